@@ -0,0 +1,296 @@
+/*
+ * protocol_bench.h
+ *
+ * Medição comparável dos parsers de t2, t3 e t4: os mesmos fluxos de
+ * mensagens (válidas, com ruído e erros, de tamanho máximo), gerados com a
+ * mesma semente, passam por cada implementação, e cada uma informa ciclos
+ * por byte, MB/s e mensagens por segundo. Só cabeçalho, como os demais de
+ * comum/: cada atividade continua compilando em um único arquivo.
+ *
+ * Ciclos: no Cortex-M pelo SysTick (a medição toma o SysTick para si, com
+ * recarga de 24 bits e sem interrupção: não rodar junto com o RTOS); no x86
+ * pelo contador de tempo (rdtsc, na frequência nominal). Sem contador, só o
+ * tempo de clock().
+ *
+ * protocol_bench_varredura mede o codificador e um parser em cada tamanho de
+ * dados de 1 a 255 bytes, com uma linha por tamanho para scripts:
+ *
+ *   varredura;<parser>;<qtd>;<codificador MB/s>;<ns/quadro>;<parser MB/s>;<ns/quadro>
+ *
+ * Cada atividade tem o modo só de varredura, sem os testes:
+ *   gcc -O2 -DPROTOCOL_BENCH_VARREDURA=1 atividade.c
+ */
+
+#ifndef PROTOCOL_BENCH_H_
+#define PROTOCOL_BENCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "protocol_checksum.h"
+
+#if defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define PROTOCOL_BENCH_SYSTICK 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROTOCOL_BENCH_RDTSC 1
+#endif
+
+// Clock da CPU no Cortex-M, para converter ciclos em tempo
+#ifndef PROTOCOL_BENCH_CPU_HZ
+#define PROTOCOL_BENCH_CPU_HZ 48000000u
+#endif
+
+// Tamanho de cada fluxo: no Cortex-M, uma passada deve durar menos de 2^24
+// ciclos (cerca de 350 ms a 48MHz), a volta do SysTick
+#ifndef PROTOCOL_BENCH_TAMANHO
+#define PROTOCOL_BENCH_TAMANHO (32u * 1024u)
+#endif
+
+// Com 1, main só executa protocol_bench_varredura
+#ifndef PROTOCOL_BENCH_VARREDURA
+#define PROTOCOL_BENCH_VARREDURA 0
+#endif
+
+// Dados sintéticos de toda a varredura, divididos pelos 255 tamanhos. No
+// Cortex-M convém reduzir (ex.: -DPROTOCOL_BENCH_VARREDURA_MB=1)
+#ifndef PROTOCOL_BENCH_VARREDURA_MB
+#define PROTOCOL_BENCH_VARREDURA_MB 100u
+#endif
+
+typedef enum {
+    BENCH_VALIDAS = 0,  // Mensagens de 1 a 64 bytes, todas válidas
+    BENCH_RUIDO,        // Ruído entre as mensagens e 1 em 4 com CHK errado
+    BENCH_MAXIMAS,      // Mensagens de 255 bytes
+    BENCH_NUM_FLUXOS
+} ProtocolBenchFluxo;
+
+static const char* const protocol_bench_nomes[BENCH_NUM_FLUXOS] = { "válidas", "ruído", "máximas" };
+
+// Parser medido: processa o fluxo inteiro e retorna as mensagens válidas
+typedef int (*ProtocolBenchParser)(void* contexto, const uint8_t* fluxo, size_t tamanho);
+
+// Codificador medido: escreve a mensagem de qtd bytes de dados em quadro,
+// com espaço para qtd + 5 bytes, e retorna o seu tamanho, ou 0 se recusou
+typedef size_t (*ProtocolBenchEncoder)(const uint8_t* dados, uint8_t qtd, uint8_t* quadro);
+
+static inline uint32_t protocol_bench_aleatorio(uint32_t* semente) {
+    *semente = *semente * 1103515245u + 12345u;
+    return *semente >> 16;
+}
+
+// Gera o fluxo (o mesmo em todas as atividades) e retorna o seu tamanho; as
+// mensagens válidas vão para *validas. Um byte 0xFF separa as mensagens: o
+// parser de t2 byte a byte descarta o byte seguinte a cada mensagem
+static inline size_t protocol_bench_gera(ProtocolBenchFluxo tipo, uint8_t* fluxo, size_t tamanho, int* validas) {
+    uint32_t semente = 2024u + (uint32_t)tipo;
+    size_t pos = 0;
+    
+    *validas = 0;
+    for (;;) {
+        size_t qtd = tipo == BENCH_MAXIMAS ? 255 : 1 + protocol_bench_aleatorio(&semente) % 64;
+        size_t ruido = tipo == BENCH_RUIDO ? protocol_bench_aleatorio(&semente) % 8 : 0;
+        
+        if (pos + ruido + qtd + 5 > tamanho) {
+            break;
+        }
+        for (size_t i = 0; i < ruido; i++) {
+            uint8_t lixo = (uint8_t)protocol_bench_aleatorio(&semente);
+            fluxo[pos++] = lixo == 0x02 ? 0x55 : lixo;  // Sem STX no ruído
+        }
+        
+        uint8_t* mensagem = &fluxo[pos];
+        mensagem[0] = 0x02;
+        mensagem[1] = (uint8_t)qtd;
+        for (size_t i = 0; i < qtd; i++) {
+            mensagem[2 + i] = (uint8_t)protocol_bench_aleatorio(&semente);
+        }
+        mensagem[2 + qtd] = protocol_sum8(&mensagem[2], qtd);
+        mensagem[3 + qtd] = 0x03;
+        if (tipo == BENCH_RUIDO && protocol_bench_aleatorio(&semente) % 4 == 0) {
+            mensagem[2 + qtd] ^= 0x5A;
+        } else {
+            (*validas)++;
+        }
+        pos += qtd + 4;
+        fluxo[pos++] = 0xFF;
+    }
+    return pos;
+}
+
+#if PROTOCOL_BENCH_SYSTICK
+#define PROTOCOL_BENCH_SYST_CSR (*(volatile uint32_t*)0xE000E010u)
+#define PROTOCOL_BENCH_SYST_RVR (*(volatile uint32_t*)0xE000E014u)
+#define PROTOCOL_BENCH_SYST_CVR (*(volatile uint32_t*)0xE000E018u)
+#endif
+
+static inline void protocol_bench_inicia_contador(void) {
+#if PROTOCOL_BENCH_SYSTICK
+    PROTOCOL_BENCH_SYST_RVR = 0xFFFFFFu;
+    PROTOCOL_BENCH_SYST_CVR = 0;
+    PROTOCOL_BENCH_SYST_CSR = 0x5u;  // Clock da CPU, contando, sem interrupção
+#endif
+}
+
+static inline uint64_t protocol_bench_contador(void) {
+#if PROTOCOL_BENCH_SYSTICK
+    return 0xFFFFFFu - PROTOCOL_BENCH_SYST_CVR;  // Conta para baixo
+#elif PROTOCOL_BENCH_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static inline uint64_t protocol_bench_ciclos(uint64_t inicio, uint64_t fim) {
+#if PROTOCOL_BENCH_SYSTICK
+    return (fim - inicio) & 0xFFFFFFu;
+#else
+    return fim - inicio;
+#endif
+}
+
+// Mede o parser nos três fluxos, repeticoes passadas em cada, e imprime uma
+// linha por fluxo. Retorna 0 se o parser encontrou todas as mensagens
+// válidas de todos os fluxos
+static inline int protocol_bench_executa(const char* nome, ProtocolBenchParser parser, void* contexto,
+                                         int repeticoes) {
+    static uint8_t fluxo[PROTOCOL_BENCH_TAMANHO];
+    int divergente = 0;
+    
+    protocol_bench_inicia_contador();
+    for (int tipo = 0; tipo < BENCH_NUM_FLUXOS; tipo++) {
+        int validas, encontradas = 0;
+        size_t tamanho = protocol_bench_gera((ProtocolBenchFluxo)tipo, fluxo, sizeof(fluxo), &validas);
+        uint64_t ciclos = 0;
+        clock_t inicio = clock();
+        
+        for (int r = 0; r < repeticoes; r++) {
+            uint64_t c0 = protocol_bench_contador();
+            encontradas = parser(contexto, fluxo, tamanho);
+            ciclos += protocol_bench_ciclos(c0, protocol_bench_contador());
+            if (encontradas != validas) {
+                divergente = 1;
+            }
+        }
+        
+#if PROTOCOL_BENCH_SYSTICK
+        double segundos = (double)ciclos / PROTOCOL_BENCH_CPU_HZ;
+#else
+        double segundos = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+#endif
+        (void)inicio;
+        double bytes = (double)tamanho * repeticoes;
+        
+        printf("Medição %s, %s: ", nome, protocol_bench_nomes[tipo]);
+        if (ciclos > 0) {
+            printf("%.1f ciclos/byte, ", (double)ciclos / bytes);
+        }
+        if (segundos > 0) {
+            printf("%.1f MB/s, %.0f mensagens/s", bytes / segundos / 1e6, (double)validas * repeticoes / segundos);
+        }
+        printf("%s\n", encontradas == validas ? "" : " (mensagens divergentes)");
+    }
+    return divergente;
+}
+
+// Tempo de uma medição em segundos: ciclos do SysTick no Cortex-M, clock()
+// no computador
+static inline double protocol_bench_segundos(uint64_t ciclos, clock_t inicio) {
+#if PROTOCOL_BENCH_SYSTICK
+    (void)inicio;
+    return (double)ciclos / PROTOCOL_BENCH_CPU_HZ;
+#else
+    (void)ciclos;
+    return (double)(clock() - inicio) / CLOCKS_PER_SEC;
+#endif
+}
+
+// Mede, para cada qtd de 1 a 255, o codificador enchendo o fluxo de
+// mensagens de qtd bytes (separadas por 0xFF, como em protocol_bench_gera) e
+// o parser lendo esse fluxo, até passarem PROTOCOL_BENCH_VARREDURA_MB / 255
+// MB por cada um. Retorna 0 se o parser achou todas as mensagens em todos os
+// tamanhos que o codificador aceitou
+static inline int protocol_bench_varredura(const char* nome, ProtocolBenchEncoder codificador,
+                                           ProtocolBenchParser parser, void* contexto) {
+    static uint8_t fluxo[PROTOCOL_BENCH_TAMANHO];
+    uint8_t dados[255];
+    uint32_t semente = 2024u;
+    double alvo = (double)PROTOCOL_BENCH_VARREDURA_MB * 1e6 / 255;
+    double total_codificados = 0, total_lidos = 0, t_codificador = 0, t_parser = 0;
+    int divergente = 0;
+    
+    for (size_t i = 0; i < sizeof(dados); i++) {
+        dados[i] = (uint8_t)protocol_bench_aleatorio(&semente);
+    }
+    
+    protocol_bench_inicia_contador();
+    printf("varredura;parser;qtd;codificador MB/s;ns/quadro;parser MB/s;ns/quadro\n");
+    for (unsigned qtd = 1; qtd <= 255; qtd++) {
+        double codificados = 0, lidos = 0, quadros = 0, segundos_cod, segundos_parser;
+        size_t tamanho = 0;
+        int mensagens = 0;
+        uint64_t ciclos = 0;
+        clock_t inicio = clock();
+        
+        // Codificador: o fluxo é refeito até passar o alvo
+        while (codificados < alvo) {
+            uint64_t c0 = protocol_bench_contador();
+            size_t pos = 0, n;
+            
+            mensagens = 0;
+            while (pos + qtd + 6 <= sizeof(fluxo) && (n = codificador(dados, (uint8_t)qtd, &fluxo[pos])) > 0) {
+                pos += n;
+                fluxo[pos++] = 0xFF;
+                mensagens++;
+            }
+            ciclos += protocol_bench_ciclos(c0, protocol_bench_contador());
+            if (mensagens == 0) {
+                break;
+            }
+            tamanho = pos;
+            codificados += (double)pos;
+            quadros += mensagens;
+        }
+        if (mensagens == 0) {
+            printf("varredura;%s;%u;recusado;;;\n", nome, qtd);
+            continue;
+        }
+        segundos_cod = protocol_bench_segundos(ciclos, inicio);
+        t_codificador += segundos_cod;
+        total_codificados += codificados;
+        
+        // Parser: o mesmo número de quadros
+        double lidos_quadros = 0;
+        ciclos = 0;
+        inicio = clock();
+        while (lidos < alvo) {
+            uint64_t c0 = protocol_bench_contador();
+            int encontradas = parser(contexto, fluxo, tamanho);
+            ciclos += protocol_bench_ciclos(c0, protocol_bench_contador());
+            if (encontradas != mensagens) {
+                divergente = 1;
+            }
+            lidos += (double)tamanho;
+            lidos_quadros += mensagens;
+        }
+        segundos_parser = protocol_bench_segundos(ciclos, inicio);
+        t_parser += segundos_parser;
+        total_lidos += lidos;
+        
+        printf("varredura;%s;%u;%.1f;%.1f;%.1f;%.1f\n", nome, qtd,
+               segundos_cod > 0 ? codificados / segundos_cod / 1e6 : 0.0, segundos_cod * 1e9 / quadros,
+               segundos_parser > 0 ? lidos / segundos_parser / 1e6 : 0.0, segundos_parser * 1e9 / lidos_quadros);
+    }
+    if (t_codificador > 0 && t_parser > 0) {
+        printf("Varredura %s: codificador %.1f MB/s, parser %.1f MB/s%s\n", nome,
+               total_codificados / t_codificador / 1e6, total_lidos / t_parser / 1e6,
+               divergente ? " (mensagens divergentes)" : "");
+    }
+    return divergente;
+}
+
+#endif /* PROTOCOL_BENCH_H_ */
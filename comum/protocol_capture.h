@@ -0,0 +1,261 @@
+/*
+ * protocol_capture.h
+ *
+ * Captura de tráfego real para medir os parsers de t2, t3 e t4 com ele, e
+ * não só com os fluxos sintéticos de protocol_bench.h. Uma captura é uma
+ * sequência de trechos de bytes brutos, como chegaram (um read, um bloco
+ * do DMA), cada um com o canal e a marca de tempo. Quem grava pode ser o
+ * gateway no computador (protocol_gateway_*) ou o microcontrolador, numa
+ * área da RAM depois lida pelo console ou pelo depurador. Só cabeçalho,
+ * como os demais de comum/.
+ *
+ * Formato, compacto para caber na RAM do microcontrolador:
+ *
+ *   "FMSC" + versão (1 byte)
+ *   trechos: delta da marca (µs) + canal + tamanho + bytes
+ *
+ * O delta, o canal e o tamanho são inteiros de 7 bits por byte (o bit 7
+ * indica que há mais um byte, o menos significativo primeiro): um trecho
+ * de até 127 bytes em menos de 128 µs tem 3 bytes de cabeçalho.
+ *
+ * protocol_capture_replay passa os trechos, em ordem, a um parser
+ * qualquer (uma função por trecho), na velocidade gravada ou na máxima.
+ */
+
+#ifndef PROTOCOL_CAPTURE_H_
+#define PROTOCOL_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define PROTOCOL_CAPTURE_VERSAO 1u
+#define PROTOCOL_CAPTURE_CABECALHO 5u
+
+// Relógio da reprodução na velocidade gravada, em µs. O padrão, clock(),
+// avança enquanto a reprodução espera ocupando a CPU
+#ifndef PROTOCOL_CAPTURE_AGORA_US
+#define PROTOCOL_CAPTURE_AGORA_US() ((uint64_t)clock() * 1000000u / CLOCKS_PER_SEC)
+#endif
+
+// Gravação numa área do chamador
+typedef struct {
+    uint8_t* area;
+    size_t capacidade;
+    size_t tamanho;            // Bytes gravados, com o cabeçalho
+    uint32_t ultima_marca;     // Marca do trecho anterior (µs)
+    uint32_t trechos;
+    uint32_t perdidos;         // Trechos que não couberam
+} ProtocolCapture;
+
+// Um trecho lido: aponta para a captura
+typedef struct {
+    uint32_t marca_us;         // Desde o início da captura
+    uint16_t canal;
+    uint16_t tamanho;
+    const uint8_t* bytes;
+} ProtocolCaptureTrecho;
+
+typedef struct {
+    const uint8_t* dados;
+    size_t tamanho;
+    size_t pos;
+    uint32_t marca_us;
+} ProtocolCaptureLeitor;
+
+// Parser reproduzido: recebe um trecho e retorna as mensagens válidas
+// encontradas nele
+typedef int (*ProtocolCaptureParser)(void* contexto, uint16_t canal, const uint8_t* bytes, size_t tamanho);
+
+typedef struct {
+    uint64_t bytes;
+    uint32_t trechos;
+    uint32_t mensagens;
+    double segundos;
+} ProtocolCaptureResultado;
+
+static inline size_t protocol_capture_escreve_varint(uint8_t* p, uint32_t valor) {
+    size_t n = 0;
+    
+    while (valor >= 0x80u) {
+        p[n++] = (uint8_t)(valor | 0x80u);
+        valor >>= 7;
+    }
+    p[n++] = (uint8_t)valor;
+    return n;
+}
+
+// Retorna os bytes lidos, ou 0 se o inteiro passa do fim ou de 32 bits
+static inline size_t protocol_capture_le_varint(const uint8_t* p, size_t disponivel, uint32_t* valor) {
+    uint32_t v = 0;
+    
+    for (size_t n = 0; n < disponivel && n < 5; n++) {
+        v |= (uint32_t)(p[n] & 0x7Fu) << (7 * n);
+        if ((p[n] & 0x80u) == 0) {
+            *valor = v;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+// Escreve o cabeçalho. Retorna false se a área não cabe nem o cabeçalho
+static inline bool protocol_capture_inicia(ProtocolCapture* c, uint8_t* area, size_t capacidade) {
+    memset(c, 0, sizeof(*c));
+    if (!area || capacidade < PROTOCOL_CAPTURE_CABECALHO) {
+        return false;
+    }
+    
+    c->area = area;
+    c->capacidade = capacidade;
+    memcpy(area, "FMSC", 4);
+    area[4] = PROTOCOL_CAPTURE_VERSAO;
+    c->tamanho = PROTOCOL_CAPTURE_CABECALHO;
+    return true;
+}
+
+// Grava um trecho recebido no canal com a marca marca_us (µs, de qualquer
+// origem: só a diferença para o trecho anterior é guardada). Um trecho que
+// não cabe é perdido inteiro e contado, sem cortar a captura no meio
+static inline bool protocol_capture_grava(ProtocolCapture* c, uint32_t marca_us, uint16_t canal,
+                                          const uint8_t* bytes, uint16_t tamanho) {
+    uint8_t cabeca[15];
+    size_t n;
+    
+    if (!c->area || tamanho == 0) {
+        return false;
+    }
+    
+    n = protocol_capture_escreve_varint(cabeca, c->trechos > 0 ? marca_us - c->ultima_marca : 0);
+    n += protocol_capture_escreve_varint(&cabeca[n], canal);
+    n += protocol_capture_escreve_varint(&cabeca[n], tamanho);
+    if (c->capacidade - c->tamanho < n + tamanho) {
+        c->perdidos++;
+        return false;
+    }
+    
+    memcpy(&c->area[c->tamanho], cabeca, n);
+    memcpy(&c->area[c->tamanho + n], bytes, tamanho);
+    c->tamanho += n + tamanho;
+    c->ultima_marca = marca_us;
+    c->trechos++;
+    return true;
+}
+
+// Confere o cabeçalho. Retorna false se não é uma captura desta versão
+static inline bool protocol_capture_abre(ProtocolCaptureLeitor* l, const uint8_t* dados, size_t tamanho) {
+    memset(l, 0, sizeof(*l));
+    if (!dados || tamanho < PROTOCOL_CAPTURE_CABECALHO || memcmp(dados, "FMSC", 4) != 0 ||
+        dados[4] != PROTOCOL_CAPTURE_VERSAO) {
+        return false;
+    }
+    
+    l->dados = dados;
+    l->tamanho = tamanho;
+    l->pos = PROTOCOL_CAPTURE_CABECALHO;
+    return true;
+}
+
+// Próximo trecho. Retorna 1 com um trecho, 0 no fim e -1 se a captura está
+// cortada ou corrompida
+static inline int protocol_capture_proximo(ProtocolCaptureLeitor* l, ProtocolCaptureTrecho* t) {
+    uint32_t delta, canal, tamanho;
+    size_t n, pos = l->pos;
+    
+    if (pos == l->tamanho) {
+        return 0;
+    }
+    if ((n = protocol_capture_le_varint(&l->dados[pos], l->tamanho - pos, &delta)) == 0) return -1;
+    pos += n;
+    if ((n = protocol_capture_le_varint(&l->dados[pos], l->tamanho - pos, &canal)) == 0) return -1;
+    pos += n;
+    if ((n = protocol_capture_le_varint(&l->dados[pos], l->tamanho - pos, &tamanho)) == 0) return -1;
+    pos += n;
+    if (canal > 0xFFFFu || tamanho == 0 || tamanho > 0xFFFFu || tamanho > l->tamanho - pos) {
+        return -1;
+    }
+    
+    l->marca_us += delta;
+    t->marca_us = l->marca_us;
+    t->canal = (uint16_t)canal;
+    t->tamanho = (uint16_t)tamanho;
+    t->bytes = &l->dados[pos];
+    l->pos = pos + tamanho;
+    return 1;
+}
+
+/*
+ * Passa os trechos da captura ao parser, em ordem. Com tempo_real, cada
+ * trecho espera a sua marca (contada do primeiro), como na gravação; sem
+ * ele, vão o mais rápido possível e o tempo medido é só o do parser.
+ * Retorna false se a captura está corrompida (os trechos anteriores ao
+ * erro já foram passados).
+ */
+static inline bool protocol_capture_replay(const uint8_t* dados, size_t tamanho, ProtocolCaptureParser parser,
+                                           void* contexto, bool tempo_real, ProtocolCaptureResultado* r) {
+    ProtocolCaptureLeitor l;
+    ProtocolCaptureTrecho t;
+    uint64_t inicio = PROTOCOL_CAPTURE_AGORA_US();
+    clock_t cpu = clock();
+    int lido;
+    
+    memset(r, 0, sizeof(*r));
+    if (!protocol_capture_abre(&l, dados, tamanho)) {
+        return false;
+    }
+    
+    while ((lido = protocol_capture_proximo(&l, &t)) == 1) {
+        while (tempo_real && PROTOCOL_CAPTURE_AGORA_US() - inicio < t.marca_us) {
+        }
+        r->mensagens += (uint32_t)parser(contexto, t.canal, t.bytes, t.tamanho);
+        r->bytes += t.tamanho;
+        r->trechos++;
+    }
+    r->segundos = tempo_real ? (double)(PROTOCOL_CAPTURE_AGORA_US() - inicio) / 1e6
+                             : (double)(clock() - cpu) / CLOCKS_PER_SEC;
+    return lido == 0;
+}
+
+// Imprime uma linha da reprodução, como as de protocol_bench_executa
+static inline void protocol_capture_imprime(const char* nome, const ProtocolCaptureResultado* r) {
+    printf("Captura %s: %u trechos, %llu bytes, %u mensagens", nome, (unsigned)r->trechos,
+           (unsigned long long)r->bytes, (unsigned)r->mensagens);
+    if (r->segundos > 0) {
+        printf(", %.1f MB/s, %.0f mensagens/s", (double)r->bytes / r->segundos / 1e6, r->mensagens / r->segundos);
+    }
+    printf("\n");
+}
+
+// Lê uma captura gravada em arquivo (no computador) para a área do
+// chamador. Retorna o tamanho, ou 0 se não abriu ou não coube
+static inline size_t protocol_capture_carrega(const char* caminho, uint8_t* area, size_t capacidade) {
+    FILE* f = fopen(caminho, "rb");
+    size_t n;
+    
+    if (!f) {
+        return 0;
+    }
+    n = fread(area, 1, capacidade, f);
+    if (!feof(f) && fgetc(f) != EOF) {
+        n = 0;  // Maior que a área
+    }
+    fclose(f);
+    return n;
+}
+
+// Grava a captura em arquivo. Retorna false em erro
+static inline bool protocol_capture_salva(const ProtocolCapture* c, const char* caminho) {
+    FILE* f = fopen(caminho, "wb");
+    bool ok;
+    
+    if (!f) {
+        return false;
+    }
+    ok = fwrite(c->area, 1, c->tamanho, f) == c->tamanho;
+    return fclose(f) == 0 && ok;
+}
+
+#endif /* PROTOCOL_CAPTURE_H_ */
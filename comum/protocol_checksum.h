@@ -0,0 +1,63 @@
+/*
+ * protocol_checksum.h
+ *
+ * Soma de 8 bits do campo CHK, compartilhada pelos protocolos de t2, t3 e
+ * t4. Só cabeçalho (funções static inline), para cada atividade continuar
+ * compilando em um único arquivo.
+ *
+ * A soma usa SWAR (SIMD dentro de um registrador): depois de alinhar o
+ * ponteiro, cada palavra de 32 bits é somada em dois acumuladores com os
+ * bytes em faixas de 16 bits (pares e ímpares), sem um laço por byte. A
+ * cada PROTOCOL_SUM8_PALAVRAS palavras, antes que as faixas transbordem, os
+ * acumuladores são somados ao resultado.
+ */
+
+#ifndef PROTOCOL_CHECKSUM_H_
+#define PROTOCOL_CHECKSUM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Palavras por acumulação: 255 * 256 cabe em uma faixa de 16 bits
+#define PROTOCOL_SUM8_PALAVRAS 256u
+
+#define PROTOCOL_SUM8_FAIXAS 0x00FF00FFu
+
+// Continua a soma de 8 bits de um trecho: um parser pode somar a mensagem
+// em trechos, à medida que os blocos chegam
+static inline uint8_t protocol_sum8_update(uint8_t soma, const uint8_t* p, size_t n) {
+    // Até alinhar em 4 bytes (o Cortex-M0 não lê palavras desalinhadas)
+    while (n > 0 && ((uintptr_t)p & 3u) != 0) {
+        soma += *p++;
+        n--;
+    }
+    
+    while (n >= 4) {
+        size_t palavras = n / 4 < PROTOCOL_SUM8_PALAVRAS ? n / 4 : PROTOCOL_SUM8_PALAVRAS;
+        uint32_t pares = 0, impares = 0;
+        
+        n -= palavras * 4;
+        for (; palavras > 0; palavras--, p += 4) {
+            uint32_t palavra;
+            memcpy(&palavra, p, sizeof(palavra));  // Alinhado: uma leitura só
+            pares += palavra & PROTOCOL_SUM8_FAIXAS;
+            impares += (palavra >> 8) & PROTOCOL_SUM8_FAIXAS;
+        }
+        // As duas faixas de cada acumulador, módulo 256
+        soma += (uint8_t)(pares + (pares >> 16) + impares + (impares >> 16));
+    }
+    
+    while (n > 0) {
+        soma += *p++;
+        n--;
+    }
+    return soma;
+}
+
+// Soma de 8 bits dos dados (o CHK de protocol_create_message)
+static inline uint8_t protocol_sum8(const uint8_t* dados, size_t qtd) {
+    return protocol_sum8_update(0, dados, qtd);
+}
+
+#endif /* PROTOCOL_CHECKSUM_H_ */
@@ -0,0 +1,57 @@
+/*
+ * protocol_frame.h
+ *
+ * Montagem da mensagem básica (STX + QTD + dados + CHK + ETX, QTD de 8 bits
+ * e soma de 8 bits), compartilhada por protocol_create_message de t2, t3 e
+ * t4. Só cabeçalho, como protocol_checksum.h: cada atividade mantém a sua
+ * máquina de estados (switch, ponteiros para funções, protothreads) e usa
+ * o mesmo codificador.
+ */
+
+#ifndef PROTOCOL_FRAME_H_
+#define PROTOCOL_FRAME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "protocol_checksum.h"
+
+#define PROTOCOL_FRAME_STX 0x02
+#define PROTOCOL_FRAME_ETX 0x03
+
+// Retornos, com os mesmos valores de PROTOCOL_SUCCESS, PROTOCOL_ERROR e
+// PROTOCOL_INVALID_PARAM dos três protocolos
+#define PROTOCOL_FRAME_OK 0
+#define PROTOCOL_FRAME_PEQUENO -1   // Buffer menor que a mensagem
+#define PROTOCOL_FRAME_INVALIDO -3  // Ponteiro nulo ou mensagem vazia
+
+// Tamanho informado além dos dados: STX + QTD + CHK + ETX e um byte de
+// folga após o ETX, como protocol_create_message sempre informou
+#define PROTOCOL_FRAME_ENVELOPE 5u
+
+// Escreve a mensagem dos dados em buffer e o seu tamanho em *buffer_size,
+// que entra com o tamanho do buffer. O tamanho é calculado sem estourar os
+// 8 bits: com qtd acima de 250 ele não cabe em *buffer_size, e a mensagem
+// é recusada em vez de passar do fim do buffer
+static inline int protocol_frame_encode8(const uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size) {
+    if (!dados || !buffer || !buffer_size || qtd == 0) {
+        return PROTOCOL_FRAME_INVALIDO;
+    }
+    
+    size_t msg_size = PROTOCOL_FRAME_ENVELOPE + qtd;
+    if (*buffer_size < msg_size) {
+        return PROTOCOL_FRAME_PEQUENO;
+    }
+    
+    buffer[0] = PROTOCOL_FRAME_STX;
+    buffer[1] = qtd;
+    memcpy(&buffer[2], dados, qtd);
+    buffer[2 + qtd] = protocol_sum8(dados, qtd);
+    buffer[3 + qtd] = PROTOCOL_FRAME_ETX;
+    
+    *buffer_size = (uint8_t)msg_size;
+    return PROTOCOL_FRAME_OK;
+}
+
+#endif /* PROTOCOL_FRAME_H_ */
@@ -0,0 +1,157 @@
+/*
+ * protocol_test.h
+ *
+ * Macros de testes de t2, t3 e t4, baseadas em minUnit
+ * (www.jera.com/techinfo/jtns/jtn002.html), com tempo: executa_teste mede a
+ * duração de cada teste e verifica_tempo reprova o teste quando uma
+ * expressão passa do seu orçamento em ns, do mesmo jeito que verifica
+ * reprova uma falha funcional. Só cabeçalho, como os demais de comum/.
+ *
+ * protocol_test_resumo imprime uma linha por teste e por orçamento, com os
+ * campos separados por ';', para comparar execuções em scripts:
+ *
+ *   teste;<função>;<ns>
+ *   tempo;<mensagem>;<ns medidos>;<limite em ns>;ok|reprovado
+ *
+ * Tempo: no computador pelo relógio monotônico (ou, em C ISO estrito, pelo
+ * de timespec_get/clock); no Cortex-M pelo contador de protocol_bench.h,
+ * convertido com PROTOCOL_BENCH_CPU_HZ.
+ */
+
+#ifndef PROTOCOL_TEST_H_
+#define PROTOCOL_TEST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "protocol_bench.h"
+
+// Execuções de cada verifica_tempo: vale a menor, que é a menos perturbada
+// pelo sistema. A expressão é avaliada várias vezes e não deve acumular
+// efeitos colaterais
+#ifndef PROTOCOL_TEST_REPETICOES
+#define PROTOCOL_TEST_REPETICOES 5
+#endif
+
+// Multiplica todos os orçamentos, para máquinas lentas ou execuções
+// instrumentadas (ex.: -DPROTOCOL_TEST_FOLGA=20 com valgrind ou sanitizers)
+#ifndef PROTOCOL_TEST_FOLGA
+#define PROTOCOL_TEST_FOLGA 1
+#endif
+
+// Testes e orçamentos guardados para o resumo; os seguintes são contados,
+// mas não aparecem nele
+#ifndef PROTOCOL_TEST_MAX_TESTES
+#define PROTOCOL_TEST_MAX_TESTES 64
+#endif
+#ifndef PROTOCOL_TEST_MAX_TEMPOS
+#define PROTOCOL_TEST_MAX_TEMPOS 32
+#endif
+
+#if !PROTOCOL_BENCH_SYSTICK
+#include <time.h>
+#endif
+
+typedef struct {
+    const char* nome;
+    uint64_t ns;
+} ProtocolTestDuracao;
+
+typedef struct {
+    const char* mensagem;
+    uint64_t ns;
+    uint64_t limite_ns;
+} ProtocolTestTempo;
+
+static int testes_executados = 0;
+static ProtocolTestDuracao protocol_test_duracoes[PROTOCOL_TEST_MAX_TESTES];
+static ProtocolTestTempo protocol_test_tempos[PROTOCOL_TEST_MAX_TEMPOS];
+static int protocol_test_num_tempos = 0;
+
+static inline uint64_t protocol_test_agora_ns(void) {
+#if PROTOCOL_BENCH_SYSTICK
+    // Contador de 24 bits: cada medição deve durar menos de uma volta
+    static uint64_t ciclos = 0;
+    static uint64_t anterior = 0;
+    static int iniciado = 0;
+    uint64_t atual;
+
+    if (!iniciado) {
+        protocol_bench_inicia_contador();
+        iniciado = 1;
+    }
+    atual = protocol_bench_contador();
+    ciclos += protocol_bench_ciclos(anterior, atual);
+    anterior = atual;
+    return ciclos * 1000000000u / PROTOCOL_BENCH_CPU_HZ;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (uint64_t)agora.tv_sec * 1000000000u + (uint64_t)agora.tv_nsec;
+#elif defined(TIME_UTC)
+    // -std=c11 sem extensões POSIX (t4, por causa do seu timer_t)
+    struct timespec agora;
+    timespec_get(&agora, TIME_UTC);
+    return (uint64_t)agora.tv_sec * 1000000000u + (uint64_t)agora.tv_nsec;
+#else
+    return (uint64_t)clock() * (1000000000u / CLOCKS_PER_SEC);
+#endif
+}
+
+static inline void protocol_test_registra(const char* nome, uint64_t ns) {
+    if (testes_executados < PROTOCOL_TEST_MAX_TESTES) {
+        protocol_test_duracoes[testes_executados].nome = nome;
+        protocol_test_duracoes[testes_executados].ns = ns;
+    }
+    testes_executados++;
+}
+
+// Guarda a medição e retorna 0 se ela passou do limite
+static inline int protocol_test_dentro(const char* mensagem, uint64_t ns, uint64_t limite_ns) {
+    if (protocol_test_num_tempos < PROTOCOL_TEST_MAX_TEMPOS) {
+        protocol_test_tempos[protocol_test_num_tempos].mensagem = mensagem;
+        protocol_test_tempos[protocol_test_num_tempos].ns = ns;
+        protocol_test_tempos[protocol_test_num_tempos].limite_ns = limite_ns;
+        protocol_test_num_tempos++;
+    }
+    return ns <= limite_ns;
+}
+
+static inline void protocol_test_resumo(void) {
+    int n = testes_executados < PROTOCOL_TEST_MAX_TESTES ? testes_executados : PROTOCOL_TEST_MAX_TESTES;
+
+    for (int i = 0; i < n; i++) {
+        printf("teste;%s;%llu\n", protocol_test_duracoes[i].nome,
+               (unsigned long long)protocol_test_duracoes[i].ns);
+    }
+    for (int i = 0; i < protocol_test_num_tempos; i++) {
+        const ProtocolTestTempo* t = &protocol_test_tempos[i];
+        printf("tempo;%s;%llu;%llu;%s\n", t->mensagem, (unsigned long long)t->ns,
+               (unsigned long long)t->limite_ns, t->ns <= t->limite_ns ? "ok" : "reprovado");
+    }
+}
+
+#define verifica(mensagem, teste) do { if (!(teste)) return mensagem; } while (0)
+
+#define executa_teste(teste) do { uint64_t inicio_ = protocol_test_agora_ns(); char *mensagem = teste(); \
+                                protocol_test_registra(#teste, protocol_test_agora_ns() - inicio_); \
+                                if (mensagem) return mensagem; } while (0)
+
+// Reprova se a menor de PROTOCOL_TEST_REPETICOES execuções da expressão
+// levar mais que max_ns (vezes PROTOCOL_TEST_FOLGA)
+#define verifica_tempo(mensagem, expressao, max_ns) do { \
+        uint64_t menor_ = UINT64_MAX; \
+        for (int r_ = 0; r_ < PROTOCOL_TEST_REPETICOES; r_++) { \
+            uint64_t inicio_ = protocol_test_agora_ns(); \
+            (void)(expressao); \
+            uint64_t ns_ = protocol_test_agora_ns() - inicio_; \
+            if (ns_ < menor_) { \
+                menor_ = ns_; \
+            } \
+        } \
+        if (!protocol_test_dentro(mensagem, menor_, (uint64_t)(max_ns) * PROTOCOL_TEST_FOLGA)) { \
+            return mensagem; \
+        } \
+    } while (0)
+
+#endif /* PROTOCOL_TEST_H_ */
@@ -0,0 +1,90 @@
+/*
+ * protocol_trace.h
+ *
+ * Rastro das trocas de estado dos parsers de t2, t3 e t4, para descobrir em
+ * qual estado uma mensagem foi perdida. Com PROTOCOL_TRACE em 1, cada troca
+ * grava (marca de tempo, estado anterior, novo estado, byte) em um anel;
+ * os registros mais antigos são sobrescritos. Com PROTOCOL_TRACE em 0 (o
+ * padrão) PROTOCOL_TRACE_TRANSICAO não gera código e o anel não existe.
+ */
+
+#ifndef PROTOCOL_TRACE_H_
+#define PROTOCOL_TRACE_H_
+
+#ifndef PROTOCOL_TRACE
+#define PROTOCOL_TRACE 0
+#endif
+
+#if PROTOCOL_TRACE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// Registros guardados no anel (potência de 2)
+#ifndef PROTOCOL_TRACE_TAMANHO
+#define PROTOCOL_TRACE_TAMANHO 64u
+#endif
+
+#if (PROTOCOL_TRACE_TAMANHO & (PROTOCOL_TRACE_TAMANHO - 1)) != 0
+#error "PROTOCOL_TRACE_TAMANHO deve ser potencia de 2"
+#endif
+
+// Marca de tempo de cada registro (no microcontrolador, ex.:
+// ObtemMarcasDeTempo() do RTOS)
+#ifndef PROTOCOL_TRACE_MARCA
+#define PROTOCOL_TRACE_MARCA() ((uint32_t)clock())
+#endif
+
+typedef struct {
+    uint32_t marca;            // PROTOCOL_TRACE_MARCA() na troca
+    uint8_t de;                // Estado anterior
+    uint8_t para;              // Novo estado
+    uint8_t byte;              // Byte que causou a troca
+} ProtocolTraceRegistro;
+
+typedef struct {
+    ProtocolTraceRegistro registros[PROTOCOL_TRACE_TAMANHO];
+    uint32_t escritos;         // Total de trocas gravadas (também as sobrescritas)
+} ProtocolTrace;
+
+static ProtocolTrace protocol_trace;
+
+static inline void protocol_trace_registra(uint8_t de, uint8_t para, uint8_t byte) {
+    ProtocolTraceRegistro* r = &protocol_trace.registros[protocol_trace.escritos & (PROTOCOL_TRACE_TAMANHO - 1)];
+    
+    r->marca = PROTOCOL_TRACE_MARCA();
+    r->de = de;
+    r->para = para;
+    r->byte = byte;
+    protocol_trace.escritos++;
+}
+
+// Copia até max registros, do mais antigo ao mais recente ainda no anel, e
+// retorna quantos foram copiados
+static inline size_t protocol_trace_le(ProtocolTraceRegistro* destino, size_t max) {
+    uint32_t guardados = protocol_trace.escritos < PROTOCOL_TRACE_TAMANHO ? protocol_trace.escritos
+                                                                          : PROTOCOL_TRACE_TAMANHO;
+    uint32_t primeiro = protocol_trace.escritos - guardados;
+    size_t n = guardados < max ? guardados : max;
+    
+    for (size_t i = 0; i < n; i++) {
+        destino[i] = protocol_trace.registros[(primeiro + i) & (PROTOCOL_TRACE_TAMANHO - 1)];
+    }
+    return n;
+}
+
+static inline void protocol_trace_limpa(void) {
+    protocol_trace.escritos = 0;
+}
+
+#define PROTOCOL_TRACE_TRANSICAO(de, para, byte) \
+    protocol_trace_registra((uint8_t)(de), (uint8_t)(para), (uint8_t)(byte))
+
+#else
+
+#define PROTOCOL_TRACE_TRANSICAO(de, para, byte) do { (void)(de); } while (0)
+
+#endif /* PROTOCOL_TRACE */
+
+#endif /* PROTOCOL_TRACE_H_ */
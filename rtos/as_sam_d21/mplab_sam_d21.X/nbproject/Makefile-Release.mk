@@ -51,17 +51,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=../src/cpu-port.c ../src/rtos.c ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c ../src/ASF/sam0/drivers/port/port.c ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c ../src/ASF/sam0/drivers/system/pinmux/pinmux.c ../src/ASF/sam0/drivers/system/system.c ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c ../src/main.c
+SOURCEFILES_QUOTED_IF_SPACED=../../portas/cortex_m0_gcc/cpu-port.c ../../nucleo/rtos.c ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c ../src/ASF/sam0/drivers/port/port.c ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c ../src/ASF/sam0/drivers/system/pinmux/pinmux.c ../src/ASF/sam0/drivers/system/system.c ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c ../src/main.c ../src/uart_dma.c ../src/dma.c ../src/eventos.c ../src/amostragem.c ../src/clock_adiado.c ../src/perfil_clock.c ../src/filtro_dsp.c ../src/spi_dma.c ../src/i2c_mestre.c ../src/receptor_quadros.c ../src/diario.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/1360937237/cpu-port.o ${OBJECTDIR}/_ext/1360937237/rtos.o ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o ${OBJECTDIR}/_ext/1502292737/board_init.o ${OBJECTDIR}/_ext/876312722/port.o ${OBJECTDIR}/_ext/519451615/clock.o ${OBJECTDIR}/_ext/519451615/gclk.o ${OBJECTDIR}/_ext/1234282992/system_interrupt.o ${OBJECTDIR}/_ext/980481618/pinmux.o ${OBJECTDIR}/_ext/227780132/system.o ${OBJECTDIR}/_ext/1126068005/startup_samd21.o ${OBJECTDIR}/_ext/540691939/system_samd21.o ${OBJECTDIR}/_ext/1284275751/syscalls.o ${OBJECTDIR}/_ext/1360937237/main.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/1360937237/cpu-port.o.d ${OBJECTDIR}/_ext/1360937237/rtos.o.d ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o.d ${OBJECTDIR}/_ext/1502292737/board_init.o.d ${OBJECTDIR}/_ext/876312722/port.o.d ${OBJECTDIR}/_ext/519451615/clock.o.d ${OBJECTDIR}/_ext/519451615/gclk.o.d ${OBJECTDIR}/_ext/1234282992/system_interrupt.o.d ${OBJECTDIR}/_ext/980481618/pinmux.o.d ${OBJECTDIR}/_ext/227780132/system.o.d ${OBJECTDIR}/_ext/1126068005/startup_samd21.o.d ${OBJECTDIR}/_ext/540691939/system_samd21.o.d ${OBJECTDIR}/_ext/1284275751/syscalls.o.d ${OBJECTDIR}/_ext/1360937237/main.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/852800589/cpu-port.o ${OBJECTDIR}/_ext/1009061190/rtos.o ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o ${OBJECTDIR}/_ext/1502292737/board_init.o ${OBJECTDIR}/_ext/876312722/port.o ${OBJECTDIR}/_ext/519451615/clock.o ${OBJECTDIR}/_ext/519451615/gclk.o ${OBJECTDIR}/_ext/1234282992/system_interrupt.o ${OBJECTDIR}/_ext/980481618/pinmux.o ${OBJECTDIR}/_ext/227780132/system.o ${OBJECTDIR}/_ext/1126068005/startup_samd21.o ${OBJECTDIR}/_ext/540691939/system_samd21.o ${OBJECTDIR}/_ext/1284275751/syscalls.o ${OBJECTDIR}/_ext/1360937237/main.o ${OBJECTDIR}/_ext/1360937237/uart_dma.o ${OBJECTDIR}/_ext/1360937237/dma.o ${OBJECTDIR}/_ext/1360937237/eventos.o ${OBJECTDIR}/_ext/1360937237/amostragem.o ${OBJECTDIR}/_ext/1360937237/clock_adiado.o ${OBJECTDIR}/_ext/1360937237/perfil_clock.o ${OBJECTDIR}/_ext/1360937237/filtro_dsp.o ${OBJECTDIR}/_ext/1360937237/spi_dma.o ${OBJECTDIR}/_ext/1360937237/i2c_mestre.o ${OBJECTDIR}/_ext/1360937237/receptor_quadros.o ${OBJECTDIR}/_ext/1360937237/diario.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/852800589/cpu-port.o.d ${OBJECTDIR}/_ext/1009061190/rtos.o.d ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o.d ${OBJECTDIR}/_ext/1502292737/board_init.o.d ${OBJECTDIR}/_ext/876312722/port.o.d ${OBJECTDIR}/_ext/519451615/clock.o.d ${OBJECTDIR}/_ext/519451615/gclk.o.d ${OBJECTDIR}/_ext/1234282992/system_interrupt.o.d ${OBJECTDIR}/_ext/980481618/pinmux.o.d ${OBJECTDIR}/_ext/227780132/system.o.d ${OBJECTDIR}/_ext/1126068005/startup_samd21.o.d ${OBJECTDIR}/_ext/540691939/system_samd21.o.d ${OBJECTDIR}/_ext/1284275751/syscalls.o.d ${OBJECTDIR}/_ext/1360937237/main.o.d ${OBJECTDIR}/_ext/1360937237/uart_dma.o.d ${OBJECTDIR}/_ext/1360937237/dma.o.d ${OBJECTDIR}/_ext/1360937237/eventos.o.d ${OBJECTDIR}/_ext/1360937237/amostragem.o.d ${OBJECTDIR}/_ext/1360937237/clock_adiado.o.d ${OBJECTDIR}/_ext/1360937237/perfil_clock.o.d ${OBJECTDIR}/_ext/1360937237/filtro_dsp.o.d ${OBJECTDIR}/_ext/1360937237/spi_dma.o.d ${OBJECTDIR}/_ext/1360937237/i2c_mestre.o.d ${OBJECTDIR}/_ext/1360937237/receptor_quadros.o.d ${OBJECTDIR}/_ext/1360937237/diario.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/_ext/1360937237/cpu-port.o ${OBJECTDIR}/_ext/1360937237/rtos.o ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o ${OBJECTDIR}/_ext/1502292737/board_init.o ${OBJECTDIR}/_ext/876312722/port.o ${OBJECTDIR}/_ext/519451615/clock.o ${OBJECTDIR}/_ext/519451615/gclk.o ${OBJECTDIR}/_ext/1234282992/system_interrupt.o ${OBJECTDIR}/_ext/980481618/pinmux.o ${OBJECTDIR}/_ext/227780132/system.o ${OBJECTDIR}/_ext/1126068005/startup_samd21.o ${OBJECTDIR}/_ext/540691939/system_samd21.o ${OBJECTDIR}/_ext/1284275751/syscalls.o ${OBJECTDIR}/_ext/1360937237/main.o
+OBJECTFILES=${OBJECTDIR}/_ext/852800589/cpu-port.o ${OBJECTDIR}/_ext/1009061190/rtos.o ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o ${OBJECTDIR}/_ext/1502292737/board_init.o ${OBJECTDIR}/_ext/876312722/port.o ${OBJECTDIR}/_ext/519451615/clock.o ${OBJECTDIR}/_ext/519451615/gclk.o ${OBJECTDIR}/_ext/1234282992/system_interrupt.o ${OBJECTDIR}/_ext/980481618/pinmux.o ${OBJECTDIR}/_ext/227780132/system.o ${OBJECTDIR}/_ext/1126068005/startup_samd21.o ${OBJECTDIR}/_ext/540691939/system_samd21.o ${OBJECTDIR}/_ext/1284275751/syscalls.o ${OBJECTDIR}/_ext/1360937237/main.o ${OBJECTDIR}/_ext/1360937237/uart_dma.o ${OBJECTDIR}/_ext/1360937237/dma.o ${OBJECTDIR}/_ext/1360937237/eventos.o ${OBJECTDIR}/_ext/1360937237/amostragem.o ${OBJECTDIR}/_ext/1360937237/clock_adiado.o ${OBJECTDIR}/_ext/1360937237/perfil_clock.o ${OBJECTDIR}/_ext/1360937237/filtro_dsp.o ${OBJECTDIR}/_ext/1360937237/spi_dma.o ${OBJECTDIR}/_ext/1360937237/i2c_mestre.o ${OBJECTDIR}/_ext/1360937237/receptor_quadros.o ${OBJECTDIR}/_ext/1360937237/diario.o
 
 # Source Files
-SOURCEFILES=../src/cpu-port.c ../src/rtos.c ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c ../src/ASF/sam0/drivers/port/port.c ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c ../src/ASF/sam0/drivers/system/pinmux/pinmux.c ../src/ASF/sam0/drivers/system/system.c ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c ../src/main.c
+SOURCEFILES=../../portas/cortex_m0_gcc/cpu-port.c ../../nucleo/rtos.c ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c ../src/ASF/sam0/drivers/port/port.c ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c ../src/ASF/sam0/drivers/system/pinmux/pinmux.c ../src/ASF/sam0/drivers/system/system.c ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c ../src/main.c ../src/uart_dma.c ../src/dma.c ../src/eventos.c ../src/amostragem.c ../src/clock_adiado.c ../src/perfil_clock.c ../src/filtro_dsp.c ../src/spi_dma.c ../src/i2c_mestre.c ../src/receptor_quadros.c ../src/diario.c
 
 # Pack Options 
 PACK_COMMON_OPTIONS=-I "${DFP_DIR}/samd21a/include"  -I "${CMSIS_DIR}/CMSIS/Core/Include"
@@ -103,174 +103,486 @@ endif
 # ------------------------------------------------------------------------------------
 # Rules for buildStep: compile
 ifeq ($(TYPE_IMAGE), DEBUG_RUN)
-${OBJECTDIR}/_ext/1360937237/cpu-port.o: ../src/cpu-port.c  .generated_files/flags/Release/14a0cdb656da7d67232327c7ad373e555fee6188 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
-	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
-	@${RM} ${OBJECTDIR}/_ext/1360937237/cpu-port.o.d 
-	@${RM} ${OBJECTDIR}/_ext/1360937237/cpu-port.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/cpu-port.o.d" -o ${OBJECTDIR}/_ext/1360937237/cpu-port.o ../src/cpu-port.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+${OBJECTDIR}/_ext/852800589/cpu-port.o: ../../portas/cortex_m0_gcc/cpu-port.c  .generated_files/flags/Release/14a0cdb656da7d67232327c7ad373e555fee6188 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/852800589" 
+	@${RM} ${OBJECTDIR}/_ext/852800589/cpu-port.o.d 
+	@${RM} ${OBJECTDIR}/_ext/852800589/cpu-port.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/852800589/cpu-port.o.d" -o ${OBJECTDIR}/_ext/852800589/cpu-port.o ../../portas/cortex_m0_gcc/cpu-port.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
-${OBJECTDIR}/_ext/1360937237/rtos.o: ../src/rtos.c  .generated_files/flags/Release/1bdaf546a7c6aa28c980099fad586dd5cd8d981a .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
-	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
-	@${RM} ${OBJECTDIR}/_ext/1360937237/rtos.o.d 
-	@${RM} ${OBJECTDIR}/_ext/1360937237/rtos.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/rtos.o.d" -o ${OBJECTDIR}/_ext/1360937237/rtos.o ../src/rtos.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+${OBJECTDIR}/_ext/1009061190/rtos.o: ../../nucleo/rtos.c  .generated_files/flags/Release/1bdaf546a7c6aa28c980099fad586dd5cd8d981a .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1009061190" 
+	@${RM} ${OBJECTDIR}/_ext/1009061190/rtos.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1009061190/rtos.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1009061190/rtos.o.d" -o ${OBJECTDIR}/_ext/1009061190/rtos.o ../../nucleo/rtos.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o: ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c  .generated_files/flags/Release/2996ef3f557f8873121a77f0e0947b30bc6ce837 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1939168694" 
 	@${RM} ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o.d" -o ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o.d" -o ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1502292737/board_init.o: ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c  .generated_files/flags/Release/85413a0a53dec9dea22dd7cd8ae6a2c1a8ba0af5 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1502292737" 
 	@${RM} ${OBJECTDIR}/_ext/1502292737/board_init.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1502292737/board_init.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1502292737/board_init.o.d" -o ${OBJECTDIR}/_ext/1502292737/board_init.o ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1502292737/board_init.o.d" -o ${OBJECTDIR}/_ext/1502292737/board_init.o ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/876312722/port.o: ../src/ASF/sam0/drivers/port/port.c  .generated_files/flags/Release/9bbca440efb9df39b81776a8546c853caf6d655f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/876312722" 
 	@${RM} ${OBJECTDIR}/_ext/876312722/port.o.d 
 	@${RM} ${OBJECTDIR}/_ext/876312722/port.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/876312722/port.o.d" -o ${OBJECTDIR}/_ext/876312722/port.o ../src/ASF/sam0/drivers/port/port.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/876312722/port.o.d" -o ${OBJECTDIR}/_ext/876312722/port.o ../src/ASF/sam0/drivers/port/port.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/519451615/clock.o: ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c  .generated_files/flags/Release/80d40a3f879550906fb574ee65e0466c1648e1c8 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/519451615" 
 	@${RM} ${OBJECTDIR}/_ext/519451615/clock.o.d 
 	@${RM} ${OBJECTDIR}/_ext/519451615/clock.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/519451615/clock.o.d" -o ${OBJECTDIR}/_ext/519451615/clock.o ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/519451615/clock.o.d" -o ${OBJECTDIR}/_ext/519451615/clock.o ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/519451615/gclk.o: ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c  .generated_files/flags/Release/da6a28a87bcfaef919c648ce69fc5fd75ba5595d .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/519451615" 
 	@${RM} ${OBJECTDIR}/_ext/519451615/gclk.o.d 
 	@${RM} ${OBJECTDIR}/_ext/519451615/gclk.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/519451615/gclk.o.d" -o ${OBJECTDIR}/_ext/519451615/gclk.o ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/519451615/gclk.o.d" -o ${OBJECTDIR}/_ext/519451615/gclk.o ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1234282992/system_interrupt.o: ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c  .generated_files/flags/Release/9ea03d15603d4315f66b78796ab8c04597e89940 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1234282992" 
 	@${RM} ${OBJECTDIR}/_ext/1234282992/system_interrupt.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1234282992/system_interrupt.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1234282992/system_interrupt.o.d" -o ${OBJECTDIR}/_ext/1234282992/system_interrupt.o ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1234282992/system_interrupt.o.d" -o ${OBJECTDIR}/_ext/1234282992/system_interrupt.o ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/980481618/pinmux.o: ../src/ASF/sam0/drivers/system/pinmux/pinmux.c  .generated_files/flags/Release/e9aa921118851cb0a374bdc371c186335f50dda1 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/980481618" 
 	@${RM} ${OBJECTDIR}/_ext/980481618/pinmux.o.d 
 	@${RM} ${OBJECTDIR}/_ext/980481618/pinmux.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/980481618/pinmux.o.d" -o ${OBJECTDIR}/_ext/980481618/pinmux.o ../src/ASF/sam0/drivers/system/pinmux/pinmux.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/980481618/pinmux.o.d" -o ${OBJECTDIR}/_ext/980481618/pinmux.o ../src/ASF/sam0/drivers/system/pinmux/pinmux.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/227780132/system.o: ../src/ASF/sam0/drivers/system/system.c  .generated_files/flags/Release/cdbefdef41c0d70eef648c48db5c12249a1f7483 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/227780132" 
 	@${RM} ${OBJECTDIR}/_ext/227780132/system.o.d 
 	@${RM} ${OBJECTDIR}/_ext/227780132/system.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/227780132/system.o.d" -o ${OBJECTDIR}/_ext/227780132/system.o ../src/ASF/sam0/drivers/system/system.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/227780132/system.o.d" -o ${OBJECTDIR}/_ext/227780132/system.o ../src/ASF/sam0/drivers/system/system.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1126068005/startup_samd21.o: ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c  .generated_files/flags/Release/4bedeca77719ab48be8c69e7d986dddaacdca975 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1126068005" 
 	@${RM} ${OBJECTDIR}/_ext/1126068005/startup_samd21.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1126068005/startup_samd21.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1126068005/startup_samd21.o.d" -o ${OBJECTDIR}/_ext/1126068005/startup_samd21.o ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1126068005/startup_samd21.o.d" -o ${OBJECTDIR}/_ext/1126068005/startup_samd21.o ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/540691939/system_samd21.o: ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c  .generated_files/flags/Release/4e2e975d8edb8ad7cdf119f0c5c7aa879715d0dc .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/540691939" 
 	@${RM} ${OBJECTDIR}/_ext/540691939/system_samd21.o.d 
 	@${RM} ${OBJECTDIR}/_ext/540691939/system_samd21.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/540691939/system_samd21.o.d" -o ${OBJECTDIR}/_ext/540691939/system_samd21.o ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/540691939/system_samd21.o.d" -o ${OBJECTDIR}/_ext/540691939/system_samd21.o ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1284275751/syscalls.o: ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c  .generated_files/flags/Release/6b33da34c65ab5a3bddc57fce8e9df49eaefe4f4 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1284275751" 
 	@${RM} ${OBJECTDIR}/_ext/1284275751/syscalls.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1284275751/syscalls.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1284275751/syscalls.o.d" -o ${OBJECTDIR}/_ext/1284275751/syscalls.o ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1284275751/syscalls.o.d" -o ${OBJECTDIR}/_ext/1284275751/syscalls.o ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1360937237/main.o: ../src/main.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
 	@${RM} ${OBJECTDIR}/_ext/1360937237/main.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1360937237/main.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/main.o.d" -o ${OBJECTDIR}/_ext/1360937237/main.o ../src/main.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/main.o.d" -o ${OBJECTDIR}/_ext/1360937237/main.o ../src/main.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/i2c_mestre.o: ../src/i2c_mestre.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/i2c_mestre.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/i2c_mestre.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/i2c_mestre.o.d" -o ${OBJECTDIR}/_ext/1360937237/i2c_mestre.o ../src/i2c_mestre.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o: ../src/ponte_protothreads.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o.d" -o ${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o ../src/ponte_protothreads.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/receptor_quadros.o: ../src/receptor_quadros.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/receptor_quadros.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/receptor_quadros.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/receptor_quadros.o.d" -o ${OBJECTDIR}/_ext/1360937237/receptor_quadros.o ../src/receptor_quadros.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/diario.o: ../src/diario.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/diario.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/diario.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/diario.o.d" -o ${OBJECTDIR}/_ext/1360937237/diario.o ../src/diario.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/console.o: ../src/console.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/console.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/console.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/console.o.d" -o ${OBJECTDIR}/_ext/1360937237/console.o ../src/console.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/crc_dma.o: ../src/crc_dma.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/crc_dma.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/crc_dma.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/crc_dma.o.d" -o ${OBJECTDIR}/_ext/1360937237/crc_dma.o ../src/crc_dma.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/pinos.o: ../src/pinos.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/pinos.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/pinos.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/pinos.o.d" -o ${OBJECTDIR}/_ext/1360937237/pinos.o ../src/pinos.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/bordas.o: ../src/bordas.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/bordas.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/bordas.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/bordas.o.d" -o ${OBJECTDIR}/_ext/1360937237/bordas.o ../src/bordas.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/sono_rtc.o: ../src/sono_rtc.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/sono_rtc.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/sono_rtc.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/sono_rtc.o.d" -o ${OBJECTDIR}/_ext/1360937237/sono_rtc.o ../src/sono_rtc.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/padrao_led.o: ../src/padrao_led.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/padrao_led.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/padrao_led.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/padrao_led.o.d" -o ${OBJECTDIR}/_ext/1360937237/padrao_led.o ../src/padrao_led.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/atualizacao.o: ../src/atualizacao.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/atualizacao.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/atualizacao.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/atualizacao.o.d" -o ${OBJECTDIR}/_ext/1360937237/atualizacao.o ../src/atualizacao.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/mtb.o: ../src/mtb.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/mtb.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/mtb.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/mtb.o.d" -o ${OBJECTDIR}/_ext/1360937237/mtb.o ../src/mtb.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/tempo_us.o: ../src/tempo_us.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/tempo_us.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/tempo_us.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/tempo_us.o.d" -o ${OBJECTDIR}/_ext/1360937237/tempo_us.o ../src/tempo_us.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/vigia_wdt.o: ../src/vigia_wdt.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/vigia_wdt.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/vigia_wdt.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/vigia_wdt.o.d" -o ${OBJECTDIR}/_ext/1360937237/vigia_wdt.o ../src/vigia_wdt.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/retida.o: ../src/retida.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/retida.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/retida.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/retida.o.d" -o ${OBJECTDIR}/_ext/1360937237/retida.o ../src/retida.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/usb_cdc.o: ../src/usb_cdc.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/usb_cdc.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/usb_cdc.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/usb_cdc.o.d" -o ${OBJECTDIR}/_ext/1360937237/usb_cdc.o ../src/usb_cdc.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/fila_nvm.o: ../src/fila_nvm.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/fila_nvm.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/fila_nvm.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/fila_nvm.o.d" -o ${OBJECTDIR}/_ext/1360937237/fila_nvm.o ../src/fila_nvm.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/telemetria.o: ../src/telemetria.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/telemetria.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/telemetria.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/telemetria.o.d" -o ${OBJECTDIR}/_ext/1360937237/telemetria.o ../src/telemetria.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/spi_dma.o: ../src/spi_dma.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/spi_dma.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/spi_dma.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/spi_dma.o.d" -o ${OBJECTDIR}/_ext/1360937237/spi_dma.o ../src/spi_dma.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/filtro_dsp.o: ../src/filtro_dsp.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/filtro_dsp.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/filtro_dsp.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/filtro_dsp.o.d" -o ${OBJECTDIR}/_ext/1360937237/filtro_dsp.o ../src/filtro_dsp.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/perfil_clock.o: ../src/perfil_clock.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/perfil_clock.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/perfil_clock.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/perfil_clock.o.d" -o ${OBJECTDIR}/_ext/1360937237/perfil_clock.o ../src/perfil_clock.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/clock_adiado.o: ../src/clock_adiado.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/clock_adiado.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/clock_adiado.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/clock_adiado.o.d" -o ${OBJECTDIR}/_ext/1360937237/clock_adiado.o ../src/clock_adiado.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/amostragem.o: ../src/amostragem.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/amostragem.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/amostragem.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/amostragem.o.d" -o ${OBJECTDIR}/_ext/1360937237/amostragem.o ../src/amostragem.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/eventos.o: ../src/eventos.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/eventos.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/eventos.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/eventos.o.d" -o ${OBJECTDIR}/_ext/1360937237/eventos.o ../src/eventos.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/dma.o: ../src/dma.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/dma.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/dma.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/dma.o.d" -o ${OBJECTDIR}/_ext/1360937237/dma.o ../src/dma.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/uart_dma.o: ../src/uart_dma.c  .generated_files/flags/Release/6cc95ff643be4b02c98616f4c9cd96966386964 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/uart_dma.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/uart_dma.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus -g -D__DEBUG  -gdwarf-2  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/uart_dma.o.d" -o ${OBJECTDIR}/_ext/1360937237/uart_dma.o ../src/uart_dma.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 else
-${OBJECTDIR}/_ext/1360937237/cpu-port.o: ../src/cpu-port.c  .generated_files/flags/Release/52dc021fbef5b869f7f2e73d435213d60d12ed26 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
-	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
-	@${RM} ${OBJECTDIR}/_ext/1360937237/cpu-port.o.d 
-	@${RM} ${OBJECTDIR}/_ext/1360937237/cpu-port.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/cpu-port.o.d" -o ${OBJECTDIR}/_ext/1360937237/cpu-port.o ../src/cpu-port.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+${OBJECTDIR}/_ext/852800589/cpu-port.o: ../../portas/cortex_m0_gcc/cpu-port.c  .generated_files/flags/Release/52dc021fbef5b869f7f2e73d435213d60d12ed26 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/852800589" 
+	@${RM} ${OBJECTDIR}/_ext/852800589/cpu-port.o.d 
+	@${RM} ${OBJECTDIR}/_ext/852800589/cpu-port.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/852800589/cpu-port.o.d" -o ${OBJECTDIR}/_ext/852800589/cpu-port.o ../../portas/cortex_m0_gcc/cpu-port.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
-${OBJECTDIR}/_ext/1360937237/rtos.o: ../src/rtos.c  .generated_files/flags/Release/9ec6cac18b0a2a7b3241f5682d822b5520f0e183 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
-	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
-	@${RM} ${OBJECTDIR}/_ext/1360937237/rtos.o.d 
-	@${RM} ${OBJECTDIR}/_ext/1360937237/rtos.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/rtos.o.d" -o ${OBJECTDIR}/_ext/1360937237/rtos.o ../src/rtos.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+${OBJECTDIR}/_ext/1009061190/rtos.o: ../../nucleo/rtos.c  .generated_files/flags/Release/9ec6cac18b0a2a7b3241f5682d822b5520f0e183 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1009061190" 
+	@${RM} ${OBJECTDIR}/_ext/1009061190/rtos.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1009061190/rtos.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1009061190/rtos.o.d" -o ${OBJECTDIR}/_ext/1009061190/rtos.o ../../nucleo/rtos.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o: ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c  .generated_files/flags/Release/e6ab91445c418d4ea0bcd391de752408af641478 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1939168694" 
 	@${RM} ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o.d" -o ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o.d" -o ${OBJECTDIR}/_ext/1939168694/interrupt_sam_nvic.o ../src/ASF/common/utils/interrupt/interrupt_sam_nvic.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1502292737/board_init.o: ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c  .generated_files/flags/Release/549e3064b517bd08421ab55ea6c67fe19af6a4ed .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1502292737" 
 	@${RM} ${OBJECTDIR}/_ext/1502292737/board_init.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1502292737/board_init.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1502292737/board_init.o.d" -o ${OBJECTDIR}/_ext/1502292737/board_init.o ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1502292737/board_init.o.d" -o ${OBJECTDIR}/_ext/1502292737/board_init.o ../src/ASF/sam0/boards/samd21_xplained_pro/board_init.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/876312722/port.o: ../src/ASF/sam0/drivers/port/port.c  .generated_files/flags/Release/9e85ed7caa7a4bd7482d9411a5dfb3b2ec086e1d .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/876312722" 
 	@${RM} ${OBJECTDIR}/_ext/876312722/port.o.d 
 	@${RM} ${OBJECTDIR}/_ext/876312722/port.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/876312722/port.o.d" -o ${OBJECTDIR}/_ext/876312722/port.o ../src/ASF/sam0/drivers/port/port.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/876312722/port.o.d" -o ${OBJECTDIR}/_ext/876312722/port.o ../src/ASF/sam0/drivers/port/port.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/519451615/clock.o: ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c  .generated_files/flags/Release/90702aa6ad065cf171085006969af7717196215 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/519451615" 
 	@${RM} ${OBJECTDIR}/_ext/519451615/clock.o.d 
 	@${RM} ${OBJECTDIR}/_ext/519451615/clock.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/519451615/clock.o.d" -o ${OBJECTDIR}/_ext/519451615/clock.o ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/519451615/clock.o.d" -o ${OBJECTDIR}/_ext/519451615/clock.o ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/clock.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/519451615/gclk.o: ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c  .generated_files/flags/Release/e265e7c95b342e95f2cf3043c6e6b53e33864855 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/519451615" 
 	@${RM} ${OBJECTDIR}/_ext/519451615/gclk.o.d 
 	@${RM} ${OBJECTDIR}/_ext/519451615/gclk.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/519451615/gclk.o.d" -o ${OBJECTDIR}/_ext/519451615/gclk.o ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/519451615/gclk.o.d" -o ${OBJECTDIR}/_ext/519451615/gclk.o ../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da/gclk.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1234282992/system_interrupt.o: ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c  .generated_files/flags/Release/310007ef22e1742f76da9a32c566508d69261a4a .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1234282992" 
 	@${RM} ${OBJECTDIR}/_ext/1234282992/system_interrupt.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1234282992/system_interrupt.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1234282992/system_interrupt.o.d" -o ${OBJECTDIR}/_ext/1234282992/system_interrupt.o ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1234282992/system_interrupt.o.d" -o ${OBJECTDIR}/_ext/1234282992/system_interrupt.o ../src/ASF/sam0/drivers/system/interrupt/system_interrupt.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/980481618/pinmux.o: ../src/ASF/sam0/drivers/system/pinmux/pinmux.c  .generated_files/flags/Release/e3c9192ffab153d2a9549f84134eadcd58d93f69 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/980481618" 
 	@${RM} ${OBJECTDIR}/_ext/980481618/pinmux.o.d 
 	@${RM} ${OBJECTDIR}/_ext/980481618/pinmux.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/980481618/pinmux.o.d" -o ${OBJECTDIR}/_ext/980481618/pinmux.o ../src/ASF/sam0/drivers/system/pinmux/pinmux.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/980481618/pinmux.o.d" -o ${OBJECTDIR}/_ext/980481618/pinmux.o ../src/ASF/sam0/drivers/system/pinmux/pinmux.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/227780132/system.o: ../src/ASF/sam0/drivers/system/system.c  .generated_files/flags/Release/20c2b84085b8e439291627cd4b265919d89a1685 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/227780132" 
 	@${RM} ${OBJECTDIR}/_ext/227780132/system.o.d 
 	@${RM} ${OBJECTDIR}/_ext/227780132/system.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/227780132/system.o.d" -o ${OBJECTDIR}/_ext/227780132/system.o ../src/ASF/sam0/drivers/system/system.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/227780132/system.o.d" -o ${OBJECTDIR}/_ext/227780132/system.o ../src/ASF/sam0/drivers/system/system.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1126068005/startup_samd21.o: ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c  .generated_files/flags/Release/48c99b9ebfb9741a6bc5a41d3596500013143260 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1126068005" 
 	@${RM} ${OBJECTDIR}/_ext/1126068005/startup_samd21.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1126068005/startup_samd21.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1126068005/startup_samd21.o.d" -o ${OBJECTDIR}/_ext/1126068005/startup_samd21.o ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1126068005/startup_samd21.o.d" -o ${OBJECTDIR}/_ext/1126068005/startup_samd21.o ../src/ASF/sam0/utils/cmsis/samd21/source/gcc/startup_samd21.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/540691939/system_samd21.o: ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c  .generated_files/flags/Release/7a8302c0a7a0e55a9a40a0fa810ca2ee0b705ff8 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/540691939" 
 	@${RM} ${OBJECTDIR}/_ext/540691939/system_samd21.o.d 
 	@${RM} ${OBJECTDIR}/_ext/540691939/system_samd21.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/540691939/system_samd21.o.d" -o ${OBJECTDIR}/_ext/540691939/system_samd21.o ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/540691939/system_samd21.o.d" -o ${OBJECTDIR}/_ext/540691939/system_samd21.o ../src/ASF/sam0/utils/cmsis/samd21/source/system_samd21.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1284275751/syscalls.o: ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c  .generated_files/flags/Release/98380eda6eac907667b728668dddf5fa0c9fd8a5 .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1284275751" 
 	@${RM} ${OBJECTDIR}/_ext/1284275751/syscalls.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1284275751/syscalls.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1284275751/syscalls.o.d" -o ${OBJECTDIR}/_ext/1284275751/syscalls.o ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1284275751/syscalls.o.d" -o ${OBJECTDIR}/_ext/1284275751/syscalls.o ../src/ASF/sam0/utils/syscalls/gcc/syscalls.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 ${OBJECTDIR}/_ext/1360937237/main.o: ../src/main.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
 	@${RM} ${OBJECTDIR}/_ext/1360937237/main.o.d 
 	@${RM} ${OBJECTDIR}/_ext/1360937237/main.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/main.o.d" -o ${OBJECTDIR}/_ext/1360937237/main.o ../src/main.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/main.o.d" -o ${OBJECTDIR}/_ext/1360937237/main.o ../src/main.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/i2c_mestre.o: ../src/i2c_mestre.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/i2c_mestre.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/i2c_mestre.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/i2c_mestre.o.d" -o ${OBJECTDIR}/_ext/1360937237/i2c_mestre.o ../src/i2c_mestre.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o: ../src/ponte_protothreads.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o.d" -o ${OBJECTDIR}/_ext/1360937237/ponte_protothreads.o ../src/ponte_protothreads.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/receptor_quadros.o: ../src/receptor_quadros.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/receptor_quadros.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/receptor_quadros.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/receptor_quadros.o.d" -o ${OBJECTDIR}/_ext/1360937237/receptor_quadros.o ../src/receptor_quadros.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/diario.o: ../src/diario.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/diario.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/diario.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/diario.o.d" -o ${OBJECTDIR}/_ext/1360937237/diario.o ../src/diario.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/console.o: ../src/console.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/console.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/console.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/console.o.d" -o ${OBJECTDIR}/_ext/1360937237/console.o ../src/console.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/crc_dma.o: ../src/crc_dma.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/crc_dma.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/crc_dma.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/crc_dma.o.d" -o ${OBJECTDIR}/_ext/1360937237/crc_dma.o ../src/crc_dma.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/pinos.o: ../src/pinos.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/pinos.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/pinos.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/pinos.o.d" -o ${OBJECTDIR}/_ext/1360937237/pinos.o ../src/pinos.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/bordas.o: ../src/bordas.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/bordas.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/bordas.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/bordas.o.d" -o ${OBJECTDIR}/_ext/1360937237/bordas.o ../src/bordas.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/sono_rtc.o: ../src/sono_rtc.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/sono_rtc.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/sono_rtc.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/sono_rtc.o.d" -o ${OBJECTDIR}/_ext/1360937237/sono_rtc.o ../src/sono_rtc.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/padrao_led.o: ../src/padrao_led.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/padrao_led.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/padrao_led.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/padrao_led.o.d" -o ${OBJECTDIR}/_ext/1360937237/padrao_led.o ../src/padrao_led.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/atualizacao.o: ../src/atualizacao.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/atualizacao.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/atualizacao.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/atualizacao.o.d" -o ${OBJECTDIR}/_ext/1360937237/atualizacao.o ../src/atualizacao.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/mtb.o: ../src/mtb.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/mtb.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/mtb.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/mtb.o.d" -o ${OBJECTDIR}/_ext/1360937237/mtb.o ../src/mtb.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/tempo_us.o: ../src/tempo_us.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/tempo_us.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/tempo_us.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/tempo_us.o.d" -o ${OBJECTDIR}/_ext/1360937237/tempo_us.o ../src/tempo_us.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/vigia_wdt.o: ../src/vigia_wdt.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/vigia_wdt.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/vigia_wdt.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/vigia_wdt.o.d" -o ${OBJECTDIR}/_ext/1360937237/vigia_wdt.o ../src/vigia_wdt.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/retida.o: ../src/retida.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/retida.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/retida.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/retida.o.d" -o ${OBJECTDIR}/_ext/1360937237/retida.o ../src/retida.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/usb_cdc.o: ../src/usb_cdc.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/usb_cdc.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/usb_cdc.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/usb_cdc.o.d" -o ${OBJECTDIR}/_ext/1360937237/usb_cdc.o ../src/usb_cdc.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/fila_nvm.o: ../src/fila_nvm.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/fila_nvm.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/fila_nvm.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/fila_nvm.o.d" -o ${OBJECTDIR}/_ext/1360937237/fila_nvm.o ../src/fila_nvm.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/telemetria.o: ../src/telemetria.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/telemetria.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/telemetria.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/telemetria.o.d" -o ${OBJECTDIR}/_ext/1360937237/telemetria.o ../src/telemetria.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/spi_dma.o: ../src/spi_dma.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/spi_dma.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/spi_dma.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/spi_dma.o.d" -o ${OBJECTDIR}/_ext/1360937237/spi_dma.o ../src/spi_dma.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/filtro_dsp.o: ../src/filtro_dsp.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/filtro_dsp.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/filtro_dsp.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/filtro_dsp.o.d" -o ${OBJECTDIR}/_ext/1360937237/filtro_dsp.o ../src/filtro_dsp.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/perfil_clock.o: ../src/perfil_clock.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/perfil_clock.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/perfil_clock.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/perfil_clock.o.d" -o ${OBJECTDIR}/_ext/1360937237/perfil_clock.o ../src/perfil_clock.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/clock_adiado.o: ../src/clock_adiado.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/clock_adiado.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/clock_adiado.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/clock_adiado.o.d" -o ${OBJECTDIR}/_ext/1360937237/clock_adiado.o ../src/clock_adiado.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/amostragem.o: ../src/amostragem.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/amostragem.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/amostragem.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/amostragem.o.d" -o ${OBJECTDIR}/_ext/1360937237/amostragem.o ../src/amostragem.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/eventos.o: ../src/eventos.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/eventos.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/eventos.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/eventos.o.d" -o ${OBJECTDIR}/_ext/1360937237/eventos.o ../src/eventos.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/dma.o: ../src/dma.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/dma.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/dma.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/dma.o.d" -o ${OBJECTDIR}/_ext/1360937237/dma.o ../src/dma.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
+
+${OBJECTDIR}/_ext/1360937237/uart_dma.o: ../src/uart_dma.c  .generated_files/flags/Release/3f1b2f1a92cae568d4a9a40192eead6bf0a9291f .generated_files/flags/Release/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/_ext/1360937237" 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/uart_dma.o.d 
+	@${RM} ${OBJECTDIR}/_ext/1360937237/uart_dma.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -mcpu=cortex-m0plus  -x c -c -D__$(MP_PROCESSOR_OPTION)__  -mthumb   -Os -ffunction-sections -mlong-calls -DNDEBUG -DBOARD=SAMD21_XPLAINED_PRO -D__SAMD21J18A__ -DARM_MATH_CM0PLUS=true -I "../src/ASF/sam0/utils/header_files" -I "../src/ASF/sam0/drivers/system/power/power_sam_d_r" -I "../src/ASF/common/utils" -I "../src/ASF/sam0/drivers/system/pinmux" -I "../src/ASF/sam0/drivers/system/power" -I "../src/ASF/sam0/drivers/system/reset/reset_sam_d_r" -I "../src/ASF/common/boards" -I "../src/ASF/sam0/drivers/port" -I "../src/ASF/sam0/boards" -I "../src/ASF/sam0/utils" -I "../src/ASF/thirdparty/CMSIS/Include" -I "../src/config" -I "../src/ASF/thirdparty/CMSIS/Lib/GCC" -I "../src/ASF/sam0/drivers/system/reset" -I "../src/ASF/sam0/drivers/system/interrupt/system_interrupt_samd21" -I "../src/ASF/sam0/boards/samd21_xplained_pro" -I "../src" -I "../../nucleo" -I "../../portas/cortex_m0_gcc" -I "../src/ASF/sam0/utils/preprocessor" -I "../src/ASF/sam0/utils/cmsis/samd21/include" -I "../src/ASF/sam0/drivers/system" -I "../src/ASF/sam0/drivers/system/clock/clock_samd21_r21_da" -I "../src/ASF/sam0/utils/cmsis/samd21/source" -I "../src/ASF/sam0/drivers/system/clock" -I "../src/ASF/sam0/drivers/system/interrupt" -Wall -MP -MMD -MF "${OBJECTDIR}/_ext/1360937237/uart_dma.o.d" -o ${OBJECTDIR}/_ext/1360937237/uart_dma.o ../src/uart_dma.c  -DXPRJ_Release=$(CND_CONF)  $(COMPARISON_BUILD)  -pipe -fno-strict-aliasing -Wall -Wstrict-prototypes -Wmissing-prototypes -Werror-implicit-function-declaration -Wpointer-arith -std=gnu99 -ffunction-sections -fdata-sections -Wchar-subscripts -Wcomment -Wformat=2 -Wimplicit-int -Wmain -Wparentheses -Wsequence-point -Wreturn-type -Wswitch -Wtrigraphs -Wunused -Wuninitialized -Wunknown-pragmas -Wfloat-equal -Wundef -Wshadow -Wbad-function-cast -Wwrite-strings -Wsign-compare -Waggregate-return  -Wmissing-declarations -Wformat -Wmissing-format-attribute -Wno-deprecated-declarations -Wpacked -Wredundant-decls -Wnested-externs -Wlong-long -Wunreachable-code -Wcast-align --param max-inline-insns-single=500 -fdata-sections -fcallgraph-info=su
 	
 endif
 
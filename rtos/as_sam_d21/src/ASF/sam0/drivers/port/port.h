@@ -534,6 +534,138 @@ static inline void port_pin_toggle_output_level(
 
 /** @} */
 
+#if defined(PORT_IOBUS) || defined(__DOXYGEN__)
+
+/** \name Fast State Writing through the Single-Cycle IOBUS
+ *
+ *  The PORT registers are also mapped on the Cortex-M0+ single-cycle I/O
+ *  port (IOBUS). A store to this alias completes in one clock cycle,
+ *  instead of going through the AHB-APB bridge, which is several times
+ *  faster for bit-banged protocols, trace pins and short interrupt
+ *  handlers.
+ *
+ *  \note The IOBUS is only reachable by the CPU: the DMA and the other bus
+ *        masters must keep using the regular PORT address.
+ *
+ * @{
+ */
+
+/**
+ *  \brief Retrieves the IOBUS alias of the PORT group of a given GPIO pin.
+ *
+ *  \param[in] gpio_pin  Index of the GPIO pin to convert
+ *
+ *  \return IOBUS address of the associated PORT group.
+ */
+static inline PortGroup* port_iobus_get_group_from_gpio_pin(
+		const uint8_t gpio_pin)
+{
+	return &(PORT_IOBUS->Group[gpio_pin / 32]);
+}
+
+/**
+ *  \brief Sets a group of output pins to high, in a single store.
+ *
+ *  \param[out] port  IOBUS base of the PORT group to write to
+ *  \param[in]  mask  Mask of the port pin(s) to set
+ */
+static inline void port_iobus_group_set(
+		PortGroup *const port,
+		const uint32_t mask)
+{
+	port->OUTSET.reg = mask;
+}
+
+/**
+ *  \brief Sets a group of output pins to low, in a single store.
+ *
+ *  \param[out] port  IOBUS base of the PORT group to write to
+ *  \param[in]  mask  Mask of the port pin(s) to clear
+ */
+static inline void port_iobus_group_clear(
+		PortGroup *const port,
+		const uint32_t mask)
+{
+	port->OUTCLR.reg = mask;
+}
+
+/**
+ *  \brief Toggles a group of output pins, in a single store.
+ *
+ *  \param[out] port  IOBUS base of the PORT group to write to
+ *  \param[in]  mask  Mask of the port pin(s) to toggle
+ */
+static inline void port_iobus_group_toggle(
+		PortGroup *const port,
+		const uint32_t mask)
+{
+	port->OUTTGL.reg = mask;
+}
+
+/**
+ *  \brief Writes a value to a parallel bus of output pins.
+ *
+ *  All the pins in the mask change on the same clock edge, which two
+ *  separate OUTSET/OUTCLR stores can not guarantee. The pins outside the
+ *  mask keep their levels.
+ *
+ *  \note This is a read-modify-write of the OUT register: if an interrupt
+ *        also writes pins of the same group, call it with interrupts
+ *        disabled.
+ *
+ *  \param[out] port   IOBUS base of the PORT group to write to
+ *  \param[in]  mask   Mask of the bus pins
+ *  \param[in]  value  Bus value, already aligned to the mask
+ */
+static inline void port_iobus_group_write(
+		PortGroup *const port,
+		const uint32_t mask,
+		const uint32_t value)
+{
+	port->OUT.reg = (port->OUT.reg & ~mask) | (value & mask);
+}
+
+/**
+ *  \brief Sets the state of an output pin through the IOBUS.
+ *
+ *  Same as \ref port_pin_set_output_level(), in a single-cycle store.
+ *
+ *  \param[in] gpio_pin  Index of the GPIO pin to write to
+ *  \param[in] level     Logical level to set the given pin to
+ */
+static inline void port_iobus_pin_set_output_level(
+		const uint8_t gpio_pin,
+		const bool level)
+{
+	PortGroup *const port_base = port_iobus_get_group_from_gpio_pin(gpio_pin);
+	uint32_t pin_mask  = (1UL << (gpio_pin % 32));
+
+	if (level) {
+		port_base->OUTSET.reg = pin_mask;
+	} else {
+		port_base->OUTCLR.reg = pin_mask;
+	}
+}
+
+/**
+ *  \brief Toggles the state of an output pin through the IOBUS.
+ *
+ *  Same as \ref port_pin_toggle_output_level(), in a single-cycle store.
+ *
+ *  \param[in] gpio_pin  Index of the GPIO pin to toggle
+ */
+static inline void port_iobus_pin_toggle_output_level(
+		const uint8_t gpio_pin)
+{
+	PortGroup *const port_base = port_iobus_get_group_from_gpio_pin(gpio_pin);
+
+	port_base->OUTTGL.reg = (1UL << (gpio_pin % 32));
+}
+
+/** @} */
+
+#endif
+
 #ifdef FEATURE_PORT_INPUT_EVENT
 
 /** \name Port Input Event
@@ -126,6 +126,12 @@ void I2S_Handler             ( void ) __attribute__ ((weak, alias("Dummy_Handler
 void AC1_Handler             ( void ) __attribute__ ((weak, alias("Dummy_Handler")));
 #endif
 
+/* Copy of the exception table in SRAM, used through VTOR. Exception entry
+   then fetches the handler address without flash wait states. VTOR needs
+   the table aligned to its size rounded up to a power of two */
+__attribute__ ((section(".ram_vectors"), aligned(256)))
+static DeviceVectors ram_exception_table;
+
 /* Exception Table */
 __attribute__ ((section(".vectors")))
 const DeviceVectors exception_table = {
@@ -236,24 +242,45 @@ void Reset_Handler(void)
 {
         uint32_t *pSrc, *pDest;
 
-        /* Initialize the relocate segment */
+        /* Initialize the relocate segment, four words per iteration
+           (the linker script aligns the segment limits to one word) */
         pSrc = &_etext;
         pDest = &_srelocate;
 
         if (pSrc != pDest) {
+                for (; pDest + 4 <= &_erelocate; pDest += 4, pSrc += 4) {
+                        uint32_t w0 = pSrc[0], w1 = pSrc[1], w2 = pSrc[2], w3 = pSrc[3];
+                        pDest[0] = w0;
+                        pDest[1] = w1;
+                        pDest[2] = w2;
+                        pDest[3] = w3;
+                }
                 for (; pDest < &_erelocate;) {
                         *pDest++ = *pSrc++;
                 }
         }
 
-        /* Clear the zero segment */
-        for (pDest = &_szero; pDest < &_ezero;) {
+        /* Clear the zero segment, four words per iteration. Variables in
+           the .noinit section are placed after it and are not cleared */
+        for (pDest = &_szero; pDest + 4 <= &_ezero; pDest += 4) {
+                pDest[0] = 0;
+                pDest[1] = 0;
+                pDest[2] = 0;
+                pDest[3] = 0;
+        }
+        for (; pDest < &_ezero;) {
                 *pDest++ = 0;
         }
 
-        /* Set the vector table base address */
-        pSrc = (uint32_t *) & _sfixed;
-        SCB->VTOR = ((uint32_t) pSrc & SCB_VTOR_TBLOFF_Msk);
+        /* Copy the vector table to SRAM and set the vector table base
+           address to the copy. Handlers in the .ramfunc section (copied
+           above with the relocate segment) run without flash wait states */
+        pSrc = (uint32_t *) &exception_table;
+        for (pDest = (uint32_t *) &ram_exception_table;
+                        pDest < (uint32_t *) (&ram_exception_table + 1);) {
+                *pDest++ = *pSrc++;
+        }
+        SCB->VTOR = ((uint32_t) &ram_exception_table & SCB_VTOR_TBLOFF_Msk);
 
         /* Change default QOS values to have the best performance and correct USB behaviour */
         SBMATRIX->SFR[SBMATRIX_SLAVE_HMCRAMC0].reg = 2;
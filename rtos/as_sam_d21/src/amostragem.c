@@ -0,0 +1,234 @@
+/*
+ * amostragem.c
+ *
+ * Amostragem periodica do ADC sem a CPU:
+ *
+ *   TC3 (estouro) --EVSYS--> ADC (inicio de conversao)
+ *   ADC (resultado pronto) --gatilho do DMAC--> lote atual na RAM
+ *   DMAC (fim do lote) --interrupcao--> marca de tempo e notificacao da tarefa
+ *
+ * Ha uma interrupcao por lote, e nao por amostra, e nenhuma tarefa precisa 
+ * acordar para iniciar as conversoes. Os lotes formam um anel de 
+ * descritores encadeados, que o DMAC percorre sem parar.
+ */
+
+#include <asf.h>
+#include "dma.h"
+#include "eventos.h"
+#include "perfil_clock.h"
+#include "pinos.h"
+#include "amostragem.h"
+
+/* pino do ADC: EXT1 da SAM D21 Xplained Pro (PB00, AIN8) */
+#define PINO_ADC			EXT1_ADC_0_PIN
+#define MUX_PINO_ADC		(EXT1_ADC_0_PINMUX & 0xFFFF)
+#define ENTRADA_ADC			EXT1_ADC_0_CHANNEL
+
+/* clock do TC3 apos o divisor, limita a frequencia minima a ~12Hz em 48MHz */
+#define DIVISOR_TC			64
+
+/* o descritor do primeiro lote e o do canal em dma_descritores */
+COMPILER_ALIGNED(16) static DmacDescriptor descritores_lotes[AMOSTRAGEM_LOTES - 1];
+
+NAO_INICIALIZADA static uint16_t lotes[AMOSTRAGEM_LOTES][AMOSTRAGEM_TAM_LOTE];
+static tick_t marcas_lotes[AMOSTRAGEM_LOTES];
+
+/* conta os lotes: o lote n fica em lotes[n % AMOSTRAGEM_LOTES] */
+static volatile uint8_t lotes_completos = 0;
+static uint8_t lotes_lidos = 0;
+static uint16_t lotes_perdidos = 0;
+static tick_t marca_lida = 0;
+static uint32_t frequencia_amostras;
+static uint8_t tarefa_lotes;
+
+static void FimDeLote(void)
+{
+	if(DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL)
+	{
+		DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+		marcas_lotes[lotes_completos % AMOSTRAGEM_LOTES] = ObtemMarcasDeTempo();
+		lotes_completos++;
+		TarefaNotifica(tarefa_lotes, 0, NOTIFICA_INCREMENTA);
+	}
+}
+
+static void IniciaAdc(void)
+{
+	struct system_gclk_chan_config config_clock;
+#if !PINOS_TABELA
+	struct system_pinmux_config config_pino;
+#endif
+	uint32_t bias, linearidade;
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_ADC);
+
+	system_gclk_chan_get_config_defaults(&config_clock);
+	config_clock.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(ADC_GCLK_ID, &config_clock);
+	system_gclk_chan_enable(ADC_GCLK_ID);
+
+#if !PINOS_TABELA		/* senao, ja configurado na partida (pinos.h) */
+	system_pinmux_get_config_defaults(&config_pino);
+	config_pino.mux_position = MUX_PINO_ADC;
+	config_pino.direction = SYSTEM_PINMUX_PIN_DIR_INPUT;
+	config_pino.input_pull = SYSTEM_PINMUX_PIN_PULL_NONE;
+	system_pinmux_pin_set_config(PINO_ADC, &config_pino);
+#endif
+
+	ADC->CTRLA.reg = ADC_CTRLA_SWRST;
+	while(ADC->CTRLA.reg & ADC_CTRLA_SWRST) {}
+
+	/* calibracao de fabrica, gravada na linha de calibracao da NVM */
+	bias = (*((uint32_t *)ADC_FUSES_BIASCAL_ADDR) & ADC_FUSES_BIASCAL_Msk) >> ADC_FUSES_BIASCAL_Pos;
+	linearidade = (*((uint32_t *)ADC_FUSES_LINEARITY_0_ADDR) & ADC_FUSES_LINEARITY_0_Msk) >> ADC_FUSES_LINEARITY_0_Pos;
+	linearidade |= ((*((uint32_t *)ADC_FUSES_LINEARITY_1_ADDR) & ADC_FUSES_LINEARITY_1_Msk) >> ADC_FUSES_LINEARITY_1_Pos) << 5;
+	ADC->CALIB.reg = ADC_CALIB_BIAS_CAL(bias) | ADC_CALIB_LINEARITY_CAL(linearidade);
+
+	/* 12 bits, referencia VDDANA/2 com ganho 1/2 (faixa de 0 a VDDANA), 
+	   clock de 48MHz/32 = 1,5MHz, conversao iniciada pelo evento */
+	ADC->REFCTRL.reg = ADC_REFCTRL_REFSEL_INTVCC1;
+	ADC->CTRLB.reg = ADC_CTRLB_PRESCALER_DIV32 | ADC_CTRLB_RESSEL_12BIT;
+	while(ADC->STATUS.reg & ADC_STATUS_SYNCBUSY) {}
+	ADC->INPUTCTRL.reg = ADC_INPUTCTRL_MUXPOS(ENTRADA_ADC) | ADC_INPUTCTRL_MUXNEG_GND | ADC_INPUTCTRL_GAIN_DIV2;
+	while(ADC->STATUS.reg & ADC_STATUS_SYNCBUSY) {}
+	ADC->EVCTRL.reg = ADC_EVCTRL_STARTEI;
+
+	ADC->CTRLA.reg = ADC_CTRLA_ENABLE;
+	while(ADC->STATUS.reg & ADC_STATUS_SYNCBUSY) {}
+}
+
+/* periodo do TC3 pelo clock atual, tambem apos cada troca de perfil de 
+   clock (gancho de perfil_clock.c) */
+static void AjustaPeriodo(uint32_t clock_hz)
+{
+	TcCount16 *const tc = &(TC3->COUNT16);
+
+	tc->CC[0].reg = (uint16_t)((clock_hz / DIVISOR_TC) / frequencia_amostras - 1);
+	while(tc->STATUS.reg & TC_STATUS_SYNCBUSY) {}
+}
+
+static void IniciaTemporizador(void)
+{
+	struct system_gclk_chan_config config_clock;
+	TcCount16 *const tc = &(TC3->COUNT16);
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_TC3);
+
+	system_gclk_chan_get_config_defaults(&config_clock);
+	config_clock.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(TC3_GCLK_ID, &config_clock);
+	system_gclk_chan_enable(TC3_GCLK_ID);
+
+	tc->CTRLA.reg = TC_CTRLA_SWRST;
+	while(tc->CTRLA.reg & TC_CTRLA_SWRST) {}
+
+	/* conta ate CC0 e reinicia (MFRQ): um estouro, e um evento, por periodo */
+	tc->CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER_DIV64;
+	AjustaPeriodo(PerfilClockHz());
+	(void)PerfilClockRegistraGancho(AjustaPeriodo);
+	tc->EVCTRL.reg = TC_EVCTRL_OVFEO;
+
+	tc->CTRLA.reg |= TC_CTRLA_ENABLE;
+	while(tc->STATUS.reg & TC_STATUS_SYNCBUSY) {}
+}
+
+/* liga a cadeia TC3 -> ADC -> DMAC com amostras a frequencia_hz. A tarefa 
+   que chama e a notificada a cada lote */
+void AmostragemInicia(uint32_t frequencia_hz)
+{
+	DmacDescriptor *descritor;
+	uint8_t i;
+
+	tarefa_lotes = tarefa_atual;
+	IniciaAdc();
+
+	/* AMOSTRAGEM_LOTES lotes encadeados em anel, com interrupcao no fim de 
+	   cada um. O ultimo volta ao descritor do canal */
+	DmaIniciaControlador();
+	DmaRegistraTratador(AMOSTRAGEM_CANAL_DMA, FimDeLote);
+
+	descritor = &dma_descritores[AMOSTRAGEM_CANAL_DMA];
+	for(i = 0; i < AMOSTRAGEM_LOTES; i++)
+	{
+		descritor->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_HWORD |
+								DMAC_BTCTRL_DSTINC | DMAC_BTCTRL_BLOCKACT_INT;
+		descritor->BTCNT.reg = AMOSTRAGEM_TAM_LOTE;
+		descritor->SRCADDR.reg = (uint32_t)&ADC->RESULT.reg;
+		descritor->DSTADDR.reg = (uint32_t)&lotes[i][AMOSTRAGEM_TAM_LOTE];
+		if(i < AMOSTRAGEM_LOTES - 1)
+		{
+			descritor->DESCADDR.reg = (uint32_t)&descritores_lotes[i];
+			descritor = &descritores_lotes[i];
+		}
+		else
+		{
+			descritor->DESCADDR.reg = (uint32_t)&dma_descritores[AMOSTRAGEM_CANAL_DMA];
+		}
+	}
+
+	DMAC->CHID.reg = AMOSTRAGEM_CANAL_DMA;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while(DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST) {}
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(ADC_DMAC_ID_RESRDY) |
+						DMAC_CHCTRLB_TRIGACT_BEAT;
+	DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+
+	/* estouro do TC3 inicia a conversao: caminho assincrono, sem clock */
+	EventosInicia();
+	EventoCanalConfigura(AMOSTRAGEM_CANAL_EVENTO, EVSYS_ID_GEN_TC3_OVF, EVENTO_ASSINCRONO);
+	EventoUsuarioConecta(EVSYS_ID_USER_ADC_START, AMOSTRAGEM_CANAL_EVENTO);
+
+	frequencia_amostras = frequencia_hz;
+	IniciaTemporizador();
+}
+
+/* aguarda o proximo lote completo por ate timeout marcas (ESPERA_INFINITA 
+   para sempre), em ordem. Retorna o lote, valido ate o DMAC voltar a ele 
+   (no minimo o tempo de um lote), ou 0 se o tempo esgotou. Se a tarefa 
+   atrasou mais que o anel, pula para o lote mais antigo ainda intacto e 
+   conta os sobrescritos em AmostragemLotesPerdidos */
+const uint16_t* AmostragemAguardaLote(tick_t timeout)
+{
+	reg_atomica_t estado;
+	uint8_t atraso, indice;
+
+	/* uma notificacao de lote ja lido acorda sem lote novo: espera de novo, 
+	   com o limite de tempo reiniciado */
+	while(lotes_lidos == lotes_completos)
+	{
+		if(TarefaAguardaNotificacao(timeout) == 0)
+		{
+			return 0;
+		}
+	}
+
+	REG_ATOMICA_INICIO(estado);
+	atraso = (uint8_t)(lotes_completos - lotes_lidos);
+	if(atraso > AMOSTRAGEM_LOTES - 1)
+	{
+		/* o lote em preenchimento divide o indice com o lote completo mais antigo */
+		lotes_perdidos += atraso - (AMOSTRAGEM_LOTES - 1);
+		lotes_lidos = (uint8_t)(lotes_completos - (AMOSTRAGEM_LOTES - 1));
+	}
+	indice = lotes_lidos % AMOSTRAGEM_LOTES;
+	marca_lida = marcas_lotes[indice];
+	lotes_lidos++;
+	REG_ATOMICA_FIM(estado);
+
+	return lotes[indice];
+}
+
+/* marca de tempo do fim do ultimo lote entregue por AmostragemAguardaLote, 
+   a da sua ultima amostra: a primeira foi AMOSTRAGEM_TAM_LOTE - 1 periodos 
+   de amostragem antes */
+tick_t AmostragemMarcaLote(void)
+{
+	return marca_lida;
+}
+
+/* lotes descartados porque a tarefa nao os leu a tempo */
+uint16_t AmostragemLotesPerdidos(void)
+{
+	return lotes_perdidos;
+}
@@ -0,0 +1,48 @@
+/*
+ * amostragem.h
+ *
+ * Amostragem periodica do ADC sem a CPU: o estouro do TC3 inicia cada 
+ * conversao pelo sistema de eventos e o DMAC copia cada resultado para o 
+ * lote atual, num anel de AMOSTRAGEM_LOTES lotes. A tarefa que chamou 
+ * AmostragemInicia so e notificada (TarefaNotifica) quando um lote de 
+ * AMOSTRAGEM_TAM_LOTE amostras esta completo, e cada lote leva a marca de 
+ * tempo do seu fim (AmostragemMarcaLote).
+ */
+
+
+#ifndef AMOSTRAGEM_H_
+#define AMOSTRAGEM_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* amostras por lote */
+#ifndef AMOSTRAGEM_TAM_LOTE
+#define AMOSTRAGEM_TAM_LOTE		32
+#endif
+
+/* lotes no anel: enquanto o DMAC preenche um, a tarefa pode atrasar ate 
+   AMOSTRAGEM_LOTES - 1 lotes sem perder nenhum. Potencia de 2 */
+#ifndef AMOSTRAGEM_LOTES
+#define AMOSTRAGEM_LOTES		2
+#endif
+
+#if AMOSTRAGEM_LOTES < 2 || AMOSTRAGEM_LOTES > 128 || (AMOSTRAGEM_LOTES & (AMOSTRAGEM_LOTES - 1)) != 0
+#error "AMOSTRAGEM_LOTES deve ser potencia de 2 entre 2 e 128"
+#endif
+
+/* canal do DMAC (menor que DMA_NUMERO_CANAIS, dma.h) e canal do EVSYS */
+#ifndef AMOSTRAGEM_CANAL_DMA
+#define AMOSTRAGEM_CANAL_DMA	1
+#endif
+
+#ifndef AMOSTRAGEM_CANAL_EVENTO
+#define AMOSTRAGEM_CANAL_EVENTO	0
+#endif
+
+void AmostragemInicia(uint32_t frequencia_hz);
+const uint16_t* AmostragemAguardaLote(tick_t timeout);
+tick_t AmostragemMarcaLote(void);
+uint16_t AmostragemLotesPerdidos(void);
+
+#endif /* AMOSTRAGEM_H_ */
@@ -0,0 +1,397 @@
+/*
+ * atualizacao.c
+ *
+ * Atualizacao do programa por diferenca, gravada na flash por uma tarefa
+ * de fundo (ver atualizacao.h).
+ *
+ * A recepcao (AtualizacaoRecebe, na tarefa do receptor) e a unica que
+ * escreve no anel e altera a posicao; a tarefa de fundo e a unica que le o
+ * anel e altera o decodificador. Uma nova diferenca so comeca com o anel
+ * vazio e fora de ATUALIZACAO_RECEBENDO, quando a tarefa de fundo esta
+ * parada no anel com o decodificador zerado.
+ */
+
+#include <asf.h>
+#include <string.h>
+#include "atualizacao.h"
+
+#if ATUALIZACAO
+
+#if (ATUALIZACAO_DESTINO) % ATUALIZACAO_TAM_LINHA != 0
+#error "ATUALIZACAO_DESTINO deve ser o inicio de uma linha da flash"
+#endif
+
+#if (ATUALIZACAO_ANEL) & ((ATUALIZACAO_ANEL) - 1)
+#error "ATUALIZACAO_ANEL deve ser potencia de 2"
+#endif
+
+/* etapas do decodificador */
+#define CABECALHO				0
+#define OPERACAO				1
+#define DESLOCAMENTO			2
+#define INSERCAO				3
+
+/* a pagina so pode ser escrita no buffer de paginas em palavras */
+typedef union
+{
+	uint8_t		bytes[ATUALIZACAO_TAM_PAGINA];
+	uint32_t	palavras[ATUALIZACAO_TAM_PAGINA / 4];
+} buffer_pagina_t;
+
+estatisticas_atualizacao_t estatisticas_atualizacao;
+
+static volatile estado_atualizacao_t estado = ATUALIZACAO_PARADA;
+static uint32_t posicao;					/* proximo byte da diferenca */
+
+static anel_t anel;
+static uint8_t area_anel[ATUALIZACAO_ANEL];
+
+/* pronto do NVMCTRL, liberado pela interrupcao */
+static semaforo_t nvm_pronta = {0,0};
+
+/* decodificador */
+static uint8_t etapa;
+static uint8_t cabecalho[ATUALIZACAO_CABECALHO];
+static uint8_t lidos_cabecalho;
+static uint32_t valor;						/* inteiro sendo lido */
+static uint8_t bits;
+static uint32_t tamanho;					/* da operacao */
+static uint32_t origem;						/* na imagem base */
+static uint32_t tamanho_base, tamanho_novo, crc_novo;
+static buffer_pagina_t pagina;
+static uint32_t gerados;
+
+void NVMCTRL_Handler(void)
+{
+	InterrupcaoEntra();
+	NVMCTRL->INTENCLR.reg = NVMCTRL_INTENCLR_READY;
+	SemaforoLiberaISR(&nvm_pronta);
+	InterrupcaoSai();
+}
+
+/* executa o comando e espera o fim bloqueada: as outras tarefas executam
+   (da RAM, ou da flash depois do comando) */
+static void ComandoNvm(uint32_t endereco, uint32_t comando)
+{
+	while(!(NVMCTRL->INTFLAG.reg & NVMCTRL_INTFLAG_READY));	/* outro usuario (fila_nvm.c) */
+	NVMCTRL->STATUS.reg = NVMCTRL_STATUS_MASK;
+	NVMCTRL->ADDR.reg = endereco / 2;
+	NVMCTRL->CTRLA.reg = (uint16_t)(comando | NVMCTRL_CTRLA_CMDEX_KEY);
+	NVMCTRL->INTENSET.reg = NVMCTRL_INTENSET_READY;
+	SemaforoAguarda(&nvm_pronta);
+}
+
+static uint32_t Le32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* CRC-32 (o de crc_dma.h) sem tabela, de uma linha por vez: cede o
+   processador entre as linhas, no modo cooperativo */
+static uint32_t Crc32(uint32_t endereco, uint32_t n)
+{
+	const uint8_t *p = (const uint8_t *)endereco;
+	uint32_t crc = 0xFFFFFFFFUL;
+	uint32_t i;
+	uint8_t b;
+
+	for(i = 0; i < n; i++)
+	{
+		crc ^= p[i];
+		for(b = 0; b < 8; b++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+		}
+		if((i % ATUALIZACAO_TAM_LINHA) == ATUALIZACAO_TAM_LINHA - 1)
+		{
+			TarefaCede();
+		}
+	}
+	return ~crc;
+}
+
+static void Zera(void)
+{
+	etapa = CABECALHO;
+	lidos_cabecalho = 0;
+	valor = 0;
+	bits = 0;
+	origem = 0;
+	gerados = 0;
+}
+
+static void Termina(estado_atualizacao_t final)
+{
+	Zera();
+	estado = final;
+}
+
+/* grava a pagina montada no fim da imagem nova, apagando a linha antes da
+   primeira pagina dela */
+static void GravaPagina(void)
+{
+	uint32_t deslocamento = (gerados - 1) & ~(uint32_t)(ATUALIZACAO_TAM_PAGINA - 1);
+	uint32_t endereco = ATUALIZACAO_DESTINO + deslocamento;
+	volatile uint32_t *destino = (volatile uint32_t *)endereco;
+	uint8_t i;
+
+	if(deslocamento % ATUALIZACAO_TAM_LINHA == 0)
+	{
+		ComandoNvm(endereco, NVMCTRL_CTRLA_CMD_ER);
+		estatisticas_atualizacao.linhas_apagadas++;
+	}
+	ComandoNvm(endereco, NVMCTRL_CTRLA_CMD_PBC);
+	for(i = 0; i < ATUALIZACAO_TAM_PAGINA / 4; i++)
+	{
+		destino[i] = pagina.palavras[i];
+	}
+	ComandoNvm(endereco, NVMCTRL_CTRLA_CMD_WP);
+	estatisticas_atualizacao.paginas_gravadas++;
+}
+
+/* acrescenta bytes a imagem nova. Retorna 0 se passam do tamanho */
+static uint8_t Emite(const uint8_t *bytes, uint32_t n)
+{
+	uint32_t na_pagina;
+
+	if(n > tamanho_novo - gerados)
+	{
+		return 0;
+	}
+	while(n > 0)
+	{
+		na_pagina = gerados % ATUALIZACAO_TAM_PAGINA;
+		pagina.bytes[na_pagina] = *bytes++;
+		gerados++;
+		n--;
+		if(na_pagina == ATUALIZACAO_TAM_PAGINA - 1)
+		{
+			GravaPagina();
+		}
+	}
+	estatisticas_atualizacao.gerados = gerados;
+	return 1;
+}
+
+/* grava a ultima pagina, completa com bytes apagados, e confere a imagem */
+static void Conclui(void)
+{
+	uint32_t na_pagina = gerados % ATUALIZACAO_TAM_PAGINA;
+
+	if(na_pagina != 0)
+	{
+		memset(&pagina.bytes[na_pagina], 0xFF, ATUALIZACAO_TAM_PAGINA - na_pagina);
+		GravaPagina();
+	}
+	ComandoNvm(0, NVMCTRL_CTRLA_CMD_INVALL);	/* o cache pode ter as paginas apagadas */
+	Termina(Crc32(ATUALIZACAO_DESTINO, tamanho_novo) == crc_novo ? ATUALIZACAO_PRONTA : ATUALIZACAO_ERRO);
+}
+
+/* confere o cabecalho e a imagem base, que deve ser a atual */
+static uint8_t ConfereCabecalho(void)
+{
+	tamanho_base = Le32(&cabecalho[4]);
+	tamanho_novo = Le32(&cabecalho[12]);
+	crc_novo = Le32(&cabecalho[16]);
+
+	return cabecalho[0] == 'D' && cabecalho[1] == 'L' && cabecalho[2] == ATUALIZACAO_VERSAO &&
+		   tamanho_base <= ATUALIZACAO_DESTINO - ATUALIZACAO_ORIGEM &&
+		   tamanho_novo > 0 && tamanho_novo <= ATUALIZACAO_MAXIMO &&
+		   Crc32(ATUALIZACAO_ORIGEM, tamanho_base) == Le32(&cabecalho[8]);
+}
+
+/* le um byte de um inteiro. Retorna 1 com o inteiro completo em valor */
+static uint8_t LeInteiro(uint8_t b, uint8_t *erro)
+{
+	if(bits >= 28 && (b >> (32 - bits)) != 0)
+	{
+		*erro = 1;
+		return 0;
+	}
+	valor |= (uint32_t)(b & 0x7F) << bits;
+	bits = (uint8_t)(bits + 7);
+	return (b & 0x80) == 0;
+}
+
+/* aplica os bytes da diferenca. Retorna 0 em erro */
+static uint8_t Aplica(const uint8_t *bytes, uint16_t n)
+{
+	uint32_t deslocamento;
+	uint16_t parte;
+	uint8_t erro = 0;
+
+	while(n > 0)
+	{
+		switch(etapa)
+		{
+		case CABECALHO:
+			cabecalho[lidos_cabecalho++] = *bytes++;
+			n--;
+			if(lidos_cabecalho == ATUALIZACAO_CABECALHO)
+			{
+				if(!ConfereCabecalho())
+				{
+					return 0;
+				}
+				etapa = OPERACAO;
+			}
+			break;
+
+		case OPERACAO:
+			if(LeInteiro(*bytes++, &erro))
+			{
+				tamanho = valor >> 1;
+				etapa = (valor & 1) == ATUALIZACAO_COPIA ? DESLOCAMENTO : INSERCAO;
+				if(etapa == INSERCAO && tamanho == 0)
+				{
+					etapa = OPERACAO;
+				}
+				valor = 0;
+				bits = 0;
+			}
+			n--;
+			break;
+
+		case DESLOCAMENTO:
+			if(LeInteiro(*bytes++, &erro))
+			{
+				/* zigue-zague: 0, 1, 2, 3... = 0, -1, 1, -2... */
+				deslocamento = (valor >> 1) ^ (0UL - (valor & 1));
+				origem += deslocamento;
+				if(origem > tamanho_base || tamanho > tamanho_base - origem ||
+				   !Emite((const uint8_t *)(ATUALIZACAO_ORIGEM + origem), tamanho))
+				{
+					return 0;
+				}
+				origem += tamanho;
+				estatisticas_atualizacao.copiados += tamanho;
+				etapa = OPERACAO;
+				valor = 0;
+				bits = 0;
+			}
+			n--;
+			break;
+
+		default:	/* INSERCAO */
+			parte = tamanho < n ? (uint16_t)tamanho : n;
+			if(!Emite(bytes, parte))
+			{
+				return 0;
+			}
+			bytes += parte;
+			n = (uint16_t)(n - parte);
+			tamanho -= parte;
+			if(tamanho == 0)
+			{
+				etapa = OPERACAO;
+			}
+			break;
+		}
+		if(erro)
+		{
+			return 0;
+		}
+		if(etapa != CABECALHO && gerados == tamanho_novo)
+		{
+			/* bytes depois do fim: a diferenca nao e desta imagem */
+			if(n > 0 || etapa != OPERACAO)
+			{
+				return 0;
+			}
+			Conclui();
+			return 1;
+		}
+	}
+	return 1;
+}
+
+/* corpo da tarefa de fundo: aplica os trechos do anel */
+void tarefa_atualizacao(void)
+{
+	uint8_t bloco[32];
+	uint16_t n;
+
+	for(;;)
+	{
+		(void)AnelAguarda(&anel, ESPERA_INFINITA);
+		while((n = AnelLe(&anel, bloco, sizeof(bloco))) > 0)
+		{
+			/* depois do fim ou de um erro, descarta o resto */
+			if(estado == ATUALIZACAO_RECEBENDO && !Aplica(bloco, n))
+			{
+				Termina(ATUALIZACAO_ERRO);
+			}
+		}
+	}
+}
+
+/* aceita o trecho na posicao esperada, se cabe inteiro no anel. Retorna a
+   posicao esperada a seguir */
+uint32_t AtualizacaoRecebe(const uint8_t *dados, uint8_t qtd)
+{
+	uint32_t inicio, pulados;
+	uint16_t n;
+
+	if(estado == ATUALIZACAO_PARADA || qtd < 4)
+	{
+		estatisticas_atualizacao.recusados++;
+		return posicao;
+	}
+	inicio = Le32(dados);
+	n = (uint16_t)(qtd - 4);
+
+	if(inicio == 0 && estado != ATUALIZACAO_RECEBENDO && AnelQuantidade(&anel) == 0)
+	{
+		memset(&estatisticas_atualizacao, 0, sizeof(estatisticas_atualizacao));
+		posicao = 0;
+		estado = ATUALIZACAO_RECEBENDO;
+	}
+	if(estado == ATUALIZACAO_ERRO)
+	{
+		return ATUALIZACAO_FALHOU;
+	}
+	if(estado != ATUALIZACAO_RECEBENDO || inicio + n <= posicao)
+	{
+		return posicao;						/* repetido */
+	}
+
+	pulados = posicao - inicio;
+	if(inicio > posicao || (uint16_t)(ATUALIZACAO_ANEL - AnelQuantidade(&anel)) < n - pulados)
+	{
+		estatisticas_atualizacao.recusados++;
+		return posicao;
+	}
+	n = (uint16_t)(n - pulados);
+	(void)AnelEscreve(&anel, &dados[4 + pulados], n);
+	posicao += n;
+	estatisticas_atualizacao.recebidos += n;
+	return posicao;
+}
+
+estado_atualizacao_t AtualizacaoEstado(void)
+{
+	return estado;
+}
+
+/* prepara a recepcao, antes de criar a tarefa de fundo. Retorna 0 se o
+   programa ocupa a area de preparacao ou a area passa do fim da flash */
+uint8_t AtualizacaoInicia(void)
+{
+	extern uint32_t _etext, _srelocate, _erelocate;
+	uint32_t fim_programa = (uint32_t)&_etext + ((uint32_t)&_erelocate - (uint32_t)&_srelocate);
+
+	if(fim_programa > ATUALIZACAO_DESTINO || ATUALIZACAO_DESTINO + ATUALIZACAO_MAXIMO > FLASH_SIZE ||
+	   !AnelInicia(&anel, area_anel, ATUALIZACAO_ANEL, 1))
+	{
+		return 0;
+	}
+	NVMCTRL->CTRLB.reg |= NVMCTRL_CTRLB_MANW;	/* grava so com o comando WP */
+	NVIC_EnableIRQ(NVMCTRL_IRQn);
+
+	Zera();
+	posicao = 0;
+	estado = ATUALIZACAO_LIVRE;
+	return 1;
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * atualizacao.h
+ *
+ * Atualizacao do programa por diferenca (delta): em vez da imagem nova
+ * inteira, o enlace leva so a diferenca para a imagem atual, gerada no
+ * computador por host_posix/gera_delta.c. A diferenca e uma sequencia de
+ * operacoes: copia de um trecho da imagem atual (o codigo que nao mudou,
+ * mesmo deslocado) ou insercao de bytes novos. Uma versao com poucas
+ * funcoes alteradas vira uma diferenca de alguns kB.
+ *
+ * A diferenca chega em quadros comuns do receptor (receptor_quadros.h),
+ * entregues a AtualizacaoRecebe pelo tratador do tipo escolhido pela
+ * aplicacao. Os dados de cada quadro sao a posicao do trecho na diferenca
+ * (32 bits, menos significativo primeiro) seguida do trecho. A funcao
+ * retorna a posicao esperada a seguir, que a aplicacao devolve como
+ * confirmacao: um trecho repetido ou fora de ordem nao avanca a posicao e
+ * o transmissor reenvia a partir dela. Ex.:
+ *
+ *   static void TrataAtualizacao(const uint8_t *dados, uint8_t qtd)
+ *   {
+ *       uint32_t posicao = AtualizacaoRecebe(dados, qtd);
+ *       envia a confirmacao com posicao
+ *   }
+ *
+ *   CriaTarefa(tarefa_atualizacao, "Atualizacao", pilha, tamanho, 1);
+ *
+ * AtualizacaoRecebe nao bloqueia: so copia o trecho para um anel e
+ * retorna. A tarefa de fundo tarefa_atualizacao, de baixa prioridade, le o
+ * anel, aplica as operacoes e grava a imagem nova, pagina a pagina, na
+ * area de preparacao (a metade superior da flash, por padrao). Cada
+ * comando da NVM (apagar a linha, gravar a pagina) e esperado pela
+ * interrupcao de pronto do NVMCTRL, com a tarefa bloqueada no semaforo, e
+ * nao em espera ocupada: a recepcao continua entre um comando e o
+ * seguinte. Com o anel cheio, o trecho nao e aceito e o transmissor espera
+ * a confirmacao, o controle de fluxo da gravacao.
+ *
+ * O SAMD21J18A nao tem secao de leitura durante a escrita (RWW): enquanto
+ * um comando executa, as leituras da flash (codigo e constantes) param ate
+ * ~2,5 ms por pagina e ~6 ms por linha, como em fila_nvm.h. O DMA continua
+ * gravando os bytes recebidos na RAM e a tarefa do receptor analisa o que
+ * acumulou assim que o comando termina.
+ *
+ * A diferenca comeca por um cabecalho com o tamanho e o CRC-32 da imagem
+ * base (a atual, conferida antes de gravar) e da imagem nova (conferida no
+ * fim, na flash). Com ATUALIZACAO_PRONTA, a imagem nova esta inteira na
+ * area de preparacao; a troca pela imagem atual e feita por um carregador
+ * de inicializacao, que nao faz parte deste projeto.
+ *
+ * Ligada com ATUALIZACAO=1 nos simbolos do projeto.
+ */
+
+
+#ifndef ATUALIZACAO_H_
+#define ATUALIZACAO_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef ATUALIZACAO
+#define ATUALIZACAO				0
+#endif
+
+/* inicio da imagem atual, base da diferenca */
+#ifndef ATUALIZACAO_ORIGEM
+#define ATUALIZACAO_ORIGEM		0
+#endif
+
+/* area de preparacao da imagem nova: por padrao a metade superior da
+   flash, sem as linhas da fila persistente (fila_nvm.h). O programa nao
+   pode ocupar a area (AtualizacaoInicia confere) */
+#ifndef ATUALIZACAO_DESTINO
+#define ATUALIZACAO_DESTINO		(FLASH_SIZE / 2)
+#endif
+
+#ifndef ATUALIZACAO_MAXIMO
+#define ATUALIZACAO_MAXIMO		(FLASH_SIZE / 2 - 16 * ATUALIZACAO_TAM_LINHA)
+#endif
+
+/* anel entre a recepcao e a tarefa de fundo (potencia de 2): trechos
+   recebidos durante os comandos da NVM */
+#ifndef ATUALIZACAO_ANEL
+#define ATUALIZACAO_ANEL		1024
+#endif
+
+#define ATUALIZACAO_TAM_PAGINA	64
+#define ATUALIZACAO_TAM_LINHA	(4 * ATUALIZACAO_TAM_PAGINA)
+
+/* cabecalho da diferenca: "DL", versao, reservado, e os tamanhos e os
+   CRC-32 da imagem base e da nova (32 bits, menos significativo primeiro) */
+#define ATUALIZACAO_VERSAO		1
+#define ATUALIZACAO_CABECALHO	20
+
+/* operacoes: inteiro de 7 bits por byte (o bit 7 indica mais um byte, o
+   menos significativo primeiro) com (tamanho << 1) | tipo. A copia segue
+   com o deslocamento da origem em relacao ao fim da copia anterior, em
+   zigue-zague (0, -1, 1, -2... = 0, 1, 2, 3...); a insercao, com os bytes */
+#define ATUALIZACAO_INSERE		0
+#define ATUALIZACAO_COPIA		1
+
+/* retorno de AtualizacaoRecebe com a atualizacao em erro: o transmissor
+   desiste. Uma nova diferenca comeca pela posicao 0 */
+#define ATUALIZACAO_FALHOU		0xFFFFFFFFUL
+
+typedef enum
+{
+	ATUALIZACAO_PARADA = 0,		///< AtualizacaoInicia nao chamada ou falhou
+	ATUALIZACAO_LIVRE,			///< esperando o comeco de uma diferenca (posicao 0)
+	ATUALIZACAO_RECEBENDO,		///< aplicando a diferenca
+	ATUALIZACAO_PRONTA,			///< imagem nova gravada e conferida
+	ATUALIZACAO_ERRO			///< diferenca invalida ou de outra imagem base, ou CRC errado
+} estado_atualizacao_t;
+
+/**
+* \struct estatisticas_atualizacao_t
+* Contadores da atualizacao em andamento
+*/
+
+typedef struct
+{
+	uint32_t	recebidos;			///< Bytes da diferenca aceitos
+	uint32_t	recusados;			///< Trechos fora de ordem ou sem espaco no anel
+	uint32_t	gerados;			///< Bytes da imagem nova
+	uint32_t	copiados;			///< Bytes da imagem nova copiados da atual
+	uint32_t	paginas_gravadas;
+	uint32_t	linhas_apagadas;
+} estatisticas_atualizacao_t;
+
+extern estatisticas_atualizacao_t estatisticas_atualizacao;
+
+uint8_t AtualizacaoInicia(void);
+uint32_t AtualizacaoRecebe(const uint8_t *dados, uint8_t qtd);
+estado_atualizacao_t AtualizacaoEstado(void);
+void tarefa_atualizacao(void);
+
+#endif /* ATUALIZACAO_H_ */
@@ -0,0 +1,230 @@
+/*
+ * bordas.c
+ *
+ * Interrupcoes externas do EIC ligadas aos servicos do nucleo (ver bordas.h).
+ */
+
+#include <asf.h>
+#include "bordas.h"
+#include "sincronismo.h"
+
+#if BORDAS
+
+typedef enum
+{
+	LIGA_NADA = 0,
+	LIGA_NOTIFICACAO,
+	LIGA_SEMAFORO,
+	LIGA_TRABALHO
+} tipo_ligacao_t;
+
+/* o que cada linha aciona na borda */
+typedef struct
+{
+	uint8_t				tipo;
+	uint8_t				tarefa;
+	uint32_t			bits;
+	semaforo_t			*sem;
+	#if cfg_FILA_TRABALHOS > 0
+	funcao_trabalho_t	funcao;
+	void				*arg;
+	#endif
+} ligacao_t;
+
+static ligacao_t ligacoes[BORDAS_LINHAS];
+static uint8_t pinos[BORDAS_LINHAS];
+static uint16_t linhas_nivel = 0;			/* deteccao por nivel */
+
+estatisticas_bordas_t estatisticas_bordas;
+
+
+/* EIC com o OSCULP32K / 2^(4+1) = 1,024 kHz, tambem no STANDBY, e a
+   interrupcao no NVIC. As linhas comecam desabilitadas */
+void BordasInicia(void)
+{
+	PM->APBAMASK.reg |= PM_APBAMASK_EIC;
+	GCLK->GENDIV.reg = GCLK_GENDIV_ID(BORDAS_GERADOR) | GCLK_GENDIV_DIV(4);
+	GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(BORDAS_GERADOR) | GCLK_GENCTRL_SRC_OSCULP32K |
+						GCLK_GENCTRL_DIVSEL | GCLK_GENCTRL_RUNSTDBY | GCLK_GENCTRL_GENEN;
+	while(GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY) {}
+	GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(EIC_GCLK_ID) | GCLK_CLKCTRL_GEN(BORDAS_GERADOR) | GCLK_CLKCTRL_CLKEN;
+
+	EIC->CTRL.reg = EIC_CTRL_SWRST;
+	while((EIC->CTRL.reg & EIC_CTRL_SWRST) || (EIC->STATUS.reg & EIC_STATUS_SYNCBUSY)) {}
+	EIC->INTENCLR.reg = EIC_INTENCLR_MASK;
+	EIC->INTFLAG.reg = EIC_INTFLAG_MASK;
+	NVIC_EnableIRQ(EIC_IRQn);
+	EIC->CTRL.reg = EIC_CTRL_ENABLE;
+}
+
+/* pino de entrada na linha do EIC, com a deteccao, o filtro (1 liga o
+   debounce de ~3 ms) e o pull. Retorna a linha, ainda desabilitada, ou
+   BORDA_INVALIDA. CONFIG e WAKEUP so aceitam escrita com o EIC parado: a
+   tarefa bloqueia enquanto o EIC para (~3 ms) e o religamento sincroniza
+   depois do retorno. As outras linhas nao detectam bordas nesse intervalo.
+   Chamada so por uma tarefa de cada vez (ex.: na partida) */
+uint8_t BordaConfigura(uint8_t pino, sentido_borda_t sentido, uint8_t filtro, pull_borda_t pull)
+{
+	PortGroup *grupo = &PORT->Group[pino / 32];
+	uint8_t bit = (uint8_t)(pino % 32);
+	uint8_t linha = (uint8_t)(pino % BORDAS_LINHAS);
+	uint32_t campo;
+	reg_atomica_t estado;
+
+	if(pino == PIN_PA08 || pino >= PORT_GROUPS * 32)
+	{
+		return BORDA_INVALIDA;
+	}
+
+	if(pull == BORDA_PULL_UP)
+	{
+		grupo->OUTSET.reg = 1UL << bit;
+	}
+	else if(pull == BORDA_PULL_DOWN)
+	{
+		grupo->OUTCLR.reg = 1UL << bit;
+	}
+	grupo->DIRCLR.reg = 1UL << bit;
+	if(bit & 1)
+	{
+		grupo->PMUX[bit / 2].reg = (grupo->PMUX[bit / 2].reg & ~PORT_PMUX_PMUXO_Msk) | PORT_PMUX_PMUXO(0);
+	}
+	else
+	{
+		grupo->PMUX[bit / 2].reg = (grupo->PMUX[bit / 2].reg & ~PORT_PMUX_PMUXE_Msk) | PORT_PMUX_PMUXE(0);
+	}
+	grupo->PINCFG[bit].reg = PORT_PINCFG_PMUXEN | PORT_PINCFG_INEN |
+							 ((pull != BORDA_SEM_PULL) ? PORT_PINCFG_PULLEN : 0);
+	pinos[linha] = pino;
+
+	campo = (uint32_t)sentido | (filtro ? EIC_CONFIG_FILTEN0 : 0);
+	SINCRONIZA_LENTO(EIC->STATUS.reg & EIC_STATUS_SYNCBUSY);
+	EIC->CTRL.reg = 0;
+	SINCRONIZA_LENTO(EIC->STATUS.reg & EIC_STATUS_SYNCBUSY);
+	REG_ATOMICA_INICIO(estado);
+	EIC->CONFIG[linha / 8].reg = (EIC->CONFIG[linha / 8].reg & ~(0xFUL << (4 * (linha % 8)))) |
+								 (campo << (4 * (linha % 8)));
+	EIC->WAKEUP.reg |= 1UL << linha;
+	EIC->CTRL.reg = EIC_CTRL_ENABLE;
+	if(sentido >= BORDA_NIVEL_ALTO)
+	{
+		linhas_nivel |= (uint16_t)(1u << linha);
+	}
+	else
+	{
+		linhas_nivel &= (uint16_t)~(1u << linha);
+	}
+	REG_ATOMICA_FIM(estado);
+	return linha;
+}
+
+/* a borda liga os bits no valor de notificacao da tarefa (NOTIFICA_BITS) */
+void BordaLigaNotificacao(uint8_t linha, uint8_t id_tarefa, uint32_t bits)
+{
+	ligacao_t *l = &ligacoes[linha];
+	reg_atomica_t estado;
+
+	REG_ATOMICA_INICIO(estado);
+	l->tipo = LIGA_NOTIFICACAO;
+	l->tarefa = id_tarefa;
+	l->bits = bits;
+	REG_ATOMICA_FIM(estado);
+}
+
+/* a borda libera o semaforo, uma vez por borda */
+void BordaLigaSemaforo(uint8_t linha, semaforo_t *sem)
+{
+	ligacao_t *l = &ligacoes[linha];
+	reg_atomica_t estado;
+
+	REG_ATOMICA_INICIO(estado);
+	l->tipo = LIGA_SEMAFORO;
+	l->sem = sem;
+	REG_ATOMICA_FIM(estado);
+}
+
+#if cfg_FILA_TRABALHOS > 0
+/* a borda agenda funcao(arg) na tarefa de trabalhos */
+void BordaLigaTrabalho(uint8_t linha, funcao_trabalho_t funcao, void *arg)
+{
+	ligacao_t *l = &ligacoes[linha];
+	reg_atomica_t estado;
+
+	REG_ATOMICA_INICIO(estado);
+	l->tipo = LIGA_TRABALHO;
+	l->funcao = funcao;
+	l->arg = arg;
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+/* descarta a borda anterior a habilitacao */
+void BordaHabilita(uint8_t linha)
+{
+	EIC->INTFLAG.reg = 1UL << linha;
+	EIC->INTENSET.reg = 1UL << linha;
+}
+
+void BordaDesabilita(uint8_t linha)
+{
+	EIC->INTENCLR.reg = 1UL << linha;
+}
+
+/* nivel atual do pino da linha */
+uint8_t BordaNivel(uint8_t linha)
+{
+	uint8_t pino = pinos[linha];
+
+	return (uint8_t)((PORT->Group[pino / 32].IN.reg >> (pino % 32)) & 1);
+}
+
+static void Aciona(uint8_t linha)
+{
+	ligacao_t *l = &ligacoes[linha];
+
+	estatisticas_bordas.bordas[linha]++;
+	switch(l->tipo)
+	{
+		case LIGA_NOTIFICACAO:
+			TarefaNotifica(l->tarefa, l->bits, NOTIFICA_BITS);
+			break;
+		case LIGA_SEMAFORO:
+			SemaforoLiberaISR(l->sem);
+			break;
+		#if cfg_FILA_TRABALHOS > 0
+		case LIGA_TRABALHO:
+			if(TrabalhoAgenda(l->funcao, l->arg) == 0)
+			{
+				estatisticas_bordas.perdidas++;
+			}
+			break;
+		#endif
+		default:
+			estatisticas_bordas.perdidas++;
+			break;
+	}
+}
+
+/* interrupcao unica do EIC: atende todas as linhas habilitadas com flag.
+   Uma linha por nivel (BORDA_NIVEL_*) interromperia de novo enquanto o
+   nivel durasse: e desabilitada aqui e a tarefa a habilita (BordaHabilita)
+   depois de tratar a entrada */
+void EIC_Handler(void)
+{
+	uint32_t pendentes = EIC->INTFLAG.reg & EIC->INTENSET.reg;
+	uint8_t linha;
+
+	InterrupcaoEntra();
+	EIC->INTENCLR.reg = pendentes & linhas_nivel;
+	EIC->INTFLAG.reg = pendentes;
+	for(linha = 0; pendentes != 0; linha++, pendentes >>= 1)
+	{
+		if(pendentes & 1)
+		{
+			Aciona(linha);
+		}
+	}
+	InterrupcaoSai();
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * bordas.h
+ *
+ * Interrupcoes externas do EIC ligadas diretamente aos servicos do nucleo:
+ * cada linha, configurada com BordaConfigura, e ligada a uma notificacao de
+ * tarefa (bits OU), a um semaforo ou a um trabalho da fila de trabalhos. A
+ * tarefa que depende de uma entrada bloqueia ate a borda, sem ler o pino
+ * periodicamente (port_pin_get_input_level).
+ *
+ * O EIC conta o OSCULP32K dividido por 32 (~1 kHz), pelo gerador
+ * BORDAS_GERADOR, tambem no STANDBY (sono_rtc.h): as linhas ligadas
+ * acordam a CPU. O filtro do EIC (maioria de 3 amostras) vira assim um
+ * debounce de ~3 ms em hardware, bom para botoes e contatos. A contrapartida
+ * e a latencia da deteccao, de ate ~2 ms em todas as linhas; bordas rapidas
+ * (ex.: medicoes/mede_latencia.c, que tem o seu proprio EIC_Handler e nao
+ * combina com este modulo) precisam do EIC no clock da CPU.
+ *
+ * A linha do EIC e a do pino (EXTINT[pino % 16]), na funcao A do PORT; o
+ * PA08 e o NMI e nao tem linha. Duas entradas com a mesma linha nao podem
+ * ser usadas juntas.
+ *
+ * Ligado com BORDAS=1 nos simbolos do projeto. Ex.:
+ *
+ *   BordasInicia();
+ *   linha = BordaConfigura(SW0_PIN, BORDA_DESCIDA, 1, BORDA_PULL_UP);
+ *   BordaLigaNotificacao(linha, id_tarefa, 1u << 0);
+ *   BordaHabilita(linha);
+ *   ...
+ *   bits = TarefaAguardaNotificacao(ESPERA_INFINITA);	na tarefa
+ */
+
+
+#ifndef BORDAS_H_
+#define BORDAS_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef BORDAS
+#define BORDAS					0
+#endif
+
+/* gerador de clock do EIC, com o OSCULP32K dividido por 32 */
+#ifndef BORDAS_GERADOR
+#define BORDAS_GERADOR			7
+#endif
+
+#define BORDAS_LINHAS			16
+
+/* retorno de BordaConfigura para um pino sem linha do EIC */
+#define BORDA_INVALIDA			0xFF
+
+/* deteccao, com os valores do campo SENSE do EIC */
+typedef enum
+{
+	BORDA_SUBIDA = 1,
+	BORDA_DESCIDA,
+	BORDA_AMBAS,
+	BORDA_NIVEL_ALTO,
+	BORDA_NIVEL_BAIXO
+} sentido_borda_t;
+
+typedef enum
+{
+	BORDA_SEM_PULL = 0,
+	BORDA_PULL_UP,
+	BORDA_PULL_DOWN
+} pull_borda_t;
+
+/**
+* \struct estatisticas_bordas_t
+* Contadores das linhas do EIC
+*/
+
+typedef struct
+{
+	uint32_t	bordas[BORDAS_LINHAS];	///< Interrupcoes de cada linha
+	uint32_t	perdidas;				///< Bordas sem ligacao ou com a fila de trabalhos cheia
+} estatisticas_bordas_t;
+
+extern estatisticas_bordas_t estatisticas_bordas;
+
+void BordasInicia(void);
+uint8_t BordaConfigura(uint8_t pino, sentido_borda_t sentido, uint8_t filtro, pull_borda_t pull);
+void BordaLigaNotificacao(uint8_t linha, uint8_t id_tarefa, uint32_t bits);
+void BordaLigaSemaforo(uint8_t linha, semaforo_t *sem);
+#if cfg_FILA_TRABALHOS > 0
+void BordaLigaTrabalho(uint8_t linha, funcao_trabalho_t funcao, void *arg);
+#endif
+void BordaHabilita(uint8_t linha);
+void BordaDesabilita(uint8_t linha);
+uint8_t BordaNivel(uint8_t linha);
+
+#endif /* BORDAS_H_ */
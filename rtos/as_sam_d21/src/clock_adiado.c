@@ -0,0 +1,143 @@
+/*
+ * clock_adiado.c
+ *
+ * Inicio rapido dos clocks: em vez de esperar o cristal e a trava da DFLL
+ * antes de main (system_clock_init), a CPU segue com o OSC8M e a partida
+ * avanca por interrupcoes do SYSCTRL:
+ *
+ *   ClockIniciaAdiado: OSC8M sem divisor, liga o XOSC32K (sem esperar)
+ *   XOSC32K pronto:    gerador 1 = XOSC32K, DFLL em malha fechada
+ *   DFLL travada:      perfil de desempenho (perfil_clock.c): flash com 1
+ *                      estado de espera, gerador 0 = DFLL, marca de tempo
+ *                      reprogramada para CLOCK_FINAL_HZ
+ *
+ * Os drivers calculam suas taxas por PerfilClockHz e as recalculam em um
+ * gancho de perfil (perfil_clock.h); os que exigem o clock final (ex.: a
+ * UART a 1Mbaud) devem ser iniciados apos ClockAguardaFinal.
+ * Os tempos de partida e os passos da DFLL vem de conf_clocks.h.
+ */
+
+#include <asf.h>
+#include <conf_clocks.h>
+#include "clock_adiado.h"
+#include "perfil_clock.h"
+
+#if CLOCK_FINAL_HZ != cfg_CPU_CLOCK_HZ
+#error "CLOCK_FINAL_HZ deve ser igual a cfg_CPU_CLOCK_HZ (conf_rtos.h)"
+#endif
+
+/* calibracao grossa da DFLL na area de calibracao da NVM (ver clock.c) */
+#define NVM_DFLL_COARSE_POS		58
+#define NVM_DFLL_COARSE_SIZE	6
+
+static volatile uint8_t clock_final_pronto = 0;
+static semaforo_t SemaforoClock = {0,0};
+
+static void EsperaDfll(void)
+{
+	while(!(SYSCTRL->PCLKSR.reg & SYSCTRL_PCLKSR_DFLLRDY)) {}
+}
+
+/* DFLL em malha fechada, com o XOSC32K como referencia pelo gerador 1 */
+static void IniciaDfll(void)
+{
+	uint32_t coarse;
+
+	GCLK->GENDIV.reg = GCLK_GENDIV_ID(1) | GCLK_GENDIV_DIV(1);
+	GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(1) | GCLK_GENCTRL_SRC_XOSC32K | GCLK_GENCTRL_GENEN;
+	while(GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY) {}
+	GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(SYSCTRL_GCLK_ID_DFLL48) | GCLK_CLKCTRL_GEN_GCLK1 |
+						GCLK_CLKCTRL_CLKEN;
+
+	/* comeca da calibracao de fabrica, para travar mais rapido */
+	coarse = (*((uint32_t *)(NVMCTRL_OTP4) + (NVM_DFLL_COARSE_POS / 32)) >> (NVM_DFLL_COARSE_POS % 32)) &
+				((1 << NVM_DFLL_COARSE_SIZE) - 1);
+	if(coarse == 0x3f)
+	{
+		coarse = 0x1f;		/* valor invalido em algumas revisoes do chip */
+	}
+
+	/* errata 9905: DFLLVAL e DFLLMUL sao escritos com a DFLL habilitada e
+	   sem ONDEMAND, esperando a sincronizacao a cada escrita */
+	SYSCTRL->DFLLCTRL.reg = SYSCTRL_DFLLCTRL_ENABLE;
+	EsperaDfll();
+	SYSCTRL->DFLLMUL.reg = SYSCTRL_DFLLMUL_CSTEP(CONF_CLOCK_DFLL_MAX_COARSE_STEP_SIZE) |
+							SYSCTRL_DFLLMUL_FSTEP(CONF_CLOCK_DFLL_MAX_FINE_STEP_SIZE) |
+							SYSCTRL_DFLLMUL_MUL(CONF_CLOCK_DFLL_MULTIPLY_FACTOR);
+	EsperaDfll();
+	SYSCTRL->DFLLVAL.reg = SYSCTRL_DFLLVAL_COARSE(coarse) | SYSCTRL_DFLLVAL_FINE(CONF_CLOCK_DFLL_FINE_VALUE);
+	EsperaDfll();
+	SYSCTRL->DFLLCTRL.reg = SYSCTRL_DFLLCTRL_ENABLE | SYSCTRL_DFLLCTRL_MODE | SYSCTRL_DFLLCTRL_WAITLOCK;
+	EsperaDfll();
+}
+
+/* DFLL travada: a CPU passa ao perfil de desempenho */
+static void TrocaParaDfll(void)
+{
+	clock_final_pronto = 1;
+	(void)PerfilClockMuda(PERFIL_DESEMPENHO);
+	SemaforoLiberaISR(&SemaforoClock);
+}
+
+/* cada etapa da partida termina em uma interrupcao do SYSCTRL */
+void SYSCTRL_Handler(void)
+{
+	uint32_t flags = SYSCTRL->INTFLAG.reg & SYSCTRL->INTENSET.reg;
+
+	if(flags & SYSCTRL_INTFLAG_XOSC32KRDY)
+	{
+		SYSCTRL->INTENCLR.reg = SYSCTRL_INTENCLR_XOSC32KRDY;
+		SYSCTRL->INTFLAG.reg = SYSCTRL_INTFLAG_XOSC32KRDY | SYSCTRL_INTFLAG_DFLLLCKF;
+		IniciaDfll();
+		SYSCTRL->INTENSET.reg = SYSCTRL_INTENSET_DFLLLCKF;
+	}
+
+	if(flags & SYSCTRL_INTFLAG_DFLLLCKF)
+	{
+		SYSCTRL->INTENCLR.reg = SYSCTRL_INTENCLR_DFLLLCKF;
+		SYSCTRL->INTFLAG.reg = SYSCTRL_INTFLAG_DFLLLCKF;
+		TrocaParaDfll();
+	}
+}
+
+/* chamada no inicio de main, no lugar de system_init. Retorna sem esperar
+   nenhum oscilador: as tarefas iniciam a CLOCK_INICIAL_HZ */
+void ClockIniciaAdiado(void)
+{
+	/* o reset deixa o OSC8M dividido por 8 (1MHz) */
+	SYSCTRL->OSC8M.bit.PRESC = 0;
+	(void)PerfilClockMuda(PERFIL_ECONOMIA);
+
+	SYSCTRL->INTFLAG.reg = SYSCTRL_INTFLAG_XOSC32KRDY;
+	SYSCTRL->INTENSET.reg = SYSCTRL_INTENSET_XOSC32KRDY;
+	NVIC_EnableIRQ(SYSCTRL_IRQn);
+
+	/* o cristal parte em segundo plano (CONF_CLOCK_XOSC32K_STARTUP_TIME) */
+	SYSCTRL->XOSC32K.reg = SYSCTRL_XOSC32K_STARTUP(CONF_CLOCK_XOSC32K_STARTUP_TIME) |
+							SYSCTRL_XOSC32K_XTALEN | SYSCTRL_XOSC32K_EN32K;
+	SYSCTRL->XOSC32K.reg |= SYSCTRL_XOSC32K_ENABLE;
+}
+
+/* 1 se a DFLL ja travou: a partida terminou e o perfil de desempenho esta
+   disponivel (a CPU pode ter voltado depois ao perfil de economia) */
+uint8_t ClockFinalPronto(void)
+{
+	return clock_final_pronto;
+}
+
+/* aguarda o fim da partida. Retorna 1 se a troca aconteceu e 0
+   se o tempo se esgotou. Varias tarefas podem aguardar: cada uma devolve o
+   semaforo para a proxima */
+uint8_t ClockAguardaFinal(tick_t timeout)
+{
+	if(clock_final_pronto)
+	{
+		return 1;
+	}
+	if(SemaforoAguardaTempo(&SemaforoClock, timeout))
+	{
+		SemaforoLibera(&SemaforoClock);
+		return 1;
+	}
+	return 0;
+}
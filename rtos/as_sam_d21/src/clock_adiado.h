@@ -0,0 +1,27 @@
+/*
+ * clock_adiado.h
+ *
+ * Inicio rapido dos clocks da SAM D21 Xplained Pro: as tarefas comecam com
+ * o OSC8M (8MHz, pronto logo apos o reset) enquanto o cristal de 32kHz
+ * (XOSC32K) parte e a DFLL trava em 48MHz, em segundo plano. Cada etapa
+ * avanca na interrupcao do SYSCTRL, sem espera ocupada no inicio; ao fim,
+ * o gerador 0 (CPU) passa para a DFLL e a marca de tempo e reprogramada.
+ */
+
+
+#ifndef CLOCK_ADIADO_H_
+#define CLOCK_ADIADO_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* frequencia da CPU ate o fim da partida e apos a troca para a DFLL
+   (esta deve ser igual a cfg_CPU_CLOCK_HZ, conf_rtos.h) */
+#define CLOCK_INICIAL_HZ		8000000UL
+#define CLOCK_FINAL_HZ			48000000UL
+
+void ClockIniciaAdiado(void);
+uint8_t ClockFinalPronto(void);
+uint8_t ClockAguardaFinal(tick_t timeout);
+
+#endif /* CLOCK_ADIADO_H_ */
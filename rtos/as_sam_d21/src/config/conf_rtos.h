@@ -0,0 +1,114 @@
+/*
+ * conf_rtos.h
+ *
+ * Configuracao do sistema multitarefas para a placa SAM D21 Xplained Pro.
+ * As macros nao definidas aqui usam os valores padrao do rtos.h.
+ */ 
+
+
+#ifndef CONF_RTOS_H_
+#define CONF_RTOS_H_
+
+/* numero de tarefas (mais a tarefa de telemetria de main.c, ou as 5 
+   tarefas dos testes do Thread-Metric com a de relatorio) */
+#if (defined(TELEMETRIA_UART) && TELEMETRIA_UART) || (defined(MEDE_THREAD_METRIC) && MEDE_THREAD_METRIC)
+#define NUMERO_DE_TAREFAS	7
+#else
+#define NUMERO_DE_TAREFAS	6
+#endif
+
+/* o teste preemptivo do Thread-Metric usa 5 prioridades, com o relatorio 
+   acima delas */
+#if defined(MEDE_THREAD_METRIC) && MEDE_THREAD_METRIC
+#define PRIORIDADE_MAXIMA	6
+#endif
+
+/* frequencia de clock da CPU (ver conf_clocks.h) */
+#define cfg_CPU_CLOCK_HZ 	48000000UL
+
+/* escalonador, troca de contexto e marca de tempo executados da RAM, 
+   sem os estados de espera da flash a 48MHz */
+#define cfg_NUCLEO_NA_RAM	1
+
+/* modo cooperativo: a tarefa atual so perde o processador ao bloquear */
+#define cfg_PREEMPTIVO		0
+
+/* modo ocioso sem marcas de tempo: a tarefa ociosa dorme ate o proximo 
+   despertar, no nivel de sono escolhido por OciosaEscolheSono (main.c) */
+#define cfg_OCIOSA_SEM_MARCAS	1
+
+void OciosaEscolheSono(uint32_t qtas_marcas);
+#define cfg_ANTES_DE_DORMIR(qtas_marcas)	OciosaEscolheSono(qtas_marcas)
+
+/* sono longo no STANDBY, acordado pelo RTC (sono_rtc.c), ligado com 
+   SONO_RTC=1 nos simbolos do projeto: esperas de 200 marcas ou mais. 
+   Abaixo disso, a latencia de acordar e de travar o DFLL nao compensa */
+#if defined(SONO_RTC) && SONO_RTC
+#define cfg_SONO_LONGO_MARCAS	200
+uint32_t SonoRtcDorme(uint32_t us);
+#define cfg_SONO_LONGO(us)		SonoRtcDorme(us)
+#endif
+
+/* tarefa ociosa no fundo da pilha principal (STACK_SIZE do ligador, 8 kB),
+   que as interrupcoes nao chegam a usar: sem vetor de pilha proprio */
+#define cfg_OCIOSA_PILHA_PRINCIPAL	1
+
+/* vigia das tarefas com o WDT da placa (vigia_wdt.c), ligado com 
+   VIGIA_WDT=1 nos simbolos do projeto: as janelas sao conferidas a cada 
+   100 marcas */
+#if defined(VIGIA_WDT) && VIGIA_WDT
+#define cfg_VIGIA			100
+void VigiaWdtAlimenta(void);
+void VigiaWdtFalhou(uint8_t id_tarefa);
+#define cfg_ALIMENTA_VIGIA()	VigiaWdtAlimenta()
+#define cfg_VIGIA_FALHOU	VigiaWdtFalhou
+#endif
+
+/* base de tempo de us no TC4/TC5 (tempo_us.c), ligada com TEMPO_US=1 nos 
+   simbolos do projeto: da tambem o tempo dos registros do rastro, o 
+   relogio livre que recupera as marcas perdidas e o relogio do tempo 
+   bloqueado (cfg_TEMPO_BLOQUEIO) */
+#if defined(TEMPO_US) && TEMPO_US
+uint32_t TempoUs(void);
+#define cfg_RASTRO_TEMPO()		TempoUs()
+#define cfg_RASTRO_TEMPO_HZ		1000000UL
+#define cfg_RELOGIO_LIVRE()		TempoUs()
+#define cfg_RELOGIO_LIVRE_HZ	1000000UL
+#define cfg_TEMPO_BLOQUEIO_RELOGIO()	TempoUs()
+#define cfg_TEMPO_BLOQUEIO_HZ			1000000UL
+#endif
+
+/* energia estimada por tarefa (cfg_ENERGIA), ligada com ENERGIA_TAREFAS=1 
+   nos simbolos do projeto e mostrada pelo comando energy do console. As 
+   potencias sao as tipicas do SAM D21 a 3,3V, a substituir pelas medidas 
+   na placa com um analisador de energia: a CPU ativa em cada perfil de 
+   clock (perfil_clock.c) e em cada nivel de sono da tarefa ociosa (main.c) */
+#if defined(ENERGIA_TAREFAS) && ENERGIA_TAREFAS
+#define cfg_ENERGIA			1
+#define POTENCIA_48MHZ_UW	12500UL
+#define POTENCIA_8MHZ_UW	3500UL
+#define POTENCIA_IDLE_0_UW	6000UL
+#define POTENCIA_IDLE_1_UW	4600UL
+#define POTENCIA_IDLE_2_UW	3600UL
+#define POTENCIA_STANDBY_UW	15UL
+
+/* custo por ciclo, em pJ, da potencia em uW ao clock em Hz */
+#define CUSTO_CICLO(uw, hz)	((uint32_t)(((uw) * 1000000ULL) / (hz)))
+#define cfg_CUSTO_CICLO		CUSTO_CICLO(POTENCIA_48MHZ_UW, cfg_CPU_CLOCK_HZ)
+uint32_t OciosaCustoSono(void);
+#define cfg_CUSTO_SONO()	OciosaCustoSono()
+#endif
+
+/* HardFault guardado na memoria retida e reset imediato, relatado na 
+   partida seguinte (retida.c) */
+#define cfg_FALHA_GRAVE		1
+
+/* rastro de instrucoes do MTB (mtb.c), ligado com MTB_RASTRO=1 nos 
+   simbolos do projeto: para no primeiro prazo perdido de uma tarefa 
+   periodica (com cfg_MONITOR_PERIODICAS) */
+#if defined(MTB_RASTRO) && MTB_RASTRO
+void MtbPrazoPerdido(uint8_t id_tarefa, uint32_t atraso);
+#define cfg_PRAZO_PERDIDO	MtbPrazoPerdido
+#endif
+
+#endif /* CONF_RTOS_H_ */
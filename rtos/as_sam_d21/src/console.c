@@ -0,0 +1,949 @@
+/*
+ * console.c
+ *
+ * Console de desempenho como gancho da tarefa ociosa. Cada passo faz uma
+ * so coisa: tenta enviar a linha pendente, gera a proxima linha do comando
+ * em andamento ou le os bytes recebidos ate o fim de um comando. As linhas
+ * sao montadas por funcoes proprias, sem printf, para caber na pilha da
+ * tarefa ociosa. So usa servicos do nucleo, sem registradores do
+ * microcontrolador (o MTB e lido por mtb.c).
+ */
+
+#include <string.h>
+#include "console.h"
+#include "mtb.h"
+
+typedef enum
+{
+	COMANDO_NENHUM = 0,
+	COMANDO_AJUDA,
+	COMANDO_DESCONHECIDO,
+	COMANDO_TOP,
+	COMANDO_STACKS,
+	COMANDO_SEM,
+	COMANDO_PROTO,
+	COMANDO_RASTRO,
+	COMANDO_MTB,
+	COMANDO_MTB_INICIA,
+	COMANDO_ENERGIA,
+	COMANDO_FALHA,
+	COMANDO_OBJETOS,
+	COMANDO_BLOQUEIOS,
+	COMANDO_INANICAO
+} comando_console_t;
+
+typedef struct
+{
+	const char	*nome;
+	semaforo_t	*sem;
+} semaforo_console_t;
+
+typedef struct
+{
+	const char				*grupo;
+	const volatile uint32_t	*valores;
+	const char * const		*nomes;
+	uint8_t					numero;
+} contadores_console_t;
+
+static envia_console_t envia_console;
+
+static anel_t recepcao;
+static uint8_t area_recepcao[CONSOLE_TAM_RECEPCAO];
+static char comando[CONSOLE_TAM_COMANDO + 1];
+static uint8_t tam_comando;
+static uint8_t comando_longo;		/* passou de CONSOLE_TAM_COMANDO: ignorado ate o fim da linha */
+
+static char linha[CONSOLE_TAM_LINHA];
+static uint8_t tam_linha;
+static uint8_t linha_pendente;		/* linha montada, ainda nao aceita pela funcao de envio */
+
+static uint8_t comando_atual = COMANDO_NENHUM;
+static uint16_t passo;				/* linha do comando em andamento (0 = cabecalho) */
+static uint16_t indice;				/* tarefa, semaforo, contador ou registro da proxima linha */
+static uint8_t grupo;				/* grupo de contadores do comando proto */
+
+static semaforo_console_t semaforos[CONSOLE_SEMAFOROS];
+static uint8_t numero_semaforos;
+static contadores_console_t contadores[CONSOLE_CONTADORES];
+static uint8_t numero_contadores;
+
+#if cfg_ESTATISTICAS
+/* copia das estatisticas no inicio do top, e os tempos do top anterior para
+   o uso de CPU no intervalo */
+static estatisticas_tarefa_t estatisticas[NUMERO_DE_TAREFAS];
+static uint8_t numero_estatisticas;
+static uint64_t total_top, total_anterior;
+static uint64_t execucao_anterior[NUMERO_DE_TAREFAS + 1];
+#endif
+
+#if cfg_ENERGIA
+/* energia do sono e total (tarefas mais sono) no inicio do comando energy */
+static uint64_t energia_sono, energia_total;
+#endif
+
+#if cfg_REGISTRO_OBJETOS
+static const char * const nomes_objetos[] =
+{
+	"?", "sem", "mutex", "cond", "trava", "fila", "mem", "grupo", "temp"
+};
+#endif
+
+#if cfg_FALHA_GRAVE
+static const char * const nomes_quadro[] =
+{
+	"r0", "r1", "r2", "r3", "r12", "lr", "pc", "xpsr"
+};
+#endif
+
+#if cfg_RASTRO > 0
+static const char * const nomes_eventos[] =
+{
+	"?", "troca", "marca", "sem_aguarda", "sem_bloqueia", "sem_libera", "espera"
+};
+static uint16_t fim_rastro;			/* rastro_total no inicio do dump */
+static uint16_t sobrescritos;		/* registros sobrescritos durante o dump */
+#endif
+
+static uint8_t PassoConsole(void);
+
+#if cfg_TEMPO_BLOQUEIO
+/* contagens do relogio do tempo bloqueado em unidades de por_segundo 
+   (ex.: 1000 para ms) */
+static uint32_t TempoBloqueio(uint64_t contagens, uint32_t por_segundo)
+{
+	#ifdef cfg_TEMPO_BLOQUEIO_HZ
+	return (uint32_t)(contagens * por_segundo / cfg_TEMPO_BLOQUEIO_HZ);
+	#else
+	return (uint32_t)(contagens * por_segundo / MarcaTempoFrequencia());
+	#endif
+}
+#endif
+
+/* inicia o console e o registra como gancho da tarefa ociosa. Retorna 0 se
+   ja ha cfg_GANCHOS_OCIOSA ganchos */
+uint8_t ConsoleInicia(envia_console_t envia)
+{
+	envia_console = envia;
+	(void)AnelInicia(&recepcao, area_recepcao, CONSOLE_TAM_RECEPCAO, 1);
+	return OciosaRegistraGancho(PassoConsole);
+}
+
+/* entrega os bytes recebidos pela serial. Chamada por uma unica tarefa;
+   retorna quantos couberam (os demais sao perdidos, como numa linha
+   digitada rapido demais) */
+uint16_t ConsoleRecebe(const uint8_t *dados, uint16_t tamanho)
+{
+	return AnelEscreve(&recepcao, dados, tamanho);
+}
+
+/* registra um semaforo para o comando sem. Deve ser chamada antes de o
+   console receber comandos. Retorna 0 se nao ha mais espaco */
+uint8_t ConsoleRegistraSemaforo(const char *nome, semaforo_t *sem)
+{
+	if(numero_semaforos >= CONSOLE_SEMAFOROS)
+	{
+		return 0;
+	}
+	semaforos[numero_semaforos].nome = nome;
+	semaforos[numero_semaforos].sem = sem;
+	numero_semaforos++;
+	return 1;
+}
+
+/* registra numero contadores de 32 bits, com os seus nomes, para o comando
+   proto (ex.: os campos de estatisticas_receptor_t). Retorna 0 se nao ha
+   mais espaco */
+uint8_t ConsoleRegistraContadores(const char *grupo_contadores, const volatile uint32_t *valores,
+								  const char * const *nomes, uint8_t numero)
+{
+	if(numero_contadores >= CONSOLE_CONTADORES)
+	{
+		return 0;
+	}
+	contadores[numero_contadores].grupo = grupo_contadores;
+	contadores[numero_contadores].valores = valores;
+	contadores[numero_contadores].nomes = nomes;
+	contadores[numero_contadores].numero = numero;
+	numero_contadores++;
+	return 1;
+}
+
+/*
+ * Montagem das linhas. Os dois ultimos bytes de linha ficam para o "\r\n"
+ */
+#define MAXIMO_LINHA	(CONSOLE_TAM_LINHA - 2)
+
+/* texto alinhado a esquerda em largura colunas (0: sem alinhamento),
+   cortado se for maior */
+static void Texto(const char *texto, uint8_t largura)
+{
+	uint8_t colunas = 0;
+
+	if(texto == 0)
+	{
+		texto = "";
+	}
+	while(*texto != 0 && tam_linha < MAXIMO_LINHA && (largura == 0 || colunas < largura))
+	{
+		linha[tam_linha++] = *texto++;
+		colunas++;
+	}
+	while(tam_linha < MAXIMO_LINHA && colunas < largura)
+	{
+		linha[tam_linha++] = ' ';
+		colunas++;
+	}
+}
+
+/* numero decimal alinhado a direita em largura colunas. Com decimos, o
+   ultimo digito vem depois de um ponto (ex.: 1234 -> "123.4") */
+static void Numero(uint32_t valor, uint8_t largura, uint8_t decimos)
+{
+	char digitos[12];
+	uint8_t n = 0;
+
+	do
+	{
+		digitos[n++] = (char)('0' + valor % 10);
+		valor /= 10;
+		if(decimos && n == 1)
+		{
+			digitos[n++] = '.';
+			if(valor == 0)
+			{
+				digitos[n++] = '0';
+			}
+		}
+	} while(valor != 0);
+
+	while(largura > n && tam_linha < MAXIMO_LINHA)
+	{
+		linha[tam_linha++] = ' ';
+		largura--;
+	}
+	while(n > 0 && tam_linha < MAXIMO_LINHA)
+	{
+		linha[tam_linha++] = digitos[--n];
+	}
+}
+
+/* numero hexadecimal de 8 digitos */
+static void Hexa(uint32_t valor)
+{
+	uint8_t n;
+
+	for(n = 0; n < 8 && tam_linha < MAXIMO_LINHA; n++)
+	{
+		linha[tam_linha++] = "0123456789abcdef"[(valor >> 28) & 0xFU];
+		valor <<= 4;
+	}
+}
+
+/*
+ * Linhas de cada comando. Retornam 0 quando o comando terminou
+ */
+static uint8_t LinhaAjuda(void)
+{
+	if(passo == 0 && comando_atual == COMANDO_DESCONHECIDO)
+	{
+		Texto("comando desconhecido", 0);
+		return 1;
+	}
+	if(passo <= 1)
+	{
+		passo = 1;
+		Texto("comandos: top, stacks, sem, objs, waits, ready, proto, energy, trace dump, mtb dump, mtb start, fault", 0);
+		return 1;
+	}
+	return 0;
+}
+
+static uint8_t LinhaTop(void)
+{
+#if cfg_ESTATISTICAS
+	const estatisticas_tarefa_t *e;
+	uint64_t execucao, intervalo;
+
+	if(passo == 0)
+	{
+		numero_estatisticas = TarefaObtemEstatisticas(estatisticas, NUMERO_DE_TAREFAS, &total_top);
+		Texto("tarefa", 16);
+		Texto("   cpu%    trocas    preemp", 0);
+		return 1;
+	}
+	if(passo > numero_estatisticas)
+	{
+		total_anterior = total_top;
+		return 0;
+	}
+
+	/* uso de CPU em decimos de %, desde o top anterior. Os tempos sao
+	   reduzidos ate 32 bits para o produto nao estourar */
+	e = &estatisticas[passo - 1];
+	execucao = (e->tempo_execucao > execucao_anterior[e->id]) ? e->tempo_execucao - execucao_anterior[e->id] : 0;
+	intervalo = total_top - total_anterior;
+	execucao_anterior[e->id] = e->tempo_execucao;
+	while(intervalo > 0xFFFFFFFFUL)
+	{
+		intervalo >>= 1;
+		execucao >>= 1;
+	}
+
+	Texto(e->nome, 16);
+	Numero((intervalo != 0) ? (uint32_t)((execucao * 1000U) / intervalo) : 0, 7, 1);
+	Numero(e->trocas, 10, 0);
+	Numero(e->preempcoes, 10, 0);
+	return 1;
+#else
+	if(passo == 0)
+	{
+		Texto("top: compile com cfg_ESTATISTICAS = 1", 0);
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+/* energia estimada de cada tarefa e do sono desde o inicio, em uJ, e a
+   fracao do total */
+static uint8_t LinhaEnergia(void)
+{
+#if cfg_ENERGIA
+	uint64_t energia, total;
+	uint8_t i;
+
+	if(passo == 0)
+	{
+		numero_estatisticas = TarefaObtemEstatisticas(estatisticas, NUMERO_DE_TAREFAS, 0);
+		energia_sono = EnergiaSono();
+		energia_total = energia_sono;
+		for(i = 0; i < numero_estatisticas; i++)
+		{
+			energia_total += estatisticas[i].energia;
+		}
+		Texto("tarefa", 16);
+		Texto("     energia(uJ)      %", 0);
+		return 1;
+	}
+	if(passo > numero_estatisticas + 1)
+	{
+		return 0;
+	}
+
+	if(passo <= numero_estatisticas)
+	{
+		Texto(estatisticas[passo - 1].nome, 16);
+		energia = estatisticas[passo - 1].energia;
+	}
+	else
+	{
+		Texto("(sono)", 16);
+		energia = energia_sono;
+	}
+	total = energia_total;
+	Numero((uint32_t)(energia / 1000000U), 16, 0);
+	while(total > 0xFFFFFFFFUL)
+	{
+		total >>= 1;
+		energia >>= 1;
+	}
+	Numero((total != 0) ? (uint32_t)((energia * 1000U) / total) : 0, 7, 1);
+	return 1;
+#else
+	if(passo == 0)
+	{
+		Texto("energy: compile com cfg_ENERGIA = 1", 0);
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+static uint8_t LinhaStacks(void)
+{
+#if cfg_PINTA_PILHA
+	if(passo == 0)
+	{
+		indice = 1;
+		Texto("tarefa", 16);
+		Texto("  usada tamanho (palavras)", 0);
+		return 1;
+	}
+	while(indice <= NUMERO_DE_TAREFAS && (TCB[indice].tamanho_pilha == 0 || TCB_ESTADO(indice) == TERMINADA))
+	{
+		indice++;
+	}
+	if(indice > NUMERO_DE_TAREFAS)
+	{
+		return 0;
+	}
+
+	Texto(TarefaNome((uint8_t)indice), 16);
+	Numero((uint32_t)(TCB[indice].tamanho_pilha - TarefaPilhaLivre((uint8_t)indice)), 7, 0);
+	Numero(TCB[indice].tamanho_pilha, 8, 0);
+	indice++;
+	return 1;
+#else
+	if(passo == 0)
+	{
+		Texto("stacks: compile com cfg_PINTA_PILHA = 1", 0);
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+static uint8_t LinhaSemaforos(void)
+{
+	const semaforo_t *sem;
+	uint8_t esperando;
+
+	if(passo == 0)
+	{
+		Texto("semaforo", 16);
+		Texto("cont ", 0);
+		Texto("espera", 12);
+		#if cfg_ESPERAS_SEMAFORO
+		Texto("  aguardas bloqueios esgotados", 0);
+		#endif
+		return 1;
+	}
+	if(passo > numero_semaforos)
+	{
+		return 0;
+	}
+
+	sem = semaforos[passo - 1].sem;
+	esperando = sem->tarefaEsperando;
+	Texto(semaforos[passo - 1].nome, 16);
+	Numero(sem->contador, 4, 0);
+	Texto(" ", 0);
+	Texto((esperando != 0) ? TarefaNome(esperando) : "-", 12);
+	#if cfg_ESPERAS_SEMAFORO
+	Numero(sem->aguardas, 10, 0);
+	Numero(sem->bloqueios, 10, 0);
+	Numero(sem->esgotados, 10, 0);
+	#endif
+	return 1;
+}
+
+/* objetos do registro do nucleo, um por linha, copiados na hora da linha */
+static uint8_t LinhaObjetos(void)
+{
+#if cfg_REGISTRO_OBJETOS
+	estado_objeto_t objeto;
+
+	if(passo == 0)
+	{
+		Texto("objeto", 14);
+		Texto("tipo ", 0);
+		Texto("   cont  marca esp", 0);
+		Texto(" primeira", 0);
+		#if cfg_ESPERAS_SEMAFORO
+		Texto("    bloqueios", 0);
+		#endif
+		#if cfg_TEMPO_BLOQUEIO
+		Texto(" bloqueado ms", 0);
+		#endif
+		return 1;
+	}
+	if(ObjetosObtemEstado(&objeto, (uint8_t)(passo - 1), 1) == 0)
+	{
+		return 0;
+	}
+	Texto(objeto.nome, 14);
+	Texto((objeto.tipo < sizeof(nomes_objetos) / sizeof(nomes_objetos[0])) ? nomes_objetos[objeto.tipo] : "?", 5);
+	Numero(objeto.contagem, 7, 0);
+	Numero(objeto.marca_agua, 7, 0);
+	Numero(objeto.esperando, 4, 0);
+	Texto(" ", 0);
+	Texto((objeto.primeira != 0) ? TarefaNome(objeto.primeira) : "-", 12);
+	#if cfg_ESPERAS_SEMAFORO
+	Numero(objeto.bloqueios, 10, 0);		/* 0 fora dos semaforos */
+	#endif
+	#if cfg_TEMPO_BLOQUEIO
+	Numero(TempoBloqueio(objeto.tempo_bloqueado, 1000), 13, 0);
+	#endif
+	return 1;
+#else
+	if(passo == 0)
+	{
+		Texto("objs: compile com cfg_REGISTRO_OBJETOS = 1", 0);
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+/* tempo que cada tarefa passou bloqueada em semaforos, mutexes e filas */
+static uint8_t LinhaBloqueios(void)
+{
+#if cfg_TEMPO_BLOQUEIO
+	tempo_bloqueio_t bloqueio;
+
+	if(passo == 0)
+	{
+		indice = 1;
+		Texto("tarefa", 16);
+		Texto("   esperas bloqueado ms  maior us", 0);
+		return 1;
+	}
+	while(indice <= NUMERO_DE_TAREFAS && TCB_ESTADO(indice) == TERMINADA)
+	{
+		indice++;
+	}
+	if(!TarefaObtemTempoBloqueio((uint8_t)indice, &bloqueio))
+	{
+		return 0;
+	}
+
+	Texto(TarefaNome((uint8_t)indice), 16);
+	Numero(bloqueio.esperas, 10, 0);
+	Numero(TempoBloqueio(bloqueio.total, 1000), 13, 0);
+	Numero(TempoBloqueio(bloqueio.maior, 1000000), 10, 0);
+	indice++;
+	return 1;
+#else
+	if(passo == 0)
+	{
+		Texto("waits: compile com cfg_TEMPO_BLOQUEIO = 1", 0);
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+/* esperas de cada tarefa pronta pela CPU, em marcas de tempo */
+static uint8_t LinhaInanicao(void)
+{
+#if cfg_INANICAO > 0
+	inanicao_tarefa_t inanicao;
+
+	if(passo == 0)
+	{
+		indice = 1;
+		Texto("tarefa", 16);
+		Texto("     maior     atual inanicoes", 0);
+		return 1;
+	}
+	/* a ociosa nao e medida */
+	while(indice <= NUMERO_DE_TAREFAS && (TCB_ESTADO(indice) == TERMINADA || TCB_PRIORIDADE(indice) == 0))
+	{
+		indice++;
+	}
+	if(!TarefaObtemInanicao((uint8_t)indice, &inanicao))
+	{
+		return 0;
+	}
+
+	Texto(TarefaNome((uint8_t)indice), 16);
+	Numero(inanicao.maior_espera, 10, 0);
+	Numero(inanicao.espera_atual, 10, 0);
+	Numero(inanicao.inanicoes, 10, 0);
+	indice++;
+	return 1;
+#else
+	if(passo == 0)
+	{
+		Texto("ready: compile com cfg_INANICAO > 0", 0);
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+static uint8_t LinhaContadores(void)
+{
+	const contadores_console_t *c;
+
+	if(passo == 0)
+	{
+		grupo = 0;
+		indice = 0;
+	}
+	while(grupo < numero_contadores && indice >= contadores[grupo].numero)
+	{
+		grupo++;
+		indice = 0;
+	}
+	if(grupo >= numero_contadores)
+	{
+		if(passo == 0)
+		{
+			Texto("proto: nenhum contador registrado", 0);
+			return 1;
+		}
+		return 0;
+	}
+
+	c = &contadores[grupo];
+	Texto(c->grupo, 0);
+	Texto(".", 0);
+	Texto(c->nomes[indice], 24);
+	Numero(c->valores[indice], 11, 0);
+	indice++;
+	return 1;
+}
+
+#if cfg_RASTRO > 0
+/* um registro do rastro, nas colunas do trace dump */
+static void RegistroRastro(const registro_rastro_t *registro)
+{
+	Numero(registro->tempo >> 16, 6, 0);
+	Texto(".", 0);
+	Numero(registro->tempo & 0xFFFFU, 6, 0);
+	Texto(" ", 0);
+	Texto(TarefaNome(registro->tarefa), 16);
+	Texto(" ", 0);
+	Texto(nomes_eventos[(registro->evento < sizeof(nomes_eventos) / sizeof(nomes_eventos[0])) ? registro->evento : 0], 12);
+	Numero(registro->dado, 6, 0);
+}
+#endif
+
+static uint8_t LinhaRastro(void)
+{
+#if cfg_RASTRO > 0
+	const registro_rastro_t *r;
+	registro_rastro_t registro;
+	reg_atomica_t estado;
+
+	if(passo == 0)
+	{
+		fim_rastro = rastro_total;
+		indice = (uint16_t)(fim_rastro - ((fim_rastro < cfg_RASTRO) ? fim_rastro : cfg_RASTRO));
+		sobrescritos = 0;
+		Texto(" marca.ciclos ", 0);
+		Texto("tarefa", 17);
+		Texto("evento", 12);
+		Texto("  dado", 0);
+		return 1;
+	}
+
+	/* o rastro continua gravando durante o dump: os registros que ja foram
+	   sobrescritos sao pulados e contados no fim */
+	REG_ATOMICA_INICIO(estado);
+	while(indice != fim_rastro && (uint16_t)(rastro_total - indice) > cfg_RASTRO)
+	{
+		indice++;
+		sobrescritos++;
+	}
+	r = &rastro_nucleo[indice & (cfg_RASTRO - 1)];
+	registro = *r;
+	REG_ATOMICA_FIM(estado);
+
+	if(indice == fim_rastro)
+	{
+		if(sobrescritos == 0)
+		{
+			return 0;
+		}
+		Texto("sobrescritos durante o envio:", 0);
+		Numero(sobrescritos, 6, 0);
+		sobrescritos = 0;
+		return 1;
+	}
+
+	RegistroRastro(&registro);
+	indice++;
+	return 1;
+#else
+	if(passo == 0)
+	{
+		Texto("trace: compile com cfg_RASTRO > 0", 0);
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+/* desvios do MTB, do mais antigo ao mais recente, para decodifica_mtb.c.
+   O rastro e parado no inicio, se ainda estava ativo, para o proprio dump
+   nao sobrescreve-lo */
+static uint8_t LinhaMtb(void)
+{
+#if MTB_RASTRO
+	uint32_t origem, destino;
+
+	if(passo == 0)
+	{
+		if(comando_atual == COMANDO_MTB_INICIA)
+		{
+			MtbInicia();
+			Texto("mtb: rastro reiniciado", 0);
+			return 1;
+		}
+		MtbPara();
+		indice = 0;
+		Texto("mtb: desvios", 0);
+		Numero(MtbDesvios(), 6, 0);
+		return 1;
+	}
+	if(comando_atual == COMANDO_MTB_INICIA || indice >= MtbDesvios())
+	{
+		return 0;
+	}
+
+	MtbLe(indice, &origem, &destino);
+	Hexa(origem & ~MTB_EXCECAO);
+	Texto(" -> ", 0);
+	Hexa(destino & ~MTB_INICIO);
+	if(origem & MTB_EXCECAO)
+	{
+		Texto(" exc", 0);
+	}
+	if(destino & MTB_INICIO)
+	{
+		Texto(" inicio", 0);
+	}
+	indice++;
+	return 1;
+#else
+	if(passo == 0)
+	{
+		Texto("mtb: compile com MTB_RASTRO=1", 0);
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+/* ultimo HardFault capturado: cabecalho, registradores empilhados (dois 
+   por linha), retorno e pilhas, e os registros do rastro da captura */
+static uint8_t LinhaFalha(void)
+{
+#if cfg_FALHA_GRAVE
+	uint16_t i;
+
+	if(falha_grave.assinatura != FALHA_GRAVE_NOVA && falha_grave.assinatura != FALHA_GRAVE_RELATADA)
+	{
+		if(passo == 0)
+		{
+			Texto("fault: nenhuma", 0);
+			return 1;
+		}
+		return 0;
+	}
+	if(passo == 0)
+	{
+		Texto("fault: tarefa ", 0);
+		Texto(TarefaNome(falha_grave.tarefa), 0);
+		Texto(" marca", 0);
+		Numero(falha_grave.marca_tempo, 11, 0);
+		if(!falha_grave.quadro_valido)
+		{
+			Texto(" (pilha fora da RAM)", 0);
+		}
+		return 1;
+	}
+	if(passo <= 4)
+	{
+		i = (uint16_t)(2 * (passo - 1));
+		Texto(nomes_quadro[i], 5);
+		Hexa(falha_grave.quadro[i]);
+		Texto("  ", 0);
+		Texto(nomes_quadro[i + 1], 5);
+		Hexa(falha_grave.quadro[i + 1]);
+		return 1;
+	}
+	if(passo == 5)
+	{
+		Texto("exc  ", 0);
+		Hexa(falha_grave.retorno);
+		Texto("  msp  ", 0);
+		Hexa(falha_grave.msp);
+		Texto("  psp  ", 0);
+		Hexa(falha_grave.psp);
+		return 1;
+	}
+	#if cfg_RASTRO > 0
+	i = (uint16_t)(passo - 6);
+	if(i < cfg_FALHA_GRAVE_RASTRO && i < cfg_RASTRO && i < falha_grave.rastro_total)
+	{
+		RegistroRastro(&falha_grave.rastro[i]);
+		return 1;
+	}
+	#endif
+	return 0;
+#else
+	if(passo == 0)
+	{
+		Texto("fault: compile com cfg_FALHA_GRAVE", 0);
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+/* monta a proxima linha do comando em andamento */
+static uint8_t GeraLinha(void)
+{
+	switch(comando_atual)
+	{
+		case COMANDO_TOP:		return LinhaTop();
+		case COMANDO_STACKS:	return LinhaStacks();
+		case COMANDO_ENERGIA:	return LinhaEnergia();
+		case COMANDO_SEM:		return LinhaSemaforos();
+		case COMANDO_OBJETOS:	return LinhaObjetos();
+		case COMANDO_BLOQUEIOS:	return LinhaBloqueios();
+		case COMANDO_INANICAO:	return LinhaInanicao();
+		case COMANDO_PROTO:		return LinhaContadores();
+		case COMANDO_RASTRO:	return LinhaRastro();
+		case COMANDO_FALHA:		return LinhaFalha();
+		case COMANDO_MTB:
+		case COMANDO_MTB_INICIA:	return LinhaMtb();
+		default:				return LinhaAjuda();
+	}
+}
+
+/* interpreta o comando completo e ecoa a linha, que e a primeira da resposta */
+static void IniciaComando(void)
+{
+	comando[tam_comando] = 0;
+
+	if(strcmp(comando, "top") == 0)
+	{
+		comando_atual = COMANDO_TOP;
+	}
+	else if(strcmp(comando, "stacks") == 0)
+	{
+		comando_atual = COMANDO_STACKS;
+	}
+	else if(strcmp(comando, "sem") == 0)
+	{
+		comando_atual = COMANDO_SEM;
+	}
+	else if(strcmp(comando, "objs") == 0)
+	{
+		comando_atual = COMANDO_OBJETOS;
+	}
+	else if(strcmp(comando, "waits") == 0)
+	{
+		comando_atual = COMANDO_BLOQUEIOS;
+	}
+	else if(strcmp(comando, "ready") == 0)
+	{
+		comando_atual = COMANDO_INANICAO;
+	}
+	else if(strcmp(comando, "proto") == 0)
+	{
+		comando_atual = COMANDO_PROTO;
+	}
+	else if(strcmp(comando, "energy") == 0)
+	{
+		comando_atual = COMANDO_ENERGIA;
+	}
+	else if(strcmp(comando, "trace dump") == 0)
+	{
+		comando_atual = COMANDO_RASTRO;
+	}
+	else if(strcmp(comando, "mtb dump") == 0)
+	{
+		comando_atual = COMANDO_MTB;
+	}
+	else if(strcmp(comando, "mtb start") == 0)
+	{
+		comando_atual = COMANDO_MTB_INICIA;
+	}
+	else if(strcmp(comando, "fault") == 0)
+	{
+		comando_atual = COMANDO_FALHA;
+	}
+	else if(strcmp(comando, "help") == 0 || strcmp(comando, "?") == 0)
+	{
+		comando_atual = COMANDO_AJUDA;
+	}
+	else
+	{
+		comando_atual = COMANDO_DESCONHECIDO;
+	}
+	passo = 0;
+
+	tam_linha = 0;
+	Texto("> ", 0);
+	Texto(comando, 0);
+}
+
+/* le os bytes recebidos ate o fim de um comando. Retorna 1 se um comando
+   comecou */
+static uint8_t LeComando(void)
+{
+	uint8_t c;
+
+	while(AnelLe(&recepcao, &c, 1) == 1)
+	{
+		if(c == '\r' || c == '\n')
+		{
+			uint8_t completo = (tam_comando > 0 && !comando_longo);
+
+			if(completo)
+			{
+				IniciaComando();
+			}
+			tam_comando = 0;
+			comando_longo = 0;
+			if(completo)
+			{
+				return 1;
+			}
+		}
+		else if(c == '\b' || c == 0x7F)
+		{
+			if(tam_comando > 0)
+			{
+				tam_comando--;
+			}
+		}
+		else if(c >= ' ' && c <= '~')
+		{
+			if(tam_comando < CONSOLE_TAM_COMANDO)
+			{
+				comando[tam_comando++] = (char)c;
+			}
+			else
+			{
+				comando_longo = 1;
+			}
+		}
+		/* os demais bytes (ex.: quadros binarios) sao ignorados */
+	}
+	return 0;
+}
+
+/* gancho da tarefa ociosa: um passo curto. Retorna 1 enquanto ha resposta
+   a enviar, e entao a tarefa ociosa nao dorme */
+static uint8_t PassoConsole(void)
+{
+	if(linha_pendente)
+	{
+		if(envia_console((const uint8_t *)linha, tam_linha) == 0)
+		{
+			return 1;		/* sem espaco: tenta de novo no proximo passo */
+		}
+		linha_pendente = 0;
+		if(comando_atual != COMANDO_NENHUM)
+		{
+			return 1;
+		}
+	}
+
+	if(comando_atual != COMANDO_NENHUM)
+	{
+		tam_linha = 0;
+		if(!GeraLinha())
+		{
+			comando_atual = COMANDO_NENHUM;
+			return 1;		/* pode haver outro comando ja recebido */
+		}
+		passo++;
+	}
+	else if(!LeComando())
+	{
+		return 0;
+	}
+
+	linha[tam_linha++] = '\r';
+	linha[tam_linha++] = '\n';
+	linha_pendente = 1;
+	return 1;
+}
@@ -0,0 +1,87 @@
+/*
+ * console.h
+ *
+ * Console de desempenho pela serial: responde a comandos de texto com os
+ * contadores que o sistema ja mantem, para diagnosticar problemas de vazao
+ * em campo sem gravar uma versao de depuracao:
+ *  - top: uso de CPU de cada tarefa desde o top anterior, trocas e
+ *    preempcoes (cfg_ESTATISTICAS);
+ *  - stacks: marca d'agua das pilhas, em palavras (cfg_PINTA_PILHA);
+ *  - sem: contador e esperas dos semaforos registrados
+ *    (cfg_ESPERAS_SEMAFORO);
+ *  - objs: os objetos do registro do nucleo (cfg_REGISTRO_OBJETOS), com
+ *    contador, marca d'agua, tarefas esperando e a primeira delas;
+ *  - waits: esperas, tempo total bloqueado e maior espera de cada tarefa
+ *    em semaforos, mutexes e filas (cfg_TEMPO_BLOQUEIO), que tambem
+ *    aparece por objeto no objs;
+ *  - ready: maior espera e espera atual de cada tarefa pronta pela CPU, em
+ *    marcas, e as esperas acima do limite (cfg_INANICAO);
+ *  - proto: contadores registrados (ex.: estatisticas do receptor de
+ *    quadros);
+ *  - energy: energia estimada de cada tarefa e do sono, em uJ (cfg_ENERGIA);
+ *  - trace dump: o anel do rastro do nucleo, em texto (cfg_RASTRO);
+ *  - mtb dump: os desvios guardados pelo MTB, em hexadecimal, e mtb start,
+ *    que reinicia o rastro (MTB_RASTRO, ver mtb.h);
+ *  - fault: o ultimo HardFault capturado antes de um reset, com os
+ *    registradores, as pilhas e os ultimos registros do rastro
+ *    (cfg_FALHA_GRAVE).
+ *
+ * Nao tem tarefa propria: executa como gancho da tarefa ociosa
+ * (cfg_GANCHOS_OCIOSA), um passo curto por vez, entao so usa o tempo em
+ * que nenhuma tarefa esta pronta, e na pilha da tarefa ociosa (que deve
+ * ter CONSOLE_PILHA palavras a mais). Cada linha de resposta vai inteira
+ * para a funcao de envio, que nao espera (ex.: UartDmaEnvia); sem espaco,
+ * a linha e tentada de novo no proximo passo. Os bytes recebidos chegam
+ * por ConsoleRecebe, chamada por uma unica tarefa (ex.: a que le a UART).
+ * Os bytes que nao sao texto (ex.: quadros binarios na mesma serial) sao
+ * ignorados. Ex.:
+ *
+ *   ConsoleInicia(UartDmaEnvia);
+ *   ConsoleRegistraSemaforo("buffer", &SemaforoCheio);
+ */
+
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* bytes do anel de recepcao (potencia de 2) */
+#ifndef CONSOLE_TAM_RECEPCAO
+#define CONSOLE_TAM_RECEPCAO	32
+#endif
+
+/* maior comando e maior linha de resposta, em caracteres */
+#ifndef CONSOLE_TAM_COMANDO
+#define CONSOLE_TAM_COMANDO		16
+#endif
+#ifndef CONSOLE_TAM_LINHA
+#define CONSOLE_TAM_LINHA		80
+#endif
+
+/* semaforos e grupos de contadores registrados */
+#ifndef CONSOLE_SEMAFOROS
+#define CONSOLE_SEMAFOROS		8
+#endif
+#ifndef CONSOLE_CONTADORES
+#define CONSOLE_CONTADORES		4
+#endif
+
+/* palavras de pilha que o console usa na tarefa ociosa */
+#define CONSOLE_PILHA			(CONSOLE_TAM_LINHA / 4 + 40)
+
+#if cfg_GANCHOS_OCIOSA == 0
+#error "o console executa como gancho da tarefa ociosa: cfg_GANCHOS_OCIOSA > 0"
+#endif
+
+/* envia os bytes sem esperar: retorna tamanho, ou 0 se nao ha espaco agora */
+typedef uint16_t (*envia_console_t)(const uint8_t *dados, uint16_t tamanho);
+
+uint8_t ConsoleInicia(envia_console_t envia);
+uint16_t ConsoleRecebe(const uint8_t *dados, uint16_t tamanho);
+uint8_t ConsoleRegistraSemaforo(const char *nome, semaforo_t *sem);
+uint8_t ConsoleRegistraContadores(const char *grupo, const volatile uint32_t *valores,
+								  const char * const *nomes, uint8_t numero);
+
+#endif /* CONSOLE_H_ */
@@ -0,0 +1,113 @@
+/*
+ * crc_dma.c
+ *
+ * CRC-32 no modulo de CRC do DMAC, junto de uma copia por DMA (ver
+ * crc_dma.h).
+ */
+
+#include <asf.h>
+#include "dma.h"
+#include "crc_dma.h"
+
+#if CRC_DMA
+
+#if CRC_DMA_CANAL >= DMA_NUMERO_CANAIS
+#error "CRC_DMA_CANAL deve ser menor que DMA_NUMERO_CANAIS (dma.h)"
+#endif
+
+/* entrada do CRC: os bytes lidos pelo canal (CRCSRC 0x20 + canal) */
+#define FONTE_CRC			(0x20U + CRC_DMA_CANAL)
+
+/* valor de teste do CRC-32: "123456789" */
+#define CRC_TESTE			0xCBF43926UL
+
+static volatile uint8_t copia_pendente = 0;
+
+/* espera o fim da copia em andamento: o canal sai de pendente e ocupado */
+void CrcDmaAguarda(void)
+{
+	if(copia_pendente)
+	{
+		while((DMAC->PENDCH.reg | DMAC->BUSYCH.reg) & (1UL << CRC_DMA_CANAL)) {}
+		copia_pendente = 0;
+	}
+}
+
+/* zera o CRC para um novo calculo. O CRCCHKSUM so e escrito com o CRC
+   desabilitado; no CRC-32 comeca em 0xFFFFFFFF */
+void CrcDmaComeca(void)
+{
+	CrcDmaAguarda();
+	DMAC->CTRL.reg &= ~DMAC_CTRL_CRCENABLE;
+	DMAC->CRCCHKSUM.reg = 0xFFFFFFFFUL;
+	DMAC->CTRL.reg |= DMAC_CTRL_CRCENABLE;
+}
+
+/* copia tamanho bytes da origem para o destino, somando-os ao CRC, e
+   retorna sem esperar. Origem e destino nao podem mudar ate o fim da copia
+   (CrcDmaAguarda ou CrcDmaResultado) */
+void CrcDmaCopia(void *destino, const void *origem, uint16_t tamanho)
+{
+	DmacDescriptor *d = &dma_descritores[CRC_DMA_CANAL];
+	reg_atomica_t estado;
+
+	if(tamanho == 0)
+	{
+		return;
+	}
+	CrcDmaAguarda();
+
+	/* enderecos incrementados apontam para o fim da area */
+	d->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+					DMAC_BTCTRL_DSTINC | DMAC_BTCTRL_BLOCKACT_NOACT;
+	d->BTCNT.reg = tamanho;
+	d->SRCADDR.reg = (uint32_t)origem + tamanho;
+	d->DSTADDR.reg = (uint32_t)destino + tamanho;
+	d->DESCADDR.reg = 0;
+
+	copia_pendente = 1;
+	REG_ATOMICA_INICIO(estado);		/* CHID e compartilhado com o DMAC_Handler */
+	DMAC->CHID.reg = CRC_DMA_CANAL;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+	DMAC->SWTRIGCTRL.reg |= (1UL << CRC_DMA_CANAL);
+	REG_ATOMICA_FIM(estado);
+}
+
+/* CRC-32 dos bytes copiados desde CrcDmaComeca, depois do fim da copia em
+   andamento. No CRC-32, o DMAC ja le o CRCCHKSUM invertido bit a bit e
+   complementado, isto e, o CRC final */
+uint32_t CrcDmaResultado(void)
+{
+	CrcDmaAguarda();
+	return DMAC->CRCCHKSUM.reg;
+}
+
+/* prepara o canal (gatilho so por software, um bloco por disparo) e o CRC
+   na fonte do canal. Confere o resultado com o valor de teste do CRC-32 e
+   retorna 0 se for diferente */
+uint8_t CrcDmaInicia(void)
+{
+	static const uint8_t teste[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	uint8_t descarte[sizeof(teste)];
+	reg_atomica_t estado;
+
+	DmaIniciaControlador();
+
+	REG_ATOMICA_INICIO(estado);
+	DMAC->CHID.reg = CRC_DMA_CANAL;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while(DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST) {}
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(0) | DMAC_CHCTRLB_TRIGACT_BLOCK;
+	DMAC->CHINTENCLR.reg = DMAC_CHINTENCLR_MASK;
+	REG_ATOMICA_FIM(estado);
+
+	DMAC->CTRL.reg &= ~DMAC_CTRL_CRCENABLE;
+	DMAC->CRCCTRL.reg = DMAC_CRCCTRL_CRCBEATSIZE_BYTE | DMAC_CRCCTRL_CRCPOLY_CRC32 |
+						DMAC_CRCCTRL_CRCSRC(FONTE_CRC);
+
+	CrcDmaComeca();
+	CrcDmaCopia(descarte, teste, sizeof(teste));
+	return CrcDmaResultado() == CRC_TESTE;
+}
+
+#endif /* CRC_DMA */
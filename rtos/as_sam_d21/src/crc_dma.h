@@ -0,0 +1,50 @@
+/*
+ * crc_dma.h
+ *
+ * CRC-32 (IEEE 802.3, o mesmo do modo PROTOCOL_CRC32 das atividades t2 a
+ * t4) calculado pelo modulo de CRC do DMAC, sem a CPU: um canal copia os
+ * bytes da origem para o destino e o DMAC calcula o CRC dos bytes que
+ * passam pelo canal. A copia e assincrona: a CPU continua (ex.: analisando
+ * o CHK e o ETX do quadro) e so espera, se preciso, ao pedir o resultado.
+ *
+ * O CRC continua entre copias ate CrcDmaComeca, entao dados divididos em
+ * varios trechos (ex.: um quadro que atravessa dois blocos da recepcao)
+ * dao o CRC do total. Ha um unico modulo de CRC no DMAC: um usuario por
+ * vez (ex.: um receptor no modo RECEPTOR_CRC32, receptor_quadros.c).
+ *
+ * O canal de recepcao da UART nao pode levar o CRC: ele grava todos os
+ * bytes da linha, sem saber onde comecam e terminam os dados de cada
+ * quadro. Por isso o CRC vai na copia dos dados que o receptor ja faz.
+ *
+ * Ligado com CRC_DMA=1 nos simbolos do projeto. Ex.:
+ *
+ *   if(!CrcDmaInicia()) { CRC do DMAC com resultado errado }
+ *   CrcDmaComeca();
+ *   CrcDmaCopia(destino, origem, n);
+ *   ...
+ *   crc = CrcDmaResultado();
+ */
+
+
+#ifndef CRC_DMA_H_
+#define CRC_DMA_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef CRC_DMA
+#define CRC_DMA					0
+#endif
+
+/* canal do DMAC das copias (menor que DMA_NUMERO_CANAIS, dma.h) */
+#ifndef CRC_DMA_CANAL
+#define CRC_DMA_CANAL			5
+#endif
+
+uint8_t CrcDmaInicia(void);
+void CrcDmaComeca(void);
+void CrcDmaCopia(void *destino, const void *origem, uint16_t tamanho);
+void CrcDmaAguarda(void);
+uint32_t CrcDmaResultado(void);
+
+#endif /* CRC_DMA_H_ */
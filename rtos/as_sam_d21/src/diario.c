@@ -0,0 +1,390 @@
+/*
+ * diario.c
+ *
+ * Diario de mensagens com a formatacao adiada (ver diario.h). So usa
+ * servicos do nucleo, sem registradores do microcontrolador.
+ *
+ * Os indices de cada anel contam sem parar e a posicao e o indice &
+ * mascara: escritos so e alterado por quem grava (a tarefa dona do anel,
+ * ou as interrupcoes, uma de cada vez); lidos, so pela tarefa ociosa. Uma
+ * posicao so e reutilizada depois de lida, entao a tarefa ociosa nunca ve
+ * um registro pela metade.
+ */
+
+#include "diario.h"
+
+#define MASCARA_REGISTROS		(DIARIO_REGISTROS - 1)
+
+/* um anel por tarefa (0 e a ociosa) e o das interrupcoes */
+#define ANEL_INTERRUPCOES		(NUMERO_DE_TAREFAS + 1)
+#define NUMERO_ANEIS			(NUMERO_DE_TAREFAS + 2)
+
+#ifndef DIARIO_EM_INTERRUPCAO
+#define DIARIO_EM_INTERRUPCAO()	(LeIpsr() != 0)
+#endif
+
+#if DIARIO_BINARIO
+#define TAM_SAIDA				DIARIO_TAM_BINARIO
+#else
+#define TAM_SAIDA				DIARIO_TAM_LINHA
+#endif
+
+typedef struct
+{
+	registro_diario_t	registros[DIARIO_REGISTROS];
+	volatile uint8_t	escritos;
+	volatile uint8_t	lidos;
+	volatile uint16_t	descartados;	/* registros com o anel cheio */
+	uint16_t			informados;		/* descartados ja entregues pela tarefa ociosa */
+} anel_diario_t;
+
+static anel_diario_t aneis[NUMERO_ANEIS];
+static envia_diario_t envia_diario;
+
+static uint8_t saida[TAM_SAIDA];
+static uint16_t tam_saida;
+static uint8_t saida_pendente;		/* montada, ainda nao aceita pela funcao de envio */
+
+static uint8_t PassoDiario(void);
+
+/* inicia o diario e o registra como gancho da tarefa ociosa. Retorna 0 se
+   ja ha cfg_GANCHOS_OCIOSA ganchos */
+uint8_t DiarioInicia(envia_diario_t envia)
+{
+	envia_diario = envia;
+	return OciosaRegistraGancho(PassoDiario);
+}
+
+/* guarda o formato e os argumentos no anel da tarefa atual (ou das
+   interrupcoes), sem formatar. Usado pela macro DIARIO */
+void DiarioGrava(const char *formato, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+	anel_diario_t *anel;
+	registro_diario_t *r;
+	reg_atomica_t estado = 0;
+	uint8_t interrupcao = (uint8_t)DIARIO_EM_INTERRUPCAO();
+
+	if(interrupcao)
+	{
+		anel = &aneis[ANEL_INTERRUPCOES];
+		REG_ATOMICA_INICIO(estado);
+	}
+	else
+	{
+		anel = &aneis[tarefa_atual];
+	}
+
+	if((uint8_t)(anel->escritos - anel->lidos) >= DIARIO_REGISTROS)
+	{
+		anel->descartados++;
+	}
+	else
+	{
+		r = &anel->registros[anel->escritos & MASCARA_REGISTROS];
+		r->formato = formato;
+		r->tempo = DIARIO_TEMPO();
+		r->argumentos[0] = a;
+		#if DIARIO_ARGUMENTOS > 1
+		r->argumentos[1] = b;
+		#endif
+		#if DIARIO_ARGUMENTOS > 2
+		r->argumentos[2] = c;
+		#endif
+		#if DIARIO_ARGUMENTOS > 3
+		r->argumentos[3] = d;
+		#endif
+		BARREIRA_MEMORIA();		/* o registro fica visivel antes do novo indice */
+		anel->escritos++;
+	}
+
+	if(interrupcao)
+	{
+		REG_ATOMICA_FIM(estado);
+	}
+	(void)b;
+	(void)c;
+	(void)d;
+}
+
+/* registros descartados com os aneis cheios, desde o inicio */
+uint32_t DiarioDescartados(void)
+{
+	uint32_t total = 0;
+	uint8_t i;
+
+	for(i = 0; i < NUMERO_ANEIS; i++)
+	{
+		total += aneis[i].descartados;
+	}
+	return total;
+}
+
+/* acrescenta vezes o caractere c, ate o fim da saida */
+static uint16_t Repete(char *saida, uint16_t n, uint16_t tamanho, char c, uint8_t vezes)
+{
+	while(vezes-- > 0 && n < tamanho)
+	{
+		saida[n++] = c;
+	}
+	return n;
+}
+
+/* formata como o printf, com os argumentos de um registro. Conversoes:
+   %d %i %u %x %X %c %s %p %%, com '-', '0' e largura; l, h e z sao
+   ignorados. Retorna o numero de caracteres, sem terminar a cadeia */
+uint16_t DiarioFormata(char *saida, uint16_t tamanho, const char *formato, const uint32_t *argumentos)
+{
+	static const char digitos[] = "0123456789abcdef0123456789ABCDEF";
+	char numero[10];
+	const char *texto;
+	uint16_t n = 0;
+	uint8_t usados = 0, largura, esquerda, zeros, negativo, base, maiusculas;
+	uint8_t tam, completa;
+	uint32_t v;
+	char c;
+
+	while((c = *formato++) != 0 && n < tamanho)
+	{
+		if(c != '%')
+		{
+			saida[n++] = c;
+			continue;
+		}
+		esquerda = 0;
+		zeros = 0;
+		largura = 0;
+		for(;; formato++)
+		{
+			if(*formato == '-')
+			{
+				esquerda = 1;
+			}
+			else if(*formato == '0')
+			{
+				zeros = 1;
+			}
+			else
+			{
+				break;
+			}
+		}
+		while(*formato >= '0' && *formato <= '9')
+		{
+			if(largura < 100)
+			{
+				largura = (uint8_t)(largura * 10 + (*formato - '0'));
+			}
+			formato++;
+		}
+		while(*formato == 'l' || *formato == 'h' || *formato == 'z')
+		{
+			formato++;
+		}
+		c = *formato;
+		if(c == 0)
+		{
+			break;
+		}
+		formato++;
+		if(c == '%')
+		{
+			saida[n++] = '%';
+			continue;
+		}
+
+		v = (usados < DIARIO_ARGUMENTOS) ? argumentos[usados++] : 0;
+		negativo = 0;
+		base = 0;
+		maiusculas = 0;
+		switch(c)
+		{
+			case 'd':
+			case 'i':
+				if((int32_t)v < 0)
+				{
+					negativo = 1;
+					v = 0u - v;
+				}
+				base = 10;
+				break;
+			case 'u':
+				base = 10;
+				break;
+			case 'X':
+				maiusculas = 16;
+				base = 16;
+				break;
+			case 'x':
+				base = 16;
+				break;
+			case 'p':
+				n = Repete(saida, n, tamanho, '0', 1);
+				n = Repete(saida, n, tamanho, 'x', 1);
+				zeros = 1;
+				largura = 8;
+				base = 16;
+				break;
+			case 'c':
+				numero[0] = (char)v;
+				break;
+			case 's':
+				break;
+			default:
+				numero[0] = '?';
+				break;
+		}
+
+		if(base != 0)
+		{
+			tam = 0;
+			do
+			{
+				numero[sizeof(numero) - 1 - tam++] = digitos[maiusculas + v % base];
+				v /= base;
+			} while(v != 0);
+			texto = &numero[sizeof(numero) - tam];
+		}
+		else if(c == 's')
+		{
+			texto = (v != 0) ? (const char *)(uintptr_t)v : "(null)";
+			for(tam = 0; tam < 255 && texto[tam] != 0; tam++) {}
+		}
+		else
+		{
+			texto = numero;
+			tam = 1;
+		}
+
+		completa = (uint8_t)(tam + negativo);
+		completa = (largura > completa) ? (uint8_t)(largura - completa) : 0;
+		if(!esquerda && !(zeros && base != 0))
+		{
+			n = Repete(saida, n, tamanho, ' ', completa);
+		}
+		if(negativo)
+		{
+			n = Repete(saida, n, tamanho, '-', 1);
+		}
+		if(!esquerda && zeros && base != 0)
+		{
+			n = Repete(saida, n, tamanho, '0', completa);
+		}
+		while(tam-- > 0 && n < tamanho)
+		{
+			saida[n++] = *texto++;
+		}
+		if(esquerda)
+		{
+			n = Repete(saida, n, tamanho, ' ', completa);
+		}
+	}
+	return n;
+}
+
+#if DIARIO_BINARIO
+static void Le32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+/* registro binario do anel (ver DIARIO_INICIO) */
+static void Monta(uint8_t anel, uint32_t tempo, const char *formato, const uint32_t *argumentos)
+{
+	uint8_t i;
+
+	saida[0] = DIARIO_INICIO;
+	saida[1] = (anel == ANEL_INTERRUPCOES) ? DIARIO_ISR : anel;
+	saida[2] = DIARIO_ARGUMENTOS;
+	Le32(&saida[3], tempo);
+	Le32(&saida[7], (uint32_t)(uintptr_t)formato);
+	for(i = 0; i < DIARIO_ARGUMENTOS; i++)
+	{
+		Le32(&saida[11 + 4 * i], argumentos[i]);
+	}
+	tam_saida = DIARIO_TAM_BINARIO;
+}
+#else
+/* linha "tempo tarefa: mensagem" */
+static void Monta(uint8_t anel, uint32_t tempo, const char *formato, const uint32_t *argumentos)
+{
+	uint32_t cabecalho[DIARIO_ARGUMENTOS];
+	char *linha = (char *)saida;
+
+	cabecalho[0] = tempo;
+	cabecalho[1] = (uint32_t)(uintptr_t)((anel == ANEL_INTERRUPCOES) ? "isr" : TarefaNome(anel));
+	tam_saida = DiarioFormata(linha, DIARIO_TAM_LINHA - 2, "%u %s: ", cabecalho);
+	if(formato != 0)
+	{
+		tam_saida += DiarioFormata(&linha[tam_saida], (uint16_t)(DIARIO_TAM_LINHA - 2 - tam_saida),
+								   formato, argumentos);
+	}
+	else
+	{
+		tam_saida += DiarioFormata(&linha[tam_saida], (uint16_t)(DIARIO_TAM_LINHA - 2 - tam_saida),
+								   "%u descartados", argumentos);
+	}
+	linha[tam_saida++] = '\r';
+	linha[tam_saida++] = '\n';
+}
+#endif
+
+/* gancho da tarefa ociosa: entrega um registro por passo, primeiro os
+   descartes ainda nao informados e depois o registro mais antigo de todos
+   os aneis. Retorna 1 enquanto ha registros a entregar */
+static uint8_t PassoDiario(void)
+{
+	uint32_t descartes[DIARIO_ARGUMENTOS] = {0};
+	anel_diario_t *anel;
+	registro_diario_t *r;
+	uint32_t tempo = 0;
+	uint16_t descartados;
+	uint8_t i, escolhido = NUMERO_ANEIS;
+
+	if(saida_pendente)
+	{
+		if(envia_diario(saida, tam_saida) == 0)
+		{
+			return 1;		/* sem espaco: tenta de novo no proximo passo */
+		}
+		saida_pendente = 0;
+	}
+
+	for(i = 0; i < NUMERO_ANEIS; i++)
+	{
+		anel = &aneis[i];
+		descartados = anel->descartados;
+		if(descartados != anel->informados)
+		{
+			anel->informados = descartados;
+			descartes[0] = descartados;
+			Monta(i, DIARIO_TEMPO(), 0, descartes);
+			saida_pendente = 1;
+			return 1;
+		}
+		if(anel->lidos != anel->escritos)
+		{
+			BARREIRA_MEMORIA();		/* o registro e lido depois do indice de escrita */
+			r = &anel->registros[anel->lidos & MASCARA_REGISTROS];
+			if(escolhido == NUMERO_ANEIS || (int32_t)(r->tempo - tempo) < 0)
+			{
+				escolhido = i;
+				tempo = r->tempo;
+			}
+		}
+	}
+	if(escolhido == NUMERO_ANEIS)
+	{
+		return 0;
+	}
+
+	anel = &aneis[escolhido];
+	r = &anel->registros[anel->lidos & MASCARA_REGISTROS];
+	Monta(escolhido, r->tempo, r->formato, r->argumentos);
+	BARREIRA_MEMORIA();		/* a posicao so e liberada depois da leitura */
+	anel->lidos++;
+	saida_pendente = 1;
+	return 1;
+}
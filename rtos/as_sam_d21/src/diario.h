@@ -0,0 +1,140 @@
+/*
+ * diario.h
+ *
+ * Diario de mensagens com a formatacao adiada: DIARIO(formato, ...) so
+ * guarda o ponteiro do formato, o tempo e ate DIARIO_ARGUMENTOS argumentos
+ * de 32 bits, sem formatar nada. O printf da newlib gasta milhares de
+ * ciclos e centenas de bytes de pilha no Cortex-M0+, na tarefa que chama;
+ * o registro custa algumas dezenas de ciclos, e a formatacao fica para a
+ * tarefa ociosa ou para o computador.
+ *
+ * Cada tarefa tem o seu anel de DIARIO_REGISTROS registros, escrito so por
+ * ela e lido so pela tarefa ociosa: o registro nao espera nem desabilita
+ * as interrupcoes. As interrupcoes (IPSR diferente de 0) escrevem em um
+ * anel proprio, com as interrupcoes desabilitadas durante a copia do
+ * registro (o Cortex-M0+ nao tem LDREX/STREX). Com o anel cheio, o registro
+ * e descartado e contado; os registros ja guardados nunca sao sobrescritos
+ * enquanto a tarefa ociosa os le.
+ *
+ * A tarefa ociosa (gancho de cfg_GANCHOS_OCIOSA, na sua pilha) entrega um
+ * registro por passo, o mais antigo de todos os aneis, para a funcao de
+ * envio, que nao espera (ex.: UartDmaEnvia):
+ *  - em texto (DIARIO_BINARIO 0): "tempo tarefa: mensagem", formatado por
+ *    DiarioFormata, sem printf. Conversoes: %d %i %u %x %X %c %s %p %%,
+ *    com '-', '0' e largura; l, h e z sao aceitos e ignorados;
+ *  - em binario (DIARIO_BINARIO 1): o registro como esta, e o computador
+ *    busca o formato (e as cadeias de %s) no ELF do programa, com
+ *    host_posix/decodifica_diario.c. A serial leva 4 bytes por argumento
+ *    em vez do texto inteiro, e a placa nao formata nada.
+ *
+ * Os argumentos sao copiados como uint32_t: %s so serve para cadeias que
+ * existem ate a formatacao (ex.: constantes na flash), e valores de 64 bits
+ * ou float nao sao suportados. Ex.:
+ *
+ *   DiarioInicia(UartDmaEnvia);
+ *   ...
+ *   DIARIO("fila cheia, %u descartes", descartes);
+ *   DIARIO("estado %s -> %s", nomes[anterior], nomes[atual]);
+ */
+
+
+#ifndef DIARIO_H_
+#define DIARIO_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* 0 remove as chamadas de DIARIO, sem avaliar os argumentos */
+#ifndef DIARIO_HABILITADO
+#define DIARIO_HABILITADO		1
+#endif
+
+/* registros do anel de cada tarefa e do anel das interrupcoes
+   (potencia de 2, ate 128) */
+#ifndef DIARIO_REGISTROS
+#define DIARIO_REGISTROS		8
+#endif
+
+/* argumentos de cada registro (2 a 4) */
+#ifndef DIARIO_ARGUMENTOS
+#define DIARIO_ARGUMENTOS		4
+#endif
+
+/* 1 entrega os registros em binario, para o computador formatar */
+#ifndef DIARIO_BINARIO
+#define DIARIO_BINARIO			0
+#endif
+
+/* tempo dos registros: sem definir, as marcas de tempo. Ex.: TempoUs()
+   com DIARIO_TEMPO_HZ 1000000UL */
+#ifdef DIARIO_TEMPO
+#ifndef DIARIO_TEMPO_HZ
+#error "DIARIO_TEMPO exige DIARIO_TEMPO_HZ"
+#endif
+#else
+#define DIARIO_TEMPO()			((uint32_t)ObtemMarcasDeTempo())
+#endif
+
+/* maior linha de texto, em caracteres */
+#ifndef DIARIO_TAM_LINHA
+#define DIARIO_TAM_LINHA		80
+#endif
+
+/* inicio de cada registro binario, seguido da tarefa (DIARIO_ISR para as
+   interrupcoes), do numero de argumentos, do tempo, do endereco
+   do formato e dos argumentos, little-endian. Formato 0 informa descartes:
+   o primeiro argumento e o total descartado do anel */
+#define DIARIO_INICIO			0xD1
+#define DIARIO_ISR				0xFF
+#define DIARIO_TAM_BINARIO		(3 + 8 + 4 * DIARIO_ARGUMENTOS)
+
+/* palavras de pilha que o diario usa na tarefa ociosa */
+#define DIARIO_PILHA			(DIARIO_TAM_LINHA / 4 + DIARIO_ARGUMENTOS + 32)
+
+#if (DIARIO_REGISTROS & (DIARIO_REGISTROS - 1)) != 0 || DIARIO_REGISTROS > 128
+#error "DIARIO_REGISTROS deve ser potencia de 2 ate 128"
+#endif
+#if DIARIO_ARGUMENTOS < 2 || DIARIO_ARGUMENTOS > 4
+#error "DIARIO_ARGUMENTOS deve estar entre 2 e 4"
+#endif
+#if cfg_GANCHOS_OCIOSA == 0
+#error "o diario e entregue por um gancho da tarefa ociosa: cfg_GANCHOS_OCIOSA > 0"
+#endif
+
+/* envia os bytes sem esperar: retorna tamanho, ou 0 se nao ha espaco agora */
+typedef uint16_t (*envia_diario_t)(const uint8_t *dados, uint16_t tamanho);
+
+/**
+* \struct registro_diario_t
+* Uma chamada de DIARIO, sem formatar
+*/
+
+typedef struct
+{
+	const char	*formato;
+	uint32_t	tempo;
+	uint32_t	argumentos[DIARIO_ARGUMENTOS];
+} registro_diario_t;
+
+/* escolhe DiarioGravaN pelo numero de argumentos depois do formato */
+#define DIARIO_SELECIONA(_0, _1, _2, _3, _4, nome, ...)	nome
+
+#if DIARIO_HABILITADO
+#define DIARIO(...)		DIARIO_SELECIONA(__VA_ARGS__, DiarioGrava4, DiarioGrava3, DiarioGrava2, \
+										 DiarioGrava1, DiarioGrava0, 0)(__VA_ARGS__)
+#else
+#define DIARIO(...)		((void)0)
+#endif
+
+#define DiarioGrava0(f)				DiarioGrava((f), 0, 0, 0, 0)
+#define DiarioGrava1(f, a)			DiarioGrava((f), (uint32_t)(a), 0, 0, 0)
+#define DiarioGrava2(f, a, b)		DiarioGrava((f), (uint32_t)(a), (uint32_t)(b), 0, 0)
+#define DiarioGrava3(f, a, b, c)	DiarioGrava((f), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0)
+#define DiarioGrava4(f, a, b, c, d)	DiarioGrava((f), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+
+uint8_t DiarioInicia(envia_diario_t envia);
+void DiarioGrava(const char *formato, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+uint16_t DiarioFormata(char *saida, uint16_t tamanho, const char *formato, const uint32_t *argumentos);
+uint32_t DiarioDescartados(void);
+
+#endif /* DIARIO_H_ */
@@ -0,0 +1,84 @@
+/*
+ * dma.c
+ *
+ * Controlador de DMA (DMAC) compartilhado pelos drivers do projeto.
+ */
+
+#include "dma.h"
+#include "rtos.h"
+
+#if defined(OTIMIZA_DESEMPENHO) && OTIMIZA_DESEMPENHO
+#pragma GCC optimize ("O2")
+#endif
+
+/* secao de descritores e de retorno: alinhadas em 128 bits */
+COMPILER_ALIGNED(16) DmacDescriptor dma_descritores[DMA_NUMERO_CANAIS];
+COMPILER_ALIGNED(16) DmacDescriptor dma_retorno[DMA_NUMERO_CANAIS];
+
+static tratador_dma_t tratadores[DMA_NUMERO_CANAIS];
+
+/* habilita o DMAC com todos os niveis de prioridade, uma unica vez */
+void DmaIniciaControlador(void)
+{
+	if(DMAC->CTRL.reg & DMAC_CTRL_DMAENABLE)
+	{
+		return;
+	}
+
+	system_ahb_clock_set_mask(PM_AHBMASK_DMAC);
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBB, PM_APBBMASK_DMAC);
+
+	DMAC->BASEADDR.reg = (uint32_t)dma_descritores;
+	DMAC->WRBADDR.reg = (uint32_t)dma_retorno;
+	DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+
+	NVIC_EnableIRQ(DMAC_IRQn);
+}
+
+/* registra o tratador da interrupcao do canal, antes de habilitar o canal */
+void DmaRegistraTratador(uint8_t canal, tratador_dma_t tratador)
+{
+	tratadores[canal] = tratador;
+}
+
+/* beats que faltam no bloco atual do canal: o contador do canal em execucao, 
+   ou o da copia de retorno. Chamada com as interrupcoes desabilitadas, 
+   porque troca o canal selecionado em DMAC->CHID */
+uint16_t DmaRestante(uint8_t canal)
+{
+	uint32_t ativo = DMAC->ACTIVE.reg;
+
+	if((ativo & DMAC_ACTIVE_ABUSY) &&
+		((ativo & DMAC_ACTIVE_ID_Msk) >> DMAC_ACTIVE_ID_Pos) == canal)
+	{
+		return (uint16_t)((ativo & DMAC_ACTIVE_BTCNT_Msk) >> DMAC_ACTIVE_BTCNT_Pos);
+	}
+	return dma_retorno[canal].BTCNT.reg;
+}
+
+/* interrupcao unica do DMAC: atende todos os canais com flags pendentes. 
+   Com cfg_INTERRUPCOES_ANINHADAS, as tarefas acordadas pelos tratadores 
+   dos canais sao escalonadas uma vez so, na saida */
+void DMAC_Handler(void)
+{
+	uint32_t pendentes = DMAC->INTSTATUS.reg;
+	uint8_t canal;
+
+	InterrupcaoEntra();
+	for(canal = 0; canal < DMA_NUMERO_CANAIS; canal++)
+	{
+		if(pendentes & (1UL << canal))
+		{
+			DMAC->CHID.reg = canal;
+			if(tratadores[canal] != 0)
+			{
+				tratadores[canal]();
+			}
+			else
+			{
+				DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_MASK;
+			}
+		}
+	}
+	InterrupcaoSai();
+}
@@ -0,0 +1,66 @@
+/*
+ * eventos.c
+ *
+ * Sistema de eventos (EVSYS) do SAM D21.
+ */
+
+#include "eventos.h"
+
+/* configuracao escrita em cada canal, repetida no disparo por software */
+static uint32_t config_canais[EVSYS_CHANNELS];
+
+/* liga o clock do EVSYS e o reinicia, desconectando todos os canais */
+void EventosInicia(void)
+{
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_EVSYS);
+
+	EVSYS->CTRL.reg = EVSYS_CTRL_SWRST;
+	while(EVSYS->CTRL.reg & EVSYS_CTRL_SWRST) {}
+}
+
+/* configura o canal com o gerador de eventos e o caminho. 
+   gerador = 0 deixa o canal apenas para disparos por software */
+void EventoCanalConfigura(uint8_t canal, uint8_t gerador, caminho_evento_t caminho)
+{
+	struct system_gclk_chan_config config_clock;
+	uint32_t config;
+
+	config = EVSYS_CHANNEL_CHANNEL(canal) | EVSYS_CHANNEL_EVGEN(gerador) | EVSYS_CHANNEL_PATH(caminho);
+
+	if(caminho == EVENTO_ASSINCRONO)
+	{
+		config |= EVSYS_CHANNEL_EDGSEL_NO_EVT_OUTPUT;	/* obrigatorio no caminho assincrono */
+	}
+	else
+	{
+		config |= EVSYS_CHANNEL_EDGSEL_RISING_EDGE;
+
+		/* os caminhos sincrono e ressincronizado precisam do clock do canal */
+		system_gclk_chan_get_config_defaults(&config_clock);
+		config_clock.source_generator = GCLK_GENERATOR_0;
+		system_gclk_chan_set_config(EVSYS_GCLK_ID_0 + canal, &config_clock);
+		system_gclk_chan_enable(EVSYS_GCLK_ID_0 + canal);
+	}
+
+	config_canais[canal] = config;
+	EVSYS->CHANNEL.reg = config;
+}
+
+/* conecta o usuario de eventos ao canal. Um canal pode ter varios usuarios */
+void EventoUsuarioConecta(uint8_t usuario, uint8_t canal)
+{
+	EVSYS->USER.reg = EVSYS_USER_USER(usuario) | EVSYS_USER_CHANNEL(canal + 1);	/* 0 = nenhum canal */
+}
+
+void EventoUsuarioDesconecta(uint8_t usuario)
+{
+	EVSYS->USER.reg = EVSYS_USER_USER(usuario) | EVSYS_USER_CHANNEL(0);
+}
+
+/* gera um evento por software no canal, para testes ou para iniciar uma 
+   cadeia de eventos. O registrador CHANNEL e escrito inteiro, entao a 
+   configuracao do canal e repetida */
+void EventoDispara(uint8_t canal)
+{
+	EVSYS->CHANNEL.reg = config_canais[canal] | EVSYS_CHANNEL_SWEVT;
+}
@@ -0,0 +1,34 @@
+/*
+ * eventos.h
+ *
+ * Sistema de eventos (EVSYS): liga um gerador de eventos de um periferico 
+ * (ex.: estouro de um TC, borda de um pino do EIC, fim de conversao do ADC) 
+ * a um ou mais usuarios (ex.: inicio de conversao do ADC, canal do DMAC), 
+ * sem passar pela CPU. Os numeros de geradores e usuarios sao os 
+ * EVSYS_ID_GEN_x e EVSYS_ID_USER_x do cabecalho do microcontrolador.
+ */
+
+
+#ifndef EVENTOS_H_
+#define EVENTOS_H_
+
+#include <asf.h>
+#include "stdint.h"
+
+/* caminho do evento no canal. O assincrono nao usa clock e tem a menor 
+   latencia, mas nao detecta bordas nem pode gerar interrupcao; os outros 
+   usam o clock do canal (gerador 0) e detectam a borda de subida */
+typedef enum
+{
+	EVENTO_SINCRONO = 0,
+	EVENTO_RESSINCRONIZADO,
+	EVENTO_ASSINCRONO
+} caminho_evento_t;
+
+void EventosInicia(void);
+void EventoCanalConfigura(uint8_t canal, uint8_t gerador, caminho_evento_t caminho);
+void EventoUsuarioConecta(uint8_t usuario, uint8_t canal);
+void EventoUsuarioDesconecta(uint8_t usuario);
+void EventoDispara(uint8_t canal);
+
+#endif /* EVENTOS_H_ */
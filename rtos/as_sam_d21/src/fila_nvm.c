@@ -0,0 +1,496 @@
+/*
+ * fila_nvm.c
+ *
+ * Fila persistente de quadros na flash (ver fila_nvm.h).
+ *
+ * Cada pagina tem um cabecalho com a sequencia (cresce a cada pagina
+ * gravada, de quadros ou de confirmacao), o tipo, os bytes usados e a soma
+ * de verificacao. Os quadros sao registros {tamanho (16 bits), bytes}
+ * seguidos; continuacao conta os bytes do comeco da pagina que terminam um
+ * registro da pagina anterior, e anterior e a sequencia (16 bits baixos) da
+ * pagina de quadros anterior. Se a pagina anterior foi perdida, a leitura
+ * descarta o registro pela metade e pula a continuacao.
+ *
+ * As paginas sao procuradas pela sequencia, nao pela posicao: a proxima
+ * pagina lida e a de menor sequencia maior que a atual, o que atravessa as
+ * linhas puladas depois de um reset e as paginas invalidas.
+ */
+
+#include <asf.h>
+#include "fila_nvm.h"
+#include "retida.h"
+
+#define PAGINAS					(FILA_NVM_LINHAS * 4)
+#define NENHUMA					0xFFFF
+
+#define TIPO_QUADROS			0x5A
+#define TIPO_CONFIRMACAO		0xC3
+#define TIPO_APAGADA			0xFF
+
+#if (FILA_NVM_INICIO) % FILA_NVM_TAM_LINHA != 0
+#error "FILA_NVM_INICIO deve ser o inicio de uma linha da flash"
+#endif
+
+typedef struct
+{
+	uint32_t	sequencia;
+	uint16_t	anterior;			/* pagina de quadros anterior */
+	uint8_t		tipo;
+	uint8_t		usados;				/* bytes de dados */
+	uint8_t		continuacao;		/* bytes do registro da pagina anterior */
+	uint8_t		reservado;
+	uint16_t	soma;				/* Fletcher-16 do resto da pagina */
+	uint8_t		dados[FILA_NVM_DADOS];
+} pagina_nvm_t;
+
+/* a pagina so pode ser escrita no buffer de paginas em palavras */
+typedef union
+{
+	pagina_nvm_t	p;
+	uint32_t		palavras[FILA_NVM_TAM_PAGINA / 4];
+} buffer_pagina_t;
+
+estatisticas_fila_nvm_t estatisticas_fila_nvm;
+
+/* o estado da fila fica na memoria retida (retida.h): depois de um reset
+   sem falta de energia, FilaNvmInicia o usa sem varrer a flash, e os
+   quadros da pagina de montagem nao se perdem */
+RETIDA static buffer_pagina_t montagem;			/* pagina de quadros na RAM */
+RETIDA static uint16_t restante_registro;		/* bytes do registro sendo guardado */
+RETIDA static uint16_t tamanho_registro;
+
+RETIDA static uint16_t proxima_escrita;			/* indice da proxima pagina gravada */
+RETIDA static uint32_t proxima_sequencia;
+RETIDA static uint16_t ultimo_quadros;			/* sequencia da ultima pagina de quadros */
+RETIDA static uint16_t pagina_confirmacao;		/* ultima pagina de confirmacao */
+
+/* leitura: depois do ultimo registro lido e do ultimo confirmado */
+RETIDA static uint32_t lida_sequencia, confirmada_sequencia;
+RETIDA static uint8_t lida_posicao, confirmada_posicao;
+
+/* paginas com a soma errada, ignoradas ate a linha ser apagada */
+RETIDA static uint8_t invalidas[(PAGINAS + 7) / 8];
+
+/* estado valido: a fila foi iniciada e o reset nao interrompeu uma
+   alteracao (ex.: no meio de uma gravacao, com a pagina pela metade) */
+RETIDA static uint8_t iniciada;
+RETIDA static uint8_t alterando;
+
+static const pagina_nvm_t *Pagina(uint16_t indice)
+{
+	return (const pagina_nvm_t *)(FILA_NVM_INICIO + (uint32_t)indice * FILA_NVM_TAM_PAGINA);
+}
+
+static uint16_t Soma(const pagina_nvm_t *p)
+{
+	const uint8_t *b = (const uint8_t *)p;
+	uint16_t s1 = 0, s2 = 0;
+	uint8_t i;
+
+	for(i = 0; i < FILA_NVM_TAM_PAGINA; i++)
+	{
+		if(i == 10)
+		{
+			i++;						/* a propria soma */
+			continue;
+		}
+		s1 = (uint16_t)((s1 + b[i]) % 255);
+		s2 = (uint16_t)((s2 + s1) % 255);
+	}
+	return (uint16_t)((s2 << 8) | s1);
+}
+
+static uint8_t Invalida(uint16_t indice)
+{
+	return (uint8_t)(invalidas[indice >> 3] & (1u << (indice & 7)));
+}
+
+/* pagina de quadros valida com a sequencia, ou NENHUMA */
+static uint16_t Procura(uint32_t sequencia)
+{
+	uint16_t i;
+
+	for(i = 0; i < PAGINAS; i++)
+	{
+		if(Pagina(i)->tipo == TIPO_QUADROS && Pagina(i)->sequencia == sequencia && !Invalida(i))
+		{
+			return i;
+		}
+	}
+	return NENHUMA;
+}
+
+/* pagina de quadros valida com a menor sequencia maior que a dada */
+static uint16_t ProximaPagina(uint32_t sequencia)
+{
+	const pagina_nvm_t *p;
+	uint16_t i, proxima = NENHUMA;
+
+	for(i = 0; i < PAGINAS; i++)
+	{
+		p = Pagina(i);
+		if(p->tipo == TIPO_QUADROS && p->sequencia > sequencia && !Invalida(i) &&
+		   (proxima == NENHUMA || p->sequencia < Pagina(proxima)->sequencia))
+		{
+			proxima = i;
+		}
+	}
+	return proxima;
+}
+
+static void ComandoNvm(uint32_t endereco, uint32_t comando)
+{
+	while(!(NVMCTRL->INTFLAG.reg & NVMCTRL_INTFLAG_READY));
+	NVMCTRL->STATUS.reg = NVMCTRL_STATUS_MASK;
+	NVMCTRL->ADDR.reg = endereco / 2;
+	NVMCTRL->CTRLA.reg = (uint16_t)(comando | NVMCTRL_CTRLA_CMDEX_KEY);
+	while(!(NVMCTRL->INTFLAG.reg & NVMCTRL_INTFLAG_READY));
+}
+
+/* apaga a linha, contando as paginas ainda nao lidas. Retorna 1 se a
+   ultima confirmacao estava nela */
+static uint8_t ApagaLinha(uint16_t linha)
+{
+	const pagina_nvm_t *p;
+	uint16_t i;
+	uint8_t confirmacao = 0;
+
+	for(i = (uint16_t)(linha * 4); i < (uint16_t)(linha * 4 + 4); i++)
+	{
+		p = Pagina(i);
+		if(p->tipo == TIPO_QUADROS && !Invalida(i) &&
+		   (p->sequencia > lida_sequencia || (p->sequencia == lida_sequencia && lida_posicao < p->usados)))
+		{
+			estatisticas_fila_nvm.paginas_perdidas++;
+		}
+		if(i == pagina_confirmacao)
+		{
+			confirmacao = 1;
+			pagina_confirmacao = NENHUMA;
+		}
+		invalidas[i >> 3] &= (uint8_t)~(1u << (i & 7));
+	}
+	ComandoNvm(FILA_NVM_INICIO + (uint32_t)linha * FILA_NVM_TAM_LINHA, NVMCTRL_CTRLA_CMD_ER);
+	estatisticas_fila_nvm.linhas_apagadas++;
+	return confirmacao;
+}
+
+/* grava a pagina no proximo indice do registro, ja apagado */
+static void Programa(buffer_pagina_t *b)
+{
+	uint32_t endereco = FILA_NVM_INICIO + (uint32_t)proxima_escrita * FILA_NVM_TAM_PAGINA;
+	volatile uint32_t *destino = (volatile uint32_t *)endereco;
+	uint8_t i;
+
+	b->p.sequencia = proxima_sequencia++;
+	b->p.reservado = 0xFF;
+	b->p.soma = Soma(&b->p);
+
+	ComandoNvm(endereco, NVMCTRL_CTRLA_CMD_PBC);
+	for(i = 0; i < FILA_NVM_TAM_PAGINA / 4; i++)
+	{
+		destino[i] = b->palavras[i];
+	}
+	ComandoNvm(endereco, NVMCTRL_CTRLA_CMD_WP);
+	ComandoNvm(0, NVMCTRL_CTRLA_CMD_INVALL);	/* o cache pode ter a pagina apagada */
+
+	if(b->p.tipo == TIPO_QUADROS)
+	{
+		ultimo_quadros = (uint16_t)b->p.sequencia;
+	}
+	else
+	{
+		pagina_confirmacao = proxima_escrita;
+	}
+	proxima_escrita = (uint16_t)((proxima_escrita + 1) % PAGINAS);
+	estatisticas_fila_nvm.paginas_gravadas++;
+}
+
+/* grava a posicao de leitura que e recuperada depois de um reset */
+static void GravaConfirmacao(uint32_t sequencia, uint8_t posicao)
+{
+	buffer_pagina_t b;
+	uint8_t i;
+
+	for(i = 0; i < FILA_NVM_TAM_PAGINA / 4; i++)
+	{
+		b.palavras[i] = 0xFFFFFFFFUL;
+	}
+	b.p.tipo = TIPO_CONFIRMACAO;
+	b.p.anterior = ultimo_quadros;
+	b.p.continuacao = 0;
+	b.p.usados = 5;
+	b.p.dados[0] = (uint8_t)sequencia;
+	b.p.dados[1] = (uint8_t)(sequencia >> 8);
+	b.p.dados[2] = (uint8_t)(sequencia >> 16);
+	b.p.dados[3] = (uint8_t)(sequencia >> 24);
+	b.p.dados[4] = posicao;
+	Programa(&b);
+	confirmada_sequencia = sequencia;
+	confirmada_posicao = posicao;
+}
+
+/* grava a pagina de montagem, apagando a linha quando o registro chega a
+   ela. A confirmacao apagada junto e gravada de novo */
+static void GravaMontagem(void)
+{
+	uint8_t reconfirma = 0;
+
+	if((proxima_escrita & 3) == 0)
+	{
+		reconfirma = ApagaLinha((uint16_t)(proxima_escrita / 4));
+	}
+	montagem.p.tipo = TIPO_QUADROS;
+	montagem.p.anterior = ultimo_quadros;
+	Programa(&montagem);
+	if(reconfirma)
+	{
+		GravaConfirmacao(confirmada_sequencia, confirmada_posicao);
+	}
+
+	montagem.p.usados = 0;
+	montagem.p.continuacao = 0;
+}
+
+static void Acrescenta(const uint8_t *bytes, uint16_t n)
+{
+	while(n > 0)
+	{
+		if(montagem.p.usados == FILA_NVM_DADOS)
+		{
+			GravaMontagem();
+		}
+		if(montagem.p.usados == 0 && restante_registro < tamanho_registro)
+		{
+			montagem.p.continuacao = (uint8_t)(restante_registro < FILA_NVM_DADOS ? restante_registro : FILA_NVM_DADOS);
+		}
+		montagem.p.dados[montagem.p.usados++] = *bytes++;
+		restante_registro--;
+		n--;
+	}
+}
+
+/*
+ * Interface
+ */
+
+/* le o registro da flash e continua depois da maior sequencia, com a
+   leitura na ultima confirmacao. Retorna 0 se a regiao da fila tem
+   programa (FILA_NVM_INICIO) */
+uint8_t FilaNvmInicia(void)
+{
+	extern uint32_t _etext, _srelocate, _erelocate;
+	const pagina_nvm_t *p;
+	uint32_t fim_programa = (uint32_t)&_etext + ((uint32_t)&_erelocate - (uint32_t)&_srelocate);
+	uint32_t maior = 0, maior_quadros = 0, maior_confirmacao = 0;
+	uint16_t i, pagina_maior = NENHUMA;
+
+	if(fim_programa > FILA_NVM_INICIO)
+	{
+		return 0;
+	}
+	NVMCTRL->CTRLB.reg |= NVMCTRL_CTRLB_MANW;	/* grava so com o comando WP */
+
+	if(RetidaQuente() && iniciada && !alterando)
+	{
+		/* partida quente: o estado e o da flash. Os quadros lidos e nao
+		   confirmados sao lidos de novo, como na partida fria */
+		lida_sequencia = confirmada_sequencia;
+		lida_posicao = confirmada_posicao;
+		return 1;
+	}
+
+	iniciada = 0;
+	alterando = 0;
+	pagina_confirmacao = NENHUMA;
+	lida_sequencia = 0;
+	lida_posicao = 0;
+	for(i = 0; i < PAGINAS; i++)
+	{
+		p = Pagina(i);
+		invalidas[i >> 3] &= (uint8_t)~(1u << (i & 7));
+		if(p->tipo == TIPO_APAGADA)
+		{
+			continue;
+		}
+		if((p->tipo != TIPO_QUADROS && p->tipo != TIPO_CONFIRMACAO) || p->soma != Soma(p) ||
+		   p->usados > FILA_NVM_DADOS)
+		{
+			/* gravacao ou apagamento interrompido */
+			invalidas[i >> 3] |= (uint8_t)(1u << (i & 7));
+			estatisticas_fila_nvm.paginas_invalidas++;
+			continue;
+		}
+		if(p->sequencia > maior)
+		{
+			maior = p->sequencia;
+			pagina_maior = i;
+		}
+		if(p->tipo == TIPO_QUADROS && p->sequencia > maior_quadros)
+		{
+			maior_quadros = p->sequencia;
+		}
+		if(p->tipo == TIPO_CONFIRMACAO && p->sequencia > maior_confirmacao)
+		{
+			maior_confirmacao = p->sequencia;
+			pagina_confirmacao = i;
+			lida_sequencia = (uint32_t)p->dados[0] | ((uint32_t)p->dados[1] << 8) |
+							 ((uint32_t)p->dados[2] << 16) | ((uint32_t)p->dados[3] << 24);
+			lida_posicao = p->dados[4];
+		}
+	}
+	confirmada_sequencia = lida_sequencia;
+	confirmada_posicao = lida_posicao;
+	/* o registro da ultima pagina pode continuar na pagina de montagem
+	   perdida no reset: a proxima pagina nao e a continuacao dela */
+	ultimo_quadros = (uint16_t)~maior_quadros;
+
+	/* a linha da maior sequencia pode ter paginas interrompidas: continua
+	   na seguinte */
+	proxima_sequencia = maior + 1;
+	proxima_escrita = (pagina_maior == NENHUMA) ? 0 : (uint16_t)(((pagina_maior / 4 + 1) % FILA_NVM_LINHAS) * 4);
+
+	montagem.p.usados = 0;
+	montagem.p.continuacao = 0;
+	restante_registro = 0;
+	iniciada = 1;
+	return 1;
+}
+
+/* guarda o quadro na pagina de montagem, gravando as paginas que enche.
+   Retorna 0 se o tamanho e 0 ou maior que FILA_NVM_MAIOR_QUADRO */
+uint8_t FilaNvmGuarda(const uint8_t *quadro, uint16_t tamanho)
+{
+	uint8_t cabecalho[2];
+
+	if(tamanho == 0 || tamanho > FILA_NVM_MAIOR_QUADRO)
+	{
+		return 0;
+	}
+	cabecalho[0] = (uint8_t)tamanho;
+	cabecalho[1] = (uint8_t)(tamanho >> 8);
+	alterando = 1;
+	tamanho_registro = (uint16_t)(tamanho + 2);
+	restante_registro = tamanho_registro;
+	Acrescenta(cabecalho, 2);
+	Acrescenta(quadro, tamanho);
+	alterando = 0;
+	estatisticas_fila_nvm.guardados++;
+	return 1;
+}
+
+/* grava a pagina de montagem mesmo incompleta (ex.: periodicamente, para
+   limitar os quadros perdidos em um reset) */
+void FilaNvmDescarrega(void)
+{
+	if(montagem.p.usados > 0)
+	{
+		alterando = 1;
+		GravaMontagem();
+		alterando = 0;
+	}
+}
+
+/* copia o proximo quadro guardado em quadro e retorna o tamanho, ou 0 se a
+   fila esta vazia. Os quadros na pagina de montagem sao gravados antes de
+   lidos. A posicao lida so persiste com FilaNvmConfirma */
+uint16_t FilaNvmLe(uint8_t *quadro, uint16_t maximo)
+{
+	const pagina_nvm_t *p;
+	uint32_t sequencia = lida_sequencia;
+	uint16_t pagina = Procura(lida_sequencia);
+	uint16_t n = 0, tamanho = 0, proxima;
+	uint8_t posicao = lida_posicao, byte;
+
+	for(;;)
+	{
+		if(pagina == NENHUMA || posicao >= Pagina(pagina)->usados)
+		{
+			proxima = ProximaPagina(sequencia);
+			if(proxima == NENHUMA)
+			{
+				if(montagem.p.usados > 0)
+				{
+					FilaNvmDescarrega();
+					continue;
+				}
+				return 0;
+			}
+			p = Pagina(proxima);
+			posicao = 0;
+			if(n > 0 && p->anterior != (uint16_t)sequencia)
+			{
+				estatisticas_fila_nvm.descartados++;		/* a pagina anterior foi perdida */
+				n = 0;
+				tamanho = 0;
+			}
+			if(n == 0)
+			{
+				posicao = p->continuacao;
+			}
+			sequencia = p->sequencia;
+			pagina = proxima;
+			continue;
+		}
+
+		byte = Pagina(pagina)->dados[posicao++];
+		if(n < 2)
+		{
+			tamanho = (uint16_t)(tamanho | ((uint16_t)byte << (8 * n)));
+		}
+		else if(n - 2 < maximo)
+		{
+			quadro[n - 2] = byte;
+		}
+		n++;
+		if(n == 2 && (tamanho == 0 || tamanho > FILA_NVM_MAIOR_QUADRO))
+		{
+			estatisticas_fila_nvm.descartados++;			/* nao e o comeco de um registro */
+			posicao = Pagina(pagina)->usados;
+			n = 0;
+			tamanho = 0;
+		}
+		else if(n >= 2 && n == tamanho + 2)
+		{
+			alterando = 1;
+			lida_sequencia = sequencia;
+			lida_posicao = posicao;
+			alterando = 0;
+			if(tamanho > maximo)
+			{
+				estatisticas_fila_nvm.descartados++;
+				n = 0;
+				tamanho = 0;
+				continue;
+			}
+			estatisticas_fila_nvm.lidos++;
+			return tamanho;
+		}
+	}
+}
+
+/* grava a posicao depois do ultimo quadro lido, que nao e lido de novo
+   depois de um reset. So grava se a posicao mudou */
+void FilaNvmConfirma(void)
+{
+	if(lida_sequencia == confirmada_sequencia && lida_posicao == confirmada_posicao)
+	{
+		return;
+	}
+	alterando = 1;
+	if((proxima_escrita & 3) == 0)
+	{
+		(void)ApagaLinha((uint16_t)(proxima_escrita / 4));
+	}
+	GravaConfirmacao(lida_sequencia, lida_posicao);
+	alterando = 0;
+}
+
+/* retorna 1 se todos os quadros guardados foram lidos */
+uint8_t FilaNvmVazia(void)
+{
+	uint16_t pagina = Procura(lida_sequencia);
+
+	return (uint8_t)(montagem.p.usados == 0 && ProximaPagina(lida_sequencia) == NENHUMA &&
+					 (pagina == NENHUMA || lida_posicao >= Pagina(pagina)->usados));
+}
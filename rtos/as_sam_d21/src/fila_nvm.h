@@ -0,0 +1,103 @@
+/*
+ * fila_nvm.h
+ *
+ * Fila persistente de quadros na flash (guarda e encaminha): quando o
+ * enlace cai, o transmissor desiste depois de MAX_RETRIES tentativas (t4) e
+ * o quadro seria perdido. Com a fila, a aplicacao guarda o quadro que nao
+ * foi entregue (FilaNvmGuarda) e, quando o enlace volta, le os quadros
+ * guardados em ordem (FilaNvmLe), os reenvia e confirma os entregues
+ * (FilaNvmConfirma). Ex.:
+ *
+ *   if(tx.result == PROTOCOL_TIMEOUT) FilaNvmGuarda(tx.message_buffer, tx.message_size);
+ *   ...
+ *   while((tamanho = FilaNvmLe(quadro, sizeof(quadro))) != 0) { envia e espera o ACK }
+ *   FilaNvmConfirma();
+ *
+ * Os quadros sao guardados como bytes opacos (com o tamanho na frente), de
+ * qualquer formato (STX ou SOH com sequencia).
+ *
+ * A fila e um registro circular nas ultimas FILA_NVM_LINHAS linhas da flash
+ * (4 paginas de 64 bytes por linha). Os quadros sao juntados em uma pagina
+ * na RAM e cada pagina e gravada uma unica vez, cheia ou por
+ * FilaNvmDescarrega; um quadro pode continuar na pagina seguinte. Cada
+ * linha so e apagada quando o registro chega a ela, entao todas as linhas
+ * sao apagadas o mesmo numero de vezes (nivelamento do desgaste), uma vez a
+ * cada FILA_NVM_LINHAS * 4 paginas gravadas. Com a fila cheia, a linha com
+ * os quadros mais antigos e apagada e as paginas nao lidas sao contadas
+ * como perdidas.
+ *
+ * Cada pagina tem um numero de sequencia e uma soma de verificacao: uma
+ * gravacao ou um apagamento interrompido por um reset deixa paginas
+ * invalidas, que sao ignoradas. FilaNvmInicia procura a maior sequencia e
+ * continua depois dela, na linha seguinte; a posicao de leitura e
+ * recuperada da ultima confirmacao, gravada como uma pagina do registro.
+ * Os quadros lidos e nao confirmados antes de um reset sao lidos de novo
+ * (ao menos uma entrega: o receptor com numeros de sequencia descarta os
+ * repetidos). Os quadros ainda na pagina da RAM se perdem na falta de
+ * energia; nos outros resets (watchdog, software), o estado da fila fica
+ * na memoria retida (retida.h) e FilaNvmInicia nao varre a flash.
+ *
+ * O SAMD21 nao le a flash enquanto grava ou apaga: o processador fica
+ * parado ate ~2,5 ms por pagina gravada e ~6 ms por linha apagada, com as
+ * interrupcoes atrasadas. A fila e usada por uma unica tarefa.
+ */
+
+
+#ifndef FILA_NVM_H_
+#define FILA_NVM_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* linhas da flash usadas pela fila (4 paginas cada) */
+#ifndef FILA_NVM_LINHAS
+#define FILA_NVM_LINHAS			16
+#endif
+
+/* endereco da primeira linha: por padrao as ultimas linhas da flash, que o
+   programa nao pode ocupar (FilaNvmInicia confere) */
+#ifndef FILA_NVM_INICIO
+#define FILA_NVM_INICIO			(FLASH_SIZE - FILA_NVM_LINHAS * FILA_NVM_TAM_LINHA)
+#endif
+
+/* maior quadro guardado (o buffer de mensagem do transmissor de t4) */
+#ifndef FILA_NVM_MAIOR_QUADRO
+#define FILA_NVM_MAIOR_QUADRO	266
+#endif
+
+#define FILA_NVM_TAM_PAGINA		64
+#define FILA_NVM_TAM_LINHA		(4 * FILA_NVM_TAM_PAGINA)
+
+/* bytes de quadros por pagina, alem do cabecalho */
+#define FILA_NVM_DADOS			(FILA_NVM_TAM_PAGINA - 12)
+
+#if FILA_NVM_LINHAS < 2 || FILA_NVM_LINHAS > 255
+#error "FILA_NVM_LINHAS deve estar entre 2 e 255"
+#endif
+
+/**
+* \struct estatisticas_fila_nvm_t
+* Contadores da fila, de 32 bits (voltam a zero ao estourar)
+*/
+
+typedef struct
+{
+	uint32_t	guardados;			///< Quadros guardados
+	uint32_t	lidos;				///< Quadros lidos (inclui os lidos de novo depois de um reset)
+	uint32_t	paginas_gravadas;	///< Paginas gravadas, de quadros e de confirmacao
+	uint32_t	linhas_apagadas;	///< Linhas apagadas (paginas_gravadas / linhas_apagadas: paginas por apagamento)
+	uint32_t	paginas_perdidas;	///< Paginas nao lidas apagadas com a fila cheia
+	uint32_t	paginas_invalidas;	///< Paginas gravadas com erro na soma, encontradas por FilaNvmInicia
+	uint32_t	descartados;		///< Quadros sem o comeco (pagina perdida) ou maiores que o buffer de leitura
+} estatisticas_fila_nvm_t;
+
+extern estatisticas_fila_nvm_t estatisticas_fila_nvm;
+
+uint8_t FilaNvmInicia(void);
+uint8_t FilaNvmGuarda(const uint8_t *quadro, uint16_t tamanho);
+void FilaNvmDescarrega(void);
+uint16_t FilaNvmLe(uint8_t *quadro, uint16_t maximo);
+void FilaNvmConfirma(void);
+uint8_t FilaNvmVazia(void);
+
+#endif /* FILA_NVM_H_ */
@@ -0,0 +1,80 @@
+/*
+ * filtro_dsp.c
+ *
+ * Etapa de processamento de sinais por lote: conversao das amostras de 12
+ * bits do ADC para Q15, FIR e cascata de biquads da CMSIS-DSP. Varias
+ * etapas podem ser encadeadas, cada uma com seu filtro_dsp_t.
+ */
+
+#include <asf.h>
+#include <string.h>
+#include "filtro_dsp.h"
+
+/* meio da faixa do ADC de 12 bits, o zero do sinal em Q15 */
+#define ZERO_ADC			2048
+#define ESCALA_ADC_Q15		16		/* 12 bits para 16 bits */
+
+/* prepara a etapa. num_coef_fir = 0 ou estagios = 0 dispensam o filtro 
+   correspondente. desloc_biquad e o deslocamento a esquerda da saida de 
+   cada estagio, para coeficientes escalados por 2^-desloc_biquad (ex.: 1 
+   para coeficientes entre -2 e 2). Os coeficientes sao usados diretamente, 
+   devem continuar validos enquanto a etapa for usada. Retorna 0 se os 
+   tamanhos excedem FILTRO_DSP_MAX_COEF_FIR ou FILTRO_DSP_MAX_ESTAGIOS */
+uint8_t FiltroDspInicia(filtro_dsp_t *filtro, const q15_t *coef_fir, uint16_t num_coef_fir,
+						const q15_t *coef_biquad, uint8_t estagios, int8_t desloc_biquad)
+{
+	if(num_coef_fir > FILTRO_DSP_MAX_COEF_FIR || estagios > FILTRO_DSP_MAX_ESTAGIOS)
+	{
+		return 0;
+	}
+
+	filtro->usa_fir = (num_coef_fir != 0);
+	if(filtro->usa_fir &&
+		arm_fir_init_q15(&filtro->fir, num_coef_fir, (q15_t *)coef_fir, filtro->estado_fir,
+						FILTRO_DSP_TAM_LOTE) != ARM_MATH_SUCCESS)
+	{
+		return 0;
+	}
+
+	filtro->usa_biquad = (estagios != 0);
+	if(filtro->usa_biquad)
+	{
+		arm_biquad_cascade_df1_init_q15(&filtro->biquad, estagios, (q15_t *)coef_biquad,
+										filtro->estado_biquad, desloc_biquad);
+	}
+
+	return 1;
+}
+
+/* filtra um lote de FILTRO_DSP_TAM_LOTE amostras do ADC e retorna a saida 
+   em Q15 (filtro->saida), valida ate a proxima chamada */
+const q15_t* FiltroDspProcessa(filtro_dsp_t *filtro, const uint16_t *lote)
+{
+	q15_t *dados = filtro->entrada;
+	uint16_t i;
+
+	for(i = 0; i < FILTRO_DSP_TAM_LOTE; i++)
+	{
+		filtro->entrada[i] = (q15_t)(((int32_t)lote[i] - ZERO_ADC) * ESCALA_ADC_Q15);
+	}
+
+	if(filtro->usa_fir)
+	{
+		arm_fir_q15(&filtro->fir, dados, filtro->saida, FILTRO_DSP_TAM_LOTE);
+		dados = filtro->saida;
+	}
+
+	/* o biquad aceita a mesma area como entrada e saida */
+	if(filtro->usa_biquad)
+	{
+		arm_biquad_cascade_df1_q15(&filtro->biquad, dados, filtro->saida, FILTRO_DSP_TAM_LOTE);
+		dados = filtro->saida;
+	}
+
+	if(dados != filtro->saida)
+	{
+		memcpy(filtro->saida, dados, sizeof(filtro->saida));
+	}
+
+	return filtro->saida;
+}
@@ -0,0 +1,60 @@
+/*
+ * filtro_dsp.h
+ *
+ * Etapa de processamento de sinais por lote, com a biblioteca CMSIS-DSP
+ * (arm_math.h, libarm_cortexM0l_math.a): cada lote de amostras do ADC
+ * (amostragem.h) e convertido para Q15 e passa por um filtro FIR seguido
+ * de uma cascata de biquads (forma direta I), ambos em Q15. O estado dos
+ * filtros continua de um lote para o outro, entao a saida e a mesma de uma
+ * filtragem amostra a amostra, com uma unica chamada por lote.
+ */
+
+
+#ifndef FILTRO_DSP_H_
+#define FILTRO_DSP_H_
+
+#include "stdint.h"
+#include <arm_math.h>
+#include "amostragem.h"
+
+/* amostras por chamada de FiltroDspProcessa */
+#ifndef FILTRO_DSP_TAM_LOTE
+#define FILTRO_DSP_TAM_LOTE			AMOSTRAGEM_TAM_LOTE
+#endif
+
+/* numero maximo de coeficientes do FIR (par, pelo menos 4) e de estagios 
+   de biquad. Definem o tamanho das areas de estado de cada etapa */
+#ifndef FILTRO_DSP_MAX_COEF_FIR
+#define FILTRO_DSP_MAX_COEF_FIR		16
+#endif
+
+#ifndef FILTRO_DSP_MAX_ESTAGIOS
+#define FILTRO_DSP_MAX_ESTAGIOS		2
+#endif
+
+#if (FILTRO_DSP_MAX_COEF_FIR & 1) != 0 || FILTRO_DSP_MAX_COEF_FIR < 4
+#error "FILTRO_DSP_MAX_COEF_FIR deve ser par e maior ou igual a 4"
+#endif
+
+/* coeficientes de cada estagio de biquad, na ordem da CMSIS-DSP: 
+   {b0, 0, b1, b2, a1, a2}, com a1 e a2 de sinal trocado 
+   (y = b0*x + b1*x1 + b2*x2 + a1*y1 + a2*y2) */
+#define FILTRO_DSP_COEF_ESTAGIO		6
+
+typedef struct
+{
+	arm_fir_instance_q15			fir;
+	arm_biquad_casd_df1_inst_q15	biquad;
+	uint8_t							usa_fir;
+	uint8_t							usa_biquad;
+	q15_t	estado_fir[FILTRO_DSP_MAX_COEF_FIR + FILTRO_DSP_TAM_LOTE];
+	q15_t	estado_biquad[4 * FILTRO_DSP_MAX_ESTAGIOS];
+	q15_t	entrada[FILTRO_DSP_TAM_LOTE];	///< lote convertido para Q15
+	q15_t	saida[FILTRO_DSP_TAM_LOTE];		///< lote filtrado
+} filtro_dsp_t;
+
+uint8_t FiltroDspInicia(filtro_dsp_t *filtro, const q15_t *coef_fir, uint16_t num_coef_fir,
+						const q15_t *coef_biquad, uint8_t estagios, int8_t desloc_biquad);
+const q15_t* FiltroDspProcessa(filtro_dsp_t *filtro, const uint16_t *lote);
+
+#endif /* FILTRO_DSP_H_ */
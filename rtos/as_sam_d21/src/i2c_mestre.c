@@ -0,0 +1,266 @@
+/*
+ * i2c_mestre.c
+ *
+ * I2C mestre por interrupcao na SERCOM do EXT1 (SDA no PAD0, SCL no PAD1).
+ *
+ * A interrupcao MB (mestre no barramento) avanca a fase de escrita: envia
+ * o proximo byte, passa a leitura com inicio repetido ou encerra com a
+ * condicao de parada. A interrupcao SB (escravo no barramento) guarda cada
+ * byte lido e responde ACK, ou NACK e parada no ultimo. No fim de cada
+ * transacao o semaforo dela e liberado e a proxima da fila e iniciada.
+ */
+
+#include <asf.h>
+#include "perfil_clock.h"
+#include "pinos.h"
+#include "i2c_mestre.h"
+
+#define SERCOM_I2C			EXT1_I2C_MODULE
+
+#define CMD_LEITURA			2		/* ACKACT e le o proximo byte */
+#define CMD_PARADA			3		/* ACKACT e condicao de parada */
+
+/* estado do barramento (STATUS.BUSSTATE) */
+#define BARRAMENTO_LIVRE	1
+#define BARRAMENTO_NOSSO	2
+
+static transacao_i2c_t *primeira_transacao = 0;
+static transacao_i2c_t *ultima_transacao = 0;
+static uint32_t frequencia_i2c;
+
+static void EsperaSincronismo(void)
+{
+	while(SERCOM_I2C->I2CM.SYNCBUSY.reg & SERCOM_I2CM_SYNCBUSY_SYSOP) {}
+}
+
+static void Comando(uint8_t comando, uint8_t nack)
+{
+	SercomI2cm *const i2c = &(SERCOM_I2C->I2CM);
+
+	if(nack)
+	{
+		i2c->CTRLB.reg |= SERCOM_I2CM_CTRLB_ACKACT;
+	}
+	else
+	{
+		i2c->CTRLB.reg &= ~SERCOM_I2CM_CTRLB_ACKACT;
+	}
+	EsperaSincronismo();
+	i2c->CTRLB.reg |= SERCOM_I2CM_CTRLB_CMD(comando);
+	EsperaSincronismo();
+}
+
+/* endereca o escravo da primeira transacao da fila. Chamada com as 
+   interrupcoes desabilitadas ou pela interrupcao da SERCOM */
+static void IniciaTransacao(void)
+{
+	transacao_i2c_t *t = primeira_transacao;
+
+	if(t == 0)
+	{
+		return;
+	}
+	t->posicao = 0;
+	/* sem bytes de escrita comeca pela leitura; sem nenhum byte, so 
+	   verifica se o escravo responde ao endereco */
+	SERCOM_I2C->I2CM.ADDR.reg = (uint32_t)(t->endereco << 1) | ((t->tam_envio == 0 && t->tam_recepcao != 0) ? 1 : 0);
+}
+
+/* encerra a primeira transacao da fila e inicia a seguinte */
+static void TerminaTransacao(uint8_t resultado)
+{
+	transacao_i2c_t *t = primeira_transacao;
+
+	/* a proxima condicao de inicio so depois da parada */
+	while(SERCOM_I2C->I2CM.STATUS.bit.BUSSTATE == BARRAMENTO_NOSSO) {}
+
+	primeira_transacao = t->proxima;
+	if(primeira_transacao == 0)
+	{
+		ultima_transacao = 0;
+	}
+	t->resultado = resultado;
+	SemaforoLiberaISR(&t->fim);
+	IniciaTransacao();
+}
+
+void SERCOM2_Handler(void)
+{
+	SercomI2cm *const i2c = &(SERCOM_I2C->I2CM);
+	transacao_i2c_t *t = primeira_transacao;
+	uint8_t flags = i2c->INTFLAG.reg;
+	uint16_t status = i2c->STATUS.reg;
+
+	if(t == 0)
+	{
+		i2c->INTFLAG.reg = flags;
+		return;
+	}
+
+	if((flags & SERCOM_I2CM_INTFLAG_ERROR) || (status & (SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST)))
+	{
+		/* o barramento ja nao e nosso: sem condicao de parada */
+		i2c->STATUS.reg = SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST;
+		i2c->INTFLAG.reg = SERCOM_I2CM_INTFLAG_ERROR | SERCOM_I2CM_INTFLAG_MB | SERCOM_I2CM_INTFLAG_SB;
+		TerminaTransacao(I2C_ERRO_BARRAMENTO);
+	}
+	else if(flags & SERCOM_I2CM_INTFLAG_MB)
+	{
+		if(status & SERCOM_I2CM_STATUS_RXNACK)
+		{
+			Comando(CMD_PARADA, 0);
+			TerminaTransacao(I2C_NACK);
+		}
+		else if(t->posicao < t->tam_envio)
+		{
+			i2c->DATA.reg = t->envio[t->posicao++];
+		}
+		else if(t->tam_recepcao != 0)
+		{
+			t->posicao = 0;
+			i2c->ADDR.reg = (uint32_t)(t->endereco << 1) | 1;	/* inicio repetido */
+		}
+		else
+		{
+			Comando(CMD_PARADA, 0);
+			TerminaTransacao(I2C_OK);
+		}
+	}
+	else if(flags & SERCOM_I2CM_INTFLAG_SB)
+	{
+		/* o clock fica parado ate o comando: o byte pode ser lido antes */
+		t->recepcao[t->posicao++] = (uint8_t)i2c->DATA.reg;
+		if(t->posicao < t->tam_recepcao)
+		{
+			Comando(CMD_LEITURA, 0);
+		}
+		else
+		{
+			Comando(CMD_PARADA, 1);
+			TerminaTransacao(I2C_OK);
+		}
+	}
+}
+
+/* BAUD para o clock atual: f = clock / (2 * (BAUD + 5)), desprezando o 
+   tempo de subida. Arredondado para nao passar de frequencia_i2c */
+static uint8_t ValorBaud(uint32_t clock_hz)
+{
+	uint32_t baud = (clock_hz + (2 * frequencia_i2c) - 1) / (2 * frequencia_i2c);
+
+	if(baud > 255 + 5)
+	{
+		baud = 255 + 5;
+	}
+	return (uint8_t)((baud > 5) ? (baud - 5) : 0);
+}
+
+/* recalcula o clock do I2C apos uma troca de perfil de clock (gancho de 
+   perfil_clock.c). BAUD so pode ser escrito com a SERCOM desabilitada: 
+   uma transacao em andamento durante a troca pode terminar em erro */
+static void AjustaBaud(uint32_t clock_hz)
+{
+	SercomI2cm *const i2c = &(SERCOM_I2C->I2CM);
+
+	i2c->CTRLA.reg &= ~SERCOM_I2CM_CTRLA_ENABLE;
+	while(i2c->SYNCBUSY.reg & SERCOM_I2CM_SYNCBUSY_ENABLE) {}
+	i2c->BAUD.reg = ValorBaud(clock_hz);
+	i2c->CTRLA.reg |= SERCOM_I2CM_CTRLA_ENABLE;
+	while(i2c->SYNCBUSY.reg & SERCOM_I2CM_SYNCBUSY_ENABLE) {}
+	i2c->STATUS.reg = SERCOM_I2CM_STATUS_BUSSTATE(BARRAMENTO_LIVRE);
+	EsperaSincronismo();
+}
+
+#if !PINOS_TABELA
+static void ConfiguraPino(uint32_t pinmux)
+{
+	struct system_pinmux_config config_pino;
+
+	system_pinmux_get_config_defaults(&config_pino);
+	config_pino.mux_position = pinmux & 0xFFFF;
+	system_pinmux_pin_set_config(pinmux >> 16, &config_pino);
+}
+#endif
+
+/* configura a SERCOM como I2C mestre a frequencia_hz (ate 400kHz) */
+void I2cMestreInicia(uint32_t frequencia_hz)
+{
+	struct system_gclk_chan_config config_clock;
+	SercomI2cm *const i2c = &(SERCOM_I2C->I2CM);
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_SERCOM2);
+
+	/* clock da SERCOM: gerador 0, o mesmo da CPU (PerfilClockHz) */
+	system_gclk_chan_get_config_defaults(&config_clock);
+	config_clock.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(SERCOM2_GCLK_ID_CORE, &config_clock);
+	system_gclk_chan_enable(SERCOM2_GCLK_ID_CORE);
+
+#if !PINOS_TABELA		/* senao, ja configurados na partida (pinos.h) */
+	ConfiguraPino(EXT1_I2C_SERCOM_PINMUX_PAD0);
+	ConfiguraPino(EXT1_I2C_SERCOM_PINMUX_PAD1);
+#endif
+
+	i2c->CTRLA.reg = SERCOM_I2CM_CTRLA_SWRST;
+	while(i2c->SYNCBUSY.reg & SERCOM_I2CM_SYNCBUSY_SWRST) {}
+
+	/* SDA mantido de 300 a 600ns apos a descida do SCL */
+	i2c->CTRLA.reg = SERCOM_I2CM_CTRLA_MODE_I2C_MASTER | SERCOM_I2CM_CTRLA_SDAHOLD(2);
+	frequencia_i2c = frequencia_hz;
+	i2c->BAUD.reg = ValorBaud(PerfilClockHz());
+
+	i2c->INTENSET.reg = SERCOM_I2CM_INTENSET_MB | SERCOM_I2CM_INTENSET_SB | SERCOM_I2CM_INTENSET_ERROR;
+	NVIC_EnableIRQ(SERCOM2_IRQn);
+
+	i2c->CTRLA.reg |= SERCOM_I2CM_CTRLA_ENABLE;
+	while(i2c->SYNCBUSY.reg & SERCOM_I2CM_SYNCBUSY_ENABLE) {}
+
+	/* o estado do barramento comeca desconhecido */
+	i2c->STATUS.reg = SERCOM_I2CM_STATUS_BUSSTATE(BARRAMENTO_LIVRE);
+	EsperaSincronismo();
+
+	(void)PerfilClockRegistraGancho(AjustaBaud);
+}
+
+/* coloca a transacao no fim da fila e retorna sem esperar. A transacao e 
+   suas areas devem continuar validas ate o fim (resultado != I2C_PENDENTE) */
+void I2cMestreEnfileira(transacao_i2c_t *transacao)
+{
+	reg_atomica_t estado;
+
+	transacao->resultado = I2C_PENDENTE;
+	transacao->fim.contador = 0;
+	transacao->fim.tarefaEsperando = 0;
+	transacao->proxima = 0;
+
+	REG_ATOMICA_INICIO(estado);
+	if(ultima_transacao == 0)
+	{
+		primeira_transacao = ultima_transacao = transacao;
+		IniciaTransacao();
+	}
+	else
+	{
+		ultima_transacao->proxima = transacao;
+		ultima_transacao = transacao;
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+/* bloqueia a tarefa ate o fim da transacao. Retorna o resultado, ou 
+   I2C_PENDENTE se o tempo se esgotou (a transacao continua na fila) */
+uint8_t I2cMestreAguarda(transacao_i2c_t *transacao, tick_t timeout)
+{
+	if(transacao->resultado == I2C_PENDENTE)
+	{
+		(void)SemaforoAguardaTempo(&transacao->fim, timeout);
+	}
+	return transacao->resultado;
+}
+
+/* enfileira a transacao e aguarda o fim */
+uint8_t I2cMestreTransfere(transacao_i2c_t *transacao, tick_t timeout)
+{
+	I2cMestreEnfileira(transacao);
+	return I2cMestreAguarda(transacao, timeout);
+}
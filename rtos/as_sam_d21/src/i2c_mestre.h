@@ -0,0 +1,42 @@
+/*
+ * i2c_mestre.h
+ *
+ * I2C mestre por interrupcao na SERCOM do conector EXT1 (SAM D21 Xplained
+ * Pro). Cada transacao (escrita, leitura ou escrita seguida de leitura com
+ * inicio repetido, ex.: leitura de registrador) e colocada em uma fila e
+ * avanca um byte por interrupcao; a tarefa que aguarda fica bloqueada no
+ * semaforo da transacao ate o fim, sem espera ocupada.
+ */
+
+
+#ifndef I2C_MESTRE_H_
+#define I2C_MESTRE_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* resultado de uma transacao */
+#define I2C_PENDENTE		0		///< na fila ou em andamento
+#define I2C_OK				1
+#define I2C_NACK			2		///< o escravo nao respondeu (endereco ou dado)
+#define I2C_ERRO_BARRAMENTO	3		///< erro de barramento ou arbitragem perdida
+
+typedef struct transacao_i2c
+{
+	uint8_t			endereco;		///< endereco de 7 bits do escravo
+	const uint8_t	*envio;			///< bytes escritos primeiro
+	uint16_t		tam_envio;
+	uint8_t			*recepcao;		///< bytes lidos em seguida, com inicio repetido
+	uint16_t		tam_recepcao;
+	volatile uint8_t	resultado;	///< I2C_PENDENTE ate o fim
+	semaforo_t		fim;			///< liberado no fim da transacao
+	uint16_t		posicao;		///< uso interno: bytes da fase atual
+	struct transacao_i2c *proxima;	///< uso interno da fila
+} transacao_i2c_t;
+
+void I2cMestreInicia(uint32_t frequencia_hz);
+void I2cMestreEnfileira(transacao_i2c_t *transacao);
+uint8_t I2cMestreAguarda(transacao_i2c_t *transacao, tick_t timeout);
+uint8_t I2cMestreTransfere(transacao_i2c_t *transacao, tick_t timeout);
+
+#endif /* I2C_MESTRE_H_ */
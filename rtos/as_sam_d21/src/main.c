@@ -26,8 +26,242 @@
  * Inclusao de arquivos de cabecalhos
  */
 #include <asf.h>
+#include <stdio.h>
 #include "stdint.h"
 #include "rtos.h"
+#include "uart_dma.h"
+#include "amostragem.h"
+#include "filtro_dsp.h"
+#include "spi_dma.h"
+#include "i2c_mestre.h"
+#include "clock_adiado.h"
+#include "perfil_clock.h"
+#include "receptor_quadros.h"
+#include "usb_cdc.h"
+#include "retida.h"
+#include "vigia_wdt.h"
+#include "tempo_us.h"
+#include "mtb.h"
+#include "crc_dma.h"
+#include "padrao_led.h"
+#include "sono_rtc.h"
+#include "bordas.h"
+#include "pinos.h"
+
+/*
+ * Inicializacao dos clocks:
+ *  0 - sem inicializacao, clock do reset (OSC8M dividido por 8, 1MHz);
+ *  1 - system_init (conf_clocks.h), esperando os osciladores antes de main;
+ *  2 - adiada (clock_adiado.c): as tarefas partem a 8MHz e a CPU passa a 
+ *      48MHz quando a DFLL travar, sem espera ocupada antes da primeira tarefa
+ */
+#ifndef INICIO_CLOCKS
+#define INICIO_CLOCKS			0
+#endif
+
+/*
+ * Escala do clock pela carga (1 habilita, 0 desabilita), com INICIO_CLOCKS 2: 
+ * a tarefa periodica mede a carga a cada 100ms e troca entre os perfis de 
+ * economia (8MHz) e desempenho (48MHz) de perfil_clock.c
+ */
+#define ESCALA_CLOCK_PELA_CARGA	0
+
+/*
+ * Medicao do custo da troca de contexto (1 habilita, 0 desabilita). 
+ * A tarefa de medicao ocupa o lugar da tarefa heartbeat
+ */
+#define MEDE_TROCA_CONTEXTO		0
+
+/*
+ * Medicao do cache e do modo de leitura da flash (1 habilita, 0 desabilita): 
+ * ciclos por iteracao de um laco do nucleo em cada configuracao. 
+ * A tarefa de medicao ocupa o lugar da tarefa heartbeat
+ */
+#define MEDE_CACHE_NVM			0
+
+/*
+ * Medicao da compressao da telemetria (1 habilita, 0 desabilita): razao e 
+ * ciclos por amostra de TelemetriaComprime em sinais sinteticos que variam 
+ * devagar, comparados com a amostra sem compressao. 
+ * A tarefa de medicao ocupa o lugar da tarefa heartbeat
+ */
+#define MEDE_COMPRESSAO			0
+
+/*
+ * Medicoes do nucleo (medicoes/mede_nucleo.c): TarefaContinua, 
+ * TarefaSuspende, SemaforoLibera ate a tarefa acordada, TarefaEspera(1) e 
+ * a troca de contexto, em ciclos (min/media/max), enviadas pela serial do 
+ * EDBG a UART_BAUD. Substitui todas as tarefas de exemplo. Ligada pela 
+ * configuracao Benchmark do projeto (MEDE_NUCLEO=1, INICIO_CLOCKS=1)
+ *
+ * A configuracao Desempenho mede o mesmo com a compilacao mais rapida: 
+ * OTIMIZA_DESEMPENHO=1 e -flto, -Os no programa e -O2 no codigo quente 
+ * (nucleo, porta, DMA, UART e receptor de quadros), com secoes por funcao e 
+ * a coleta das secoes sem uso no ligador. O cabecalho de cada rodada diz a 
+ * configuracao, para comparar as duas saidas
+ */
+#ifndef MEDE_NUCLEO
+#define MEDE_NUCLEO				0
+#endif
+
+/*
+ * Latencia da borda externa ate a tarefa (medicoes/mede_latencia.c), com o 
+ * nucleo cooperativo desta placa: percentis e histograma em ciclos, pela 
+ * mesma serial. Substitui as medicoes do nucleo. Ligada com MEDE_LATENCIA=1 
+ * nos simbolos da configuracao Benchmark, com um jumper entre os pinos 5 
+ * (estimulo) e 9 (EIC) do EXT1; a resposta sai no pino 6
+ */
+#ifndef MEDE_LATENCIA
+#define MEDE_LATENCIA			0
+#endif
+
+#if MEDE_LATENCIA && BORDAS
+#error "MEDE_LATENCIA usa o EIC no clock da CPU, com o seu EIC_Handler: desligar BORDAS"
+#endif
+
+/*
+ * Testes do Thread-Metric (medicoes/mede_thread_metric.c), para comparar o 
+ * nucleo com os resultados publicados de outros RTOS: operacoes a cada 
+ * 30 s, pela mesma serial. Substitui as medicoes do nucleo. Ligados com 
+ * MEDE_THREAD_METRIC=n (teste 1 a 7) nos simbolos da configuracao Benchmark
+ */
+#ifndef MEDE_THREAD_METRIC
+#define MEDE_THREAD_METRIC		0
+#endif
+
+/*
+ * Recepcao de quadros pela serial do EDBG, por DMA (1 habilita, 0 desabilita). 
+ * A tarefa de recepcao ocupa o lugar da tarefa 3
+ */
+#define RECEBE_QUADROS_UART		0
+#define UART_BAUD				1000000UL
+
+/*
+ * Console de desempenho na mesma serial (1 habilita, 0 desabilita): 
+ * comandos top, stacks, sem, objs, proto, energy, trace dump e, com MTB_RASTRO=1 nos 
+ * simbolos do projeto, mtb dump e mtb start (console.c), executados 
+ * pela tarefa ociosa. A tarefa de recepcao de quadros repassa os bytes ao 
+ * console. Compile com cfg_GANCHOS_OCIOSA > 0 e, para o comando sem, 
+ * cfg_ESPERAS_SEMAFORO = 1 (para o objs, cfg_REGISTRO_OBJETOS = 1)
+ */
+#define CONSOLE_UART			0
+
+/*
+ * Registro pela serial do EDBG (0 desabilita): com 1, a tarefa heartbeat 
+ * escreve cada batimento com printf no anel de envio de uart_dma.c, sem 
+ * esperar a UART; com 2, so grava o batimento no diario (diario.c) e a 
+ * tarefa ociosa o formata e envia depois (compile com cfg_GANCHOS_OCIOSA 
+ * > 0). Sem RECEBE_QUADROS_UART, a UART e iniciada pela propria tarefa 
+ * heartbeat, a UART_BAUD
+ */
+#define REGISTRO_SERIAL			0
+
+/*
+ * Recepcao de quadros pela USB nativa do SAMD21 (usb_cdc.c), uma porta 
+ * serial virtual sem limite de baud (1 habilita, 0 desabilita). Compile com 
+ * USB_CDC=1 e INICIO_CLOCKS=2 nos simbolos do projeto. A tarefa de 
+ * recepcao ocupa o lugar da tarefa 3
+ */
+#ifndef RECEBE_QUADROS_USB
+#define RECEBE_QUADROS_USB		0
+#endif
+
+/*
+ * Amostragem do ADC pelo sistema de eventos e DMA (1 habilita, 0 desabilita). 
+ * A tarefa de amostragem ocupa o lugar da tarefa periodica
+ */
+#define AMOSTRA_ADC				0
+#define FREQUENCIA_AMOSTRAS		1000UL
+
+/*
+ * Processamento de sinais por lote (1 habilita, 0 desabilita): as amostras 
+ * do ADC, como em AMOSTRA_ADC, passam por um FIR e um biquad da CMSIS-DSP 
+ * (filtro_dsp.c), uma vez por lote. A tarefa de processamento ocupa o 
+ * lugar da tarefa periodica e mede a capacidade de processamento
+ */
+#define PROCESSA_DSP			0
+
+/*
+ * Transacoes de SPI (DMA) e I2C (interrupcao) no conector EXT1 
+ * (1 habilita, 0 desabilita): a tarefa fica bloqueada durante cada 
+ * transferencia, enquanto as outras executam. Usa a pilha da tarefa 4
+ */
+#define TRANSACOES_BARRAMENTO	0
+#define FREQUENCIA_SPI			1000000UL
+#define FREQUENCIA_I2C			100000UL
+
+/*
+ * Telemetria agregada pela serial do EDBG (telemetria.c): as tarefas 
+ * heartbeat e periodica publicam amostras e a tarefa de telemetria as 
+ * envia juntas, em quadros de ate TELEMETRIA_POR_QUADRO amostras, em vez de 
+ * um quadro por amostra. Ligada com TELEMETRIA_UART=1 nos simbolos do 
+ * projeto, que tambem aumenta NUMERO_DE_TAREFAS (conf_rtos.h)
+ */
+#ifndef TELEMETRIA_UART
+#define TELEMETRIA_UART			0
+#endif
+
+#if REGISTRO_SERIAL && INICIO_CLOCKS == 0 && (16 * UART_BAUD > 1000000UL)
+#error "UART_BAUD alto demais para o clock do reset"
+#endif
+#if MEDE_NUCLEO && INICIO_CLOCKS != 1
+#error "MEDE_NUCLEO mede com o clock final desde a partida (INICIO_CLOCKS 1)"
+#endif
+#if MEDE_COMPRESSAO && INICIO_CLOCKS == 0
+#error "MEDE_COMPRESSAO mede um quadro em ate uma marca: 1000 ciclos a 1 MHz nao bastam"
+#endif
+#if MEDE_LATENCIA && !MEDE_NUCLEO
+#error "MEDE_LATENCIA usa a configuracao Benchmark (MEDE_NUCLEO=1)"
+#endif
+#if MEDE_THREAD_METRIC && (!MEDE_NUCLEO || MEDE_LATENCIA)
+#error "MEDE_THREAD_METRIC usa a configuracao Benchmark (MEDE_NUCLEO=1), sem MEDE_LATENCIA"
+#endif
+#if ESCALA_CLOCK_PELA_CARGA && INICIO_CLOCKS != 2
+#error "ESCALA_CLOCK_PELA_CARGA exige a DFLL de INICIO_CLOCKS 2"
+#endif
+#if ESCALA_CLOCK_PELA_CARGA && RECEBE_QUADROS_UART && (16 * UART_BAUD > CLOCK_INICIAL_HZ)
+#error "UART_BAUD alto demais para o perfil de economia"
+#endif
+#if TELEMETRIA_UART && !RECEBE_QUADROS_UART && !REGISTRO_SERIAL && INICIO_CLOCKS == 0 && (16 * UART_BAUD > 1000000UL)
+#error "UART_BAUD alto demais para o clock do reset"
+#endif
+#if CONSOLE_UART && !RECEBE_QUADROS_UART
+#error "CONSOLE_UART recebe os comandos pela tarefa de quadros (RECEBE_QUADROS_UART 1)"
+#endif
+#if RECEBE_QUADROS_USB && (!USB_CDC || INICIO_CLOCKS != 2)
+#error "RECEBE_QUADROS_USB exige USB_CDC=1 e a DFLL de INICIO_CLOCKS 2"
+#endif
+#if RECEBE_QUADROS_USB && RECEBE_QUADROS_UART
+#error "RECEBE_QUADROS_USB e RECEBE_QUADROS_UART ocupam o lugar da mesma tarefa"
+#endif
+
+#if CONSOLE_UART
+#include "console.h"
+#endif
+
+#if REGISTRO_SERIAL == 2
+#include "diario.h"
+#endif
+
+#if TELEMETRIA_UART || MEDE_COMPRESSAO
+#include "telemetria.h"
+#endif
+
+#if TELEMETRIA_UART
+
+/* identificadores das amostras */
+#define ID_BATIMENTOS			1
+#define ID_EXECUCOES_100MS		2
+#define ID_DESCARTES_UART		3
+#endif
+
+#if MEDE_NUCLEO
+#include <string.h>
+#include "mede_nucleo.h"		/* caminho ../../medicoes na configuracao Benchmark */
+#include "mede_latencia.h"
+#include "mede_thread_metric.h"
+static void EnviaMedicoes(const char *texto);
+#endif
 
 /*
  * Prototipos das tarefas
@@ -42,9 +276,19 @@ void tarefa_7(void);
 void tarefa_8(void);
 void tarefa_heartbeat(void);
 void tarefa_periodica_100ms(void);
+void tarefa_mede_troca(void);
+void tarefa_mede_cache_nvm(void);
+void tarefa_mede_compressao(void);
+void tarefa_quadros_uart(void);
+void tarefa_quadros_usb(void);
+void tarefa_amostragem(void);
+void tarefa_dsp(void);
+void tarefa_barramentos(void);
+void tarefa_telemetria(void);
 
 /*
  * Configuracao dos tamanhos das pilhas
+ * (com cfg_PINTA_PILHA, TarefaPilhaLivre() informa a folga real de cada pilha)
  */
 #define TAM_PILHA_1			(TAM_MINIMO_PILHA + 24)
 #define TAM_PILHA_2			(TAM_MINIMO_PILHA + 24)
@@ -54,34 +298,112 @@ void tarefa_periodica_100ms(void);
 #define TAM_PILHA_6			(TAM_MINIMO_PILHA + 24)
 #define TAM_PILHA_7			(TAM_MINIMO_PILHA + 24)
 #define TAM_PILHA_8			(TAM_MINIMO_PILHA + 24)
+#if REGISTRO_SERIAL == 1
+#define TAM_PILHA_HEARTBEAT	(TAM_MINIMO_PILHA + 32 + 256)	/* printf */
+#else
 #define TAM_PILHA_HEARTBEAT	(TAM_MINIMO_PILHA + 32)
+#endif
 #define TAM_PILHA_PERIODICA	(TAM_MINIMO_PILHA + 40)
+#if TELEMETRIA_UART
+#define TAM_PILHA_TELEMETRIA	(TAM_MINIMO_PILHA + TELEMETRIA_PILHA)
+#endif
+#if CONSOLE_UART
+#define TAM_PILHA_OCIOSA	(TAM_MINIMO_PILHA + 24 + CONSOLE_PILHA)	/* tambem cobre o diario */
+#elif REGISTRO_SERIAL == 2
+#define TAM_PILHA_OCIOSA	(TAM_MINIMO_PILHA + 24 + DIARIO_PILHA)
+#else
 #define TAM_PILHA_OCIOSA	(TAM_MINIMO_PILHA + 24)
+#endif
 
 /*
  * Declaracao das pilhas das tarefas
+ * (fora da secao .bss: CriaTarefa prepara cada pilha, o Reset_Handler nao 
+ * precisa zera-las)
  */
-uint32_t PILHA_TAREFA_1[TAM_PILHA_1];
-uint32_t PILHA_TAREFA_2[TAM_PILHA_2];
-uint32_t PILHA_TAREFA_3[TAM_PILHA_3];
-uint32_t PILHA_TAREFA_4[TAM_PILHA_4];
-uint32_t PILHA_TAREFA_5[TAM_PILHA_5];
-uint32_t PILHA_TAREFA_6[TAM_PILHA_6];
-uint32_t PILHA_TAREFA_7[TAM_PILHA_7];
-uint32_t PILHA_TAREFA_8[TAM_PILHA_8];
-uint32_t PILHA_TAREFA_HEARTBEAT[TAM_PILHA_HEARTBEAT];
-uint32_t PILHA_TAREFA_PERIODICA[TAM_PILHA_PERIODICA];
-uint32_t PILHA_TAREFA_OCIOSA[TAM_PILHA_OCIOSA];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_1[TAM_PILHA_1];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_2[TAM_PILHA_2];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_3[TAM_PILHA_3];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_4[TAM_PILHA_4];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_5[TAM_PILHA_5];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_6[TAM_PILHA_6];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_7[TAM_PILHA_7];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_8[TAM_PILHA_8];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_HEARTBEAT[TAM_PILHA_HEARTBEAT];
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_PERIODICA[TAM_PILHA_PERIODICA];
+#if TELEMETRIA_UART
+NAO_INICIALIZADA uint32_t PILHA_TAREFA_TELEMETRIA[TAM_PILHA_TELEMETRIA];
+#endif
+
+/*
+ * Fluxo de bytes das tarefas 7 e 8: a tarefa 8 acorda uma vez por lote de 
+ * LOTE_FLUXO bytes, ou com o que houver a cada 100 marcas
+ */
+#define TAM_FLUXO	16
+#define LOTE_FLUXO	8
+uint8_t area_fluxo[TAM_FLUXO]; /* area do anel (potencia de 2) */
+anel_t FluxoDados; /* inicializado em main() */
 
 /*
  * Funcao principal de entrada do sistema
  */
 int main(void)
 {
+	/* valida a memoria retida (zerada na partida fria) antes de qualquer 
+	   modulo usar uma variavel RETIDA */
+	RetidaInicia();
+	
+#if PINOS_TABELA
+	/* todos os pinos da placa de uma vez, pela tabela (pinos.c) */
+	PinosConfigura(pinos_placa, pinos_placa_quantidade);
+#endif
     
-#if 0
+#if MTB_RASTRO
+	/* rastro de instrucoes desde a partida, ate o primeiro gatilho */
+	MtbInicia();
+#endif
+	
+#if INICIO_CLOCKS == 1
 	system_init();
+#elif INICIO_CLOCKS == 2
+	ClockIniciaAdiado();
+#endif
+
+#if TEMPO_US
+	/* base de us antes das tarefas, pois da o tempo do rastro (conf_rtos.h) */
+	TempoUsInicia();
+#endif
+
+#if PADRAO_LED
+	/* LED de estado tocado pelo TCC0 e pelo DMAC (padrao_led.h): as tarefas 
+	   heartbeat e periodica nao acordam para altera-lo */
+	PadraoLedInicia(LED_0_PIN, LED_0_ACTIVE);
+	(void)PadraoLedBatimento();
 #endif
+
+#if SONO_RTC
+	/* esperas longas no STANDBY, acordadas pelo RTC (sono_rtc.h). A UART 
+	   para no STANDBY: um byte que chega durante o sono longo se perde */
+	SonoRtcInicia();
+#endif
+
+#if BORDAS
+	/* interrupcoes externas ligadas as tarefas (bordas.h): as linhas sao 
+	   configuradas e ligadas por quem as usa, depois de criar a tarefa */
+	BordasInicia();
+#endif
+	
+#if MEDE_NUCLEO
+	UartDmaInicia(UART_BAUD);
+#if MEDE_LATENCIA
+	MedeLatenciaCriaTarefas(EnviaMedicoes);
+#elif MEDE_THREAD_METRIC
+	MedeThreadMetricCriaTarefas(MEDE_THREAD_METRIC, EnviaMedicoes);
+#else
+	MedeNucleoCriaTarefas(EnviaMedicoes);
+#endif
+#else
+	/* Inicializacao do fluxo de bytes usado pelas tarefas 7 e 8 */
+	(void)AnelInicia(&FluxoDados, area_fluxo, TAM_FLUXO, LOTE_FLUXO);
 	
 	/* Criacao das tarefas */
 	/* Parametros: ponteiro, nome, ponteiro da pilha, tamanho da pilha, prioridade da tarefa */
@@ -90,14 +412,50 @@ int main(void)
 	
 	CriaTarefa(tarefa_2, "Tarefa 2", PILHA_TAREFA_2, TAM_PILHA_2, 1);
 	
+#if RECEBE_QUADROS_UART
+	CriaTarefa(tarefa_quadros_uart, "Quadros UART", PILHA_TAREFA_3, TAM_PILHA_3, 3);
+#elif RECEBE_QUADROS_USB
+	CriaTarefa(tarefa_quadros_usb, "Quadros USB", PILHA_TAREFA_3, TAM_PILHA_3, 3);
+#else
 	CriaTarefa(tarefa_3, "Tarefa 3", PILHA_TAREFA_3, TAM_PILHA_3, 3);
+#endif
 	
+#if MEDE_TROCA_CONTEXTO
+	CriaTarefa(tarefa_mede_troca, "Mede troca", PILHA_TAREFA_HEARTBEAT, TAM_PILHA_HEARTBEAT, 3);
+#elif MEDE_CACHE_NVM
+	CriaTarefa(tarefa_mede_cache_nvm, "Mede flash", PILHA_TAREFA_HEARTBEAT, TAM_PILHA_HEARTBEAT, 3);
+#elif MEDE_COMPRESSAO
+	CriaTarefa(tarefa_mede_compressao, "Mede compressao", PILHA_TAREFA_HEARTBEAT, TAM_PILHA_HEARTBEAT, 3);
+#else
 	CriaTarefa(tarefa_heartbeat, "Heartbeat", PILHA_TAREFA_HEARTBEAT, TAM_PILHA_HEARTBEAT, 1);
+#endif
 	
+#if AMOSTRA_ADC
+	CriaTarefa(tarefa_amostragem, "Amostragem", PILHA_TAREFA_PERIODICA, TAM_PILHA_PERIODICA, 2);
+#elif PROCESSA_DSP
+	CriaTarefa(tarefa_dsp, "DSP", PILHA_TAREFA_PERIODICA, TAM_PILHA_PERIODICA, 2);
+#else
 	CriaTarefa(tarefa_periodica_100ms, "Periodica 100ms", PILHA_TAREFA_PERIODICA, TAM_PILHA_PERIODICA, 2);
+#endif
+	
+#if TRANSACOES_BARRAMENTO
+	CriaTarefa(tarefa_barramentos, "Barramentos", PILHA_TAREFA_4, TAM_PILHA_4, 2);
+#endif
+	
+#if TELEMETRIA_UART
+	TelemetriaInicia(UartDmaEnvia);
+	CriaTarefa(tarefa_telemetria, "Telemetria", PILHA_TAREFA_TELEMETRIA, TAM_PILHA_TELEMETRIA, 1);
+#endif
+#endif /* MEDE_NUCLEO */
 	
-	/* Cria tarefa ociosa do sistema */
-	CriaTarefa(tarefa_ociosa,"Tarefa ociosa", PILHA_TAREFA_OCIOSA, TAM_PILHA_OCIOSA, 0);
+#if VIGIA_WDT
+	/* WDT alimentado pelo vigia: as tarefas heartbeat e periodica se 
+	   registram e sinalizam nos seus lacos */
+	VigiaWdtInicia(VIGIA_WDT_PERIODO, VIGIA_WDT_AVISO);
+#endif
+	
+	/* Cria tarefa ociosa do sistema, no fundo da pilha principal */
+	CriaTarefaOciosa(TAM_PILHA_OCIOSA);
 	
 	/* Configura marca de tempo */
 	ConfiguraMarcaTempo();   
@@ -111,6 +469,80 @@ int main(void)
 	}
 }
 
+#if MEDE_NUCLEO
+/* saida das medicoes do nucleo: cada linha vai inteira para o anel de 
+   envio. Uma rodada nao cabe no anel, entao espera a UART esvaziar-lo em 
+   vez de descartar a linha (a tarefa de medicao so envia entre as rodadas) */
+static void EnviaMedicoes(const char *texto)
+{
+	uint16_t tamanho = (uint16_t)strlen(texto);
+	
+	while(UartDmaEnvia((const uint8_t *)texto, tamanho) == 0)
+	{
+		TarefaEspera(1);
+	}
+}
+#endif
+
+/*
+ * Escolha do nivel de sono da tarefa ociosa (cfg_ANTES_DE_DORMIR), pelo 
+ * tempo ate o proximo despertar. Quanto mais profundo o nivel, menor o 
+ * consumo e maior a latencia para acordar, entao os niveis mais 
+ * profundos so sao usados em esperas longas:
+ *  - IDLE 0: para so o clock da CPU;
+ *  - IDLE 1: tambem o clock AHB;
+ *  - IDLE 2: tambem o clock APB.
+ * O STANDBY, em que o SysTick para, so e usado pelo sono longo 
+ * (SONO_RTC), a partir de cfg_SONO_LONGO_MARCAS, com o despertar e a 
+ * medida do tempo dormido pelo RTC (sono_rtc.c)
+ */
+#define MARCAS_SONO_IDLE_1		5
+#define MARCAS_SONO_IDLE_2		20
+
+#if cfg_ENERGIA
+/* potencia do nivel escolhido, para cfg_CUSTO_SONO */
+static uint32_t potencia_sono_uw;
+#define POTENCIA_SONO(uw)		(potencia_sono_uw = (uw))
+#else
+#define POTENCIA_SONO(uw)
+#endif
+
+void OciosaEscolheSono(uint32_t qtas_marcas)
+{
+	#if SONO_RTC
+	if(qtas_marcas >= cfg_SONO_LONGO_MARCAS && SonoRtcPermitido())
+	{
+		/* o STANDBY e escolhido por SonoRtcDorme, logo em seguida */
+		POTENCIA_SONO(POTENCIA_STANDBY_UW);
+		return;
+	}
+	#endif
+	if(qtas_marcas >= MARCAS_SONO_IDLE_2)
+	{
+		system_set_sleepmode(SYSTEM_SLEEPMODE_IDLE_2);
+		POTENCIA_SONO(POTENCIA_IDLE_2_UW);
+	}
+	else if(qtas_marcas >= MARCAS_SONO_IDLE_1)
+	{
+		system_set_sleepmode(SYSTEM_SLEEPMODE_IDLE_1);
+		POTENCIA_SONO(POTENCIA_IDLE_1_UW);
+	}
+	else
+	{
+		system_set_sleepmode(SYSTEM_SLEEPMODE_IDLE_0);
+		POTENCIA_SONO(POTENCIA_IDLE_0_UW);
+	}
+}
+
+#if cfg_ENERGIA
+/* cfg_CUSTO_SONO: custo por ciclo do ultimo sono, ao clock do perfil atual
+   (o SysTick conta os ciclos tambem dormindo) */
+uint32_t OciosaCustoSono(void)
+{
+	return CUSTO_CICLO(potencia_sono_uw, PerfilClockHz());
+}
+#endif
+
 /* Tarefas de exemplo que usam funcoes para suspender/continuar as tarefas */
 void tarefa_1(void)
 {
@@ -200,62 +632,42 @@ void tarefa_6(void)
 	}
 }
 
-/* solucao com buffer compartihado */
-/* Tarefas de exemplo que usam funcoes de semaforo */
-
-#define TAM_BUFFER 10
-uint8_t buffer[TAM_BUFFER]; /* declaracao de um buffer (vetor) ou fila circular */
-
-semaforo_t SemaforoCheio = {0,0}; /* declaracao e inicializacao de um semaforo */
-semaforo_t SemaforoVazio = {TAM_BUFFER,0}; /* declaracao e inicializacao de um semaforo */
+/* solucao com fluxo de bytes */
+/* Tarefas de exemplo que usam um anel como fluxo de bytes: o produtor 
+   escreve um byte por vez e o consumidor acorda uma vez por lote, em vez 
+   de uma troca de contexto por byte como no buffer com dois semaforos */
 
 void tarefa_7(void)
 {
 
 	uint8_t a = 1;			/* inicializacoes para a tarefa */
-	uint8_t i = 0;
 	
 	for(;;)
 	{
-		SemaforoAguarda(&SemaforoVazio);
-		
-		buffer[i] = a++;
-		i = (i+1)%TAM_BUFFER;
-		
-		SemaforoLibera(&SemaforoCheio); /* tarefa libera semaforo para tarefa que esta esperando-o */
+		(void)AnelEscreveEspera(&FluxoDados, &a, 1, ESPERA_INFINITA); /* espera se o anel estiver cheio */
+		a++;
 		
 		TarefaEspera(10); 	/* tarefa se coloca em espera por 10 marcas de tempo (ticks), equivale a 10ms */		
 	}
 }
 
-/* Exemplo de tarefa que usa semaforo */
+/* Exemplo de tarefa que recebe do fluxo, por lotes */
 void tarefa_8(void)
 {
-	static uint8_t f = 0;
 	volatile uint8_t valor;
 		
 	for(;;)
 	{
-		volatile uint8_t contador;
+		uint8_t lote[LOTE_FLUXO];
+		uint16_t i, recebidos;
 		
-		do{
-			REG_ATOMICA_INICIO();			
-				contador = SemaforoCheio.contador;			
-			REG_ATOMICA_FIM();
-			
-			if (contador == 0)
-			{
-				TarefaEspera(100);
-			}
-				
-		} while (!contador);
-		
-		SemaforoAguarda(&SemaforoCheio);
-		
-		valor = buffer[f];
-		f = (f+1) % TAM_BUFFER;		
-		
-		SemaforoLibera(&SemaforoVazio);
+		(void)AnelAguardaNivel(&FluxoDados, LOTE_FLUXO, 100); /* espera o lote ou 100 marcas */
+		recebidos = AnelLe(&FluxoDados, lote, sizeof(lote));
+		for(i = 0; i < recebidos; i++)
+		{
+			valor = lote[i];
+		}
+		(void)valor;
 	}
 }
 
@@ -264,15 +676,51 @@ void tarefa_8(void)
 void tarefa_heartbeat(void)
 {
 	static uint32_t heartbeat_counter = 0;
+#if !PADRAO_LED
 	static uint8_t led_state = 0;
+#endif
+	
+#if REGISTRO_SERIAL
+#if REGISTRO_SERIAL == 1
+	/* sem o buffer do stdio: cada printf e uma unica mensagem no anel */
+	setvbuf(stdout, NULL, _IONBF, 0);
+#else
+	(void)DiarioInicia(UartDmaEnvia);
+#endif
+#if !RECEBE_QUADROS_UART
+#if INICIO_CLOCKS == 2
+	(void)ClockAguardaFinal(ESPERA_INFINITA);
+#endif
+	UartDmaInicia(UART_BAUD);
+#endif
+#endif
+	
+#if VIGIA_WDT
+	VigiaRegistra(tarefa_atual, 3500);	/* maior intervalo do padrao: 800 + 2000 ms */
+#endif
 	
 	for(;;)
 	{
+		VigiaSinaliza();
 		heartbeat_counter++;
+#if TELEMETRIA_UART
+		(void)TelemetriaPublica(ID_BATIMENTOS, (int32_t)heartbeat_counter);
+		(void)TelemetriaPublica(ID_DESCARTES_UART, (int32_t)UartDmaDescartados());
+#endif
+#if REGISTRO_SERIAL == 1
+		printf("batimento %lu, descartados %lu\r\n", (unsigned long)heartbeat_counter,
+				(unsigned long)UartDmaDescartados());
+#elif REGISTRO_SERIAL == 2
+		DIARIO("batimento %lu, descartados %lu", heartbeat_counter, UartDmaDescartados());
+#endif
 		
+#if PADRAO_LED
+		/* o batimento do LED e tocado pelo hardware: um despertar por segundo */
+		TarefaEspera(1000);
+#else
 		/* Alterna estado do LED para mostrar atividade */
 		led_state = !led_state;
-		port_pin_set_output_level(LED_0_PIN, led_state ? LED_0_ACTIVE : !LED_0_ACTIVE);
+		port_iobus_pin_set_output_level(LED_0_PIN, led_state ? LED_0_ACTIVE : !LED_0_ACTIVE);	/* IOBUS: escrita em um ciclo */
 		
 		/* Implementa um pattern de heartbeat: 2 piscadas rapidas, pausa longa */
 		if (heartbeat_counter % 4 == 1 || heartbeat_counter % 4 == 2) {
@@ -282,6 +730,7 @@ void tarefa_heartbeat(void)
 			/* Pausa longa entre batimentos */
 			TarefaEspera(800);  /* 800ms */
 		}
+#endif
 		
 		/* A cada 50 heartbeats, faz uma pausa mais longa (simula checagem de sistema) */
 		if (heartbeat_counter % 50 == 0) {
@@ -296,25 +745,522 @@ void tarefa_periodica_100ms(void)
 {
 	static uint32_t contador_execucoes = 0;
 	static uint32_t tempo_total_ms = 0;
+	tick_t ultimo_despertar = ObtemMarcasDeTempo();
+	
+#if VIGIA_WDT
+	VigiaRegistra(tarefa_atual, 300);
+#endif
 	
 	for(;;)
 	{
+		VigiaSinaliza();
 		contador_execucoes++;
+#if TELEMETRIA_UART
+		(void)TelemetriaPublica(ID_EXECUCOES_100MS, (int32_t)contador_execucoes);
+#endif
 		tempo_total_ms += 100; /* Incrementa o tempo total em 100ms a cada execucao */
 		
 		/* Simulacao de processamento periodico */
 		/* Pode ser usado para: leitura de sensores, atualizacao de controles, etc. */
 		
 		/* Exemplo: toggle de um indicador visual a cada 10 execucoes (1 segundo) */
+#if !PADRAO_LED
 		if (contador_execucoes % 10 == 0) {
 			/* A cada 1 segundo (10 * 100ms), faz algo especial */
 			port_pin_set_output_level(LED_0_PIN, LED_0_ACTIVE);
 			TarefaEspera(50); /* Liga LED por 50ms */
 			port_pin_set_output_level(LED_0_PIN, !LED_0_ACTIVE);
 		}
+#endif
 		
-		/* Espera 100ms ate a proxima execucao (100 ticks a 1ms cada) */
+		/* Espera ate o proximo instante multiplo de 100ms (100 ticks a 1ms cada), 
+		   o tempo de execucao e a espera do LED nao atrasam o periodo */
 		/* Funciona tanto em modo cooperativo quanto preemptivo */
+#if ESCALA_CLOCK_PELA_CARGA
+		PerfilClockGoverna();
+#endif
+		TarefaEsperaAte(&ultimo_despertar, 100);
+	}
+}
+
+#if MEDE_TROCA_CONTEXTO
+/* Tarefa de medicao do custo da troca de contexto, em ciclos de clock */
+/* A tarefa solicita a troca de contexto para si mesma, o que executa o 
+   PendSV_Handler completo (salva o contexto, escalona e restaura). 
+   Os resultados podem ser lidos pelo depurador */
+volatile uint32_t ciclos_troca_ultima = 0;
+volatile uint32_t ciclos_troca_min = 0xFFFFFFFF;
+volatile uint32_t ciclos_troca_max = 0;
+
+void tarefa_mede_troca(void)
+{
+	uint32_t inicio, fim, ajuste, ciclos;
+	reg_atomica_t estado;
+	
+	for(;;)
+	{
+		REG_ATOMICA_INICIO(estado);
+		
+		/* custo da propria leitura do contador, descontado da medicao */
+		inicio = LE_CONTADOR_CICLOS();
+		fim = LE_CONTADOR_CICLOS();
+		ajuste = inicio - fim;
+		
+		inicio = LE_CONTADOR_CICLOS();
+		TROCA_CONTEXTO();
+		REG_ATOMICA_FIM(estado);		/* o PendSV executa assim que as interrupcoes sao habilitadas */
+		fim = LE_CONTADOR_CICLOS();
+		
+		/* o contador conta para baixo: descarta a medicao se houve recarga (marca de tempo) */
+		if(fim < inicio)
+		{
+			ciclos = inicio - fim - ajuste;
+			ciclos_troca_ultima = ciclos;
+			if(ciclos < ciclos_troca_min)
+			{
+				ciclos_troca_min = ciclos;
+			}
+			if(ciclos > ciclos_troca_max)
+			{
+				ciclos_troca_max = ciclos;
+			}
+		}
+		
+		TarefaEspera(1);
+	}
+}
+#endif
+
+#if MEDE_CACHE_NVM
+/* Tarefa de medicao do cache e do modo de leitura da flash, em ciclos por 
+   iteracao de um laco do nucleo executado da flash (libera e obtem um 
+   semaforo). Os resultados podem ser lidos pelo depurador, indexados por 
+   [cache ligado][NVMCTRL_CTRLB_READMODE_*_Val]. A menor variacao entre as 
+   medicoes mostra o modo deterministico; o menor valor, o melhor desempenho */
+#define ITERACOES_NVM		16
+#define MODOS_LEITURA_NVM	3
+
+volatile uint16_t ciclos_nvm[2][MODOS_LEITURA_NVM];
+
+void tarefa_mede_cache_nvm(void)
+{
+	static semaforo_t semaforo_medicao = {0,0};
+	uint32_t inicio, fim;
+	reg_atomica_t estado;
+	uint8_t cache, modo, i;
+	
+	for(;;)
+	{
+		for(cache = 0; cache < 2; cache++)
+		{
+			for(modo = 0; modo < MODOS_LEITURA_NVM; modo++)
+			{
+				PerfilClockConfiguraNvm(cache, modo);
+				
+				REG_ATOMICA_INICIO(estado);
+				inicio = LE_CONTADOR_CICLOS();
+				for(i = 0; i < ITERACOES_NVM; i++)
+				{
+					SemaforoLibera(&semaforo_medicao);
+					(void)SemaforoAguardaTempo(&semaforo_medicao, 0);
+				}
+				fim = LE_CONTADOR_CICLOS();
+				REG_ATOMICA_FIM(estado);
+				
+				/* o contador conta para baixo: descarta a medicao se houve recarga */
+				if(fim < inicio)
+				{
+					ciclos_nvm[cache][modo] = (uint16_t)((inicio - fim) / ITERACOES_NVM);
+				}
+			}
+		}
+		
+		/* volta a configuracao do perfil de desempenho */
+		PerfilClockConfiguraNvm(PERFIL_DESEMPENHO_CACHE_NVM, PERFIL_DESEMPENHO_LEITURA_NVM);
+		TarefaEspera(100);
+	}
+}
+#endif
+
+#if MEDE_COMPRESSAO
+/* Tarefa de medicao da compressao da telemetria: a cada rodada gera um 
+   quadro de TELEMETRIA_POR_QUADRO amostras de quatro sinais (temperatura e 
+   pressao em passeio aleatorio, leitura de ADC com ruido e um contador), e 
+   mede os ciclos para comprimi-lo, descomprimi-lo e escreve-lo sem 
+   compressao. Os resultados podem ser lidos pelo depurador: ciclos por 
+   amostra (a menor medicao) e a razao entre os bytes sem e com compressao, 
+   x100. erros_compressao conta as amostras descomprimidas erradas */
+#define SINAIS_COMPRESSAO	4
+
+volatile uint16_t ciclos_comprime_amostra = 0xFFFF;
+volatile uint16_t ciclos_descomprime_amostra = 0xFFFF;
+volatile uint16_t ciclos_amostra_sem_compressao = 0xFFFF;
+volatile uint16_t razao_compressao_x100;
+volatile uint32_t erros_compressao;
+
+/* fora da pilha da tarefa, que e a do heartbeat */
+static uint8_t ids_medicao[TELEMETRIA_POR_QUADRO];
+static int32_t valores_medicao[TELEMETRIA_POR_QUADRO];
+static uint8_t quadro_medicao[TELEMETRIA_POR_QUADRO * TELEMETRIA_MAIOR_COMPRIMIDA];
+static compressor_telemetria_t compressor_medicao;
+
+void tarefa_mede_compressao(void)
+{
+	int32_t sinais[SINAIS_COMPRESSAO] = {2500, 101325, 2048, 0};
+	uint32_t semente = 1, inicio, fim;
+	uint32_t bytes_sem_compressao = 0, bytes_comprimidos = 0;
+	reg_atomica_t estado;
+	uint16_t tamanho, lidos, ciclos;
+	uint8_t i, id;
+	int32_t valor;
+	
+	for(;;)
+	{
+		for(i = 0; i < TELEMETRIA_POR_QUADRO; i++)
+		{
+			semente = semente * 1664525UL + 1013904223UL;
+			id = (uint8_t)(i % SINAIS_COMPRESSAO);
+			switch(id)
+			{
+				case 0: sinais[0] += (int32_t)((semente >> 24) % 5) - 2; break;		/* centesimos de grau */
+				case 1: sinais[1] += (int32_t)((semente >> 24) % 17) - 8; break;	/* Pa */
+				case 2: sinais[2] = 2048 + (int32_t)((semente >> 24) % 63) - 31; break;
+				default: sinais[3]++; break;
+			}
+			ids_medicao[i] = id;
+			valores_medicao[i] = sinais[id];
+		}
+		
+		REG_ATOMICA_INICIO(estado);
+		inicio = LE_CONTADOR_CICLOS();
+		TelemetriaCompressorInicia(&compressor_medicao);
+		tamanho = 0;
+		for(i = 0; i < TELEMETRIA_POR_QUADRO; i++)
+		{
+			tamanho = (uint16_t)(tamanho + TelemetriaComprime(&compressor_medicao, ids_medicao[i], 
+				valores_medicao[i], &quadro_medicao[tamanho]));
+		}
+		fim = LE_CONTADOR_CICLOS();
+		REG_ATOMICA_FIM(estado);
+		
+		/* o contador conta para baixo: descarta a medicao se houve recarga */
+		ciclos = (uint16_t)((inicio - fim) / TELEMETRIA_POR_QUADRO);
+		if(fim < inicio && ciclos < ciclos_comprime_amostra)
+		{
+			ciclos_comprime_amostra = ciclos;
+		}
+		bytes_sem_compressao += TELEMETRIA_POR_QUADRO * TELEMETRIA_TAM_AMOSTRA;
+		bytes_comprimidos += tamanho;
+		razao_compressao_x100 = (uint16_t)(bytes_sem_compressao * 100 / bytes_comprimidos);
+		if(bytes_sem_compressao >= 0x10000000UL)
+		{
+			bytes_sem_compressao /= 2;
+			bytes_comprimidos /= 2;
+		}
+		
+		REG_ATOMICA_INICIO(estado);
+		inicio = LE_CONTADOR_CICLOS();
+		TelemetriaCompressorInicia(&compressor_medicao);
+		lidos = 0;
+		for(i = 0; i < TELEMETRIA_POR_QUADRO; i++)
+		{
+			lidos = (uint16_t)(lidos + TelemetriaDescomprime(&compressor_medicao, &quadro_medicao[lidos], 
+				(uint8_t)(tamanho - lidos), &id, &valor));
+			if(id != ids_medicao[i] || valor != valores_medicao[i])
+			{
+				erros_compressao++;
+			}
+		}
+		fim = LE_CONTADOR_CICLOS();
+		REG_ATOMICA_FIM(estado);
+		
+		ciclos = (uint16_t)((inicio - fim) / TELEMETRIA_POR_QUADRO);
+		if(fim < inicio && ciclos < ciclos_descomprime_amostra)
+		{
+			ciclos_descomprime_amostra = ciclos;
+		}
+		
+		/* a mesma escrita de MontaQuadro sem compressao */
+		REG_ATOMICA_INICIO(estado);
+		inicio = LE_CONTADOR_CICLOS();
+		for(i = 0; i < TELEMETRIA_POR_QUADRO; i++)
+		{
+			uint8_t *p = &quadro_medicao[i * TELEMETRIA_TAM_AMOSTRA];
+			uint32_t v = (uint32_t)valores_medicao[i];
+			
+			p[0] = ids_medicao[i];
+			p[1] = (uint8_t)v;
+			p[2] = (uint8_t)(v >> 8);
+			p[3] = (uint8_t)(v >> 16);
+			p[4] = (uint8_t)(v >> 24);
+		}
+		fim = LE_CONTADOR_CICLOS();
+		REG_ATOMICA_FIM(estado);
+		
+		ciclos = (uint16_t)((inicio - fim) / TELEMETRIA_POR_QUADRO);
+		if(fim < inicio && ciclos < ciclos_amostra_sem_compressao)
+		{
+			ciclos_amostra_sem_compressao = ciclos;
+		}
+		
+		TarefaEspera(10);
+	}
+}
+#endif
+
+#if TELEMETRIA_UART
+/* envia os quadros de telemetria. Sem as tarefas de quadros e de registro, 
+   que ja iniciam a UART, a inicia antes do primeiro quadro */
+void tarefa_telemetria(void)
+{
+#if !RECEBE_QUADROS_UART && !REGISTRO_SERIAL
+#if INICIO_CLOCKS == 2
+	(void)ClockAguardaFinal(ESPERA_INFINITA);
+#endif
+	UartDmaInicia(UART_BAUD);
+#endif
+	TelemetriaExecuta();
+}
+#endif
+
+#if RECEBE_QUADROS_UART
+/*
+ * Recepcao de quadros STX, QTD, DADOS, CHK, ETX a partir dos blocos 
+ * entregues pelo DMA, analisados pelo receptor de quadros sem o anel (os 
+ * contadores ficam em receptor.estatisticas)
+ */
+static receptor_quadros_t receptor;
+
+#if CONSOLE_UART
+/* campos de estatisticas_receptor_t, na ordem, para o comando proto */
+static const char * const nomes_receptor[] =
+{
+	"bytes", "despertares", "quadros_validos", "quadros_invalidos", "entregas_perdidas", "bytes_perdidos",
+	"sem_tratador"
+};
+#endif
+
+void tarefa_quadros_uart(void)
+{
+	const uint8_t *bloco;
+	uint16_t tamanho;
+	
+#if INICIO_CLOCKS == 2
+	(void)ClockAguardaFinal(ESPERA_INFINITA);	/* acima de 500kbaud, so a 48MHz */
+#endif
+	(void)ReceptorQuadrosInicia(&receptor, 0, 0, 0, RECEPTOR_LINHA_OCIOSA, 0, 0);
+#if CRC_DMA
+	/* CHK de CRC-32 pelo DMAC; com o CRC do DMAC errado, fica a soma */
+	if(CrcDmaInicia())
+	{
+		(void)ReceptorQuadrosIntegridade(&receptor, RECEPTOR_CRC32);
+	}
+#endif
+	UartDmaInicia(UART_BAUD);
+#if CONSOLE_UART
+	(void)ConsoleRegistraContadores("receptor", (const volatile uint32_t *)&receptor.estatisticas,
+									nomes_receptor, sizeof(nomes_receptor) / sizeof(nomes_receptor[0]));
+	(void)ConsoleRegistraSemaforo("teste", &SemaforoTeste);
+#if cfg_REGISTRO_OBJETOS
+	OBJETO_REGISTRA(OBJETO_SEMAFORO, &SemaforoTeste, "teste");
+#endif
+	(void)ConsoleInicia(UartDmaEnvia);
+#endif
+	
+	for(;;)
+	{
+		tamanho = UartDmaRecebe(&bloco);		/* bloco cheio ou fim de rajada */
+		ReceptorQuadrosProcessa(&receptor, bloco, tamanho);
+#if CONSOLE_UART
+		(void)ConsoleRecebe(bloco, tamanho);	/* comandos de texto entre os quadros */
+#endif
+	}
+}
+#endif
+
+#if RECEBE_QUADROS_USB
+/*
+ * Recepcao de quadros pela USB: cada buffer recebido (ate 
+ * USB_CDC_TAM_RECEPCAO bytes, ou uma escrita do PC) vai direto ao receptor 
+ * de quadros, sem copia. Enquanto a tarefa processa um buffer, a USB enche 
+ * o outro; com os dois cheios, o PC espera
+ */
+static receptor_quadros_t receptor_usb;
+
+void tarefa_quadros_usb(void)
+{
+	const uint8_t *bloco;
+	uint16_t tamanho;
+	
+	(void)ClockAguardaFinal(ESPERA_INFINITA);	/* a USB usa a DFLL travada */
+	(void)ReceptorQuadrosInicia(&receptor_usb, 0, 0, 0, RECEPTOR_LINHA_OCIOSA, 0, 0);
+	UsbCdcInicia();
+	
+	for(;;)
+	{
+		tamanho = UsbCdcRecebe(&bloco);
+		ReceptorQuadrosProcessa(&receptor_usb, bloco, tamanho);
+	}
+}
+#endif
+
+#if AMOSTRA_ADC
+/*
+ * Amostragem periodica sem a CPU: diferente da tarefa periodica, que acorda 
+ * a cada periodo, esta tarefa so acorda a cada AMOSTRAGEM_TAM_LOTE amostras, 
+ * quando o DMAC completa um lote
+ */
+volatile uint16_t media_amostras = 0;
+volatile tick_t marca_media_amostras = 0;		/* fim do lote da media */
+
+void tarefa_amostragem(void)
+{
+	const uint16_t *lote;
+	uint32_t soma;
+	uint16_t i;
+	
+	AmostragemInicia(FREQUENCIA_AMOSTRAS);
+	
+	for(;;)
+	{
+		lote = AmostragemAguardaLote(ESPERA_INFINITA);
+		
+		soma = 0;
+		for(i = 0; i < AMOSTRAGEM_TAM_LOTE; i++)
+		{
+			soma += lote[i];
+		}
+		media_amostras = (uint16_t)(soma / AMOSTRAGEM_TAM_LOTE);
+		marca_media_amostras = AmostragemMarcaLote();
+	}
+}
+#endif
+
+#if PROCESSA_DSP
+/*
+ * Cadeia de filtros por lote: FIR de media movel de 8 amostras seguido de 
+ * um biquad passa-baixas Butterworth de 50Hz (para 1kHz de amostragem). 
+ * A tarefa so acorda a cada lote, como em AMOSTRA_ADC. A capacidade e 
+ * estimada pelos ciclos do processamento de um lote, sem interrupcoes
+ */
+static const q15_t coef_fir[8] = 
+{
+	4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096		/* 1/8 em Q15 */
+};
+
+/* {b0, 0, b1, b2, a1, a2} escalados por 1/2 (desloc_biquad = 1) */
+static const q15_t coef_biquad[FILTRO_DSP_COEF_ESTAGIO] = 
+{
+	329, 0, 658, 329, 25576, -10508
+};
+
+static filtro_dsp_t filtro;
+
+volatile q15_t ultima_saida_dsp = 0;
+volatile uint32_t ciclos_lote_dsp = 0xFFFFFFFF;		/* menor medicao */
+volatile uint32_t amostras_por_segundo_dsp = 0;		/* capacidade da CPU no clock atual */
+volatile uint32_t amostras_processadas_dsp = 0;
+
+void tarefa_dsp(void)
+{
+	const uint16_t *lote;
+	const q15_t *saida;
+	uint32_t inicio, fim;
+	
+	(void)FiltroDspInicia(&filtro, coef_fir, 8, coef_biquad, 1, 1);
+	AmostragemInicia(FREQUENCIA_AMOSTRAS);
+	
+	for(;;)
+	{
+		lote = AmostragemAguardaLote(ESPERA_INFINITA);
+		
+		inicio = LE_CONTADOR_CICLOS();
+		saida = FiltroDspProcessa(&filtro, lote);
+		fim = LE_CONTADOR_CICLOS();
+		
+		/* o contador conta para baixo: descarta a medicao se houve recarga; 
+		   a menor medicao e a sem interrupcoes no meio */
+		if(fim < inicio && (inicio - fim) < ciclos_lote_dsp)
+		{
+			ciclos_lote_dsp = inicio - fim;
+			amostras_por_segundo_dsp = (uint32_t)(((uint64_t)PerfilClockHz() * FILTRO_DSP_TAM_LOTE) / ciclos_lote_dsp);
+		}
+		
+		ultima_saida_dsp = saida[FILTRO_DSP_TAM_LOTE - 1];
+		amostras_processadas_dsp += FILTRO_DSP_TAM_LOTE;
+	}
+}
+#endif
+
+#if TRANSACOES_BARRAMENTO
+/*
+ * A cada 100ms le o registrador de temperatura (0x00) de um sensor I2C 
+ * (ex.: AT30TSE758 da I/O1 Xplained Pro, endereco 0x4F) e a identificacao 
+ * JEDEC (comando 0x9F) de uma memoria SPI no CS do EXT1. As duas 
+ * transacoes sao enfileiradas juntas e executam em paralelo
+ */
+#define ENDERECO_SENSOR_I2C		0x4F
+#define PINO_CS_SPI				EXT1_PIN_SPI_SS_0
+
+volatile uint16_t temperatura_i2c = 0;
+volatile uint32_t identificacao_spi = 0;
+volatile uint32_t erros_barramento = 0;
+
+void tarefa_barramentos(void)
+{
+	static const uint8_t registro_temperatura = 0x00;
+	static const uint8_t comando_jedec[4] = {0x9F, 0, 0, 0};
+	static uint8_t temperatura[2];
+	static uint8_t jedec[4];
+	static transacao_i2c_t leitura_i2c;
+	static transacao_spi_t leitura_spi;
+#if !PINOS_TABELA
+	struct port_config config_cs;
+#endif
+	
+#if INICIO_CLOCKS == 2
+	(void)ClockAguardaFinal(ESPERA_INFINITA);
+#endif
+#if !PINOS_TABELA
+	port_get_config_defaults(&config_cs);
+	config_cs.direction = PORT_PIN_DIR_OUTPUT;
+	port_pin_set_config(PINO_CS_SPI, &config_cs);
+	port_pin_set_output_level(PINO_CS_SPI, true);
+#endif
+	
+	SpiDmaInicia(FREQUENCIA_SPI);
+	I2cMestreInicia(FREQUENCIA_I2C);
+	
+	leitura_i2c.endereco = ENDERECO_SENSOR_I2C;
+	leitura_i2c.envio = &registro_temperatura;
+	leitura_i2c.tam_envio = 1;
+	leitura_i2c.recepcao = temperatura;
+	leitura_i2c.tam_recepcao = sizeof(temperatura);
+	
+	leitura_spi.envio = comando_jedec;
+	leitura_spi.recepcao = jedec;
+	leitura_spi.tamanho = sizeof(jedec);
+	leitura_spi.pino_cs = PINO_CS_SPI;
+	
+	for(;;)
+	{
+		I2cMestreEnfileira(&leitura_i2c);
+		SpiDmaEnfileira(&leitura_spi);
+		
+		if(SpiDmaAguarda(&leitura_spi, ESPERA_INFINITA))
+		{
+			identificacao_spi = ((uint32_t)jedec[1] << 16) | ((uint32_t)jedec[2] << 8) | jedec[3];
+		}
+		if(I2cMestreAguarda(&leitura_i2c, ESPERA_INFINITA) == I2C_OK)
+		{
+			temperatura_i2c = (uint16_t)((temperatura[0] << 8) | temperatura[1]);
+		}
+		else
+		{
+			erros_barramento++;
+		}
+		
 		TarefaEspera(100);
 	}
 }
+#endif
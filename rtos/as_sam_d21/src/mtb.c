@@ -0,0 +1,89 @@
+/*
+ * mtb.c
+ *
+ * Rastro de instrucoes pelo MTB do Cortex-M0+ (ver mtb.h).
+ */
+
+#include <asf.h>
+#include "mtb.h"
+
+#if MTB_RASTRO
+
+/* buffer do MTB: o ponteiro de escrita so avanca nos bits abaixo de
+   MASTER.MASK, entao o buffer deve estar alinhado ao proprio tamanho */
+static uint32_t buffer_mtb[MTB_TAMANHO / 4] __attribute__((section(".mtb"), aligned(MTB_TAMANHO)));
+
+/* posicao de escrita e volta do buffer no momento da parada */
+static uint16_t fim_mtb;
+static uint8_t voltou_mtb;
+
+/* MASTER.MASK: o buffer tem 2^(MASK + 4) bytes */
+static uint8_t MascaraMtb(void)
+{
+	uint8_t mascara = 0;
+
+	while((16UL << mascara) < MTB_TAMANHO)
+	{
+		mascara++;
+	}
+	return mascara;
+}
+
+/* (re)inicia o rastro do inicio do buffer. O ponteiro e relativo a base
+   da RAM informada pelo proprio MTB */
+void MtbInicia(void)
+{
+	MTB->MASTER.reg = 0;
+	MTB->FLOW.reg = 0;
+	MTB->POSITION.reg = ((uint32_t)buffer_mtb - MTB->BASE.reg) & MTB_POSITION_POINTER_Msk;
+	MTB->MASTER.reg = MTB_MASTER_EN | MTB_MASTER_MASK(MascaraMtb());
+}
+
+/* para o rastro e guarda a posicao. Pode ser chamada de interrupcoes e
+   mais de uma vez: so a primeira parada conta, ate o proximo MtbInicia */
+void MtbPara(void)
+{
+	reg_atomica_t estado;
+	uint32_t posicao;
+
+	REG_ATOMICA_INICIO(estado);
+	if(MTB->MASTER.reg & MTB_MASTER_EN)
+	{
+		MTB->MASTER.reg &= ~MTB_MASTER_EN;
+		posicao = MTB->POSITION.reg;
+		fim_mtb = (uint16_t)((posicao & MTB_POSITION_POINTER_Msk & (MTB_TAMANHO - 1)) / 8);
+		voltou_mtb = (posicao & MTB_POSITION_WRAP) != 0;
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+uint8_t MtbAtivo(void)
+{
+	return (MTB->MASTER.reg & MTB_MASTER_EN) != 0;
+}
+
+/* desvios guardados na ultima parada */
+uint16_t MtbDesvios(void)
+{
+	return voltou_mtb ? (uint16_t)(MTB_TAMANHO / 8) : fim_mtb;
+}
+
+/* desvio indice (0 = o mais antigo) da ultima parada. O bit 0 da origem e
+   MTB_EXCECAO e o do destino, MTB_INICIO */
+void MtbLe(uint16_t indice, uint32_t *origem, uint32_t *destino)
+{
+	uint16_t i = voltou_mtb ? (uint16_t)((fim_mtb + indice) & (MTB_TAMANHO / 8 - 1)) : indice;
+
+	*origem = buffer_mtb[2 * i];
+	*destino = buffer_mtb[2 * i + 1];
+}
+
+/* cfg_PRAZO_PERDIDO: guarda o caminho ate a tarefa perder o prazo */
+void MtbPrazoPerdido(uint8_t id_tarefa, tick_t atraso)
+{
+	(void)id_tarefa;
+	(void)atraso;
+	MtbPara();
+}
+
+#endif /* MTB_RASTRO */
@@ -0,0 +1,67 @@
+/*
+ * mtb.h
+ *
+ * Rastro de instrucoes pelo MTB (Micro Trace Buffer) do Cortex-M0+: com o
+ * MTB ligado, o processador grava na RAM, sem instrucoes a mais, a origem
+ * e o destino de cada desvio que nao segue em sequencia (desvios tomados,
+ * chamadas, retornos, entradas e saidas de excecao). Os ultimos
+ * MTB_TAMANHO / 8 desvios ficam no buffer, que e circular, entao o
+ * caminho exato do codigo ate um evento pode ser reconstruido depois.
+ *
+ * O buffer fica na secao .mtb do script do ligador, no inicio da RAM
+ * (alinhado ao proprio tamanho, como o MTB exige). Nao e zerado na
+ * partida, entao o rastro de antes de um reset quente ainda pode ser lido
+ * pelo depurador.
+ *
+ * O rastro e parado pelos gatilhos do nucleo, para guardar o caminho ate
+ * o evento em vez de sobrescreve-lo:
+ *  - prazo perdido de uma tarefa periodica (cfg_PRAZO_PERDIDO, com
+ *    cfg_MONITOR_PERIODICAS, ver conf_rtos.h);
+ *  - tarefa atrasada no vigia (VigiaWdtFalhou, com VIGIA_WDT);
+ *  - MtbPara chamada pela aplicacao (ex.: numa latencia fora do limite).
+ * Com CONSOLE_UART, o comando "mtb dump" envia os desvios em hexadecimal
+ * (parando o rastro, se ainda ativo) e "mtb start" o reinicia. O programa
+ * host_posix/decodifica_mtb.c traduz os enderecos para as funcoes.
+ *
+ * Ligado com MTB_RASTRO=1 nos simbolos do projeto. Ex.:
+ *
+ *   MtbInicia();				no inicio de main
+ *   ...
+ *   if(latencia > LIMITE) MtbPara();
+ */
+
+
+#ifndef MTB_H_
+#define MTB_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef MTB_RASTRO
+#define MTB_RASTRO				0
+#endif
+
+/* bytes do buffer (potencia de 2, 16 a 32768): 8 bytes por desvio */
+#ifndef MTB_TAMANHO
+#define MTB_TAMANHO				1024
+#endif
+
+#if MTB_RASTRO
+#if MTB_TAMANHO < 16 || MTB_TAMANHO > 32768 || (MTB_TAMANHO & (MTB_TAMANHO - 1)) != 0
+#error "MTB_TAMANHO deve ser uma potencia de 2 entre 16 e 32768"
+#endif
+#endif
+
+/* bit 0 da origem: desvio de entrada ou saida de excecao */
+#define MTB_EXCECAO				1UL
+/* bit 0 do destino: primeiro desvio depois de o rastro (re)iniciar */
+#define MTB_INICIO				1UL
+
+void MtbInicia(void);
+void MtbPara(void);
+uint8_t MtbAtivo(void);
+uint16_t MtbDesvios(void);
+void MtbLe(uint16_t indice, uint32_t *origem, uint32_t *destino);
+void MtbPrazoPerdido(uint8_t id_tarefa, tick_t atraso);
+
+#endif /* MTB_H_ */
@@ -0,0 +1,179 @@
+/*
+ * padrao_led.c
+ *
+ * Padroes de LED pelo TCC0 e pelo DMAC, sem a CPU (ver padrao_led.h).
+ */
+
+#include <asf.h>
+#include "dma.h"
+#include "padrao_led.h"
+#include "sincronismo.h"
+
+#if PADRAO_LED
+
+#if PADRAO_LED_CANAL >= DMA_NUMERO_CANAIS
+#error "PADRAO_LED_CANAL deve ser menor que DMA_NUMERO_CANAIS (dma.h)"
+#endif
+
+/* clock do TCC0: OSCULP32K / 2^(4+1) = 1,024 kHz */
+#define CLOCK_TCC_HZ		1024UL
+
+/* troca de cada passo para o seguinte, lida pelo DMAC: 0 ou a mascara do
+   pino no byte do OUTTGL */
+static uint8_t trocas[PADRAO_LED_MAX_PASSOS];
+
+static PortGroup *grupo;
+static uint32_t mascara;
+static uint8_t bit_pino;					/* 0 a 31 */
+static uint8_t ativo;
+
+/* leva o pino ao nivel do LED aceso ou apagado */
+static void Acende(uint8_t aceso)
+{
+	if((aceso != 0) == (ativo != 0))
+	{
+		grupo->OUTSET.reg = mascara;
+	}
+	else
+	{
+		grupo->OUTCLR.reg = mascara;
+	}
+}
+
+static void ParaCanal(void)
+{
+	reg_atomica_t estado;
+
+	REG_ATOMICA_INICIO(estado);
+	DMAC->CHID.reg = PADRAO_LED_CANAL;
+	DMAC->CHCTRLA.reg = 0;
+	while(DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE) {}
+	REG_ATOMICA_FIM(estado);
+}
+
+/* prepara o TCC0 e o canal do DMAC para o pino (ex.: LED_0_PIN), aceso no
+   nivel_ativo. O LED fica apagado ate o primeiro padrao */
+void PadraoLedInicia(uint8_t pino, uint8_t nivel_ativo)
+{
+	grupo = &PORT->Group[pino / 32];
+	bit_pino = (uint8_t)(pino % 32);
+	mascara = 1UL << bit_pino;
+	ativo = nivel_ativo;
+	Acende(0);
+	grupo->DIRSET.reg = mascara;
+
+	PM->APBCMASK.reg |= PM_APBCMASK_TCC0;
+	GCLK->GENDIV.reg = GCLK_GENDIV_ID(PADRAO_LED_GERADOR) | GCLK_GENDIV_DIV(4);
+	GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(PADRAO_LED_GERADOR) | GCLK_GENCTRL_SRC_OSCULP32K |
+						GCLK_GENCTRL_DIVSEL | GCLK_GENCTRL_RUNSTDBY | GCLK_GENCTRL_GENEN;
+	while(GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY) {}
+	GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(TCC0_GCLK_ID) | GCLK_CLKCTRL_GEN(PADRAO_LED_GERADOR) | GCLK_CLKCTRL_CLKEN;
+
+	TCC0->CTRLA.reg = TCC_CTRLA_SWRST;
+	while(TCC0->SYNCBUSY.reg & TCC_SYNCBUSY_SWRST) {}
+
+	/* um estouro por passo: o pedido de DMA do estouro dispara o canal */
+	TCC0->CTRLA.reg = TCC_CTRLA_PRESCALER_DIV1 | TCC_CTRLA_RUNSTDBY;
+	TCC0->WAVE.reg = TCC_WAVE_WAVEGEN_NFRQ;
+	TCC0->PER.reg = (PADRAO_LED_PASSO_MS * CLOCK_TCC_HZ + 500) / 1000 - 1;
+	while(TCC0->SYNCBUSY.reg & TCC_SYNCBUSY_PER) {}
+
+	DmaIniciaControlador();
+	DMAC->CHID.reg = PADRAO_LED_CANAL;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while(DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST) {}
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(TCC0_DMAC_ID_OVF) |
+						DMAC_CHCTRLB_TRIGACT_BEAT;
+}
+
+/* toca o padrao de passos de PADRAO_LED_PASSO_MS, repetido sem fim:
+   acesos[i] diferente de 0 acende o LED no passo i. Retorna 0 se o padrao
+   passa de PADRAO_LED_MAX_PASSOS */
+uint8_t PadraoLedToca(const uint8_t *acesos, uint8_t passos)
+{
+	DmacDescriptor *d = &dma_descritores[PADRAO_LED_CANAL];
+	uint8_t bit = (uint8_t)(1u << (bit_pino % 8));
+	uint8_t i, seguinte;
+
+	if(passos == 0 || passos > PADRAO_LED_MAX_PASSOS)
+	{
+		return 0;
+	}
+	/* a ~1 kHz cada sincronismo leva ~3 ms: a tarefa bloqueia enquanto o TCC0
+	   sincroniza, e a tabela e montada durante o sincronismo do COUNT */
+	ParaCanal();
+	SINCRONIZA_LENTO(TCC0->SYNCBUSY.reg);		/* escritas da chamada anterior */
+	TCC0->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+	SINCRONIZA_LENTO(TCC0->SYNCBUSY.reg & TCC_SYNCBUSY_ENABLE);
+	TCC0->COUNT.reg = 0;							/* passo 0 inteiro */
+
+	/* o estouro do fim do passo i escreve a troca para o passo i + 1 */
+	for(i = 0; i < passos; i++)
+	{
+		seguinte = (uint8_t)((i + 1) % passos);
+		trocas[i] = ((acesos[seguinte] != 0) != (acesos[i] != 0)) ? bit : 0;
+	}
+	Acende(acesos[0]);
+
+	/* um bloco com a tabela inteira, que volta ao proprio descritor. A
+	   origem e o fim da tabela (origem incrementada) */
+	d->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+					DMAC_BTCTRL_BLOCKACT_NOACT;
+	d->BTCNT.reg = passos;
+	d->SRCADDR.reg = (uint32_t)&trocas[passos];
+	d->DSTADDR.reg = (uint32_t)&grupo->OUTTGL.reg + bit_pino / 8;	/* escrita de 1 byte */
+	d->DESCADDR.reg = (uint32_t)d;
+
+	DMAC->CHID.reg = PADRAO_LED_CANAL;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+
+	/* o ENABLE sincroniza depois do retorno */
+	SINCRONIZA_LENTO(TCC0->SYNCBUSY.reg & TCC_SYNCBUSY_COUNT);
+	TCC0->CTRLA.reg |= TCC_CTRLA_ENABLE;
+	return 1;
+}
+
+/* LED aceso aceso_ms a cada periodo_ms, arredondados para passos */
+uint8_t PadraoLedPisca(uint16_t periodo_ms, uint16_t aceso_ms)
+{
+	uint8_t acesos[PADRAO_LED_MAX_PASSOS];
+	uint16_t passos = PADRAO_LED_PASSOS(periodo_ms);
+	uint16_t i;
+
+	if(passos == 0 || passos > PADRAO_LED_MAX_PASSOS)
+	{
+		return 0;
+	}
+	for(i = 0; i < passos; i++)
+	{
+		acesos[i] = (uint8_t)(i < PADRAO_LED_PASSOS(aceso_ms));
+	}
+	return PadraoLedToca(acesos, (uint8_t)passos);
+}
+
+/* batimento duplo: aceso 100 ms, apagado 100 ms, aceso 100 ms e apagado
+   ate completar 1 s */
+uint8_t PadraoLedBatimento(void)
+{
+	uint8_t acesos[PADRAO_LED_MAX_PASSOS];
+	uint8_t passo = PADRAO_LED_PASSOS(100);
+	uint8_t i;
+
+	for(i = 0; i < PADRAO_LED_PASSOS(1000) && i < PADRAO_LED_MAX_PASSOS; i++)
+	{
+		acesos[i] = (uint8_t)(i < passo || (i >= 2 * passo && i < 3 * passo));
+	}
+	return PadraoLedToca(acesos, i);
+}
+
+/* para o padrao com o LED aceso ou apagado. Com o canal parado, o TCC0
+   pode terminar de sincronizar depois do retorno */
+void PadraoLedPara(uint8_t aceso)
+{
+	ParaCanal();
+	SINCRONIZA_LENTO(TCC0->SYNCBUSY.reg & TCC_SYNCBUSY_ENABLE);
+	TCC0->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+	Acende(aceso);
+}
+
+#endif
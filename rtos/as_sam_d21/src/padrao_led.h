@@ -0,0 +1,64 @@
+/*
+ * padrao_led.h
+ *
+ * Padroes de LED (batimento, piscadas, ciclos de trabalho) tocados pelo
+ * hardware, sem tarefa e sem acordar a CPU: o estouro do TCC0 marca cada
+ * passo de PADRAO_LED_PASSO_MS e o DMAC escreve, a cada estouro, o byte
+ * seguinte da tabela de trocas no OUTTGL do PORT (0 mantem o pino, a
+ * mascara do pino o inverte). O descritor do canal aponta para si mesmo,
+ * entao a tabela se repete sem fim.
+ *
+ * O LED da placa (PB30) nao tem saida de TC ou TCC no SAMD21J18A, por isso
+ * o pino e alterado pelo DMAC e nao pela saida de forma de onda, e o
+ * padrao vale para qualquer pino. O TCC0 conta o OSCULP32K / 32 (~1 kHz),
+ * que tambem corre no sono da tarefa ociosa.
+ *
+ * Ligado com PADRAO_LED=1 nos simbolos do projeto. Ex.:
+ *
+ *   PadraoLedInicia(LED_0_PIN, LED_0_ACTIVE);
+ *   PadraoLedBatimento();				2 piscadas de 100 ms a cada 1 s
+ *   PadraoLedPisca(1000, 50);			50 ms aceso a cada 1 s
+ *   PadraoLedToca(acesos, passos);		tabela da aplicacao, 1 = aceso
+ */
+
+
+#ifndef PADRAO_LED_H_
+#define PADRAO_LED_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef PADRAO_LED
+#define PADRAO_LED				0
+#endif
+
+/* canal do DMAC (menor que DMA_NUMERO_CANAIS, dma.h) */
+#ifndef PADRAO_LED_CANAL
+#define PADRAO_LED_CANAL		6
+#endif
+
+/* gerador de clock do TCC0, com o OSCULP32K dividido por 32 */
+#ifndef PADRAO_LED_GERADOR
+#define PADRAO_LED_GERADOR		5
+#endif
+
+/* duracao de cada passo do padrao */
+#ifndef PADRAO_LED_PASSO_MS
+#define PADRAO_LED_PASSO_MS		50
+#endif
+
+/* maior numero de passos de um padrao (1 byte de RAM cada) */
+#ifndef PADRAO_LED_MAX_PASSOS
+#define PADRAO_LED_MAX_PASSOS	64
+#endif
+
+/* passos de PADRAO_LED_PASSO_MS em ms */
+#define PADRAO_LED_PASSOS(ms)	(((ms) + PADRAO_LED_PASSO_MS / 2) / PADRAO_LED_PASSO_MS)
+
+void PadraoLedInicia(uint8_t pino, uint8_t nivel_ativo);
+uint8_t PadraoLedToca(const uint8_t *acesos, uint8_t passos);
+uint8_t PadraoLedPisca(uint16_t periodo_ms, uint16_t aceso_ms);
+uint8_t PadraoLedBatimento(void);
+void PadraoLedPara(uint8_t aceso);
+
+#endif /* PADRAO_LED_H_ */
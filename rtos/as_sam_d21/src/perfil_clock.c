@@ -0,0 +1,169 @@
+/*
+ * perfil_clock.c
+ *
+ * Troca do perfil de clock da CPU (gerador 0) em tempo de execucao. A
+ * ordem da troca respeita a flash: ao subir o clock os estados de espera
+ * aumentam antes da troca, ao descer diminuem depois. O cache e o modo de
+ * leitura da flash de cada perfil sao aplicados junto. A DFLL continua
+ * ligada no perfil de economia, entao a volta ao desempenho e imediata,
+ * sem esperar nova trava.
+ */
+
+#include <asf.h>
+#include "clock_adiado.h"
+#include "perfil_clock.h"
+
+typedef struct
+{
+	uint32_t	clock_hz;
+	uint32_t	fonte;				///< fonte do gerador 0 (GCLK_GENCTRL_SRC_*)
+	uint8_t		estados_espera;		///< NVMCTRL.CTRLB.RWS
+	uint8_t		cache;				///< 1 liga o cache da flash
+	uint8_t		modo_leitura;		///< NVMCTRL.CTRLB.READMODE
+} config_perfil_t;
+
+static const config_perfil_t perfis[NUMERO_PERFIS] =
+{
+	{CLOCK_INICIAL_HZ,	GCLK_GENCTRL_SRC_OSC8M,		0,	PERFIL_ECONOMIA_CACHE_NVM,		PERFIL_ECONOMIA_LEITURA_NVM},
+	{CLOCK_FINAL_HZ,	GCLK_GENCTRL_SRC_DFLL48M,	1,	PERFIL_DESEMPENHO_CACHE_NVM,	PERFIL_DESEMPENHO_LEITURA_NVM},
+};
+
+#if cfg_ENERGIA
+/* custo por ciclo da CPU ativa em cada perfil (conf_rtos.h) */
+static const uint32_t custo_perfil[NUMERO_PERFIS] =
+{
+	CUSTO_CICLO(POTENCIA_8MHZ_UW, CLOCK_INICIAL_HZ),
+	CUSTO_CICLO(POTENCIA_48MHZ_UW, CLOCK_FINAL_HZ),
+};
+#endif
+
+/* ate a primeira troca vale o clock de conf_rtos.h */
+static perfil_clock_t perfil_atual = PERFIL_DESEMPENHO;
+static uint32_t clock_atual_hz = cfg_CPU_CLOCK_HZ;
+
+static gancho_perfil_t ganchos_perfil[PERFIL_NUMERO_GANCHOS];
+static uint8_t numero_ganchos_perfil = 0;
+
+/* troca o perfil de clock. Pode ser chamada por tarefas e interrupcoes.
+   Retorna 0 se o perfil nao existe ou se a DFLL ainda nao travou */
+uint8_t PerfilClockMuda(perfil_clock_t perfil)
+{
+	const config_perfil_t *config;
+	reg_atomica_t estado;
+	uint8_t i;
+
+	if(perfil >= NUMERO_PERFIS || (perfil == PERFIL_DESEMPENHO && !ClockFinalPronto()))
+	{
+		return 0;
+	}
+	config = &perfis[perfil];
+
+	REG_ATOMICA_INICIO(estado);
+
+	if(config->estados_espera > NVMCTRL->CTRLB.bit.RWS)
+	{
+		NVMCTRL->CTRLB.bit.RWS = config->estados_espera;
+	}
+
+	GCLK->GENDIV.reg = GCLK_GENDIV_ID(0) | GCLK_GENDIV_DIV(1);
+	GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(0) | config->fonte | GCLK_GENCTRL_IDC | GCLK_GENCTRL_GENEN;
+	while(GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY) {}
+
+	NVMCTRL->CTRLB.bit.RWS = config->estados_espera;
+	PerfilClockConfiguraNvm(config->cache, config->modo_leitura);
+
+	perfil_atual = perfil;
+	clock_atual_hz = config->clock_hz;
+	MarcaTempoAlteraClock(clock_atual_hz);
+#if cfg_ENERGIA
+	EnergiaAlteraCusto(custo_perfil[perfil]);
+#endif
+
+	for(i = 0; i < numero_ganchos_perfil; i++)
+	{
+		ganchos_perfil[i](clock_atual_hz);
+	}
+
+	REG_ATOMICA_FIM(estado);
+
+	return 1;
+}
+
+perfil_clock_t PerfilClockAtual(void)
+{
+	return perfil_atual;
+}
+
+/* clock atual da CPU (gerador 0), para os drivers calcularem suas taxas */
+uint32_t PerfilClockHz(void)
+{
+	return clock_atual_hz;
+}
+
+/* liga ou desliga o cache da flash e escolhe o modo de leitura 
+   (NVMCTRL_CTRLB_READMODE_*_Val), sem trocar o perfil. Vale ate a proxima 
+   troca de perfil, que aplica a configuracao do novo perfil */
+void PerfilClockConfiguraNvm(uint8_t cache, uint8_t modo_leitura)
+{
+	reg_atomica_t estado;
+	uint32_t ctrlb;
+
+	REG_ATOMICA_INICIO(estado);
+	ctrlb = NVMCTRL->CTRLB.reg & ~(NVMCTRL_CTRLB_CACHEDIS | NVMCTRL_CTRLB_READMODE_Msk);
+	if(!cache)
+	{
+		ctrlb |= NVMCTRL_CTRLB_CACHEDIS;
+	}
+	NVMCTRL->CTRLB.reg = ctrlb | NVMCTRL_CTRLB_READMODE(modo_leitura);
+	REG_ATOMICA_FIM(estado);
+}
+
+/* registra um gancho de driver. Retorna 0 se nao ha mais espaco */
+uint8_t PerfilClockRegistraGancho(gancho_perfil_t gancho)
+{
+	reg_atomica_t estado;
+	uint8_t registrado = 0;
+
+	REG_ATOMICA_INICIO(estado);
+	if(numero_ganchos_perfil < PERFIL_NUMERO_GANCHOS)
+	{
+		ganchos_perfil[numero_ganchos_perfil++] = gancho;
+		registrado = 1;
+	}
+	REG_ATOMICA_FIM(estado);
+
+	return registrado;
+}
+
+#if cfg_OCIOSA_SEM_MARCAS
+/* escolhe o perfil pela carga desde a chamada anterior, medida pelas marcas
+   que a tarefa ociosa dormiu (ObtemMarcasDormidas). Deve ser chamada
+   periodicamente (ex.: a cada 100 marcas) por uma tarefa que execute mesmo
+   com a CPU ocupada, de prioridade alta, ou por um temporizador */
+void PerfilClockGoverna(void)
+{
+	static tick_t marcas_anterior = 0, dormidas_anterior = 0;
+	tick_t marcas = ObtemMarcasDeTempo();
+	tick_t dormidas = ObtemMarcasDormidas();
+	tick_t periodo = marcas - marcas_anterior;
+	uint32_t carga;
+
+	if(periodo == 0)
+	{
+		return;
+	}
+	carga = 100 - (((dormidas - dormidas_anterior) * 100) / periodo);
+	marcas_anterior = marcas;
+	dormidas_anterior = dormidas;
+
+	if(perfil_atual == PERFIL_ECONOMIA && carga >= PERFIL_CARGA_SOBE)
+	{
+		(void)PerfilClockMuda(PERFIL_DESEMPENHO);
+	}
+	else if(perfil_atual == PERFIL_DESEMPENHO &&
+			(carga * (CLOCK_FINAL_HZ / CLOCK_INICIAL_HZ)) < (PERFIL_CARGA_SOBE / 2))
+	{
+		(void)PerfilClockMuda(PERFIL_ECONOMIA);
+	}
+}
+#endif
@@ -0,0 +1,70 @@
+/*
+ * perfil_clock.h
+ *
+ * Perfis de clock da CPU trocados em tempo de execucao: economia (OSC8M,
+ * 8MHz, flash sem estado de espera) e desempenho (DFLL, 48MHz, 1 estado de
+ * espera). A troca ajusta os estados de espera, o cache e o modo de leitura
+ * da flash (NVMCTRL) e a marca de tempo e avisa os drivers registrados, que
+ * recalculam suas taxas. Opcionalmente o perfil segue a carga medida pelo
+ * tempo de sono da tarefa ociosa.
+ */
+
+
+#ifndef PERFIL_CLOCK_H_
+#define PERFIL_CLOCK_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+typedef enum
+{
+	PERFIL_ECONOMIA = 0,	///< OSC8M, 8MHz
+	PERFIL_DESEMPENHO,		///< DFLL, 48MHz (exige a DFLL travada, clock_adiado.c)
+	NUMERO_PERFIS
+} perfil_clock_t;
+
+/* gancho de driver, chamado apos cada troca com o novo clock da CPU, com as
+   interrupcoes desabilitadas: deve so reprogramar registradores */
+typedef void (*gancho_perfil_t)(uint32_t clock_hz);
+
+/* cache e modo de leitura da flash (NVMCTRL.CTRLB) de cada perfil. Cache: 
+   1 liga, 0 desliga. Modo de leitura, NVMCTRL_CTRLB_READMODE_*_Val:
+    - NO_MISS_PENALTY: melhor desempenho, sem espera extra na falta no cache;
+    - LOW_POWER: menor consumo do cache, uma espera a cada falta;
+    - DETERMINISTIC: acerto e falta no cache levam o mesmo tempo (os estados 
+      de espera da flash), para tempos de execucao previsiveis */
+#ifndef PERFIL_ECONOMIA_CACHE_NVM
+#define PERFIL_ECONOMIA_CACHE_NVM		1
+#endif
+#ifndef PERFIL_ECONOMIA_LEITURA_NVM
+#define PERFIL_ECONOMIA_LEITURA_NVM		NVMCTRL_CTRLB_READMODE_LOW_POWER_Val
+#endif
+#ifndef PERFIL_DESEMPENHO_CACHE_NVM
+#define PERFIL_DESEMPENHO_CACHE_NVM		1
+#endif
+#ifndef PERFIL_DESEMPENHO_LEITURA_NVM
+#define PERFIL_DESEMPENHO_LEITURA_NVM	NVMCTRL_CTRLB_READMODE_NO_MISS_PENALTY_Val
+#endif
+
+/* numero maximo de ganchos registrados */
+#ifndef PERFIL_NUMERO_GANCHOS
+#define PERFIL_NUMERO_GANCHOS	4
+#endif
+
+/* PerfilClockGoverna: carga (% do tempo acordada) acima da qual passa ao
+   desempenho. A volta a economia exige que a carga prevista a 8MHz fique
+   abaixo da metade deste limite, para nao oscilar entre os perfis */
+#ifndef PERFIL_CARGA_SOBE
+#define PERFIL_CARGA_SOBE		70
+#endif
+
+uint8_t PerfilClockMuda(perfil_clock_t perfil);
+perfil_clock_t PerfilClockAtual(void);
+uint32_t PerfilClockHz(void);
+uint8_t PerfilClockRegistraGancho(gancho_perfil_t gancho);
+void PerfilClockConfiguraNvm(uint8_t cache, uint8_t modo_leitura);
+#if cfg_OCIOSA_SEM_MARCAS
+void PerfilClockGoverna(void);
+#endif
+
+#endif /* PERFIL_CLOCK_H_ */
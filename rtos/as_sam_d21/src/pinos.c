@@ -0,0 +1,81 @@
+/*
+ * pinos.c
+ *
+ * Configuracao dos pinos por tabela, com o WRCONFIG (ver pinos.h).
+ */
+
+#include <asf.h>
+#include "pinos.h"
+
+#if PINOS_TABELA
+
+/* pinos de todos os drivers do projeto na SAM D21 Xplained Pro, agrupados
+   por grupo e funcao para uma escrita por linha */
+const config_pinos_t pinos_placa[] =
+{
+	/* LED0 (PB30) apagado */
+	PINOS_GPIO(PINO_GRUPO(LED_0_PIN), PINO_BIT(LED_0_PIN), PINO_BIT(LED_0_PIN),
+			   LED_0_ACTIVE ? 0 : PINO_BIT(LED_0_PIN), 0),
+	/* SW0 (PA15) com pull-up */
+	PINOS_GPIO(PINO_GRUPO(SW0_PIN), PINO_BIT(SW0_PIN), 0, PINO_BIT(SW0_PIN), PINOS_ENTRADA | PINOS_PULL),
+	/* selecao da SPI (PA05) em 1 */
+	PINOS_GPIO(PINO_GRUPO(EXT1_PIN_SPI_SS_0), PINO_BIT(EXT1_PIN_SPI_SS_0), PINO_BIT(EXT1_PIN_SPI_SS_0),
+			   PINO_BIT(EXT1_PIN_SPI_SS_0), 0),
+	/* funcao D: SPI na SERCOM0 (PA04, PA06, PA07) e I2C na SERCOM2 (PA08, PA09) */
+	PINOS_PERIFERICO(0, PINO_BIT(PINMUX_PINO(EXT1_SPI_SERCOM_PINMUX_PAD0)) |
+						PINO_BIT(PINMUX_PINO(EXT1_SPI_SERCOM_PINMUX_PAD2)) |
+						PINO_BIT(PINMUX_PINO(EXT1_SPI_SERCOM_PINMUX_PAD3)) |
+						PINO_BIT(PINMUX_PINO(EXT1_I2C_SERCOM_PINMUX_PAD0)) |
+						PINO_BIT(PINMUX_PINO(EXT1_I2C_SERCOM_PINMUX_PAD1)),
+					 PINMUX_FUNCAO(EXT1_SPI_SERCOM_PINMUX_PAD0), PINOS_ENTRADA),
+	/* funcao C: UART do EDBG na SERCOM3 (PA22, PA23) */
+	PINOS_PERIFERICO(0, PINO_BIT(PINMUX_PINO(EDBG_CDC_SERCOM_PINMUX_PAD0)) |
+						PINO_BIT(PINMUX_PINO(EDBG_CDC_SERCOM_PINMUX_PAD1)),
+					 PINMUX_FUNCAO(EDBG_CDC_SERCOM_PINMUX_PAD0), PINOS_ENTRADA),
+	/* funcao G: USB (PA24, PA25) */
+	PINOS_PERIFERICO(0, PINO_BIT(PINMUX_PINO(PINMUX_PA24G_USB_DM)) | PINO_BIT(PINMUX_PINO(PINMUX_PA25G_USB_DP)),
+					 PINMUX_FUNCAO(PINMUX_PA24G_USB_DM), 0),
+	/* funcao B: entrada analogica AIN8 da amostragem (PB00), sem buffer digital */
+	PINOS_PERIFERICO(PINO_GRUPO(EXT1_ADC_0_PIN), PINO_BIT(EXT1_ADC_0_PIN), EXT1_ADC_0_MUX, 0),
+};
+
+const uint8_t pinos_placa_quantidade = sizeof(pinos_placa) / sizeof(pinos_placa[0]);
+
+/* as linhas agrupam pinos do mesmo grupo e da mesma funcao */
+#if PINMUX_PINO(EXT1_SPI_SERCOM_PINMUX_PAD0) >= 32 || PINMUX_PINO(EXT1_I2C_SERCOM_PINMUX_PAD1) >= 32 || \
+	PINMUX_FUNCAO(EXT1_SPI_SERCOM_PINMUX_PAD0) != PINMUX_FUNCAO(EXT1_I2C_SERCOM_PINMUX_PAD0) || \
+	PINMUX_FUNCAO(EDBG_CDC_SERCOM_PINMUX_PAD0) != PINMUX_FUNCAO(EDBG_CDC_SERCOM_PINMUX_PAD1)
+#error "pinos_placa agrupa pinos de grupos ou funcoes diferentes: separar as linhas"
+#endif
+
+/* configura os pinos da tabela. O nivel vem antes da direcao, entao uma
+   saida ja comeca no nivel inicial */
+void PinosConfigura(const config_pinos_t *tabela, uint8_t quantidade)
+{
+	const config_pinos_t *linha;
+	PortGroup *grupo;
+
+	for(linha = tabela; linha < tabela + quantidade; linha++)
+	{
+		grupo = &PORT->Group[linha->grupo];
+		grupo->OUTSET.reg = linha->mascara & linha->nivel;
+		grupo->OUTCLR.reg = linha->mascara & ~linha->nivel;
+		if(!(linha->config & PORT_WRCONFIG_PMUXEN))
+		{
+			grupo->DIRSET.reg = linha->mascara & linha->saidas;
+			grupo->DIRCLR.reg = linha->mascara & ~linha->saidas;
+		}
+
+		/* a mascara do WRCONFIG tem 16 bits: HWSEL escolhe os pinos 16 a 31 */
+		if(linha->mascara & 0xFFFF)
+		{
+			grupo->WRCONFIG.reg = linha->config | PORT_WRCONFIG_PINMASK(linha->mascara & 0xFFFF);
+		}
+		if(linha->mascara >> 16)
+		{
+			grupo->WRCONFIG.reg = linha->config | PORT_WRCONFIG_HWSEL | PORT_WRCONFIG_PINMASK(linha->mascara >> 16);
+		}
+	}
+}
+
+#endif
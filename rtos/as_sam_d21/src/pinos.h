@@ -0,0 +1,79 @@
+/*
+ * pinos.h
+ *
+ * Configuracao dos pinos da placa por tabela, na partida: em vez de um
+ * port_pin_set_config/system_pinmux_pin_set_config por pino (varias
+ * leituras e escritas do PORT cada), cada linha da tabela configura os
+ * pinos de um grupo com a mesma funcao com uma escrita no WRCONFIG, ate 16
+ * pinos por escrita (uma por metade do grupo), e a direcao e o nivel
+ * inicial com uma escrita de 32 bits cada.
+ *
+ * A tabela da placa (pinos_placa, pinos.c) tem os pinos de todos os
+ * drivers do projeto. Ligada com PINOS_TABELA=1 nos simbolos do projeto:
+ * main chama PinosConfigura(pinos_placa, ...) logo na partida e os drivers
+ * deixam de configurar os seus pinos. Ex. de tabela:
+ *
+ *   static const config_pinos_t pinos[] =
+ *   {
+ *       PINOS_GPIO(PINO_GRUPO(PIN_PB30), PINO_BIT(PIN_PB30), PINO_BIT(PIN_PB30), 0, 0),
+ *       PINOS_PERIFERICO(0, PINO_BIT(PIN_PA22) | PINO_BIT(PIN_PA23), MUX_PA22C_SERCOM3_PAD0, PINOS_ENTRADA),
+ *   };
+ *   PinosConfigura(pinos, sizeof(pinos) / sizeof(pinos[0]));
+ */
+
+
+#ifndef PINOS_H_
+#define PINOS_H_
+
+#include <asf.h>
+#include "stdint.h"
+
+#ifndef PINOS_TABELA
+#define PINOS_TABELA			0
+#endif
+
+/* grupo (0 = PA, 1 = PB) e bit no grupo de um pino PIN_Pxnn */
+#define PINO_GRUPO(pino)		((pino) / 32)
+#define PINO_BIT(pino)			(1UL << ((pino) % 32))
+
+/* pino de um PINMUX_Pxnn... (pino << 16 | funcao) */
+#define PINMUX_PINO(pinmux)		((pinmux) >> 16)
+#define PINMUX_FUNCAO(pinmux)	((pinmux) & 0xFFFF)
+
+/* opcoes, os bits do PINCFG na posicao do WRCONFIG */
+#define PINOS_ENTRADA			PORT_WRCONFIG_INEN		///< buffer de entrada (leitura do IN)
+#define PINOS_PULL				PORT_WRCONFIG_PULLEN	///< pull-up com nivel 1, pull-down com 0
+#define PINOS_FORTE				PORT_WRCONFIG_DRVSTR	///< saida com corrente maior
+
+/**
+* \struct config_pinos_t
+* Pinos de um grupo com a mesma configuracao. config ja e a palavra do
+* WRCONFIG, sem a mascara de pinos, montada por PINOS_GPIO ou
+* PINOS_PERIFERICO
+*/
+
+typedef struct
+{
+	uint32_t	mascara;			///< Pinos do grupo
+	uint32_t	saidas;				///< Pinos de saida (GPIO); os demais da mascara sao entradas
+	uint32_t	nivel;				///< Nivel inicial (OUT): da saida ou do pull
+	uint32_t	config;				///< WRCONFIG sem a mascara
+	uint8_t		grupo;
+} config_pinos_t;
+
+/* pinos do PORT (GPIO), com a direcao e o nivel inicial */
+#define PINOS_GPIO(grupo, mascara, saidas, nivel, opcoes)		\
+	{ (mascara), (saidas), (nivel), PORT_WRCONFIG_WRPINCFG | (opcoes), (grupo) }
+
+/* pinos de um periferico, na funcao do PMUX (MUX_Pxnn..., 0 = A a 7 = H).
+   A direcao e do periferico */
+#define PINOS_PERIFERICO(grupo, mascara, funcao, opcoes)		\
+	{ (mascara), 0, 0, PORT_WRCONFIG_WRPINCFG | PORT_WRCONFIG_WRPMUX | PORT_WRCONFIG_PMUXEN |	\
+	  PORT_WRCONFIG_PMUX(funcao) | (opcoes), (grupo) }
+
+extern const config_pinos_t pinos_placa[];
+extern const uint8_t pinos_placa_quantidade;
+
+void PinosConfigura(const config_pinos_t *tabela, uint8_t quantidade);
+
+#endif /* PINOS_H_ */
@@ -0,0 +1,93 @@
+/*
+ * ponte_protothreads.c
+ *
+ * Tarefa que roda o escalonador de protothreads e bloqueia quando nenhuma
+ * esta pronta. So usa servicos do nucleo, sem registradores do
+ * microcontrolador.
+ */
+
+#include <string.h>
+#include "ponte_protothreads.h"
+
+/* inicia a ponte com a passada do escalonador. Deve ser chamada antes de a
+   tarefa da ponte comecar */
+void PonteProtothreadsInicia(ponte_protothreads_t *ponte, passada_protothreads_t passada)
+{
+	memset(ponte, 0, sizeof(*ponte));
+	ponte->passada = passada;
+}
+
+/* acorda a tarefa da ponte, se estiver bloqueada; senao, a proxima espera
+   retorna na hora. Nunca bloqueia, pode ser usada em interrupcoes. Antes de
+   a tarefa comecar nao faz nada: a primeira passada ve todas as prontas */
+void PonteProtothreadsNotifica(ponte_protothreads_t *ponte)
+{
+	uint8_t tarefa = ponte->tarefa;
+
+	ponte->notificacoes++;
+	if(tarefa != 0)
+	{
+		TarefaNotifica(tarefa, 1, NOTIFICA_BITS);
+	}
+}
+
+/* uma passada com o tempo desde a anterior. Retorna as marcas que a tarefa
+   pode esperar: 0 se ha protothreads prontas, ESPERA_INFINITA sem
+   expiracao pendente */
+tick_t PonteProtothreadsPassa(ponte_protothreads_t *ponte)
+{
+	tick_t agora = ObtemMarcasDeTempo();
+	uint32_t decorrido_ms = (uint32_t)(((uint64_t)(tick_t)(agora - ponte->ultima_marca) * 1000u) / cfg_MARCA_TEMPO_HZ);
+	uint32_t espera_ms;
+	uint64_t marcas;
+
+	/* so as marcas convertidas em ms inteiros saem da conta: o resto fica
+	   para a proxima passada, sem adiantar o tempo das protothreads */
+	ponte->ultima_marca += (tick_t)(((uint64_t)decorrido_ms * cfg_MARCA_TEMPO_HZ) / 1000u);
+	ponte->passadas++;
+	espera_ms = ponte->passada(decorrido_ms);
+
+	if(espera_ms == PONTE_SEM_EXPIRACAO)
+	{
+		return ESPERA_INFINITA;
+	}
+	marcas = ((uint64_t)espera_ms * cfg_MARCA_TEMPO_HZ + 999u) / 1000u;	/* arredonda para cima: nao acorda antes */
+	if(marcas >= ESPERA_INFINITA)
+	{
+		marcas = ESPERA_INFINITA - 1;
+	}
+	return (tick_t)marcas;
+}
+
+/* corpo da tarefa da ponte, que nunca retorna */
+void PonteProtothreadsExecuta(ponte_protothreads_t *ponte)
+{
+	tick_t espera;
+
+	ponte->tarefa = tarefa_atual;
+	ponte->ultima_marca = ObtemMarcasDeTempo();
+	for(;;)
+	{
+		espera = PonteProtothreadsPassa(ponte);
+		if(espera != 0)
+		{
+			/* uma notificacao durante a passada deixa a espera pendente, e
+			   ela retorna na hora */
+			ponte->bloqueios++;
+			(void)TarefaAguardaNotificacao(espera);
+		}
+	}
+}
+
+/* tempo do sistema em ms, para PT_TIME_NOW: as marcas de tempo convertidas.
+   Da a volta em 2^32 ms, como o tempo das protothreads, so com
+   cfg_MARCA_TEMPO_HZ de 1000; com outra frequencia, o salto na volta do
+   contador de marcas conta como um avanco de tempo */
+uint32_t PonteProtothreadsTempoMs(void)
+{
+#if cfg_MARCA_TEMPO_HZ == 1000
+	return (uint32_t)ObtemMarcasDeTempo();
+#else
+	return (uint32_t)(((uint64_t)ObtemMarcasDeTempo() * 1000u) / cfg_MARCA_TEMPO_HZ);
+#endif
+}
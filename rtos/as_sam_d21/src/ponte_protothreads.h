@@ -0,0 +1,69 @@
+/*
+ * ponte_protothreads.h
+ *
+ * Escalonador de protothreads (o da atividade t4) dentro de uma tarefa do
+ * sistema multitarefas: todas as sessoes de protocolo dividem a pilha dessa
+ * tarefa e convivem com as tarefas de tempo real. A tarefa faz passadas
+ * enquanto ha protothreads prontas e, sem nenhuma, bloqueia em
+ * TarefaAguardaNotificacao ate a proxima expiracao de timer ou ate ser
+ * notificada. Quem deixa uma protothread pronta fora da tarefa (a
+ * interrupcao da UART que escreve no canal, outra tarefa) notifica a tarefa
+ * com PonteProtothreadsNotifica, que pode ser chamada em interrupcoes.
+ *
+ * A passada e uma funcao da aplicacao, que trata os ms passados desde a
+ * anterior e retorna os ms ate a proxima expiracao. Com t4, ex.:
+ *
+ *   #define PT_NOTIFY()	PonteProtothreadsNotifica(&ponte)
+ *   #define PT_TIME_NOW()	PonteProtothreadsTempoMs()
+ *   #define PT_ATOMIC(i)	do { reg_atomica_t e; REG_ATOMICA_INICIO(e); i; REG_ATOMICA_FIM(e); } while(0)
+ *
+ *   static ponte_protothreads_t ponte;
+ *   void tarefa_protocolo(void) { PonteProtothreadsExecuta(&ponte); }
+ *
+ *   PonteProtothreadsInicia(&ponte, protothreads_poll);
+ *   CriaTarefa(tarefa_protocolo, "Protocolo", pilha, tamanho, prioridade);
+ *
+ * Com PT_TIME_NOW, os timers das protothreads leem o tempo do nucleo em
+ * timer_set e timer_expired, e o decorrido_ms da passada so serve ao tempo
+ * virtual (sem PT_TIME_NOW). Com a base de tempo de us (TEMPO_US), ex.:
+ * #define PT_TIME_NOW() (TempoUs() / 1000u), os timeouts tem resolucao de ms
+ * mesmo entre marcas lentas.
+ */
+
+
+#ifndef PONTE_PROTOTHREADS_H_
+#define PONTE_PROTOTHREADS_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* retorno da passada sem expiracao pendente (PT_NO_DEADLINE de t4) */
+#define PONTE_SEM_EXPIRACAO		0xFFFFFFFFUL
+
+/* passada do escalonador: avanca o tempo das protothreads em decorrido_ms,
+   retoma as prontas e retorna os ms ate a proxima expiracao, 0 se ainda ha
+   protothreads prontas, ou PONTE_SEM_EXPIRACAO */
+typedef uint32_t (*passada_protothreads_t)(uint32_t decorrido_ms);
+
+/**
+* \struct ponte_protothreads_t
+* Estrutura de controle da ponte
+*/
+
+typedef struct
+{
+	passada_protothreads_t	passada;
+	volatile uint8_t		tarefa;			///< Tarefa da ponte, 0 antes de ela comecar
+	tick_t					ultima_marca;	///< Marca de tempo ja passada as protothreads
+	uint32_t				passadas;		///< Chamadas da passada
+	uint32_t				bloqueios;		///< Vezes que a tarefa bloqueou sem protothreads prontas
+	volatile uint32_t		notificacoes;	///< Chamadas de PonteProtothreadsNotifica
+} ponte_protothreads_t;
+
+void PonteProtothreadsInicia(ponte_protothreads_t *ponte, passada_protothreads_t passada);
+void PonteProtothreadsNotifica(ponte_protothreads_t *ponte);
+tick_t PonteProtothreadsPassa(ponte_protothreads_t *ponte);
+void PonteProtothreadsExecuta(ponte_protothreads_t *ponte);
+uint32_t PonteProtothreadsTempoMs(void);
+
+#endif /* PONTE_PROTOTHREADS_H_ */
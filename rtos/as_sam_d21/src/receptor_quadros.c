@@ -0,0 +1,341 @@
+/*
+ * receptor_quadros.c
+ *
+ * Tarefa de recepcao de quadros sobre o anel de bytes do nucleo. O
+ * analisador percorre cada trecho contiguo do anel em um laco, sem uma
+ * chamada por byte: o STX e procurado com memchr e os dados sao copiados
+ * com a soma do CHK no mesmo laco. So usa servicos do nucleo, sem
+ * registradores do microcontrolador, exceto no modo RECEPTOR_CRC32, em que
+ * a copia dos dados e o CRC ficam com o DMAC (crc_dma.c).
+ */
+
+#include <string.h>
+#include "receptor_quadros.h"
+#include "crc_dma.h"
+
+#if defined(OTIMIZA_DESEMPENHO) && OTIMIZA_DESEMPENHO
+#pragma GCC optimize ("O2")
+#endif
+
+#define STX		0x02
+#define ETX		0x03
+
+typedef enum { AGUARDA_STX = 0, AGUARDA_QTD, AGUARDA_DADOS, AGUARDA_CHK, AGUARDA_ETX } estado_receptor_t;
+
+/* inicia o receptor. Com area_anel, os bytes chegam pelo anel de capacidade
+   bytes (potencia de 2), escrito com ReceptorQuadrosEscreve, e a tarefa
+   acorda conforme despertar: a cada byte, a cada limiar bytes ou, na linha
+   ociosa, tambem quando passam ociosa marcas sem bytes novos. Sem area_anel
+   (0), so ReceptorQuadrosProcessa e usada. Os quadros validos sao copiados
+   para blocos de quadros (0: nenhum assinante). Retorna 0 se o anel nao
+   pode ser iniciado */
+uint8_t ReceptorQuadrosInicia(receptor_quadros_t *receptor, uint8_t *area_anel, uint16_t capacidade,
+							  memoria_t *quadros, despertar_receptor_t despertar, uint16_t limiar, tick_t ociosa)
+{
+	memset(receptor, 0, sizeof(*receptor));
+	receptor->quadros = quadros;
+	receptor->despertar = (uint8_t)despertar;
+	receptor->limiar = (despertar == RECEPTOR_POR_BYTE || limiar == 0) ? 1 : limiar;
+	receptor->ociosa = (ociosa == 0) ? 1 : ociosa;
+	receptor->estado = AGUARDA_STX;
+
+	if(area_anel != 0)
+	{
+		if(!AnelInicia(&receptor->anel, area_anel, capacidade, receptor->limiar))
+		{
+			return 0;
+		}
+		receptor->limiar = receptor->anel.limiar;		/* limitado a capacidade */
+	}
+	return 1;
+}
+
+/* escolhe a verificacao do CHK dos proximos quadros. Deve ser chamada antes
+   de a tarefa do receptor comecar; RECEPTOR_CRC32 exige CRC_DMA e o CRC do
+   DMAC iniciado (CrcDmaInicia), usado so por este receptor. Retorna 0 se o
+   modo nao e suportado */
+uint8_t ReceptorQuadrosIntegridade(receptor_quadros_t *receptor, integridade_receptor_t integridade)
+{
+	if(integridade == RECEPTOR_CRC32 && !CRC_DMA)
+	{
+		return 0;
+	}
+	receptor->integridade = (uint8_t)integridade;
+	return 1;
+}
+
+/* inscreve a fila de ponteiros de um assinante, que recebe os quadros cujo
+   primeiro byte de dados e tipo (ou todos, com RECEPTOR_TODOS). Deve ser
+   chamada antes de a tarefa do receptor comecar. Retorna 0 se nao ha
+   mais espaco */
+uint8_t ReceptorQuadrosAssina(receptor_quadros_t *receptor, fila_t *fila, uint16_t tipo)
+{
+	if(receptor->numero_assinantes >= RECEPTOR_ASSINANTES)
+	{
+		return 0;
+	}
+	receptor->assinantes[receptor->numero_assinantes].fila = fila;
+	receptor->assinantes[receptor->numero_assinantes].tipo = tipo;
+	receptor->numero_assinantes++;
+	return 1;
+}
+
+/* despacha os quadros validos pela tabela de 256 tratadores, indexada pelo
+   byte posicao_tipo dos dados (0: o primeiro). Os quadros mais curtos e os
+   tipos sem tratador (entrada 0) sao contados em sem_tratador. Com
+   tratadores 0, o despacho e desligado. Deve ser chamada antes de a tarefa
+   do receptor comecar; os assinantes continuam recebendo as copias */
+void ReceptorQuadrosDespacha(receptor_quadros_t *receptor, const tratador_quadro_t *tratadores, uint8_t posicao_tipo)
+{
+	receptor->tratadores = tratadores;
+	receptor->posicao_tipo = posicao_tipo;
+}
+
+/* chama o tratador do tipo do quadro, com os dados do receptor */
+static void DespachaQuadro(receptor_quadros_t *receptor)
+{
+	tratador_quadro_t tratador = 0;
+
+	if(receptor->posicao_tipo < receptor->qtd)
+	{
+		tratador = receptor->tratadores[receptor->dados[receptor->posicao_tipo]];
+	}
+	if(tratador != 0)
+	{
+		tratador(receptor->dados, receptor->qtd);
+	}
+	else
+	{
+		receptor->estatisticas.sem_tratador++;
+	}
+}
+
+/* escreve bytes recebidos no anel; e o produtor unico, normalmente a
+   interrupcao de recepcao da UART. Retorna quantos couberam; os demais sao
+   contados em bytes_perdidos */
+uint16_t ReceptorQuadrosEscreve(receptor_quadros_t *receptor, const uint8_t *dados, uint16_t tamanho)
+{
+	uint16_t escritos = AnelEscreve(&receptor->anel, dados, tamanho);
+
+	receptor->estatisticas.bytes_perdidos += (uint32_t)(tamanho - escritos);
+	return escritos;
+}
+
+/* entrega uma copia do quadro a cada assinante interessado, sem bloquear:
+   sem bloco livre ou com a fila cheia, a copia e perdida */
+static void EntregaQuadro(receptor_quadros_t *receptor)
+{
+	quadro_recebido_t *quadro;
+	uint8_t i;
+
+	for(i = 0; i < receptor->numero_assinantes; i++)
+	{
+		assinante_receptor_t *assinante = &receptor->assinantes[i];
+
+		if(assinante->tipo != RECEPTOR_TODOS && assinante->tipo != receptor->dados[0])
+		{
+			continue;
+		}
+
+		quadro = (quadro_recebido_t*)MemoriaAlocaISR(receptor->quadros);
+		if(quadro == 0)
+		{
+			receptor->estatisticas.entregas_perdidas++;
+			continue;
+		}
+		quadro->qtd = receptor->qtd;
+		memcpy(quadro->dados, receptor->dados, receptor->qtd);
+		if(!FilaEnviaPonteiroISR(assinante->fila, quadro))
+		{
+			MemoriaLibera(receptor->quadros, quadro);
+			receptor->estatisticas.entregas_perdidas++;
+		}
+	}
+}
+
+/* analisa um bloco de bytes recebidos; o quadro pode continuar no bloco
+   seguinte. Chamada pela tarefa do receptor, ou pela tarefa que recebe os
+   blocos de outra fonte. O bloco pode ser reutilizado no retorno */
+void ReceptorQuadrosProcessa(receptor_quadros_t *receptor, const uint8_t *bloco, uint16_t tamanho)
+{
+	const uint8_t *p = bloco;
+	const uint8_t *fim = bloco + tamanho;
+	uint16_t n, i;
+	uint8_t soma, valido;
+
+	receptor->estatisticas.bytes += tamanho;
+
+	while(p < fim)
+	{
+		switch(receptor->estado)
+		{
+			case AGUARDA_STX:
+				p = (const uint8_t*)memchr(p, STX, (size_t)(fim - p));
+				if(p == 0)
+				{
+					p = fim;
+					break;
+				}
+				p++;
+				receptor->estado = AGUARDA_QTD;
+				break;
+			case AGUARDA_QTD:
+				receptor->qtd = *p++;
+				receptor->recebidos = 0;
+				receptor->soma = 0;
+				receptor->bytes_chk = 0;
+				receptor->chk = 0;
+				if(receptor->qtd > 0)
+				{
+					receptor->estado = AGUARDA_DADOS;
+				}
+				else
+				{
+					receptor->estatisticas.quadros_invalidos++;
+					receptor->estado = AGUARDA_STX;
+				}
+				break;
+			case AGUARDA_DADOS:
+				/* todos os dados disponiveis de uma vez, copia e soma no mesmo laco */
+				n = (uint16_t)(receptor->qtd - receptor->recebidos);
+				if(n > (uint16_t)(fim - p))
+				{
+					n = (uint16_t)(fim - p);
+				}
+#if CRC_DMA
+				if(receptor->integridade == RECEPTOR_CRC32)
+				{
+					/* o DMAC copia e calcula o CRC enquanto a analise segue */
+					if(receptor->recebidos == 0)
+					{
+						CrcDmaComeca();
+					}
+					CrcDmaCopia(&receptor->dados[receptor->recebidos], p, n);
+				}
+				else
+#endif
+				{
+					soma = receptor->soma;
+					for(i = 0; i < n; i++)
+					{
+						uint8_t byte = p[i];
+						receptor->dados[receptor->recebidos + i] = byte;
+						soma = (uint8_t)(soma + byte);
+					}
+					receptor->soma = soma;
+				}
+				receptor->recebidos = (uint8_t)(receptor->recebidos + n);
+				p += n;
+				if(receptor->recebidos >= receptor->qtd)
+				{
+					receptor->estado = AGUARDA_CHK;
+				}
+				break;
+			case AGUARDA_CHK:
+				/* 1 byte na soma, 4 no CRC-32 (mais significativo primeiro) */
+				receptor->chk = (receptor->chk << 8) | *p++;
+				receptor->bytes_chk++;
+				if(receptor->integridade != RECEPTOR_CRC32 || receptor->bytes_chk >= 4)
+				{
+					receptor->estado = AGUARDA_ETX;
+				}
+				break;
+			default:	/* AGUARDA_ETX */
+				valido = (*p++ == ETX);
+#if CRC_DMA
+				if(receptor->integridade == RECEPTOR_CRC32)
+				{
+					valido = valido && receptor->chk == CrcDmaResultado();
+				}
+				else
+#endif
+				{
+					valido = valido && receptor->chk == receptor->soma;
+				}
+				if(valido)
+				{
+					receptor->estatisticas.quadros_validos++;
+					if(receptor->tratadores != 0)
+					{
+						DespachaQuadro(receptor);
+					}
+					if(receptor->quadros != 0)
+					{
+						EntregaQuadro(receptor);
+					}
+				}
+				else
+				{
+					receptor->estatisticas.quadros_invalidos++;
+				}
+				receptor->estado = AGUARDA_STX;
+				break;
+		}
+	}
+
+#if CRC_DMA
+	/* uma copia do DMAC ainda pode estar lendo o bloco */
+	if(receptor->integridade == RECEPTOR_CRC32)
+	{
+		CrcDmaAguarda();
+	}
+#endif
+}
+
+/* espera bytes no anel conforme o modo de despertar e retorna quantos ha */
+static uint16_t AguardaBytes(receptor_quadros_t *receptor)
+{
+	anel_t *anel = &receptor->anel;
+	uint16_t quantidade, anterior;
+
+	if(receptor->despertar != RECEPTOR_LINHA_OCIOSA)
+	{
+		return AnelAguarda(anel, ESPERA_INFINITA);
+	}
+
+	/* anel vazio: acorda no primeiro byte. Depois, no limiar ou quando uma
+	   espera de ociosa marcas termina sem nenhum byte novo */
+	anel->limiar = 1;
+	quantidade = AnelAguarda(anel, ESPERA_INFINITA);
+	anel->limiar = receptor->limiar;
+	do
+	{
+		anterior = quantidade;
+		quantidade = AnelAguarda(anel, receptor->ociosa);
+	} while(quantidade < receptor->limiar && quantidade != anterior);
+
+	return quantidade;
+}
+
+/* corpo da tarefa do receptor, que nunca retorna. Os bytes sao analisados
+   direto no anel, em ate dois trechos contiguos, e so entao liberados para
+   o produtor */
+void ReceptorQuadrosExecuta(receptor_quadros_t *receptor)
+{
+	anel_t *anel = &receptor->anel;
+	uint16_t quantidade, inicio, contiguos;
+
+	for(;;)
+	{
+		if(AguardaBytes(receptor) == 0)
+		{
+			continue;
+		}
+		receptor->estatisticas.despertares++;
+
+		while((quantidade = AnelQuantidade(anel)) > 0)
+		{
+			inicio = (uint16_t)(anel->leitura & anel->mascara);
+			contiguos = (uint16_t)(anel->mascara + 1 - inicio);
+			if(contiguos > quantidade)
+			{
+				contiguos = quantidade;
+			}
+
+			BARREIRA_MEMORIA();		/* os dados sao lidos depois do indice de escrita */
+			ReceptorQuadrosProcessa(receptor, &anel->area[inicio], contiguos);
+			BARREIRA_MEMORIA();		/* o espaco so e liberado depois da analise */
+			anel->leitura = (uint16_t)(anel->leitura + contiguos);
+		}
+	}
+}
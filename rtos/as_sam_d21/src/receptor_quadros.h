@@ -0,0 +1,144 @@
+/*
+ * receptor_quadros.h
+ *
+ * Recepcao de quadros STX, QTD, DADOS, CHK, ETX (o mesmo protocolo das
+ * atividades t2 a t4) em uma tarefa do sistema multitarefas. A interrupcao
+ * da UART (ou o DMA) so escreve os bytes no anel do receptor; a tarefa
+ * acorda conforme o modo de despertar, analisa todos os bytes disponiveis
+ * direto no anel, sem copia, e entrega cada quadro valido as filas dos
+ * assinantes, cada um com a sua copia em um bloco de memoria.
+ *
+ * A tarefa e criada pela aplicacao como as demais, com o corpo
+ * ReceptorQuadrosExecuta. Ex.:
+ *
+ *   static receptor_quadros_t receptor;
+ *   void tarefa_receptor(void) { ReceptorQuadrosExecuta(&receptor); }
+ *
+ * Fontes que ja entregam blocos (ex.: UartDmaRecebe) chamam
+ * ReceptorQuadrosProcessa na propria tarefa, sem o anel.
+ *
+ * Quadros tratados na propria tarefa do receptor vao por uma tabela de 256
+ * tratadores indexada pelo byte de tipo (ReceptorQuadrosDespacha), com
+ * custo constante qualquer que seja o numero de tipos. A tabela pode ser
+ * constante, na flash. Ex.:
+ *
+ *   static const tratador_quadro_t tratadores[256] =
+ *   {
+ *       [TIPO_ESTADO] = TrataEstado,
+ *       [TIPO_COMANDO] = TrataComando,
+ *   };
+ *   ReceptorQuadrosDespacha(&receptor, tratadores, 0);
+ *
+ * O CHK e a soma de 8 bits dos dados, ou, com CRC_DMA e
+ * ReceptorQuadrosIntegridade(receptor, RECEPTOR_CRC32), o CRC-32 dos dados
+ * em 4 bytes (mais significativo primeiro), calculado pelo DMAC durante a
+ * copia dos dados (crc_dma.h).
+ */
+
+
+#ifndef RECEPTOR_QUADROS_H_
+#define RECEPTOR_QUADROS_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* numero maximo de assinantes de um receptor */
+#ifndef RECEPTOR_ASSINANTES
+#define RECEPTOR_ASSINANTES		4
+#endif
+
+/* tipo de assinatura que recebe todos os quadros (ReceptorQuadrosAssina) */
+#define RECEPTOR_TODOS			0xFFFF
+
+/* modos de despertar da tarefa do receptor */
+typedef enum
+{
+	RECEPTOR_POR_BYTE = 0,		///< a cada byte: menor latencia, mais trocas de contexto
+	RECEPTOR_POR_LIMIAR,		///< a cada limiar bytes: fluxos continuos, sem pausas
+	RECEPTOR_LINHA_OCIOSA		///< no limiar ou quando a linha fica ociosa por ociosa marcas
+} despertar_receptor_t;
+
+/* verificacao de integridade do CHK */
+typedef enum
+{
+	RECEPTOR_SOMA = 0,			///< soma de 8 bits dos dados, 1 byte
+	RECEPTOR_CRC32				///< CRC-32 dos dados, 4 bytes, pelo DMAC (CRC_DMA)
+} integridade_receptor_t;
+
+/* tratador de um tipo de quadro, chamado na tarefa do receptor com os dados
+   do quadro sem copia, validos so durante a chamada. Nao deve bloquear: a
+   recepcao espera o retorno */
+typedef void (*tratador_quadro_t)(const uint8_t *dados, uint8_t qtd);
+
+/**
+* \struct quadro_recebido_t
+* Quadro entregue a um assinante, em um bloco do conjunto de memoria do
+* receptor (blocos de sizeof(quadro_recebido_t) bytes). O assinante o
+* recebe com FilaRecebePonteiro e o devolve com MemoriaLibera
+*/
+
+typedef struct
+{
+	uint8_t		qtd;				///< Quantidade de dados
+	uint8_t		dados[255];			///< Dados do quadro
+} quadro_recebido_t;
+
+/**
+* \struct estatisticas_receptor_t
+* Contadores do receptor, de 32 bits (voltam a zero ao estourar)
+*/
+
+typedef struct
+{
+	uint32_t	bytes;				///< Bytes analisados
+	uint32_t	despertares;		///< Vezes que a tarefa acordou com bytes (bytes / despertares: bytes por despertar)
+	uint32_t	quadros_validos;	///< Quadros com CHK e ETX corretos
+	uint32_t	quadros_invalidos;	///< Quadros com QTD zero, CHK ou ETX errado
+	uint32_t	entregas_perdidas;	///< Copias nao entregues: sem bloco livre ou fila do assinante cheia
+	uint32_t	bytes_perdidos;		///< Bytes que nao couberam no anel (ReceptorQuadrosEscreve)
+	uint32_t	sem_tratador;		///< Quadros validos de tipo sem tratador na tabela de despacho
+} estatisticas_receptor_t;
+
+typedef struct
+{
+	fila_t		*fila;				///< Fila de ponteiros (mensagens de sizeof(void*))
+	uint16_t	tipo;				///< Primeiro byte dos dados aceito, ou RECEPTOR_TODOS
+} assinante_receptor_t;
+
+/**
+* \struct receptor_quadros_t
+* Estrutura de controle do receptor
+*/
+
+typedef struct
+{
+	anel_t					anel;			///< Bytes recebidos (produtor: a interrupcao)
+	memoria_t				*quadros;		///< Blocos das copias entregues
+	assinante_receptor_t	assinantes[RECEPTOR_ASSINANTES];
+	uint8_t					numero_assinantes;
+	uint8_t					posicao_tipo;	///< Byte dos dados com o tipo do despacho
+	const tratador_quadro_t	*tratadores;	///< Tabela de 256 tratadores, ou 0
+	uint8_t					despertar;		///< despertar_receptor_t
+	uint16_t				limiar;			///< Bytes que acordam a tarefa
+	tick_t					ociosa;			///< Marcas sem bytes novos que indicam a linha ociosa
+	uint8_t					estado;			///< Estado do analisador
+	uint8_t					integridade;	///< integridade_receptor_t
+	uint8_t					qtd;
+	uint8_t					recebidos;
+	uint8_t					soma;
+	uint8_t					bytes_chk;		///< Bytes do CHK ja recebidos
+	uint32_t				chk;
+	uint8_t					dados[255];
+	estatisticas_receptor_t	estatisticas;
+} receptor_quadros_t;
+
+uint8_t ReceptorQuadrosInicia(receptor_quadros_t *receptor, uint8_t *area_anel, uint16_t capacidade,
+							  memoria_t *quadros, despertar_receptor_t despertar, uint16_t limiar, tick_t ociosa);
+uint8_t ReceptorQuadrosIntegridade(receptor_quadros_t *receptor, integridade_receptor_t integridade);
+uint8_t ReceptorQuadrosAssina(receptor_quadros_t *receptor, fila_t *fila, uint16_t tipo);
+void ReceptorQuadrosDespacha(receptor_quadros_t *receptor, const tratador_quadro_t *tratadores, uint8_t posicao_tipo);
+uint16_t ReceptorQuadrosEscreve(receptor_quadros_t *receptor, const uint8_t *dados, uint16_t tamanho);
+void ReceptorQuadrosProcessa(receptor_quadros_t *receptor, const uint8_t *bloco, uint16_t tamanho);
+void ReceptorQuadrosExecuta(receptor_quadros_t *receptor);
+
+#endif /* RECEPTOR_QUADROS_H_ */
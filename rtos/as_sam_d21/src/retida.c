@@ -0,0 +1,80 @@
+/*
+ * retida.c
+ *
+ * Memoria retida entre resets (ver retida.h).
+ */
+
+#include <asf.h>
+#include "retida.h"
+
+/* "RTD" e a versao; o tamanho da secao entra na assinatura, entao mudar
+   as variaveis RETIDA de tamanho tambem leva a uma partida fria */
+#define ASSINATURA_BASE		(0x52544400u ^ (uint32_t)RETIDA_VERSAO)
+
+RETIDA memoria_retida_t memoria_retida;
+RETIDA static uint32_t assinatura;
+
+/* causas que perdem a RAM */
+#define CAUSAS_FRIAS		(PM_RCAUSE_POR | PM_RCAUSE_BOD12 | PM_RCAUSE_BOD33)
+
+/* valida a secao retida pela causa do reset e pela assinatura, zerando-a
+   na partida fria. Retorna 1 se a partida e quente */
+uint8_t RetidaInicia(void)
+{
+	extern uint32_t _sretida, _eretida;
+	uint32_t esperada = ASSINATURA_BASE ^ ((uint32_t)&_eretida - (uint32_t)&_sretida);
+	uint8_t causa = PM->RCAUSE.reg;
+	uint32_t *p;
+
+	if((causa & CAUSAS_FRIAS) != 0 || assinatura != esperada)
+	{
+		for(p = &_sretida; p < &_eretida; p++)
+		{
+			*p = 0;
+		}
+		assinatura = esperada;
+	}
+	else
+	{
+		memoria_retida.quente = 1;
+		memoria_retida.partidas_quentes++;
+		if(causa & PM_RCAUSE_WDT)
+		{
+			memoria_retida.resets_watchdog++;
+		}
+		#if cfg_FALHA_GRAVE
+		/* o HardFault capturado e a ultima falha, relatada uma so vez */
+		if(falha_grave.assinatura == FALHA_GRAVE_NOVA)
+		{
+			memoria_retida.falha.codigo = RETIDA_HARDFAULT | falha_grave.tarefa;
+			memoria_retida.falha.endereco = falha_grave.quadro[6];		/* PC */
+			memoria_retida.falha.marca_tempo = falha_grave.marca_tempo;
+			memoria_retida.falha.tarefa = falha_grave.tarefa;
+			falha_grave.assinatura = FALHA_GRAVE_RELATADA;
+		}
+		#endif
+	}
+	memoria_retida.causa = causa;
+	return memoria_retida.quente;
+}
+
+/* guarda a falha para a proxima partida quente, sobrescrevendo a anterior */
+void RetidaRegistraFalha(uint32_t codigo, uint32_t endereco)
+{
+	reg_atomica_t estado;
+
+	REG_ATOMICA_INICIO(estado);
+	memoria_retida.falha.codigo = codigo;
+	memoria_retida.falha.endereco = endereco;
+	memoria_retida.falha.marca_tempo = ObtemMarcasDeTempo();
+	memoria_retida.falha.tarefa = tarefa_atual;
+	REG_ATOMICA_FIM(estado);
+}
+
+/* registra a falha e reinicia por software: a partida seguinte e quente */
+void RetidaReinicia(uint32_t codigo, uint32_t endereco)
+{
+	RetidaRegistraFalha(codigo, endereco);
+	__DSB();
+	NVIC_SystemReset();
+}
@@ -0,0 +1,85 @@
+/*
+ * retida.h
+ *
+ * Memoria retida entre resets: as variaveis RETIDA (secao .retida do
+ * script do ligador) nao sao zeradas nem inicializadas na partida, entao
+ * continuam com o valor de antes de um reset do watchdog, de
+ * NVIC_SystemReset ou do pino de reset. Depois de uma falta de energia
+ * (POR ou BOD) o conteudo e lixo.
+ *
+ * RetidaInicia decide o tipo de partida pela causa do reset (PM->RCAUSE)
+ * e por uma assinatura guardada na propria secao:
+ *  - partida fria: POR, BOD ou assinatura errada (primeira partida, outro
+ *    programa ou RETIDA_VERSAO diferente). A secao inteira e zerada;
+ *  - partida quente: a secao e mantida. O rastro do nucleo com
+ *    cfg_RASTRO_RETIDO, a ultima falha registrada e os caches RETIDA dos
+ *    modulos (ex.: o estado da fila na flash, sem a varredura das paginas)
+ *    estao validos.
+ *
+ * Deve ser a primeira chamada de main, antes de qualquer modulo usar uma
+ * variavel RETIDA. Ex.:
+ *
+ *   RetidaInicia();
+ *   if(memoria_retida.falha.codigo != 0) { envia o rastro e a falha }
+ *   ...
+ *   if(erro_grave) RetidaReinicia(CODIGO_ERRO, endereco);	partida quente
+ *
+ * Com cfg_FALHA_GRAVE, um HardFault capturado pela porta (falha_grave) vira
+ * a falha registrada da partida quente seguinte: codigo RETIDA_HARDFAULT
+ * com a tarefa no byte baixo e o PC da falha no endereco. Os detalhes
+ * (registradores, pilhas e rastro) continuam em falha_grave.
+ */
+
+
+#ifndef RETIDA_H_
+#define RETIDA_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* mude ao alterar o formato de alguma variavel RETIDA sem mudar o tamanho
+   da secao: a proxima partida sera fria */
+#ifndef RETIDA_VERSAO
+#define RETIDA_VERSAO			1
+#endif
+
+/**
+* \struct falha_retida_t
+* Ultima falha registrada antes de um reset
+*/
+
+typedef struct
+{
+	uint32_t	codigo;				///< Codigo da falha, da aplicacao (0 = nenhuma)
+	uint32_t	endereco;			///< Endereco da falha (ex.: PC ou LR), ou dado da aplicacao
+	tick_t		marca_tempo;		///< Marca de tempo do registro
+	uint8_t		tarefa;				///< Tarefa em execucao no registro
+} falha_retida_t;
+
+/**
+* \struct memoria_retida_t
+* Contadores e falha mantidos entre resets (zerados na partida fria)
+*/
+
+typedef struct
+{
+	uint32_t		partidas_quentes;	///< Partidas quentes desde a ultima fria
+	uint32_t		resets_watchdog;	///< Resets do watchdog desde a ultima partida fria
+	falha_retida_t	falha;				///< Ultima falha registrada (RetidaRegistraFalha)
+	uint8_t			causa;				///< PM->RCAUSE desta partida
+	uint8_t			quente;				///< 1 se esta partida e quente
+} memoria_retida_t;
+
+/* codigo da falha de um HardFault capturado; o byte baixo e a tarefa */
+#define RETIDA_HARDFAULT		0x48464C00u
+
+extern memoria_retida_t memoria_retida;
+
+uint8_t RetidaInicia(void);
+void RetidaRegistraFalha(uint32_t codigo, uint32_t endereco);
+void RetidaReinicia(uint32_t codigo, uint32_t endereco);
+
+/* 1 se esta partida e quente: os caches RETIDA podem ser usados */
+#define RetidaQuente()			(memoria_retida.quente)
+
+#endif /* RETIDA_H_ */
@@ -0,0 +1,52 @@
+/*
+ * sincronismo.h
+ *
+ * Espera do sincronismo de registradores de perifericos com clock lento
+ * (o EIC e o TCC0 a ~1 kHz, o WDT): cada escrita sincronizada leva de 2 a
+ * 3 ciclos do clock do periferico, ~3 ms a 1 kHz. A espera ocupada do ASF
+ * (while(SYNCBUSY)) prende a tarefa, e o que ela tiver reservado, esse
+ * tempo todo. SINCRONIZA_LENTO espera a marca seguinte com a tarefa
+ * bloqueada (TarefaEspera(1)) enquanto o periferico sincroniza, e so gira
+ * onde nao pode bloquear: antes de IniciaMultitarefas, em interrupcoes, em
+ * regioes atomicas e na tarefa ociosa.
+ *
+ * Os drivers agrupam as escritas para esperar uma vez so: escrevem os
+ * registradores de sincronismo independente em seguida e so esperam antes
+ * da escrita que depende deles, e nao esperam depois da ultima (a proxima
+ * configuracao espera no inicio). Ex.:
+ *
+ *   SINCRONIZA_LENTO(EIC->STATUS.reg & EIC_STATUS_SYNCBUSY);
+ */
+
+
+#ifndef SINCRONISMO_H_
+#define SINCRONISMO_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* 1 se a chamada vem de uma tarefa que pode bloquear: modo thread (IPSR 0)
+   na pilha de tarefa (CONTROL.SPSEL), interrupcoes habilitadas e nao e a
+   tarefa ociosa */
+static inline uint8_t SincronismoPodeBloquear(void)
+{
+	uint32_t primask, control;
+
+	__asm volatile("MRS %0, PRIMASK" : "=r"(primask));
+	__asm volatile("MRS %0, CONTROL" : "=r"(control));
+	return (uint8_t)(primask == 0 && LeIpsr() == 0 && (control & 2) != 0 &&
+					 TCB_ATUAL_PRIORIDADE() != 0);
+}
+
+#define SINCRONIZA_LENTO(ocupado)								\
+	do {														\
+		while(ocupado)											\
+		{														\
+			if(SincronismoPodeBloquear())						\
+			{													\
+				TarefaEspera(1);								\
+			}													\
+		}														\
+	} while(0)
+
+#endif /* SINCRONISMO_H_ */
@@ -0,0 +1,136 @@
+/*
+ * sono_rtc.c
+ *
+ * Sono longo no STANDBY, acordado pela comparacao do RTC (ver sono_rtc.h).
+ */
+
+#include <asf.h>
+#include "sono_rtc.h"
+
+#if SONO_RTC
+
+#if SONO_RTC_XOSC32K
+#define FONTE_RTC				GCLK_GENCTRL_SRC_XOSC32K
+#else
+#define FONTE_RTC				GCLK_GENCTRL_SRC_OSCULP32K
+#endif
+
+/* a comparacao precisa de algumas contagens a frente para ser vista depois
+   da sincronizacao da escrita */
+#define MENOR_SONO				8
+
+static volatile uint8_t impedimentos = 0;
+
+static void Sincroniza(void)
+{
+	while(RTC->MODE0.STATUS.reg & RTC_STATUS_SYNCBUSY) {}
+}
+
+static uint32_t LeContagem(void)
+{
+	RTC->MODE0.READREQ.reg = RTC_READREQ_RREQ | RTC_READREQ_ADDR(RTC_MODE0_COUNT_OFFSET);
+	Sincroniza();
+	return RTC->MODE0.COUNT.reg;
+}
+
+/* RTC contando livre em 32 bits a 32,768 kHz, tambem no STANDBY */
+void SonoRtcInicia(void)
+{
+	#if SONO_RTC_XOSC32K
+	SYSCTRL->XOSC32K.reg |= SYSCTRL_XOSC32K_RUNSTDBY;
+	#endif
+
+	PM->APBAMASK.reg |= PM_APBAMASK_RTC;
+	GCLK->GENDIV.reg = GCLK_GENDIV_ID(SONO_RTC_GERADOR) | GCLK_GENDIV_DIV(1);
+	GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(SONO_RTC_GERADOR) | FONTE_RTC |
+						GCLK_GENCTRL_RUNSTDBY | GCLK_GENCTRL_GENEN;
+	while(GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY) {}
+	GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(RTC_GCLK_ID) | GCLK_CLKCTRL_GEN(SONO_RTC_GERADOR) | GCLK_CLKCTRL_CLKEN;
+
+	RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_SWRST;
+	while(RTC->MODE0.CTRL.reg & RTC_MODE0_CTRL_SWRST) {}
+	RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_MODE_COUNT32 | RTC_MODE0_CTRL_PRESCALER_DIV1;
+	Sincroniza();
+	RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+	NVIC_EnableIRQ(RTC_IRQn);
+	RTC->MODE0.CTRL.reg |= RTC_MODE0_CTRL_ENABLE;
+	Sincroniza();
+}
+
+/* cfg_SONO_LONGO: dorme no STANDBY ate us microssegundos e retorna os
+   microssegundos dormidos, pelo RTC, ou 0 se o sono foi impedido (ou
+   nem comecou). Chamada
+   pela porta com as interrupcoes desabilitadas: uma interrupcao pendente
+   acorda do WFI sem ser atendida */
+uint32_t SonoRtcDorme(uint32_t us)
+{
+	uint32_t contagens, inicio, dormidas;
+
+	if(impedimentos != 0)
+	{
+		return 0;
+	}
+	if(us > SONO_RTC_MAX_MS * 1000UL)
+	{
+		us = SONO_RTC_MAX_MS * 1000UL;
+	}
+	contagens = (uint32_t)(((uint64_t)us * SONO_RTC_HZ) / 1000000UL);
+	if(contagens < MENOR_SONO)
+	{
+		return 0;
+	}
+
+	inicio = LeContagem();
+	RTC->MODE0.COMP[0].reg = inicio + contagens;
+	Sincroniza();
+	RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+	RTC->MODE0.INTENSET.reg = RTC_MODE0_INTENSET_CMP0;
+
+	system_set_sleepmode(SYSTEM_SLEEPMODE_STANDBY);
+	__DSB();
+	__WFI();
+	/* a tarefa ociosa escolhe o nivel de cada sono (OciosaEscolheSono) */
+	system_set_sleepmode(SYSTEM_SLEEPMODE_IDLE_0);
+
+	/* a leitura captura a contagem no pedido; a espera da sincronizacao
+	   (~2 contagens) fica fora da medida, menos de 0,1 ms por sono */
+	RTC->MODE0.INTENCLR.reg = RTC_MODE0_INTENCLR_CMP0;
+	dormidas = LeContagem() - inicio;
+	return (uint32_t)(((uint64_t)dormidas * 1000000UL + SONO_RTC_HZ / 2) / SONO_RTC_HZ);
+}
+
+/* um modulo que nao pode parar no STANDBY impede o sono longo enquanto
+   trabalha. Contados: cada SonoRtcImpede com o seu SonoRtcPermite */
+void SonoRtcImpede(void)
+{
+	reg_atomica_t estado;
+
+	REG_ATOMICA_INICIO(estado);
+	impedimentos++;
+	REG_ATOMICA_FIM(estado);
+}
+
+void SonoRtcPermite(void)
+{
+	reg_atomica_t estado;
+
+	REG_ATOMICA_INICIO(estado);
+	if(impedimentos > 0)
+	{
+		impedimentos--;
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+uint8_t SonoRtcPermitido(void)
+{
+	return (uint8_t)(impedimentos == 0);
+}
+
+/* o despertar ja aconteceu no WFI: so limpa a comparacao */
+void RTC_Handler(void)
+{
+	RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * sono_rtc.h
+ *
+ * Sono longo da tarefa ociosa no STANDBY, acordado pelo RTC (gancho
+ * cfg_SONO_LONGO do nucleo, conf_rtos.h). No STANDBY o clock da CPU para e,
+ * com ele, o SysTick: para esperas de segundos (TarefaEspera(5000)), a
+ * porta para a marca de tempo e SonoRtcDorme programa a comparacao do RTC,
+ * que conta 32,768 kHz tambem no STANDBY, para o instante do despertar. Ao
+ * acordar, pelo RTC ou por outra interrupcao, o tempo dormido e lido do
+ * proprio RTC e o nucleo compensa as marcas, com a fracao da marca atual.
+ *
+ * O RTC conta o OSCULP32K pelo gerador SONO_RTC_GERADOR, sempre ligado mas
+ * impreciso (alguns % com a temperatura), ou o XOSC32K com
+ * SONO_RTC_XOSC32K=1, que precisa estar ligado (clock_adiado.c) e que passa
+ * a correr no STANDBY. O erro do relogio vira erro do tempo do sistema
+ * durante os sonos longos.
+ *
+ * No STANDBY param tambem os perifericos sem RUNSTDBY: a SERCOM e o DMA da
+ * UART, a SPI, o TC3 da amostragem e o TC4/TC5 de tempo_us. O WDT
+ * (vigia_wdt.h), o TCC0 do padrao de LED e o USB continuam. Um modulo que
+ * nao pode parar chama SonoRtcImpede enquanto trabalha (ex.: uma recepcao
+ * em andamento) e SonoRtcPermite depois: impedido, o sono longo e recusado
+ * e a tarefa ociosa dorme no IDLE, como sem o modulo. O sono e limitado a
+ * SONO_RTC_MAX_MS, menor que o aviso do WDT. Ao acordar, o DFLL volta a
+ * travar na referencia antes de o clock da CPU ficar estavel.
+ *
+ * Ligado com SONO_RTC=1 nos simbolos do projeto, a partir de
+ * cfg_SONO_LONGO_MARCAS marcas ate o despertar (conf_rtos.h):
+ *
+ *   SonoRtcInicia();			antes de IniciaMultitarefas
+ */
+
+
+#ifndef SONO_RTC_H_
+#define SONO_RTC_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef SONO_RTC
+#define SONO_RTC				0
+#endif
+
+/* gerador de clock do RTC, sem divisor (32,768 kHz) */
+#ifndef SONO_RTC_GERADOR
+#define SONO_RTC_GERADOR		6
+#endif
+
+/* 1: XOSC32K, 0: OSCULP32K */
+#ifndef SONO_RTC_XOSC32K
+#define SONO_RTC_XOSC32K		0
+#endif
+
+/* maior sono de uma vez (a tarefa ociosa volta a dormir se falta tempo),
+   menor que o aviso do WDT (~2 s depois da alimentacao, vigia_wdt.h) */
+#ifndef SONO_RTC_MAX_MS
+#define SONO_RTC_MAX_MS			1000
+#endif
+
+#define SONO_RTC_HZ				32768UL
+
+void SonoRtcInicia(void);
+uint32_t SonoRtcDorme(uint32_t us);
+void SonoRtcImpede(void);
+void SonoRtcPermite(void);
+uint8_t SonoRtcPermitido(void);
+
+#endif /* SONO_RTC_H_ */
@@ -0,0 +1,249 @@
+/*
+ * spi_dma.c
+ *
+ * SPI mestre por DMA na SERCOM do EXT1 (modo 0, MSB primeiro, 8 bits).
+ *
+ * Dois canais do DMAC por transacao: o de recepcao copia cada byte
+ * recebido (gatilho RXC) e o de envio escreve o proximo byte (gatilho DRE).
+ * Como o SPI recebe um byte para cada byte enviado, o fim do canal de
+ * recepcao e o fim da transacao: a interrupcao desse canal desativa o
+ * pino CS, libera o semaforo da transacao e inicia a proxima da fila.
+ */
+
+#include <asf.h>
+#include "dma.h"
+#include "perfil_clock.h"
+#include "pinos.h"
+#include "spi_dma.h"
+
+#define SERCOM_SPI			EXT1_SPI_MODULE
+
+/* PAD0 recebe (MISO), PAD2 envia (MOSI) e PAD3 e o clock. O PAD1 (SS) 
+   fica como pino comum: cada transacao controla seu proprio CS */
+#define SPI_DIPO			0
+#define SPI_DOPO			1
+
+static transacao_spi_t *primeira_transacao = 0;
+static transacao_spi_t *ultima_transacao = 0;
+static uint32_t frequencia_spi;
+
+static const uint8_t byte_vazio = SPI_DMA_BYTE_VAZIO;
+static uint8_t byte_descarte;
+
+/* programa os dois canais para a primeira transacao da fila. Chamada com 
+   as interrupcoes desabilitadas ou pelo DMAC_Handler */
+static void IniciaTransacao(void)
+{
+	transacao_spi_t *t = primeira_transacao;
+	DmacDescriptor *recepcao = &dma_descritores[SPI_DMA_CANAL_RECEPCAO];
+	DmacDescriptor *envio = &dma_descritores[SPI_DMA_CANAL_ENVIO];
+
+	if(t == 0)
+	{
+		return;
+	}
+
+	/* enderecos incrementados apontam para o fim da area */
+	recepcao->BTCNT.reg = t->tamanho;
+	if(t->recepcao != 0)
+	{
+		recepcao->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_DSTINC |
+								DMAC_BTCTRL_BLOCKACT_INT;
+		recepcao->DSTADDR.reg = (uint32_t)&t->recepcao[t->tamanho];
+	}
+	else
+	{
+		recepcao->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_BLOCKACT_INT;
+		recepcao->DSTADDR.reg = (uint32_t)&byte_descarte;
+	}
+
+	envio->BTCNT.reg = t->tamanho;
+	if(t->envio != 0)
+	{
+		envio->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+							DMAC_BTCTRL_BLOCKACT_NOACT;
+		envio->SRCADDR.reg = (uint32_t)&t->envio[t->tamanho];
+	}
+	else
+	{
+		envio->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_BLOCKACT_NOACT;
+		envio->SRCADDR.reg = (uint32_t)&byte_vazio;
+	}
+
+	port_pin_set_output_level(t->pino_cs, false);
+
+	/* a recepcao primeiro, para nao perder o primeiro byte */
+	DMAC->CHID.reg = SPI_DMA_CANAL_RECEPCAO;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+	DMAC->CHID.reg = SPI_DMA_CANAL_ENVIO;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+}
+
+/* interrupcao de fim da recepcao, chamada pelo DMAC_Handler */
+static void FimDeTransacao(void)
+{
+	transacao_spi_t *t = primeira_transacao;
+
+	if(DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL)
+	{
+		DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+		if(t != 0)
+		{
+			port_pin_set_output_level(t->pino_cs, true);
+			primeira_transacao = t->proxima;
+			if(primeira_transacao == 0)
+			{
+				ultima_transacao = 0;
+			}
+			t->concluida = 1;
+			SemaforoLiberaISR(&t->fim);
+			IniciaTransacao();
+		}
+	}
+}
+
+/* BAUD para o clock atual: f = clock / (2 * (BAUD + 1)), arredondado para 
+   a frequencia mais proxima que nao passe de frequencia_spi */
+static uint8_t ValorBaud(uint32_t clock_hz)
+{
+	uint32_t baud = (clock_hz + (2 * frequencia_spi) - 1) / (2 * frequencia_spi);
+
+	if(baud > 256)
+	{
+		baud = 256;
+	}
+	return (uint8_t)((baud > 0) ? (baud - 1) : 0);
+}
+
+/* recalcula o clock do SPI apos uma troca de perfil de clock (gancho de 
+   perfil_clock.c). Uma transacao em andamento continua com a nova taxa */
+static void AjustaBaud(uint32_t clock_hz)
+{
+	SercomSpi *const spi = &(SERCOM_SPI->SPI);
+
+	spi->CTRLA.reg &= ~SERCOM_SPI_CTRLA_ENABLE;
+	while(spi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_ENABLE) {}
+	spi->BAUD.reg = ValorBaud(clock_hz);
+	spi->CTRLA.reg |= SERCOM_SPI_CTRLA_ENABLE;
+	while(spi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_ENABLE) {}
+}
+
+/* reinicia o canal e escolhe o gatilho e o nivel de prioridade */
+static void ConfiguraCanal(uint8_t canal, uint8_t nivel, uint8_t gatilho)
+{
+	DMAC->CHID.reg = canal;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while(DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST) {}
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(nivel) | DMAC_CHCTRLB_TRIGSRC(gatilho) | DMAC_CHCTRLB_TRIGACT_BEAT;
+}
+
+#if !PINOS_TABELA
+static void ConfiguraPino(uint32_t pinmux)
+{
+	struct system_pinmux_config config_pino;
+
+	system_pinmux_get_config_defaults(&config_pino);
+	config_pino.mux_position = pinmux & 0xFFFF;
+	system_pinmux_pin_set_config(pinmux >> 16, &config_pino);
+}
+#endif
+
+/* configura a SERCOM como SPI mestre e os dois canais do DMAC. Os pinos CS 
+   das transacoes devem estar configurados como saida, em nivel alto */
+void SpiDmaInicia(uint32_t frequencia_hz)
+{
+	struct system_gclk_chan_config config_clock;
+	SercomSpi *const spi = &(SERCOM_SPI->SPI);
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_SERCOM0);
+
+	/* clock da SERCOM: gerador 0, o mesmo da CPU (PerfilClockHz) */
+	system_gclk_chan_get_config_defaults(&config_clock);
+	config_clock.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(SERCOM0_GCLK_ID_CORE, &config_clock);
+	system_gclk_chan_enable(SERCOM0_GCLK_ID_CORE);
+
+#if !PINOS_TABELA		/* senao, ja configurados na partida (pinos.h) */
+	ConfiguraPino(EXT1_SPI_SERCOM_PINMUX_PAD0);
+	ConfiguraPino(EXT1_SPI_SERCOM_PINMUX_PAD2);
+	ConfiguraPino(EXT1_SPI_SERCOM_PINMUX_PAD3);
+#endif
+
+	spi->CTRLA.reg = SERCOM_SPI_CTRLA_SWRST;
+	while(spi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_SWRST) {}
+
+	spi->CTRLA.reg = SERCOM_SPI_CTRLA_MODE_SPI_MASTER | SERCOM_SPI_CTRLA_DIPO(SPI_DIPO) |
+					SERCOM_SPI_CTRLA_DOPO(SPI_DOPO);
+	spi->CTRLB.reg = SERCOM_SPI_CTRLB_RXEN | SERCOM_SPI_CTRLB_CHSIZE(0);
+	while(spi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_CTRLB) {}
+
+	frequencia_spi = frequencia_hz;
+	spi->BAUD.reg = ValorBaud(PerfilClockHz());
+
+	/* um unico bloco por transacao, sem descritor seguinte */
+	dma_descritores[SPI_DMA_CANAL_RECEPCAO].SRCADDR.reg = (uint32_t)&spi->DATA.reg;
+	dma_descritores[SPI_DMA_CANAL_RECEPCAO].DESCADDR.reg = 0;
+	dma_descritores[SPI_DMA_CANAL_ENVIO].DSTADDR.reg = (uint32_t)&spi->DATA.reg;
+	dma_descritores[SPI_DMA_CANAL_ENVIO].DESCADDR.reg = 0;
+
+	DmaIniciaControlador();
+	DmaRegistraTratador(SPI_DMA_CANAL_RECEPCAO, FimDeTransacao);
+
+	ConfiguraCanal(SPI_DMA_CANAL_ENVIO, 0, EXT1_SPI_SERCOM_DMAC_ID_TX);
+	ConfiguraCanal(SPI_DMA_CANAL_RECEPCAO, 1, EXT1_SPI_SERCOM_DMAC_ID_RX);
+	DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+
+	spi->CTRLA.reg |= SERCOM_SPI_CTRLA_ENABLE;
+	while(spi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_ENABLE) {}
+
+	(void)PerfilClockRegistraGancho(AjustaBaud);
+}
+
+/* coloca a transacao no fim da fila e retorna sem esperar. A transacao e 
+   suas areas devem continuar validas ate o fim (concluida = 1) */
+void SpiDmaEnfileira(transacao_spi_t *transacao)
+{
+	reg_atomica_t estado;
+
+	transacao->concluida = 0;
+	transacao->fim.contador = 0;
+	transacao->fim.tarefaEsperando = 0;
+	transacao->proxima = 0;
+
+	if(transacao->tamanho == 0)
+	{
+		transacao->concluida = 1;
+		return;
+	}
+
+	REG_ATOMICA_INICIO(estado);
+	if(ultima_transacao == 0)
+	{
+		primeira_transacao = ultima_transacao = transacao;
+		IniciaTransacao();
+	}
+	else
+	{
+		ultima_transacao->proxima = transacao;
+		ultima_transacao = transacao;
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+/* bloqueia a tarefa ate o fim da transacao. Retorna 1 se ela terminou e 0 
+   se o tempo se esgotou (a transacao continua na fila) */
+uint8_t SpiDmaAguarda(transacao_spi_t *transacao, tick_t timeout)
+{
+	if(transacao->concluida)
+	{
+		return 1;
+	}
+	return SemaforoAguardaTempo(&transacao->fim, timeout) || transacao->concluida;
+}
+
+/* enfileira a transacao e aguarda o fim */
+uint8_t SpiDmaTransfere(transacao_spi_t *transacao, tick_t timeout)
+{
+	SpiDmaEnfileira(transacao);
+	return SpiDmaAguarda(transacao, timeout);
+}
@@ -0,0 +1,49 @@
+/*
+ * spi_dma.h
+ *
+ * SPI mestre por DMA na SERCOM do conector EXT1 (SAM D21 Xplained Pro).
+ * Cada transferencia e uma transacao em uma fila: o DMAC envia e recebe os
+ * bytes sem a CPU e a tarefa que aguarda a transacao fica bloqueada no
+ * semaforo da transacao ate o fim, sem espera ocupada. As transacoes de
+ * varias tarefas sao executadas na ordem em que foram enfileiradas.
+ */
+
+
+#ifndef SPI_DMA_H_
+#define SPI_DMA_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* canais do DMAC (menores que DMA_NUMERO_CANAIS, dma.h). A recepcao tem 
+   prioridade maior, para nao perder bytes quando o DMAC esta ocupado */
+#ifndef SPI_DMA_CANAL_RECEPCAO
+#define SPI_DMA_CANAL_RECEPCAO	3
+#endif
+
+#ifndef SPI_DMA_CANAL_ENVIO
+#define SPI_DMA_CANAL_ENVIO		4
+#endif
+
+/* byte enviado nas transacoes sem dados de envio (so recepcao) */
+#ifndef SPI_DMA_BYTE_VAZIO
+#define SPI_DMA_BYTE_VAZIO		0xFF
+#endif
+
+typedef struct transacao_spi
+{
+	const uint8_t	*envio;			///< bytes enviados, ou 0 para SPI_DMA_BYTE_VAZIO
+	uint8_t			*recepcao;		///< bytes recebidos, ou 0 para descarta-los
+	uint16_t		tamanho;		///< bytes em cada sentido
+	uint8_t			pino_cs;		///< pino de selecao do escravo, ativo em 0
+	volatile uint8_t	concluida;	///< 1 apos o fim da transferencia
+	semaforo_t		fim;			///< liberado no fim da transferencia
+	struct transacao_spi *proxima;	///< uso interno da fila
+} transacao_spi_t;
+
+void SpiDmaInicia(uint32_t frequencia_hz);
+void SpiDmaEnfileira(transacao_spi_t *transacao);
+uint8_t SpiDmaAguarda(transacao_spi_t *transacao, tick_t timeout);
+uint8_t SpiDmaTransfere(transacao_spi_t *transacao, tick_t timeout);
+
+#endif /* SPI_DMA_H_ */
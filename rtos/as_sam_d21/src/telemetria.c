@@ -0,0 +1,329 @@
+/*
+ * telemetria.c
+ *
+ * Agregador de telemetria (ver telemetria.h). So usa servicos do nucleo,
+ * sem registradores do microcontrolador.
+ *
+ * Os indices do anel contam sem parar e a posicao e o indice & mascara:
+ * reservadas so e alterada com as interrupcoes desabilitadas, por quem
+ * publica; lidas, so pelo agregador. Uma posicao reservada so e lida depois
+ * de marcada como pronta, entao uma publicacao interrompida no meio da
+ * escrita so atrasa o quadro, nunca entrega a amostra incompleta.
+ */
+
+#include "telemetria.h"
+
+#define STX						0x02
+#define ETX						0x03
+
+#define MASCARA_AMOSTRAS		(TELEMETRIA_AMOSTRAS - 1)
+
+/* STX, QTD, tipo, indicacoes, amostras, CHK, ETX. Com a compressao, as
+   amostras podem ocupar mais que sem ela antes de o quadro voltar a forma
+   sem compressao */
+#if TELEMETRIA_COMPRIME
+#define TAM_QUADRO				(2 + 2 + TELEMETRIA_POR_QUADRO * TELEMETRIA_MAIOR_COMPRIMIDA + 2)
+#else
+#define TAM_QUADRO				(2 + 2 + TELEMETRIA_POR_QUADRO * TELEMETRIA_TAM_AMOSTRA + 2)
+#endif
+
+typedef struct
+{
+	uint8_t		pronta;				/* escrita terminada, pode ser lida */
+	uint8_t		id;
+	int32_t		valor;
+	tick_t		marca;				/* da publicacao, para a idade */
+} amostra_telemetria_t;
+
+estatisticas_telemetria_t estatisticas_telemetria;
+
+static volatile amostra_telemetria_t anel[TELEMETRIA_AMOSTRAS];
+static volatile uint16_t reservadas = 0;
+static volatile uint16_t lidas = 0;
+static envia_telemetria_t envia_saida;
+static volatile uint8_t tarefa_agregador = 0;
+
+/* marcas que o agregador pode esperar antes do proximo quadro: 0 se ha
+   um quadro completo ou se a amostra mais antiga passou da idade */
+static tick_t Espera(void)
+{
+	uint16_t pendentes = (uint16_t)(reservadas - lidas);
+	uint16_t prontas = 0;
+	tick_t idade;
+
+	if(pendentes == 0)
+	{
+		return ESPERA_INFINITA;
+	}
+	while(prontas < pendentes && prontas < TELEMETRIA_POR_QUADRO &&
+		  anel[(uint16_t)(lidas + prontas) & MASCARA_AMOSTRAS].pronta)
+	{
+		prontas++;
+	}
+	if(prontas == TELEMETRIA_POR_QUADRO)
+	{
+		return 0;
+	}
+	if(prontas == 0 || pendentes >= TELEMETRIA_POR_QUADRO)
+	{
+		return 1;						/* publicacao no meio da escrita */
+	}
+	idade = (tick_t)(ObtemMarcasDeTempo() - anel[lidas & MASCARA_AMOSTRAS].marca);
+	if(idade >= TELEMETRIA_IDADE)
+	{
+		return 0;
+	}
+	return (tick_t)(TELEMETRIA_IDADE - idade);
+}
+
+/* posicao do id no compressor; um id novo substitui o mais antigo, com
+   a ultima amostra 0 */
+static int32_t *UltimaAmostra(compressor_telemetria_t *c, uint8_t id)
+{
+	uint8_t i;
+
+	for(i = 0; i < c->usados; i++)
+	{
+		if(c->ids[i] == id)
+		{
+			return &c->valores[i];
+		}
+	}
+	i = c->proxima;
+	c->proxima = (uint8_t)((i + 1) % TELEMETRIA_HISTORICO);
+	if(c->usados < TELEMETRIA_HISTORICO)
+	{
+		c->usados++;
+	}
+	c->ids[i] = id;
+	c->valores[i] = 0;
+	return &c->valores[i];
+}
+
+/* amostra sem compressao: id e valor little-endian */
+static void EscreveAmostra(uint8_t *p, uint8_t id, int32_t valor)
+{
+	uint32_t v = (uint32_t)valor;
+
+	p[0] = id;
+	p[1] = (uint8_t)v;
+	p[2] = (uint8_t)(v >> 8);
+	p[3] = (uint8_t)(v >> 16);
+	p[4] = (uint8_t)(v >> 24);
+}
+
+/* monta o quadro com as amostras prontas mais antigas, ate
+   TELEMETRIA_POR_QUADRO, e libera as posicoes. Retorna o tamanho */
+static uint16_t MontaQuadro(uint8_t *quadro, uint8_t *amostras)
+{
+	volatile amostra_telemetria_t *a;
+	uint8_t *dados = &quadro[4];
+	uint8_t soma, indicacoes = 0;
+	uint8_t n = 0;
+	uint16_t usados = 0, i;
+#if TELEMETRIA_COMPRIME
+	uint8_t ids[TELEMETRIA_POR_QUADRO];
+	int32_t valores[TELEMETRIA_POR_QUADRO];
+	compressor_telemetria_t compressor;
+
+	TelemetriaCompressorInicia(&compressor);
+#endif
+
+	while(n < TELEMETRIA_POR_QUADRO && lidas != reservadas)
+	{
+		a = &anel[lidas & MASCARA_AMOSTRAS];
+		if(!a->pronta)
+		{
+			break;
+		}
+#if TELEMETRIA_COMPRIME
+		ids[n] = a->id;
+		valores[n] = a->valor;
+		usados = (uint16_t)(usados + TelemetriaComprime(&compressor, ids[n], valores[n], &dados[usados]));
+#else
+		EscreveAmostra(&dados[usados], a->id, a->valor);
+		usados = (uint16_t)(usados + TELEMETRIA_TAM_AMOSTRA);
+#endif
+		a->pronta = 0;
+		lidas = (uint16_t)(lidas + 1);	/* a posicao volta para quem publica */
+		n++;
+	}
+
+#if TELEMETRIA_COMPRIME
+	if(usados < (uint16_t)(n * TELEMETRIA_TAM_AMOSTRA))
+	{
+		indicacoes = TELEMETRIA_COMPRIMIDO;
+	}
+	else
+	{
+		/* valores que variam muito: a forma sem compressao e menor */
+		for(i = 0; i < n; i++)
+		{
+			EscreveAmostra(&dados[i * TELEMETRIA_TAM_AMOSTRA], ids[i], valores[i]);
+		}
+		usados = (uint16_t)(n * TELEMETRIA_TAM_AMOSTRA);
+	}
+#endif
+	estatisticas_telemetria.bytes_amostras += (uint32_t)n * TELEMETRIA_TAM_AMOSTRA;
+	estatisticas_telemetria.bytes_enviados += usados;
+
+	quadro[0] = STX;
+	quadro[1] = (uint8_t)(2 + usados);
+	quadro[2] = TELEMETRIA_TIPO;
+	quadro[3] = indicacoes;
+	soma = (uint8_t)(TELEMETRIA_TIPO + indicacoes);
+	for(i = 0; i < usados; i++)
+	{
+		soma = (uint8_t)(soma + dados[i]);
+	}
+	dados[usados] = soma;
+	dados[usados + 1] = ETX;
+	*amostras = n;
+	return (uint16_t)(4 + usados + 2);
+}
+
+/*
+ * Interface
+ */
+
+/* inicia o agregador com a funcao de envio dos quadros. Deve ser chamada
+   antes de a tarefa do agregador comecar; as amostras publicadas antes
+   dela comecar esperam no anel */
+void TelemetriaInicia(envia_telemetria_t envia)
+{
+	envia_saida = envia;
+}
+
+/* publica uma amostra sem esperar. Pode ser chamada em interrupcoes.
+   Retorna 0 se o anel esta cheio (a amostra e descartada) */
+uint8_t TelemetriaPublica(uint8_t id, int32_t valor)
+{
+	reg_atomica_t estado;
+	volatile amostra_telemetria_t *a;
+	uint16_t pendentes;
+	uint8_t tarefa = 0;
+
+	REG_ATOMICA_INICIO(estado);
+	pendentes = (uint16_t)(reservadas - lidas);
+	if(pendentes >= TELEMETRIA_AMOSTRAS)
+	{
+		estatisticas_telemetria.descartadas++;
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	a = &anel[reservadas & MASCARA_AMOSTRAS];
+	reservadas = (uint16_t)(reservadas + 1);
+	estatisticas_telemetria.amostras++;
+
+	/* a primeira amostra comeca a contar a idade; a que completa um quadro
+	   o envia. As outras nao acordam o agregador */
+	if(pendentes == 0 || pendentes + 1 == TELEMETRIA_POR_QUADRO)
+	{
+		tarefa = tarefa_agregador;
+		if(tarefa != 0)
+		{
+			estatisticas_telemetria.notificacoes++;
+		}
+	}
+	REG_ATOMICA_FIM(estado);
+
+	a->id = id;
+	a->valor = valor;
+	a->marca = ObtemMarcasDeTempo();
+	a->pronta = 1;
+
+	if(tarefa != 0)
+	{
+		TarefaNotifica(tarefa, 1, NOTIFICA_BITS);
+	}
+	return 1;
+}
+
+/* corpo da tarefa do agregador, que nunca retorna */
+void TelemetriaExecuta(void)
+{
+	uint8_t quadro[TAM_QUADRO];
+	uint16_t tamanho;
+	uint8_t amostras;
+	tick_t espera;
+
+	tarefa_agregador = tarefa_atual;
+	for(;;)
+	{
+		espera = Espera();
+		if(espera != 0)
+		{
+			/* uma publicacao durante a montagem deixa a notificacao
+			   pendente, e a espera retorna na hora */
+			(void)TarefaAguardaNotificacao(espera);
+			continue;
+		}
+
+		tamanho = MontaQuadro(quadro, &amostras);
+		if(amostras < TELEMETRIA_POR_QUADRO)
+		{
+			estatisticas_telemetria.por_idade++;
+		}
+		while(envia_saida(quadro, tamanho) == 0)
+		{
+			estatisticas_telemetria.envios_adiados++;
+			TarefaEspera(1);
+		}
+		estatisticas_telemetria.quadros++;
+	}
+}
+
+/* inicia o compressor (ou o descompressor) no comeco de um quadro */
+void TelemetriaCompressorInicia(compressor_telemetria_t *c)
+{
+	c->usados = 0;
+	c->proxima = 0;
+}
+
+/* escreve a amostra comprimida em saida: id e a diferenca para a ultima
+   amostra do id em zigue-zague e varint (7 bits por byte, o bit 7 indica
+   que ha mais um). Retorna os bytes escritos (2 a TELEMETRIA_MAIOR_COMPRIMIDA) */
+uint8_t TelemetriaComprime(compressor_telemetria_t *c, uint8_t id, int32_t valor, uint8_t *saida)
+{
+	int32_t *ultima = UltimaAmostra(c, id);
+	uint32_t diferenca = (uint32_t)valor - (uint32_t)*ultima;
+	uint8_t n = 1;
+
+	*ultima = valor;
+	diferenca = (diferenca << 1) ^ (uint32_t)-(int32_t)(diferenca >> 31);	/* zigue-zague */
+	saida[0] = id;
+	while(diferenca >= 0x80)
+	{
+		saida[n++] = (uint8_t)(diferenca | 0x80);
+		diferenca >>= 7;
+	}
+	saida[n++] = (uint8_t)diferenca;
+	return n;
+}
+
+/* le uma amostra comprimida dos tamanho bytes de entrada. Retorna os bytes
+   lidos, ou 0 se a amostra esta incompleta ou e invalida */
+uint8_t TelemetriaDescomprime(compressor_telemetria_t *c, const uint8_t *entrada, uint8_t tamanho,
+							  uint8_t *id, int32_t *valor)
+{
+	int32_t *ultima;
+	uint32_t diferenca = 0;
+	uint8_t n = 1, deslocamento = 0;
+
+	do
+	{
+		if(n >= tamanho || n >= TELEMETRIA_MAIOR_COMPRIMIDA)
+		{
+			return 0;
+		}
+		diferenca |= (uint32_t)(entrada[n] & 0x7F) << deslocamento;
+		deslocamento = (uint8_t)(deslocamento + 7);
+	} while(entrada[n++] & 0x80);
+
+	diferenca = (diferenca >> 1) ^ (uint32_t)-(int32_t)(diferenca & 1);
+	*id = entrada[0];
+	ultima = UltimaAmostra(c, *id);
+	*ultima = (int32_t)((uint32_t)*ultima + diferenca);
+	*valor = *ultima;
+	return n;
+}
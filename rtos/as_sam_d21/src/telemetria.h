@@ -0,0 +1,156 @@
+/*
+ * telemetria.h
+ *
+ * Agregador de telemetria: as tarefas (e interrupcoes) publicam amostras
+ * (identificador, valor) sem esperar, e a tarefa do agregador junta varias
+ * amostras em um unico quadro STX, QTD, DADOS, CHK, ETX (o protocolo das
+ * atividades t2 a t4). Um quadro por amostra gastaria 6 bytes de envelope
+ * e cabecalho para 5 de amostra; com TELEMETRIA_POR_QUADRO amostras por
+ * quadro, o envelope fica dividido entre todas e a serial envia muito menos
+ * quadros.
+ *
+ * O quadro e enviado quando tem TELEMETRIA_POR_QUADRO amostras ou quando a
+ * amostra mais antiga fica TELEMETRIA_IDADE marcas esperando, o maior atraso
+ * que a agregacao acrescenta. Os dados do quadro sao:
+ *
+ *   TELEMETRIA_TIPO, indicacoes, {id, valor (int32, little-endian)} ...
+ *
+ * O primeiro byte permite assinar so a telemetria no receptor de quadros
+ * (ReceptorQuadrosAssina).
+ *
+ * Com TELEMETRIA_COMPRIME=1, as amostras de cada quadro sao comprimidas por
+ * diferenca e varint: id, e a diferenca para a amostra anterior do mesmo id
+ * no quadro (a primeira, para 0) em zigue-zague, 7 bits por byte. Leituras
+ * que variam devagar ocupam 2 ou 3 bytes em vez de 5. O quadro comprimido
+ * tem o bit TELEMETRIA_COMPRIMIDO nas indicacoes; o quadro em que a
+ * compressao nao reduz o tamanho sai sem ela. Cada quadro e descomprimido
+ * sozinho (TelemetriaDescomprime, com um compressor iniciado por quadro),
+ * entao a perda de um quadro nao afeta os outros.
+ *
+ * As amostras ficam em um anel de TELEMETRIA_AMOSTRAS posicoes. Quem
+ * publica reserva uma posicao com as interrupcoes desabilitadas por poucas
+ * instrucoes (o Cortex-M0+ nao tem LDREX/STREX), escreve a amostra fora da
+ * regiao atomica e a marca como pronta; o agregador le sem regiao atomica.
+ * A tarefa do agregador so e notificada pela primeira amostra (para contar
+ * a idade) e quando ha amostras para um quadro, nao a cada publicacao.
+ * Com o anel cheio, a amostra e descartada e contada.
+ *
+ * A tarefa e criada pela aplicacao com o corpo TelemetriaExecuta, com
+ * TELEMETRIA_PILHA palavras alem de TAM_MINIMO_PILHA. Ex.:
+ *
+ *   void tarefa_telemetria(void) { TelemetriaExecuta(); }
+ *
+ *   TelemetriaInicia(UartDmaEnvia);
+ *   CriaTarefa(tarefa_telemetria, "Telemetria", pilha, tamanho, 1);
+ *   ...
+ *   TelemetriaPublica(ID_TEMPERATURA, leitura);
+ */
+
+
+#ifndef TELEMETRIA_H_
+#define TELEMETRIA_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* posicoes do anel de amostras (potencia de 2, ate 256) */
+#ifndef TELEMETRIA_AMOSTRAS
+#define TELEMETRIA_AMOSTRAS		32
+#endif
+
+/* amostras por quadro (QTD ate 2 + 5 * amostras, 250 no maximo) */
+#ifndef TELEMETRIA_POR_QUADRO
+#define TELEMETRIA_POR_QUADRO	16
+#endif
+
+/* marcas que a amostra mais antiga espera antes de o quadro sair incompleto */
+#ifndef TELEMETRIA_IDADE
+#define TELEMETRIA_IDADE		(cfg_MARCA_TEMPO_HZ / 2)
+#endif
+
+/* primeiro byte dos dados dos quadros de telemetria */
+#ifndef TELEMETRIA_TIPO
+#define TELEMETRIA_TIPO			0x54
+#endif
+
+/* compressao das amostras nos quadros (1 liga, 0 desliga) */
+#ifndef TELEMETRIA_COMPRIME
+#define TELEMETRIA_COMPRIME		0
+#endif
+
+/* ids diferentes cuja ultima amostra o compressor lembra em um quadro */
+#ifndef TELEMETRIA_HISTORICO
+#define TELEMETRIA_HISTORICO	8
+#endif
+
+/* bytes de cada amostra no quadro, sem e com a compressao (no maximo) */
+#define TELEMETRIA_TAM_AMOSTRA	5
+#define TELEMETRIA_MAIOR_COMPRIMIDA	6
+
+/* indicacoes do quadro (segundo byte dos dados) */
+#define TELEMETRIA_COMPRIMIDO	0x01
+
+/* palavras de pilha da tarefa do agregador, alem de TAM_MINIMO_PILHA */
+#if TELEMETRIA_COMPRIME
+#define TELEMETRIA_PILHA		((2 + TELEMETRIA_POR_QUADRO * (TELEMETRIA_MAIOR_COMPRIMIDA + 5) + 4 + \
+								  TELEMETRIA_HISTORICO * 5 + 3) / 4 + 20)
+#else
+#define TELEMETRIA_PILHA		((2 + TELEMETRIA_POR_QUADRO * TELEMETRIA_TAM_AMOSTRA + 4 + 3) / 4 + 16)
+#endif
+
+#if (TELEMETRIA_AMOSTRAS & (TELEMETRIA_AMOSTRAS - 1)) != 0 || TELEMETRIA_AMOSTRAS > 256
+#error "TELEMETRIA_AMOSTRAS deve ser potencia de 2 ate 256"
+#endif
+#if TELEMETRIA_POR_QUADRO < 1 || TELEMETRIA_POR_QUADRO > 49 || TELEMETRIA_POR_QUADRO > TELEMETRIA_AMOSTRAS
+#error "TELEMETRIA_POR_QUADRO deve estar entre 1 e 49 e caber no anel"
+#endif
+#if TELEMETRIA_HISTORICO < 1 || TELEMETRIA_HISTORICO > 255
+#error "TELEMETRIA_HISTORICO deve estar entre 1 e 255"
+#endif
+
+/* envia os bytes sem esperar: retorna tamanho, ou 0 se nao ha espaco agora
+   (ex.: UartDmaEnvia) */
+typedef uint16_t (*envia_telemetria_t)(const uint8_t *dados, uint16_t tamanho);
+
+/**
+* \struct estatisticas_telemetria_t
+* Contadores do agregador, de 32 bits (voltam a zero ao estourar)
+*/
+
+typedef struct
+{
+	uint32_t	amostras;			///< Amostras publicadas
+	uint32_t	descartadas;		///< Amostras publicadas com o anel cheio
+	uint32_t	quadros;			///< Quadros enviados (amostras / quadros: amostras por quadro)
+	uint32_t	por_idade;			///< Quadros enviados incompletos, pela idade
+	uint32_t	envios_adiados;		///< Tentativas de envio sem espaco na saida
+	uint32_t	notificacoes;		///< Vezes que uma publicacao acordou o agregador
+	uint32_t	bytes_amostras;		///< Bytes das amostras enviadas, sem compressao
+	uint32_t	bytes_enviados;		///< Bytes que elas ocuparam nos quadros (bytes_amostras / bytes_enviados: razao de compressao)
+} estatisticas_telemetria_t;
+
+/**
+* \struct compressor_telemetria_t
+* Estado do compressor (e do descompressor) de um quadro: a ultima amostra
+* de ate TELEMETRIA_HISTORICO ids; um id novo substitui o mais antigo
+*/
+
+typedef struct
+{
+	uint8_t		ids[TELEMETRIA_HISTORICO];
+	int32_t		valores[TELEMETRIA_HISTORICO];
+	uint8_t		usados;				///< Posicoes com um id
+	uint8_t		proxima;			///< Posicao do proximo id novo
+} compressor_telemetria_t;
+
+extern estatisticas_telemetria_t estatisticas_telemetria;
+
+void TelemetriaInicia(envia_telemetria_t envia);
+uint8_t TelemetriaPublica(uint8_t id, int32_t valor);
+void TelemetriaExecuta(void);
+void TelemetriaCompressorInicia(compressor_telemetria_t *c);
+uint8_t TelemetriaComprime(compressor_telemetria_t *c, uint8_t id, int32_t valor, uint8_t *saida);
+uint8_t TelemetriaDescomprime(compressor_telemetria_t *c, const uint8_t *entrada, uint8_t tamanho,
+							  uint8_t *id, int32_t *valor);
+
+#endif /* TELEMETRIA_H_ */
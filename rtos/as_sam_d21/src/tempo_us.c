@@ -0,0 +1,178 @@
+/*
+ * tempo_us.c
+ *
+ * Base de tempo de microssegundos no TC4/TC5 (ver tempo_us.h).
+ */
+
+#include <asf.h>
+#include "tempo_us.h"
+
+#if TEMPO_US
+
+#define TC_US		(TC4->COUNT32)
+
+/* endereco de COUNT no modo de 32 bits, para a leitura continua */
+#define ENDERECO_COUNT		0x10
+
+/* agendados, do proximo disparo ao ultimo */
+static alarme_us_t *alarmes = 0;
+
+/* liga o contador; a partir dai TempoUs conta e os alarmes disparam */
+void TempoUsInicia(void)
+{
+	PM->APBCMASK.reg |= PM_APBCMASK_TC4 | PM_APBCMASK_TC5;
+
+	/* OSC8M (8MHz / 2^PRESC) dividido ate 1MHz, sem depender do clock da CPU */
+	GCLK->GENDIV.reg = GCLK_GENDIV_ID(TEMPO_US_GERADOR) | GCLK_GENDIV_DIV(8u >> SYSCTRL->OSC8M.bit.PRESC);
+	GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(TEMPO_US_GERADOR) | GCLK_GENCTRL_SRC_OSC8M | GCLK_GENCTRL_GENEN;
+	while(GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY) {}
+	GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(TC4_GCLK_ID) | GCLK_CLKCTRL_GEN(TEMPO_US_GERADOR) | GCLK_CLKCTRL_CLKEN;
+
+	TC_US.CTRLA.reg = TC_CTRLA_SWRST;
+	while(TC_US.CTRLA.reg & TC_CTRLA_SWRST) {}
+
+	/* 32 bits (TC5 escravo do TC4), contagem livre ate 0xFFFFFFFF */
+	TC_US.CTRLA.reg = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_WAVEGEN_NFRQ | TC_CTRLA_PRESCALER_DIV1;
+
+	/* COUNT sincronizado continuamente: a leitura nao espera */
+	TC_US.READREQ.reg = TC_READREQ_RREQ | TC_READREQ_RCONT | TC_READREQ_ADDR(ENDERECO_COUNT);
+
+	NVIC_SetPriority(TC4_IRQn, TEMPO_US_PRIORIDADE);
+	NVIC_EnableIRQ(TC4_IRQn);
+
+	TC_US.CTRLA.reg |= TC_CTRLA_ENABLE;
+	while(TC_US.STATUS.reg & TC_STATUS_SYNCBUSY) {}
+}
+
+/* instante atual em us, atrasado de ~3us pela sincronizacao */
+uint32_t TempoUs(void)
+{
+	return TC_US.COUNT.reg;
+}
+
+/* programa o comparador para o primeiro agendado ou desliga a interrupcao.
+   Retorna 1 se o primeiro esta perto demais e deve disparar ja. Com as
+   interrupcoes desabilitadas */
+static uint8_t ProgramaComparador(void)
+{
+	if(alarmes == 0)
+	{
+		TC_US.INTENCLR.reg = TC_INTENCLR_MC0;
+		return 0;
+	}
+	if((int32_t)(alarmes->instante - TempoUs()) <= TEMPO_US_MARGEM)
+	{
+		return 1;
+	}
+	TC_US.CC[0].reg = alarmes->instante;
+	while(TC_US.STATUS.reg & TC_STATUS_SYNCBUSY) {}
+	TC_US.INTFLAG.reg = TC_INTFLAG_MC0;
+	TC_US.INTENSET.reg = TC_INTENSET_MC0;
+	return 0;
+}
+
+/* dispara os alarmes vencidos, esperando o instante exato dos que estao a
+   menos de TEMPO_US_MARGEM, e reprograma o comparador */
+static void DisparaAlarmes(void)
+{
+	reg_atomica_t estado;
+	alarme_us_t *alarme;
+
+	for(;;)
+	{
+		REG_ATOMICA_INICIO(estado);
+		if(!ProgramaComparador())
+		{
+			REG_ATOMICA_FIM(estado);
+			return;
+		}
+		alarme = alarmes;
+		alarmes = alarme->proximo;
+		alarme->agendado = 0;
+		REG_ATOMICA_FIM(estado);
+
+		while((int32_t)(alarme->instante - TempoUs()) > 0) {}
+		alarme->funcao(alarme->arg);
+	}
+}
+
+/* agenda funcao(arg) para o instante (em TempoUs, no maximo 2^31 us
+   adiante), na interrupcao do comparador, ou ja na chamada se faltam menos
+   de TEMPO_US_MARGEM. Um alarme ja agendado e reagendado. O alarme deve
+   continuar valido ate disparar ou ser cancelado */
+void TempoUsAgenda(alarme_us_t *alarme, uint32_t instante, funcao_alarme_us_t funcao, void *arg)
+{
+	reg_atomica_t estado;
+	alarme_us_t **p;
+
+	(void)TempoUsCancela(alarme);
+	alarme->instante = instante;
+	alarme->funcao = funcao;
+	alarme->arg = arg;
+
+	REG_ATOMICA_INICIO(estado);
+	for(p = &alarmes; *p != 0 && (int32_t)((*p)->instante - instante) <= 0; p = &(*p)->proximo) {}
+	alarme->proximo = *p;
+	*p = alarme;
+	alarme->agendado = 1;
+	REG_ATOMICA_FIM(estado);
+
+	/* o primeiro mudou: reprograma, ou dispara se ja esta perto */
+	if(alarmes == alarme)
+	{
+		DisparaAlarmes();
+	}
+}
+
+/* retira o alarme da lista. Retorna 1 se ele ainda nao tinha disparado */
+uint8_t TempoUsCancela(alarme_us_t *alarme)
+{
+	reg_atomica_t estado;
+	alarme_us_t **p;
+	uint8_t agendado = 0;
+
+	REG_ATOMICA_INICIO(estado);
+	for(p = &alarmes; *p != 0; p = &(*p)->proximo)
+	{
+		if(*p == alarme)
+		{
+			*p = alarme->proximo;
+			alarme->agendado = 0;
+			agendado = 1;
+			break;
+		}
+	}
+	REG_ATOMICA_FIM(estado);
+
+	return agendado;
+}
+
+static void LiberaEspera(void *arg)
+{
+	SemaforoLiberaISR((semaforo_t *)arg);
+}
+
+/* espera us microssegundos: ativa ate TEMPO_US_ESPERA_ATIVA, e acima disso
+   bloqueando a tarefa ate o alarme (a volta depende da prioridade dela) */
+void TempoUsEspera(uint32_t us)
+{
+	uint32_t fim = TempoUs() + us;
+	semaforo_t espera = {0,0};
+	alarme_us_t alarme;
+
+	if(us <= TEMPO_US_ESPERA_ATIVA)
+	{
+		while((int32_t)(fim - TempoUs()) > 0) {}
+		return;
+	}
+	TempoUsAgenda(&alarme, fim, LiberaEspera, &espera);
+	SemaforoAguarda(&espera);
+}
+
+void TC4_Handler(void)
+{
+	TC_US.INTFLAG.reg = TC_INTFLAG_MC0;
+	DisparaAlarmes();
+}
+
+#endif /* TEMPO_US */
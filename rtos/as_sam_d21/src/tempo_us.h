@@ -0,0 +1,76 @@
+/*
+ * tempo_us.h
+ *
+ * Base de tempo de microssegundos: TC4 e TC5 encadeados em um contador de
+ * 32 bits, livre, a 1MHz (OSC8M dividido ate 1MHz no gerador
+ * TEMPO_US_GERADOR), independente da marca de tempo e dos perfis de clock.
+ * O divisor segue o divisor do OSC8M no momento de TempoUsInicia, chamada
+ * depois da inicializacao dos clocks.
+ * Da instantes em us (TempoUs), alarmes de um disparo com callback no
+ * comparador CC0 (ex.: timeouts de protocolo menores que uma marca) e
+ * esperas curtas e precisas das tarefas, sem subir cfg_MARCA_TEMPO_HZ.
+ * O contador volta a 0 apos ~71 minutos: compare instantes pela diferenca.
+ *
+ * A precisao e a do OSC8M (~2% na faixa de temperatura). Com
+ * cfg_RASTRO_TEMPO (conf_rtos.h), o rastro do nucleo usa estes instantes.
+ *
+ * Ligado com TEMPO_US=1 nos simbolos do projeto. Ex.:
+ *
+ *   TempoUsInicia();
+ *   TempoUsAgenda(&alarme, TempoUs() + 250, FimDoQuadro, &rx);
+ *   TempoUsEspera(40);					bloqueia a tarefa por 40us
+ */
+
+
+#ifndef TEMPO_US_H_
+#define TEMPO_US_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef TEMPO_US
+#define TEMPO_US				0
+#endif
+
+/* gerador de clock do TC4/TC5, com o OSC8M dividido por 8 */
+#ifndef TEMPO_US_GERADOR
+#define TEMPO_US_GERADOR		4
+#endif
+
+/* prioridade da interrupcao do comparador (0 mais alta, 3 mais baixa) */
+#ifndef TEMPO_US_PRIORIDADE
+#define TEMPO_US_PRIORIDADE		1
+#endif
+
+/* alarmes a menos que isto do disparo esperam o instante exato na propria
+   interrupcao, em vez de no comparador: cobre a sincronizacao da escrita
+   do CC0 (~3 ciclos do TC) */
+#ifndef TEMPO_US_MARGEM
+#define TEMPO_US_MARGEM			10
+#endif
+
+/* TempoUsEspera: esperas ate este tempo sao ativas, sem trocar de tarefa */
+#ifndef TEMPO_US_ESPERA_ATIVA
+#define TEMPO_US_ESPERA_ATIVA	30
+#endif
+
+/* executada na interrupcao do comparador: so deve sinalizar (ex.:
+   SemaforoLiberaISR, TarefaNotifica) */
+typedef void (*funcao_alarme_us_t)(void *arg);
+
+typedef struct alarme_us
+{
+	uint32_t				instante;		///< disparo, em TempoUs
+	funcao_alarme_us_t		funcao;
+	void					*arg;
+	struct alarme_us		*proximo;		///< lista dos agendados, por instante
+	volatile uint8_t		agendado;
+} alarme_us_t;
+
+void TempoUsInicia(void);
+uint32_t TempoUs(void);
+void TempoUsAgenda(alarme_us_t *alarme, uint32_t instante, funcao_alarme_us_t funcao, void *arg);
+uint8_t TempoUsCancela(alarme_us_t *alarme);
+void TempoUsEspera(uint32_t us);
+
+#endif /* TEMPO_US_H_ */
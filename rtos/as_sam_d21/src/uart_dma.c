@@ -0,0 +1,451 @@
+/*
+ * uart_dma.c
+ *
+ * Recepcao serial por DMA na SERCOM da porta serial virtual do EDBG.
+ *
+ * O canal do DMAC copia cada byte recebido (gatilho RXC da SERCOM) para a
+ * area de recepcao, dividida em dois blocos. Os dois descritores apontam um
+ * para o outro, entao a recepcao nunca para: enquanto o DMAC grava um bloco,
+ * a tarefa processa o outro. O fim de cada bloco gera a unica interrupcao,
+ * que libera o semaforo aguardado por UartDmaRecebe. A posicao de escrita
+ * dentro do bloco atual e lida do contador de transferencia do DMAC, o que
+ * permite entregar os bytes de um quadro curto quando a linha fica ociosa.
+ *
+ * Na transmissao, cada mensagem reserva seu espaco no anel de envio com as
+ * interrupcoes desabilitadas por poucas instrucoes (o Cortex-M0+ nao tem
+ * LDREX/STREX) e e copiada com as interrupcoes habilitadas. Os bytes so
+ * ficam visiveis ao DMAC quando todas as copias em andamento terminam, entao
+ * uma tarefa interrompida no meio da copia atrasa o envio, mas nunca bloqueia
+ * as outras. O DMAC envia o trecho publicado e, no fim de cada trecho, a
+ * interrupcao inicia o seguinte. Um trecho que passa do fim do anel usa dois
+ * descritores encadeados, sem interrupcao entre eles. No fim de um trecho a
+ * USART ainda tem um byte em DATA e outro no registrador de deslocamento,
+ * entao o trecho seguinte comeca antes de a linha ficar ociosa.
+ *
+ * UartDmaReserva entrega o espaco reservado ao chamador, que monta a
+ * mensagem direto no anel (sem a copia de UartDmaEnvia) enquanto o DMAC
+ * envia as anteriores. Esse espaco precisa ser contiguo: se a mensagem nao
+ * cabe antes do fim do anel, o resto do anel e reservado como um salto, que
+ * o DMAC pula.
+ */
+
+#include <asf.h>
+#include <string.h>
+#include "dma.h"
+#include "perfil_clock.h"
+#include "pinos.h"
+#include "uart_dma.h"
+
+#if defined(OTIMIZA_DESEMPENHO) && OTIMIZA_DESEMPENHO
+#pragma GCC optimize ("O2")
+#endif
+
+#define TAM_AREA		(2 * UART_DMA_TAM_BLOCO)
+
+/* descritor do segundo bloco, encadeado ao primeiro descritor do canal 
+   (dma_descritores). Alinhado em 128 bits */
+COMPILER_ALIGNED(16) static DmacDescriptor descritor_segundo_bloco;
+
+NAO_INICIALIZADA static uint8_t area_recepcao[TAM_AREA];
+
+/* posicoes em bytes desde o inicio da recepcao. Retornam a 0 sem problemas,
+   porque TAM_AREA e potencia de 2 */
+static volatile uint32_t blocos_completos = 0;
+static uint32_t posicao_leitura = 0;
+static uint32_t ultima_escrita = 0;
+static uint32_t bytes_perdidos = 0;
+static uint8_t resto_pendente = 0;		/* a ultima entrega parou no fim da area */
+static uint32_t baud_uart;
+
+static semaforo_t SemaforoBlocos = {0,0};
+
+NAO_INICIALIZADA static uint8_t area_envio[UART_DMA_TAM_ENVIO];
+
+/* descritor do inicio do anel, encadeado ao primeiro descritor do canal de
+   envio quando o trecho passa do fim do anel */
+COMPILER_ALIGNED(16) static DmacDescriptor descritor_envio_volta;
+
+/* posicoes em bytes no anel de envio, desde o inicio. reservado >= publicado
+   >= enviado, e reservado - enviado nunca passa de UART_DMA_TAM_ENVIO */
+static uint32_t envio_reservado = 0;		/* ja reservado pelas mensagens */
+static uint32_t envio_publicado = 0;		/* ja copiado, visivel ao DMAC */
+static volatile uint32_t envio_enviado = 0;	/* ja transmitido pelo DMAC */
+static uint16_t envio_em_curso = 0;			/* bytes do trecho atual do DMAC, 0 parado */
+/* fim do anel pulado por UartDmaReserva: posicao e bytes (0, nenhum). Ha no
+   maximo um, pois as reservas pendentes nunca passam de UART_DMA_TAM_ENVIO */
+static uint32_t envio_salto_inicio = 0;
+static uint16_t envio_salto = 0;
+static uint8_t copias_em_andamento = 0;
+static uint8_t uart_iniciada = 0;
+static uint32_t bytes_descartados = 0;
+
+/* bytes ja gravados pelo DMAC. Chamada com as interrupcoes desabilitadas.
+   Pode ficar para tras, se o bloco terminar durante a leitura, mas nunca a
+   frente dos bytes realmente recebidos */
+static uint32_t PosicaoEscrita(void)
+{
+	uint32_t blocos, restante;
+
+	DMAC->CHID.reg = UART_DMA_CANAL;
+	blocos = blocos_completos;
+	if(DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL)
+	{
+		blocos++;		/* bloco terminado, interrupcao ainda pendente */
+	}
+
+	restante = DmaRestante(UART_DMA_CANAL);
+
+	/* restante = 0 e o fim do bloco ja contado em blocos */
+	return (blocos * UART_DMA_TAM_BLOCO) + ((UART_DMA_TAM_BLOCO - restante) % UART_DMA_TAM_BLOCO);
+}
+
+/* interrupcao de fim de bloco do canal, chamada pelo DMAC_Handler */
+static void FimDeBloco(void)
+{
+	if(DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL)
+	{
+		DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+		blocos_completos++;
+		SemaforoLiberaISR(&SemaforoBlocos);
+	}
+}
+
+/* inicia o DMAC no proximo trecho contiguo publicado, se estiver parado.
+   Chamada com as interrupcoes desabilitadas ou pelo DMAC_Handler */
+static void IniciaEnvio(void)
+{
+	DmacDescriptor *d = &dma_descritores[UART_DMA_CANAL_ENVIO];
+	uint32_t inicio, quantidade, primeira_parte;
+
+	if(envio_em_curso != 0 || envio_publicado == envio_enviado || !uart_iniciada)
+	{
+		return;
+	}
+
+	/* o salto e publicado junto com a mensagem que vem depois dele */
+	if(envio_salto != 0 && envio_enviado == envio_salto_inicio)
+	{
+		envio_enviado += envio_salto;
+		envio_salto = 0;
+	}
+	quantidade = envio_publicado - envio_enviado;
+	if(envio_salto != 0 && envio_salto_inicio - envio_enviado < quantidade)
+	{
+		quantidade = envio_salto_inicio - envio_enviado;	/* ate o salto */
+	}
+	if(quantidade == 0)
+	{
+		return;
+	}
+	envio_em_curso = (uint16_t)quantidade;
+
+	/* origem incrementada: o endereco e o do fim do trecho. Passando do fim
+	   do anel, o inicio do anel vai no descritor encadeado, e so ele
+	   interrompe */
+	inicio = envio_enviado % UART_DMA_TAM_ENVIO;
+	primeira_parte = UART_DMA_TAM_ENVIO - inicio;
+	if(quantidade > primeira_parte)
+	{
+		d->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+						DMAC_BTCTRL_BLOCKACT_NOACT;
+		d->BTCNT.reg = (uint16_t)primeira_parte;
+		d->SRCADDR.reg = (uint32_t)&area_envio[UART_DMA_TAM_ENVIO];
+		d->DESCADDR.reg = (uint32_t)&descritor_envio_volta;
+		descritor_envio_volta.BTCNT.reg = (uint16_t)(quantidade - primeira_parte);
+		descritor_envio_volta.SRCADDR.reg = (uint32_t)&area_envio[quantidade - primeira_parte];
+	}
+	else
+	{
+		d->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+						DMAC_BTCTRL_BLOCKACT_INT;
+		d->BTCNT.reg = (uint16_t)quantidade;
+		d->SRCADDR.reg = (uint32_t)&area_envio[inicio + quantidade];
+		d->DESCADDR.reg = 0;
+	}
+
+	DMAC->CHID.reg = UART_DMA_CANAL_ENVIO;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+}
+
+/* interrupcao de fim de trecho da transmissao, chamada pelo DMAC_Handler */
+static void FimDeEnvio(void)
+{
+	if(DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL)
+	{
+		DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+		envio_enviado += envio_em_curso;
+		envio_em_curso = 0;
+		IniciaEnvio();
+	}
+}
+
+/* taxa com sobreamostragem de 16x: BAUD = 65536 * (1 - 16 * baud / clock).
+   O clock deve ser de pelo menos 16 * baud */
+static uint16_t ValorBaud(uint32_t clock_hz)
+{
+	return (uint16_t)(65536UL - (uint32_t)(((uint64_t)65536UL * 16 * baud_uart) / clock_hz));
+}
+
+/* recalcula a taxa apos uma troca de perfil de clock (gancho de 
+   perfil_clock.c). BAUD so pode ser escrito com a USART desabilitada: um 
+   byte em transito durante a troca pode ser perdido */
+static void AjustaBaud(uint32_t clock_hz)
+{
+	SercomUsart *const usart = &(EDBG_CDC_MODULE->USART);
+
+	usart->CTRLA.reg &= ~SERCOM_USART_CTRLA_ENABLE;
+	while(usart->SYNCBUSY.reg & SERCOM_USART_SYNCBUSY_ENABLE) {}
+	usart->BAUD.reg = ValorBaud(clock_hz);
+	usart->CTRLA.reg |= SERCOM_USART_CTRLA_ENABLE;
+	while(usart->SYNCBUSY.reg & SERCOM_USART_SYNCBUSY_ENABLE) {}
+}
+
+/* configura a SERCOM no modo USART (8 bits, sem paridade, 1 bit de parada)
+   e o canal do DMAC, e inicia a recepcao */
+void UartDmaInicia(uint32_t baud)
+{
+	struct system_gclk_chan_config config_clock;
+#if !PINOS_TABELA
+	struct system_pinmux_config config_pino;
+#endif
+	SercomUsart *const usart = &(EDBG_CDC_MODULE->USART);
+	reg_atomica_t estado;
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_SERCOM3);
+
+	/* clock da SERCOM: gerador 0, o mesmo da CPU (PerfilClockHz) */
+	system_gclk_chan_get_config_defaults(&config_clock);
+	config_clock.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(SERCOM3_GCLK_ID_CORE, &config_clock);
+	system_gclk_chan_enable(SERCOM3_GCLK_ID_CORE);
+
+#if !PINOS_TABELA
+	/* pinos: PAD0 transmite, PAD1 recebe (com PINOS_TABELA, ja configurados
+	   na partida, pinos.h) */
+	system_pinmux_get_config_defaults(&config_pino);
+	config_pino.mux_position = EDBG_CDC_SERCOM_PINMUX_PAD0 & 0xFFFF;
+	config_pino.direction = SYSTEM_PINMUX_PIN_DIR_OUTPUT;
+	system_pinmux_pin_set_config(EDBG_CDC_SERCOM_PINMUX_PAD0 >> 16, &config_pino);
+	config_pino.mux_position = EDBG_CDC_SERCOM_PINMUX_PAD1 & 0xFFFF;
+	config_pino.direction = SYSTEM_PINMUX_PIN_DIR_INPUT;
+	system_pinmux_pin_set_config(EDBG_CDC_SERCOM_PINMUX_PAD1 >> 16, &config_pino);
+#endif
+
+	usart->CTRLA.reg = SERCOM_USART_CTRLA_SWRST;
+	while(usart->SYNCBUSY.reg & SERCOM_USART_SYNCBUSY_SWRST) {}
+
+	usart->CTRLA.reg = SERCOM_USART_CTRLA_MODE_USART_INT_CLK | SERCOM_USART_CTRLA_DORD |
+						SERCOM_USART_CTRLA_RXPO(1) | SERCOM_USART_CTRLA_TXPO(0);
+	usart->CTRLB.reg = SERCOM_USART_CTRLB_RXEN | SERCOM_USART_CTRLB_TXEN | SERCOM_USART_CTRLB_CHSIZE(0);
+	while(usart->SYNCBUSY.reg & SERCOM_USART_SYNCBUSY_CTRLB) {}
+
+	baud_uart = baud;
+	usart->BAUD.reg = ValorBaud(PerfilClockHz());
+
+	/* dois blocos encadeados em anel, com interrupcao no fim de cada um.
+	   O endereco de destino e o do fim do bloco (destino incrementado) */
+	dma_descritores[UART_DMA_CANAL].BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+											DMAC_BTCTRL_DSTINC | DMAC_BTCTRL_BLOCKACT_INT;
+	dma_descritores[UART_DMA_CANAL].BTCNT.reg = UART_DMA_TAM_BLOCO;
+	dma_descritores[UART_DMA_CANAL].SRCADDR.reg = (uint32_t)&usart->DATA.reg;
+	dma_descritores[UART_DMA_CANAL].DSTADDR.reg = (uint32_t)&area_recepcao[UART_DMA_TAM_BLOCO];
+	dma_descritores[UART_DMA_CANAL].DESCADDR.reg = (uint32_t)&descritor_segundo_bloco;
+
+	descritor_segundo_bloco = dma_descritores[UART_DMA_CANAL];
+	descritor_segundo_bloco.DSTADDR.reg = (uint32_t)&area_recepcao[TAM_AREA];
+	descritor_segundo_bloco.DESCADDR.reg = (uint32_t)&dma_descritores[UART_DMA_CANAL];
+
+	DmaIniciaControlador();
+	DmaRegistraTratador(UART_DMA_CANAL, FimDeBloco);
+
+	DMAC->CHID.reg = UART_DMA_CANAL;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while(DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST) {}
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(EDBG_CDC_SERCOM_DMAC_ID_RX) |
+						DMAC_CHCTRLB_TRIGACT_BEAT;
+	DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+
+	/* transmissao: um ou dois blocos por trecho, o canal para no fim de cada
+	   trecho (BTCTRL, BTCNT e a origem em IniciaEnvio) */
+	dma_descritores[UART_DMA_CANAL_ENVIO].DSTADDR.reg = (uint32_t)&usart->DATA.reg;
+	dma_descritores[UART_DMA_CANAL_ENVIO].DESCADDR.reg = 0;
+	descritor_envio_volta.BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+										DMAC_BTCTRL_BLOCKACT_INT;
+	descritor_envio_volta.DSTADDR.reg = (uint32_t)&usart->DATA.reg;
+	descritor_envio_volta.DESCADDR.reg = 0;
+	DmaRegistraTratador(UART_DMA_CANAL_ENVIO, FimDeEnvio);
+
+	DMAC->CHID.reg = UART_DMA_CANAL_ENVIO;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while(DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST) {}
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(EDBG_CDC_SERCOM_DMAC_ID_TX) |
+						DMAC_CHCTRLB_TRIGACT_BEAT;
+	DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+
+	usart->CTRLA.reg |= SERCOM_USART_CTRLA_ENABLE;
+	while(usart->SYNCBUSY.reg & SERCOM_USART_SYNCBUSY_ENABLE) {}
+
+	(void)PerfilClockRegistraGancho(AjustaBaud);
+
+	/* envia o que foi escrito antes da UART ser iniciada */
+	REG_ATOMICA_INICIO(estado);
+	uart_iniciada = 1;
+	IniciaEnvio();
+	REG_ATOMICA_FIM(estado);
+}
+
+/* aguarda um bloco cheio, ou o fim de uma rajada (linha ociosa), e retorna
+   em *dados e no valor de retorno os bytes recebidos ainda nao entregues,
+   contiguos na area de recepcao. Os dados ficam validos ate o DMAC voltar
+   a eles, pelo menos o tempo de receber um bloco: a tarefa deve processa-los
+   antes disso. Bytes sobrescritos sao contados em UartDmaPerdidos */
+uint16_t UartDmaRecebe(const uint8_t **dados)
+{
+	reg_atomica_t estado;
+	uint32_t escrita, quantidade, inicio;
+	uint8_t bloco_cheio;
+
+	for(;;)
+	{
+		/* o restante de uma entrega dividida no fim da area nao espera */
+		bloco_cheio = resto_pendente || SemaforoAguardaTempo(&SemaforoBlocos, UART_DMA_MARCAS_OCIOSA);
+
+		REG_ATOMICA_INICIO(estado);
+		escrita = PosicaoEscrita();
+		REG_ATOMICA_FIM(estado);
+
+		/* entrega ao fim de um bloco ou se nada chegou durante a espera */
+		if((int32_t)(escrita - posicao_leitura) > 0 && (bloco_cheio || escrita == ultima_escrita))
+		{
+			break;
+		}
+		ultima_escrita = escrita;
+	}
+	ultima_escrita = escrita;
+
+	quantidade = escrita - posicao_leitura;
+	if(quantidade > TAM_AREA)
+	{
+		/* a tarefa atrasou mais de um bloco: os mais antigos foram sobrescritos */
+		bytes_perdidos += quantidade - UART_DMA_TAM_BLOCO;
+		posicao_leitura = escrita - UART_DMA_TAM_BLOCO;
+		quantidade = UART_DMA_TAM_BLOCO;
+	}
+
+	inicio = posicao_leitura % TAM_AREA;
+	resto_pendente = (inicio + quantidade > TAM_AREA);
+	if(resto_pendente)
+	{
+		quantidade = TAM_AREA - inicio;	/* o restante vai na proxima chamada */
+	}
+
+	*dados = &area_recepcao[inicio];
+	posicao_leitura += quantidade;
+	return (uint16_t)quantidade;
+}
+
+/* bytes perdidos porque a tarefa nao os leu a tempo */
+uint32_t UartDmaPerdidos(void)
+{
+	return bytes_perdidos;
+}
+
+/* copia a mensagem para o anel de envio e retorna sem esperar a UART. 
+   Pode ser chamada por varias tarefas, inclusive antes de UartDmaInicia 
+   (os bytes saem quando a UART for iniciada), mas nao por interrupcoes. 
+   Retorna o tamanho, ou 0 se a mensagem nao coube e foi descartada */
+uint16_t UartDmaEnvia(const uint8_t *dados, uint16_t tamanho)
+{
+	reg_atomica_t estado;
+	uint32_t inicio, primeira_parte;
+
+	if(tamanho == 0)
+	{
+		return 0;
+	}
+
+	REG_ATOMICA_INICIO(estado);
+	if(tamanho > UART_DMA_TAM_ENVIO - (envio_reservado - envio_enviado))
+	{
+		bytes_descartados += tamanho;
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	inicio = envio_reservado % UART_DMA_TAM_ENVIO;
+	envio_reservado += tamanho;
+	copias_em_andamento++;
+	REG_ATOMICA_FIM(estado);
+
+	/* a copia pode ser interrompida: o espaco ja e desta mensagem */
+	primeira_parte = UART_DMA_TAM_ENVIO - inicio;
+	if(primeira_parte >= tamanho)
+	{
+		memcpy(&area_envio[inicio], dados, tamanho);
+	}
+	else
+	{
+		memcpy(&area_envio[inicio], dados, primeira_parte);
+		memcpy(area_envio, dados + primeira_parte, tamanho - primeira_parte);
+	}
+
+	UartDmaConclui();
+	return tamanho;
+}
+
+/* reserva tamanho bytes contiguos no anel de envio e retorna o endereco,
+   para a mensagem ser montada ali sem copia (ex.: o codificador de quadros
+   escrevendo direto no anel enquanto o DMAC envia o quadro anterior). Cada
+   reserva termina com UartDmaConclui, na mesma tarefa; as mensagens saem na
+   ordem das reservas. Retorna 0, sem esperar, se nao ha espaco agora */
+uint8_t *UartDmaReserva(uint16_t tamanho)
+{
+	reg_atomica_t estado;
+	uint32_t inicio, salto;
+
+	if(tamanho == 0 || tamanho > UART_DMA_TAM_ENVIO)
+	{
+		return 0;
+	}
+
+	REG_ATOMICA_INICIO(estado);
+	inicio = envio_reservado % UART_DMA_TAM_ENVIO;
+	salto = (inicio + tamanho > UART_DMA_TAM_ENVIO) ? UART_DMA_TAM_ENVIO - inicio : 0;
+	if(salto + tamanho > UART_DMA_TAM_ENVIO - (envio_reservado - envio_enviado))
+	{
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	if(salto != 0)
+	{
+		envio_salto_inicio = envio_reservado;
+		envio_salto = (uint16_t)salto;
+		inicio = 0;
+	}
+	envio_reservado += salto + tamanho;
+	copias_em_andamento++;
+	REG_ATOMICA_FIM(estado);
+
+	return &area_envio[inicio];
+}
+
+/* termina uma reserva (UartDmaReserva ou a copia de UartDmaEnvia). A
+   ultima em andamento publica todas as reservas ja escritas para o DMAC */
+void UartDmaConclui(void)
+{
+	reg_atomica_t estado;
+
+	REG_ATOMICA_INICIO(estado);
+	if(--copias_em_andamento == 0)
+	{
+		envio_publicado = envio_reservado;
+		IniciaEnvio();
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+/* bytes descartados porque a mensagem nao coube no anel de envio */
+uint32_t UartDmaDescartados(void)
+{
+	return bytes_descartados;
+}
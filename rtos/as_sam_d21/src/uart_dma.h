@@ -0,0 +1,76 @@
+/*
+ * uart_dma.h
+ *
+ * Recepcao serial por DMA na SERCOM da porta serial virtual do EDBG
+ * (SAM D21 Xplained Pro). O DMAC grava os bytes recebidos em dois blocos
+ * circulares, sem interrupcao por byte: so ha uma interrupcao a cada bloco
+ * cheio. Os bytes de um bloco incompleto sao entregues quando a linha fica
+ * ociosa por UART_DMA_MARCAS_OCIOSA marcas de tempo.
+ *
+ * A transmissao tambem e por DMA, a partir de um anel de envio: quem envia
+ * (ex.: printf, pelo _write de syscalls.c) so copia os bytes para o anel e
+ * nunca espera a UART. Uma mensagem que nao cabe no anel e descartada
+ * inteira e contada em UartDmaDescartados. Os trechos sao encadeados sem
+ * pausa na linha, entao quadros seguidos saem na taxa da serial.
+ *
+ * Para montar a mensagem direto no anel, sem a copia, enquanto o DMAC envia
+ * as anteriores:
+ *
+ *   uint8_t *p = UartDmaReserva(5 + qtd);
+ *   if(p != 0)
+ *   {
+ *       monta STX, QTD, dados, CHK, ETX em p
+ *       UartDmaConclui();
+ *   }
+ */
+
+
+#ifndef UART_DMA_H_
+#define UART_DMA_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* tamanho de cada um dos dois blocos de recepcao, em bytes (potencia de 2) */
+#ifndef UART_DMA_TAM_BLOCO
+#define UART_DMA_TAM_BLOCO		64
+#endif
+
+/* marcas de tempo sem nenhum byte novo para considerar a linha ociosa e
+   entregar o bloco incompleto */
+#ifndef UART_DMA_MARCAS_OCIOSA
+#define UART_DMA_MARCAS_OCIOSA	2
+#endif
+
+/* canal do DMAC usado na recepcao (menor que DMA_NUMERO_CANAIS, dma.h) */
+#ifndef UART_DMA_CANAL
+#define UART_DMA_CANAL			0
+#endif
+
+/* tamanho do anel de envio, em bytes (potencia de 2) */
+#ifndef UART_DMA_TAM_ENVIO
+#define UART_DMA_TAM_ENVIO		256
+#endif
+
+/* canal do DMAC usado na transmissao. Com o mesmo nivel de prioridade, o
+   canal de numero menor (recepcao) e atendido primeiro */
+#ifndef UART_DMA_CANAL_ENVIO
+#define UART_DMA_CANAL_ENVIO	2
+#endif
+
+#if (UART_DMA_TAM_BLOCO & (UART_DMA_TAM_BLOCO - 1)) != 0
+#error "UART_DMA_TAM_BLOCO deve ser potencia de 2"
+#endif
+#if (UART_DMA_TAM_ENVIO & (UART_DMA_TAM_ENVIO - 1)) != 0
+#error "UART_DMA_TAM_ENVIO deve ser potencia de 2"
+#endif
+
+void UartDmaInicia(uint32_t baud);
+uint16_t UartDmaRecebe(const uint8_t **dados);
+uint32_t UartDmaPerdidos(void);
+uint16_t UartDmaEnvia(const uint8_t *dados, uint16_t tamanho);
+uint8_t *UartDmaReserva(uint16_t tamanho);
+void UartDmaConclui(void);
+uint32_t UartDmaDescartados(void);
+
+#endif /* UART_DMA_H_ */
@@ -0,0 +1,718 @@
+/*
+ * usb_cdc.c
+ *
+ * Dispositivo USB CDC ACM minimo, direto nos registradores (sem a pilha USB
+ * da ASF): ponto de acesso 0 de controle, 1 bulk de saida do PC, 2 bulk de
+ * entrada no PC e 3 de interrupcao, so declarado (nunca envia
+ * notificacoes).
+ *
+ * O controlador USB le e grava os pacotes direto na RAM, pelos descritores
+ * de banco (descritores_ep): cada transferencia bulk e programada com o
+ * endereco e o tamanho do buffer inteiro (varios pacotes) e gera uma unica
+ * interrupcao, no fim do buffer ou no primeiro pacote curto.
+ *
+ * O SAMD21 nao alterna bancos (ping-pong) nos pontos de acesso do modo
+ * dispositivo: cada sentido usa um so banco, e a alternancia e feita aqui,
+ * com dois buffers. A interrupcao de fim de recepcao ja arma o outro buffer,
+ * se a tarefa o devolveu; senao, o banco fica cheio e a USB responde NAK ao
+ * PC, que repete o pacote mais tarde. Na transmissao, as mensagens vao para
+ * o anel de envio (reservado sob regiao atomica, como em uart_dma.c) e a
+ * interrupcao USB copia o anel para os buffers de envio alinhados: o
+ * seguinte e preparado enquanto o atual e transmitido. UsbCdcEnvia so
+ * publica os bytes e marca a interrupcao USB como pendente, entao a copia
+ * nunca e feita com as interrupcoes desabilitadas.
+ */
+
+#include <asf.h>
+#include <string.h>
+#include "usb_cdc.h"
+#include "pinos.h"
+
+#if USB_CDC
+
+#if INICIO_CLOCKS != 2
+#error "USB_CDC exige a DFLL em malha fechada com o XOSC32K (INICIO_CLOCKS 2)"
+#endif
+
+#define EP_CONTROLE				0
+#define EP_SAIDA				1		/* bulk, do PC para o dispositivo */
+#define EP_ENTRADA				2		/* bulk, do dispositivo para o PC */
+#define EP_NOTIFICACAO			3
+#define NUM_EPS					4
+
+#define TAM_PACOTE				64
+#define TAM_PACOTE_NOTIFICACAO	8
+#define PCKSIZE_64				USB_DEVICE_PCKSIZE_SIZE(3)
+
+#define TAM_CONTROLE			128		/* maior resposta do ponto de acesso 0 */
+
+/* requisicoes padrao e da classe CDC */
+#define REQ_GET_STATUS			0x00
+#define REQ_CLEAR_FEATURE		0x01
+#define REQ_SET_ADDRESS			0x05
+#define REQ_GET_DESCRIPTOR		0x06
+#define REQ_GET_CONFIGURATION	0x08
+#define REQ_SET_CONFIGURATION	0x09
+#define REQ_SET_INTERFACE		0x0B
+#define REQ_SET_LINE_CODING		0x20
+#define REQ_GET_LINE_CODING		0x21
+#define REQ_SET_CONTROL_LINE_STATE	0x22
+#define REQ_SEND_BREAK			0x23
+
+#define DESC_DISPOSITIVO		1
+#define DESC_CONFIGURACAO		2
+#define DESC_TEXTO				3
+
+/* estados dos buffers de recepcao */
+#define LIVRE					0
+#define ENCHENDO				1
+#define CHEIO					2
+#define ENTREGUE				3
+
+static const uint8_t descritor_dispositivo[] =
+{
+	18, DESC_DISPOSITIVO, 0x00, 0x02,	/* USB 2.0 */
+	0x02, 0x00, 0x00, TAM_PACOTE,		/* classe CDC */
+	USB_CDC_VID & 0xFF, USB_CDC_VID >> 8, USB_CDC_PID & 0xFF, USB_CDC_PID >> 8,
+	0x00, 0x01, 1, 2, 0, 1				/* versao 1.00, textos 1 e 2, sem numero de serie */
+};
+
+#define TAM_DESC_CONFIGURACAO	67
+
+static const uint8_t descritor_configuracao[TAM_DESC_CONFIGURACAO] =
+{
+	9, DESC_CONFIGURACAO, TAM_DESC_CONFIGURACAO, 0, 2, 1, 0, 0x80, 50,	/* 2 interfaces, 100 mA */
+
+	/* interface 0: comunicacao (ACM) */
+	9, 4, 0, 0, 1, 0x02, 0x02, 0x01, 0,
+	5, 0x24, 0x00, 0x10, 0x01,			/* cabecalho, CDC 1.10 */
+	5, 0x24, 0x01, 0x00, 1,				/* gerencia de chamada: dados na interface 1 */
+	4, 0x24, 0x02, 0x02,				/* ACM: line coding e control line state */
+	5, 0x24, 0x06, 0, 1,				/* uniao: 0 controla 1 */
+	7, 5, 0x80 | EP_NOTIFICACAO, 0x03, TAM_PACOTE_NOTIFICACAO, 0, 16,
+
+	/* interface 1: dados */
+	9, 4, 1, 0, 2, 0x0A, 0x00, 0x00, 0,
+	7, 5, 0x80 | EP_ENTRADA, 0x02, TAM_PACOTE, 0, 0,
+	7, 5, EP_SAIDA, 0x02, TAM_PACOTE, 0, 0
+};
+
+static const char * const textos[] = { "UTFPR", "RTOS CDC" };
+
+/* descritores dos bancos de cada ponto de acesso, lidos pelo controlador */
+COMPILER_ALIGNED(4) static UsbDeviceDescriptor descritores_ep[NUM_EPS];
+
+COMPILER_ALIGNED(4) static uint8_t controle_saida[TAM_PACOTE];
+COMPILER_ALIGNED(4) static uint8_t controle_entrada[TAM_CONTROLE];
+
+COMPILER_ALIGNED(4) NAO_INICIALIZADA static uint8_t recepcao[2][USB_CDC_TAM_RECEPCAO];
+COMPILER_ALIGNED(4) NAO_INICIALIZADA static uint8_t lotes[2][USB_CDC_TAM_LOTE];
+NAO_INICIALIZADA static uint8_t area_envio[USB_CDC_TAM_ENVIO];
+
+/* linha serial pedida pelo PC (nao usada: so devolvida): 115200, 8N1 */
+static uint8_t codificacao_linha[7] = { 0x00, 0xC2, 0x01, 0x00, 0, 0, 8 };
+
+static volatile uint8_t configurada = 0;
+static volatile uint8_t dtr = 0;
+static uint8_t endereco_pendente = 0;
+static uint8_t esperando_codificacao = 0;
+
+/* recepcao: o controlador enche os buffers alternadamente e a tarefa os
+   recebe na mesma ordem */
+static volatile uint8_t estado_recepcao[2] = { LIVRE, LIVRE };
+static uint16_t tamanho_recepcao[2];
+static uint8_t proximo_enchimento = 0;
+static uint8_t recebendo = 0;			/* um buffer armado no ponto de acesso */
+static uint8_t proxima_leitura = 0;
+static int8_t entregue = -1;			/* buffer com a tarefa, devolvido na proxima chamada */
+static semaforo_t SemaforoRecepcao = {0,0};
+
+/* envio: posicoes em bytes no anel, desde o inicio. reservado >= publicado
+   >= copiado, e reservado - copiado nunca passa de USB_CDC_TAM_ENVIO */
+static uint32_t envio_reservado = 0;
+static volatile uint32_t envio_publicado = 0;
+static volatile uint32_t envio_copiado = 0;
+static uint8_t copias_em_andamento = 0;
+static uint16_t tamanho_lote[2] = { 0, 0 };
+static uint8_t lote_atual = 0;
+static uint8_t enviando = 0;
+
+estatisticas_usb_cdc_t estatisticas_usb_cdc;
+
+/* prepara a resposta da etapa de dados do ponto de acesso 0, limitada ao
+   tamanho pedido. Um pacote vazio encerra uma resposta menor que o pedido
+   e multipla de 64 bytes */
+static void RespondeControle(uint16_t tamanho, uint16_t pedido)
+{
+	UsbDeviceDescBank *banco = &descritores_ep[EP_CONTROLE].DeviceDescBank[1];
+	uint32_t pcksize = PCKSIZE_64;
+
+	if(tamanho > pedido)
+	{
+		tamanho = pedido;
+	}
+	if(tamanho < pedido && (tamanho % TAM_PACOTE) == 0 && tamanho != 0)
+	{
+		pcksize |= USB_DEVICE_PCKSIZE_AUTO_ZLP;
+	}
+	banco->ADDR.reg = (uint32_t)controle_entrada;
+	banco->PCKSIZE.reg = pcksize | USB_DEVICE_PCKSIZE_BYTE_COUNT(tamanho);
+	USB->DEVICE.DeviceEndpoint[EP_CONTROLE].EPSTATUSSET.reg = USB_DEVICE_EPSTATUSSET_BK1RDY;
+}
+
+/* arma o banco de saida do ponto de acesso 0 para o proximo pacote */
+static void ArmaControleSaida(void)
+{
+	descritores_ep[EP_CONTROLE].DeviceDescBank[0].PCKSIZE.reg = PCKSIZE_64 |
+		USB_DEVICE_PCKSIZE_MULTI_PACKET_SIZE(TAM_PACOTE);
+	USB->DEVICE.DeviceEndpoint[EP_CONTROLE].EPSTATUSCLR.reg = USB_DEVICE_EPSTATUSCLR_BK0RDY;
+}
+
+/* descritor de texto em UTF-16, a partir de ASCII */
+static uint16_t MontaTexto(const char *texto)
+{
+	uint16_t tamanho = 2;
+
+	while(*texto != '\0' && tamanho < TAM_CONTROLE)
+	{
+		controle_entrada[tamanho++] = (uint8_t)*texto++;
+		controle_entrada[tamanho++] = 0;
+	}
+	controle_entrada[0] = (uint8_t)tamanho;
+	controle_entrada[1] = DESC_TEXTO;
+	return tamanho;
+}
+
+/* arma o proximo buffer de recepcao, se estiver livre. Chamada pela
+   interrupcao USB ou com as interrupcoes desabilitadas */
+static void ArmaRecepcao(void)
+{
+	UsbDeviceDescBank *banco = &descritores_ep[EP_SAIDA].DeviceDescBank[0];
+	uint8_t b = proximo_enchimento;
+
+	if(!configurada || recebendo)
+	{
+		return;
+	}
+	if(estado_recepcao[b] != LIVRE)
+	{
+		estatisticas_usb_cdc.recusas++;		/* o PC recebe NAK ate a tarefa devolver um */
+		return;
+	}
+	estado_recepcao[b] = ENCHENDO;
+	recebendo = 1;
+	banco->ADDR.reg = (uint32_t)recepcao[b];
+	banco->PCKSIZE.reg = PCKSIZE_64 | USB_DEVICE_PCKSIZE_MULTI_PACKET_SIZE(USB_CDC_TAM_RECEPCAO);
+	USB->DEVICE.DeviceEndpoint[EP_SAIDA].EPSTATUSCLR.reg = USB_DEVICE_EPSTATUSCLR_BK0RDY;
+}
+
+/* copia o trecho seguinte do anel para o buffer de envio */
+static void PreparaLote(uint8_t l)
+{
+	uint32_t quantidade = envio_publicado - envio_copiado;
+	uint32_t inicio = envio_copiado % USB_CDC_TAM_ENVIO;
+	uint32_t primeira_parte;
+
+	if(quantidade > USB_CDC_TAM_LOTE)
+	{
+		quantidade = USB_CDC_TAM_LOTE;
+	}
+	primeira_parte = USB_CDC_TAM_ENVIO - inicio;
+	if(primeira_parte >= quantidade)
+	{
+		memcpy(lotes[l], &area_envio[inicio], quantidade);
+	}
+	else
+	{
+		memcpy(lotes[l], &area_envio[inicio], primeira_parte);
+		memcpy(&lotes[l][primeira_parte], area_envio, quantidade - primeira_parte);
+	}
+	envio_copiado += quantidade;
+	tamanho_lote[l] = (uint16_t)quantidade;
+}
+
+/* inicia o buffer de envio atual, se parado, e prepara o outro. Chamada so
+   pela interrupcao USB */
+static void IniciaEnvio(void)
+{
+	UsbDeviceDescBank *banco = &descritores_ep[EP_ENTRADA].DeviceDescBank[1];
+	uint32_t pcksize = PCKSIZE_64;
+
+	if(!configurada)
+	{
+		return;
+	}
+	if(!enviando)
+	{
+		if(tamanho_lote[lote_atual] == 0 && envio_publicado != envio_copiado)
+		{
+			PreparaLote(lote_atual);
+		}
+		if(tamanho_lote[lote_atual] == 0)
+		{
+			return;
+		}
+
+		/* pacote vazio so no fim de uma rajada: no meio dela, o PC continua
+		   lendo o lote seguinte */
+		if(envio_publicado == envio_copiado && tamanho_lote[lote_atual ^ 1] == 0)
+		{
+			pcksize |= USB_DEVICE_PCKSIZE_AUTO_ZLP;
+		}
+		enviando = 1;
+		banco->ADDR.reg = (uint32_t)lotes[lote_atual];
+		banco->PCKSIZE.reg = pcksize | USB_DEVICE_PCKSIZE_BYTE_COUNT(tamanho_lote[lote_atual]);
+		USB->DEVICE.DeviceEndpoint[EP_ENTRADA].EPSTATUSSET.reg = USB_DEVICE_EPSTATUSSET_BK1RDY;
+	}
+	if(tamanho_lote[lote_atual ^ 1] == 0 && envio_publicado != envio_copiado)
+	{
+		PreparaLote(lote_atual ^ 1);
+	}
+}
+
+/* configura (1) ou desfaz (0) a configuracao com os pontos de acesso de
+   dados */
+static void Configura(uint8_t configuracao)
+{
+	UsbDevice *const usb = &USB->DEVICE;
+
+	usb->DeviceEndpoint[EP_SAIDA].EPCFG.reg = 0;
+	usb->DeviceEndpoint[EP_ENTRADA].EPCFG.reg = 0;
+	usb->DeviceEndpoint[EP_NOTIFICACAO].EPCFG.reg = 0;
+	configurada = 0;
+	dtr = 0;
+	if(recebendo)
+	{
+		estado_recepcao[proximo_enchimento] = LIVRE;
+		recebendo = 0;
+	}
+	enviando = 0;		/* o lote interrompido e enviado de novo */
+	if(configuracao == 0)
+	{
+		return;
+	}
+
+	usb->DeviceEndpoint[EP_SAIDA].EPCFG.reg = USB_DEVICE_EPCFG_EPTYPE0(3);
+	usb->DeviceEndpoint[EP_SAIDA].EPSTATUSCLR.reg = USB_DEVICE_EPSTATUSCLR_DTGLOUT |
+													USB_DEVICE_EPSTATUSCLR_STALLRQ0;
+	usb->DeviceEndpoint[EP_SAIDA].EPSTATUSSET.reg = USB_DEVICE_EPSTATUSSET_BK0RDY;
+	usb->DeviceEndpoint[EP_SAIDA].EPINTENSET.reg = USB_DEVICE_EPINTENSET_TRCPT0;
+
+	usb->DeviceEndpoint[EP_ENTRADA].EPCFG.reg = USB_DEVICE_EPCFG_EPTYPE1(3);
+	usb->DeviceEndpoint[EP_ENTRADA].EPSTATUSCLR.reg = USB_DEVICE_EPSTATUSCLR_DTGLIN |
+													USB_DEVICE_EPSTATUSCLR_STALLRQ1 |
+													USB_DEVICE_EPSTATUSCLR_BK1RDY;
+	usb->DeviceEndpoint[EP_ENTRADA].EPINTENSET.reg = USB_DEVICE_EPINTENSET_TRCPT1;
+
+	/* notificacao sem dados: o banco vazio responde NAK */
+	usb->DeviceEndpoint[EP_NOTIFICACAO].EPCFG.reg = USB_DEVICE_EPCFG_EPTYPE1(4);
+	usb->DeviceEndpoint[EP_NOTIFICACAO].EPSTATUSCLR.reg = USB_DEVICE_EPSTATUSCLR_BK1RDY;
+
+	configurada = 1;
+	ArmaRecepcao();
+	IniciaEnvio();
+}
+
+/* requisicao recebida no ponto de acesso 0. Retorna 0 se nao tratada */
+static uint8_t TrataRequisicao(const uint8_t *req)
+{
+	uint8_t tipo = req[0];
+	uint8_t pedido = req[1];
+	uint16_t valor = (uint16_t)(req[2] | (req[3] << 8));
+	uint16_t indice = (uint16_t)(req[4] | (req[5] << 8));
+	uint16_t tamanho = (uint16_t)(req[6] | (req[7] << 8));
+
+	switch((uint16_t)((tipo << 8) | pedido))
+	{
+		case 0x8000 | REQ_GET_DESCRIPTOR:
+			switch(valor >> 8)
+			{
+				case DESC_DISPOSITIVO:
+					memcpy(controle_entrada, descritor_dispositivo, sizeof(descritor_dispositivo));
+					RespondeControle(sizeof(descritor_dispositivo), tamanho);
+					return 1;
+				case DESC_CONFIGURACAO:
+					memcpy(controle_entrada, descritor_configuracao, sizeof(descritor_configuracao));
+					RespondeControle(sizeof(descritor_configuracao), tamanho);
+					return 1;
+				case DESC_TEXTO:
+					if((valor & 0xFF) == 0)
+					{
+						controle_entrada[0] = 4;		/* idioma: ingles (EUA) */
+						controle_entrada[1] = DESC_TEXTO;
+						controle_entrada[2] = 0x09;
+						controle_entrada[3] = 0x04;
+						RespondeControle(4, tamanho);
+						return 1;
+					}
+					if((valor & 0xFF) <= sizeof(textos) / sizeof(textos[0]))
+					{
+						RespondeControle(MontaTexto(textos[(valor & 0xFF) - 1]), tamanho);
+						return 1;
+					}
+					return 0;
+				default:
+					return 0;		/* qualificador de dispositivo: so velocidade plena */
+			}
+
+		case REQ_SET_ADDRESS:
+			endereco_pendente = (uint8_t)(valor & 0x7F);	/* aplicado depois do status */
+			RespondeControle(0, 0);
+			return 1;
+
+		case REQ_SET_CONFIGURATION:
+			if(valor > 1)
+			{
+				return 0;
+			}
+			Configura((uint8_t)valor);
+			RespondeControle(0, 0);
+			return 1;
+
+		case 0x8000 | REQ_GET_CONFIGURATION:
+			controle_entrada[0] = configurada;
+			RespondeControle(1, tamanho);
+			return 1;
+
+		case 0x8000 | REQ_GET_STATUS:
+		case 0x8100 | REQ_GET_STATUS:
+		case 0x8200 | REQ_GET_STATUS:
+			controle_entrada[0] = 0;
+			controle_entrada[1] = 0;
+			RespondeControle(2, tamanho);
+			return 1;
+
+		case 0x0200 | REQ_CLEAR_FEATURE:
+			/* fim do ENDPOINT_HALT: reinicia a alternancia de dados */
+			if((indice & 0x0F) == EP_SAIDA || (indice & 0x0F) == EP_ENTRADA)
+			{
+				USB->DEVICE.DeviceEndpoint[indice & 0x0F].EPSTATUSCLR.reg = (indice & 0x80) ?
+					(USB_DEVICE_EPSTATUSCLR_STALLRQ1 | USB_DEVICE_EPSTATUSCLR_DTGLIN) :
+					(USB_DEVICE_EPSTATUSCLR_STALLRQ0 | USB_DEVICE_EPSTATUSCLR_DTGLOUT);
+			}
+			RespondeControle(0, 0);
+			return 1;
+
+		case 0x0100 | REQ_SET_INTERFACE:
+			RespondeControle(0, 0);
+			return 1;
+
+		case 0x2100 | REQ_SET_LINE_CODING:
+			esperando_codificacao = 1;		/* etapa de dados: 7 bytes do PC */
+			return 1;
+
+		case 0xA100 | REQ_GET_LINE_CODING:
+			memcpy(controle_entrada, codificacao_linha, sizeof(codificacao_linha));
+			RespondeControle(sizeof(codificacao_linha), tamanho);
+			return 1;
+
+		case 0x2100 | REQ_SET_CONTROL_LINE_STATE:
+			dtr = (uint8_t)(valor & 1);		/* porta aberta no PC */
+			RespondeControle(0, 0);
+			return 1;
+
+		case 0x2100 | REQ_SEND_BREAK:
+			RespondeControle(0, 0);
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+/* interrupcoes do ponto de acesso 0 */
+static void TrataControle(void)
+{
+	UsbDeviceEndpoint *const ep = &USB->DEVICE.DeviceEndpoint[EP_CONTROLE];
+	uint8_t flags = ep->EPINTFLAG.reg;
+
+	if(flags & USB_DEVICE_EPINTFLAG_RXSTP)
+	{
+		ep->EPINTFLAG.reg = USB_DEVICE_EPINTFLAG_RXSTP | USB_DEVICE_EPINTFLAG_TRCPT0 |
+							USB_DEVICE_EPINTFLAG_TRCPT1;
+		esperando_codificacao = 0;
+		if(!TrataRequisicao(controle_saida))
+		{
+			estatisticas_usb_cdc.requisicoes_recusadas++;
+			ep->EPSTATUSSET.reg = USB_DEVICE_EPSTATUSSET_STALLRQ0 | USB_DEVICE_EPSTATUSSET_STALLRQ1;
+		}
+		ArmaControleSaida();		/* etapa de dados ou status do PC */
+		return;
+	}
+	if(flags & USB_DEVICE_EPINTFLAG_TRCPT0)
+	{
+		ep->EPINTFLAG.reg = USB_DEVICE_EPINTFLAG_TRCPT0;
+		if(esperando_codificacao)
+		{
+			esperando_codificacao = 0;
+			memcpy(codificacao_linha, controle_saida, sizeof(codificacao_linha));
+			RespondeControle(0, 0);
+		}
+		ArmaControleSaida();
+	}
+	if(flags & USB_DEVICE_EPINTFLAG_TRCPT1)
+	{
+		ep->EPINTFLAG.reg = USB_DEVICE_EPINTFLAG_TRCPT1;
+		if(endereco_pendente != 0)
+		{
+			USB->DEVICE.DADD.reg = USB_DEVICE_DADD_ADDEN | endereco_pendente;
+			endereco_pendente = 0;
+		}
+	}
+}
+
+/* reset do barramento: so o ponto de acesso 0, endereco 0 */
+static void FimDeReset(void)
+{
+	UsbDevice *const usb = &USB->DEVICE;
+
+	estatisticas_usb_cdc.resets++;
+	Configura(0);
+	endereco_pendente = 0;
+	esperando_codificacao = 0;
+	usb->DADD.reg = USB_DEVICE_DADD_ADDEN;
+
+	descritores_ep[EP_CONTROLE].DeviceDescBank[0].ADDR.reg = (uint32_t)controle_saida;
+	descritores_ep[EP_CONTROLE].DeviceDescBank[1].ADDR.reg = (uint32_t)controle_entrada;
+	descritores_ep[EP_CONTROLE].DeviceDescBank[1].PCKSIZE.reg = PCKSIZE_64;
+	usb->DeviceEndpoint[EP_CONTROLE].EPCFG.reg = USB_DEVICE_EPCFG_EPTYPE0(1) | USB_DEVICE_EPCFG_EPTYPE1(1);
+	usb->DeviceEndpoint[EP_CONTROLE].EPSTATUSCLR.reg = USB_DEVICE_EPSTATUSCLR_BK1RDY;
+	ArmaControleSaida();
+	usb->DeviceEndpoint[EP_CONTROLE].EPINTENSET.reg = USB_DEVICE_EPINTENSET_RXSTP |
+		USB_DEVICE_EPINTENSET_TRCPT0 | USB_DEVICE_EPINTENSET_TRCPT1;
+}
+
+/* fim de um buffer de recepcao: cheio ou encerrado por um pacote curto */
+static void FimDeRecepcao(void)
+{
+	UsbDeviceEndpoint *const ep = &USB->DEVICE.DeviceEndpoint[EP_SAIDA];
+	uint8_t b = proximo_enchimento;
+	uint16_t tamanho;
+
+	if(!(ep->EPINTFLAG.reg & USB_DEVICE_EPINTFLAG_TRCPT0))
+	{
+		return;
+	}
+	ep->EPINTFLAG.reg = USB_DEVICE_EPINTFLAG_TRCPT0;
+	recebendo = 0;
+
+	tamanho = (uint16_t)(descritores_ep[EP_SAIDA].DeviceDescBank[0].PCKSIZE.bit.BYTE_COUNT);
+	if(tamanho == 0)
+	{
+		estado_recepcao[b] = LIVRE;		/* pacote vazio: o mesmo buffer de novo */
+	}
+	else
+	{
+		tamanho_recepcao[b] = tamanho;
+		estado_recepcao[b] = CHEIO;
+		proximo_enchimento ^= 1;
+		estatisticas_usb_cdc.buffers_recebidos++;
+		estatisticas_usb_cdc.bytes_recebidos += tamanho;
+		SemaforoLiberaISR(&SemaforoRecepcao);
+	}
+	ArmaRecepcao();
+}
+
+/* fim de um buffer de envio: o seguinte, ja preparado, sai em seguida */
+static void FimDeEnvio(void)
+{
+	UsbDeviceEndpoint *const ep = &USB->DEVICE.DeviceEndpoint[EP_ENTRADA];
+
+	if(!(ep->EPINTFLAG.reg & USB_DEVICE_EPINTFLAG_TRCPT1))
+	{
+		return;
+	}
+	ep->EPINTFLAG.reg = USB_DEVICE_EPINTFLAG_TRCPT1;
+	estatisticas_usb_cdc.lotes_enviados++;
+	estatisticas_usb_cdc.bytes_enviados += tamanho_lote[lote_atual];
+	tamanho_lote[lote_atual] = 0;
+	lote_atual ^= 1;
+	enviando = 0;
+}
+
+void USB_Handler(void)
+{
+	UsbDevice *const usb = &USB->DEVICE;
+
+	if(usb->INTFLAG.reg & USB_DEVICE_INTFLAG_EORST)
+	{
+		usb->INTFLAG.reg = USB_DEVICE_INTFLAG_EORST;
+		FimDeReset();
+	}
+	if(usb->EPINTSMRY.reg & (1 << EP_CONTROLE))
+	{
+		TrataControle();
+	}
+	if(usb->EPINTSMRY.reg & (1 << EP_SAIDA))
+	{
+		FimDeRecepcao();
+	}
+	if(usb->EPINTSMRY.reg & (1 << EP_ENTRADA))
+	{
+		FimDeEnvio();
+	}
+
+	/* tambem pendente por UsbCdcEnvia, com bytes novos no anel */
+	IniciaEnvio();
+}
+
+/* liga a USB e conecta o dispositivo ao PC. A DFLL deve estar travada
+   (ClockAguardaFinal) */
+void UsbCdcInicia(void)
+{
+#if !PINOS_TABELA
+	struct system_pinmux_config config_pino;
+#endif
+	UsbDevice *const usb = &USB->DEVICE;
+	uint32_t transn, transp, trim;
+
+	PM->APBBMASK.reg |= PM_APBBMASK_USB;
+
+#if !PINOS_TABELA		/* senao, ja configurados na partida (pinos.h) */
+	/* pinos D- e D+ */
+	system_pinmux_get_config_defaults(&config_pino);
+	config_pino.mux_position = PINMUX_PA24G_USB_DM & 0xFFFF;
+	system_pinmux_pin_set_config(PINMUX_PA24G_USB_DM >> 16, &config_pino);
+	config_pino.mux_position = PINMUX_PA25G_USB_DP & 0xFFFF;
+	system_pinmux_pin_set_config(PINMUX_PA25G_USB_DP >> 16, &config_pino);
+#endif
+
+	/* 48 MHz da DFLL por um gerador proprio, independente do gerador 0 */
+	GCLK->GENDIV.reg = GCLK_GENDIV_ID(USB_CDC_GERADOR) | GCLK_GENDIV_DIV(1);
+	GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(USB_CDC_GERADOR) | GCLK_GENCTRL_SRC_DFLL48M | GCLK_GENCTRL_GENEN;
+	while(GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY) {}
+	GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(USB_GCLK_ID) | GCLK_CLKCTRL_GEN(USB_CDC_GERADOR) | GCLK_CLKCTRL_CLKEN;
+
+	usb->CTRLA.reg = USB_CTRLA_SWRST;
+	while(usb->SYNCBUSY.reg & USB_SYNCBUSY_SWRST) {}
+
+	/* calibracao dos pinos gravada na fabrica (valores tipicos se apagada) */
+	transn = (*((uint32_t *)USB_FUSES_TRANSN_ADDR) & USB_FUSES_TRANSN_Msk) >> USB_FUSES_TRANSN_Pos;
+	transp = (*((uint32_t *)USB_FUSES_TRANSP_ADDR) & USB_FUSES_TRANSP_Msk) >> USB_FUSES_TRANSP_Pos;
+	trim = (*((uint32_t *)USB_FUSES_TRIM_ADDR) & USB_FUSES_TRIM_Msk) >> USB_FUSES_TRIM_Pos;
+	if(transn == 0x1F)
+	{
+		transn = 5;
+	}
+	if(transp == 0x1F)
+	{
+		transp = 29;
+	}
+	if(trim == 0x7)
+	{
+		trim = 3;
+	}
+	usb->PADCAL.reg = (uint16_t)(USB_PADCAL_TRANSN(transn) | USB_PADCAL_TRANSP(transp) | USB_PADCAL_TRIM(trim));
+
+	memset(descritores_ep, 0, sizeof(descritores_ep));
+	usb->DESCADD.reg = (uint32_t)descritores_ep;
+
+	usb->CTRLA.reg = USB_CTRLA_MODE_DEVICE | USB_CTRLA_RUNSTDBY | USB_CTRLA_ENABLE;
+	while(usb->SYNCBUSY.reg & USB_SYNCBUSY_ENABLE) {}
+
+	usb->INTENSET.reg = USB_DEVICE_INTENSET_EORST;
+	NVIC_EnableIRQ(USB_IRQn);
+
+	/* DETACH em 0: o pull-up de D+ anuncia o dispositivo ao PC */
+	usb->CTRLB.reg = USB_DEVICE_CTRLB_SPDCONF_FS;
+}
+
+/* aguarda um buffer recebido e retorna em *dados e no valor de retorno os
+   seus bytes: um buffer cheio ou o que chegou ate um pacote curto do PC (o
+   fim de uma escrita). O buffer fica com a tarefa ate a proxima chamada,
+   que o devolve a USB */
+uint16_t UsbCdcRecebe(const uint8_t **dados)
+{
+	reg_atomica_t estado;
+	uint8_t b;
+
+	if(entregue >= 0)
+	{
+		REG_ATOMICA_INICIO(estado);
+		estado_recepcao[entregue] = LIVRE;
+		ArmaRecepcao();			/* se a recepcao parou com os dois cheios */
+		REG_ATOMICA_FIM(estado);
+		entregue = -1;
+	}
+
+	SemaforoAguarda(&SemaforoRecepcao);
+
+	b = proxima_leitura;
+	proxima_leitura ^= 1;
+	estado_recepcao[b] = ENTREGUE;
+	entregue = (int8_t)b;
+
+	*dados = recepcao[b];
+	return tamanho_recepcao[b];
+}
+
+/* copia a mensagem para o anel de envio e retorna sem esperar a USB. Pode
+   ser chamada por varias tarefas, inclusive antes de o PC configurar o
+   dispositivo (os bytes saem depois), mas nao por interrupcoes. Retorna o
+   tamanho, ou 0 se a mensagem nao coube e foi descartada */
+uint16_t UsbCdcEnvia(const uint8_t *dados, uint16_t tamanho)
+{
+	reg_atomica_t estado;
+	uint32_t inicio, primeira_parte;
+	uint8_t publica;
+
+	if(tamanho == 0)
+	{
+		return 0;
+	}
+
+	REG_ATOMICA_INICIO(estado);
+	if(tamanho > USB_CDC_TAM_ENVIO - (envio_reservado - envio_copiado))
+	{
+		estatisticas_usb_cdc.bytes_descartados += tamanho;
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	inicio = envio_reservado % USB_CDC_TAM_ENVIO;
+	envio_reservado += tamanho;
+	copias_em_andamento++;
+	REG_ATOMICA_FIM(estado);
+
+	/* a copia pode ser interrompida: o espaco ja e desta mensagem */
+	primeira_parte = USB_CDC_TAM_ENVIO - inicio;
+	if(primeira_parte >= tamanho)
+	{
+		memcpy(&area_envio[inicio], dados, tamanho);
+	}
+	else
+	{
+		memcpy(&area_envio[inicio], dados, primeira_parte);
+		memcpy(area_envio, dados + primeira_parte, tamanho - primeira_parte);
+	}
+
+	/* a ultima copia em andamento publica todas as reservas ja copiadas */
+	REG_ATOMICA_INICIO(estado);
+	publica = (--copias_em_andamento == 0);
+	if(publica)
+	{
+		envio_publicado = envio_reservado;
+	}
+	REG_ATOMICA_FIM(estado);
+
+	/* a copia para os buffers de envio e feita pela interrupcao USB */
+	if(publica)
+	{
+		NVIC_SetPendingIRQ(USB_IRQn);
+	}
+
+	return tamanho;
+}
+
+/* bytes descartados porque a mensagem nao coube no anel de envio */
+uint32_t UsbCdcDescartados(void)
+{
+	return estatisticas_usb_cdc.bytes_descartados;
+}
+
+/* 1 se o PC configurou o dispositivo e abriu a porta (DTR) */
+uint8_t UsbCdcAberta(void)
+{
+	return (uint8_t)(configurada && dtr);
+}
+
+#endif /* USB_CDC */
@@ -0,0 +1,104 @@
+/*
+ * usb_cdc.h
+ *
+ * Porta serial virtual pela USB de velocidade plena do SAMD21 (dispositivo
+ * CDC ACM, sem driver no PC), com a mesma interface de uart_dma.h: os
+ * blocos recebidos sao entregues por UsbCdcRecebe (ex.: ao receptor de
+ * quadros, ReceptorQuadrosProcessa) e o envio copia para um anel sem
+ * esperar. A taxa nao depende de baud: o PC le ate 19 pacotes de 64 bytes
+ * por quadro USB de 1 ms, o que permite descarregar registros a mais de
+ * 500 kB/s.
+ *
+ * Os pontos de acesso bulk usam o DMA da propria USB, que copia os pacotes
+ * direto dos buffers na RAM, e transferencias de varios pacotes: uma unica
+ * interrupcao por buffer, nao por pacote. Cada sentido tem dois buffers:
+ *  - recepcao: a USB enche um enquanto a tarefa processa o outro. Com os
+ *    dois cheios, a USB recusa (NAK) os pacotes seguintes ate a tarefa
+ *    devolver um: o PC espera e nenhum byte e perdido;
+ *  - envio: enquanto um e enviado, o outro e preparado com o trecho
+ *    seguinte do anel, e a interrupcao de fim de envio ja inicia o proximo.
+ *
+ * A USB precisa de 48 MHz com precisao de 0,25%: a DFLL em malha fechada
+ * com o cristal de 32 kHz (INICIO_CLOCKS 2), por um gerador proprio
+ * (USB_CDC_GERADOR), que nao muda com os perfis de clock da CPU.
+ *
+ * Define o USB_Handler, entao so e compilado com USB_CDC=1 nos simbolos do
+ * projeto. Ex.:
+ *
+ *   UsbCdcInicia();		depois de ClockAguardaFinal
+ *   for(;;) { tamanho = UsbCdcRecebe(&bloco); ReceptorQuadrosProcessa(&receptor, bloco, tamanho); }
+ */
+
+
+#ifndef USB_CDC_H_
+#define USB_CDC_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef USB_CDC
+#define USB_CDC					0
+#endif
+
+/* gerador de clock da USB, com a DFLL (48 MHz) */
+#ifndef USB_CDC_GERADOR
+#define USB_CDC_GERADOR			3
+#endif
+
+/* tamanho de cada um dos dois buffers de recepcao (multiplo de 64, ate 1023
+   pacotes) */
+#ifndef USB_CDC_TAM_RECEPCAO
+#define USB_CDC_TAM_RECEPCAO	256
+#endif
+
+/* tamanho de cada um dos dois buffers de envio (multiplo de 64) */
+#ifndef USB_CDC_TAM_LOTE
+#define USB_CDC_TAM_LOTE		512
+#endif
+
+/* tamanho do anel de envio, em bytes (potencia de 2) */
+#ifndef USB_CDC_TAM_ENVIO
+#define USB_CDC_TAM_ENVIO		2048
+#endif
+
+/* identificacao do dispositivo (o par da Atmel para exemplos CDC) */
+#ifndef USB_CDC_VID
+#define USB_CDC_VID				0x03EB
+#endif
+#ifndef USB_CDC_PID
+#define USB_CDC_PID				0x2404
+#endif
+
+#if (USB_CDC_TAM_RECEPCAO % 64) != 0 || (USB_CDC_TAM_LOTE % 64) != 0
+#error "USB_CDC_TAM_RECEPCAO e USB_CDC_TAM_LOTE devem ser multiplos de 64"
+#endif
+#if (USB_CDC_TAM_ENVIO & (USB_CDC_TAM_ENVIO - 1)) != 0
+#error "USB_CDC_TAM_ENVIO deve ser potencia de 2"
+#endif
+
+/**
+* \struct estatisticas_usb_cdc_t
+* Contadores da porta, de 32 bits (voltam a zero ao estourar)
+*/
+
+typedef struct
+{
+	uint32_t	resets;				///< Resets do barramento (conexoes ao PC)
+	uint32_t	buffers_recebidos;	///< Buffers de recepcao entregues
+	uint32_t	bytes_recebidos;	///< Bytes recebidos
+	uint32_t	recusas;			///< Vezes que os dois buffers de recepcao estavam cheios (NAK)
+	uint32_t	lotes_enviados;		///< Buffers de envio transmitidos
+	uint32_t	bytes_enviados;		///< Bytes transmitidos
+	uint32_t	bytes_descartados;	///< Bytes de mensagens que nao couberam no anel de envio
+	uint32_t	requisicoes_recusadas;	///< Requisicoes de controle nao tratadas (STALL)
+} estatisticas_usb_cdc_t;
+
+extern estatisticas_usb_cdc_t estatisticas_usb_cdc;
+
+void UsbCdcInicia(void);
+uint16_t UsbCdcRecebe(const uint8_t **dados);
+uint16_t UsbCdcEnvia(const uint8_t *dados, uint16_t tamanho);
+uint32_t UsbCdcDescartados(void);
+uint8_t UsbCdcAberta(void);
+
+#endif /* USB_CDC_H_ */
@@ -0,0 +1,77 @@
+/*
+ * vigia_wdt.c
+ *
+ * WDT do SAM D21 alimentado pelo vigia das tarefas (ver vigia_wdt.h).
+ */
+
+#include <asf.h>
+#include "vigia_wdt.h"
+#include "retida.h"
+#include "mtb.h"
+
+#if VIGIA_WDT
+
+#if cfg_VIGIA == 0
+#error "VIGIA_WDT exige cfg_VIGIA (conf_rtos.h)"
+#endif
+
+/* posicao do rastro no registro da falha */
+#if cfg_RASTRO > 0
+#define POSICAO_RASTRO()		((uint32_t)rastro_total)
+#else
+#define POSICAO_RASTRO()		0u
+#endif
+
+/* liga o WDT com o periodo e o aviso (codigos de 8 << n ciclos de
+   1,024 ms). Depois de ligado, so o reset o desliga */
+void VigiaWdtInicia(uint8_t periodo, uint8_t aviso)
+{
+	PM->APBAMASK.reg |= PM_APBAMASK_WDT;
+
+	/* OSCULP32K / 2^(4+1) = 1,024 kHz, tambem no sono */
+	GCLK->GENDIV.reg = GCLK_GENDIV_ID(VIGIA_WDT_GERADOR) | GCLK_GENDIV_DIV(4);
+	GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(VIGIA_WDT_GERADOR) | GCLK_GENCTRL_SRC_OSCULP32K |
+						GCLK_GENCTRL_DIVSEL | GCLK_GENCTRL_RUNSTDBY | GCLK_GENCTRL_GENEN;
+	while(GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY) {}
+	GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(WDT_GCLK_ID) | GCLK_CLKCTRL_GEN(VIGIA_WDT_GERADOR) | GCLK_CLKCTRL_CLKEN;
+
+	WDT->CTRL.reg = 0;
+	while(WDT->STATUS.reg & WDT_STATUS_SYNCBUSY) {}
+	WDT->CONFIG.reg = WDT_CONFIG_PER(periodo);
+	WDT->EWCTRL.reg = WDT_EWCTRL_EWOFFSET(aviso);
+	WDT->INTFLAG.reg = WDT_INTFLAG_EW;
+	WDT->INTENSET.reg = WDT_INTENSET_EW;
+	NVIC_EnableIRQ(WDT_IRQn);
+	WDT->CTRL.reg = WDT_CTRL_ENABLE;
+	while(WDT->STATUS.reg & WDT_STATUS_SYNCBUSY) {}
+}
+
+/* cfg_ALIMENTA_VIGIA: reinicia a contagem, sem esperar a sincronizacao
+   (~3 ciclos do WDT). Se a anterior ainda sincroniza, a contagem ja foi
+   reiniciada ha menos de 3 ms */
+void VigiaWdtAlimenta(void)
+{
+	if((WDT->STATUS.reg & WDT_STATUS_SYNCBUSY) == 0)
+	{
+		WDT->CLEAR.reg = WDT_CLEAR_CLEAR_KEY;
+	}
+}
+
+/* cfg_VIGIA_FALHOU: registra a tarefa atrasada ja na deteccao, antes do
+   aviso */
+void VigiaWdtFalhou(uint8_t id_tarefa)
+{
+#if MTB_RASTRO
+	MtbPara();		/* guarda os desvios ate o atraso, como o rastro */
+#endif
+	RetidaRegistraFalha(VIGIA_WDT_FALHA | id_tarefa, POSICAO_RASTRO());
+}
+
+/* aviso: o reset vem em (periodo - aviso) ciclos do WDT */
+void WDT_Handler(void)
+{
+	WDT->INTFLAG.reg = WDT_INTFLAG_EW;
+	RetidaRegistraFalha(VIGIA_WDT_FALHA | VigiaAtrasada(), POSICAO_RASTRO());
+}
+
+#endif /* VIGIA_WDT */
@@ -0,0 +1,64 @@
+/*
+ * vigia_wdt.h
+ *
+ * WDT do SAMD21 alimentado pelo vigia das tarefas do nucleo (cfg_VIGIA):
+ * um unico WDT para todas as tarefas, sem tarefa de vigia. Cada tarefa
+ * registrada (VigiaRegistra) chama VigiaSinaliza no seu laco; a marca de
+ * tempo confere as janelas a cada cfg_VIGIA marcas e so reinicia o WDT se
+ * todas sinalizaram. Com uma tarefa presa, o WDT nao e mais reiniciado.
+ *
+ * Antes do reset, a interrupcao de aviso (early warning) registra a falha
+ * na memoria retida (retida.h), com a tarefa atrasada e a posicao do
+ * rastro do nucleo, ja congelado pelo vigia. Com cfg_RASTRO_RETIDO o anel
+ * inteiro sobrevive ao reset e pode ser descarregado na partida quente.
+ * Aviso sem tarefa atrasada (tarefa 0 no codigo) indica que a propria
+ * verificacao parou: marca de tempo parada ou interrupcoes desabilitadas.
+ *
+ * O WDT conta o OSCULP32K dividido por 32 (1,024 kHz), pelo gerador
+ * VIGIA_WDT_GERADOR, e continua contando no sono. Com cfg_OCIOSA_SEM_MARCAS,
+ * o periodo do WDT deve ser maior que o sono mais longo da tarefa ociosa.
+ *
+ * Ligado com VIGIA_WDT=1 nos simbolos do projeto (conf_rtos.h). Ex.:
+ *
+ *   VigiaWdtInicia(VIGIA_WDT_PERIODO, VIGIA_WDT_AVISO);
+ *   VigiaRegistra(id, 500);			a tarefa id sinaliza a cada 500 marcas
+ *   for(;;) { VigiaSinaliza(); ... }	no laco da tarefa
+ */
+
+
+#ifndef VIGIA_WDT_H_
+#define VIGIA_WDT_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef VIGIA_WDT
+#define VIGIA_WDT				0
+#endif
+
+/* gerador de clock do WDT, com o OSCULP32K (o gerador 2 divide por 2^n) */
+#ifndef VIGIA_WDT_GERADOR
+#define VIGIA_WDT_GERADOR		2
+#endif
+
+/* periodo e aviso, como WDT_CONFIG_PER e WDT_EWCTRL_EWOFFSET: 8 << n
+   ciclos de 1,024 ms (9: ~4 s, 8: aviso ~2 s depois da ultima alimentacao) */
+#ifndef VIGIA_WDT_PERIODO
+#define VIGIA_WDT_PERIODO		9
+#endif
+#ifndef VIGIA_WDT_AVISO
+#define VIGIA_WDT_AVISO			8
+#endif
+
+/* codigo da falha na memoria retida; o byte baixo e a tarefa atrasada */
+#define VIGIA_WDT_FALHA			0x57445400u
+
+#if VIGIA_WDT_AVISO >= VIGIA_WDT_PERIODO || VIGIA_WDT_PERIODO > 11
+#error "VIGIA_WDT_AVISO deve ser menor que VIGIA_WDT_PERIODO, no maximo 11"
+#endif
+
+void VigiaWdtInicia(uint8_t periodo, uint8_t aviso);
+void VigiaWdtAlimenta(void);
+void VigiaWdtFalhou(uint8_t id_tarefa);
+
+#endif /* VIGIA_WDT_H_ */
@@ -0,0 +1,42 @@
+/*
+ * conf_rtos.h
+ *
+ * Configuracao do sistema multitarefas para a placa SAM R21 Xplained Pro.
+ * As macros nao definidas aqui usam os valores padrao do rtos.h.
+ */ 
+
+
+#ifndef CONF_RTOS_H_
+#define CONF_RTOS_H_
+
+/* numero de tarefas (as medicoes do nucleo usam tres, mais a ociosa, e 
+   os testes do Thread-Metric ate seis; a escuta periodica do radio usa a 
+   tarefa de temporizadores) */
+#if defined(MEDE_THREAD_METRIC) && MEDE_THREAD_METRIC
+#define NUMERO_DE_TAREFAS	7
+#define PRIORIDADE_MAXIMA	6		/* teste preemptivo: 5 prioridades e o relatorio */
+#elif (defined(MEDE_NUCLEO) && MEDE_NUCLEO) || (defined(RADIO_ESCUTA_PERIODO) && RADIO_ESCUTA_PERIODO > 0)
+#define NUMERO_DE_TAREFAS	4
+#else
+#define NUMERO_DE_TAREFAS	3
+#endif
+
+/* frequencia de clock da CPU, lida da configuracao de clocks do ASF */
+#define cfg_CPU_CLOCK_HZ 	system_cpu_clock_get_hz()
+
+/* modo preemptivo: a marca de tempo troca para a tarefa de maior prioridade */
+#define cfg_PREEMPTIVO		1
+
+/* escuta periodica do radio: janelas programadas por temporizadores e, 
+   entre elas, o processador dorme sem marcas de tempo */
+#if defined(RADIO_ESCUTA_PERIODO) && RADIO_ESCUTA_PERIODO > 0
+#define cfg_TEMPORIZADORES		1
+#define cfg_OCIOSA_SEM_MARCAS	1
+#endif
+
+/* ajuste fino da marca de tempo, usado pelo sincronismo entre os nos */
+#if defined(SINCRONISMO) && SINCRONISMO
+#define cfg_AJUSTE_MARCA	1
+#endif
+
+#endif /* CONF_RTOS_H_ */
@@ -0,0 +1,40 @@
+/*
+ * dma.h
+ *
+ * Controlador de DMA (DMAC) compartilhado pelos drivers do projeto: secao
+ * de descritores, copia de retorno e a interrupcao unica do DMAC, repassada
+ * ao tratador registrado para cada canal.
+ */
+
+
+#ifndef DMA_H_
+#define DMA_H_
+
+#include <asf.h>
+#include "stdint.h"
+
+/* numero de canais usados no projeto (canais 0 a DMA_NUMERO_CANAIS - 1): 
+   os dois do radio (radio_rf233.c). Cada canal ocupa 32 bytes de RAM na 
+   secao de descritores */
+#ifndef DMA_NUMERO_CANAIS
+#define DMA_NUMERO_CANAIS		2
+#endif
+
+#if DMA_NUMERO_CANAIS > DMAC_CH_NUM
+#error "DMA_NUMERO_CANAIS maior que o numero de canais do DMAC"
+#endif
+
+/* tratador da interrupcao de um canal, chamado com o canal ja selecionado 
+   em DMAC->CHID. Deve limpar as flags que tratar em DMAC->CHINTFLAG */
+typedef void (*tratador_dma_t)(void);
+
+/* primeiro descritor de cada canal e a copia de retorno, onde o DMAC guarda 
+   o estado do canal (ex.: BTCNT) quando ele deixa de ser o canal ativo */
+extern DmacDescriptor dma_descritores[DMA_NUMERO_CANAIS];
+extern DmacDescriptor dma_retorno[DMA_NUMERO_CANAIS];
+
+void DmaIniciaControlador(void);
+void DmaRegistraTratador(uint8_t canal, tratador_dma_t tratador);
+uint16_t DmaRestante(uint8_t canal);
+
+#endif /* DMA_H_ */
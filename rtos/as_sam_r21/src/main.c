@@ -29,6 +29,102 @@
 #include "stdint.h"
 #include "rtos.h"
 
+/*
+ * Medicoes do nucleo (medicoes/mede_nucleo.c), em ciclos (min/media/max), 
+ * enviadas pela serial do EDBG a BAUD_MEDICOES. Substitui as tarefas de 
+ * exemplo e inicia os clocks e a marca de tempo. Ligada pela configuracao 
+ * Benchmark do projeto (MEDE_NUCLEO=1)
+ */
+#ifndef MEDE_NUCLEO
+#define MEDE_NUCLEO			0
+#endif
+#define BAUD_MEDICOES		115200UL
+
+/*
+ * Latencia da borda externa ate a tarefa (medicoes/mede_latencia.c), com o 
+ * nucleo preemptivo desta placa, no lugar das medicoes do nucleo. Ligada 
+ * com MEDE_LATENCIA=1 nos simbolos da configuracao Benchmark, com um jumper 
+ * entre os pinos 5 (estimulo) e 9 (EIC) do EXT1; a resposta sai no pino 6
+ */
+#ifndef MEDE_LATENCIA
+#define MEDE_LATENCIA		0
+#endif
+
+/*
+ * Testes do Thread-Metric (medicoes/mede_thread_metric.c): operacoes a 
+ * cada 30 s, comparaveis com os resultados publicados de outros RTOS, no 
+ * lugar das medicoes do nucleo. Ligados com MEDE_THREAD_METRIC=n (teste 1 
+ * a 7) nos simbolos da configuracao Benchmark
+ */
+#ifndef MEDE_THREAD_METRIC
+#define MEDE_THREAD_METRIC	0
+#endif
+
+/*
+ * Radio 802.15.4 do AT86RF233 (radio_rf233.c), com varios quadros por 
+ * PSDU: a tarefa de telemetria envia uma rajada de leituras a cada 
+ * PERIODO_TELEMETRIA marcas e inverte o LED a cada quadro recebido de 
+ * outro no. Ligado com RADIO_RF233=1 nos simbolos do projeto, porque o 
+ * driver define o EIC_Handler
+ */
+#ifndef RADIO_RF233
+#define RADIO_RF233			0
+#endif
+#define PERIODO_TELEMETRIA	1000
+#define LEITURAS_TELEMETRIA	4
+
+/*
+ * Escuta periodica do radio (MAC de baixo consumo): com 
+ * RADIO_ESCUTA_PERIODO=n nos simbolos do projeto, o transceptor so escuta 
+ * uma janela a cada n marcas e o processador dorme entre elas. As janelas 
+ * sao programadas pela tarefa de temporizadores, a de maior prioridade
+ */
+#ifndef RADIO_ESCUTA_PERIODO
+#define RADIO_ESCUTA_PERIODO	0
+#endif
+
+/*
+ * Sincronismo da marca de tempo entre os nos (sincronismo.c): o periodo de 
+ * telemetria e dividido em FENDAS_TDMA fendas do tempo da rede. O no de 
+ * referencia (NO_REFERENCIA=1) envia a baliza na fenda 0 e cada outro no 
+ * envia a sua rajada na fenda do seu endereco; o LED inverte no inicio de 
+ * cada periodo, junto em todos os nos sincronizados. Ligado com 
+ * SINCRONISMO=1 (e RADIO_RF233=1) nos simbolos do projeto
+ */
+#ifndef SINCRONISMO
+#define SINCRONISMO			0
+#endif
+#ifndef NO_REFERENCIA
+#define NO_REFERENCIA		0
+#endif
+#define FENDAS_TDMA			10
+
+#if MEDE_LATENCIA && !MEDE_NUCLEO
+#error "MEDE_LATENCIA usa a configuracao Benchmark (MEDE_NUCLEO=1)"
+#endif
+#if MEDE_THREAD_METRIC && (!MEDE_NUCLEO || MEDE_LATENCIA)
+#error "MEDE_THREAD_METRIC usa a configuracao Benchmark (MEDE_NUCLEO=1), sem MEDE_LATENCIA"
+#endif
+#if RADIO_RF233 && MEDE_NUCLEO
+#error "RADIO_RF233 e as medicoes usam o EIC: ligue so um dos dois"
+#endif
+
+#if MEDE_NUCLEO
+#include "mede_nucleo.h"		/* caminho ../../medicoes na configuracao Benchmark */
+#include "mede_latencia.h"
+#include "mede_thread_metric.h"
+#include "serial_edbg.h"
+#endif
+
+#if RADIO_RF233
+#include "radio_rf233.h"
+void tarefa_radio(void);
+void tarefa_telemetria(void);
+#endif
+#if SINCRONISMO
+#include "sincronismo.h"
+#endif
+
 /*
  * Prototipos das tarefas
  */
@@ -44,7 +140,13 @@ void tarefa_8(void);
 /*
  * Configuracao dos tamanhos das pilhas
  */
+#if SINCRONISMO
+#define TAM_PILHA_1			(TAM_MINIMO_PILHA + RADIO_PILHA + SINCRONISMO_PILHA)	/* tarefa do radio */
+#elif RADIO_RF233
+#define TAM_PILHA_1			(TAM_MINIMO_PILHA + RADIO_PILHA)	/* tarefa do radio */
+#else
 #define TAM_PILHA_1			(TAM_MINIMO_PILHA + 24)
+#endif
 #define TAM_PILHA_2			(TAM_MINIMO_PILHA + 24)
 #define TAM_PILHA_3			(TAM_MINIMO_PILHA + 24)
 #define TAM_PILHA_4			(TAM_MINIMO_PILHA + 24)
@@ -67,11 +169,53 @@ uint32_t PILHA_TAREFA_7[TAM_PILHA_7];
 uint32_t PILHA_TAREFA_8[TAM_PILHA_8];
 uint32_t PILHA_TAREFA_OCIOSA[TAM_PILHA_OCIOSA];
 
+#if RADIO_RF233
+/* endereco curto do no: as quatro palavras do numero de serie do 
+   microcontrolador, dobradas em 16 bits (sem o endereco de difusao) */
+static uint16_t EnderecoDoNo(void)
+{
+	uint32_t serie = *(volatile uint32_t *)0x0080A00CUL ^ *(volatile uint32_t *)0x0080A040UL ^
+					 *(volatile uint32_t *)0x0080A044UL ^ *(volatile uint32_t *)0x0080A048UL;
+	uint16_t endereco = (uint16_t)(serie ^ (serie >> 16));
+	
+	return (endereco == RADIO_DIFUSAO) ? 0xFFFE : endereco;
+}
+#endif
+
 /*
  * Funcao principal de entrada do sistema
  */
 int main(int argc, char** argv)
 {
+#if MEDE_NUCLEO
+	system_init();
+	SerialEdbgInicia(BAUD_MEDICOES);
+#if MEDE_LATENCIA
+	MedeLatenciaCriaTarefas(SerialEdbgEscreve);
+#elif MEDE_THREAD_METRIC
+	MedeThreadMetricCriaTarefas(MEDE_THREAD_METRIC, SerialEdbgEscreve);
+#else
+	MedeNucleoCriaTarefas(SerialEdbgEscreve);
+#endif
+	CriaTarefa(tarefa_ociosa,"Tarefa ociosa", PILHA_TAREFA_OCIOSA, TAM_PILHA_OCIOSA, 0);
+	ConfiguraMarcaTempo();
+	IniciaMultitarefas();
+#endif
+#if RADIO_RF233
+	system_init();
+	RadioInicia(EnderecoDoNo());
+#if SINCRONISMO
+	SincronismoInicia(NO_REFERENCIA);
+#endif
+	CriaTarefa(tarefa_radio, "Radio", PILHA_TAREFA_1, TAM_PILHA_1, 2);
+	CriaTarefa(tarefa_telemetria, "Telemetria", PILHA_TAREFA_2, TAM_PILHA_2, 1);
+#if RADIO_ESCUTA_PERIODO > 0
+	CriaTarefa(tarefa_temporizadores, "Temporizadores", PILHA_TAREFA_3, TAM_PILHA_3, 3);
+#endif
+	CriaTarefa(tarefa_ociosa,"Tarefa ociosa", PILHA_TAREFA_OCIOSA, TAM_PILHA_OCIOSA, 0);
+	ConfiguraMarcaTempo();
+	IniciaMultitarefas();
+#endif
 #if 0
 	system_init();
 #endif	
@@ -224,21 +368,12 @@ void tarefa_8(void)
 		
 	for(;;)
 	{
-		volatile uint8_t contador;
-		
-		do{
-			REG_ATOMICA_INICIO();			
-				contador = SemaforoCheio.contador;			
-			REG_ATOMICA_FIM();
-			
-			if (contador == 0)
-			{
-				TarefaEspera(100);
-			}
-				
-		} while (!contador);
-		
-		SemaforoAguarda(&SemaforoCheio);
+		/* acorda assim que houver dado; o limite de tempo permite fazer 
+		   outra coisa se a tarefa 7 parar de produzir */
+		while(!SemaforoAguardaTempo(&SemaforoCheio, 100))
+		{
+			/* nenhum dado em 100 marcas de tempo (100ms) */
+		}
 		
 		valor = buffer[f];
 		f = (f+1) % TAM_BUFFER;	
@@ -248,3 +383,116 @@ void tarefa_8(void)
 		SemaforoLibera(&SemaforoVazio);
 	}
 }
+
+#if RADIO_RF233
+/* toda a comunicacao com o transceptor, acima das tarefas que usam o radio */
+void tarefa_radio(void)
+{
+	RadioExecuta();
+}
+
+#if SINCRONISMO
+/* fenda do no no periodo de telemetria: a 0 e a da baliza da referencia */
+static tick_t FendaDoNo(void)
+{
+	uint16_t fenda = NO_REFERENCIA ? 0 : (uint16_t)(1 + EnderecoDoNo() % (FENDAS_TDMA - 1));
+	
+	return (tick_t)fenda * (PERIODO_TELEMETRIA / FENDAS_TDMA);
+}
+
+/* espera o inicio do periodo de telemetria seguinte, no tempo da rede, 
+   recebendo os quadros dos outros nos ate a marca anterior; o despertar 
+   e feito por TarefaEsperaAte, na mesma marca em todos os nos */
+static void EsperaPeriodoDaRede(uint8_t *quadro)
+{
+	tick_t rede = SincronismoMarcasRede();
+	tick_t inicio = rede - (rede % PERIODO_TELEMETRIA) + PERIODO_TELEMETRIA;
+	tick_t ultimo = SincronismoParaLocal(inicio) - PERIODO_TELEMETRIA;
+	tick_t falta;
+	
+	while((falta = SincronismoParaLocal(inicio) - ObtemMarcasDeTempo()) > 1 && 
+		  falta <= PERIODO_TELEMETRIA)
+	{
+		(void)RadioRecebeQuadro(quadro, 0, falta - 1);
+	}
+	TarefaEsperaAte(&ultimo, PERIODO_TELEMETRIA);
+}
+
+/* a cada periodo da rede: inverte o LED e, na fenda do no, envia a rajada 
+   de LEITURAS_TELEMETRIA quadros (ou a baliza, na referencia) */
+void tarefa_telemetria(void)
+{
+	static uint8_t quadro[RADIO_MAIOR_QUADRO];
+	tick_t ultimo;
+	uint32_t rajada = 0;
+	uint8_t i;
+	
+	for(;;)
+	{
+		EsperaPeriodoDaRede(quadro);
+		if(SincronismoEstado() == SINC_SINCRONIZADO)
+		{
+			port_pin_toggle_output_level(LED_0_PIN);
+		}
+		
+		ultimo = ObtemMarcasDeTempo();
+		TarefaEsperaAte(&ultimo, FendaDoNo());
+		if(NO_REFERENCIA)
+		{
+			(void)SincronismoEnviaBaliza();
+			continue;
+		}
+		if(SincronismoEstado() == SINC_SEM_REFERENCIA)
+		{
+			continue;						/* sem fendas: nao transmite */
+		}
+		for(i = 0; i < LEITURAS_TELEMETRIA; i++)
+		{
+			quadro[0] = i;
+			quadro[1] = (uint8_t)rajada;
+			quadro[2] = (uint8_t)(rajada >> 8);
+			quadro[3] = (uint8_t)(rajada >> 16);
+			quadro[4] = (uint8_t)(rajada >> 24);
+			(void)RadioEnviaQuadro(RADIO_DIFUSAO, quadro, 5, PERIODO_TELEMETRIA / FENDAS_TDMA);
+		}
+		RadioDescarrega();
+		rajada++;
+	}
+}
+#else
+/* rajada de LEITURAS_TELEMETRIA quadros por periodo, agregados em uma 
+   unica PSDU; entre as rajadas, recebe os quadros dos outros nos */
+void tarefa_telemetria(void)
+{
+	static uint8_t quadro[RADIO_MAIOR_QUADRO];
+	tick_t ultimo_envio = ObtemMarcasDeTempo();
+	tick_t decorrido;
+	uint32_t rajada = 0;
+	uint8_t i;
+	
+	for(;;)
+	{
+		for(i = 0; i < LEITURAS_TELEMETRIA; i++)
+		{
+			quadro[0] = i;						/* tipo da leitura */
+			quadro[1] = (uint8_t)rajada;
+			quadro[2] = (uint8_t)(rajada >> 8);
+			quadro[3] = (uint8_t)(rajada >> 16);
+			quadro[4] = (uint8_t)(rajada >> 24);
+			(void)RadioEnviaQuadro(RADIO_DIFUSAO, quadro, 5, PERIODO_TELEMETRIA);
+		}
+		RadioDescarrega();						/* fim da rajada: nao espera o prazo de agregacao */
+		rajada++;
+		
+		while((decorrido = ObtemMarcasDeTempo() - ultimo_envio) < PERIODO_TELEMETRIA)
+		{
+			if(RadioRecebeQuadro(quadro, 0, PERIODO_TELEMETRIA - decorrido) > 0)
+			{
+				port_pin_toggle_output_level(LED_0_PIN);
+			}
+		}
+		ultimo_envio += PERIODO_TELEMETRIA;
+	}
+}
+#endif /* SINCRONISMO */
+#endif
@@ -0,0 +1,1093 @@
+/*
+ * radio_rf233.c
+ *
+ * Radio 802.15.4 pelo AT86RF233 (ver radio_rf233.h).
+ *
+ * O transceptor fica em RX_ON. Para enviar, a tarefa do radio passa para
+ * PLL_ON, escreve a PSDU no buffer do transceptor (o FCS e calculado por
+ * ele) e comanda TX_START; a interrupcao TRX_END do fim da transmissao o
+ * devolve a RX_ON. Na recepcao, a mesma interrupcao indica uma PSDU no
+ * buffer, protegido ate ser lido (RX_SAFE_MODE).
+ *
+ * Os registradores sao lidos e escritos por espera ocupada (dois bytes no
+ * SPI, menos tempo que programar o DMAC e trocar de contexto) e os acessos
+ * ao buffer, de ate 129 bytes, por DMA, com a tarefa bloqueada ate o fim.
+ * A interrupcao do EIC marca o instante e notifica a tarefa: o IRQ_STATUS
+ * e lido por ela, pelo SPI.
+ *
+ * Na escuta periodica, o transceptor dorme (SLP_TR em 1, a partir de
+ * TRX_OFF) fora das janelas. Um temporizador periodico abre a janela e um
+ * de uma vez a fecha; uma PSDU recebida a prolonga. Para enviar, a tarefa
+ * acorda o transceptor e, ao fim de cada transmissao, comanda TX_START de
+ * novo ate completar um periodo e uma janela: o buffer ainda tem a PSDU,
+ * porque nada e recebido em PLL_ON.
+ */
+
+#include <asf.h>
+#include "dma.h"
+#include "radio_rf233.h"
+
+#if RADIO_RF233
+
+#if (RADIO_TAM_RECEPCAO & (RADIO_TAM_RECEPCAO - 1)) != 0 || RADIO_TAM_RECEPCAO > 512
+#error "RADIO_TAM_RECEPCAO deve ser potencia de 2, ate 512 (o semaforo conta ate 255 quadros)"
+#endif
+
+#define SERCOM_RADIO			AT86RFX_SPI
+
+/* PAD0 recebe (MISO), PAD2 envia (MOSI) e PAD3 e o clock. O CS e um pino
+   comum, controlado em cada acesso */
+#define SPI_DIPO				0
+#define SPI_DOPO				1
+
+/* registradores do AT86RF233 */
+#define RG_TRX_STATUS			0x01
+#define RG_TRX_STATE			0x02
+#define RG_TRX_CTRL_1			0x04
+#define RG_PHY_RSSI				0x06
+#define RG_PHY_CC_CCA			0x08
+#define RG_TRX_CTRL_2			0x0C
+#define RG_IRQ_MASK				0x0E
+#define RG_IRQ_STATUS			0x0F
+#define RG_PART_NUM				0x1C
+
+/* primeiro byte de cada acesso pelo SPI */
+#define SPI_LE_REGISTRADOR		0x80
+#define SPI_ESCREVE_REGISTRADOR	0xC0
+#define SPI_LE_BUFFER			0x20
+#define SPI_ESCREVE_BUFFER		0x60
+
+/* comandos de TRX_STATE e estados lidos em TRX_STATUS */
+#define CMD_TX_START			0x02
+#define CMD_FORCE_TRX_OFF		0x03
+#define CMD_FORCE_PLL_ON		0x04
+#define CMD_RX_ON				0x06
+#define CMD_TRX_OFF				0x08
+#define CMD_PLL_ON				0x09
+#define ESTADO_BUSY_RX			0x01
+#define ESTADO_RX_ON			0x06
+#define ESTADO_TRX_OFF			0x08
+#define ESTADO_PLL_ON			0x09
+#define MASCARA_ESTADO			0x1F
+
+#define IRQ_TRX_END				0x08
+#define TX_AUTO_CRC_ON			0x20
+#define RX_SAFE_MODE			0x80
+#define CCA_MODO_1				0x20
+#define RX_CRC_VALID			0x80
+#define PART_NUM_RF233			0x0B
+
+/* controle do quadro MAC: dados, sem seguranca, PAN comprimida, destino e
+   origem curtos. Na recepcao so esses campos sao conferidos */
+#define CONTROLE_MAC			0x8841
+#define MASCARA_CONTROLE		0xCC4F
+
+#define STX						0x02
+#define ETX						0x03
+#define SYN						0x16		/* inicio da carga de uma baliza */
+
+/* bits de notificacao da tarefa do radio */
+#define EVENTO_INTERRUPCAO		0x01
+#define EVENTO_ENVIO			0x02
+#define EVENTO_ESCUTA			0x04
+#define EVENTO_FIM_JANELA		0x08
+
+/* PSDU em transmissao (transmitindo) */
+#define ENVIO_QUADROS			1
+#define ENVIO_BALIZA			2
+
+/* buffer de envio no formato da escrita pelo SPI: comando, PHR, cabecalho
+   MAC e carga (o FCS fica com o transceptor) */
+#define POS_PHR					1
+#define POS_CABECALHO			2
+#define TAM_CABECALHO			9
+#define POS_CARGA				(POS_CABECALHO + TAM_CABECALHO)
+#define TAM_FCS					2
+
+/* leituras de TRX_STATUS ate a troca de estado (~10 us cada; a mais longa,
+   de P_ON para TRX_OFF, leva ~0,3 ms) */
+#define TENTATIVAS_ESTADO		100
+
+/* marcas sem TRX_END antes de desistir do envio (a maior PSDU leva ~4 ms) */
+#define ESPERA_FIM_ENVIO		(cfg_MARCA_TEMPO_HZ / 50 + 1)
+
+estatisticas_radio_t estatisticas_radio;
+
+static uint16_t endereco_local;
+static uint8_t tarefa_radio = 0;
+static uint8_t sequencia = 0;
+
+/* duas PSDUs: a de montagem recebe os quadros de RadioEnviaQuadro e a
+   outra e a do envio em andamento. A troca e feita pela tarefa do radio */
+static uint8_t psdu[2][POS_CARGA + RADIO_CARGA];
+static uint8_t montagem = 0;
+static volatile uint8_t carga[2];				/* bytes de quadros em cada PSDU */
+static uint8_t quadros[2];						/* quadros em cada PSDU */
+static uint16_t destino_montagem;
+static volatile tick_t marca_montagem;			/* marca do primeiro quadro da montagem */
+static volatile uint8_t montagem_pronta = 0;	/* envia sem esperar o prazo de agregacao */
+static mutex_t acesso_montagem = {0,0};
+static semaforo_t montagem_livre = {0,0};		/* a montagem foi trocada por uma vazia */
+
+static uint8_t transmitindo = 0;				/* 0, ENVIO_QUADROS ou ENVIO_BALIZA */
+static uint8_t psdu_envio;
+static tick_t marca_envio;
+static uint8_t adiado = 0;						/* envio adiado por uma recepcao em andamento */
+
+static uint8_t psdu_recepcao[RADIO_TAM_PSDU];
+static anel_t anel_recepcao;
+static uint8_t area_recepcao[RADIO_TAM_RECEPCAO];
+static semaforo_t quadros_no_anel = {0,0};
+
+/* baliza: carga a enviar (SYN e dados), instante do ultimo envio e 
+   funcao que recebe as balizas dos outros nos */
+static uint8_t psdu_baliza[POS_CARGA + 1 + RADIO_MAIOR_BALIZA];
+static uint8_t tamanho_baliza;
+static volatile uint8_t baliza_pendente = 0;
+static instante_radio_t instante_baliza;
+static volatile uint8_t baliza_enviada = 0;
+static trata_baliza_t trata_baliza = 0;
+
+static semaforo_t fim_dma = {0,0};
+static const uint8_t byte_vazio = 0;
+static uint8_t byte_descarte;
+
+#if RADIO_ESCUTA_PERIODO > 0
+/* escuta periodica: transceptor fora de SLEEP, janela aberta, inicio da
+   transmissao em curso (todas as copias) e ultimas sequencias recebidas */
+static tick_t periodo_escuta = RADIO_ESCUTA_PERIODO;
+static uint8_t acordado = 1;
+static uint8_t janela_aberta = 0;
+static tick_t marca_acordou;
+static tick_t inicio_trem;
+static temporizador_t temporizador_escuta;
+static temporizador_t temporizador_janela;
+static uint16_t origens[RADIO_ORIGENS];
+static uint8_t sequencias[RADIO_ORIGENS];
+static uint8_t proxima_origem = 0;
+#endif
+
+/* instante da ultima interrupcao TRX_END (unica habilitada) */
+static volatile instante_radio_t instante_fim;
+
+/* linha do transceptor: marca o instante do fim da PSDU, o mais perto 
+   possivel da borda, e notifica a tarefa, que le o IRQ_STATUS */
+void EIC_Handler(void)
+{
+	reg_atomica_t estado;
+	uint32_t contagens;
+	
+	REG_ATOMICA_INICIO(estado);
+	instante_fim.marcas = MarcaTempoInstante(&contagens);
+	REG_ATOMICA_FIM(estado);
+	instante_fim.contagens = contagens;
+	
+	EIC->INTFLAG.reg = 1UL << AT86RFX_IRQ_CHAN;
+	if(tarefa_radio != 0)
+	{
+		TarefaNotifica(tarefa_radio, EVENTO_INTERRUPCAO, NOTIFICA_BITS);
+	}
+}
+
+/*
+ * Acesso ao transceptor pelo SPI
+ */
+static void Seleciona(void)
+{
+	port_pin_set_output_level(AT86RFX_SPI_CS, false);
+}
+
+static void Libera(void)
+{
+	port_pin_set_output_level(AT86RFX_SPI_CS, true);
+}
+
+static uint8_t TrocaByte(uint8_t byte)
+{
+	SercomSpi *const spi = &(SERCOM_RADIO->SPI);
+
+	spi->DATA.reg = byte;
+	while(!(spi->INTFLAG.reg & SERCOM_SPI_INTFLAG_RXC)) {}
+	return (uint8_t)spi->DATA.reg;
+}
+
+static uint8_t LeRegistrador(uint8_t endereco)
+{
+	uint8_t valor;
+
+	Seleciona();
+	(void)TrocaByte((uint8_t)(SPI_LE_REGISTRADOR | endereco));
+	valor = TrocaByte(0);
+	Libera();
+	return valor;
+}
+
+static void EscreveRegistrador(uint8_t endereco, uint8_t valor)
+{
+	Seleciona();
+	(void)TrocaByte((uint8_t)(SPI_ESCREVE_REGISTRADOR | endereco));
+	(void)TrocaByte(valor);
+	Libera();
+}
+
+/* interrupcao de fim da recepcao do DMA, chamada pelo DMAC_Handler */
+static void FimDma(void)
+{
+	if(DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL)
+	{
+		DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+		SemaforoLiberaISR(&fim_dma);
+	}
+}
+
+/* continua o acesso em andamento (CS ja ativo) com tamanho bytes por DMA e
+   bloqueia a tarefa ate o fim. envio 0 envia zeros, recepcao 0 descarta */
+static void TransfereDma(const uint8_t *envio, uint8_t *recepcao, uint16_t tamanho)
+{
+	DmacDescriptor *d_recepcao = &dma_descritores[RADIO_DMA_CANAL_RECEPCAO];
+	DmacDescriptor *d_envio = &dma_descritores[RADIO_DMA_CANAL_ENVIO];
+	reg_atomica_t estado;
+
+	/* enderecos incrementados apontam para o fim da area */
+	d_recepcao->BTCNT.reg = tamanho;
+	if(recepcao != 0)
+	{
+		d_recepcao->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_DSTINC |
+								DMAC_BTCTRL_BLOCKACT_INT;
+		d_recepcao->DSTADDR.reg = (uint32_t)&recepcao[tamanho];
+	}
+	else
+	{
+		d_recepcao->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_BLOCKACT_INT;
+		d_recepcao->DSTADDR.reg = (uint32_t)&byte_descarte;
+	}
+
+	d_envio->BTCNT.reg = tamanho;
+	if(envio != 0)
+	{
+		d_envio->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+							DMAC_BTCTRL_BLOCKACT_NOACT;
+		d_envio->SRCADDR.reg = (uint32_t)&envio[tamanho];
+	}
+	else
+	{
+		d_envio->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_BLOCKACT_NOACT;
+		d_envio->SRCADDR.reg = (uint32_t)&byte_vazio;
+	}
+
+	/* a recepcao primeiro, para nao perder o primeiro byte. O DMAC_Handler 
+	   tambem usa o DMAC->CHID */
+	REG_ATOMICA_INICIO(estado);
+	DMAC->CHID.reg = RADIO_DMA_CANAL_RECEPCAO;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+	DMAC->CHID.reg = RADIO_DMA_CANAL_ENVIO;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+	REG_ATOMICA_FIM(estado);
+
+	SemaforoAguarda(&fim_dma);
+}
+
+/* espera o estado pedido em TRX_STATE. Retorna 0 se ele nao veio */
+static uint8_t AguardaEstado(uint8_t estado)
+{
+	uint8_t i;
+
+	for(i = 0; i < TENTATIVAS_ESTADO; i++)
+	{
+		if((LeRegistrador(RG_TRX_STATUS) & MASCARA_ESTADO) == estado)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Configuracao da SERCOM, do DMAC, do EIC e do transceptor
+ */
+static void ConfiguraPino(uint32_t pinmux)
+{
+	struct system_pinmux_config config_pino;
+
+	system_pinmux_get_config_defaults(&config_pino);
+	config_pino.mux_position = pinmux & 0xFFFF;
+	system_pinmux_pin_set_config(pinmux >> 16, &config_pino);
+}
+
+/* reinicia o canal e escolhe o gatilho e o nivel de prioridade */
+static void ConfiguraCanal(uint8_t canal, uint8_t nivel, uint8_t gatilho)
+{
+	DMAC->CHID.reg = canal;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while(DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST) {}
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(nivel) | DMAC_CHCTRLB_TRIGSRC(gatilho) | DMAC_CHCTRLB_TRIGACT_BEAT;
+}
+
+static void IniciaPerifericos(void)
+{
+	struct system_gclk_chan_config config_clock;
+	struct system_pinmux_config config_pino;
+	struct port_config config_saida;
+	SercomSpi *const spi = &(SERCOM_RADIO->SPI);
+	uint32_t baud;
+
+	/* transceptor em reset, acordado (SLP_TR em 0) e nao selecionado */
+	port_get_config_defaults(&config_saida);
+	config_saida.direction = PORT_PIN_DIR_OUTPUT;
+	port_pin_set_config(AT86RFX_RST_PIN, &config_saida);
+	port_pin_set_output_level(AT86RFX_RST_PIN, false);
+	port_pin_set_config(AT86RFX_SLP_PIN, &config_saida);
+	port_pin_set_output_level(AT86RFX_SLP_PIN, false);
+	port_pin_set_config(AT86RFX_SPI_CS, &config_saida);
+	port_pin_set_output_level(AT86RFX_SPI_CS, true);
+
+	/* SPI mestre, modo 0, MSB primeiro, com o clock do gerador 0 */
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_SERCOM4);
+	system_gclk_chan_get_config_defaults(&config_clock);
+	config_clock.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(SERCOM4_GCLK_ID_CORE, &config_clock);
+	system_gclk_chan_enable(SERCOM4_GCLK_ID_CORE);
+
+	ConfiguraPino(AT86RFX_SPI_SERCOM_PINMUX_PAD0);
+	ConfiguraPino(AT86RFX_SPI_SERCOM_PINMUX_PAD2);
+	ConfiguraPino(AT86RFX_SPI_SERCOM_PINMUX_PAD3);
+
+	spi->CTRLA.reg = SERCOM_SPI_CTRLA_SWRST;
+	while(spi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_SWRST) {}
+
+	spi->CTRLA.reg = SERCOM_SPI_CTRLA_MODE_SPI_MASTER | SERCOM_SPI_CTRLA_DIPO(SPI_DIPO) |
+					SERCOM_SPI_CTRLA_DOPO(SPI_DOPO);
+	spi->CTRLB.reg = SERCOM_SPI_CTRLB_RXEN | SERCOM_SPI_CTRLB_CHSIZE(0);
+	while(spi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_CTRLB) {}
+
+	/* f = clock / (2 * (BAUD + 1)), sem passar de RADIO_FREQUENCIA_SPI */
+	baud = (system_gclk_gen_get_hz(GCLK_GENERATOR_0) + (2 * RADIO_FREQUENCIA_SPI) - 1) / (2 * RADIO_FREQUENCIA_SPI);
+	spi->BAUD.reg = (uint8_t)((baud > 0) ? (baud - 1) : 0);
+
+	/* um unico bloco por acesso, sem descritor seguinte */
+	dma_descritores[RADIO_DMA_CANAL_RECEPCAO].SRCADDR.reg = (uint32_t)&spi->DATA.reg;
+	dma_descritores[RADIO_DMA_CANAL_RECEPCAO].DESCADDR.reg = 0;
+	dma_descritores[RADIO_DMA_CANAL_ENVIO].DSTADDR.reg = (uint32_t)&spi->DATA.reg;
+	dma_descritores[RADIO_DMA_CANAL_ENVIO].DESCADDR.reg = 0;
+
+	DmaIniciaControlador();
+	DmaRegistraTratador(RADIO_DMA_CANAL_RECEPCAO, FimDma);
+
+	ConfiguraCanal(RADIO_DMA_CANAL_ENVIO, 0, SERCOM4_DMAC_ID_TX);
+	ConfiguraCanal(RADIO_DMA_CANAL_RECEPCAO, 1, SERCOM4_DMAC_ID_RX);
+	DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+
+	spi->CTRLA.reg |= SERCOM_SPI_CTRLA_ENABLE;
+	while(spi->SYNCBUSY.reg & SERCOM_SPI_SYNCBUSY_ENABLE) {}
+
+	/* EIC: borda de subida no pino IRQ do transceptor (ativo em 1 e
+	   mantido ate a leitura de IRQ_STATUS) */
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBA, PM_APBAMASK_EIC);
+	system_gclk_chan_set_config(EIC_GCLK_ID, &config_clock);
+	system_gclk_chan_enable(EIC_GCLK_ID);
+
+	system_pinmux_get_config_defaults(&config_pino);
+	config_pino.mux_position = AT86RFX_IRQ_PINMUX & 0xFFFF;
+	config_pino.direction = SYSTEM_PINMUX_PIN_DIR_INPUT;
+	config_pino.input_pull = SYSTEM_PINMUX_PIN_PULL_NONE;
+	system_pinmux_pin_set_config(AT86RFX_IRQ_PINMUX >> 16, &config_pino);
+
+	EIC->CTRL.reg = 0;
+	while(EIC->STATUS.reg & EIC_STATUS_SYNCBUSY) {}
+	EIC->CONFIG[AT86RFX_IRQ_CHAN / 8].reg = (EIC->CONFIG[AT86RFX_IRQ_CHAN / 8].reg &
+											~(EIC_CONFIG_SENSE0_Msk << (4 * (AT86RFX_IRQ_CHAN % 8)))) |
+											(EIC_CONFIG_SENSE0_RISE << (4 * (AT86RFX_IRQ_CHAN % 8)));
+	EIC->INTFLAG.reg = 1UL << AT86RFX_IRQ_CHAN;
+	EIC->INTENSET.reg = 1UL << AT86RFX_IRQ_CHAN;
+	EIC->CTRL.reg = EIC_CTRL_ENABLE;
+	while(EIC->STATUS.reg & EIC_STATUS_SYNCBUSY) {}
+
+	NVIC_EnableIRQ(EIC_IRQn);
+}
+
+/* reinicia o transceptor e o deixa em RX_ON. Retorna 0 se ele nao responde */
+static uint8_t IniciaTransceptor(void)
+{
+	port_pin_set_output_level(AT86RFX_SLP_PIN, false);
+	port_pin_set_output_level(AT86RFX_RST_PIN, false);
+	TarefaEspera(1);
+	port_pin_set_output_level(AT86RFX_RST_PIN, true);
+	TarefaEspera(1);
+
+	if(LeRegistrador(RG_PART_NUM) != PART_NUM_RF233)
+	{
+		return 0;
+	}
+	EscreveRegistrador(RG_TRX_STATE, CMD_FORCE_TRX_OFF);
+	if(!AguardaEstado(ESTADO_TRX_OFF))
+	{
+		return 0;
+	}
+
+	EscreveRegistrador(RG_TRX_CTRL_1, TX_AUTO_CRC_ON);
+	EscreveRegistrador(RG_TRX_CTRL_2, RX_SAFE_MODE);	/* 250 kbit/s */
+	EscreveRegistrador(RG_PHY_CC_CCA, (uint8_t)(CCA_MODO_1 | RADIO_CANAL));
+	EscreveRegistrador(RG_IRQ_MASK, IRQ_TRX_END);
+	(void)LeRegistrador(RG_IRQ_STATUS);
+
+	EscreveRegistrador(RG_TRX_STATE, CMD_RX_ON);
+	return AguardaEstado(ESTADO_RX_ON);
+}
+
+/*
+ * Recepcao
+ */
+
+/* guarda o quadro no anel como origem (2 bytes), QTD e dados */
+static void GuardaQuadro(uint16_t origem, const uint8_t *dados, uint8_t qtd)
+{
+	uint8_t cabecalho[3];
+	uint16_t livre = (uint16_t)(anel_recepcao.mascara + 1 -
+								(uint16_t)(anel_recepcao.escrita - anel_recepcao.leitura));
+
+	if(livre < (uint16_t)(sizeof(cabecalho) + qtd))
+	{
+		estatisticas_radio.quadros_perdidos++;
+		return;
+	}
+	cabecalho[0] = (uint8_t)origem;
+	cabecalho[1] = (uint8_t)(origem >> 8);
+	cabecalho[2] = qtd;
+	(void)AnelEscreve(&anel_recepcao, cabecalho, sizeof(cabecalho));
+	(void)AnelEscreve(&anel_recepcao, dados, qtd);
+	estatisticas_radio.quadros_recebidos++;
+	SemaforoLibera(&quadros_no_anel);
+}
+
+#if RADIO_ESCUTA_PERIODO > 0
+/* a PSDU de origem com a sequencia ja foi recebida (outra copia)? Guarda
+   a ultima sequencia das RADIO_ORIGENS origens mais recentes */
+static uint8_t Repetida(uint16_t origem, uint8_t sequencia_psdu)
+{
+	uint8_t i;
+
+	for(i = 0; i < RADIO_ORIGENS; i++)
+	{
+		if(origens[i] == origem)
+		{
+			if(sequencias[i] == sequencia_psdu)
+			{
+				return 1;
+			}
+			sequencias[i] = sequencia_psdu;
+			return 0;
+		}
+	}
+	origens[proxima_origem] = origem;
+	sequencias[proxima_origem] = sequencia_psdu;
+	proxima_origem = (uint8_t)((proxima_origem + 1) % RADIO_ORIGENS);
+	return 0;
+}
+#endif
+
+/* confere o cabecalho MAC e separa os quadros da carga, ou entrega a 
+   baliza. Um quadro com erro descarta o resto da PSDU, porque o proximo 
+   STX nao e confiavel */
+static void SeparaQuadros(const uint8_t *p, uint8_t tamanho, const instante_radio_t *fim_psdu)
+{
+	const uint8_t *fim = p + tamanho;
+	uint16_t controle = (uint16_t)(p[0] | (p[1] << 8));
+	uint16_t pan = (uint16_t)(p[3] | (p[4] << 8));
+	uint16_t destino = (uint16_t)(p[5] | (p[6] << 8));
+	uint16_t origem = (uint16_t)(p[7] | (p[8] << 8));
+	uint8_t qtd, soma, i;
+
+	if((controle & MASCARA_CONTROLE) != CONTROLE_MAC || pan != RADIO_PAN ||
+		(destino != endereco_local && destino != RADIO_DIFUSAO))
+	{
+		estatisticas_radio.psdus_descartadas++;
+		return;
+	}
+	#if RADIO_ESCUTA_PERIODO > 0
+	if(Repetida(origem, p[2]))
+	{
+		estatisticas_radio.psdus_repetidas++;
+		return;
+	}
+	#endif
+	estatisticas_radio.psdus_recebidas++;
+
+	if(tamanho > TAM_CABECALHO && p[TAM_CABECALHO] == SYN)
+	{
+		if(trata_baliza != 0)
+		{
+			estatisticas_radio.balizas_recebidas++;
+			trata_baliza(origem, &p[TAM_CABECALHO + 1], (uint8_t)(tamanho - TAM_CABECALHO - 1), fim_psdu);
+		}
+		return;
+	}
+
+	for(p += TAM_CABECALHO; p < fim; p += qtd + 4)
+	{
+		qtd = (fim - p >= 5) ? p[1] : 0;
+		if(p[0] != STX || qtd == 0 || qtd > fim - p - 4)
+		{
+			estatisticas_radio.quadros_invalidos++;
+			return;
+		}
+		for(soma = 0, i = 0; i < qtd; i++)
+		{
+			soma = (uint8_t)(soma + p[2 + i]);
+		}
+		if(p[2 + qtd] != soma || p[3 + qtd] != ETX)
+		{
+			estatisticas_radio.quadros_invalidos++;
+			return;
+		}
+		GuardaQuadro(origem, &p[2], qtd);
+	}
+}
+
+/* le a PSDU do buffer. Com FCS errado so le o PHR: o fim do acesso ja
+   libera o buffer para a proxima recepcao, e so entao pode haver outro
+   TRX_END (o instante marcado ainda e o desta PSDU) */
+static void RecebePsdu(void)
+{
+	uint8_t crc_valido = (uint8_t)(LeRegistrador(RG_PHY_RSSI) & RX_CRC_VALID);
+	uint8_t phr;
+	instante_radio_t fim_psdu;
+
+	fim_psdu.marcas = instante_fim.marcas;
+	fim_psdu.contagens = instante_fim.contagens;
+
+	Seleciona();
+	(void)TrocaByte(SPI_LE_BUFFER);					/* PHY_STATUS */
+	phr = (uint8_t)(TrocaByte(0) & 0x7F);
+	crc_valido = (uint8_t)(crc_valido && phr >= TAM_CABECALHO + TAM_FCS);
+	if(crc_valido)
+	{
+		TransfereDma(0, psdu_recepcao, phr);
+	}
+	Libera();
+
+	if(!crc_valido)
+	{
+		estatisticas_radio.psdus_descartadas++;
+		return;
+	}
+	SeparaQuadros(psdu_recepcao, (uint8_t)(phr - TAM_FCS), &fim_psdu);
+}
+
+#if RADIO_ESCUTA_PERIODO > 0
+/*
+ * Escuta periodica
+ */
+
+/* tira o transceptor de SLEEP (~0,2 ms ate TRX_OFF). Retorna 0 se ele
+   nao respondeu */
+static uint8_t Acorda(void)
+{
+	if(acordado)
+	{
+		return 1;
+	}
+	port_pin_set_output_level(AT86RFX_SLP_PIN, false);
+	if(!AguardaEstado(ESTADO_TRX_OFF))
+	{
+		port_pin_set_output_level(AT86RFX_SLP_PIN, true);
+		return 0;
+	}
+	acordado = 1;
+	marca_acordou = ObtemMarcasDeTempo();
+	return 1;
+}
+
+/* poe o transceptor em SLEEP, se nao estiver recebendo uma PSDU. Uma PSDU
+   recebida e ainda nao lida (RX_SAFE_MODE) e perdida: a tarefa do radio
+   so dorme depois de tratar as notificacoes */
+static void Dorme(void)
+{
+	if((LeRegistrador(RG_TRX_STATUS) & MASCARA_ESTADO) == ESTADO_BUSY_RX)
+	{
+		return;
+	}
+	EscreveRegistrador(RG_TRX_STATE, CMD_TRX_OFF);
+	if(!AguardaEstado(ESTADO_TRX_OFF))
+	{
+		return;
+	}
+	port_pin_set_output_level(AT86RFX_SLP_PIN, true);
+	acordado = 0;
+	estatisticas_radio.marcas_ligado += ObtemMarcasDeTempo() - marca_acordou;
+}
+
+/* abre a janela de escuta: RX_ON por RADIO_ESCUTA_JANELA marcas */
+static void AbreJanela(void)
+{
+	if(!Acorda())
+	{
+		return;
+	}
+	if(!transmitindo)
+	{
+		EscreveRegistrador(RG_TRX_STATE, CMD_RX_ON);
+	}
+	janela_aberta = 1;
+	TemporizadorLiga(&temporizador_janela, RADIO_ESCUTA_JANELA, 0);
+}
+
+static void Notifica(uint32_t evento);
+
+/* funcoes dos temporizadores, na tarefa de temporizadores */
+static void InicioDaJanela(void *arg)
+{
+	(void)arg;
+	Notifica(EVENTO_ESCUTA);
+}
+
+static void FimDaJanela(void *arg)
+{
+	(void)arg;
+	Notifica(EVENTO_FIM_JANELA);
+}
+#endif
+
+/*
+ * Envio
+ */
+
+/* passa o transceptor para PLL_ON. Durante uma recepcao (BUSY_RX) o 
+   PLL_ON so vem depois do fim dela: o envio e adiado e retorna 0 */
+static uint8_t PreparaEnvio(void)
+{
+	#if RADIO_ESCUTA_PERIODO > 0
+	if(!Acorda())
+	{
+		adiado = 1;
+		return 0;
+	}
+	#endif
+	if((LeRegistrador(RG_TRX_STATUS) & MASCARA_ESTADO) == ESTADO_BUSY_RX)
+	{
+		adiado = 1;
+		return 0;
+	}
+	EscreveRegistrador(RG_TRX_STATE, CMD_PLL_ON);
+	adiado = (uint8_t)!AguardaEstado(ESTADO_PLL_ON);
+	if(adiado)
+	{
+		return 0;
+	}
+
+	/* uma recepcao terminada na troca de estado ainda esta no buffer */
+	if(TarefaAguardaNotificacao(0) & EVENTO_INTERRUPCAO)
+	{
+		if(LeRegistrador(RG_IRQ_STATUS) & IRQ_TRX_END)
+		{
+			RecebePsdu();
+		}
+	}
+	return 1;
+}
+
+/* completa o cabecalho MAC da PSDU p (no formato da escrita pelo SPI), com 
+   tamanho bytes de carga, escreve-a no buffer e inicia a transmissao */
+static void Transmite(uint8_t *p, uint16_t destino, uint8_t tamanho, uint8_t envio)
+{
+	p[0] = SPI_ESCREVE_BUFFER;
+	p[POS_PHR] = (uint8_t)(TAM_CABECALHO + tamanho + TAM_FCS);
+	p[POS_CABECALHO + 0] = (uint8_t)CONTROLE_MAC;
+	p[POS_CABECALHO + 1] = (uint8_t)(CONTROLE_MAC >> 8);
+	p[POS_CABECALHO + 2] = sequencia++;
+	p[POS_CABECALHO + 3] = (uint8_t)RADIO_PAN;
+	p[POS_CABECALHO + 4] = (uint8_t)(RADIO_PAN >> 8);
+	p[POS_CABECALHO + 5] = (uint8_t)destino;
+	p[POS_CABECALHO + 6] = (uint8_t)(destino >> 8);
+	p[POS_CABECALHO + 7] = (uint8_t)endereco_local;
+	p[POS_CABECALHO + 8] = (uint8_t)(endereco_local >> 8);
+
+	Seleciona();
+	TransfereDma(p, 0, (uint16_t)(POS_CARGA + tamanho));
+	Libera();
+
+	EscreveRegistrador(RG_TRX_STATE, CMD_TX_START);
+	transmitindo = envio;
+	marca_envio = ObtemMarcasDeTempo();
+	#if RADIO_ESCUTA_PERIODO > 0
+	inicio_trem = marca_envio;
+	#endif
+}
+
+/* troca a montagem por uma PSDU vazia e transmite a montada */
+static void EnviaMontagem(void)
+{
+	uint8_t tamanho;
+	uint16_t destino;
+
+	if(!PreparaEnvio())
+	{
+		return;
+	}
+
+	MutexAguarda(&acesso_montagem);
+	psdu_envio = montagem;
+	montagem ^= 1;
+	carga[montagem] = 0;
+	quadros[montagem] = 0;
+	montagem_pronta = 0;
+	tamanho = carga[psdu_envio];
+	destino = destino_montagem;
+	MutexLibera(&acesso_montagem);
+	if(montagem_livre.contador == 0)
+	{
+		SemaforoLibera(&montagem_livre);
+	}
+
+	Transmite(psdu[psdu_envio], destino, tamanho, ENVIO_QUADROS);
+}
+
+/* transmite a baliza pendente, para todos os nos */
+static void EnviaBaliza(void)
+{
+	if(!PreparaEnvio())
+	{
+		return;
+	}
+	baliza_pendente = 0;
+	Transmite(psdu_baliza, RADIO_DIFUSAO, tamanho_baliza, ENVIO_BALIZA);
+}
+
+/* TRX_END: fim do envio (volta a RX_ON) ou PSDU recebida */
+static void TrataInterrupcao(void)
+{
+	if(!(LeRegistrador(RG_IRQ_STATUS) & IRQ_TRX_END))
+	{
+		return;
+	}
+	if(transmitindo)
+	{
+		#if RADIO_ESCUTA_PERIODO > 0
+		/* outra copia, ate cobrir a janela de todos os nos */
+		if((tick_t)(ObtemMarcasDeTempo() - inicio_trem) < periodo_escuta + RADIO_ESCUTA_JANELA)
+		{
+			EscreveRegistrador(RG_TRX_STATE, CMD_TX_START);
+			marca_envio = ObtemMarcasDeTempo();
+			estatisticas_radio.repeticoes++;
+			return;
+		}
+		#endif
+		if(transmitindo == ENVIO_BALIZA)
+		{
+			instante_baliza.marcas = instante_fim.marcas;
+			instante_baliza.contagens = instante_fim.contagens;
+			baliza_enviada = 1;
+			estatisticas_radio.balizas_enviadas++;
+		}
+		else
+		{
+			estatisticas_radio.psdus_enviadas++;
+			estatisticas_radio.quadros_enviados += quadros[psdu_envio];
+		}
+		transmitindo = 0;
+		EscreveRegistrador(RG_TRX_STATE, CMD_RX_ON);
+	}
+	else
+	{
+		RecebePsdu();
+		#if RADIO_ESCUTA_PERIODO > 0
+		if(janela_aberta)
+		{
+			TemporizadorLiga(&temporizador_janela, RADIO_ESCUTA_JANELA, 0);	/* pode vir outra PSDU */
+		}
+		#endif
+	}
+}
+
+/* marcas ate o proximo envio ou o fim do envio em curso */
+static tick_t EsperaDoEnvio(void)
+{
+	tick_t decorrido;
+
+	if(transmitindo)
+	{
+		decorrido = ObtemMarcasDeTempo() - marca_envio;
+		return (decorrido < ESPERA_FIM_ENVIO) ? ESPERA_FIM_ENVIO - decorrido : 0;
+	}
+	if(baliza_pendente)
+	{
+		return 1;						/* baliza adiada por uma recepcao */
+	}
+	if(carga[montagem] == 0)
+	{
+		return ESPERA_INFINITA;
+	}
+	if(adiado)
+	{
+		return 1;
+	}
+	if(montagem_pronta)
+	{
+		return 0;
+	}
+	decorrido = ObtemMarcasDeTempo() - marca_montagem;
+	return (decorrido < RADIO_ESPERA_AGREGACAO) ? RADIO_ESPERA_AGREGACAO - decorrido : 0;
+}
+
+/* marcas que a tarefa pode esperar pelo proximo evento */
+static tick_t EsperaDoRadio(void)
+{
+	tick_t espera = EsperaDoEnvio();
+
+	#if RADIO_ESCUTA_PERIODO > 0
+	if(!transmitindo && acordado && !janela_aberta && espera > 1)
+	{
+		espera = 1;						/* SLEEP adiado por uma recepcao */
+	}
+	#endif
+	return espera;
+}
+
+static void Notifica(uint32_t evento)
+{
+	if(tarefa_radio != 0)
+	{
+		TarefaNotifica(tarefa_radio, evento, NOTIFICA_BITS);
+	}
+}
+
+/*
+ * Interface
+ */
+
+/* endereco curto do no e area de recepcao. Chamada antes de criar a tarefa
+   do radio; o transceptor e iniciado pela tarefa */
+void RadioInicia(uint16_t endereco)
+{
+	#if RADIO_ESCUTA_PERIODO > 0
+	uint8_t i;
+
+	for(i = 0; i < RADIO_ORIGENS; i++)
+	{
+		origens[i] = RADIO_DIFUSAO;		/* nenhuma origem usa o endereco de difusao */
+	}
+	TemporizadorInicia(&temporizador_escuta, InicioDaJanela, 0);
+	TemporizadorInicia(&temporizador_janela, FimDaJanela, 0);
+	#endif
+	endereco_local = endereco;
+	(void)AnelInicia(&anel_recepcao, area_recepcao, RADIO_TAM_RECEPCAO, 1);
+}
+
+/* corpo da tarefa do radio. Sem resposta do transceptor, tenta de novo a
+   cada segundo */
+void RadioExecuta(void)
+{
+	tarefa_radio = tarefa_atual;
+	IniciaPerifericos();
+	while(!IniciaTransceptor())
+	{
+		TarefaEspera(cfg_MARCA_TEMPO_HZ);
+	}
+
+	#if RADIO_ESCUTA_PERIODO > 0
+	acordado = 1;
+	marca_acordou = ObtemMarcasDeTempo();
+	TemporizadorLiga(&temporizador_escuta, periodo_escuta, periodo_escuta);
+	#endif
+
+	for(;;)
+	{
+		/* com espera 0 so consulta as notificacoes */
+		uint32_t eventos = TarefaAguardaNotificacao(EsperaDoRadio());
+
+		if(eventos & EVENTO_INTERRUPCAO)
+		{
+			TrataInterrupcao();
+		}
+		#if RADIO_ESCUTA_PERIODO > 0
+		if(eventos & EVENTO_ESCUTA)
+		{
+			AbreJanela();
+		}
+		if(eventos & EVENTO_FIM_JANELA)
+		{
+			janela_aberta = 0;
+		}
+		#endif
+
+		if(transmitindo)
+		{
+			if((tick_t)(ObtemMarcasDeTempo() - marca_envio) >= ESPERA_FIM_ENVIO)
+			{
+				EscreveRegistrador(RG_TRX_STATE, CMD_FORCE_PLL_ON);
+				EscreveRegistrador(RG_TRX_STATE, CMD_RX_ON);
+				transmitindo = 0;
+				estatisticas_radio.falhas_envio++;
+			}
+		}
+		else if(baliza_pendente)
+		{
+			EnviaBaliza();
+		}
+		else if(carga[montagem] != 0 && (adiado || EsperaDoEnvio() == 0))
+		{
+			EnviaMontagem();
+		}
+		#if RADIO_ESCUTA_PERIODO > 0
+		else if(acordado && !janela_aberta)
+		{
+			Dorme();					/* a PSDU em montagem o acorda no fim do prazo */
+		}
+		#endif
+	}
+}
+
+/* agrega o quadro STX, QTD, dados, CHK, ETX a PSDU para destino. Se o
+   quadro nao cabe na PSDU em montagem (ou ela vai para outro destino),
+   espera a troca por uma vazia por ate timeout marcas a cada tentativa.
+   Retorna 1 se o quadro foi aceito e 0 se o tempo se esgotou ou qtd e 0
+   ou maior que RADIO_MAIOR_QUADRO */
+uint8_t RadioEnviaQuadro(uint16_t destino, const uint8_t *dados, uint8_t qtd, tick_t timeout)
+{
+	uint8_t *p;
+	uint8_t usada, soma, i;
+	uint8_t avisa = 0;
+
+	if(qtd == 0 || qtd > RADIO_MAIOR_QUADRO)
+	{
+		return 0;
+	}
+
+	for(;;)
+	{
+		MutexAguarda(&acesso_montagem);
+		usada = carga[montagem];
+		if(usada == 0 || (destino == destino_montagem && usada + qtd + 4 <= RADIO_CARGA))
+		{
+			break;
+		}
+		montagem_pronta = 1;
+		MutexLibera(&acesso_montagem);
+		Notifica(EVENTO_ENVIO);
+		if(!SemaforoAguardaTempo(&montagem_livre, timeout))
+		{
+			return 0;
+		}
+	}
+
+	p = &psdu[montagem][POS_CARGA + usada];
+	p[0] = STX;
+	p[1] = qtd;
+	for(soma = 0, i = 0; i < qtd; i++)
+	{
+		p[2 + i] = dados[i];
+		soma = (uint8_t)(soma + dados[i]);
+	}
+	p[2 + qtd] = soma;
+	p[3 + qtd] = ETX;
+
+	if(usada == 0)
+	{
+		destino_montagem = destino;
+		marca_montagem = ObtemMarcasDeTempo();
+		avisa = 1;							/* inicia o prazo de agregacao */
+	}
+	usada = (uint8_t)(usada + qtd + 4);
+	carga[montagem] = usada;
+	quadros[montagem]++;
+	if(usada + 5 > RADIO_CARGA)
+	{
+		montagem_pronta = 1;				/* nao cabe mais nenhum quadro */
+		avisa = 1;
+	}
+	MutexLibera(&acesso_montagem);
+
+	if(avisa)
+	{
+		Notifica(EVENTO_ENVIO);
+	}
+	return 1;
+}
+
+/* envia a PSDU em montagem sem esperar o prazo de agregacao */
+void RadioDescarrega(void)
+{
+	if(carga[montagem] != 0)
+	{
+		montagem_pronta = 1;
+		Notifica(EVENTO_ENVIO);
+	}
+}
+
+/* espera um quadro por ate timeout marcas e o copia para dados (com espaco
+   para RADIO_MAIOR_QUADRO bytes). Retorna a QTD do quadro, ou 0 se o tempo
+   se esgotou. origem (se nao for 0) recebe o endereco de quem enviou. Uma
+   unica tarefa deve receber */
+uint8_t RadioRecebeQuadro(uint8_t *dados, uint16_t *origem, tick_t timeout)
+{
+	uint8_t cabecalho[3];
+
+	if(!SemaforoAguardaTempo(&quadros_no_anel, timeout))
+	{
+		return 0;
+	}
+	(void)AnelLe(&anel_recepcao, cabecalho, sizeof(cabecalho));
+	(void)AnelLe(&anel_recepcao, dados, cabecalho[2]);
+	if(origem != 0)
+	{
+		*origem = (uint16_t)(cabecalho[0] | (cabecalho[1] << 8));
+	}
+	return cabecalho[2];
+}
+
+/* funcao que recebe as balizas, executada pela tarefa do radio (deve ser 
+   curta e nao bloquear). Chamada antes de criar a tarefa do radio */
+void RadioRegistraBaliza(trata_baliza_t trata)
+{
+	trata_baliza = trata;
+}
+
+/* envia uma baliza de qtd bytes (ate RADIO_MAIOR_BALIZA) a todos os nos, 
+   antes da PSDU em montagem. Retorna 0 se qtd e invalida ou a baliza 
+   anterior ainda esta sendo enviada */
+uint8_t RadioEnviaBaliza(const uint8_t *dados, uint8_t qtd)
+{
+	uint8_t i;
+
+	if(qtd > RADIO_MAIOR_BALIZA || baliza_pendente || transmitindo == ENVIO_BALIZA)
+	{
+		return 0;
+	}
+	psdu_baliza[POS_CARGA] = SYN;
+	for(i = 0; i < qtd; i++)
+	{
+		psdu_baliza[POS_CARGA + 1 + i] = dados[i];
+	}
+	tamanho_baliza = (uint8_t)(qtd + 1);
+	baliza_enviada = 0;
+	baliza_pendente = 1;
+	Notifica(EVENTO_ENVIO);
+	return 1;
+}
+
+/* instante do fim do envio da ultima baliza. Retorna 0 se ela ainda nao 
+   foi (ou nunca sera) transmitida */
+uint8_t RadioInstanteBaliza(instante_radio_t *fim)
+{
+	if(!baliza_enviada)
+	{
+		return 0;
+	}
+	*fim = instante_baliza;
+	return 1;
+}
+
+#if RADIO_ESCUTA_PERIODO > 0
+/* muda o periodo da escuta (no minimo duas janelas): maior economiza
+   energia, menor reduz a latencia. Deve ser o mesmo em todos os nos */
+void RadioDefineEscuta(tick_t periodo)
+{
+	if(periodo < 2 * RADIO_ESCUTA_JANELA)
+	{
+		periodo = 2 * RADIO_ESCUTA_JANELA;
+	}
+	periodo_escuta = periodo;
+	TemporizadorLiga(&temporizador_escuta, periodo, periodo);
+}
+#endif
+
+#endif /* RADIO_RF233 */
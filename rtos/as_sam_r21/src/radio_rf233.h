@@ -0,0 +1,185 @@
+/*
+ * radio_rf233.h
+ *
+ * Radio 802.15.4 pelo transceptor AT86RF233 integrado ao SAM R21 (SAM R21
+ * Xplained Pro), no modo basico (RX_ON/PLL_ON, sem ACK automatico).
+ *
+ * Quadros STX, QTD, DADOS, CHK, ETX (o mesmo protocolo das atividades t2 a
+ * t4) sao agregados em PSDUs de ate 127 bytes: um quadro de dados 802.15.4
+ * com enderecos curtos e a mesma PAN, cuja carga sao varios quadros
+ * seguidos. Cada PSDU enviada carrega ate RADIO_CARGA bytes de quadros, em
+ * vez de um pacote no ar por quadro, o que reduz o cabecalho, o preambulo
+ * e o tempo do radio ligado por byte de dados.
+ *
+ * RadioEnviaQuadro so copia o quadro para a PSDU em montagem. A PSDU e
+ * enviada quando o proximo quadro nao cabe nela ou vai para outro
+ * destino, quando RadioDescarrega e chamada ou RADIO_ESPERA_AGREGACAO
+ * marcas depois do primeiro quadro, o maior atraso que a agregacao
+ * acrescenta. Ha duas PSDUs: uma e montada enquanto a outra e enviada.
+ *
+ * Os quadros recebidos sao separados da PSDU e guardados em um anel;
+ * RadioRecebeQuadro bloqueia a tarefa ate chegar um quadro.
+ *
+ * Balizas (RadioEnviaBaliza) sao PSDUs de difusao a parte, com uma carga
+ * que comeca por SYN em vez de STX, enviadas antes da PSDU em montagem.
+ * O fim de cada PSDU (interrupcao TRX_END) tem o instante marcado na
+ * propria interrupcao: o de envio da ultima baliza e lido com
+ * RadioInstanteBaliza e o de recepcao e entregue, com a carga, a funcao
+ * registrada com RadioRegistraBaliza, executada pela tarefa do radio (ex.:
+ * o sincronismo da marca de tempo entre os nos, sincronismo.c).
+ *
+ * Com RADIO_ESCUTA_PERIODO > 0 (escuta periodica, um MAC de baixo consumo
+ * do tipo low power listening), o transceptor fica em SLEEP e so escuta
+ * RADIO_ESCUTA_JANELA marcas a cada periodo, programadas por temporizadores
+ * do nucleo (cfg_TEMPORIZADORES); entre as janelas, sem outras tarefas
+ * prontas, o processador dorme pelo modo ocioso sem marcas. Cada PSDU e
+ * repetida por um periodo mais uma janela, para cair na janela de todos os
+ * nos; as copias repetidas sao descartadas pela sequencia. O periodo
+ * (RadioDefineEscuta, o mesmo em todos os nos) escolhe entre latencia, no
+ * maximo um periodo e uma janela por PSDU, e energia, com o transceptor
+ * ligado ~janela/periodo do tempo sem trafego.
+ *
+ * Toda a comunicacao com o transceptor (SPI, interrupcao, estados) e feita
+ * pela tarefa do radio, criada pela aplicacao com o corpo RadioExecuta e a
+ * maior prioridade entre as tarefas que usam o radio. Ex.:
+ *
+ *   void tarefa_radio(void) { RadioExecuta(); }
+ *
+ *   RadioInicia(endereco);
+ *   CriaTarefa(tarefa_radio, "Radio", pilha, TAM_PILHA_RADIO, 3);
+ *
+ * Usa a SERCOM4 (SPI do transceptor), os canais RADIO_DMA_CANAL_* do DMAC
+ * e a linha 0 do EIC, e define o EIC_Handler, entao so e compilado com
+ * RADIO_RF233=1 nos simbolos do projeto.
+ */
+
+
+#ifndef RADIO_RF233_H_
+#define RADIO_RF233_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+#ifndef RADIO_RF233
+#define RADIO_RF233				0
+#endif
+
+/* canal 802.15.4 na faixa de 2,4 GHz (11 a 26) e identificador da PAN */
+#ifndef RADIO_CANAL
+#define RADIO_CANAL				26
+#endif
+#ifndef RADIO_PAN
+#define RADIO_PAN				0x2021
+#endif
+
+/* marcas de tempo que o primeiro quadro espera por outros na PSDU */
+#ifndef RADIO_ESPERA_AGREGACAO
+#define RADIO_ESPERA_AGREGACAO	5
+#endif
+
+/* bytes do anel de quadros recebidos (potencia de 2) */
+#ifndef RADIO_TAM_RECEPCAO
+#define RADIO_TAM_RECEPCAO		256
+#endif
+
+/* frequencia do SPI (no maximo 8 MHz no AT86RF233 e clock da CPU / 2) */
+#ifndef RADIO_FREQUENCIA_SPI
+#define RADIO_FREQUENCIA_SPI	4000000UL
+#endif
+
+/* escuta periodica: marcas entre o inicio das janelas (0 desliga: o
+   transceptor fica sempre em RX_ON) e marcas de cada janela, pelo menos
+   duas das maiores PSDUs (~4,3 ms cada) */
+#ifndef RADIO_ESCUTA_PERIODO
+#define RADIO_ESCUTA_PERIODO	0
+#endif
+#ifndef RADIO_ESCUTA_JANELA
+#define RADIO_ESCUTA_JANELA		(cfg_MARCA_TEMPO_HZ / 100)
+#endif
+
+/* origens cujas ultimas sequencias sao guardadas para descartar as copias */
+#ifndef RADIO_ORIGENS
+#define RADIO_ORIGENS			4
+#endif
+
+#if RADIO_ESCUTA_PERIODO > 0 && (!cfg_TEMPORIZADORES || !cfg_OCIOSA_SEM_MARCAS)
+#error "a escuta periodica usa cfg_TEMPORIZADORES e cfg_OCIOSA_SEM_MARCAS"
+#endif
+
+/* canais do DMAC (menores que DMA_NUMERO_CANAIS, dma.h) */
+#ifndef RADIO_DMA_CANAL_RECEPCAO
+#define RADIO_DMA_CANAL_RECEPCAO	0
+#endif
+#ifndef RADIO_DMA_CANAL_ENVIO
+#define RADIO_DMA_CANAL_ENVIO		1
+#endif
+
+/* palavras de pilha da tarefa do radio, alem de TAM_MINIMO_PILHA */
+#define RADIO_PILHA				48
+
+/* endereco de destino de todos os nos */
+#define RADIO_DIFUSAO			0xFFFF
+
+/* PSDU: cabecalho MAC de 9 bytes (controle, sequencia, PAN, destino e
+   origem) e FCS de 2 bytes; o resto e a carga de quadros */
+#define RADIO_TAM_PSDU			127
+#define RADIO_CARGA				(RADIO_TAM_PSDU - 9 - 2)
+
+/* maior QTD de um quadro (STX, QTD, CHK e ETX ocupam mais 4 bytes) */
+#define RADIO_MAIOR_QUADRO		(RADIO_CARGA - 4)
+
+/* maior carga de uma baliza, sem o SYN */
+#define RADIO_MAIOR_BALIZA		16
+
+/**
+* \struct instante_radio_t
+* Instante do fim de uma PSDU, lido na interrupcao (MarcaTempoInstante)
+*/
+
+typedef struct
+{
+	tick_t		marcas;			///< Marcas de tempo ja contadas
+	uint32_t	contagens;		///< Contagens do SysTick na marca atual
+} instante_radio_t;
+
+/* recebe a carga de uma baliza de origem e o instante do fim da PSDU */
+typedef void (*trata_baliza_t)(uint16_t origem, const uint8_t *dados, uint8_t qtd,
+							   const instante_radio_t *fim);
+
+/**
+* \struct estatisticas_radio_t
+* Contadores do radio, de 32 bits (voltam a zero ao estourar)
+*/
+
+typedef struct
+{
+	uint32_t	psdus_enviadas;		///< PSDUs transmitidas
+	uint32_t	quadros_enviados;	///< Quadros agregados nas PSDUs transmitidas
+	uint32_t	psdus_recebidas;	///< PSDUs com FCS correto, para esta PAN e este no
+	uint32_t	quadros_recebidos;	///< Quadros validos guardados no anel
+	uint32_t	psdus_descartadas;	///< PSDUs com FCS errado, outro tipo, PAN ou destino
+	uint32_t	quadros_invalidos;	///< Quadros com QTD zero, CHK ou ETX errado (o resto da PSDU e descartado)
+	uint32_t	quadros_perdidos;	///< Quadros recebidos que nao couberam no anel
+	uint32_t	falhas_envio;		///< Envios sem fim de transmissao (transceptor reiniciado para RX_ON)
+	uint32_t	balizas_enviadas;	///< Balizas transmitidas
+	uint32_t	balizas_recebidas;	///< Balizas entregues a funcao registrada
+	uint32_t	repeticoes;			///< Copias enviadas alem da primeira (escuta periodica)
+	uint32_t	psdus_repetidas;	///< Copias recebidas de uma PSDU ja recebida (escuta periodica)
+	uint32_t	marcas_ligado;		///< Marcas com o transceptor fora de SLEEP (escuta periodica)
+} estatisticas_radio_t;
+
+extern estatisticas_radio_t estatisticas_radio;
+
+void RadioInicia(uint16_t endereco);
+void RadioExecuta(void);
+uint8_t RadioEnviaQuadro(uint16_t destino, const uint8_t *dados, uint8_t qtd, tick_t timeout);
+void RadioDescarrega(void);
+uint8_t RadioRecebeQuadro(uint8_t *dados, uint16_t *origem, tick_t timeout);
+void RadioRegistraBaliza(trata_baliza_t trata);
+uint8_t RadioEnviaBaliza(const uint8_t *dados, uint8_t qtd);
+uint8_t RadioInstanteBaliza(instante_radio_t *fim);
+#if RADIO_ESCUTA_PERIODO > 0
+void RadioDefineEscuta(tick_t periodo);
+#endif
+
+#endif /* RADIO_RF233_H_ */
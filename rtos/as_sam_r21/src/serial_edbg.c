@@ -0,0 +1,59 @@
+/*
+ * serial_edbg.c
+ *
+ * USART da SERCOM do EDBG (8 bits, sem paridade, 1 bit de parada), so
+ * transmissao, com o clock do gerador 0, o mesmo da CPU.
+ */
+
+#include <asf.h>
+#include "serial_edbg.h"
+
+/* configura a SERCOM no modo USART, com a taxa calculada pelo clock atual */
+void SerialEdbgInicia(uint32_t baud)
+{
+	struct system_gclk_chan_config config_clock;
+	struct system_pinmux_config config_pino;
+	SercomUsart *const usart = &(EDBG_CDC_MODULE->USART);
+	uint32_t clock_hz = system_gclk_gen_get_hz(GCLK_GENERATOR_0);
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_SERCOM0);
+
+	system_gclk_chan_get_config_defaults(&config_clock);
+	config_clock.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(SERCOM0_GCLK_ID_CORE, &config_clock);
+	system_gclk_chan_enable(SERCOM0_GCLK_ID_CORE);
+
+	/* pinos: PAD0 transmite, PAD1 recebe */
+	system_pinmux_get_config_defaults(&config_pino);
+	config_pino.mux_position = EDBG_CDC_SERCOM_PINMUX_PAD0 & 0xFFFF;
+	config_pino.direction = SYSTEM_PINMUX_PIN_DIR_OUTPUT;
+	system_pinmux_pin_set_config(EDBG_CDC_SERCOM_PINMUX_PAD0 >> 16, &config_pino);
+	config_pino.mux_position = EDBG_CDC_SERCOM_PINMUX_PAD1 & 0xFFFF;
+	config_pino.direction = SYSTEM_PINMUX_PIN_DIR_INPUT;
+	system_pinmux_pin_set_config(EDBG_CDC_SERCOM_PINMUX_PAD1 >> 16, &config_pino);
+
+	usart->CTRLA.reg = SERCOM_USART_CTRLA_SWRST;
+	while(usart->SYNCBUSY.reg & SERCOM_USART_SYNCBUSY_SWRST) {}
+
+	usart->CTRLA.reg = SERCOM_USART_CTRLA_MODE_USART_INT_CLK | SERCOM_USART_CTRLA_DORD |
+						SERCOM_USART_CTRLA_RXPO(1) | SERCOM_USART_CTRLA_TXPO(0);
+	usart->CTRLB.reg = SERCOM_USART_CTRLB_TXEN | SERCOM_USART_CTRLB_CHSIZE(0);
+	while(usart->SYNCBUSY.reg & SERCOM_USART_SYNCBUSY_CTRLB) {}
+
+	usart->BAUD.reg = (uint16_t)(65536UL - (uint32_t)(((uint64_t)65536UL * 16 * baud) / clock_hz));
+
+	usart->CTRLA.reg |= SERCOM_USART_CTRLA_ENABLE;
+	while(usart->SYNCBUSY.reg & SERCOM_USART_SYNCBUSY_ENABLE) {}
+}
+
+/* envia o texto e retorna depois do ultimo byte entrar na SERCOM */
+void SerialEdbgEscreve(const char *texto)
+{
+	SercomUsart *const usart = &(EDBG_CDC_MODULE->USART);
+
+	while(*texto != '\0')
+	{
+		while(!(usart->INTFLAG.reg & SERCOM_USART_INTFLAG_DRE)) {}
+		usart->DATA.reg = (uint8_t)*texto++;
+	}
+}
@@ -0,0 +1,19 @@
+/*
+ * serial_edbg.h
+ *
+ * Transmissao serial simples, por espera ocupada, na SERCOM da porta serial
+ * virtual do EDBG (SAM R21 Xplained Pro). Cada byte espera o registrador de
+ * dados esvaziar, entao so serve para mensagens fora do caminho critico
+ * (ex.: resultados de medicoes, entre as rodadas).
+ */
+
+
+#ifndef SERIAL_EDBG_H_
+#define SERIAL_EDBG_H_
+
+#include "stdint.h"
+
+void SerialEdbgInicia(uint32_t baud);
+void SerialEdbgEscreve(const char *texto);
+
+#endif /* SERIAL_EDBG_H_ */
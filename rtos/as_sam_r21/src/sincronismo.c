@@ -0,0 +1,237 @@
+/*
+ * sincronismo.c
+ *
+ * Sincronismo da marca de tempo entre os nos do radio (ver sincronismo.h).
+ *
+ * Os instantes sao contados em contagens do SysTick: marcas vezes
+ * MarcaTempoContagens mais as contagens na marca. A diferenca entre o
+ * instante de envio de uma baliza na referencia e o da sua recepcao (ja
+ * somado o desvio de marcas inteiras) e o erro do no: positivo, a marca
+ * local esta atrasada. A correcao e um controle proporcional-integral:
+ * todo o erro na fase e metade do erro por marca do periodo na
+ * frequencia, acumulada entre as amostras.
+ *
+ * A amostra so e feita na baliza seguinte, depois da recepcao de outra
+ * baliza, cujo instante foi medido antes da correcao de fase: ele e
+ * corrigido do mesmo tanto, para a proxima amostra nao repetir a correcao.
+ */
+
+#include <asf.h>
+#include "sincronismo.h"
+
+#if SINCRONISMO
+
+/* carga da baliza: sequencia, marcas e contagens do envio da baliza
+   anterior (as contagens em 16 bits), contagens por marca da referencia
+   e indicacoes */
+#define TAM_BALIZA				10
+#define BALIZA_ANTERIOR_VALIDA	0x01
+
+/* limite do ajuste de frequencia: 1/16 de marca (o OSC8M varia ~2%) */
+#define LIMITE_FREQUENCIA		((int32_t)(MarcaTempoContagens() / 16) * 65536)
+
+estatisticas_sincronismo_t estatisticas_sincronismo;
+
+static uint8_t eh_referencia = 0;
+static uint8_t sequencia = 0;
+
+/* no que segue a referencia */
+static volatile tick_t desvio_marcas = 0;		/* marcas da rede - marcas locais */
+static uint8_t com_referencia = 0;
+static uint8_t sincronizado = 0;
+static uint8_t sequencia_anterior;
+static instante_radio_t recepcao_anterior;		/* da baliza sequencia_anterior */
+static uint8_t com_anterior = 0;
+static tick_t marca_amostra;					/* da ultima amostra */
+static uint8_t com_amostra = 0;
+static int32_t frequencia = 0;
+
+/* baliza perdida por SINCRONISMO_PERDAS periodos */
+static uint8_t ReferenciaPerdida(void)
+{
+	return (tick_t)(ObtemMarcasDeTempo() - recepcao_anterior.marcas) >
+		   (tick_t)(SINCRONISMO_PERDAS * SINCRONISMO_PERIODO);
+}
+
+/* compara o envio da baliza anterior na referencia com a sua recepcao e
+   corrige o desvio, a fase e a frequencia. Retorna as contagens que a
+   marca local foi adiantada */
+static int32_t Amostra(const instante_radio_t *envio, const instante_radio_t *recepcao)
+{
+	int32_t contagens = (int32_t)MarcaTempoContagens();
+	int64_t erro;
+	int32_t marcas, fase;
+	tick_t intervalo;
+
+	erro = (int64_t)(int32_t)(envio->marcas - recepcao->marcas - desvio_marcas) * contagens +
+		   (int32_t)envio->contagens - (int32_t)recepcao->contagens + SINCRONISMO_ATRASO;
+
+	/* frequencia: o erro acumulado desde a amostra anterior, por marca */
+	intervalo = recepcao->marcas - marca_amostra;
+	if(com_amostra && intervalo > 0 && intervalo < 4 * SINCRONISMO_PERIODO)
+	{
+		frequencia -= (int32_t)((erro * 65536) / (2 * (int64_t)intervalo));
+		if(frequencia > LIMITE_FREQUENCIA)
+		{
+			frequencia = LIMITE_FREQUENCIA;
+		}else if(frequencia < -LIMITE_FREQUENCIA)
+		{
+			frequencia = -LIMITE_FREQUENCIA;
+		}
+	}
+	marca_amostra = recepcao->marcas;
+	com_amostra = 1;
+
+	/* marcas inteiras (arredondadas) no desvio, o resto na fase */
+	marcas = (int32_t)((erro + (erro >= 0 ? contagens / 2 : -(contagens / 2))) / contagens);
+	fase = (int32_t)(erro - (int64_t)marcas * contagens);
+	if(marcas != 0)
+	{
+		desvio_marcas += (tick_t)marcas;
+		estatisticas_sincronismo.saltos++;
+	}
+	MarcaTempoAjusta(frequencia, -fase);	/* erro positivo: adianta a marca local */
+
+	sincronizado = (uint8_t)(marcas == 0 && fase < SINCRONISMO_PRECISAO && fase > -SINCRONISMO_PRECISAO);
+	estatisticas_sincronismo.amostras++;
+	estatisticas_sincronismo.ultimo_erro = (erro > INT32_MAX) ? INT32_MAX :
+										   (erro < INT32_MIN) ? INT32_MIN : (int32_t)erro;
+	estatisticas_sincronismo.frequencia = frequencia;
+	return fase;
+}
+
+/* desloca o instante de contagens, entre -1/2 e +1/2 marca */
+static void Desloca(instante_radio_t *instante, int32_t contagens)
+{
+	int32_t por_marca = (int32_t)MarcaTempoContagens();
+	int32_t valor = (int32_t)instante->contagens + contagens;
+
+	if(valor < 0)
+	{
+		valor += por_marca;
+		instante->marcas--;
+	}else if(valor >= por_marca)
+	{
+		valor -= por_marca;
+		instante->marcas++;
+	}
+	instante->contagens = (uint32_t)valor;
+}
+
+/* baliza recebida, na tarefa do radio */
+static void TrataBaliza(uint16_t origem, const uint8_t *dados, uint8_t qtd, const instante_radio_t *fim)
+{
+	instante_radio_t envio;
+	int32_t adiantado = 0;
+
+	if(eh_referencia || qtd != TAM_BALIZA)
+	{
+		return;
+	}
+	if(com_referencia && origem != estatisticas_sincronismo.referencia)
+	{
+		if(!ReferenciaPerdida())
+		{
+			return;
+		}
+		com_anterior = 0;					/* troca de referencia */
+		com_amostra = 0;
+	}
+	if(((uint32_t)dados[7] | ((uint32_t)dados[8] << 8)) != MarcaTempoContagens())
+	{
+		return;								/* marca de tempo de outra duracao */
+	}
+
+	if(com_anterior && (dados[9] & BALIZA_ANTERIOR_VALIDA) &&
+	   dados[0] == (uint8_t)(sequencia_anterior + 1))
+	{
+		envio.marcas = (tick_t)dados[1] | ((tick_t)dados[2] << 8) |
+					   ((tick_t)dados[3] << 16) | ((tick_t)dados[4] << 24);
+		envio.contagens = (uint32_t)dados[5] | ((uint32_t)dados[6] << 8);
+		adiantado = Amostra(&envio, &recepcao_anterior);
+	}
+	else if(com_amostra && (tick_t)(fim->marcas - marca_amostra) >= 4 * SINCRONISMO_PERIODO)
+	{
+		com_amostra = 0;					/* intervalo longo demais para a frequencia */
+	}
+
+	estatisticas_sincronismo.referencia = origem;
+	com_referencia = 1;
+	sequencia_anterior = dados[0];
+	recepcao_anterior = *fim;
+	Desloca(&recepcao_anterior, adiantado);
+	com_anterior = 1;
+}
+
+/*
+ * Interface
+ */
+
+/* referencia (1) ou no que segue a referencia (0). Chamada depois de
+   RadioInicia e antes de criar a tarefa do radio */
+void SincronismoInicia(uint8_t referencia)
+{
+	eh_referencia = referencia;
+	RadioRegistraBaliza(TrataBaliza);
+}
+
+/* envia a baliza da referencia, com o instante de envio da anterior.
+   Retorna 0 se a baliza anterior ainda esta sendo enviada */
+uint8_t SincronismoEnviaBaliza(void)
+{
+	uint8_t baliza[TAM_BALIZA];
+	instante_radio_t anterior;
+	uint32_t contagens = MarcaTempoContagens();
+
+	baliza[9] = 0;
+	if(RadioInstanteBaliza(&anterior))
+	{
+		baliza[9] = BALIZA_ANTERIOR_VALIDA;
+	}
+	baliza[0] = (uint8_t)(sequencia + 1);
+	baliza[1] = (uint8_t)anterior.marcas;
+	baliza[2] = (uint8_t)(anterior.marcas >> 8);
+	baliza[3] = (uint8_t)(anterior.marcas >> 16);
+	baliza[4] = (uint8_t)(anterior.marcas >> 24);
+	baliza[5] = (uint8_t)anterior.contagens;
+	baliza[6] = (uint8_t)(anterior.contagens >> 8);
+	baliza[7] = (uint8_t)contagens;
+	baliza[8] = (uint8_t)(contagens >> 8);
+
+	if(!RadioEnviaBaliza(baliza, TAM_BALIZA))
+	{
+		return 0;
+	}
+	sequencia++;
+	return 1;
+}
+
+/* SINC_SEM_REFERENCIA, SINC_AJUSTANDO ou SINC_SINCRONIZADO (a referencia
+   esta sempre sincronizada) */
+uint8_t SincronismoEstado(void)
+{
+	if(eh_referencia)
+	{
+		return SINC_SINCRONIZADO;
+	}
+	if(!com_referencia || ReferenciaPerdida())
+	{
+		return SINC_SEM_REFERENCIA;
+	}
+	return sincronizado ? SINC_SINCRONIZADO : SINC_AJUSTANDO;
+}
+
+/* marcas de tempo da rede (da referencia) */
+tick_t SincronismoMarcasRede(void)
+{
+	return ObtemMarcasDeTempo() + desvio_marcas;
+}
+
+/* marca local do instante marca_rede da rede. O desvio muda quando o no
+   (re)sincroniza: recalcule a cada espera */
+tick_t SincronismoParaLocal(tick_t marca_rede)
+{
+	return marca_rede - desvio_marcas;
+}
+
+#endif /* SINCRONISMO */
@@ -0,0 +1,107 @@
+/*
+ * sincronismo.h
+ *
+ * Sincronismo da marca de tempo entre os nos do radio (radio_rf233.c): um
+ * no de referencia envia uma baliza a cada periodo e os outros ajustam a
+ * propria marca de tempo para ela comecar junto com a da referencia. Com
+ * isso as tarefas de todos os nos que esperam o mesmo instante da rede
+ * (TarefaEsperaAte) acordam na mesma marca, com diferenca de dezenas de
+ * microssegundos, o que permite dividir o canal em fendas de tempo (TDMA)
+ * sem grandes intervalos de guarda.
+ *
+ * O instante de cada baliza e marcado na interrupcao TRX_END, no fim do
+ * envio na referencia e no fim da recepcao nos outros nos, que acontecem
+ * juntos. Como a referencia so sabe o seu instante depois do envio, cada
+ * baliza leva o instante da anterior (em dois passos, como no PTP). Cada
+ * no compara esse instante com o da recepcao da baliza anterior e:
+ *  - soma as marcas inteiras de diferenca ao desvio entre o tempo da rede
+ *    e o seu (SincronismoMarcasRede, SincronismoParaLocal);
+ *  - corrige o resto, menor que meia marca, na fase da proxima marca;
+ *  - corrige a frequencia da marca de tempo pela diferenca acumulada no
+ *    periodo (deriva do oscilador), com o ajuste fino da porta da cpu
+ *    (cfg_AJUSTE_MARCA), para a diferenca nao crescer entre as balizas.
+ *
+ * As balizas sao tratadas na tarefa do radio, que deve ter SINCRONISMO_PILHA
+ * palavras a mais de pilha. A referencia chama SincronismoEnviaBaliza a
+ * cada SINCRONISMO_PERIODO marcas (ex.: no inicio da sua fenda). Ex.:
+ *
+ *   RadioInicia(endereco);
+ *   SincronismoInicia(0);
+ *   ...
+ *   ultimo = SincronismoParaLocal(proxima_fenda_da_rede) - periodo;
+ *   TarefaEsperaAte(&ultimo, periodo);
+ *
+ * So e compilado com SINCRONISMO=1 nos simbolos do projeto.
+ */
+
+
+#ifndef SINCRONISMO_H_
+#define SINCRONISMO_H_
+
+#include "stdint.h"
+#include "rtos.h"
+#include "radio_rf233.h"
+
+#ifndef SINCRONISMO
+#define SINCRONISMO				0
+#endif
+
+/* marcas entre as balizas da referencia */
+#ifndef SINCRONISMO_PERIODO
+#define SINCRONISMO_PERIODO		cfg_MARCA_TEMPO_HZ
+#endif
+
+/* periodos sem baliza ate o no aceitar outra referencia */
+#ifndef SINCRONISMO_PERDAS
+#define SINCRONISMO_PERDAS		5
+#endif
+
+/* contagens do SysTick entre o TRX_END do envio e o da recepcao (atraso da
+   recepcao no transceptor e no EIC), descontadas do instante de recepcao */
+#ifndef SINCRONISMO_ATRASO
+#define SINCRONISMO_ATRASO		0
+#endif
+
+/* diferenca, em contagens do SysTick, abaixo da qual o no esta sincronizado */
+#ifndef SINCRONISMO_PRECISAO
+#define SINCRONISMO_PRECISAO	((int32_t)MarcaTempoContagens() / 32)
+#endif
+
+/* palavras de pilha da tarefa do radio usadas pelo sincronismo */
+#define SINCRONISMO_PILHA		24
+
+/* estados do no (SincronismoEstado) */
+#define SINC_SEM_REFERENCIA		0
+#define SINC_AJUSTANDO			1
+#define SINC_SINCRONIZADO		2
+
+#if SINCRONISMO && (!RADIO_RF233 || !cfg_AJUSTE_MARCA)
+#error "o sincronismo usa o radio (RADIO_RF233=1) e o ajuste fino da marca de tempo (cfg_AJUSTE_MARCA=1)"
+#endif
+#if SINCRONISMO && RADIO_ESCUTA_PERIODO > 0
+#error "as balizas precisam do radio sempre ligado (RADIO_ESCUTA_PERIODO=0): as copias da escuta periodica tem outro instante"
+#endif
+
+/**
+* \struct estatisticas_sincronismo_t
+* Estado do sincronismo de um no que segue a referencia
+*/
+
+typedef struct
+{
+	uint32_t	amostras;			///< Balizas comparadas com a anterior
+	uint32_t	saltos;				///< Amostras com diferenca de uma marca ou mais
+	int32_t		ultimo_erro;		///< Ultima diferenca para a referencia, em contagens do SysTick
+	int32_t		frequencia;			///< Ajuste de frequencia, em 1/65536 de contagem por marca
+	uint16_t	referencia;			///< Endereco do no de referencia
+} estatisticas_sincronismo_t;
+
+extern estatisticas_sincronismo_t estatisticas_sincronismo;
+
+void SincronismoInicia(uint8_t referencia);
+uint8_t SincronismoEnviaBaliza(void);
+uint8_t SincronismoEstado(void);
+tick_t SincronismoMarcasRede(void);
+tick_t SincronismoParaLocal(tick_t marca_rede);
+
+#endif /* SINCRONISMO_H_ */
@@ -0,0 +1,25 @@
+/*
+ * conf_rtos.h
+ *
+ * Configuracao do sistema multitarefas para a porta POSIX (computador).
+ * As macros nao definidas aqui usam os valores padrao do rtos.h e podem 
+ * ser trocadas na linha de compilacao (ver main.c).
+ */ 
+
+
+#ifndef CONF_RTOS_H_
+#define CONF_RTOS_H_
+
+/* no computador, as marcas de tempo do benchmark sao geradas pela 
+   tarefa de medicao, entao o modo padrao e cooperativo, como na SAM D21 */
+#ifndef cfg_PREEMPTIVO
+#define cfg_PREEMPTIVO		0
+#endif
+
+/* inanicao.c: o aviso de inanicao e contado pelo teste */
+#if defined(TESTE_INANICAO) && TESTE_INANICAO
+void InanicaoDetectada(uint8_t id_tarefa, uint32_t marcas);
+#define cfg_INANICAO_DETECTADA(id_tarefa, marcas)	InanicaoDetectada((id_tarefa), (marcas))
+#endif
+
+#endif /* CONF_RTOS_H_ */
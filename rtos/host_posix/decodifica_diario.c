@@ -0,0 +1,288 @@
+/**
+ * \file
+ *
+ * \brief Decodificador do diario binario da placa SAM D21 (diario.h, com
+ * DIARIO_BINARIO 1), para o computador.
+ *
+ * A placa envia so o endereco do formato e os argumentos de cada DIARIO;
+ * o formato, e as cadeias dos argumentos de %s, sao buscados nas secoes
+ * carregadas do ELF do mesmo programa, e a mensagem e formatada aqui com o
+ * printf do computador. Os registros sao achados pelo byte de inicio
+ * (DIARIO_INICIO), entao a captura pode comecar no meio de um registro.
+ *
+ * Compilacao e execucao (nesta pasta):
+ *
+ *   gcc -O2 -o decodifica_diario decodifica_diario.c
+ *   ./decodifica_diario programa.elf diario.bin
+ *
+ * O tempo sai em segundos, pela frequencia do tempo dos registros (-f, as
+ * marcas de tempo de 1 kHz sem ela). Ex., com DIARIO_TEMPO() TempoUs():
+ *
+ *   ./decodifica_diario -f 1000000 programa.elf diario.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* como em diario.h */
+#define DIARIO_INICIO		0xD1
+#define DIARIO_ISR			0xFF
+#define MAX_ARGUMENTOS		4
+
+#define MAX_SECOES			64
+#define SHT_NOBITS			8
+#define SHF_ALLOC			2
+
+typedef struct
+{
+	uint64_t	endereco;
+	uint64_t	tamanho;
+	uint64_t	posicao;		/* no arquivo */
+} secao_t;
+
+static uint8_t *elf;
+static size_t tam_elf;
+static secao_t secoes[MAX_SECOES];
+static unsigned numero_secoes;
+
+static uint8_t *Carrega(const char *caminho, size_t *tamanho)
+{
+	FILE *f = fopen(caminho, "rb");
+	uint8_t *dados;
+	long n;
+
+	if(f == NULL || fseek(f, 0, SEEK_END) != 0 || (n = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0)
+	{
+		fprintf(stderr, "nao abriu %s\n", caminho);
+		exit(1);
+	}
+	dados = malloc((size_t)n + 1);
+	if(dados == NULL || fread(dados, 1, (size_t)n, f) != (size_t)n)
+	{
+		fprintf(stderr, "nao leu %s\n", caminho);
+		exit(1);
+	}
+	fclose(f);
+	*tamanho = (size_t)n;
+	return dados;
+}
+
+/* inteiro little-endian de n bytes */
+static uint64_t Le(const uint8_t *p, unsigned n)
+{
+	uint64_t v = 0;
+
+	while(n-- > 0)
+	{
+		v = (v << 8) | p[n];
+	}
+	return v;
+}
+
+/* secoes carregadas na memoria e com conteudo no arquivo (ELF de 32 ou 64
+   bits, little-endian) */
+static void LeSecoes(void)
+{
+	unsigned largura, tam_cabecalho, n, i;
+	uint64_t tabela;
+	const uint8_t *s;
+
+	if(tam_elf < 64 || memcmp(elf, "\177ELF", 4) != 0 || elf[5] != 1)
+	{
+		fprintf(stderr, "o programa nao e um ELF little-endian\n");
+		exit(1);
+	}
+	largura = (elf[4] == 2) ? 8 : 4;
+	tabela = Le(&elf[largura == 8 ? 0x28 : 0x20], largura);
+	tam_cabecalho = (unsigned)Le(&elf[largura == 8 ? 0x3A : 0x2E], 2);
+	n = (unsigned)Le(&elf[largura == 8 ? 0x3C : 0x30], 2);
+	for(i = 0; i < n && numero_secoes < MAX_SECOES; i++)
+	{
+		if(tabela + (uint64_t)(i + 1) * tam_cabecalho > tam_elf)
+		{
+			break;
+		}
+		s = &elf[tabela + (uint64_t)i * tam_cabecalho];
+		if(Le(&s[4], 4) == SHT_NOBITS || !(Le(&s[8], largura) & SHF_ALLOC))
+		{
+			continue;
+		}
+		secoes[numero_secoes].endereco = Le(&s[8 + largura], largura);
+		secoes[numero_secoes].posicao = Le(&s[8 + 2 * largura], largura);
+		secoes[numero_secoes].tamanho = Le(&s[8 + 3 * largura], largura);
+		if(secoes[numero_secoes].posicao + secoes[numero_secoes].tamanho <= tam_elf)
+		{
+			numero_secoes++;
+		}
+	}
+}
+
+/* cadeia no endereco da placa, ou NULL se nao esta no ELF (ex.: na RAM) */
+static const char *Texto(uint32_t endereco)
+{
+	unsigned i;
+	uint64_t resto;
+
+	for(i = 0; i < numero_secoes; i++)
+	{
+		if(endereco >= secoes[i].endereco && endereco < secoes[i].endereco + secoes[i].tamanho)
+		{
+			resto = secoes[i].endereco + secoes[i].tamanho - endereco;
+			if(memchr(&elf[secoes[i].posicao + endereco - secoes[i].endereco], 0, resto) == NULL)
+			{
+				return NULL;
+			}
+			return (const char *)&elf[secoes[i].posicao + endereco - secoes[i].endereco];
+		}
+	}
+	return NULL;
+}
+
+/* formata como a placa (DiarioFormata), com o printf do computador */
+static void Formata(const char *formato, const uint32_t *argumentos, unsigned numero)
+{
+	char especificacao[32];
+	const char *texto;
+	unsigned usados = 0, n;
+	uint32_t v;
+	char c;
+
+	while((c = *formato++) != 0)
+	{
+		if(c != '%')
+		{
+			putchar(c);
+			continue;
+		}
+		n = 0;
+		especificacao[n++] = '%';
+		while((*formato == '-' || *formato == '0' || (*formato >= '1' && *formato <= '9')) &&
+			  n < sizeof(especificacao) - 2)
+		{
+			especificacao[n++] = *formato++;
+		}
+		while(*formato == 'l' || *formato == 'h' || *formato == 'z')
+		{
+			formato++;
+		}
+		c = *formato;
+		if(c == 0)
+		{
+			break;
+		}
+		formato++;
+		if(c == '%')
+		{
+			putchar('%');
+			continue;
+		}
+		v = (usados < numero) ? argumentos[usados++] : 0;
+		especificacao[n + 1] = 0;
+		switch(c)
+		{
+			case 'd':
+			case 'i':
+				especificacao[n] = 'd';
+				printf(especificacao, (int)(int32_t)v);
+				break;
+			case 'u':
+			case 'x':
+			case 'X':
+			case 'c':
+				especificacao[n] = c;
+				printf(especificacao, (unsigned)v);
+				break;
+			case 'p':
+				printf("0x%08x", (unsigned)v);
+				break;
+			case 's':
+				especificacao[n] = 's';
+				texto = (v == 0) ? "(null)" : Texto(v);
+				if(texto != NULL)
+				{
+					printf(especificacao, texto);
+				}
+				else
+				{
+					printf("<0x%08x>", (unsigned)v);
+				}
+				break;
+			default:
+				putchar('?');
+				break;
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	uint8_t *captura, tarefa, numero;
+	uint32_t argumentos[MAX_ARGUMENTOS], tempo, endereco;
+	size_t tam_captura, pos = 0, tamanho;
+	unsigned long registros = 0, perdidos = 0;
+	const char *formato;
+	double hz = 1000.0;
+	unsigned i;
+	int a = 1;
+
+	if(argc == 5 && strcmp(argv[1], "-f") == 0)
+	{
+		hz = atof(argv[2]);
+		a = 3;
+	}
+	if(argc - a != 2 || hz <= 0)
+	{
+		fprintf(stderr, "uso: %s [-f hz] programa.elf diario.bin\n", argv[0]);
+		return 1;
+	}
+	elf = Carrega(argv[a], &tam_elf);
+	LeSecoes();
+	captura = Carrega(argv[a + 1], &tam_captura);
+
+	while(pos + 3 <= tam_captura)
+	{
+		numero = captura[pos + 2];
+		tamanho = 3 + 8 + 4 * (size_t)numero;
+		if(captura[pos] != DIARIO_INICIO || numero < 2 || numero > MAX_ARGUMENTOS ||
+		   pos + tamanho > tam_captura)
+		{
+			pos++;
+			perdidos++;
+			continue;
+		}
+		tarefa = captura[pos + 1];
+		tempo = (uint32_t)Le(&captura[pos + 3], 4);
+		endereco = (uint32_t)Le(&captura[pos + 7], 4);
+		for(i = 0; i < numero; i++)
+		{
+			argumentos[i] = (uint32_t)Le(&captura[pos + 11 + 4 * i], 4);
+		}
+		formato = (endereco != 0) ? Texto(endereco) : "%u descartados";
+		if(formato == NULL)
+		{
+			/* o byte de inicio era um dado: procura o proximo */
+			pos++;
+			perdidos++;
+			continue;
+		}
+
+		printf("%12.6f ", tempo / hz);
+		if(tarefa == DIARIO_ISR)
+		{
+			printf("isr: ");
+		}
+		else
+		{
+			printf("#%u: ", tarefa);
+		}
+		Formata(formato, argumentos, numero);
+		putchar('\n');
+		registros++;
+		pos += tamanho;
+	}
+
+	fprintf(stderr, "%lu registros, %lu bytes ignorados\n", registros, perdidos + (unsigned long)(tam_captura - pos));
+	return 0;
+}
@@ -0,0 +1,322 @@
+/**
+ * \file
+ *
+ * \brief Decodificador do rastro de instrucoes do MTB (SAM D21, mtb.c),
+ * para o computador.
+ *
+ * Le os desvios enviados pelo comando "mtb dump" do console (ex.: a saida
+ * da serial gravada em um arquivo; as linhas que nao sao desvios sao
+ * ignoradas) e os traduz para as funcoes da imagem, lidas com nm. Entre o
+ * destino de um desvio e a origem do seguinte o codigo executou em
+ * sequencia, entao cada linha mostra um trecho executado e o desvio que o
+ * terminou:
+ *
+ *   tarefa_periodica+0x1c..+0x2a  -> TarefaEsperaAte
+ *
+ * Compilacao e execucao (nesta pasta), com o nm da imagem:
+ *
+ *   gcc -O2 -o decodifica_mtb decodifica_mtb.c
+ *   NM=arm-none-eabi-nm ./decodifica_mtb imagem.elf mtb.txt
+ *
+ * O buffer tambem pode ser lido direto da RAM pelo depurador (SWD), com o
+ * registrador POSITION do MTB (0x41006000) lido antes. Ex. no gdb:
+ *
+ *   x/x 0x41006000
+ *   dump binary value mtb.bin buffer_mtb
+ *
+ *   ./decodifica_mtb -b <position> imagem.elf mtb.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* bit 0 da origem (MTB_EXCECAO) e do destino (MTB_INICIO), como em mtb.h */
+#define EXCECAO		1UL
+#define INICIO		1UL
+
+typedef struct
+{
+	uint32_t	origem;
+	uint32_t	destino;
+} desvio_t;
+
+typedef struct
+{
+	uint32_t	endereco;
+	uint32_t	tamanho;		/* 0 = desconhecido: vai ate o proximo simbolo */
+	const char	*nome;
+} simbolo_t;
+
+static simbolo_t *simbolos;
+static unsigned numero_simbolos;
+
+static desvio_t *desvios;
+static unsigned numero_desvios, capacidade_desvios;
+
+/* le as funcoes da imagem com "nm -n -S --defined-only" (NM do ambiente,
+   ex.: arm-none-eabi-nm), em ordem de endereco. O bit 0 dos enderecos
+   Thumb e descartado */
+static int LeSimbolos(const char *imagem)
+{
+	const char *nm = getenv("NM");
+	char comando[512], linha[512], nome[256];
+	unsigned long endereco, tamanho;
+	unsigned capacidade = 0;
+	char tipo;
+	FILE *saida;
+
+	snprintf(comando, sizeof(comando), "%s -n -S --defined-only '%s'", (nm != 0) ? nm : "nm", imagem);
+	saida = popen(comando, "r");
+	if(saida == 0)
+	{
+		return 0;
+	}
+
+	while(fgets(linha, sizeof(linha), saida) != 0)
+	{
+		if(sscanf(linha, "%lx %lx %c %255s", &endereco, &tamanho, &tipo, nome) != 4)
+		{
+			tamanho = 0;
+			if(sscanf(linha, "%lx %c %255s", &endereco, &tipo, nome) != 3)
+			{
+				continue;
+			}
+		}
+		if(tipo != 'T' && tipo != 't' && tipo != 'W' && tipo != 'w')
+		{
+			continue;		/* so codigo */
+		}
+		if(numero_simbolos == capacidade)
+		{
+			capacidade = (capacidade == 0) ? 1024 : capacidade * 2;
+			simbolos = realloc(simbolos, capacidade * sizeof(simbolo_t));
+			if(simbolos == 0)
+			{
+				pclose(saida);
+				return 0;
+			}
+		}
+		simbolos[numero_simbolos].endereco = (uint32_t)endereco & ~1UL;
+		simbolos[numero_simbolos].tamanho = (uint32_t)tamanho;
+		simbolos[numero_simbolos].nome = strdup(nome);
+		numero_simbolos++;
+	}
+
+	return pclose(saida) == 0 && numero_simbolos > 0;
+}
+
+/* funcao que contem pc, ou 0 */
+static const simbolo_t *BuscaSimbolo(uint32_t pc)
+{
+	unsigned inicio = 0, fim = numero_simbolos;
+	const simbolo_t *simbolo;
+
+	while(fim - inicio > 1)
+	{
+		unsigned meio = (inicio + fim) / 2;
+
+		if(simbolos[meio].endereco <= pc)
+		{
+			inicio = meio;
+		}
+		else
+		{
+			fim = meio;
+		}
+	}
+	simbolo = &simbolos[inicio];
+	if(simbolo->endereco > pc || (simbolo->tamanho != 0 && pc >= simbolo->endereco + simbolo->tamanho))
+	{
+		return 0;
+	}
+	return simbolo;
+}
+
+/* escreve "funcao+0xdeslocamento" (ou o endereco, fora das funcoes) em texto */
+static void Endereco(char *texto, size_t tamanho, uint32_t pc)
+{
+	const simbolo_t *simbolo = BuscaSimbolo(pc);
+
+	if(simbolo == 0)
+	{
+		snprintf(texto, tamanho, "0x%08x", (unsigned)pc);
+	}
+	else if(pc == simbolo->endereco)
+	{
+		snprintf(texto, tamanho, "%s", simbolo->nome);
+	}
+	else
+	{
+		snprintf(texto, tamanho, "%s+0x%x", simbolo->nome, (unsigned)(pc - simbolo->endereco));
+	}
+}
+
+static int Guarda(uint32_t origem, uint32_t destino)
+{
+	if(numero_desvios == capacidade_desvios)
+	{
+		capacidade_desvios = (capacidade_desvios == 0) ? 256 : capacidade_desvios * 2;
+		desvios = realloc(desvios, capacidade_desvios * sizeof(desvio_t));
+		if(desvios == 0)
+		{
+			return 0;
+		}
+	}
+	desvios[numero_desvios].origem = origem;
+	desvios[numero_desvios].destino = destino;
+	numero_desvios++;
+	return 1;
+}
+
+/* linhas "origem -> destino [exc] [inicio]" do console */
+static int LeTexto(FILE *arquivo)
+{
+	char linha[256];
+	unsigned long origem, destino;
+
+	while(fgets(linha, sizeof(linha), arquivo) != 0)
+	{
+		if(sscanf(linha, "%8lx -> %8lx", &origem, &destino) != 2)
+		{
+			continue;
+		}
+		if(strstr(linha, " exc") != 0)
+		{
+			origem |= EXCECAO;
+		}
+		if(strstr(linha, " inicio") != 0)
+		{
+			destino |= INICIO;
+		}
+		if(!Guarda((uint32_t)origem, (uint32_t)destino))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* buffer inteiro lido da RAM: com o bit WRAP de POSITION, o mais antigo
+   esta na posicao de escrita; sem ele, os desvios vao do inicio ate ela */
+static int LeBruto(FILE *arquivo, uint32_t posicao)
+{
+	uint32_t *buffer;
+	long tamanho;
+	unsigned n, i, inicio, quantidade;
+
+	fseek(arquivo, 0, SEEK_END);
+	tamanho = ftell(arquivo);
+	fseek(arquivo, 0, SEEK_SET);
+	n = (unsigned)(tamanho / 8);
+	if(n == 0 || (n & (n - 1)) != 0)
+	{
+		fprintf(stderr, "o buffer do MTB deve ter uma potencia de 2 de desvios (8 bytes cada)\n");
+		return 0;
+	}
+	buffer = malloc((size_t)n * 8);
+	if(buffer == 0 || fread(buffer, 8, n, arquivo) != n)
+	{
+		return 0;
+	}
+
+	inicio = (unsigned)((posicao & ~7UL) / 8) & (n - 1);
+	if(posicao & 4)
+	{
+		quantidade = n;
+	}
+	else
+	{
+		quantidade = inicio;
+		inicio = 0;
+	}
+	for(i = 0; i < quantidade; i++)
+	{
+		unsigned j = (inicio + i) & (n - 1);
+
+		if(!Guarda(buffer[2 * j], buffer[2 * j + 1]))
+		{
+			return 0;
+		}
+	}
+	free(buffer);
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	FILE *arquivo;
+	char trecho[640], inicio[300], fim[300], destino[300];
+	int bruto = (argc == 5 && strcmp(argv[1], "-b") == 0);
+	unsigned i, excecoes = 0, reinicios = 0;
+	int ok;
+
+	if(argc != 3 && !bruto)
+	{
+		fprintf(stderr, "uso: %s imagem.elf mtb.txt\n"
+						"     %s -b <position> imagem.elf mtb.bin\n", argv[0], argv[0]);
+		return 1;
+	}
+
+	if(!LeSimbolos(argv[argc - 2]))
+	{
+		fprintf(stderr, "sem funcoes em %s (NM=%s)\n", argv[argc - 2], getenv("NM") ? getenv("NM") : "nm");
+		return 1;
+	}
+
+	arquivo = fopen(argv[argc - 1], bruto ? "rb" : "r");
+	if(arquivo == 0)
+	{
+		perror(argv[argc - 1]);
+		return 1;
+	}
+	ok = bruto ? LeBruto(arquivo, (uint32_t)strtoul(argv[2], 0, 0)) : LeTexto(arquivo);
+	fclose(arquivo);
+	if(!ok || numero_desvios == 0)
+	{
+		fprintf(stderr, "nenhum desvio em %s\n", argv[argc - 1]);
+		return 1;
+	}
+
+	/* o trecho antes do primeiro desvio guardado e desconhecido: comeca no
+	   destino do desvio anterior, ja sobrescrito */
+	printf("%u desvios, do mais antigo ao mais recente\n\n", numero_desvios);
+	for(i = 0; i < numero_desvios; i++)
+	{
+		uint32_t origem = desvios[i].origem & ~EXCECAO;
+
+		if(desvios[i].destino & INICIO)
+		{
+			printf("-- rastro iniciado\n");
+			reinicios++;
+		}
+		Endereco(fim, sizeof(fim), origem);
+		if(i == 0 || (desvios[i].destino & INICIO))
+		{
+			snprintf(trecho, sizeof(trecho), "..%s", fim);
+		}
+		else
+		{
+			uint32_t anterior = desvios[i - 1].destino & ~INICIO;
+			const simbolo_t *s = BuscaSimbolo(anterior);
+
+			Endereco(inicio, sizeof(inicio), anterior);
+			if(s != 0 && s == BuscaSimbolo(origem))
+			{
+				/* mesma funcao: so o deslocamento do fim */
+				snprintf(trecho, sizeof(trecho), "%s..+0x%x", inicio, (unsigned)(origem - s->endereco));
+			}
+			else
+			{
+				snprintf(trecho, sizeof(trecho), "%s..%s", inicio, fim);
+			}
+		}
+		Endereco(destino, sizeof(destino), desvios[i].destino & ~INICIO);
+		printf("%-48s -> %s%s\n", trecho, destino, (desvios[i].origem & EXCECAO) ? "  (excecao)" : "");
+		excecoes += (desvios[i].origem & EXCECAO) ? 1 : 0;
+	}
+
+	printf("\n%u entradas/saidas de excecao, %u reinicios do rastro\n", excecoes, reinicios);
+	return 0;
+}
@@ -0,0 +1,277 @@
+/**
+ * \file
+ *
+ * \brief Decodificador do rastro do nucleo (cfg_RASTRO), para o computador.
+ *
+ * Le o rastro enviado por RastroDescarrega() (ex.: gravado da UART em um
+ * arquivo) e mostra a linha do tempo dos eventos e o tempo de execucao de
+ * cada tarefa entre o primeiro e o ultimo registro.
+ *
+ * Compilacao e execucao (nesta pasta):
+ *
+ *   gcc -O2 -o decodifica_rastro decodifica_rastro.c
+ *   ./decodifica_rastro rastro.bin
+ *
+ * O anel tambem pode ser lido direto da RAM pelo depurador (SWD), sem
+ * cabecalho. Ex. no gdb, com o rastro ja completo (rastro_total >= cfg_RASTRO):
+ *
+ *   dump binary value rastro.bin rastro_nucleo
+ *
+ * e entao, informando o clock, a marca de tempo e rastro_total:
+ *
+ *   ./decodifica_rastro -b 48000000 1000 <rastro_total> rastro.bin
+ *
+ * Com cfg_RASTRO_TEMPO, o tempo dos registros e um contador livre de 32
+ * bits: o cabecalho traz a sua frequencia e marca 0, e no modo -b o clock
+ * e a frequencia do contador com marca_hz 0 (ex.: -b 1000000 0 para
+ * TempoUs da placa SAM D21).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* mesmos valores e formato de evento_rastro_t e registro_rastro_t (rtos.h) */
+enum {
+	RASTRO_TROCA = 1,
+	RASTRO_MARCA,
+	RASTRO_SEMAFORO_AGUARDA,
+	RASTRO_SEMAFORO_BLOQUEIA,
+	RASTRO_SEMAFORO_LIBERA,
+	RASTRO_ESPERA
+};
+
+typedef struct
+{
+	uint32_t	tempo;
+	uint8_t		evento;
+	uint8_t		tarefa;
+	uint16_t	dado;
+} registro_rastro_t;
+
+#define MAX_TAREFAS		256
+#define TAM_NOME		32
+
+static char nomes[MAX_TAREFAS][TAM_NOME];
+static double tempo_execucao[MAX_TAREFAS];
+
+static const char *NomeTarefa(uint8_t tarefa)
+{
+	static char numero[8];
+
+	if(tarefa == 0)
+	{
+		return "-";
+	}
+	if(nomes[tarefa][0] != 0)
+	{
+		return nomes[tarefa];
+	}
+	snprintf(numero, sizeof(numero), "#%u", tarefa);
+	return numero;
+}
+
+static int LeBytes(FILE *arquivo, void *destino, size_t tamanho)
+{
+	return fread(destino, 1, tamanho, arquivo) == tamanho;
+}
+
+/* le o cabecalho de RastroDescarrega: frequencias, nomes das tarefas e
+   numero de registros */
+static int LeCabecalho(FILE *arquivo, uint32_t *clock, uint32_t *marca_hz, uint16_t *quantidade)
+{
+	char assinatura[4];
+	uint32_t frequencias[2];
+	uint8_t tarefas;
+	int i, c, n;
+
+	if(!LeBytes(arquivo, assinatura, 4) || memcmp(assinatura, "RTR1", 4) != 0)
+	{
+		fprintf(stderr, "arquivo nao comeca com RTR1 (use -b para o anel lido da RAM)\n");
+		return 0;
+	}
+	if(!LeBytes(arquivo, frequencias, sizeof(frequencias)) || !LeBytes(arquivo, &tarefas, 1))
+	{
+		return 0;
+	}
+	*clock = frequencias[0];
+	*marca_hz = frequencias[1];
+
+	for(i = 1; i <= tarefas && i < MAX_TAREFAS; i++)
+	{
+		n = 0;
+		while((c = fgetc(arquivo)) != EOF && c != 0)
+		{
+			if(n < TAM_NOME - 1)
+			{
+				nomes[i][n++] = (char)c;
+			}
+		}
+		nomes[i][n] = 0;
+		if(c == EOF)
+		{
+			return 0;
+		}
+	}
+
+	return LeBytes(arquivo, quantidade, sizeof(*quantidade));
+}
+
+int main(int argc, char **argv)
+{
+	FILE *arquivo;
+	registro_rastro_t *registros;
+	uint32_t clock = 0, marca_hz = 0;
+	uint16_t quantidade = 0, total = 0, primeiro = 0;
+	uint32_t ciclos_por_marca;
+	uint32_t voltas = 0;
+	uint16_t marca_anterior = 0;
+	uint32_t tempo_anterior = 0;
+	double inicio = 0, instante = 0, troca_anterior = 0;
+	uint8_t atual = 0;
+	int bruto = (argc == 6 && strcmp(argv[1], "-b") == 0);
+	unsigned i;
+
+	if(argc != 2 && !bruto)
+	{
+		fprintf(stderr, "uso: %s rastro.bin\n"
+						"     %s -b <clock_hz> <marca_hz> <rastro_total> rastro.bin\n", argv[0], argv[0]);
+		return 1;
+	}
+
+	arquivo = fopen(argv[argc - 1], "rb");
+	if(arquivo == 0)
+	{
+		perror(argv[argc - 1]);
+		return 1;
+	}
+
+	if(bruto)
+	{
+		/* anel completo lido da RAM: o mais antigo esta em rastro_total % tamanho */
+		long tamanho;
+
+		clock = (uint32_t)strtoul(argv[2], 0, 0);
+		marca_hz = (uint32_t)strtoul(argv[3], 0, 0);
+		total = (uint16_t)strtoul(argv[4], 0, 0);
+		fseek(arquivo, 0, SEEK_END);
+		tamanho = ftell(arquivo);
+		fseek(arquivo, 0, SEEK_SET);
+		quantidade = (uint16_t)(tamanho / (long)sizeof(registro_rastro_t));
+		if(quantidade == 0 || (quantidade & (quantidade - 1)) != 0)
+		{
+			fprintf(stderr, "o anel deve ter cfg_RASTRO (potencia de 2) registros\n");
+			return 1;
+		}
+		primeiro = (uint16_t)(total & (quantidade - 1));
+	}
+	else if(!LeCabecalho(arquivo, &clock, &marca_hz, &quantidade))
+	{
+		fprintf(stderr, "cabecalho do rastro incompleto\n");
+		return 1;
+	}
+
+	if(clock == 0 || marca_hz > clock)
+	{
+		fprintf(stderr, "frequencias invalidas\n");
+		return 1;
+	}
+	ciclos_por_marca = (marca_hz != 0) ? clock / marca_hz : 0;
+
+	registros = malloc((size_t)quantidade * sizeof(registro_rastro_t) + 1);
+	if(registros == 0 || !LeBytes(arquivo, registros, (size_t)quantidade * sizeof(registro_rastro_t)))
+	{
+		fprintf(stderr, "rastro incompleto\n");
+		return 1;
+	}
+	fclose(arquivo);
+
+	printf("%14s  %-16s %s\n", "tempo (ms)", "tarefa", "evento");
+
+	for(i = 0; i < quantidade; i++)
+	{
+		const registro_rastro_t *r = &registros[(primeiro + i) % quantidade];
+		uint16_t marca = (uint16_t)(r->tempo >> 16);
+		uint16_t ciclos = (uint16_t)r->tempo;
+
+		if(marca_hz == 0)
+		{
+			/* contador livre de 32 bits (cfg_RASTRO_TEMPO): conta as voltas */
+			if(i > 0 && r->tempo < tempo_anterior)
+			{
+				voltas++;
+			}
+			tempo_anterior = r->tempo;
+			instante = ((double)voltas * 4294967296.0 + r->tempo) * 1000.0 / clock;
+		}
+		else
+		{
+			/* a marca de tempo do registro tem 16 bits: conta as voltas */
+			if(i > 0 && marca < marca_anterior)
+			{
+				voltas++;
+			}
+			marca_anterior = marca;
+			instante = (((double)voltas * 65536.0 + marca) * ciclos_por_marca + ciclos) * 1000.0 / clock;
+		}
+		if(i == 0)
+		{
+			inicio = instante;
+			troca_anterior = instante;
+		}
+
+		printf("%14.6f  %-16s ", instante - inicio, NomeTarefa(r->tarefa));
+		switch(r->evento)
+		{
+			case RASTRO_TROCA:
+				printf("entra (sai %s)\n", NomeTarefa((uint8_t)r->dado));
+				tempo_execucao[(uint8_t)r->dado] += instante - troca_anterior;
+				troca_anterior = instante;
+				atual = r->tarefa;
+				break;
+			case RASTRO_MARCA:
+				printf("marca de tempo desperta %u tarefa(s)\n", r->dado);
+				break;
+			case RASTRO_SEMAFORO_AGUARDA:
+				printf("obtem semaforo 0x%04x\n", r->dado);
+				break;
+			case RASTRO_SEMAFORO_BLOQUEIA:
+				printf("bloqueia no semaforo 0x%04x\n", r->dado);
+				break;
+			case RASTRO_SEMAFORO_LIBERA:
+				if(r->tarefa != 0)
+				{
+					printf("acordada pela liberacao do semaforo 0x%04x\n", r->dado);
+				}
+				else
+				{
+					printf("semaforo 0x%04x liberado sem tarefa esperando\n", r->dado);
+				}
+				break;
+			case RASTRO_ESPERA:
+				printf("espera %u marcas\n", r->dado);
+				break;
+			default:
+				printf("evento desconhecido %u (dado %u)\n", r->evento, r->dado);
+				break;
+		}
+	}
+
+	if(atual != 0)
+	{
+		tempo_execucao[atual] += instante - troca_anterior;
+	}
+
+	printf("\ntempo de execucao entre o primeiro e o ultimo registro (%.3f ms):\n", instante - inicio);
+	for(i = 1; i < MAX_TAREFAS; i++)
+	{
+		if(tempo_execucao[i] > 0)
+		{
+			printf("  %-16s %12.3f ms\n", NomeTarefa((uint8_t)i), tempo_execucao[i]);
+		}
+	}
+
+	free(registros);
+	return 0;
+}
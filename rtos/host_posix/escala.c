@@ -0,0 +1,223 @@
+/**
+ * \file
+ *
+ * \brief Escala do nucleo com o numero de tarefas e de prioridades (porta POSIX).
+ *
+ * Mede o escalonador, a marca de tempo e o semaforo com NUMERO_DE_TAREFAS
+ * tarefas distribuidas em PRIORIDADE_MAXIMA prioridades: metade das tarefas
+ * de carga fica na lista de espera e metade pronta. Imprime uma linha CSV
+ * por operacao, com o custo medio em ns e em instrucoes (no Linux, pelo
+ * contador de instrucoes do processador; vazio se o sistema nao permite).
+ *
+ * Compilacao e execucao de uma configuracao (nesta pasta):
+ *
+ *   gcc -O2 -I. -I../nucleo -I../portas/posix -DNUMERO_DE_TAREFAS=64 \
+ *       -DPRIORIDADE_MAXIMA=16 -o rtos_escala escala.c \
+ *       ../portas/posix/cpu-port.c ../nucleo/rtos.c
+ *   ./rtos_escala
+ *
+ * O escala.sh compila e executa todas as configuracoes de 8 ate o limite
+ * do nucleo (254 tarefas, 31 prioridades) e junta as linhas em um CSV, para
+ * comparar as curvas antes e depois de uma mudanca no escalonador.
+ */
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "rtos.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#if NUMERO_DE_TAREFAS < 4 || PRIORIDADE_MAXIMA < 3
+#error "escala.c precisa de pelo menos 4 tarefas e 3 prioridades"
+#endif
+
+/*
+ * Configuracao das medicoes
+ */
+#define REPETICOES			100000UL
+
+#define TAM_PILHA			(TAM_MINIMO_PILHA + 256)
+
+/* tarefas de carga: todas menos a de medicao, a eco e a ociosa */
+#define TAREFAS_DE_CARGA	(NUMERO_DE_TAREFAS - 3)
+
+#define PRIORIDADE_ECO		PRIORIDADE_MAXIMA
+#define PRIORIDADE_MEDE		(PRIORIDADE_MAXIMA - 1)
+
+/* espera das tarefas de carga dormentes: nao despertam durante a medicao */
+#define ESPERA_DORMENTE		1000000UL
+
+void tarefa_mede(void);
+void tarefa_eco(void);
+void tarefa_dormente(void);
+void tarefa_pronta(void);
+
+static uint32_t PilhaMede[TAM_PILHA];
+static uint32_t PilhaEco[TAM_PILHA];
+static uint32_t PilhaOciosa[TAM_PILHA];
+static uint32_t PilhasCarga[TAREFAS_DE_CARGA][TAM_PILHA];
+
+semaforo_t SemaforoIda = {0,0};
+semaforo_t SemaforoVolta = {0,0};
+
+/* liberado pela ultima tarefa de carga a executar: as marcas de tempo sao
+   geradas pela tarefa de medicao, que nao pode dormir para dar a vez */
+semaforo_t SemaforoPartida = {0,0};
+static uint16_t tarefas_iniciadas = 0;
+
+/* contador de instrucoes do processo, ou -1 se nao ha */
+static int contador_instrucoes = -1;
+
+static void IniciaContador(void)
+{
+#if defined(__linux__)
+	struct perf_event_attr atributos;
+
+	memset(&atributos, 0, sizeof(atributos));
+	atributos.type = PERF_TYPE_HARDWARE;
+	atributos.size = sizeof(atributos);
+	atributos.config = PERF_COUNT_HW_INSTRUCTIONS;
+	atributos.exclude_kernel = 1;
+	atributos.exclude_hv = 1;
+	contador_instrucoes = (int)syscall(__NR_perf_event_open, &atributos, 0, -1, -1, 0);
+	if(contador_instrucoes >= 0)
+	{
+		ioctl(contador_instrucoes, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+}
+
+static uint64_t LeInstrucoes(void)
+{
+	uint64_t valor = 0;
+
+	if(contador_instrucoes < 0 || read(contador_instrucoes, &valor, sizeof(valor)) != (ssize_t)sizeof(valor))
+	{
+		return 0;
+	}
+	return valor;
+}
+
+/* uma linha CSV: tarefas, prioridades, operacao, ns e instrucoes por operacao */
+static void MostraResultado(const char *nome, uint64_t inicio, uint64_t fim, uint64_t instr_inicio, uint64_t instr_fim)
+{
+	printf("%u,%u,%s,%.1f,", (unsigned)NUMERO_DE_TAREFAS, (unsigned)PRIORIDADE_MAXIMA, nome,
+		   (double)(fim - inicio) / REPETICOES);
+	if(contador_instrucoes >= 0)
+	{
+		printf("%.1f", (double)(instr_fim - instr_inicio) / REPETICOES);
+	}
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	uint16_t i;
+
+	/* --cabecalho: so a primeira linha do CSV */
+	if(argc > 1 && strcmp(argv[1], "--cabecalho") == 0)
+	{
+		printf("tarefas,prioridades,operacao,ns,instrucoes\n");
+		return 0;
+	}
+
+	CriaTarefa(tarefa_eco, "Eco", PilhaEco, TAM_PILHA, PRIORIDADE_ECO);
+	CriaTarefa(tarefa_mede, "Mede", PilhaMede, TAM_PILHA, PRIORIDADE_MEDE);
+	for(i = 0; i < TAREFAS_DE_CARGA; i++)
+	{
+		CriaTarefa((i & 1) ? tarefa_pronta : tarefa_dormente, "Carga", PilhasCarga[i], TAM_PILHA,
+				   (prioridade_t)(1 + i % (PRIORIDADE_MAXIMA - 2)));
+	}
+	CriaTarefa(tarefa_ociosa, "Tarefa ociosa", PilhaOciosa, TAM_PILHA, 0);
+
+	IniciaContador();
+	IniciaMultitarefas();
+
+	/* Nunca chega aqui */
+	return 1;
+}
+
+/* mede uma operacao REPETICOES vezes */
+#define MEDE(nome, operacao)										\
+	do {															\
+		uint64_t inicio, fim, instr_inicio, instr_fim;				\
+		uint32_t n;													\
+		instr_inicio = LeInstrucoes();								\
+		inicio = TempoEmCiclos();									\
+		for(n = 0; n < REPETICOES; n++)								\
+		{															\
+			operacao;												\
+		}															\
+		fim = TempoEmCiclos();										\
+		instr_fim = LeInstrucoes();									\
+		MostraResultado(nome, inicio, fim, instr_inicio, instr_fim);	\
+	} while(0)
+
+/* Tarefa que executa as medicoes e encerra o programa */
+void tarefa_mede(void)
+{
+	/* deixa as tarefas de carga executarem uma vez: as dormentes vao para
+	   a lista de espera e as prontas voltam a ficar prontas na marca */
+	SemaforoAguarda(&SemaforoPartida);
+
+	MEDE("escalonador", (void)escalonador());
+	MEDE("marca_de_tempo", InterrupcaoMarcaDeTempo());
+	MEDE("semaforo_libera_aguarda", (SemaforoLibera(&SemaforoVolta), SemaforoAguarda(&SemaforoVolta)));
+	MEDE("ida_e_volta_semaforos", (SemaforoLibera(&SemaforoIda), SemaforoAguarda(&SemaforoVolta)));
+
+	exit(0);
+}
+
+/* Tarefa que responde a tarefa de medicao */
+void tarefa_eco(void)
+{
+	for(;;)
+	{
+		SemaforoAguarda(&SemaforoIda);
+		SemaforoLibera(&SemaforoVolta);
+	}
+}
+
+/* primeira execucao de uma tarefa de carga */
+static void CargaIniciada(void)
+{
+	if(++tarefas_iniciadas == TAREFAS_DE_CARGA)
+	{
+		SemaforoLibera(&SemaforoPartida);
+	}
+}
+
+/* Tarefas de carga: na lista de espera durante toda a medicao, com
+   despertares diferentes */
+void tarefa_dormente(void)
+{
+	uint32_t espera = ESPERA_DORMENTE + 97u * tarefas_iniciadas;
+
+	CargaIniciada();
+	for(;;)
+	{
+		TarefaEspera(espera);
+	}
+}
+
+/* ... ou prontas, sem executar: a marca as desperta e a tarefa de medicao,
+   de maior prioridade, nao cede o processador */
+void tarefa_pronta(void)
+{
+	CargaIniciada();
+	for(;;)
+	{
+		TarefaEspera(1);
+	}
+}
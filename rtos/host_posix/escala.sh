@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# Curvas de escala do nucleo na porta POSIX: compila escala.c com cada
+# combinacao de NUMERO_DE_TAREFAS e PRIORIDADE_MAXIMA e junta as linhas em
+# um CSV na saida. Uso (nesta pasta), antes e depois de mudar o escalonador:
+#
+#   ./escala.sh > escala_antes.csv
+#
+# Outras listas: TAREFAS="8 64" PRIORIDADES="8 31" ./escala.sh
+# (no maximo 254 tarefas, ids de 8 bits, e 31 prioridades, o mapa de prontas)
+
+TAREFAS=${TAREFAS:-"8 16 32 64 128 254"}
+PRIORIDADES=${PRIORIDADES:-"8 16 31"}
+CC=${CC:-gcc}
+BINARIO=${TMPDIR:-/tmp}/rtos_escala_$$
+
+set -e
+trap 'rm -f "$BINARIO"' EXIT
+cabecalho=1
+for tarefas in $TAREFAS; do
+	for prioridades in $PRIORIDADES; do
+		$CC -O2 -I. -I../nucleo -I../portas/posix \
+			-DNUMERO_DE_TAREFAS=$tarefas -DPRIORIDADE_MAXIMA=$prioridades \
+			-o "$BINARIO" escala.c ../portas/posix/cpu-port.c ../nucleo/rtos.c
+		if [ $cabecalho = 1 ]; then
+			"$BINARIO" --cabecalho
+			cabecalho=0
+		fi
+		"$BINARIO"
+	done
+done
@@ -0,0 +1,287 @@
+/**
+ * \file
+ *
+ * \brief Gerador da diferenca (delta) entre duas imagens do programa, para
+ * a atualizacao do SAM D21 (atualizacao.h), no computador.
+ *
+ * Le a imagem base (a que esta na placa) e a nova, em binario (ex.:
+ * arm-none-eabi-objcopy -O binary), e grava a diferenca no formato de
+ * atualizacao.h: o cabecalho com os tamanhos e os CRC-32 e as operacoes de
+ * copia da base e de insercao. As copias sao achadas por um indice de
+ * trechos de 8 bytes da base; antes do indice, tenta-se continuar a copia
+ * anterior com o mesmo deslocamento, o caso comum do codigo que so mudou
+ * de lugar. No fim, a diferenca e aplicada de volta e conferida.
+ *
+ * Compilacao e execucao (nesta pasta):
+ *
+ *   gcc -O2 -o gera_delta gera_delta.c
+ *   ./gera_delta base.bin nova.bin delta.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* como em atualizacao.h */
+#define VERSAO			1
+#define CABECALHO		20
+#define INSERE			0
+#define COPIA			1
+
+/* menor copia que compensa (abaixo dela, a operacao custa mais que os bytes) */
+#define MENOR_COPIA		8
+#define BITS_INDICE		16
+#define NENHUM			0xFFFFFFFFUL
+
+static uint8_t *Carrega(const char *caminho, uint32_t *tamanho)
+{
+	FILE *f = fopen(caminho, "rb");
+	uint8_t *dados;
+	long n;
+
+	if(f == NULL || fseek(f, 0, SEEK_END) != 0 || (n = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0)
+	{
+		fprintf(stderr, "nao abriu %s\n", caminho);
+		exit(1);
+	}
+	dados = malloc((size_t)n + 1);
+	if(dados == NULL || fread(dados, 1, (size_t)n, f) != (size_t)n)
+	{
+		fprintf(stderr, "nao leu %s\n", caminho);
+		exit(1);
+	}
+	fclose(f);
+	*tamanho = (uint32_t)n;
+	return dados;
+}
+
+static uint32_t Crc32(const uint8_t *p, uint32_t n)
+{
+	uint32_t crc = 0xFFFFFFFFUL;
+	uint8_t b;
+
+	while(n--)
+	{
+		crc ^= *p++;
+		for(b = 0; b < 8; b++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+		}
+	}
+	return ~crc;
+}
+
+static uint32_t Hash(const uint8_t *p)
+{
+	uint32_t a, b;
+
+	memcpy(&a, p, 4);
+	memcpy(&b, p + 4, 4);
+	return (uint32_t)((a * 2654435761U) ^ (b * 2246822519U)) >> (32 - BITS_INDICE);
+}
+
+/* diferenca sendo gravada */
+static uint8_t *saida;
+static uint32_t tam_saida;
+
+static void Byte(uint8_t b)
+{
+	saida[tam_saida++] = b;
+}
+
+static void Inteiro(uint32_t v)
+{
+	while(v >= 0x80)
+	{
+		Byte((uint8_t)(v | 0x80));
+		v >>= 7;
+	}
+	Byte((uint8_t)v);
+}
+
+static void Le32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static void Insercao(const uint8_t *bytes, uint32_t n)
+{
+	if(n > 0)
+	{
+		Inteiro((n << 1) | INSERE);
+		memcpy(&saida[tam_saida], bytes, n);
+		tam_saida += n;
+	}
+}
+
+static uint32_t Igual(const uint8_t *a, uint32_t na, const uint8_t *b, uint32_t nb)
+{
+	uint32_t i = 0;
+
+	while(i < na && i < nb && a[i] == b[i])
+	{
+		i++;
+	}
+	return i;
+}
+
+/* aplica a diferenca como a placa, com a base na memoria. Retorna o
+   tamanho da imagem gerada, ou 0 em erro */
+static uint32_t Aplica(const uint8_t *d, uint32_t n, const uint8_t *base, uint32_t tam_base, uint8_t *nova)
+{
+	uint32_t pos = CABECALHO, gerados = 0, origem = 0, v, tamanho, tam_nova;
+	uint8_t bits;
+
+	if(n < CABECALHO || d[0] != 'D' || d[1] != 'L' || d[2] != VERSAO)
+	{
+		return 0;
+	}
+	tam_nova = d[12] | (d[13] << 8) | ((uint32_t)d[14] << 16) | ((uint32_t)d[15] << 24);
+	while(pos < n)
+	{
+		for(v = 0, bits = 0; pos < n && bits < 35; bits += 7)
+		{
+			v |= (uint32_t)(d[pos] & 0x7F) << bits;
+			if(!(d[pos++] & 0x80))
+			{
+				break;
+			}
+		}
+		tamanho = v >> 1;
+		if((v & 1) == COPIA)
+		{
+			for(v = 0, bits = 0; pos < n && bits < 35; bits += 7)
+			{
+				v |= (uint32_t)(d[pos] & 0x7F) << bits;
+				if(!(d[pos++] & 0x80))
+				{
+					break;
+				}
+			}
+			origem += (v >> 1) ^ (0UL - (v & 1));
+			if(origem > tam_base || tamanho > tam_base - origem || tamanho > tam_nova - gerados)
+			{
+				return 0;
+			}
+			memcpy(&nova[gerados], &base[origem], tamanho);
+			origem += tamanho;
+		}
+		else
+		{
+			if(tamanho > n - pos || tamanho > tam_nova - gerados)
+			{
+				return 0;
+			}
+			memcpy(&nova[gerados], &d[pos], tamanho);
+			pos += tamanho;
+		}
+		gerados += tamanho;
+	}
+	return gerados == tam_nova ? gerados : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	uint8_t *base, *nova, *conferida;
+	uint32_t tam_base, tam_nova, *indice;
+	uint32_t i, literal = 0, origem = 0, copiados = 0, copias = 0;
+	FILE *f;
+
+	if(argc != 4)
+	{
+		fprintf(stderr, "uso: %s base.bin nova.bin delta.bin\n", argv[0]);
+		return 1;
+	}
+	base = Carrega(argv[1], &tam_base);
+	nova = Carrega(argv[2], &tam_nova);
+	if(tam_nova == 0)
+	{
+		fprintf(stderr, "imagem nova vazia\n");
+		return 1;
+	}
+
+	/* pior caso: copias de MENOR_COPIA bytes, cada uma com ate 15 bytes de
+	   operacoes (a insercao antes dela, o tamanho e o deslocamento) */
+	saida = malloc(CABECALHO + 2 * (size_t)tam_nova + 16);
+	indice = malloc(sizeof(uint32_t) << BITS_INDICE);
+	conferida = malloc(tam_nova);
+	if(saida == NULL || indice == NULL || conferida == NULL)
+	{
+		return 1;
+	}
+
+	/* a ultima ocorrencia de cada trecho, alinhado a 2 bytes (instrucoes Thumb) */
+	memset(indice, 0xFF, sizeof(uint32_t) << BITS_INDICE);
+	for(i = 0; i + MENOR_COPIA <= tam_base; i += 2)
+	{
+		indice[Hash(&base[i])] = i;
+	}
+
+	memcpy(saida, "DL", 2);
+	saida[2] = VERSAO;
+	saida[3] = 0;
+	Le32(&saida[4], tam_base);
+	Le32(&saida[8], Crc32(base, tam_base));
+	Le32(&saida[12], tam_nova);
+	Le32(&saida[16], Crc32(nova, tam_nova));
+	tam_saida = CABECALHO;
+
+	i = 0;
+	while(i < tam_nova)
+	{
+		uint32_t candidato = NENHUM, n = 0, outro, m;
+
+		/* continua no mesmo deslocamento da copia anterior */
+		if(origem + (i - literal) < tam_base)
+		{
+			candidato = origem + (i - literal);
+			n = Igual(&base[candidato], tam_base - candidato, &nova[i], tam_nova - i);
+		}
+		if(n < MENOR_COPIA && i + MENOR_COPIA <= tam_nova &&
+		   (outro = indice[Hash(&nova[i])]) != NENHUM &&
+		   (m = Igual(&base[outro], tam_base - outro, &nova[i], tam_nova - i)) > n)
+		{
+			candidato = outro;
+			n = m;
+		}
+
+		if(n < MENOR_COPIA)
+		{
+			i++;
+			continue;
+		}
+		Insercao(&nova[literal], i - literal);
+		Inteiro((n << 1) | COPIA);
+		/* deslocamento relativo em zigue-zague */
+		m = candidato - origem;
+		Inteiro((m << 1) ^ (0UL - (m >> 31)));
+		origem = candidato + n;
+		copiados += n;
+		copias++;
+		i += n;
+		literal = i;
+	}
+	Insercao(&nova[literal], tam_nova - literal);
+
+	if(Aplica(saida, tam_saida, base, tam_base, conferida) != tam_nova ||
+	   memcmp(conferida, nova, tam_nova) != 0)
+	{
+		fprintf(stderr, "a diferenca nao reproduz a imagem nova\n");
+		return 1;
+	}
+	f = fopen(argv[3], "wb");
+	if(f == NULL || fwrite(saida, 1, tam_saida, f) != tam_saida || fclose(f) != 0)
+	{
+		fprintf(stderr, "nao gravou %s\n", argv[3]);
+		return 1;
+	}
+
+	printf("base %u bytes, nova %u bytes, diferenca %u bytes (%.1f%%): %u copias com %u bytes\n",
+		   (unsigned)tam_base, (unsigned)tam_nova, (unsigned)tam_saida, 100.0 * tam_saida / tam_nova,
+		   (unsigned)copias, (unsigned)copiados);
+	return 0;
+}
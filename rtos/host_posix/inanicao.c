@@ -0,0 +1,145 @@
+/**
+ * \file
+ *
+ * \brief Teste da deteccao de inanicao (cfg_INANICAO) na porta POSIX.
+ *
+ * A tarefa ocupada executa sem ceder por ESPERA_OCUPADA marcas e dorme
+ * uma marca, repetidamente; a tarefa baixa, de menor prioridade, nunca
+ * bloqueia. Enquanto a ocupada executa, a baixa e a ociosa ficam prontas
+ * sem a CPU, alem do limite: a baixa deve ser avisada e contada, a ociosa
+ * (prioridade 0, sempre pronta) nunca. Depois de DURACAO marcas, a tarefa
+ * de conferencia, de maior prioridade, confere:
+ *  - baixa: avisos pelo gancho e inanicoes de TarefaObtemInanicao, com a
+ *    maior espera de pelo menos o limite;
+ *  - ociosa: nenhum aviso, e TarefaObtemInanicao retorna 0.
+ *
+ * Compilacao e execucao (nesta pasta), com marcas reais (SIGALRM):
+ *
+ *   gcc -O2 -I. -I../nucleo -I../portas/posix -DTESTE_INANICAO=1 \
+ *       -Dcfg_PREEMPTIVO=1 -Dcfg_INANICAO=10 \
+ *       -o rtos_inanicao inanicao.c \
+ *       ../portas/posix/cpu-port.c ../nucleo/rtos.c
+ *   ./rtos_inanicao
+ *
+ * Imprime uma linha por tarefa, com os campos separados por ';' como em
+ * longa_duracao.c:
+ *
+ *   inanicao;<tarefa>;<avisos>;<inanicoes>;<maior espera em marcas>
+ *
+ * Retorna 1 se alguma conferencia falhou.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "rtos.h"
+
+#if !TESTE_INANICAO || cfg_INANICAO == 0 || !cfg_PREEMPTIVO
+#error "compile com -DTESTE_INANICAO=1 -Dcfg_PREEMPTIVO=1 -Dcfg_INANICAO=10 (ver a linha de compilacao acima)"
+#endif
+
+/*
+ * Configuracao do teste
+ */
+#define ESPERA_OCUPADA			(4 * cfg_INANICAO)
+#define DURACAO					(40 * ESPERA_OCUPADA)
+
+#define PRIORIDADE_CONFERENCIA	3
+#define PRIORIDADE_OCUPADA		2
+#define PRIORIDADE_BAIXA		1
+
+#define TAM_PILHA				(TAM_MINIMO_PILHA + 256)
+
+void tarefa_conferencia(void);
+void tarefa_ocupada(void);
+void tarefa_baixa(void);
+
+static uint32_t PilhaConferencia[TAM_PILHA];
+static uint32_t PilhaOcupada[TAM_PILHA];
+static uint32_t PilhaBaixa[TAM_PILHA];
+static uint32_t PilhaOciosa[TAM_PILHA];
+
+static uint8_t id_baixa;
+static uint8_t id_ociosa;
+static volatile uint32_t avisos[NUMERO_DE_TAREFAS + 1];
+static volatile uint32_t voltas_baixa;
+
+/* gancho cfg_INANICAO_DETECTADA (conf_rtos.h), chamado na marca de tempo */
+void InanicaoDetectada(uint8_t id_tarefa, uint32_t marcas)
+{
+	(void)marcas;
+
+	if(id_tarefa <= NUMERO_DE_TAREFAS)
+	{
+		avisos[id_tarefa]++;
+	}
+}
+
+int main(void)
+{
+	CriaTarefa(tarefa_conferencia, "Conferencia", PilhaConferencia, TAM_PILHA, PRIORIDADE_CONFERENCIA);
+	CriaTarefa(tarefa_ocupada, "Ocupada", PilhaOcupada, TAM_PILHA, PRIORIDADE_OCUPADA);
+	id_baixa = CriaTarefa(tarefa_baixa, "Baixa", PilhaBaixa, TAM_PILHA, PRIORIDADE_BAIXA);
+	id_ociosa = CriaTarefa(tarefa_ociosa, "Tarefa ociosa", PilhaOciosa, TAM_PILHA, 0);
+
+	ConfiguraMarcaTempo();
+	IniciaMultitarefas();
+
+	/* Nunca chega aqui */
+	return 1;
+}
+
+/* dorme DURACAO marcas e confere os avisos e as medicoes */
+void tarefa_conferencia(void)
+{
+	inanicao_tarefa_t baixa, ociosa;
+	uint8_t obtida_baixa, obtida_ociosa;
+	uint32_t erros = 0;
+
+	TarefaEspera(DURACAO);
+
+	obtida_baixa = TarefaObtemInanicao(id_baixa, &baixa);
+	obtida_ociosa = TarefaObtemInanicao(id_ociosa, &ociosa);
+
+	printf("inanicao;baixa;%lu;%u;%lu\n", (unsigned long)avisos[id_baixa],
+		   obtida_baixa ? baixa.inanicoes : 0, obtida_baixa ? (unsigned long)baixa.maior_espera : 0UL);
+	printf("inanicao;ociosa;%lu;%s\n", (unsigned long)avisos[id_ociosa],
+		   obtida_ociosa ? "medida" : "nao medida");
+
+	if(!obtida_baixa || avisos[id_baixa] == 0 || baixa.inanicoes != avisos[id_baixa] ||
+	   baixa.maior_espera < cfg_INANICAO || voltas_baixa == 0)
+	{
+		printf("erro;baixa;inanicao nao detectada\n");
+		erros++;
+	}
+	if(avisos[id_ociosa] != 0 || obtida_ociosa)
+	{
+		printf("erro;ociosa;a ociosa nao deve ser conferida\n");
+		erros++;
+	}
+
+	exit(erros != 0);
+}
+
+/* segura a CPU por ESPERA_OCUPADA marcas e dorme uma */
+void tarefa_ocupada(void)
+{
+	for(;;)
+	{
+		tick_t inicio = ObtemMarcasDeTempo();
+
+		while(ObtemMarcasDeTempo() - inicio < ESPERA_OCUPADA)
+		{
+		}
+		TarefaEspera(1);
+	}
+}
+
+/* sempre pronta: so executa quando a ocupada dorme */
+void tarefa_baixa(void)
+{
+	for(;;)
+	{
+		voltas_baixa++;
+	}
+}
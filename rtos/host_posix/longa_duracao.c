@@ -0,0 +1,352 @@
+/**
+ * \file
+ *
+ * \brief Teste de longa duracao do nucleo com marcas de tempo virtuais (porta POSIX).
+ *
+ * O contador de marcas de 32 bits retorna a 0 apos ~49 dias a 1 kHz, tempo
+ * demais para um teste em tempo real. Com MARCAS_VIRTUAIS, a tarefa ociosa
+ * salta direto para o proximo despertar, entao meses de funcionamento passam
+ * em segundos; com cfg_MARCA_INICIAL perto do maximo, o primeiro retorno a 0
+ * acontece logo no inicio. Durante DIAS dias virtuais, confere a cada
+ * despertar se o instante e exatamente o esperado:
+ *  - periodica: TarefaEsperaAte com periodo de 1 minuto;
+ *  - espera: TarefaEspera com atrasos aleatorios, curtos e longos;
+ *  - condicao: antes de cada espera, CondicaoAguarda com tempo 0, que deve
+ *    retornar 0 na mesma marca sem prender as esperas seguintes;
+ *  - semaforo: SemaforoAguardaTempo, esgotando o tempo ou liberado por um
+ *    temporizador de uma vez ligado com o mesmo atraso;
+ *  - temporizador: temporizador periodico, ligado so nas horas impares, para
+ *    que a roda tambem fique vazia durante esperas longas;
+ *  - rapida: TarefaEsperaAte a cada PERIODO_RAPIDA marcas, so na janela em
+ *    volta de cada retorno a 0, dormindo ate a proxima janela.
+ *
+ * Compilacao e execucao (nesta pasta):
+ *
+ *   gcc -O2 -I. -I../nucleo -I../portas/posix -DMARCAS_VIRTUAIS=1 \
+ *       -Dcfg_OCIOSA_SEM_MARCAS=1 -Dcfg_OCIOSA_MIN_MARCAS=1 \
+ *       -Dcfg_TEMPORIZADORES=1 -Dcfg_MARCA_INICIAL=0xFFFF0000 \
+ *       -o rtos_longa_duracao longa_duracao.c \
+ *       ../portas/posix/cpu-port.c ../nucleo/rtos.c
+ *   ./rtos_longa_duracao [dias] [semente]
+ *
+ * Imprime uma linha por retorno a 0 e uma por verificacao, com os campos
+ * separados por ';' como nos testes de t2, t3 e t4:
+ *
+ *   verificacao;<nome>;<despertares>;<erros>;<maior desvio em marcas>
+ *
+ * Retorna 1 se algum despertar saiu do instante esperado. O tempo real da
+ * execucao tambem mostra se alguma mudanca no nucleo passou a percorrer as
+ * marcas dormidas uma a uma.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "rtos.h"
+
+#if !MARCAS_VIRTUAIS || !cfg_TEMPORIZADORES
+#error "compile com -DMARCAS_VIRTUAIS=1 -Dcfg_TEMPORIZADORES=1 (ver a linha de compilacao acima)"
+#endif
+
+#if NUMERO_DE_TAREFAS < 6 || PRIORIDADE_MAXIMA < 4
+#error "longa_duracao.c precisa de pelo menos 6 tarefas e 4 prioridades"
+#endif
+
+/*
+ * Configuracao do teste
+ */
+#define DIAS_PADRAO				100
+#define MARCAS_POR_MINUTO		(60UL * cfg_MARCA_TEMPO_HZ)
+#define MINUTOS_POR_DIA			(24UL * 60UL)
+
+/* periodos em marcas: impares, para cruzar o retorno a 0 em fases variadas */
+#define PERIODO_TEMPORIZADOR	36007UL
+#define PERIODO_RAPIDA			3UL
+#define JANELA_RAPIDA			3000UL		/* marcas antes e depois do retorno a 0 */
+
+/* maior atraso das esperas aleatorias: curtas ate 100 marcas, longas ate 10 min */
+#define ESPERA_CURTA			100UL
+#define ESPERA_LONGA			(10UL * MARCAS_POR_MINUTO)
+
+/* maior desvio aceito em marcas: com marcas virtuais as tarefas nao gastam
+   tempo, entao todo despertar e exato */
+#ifndef LIMITE_DESVIO
+#define LIMITE_DESVIO			0
+#endif
+
+/* erros impressos por verificacao; os demais so sao contados */
+#define ERROS_IMPRESSOS			5
+
+#define TAM_PILHA				(TAM_MINIMO_PILHA + 256)
+
+#define PRIORIDADE_TEMPORIZADORES	PRIORIDADE_MAXIMA
+#define PRIORIDADE_RAPIDA		3
+#define PRIORIDADE_PERIODICA	2
+#define PRIORIDADE_ESPERAS		1
+
+typedef struct
+{
+	const char	*nome;
+	uint32_t	despertares;
+	uint32_t	erros;
+	tick_t		desvio_maximo;		/* sem sinal: um despertar adiantado aparece enorme */
+} verificacao_t;
+
+enum { V_PERIODICA, V_ESPERA, V_CONDICAO, V_SEMAFORO, V_TEMPORIZADOR, V_RAPIDA, VERIFICACOES };
+
+static verificacao_t verificacoes[VERIFICACOES] =
+{
+	{"periodica", 0, 0, 0},
+	{"espera", 0, 0, 0},
+	{"condicao", 0, 0, 0},
+	{"semaforo", 0, 0, 0},
+	{"temporizador", 0, 0, 0},
+	{"rapida", 0, 0, 0}
+};
+
+void tarefa_periodica(void);
+void tarefa_espera(void);
+void tarefa_semaforo(void);
+void tarefa_rapida(void);
+
+static uint32_t PilhaTemporizadores[TAM_PILHA];
+static uint32_t PilhaPeriodica[TAM_PILHA];
+static uint32_t PilhaEspera[TAM_PILHA];
+static uint32_t PilhaSemaforo[TAM_PILHA];
+static uint32_t PilhaRapida[TAM_PILHA];
+static uint32_t PilhaOciosa[TAM_PILHA];
+
+static semaforo_t SemaforoTeste = {0,0};
+static mutex_t MutexTeste;
+static condicao_t CondicaoTeste;
+static temporizador_t TemporizadorPeriodico;
+static temporizador_t TemporizadorUnico;
+static tick_t vencimento_periodico;
+
+static uint32_t dias = DIAS_PADRAO;
+static uint32_t semente = 1;
+static clock_t inicio_real;
+
+/* xorshift32: a mesma semente repete a mesma sequencia de esperas */
+static uint32_t Aleatorio(void)
+{
+	semente ^= semente << 13;
+	semente ^= semente >> 17;
+	semente ^= semente << 5;
+	return semente;
+}
+
+/* atraso entre 1 e o maximo, metade curtos e metade longos */
+static tick_t AtrasoAleatorio(void)
+{
+	uint32_t sorteio = Aleatorio();
+
+	return (tick_t)(1 + (sorteio >> 1) % ((sorteio & 1) ? ESPERA_LONGA : ESPERA_CURTA));
+}
+
+/* confere um despertar: esperado e o instante em que deveria acontecer */
+static void Confere(uint8_t indice, tick_t esperado)
+{
+	verificacao_t *v = &verificacoes[indice];
+	tick_t desvio = ObtemMarcasDeTempo() - esperado;
+
+	v->despertares++;
+	if(desvio > v->desvio_maximo)
+	{
+		v->desvio_maximo = desvio;
+	}
+	if(desvio > LIMITE_DESVIO)
+	{
+		if(v->erros < ERROS_IMPRESSOS)
+		{
+			printf("erro;%s;esperado %lu;marca %lu\n", v->nome, (unsigned long)esperado,
+				   (unsigned long)ObtemMarcasDeTempo());
+		}
+		v->erros++;
+	}
+}
+
+static void TerminaTeste(void)
+{
+	uint32_t erros = 0;
+	uint8_t i;
+
+	for(i = 0; i < VERIFICACOES; i++)
+	{
+		verificacao_t *v = &verificacoes[i];
+
+		printf("verificacao;%s;%lu;%lu;%ld\n", v->nome, (unsigned long)v->despertares,
+			   (unsigned long)v->erros, (long)(int32_t)v->desvio_maximo);
+		erros += v->erros;
+	}
+	printf("%lu dias virtuais em %.1f s\n", (unsigned long)dias,
+		   (double)(clock() - inicio_real) / CLOCKS_PER_SEC);
+
+	exit(erros != 0);
+}
+
+static void VenceTemporizadorPeriodico(void *arg)
+{
+	(void)arg;
+
+	Confere(V_TEMPORIZADOR, vencimento_periodico);
+	vencimento_periodico += PERIODO_TEMPORIZADOR;
+}
+
+static void VenceTemporizadorUnico(void *arg)
+{
+	SemaforoLibera((semaforo_t *)arg);
+}
+
+int main(int argc, char **argv)
+{
+	if(argc > 1)
+	{
+		dias = (uint32_t)strtoul(argv[1], 0, 0);
+	}
+	if(argc > 2)
+	{
+		semente = (uint32_t)strtoul(argv[2], 0, 0) | 1;		/* xorshift nao sai do 0 */
+	}
+
+	TemporizadorInicia(&TemporizadorPeriodico, VenceTemporizadorPeriodico, 0);
+	TemporizadorInicia(&TemporizadorUnico, VenceTemporizadorUnico, &SemaforoTeste);
+
+	CriaTarefa(tarefa_temporizadores, "Temporizadores", PilhaTemporizadores, TAM_PILHA, PRIORIDADE_TEMPORIZADORES);
+	CriaTarefa(tarefa_rapida, "Rapida", PilhaRapida, TAM_PILHA, PRIORIDADE_RAPIDA);
+	CriaTarefa(tarefa_periodica, "Periodica", PilhaPeriodica, TAM_PILHA, PRIORIDADE_PERIODICA);
+	CriaTarefa(tarefa_espera, "Espera", PilhaEspera, TAM_PILHA, PRIORIDADE_ESPERAS);
+	CriaTarefa(tarefa_semaforo, "Semaforo", PilhaSemaforo, TAM_PILHA, PRIORIDADE_ESPERAS);
+	CriaTarefa(tarefa_ociosa, "Tarefa ociosa", PilhaOciosa, TAM_PILHA, 0);
+
+	printf("%lu dias a partir da marca 0x%08lX, semente %lu\n", (unsigned long)dias,
+		   (unsigned long)ObtemMarcasDeTempo(), (unsigned long)semente);
+	inicio_real = clock();
+	IniciaMultitarefas();
+
+	/* Nunca chega aqui */
+	return 1;
+}
+
+/* a cada minuto: conta os retornos a 0, liga o temporizador periodico nas
+   horas impares e termina o teste apos os dias pedidos */
+void tarefa_periodica(void)
+{
+	tick_t ultimo = ObtemMarcasDeTempo();
+	uint32_t minutos = 0;
+	uint32_t retornos = 0;
+
+	for(;;)
+	{
+		tick_t anterior = ultimo;
+
+		TarefaEsperaAte(&ultimo, MARCAS_POR_MINUTO);
+		Confere(V_PERIODICA, ultimo);
+		minutos++;
+
+		if(ultimo < anterior)
+		{
+			retornos++;
+			printf("retorno;%lu;dia %lu\n", (unsigned long)retornos, (unsigned long)(minutos / MINUTOS_POR_DIA));
+		}
+
+		if(minutos % 60 == 0)
+		{
+			if((minutos / 60) & 1)
+			{
+				vencimento_periodico = ObtemMarcasDeTempo() + PERIODO_TEMPORIZADOR;
+				TemporizadorLiga(&TemporizadorPeriodico, PERIODO_TEMPORIZADOR, PERIODO_TEMPORIZADOR);
+			}
+			else
+			{
+				TemporizadorDesliga(&TemporizadorPeriodico);
+			}
+		}
+
+		if(minutos >= dias * MINUTOS_POR_DIA)
+		{
+			TerminaTeste();
+		}
+	}
+}
+
+void tarefa_espera(void)
+{
+	for(;;)
+	{
+		tick_t atraso = AtrasoAleatorio();
+		tick_t inicio = ObtemMarcasDeTempo();
+		uint8_t sinalizada;
+
+		/* ninguem sinaliza: com tempo 0 nao pode esperar nem ficar na lista */
+		MutexAguarda(&MutexTeste);
+		sinalizada = CondicaoAguarda(&CondicaoTeste, &MutexTeste, 0);
+		MutexLibera(&MutexTeste);
+		if(sinalizada)
+		{
+			printf("erro;condicao;sinalizada sem sinal;marca %lu\n", (unsigned long)ObtemMarcasDeTempo());
+			verificacoes[V_CONDICAO].erros++;
+		}
+		Confere(V_CONDICAO, inicio);
+
+		TarefaEspera(atraso);
+		Confere(V_ESPERA, inicio + atraso);
+	}
+}
+
+/* alterna entre esgotar o tempo e ser liberada pelo temporizador de uma vez */
+void tarefa_semaforo(void)
+{
+	uint8_t liberado = 0;
+
+	for(;;)
+	{
+		tick_t atraso = AtrasoAleatorio();
+		tick_t inicio = ObtemMarcasDeTempo();
+		uint8_t obtido;
+
+		liberado = !liberado;
+		if(liberado)
+		{
+			TemporizadorLiga(&TemporizadorUnico, atraso, 0);
+			obtido = SemaforoAguardaTempo(&SemaforoTeste, atraso + 1);
+		}
+		else
+		{
+			obtido = SemaforoAguardaTempo(&SemaforoTeste, atraso);
+		}
+
+		if(obtido != liberado)
+		{
+			printf("erro;semaforo;%s;marca %lu\n", obtido ? "obtido sem liberar" : "tempo esgotado",
+				   (unsigned long)ObtemMarcasDeTempo());
+			verificacoes[V_SEMAFORO].erros++;
+		}
+		Confere(V_SEMAFORO, inicio + atraso);
+	}
+}
+
+/* dorme ate JANELA_RAPIDA marcas antes do retorno a 0 e executa a cada
+   PERIODO_RAPIDA marcas ate JANELA_RAPIDA marcas depois dele */
+void tarefa_rapida(void)
+{
+	for(;;)
+	{
+		tick_t ate_retorno = (tick_t)0 - ObtemMarcasDeTempo();
+		tick_t ultimo;
+		uint32_t i;
+
+		if(ate_retorno > JANELA_RAPIDA)
+		{
+			TarefaEspera(ate_retorno - JANELA_RAPIDA);
+		}
+
+		ultimo = ObtemMarcasDeTempo();
+		for(i = 0; i < 2 * JANELA_RAPIDA / PERIODO_RAPIDA; i++)
+		{
+			TarefaEsperaAte(&ultimo, PERIODO_RAPIDA);
+			Confere(V_RAPIDA, ultimo);
+		}
+	}
+}
@@ -0,0 +1,211 @@
+/**
+ * \file
+ *
+ * \brief Medicoes de desempenho do sistema multitarefas no computador (porta POSIX).
+ *
+ * Compilacao e execucao (nesta pasta), com o mesmo nucleo das placas:
+ *
+ *   gcc -O2 -I. -I../nucleo -I../portas/posix -o rtos_host \
+ *       main.c ../portas/posix/cpu-port.c ../nucleo/rtos.c
+ *   ./rtos_host
+ *
+ * As macros de configuracao do rtos.h podem ser trocadas no conf_rtos.h ou na
+ * linha de compilacao (ex.: -Dcfg_FATIA_TEMPO=0 -DNUMERO_DE_TAREFAS=8), permitindo
+ * comparar varias configuracoes do nucleo sem alterar os fontes.
+ *
+ * As marcas de tempo sao geradas com InterrupcaoMarcaDeTempo(), e nao pelo
+ * temporizador, para que os resultados nao dependam do computador.
+ *
+ * A escala com o numero de tarefas e de prioridades e medida pelo escala.c
+ * (escala.sh gera o CSV de todas as configuracoes).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "rtos.h"
+
+/*
+ * Configuracao das medicoes
+ */
+#define REPETICOES			100000UL
+
+/*
+ * Configuracao dos tamanhos das pilhas
+ */
+#define TAM_PILHA			(TAM_MINIMO_PILHA + 256)
+
+/*
+ * Tabela de tarefas: funcao, nome, tamanho da pilha, prioridade. 
+ * Gera os prototipos, as pilhas e a tabela usada por CriaTarefasDaTabela
+ */
+#define TABELA_DE_TAREFAS(TAREFA)											\
+	TAREFA(tarefa_mede,			"Mede",				TAM_PILHA,	2)		\
+	TAREFA(tarefa_eco,			"Eco",				TAM_PILHA,	3)		\
+	TAREFA(tarefa_dorminhoca_1,	"Dorminhoca 1",		TAM_PILHA,	1)		\
+	TAREFA(tarefa_dorminhoca_2,	"Dorminhoca 2",		TAM_PILHA,	1)		\
+	TAREFA(tarefa_ociosa,		"Tarefa ociosa",	TAM_PILHA,	0)
+
+TAREFAS_DECLARA(TABELA_DE_TAREFAS)
+
+/*
+ * Semaforos usados na medicao de ida e volta entre duas tarefas
+ */
+semaforo_t SemaforoIda = {0,0};
+semaforo_t SemaforoVolta = {0,0};
+
+/*
+ * Trava de leitura sem escritor, comparada ao semaforo
+ */
+trava_rw_t TravaConfiguracao = {0,0,0,0};
+
+/*
+ * Instantaneo de 8 palavras, publicado e lido sem regiao atomica
+ */
+instantaneo_t InstantaneoSensor;
+uint32_t area_sensor[2 * 8];
+
+/*
+ * Funcao principal de entrada do sistema
+ */
+int main(void)
+{
+	/* Criacao das tarefas da tabela, inclusive a tarefa ociosa do sistema */
+	CriaTarefasDaTabela(tabela_de_tarefas, NUMERO_TAREFAS_DA_TABELA);
+
+	/* Inicia sistema multitarefas */
+	IniciaMultitarefas();
+
+	/* Nunca chega aqui */
+	return 1;
+}
+
+/* mostra o custo medio de uma operacao, em nanossegundos */
+static void MostraResultado(const char *nome, uint64_t inicio, uint64_t fim)
+{
+	printf("%-40s %8.1f ns\n", nome, (double)(fim - inicio) / REPETICOES);
+}
+
+/* Tarefa que executa as medicoes e encerra o programa */
+void tarefa_mede(void)
+{
+	uint64_t inicio, fim;
+	uint32_t i;
+
+	/* escalonador: busca da tarefa de maior prioridade pronta */
+	inicio = TempoEmCiclos();
+	for(i = 0; i < REPETICOES; i++)
+	{
+		(void)escalonador();
+	}
+	fim = TempoEmCiclos();
+	MostraResultado("escalonador()", inicio, fim);
+
+	/* semaforo sem espera nem troca de contexto */
+	inicio = TempoEmCiclos();
+	for(i = 0; i < REPETICOES; i++)
+	{
+		SemaforoLibera(&SemaforoVolta);
+		SemaforoAguarda(&SemaforoVolta);
+	}
+	fim = TempoEmCiclos();
+	MostraResultado("SemaforoLibera + SemaforoAguarda", inicio, fim);
+
+	/* rajada de 8 itens (ex.: fim de um DMA): uma liberacao por item ou uma so */
+	inicio = TempoEmCiclos();
+	for(i = 0; i < REPETICOES; i++)
+	{
+		uint8_t item;
+
+		for(item = 0; item < 8; item++)
+		{
+			SemaforoLibera(&SemaforoVolta);
+		}
+		SemaforoVolta.contador = 0;
+	}
+	fim = TempoEmCiclos();
+	MostraResultado("8 x SemaforoLibera", inicio, fim);
+
+	inicio = TempoEmCiclos();
+	for(i = 0; i < REPETICOES; i++)
+	{
+		SemaforoLiberaN(&SemaforoVolta, 8);
+		SemaforoVolta.contador = 0;
+	}
+	fim = TempoEmCiclos();
+	MostraResultado("SemaforoLiberaN(8)", inicio, fim);
+
+	/* leitura sem escritor: so conta o leitor */
+	inicio = TempoEmCiclos();
+	for(i = 0; i < REPETICOES; i++)
+	{
+		TravaLeituraAguarda(&TravaConfiguracao);
+		TravaLeituraLibera(&TravaConfiguracao);
+	}
+	fim = TempoEmCiclos();
+	MostraResultado("TravaLeituraAguarda + TravaLeituraLibera", inicio, fim);
+
+	/* publicacao e leitura de um bloco de 8 palavras */
+	{
+		uint32_t vetor[8] = {0};
+
+		InstantaneoInicia(&InstantaneoSensor, (uint8_t *)area_sensor, sizeof(vetor));
+		inicio = TempoEmCiclos();
+		for(i = 0; i < REPETICOES; i++)
+		{
+			vetor[0] = i;
+			InstantaneoPublica(&InstantaneoSensor, vetor);
+			(void)InstantaneoLe(&InstantaneoSensor, vetor);
+		}
+		fim = TempoEmCiclos();
+		MostraResultado("InstantaneoPublica + InstantaneoLe", inicio, fim);
+	}
+
+	/* ida e volta com a tarefa eco: duas trocas de contexto */
+	inicio = TempoEmCiclos();
+	for(i = 0; i < REPETICOES; i++)
+	{
+		SemaforoLibera(&SemaforoIda);		/* acorda a tarefa eco, de maior prioridade */
+		SemaforoAguarda(&SemaforoVolta);
+	}
+	fim = TempoEmCiclos();
+	MostraResultado("ida e volta por semaforos (2 trocas)", inicio, fim);
+
+	/* marca de tempo com as tarefas dorminhocas na lista de espera */
+	inicio = TempoEmCiclos();
+	for(i = 0; i < REPETICOES; i++)
+	{
+		InterrupcaoMarcaDeTempo();
+	}
+	fim = TempoEmCiclos();
+	MostraResultado("marca de tempo", inicio, fim);
+
+	exit(0);
+}
+
+/* Tarefa que responde a tarefa de medicao */
+void tarefa_eco(void)
+{
+	for(;;)
+	{
+		SemaforoAguarda(&SemaforoIda);
+		SemaforoLibera(&SemaforoVolta);
+	}
+}
+
+/* Tarefas que ficam na lista de espera durante a medicao da marca de tempo */
+void tarefa_dorminhoca_1(void)
+{
+	for(;;)
+	{
+		TarefaEspera(3);
+	}
+}
+
+void tarefa_dorminhoca_2(void)
+{
+	for(;;)
+	{
+		TarefaEspera(7);
+	}
+}
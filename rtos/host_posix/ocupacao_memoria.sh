@@ -0,0 +1,264 @@
+#!/bin/sh
+#
+# Ocupacao de RAM e flash de uma placa, lida do arquivo de mapa do ligador
+# (-Wl,-Map) e comparada com um orcamento. Retorna 1 se algum item passou
+# do limite, para falhar a compilacao. Uso:
+#
+#   ./ocupacao_memoria.sh projeto.map orcamento_memoria.txt
+#
+# Cada linha do orcamento e um item: nome, classe, padrao e limite em bytes
+# (- usa o tamanho da regiao de memoria do mapa; # inicia um comentario):
+#
+#   TCB        dados   :TCB$                        512
+#   nucleo     codigo  (rtos|cpu-port)\.o:          12288
+#   ram        total   ram                          -
+#
+# Classes:
+#  - dados: variaveis na RAM (.data, .bss, .noinit, COMMON);
+#  - codigo: funcoes (.text e .ramfunc, na flash ou na RAM);
+#  - total: ocupacao de uma regiao do mapa (ex.: ram, rom), com .data
+#    contada na RAM e na flash.
+# O padrao (expressao regular estendida) e comparado com "objeto:nome", ex.:
+# "main.o:PILHA_TAREFA_1". Os nomes vem das secoes de -fdata-sections e
+# -ffunction-sections (.bss.TCB, .text.escalonador), inclusive das variaveis
+# static; nas secoes sem divisao (.noinit, COMMON), das variaveis globais,
+# com o tamanho ate a proxima variavel. Os bytes das variaveis static dessas
+# secoes vao para "objeto:.secao".
+#
+# Saida, com os campos separados por ';' como nos testes de t2, t3 e t4:
+#
+#   memoria;<item>;<bytes>;<limite>;ok|estourado
+#   parte;<item>;<objeto:nome>;<bytes>
+
+if [ $# -ne 2 ]; then
+	echo "uso: $0 projeto.map orcamento_memoria.txt" >&2
+	exit 2
+fi
+
+# o MPLAB X grava o caminho do mapa com '\' no Windows
+MAPA=$(echo "$1" | tr '\\' '/')
+ORCAMENTO=$2
+
+for arquivo in "$MAPA" "$ORCAMENTO"; do
+	if [ ! -r "$arquivo" ]; then
+		echo "$0: nao foi possivel ler $arquivo" >&2
+		exit 2
+	fi
+done
+
+tr -d '\r' < "$MAPA" | awk -v orcamento="$ORCAMENTO" '
+function hex(s,    i, c, v) {
+	v = 0
+	s = tolower(s)
+	sub(/^0x/, "", s)
+	for (i = 1; i <= length(s); i++) {
+		c = index("0123456789abcdef", substr(s, i, 1))
+		if (c == 0) {
+			break
+		}
+		v = v * 16 + c - 1
+	}
+	return v
+}
+
+function regiao(endereco,    r) {
+	for (r = 1; r <= num_regioes; r++) {
+		if (endereco >= origem[r] && endereco < origem[r] + tamanho[r]) {
+			return nome_regiao[r]
+		}
+	}
+	return ""
+}
+
+function base(caminho) {
+	sub(/.*[\/\\]/, "", caminho)
+	return caminho
+}
+
+# variavel ou funcao de uma secao de entrada
+function item(classe, nome, bytes) {
+	if (bytes <= 0) {
+		return
+	}
+	n++
+	classe_item[n] = classe
+	nome_item[n] = nome
+	bytes_item[n] = bytes
+}
+
+# fecha a secao sem divisao em andamento: cada global vai ate a seguinte
+function fecha_secao(    s, fim) {
+	if (secao_aberta && num_simbolos > 0) {
+		item("dados", objeto_secao ":" secao_atual, endereco_simbolo[1] - inicio_secao)
+		for (s = 1; s <= num_simbolos; s++) {
+			fim = (s < num_simbolos) ? endereco_simbolo[s + 1] : inicio_secao + tamanho_secao
+			item("dados", objeto_secao ":" nome_simbolo[s], fim - endereco_simbolo[s])
+		}
+	} else if (secao_aberta) {
+		item("dados", objeto_secao ":" secao_atual, tamanho_secao)
+	}
+	secao_aberta = 0
+	num_simbolos = 0
+}
+
+function secao_entrada(nome, endereco, bytes, objeto,    variavel, classe) {
+	fecha_secao()
+	if (bytes == 0 || descartada) {
+		return
+	}
+	objeto = base(objeto)
+	if (nome ~ /^\.(text|ramfunc)/) {
+		classe = "codigo"
+	} else if (regiao(endereco) == regiao_ram && nome ~ /^(\.(bss|data|noinit)|COMMON)/) {
+		classe = "dados"
+	} else {
+		return
+	}
+	variavel = nome
+	if (sub(/^\.(text|ramfunc|bss|data|noinit)\./, "", variavel)) {
+		sub(/\.[0-9]+$/, "", variavel)	# static local: nome.N
+		item(classe, objeto ":" variavel, bytes)
+	} else if (classe == "dados") {
+		secao_aberta = 1
+		secao_atual = nome
+		objeto_secao = objeto
+		inicio_secao = endereco
+		tamanho_secao = bytes
+	} else {
+		item(classe, objeto ":" nome, bytes)
+	}
+}
+
+function secao_saida(nome, endereco, bytes, resto,    carga) {
+	fecha_secao()
+	descartada = (nome ~ /^\.(debug|comment|ARM\.attributes|stab)/ || nome == "/DISCARD/")
+	if (descartada || bytes == 0) {
+		return
+	}
+	ocupado[regiao(endereco)] += bytes
+	# .relocate (.data e .ramfunc do ASF): na RAM, copiada da flash. O 
+	# ligador tambem mostra o endereco de carga das secoes NOLOAD seguintes 
+	# (.bss, .stack), que nao ocupam a flash
+	if (nome ~ /^\.(relocate|data|ramfunc)/ && match(resto, /load address 0x[0-9a-fA-F]+/)) {
+		carga = hex(substr(resto, RSTART + 13, RLENGTH - 13))
+		if (regiao(carga) != regiao(endereco)) {
+			ocupado[regiao(carga)] += bytes
+		}
+	}
+}
+
+/^Memory Configuration/ { fase = 1; next }
+/^Linker script and memory map/ { fase = 2; next }
+
+fase == 1 && NF >= 3 && $2 ~ /^0x/ && $1 != "Name" && $1 != "*default*" {
+	num_regioes++
+	nome_regiao[num_regioes] = $1
+	origem[num_regioes] = hex($2)
+	tamanho[num_regioes] = hex($3)
+	if ($4 ~ /w/ && regiao_ram == "") {
+		regiao_ram = $1
+	}
+	next
+}
+
+fase != 2 { next }
+
+# nome longo: o endereco e o tamanho vem na linha seguinte
+/^ ?[^ ]+$/ && $1 ~ /^(\.|COMMON)/ {
+	pendente = $1
+	pendente_entrada = ($0 ~ /^ /)
+	next
+}
+
+{
+	linha = $0
+	if (pendente != "") {
+		linha = (pendente_entrada ? " " : "") pendente " " $0
+		pendente = ""
+	}
+	campos = split(linha, f, " ")
+}
+
+# secao de saida, na coluna 0
+linha ~ /^[.\/]/ && campos >= 3 && f[2] ~ /^0x/ && f[3] ~ /^0x/ {
+	resto = linha
+	sub(/^[^ ]+ +[^ ]+ +[^ ]+/, "", resto)
+	secao_saida(f[1], hex(f[2]), hex(f[3]), resto)
+	next
+}
+
+# secao de entrada: " .bss.TCB  0x20000100  0x1a4 src/nucleo/rtos.o"
+linha ~ /^ [.A-Z]/ && campos >= 4 && f[2] ~ /^0x/ && f[3] ~ /^0x/ {
+	secao_entrada(f[1], hex(f[2]), hex(f[3]), f[4])
+	next
+}
+
+# simbolo global dentro de uma secao sem divisao: "  0x20000100  TCB"
+secao_aberta && campos == 2 && f[1] ~ /^0x/ && f[2] !~ /^0x/ {
+	endereco = hex(f[1])
+	if (endereco >= inicio_secao && endereco < inicio_secao + tamanho_secao &&
+	    (num_simbolos == 0 || endereco > endereco_simbolo[num_simbolos])) {
+		num_simbolos++
+		endereco_simbolo[num_simbolos] = endereco
+		nome_simbolo[num_simbolos] = f[2]
+	}
+	next
+}
+
+END {
+	fecha_secao()
+	if (num_regioes == 0) {
+		print "ocupacao_memoria: mapa sem \"Memory Configuration\"" > "/dev/stderr"
+		exit 2
+	}
+	estouros = 0
+	while ((getline linha < orcamento) > 0) {
+		sub(/\r$/, "", linha)
+		sub(/#.*/, "", linha)
+		if (split(linha, c, /[ \t]+/) < 4) {
+			if (linha ~ /[^ \t]/) {
+				print "ocupacao_memoria: linha invalida no orcamento: " linha > "/dev/stderr"
+				exit 2
+			}
+			continue
+		}
+		if (c[1] == "") {		# linha indentada
+			for (i = 1; i < 5; i++) {
+				c[i] = c[i + 1]
+			}
+		}
+		total = 0
+		limite = c[4]
+		if (c[2] == "total") {
+			total = ocupado[c[3]]
+			if (limite == "-") {
+				for (r = 1; r <= num_regioes; r++) {
+					if (nome_regiao[r] == c[3]) {
+						limite = tamanho[r]
+					}
+				}
+			}
+		} else {
+			for (i = 1; i <= n; i++) {
+				if (classe_item[i] == c[2] && nome_item[i] ~ c[3]) {
+					total += bytes_item[i]
+					parte[++num_partes] = "parte;" c[1] ";" nome_item[i] ";" bytes_item[i]
+				}
+			}
+		}
+		if (limite == "-" || limite !~ /^[0-9]+$/) {
+			print "ocupacao_memoria: limite invalido para " c[1] > "/dev/stderr"
+			exit 2
+		}
+		situacao = (total <= limite + 0) ? "ok" : "estourado"
+		if (situacao != "ok") {
+			estouros++
+		}
+		printf "memoria;%s;%d;%d;%s\n", c[1], total, limite, situacao
+	}
+	for (i = 1; i <= num_partes; i++) {
+		print parte[i]
+	}
+	exit (estouros > 0)
+}
+'
@@ -0,0 +1,366 @@
+/**
+ * \file
+ *
+ * \brief Perfil estatistico do nucleo (cfg_PERFIL), para o computador.
+ *
+ * Le as amostras enviadas por PerfilDescarrega() (ex.: gravadas da UART em
+ * um arquivo) e as agrupa pelas funcoes da imagem, lidas com nm: mostra a
+ * fracao do tempo em cada funcao, no total e em cada tarefa.
+ *
+ * Compilacao e execucao (nesta pasta), com o nm da imagem:
+ *
+ *   gcc -O2 -o perfil perfil.c
+ *   NM=arm-none-eabi-nm ./perfil imagem.elf perfil.bin
+ *
+ * O anel tambem pode ser lido direto da RAM pelo depurador (SWD), sem
+ * cabecalho. Ex. no gdb:
+ *
+ *   dump binary value perfil.bin perfil_amostras
+ *
+ * e entao, informando as amostras por segundo (cfg_MARCA_TEMPO_HZ /
+ * cfg_PERFIL_INTERVALO) e perfil_total:
+ *
+ *   ./perfil -b 1000 <perfil_total> imagem.elf perfil.bin
+ *
+ * Na porta posix, a imagem e o proprio executavel, compilado sem PIE
+ * (gcc -no-pie), para os enderecos caberem nos 32 bits das amostras.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* mesmo formato de amostra_perfil_t (rtos.h) */
+typedef struct
+{
+	uint32_t	pc;
+	uint8_t		tarefa;
+	uint8_t		reservado;
+	uint16_t	marca;
+} amostra_perfil_t;
+
+typedef struct
+{
+	uint32_t	endereco;
+	uint32_t	tamanho;		/* 0 = desconhecido: vai ate o proximo simbolo */
+	const char	*nome;
+	uint32_t	amostras;
+	uint32_t	*por_tarefa;	/* MAX_TAREFAS contadores, alocados na primeira amostra */
+} simbolo_t;
+
+#define MAX_TAREFAS		256
+#define TAM_NOME		32
+#define MAIS_FREQUENTES	5		/* funcoes mostradas por tarefa */
+
+static char nomes[MAX_TAREFAS][TAM_NOME];
+static uint32_t amostras_tarefa[MAX_TAREFAS];
+
+static simbolo_t *simbolos;
+static unsigned numero_simbolos;
+
+/* amostras fora das funcoes conhecidas e fora das tarefas (pilha principal) */
+static simbolo_t desconhecido = {0, 0, "(sem simbolo)", 0, 0};
+static simbolo_t fora_das_tarefas = {0, 0, "(antes das tarefas)", 0, 0};
+
+static const char *NomeTarefa(uint8_t tarefa)
+{
+	static char numero[8];
+
+	if(nomes[tarefa][0] != 0)
+	{
+		return nomes[tarefa];
+	}
+	snprintf(numero, sizeof(numero), "#%u", tarefa);
+	return numero;
+}
+
+static int LeBytes(FILE *arquivo, void *destino, size_t tamanho)
+{
+	return fread(destino, 1, tamanho, arquivo) == tamanho;
+}
+
+/* le as funcoes da imagem com "nm -n -S --defined-only" (NM do ambiente,
+   ex.: arm-none-eabi-nm), em ordem de endereco. O bit 0 dos enderecos
+   Thumb e descartado */
+static int LeSimbolos(const char *imagem)
+{
+	const char *nm = getenv("NM");
+	char comando[512], linha[512], nome[256];
+	unsigned long endereco, tamanho;
+	unsigned capacidade = 0;
+	char tipo;
+	FILE *saida;
+
+	snprintf(comando, sizeof(comando), "%s -n -S --defined-only '%s'", (nm != 0) ? nm : "nm", imagem);
+	saida = popen(comando, "r");
+	if(saida == 0)
+	{
+		return 0;
+	}
+
+	while(fgets(linha, sizeof(linha), saida) != 0)
+	{
+		if(sscanf(linha, "%lx %lx %c %255s", &endereco, &tamanho, &tipo, nome) != 4)
+		{
+			tamanho = 0;
+			if(sscanf(linha, "%lx %c %255s", &endereco, &tipo, nome) != 3)
+			{
+				continue;
+			}
+		}
+		if(tipo != 'T' && tipo != 't' && tipo != 'W' && tipo != 'w')
+		{
+			continue;		/* so codigo */
+		}
+		if(numero_simbolos == capacidade)
+		{
+			capacidade = (capacidade == 0) ? 1024 : capacidade * 2;
+			simbolos = realloc(simbolos, capacidade * sizeof(simbolo_t));
+			if(simbolos == 0)
+			{
+				pclose(saida);
+				return 0;
+			}
+		}
+		simbolos[numero_simbolos].endereco = (uint32_t)endereco & ~1UL;
+		simbolos[numero_simbolos].tamanho = (uint32_t)tamanho;
+		simbolos[numero_simbolos].nome = strdup(nome);
+		simbolos[numero_simbolos].amostras = 0;
+		simbolos[numero_simbolos].por_tarefa = 0;
+		numero_simbolos++;
+	}
+
+	return pclose(saida) == 0 && numero_simbolos > 0;
+}
+
+/* funcao que contem pc: a de maior endereco ate pc, se pc esta dentro
+   do seu tamanho (quando conhecido) */
+static simbolo_t *BuscaSimbolo(uint32_t pc)
+{
+	unsigned inicio = 0, fim = numero_simbolos;
+	simbolo_t *simbolo;
+
+	if(pc == 0)
+	{
+		return &fora_das_tarefas;
+	}
+	while(fim - inicio > 1)
+	{
+		unsigned meio = (inicio + fim) / 2;
+
+		if(simbolos[meio].endereco <= pc)
+		{
+			inicio = meio;
+		}
+		else
+		{
+			fim = meio;
+		}
+	}
+	simbolo = &simbolos[inicio];
+	if(simbolo->endereco > pc || (simbolo->tamanho != 0 && pc >= simbolo->endereco + simbolo->tamanho))
+	{
+		return &desconhecido;
+	}
+	return simbolo;
+}
+
+static void Conta(simbolo_t *simbolo, uint8_t tarefa)
+{
+	if(simbolo->por_tarefa == 0)
+	{
+		simbolo->por_tarefa = calloc(MAX_TAREFAS, sizeof(uint32_t));
+		if(simbolo->por_tarefa == 0)
+		{
+			exit(1);
+		}
+	}
+	simbolo->amostras++;
+	simbolo->por_tarefa[tarefa]++;
+	amostras_tarefa[tarefa]++;
+}
+
+static int ComparaAmostras(const void *a, const void *b)
+{
+	const simbolo_t *sa = *(const simbolo_t * const *)a;
+	const simbolo_t *sb = *(const simbolo_t * const *)b;
+
+	return (sa->amostras < sb->amostras) - (sa->amostras > sb->amostras);
+}
+
+/* le o cabecalho de PerfilDescarrega: frequencia, nomes das tarefas e
+   numero de amostras */
+static int LeCabecalho(FILE *arquivo, uint32_t *frequencia, uint32_t *quantidade)
+{
+	char assinatura[4];
+	uint8_t tarefas;
+	int i, c, n;
+
+	if(!LeBytes(arquivo, assinatura, 4) || memcmp(assinatura, "PRF1", 4) != 0)
+	{
+		fprintf(stderr, "arquivo nao comeca com PRF1 (use -b para o anel lido da RAM)\n");
+		return 0;
+	}
+	if(!LeBytes(arquivo, frequencia, sizeof(*frequencia)) || !LeBytes(arquivo, &tarefas, 1))
+	{
+		return 0;
+	}
+
+	for(i = 1; i <= tarefas && i < MAX_TAREFAS; i++)
+	{
+		n = 0;
+		while((c = fgetc(arquivo)) != EOF && c != 0)
+		{
+			if(n < TAM_NOME - 1)
+			{
+				nomes[i][n++] = (char)c;
+			}
+		}
+		nomes[i][n] = 0;
+		if(c == EOF)
+		{
+			return 0;
+		}
+	}
+
+	return LeBytes(arquivo, quantidade, sizeof(*quantidade));
+}
+
+int main(int argc, char **argv)
+{
+	FILE *arquivo;
+	amostra_perfil_t *amostras;
+	simbolo_t **ordem;
+	uint32_t frequencia = 0, quantidade = 0, total, primeiro = 0;
+	int bruto = (argc == 6 && strcmp(argv[1], "-b") == 0);
+	unsigned i, j, n, mostradas;
+
+	if(argc != 3 && !bruto)
+	{
+		fprintf(stderr, "uso: %s imagem.elf perfil.bin\n"
+						"     %s -b <amostras_por_s> <perfil_total> imagem.elf perfil.bin\n", argv[0], argv[0]);
+		return 1;
+	}
+
+	if(!LeSimbolos(argv[argc - 2]))
+	{
+		fprintf(stderr, "sem funcoes em %s (NM=%s)\n", argv[argc - 2], getenv("NM") ? getenv("NM") : "nm");
+		return 1;
+	}
+
+	arquivo = fopen(argv[argc - 1], "rb");
+	if(arquivo == 0)
+	{
+		perror(argv[argc - 1]);
+		return 1;
+	}
+
+	if(bruto)
+	{
+		/* anel lido da RAM: completo, o mais antigo esta em perfil_total % tamanho */
+		long tamanho;
+
+		frequencia = (uint32_t)strtoul(argv[2], 0, 0);
+		total = (uint32_t)strtoul(argv[3], 0, 0);
+		fseek(arquivo, 0, SEEK_END);
+		tamanho = ftell(arquivo);
+		fseek(arquivo, 0, SEEK_SET);
+		quantidade = (uint32_t)(tamanho / (long)sizeof(amostra_perfil_t));
+		if(quantidade == 0 || (quantidade & (quantidade - 1)) != 0)
+		{
+			fprintf(stderr, "o anel deve ter cfg_PERFIL (potencia de 2) amostras\n");
+			return 1;
+		}
+		primeiro = total & (quantidade - 1);
+		if(total < quantidade)
+		{
+			quantidade = total;		/* anel ainda incompleto */
+			primeiro = 0;
+		}
+	}
+	else if(!LeCabecalho(arquivo, &frequencia, &quantidade))
+	{
+		fprintf(stderr, "cabecalho do perfil incompleto\n");
+		return 1;
+	}
+
+	amostras = malloc((size_t)quantidade * sizeof(amostra_perfil_t) + 1);
+	if(amostras == 0 || !LeBytes(arquivo, amostras, (size_t)quantidade * sizeof(amostra_perfil_t)))
+	{
+		fprintf(stderr, "perfil incompleto\n");
+		return 1;
+	}
+	fclose(arquivo);
+
+	if(quantidade == 0)
+	{
+		printf("nenhuma amostra\n");
+		return 0;
+	}
+
+	for(i = 0; i < quantidade; i++)
+	{
+		const amostra_perfil_t *a = (bruto && primeiro != 0) ?
+				&amostras[(primeiro + i) & (quantidade - 1)] : &amostras[i];
+
+		Conta(BuscaSimbolo(a->pc), a->tarefa);
+	}
+
+	/* funcoes com amostras, da mais frequente a menos frequente */
+	ordem = malloc((numero_simbolos + 2) * sizeof(simbolo_t *));
+	if(ordem == 0)
+	{
+		return 1;
+	}
+	for(i = 0, n = 0; i < numero_simbolos; i++)
+	{
+		if(simbolos[i].amostras != 0)
+		{
+			ordem[n++] = &simbolos[i];
+		}
+	}
+	if(desconhecido.amostras != 0)
+	{
+		ordem[n++] = &desconhecido;
+	}
+	if(fora_das_tarefas.amostras != 0)
+	{
+		ordem[n++] = &fora_das_tarefas;
+	}
+	qsort(ordem, n, sizeof(simbolo_t *), ComparaAmostras);
+
+	printf("%u amostras", quantidade);
+	if(frequencia != 0)
+	{
+		printf(" (%.1f s a %u amostras/s)", (double)quantidade / frequencia, frequencia);
+	}
+	printf("\n\n%7s %9s  %s\n", "%", "amostras", "funcao");
+	for(i = 0; i < n; i++)
+	{
+		printf("%6.2f%% %9u  %s\n", 100.0 * ordem[i]->amostras / quantidade, ordem[i]->amostras, ordem[i]->nome);
+	}
+
+	for(j = 0; j < MAX_TAREFAS; j++)
+	{
+		if(amostras_tarefa[j] == 0)
+		{
+			continue;
+		}
+		printf("\ntarefa %s: %6.2f%%\n", NomeTarefa((uint8_t)j), 100.0 * amostras_tarefa[j] / quantidade);
+		for(i = 0, mostradas = 0; i < n && mostradas < MAIS_FREQUENTES; i++)
+		{
+			uint32_t na_tarefa = ordem[i]->por_tarefa[j];
+
+			if(na_tarefa != 0)
+			{
+				printf("  %6.2f%% %9u  %s\n", 100.0 * na_tarefa / amostras_tarefa[j], na_tarefa, ordem[i]->nome);
+				mostradas++;
+			}
+		}
+	}
+
+	free(ordem);
+	free(amostras);
+	return 0;
+}
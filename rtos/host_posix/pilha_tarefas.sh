@@ -0,0 +1,251 @@
+#!/bin/sh
+#
+# Pior caso de uso da pilha de cada tarefa, calculado do grafo de chamadas
+# do GCC (-fcallgraph-info=su, GCC 10 ou mais novo, que junta o uso de
+# pilha de -fstack-usage as chamadas de cada funcao), e comparado com o
+# tamanho declarado da pilha da tarefa. Retorna 1 se alguma pilha for
+# menor que o pior caso, para falhar a compilacao. Uso:
+#
+#   NM=arm-none-eabi-nm ./pilha_tarefas.sh pasta_objetos imagem.elf pilhas_tarefas.txt
+#
+# Os arquivos .ci sao procurados em pasta_objetos (um por objeto, ao lado
+# do .o). Da imagem, lida com nm -S, vem o tamanho de cada pilha e as
+# tarefas presentes: a funcao de uma tarefa que nao e criada nesta
+# configuracao sai da imagem (-Wl,--gc-sections) e a tarefa e ignorada.
+#
+# Linhas do arquivo de pilhas (# inicia um comentario):
+#
+#   contexto  68                          bytes do contexto guardado na pilha da tarefa
+#   tarefa    tarefa_1  PILHA_TAREFA_1    funcao de entrada e vetor da pilha
+#   funcao    memcpy    16                pilha de funcao sem .ci (biblioteca, assembly)
+#   chama     Executa   trata_evento      alvo de uma chamada por ponteiro em Executa
+#
+# As funcoes static aparecem no grafo como "arquivo.c:nome". O pior caso de
+# uma tarefa e a soma dos quadros da cadeia de chamadas mais funda a partir
+# da funcao de entrada, mais o contexto (no Cortex-M0: os 16 registradores
+# de CriaContexto e do PendSV, mais 4 bytes do alinhamento do quadro de
+# excecao). As interrupcoes usam a pilha principal (MSP) e nao entram.
+#
+# O resultado e incompleto (e pode ser menor que o real) se a cadeia tem
+# recursao, pilha dinamica (alloca, vetores de tamanho variavel), chamada
+# por ponteiro sem linha "chama" ou funcao sem uso de pilha conhecido.
+#
+# Saida, com os campos separados por ';' como nos testes de t2, t3 e t4:
+#
+#   pilha;<tarefa>;<pior caso>;<declarada>;ok|estourada|incompleta
+#   caminho;<tarefa>;<funcao>><funcao>>...
+#   aviso;<tarefa>;<funcao>;recursao|dinamica|indireta|sem dados
+
+if [ $# -ne 3 ]; then
+	echo "uso: $0 pasta_objetos imagem.elf pilhas_tarefas.txt" >&2
+	exit 2
+fi
+
+NM=${NM:-arm-none-eabi-nm}
+OBJETOS=$(echo "$1" | tr '\\' '/')
+IMAGEM=$(echo "$2" | tr '\\' '/')
+PILHAS=$3
+
+for arquivo in "$IMAGEM" "$PILHAS"; do
+	if [ ! -r "$arquivo" ]; then
+		echo "$0: nao foi possivel ler $arquivo" >&2
+		exit 2
+	fi
+done
+
+SIMBOLOS=$("$NM" -S "$IMAGEM") || {
+	echo "$0: falha ao executar $NM (defina NM com o nm do compilador)" >&2
+	exit 2
+}
+
+find "$OBJETOS" -name '*.ci' -exec cat {} + | tr -d '\r' | awk -v pilhas="$PILHAS" -v simbolos="$SIMBOLOS" '
+function hex(s,    i, c, v) {
+	v = 0
+	s = tolower(s)
+	for (i = 1; i <= length(s); i++) {
+		c = index("0123456789abcdef", substr(s, i, 1))
+		if (c == 0) {
+			break
+		}
+		v = v * 16 + c - 1
+	}
+	return v
+}
+
+# valor de um campo "chave: "valor"" de uma linha do grafo
+function campo(linha, chave,    p, resto) {
+	p = index(linha, chave ": \"")
+	if (p == 0) {
+		return ""
+	}
+	resto = substr(linha, p + length(chave) + 3)
+	return substr(resto, 1, index(resto, "\"") - 1)
+}
+
+function problema(f, tipo) {
+	if (!((f, tipo) in marcado)) {
+		marcado[f, tipo] = 1
+		problemas[f] = problemas[f] " " tipo
+	}
+}
+
+# pior caso a partir de f: o quadro de f mais o do alvo mais fundo
+function pior(f,    i, n, alvo, v, maior) {
+	if (f in memo) {
+		return memo[f]
+	}
+	visitando[f] = 1
+	if (!(f in quadro)) {
+		problema(f, "sem_dados")
+	}
+	maior = 0
+	via[f] = ""
+	n = num_alvos[f] + num_indiretas[f]
+	for (i = 1; i <= n; i++) {
+		alvo = (i <= num_alvos[f]) ? alvos[f, i] : indiretas[f, i - num_alvos[f]]
+		if (alvo == "__indirect_call") {
+			if (!(f in indiretas)) {
+				problema(f, "indireta")
+			}
+			continue
+		}
+		if (alvo in visitando) {
+			problema(alvo, "recursao")
+			continue
+		}
+		v = pior(alvo)
+		if (v > maior || via[f] == "") {
+			maior = v
+			via[f] = alvo
+		}
+	}
+	delete visitando[f]
+	memo[f] = quadro[f] + maior
+	return memo[f]
+}
+
+# conta (e com imprime = 1, mostra) os avisos das funcoes alcancadas a
+# partir de f
+function avisos(tarefa, f, imprime,    i, k, n, tipos) {
+	if ((tarefa, f, imprime) in avisado) {
+		return 0
+	}
+	avisado[tarefa, f, imprime] = 1
+	n = 0
+	if (problemas[f] != "") {
+		k = split(substr(problemas[f], 2), tipos, " ")
+		for (i = 1; i <= k; i++) {
+			if (imprime) {
+				sub(/_/, " ", tipos[i])
+				printf "aviso;%s;%s;%s\n", tarefa, f, tipos[i]
+			}
+			n++
+		}
+	}
+	for (i = 1; i <= num_alvos[f]; i++) {
+		if (alvos[f, i] != "__indirect_call") {
+			n += avisos(tarefa, alvos[f, i], imprime)
+		}
+	}
+	for (i = 1; i <= num_indiretas[f]; i++) {
+		n += avisos(tarefa, indiretas[f, i], imprime)
+	}
+	return n
+}
+
+# no: { title: "tarefa_1" label: "tarefa_1\nmain.c:400:6\n24 bytes (static)" }
+/^node:/ {
+	nome = campo($0, "title")
+	rotulo = campo($0, "label")
+	if (match(rotulo, /\\n[0-9]+ bytes \(/)) {
+		quadro[nome] = substr(rotulo, RSTART + 2, RLENGTH - 2) + 0
+		if (rotulo ~ /bytes \(dynamic/) {
+			problema(nome, "dinamica")
+		}
+	}
+	next
+}
+
+# aresta: { sourcename: "tarefa_1" targetname: "TarefaEspera" label: "main.c:410:3" }
+/^edge:/ {
+	origem = campo($0, "sourcename")
+	alvo = campo($0, "targetname")
+	if (!((origem, alvo) in aresta)) {
+		aresta[origem, alvo] = 1
+		alvos[origem, ++num_alvos[origem]] = alvo
+	}
+	next
+}
+
+END {
+	contexto = 0
+	while ((getline linha < pilhas) > 0) {
+		sub(/\r$/, "", linha)
+		sub(/#.*/, "", linha)
+		n = split(linha, c, /[ \t]+/)
+		if (n > 0 && c[1] == "") {		# linha indentada
+			for (i = 1; i < n; i++) {
+				c[i] = c[i + 1]
+			}
+			n--
+		}
+		if (n == 0 || (n == 1 && c[1] == "")) {
+			continue
+		}
+		if (c[1] == "contexto" && n == 2) {
+			contexto = c[2] + 0
+		} else if (c[1] == "tarefa" && n == 3) {
+			tarefa[++num_tarefas] = c[2]
+			vetor[num_tarefas] = c[3]
+		} else if (c[1] == "funcao" && n == 3) {
+			quadro[c[2]] = c[3] + 0
+		} else if (c[1] == "chama" && n == 3) {
+			indiretas[c[2]] = 1
+			indiretas[c[2], ++num_indiretas[c[2]]] = c[3]
+		} else {
+			print "pilha_tarefas: linha invalida: " linha > "/dev/stderr"
+			exit 2
+		}
+	}
+
+	# nm -S: "20000100 00000060 B PILHA_TAREFA_1"
+	n = split(simbolos, linhas, "\n")
+	for (i = 1; i <= n; i++) {
+		k = split(linhas[i], s, " ")
+		if (k == 4) {
+			tamanho[s[4]] = hex(s[2])
+		} else if (k == 3) {
+			tamanho[s[3]] = 0
+		}
+	}
+
+	estouros = 0
+	for (t = 1; t <= num_tarefas; t++) {
+		f = tarefa[t]
+		if (!(f in tamanho)) {
+			continue		# tarefa fora desta configuracao
+		}
+		if (!(vetor[t] in tamanho)) {
+			print "pilha_tarefas: pilha " vetor[t] " nao esta na imagem" > "/dev/stderr"
+			exit 2
+		}
+		total = pior(f) + contexto
+		if (total > tamanho[vetor[t]]) {
+			situacao = "estourada"
+			estouros++
+		} else if (avisos(f, f, 0) > 0) {
+			situacao = "incompleta"
+		} else {
+			situacao = "ok"
+		}
+		printf "pilha;%s;%d;%d;%s\n", f, total, tamanho[vetor[t]], situacao
+		caminho = f
+		for (g = f; via[g] != ""; g = via[g]) {
+			caminho = caminho ">" via[g]
+		}
+		printf "caminho;%s;%s\n", f, caminho
+		avisos(f, f, 1)
+	}
+	exit (estouros > 0)
+}
+'
@@ -0,0 +1,556 @@
+/**
+ * \file
+ *
+ * \brief Analise do pior tempo de resposta das tarefas periodicas, para o
+ * computador.
+ *
+ * Le a tabela estatica de tarefas do projeto (prioridades, limiares de
+ * preempcao, periodos e piores tempos de execucao medidos na placa, ex.:
+ * com medicoes/mede_nucleo.c e os pinos de rastro) e calcula o pior tempo
+ * de resposta de cada tarefa com prioridade fixa, incluindo o bloqueio
+ * pelas regioes REG_ATOMICA, pelos semaforos e mutexes e pelas tarefas de
+ * menor prioridade que nao podem ser preemptadas. Retorna 1 se alguma
+ * tarefa pode perder o prazo, para conferir a configuracao antes de
+ * gravar a placa.
+ *
+ * Compilacao e execucao (nesta pasta):
+ *
+ *   gcc -O2 -o tempo_resposta tempo_resposta.c
+ *   ./tempo_resposta tarefas.txt
+ *
+ * Linhas da tabela (# inicia um comentario), com todos os tempos na mesma
+ * unidade inteira (ex.: microssegundos ou ciclos):
+ *
+ *   troca       12                              custo de uma troca de contexto
+ *   interrupcao SysTick  1000  6                periodo minimo e pior tempo
+ *   tarefa      leitura  3  c  10000  1500      prioridade, limiar, periodo, pior tempo [prazo]
+ *   regiao      leitura  40                     REG_ATOMICA mais longa da tarefa ("nucleo": do nucleo)
+ *   semaforo    spi  leitura  200               secao protegida por semaforo (sem heranca)
+ *   mutex       i2c  leitura  300               secao protegida por mutex (heranca de prioridade)
+ *
+ * O limiar de preempcao e o de TarefaLimiarPreempcao: "p" (a prioridade da
+ * tarefa, modo preemptivo), "c" (PRIORIDADE_MAXIMA, modo cooperativo, o
+ * padrao do nucleo) ou um numero. O prazo padrao e o periodo.
+ *
+ * Modelo (conservador):
+ *  - as tarefas sao liberadas pela marca de tempo (TarefaEspera ou tarefas
+ *    periodicas), que respeita o limiar de preempcao. Cada execucao custa
+ *    o pior tempo mais duas trocas de contexto;
+ *  - as interrupcoes interferem em todas as tarefas, antes e depois de
+ *    comecar;
+ *  - tarefas de mesma prioridade revezam por fatia de tempo e contam como
+ *    de maior prioridade;
+ *  - bloqueio de uma tarefa = a maior execucao de uma tarefa de menor
+ *    prioridade com limiar >= a prioridade dela, mais a maior REG_ATOMICA
+ *    das tarefas de menor prioridade e do nucleo, mais, para cada semaforo
+ *    ou mutex usado por ela ou por uma tarefa de maior prioridade, a maior
+ *    secao de uma tarefa de menor prioridade;
+ *  - um semaforo usado por uma tarefa e por outra de menor prioridade que
+ *    pode ser preemptada por uma terceira de prioridade intermediaria tem
+ *    inversao de prioridade sem limite: a analise nao vale (troque por um
+ *    mutex ou aumente o limiar da tarefa de menor prioridade).
+ *
+ * A analise e a de prioridade fixa com limiares de preempcao (Wang e
+ * Saksena, com a correcao de Regehr), para todas as execucoes do periodo
+ * ocupado do nivel da tarefa. Saida, com os campos separados por ';':
+ *
+ *   utilizacao;<porcentagem>
+ *   resposta;<tarefa>;<pior tempo de resposta>;<prazo>;<bloqueio>;ok|perdido
+ *   aviso;<tarefa>;inversao;<semaforo>;<tarefa intermediaria>
+ *   margem;<porcentagem>     maior escala dos piores tempos de execucao que
+ *                            ainda cumpre todos os prazos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define MAX_TAREFAS		64
+#define MAX_SECOES		256
+#define TAM_NOME		32
+
+/* limiar "c": maior que qualquer prioridade da tabela */
+#define COOPERATIVO		255
+
+/* limite do periodo ocupado, em unidades de tempo: acima dele a tarefa e
+   considerada sem resposta (utilizacao perto de 100%) */
+#define LIMITE_TEMPO	((uint64_t)1 << 48)
+
+typedef struct
+{
+	char		nome[TAM_NOME];
+	unsigned	prioridade;
+	unsigned	limiar;
+	uint64_t	periodo;
+	uint64_t	execucao;			/* pior tempo, sem as trocas */
+	uint64_t	prazo;
+	uint64_t	regiao;				/* REG_ATOMICA mais longa */
+	uint64_t	resposta;
+	uint64_t	bloqueio;
+	int			interrupcao;
+} tarefa_rt_t;
+
+typedef struct
+{
+	char		recurso[TAM_NOME];
+	int			tarefa;
+	uint64_t	duracao;
+	int			mutex;
+} secao_t;
+
+static tarefa_rt_t tarefas[MAX_TAREFAS];
+static int num_tarefas;
+static secao_t secoes[MAX_SECOES];
+static int num_secoes;
+static uint64_t troca;
+static uint64_t regiao_nucleo;
+
+static int ProcuraTarefa(const char *nome)
+{
+	int i;
+
+	for(i = 0; i < num_tarefas; i++)
+	{
+		if(!tarefas[i].interrupcao && strcmp(tarefas[i].nome, nome) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+static uint64_t Teto(uint64_t a, uint64_t b)
+{
+	return (a + b - 1) / b;
+}
+
+/* custo de uma execucao de j com os piores tempos multiplicados por
+   escala / 100 */
+static uint64_t Custo(int j, unsigned escala)
+{
+	uint64_t c = Teto(tarefas[j].execucao * escala, 100);
+
+	return tarefas[j].interrupcao ? c : c + 2 * troca;
+}
+
+/* j interfere em i antes de i comecar: interrupcoes e tarefas de
+   prioridade maior ou igual */
+static int InterfereAntes(int j, int i)
+{
+	return j != i && (tarefas[j].interrupcao || tarefas[j].prioridade >= tarefas[i].prioridade);
+}
+
+/* j interfere em i depois de i comecar: so acima do limiar de i */
+static int InterfereDepois(int j, int i)
+{
+	return j != i && (tarefas[j].interrupcao || tarefas[j].prioridade > tarefas[i].limiar);
+}
+
+static uint64_t Bloqueio(int i, unsigned escala)
+{
+	uint64_t execucao = 0, regiao = regiao_nucleo, recursos = 0, maior;
+	int j, k, s;
+
+	for(j = 0; j < num_tarefas; j++)
+	{
+		if(tarefas[j].interrupcao || tarefas[j].prioridade >= tarefas[i].prioridade)
+		{
+			continue;
+		}
+		if(tarefas[j].limiar >= tarefas[i].prioridade && Custo(j, escala) > execucao)
+		{
+			execucao = Custo(j, escala);
+		}
+		if(tarefas[j].regiao > regiao)
+		{
+			regiao = tarefas[j].regiao;
+		}
+	}
+
+	/* recursos usados por i ou por tarefas de maior prioridade (teto do
+	   recurso >= prioridade de i), cada um bloqueia uma vez */
+	for(s = 0; s < num_secoes; s++)
+	{
+		int teto_alto = 0, repetido = 0;
+
+		for(k = 0; k < s; k++)
+		{
+			repetido |= (strcmp(secoes[k].recurso, secoes[s].recurso) == 0);
+		}
+		if(repetido)
+		{
+			continue;
+		}
+		maior = 0;
+		for(k = s; k < num_secoes; k++)
+		{
+			if(strcmp(secoes[k].recurso, secoes[s].recurso) != 0)
+			{
+				continue;
+			}
+			j = secoes[k].tarefa;
+			if(tarefas[j].prioridade >= tarefas[i].prioridade)
+			{
+				teto_alto = 1;
+			}
+			else if(secoes[k].duracao > maior)
+			{
+				maior = secoes[k].duracao;
+			}
+		}
+		if(teto_alto)
+		{
+			recursos += Teto(maior * escala, 100);
+		}
+	}
+
+	return execucao + regiao + recursos;
+}
+
+/* pior tempo de resposta de i, ou 0 se passa de LIMITE_TEMPO */
+static uint64_t Resposta(int i, unsigned escala, uint64_t *bloqueio)
+{
+	uint64_t b = Bloqueio(i, escala), c = Custo(i, escala);
+	uint64_t ocupado, anterior, inicio, fim, soma, pior = 0;
+	uint64_t q, execucoes;
+	double utilizacao = (double)c / (double)tarefas[i].periodo;
+	int j;
+
+	*bloqueio = b;
+
+	/* acima de 100% o periodo ocupado nao termina */
+	for(j = 0; j < num_tarefas; j++)
+	{
+		if(InterfereAntes(j, i))
+		{
+			utilizacao += (double)Custo(j, escala) / (double)tarefas[j].periodo;
+		}
+	}
+	if(utilizacao > 1.0 || (utilizacao == 1.0 && b > 0))
+	{
+		return 0;
+	}
+
+	/* periodo ocupado do nivel de i */
+	ocupado = b + c;
+	do
+	{
+		anterior = ocupado;
+		soma = b + Teto(anterior, tarefas[i].periodo) * c;
+		for(j = 0; j < num_tarefas; j++)
+		{
+			if(InterfereAntes(j, i))
+			{
+				soma += Teto(anterior, tarefas[j].periodo) * Custo(j, escala);
+			}
+		}
+		ocupado = soma;
+		if(ocupado > LIMITE_TEMPO)
+		{
+			return 0;
+		}
+	} while(ocupado != anterior);
+
+	execucoes = Teto(ocupado, tarefas[i].periodo);
+	for(q = 0; q < execucoes; q++)
+	{
+		/* inicio da execucao q: tudo o que chega ate ela comecar */
+		inicio = b + q * c;
+		do
+		{
+			anterior = inicio;
+			soma = b + q * c;
+			for(j = 0; j < num_tarefas; j++)
+			{
+				if(InterfereAntes(j, i))
+				{
+					soma += (1 + anterior / tarefas[j].periodo) * Custo(j, escala);
+				}
+			}
+			inicio = soma;
+			if(inicio > LIMITE_TEMPO)
+			{
+				return 0;
+			}
+		} while(inicio != anterior);
+
+		/* fim: so as tarefas acima do limiar a interrompem */
+		fim = inicio + c;
+		do
+		{
+			anterior = fim;
+			soma = inicio + c;
+			for(j = 0; j < num_tarefas; j++)
+			{
+				if(InterfereDepois(j, i))
+				{
+					uint64_t chegadas = Teto(anterior, tarefas[j].periodo);
+					uint64_t antes = 1 + inicio / tarefas[j].periodo;
+
+					if(chegadas > antes)
+					{
+						soma += (chegadas - antes) * Custo(j, escala);
+					}
+				}
+			}
+			fim = soma;
+			if(fim > LIMITE_TEMPO)
+			{
+				return 0;
+			}
+		} while(fim != anterior);
+
+		if(fim - q * tarefas[i].periodo > pior)
+		{
+			pior = fim - q * tarefas[i].periodo;
+		}
+	}
+	return pior;
+}
+
+/* 1 se todas as tarefas cumprem o prazo com os tempos em escala / 100 */
+static int Escalonavel(unsigned escala)
+{
+	uint64_t bloqueio, r;
+	int i;
+
+	for(i = 0; i < num_tarefas; i++)
+	{
+		if(tarefas[i].interrupcao)
+		{
+			continue;
+		}
+		r = Resposta(i, escala, &bloqueio);
+		if(r == 0 || r > tarefas[i].prazo)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* semaforo sem heranca usado por i e por uma tarefa j de menor prioridade
+   que uma tarefa m, entre as duas, pode preemptar: inversao sem limite */
+static int Inversoes(void)
+{
+	int s, k, i, j, m, avisos = 0;
+
+	for(s = 0; s < num_secoes; s++)
+	{
+		if(secoes[s].mutex)
+		{
+			continue;
+		}
+		i = secoes[s].tarefa;
+		for(k = 0; k < num_secoes; k++)
+		{
+			if(secoes[k].mutex || strcmp(secoes[k].recurso, secoes[s].recurso) != 0)
+			{
+				continue;
+			}
+			j = secoes[k].tarefa;
+			if(tarefas[j].prioridade >= tarefas[i].prioridade)
+			{
+				continue;
+			}
+			for(m = 0; m < num_tarefas; m++)
+			{
+				if(!tarefas[m].interrupcao && tarefas[m].prioridade < tarefas[i].prioridade &&
+				   tarefas[m].prioridade > tarefas[j].limiar)
+				{
+					printf("aviso;%s;inversao;%s;%s\n", tarefas[i].nome, secoes[s].recurso, tarefas[m].nome);
+					avisos++;
+				}
+			}
+		}
+	}
+	return avisos;
+}
+
+static int LeTabela(FILE *arquivo)
+{
+	char linha[256], *campo[8], *p;
+	unsigned long long valor;
+	int n, numero = 0;
+
+	while(fgets(linha, sizeof(linha), arquivo) != 0)
+	{
+		numero++;
+		if((p = strchr(linha, '#')) != 0)
+		{
+			*p = 0;
+		}
+		n = 0;
+		for(p = strtok(linha, " \t\r\n"); p != 0 && n < 8; p = strtok(0, " \t\r\n"))
+		{
+			campo[n++] = p;
+		}
+		if(n == 0)
+		{
+			continue;
+		}
+
+		if(strcmp(campo[0], "troca") == 0 && n == 2)
+		{
+			troca = strtoull(campo[1], 0, 0);
+		}
+		else if((strcmp(campo[0], "tarefa") == 0 && (n == 6 || n == 7)) ||
+				(strcmp(campo[0], "interrupcao") == 0 && n == 4))
+		{
+			tarefa_rt_t *t = &tarefas[num_tarefas];
+
+			if(num_tarefas == MAX_TAREFAS)
+			{
+				fprintf(stderr, "linha %d: mais de %d tarefas\n", numero, MAX_TAREFAS);
+				return 0;
+			}
+			memset(t, 0, sizeof(*t));
+			snprintf(t->nome, sizeof(t->nome), "%s", campo[1]);
+			if(campo[0][0] == 'i')
+			{
+				t->interrupcao = 1;
+				t->periodo = strtoull(campo[2], 0, 0);
+				t->execucao = strtoull(campo[3], 0, 0);
+			}
+			else
+			{
+				t->prioridade = (unsigned)strtoul(campo[2], 0, 0);
+				t->limiar = (strcmp(campo[3], "c") == 0) ? COOPERATIVO :
+							(strcmp(campo[3], "p") == 0) ? t->prioridade : (unsigned)strtoul(campo[3], 0, 0);
+				t->periodo = strtoull(campo[4], 0, 0);
+				t->execucao = strtoull(campo[5], 0, 0);
+				t->prazo = (n == 7) ? strtoull(campo[6], 0, 0) : t->periodo;
+				if(t->limiar < t->prioridade)
+				{
+					fprintf(stderr, "linha %d: limiar menor que a prioridade\n", numero);
+					return 0;
+				}
+			}
+			if(t->periodo == 0)
+			{
+				fprintf(stderr, "linha %d: periodo 0\n", numero);
+				return 0;
+			}
+			num_tarefas++;
+		}
+		else if(strcmp(campo[0], "regiao") == 0 && n == 3)
+		{
+			valor = strtoull(campo[2], 0, 0);
+			if(strcmp(campo[1], "nucleo") == 0)
+			{
+				regiao_nucleo = valor > regiao_nucleo ? valor : regiao_nucleo;
+			}
+			else if(ProcuraTarefa(campo[1]) < 0)
+			{
+				fprintf(stderr, "linha %d: tarefa %s nao declarada antes\n", numero, campo[1]);
+				return 0;
+			}
+			else if(valor > tarefas[ProcuraTarefa(campo[1])].regiao)
+			{
+				tarefas[ProcuraTarefa(campo[1])].regiao = valor;
+			}
+		}
+		else if((strcmp(campo[0], "semaforo") == 0 || strcmp(campo[0], "mutex") == 0) && n == 4)
+		{
+			if(num_secoes == MAX_SECOES)
+			{
+				fprintf(stderr, "linha %d: mais de %d secoes\n", numero, MAX_SECOES);
+				return 0;
+			}
+			if(ProcuraTarefa(campo[2]) < 0)
+			{
+				fprintf(stderr, "linha %d: tarefa %s nao declarada antes\n", numero, campo[2]);
+				return 0;
+			}
+			snprintf(secoes[num_secoes].recurso, TAM_NOME, "%s", campo[1]);
+			secoes[num_secoes].tarefa = ProcuraTarefa(campo[2]);
+			secoes[num_secoes].duracao = strtoull(campo[3], 0, 0);
+			secoes[num_secoes].mutex = (campo[0][0] == 'm');
+			num_secoes++;
+		}
+		else
+		{
+			fprintf(stderr, "linha %d: invalida\n", numero);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	FILE *arquivo;
+	uint64_t bloqueio;
+	double utilizacao = 0;
+	unsigned escala, menor, maior;
+	int i, perdidos = 0;
+
+	if(argc != 2)
+	{
+		fprintf(stderr, "uso: %s tarefas.txt\n", argv[0]);
+		return 2;
+	}
+	arquivo = fopen(argv[1], "r");
+	if(arquivo == 0)
+	{
+		perror(argv[1]);
+		return 2;
+	}
+	if(!LeTabela(arquivo))
+	{
+		fclose(arquivo);
+		return 2;
+	}
+	fclose(arquivo);
+
+	for(i = 0; i < num_tarefas; i++)
+	{
+		utilizacao += (double)Custo(i, 100) / (double)tarefas[i].periodo;
+	}
+	printf("utilizacao;%.1f\n", 100.0 * utilizacao);
+
+	for(i = 0; i < num_tarefas; i++)
+	{
+		if(tarefas[i].interrupcao)
+		{
+			continue;
+		}
+		tarefas[i].resposta = Resposta(i, 100, &bloqueio);
+		tarefas[i].bloqueio = bloqueio;
+		if(tarefas[i].resposta == 0 || tarefas[i].resposta > tarefas[i].prazo)
+		{
+			perdidos++;
+			if(tarefas[i].resposta == 0)
+			{
+				printf("resposta;%s;-;%llu;%llu;perdido\n", tarefas[i].nome,
+					   (unsigned long long)tarefas[i].prazo, (unsigned long long)bloqueio);
+				continue;
+			}
+		}
+		printf("resposta;%s;%llu;%llu;%llu;%s\n", tarefas[i].nome, (unsigned long long)tarefas[i].resposta,
+			   (unsigned long long)tarefas[i].prazo, (unsigned long long)bloqueio,
+			   (tarefas[i].resposta > tarefas[i].prazo) ? "perdido" : "ok");
+	}
+
+	perdidos += Inversoes();
+
+	/* busca binaria da maior escala (em %) que ainda cumpre os prazos */
+	menor = 0;
+	maior = 10000;
+	while(menor < maior)
+	{
+		escala = (menor + maior + 1) / 2;
+		if(Escalonavel(escala))
+		{
+			menor = escala;
+		}
+		else
+		{
+			maior = escala - 1;
+		}
+	}
+	printf("margem;%u\n", menor);
+
+	return perdidos > 0;
+}
@@ -0,0 +1,27 @@
+/*
+ * conf_rtos.h
+ *
+ * Configuracao do sistema multitarefas para o projeto IAR EW ARM (Cortex-M0).
+ * As macros nao definidas aqui usam os valores padrao do rtos.h.
+ */ 
+
+
+#ifndef CONF_RTOS_H_
+#define CONF_RTOS_H_
+
+/* numero de tarefas (os testes do Thread-Metric usam ate 5, mais a de 
+   relatorio e a ociosa, e 5 prioridades abaixo da do relatorio) */
+#if defined(MEDE_THREAD_METRIC) && MEDE_THREAD_METRIC
+#define NUMERO_DE_TAREFAS	7
+#define PRIORIDADE_MAXIMA	6
+#else
+#define NUMERO_DE_TAREFAS	3
+#endif
+
+/* frequencia de clock da CPU */
+#define cfg_CPU_CLOCK_HZ 	48000000UL
+
+/* modo cooperativo: a tarefa atual so perde o processador ao bloquear */
+#define cfg_PREEMPTIVO		0
+
+#endif /* CONF_RTOS_H_ */
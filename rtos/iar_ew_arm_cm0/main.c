@@ -3,6 +3,21 @@
 
 #include "rtos.h"
 
+/*
+ * Testes do Thread-Metric (medicoes/mede_thread_metric.c) no lugar das 
+ * tarefas de exemplo, ligados com MEDE_THREAD_METRIC=n (teste 1 a 7) nos 
+ * simbolos do projeto. Sem saida: o total da ultima janela de 30 s fica em 
+ * operacoes_thread_metric, para o Live Watch. Os testes 3 e 4 precisam da 
+ * rotina MEDE_TM_ROTINA na tabela de vetores do dispositivo escolhido
+ */
+#ifndef MEDE_THREAD_METRIC
+#define MEDE_THREAD_METRIC	0
+#endif
+
+#if MEDE_THREAD_METRIC
+#include "mede_thread_metric.h"
+#endif
+
 /*
  * Prototipos das tarefas
  */
@@ -29,12 +44,16 @@ uint32_t PILHA_TAREFA_OCIOSA[TAM_PILHA_OCIOSA];
 int main(void)
 {
 	
+#if MEDE_THREAD_METRIC
+	MedeThreadMetricCriaTarefas(MEDE_THREAD_METRIC, 0);
+#else
 	/* Criacao das tarefas */
 	/* Parametros: ponteiro, nome, ponteiro da pilha, tamanho da pilha, prioridade da tarefa */
 	
 	CriaTarefa(tarefa_1, "Tarefa 1", PILHA_TAREFA_1, TAM_PILHA_1, 1);
 	
 	CriaTarefa(tarefa_2, "Tarefa 2", PILHA_TAREFA_2, TAM_PILHA_2, 2);
+#endif
 	
 	/* Cria tarefa ociosa do sistema */
 	CriaTarefa(tarefa_ociosa,"Tarefa ociosa", PILHA_TAREFA_OCIOSA, TAM_PILHA_OCIOSA, 0);
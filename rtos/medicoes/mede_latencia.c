@@ -0,0 +1,301 @@
+/*
+ * mede_latencia.c
+ *
+ * Latencia da borda externa ate a tarefa (ver mede_latencia.h). O TCC0 conta
+ * livre, com o clock da CPU (gerador 0) e 24 bits, e captura a contagem em
+ * CC0 no evento do EIC e em CC1 no evento por software da tarefa. As
+ * amostras sao guardadas em 16 bits (saturadas) e ordenadas no fim da
+ * rodada para os percentis.
+ */
+
+#include <stdio.h>
+#include "mede_latencia.h"
+
+#if MEDE_LATENCIA
+
+#define TAM_PILHA_ESTIMULO		(TAM_MINIMO_PILHA + 32 + 256)	/* snprintf */
+#define TAM_PILHA_RESPOSTA		(TAM_MINIMO_PILHA + 24)
+
+#define MASCARA_TCC				0x00FFFFFFUL	/* contador de 24 bits */
+#define MAIOR_AMOSTRA			0xFFFFU
+
+NAO_INICIALIZADA static uint32_t pilha_estimulo[TAM_PILHA_ESTIMULO];
+NAO_INICIALIZADA static uint32_t pilha_resposta[TAM_PILHA_RESPOSTA];
+NAO_INICIALIZADA static uint16_t amostras[MEDE_LATENCIA_AMOSTRAS];
+
+volatile resultado_medicao_t resultado_latencia;
+volatile uint16_t histograma_latencia[MEDE_LATENCIA_CLASSES];
+volatile uint32_t rodadas_latencia = 0;
+
+static saida_medicoes_t saida_medicoes;
+static semaforo_t semaforo_borda = {0,0};
+static uint32_t config_canal_resposta;		/* repetida no disparo por software */
+static uint16_t perdidas;					/* bordas sem as duas capturas */
+static uint32_t semente = 1;
+
+static void tarefa_estimulo(void);
+static void tarefa_resposta(void);
+
+/* borda no pino do EIC: o CC0 ja foi capturado pelo evento */
+void EIC_Handler(void)
+{
+	EIC->INTFLAG.reg = 1UL << MEDE_LATENCIA_LINHA_EIC;
+	SemaforoLiberaISR(&semaforo_borda);
+}
+
+/* acima da tarefa de estimulo: inverte o pino de resposta (IOBUS, um
+   ciclo) e captura o CC1 pelo evento por software */
+static void tarefa_resposta(void)
+{
+	for(;;)
+	{
+		SemaforoAguarda(&semaforo_borda);
+		PORT_IOBUS->Group[MEDE_LATENCIA_PINO_RESPOSTA / 32].OUTTGL.reg = 1UL << (MEDE_LATENCIA_PINO_RESPOSTA % 32);
+		EVSYS->CHANNEL.reg = config_canal_resposta | EVSYS_CHANNEL_SWEVT;
+	}
+}
+
+/* canal do EVSYS no caminho ressincronizado (clock do gerador 0),
+   com o mesmo atraso para os dois eventos */
+static uint32_t ConfiguraCanal(uint8_t canal, uint8_t gerador, uint8_t usuario)
+{
+	struct system_gclk_chan_config config_clock;
+	uint32_t config;
+
+	system_gclk_chan_get_config_defaults(&config_clock);
+	config_clock.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(EVSYS_GCLK_ID_0 + canal, &config_clock);
+	system_gclk_chan_enable(EVSYS_GCLK_ID_0 + canal);
+
+	config = EVSYS_CHANNEL_CHANNEL(canal) | EVSYS_CHANNEL_EVGEN(gerador) |
+			 EVSYS_CHANNEL_PATH_RESYNCHRONIZED | EVSYS_CHANNEL_EDGSEL_RISING_EDGE;
+	EVSYS->CHANNEL.reg = config;
+	EVSYS->USER.reg = EVSYS_USER_USER(usuario) | EVSYS_USER_CHANNEL(canal + 1);	/* 0 = nenhum canal */
+
+	return config;
+}
+
+static void IniciaPerifericos(void)
+{
+	struct system_gclk_chan_config config_clock;
+	struct system_pinmux_config config_pino;
+	struct port_config config_saida;
+	uint8_t linha = MEDE_LATENCIA_LINHA_EIC;
+
+	/* pinos de estimulo e de resposta, em 0 */
+	port_get_config_defaults(&config_saida);
+	config_saida.direction = PORT_PIN_DIR_OUTPUT;
+	port_pin_set_config(MEDE_LATENCIA_PINO_ESTIMULO, &config_saida);
+	port_pin_set_output_level(MEDE_LATENCIA_PINO_ESTIMULO, false);
+	port_pin_set_config(MEDE_LATENCIA_PINO_RESPOSTA, &config_saida);
+	port_pin_set_output_level(MEDE_LATENCIA_PINO_RESPOSTA, false);
+
+	/* TCC0 livre com o clock da CPU, capturas nos canais 0 e 1 por evento */
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_TCC0 | PM_APBCMASK_EVSYS);
+	system_gclk_chan_get_config_defaults(&config_clock);
+	config_clock.source_generator = GCLK_GENERATOR_0;
+	system_gclk_chan_set_config(TCC0_GCLK_ID, &config_clock);
+	system_gclk_chan_enable(TCC0_GCLK_ID);
+
+	TCC0->CTRLA.reg = TCC_CTRLA_SWRST;
+	while(TCC0->SYNCBUSY.reg & TCC_SYNCBUSY_SWRST) {}
+	TCC0->CTRLA.reg = TCC_CTRLA_PRESCALER_DIV1 | TCC_CTRLA_CPTEN0 | TCC_CTRLA_CPTEN1;
+	TCC0->EVCTRL.reg = TCC_EVCTRL_MCEI0 | TCC_EVCTRL_MCEI1;
+	TCC0->CTRLA.reg |= TCC_CTRLA_ENABLE;
+	while(TCC0->SYNCBUSY.reg & TCC_SYNCBUSY_ENABLE) {}
+
+	ConfiguraCanal(MEDE_LATENCIA_CANAL_BORDA, EVSYS_ID_GEN_EIC_EXTINT_0 + linha, EVSYS_ID_USER_TCC0_MC_0);
+	config_canal_resposta = ConfiguraCanal(MEDE_LATENCIA_CANAL_RESPOSTA, 0, EVSYS_ID_USER_TCC0_MC_1);
+
+	/* EIC: borda de subida, com evento e interrupcao, sem filtro. O pino
+	   tem pull-down para nao disparar sem o jumper */
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBA, PM_APBAMASK_EIC);
+	system_gclk_chan_set_config(EIC_GCLK_ID, &config_clock);
+	system_gclk_chan_enable(EIC_GCLK_ID);
+
+	system_pinmux_get_config_defaults(&config_pino);
+	config_pino.mux_position = MEDE_LATENCIA_MUX_EIC;
+	config_pino.direction = SYSTEM_PINMUX_PIN_DIR_INPUT;
+	config_pino.input_pull = SYSTEM_PINMUX_PIN_PULL_DOWN;
+	system_pinmux_pin_set_config(MEDE_LATENCIA_PINO_EIC, &config_pino);
+
+	EIC->CTRL.reg = 0;
+	while(EIC->STATUS.reg & EIC_STATUS_SYNCBUSY) {}
+	EIC->CONFIG[linha / 8].reg = (EIC->CONFIG[linha / 8].reg & ~(EIC_CONFIG_SENSE0_Msk << (4 * (linha % 8)))) |
+								 (EIC_CONFIG_SENSE0_RISE << (4 * (linha % 8)));
+	EIC->EVCTRL.reg |= 1UL << linha;
+	EIC->INTFLAG.reg = 1UL << linha;
+	EIC->INTENSET.reg = 1UL << linha;
+	EIC->CTRL.reg = EIC_CTRL_ENABLE;
+	while(EIC->STATUS.reg & EIC_STATUS_SYNCBUSY) {}
+
+	NVIC_EnableIRQ(EIC_IRQn);
+}
+
+/* cria as tarefas e configura o EIC, o TCC0 e o EVSYS. As rodadas
+   comecam com o sistema */
+void MedeLatenciaCriaTarefas(saida_medicoes_t saida)
+{
+	saida_medicoes = saida;
+	IniciaPerifericos();
+	CriaTarefa(tarefa_resposta, "Latencia resposta", pilha_resposta, TAM_PILHA_RESPOSTA, MEDE_LATENCIA_PRIORIDADE);
+	CriaTarefa(tarefa_estimulo, "Latencia estimulo", pilha_estimulo, TAM_PILHA_ESTIMULO, 1);
+}
+
+static uint32_t Aleatorio(void)
+{
+	semente = semente * 1664525UL + 1013904223UL;
+	return semente >> 16;
+}
+
+/* uma borda: retorna 0 se as duas capturas nao aconteceram */
+static uint8_t MedeBorda(uint16_t *ciclos)
+{
+	uint32_t latencia;
+	uint8_t espera;
+	volatile uint16_t atraso;
+
+	/* instantes variados em relacao a marca de tempo e as outras tarefas */
+	TarefaEspera(1 + (Aleatorio() % 4));
+	for(atraso = (uint16_t)(Aleatorio() % 256); atraso != 0; atraso--) {}
+
+	TCC0->INTFLAG.reg = TCC_INTFLAG_MC0 | TCC_INTFLAG_MC1;
+	port_pin_set_output_level(MEDE_LATENCIA_PINO_ESTIMULO, true);
+
+	/* a tarefa de resposta executa antes de voltar aqui; a espera so
+	   cobre a falta do jumper */
+	for(espera = 0; espera < 2 && (TCC0->INTFLAG.reg & (TCC_INTFLAG_MC0 | TCC_INTFLAG_MC1)) !=
+		(TCC_INTFLAG_MC0 | TCC_INTFLAG_MC1); espera++)
+	{
+		TarefaEspera(1);
+	}
+	port_pin_set_output_level(MEDE_LATENCIA_PINO_ESTIMULO, false);
+
+	if(espera == 2)
+	{
+		return 0;
+	}
+
+	latencia = (TCC0->CC[1].reg - TCC0->CC[0].reg) & MASCARA_TCC;
+	*ciclos = (latencia > MAIOR_AMOSTRA) ? MAIOR_AMOSTRA : (uint16_t)latencia;
+	return 1;
+}
+
+static void Ordena(uint16_t *v, uint16_t n)
+{
+	uint16_t i, j, x;
+
+	for(i = 1; i < n; i++)
+	{
+		x = v[i];
+		for(j = i; j > 0 && v[j - 1] > x; j--)
+		{
+			v[j] = v[j - 1];
+		}
+		v[j] = x;
+	}
+}
+
+static uint16_t Percentil(const uint16_t *ordenadas, uint16_t n, uint8_t percentil)
+{
+	return ordenadas[((uint32_t)(n - 1) * percentil) / 100];
+}
+
+static void EnviaResultados(uint16_t n)
+{
+	char linha[96];
+	uint32_t clock_hz = (*(NVIC_SYSTICK_LOAD) + 1) * MarcaTempoFrequencia();
+	uint32_t mhz = clock_hz / 1000000UL;
+	uint16_t p50, p90, p99;
+	uint8_t c;
+
+	snprintf(linha, sizeof(linha), "latencia borda->tarefa, rodada %lu, clock %lu Hz, %u amostras, %u perdidas\r\n",
+			(unsigned long)rodadas_latencia, (unsigned long)clock_hz, (unsigned)n, (unsigned)perdidas);
+	saida_medicoes(linha);
+	if(n == 0)
+	{
+		saida_medicoes("nenhuma captura: ligue o pino de estimulo ao pino do EIC\r\n");
+		return;
+	}
+
+	p50 = Percentil(amostras, n, 50);
+	p90 = Percentil(amostras, n, 90);
+	p99 = Percentil(amostras, n, 99);
+	snprintf(linha, sizeof(linha), "ciclos min %u p50 %u p90 %u p99 %u max %u media %lu\r\n",
+			(unsigned)amostras[0], (unsigned)p50, (unsigned)p90, (unsigned)p99, (unsigned)amostras[n - 1],
+			(unsigned long)(resultado_latencia.total / n));
+	saida_medicoes(linha);
+	if(mhz != 0)
+	{
+		snprintf(linha, sizeof(linha), "ns     min %lu p50 %lu p90 %lu p99 %lu max %lu\r\n",
+				(unsigned long)(amostras[0] * 1000UL / mhz), (unsigned long)(p50 * 1000UL / mhz),
+				(unsigned long)(p90 * 1000UL / mhz), (unsigned long)(p99 * 1000UL / mhz),
+				(unsigned long)(amostras[n - 1] * 1000UL / mhz));
+		saida_medicoes(linha);
+	}
+
+	/* so as classes com amostras; a ultima inclui as maiores */
+	for(c = 0; c < MEDE_LATENCIA_CLASSES; c++)
+	{
+		if(histograma_latencia[c] != 0)
+		{
+			snprintf(linha, sizeof(linha), "%6lu%s %5u\r\n", (unsigned long)c * MEDE_LATENCIA_CLASSE,
+					(c == MEDE_LATENCIA_CLASSES - 1) ? "+" : " ", (unsigned)histograma_latencia[c]);
+			saida_medicoes(linha);
+		}
+	}
+}
+
+/* prioridade 1: a borda interrompe esta tarefa, que estava executando */
+static void tarefa_estimulo(void)
+{
+	uint16_t n, i;
+	uint16_t ciclos;
+	uint8_t c;
+
+	for(;;)
+	{
+		resultado_latencia.minimo = 0xFFFFFFFF;
+		resultado_latencia.maximo = 0;
+		resultado_latencia.total = 0;
+		resultado_latencia.amostras = 0;
+		for(c = 0; c < MEDE_LATENCIA_CLASSES; c++)
+		{
+			histograma_latencia[c] = 0;
+		}
+		perdidas = 0;
+
+		for(n = 0, i = 0; i < MEDE_LATENCIA_AMOSTRAS; i++)
+		{
+			if(!MedeBorda(&ciclos))
+			{
+				perdidas++;
+				continue;
+			}
+			amostras[n++] = ciclos;
+
+			if(ciclos < resultado_latencia.minimo)
+			{
+				resultado_latencia.minimo = ciclos;
+			}
+			if(ciclos > resultado_latencia.maximo)
+			{
+				resultado_latencia.maximo = ciclos;
+			}
+			resultado_latencia.total += ciclos;
+			resultado_latencia.amostras = n;
+			c = (ciclos / MEDE_LATENCIA_CLASSE < MEDE_LATENCIA_CLASSES) ? (uint8_t)(ciclos / MEDE_LATENCIA_CLASSE) :
+				MEDE_LATENCIA_CLASSES - 1;
+			histograma_latencia[c]++;
+		}
+
+		Ordena(amostras, n);
+		rodadas_latencia++;
+		if(saida_medicoes != 0)
+		{
+			EnviaResultados(n);
+		}
+	}
+}
+
+#endif /* MEDE_LATENCIA */
@@ -0,0 +1,100 @@
+/*
+ * mede_latencia.h
+ *
+ * Latencia de uma borda externa ate a tarefa, no SAM D21 e no SAM R21: a
+ * borda de subida em um pino do EIC gera uma interrupcao, que libera o
+ * semaforo de uma tarefa de alta prioridade; a tarefa inverte o pino de
+ * resposta. A latencia e medida pelo TCC0, contando os ciclos de clock da
+ * CPU, com duas capturas feitas pelo hardware via EVSYS:
+ *  - CC0: o evento do EIC na deteccao da borda;
+ *  - CC1: um evento por software gerado pela tarefa logo apos inverter o
+ *    pino de resposta.
+ * Os dois eventos passam pelo caminho ressincronizado do EVSYS, com o mesmo
+ * atraso, entao a diferenca e a latencia da interrupcao, do semaforo e da
+ * troca de contexto ate a tarefa. A sincronizacao do pino no EIC (alguns
+ * ciclos constantes) fica de fora; com um analisador logico nos pinos de
+ * estimulo e de resposta, mede-se a latencia completa.
+ *
+ * A borda vem do pino de estimulo, acionado por uma tarefa de baixa
+ * prioridade em instantes variados: ligue-o ao pino do EIC com um jumper
+ * (padrao: pinos 5 e 9 do conector EXT1 das placas Xplained Pro).
+ *
+ * Cada rodada faz MEDE_LATENCIA_AMOSTRAS medicoes e envia o minimo, a
+ * media, os percentis 50, 90 e 99 e o maximo, e o histograma em classes
+ * de MEDE_LATENCIA_CLASSE ciclos, pela funcao de saida da placa:
+ *
+ *   MedeLatenciaCriaTarefas(EscreveSerial);
+ *   CriaTarefa(tarefa_ociosa, "Tarefa ociosa", pilha, tamanho, 0);
+ *
+ * Usa o EIC, o TCC0 e dois canais do EVSYS, e define o EIC_Handler, entao
+ * so e compilado com MEDE_LATENCIA=1 (simbolo da configuracao Benchmark).
+ */
+
+
+#ifndef MEDE_LATENCIA_H_
+#define MEDE_LATENCIA_H_
+
+#include <asf.h>
+#include "stdint.h"
+#include "rtos.h"
+#include "mede_nucleo.h"		/* saida_medicoes_t e resultado_medicao_t */
+
+#ifndef MEDE_LATENCIA
+#define MEDE_LATENCIA				0
+#endif
+
+/* medicoes por rodada */
+#ifndef MEDE_LATENCIA_AMOSTRAS
+#define MEDE_LATENCIA_AMOSTRAS		1000
+#endif
+
+/* histograma: MEDE_LATENCIA_CLASSES classes de MEDE_LATENCIA_CLASSE
+   ciclos; as latencias maiores vao para a ultima */
+#ifndef MEDE_LATENCIA_CLASSE
+#define MEDE_LATENCIA_CLASSE		16
+#endif
+#ifndef MEDE_LATENCIA_CLASSES
+#define MEDE_LATENCIA_CLASSES		32
+#endif
+
+/* prioridade da tarefa que responde a borda; a tarefa de estimulo executa
+   na prioridade 1 */
+#ifndef MEDE_LATENCIA_PRIORIDADE
+#define MEDE_LATENCIA_PRIORIDADE	PRIORIDADE_MAXIMA
+#endif
+
+/* pinos: estimulo (saida), resposta (saida) e entrada do EIC, com a sua
+   linha EXTINT e o seu mux */
+#ifndef MEDE_LATENCIA_PINO_ESTIMULO
+#define MEDE_LATENCIA_PINO_ESTIMULO	EXT1_PIN_GPIO_0
+#endif
+#ifndef MEDE_LATENCIA_PINO_RESPOSTA
+#define MEDE_LATENCIA_PINO_RESPOSTA	EXT1_PIN_GPIO_1
+#endif
+#ifndef MEDE_LATENCIA_PINO_EIC
+#define MEDE_LATENCIA_PINO_EIC		EXT1_IRQ_PIN
+#define MEDE_LATENCIA_MUX_EIC		EXT1_IRQ_MUX
+#define MEDE_LATENCIA_LINHA_EIC		EXT1_IRQ_INPUT
+#endif
+
+/* canais do EVSYS da borda (EIC) e da resposta (por software) */
+#ifndef MEDE_LATENCIA_CANAL_BORDA
+#define MEDE_LATENCIA_CANAL_BORDA	4
+#endif
+#ifndef MEDE_LATENCIA_CANAL_RESPOSTA
+#define MEDE_LATENCIA_CANAL_RESPOSTA	5
+#endif
+
+#if MEDE_LATENCIA_PRIORIDADE < 2 || MEDE_LATENCIA_PRIORIDADE > PRIORIDADE_MAXIMA
+#error "MEDE_LATENCIA_PRIORIDADE deve ficar acima da tarefa de estimulo (prioridade 1)"
+#endif
+
+/* resultados da ultima rodada completa, tambem para leitura pelo
+   depurador: minimo, maximo, soma e amostras em ciclos, e o histograma */
+extern volatile resultado_medicao_t resultado_latencia;
+extern volatile uint16_t histograma_latencia[MEDE_LATENCIA_CLASSES];
+extern volatile uint32_t rodadas_latencia;
+
+void MedeLatenciaCriaTarefas(saida_medicoes_t saida);
+
+#endif /* MEDE_LATENCIA_H_ */
@@ -0,0 +1,245 @@
+/*
+ * mede_nucleo.c
+ *
+ * Medicoes do nucleo no microcontrolador. O SysTick conta para baixo a cada
+ * ciclo e recarrega a cada marca de tempo: uma medicao com fim >= inicio
+ * atravessou uma recarga e e descartada. O custo das duas leituras do
+ * contador e medido a cada rodada e descontado.
+ *
+ * TarefaEspera(1) sempre atravessa uma recarga, entao e medida pelas marcas
+ * de tempo: com exatamente uma marca entre o inicio e o fim, o tempo e o
+ * resto da marca do inicio mais os ciclos desde a recarga ate o fim.
+ */
+
+#include <stdio.h>
+#include "mede_nucleo.h"
+
+#define TAM_PILHA_MEDE		(TAM_MINIMO_PILHA + 32 + 256)	/* snprintf */
+#define TAM_PILHA_PAR		(TAM_MINIMO_PILHA + 24)
+
+/* configuracao da compilacao, no cabecalho de cada rodada */
+#if defined(OTIMIZA_DESEMPENHO) && OTIMIZA_DESEMPENHO
+#define COMPILACAO			"LTO, -O2 no codigo quente"
+#else
+#define COMPILACAO			"-Os"
+#endif
+
+NAO_INICIALIZADA static uint32_t pilha_mede[TAM_PILHA_MEDE];
+NAO_INICIALIZADA static uint32_t pilha_acordada[TAM_PILHA_PAR];
+NAO_INICIALIZADA static uint32_t pilha_suspensa[TAM_PILHA_PAR];
+
+volatile resultado_medicao_t resultados_nucleo[MEDE_OPERACOES];
+volatile uint32_t rodadas_nucleo = 0;
+
+static const char * const nomes_operacoes[MEDE_OPERACOES] =
+{
+	"TarefaContinua",
+	"TarefaSuspende",
+	"SemaforoLibera->acorda",
+	"TarefaEspera(1)",
+	"marca->retorno",
+	"troca PendSV"
+};
+
+static saida_medicoes_t saida_medicoes;
+static uint8_t id_suspensa;
+static semaforo_t semaforo_medicao = {0,0};
+static volatile uint32_t ciclos_acordada;		/* contador lido pela tarefa acordada */
+
+static void tarefa_mede_nucleo(void);
+static void tarefa_acordada(void);
+static void tarefa_suspensa(void);
+
+/* cria as tarefas das medicoes. As rodadas comecam com o sistema */
+void MedeNucleoCriaTarefas(saida_medicoes_t saida)
+{
+	saida_medicoes = saida;
+	CriaTarefa(tarefa_mede_nucleo, "Mede nucleo", pilha_mede, TAM_PILHA_MEDE, MEDE_NUCLEO_PRIORIDADE);
+	CriaTarefa(tarefa_acordada, "Mede acordada", pilha_acordada, TAM_PILHA_PAR, MEDE_NUCLEO_PRIORIDADE + 1);
+	id_suspensa = CriaTarefa(tarefa_suspensa, "Mede suspensa", pilha_suspensa, TAM_PILHA_PAR, MEDE_NUCLEO_PRIORIDADE - 1);
+}
+
+/* acima da tarefa de medicao: executa logo apos cada SemaforoLibera */
+static void tarefa_acordada(void)
+{
+	for(;;)
+	{
+		SemaforoAguarda(&semaforo_medicao);
+		ciclos_acordada = LE_CONTADOR_CICLOS();
+	}
+}
+
+/* abaixo da tarefa de medicao: so e continuada e suspensa por ela, sem
+   nunca chegar a executar */
+static void tarefa_suspensa(void)
+{
+	for(;;)
+	{
+		TarefaSuspende(id_suspensa);
+	}
+}
+
+static void Registra(resultado_medicao_t *resultado, uint32_t inicio, uint32_t fim, uint32_t ajuste)
+{
+	uint32_t ciclos;
+
+	if(fim >= inicio)
+	{
+		return;		/* recarga do SysTick no meio */
+	}
+	ciclos = inicio - fim;
+	ciclos = (ciclos > ajuste) ? ciclos - ajuste : 0;
+
+	if(ciclos < resultado->minimo)
+	{
+		resultado->minimo = ciclos;
+	}
+	if(ciclos > resultado->maximo)
+	{
+		resultado->maximo = ciclos;
+	}
+	resultado->total += ciclos;
+	resultado->amostras++;
+}
+
+/* le a marca de tempo e o contador juntos. Retorna 0 se a recarga ja
+   aconteceu mas a marca ainda nao foi contada */
+static uint8_t LeMarcaEContador(tick_t *marca, uint32_t *contador)
+{
+	reg_atomica_t estado;
+	uint8_t valido;
+
+	REG_ATOMICA_INICIO(estado);
+	*marca = ObtemMarcasDeTempo();
+	*contador = LE_CONTADOR_CICLOS();
+	valido = (*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET) == 0;
+	REG_ATOMICA_FIM(estado);
+
+	return valido;
+}
+
+static void MedeRodada(resultado_medicao_t *resultados)
+{
+	uint32_t inicio, fim, ajuste, recarga;
+	tick_t marca_inicio, marca_fim;
+	reg_atomica_t estado;
+	uint16_t i;
+	uint8_t op;
+
+	for(op = 0; op < MEDE_OPERACOES; op++)
+	{
+		resultados[op].minimo = 0xFFFFFFFF;
+		resultados[op].maximo = 0;
+		resultados[op].total = 0;
+		resultados[op].amostras = 0;
+	}
+
+	/* custo da propria leitura do contador, descontado das medicoes */
+	REG_ATOMICA_INICIO(estado);
+	inicio = LE_CONTADOR_CICLOS();
+	fim = LE_CONTADOR_CICLOS();
+	REG_ATOMICA_FIM(estado);
+	ajuste = (fim < inicio) ? inicio - fim : 0;
+
+	for(i = 0; i < MEDE_NUCLEO_AMOSTRAS; i++)
+	{
+		/* a tarefa suspensa tem menor prioridade: nenhuma troca de contexto */
+		inicio = LE_CONTADOR_CICLOS();
+		TarefaContinua(id_suspensa);
+		fim = LE_CONTADOR_CICLOS();
+		Registra(&resultados[MEDE_CONTINUA], inicio, fim, ajuste);
+
+		inicio = LE_CONTADOR_CICLOS();
+		TarefaSuspende(id_suspensa);
+		fim = LE_CONTADOR_CICLOS();
+		Registra(&resultados[MEDE_SUSPENDE], inicio, fim, ajuste);
+	}
+
+	for(i = 0; i < MEDE_NUCLEO_AMOSTRAS; i++)
+	{
+		/* retorna depois que a tarefa acordada leu o contador e voltou a esperar */
+		inicio = LE_CONTADOR_CICLOS();
+		SemaforoLibera(&semaforo_medicao);
+		Registra(&resultados[MEDE_SEMAFORO_ACORDA], inicio, ciclos_acordada, ajuste);
+	}
+
+	for(i = 0; i < MEDE_NUCLEO_AMOSTRAS; i++)
+	{
+		uint8_t valido = LeMarcaEContador(&marca_inicio, &inicio);
+
+		TarefaEspera(1);
+		valido &= LeMarcaEContador(&marca_fim, &fim);
+
+		if(valido && (tick_t)(marca_fim - marca_inicio) == 1)
+		{
+			/* conta ate 0, recarrega (1 ciclo) e conta de LOAD ate fim */
+			recarga = *(NVIC_SYSTICK_LOAD);
+			Registra(&resultados[MEDE_MARCA_RETORNO], recarga, fim, ajuste);
+			Registra(&resultados[MEDE_ESPERA_1], inicio + 1 + recarga, fim, ajuste);
+		}
+	}
+
+	for(i = 0; i < MEDE_NUCLEO_AMOSTRAS; i++)
+	{
+		/* troca de contexto para a propria tarefa: o PendSV_Handler completo */
+		REG_ATOMICA_INICIO(estado);
+		inicio = LE_CONTADOR_CICLOS();
+		TROCA_CONTEXTO();
+		REG_ATOMICA_FIM(estado);		/* o PendSV executa assim que as interrupcoes sao habilitadas */
+		fim = LE_CONTADOR_CICLOS();
+		Registra(&resultados[MEDE_TROCA_PENDSV], inicio, fim, ajuste);
+	}
+}
+
+static void EnviaResultados(const resultado_medicao_t *resultados)
+{
+	char linha[96];
+	uint32_t clock_hz = (*(NVIC_SYSTICK_LOAD) + 1) * MarcaTempoFrequencia();
+	uint8_t op;
+
+	snprintf(linha, sizeof(linha), "rodada %lu, clock %lu Hz, %s, ciclos min/media/max\r\n",
+			(unsigned long)rodadas_nucleo, (unsigned long)clock_hz, COMPILACAO);
+	saida_medicoes(linha);
+
+	for(op = 0; op < MEDE_OPERACOES; op++)
+	{
+		const resultado_medicao_t *r = &resultados[op];
+
+		if(r->amostras == 0)
+		{
+			snprintf(linha, sizeof(linha), "%-24s sem amostras\r\n", nomes_operacoes[op]);
+		}
+		else
+		{
+			snprintf(linha, sizeof(linha), "%-24s %6lu %6lu %6lu (%u)\r\n", nomes_operacoes[op],
+					(unsigned long)r->minimo, (unsigned long)(r->total / r->amostras),
+					(unsigned long)r->maximo, (unsigned)r->amostras);
+		}
+		saida_medicoes(linha);
+	}
+}
+
+static void tarefa_mede_nucleo(void)
+{
+	static resultado_medicao_t rodada[MEDE_OPERACOES];
+	uint8_t op;
+
+	TarefaSuspende(id_suspensa);		/* so volta a ficar pronta nas medicoes */
+
+	for(;;)
+	{
+		MedeRodada(rodada);
+
+		rodadas_nucleo++;
+		for(op = 0; op < MEDE_OPERACOES; op++)
+		{
+			resultados_nucleo[op] = rodada[op];
+		}
+		if(saida_medicoes != 0)
+		{
+			EnviaResultados(rodada);
+		}
+
+		TarefaEspera(MEDE_NUCLEO_INTERVALO);
+	}
+}
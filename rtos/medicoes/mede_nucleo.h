@@ -0,0 +1,86 @@
+/*
+ * mede_nucleo.h
+ *
+ * Medicoes do nucleo no proprio microcontrolador (Cortex-M0+), em ciclos de
+ * clock contados pelo SysTick (LE_CONTADOR_CICLOS da porta), para os
+ * orcamentos de latencia das aplicacoes:
+ *  - TarefaContinua e TarefaSuspende de uma tarefa de menor prioridade,
+ *    sem troca de contexto;
+ *  - SemaforoLibera ate a tarefa que esperava o semaforo voltar a executar;
+ *  - TarefaEspera(1) completa, da chamada ao retorno, e so a parte da marca
+ *    de tempo ate o retorno;
+ *  - a troca de contexto completa do PendSV, da tarefa para ela mesma.
+ *
+ * Cada rodada faz MEDE_NUCLEO_AMOSTRAS medicoes de cada operacao e envia o
+ * minimo, a media e o maximo, uma linha de texto por operacao, pela funcao
+ * de saida da placa (ex.: a UART da porta serial do EDBG). As medicoes
+ * interrompidas pela recarga do SysTick (marca de tempo) sao descartadas.
+ *
+ * O modulo cria as suas tres tarefas, com prioridades MEDE_NUCLEO_PRIORIDADE
+ * - 1 a MEDE_NUCLEO_PRIORIDADE + 1, entao a placa so cria a tarefa ociosa:
+ *
+ *   MedeNucleoCriaTarefas(EscreveSerial);
+ *   CriaTarefa(tarefa_ociosa, "Tarefa ociosa", pilha, tamanho, 0);
+ */
+
+
+#ifndef MEDE_NUCLEO_H_
+#define MEDE_NUCLEO_H_
+
+#include "stdint.h"
+#include "rtos.h"
+
+/* medicoes de cada operacao por rodada */
+#ifndef MEDE_NUCLEO_AMOSTRAS
+#define MEDE_NUCLEO_AMOSTRAS		256
+#endif
+
+/* prioridade da tarefa de medicao; a tarefa acordada pelo semaforo fica
+   acima e a tarefa suspensa/continuada, abaixo */
+#ifndef MEDE_NUCLEO_PRIORIDADE
+#define MEDE_NUCLEO_PRIORIDADE		2
+#endif
+
+/* marcas de tempo entre as rodadas */
+#ifndef MEDE_NUCLEO_INTERVALO
+#define MEDE_NUCLEO_INTERVALO		1000
+#endif
+
+#if MEDE_NUCLEO_PRIORIDADE < 2 || MEDE_NUCLEO_PRIORIDADE + 1 > PRIORIDADE_MAXIMA
+#error "MEDE_NUCLEO_PRIORIDADE deve deixar uma prioridade livre acima e uma acima da ociosa"
+#endif
+
+/* funcao que envia uma linha de resultado, terminada em "\r\n" */
+typedef void (*saida_medicoes_t)(const char *texto);
+
+/**
+* \struct resultado_medicao_t
+* Resultado de uma operacao na ultima rodada, em ciclos de clock
+*/
+
+typedef struct
+{
+	uint32_t	minimo;
+	uint32_t	maximo;
+	uint32_t	total;			///< Soma das amostras validas, para a media
+	uint16_t	amostras;		///< Amostras validas (sem recarga do SysTick)
+} resultado_medicao_t;
+
+/* operacoes medidas, na ordem da saida */
+typedef enum {
+	MEDE_CONTINUA = 0,		///< TarefaContinua sem troca de contexto
+	MEDE_SUSPENDE,			///< TarefaSuspende sem troca de contexto
+	MEDE_SEMAFORO_ACORDA,	///< SemaforoLibera ate a tarefa acordada executar
+	MEDE_ESPERA_1,			///< TarefaEspera(1), da chamada ao retorno
+	MEDE_MARCA_RETORNO,		///< da marca de tempo ao retorno de TarefaEspera(1)
+	MEDE_TROCA_PENDSV,		///< troca de contexto completa (PendSV)
+	MEDE_OPERACOES
+} operacao_medida_t;
+
+/* resultados da ultima rodada completa, tambem para leitura pelo depurador */
+extern volatile resultado_medicao_t resultados_nucleo[MEDE_OPERACOES];
+extern volatile uint32_t rodadas_nucleo;
+
+void MedeNucleoCriaTarefas(saida_medicoes_t saida);
+
+#endif /* MEDE_NUCLEO_H_ */
@@ -0,0 +1,355 @@
+/*
+ * mede_thread_metric.c
+ *
+ * Testes do Thread-Metric sobre o rtos.c (ver mede_thread_metric.h). As
+ * tarefas seguem os lacos do original, trocando as chamadas tm_* pelos
+ * servicos do nucleo. As tarefas do teste 2 (e a tarefa de cima do teste 4)
+ * se suspendem no inicio de cada volta, como se fossem criadas suspensas.
+ *
+ * Os contadores so crescem: o relatorio soma a diferenca desde a janela
+ * anterior, sem zera-los com as tarefas executando.
+ */
+
+#include <stdio.h>
+#include "mede_thread_metric.h"
+
+#if MEDE_THREAD_METRIC
+
+#define TAM_PILHA_RELATORIO	(TAM_MINIMO_PILHA + 32 + 256)	/* snprintf */
+#define TAM_PILHA_TESTE		(TAM_MINIMO_PILHA + 32)
+
+#define TAREFAS_TESTE		5
+#define TAM_MENSAGEM		16
+#define TAM_BLOCO			128
+
+/* registradores do NVIC para a interrupcao por software */
+#define NVIC_ISER			((volatile uint32_t *)0xE000E100)
+#define NVIC_ISPR			((volatile uint32_t *)0xE000E200)
+#define DISPARA_INTERRUPCAO()	(*(NVIC_ISPR) = 1UL << MEDE_TM_IRQ)
+
+NAO_INICIALIZADA static uint32_t pilha_relatorio[TAM_PILHA_RELATORIO];
+NAO_INICIALIZADA static uint32_t pilhas_teste[TAREFAS_TESTE][TAM_PILHA_TESTE];
+
+volatile uint32_t operacoes_thread_metric = 0;
+volatile uint32_t janelas_thread_metric = 0;
+volatile uint32_t erros_thread_metric = 0;
+
+static const char * const nomes_testes[MEDE_TM_TESTES] =
+{
+	"",
+	"troca cooperativa",
+	"troca preemptiva",
+	"interrupcao",
+	"preempcao por interrupcao",
+	"mensagens",
+	"sincronizacao",
+	"memoria"
+};
+
+static teste_thread_metric_t teste_atual;
+static saida_medicoes_t saida_medicoes;
+static uint8_t ids_teste[TAREFAS_TESTE];
+static volatile uint32_t contadores[TAREFAS_TESTE];
+static volatile uint32_t contador_interrupcao;
+
+static semaforo_t semaforo_teste = {0,0};
+static fila_t fila_teste;
+static uint32_t area_fila[4 * TAM_MENSAGEM / sizeof(uint32_t)];
+static memoria_t memoria_teste;
+static MEMORIA_AREA(area_memoria, TAM_BLOCO, 1);
+
+static void tarefa_relatorio(void);
+static void tarefa_cooperativa(void);
+static void tarefa_preemptiva(void);
+static void tarefa_interrupcao(void);
+static void tarefa_dispara_preempcao(void);
+static void tarefa_preemptada(void);
+static void tarefa_mensagens(void);
+static void tarefa_sincronizacao(void);
+static void tarefa_memoria(void);
+
+/* indice da tarefa atual entre as do teste */
+static uint8_t IndiceAtual(void)
+{
+	uint8_t i;
+
+	for(i = 0; i < TAREFAS_TESTE - 1 && ids_teste[i] != tarefa_atual; i++) {}
+	return i;
+}
+
+/* cria as tarefas do teste e a de relatorio; a primeira janela comeca
+   com o sistema */
+void MedeThreadMetricCriaTarefas(teste_thread_metric_t teste, saida_medicoes_t saida)
+{
+	uint8_t i;
+
+	teste_atual = teste;
+	saida_medicoes = saida;
+
+	switch(teste)
+	{
+		case MEDE_TM_COOPERATIVO:
+			for(i = 0; i < TAREFAS_TESTE; i++)
+			{
+				ids_teste[i] = CriaTarefa(tarefa_cooperativa, "TM cooperativa", pilhas_teste[i], TAM_PILHA_TESTE, MEDE_TM_PRIORIDADE);
+			}
+			break;
+		case MEDE_TM_PREEMPTIVO:
+			for(i = 0; i < TAREFAS_TESTE; i++)
+			{
+				ids_teste[i] = CriaTarefa(tarefa_preemptiva, "TM preemptiva", pilhas_teste[i], TAM_PILHA_TESTE, MEDE_TM_PRIORIDADE + i);
+			}
+			break;
+		case MEDE_TM_INTERRUPCAO:
+			ids_teste[0] = CriaTarefa(tarefa_interrupcao, "TM interrupcao", pilhas_teste[0], TAM_PILHA_TESTE, MEDE_TM_PRIORIDADE);
+			break;
+		case MEDE_TM_PREEMPCAO_ISR:
+			ids_teste[0] = CriaTarefa(tarefa_dispara_preempcao, "TM dispara", pilhas_teste[0], TAM_PILHA_TESTE, MEDE_TM_PRIORIDADE);
+			ids_teste[1] = CriaTarefa(tarefa_preemptada, "TM preemptada", pilhas_teste[1], TAM_PILHA_TESTE, MEDE_TM_PRIORIDADE + 1);
+			break;
+		case MEDE_TM_MENSAGENS:
+			FilaInicia(&fila_teste, area_fila, TAM_MENSAGEM, sizeof(area_fila) / TAM_MENSAGEM);
+			ids_teste[0] = CriaTarefa(tarefa_mensagens, "TM mensagens", pilhas_teste[0], TAM_PILHA_TESTE, MEDE_TM_PRIORIDADE);
+			break;
+		case MEDE_TM_SINCRONIZACAO:
+			semaforo_teste.contador = 1;
+			ids_teste[0] = CriaTarefa(tarefa_sincronizacao, "TM sincronizacao", pilhas_teste[0], TAM_PILHA_TESTE, MEDE_TM_PRIORIDADE);
+			break;
+		case MEDE_TM_MEMORIA:
+			MemoriaInicia(&memoria_teste, area_memoria, TAM_BLOCO, 1);
+			ids_teste[0] = CriaTarefa(tarefa_memoria, "TM memoria", pilhas_teste[0], TAM_PILHA_TESTE, MEDE_TM_PRIORIDADE);
+			break;
+		default:
+			return;
+	}
+
+	/* a marca de tempo preempta as tarefas do teste, mesmo no modo
+	   cooperativo, para o relatorio executar no fim de cada janela */
+	for(i = 0; i < TAREFAS_TESTE; i++)
+	{
+		if(ids_teste[i] != 0)
+		{
+			TarefaLimiarPreempcao(ids_teste[i], MEDE_TM_PRIORIDADE);
+		}
+	}
+
+	if(teste == MEDE_TM_INTERRUPCAO || teste == MEDE_TM_PREEMPCAO_ISR)
+	{
+		*(NVIC_ISER) = 1UL << MEDE_TM_IRQ;
+	}
+
+	CriaTarefa(tarefa_relatorio, "TM relatorio", pilha_relatorio, TAM_PILHA_RELATORIO, MEDE_TM_PRIORIDADE + TAREFAS_TESTE);
+}
+
+/* teste 1: tm_thread_relinquish */
+static void tarefa_cooperativa(void)
+{
+	uint8_t i = IndiceAtual();
+
+	for(;;)
+	{
+		contadores[i]++;
+		TarefaCede();
+	}
+}
+
+/* teste 2: cada tarefa continua a de prioridade acima, que executa ate se
+   suspender, e so entao conta a sua volta */
+static void tarefa_preemptiva(void)
+{
+	uint8_t i = IndiceAtual();
+
+	for(;;)
+	{
+		if(i != 0)
+		{
+			TarefaSuspende(ids_teste[i]);
+		}
+		if(i != TAREFAS_TESTE - 1)
+		{
+			TarefaContinua(ids_teste[i + 1]);
+		}
+		contadores[i]++;
+	}
+}
+
+/* teste 3 */
+static void tarefa_interrupcao(void)
+{
+	for(;;)
+	{
+		DISPARA_INTERRUPCAO();
+		SemaforoAguarda(&semaforo_teste);
+		contadores[0]++;
+	}
+}
+
+/* teste 4: a tarefa de cima executa antes de a interrupcao retornar aqui */
+static void tarefa_dispara_preempcao(void)
+{
+	for(;;)
+	{
+		DISPARA_INTERRUPCAO();
+		contadores[0]++;
+	}
+}
+
+static void tarefa_preemptada(void)
+{
+	for(;;)
+	{
+		TarefaSuspende(ids_teste[1]);
+		contadores[1]++;
+	}
+}
+
+/* testes 3 e 4 */
+void MEDE_TM_ROTINA(void)
+{
+	contador_interrupcao++;
+	if(teste_atual == MEDE_TM_INTERRUPCAO)
+	{
+		SemaforoLiberaISR(&semaforo_teste);
+	}
+	else
+	{
+		TarefaContinuaISR(ids_teste[1]);
+	}
+}
+
+/* teste 5: a mensagem volta igual, e muda a cada volta */
+static void tarefa_mensagens(void)
+{
+	uint32_t enviada[TAM_MENSAGEM / sizeof(uint32_t)] = {0x11223344UL, 0, 0, 0};
+	uint32_t recebida[TAM_MENSAGEM / sizeof(uint32_t)];
+
+	for(;;)
+	{
+		enviada[3] = contadores[0];
+		FilaEnvia(&fila_teste, enviada);
+		FilaRecebe(&fila_teste, recebida);
+		if(recebida[0] != enviada[0] || recebida[3] != enviada[3])
+		{
+			erros_thread_metric++;
+		}
+		contadores[0]++;
+	}
+}
+
+/* teste 6: o semaforo comeca com 1, entao nunca bloqueia */
+static void tarefa_sincronizacao(void)
+{
+	for(;;)
+	{
+		SemaforoAguarda(&semaforo_teste);
+		SemaforoLibera(&semaforo_teste);
+		contadores[0]++;
+	}
+}
+
+/* teste 7 */
+static void tarefa_memoria(void)
+{
+	void *bloco;
+
+	for(;;)
+	{
+		bloco = MemoriaAloca(&memoria_teste, 0);
+		if(bloco == 0)
+		{
+			erros_thread_metric++;
+			continue;
+		}
+		MemoriaLibera(&memoria_teste, bloco);
+		contadores[0]++;
+	}
+}
+
+/* confere os contadores da janela, pelo criterio do teste: as tarefas que
+   se revezam executam o mesmo numero de vezes (a cooperativa, com a fatia
+   de tempo podendo trocar de tarefa antes de TarefaCede, so tem de
+   executar) e cada interrupcao completa uma volta da tarefa */
+static uint8_t ConfereJanela(const uint32_t *janela)
+{
+	uint8_t i;
+	uint32_t ultima_volta;
+
+	switch(teste_atual)
+	{
+		case MEDE_TM_COOPERATIVO:
+			for(i = 0; i < TAREFAS_TESTE; i++)
+			{
+				if(janela[i] == 0)
+				{
+					return 0;
+				}
+			}
+			return 1;
+		case MEDE_TM_PREEMPTIVO:
+			for(i = 1; i < TAREFAS_TESTE; i++)
+			{
+				/* a volta em andamento no fim da janela */
+				if(janela[i] > janela[0] + 1 || janela[i] + 1 < janela[0])
+				{
+					return 0;
+				}
+			}
+			return 1;
+		case MEDE_TM_INTERRUPCAO:
+		case MEDE_TM_PREEMPCAO_ISR:
+			ultima_volta = janela[TAREFAS_TESTE - 1];		/* contador da interrupcao */
+			return ultima_volta <= janela[0] + 1 && ultima_volta + 1 >= janela[0] && ultima_volta != 0;
+		default:
+			return janela[0] != 0;
+	}
+}
+
+static void tarefa_relatorio(void)
+{
+	static uint32_t anteriores[TAREFAS_TESTE];
+	uint32_t janela[TAREFAS_TESTE];
+	uint32_t atual, total;
+	tick_t despertar = ObtemMarcasDeTempo();
+	char linha[96];
+	uint8_t i;
+
+	for(;;)
+	{
+		TarefaEsperaAte(&despertar, MEDE_TM_JANELA);
+
+		/* os contadores das tarefas e o da interrupcao, no lugar do ultimo
+		   nos testes de interrupcao (que usam no maximo 2 tarefas) */
+		total = 0;
+		for(i = 0; i < TAREFAS_TESTE; i++)
+		{
+			if(i == TAREFAS_TESTE - 1 && (teste_atual == MEDE_TM_INTERRUPCAO || teste_atual == MEDE_TM_PREEMPCAO_ISR))
+			{
+				atual = contador_interrupcao;
+			}
+			else
+			{
+				atual = contadores[i];
+			}
+			janela[i] = atual - anteriores[i];
+			anteriores[i] = atual;
+			total += janela[i];
+		}
+
+		janelas_thread_metric++;
+		operacoes_thread_metric = total;
+		if(!ConfereJanela(janela))
+		{
+			erros_thread_metric++;
+		}
+
+		if(saida_medicoes != 0)
+		{
+			snprintf(linha, sizeof(linha), "Thread-Metric %u %s: janela %lu, %lu operacoes, %lu erros\r\n",
+					(unsigned)teste_atual, nomes_testes[teste_atual], (unsigned long)janelas_thread_metric,
+					(unsigned long)total, (unsigned long)erros_thread_metric);
+			saida_medicoes(linha);
+		}
+	}
+}
+
+#endif /* MEDE_THREAD_METRIC */
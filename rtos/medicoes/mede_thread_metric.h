@@ -0,0 +1,107 @@
+/*
+ * mede_thread_metric.h
+ *
+ * Testes do Thread-Metric (o conjunto classico de medidas de RTOS, com
+ * resultados publicados para varios nucleos) sobre os servicos do rtos.c.
+ * Cada teste conta as operacoes completas por janela de MEDE_TM_JANELA
+ * marcas (30 s, como no original), entao os totais sao comparaveis com os
+ * de outros nucleos no mesmo processador e clock:
+ *
+ *  1 troca de contexto cooperativa: 5 tarefas da mesma prioridade cedem o
+ *    processador (TarefaCede) uma a outra;
+ *  2 troca de contexto preemptiva: 5 tarefas de prioridades crescentes,
+ *    cada uma continua a seguinte, que a preempta, e depois se suspende;
+ *  3 processamento de interrupcao: a tarefa dispara a interrupcao por
+ *    software, que libera o semaforo que ela aguarda;
+ *  4 preempcao por interrupcao: a interrupcao continua uma tarefa de
+ *    prioridade maior que a que a disparou;
+ *  5 troca de mensagens: envia e recebe de volta uma mensagem de 16 bytes
+ *    pela fila;
+ *  6 sincronizacao: SemaforoAguarda e SemaforoLibera sem bloquear;
+ *  7 alocacao de memoria: MemoriaAloca e MemoriaLibera de um bloco de
+ *    128 bytes.
+ *
+ * A tarefa de relatorio, na prioridade MEDE_TM_PRIORIDADE + 5, envia a cada
+ * janela o total e confere os contadores das tarefas (ex.: no teste 2 as 5
+ * tarefas executam o mesmo numero de vezes).
+ *
+ * A interrupcao dos testes 3 e 4 e a MEDE_TM_IRQ, sem periferico, disparada
+ * pelo registrador de pendencia do NVIC. A rotina MEDE_TM_ROTINA e definida
+ * aqui e deve estar na tabela de vetores da placa (o padrao e a do PTC, que
+ * o SAM D21 e o SAM R21 tem e os projetos nao usam).
+ *
+ * Um teste por vez, como no original. Precisa de 7 tarefas (com a ociosa) e
+ * PRIORIDADE_MAXIMA >= MEDE_TM_PRIORIDADE + 5 no conf_rtos.h:
+ *
+ *   MedeThreadMetricCriaTarefas(2, EscreveSerial);
+ *   CriaTarefa(tarefa_ociosa, "Tarefa ociosa", pilha, tamanho, 0);
+ *
+ * Define a rotina da interrupcao, entao so e compilado com
+ * MEDE_THREAD_METRIC=n (o teste, 1 a 7) nos simbolos do projeto.
+ */
+
+
+#ifndef MEDE_THREAD_METRIC_H_
+#define MEDE_THREAD_METRIC_H_
+
+#include "stdint.h"
+#include "rtos.h"
+#include "mede_nucleo.h"		/* saida_medicoes_t */
+
+#ifndef MEDE_THREAD_METRIC
+#define MEDE_THREAD_METRIC		0
+#endif
+
+/* marcas de tempo de cada janela do relatorio */
+#ifndef MEDE_TM_JANELA
+#define MEDE_TM_JANELA			(30UL * cfg_MARCA_TEMPO_HZ)
+#endif
+
+/* prioridade mais baixa das tarefas dos testes; o teste 2 usa as 5
+   prioridades a partir dela e o relatorio fica acima */
+#ifndef MEDE_TM_PRIORIDADE
+#define MEDE_TM_PRIORIDADE		1
+#endif
+
+/* interrupcao livre dos testes 3 e 4 (26: PTC no SAM D21/R21) */
+#ifndef MEDE_TM_IRQ
+#define MEDE_TM_IRQ				26
+#endif
+
+#ifndef MEDE_TM_ROTINA
+#define MEDE_TM_ROTINA			PTC_Handler
+#endif
+
+#if MEDE_THREAD_METRIC
+#if MEDE_TM_PRIORIDADE < 1 || MEDE_TM_PRIORIDADE + 5 > PRIORIDADE_MAXIMA
+#error "MEDE_TM_PRIORIDADE deve ficar acima da ociosa, com 5 prioridades livres acima dela"
+#endif
+#if NUMERO_DE_TAREFAS < 7
+#error "Thread-Metric usa ate 5 tarefas de teste, a de relatorio e a ociosa (NUMERO_DE_TAREFAS >= 7)"
+#endif
+#if MEDE_TM_IRQ < 0 || MEDE_TM_IRQ > 31
+#error "MEDE_TM_IRQ deve ser uma interrupcao externa do Cortex-M0 (0 a 31)"
+#endif
+#endif
+
+/* testes, na numeracao do Thread-Metric */
+typedef enum {
+	MEDE_TM_COOPERATIVO = 1,	///< troca de contexto cooperativa
+	MEDE_TM_PREEMPTIVO,			///< troca de contexto preemptiva
+	MEDE_TM_INTERRUPCAO,		///< processamento de interrupcao
+	MEDE_TM_PREEMPCAO_ISR,		///< preempcao por interrupcao
+	MEDE_TM_MENSAGENS,			///< troca de mensagens
+	MEDE_TM_SINCRONIZACAO,		///< sincronizacao (semaforo)
+	MEDE_TM_MEMORIA,			///< alocacao de memoria
+	MEDE_TM_TESTES
+} teste_thread_metric_t;
+
+/* ultima janela completa e erros dos contadores, tambem para leitura pelo
+   depurador (ex.: no projeto IAR, sem saida) */
+extern volatile uint32_t operacoes_thread_metric;
+extern volatile uint32_t janelas_thread_metric;
+extern volatile uint32_t erros_thread_metric;
+
+void MedeThreadMetricCriaTarefas(teste_thread_metric_t teste, saida_medicoes_t saida);
+
+#endif /* MEDE_THREAD_METRIC_H_ */
@@ -0,0 +1,141 @@
+/*
+ * atomico.h
+ *
+ * Operacoes atomicas em palavras de 32 bits compartilhadas entre tarefas e
+ * interrupcoes, mais curtas que uma regiao atomica em volta do codigo.
+ *
+ * No Cortex-M0/M0+, sem LDREX/STREX, cada operacao desabilita as
+ * interrupcoes (PRIMASK) so durante a leitura, a operacao e a escrita
+ * (3 a 5 instrucoes), na regiao curta da porta (REG_ATOMICA_CURTA_INICIO/
+ * FIM): com MASCARA_NUCLEO, tambem as interrupcoes de latencia zero. Com
+ * instrucoes exclusivas (Cortex-M3/M4/M7, onde o compilador define
+ * __ARM_FEATURE_LDREX) ou no computador (porta posix), usa as operacoes
+ * __atomic do gcc, sem desabilitar as interrupcoes.
+ * ATOMICO_NATIVO pode ser definido no conf_rtos.h para forcar a escolha.
+ *
+ * Num processador de um nucleo so, as duas formas tambem sao atomicas em
+ * relacao as regioes atomicas (REG_ATOMICA_INICIO/FIM) do mesmo dado: a
+ * interrupcao que entra entre o LDREX e o STREX faz o STREX falhar.
+ */
+
+
+#ifndef ATOMICO_H_
+#define ATOMICO_H_
+
+#include "stdint.h"
+
+#ifndef ATOMICO_NATIVO
+#if defined(__GNUC__) && (defined(__ARM_FEATURE_LDREX) || !defined(__arm__))
+#define ATOMICO_NATIVO		1
+#else
+#define ATOMICO_NATIVO		0
+#endif
+#endif
+
+#if ATOMICO_NATIVO
+
+/* soma v e retorna o novo valor */
+static inline uint32_t AtomicoSoma(volatile uint32_t *p, uint32_t v)
+{
+	return __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST);
+}
+
+/* liga os bits de v e retorna o valor anterior */
+static inline uint32_t AtomicoOu(volatile uint32_t *p, uint32_t v)
+{
+	return __atomic_fetch_or(p, v, __ATOMIC_SEQ_CST);
+}
+
+/* mantem so os bits de v e retorna o valor anterior */
+static inline uint32_t AtomicoE(volatile uint32_t *p, uint32_t v)
+{
+	return __atomic_fetch_and(p, v, __ATOMIC_SEQ_CST);
+}
+
+/* escreve v e retorna o valor anterior */
+static inline uint32_t AtomicoTroca(volatile uint32_t *p, uint32_t v)
+{
+	return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+/* escreve novo se o valor e esperado. Retorna 1 se escreveu */
+static inline uint8_t AtomicoCompara(volatile uint32_t *p, uint32_t esperado, uint32_t novo)
+{
+	return __atomic_compare_exchange_n(p, &esperado, novo, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? 1 : 0;
+}
+
+#else
+
+/* a regiao curta da porta (ex.: so PRIMASK com MASCARA_NUCLEO no Cortex-M0+), 
+   ou a regiao atomica do nucleo nas portas sem ela */
+#ifndef REG_ATOMICA_CURTA_INICIO
+#define REG_ATOMICA_CURTA_INICIO(estado)	REG_ATOMICA_INICIO(estado)
+#define REG_ATOMICA_CURTA_FIM(estado)		REG_ATOMICA_FIM(estado)
+#endif
+
+static inline uint32_t AtomicoSoma(volatile uint32_t *p, uint32_t v)
+{
+	reg_atomica_t estado;
+	uint32_t novo;
+
+	REG_ATOMICA_CURTA_INICIO(estado);
+	novo = *p + v;
+	*p = novo;
+	REG_ATOMICA_CURTA_FIM(estado);
+	return novo;
+}
+
+static inline uint32_t AtomicoOu(volatile uint32_t *p, uint32_t v)
+{
+	reg_atomica_t estado;
+	uint32_t anterior;
+
+	REG_ATOMICA_CURTA_INICIO(estado);
+	anterior = *p;
+	*p = anterior | v;
+	REG_ATOMICA_CURTA_FIM(estado);
+	return anterior;
+}
+
+static inline uint32_t AtomicoE(volatile uint32_t *p, uint32_t v)
+{
+	reg_atomica_t estado;
+	uint32_t anterior;
+
+	REG_ATOMICA_CURTA_INICIO(estado);
+	anterior = *p;
+	*p = anterior & v;
+	REG_ATOMICA_CURTA_FIM(estado);
+	return anterior;
+}
+
+static inline uint32_t AtomicoTroca(volatile uint32_t *p, uint32_t v)
+{
+	reg_atomica_t estado;
+	uint32_t anterior;
+
+	REG_ATOMICA_CURTA_INICIO(estado);
+	anterior = *p;
+	*p = v;
+	REG_ATOMICA_CURTA_FIM(estado);
+	return anterior;
+}
+
+static inline uint8_t AtomicoCompara(volatile uint32_t *p, uint32_t esperado, uint32_t novo)
+{
+	reg_atomica_t estado;
+	uint8_t igual;
+
+	REG_ATOMICA_CURTA_INICIO(estado);
+	igual = (*p == esperado);
+	if(igual)
+	{
+		*p = novo;
+	}
+	REG_ATOMICA_CURTA_FIM(estado);
+	return igual;
+}
+
+#endif /* ATOMICO_NATIVO */
+
+#endif /* ATOMICO_H_ */
@@ -0,0 +1,4802 @@
+/*
+ * rtos.c
+ *
+ */ 
+
+#include "rtos.h"
+
+/* com cfg_SERVICOS_EM_LINHA, os servicos com caminho rapido em rtos.h sao
+   definidos aqui com o nome do caminho lento */
+#if cfg_SERVICOS_EM_LINHA
+#define TarefaEspera		TarefaEsperaLento
+#define SemaforoAguarda		SemaforoAguardaLento
+#define SemaforoLibera		SemaforoLiberaLento
+#endif
+
+#if defined(OTIMIZA_DESEMPENHO) && OTIMIZA_DESEMPENHO
+#pragma GCC optimize ("O2")
+#endif
+
+/* variaveis do sistema multitarefas */
+uint8_t 	   tarefa_atual, proxima_tarefa;
+tcb_t   	   TCB[NUMERO_DE_TAREFAS+1];
+tcb_t		  *tcb_atual = &TCB[0];		/* sempre &TCB[tarefa_atual] */
+#if cfg_TCB_SEPARADO
+uint8_t		   tcb_estado[NUMERO_DE_TAREFAS+1];
+prioridade_t   tcb_prioridade[NUMERO_DE_TAREFAS+1];
+uint8_t		   tcb_prox_espera[NUMERO_DE_TAREFAS+1];
+tick_t		   tcb_tempo_espera[NUMERO_DE_TAREFAS+1];
+#endif
+CHAMADA_POR_ASM stackptr_t ponteiro_de_pilha;
+uint8_t		   Prioridades[PRIORIDADE_MAXIMA+1];   /* vetor com a primeira tarefa da fila de prontas de cada prioridade */
+
+#if cfg_NOMES_TAREFAS
+/* nomes das tarefas, fora do TCB: so usados na depuracao */
+static const char *nomes_tarefas[NUMERO_DE_TAREFAS+1];
+#endif
+
+/* variavel auxiliar para guardar o numero de marcas de tempo */
+static tick_t contador_marcas = cfg_MARCA_INICIAL;
+
+#if cfg_MARCA_VARIAVEL
+/* marcas de tempo por segundo, trocada por MarcaTempoMudaFrequencia */
+static uint32_t marca_tempo_hz = cfg_MARCA_TEMPO_HZ;
+#define MARCA_TEMPO_HZ		marca_tempo_hz
+#else
+#define MARCA_TEMPO_HZ		cfg_MARCA_TEMPO_HZ
+#endif
+
+#if cfg_TEMPO_BLOQUEIO
+/* relogio do tempo bloqueado: o da placa ou as marcas de tempo */
+#ifdef cfg_TEMPO_BLOQUEIO_RELOGIO
+#define RELOGIO_BLOQUEIO()	((uint32_t)cfg_TEMPO_BLOQUEIO_RELOGIO())
+#else
+#define RELOGIO_BLOQUEIO()	((uint32_t)contador_marcas)
+#endif
+#endif
+
+#if cfg_OCIOSA_SEM_MARCAS
+/* marcas de tempo dormidas pela tarefa ociosa sem marcas (compensadas) */
+static tick_t marcas_dormidas = 0;
+#endif
+
+#ifdef cfg_RELOGIO_LIVRE
+/* contagens do relogio livre em uma marca e instante da ultima marca */
+#if cfg_MARCA_VARIAVEL
+static uint32_t contagens_relogio_marca = (uint32_t)((cfg_RELOGIO_LIVRE_HZ) / cfg_MARCA_TEMPO_HZ);
+#define CONTAGENS_RELOGIO_MARCA		contagens_relogio_marca
+#else
+#define CONTAGENS_RELOGIO_MARCA		((uint32_t)((cfg_RELOGIO_LIVRE_HZ) / cfg_MARCA_TEMPO_HZ))
+#endif
+static uint32_t relogio_ultima_marca;
+static uint8_t relogio_medindo = 0;
+#endif
+
+/* maior identificador de tarefa ja usado e lista de TCBs livres (tarefas 
+   terminadas), encadeada pelo campo proxima. Um TCB livre e reutilizado 
+   antes de se usar um novo, ambos em tempo constante */
+static uint8_t numero_tarefas = 0;
+static uint8_t tarefas_livres = 0;
+
+/* indica que IniciaMultitarefas ja foi chamada: a partir dai, uma tarefa 
+   criada com maior prioridade que a atual executa imediatamente */
+static uint8_t multitarefas_iniciado = 0;
+
+#if cfg_ARENA_PILHAS > 0
+/* arena de pilhas das tarefas dinamicas: blocos de tamanho fixo, com uma 
+   lista de blocos livres (indice + 1, 0 = vazia) e o numero de blocos ja 
+   usados alguma vez, para alocacao e liberacao em tempo constante */
+static uint32_t arena_pilhas[cfg_ARENA_PILHAS][cfg_TAM_BLOCO_PILHA];
+static uint8_t  prox_bloco_livre[cfg_ARENA_PILHAS];
+static uint8_t  blocos_livres = 0;
+static uint8_t  blocos_usados = 0;
+
+#if cfg_ARENA_PILHAS > 254
+#error "cfg_ARENA_PILHAS deve ser no maximo 254"
+#endif
+#endif
+
+#if cfg_PILHA_TAREFAS_BASICAS > 0
+/* pilha compartilhada das tarefas basicas e a ultima tarefa basica 
+   iniciada (0 = nenhuma), cujo contexto e o mais baixo da pilha */
+static uint32_t pilha_basicas[cfg_PILHA_TAREFAS_BASICAS];
+static uint8_t  basica_topo = 0;
+uint8_t contexto_descartado = 0;
+
+/* primeiro endereco abaixo do que uma tarefa suspensa usa da sua pilha, 
+   dado o stack pointer guardado. A porta redefine se o contexto nao fica 
+   no fim da parte usada (ex.: posix) */
+#ifndef FIM_PILHA_USADA
+#define FIM_PILHA_USADA(sp)		(sp)
+#endif
+#endif
+
+/* mapa de bits das prioridades prontas: o bit N em 1 indica que a 
+   fila de prontas da prioridade N nao esta vazia */
+static uint32_t mapa_prontas = 0;
+
+#if cfg_ESCALONADOR_EDF
+/* heap binario das tarefas prontas, ordenado pelo prazo absoluto e, no 
+   empate, pela prioridade: heap_prontas[0] e a proxima a executar. As 
+   filas por prioridade continuam mantidas para a fatia de tempo e o 
+   modo ocioso */
+static uint8_t heap_prontas[NUMERO_DE_TAREFAS];
+static uint8_t tamanho_heap = 0;
+#endif
+
+/* lista das tarefas esperando por tempo, ordenada pelo instante de 
+   despertar. Cada tarefa guarda em tempo_espera apenas a diferenca (delta) 
+   em relacao a tarefa anterior, assim a marca de tempo so atualiza a 
+   primeira tarefa da lista */
+static uint8_t lista_espera = 0;
+
+/* valor de prox_espera das tarefas que nao estao na lista de espera */
+#define FORA_DA_LISTA	0xFF
+
+#if cfg_GANCHOS_OCIOSA > 0
+/* ganchos chamados em rodizio pela tarefa ociosa */
+static gancho_ociosa_t ganchos_ociosa[cfg_GANCHOS_OCIOSA];
+static volatile uint8_t numero_ganchos_ociosa = 0;
+
+#if cfg_GANCHOS_OCIOSA > 255
+#error "cfg_GANCHOS_OCIOSA deve ser no maximo 255"
+#endif
+#endif
+
+#if cfg_FILA_TRABALHOS > 0
+/* fila circular dos trabalhos agendados pelas interrupcoes e tarefa que os executa */
+typedef struct
+{
+	funcao_trabalho_t	funcao;
+	void				*arg;
+} trabalho_t;
+
+static trabalho_t fila_trabalhos[cfg_FILA_TRABALHOS];
+static uint8_t inicio_trabalhos = 0;
+static uint8_t quantidade_trabalhos = 0;
+static uint16_t trabalhos_perdidos = 0;
+static uint8_t id_tarefa_trabalhos = 0;
+
+#if cfg_FILA_TRABALHOS > 255
+#error "cfg_FILA_TRABALHOS deve ser no maximo 255"
+#endif
+#endif
+
+#if cfg_OBJETOS_ATIVOS > 0
+/* grupos de objetos ativos: os objetos por prioridade, um bit por objeto 
+   com eventos na fila e a tarefa que executa o grupo (0 = ainda nao 
+   iniciada) */
+typedef struct
+{
+	objeto_ativo_t	*objetos[cfg_OBJETOS_POR_GRUPO];
+	uint8_t			prontos;
+	uint8_t			tarefa;
+} grupo_objetos_t;
+
+static grupo_objetos_t grupos_objetos[cfg_OBJETOS_ATIVOS];
+
+#if cfg_OBJETOS_POR_GRUPO > 8
+#error "cfg_OBJETOS_POR_GRUPO deve ser no maximo 8"
+#endif
+#endif
+
+#if cfg_TEMPORIZADORES
+/* roda de temporizadores: cada posicao e uma lista duplamente encadeada 
+   dos temporizadores com vencimento & MASCARA_RODA igual a posicao, assim 
+   ligar, desligar e encontrar os que vencem na marca atual nao dependem 
+   do numero total de temporizadores */
+#define MASCARA_RODA	(cfg_RODA_TEMPORIZADORES - 1)
+
+#if (cfg_RODA_TEMPORIZADORES & MASCARA_RODA) != 0
+#error "cfg_RODA_TEMPORIZADORES deve ser potencia de 2"
+#endif
+
+static temporizador_t *roda_temporizadores[cfg_RODA_TEMPORIZADORES];
+static uint8_t temporizadores_ativos = 0;
+
+/* tarefa que executa os temporizadores (0 = ainda nao iniciada) e ultima 
+   marca de tempo ja tratada por ela */
+static uint8_t id_tarefa_temporizadores = 0;
+static tick_t marca_temporizadores = cfg_MARCA_INICIAL;
+#endif
+
+#if cfg_REGISTRO_OBJETOS
+/* objetos registrados, na ordem do registro */
+static registro_objeto_t *objetos_registrados = 0;
+#endif
+
+/* palavras reservadas no inicio de cada pilha para o canario */
+#if cfg_VERIFICA_PILHA
+#define PALAVRAS_CANARIO	1
+#else
+#define PALAVRAS_CANARIO	0
+#endif
+
+#if cfg_FATIA_TEMPO > 0
+/* marcas de tempo restantes da fatia de tempo da tarefa atual */
+static uint16_t fatia_restante = cfg_FATIA_TEMPO;
+#endif
+
+#if cfg_ESTATISTICAS
+/* instantes (em ciclos) do inicio do sistema e da entrada da tarefa atual em execucao */
+static uint64_t inicio_sistema = 0;
+static uint64_t inicio_execucao = 0;
+#endif
+
+#if cfg_ENERGIA
+/* custo por ciclo do clock atual e energia gasta dormindo, em pJ */
+static uint32_t custo_ciclo = cfg_CUSTO_CICLO;
+static uint64_t energia_sono = 0;
+#endif
+
+#if cfg_RASTRO > 0
+/* anel do rastro e numero total de registros gravados, que conta sem parar */
+RASTRO_RETIDO registro_rastro_t	rastro_nucleo[cfg_RASTRO];
+RASTRO_RETIDO volatile uint16_t	rastro_total;
+
+/* durante RastroDescarrega os eventos nao sao gravados */
+static uint8_t rastro_pausado = 0;
+
+#define MASCARA_RASTRO	(cfg_RASTRO - 1)
+
+#if (cfg_RASTRO & MASCARA_RASTRO) != 0 || cfg_RASTRO > 32768
+#error "cfg_RASTRO deve ser potencia de 2, no maximo 32768"
+#endif
+
+/* ciclos desde a ultima marca de tempo, definido pela porta da cpu. 
+   Sem ele, o rastro tem so a resolucao da marca de tempo */
+#ifndef RASTRO_SUBMARCA
+#define RASTRO_SUBMARCA()		0
+#endif
+
+#define RASTRO(evento, tarefa, dado)	Rastro((evento), (tarefa), (uint16_t)(dado))
+#else
+#define RASTRO(evento, tarefa, dado)
+#endif
+
+#if cfg_PERFIL > 0
+/* anel do perfil e numero total de amostras gravadas, que conta sem parar */
+amostra_perfil_t	perfil_amostras[cfg_PERFIL];
+volatile uint32_t	perfil_total = 0;
+
+/* durante PerfilDescarrega as amostras nao sao gravadas */
+static uint8_t perfil_pausado = 0;
+
+#define MASCARA_PERFIL	(cfg_PERFIL - 1)
+
+#if (cfg_PERFIL & MASCARA_PERFIL) != 0
+#error "cfg_PERFIL deve ser potencia de 2"
+#endif
+#if cfg_PERFIL_INTERVALO < 1 || cfg_PERFIL_INTERVALO > 65535
+#error "cfg_PERFIL_INTERVALO deve ser de 1 a 65535 marcas"
+#endif
+#endif
+
+#if cfg_SERVICOS_EM_LINHA && cfg_RASTRO > 0
+#error "cfg_SERVICOS_EM_LINHA exige cfg_RASTRO = 0: o caminho rapido nao registra eventos"
+#endif
+
+#if PRIORIDADE_MAXIMA > 31
+#error "PRIORIDADE_MAXIMA deve ser no maximo 31 (mapa de prontas de 32 bits)"
+#endif
+
+#if cfg_VIGIA > 0
+/* janela de cada tarefa vigiada em marcas (0 = nao vigiada) e marcas que 
+   restam dela ate o proximo sinal */
+volatile uint8_t	vigia_sinal[NUMERO_DE_TAREFAS+1];
+static uint16_t		vigia_janela[NUMERO_DE_TAREFAS+1];
+static uint16_t		vigia_restante[NUMERO_DE_TAREFAS+1];
+
+/* marcas desde a ultima verificacao e primeira tarefa atrasada (0 = nenhuma) */
+static tick_t		vigia_decorridas = 0;
+static uint8_t		vigia_atrasada = 0;
+
+#if cfg_VIGIA > 65535
+#error "cfg_VIGIA deve ser no maximo 65535 marcas"
+#endif
+#endif
+
+#if cfg_INANICAO > 0
+/* marca em que cada tarefa passou a esperar pela CPU, maior espera e
+   esperas acima do limite. Uma espera so e contada uma vez (avisada) */
+static tick_t		pronta_desde[NUMERO_DE_TAREFAS+1];
+static tick_t		inanicao_maior[NUMERO_DE_TAREFAS+1];
+static uint16_t		inanicao_contadas[NUMERO_DE_TAREFAS+1];
+static uint8_t		inanicao_avisada[NUMERO_DE_TAREFAS+1];
+
+/* marcas desde a ultima verificacao */
+static tick_t		inanicao_decorridas = 0;
+
+#if cfg_INANICAO_PERIODO < 1
+#error "cfg_INANICAO_PERIODO deve ser de pelo menos 1 marca"
+#endif
+#endif
+
+#if cfg_INTERRUPCOES_ANINHADAS
+/* interrupcoes marcadas em execucao (aninhadas) e troca de contexto 
+   solicitada por elas, adiada ate a saida da mais externa */
+volatile uint8_t	nivel_interrupcao = 0;
+static uint8_t		troca_adiada = 0;
+#endif
+
+#if cfg_ORCAMENTO
+/* orcamento de cada tarefa por periodo, em marcas (0 = sem orcamento), 
+   marcas que restam dele, duracao e fim do periodo atual e prioridade 
+   quando esgotado (ORCAMENTO_SUSPENDE = suspensa) */
+static uint16_t		orcamento_marcas[NUMERO_DE_TAREFAS+1];
+static uint16_t		orcamento_restante[NUMERO_DE_TAREFAS+1];
+static uint16_t		orcamento_periodo[NUMERO_DE_TAREFAS+1];
+static tick_t		orcamento_reposicao[NUMERO_DE_TAREFAS+1];
+static prioridade_t	orcamento_esgotado[NUMERO_DE_TAREFAS+1];
+static uint8_t		orcamento_estourado[NUMERO_DE_TAREFAS+1];	/* 1 enquanto rebaixada ou suspensa */
+static uint16_t		orcamento_estouros[NUMERO_DE_TAREFAS+1];
+
+/* primeira reposicao entre as tarefas com orcamento: a marca de tempo so 
+   percorre as tarefas nela */
+static tick_t		proxima_reposicao;
+static uint8_t		tarefas_com_orcamento = 0;
+#endif
+
+/* codigo independente de hardware */
+
+#if cfg_RASTRO > 0
+/* grava um registro no anel do rastro, sobrescrevendo o mais antigo. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static void Rastro(uint8_t evento, uint8_t tarefa, uint16_t dado)
+{
+	registro_rastro_t *registro;
+	
+	if(rastro_pausado)
+	{
+		return;
+	}
+	
+	registro = &rastro_nucleo[rastro_total & MASCARA_RASTRO];
+	rastro_total++;
+	#ifdef cfg_RASTRO_TEMPO
+	registro->tempo = cfg_RASTRO_TEMPO();
+	#else
+	registro->tempo = ((uint32_t)contador_marcas << 16) | (uint16_t)RASTRO_SUBMARCA();
+	#endif
+	registro->evento = evento;
+	registro->tarefa = tarefa;
+	registro->dado = dado;
+}
+#endif
+
+/* tabelas lidas pelo caminho critico: com cfg_NUCLEO_NA_RAM ficam na RAM 
+   (.data), junto com o codigo */
+#if cfg_NUCLEO_NA_RAM
+#define CONST_RAPIDA
+#else
+#define CONST_RAPIDA	const
+#endif
+
+#ifndef MAIOR_BIT_ATIVO
+/* retorna a posicao do bit mais significativo em 1 (mapa != 0). 
+   Busca binaria com tempo constante, pois o Cortex-M0+ nao possui CLZ. 
+   Expandida no escalonador, entao fica na mesma secao que ele */
+static inline uint8_t maior_bit_ativo(uint32_t mapa)
+{
+	static CONST_RAPIDA uint8_t tabela[16] = {0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3};
+	uint8_t bit = 0;
+	
+	if(mapa & 0xFFFF0000UL)
+	{
+		mapa >>= 16;
+		bit += 16;
+	}
+	if(mapa & 0x0000FF00UL)
+	{
+		mapa >>= 8;
+		bit += 8;
+	}
+	if(mapa & 0x000000F0UL)
+	{
+		mapa >>= 4;
+		bit += 4;
+	}
+	return bit + tabela[mapa];
+}
+#define MAIOR_BIT_ATIVO(mapa)	maior_bit_ativo(mapa)
+#endif
+
+#if cfg_ESCALONADOR_EDF
+/* 1 se a tarefa a deve executar antes da b: prazo menor (comparacao sem 
+   sinal, correta com o retorno a 0), sem prazo depois de com prazo e, 
+   no empate, a de maior prioridade */
+static uint8_t PrecedeEDF(uint8_t a, uint8_t b)
+{
+	if(TCB[a].tem_prazo != TCB[b].tem_prazo)
+	{
+		return TCB[a].tem_prazo;
+	}
+	if(TCB[a].tem_prazo && TCB[a].prazo != TCB[b].prazo)
+	{
+		return (int32_t)(TCB[a].prazo - TCB[b].prazo) < 0;
+	}
+	return TCB_PRIORIDADE(a) > TCB_PRIORIDADE(b);
+}
+
+/* coloca a tarefa na posicao do heap e atualiza o seu indice */
+static void PosicionaNoHeap(uint8_t tarefa, uint8_t posicao)
+{
+	heap_prontas[posicao] = tarefa;
+	TCB[tarefa].posicao_heap = posicao;
+}
+
+/* move a tarefa da posicao para cima ou para baixo ate restaurar a ordem do heap */
+static void ReordenaHeap(uint8_t posicao)
+{
+	uint8_t tarefa = heap_prontas[posicao];
+	uint8_t filho;
+	
+	while(posicao > 0 && PrecedeEDF(tarefa, heap_prontas[(posicao - 1) / 2]))
+	{
+		PosicionaNoHeap(heap_prontas[(posicao - 1) / 2], posicao);
+		posicao = (posicao - 1) / 2;
+	}
+	
+	for(;;)
+	{
+		filho = (uint8_t)(2 * posicao + 1);
+		if(filho >= tamanho_heap)
+		{
+			break;
+		}
+		if(filho + 1 < tamanho_heap && PrecedeEDF(heap_prontas[filho + 1], heap_prontas[filho]))
+		{
+			filho++;
+		}
+		if(!PrecedeEDF(heap_prontas[filho], tarefa))
+		{
+			break;
+		}
+		PosicionaNoHeap(heap_prontas[filho], posicao);
+		posicao = filho;
+	}
+	
+	PosicionaNoHeap(tarefa, posicao);
+}
+
+static void InsereNoHeap(uint8_t tarefa)
+{
+	PosicionaNoHeap(tarefa, tamanho_heap++);
+	ReordenaHeap(TCB[tarefa].posicao_heap);
+}
+
+/* a ultima tarefa do heap ocupa o lugar da retirada e e reposicionada */
+static void RetiraDoHeap(uint8_t tarefa)
+{
+	uint8_t posicao = TCB[tarefa].posicao_heap;
+	
+	if(--tamanho_heap != posicao)
+	{
+		PosicionaNoHeap(heap_prontas[tamanho_heap], posicao);
+		ReordenaHeap(posicao);
+	}
+}
+#endif
+
+/* coloca a tarefa no fim da fila de prontas da sua prioridade. 
+   As filas sao listas circulares duplamente encadeadas (campos proxima 
+   e anterior do TCB), cuja primeira tarefa fica em Prioridades[] */
+static void TarefaPronta(uint8_t tarefa)
+{
+	prioridade_t prioridade = TCB_PRIORIDADE(tarefa);
+	uint8_t primeira = Prioridades[prioridade];
+	uint8_t ultima;
+	
+	if(TCB_ESTADO(tarefa) == PRONTA)
+	{
+		return;		/* ja esta na fila de prontas */
+	}
+	TCB_ESTADO(tarefa) = PRONTA;
+	#if cfg_INANICAO > 0
+	if(TCB_PRIORIDADE(tarefa) != 0)		/* a ociosa nao e medida */
+	{
+		pronta_desde[tarefa] = contador_marcas;
+	}
+	#endif
+
+	if(primeira == 0)
+	{
+		/* fila vazia: a tarefa e a unica da sua prioridade */
+		TCB[tarefa].proxima = tarefa;
+		TCB[tarefa].anterior = tarefa;
+		Prioridades[prioridade] = tarefa;
+		mapa_prontas |= (1UL << prioridade);
+	}else
+	{
+		ultima = TCB[primeira].anterior;
+		TCB[tarefa].proxima = primeira;
+		TCB[tarefa].anterior = ultima;
+		TCB[ultima].proxima = tarefa;
+		TCB[primeira].anterior = tarefa;
+	}
+	
+	#if cfg_ESCALONADOR_EDF
+	InsereNoHeap(tarefa);
+	#endif
+}
+
+/* coloca a tarefa em espera, retirando-a da fila de prontas */
+static void TarefaBloqueia(uint8_t tarefa)
+{
+	prioridade_t prioridade = TCB_PRIORIDADE(tarefa);
+	
+	if(TCB_ESTADO(tarefa) != PRONTA)
+	{
+		return;		/* ja esta em espera */
+	}
+	TCB_ESTADO(tarefa) = ESPERA;
+	
+	if(TCB[tarefa].proxima == tarefa)
+	{
+		/* era a unica tarefa pronta da sua prioridade */
+		Prioridades[prioridade] = 0;
+		mapa_prontas &= ~(1UL << prioridade);
+	}else
+	{
+		TCB[TCB[tarefa].anterior].proxima = TCB[tarefa].proxima;
+		TCB[TCB[tarefa].proxima].anterior = TCB[tarefa].anterior;
+		if(Prioridades[prioridade] == tarefa)
+		{
+			Prioridades[prioridade] = TCB[tarefa].proxima;
+		}
+	}
+	
+	#if cfg_ESCALONADOR_EDF
+	RetiraDoHeap(tarefa);
+	#endif
+}
+
+/* insere a tarefa na lista de espera para despertar apos qtas_marcas. 
+   Tarefas com o mesmo instante de despertar ficam na ordem de insercao */
+static void InsereNaListaDeEspera(uint8_t tarefa, tick_t qtas_marcas)
+{
+	uint8_t *anterior = &lista_espera;
+	
+	while(*anterior != 0 && TCB_TEMPO_ESPERA(*anterior) <= qtas_marcas)
+	{
+		qtas_marcas -= TCB_TEMPO_ESPERA(*anterior);
+		anterior = &TCB_PROX_ESPERA(*anterior);
+	}
+	
+	TCB_TEMPO_ESPERA(tarefa) = qtas_marcas;
+	TCB_PROX_ESPERA(tarefa) = *anterior;
+	if(*anterior != 0)
+	{
+		TCB_TEMPO_ESPERA(*anterior) -= qtas_marcas;	/* a seguinte passa a contar a partir desta */
+	}
+	*anterior = tarefa;
+}
+
+/* retira a tarefa da lista de espera, caso esteja nela */
+static void RetiraDaListaDeEspera(uint8_t tarefa)
+{
+	uint8_t *anterior = &lista_espera;
+	
+	if(TCB_PROX_ESPERA(tarefa) == FORA_DA_LISTA)
+	{
+		return;
+	}
+	
+	while(*anterior != tarefa)
+	{
+		anterior = &TCB_PROX_ESPERA(*anterior);
+	}
+	
+	*anterior = TCB_PROX_ESPERA(tarefa);
+	if(*anterior != 0)
+	{
+		TCB_TEMPO_ESPERA(*anterior) += TCB_TEMPO_ESPERA(tarefa);	/* devolve o delta a seguinte */
+	}
+	TCB_PROX_ESPERA(tarefa) = FORA_DA_LISTA;
+	TCB_TEMPO_ESPERA(tarefa) = 0;
+}
+
+/* insere a tarefa na lista de espera de um objeto (ex.: semaforo), 
+   ordenada da maior para a menor prioridade. Tarefas de mesma 
+   prioridade ficam na ordem de chegada */
+static void InsereNaListaDeEvento(uint8_t *lista, uint8_t tarefa)
+{
+	prioridade_t prioridade = TCB_PRIORIDADE(tarefa);
+	
+	TCB[tarefa].lista_evento = lista;	/* guarda o inicio da lista, para poder sair dela depois */
+	
+	while(*lista != 0 && TCB_PRIORIDADE(*lista) >= prioridade)
+	{
+		lista = &TCB[*lista].prox_evento;
+	}
+	
+	TCB[tarefa].prox_evento = *lista;
+	*lista = tarefa;
+}
+
+/* retira e retorna a primeira tarefa (maior prioridade) da lista de 
+   espera de um objeto, ou 0 se a lista estiver vazia */
+static uint8_t RetiraDaListaDeEvento(uint8_t *lista)
+{
+	uint8_t tarefa = *lista;
+	
+	if(tarefa != 0)
+	{
+		*lista = TCB[tarefa].prox_evento;
+		TCB[tarefa].prox_evento = 0;
+		TCB[tarefa].lista_evento = 0;
+	}
+	return tarefa;
+}
+
+/* retira a primeira tarefa da lista de espera de um objeto e a coloca na 
+   fila de prontas, cancelando o limite de tempo da espera, se houver. 
+   Retorna a tarefa, ou 0 se a lista estiver vazia */
+static uint8_t AcordaDaListaDeEvento(uint8_t *lista)
+{
+	uint8_t tarefa = RetiraDaListaDeEvento(lista);
+	
+	if(tarefa != 0)
+	{
+		RetiraDaListaDeEspera(tarefa);
+		TarefaPronta(tarefa);
+	}
+	return tarefa;
+}
+
+/* bloqueia a tarefa atual na lista de espera de um objeto por no maximo 
+   qtas_marcas (ESPERA_INFINITA = sem limite). Se o tempo se esgotar, a 
+   marca de tempo a retira da lista do objeto. A troca de contexto acontece 
+   ao fim da regiao atomica em que deve ser chamada */
+static void AguardaEvento(uint8_t *lista, tick_t qtas_marcas)
+{
+	tcb_atual->tempo_esgotado = 0;
+	TarefaBloqueia(tarefa_atual);
+	InsereNaListaDeEvento(lista, tarefa_atual);
+	if(qtas_marcas != ESPERA_INFINITA)
+	{
+		InsereNaListaDeEspera(tarefa_atual, qtas_marcas);
+	}
+	TROCA_CONTEXTO();
+}
+
+#if cfg_TEMPO_BLOQUEIO
+/* soma uma espera de duracao contagens do relogio */
+static void SomaBloqueio(tempo_bloqueio_t *bloqueio, uint32_t duracao)
+{
+	uint8_t faixa = (duracao > 1) ? (uint8_t)MAIOR_BIT_ATIVO(duracao) : 0;
+	
+	if(faixa >= cfg_TEMPO_BLOQUEIO_FAIXAS)
+	{
+		faixa = cfg_TEMPO_BLOQUEIO_FAIXAS - 1;
+	}
+	bloqueio->total += duracao;
+	bloqueio->esperas++;
+	if(duracao > bloqueio->maior)
+	{
+		bloqueio->maior = duracao;
+	}
+	if(bloqueio->faixas[faixa] != 0xFFFF)
+	{
+		bloqueio->faixas[faixa]++;
+	}
+}
+
+/* conta no objeto e na tarefa atual a espera que comecou no instante 
+   inicio (RELOGIO_BLOQUEIO), ao voltar do bloqueio. Deve ser chamada com 
+   as interrupcoes desabilitadas */
+static void ContaBloqueio(tempo_bloqueio_t *objeto, uint32_t inicio)
+{
+	uint32_t duracao = RELOGIO_BLOQUEIO() - inicio;
+	
+	SomaBloqueio(objeto, duracao);
+	SomaBloqueio(&tcb_atual->bloqueio, duracao);
+}
+#endif
+
+/* retira uma tarefa qualquer da lista de espera do objeto em que esta bloqueada */
+static void RemoveDaListaDeEvento(uint8_t tarefa)
+{
+	uint8_t *lista = TCB[tarefa].lista_evento;
+	
+	if(lista == 0)
+	{
+		return;
+	}
+	
+	while(*lista != tarefa)
+	{
+		lista = &TCB[*lista].prox_evento;
+	}
+	RetiraDaListaDeEvento(lista);
+}
+
+/* coloca na fila de prontas a primeira tarefa da lista de espera, cujo 
+   tempo terminou, e retorna a nova primeira. Se a tarefa esperava por um 
+   objeto, sai tambem da lista dele, com tempo_esgotado = 1 */
+static uint8_t DespertaPrimeiraDaListaDeEspera(void)
+{
+	uint8_t tarefa = lista_espera;
+	
+	lista_espera = TCB_PROX_ESPERA(tarefa);
+	TCB_PROX_ESPERA(tarefa) = FORA_DA_LISTA;
+	if(TCB[tarefa].lista_evento != 0)
+	{
+		RemoveDaListaDeEvento(tarefa);
+		TCB[tarefa].tempo_esgotado = 1;
+	}
+	TarefaPronta(tarefa);
+	
+	return lista_espera;
+}
+
+#if cfg_ESCALONADOR_EDF
+/* altera o prazo de uma tarefa, reposicionando-a no heap se estiver pronta. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static void MudaPrazo(uint8_t tarefa, uint8_t tem_prazo, tick_t prazo)
+{
+	TCB[tarefa].tem_prazo = tem_prazo;
+	TCB[tarefa].prazo = prazo;
+	if(TCB_ESTADO(tarefa) == PRONTA)
+	{
+		ReordenaHeap(TCB[tarefa].posicao_heap);
+	}
+}
+#endif
+
+/* altera a prioridade efetiva de uma tarefa (heranca de prioridade e 
+   TarefaMudaPrioridade), reposicionando-a na fila de prontas ou na lista 
+   de espera do objeto em que esta bloqueada */
+static void MudaPrioridade(uint8_t tarefa, prioridade_t prioridade)
+{
+	uint8_t *lista = TCB[tarefa].lista_evento;
+	
+	if(TCB_ESTADO(tarefa) == PRONTA)
+	{
+		TarefaBloqueia(tarefa);
+		TCB_PRIORIDADE(tarefa) = prioridade;
+		TarefaPronta(tarefa);
+	}else if(lista != 0)
+	{
+		RemoveDaListaDeEvento(tarefa);
+		TCB_PRIORIDADE(tarefa) = prioridade;
+		InsereNaListaDeEvento(lista, tarefa);
+	}else
+	{
+		TCB_PRIORIDADE(tarefa) = prioridade;
+	}
+}
+
+/* funcao para realizar o escalonamento de tarefas por prioridades 
+   que retorna a proxima tarefa que sera executada, isto e, aquela que
+   tem a maior prioridade e que esta pronta para executar */
+   
+NUCLEO_RAPIDO uint8_t escalonador(void)
+{
+	/* a maior prioridade pronta e obtida diretamente do mapa de bits, 
+	   em tempo constante, e a tarefa escolhida e a primeira da fila de 
+	   prontas dessa prioridade. Caso nenhuma esteja pronta para executar, 
+	   retorna a de menor prioridade (bit 0), a qual sempre deve estar 
+	   pronta para executar */
+	#if cfg_ESCALONADOR_EDF
+	/* EDF: a tarefa no topo do heap, tambem em tempo constante */
+	if(tamanho_heap != 0)
+	{
+		return heap_prontas[0];
+	}
+	#endif
+	return Prioridades[MAIOR_BIT_ATIVO(mapa_prontas | 1UL)];
+}
+
+/* solicita a troca de contexto somente se o escalonador escolheria outra 
+   tarefa, por exemplo quando uma tarefa de maior prioridade ficou pronta. 
+   Evita executar o PendSV_Handler apenas para continuar na mesma tarefa. 
+   Dentro das interrupcoes marcadas com InterrupcaoEntra, so anota que a 
+   decisao deve ser tomada na saida da mais externa. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static void TrocaContextoSeNecessario(void)
+{
+	#if cfg_INTERRUPCOES_ANINHADAS
+	if(nivel_interrupcao != 0)
+	{
+		troca_adiada = 1;
+		return;
+	}
+	#endif
+	if(escalonador() != tarefa_atual)
+	{
+		TROCA_CONTEXTO();
+	}
+}
+
+#if cfg_INTERRUPCOES_ANINHADAS
+/* fim de uma interrupcao marcada com InterrupcaoEntra: na saida da mais 
+   externa, o escalonador decide uma vez so pelas tarefas acordadas por 
+   todas as interrupcoes aninhadas */
+void InterrupcaoSai(void)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	if(--nivel_interrupcao == 0 && troca_adiada)
+	{
+		troca_adiada = 0;
+		TrocaContextoSeNecessario();
+	}
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+
+/* preempcao pela marca de tempo: solicita a troca de contexto somente se 
+   ficou pronta uma tarefa com prioridade acima do limiar de preempcao da 
+   tarefa atual, evitando trocas que nao mudariam a tarefa em execucao. 
+   Com a heranca de prioridade, o limiar nunca fica abaixo da prioridade 
+   efetiva. Deve ser chamada com as interrupcoes desabilitadas */
+static void PreemptaSeNecessario(void)
+{
+	#if cfg_ESCALONADOR_EDF
+	TrocaContextoSeNecessario();	/* EDF: o prazo mais proximo sempre executa */
+	#else
+	prioridade_t limiar = tcb_atual->limiar_preempcao;
+	
+	if(limiar < TCB_ATUAL_PRIORIDADE())
+	{
+		limiar = TCB_ATUAL_PRIORIDADE();
+	}
+	if(MAIOR_BIT_ATIVO(mapa_prontas | 1UL) > limiar)
+	{
+		TROCA_CONTEXTO();
+	}
+	#endif
+}
+
+
+/* obtem um TCB para uma nova tarefa: reutiliza o de uma tarefa terminada 
+   ou usa o proximo ainda nao usado. Retorna 0 se nao houver. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static uint8_t AlocaTarefa(void)
+{
+	uint8_t tarefa = tarefas_livres;
+	
+	if(tarefa != 0)
+	{
+		tarefas_livres = TCB[tarefa].proxima;
+	}else if(numero_tarefas < NUMERO_DE_TAREFAS)
+	{
+		tarefa = ++numero_tarefas;		/* incrementa o numero de tarefas instaladas */
+	}
+	return tarefa;
+}
+
+/* devolve o TCB de uma tarefa terminada e o seu bloco de pilha da arena, 
+   se houver. Deve ser chamada com as interrupcoes desabilitadas */
+static void LiberaTarefa(uint8_t tarefa)
+{
+	#if cfg_ARENA_PILHAS > 0
+	uint8_t bloco = TCB[tarefa].bloco_pilha;
+	
+	if(bloco != 0)
+	{
+		prox_bloco_livre[bloco - 1] = blocos_livres;
+		blocos_livres = bloco;
+		TCB[tarefa].bloco_pilha = 0;
+	}
+	#endif
+	
+	TCB[tarefa].proxima = tarefas_livres;
+	tarefas_livres = tarefa;
+}
+
+#if cfg_MONITOR_PERIODICAS
+/* zera as ativacoes, os prazos perdidos e os atrasos da tarefa periodica */
+static void ZeraMonitor(uint8_t tarefa)
+{
+	TCB[tarefa].periodica.ativacoes = 0;
+	TCB[tarefa].periodica.prazos_perdidos = 0;
+	TCB[tarefa].periodica.atraso_minimo = 0;
+	TCB[tarefa].periodica.atraso_maximo = 0;
+	TCB[tarefa].periodica.atraso_total = 0;
+}
+#endif
+
+/* instala a tarefa em um TCB livre e a coloca na fila de prontas. 
+   bloco e o bloco da arena usado como pilha + 1, ou 0 para a pilha do usuario */
+static uint8_t InstalaTarefa(tarefa_t p, const char * nome,
+stackptr_t pilha, uint16_t tamanho, prioridade_t prioridade, uint8_t bloco)
+{
+	uint8_t tarefa;
+	reg_atomica_t estado;
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	/* tarefa basica: a pilha compartilhada e pintada uma vez so, em 
+	   IniciaMultitarefas, e o contexto so e criado quando a tarefa comeca */
+	uint8_t basica = (pilha == pilha_basicas);
+	#else
+	const uint8_t basica = 0;
+	#endif
+	
+	#if cfg_PINTA_PILHA
+	/* pinta a pilha inteira antes de criar o contexto, que ocupa o topo */
+	if(!basica)
+	{
+		uint16_t i;
+		for(i = 0; i < tamanho; i++)
+		{
+			pilha[i] = PADRAO_PILHA;
+		}
+	}
+	#endif
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	tarefa = AlocaTarefa();
+	if(tarefa == 0)
+	{
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	
+	#if cfg_PINTA_PILHA || cfg_VERIFICA_PILHA
+	TCB[tarefa].pilha = pilha;
+	#endif
+	#if cfg_PINTA_PILHA
+	TCB[tarefa].tamanho_pilha = tamanho;
+	#endif
+	#if cfg_VERIFICA_PILHA
+	pilha[0] = CANARIO_PILHA;
+	#endif
+	#if cfg_ARENA_PILHAS > 0
+	TCB[tarefa].bloco_pilha = bloco;
+	#else
+	(void)bloco;
+	#endif
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	TCB[tarefa].funcao_basica = basica ? p : 0;
+	TCB[tarefa].iniciada = 0;
+	TCB[tarefa].ativacoes = 0;
+	#endif
+	
+	if(!basica)
+	{
+		pilha = CriaContexto(p, pilha + tamanho);
+	}
+
+	/* guardar os dados no bloco de controle da tarefa (TCB) */
+	#if cfg_NOMES_TAREFAS
+	nomes_tarefas[tarefa] = nome;
+	#else
+	(void)nome;
+	#endif
+	TCB[tarefa].stack_pointer = (stackptr_t)(pilha);
+	TCB_PRIORIDADE(tarefa) = prioridade;
+	TCB[tarefa].prioridade_base = prioridade;
+	TCB[tarefa].mutexes = 0;
+	#if cfg_PREEMPTIVO
+	TCB[tarefa].limiar_preempcao = prioridade;			/* preemptiva */
+	#else
+	TCB[tarefa].limiar_preempcao = PRIORIDADE_MAXIMA;	/* cooperativa */
+	#endif
+	TCB_TEMPO_ESPERA(tarefa) = 0;
+	TCB_PROX_ESPERA(tarefa) = FORA_DA_LISTA;
+	TCB[tarefa].prox_evento = 0;
+	TCB[tarefa].lista_evento = 0;
+	TCB[tarefa].notificacao = 0;
+	TCB[tarefa].esperando_notificacao = 0;
+	#if cfg_CEDE_DIRETO
+	TCB[tarefa].cedida = 0;
+	#endif
+	#if cfg_ESTATISTICAS
+	TCB[tarefa].tempo_execucao = 0;
+	TCB[tarefa].trocas = 0;
+	TCB[tarefa].preempcoes = 0;
+	#endif
+	#if cfg_ENERGIA
+	TCB[tarefa].energia = 0;
+	#endif
+	#if cfg_MONITOR_PERIODICAS
+	ZeraMonitor(tarefa);
+	#endif
+	#if cfg_TEMPO_BLOQUEIO
+	TempoBloqueioZera(&TCB[tarefa].bloqueio);
+	#endif
+	#if cfg_INANICAO > 0
+	inanicao_maior[tarefa] = 0;
+	inanicao_contadas[tarefa] = 0;
+	inanicao_avisada[tarefa] = 0;
+	#endif
+	#if cfg_ESCALONADOR_EDF
+	TCB[tarefa].prazo = 0;
+	TCB[tarefa].tem_prazo = 0;
+	#endif
+	#if cfg_PINOS_RASTRO
+	TCB[tarefa].pinos_rastro = 0;
+	#endif
+	TCB_ESTADO(tarefa) = ESPERA;
+	
+	/* coloca a tarefa na fila de prontas da sua prioridade, 
+	   permitindo varias tarefas com a mesma prioridade. A tarefa basica 
+	   fica em espera ate a primeira ativacao */
+	if(!basica)
+	{
+		TarefaPronta(tarefa);
+		
+		if(multitarefas_iniciado)
+		{
+			TrocaContextoSeNecessario();	/* criada em tempo de execucao com maior prioridade */
+		}
+	}
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return tarefa;
+}
+
+/*********************************************/
+/* cria uma tarefa com a pilha fornecida pelo usuario e retorna o seu 
+   identificador, ou 0 se nao houver TCB livre ou os parametros forem 
+   invalidos. Pode ser chamada antes ou depois de IniciaMultitarefas, 
+   mas nao em interrupcoes */
+uint8_t CriaTarefa(tarefa_t p, const char * nome,
+stackptr_t pilha, uint16_t tamanho, prioridade_t prioridade)
+{
+	
+	if(tamanho < TAM_MINIMO_PILHA + PALAVRAS_CANARIO)
+	{
+		return 0;
+	}
+	
+	if(prioridade > PRIORIDADE_MAXIMA)
+	{
+		return 0;
+	}
+	
+	return InstalaTarefa(p, nome, pilha, tamanho, prioridade, 0);
+
+}
+
+/* cria as tarefas de uma tabela estatica de tarefas (ver TAREFAS_DECLARA), 
+   na ordem da tabela, e retorna quantas foram criadas */
+uint8_t CriaTarefasDaTabela(const descritor_tarefa_t *tabela, uint8_t numero)
+{
+	uint8_t i;
+	
+	for(i = 0; i < numero; i++)
+	{
+		if(CriaTarefa(tabela[i].funcao, tabela[i].nome, tabela[i].pilha, 
+			tabela[i].tamanho_pilha, tabela[i].prioridade) == 0)
+		{
+			break;		/* sem TCB livre */
+		}
+	}
+	return i;
+}
+
+#if cfg_OCIOSA_PILHA_PRINCIPAL
+/* cria a tarefa ociosa com tamanho palavras do fundo da pilha principal
+   (ver cfg_OCIOSA_PILHA_PRINCIPAL) e retorna o seu identificador, ou 0 se
+   a pilha principal, no ponto da chamada, ja chega a essa area. Chamada
+   em main, antes de IniciaMultitarefas */
+uint8_t CriaTarefaOciosa(uint16_t tamanho)
+{
+	stackptr_t pilha = PILHA_PRINCIPAL_FUNDO();
+
+	if((uintptr_t)PILHA_PRINCIPAL_ATUAL() <= (uintptr_t)(pilha + tamanho))
+	{
+		return 0;
+	}
+
+	return CriaTarefa(tarefa_ociosa, "Tarefa ociosa", pilha, tamanho, 0);
+}
+#endif
+
+#if cfg_ARENA_PILHAS > 0
+/* cria uma tarefa com um bloco de pilha de cfg_TAM_BLOCO_PILHA palavras da 
+   arena, para tarefas de curta duracao criadas e terminadas em tempo de 
+   execucao. Retorna o identificador da tarefa, ou 0 se nao houver bloco 
+   ou TCB livre */
+uint8_t CriaTarefaDinamica(tarefa_t p, const char * nome, prioridade_t prioridade)
+{
+	uint8_t bloco, tarefa;
+	reg_atomica_t estado;
+	
+	if(prioridade > PRIORIDADE_MAXIMA)
+	{
+		return 0;
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	bloco = blocos_livres;
+	if(bloco != 0)
+	{
+		blocos_livres = prox_bloco_livre[bloco - 1];
+	}else if(blocos_usados < cfg_ARENA_PILHAS)
+	{
+		bloco = ++blocos_usados;
+	}
+	REG_ATOMICA_FIM(estado);
+	
+	if(bloco == 0)
+	{
+		return 0;
+	}
+	
+	tarefa = InstalaTarefa(p, nome, arena_pilhas[bloco - 1], cfg_TAM_BLOCO_PILHA, prioridade, bloco);
+	if(tarefa == 0)
+	{
+		/* sem TCB livre: devolve o bloco */
+		REG_ATOMICA_INICIO(estado);
+		prox_bloco_livre[bloco - 1] = blocos_livres;
+		blocos_livres = bloco;
+		REG_ATOMICA_FIM(estado);
+	}
+	return tarefa;
+}
+#endif
+
+#if cfg_PILHA_TAREFAS_BASICAS > 0
+/* inicio de todas as tarefas basicas: executa a funcao da tarefa e, ao 
+   retorno, libera o contexto da pilha compartilhada. Com ativacoes 
+   pendentes a tarefa continua pronta e recomeca com um contexto novo; 
+   senao volta a espera. O contexto atual nunca e retomado */
+static void ExecutaTarefaBasica(void)
+{
+	reg_atomica_t estado;
+	
+	tcb_atual->funcao_basica();
+	
+	REG_ATOMICA_INICIO(estado);
+	tcb_atual->iniciada = 0;
+	basica_topo = tcb_atual->basica_abaixo;
+	if(tcb_atual->ativacoes != 0)
+	{
+		tcb_atual->ativacoes--;
+	}else
+	{
+		TarefaBloqueia(tarefa_atual);
+	}
+	TrocaContexto();
+	REG_ATOMICA_FIM(estado);
+	
+	for(;;)
+	{
+		/* nao chega aqui: a troca de contexto descarta este contexto */
+	}
+}
+
+/* cria o contexto da tarefa basica escolhida pelo escalonador logo abaixo 
+   do contexto da ultima tarefa basica iniciada, que tem prioridade menor. 
+   Retorna 0 se nao houver espaco na pilha compartilhada: a tarefa e 
+   suspensa, como no estouro de pilha. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static uint8_t IniciaTarefaBasica(uint8_t tarefa)
+{
+	stackptr_t topo = pilha_basicas + cfg_PILHA_TAREFAS_BASICAS;
+	
+	if(basica_topo != 0)
+	{
+		topo = FIM_PILHA_USADA(TCB[basica_topo].stack_pointer);
+	}
+	topo = (stackptr_t)((uintptr_t)topo & ~(uintptr_t)7);	/* alinhamento de 8 bytes da pilha */
+	
+	if(topo < pilha_basicas + TAM_MINIMO_PILHA + PALAVRAS_CANARIO)
+	{
+		#if cfg_VERIFICA_PILHA
+		cfg_ESTOURO_DE_PILHA(tarefa, TarefaNome(tarefa));
+		#endif
+		TarefaBloqueia(tarefa);
+		return 0;
+	}
+	
+	TCB[tarefa].stack_pointer = CriaContexto(ExecutaTarefaBasica, topo);
+	TCB[tarefa].iniciada = 1;
+	TCB[tarefa].basica_abaixo = basica_topo;
+	basica_topo = tarefa;
+	return 1;
+}
+
+/* cria uma tarefa basica, executada ate o fim na pilha compartilhada a cada 
+   ativacao (TarefaBasicaAtiva), e retorna o seu identificador, ou 0 se nao 
+   houver TCB livre. A funcao da tarefa retorna ao terminar e nunca bloqueia 
+   (sem TarefaEspera, SemaforoAguarda, FilaRecebe etc.), mas pode liberar 
+   semaforos, enviar para filas com as versoes ISR e ativar outras tarefas. 
+   A tarefa comeca em espera, ate a primeira ativacao */
+uint8_t CriaTarefaBasica(tarefa_t p, const char * nome, prioridade_t prioridade)
+{
+	if(prioridade > PRIORIDADE_MAXIMA)
+	{
+		return 0;
+	}
+	
+	return InstalaTarefa(p, nome, pilha_basicas, cfg_PILHA_TAREFAS_BASICAS, prioridade, 0);
+}
+
+/* ativa uma tarefa basica: se ja estiver pronta ou executando, a ativacao 
+   fica pendente e a tarefa executa de novo depois de terminar. Pode ser 
+   chamada por tarefas e interrupcoes; a troca de contexto, se necessaria, 
+   acontece ao fim da regiao atomica ou da interrupcao. Retorna 0 se a 
+   tarefa nao e basica ou ja tem 255 ativacoes pendentes */
+uint8_t TarefaBasicaAtiva(uint8_t id_tarefa)
+{
+	reg_atomica_t estado;
+	uint8_t ativou = 1;
+	
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas)
+	{
+		return 0;
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	if(TCB[id_tarefa].funcao_basica == 0 || TCB_ESTADO(id_tarefa) == TERMINADA)
+	{
+		ativou = 0;
+	}else if(TCB_ESTADO(id_tarefa) == PRONTA)
+	{
+		if(TCB[id_tarefa].ativacoes == 0xFF)
+		{
+			ativou = 0;
+		}else
+		{
+			TCB[id_tarefa].ativacoes++;
+		}
+	}else
+	{
+		TarefaPronta(id_tarefa);
+		TrocaContextoSeNecessario();	/* comeca agora se tem maior prioridade */
+	}
+	REG_ATOMICA_FIM(estado);
+	
+	return ativou;
+}
+#endif
+
+/* termina uma tarefa, retirando-a de todas as filas e listas de espera, e 
+   devolve o seu TCB e o seu bloco de pilha da arena, se houver. Retorna 1 
+   se terminou, ou 0 se a tarefa nao existe ou possui algum mutex, ja que a 
+   heranca de prioridade nao poderia ser desfeita. 
+   A tarefa pode terminar a si mesma com TarefaTermina(tarefa_atual), e nesse 
+   caso nao retorna: o TCB e a pilha so sao liberados na troca de contexto, 
+   quando a pilha deixa de ser usada. A tarefa ociosa nao deve ser terminada */
+uint8_t TarefaTermina(uint8_t id_tarefa)
+{
+	reg_atomica_t estado;
+	
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas)
+	{
+		return 0;
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(TCB_ESTADO(id_tarefa) == TERMINADA || TCB[id_tarefa].mutexes != 0)
+	{
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	if(TCB[id_tarefa].iniciada)
+	{
+		REG_ATOMICA_FIM(estado);
+		return 0;	/* tarefa basica em execucao: o seu contexto esta no meio da pilha compartilhada */
+	}
+	#endif
+	
+	TarefaBloqueia(id_tarefa);
+	RetiraDaListaDeEspera(id_tarefa);
+	RemoveDaListaDeEvento(id_tarefa);
+	TCB[id_tarefa].esperando_notificacao = 0;
+	TCB_ESTADO(id_tarefa) = TERMINADA;
+	#if cfg_VIGIA > 0
+	vigia_janela[id_tarefa] = 0;
+	#endif
+	#if cfg_ORCAMENTO
+	if(orcamento_marcas[id_tarefa] != 0)
+	{
+		orcamento_marcas[id_tarefa] = 0;
+		tarefas_com_orcamento--;
+	}
+	#endif
+	
+	if(id_tarefa != tarefa_atual)
+	{
+		LiberaTarefa(id_tarefa);
+	}
+	TrocaContextoSeNecessario();
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return 1;
+}
+
+
+/* Servicos do gerenciador de tarefas */
+
+/* Os servicos usam regioes atomicas aninhaveis (ver REG_ATOMICA_INICIO), 
+   podendo ser chamados com as interrupcoes desabilitadas. Nesse caso, a 
+   troca de contexto solicitada so acontece quando o chamador habilitar as 
+   interrupcoes, entao os servicos que bloqueiam a tarefa atual (esperas) 
+   nao devem ser chamados dentro de regioes atomicas */
+void TarefaSuspende(uint8_t id_tarefa)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	if(TCB[id_tarefa].iniciada)
+	{
+		REG_ATOMICA_FIM(estado);
+		return;		/* tarefa basica em execucao: so para ao terminar */
+	}
+	#endif
+	TarefaBloqueia(id_tarefa); 		/* tarefa colocada em espera */
+	TrocaContextoSeNecessario(); 	/* troca de contexto somente se a tarefa atual foi suspensa */
+	REG_ATOMICA_FIM(estado);
+}
+
+void TarefaContinua(uint8_t id_tarefa)
+{
+	TarefaContinuaISR(id_tarefa);		/* a troca pendente acontece ao fim da regiao atomica */
+}
+
+/* versao para rotinas de interrupcao: a troca de contexto, se necessaria, 
+   fica pendente no PendSV e acontece somente ao fim da interrupcao */
+void TarefaContinuaISR(uint8_t id_tarefa)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	if(TCB_ESTADO(id_tarefa) == TERMINADA)
+	{
+		REG_ATOMICA_FIM(estado);
+		return;
+	}
+	RetiraDaListaDeEspera(id_tarefa);		/* cancela uma espera por tempo, se houver */
+	TarefaPronta(id_tarefa);				/* tarefa colocada na fila de prontas */
+	TrocaContextoSeNecessario(); 			/* troca de contexto somente se ela tem maior prioridade */
+	REG_ATOMICA_FIM(estado);
+}
+
+void TarefaEspera(tick_t qtas_marcas)
+{
+	reg_atomica_t estado;
+	
+	if(qtas_marcas > 0)  //** so valores maiores que 0 */
+	{
+		REG_ATOMICA_INICIO(estado);			/* bloqueia interrupcoes */
+		RASTRO(RASTRO_ESPERA, tarefa_atual, qtas_marcas);
+		InsereNaListaDeEspera(tarefa_atual, qtas_marcas);	/* tarefa colocada na lista de espera, ordenada pelo tempo */
+		TarefaBloqueia(tarefa_atual);						/* tarefa retirada da fila de prontas */
+		TrocaContexto(); 	 /* tarefa atual solicita troca de contexto */
+		REG_ATOMICA_FIM(estado);   /* desbloqueia interrupcoes: a troca acontece aqui, so retorna quando ficar pronta novamente */
+	}
+}
+
+/* cede o processador a proxima tarefa pronta da mesma prioridade, e a
+   tarefa atual vai para o fim da fila da sua prioridade, como no fim da
+   fatia de tempo. Sem outra tarefa pronta da mesma prioridade, retorna
+   sem troca de contexto */
+void TarefaCede(void)
+{
+	reg_atomica_t estado;
+	prioridade_t prioridade;
+	
+	REG_ATOMICA_INICIO(estado);
+	prioridade = TCB_ATUAL_PRIORIDADE();
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	/* a tarefa basica executa ate o fim (ver a fatia de tempo) */
+	if(tcb_atual->funcao_basica == 0 &&
+		Prioridades[prioridade] == tarefa_atual && tcb_atual->proxima != tarefa_atual)
+	#else
+	if(Prioridades[prioridade] == tarefa_atual && tcb_atual->proxima != tarefa_atual)
+	#endif
+	{
+		Prioridades[prioridade] = tcb_atual->proxima;
+		#if cfg_CEDE_DIRETO
+		/* a proxima tambem cedeu: troca aqui mesmo, sem o PendSV, e 
+		   continua quando for escolhida de novo */
+		if(PODE_CEDER_DIRETO(estado) && TCB[escalonador()].cedida)
+		{
+			CEDE_DIRETO();
+		}
+		else
+		#endif
+		{
+			TrocaContexto();	/* acontece ao fim da regiao atomica */
+		}
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+#if cfg_TEMPORIZADORES
+/* retorna quantas marcas de tempo faltam, a partir de marca, para o 
+   vencimento mais proximo, ou ESPERA_INFINITA se nenhum temporizador esta 
+   ligado. Percorre todos os temporizadores ligados; a distancia e sem 
+   sinal, correta mesmo com o retorno a 0. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static tick_t MarcasAteVencimento(tick_t marca)
+{
+	temporizador_t *temporizador;
+	tick_t marcas = ESPERA_INFINITA;
+	uint16_t posicao;
+	
+	for(posicao = 0; posicao < cfg_RODA_TEMPORIZADORES; posicao++)
+	{
+		for(temporizador = roda_temporizadores[posicao]; temporizador != 0; temporizador = temporizador->proximo)
+		{
+			tick_t distancia = temporizador->vencimento - marca;
+			
+			if(distancia < marcas)
+			{
+				marcas = distancia;
+			}
+		}
+	}
+	return marcas;
+}
+#endif
+
+#if cfg_OCIOSA_SEM_MARCAS
+/* retorna quantas marcas de tempo a tarefa ociosa pode dormir, 
+   isto e, ate o despertar da primeira tarefa da lista de espera, 
+   ou 0 se houver outra tarefa pronta para executar. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static tick_t MarcasParaDormir(void)
+{
+	uint8_t ociosa = Prioridades[0];
+	tick_t marcas;
+	
+	if(mapa_prontas != (1UL << 0) || TCB[ociosa].proxima != ociosa)
+	{
+		return 0;	/* alguma outra tarefa esta pronta */
+	}
+	
+	if(lista_espera == 0)
+	{
+		marcas = (tick_t)~0;	/* ninguem esperando por tempo, dorme o maximo possivel */
+	}
+	else
+	{
+		marcas = TCB_TEMPO_ESPERA(lista_espera);
+	}
+	
+	#if cfg_TEMPORIZADORES
+	/* acorda no vencimento mais proximo, e nao na proxima posicao ocupada 
+	   da roda: com um temporizador longo ligado, acordaria a cada volta */
+	if(temporizadores_ativos != 0)
+	{
+		tick_t distancia = MarcasAteVencimento(contador_marcas);
+		
+		if(distancia < marcas)
+		{
+			marcas = distancia;
+		}
+	}
+	#endif
+	
+	return marcas;
+}
+#endif
+
+/* espera ate o instante absoluto *ultimo_despertar + periodo e atualiza 
+   *ultimo_despertar com esse instante. Usada em tarefas periodicas, 
+   pois o periodo nao acumula o tempo de execucao da tarefa (sem deriva). 
+   Se o instante ja passou, retorna imediatamente */
+void TarefaEsperaAte(tick_t *ultimo_despertar, tick_t periodo)
+{
+	tick_t qtas_marcas;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	*ultimo_despertar += periodo;						/* proximo instante de despertar */
+	qtas_marcas = *ultimo_despertar - contador_marcas;	/* aritmetica sem sinal: correta mesmo com o retorno a 0 */
+	
+	#if cfg_ESCALONADOR_EDF
+	/* o prazo da proxima execucao e o fim do proximo periodo */
+	MudaPrazo(tarefa_atual, 1, *ultimo_despertar + periodo);
+	#endif
+	
+	if(qtas_marcas > 0 && qtas_marcas <= periodo)
+	{
+		InsereNaListaDeEspera(tarefa_atual, qtas_marcas);
+		TarefaBloqueia(tarefa_atual);
+		TrocaContexto();
+	}
+	#if cfg_MONITOR_PERIODICAS
+	else if(qtas_marcas > periodo)
+	{
+		/* o instante de liberacao ja passou: a execucao anterior passou do periodo */
+		tcb_atual->periodica.prazos_perdidos++;
+		#ifdef cfg_PRAZO_PERDIDO
+		cfg_PRAZO_PERDIDO(tarefa_atual, contador_marcas - *ultimo_despertar);
+		#endif
+	}
+	#endif
+	
+	REG_ATOMICA_FIM(estado);	/* se bloqueada, so retorna quando ficar pronta novamente */
+	
+	#if cfg_MONITOR_PERIODICAS
+	/* atraso da liberacao: da marca esperada ate a tarefa voltar a executar */
+	REG_ATOMICA_INICIO(estado);
+	{
+		monitor_periodica_t *monitor = &tcb_atual->periodica;
+		tick_t atraso = contador_marcas - *ultimo_despertar;
+		
+		if(monitor->ativacoes == 0 || atraso < monitor->atraso_minimo)
+		{
+			monitor->atraso_minimo = atraso;
+		}
+		if(atraso > monitor->atraso_maximo)
+		{
+			monitor->atraso_maximo = atraso;
+		}
+		monitor->atraso_total += atraso;
+		monitor->ativacoes++;
+	}
+	REG_ATOMICA_FIM(estado);
+	#endif
+}
+
+/* muda o limiar de preempcao da tarefa: a marca de tempo so a preempta 
+   quando fica pronta uma tarefa de prioridade maior que limiar. 
+   limiar = prioridade da tarefa torna a tarefa preemptiva, e 
+   limiar = PRIORIDADE_MAXIMA a torna cooperativa, cedendo o processador 
+   somente ao bloquear. As tarefas acordadas por outras tarefas ou por 
+   interrupcoes (ex.: SemaforoLiberaISR) continuam executando imediatamente */
+void TarefaLimiarPreempcao(uint8_t id_tarefa, prioridade_t limiar)
+{
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas)
+	{
+		return;
+	}
+	if(limiar > PRIORIDADE_MAXIMA)
+	{
+		limiar = PRIORIDADE_MAXIMA;
+	}
+	TCB[id_tarefa].limiar_preempcao = limiar;	/* escrita de 8 bits e atomica */
+}
+
+/* muda a prioridade da tarefa em tempo de execucao, em tempo constante: 
+   a tarefa troca de fila de prontas (ou de posicao na lista de espera do 
+   objeto em que esta bloqueada) pelo mesmo caminho da heranca de 
+   prioridade. A tarefa preemptiva continua preemptiva na nova prioridade. 
+   Enquanto a tarefa possui mutexes, a prioridade efetiva so sobe: a 
+   reducao acontece ao liberar o ultimo, pois uma tarefa que espera por 
+   eles pode depender da prioridade atual. Retorna 0 se a tarefa e invalida 
+   ou e uma tarefa basica ja iniciada, cuja posicao na pilha compartilhada 
+   depende da prioridade */
+uint8_t TarefaMudaPrioridade(uint8_t id_tarefa, prioridade_t prioridade)
+{
+	reg_atomica_t estado;
+	
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas || prioridade > PRIORIDADE_MAXIMA)
+	{
+		return 0;
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	if(TCB_ESTADO(id_tarefa) == TERMINADA)
+	{
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	if(TCB[id_tarefa].funcao_basica != 0 && TCB[id_tarefa].iniciada)
+	{
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	#endif
+	
+	if(TCB[id_tarefa].limiar_preempcao == TCB[id_tarefa].prioridade_base)
+	{
+		TCB[id_tarefa].limiar_preempcao = prioridade;
+	}
+	TCB[id_tarefa].prioridade_base = prioridade;
+	if(TCB[id_tarefa].mutexes == 0 || prioridade > TCB_PRIORIDADE(id_tarefa))
+	{
+		MudaPrioridade(id_tarefa, prioridade);
+	}
+	TrocaContextoSeNecessario();
+	REG_ATOMICA_FIM(estado);
+	return 1;
+}
+
+#if cfg_ESCALONADOR_EDF
+/* define o prazo da tarefa para daqui a qtas_marcas, para tarefas 
+   esporadicas (as periodicas o recebem de TarefaEsperaAte). 
+   ESPERA_INFINITA retira o prazo: a tarefa passa a executar depois das 
+   tarefas com prazo, pela sua prioridade */
+void TarefaDefinePrazo(uint8_t id_tarefa, tick_t qtas_marcas)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	MudaPrazo(id_tarefa, qtas_marcas != ESPERA_INFINITA, contador_marcas + qtas_marcas);
+	TrocaContextoSeNecessario();
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+#if cfg_PINOS_RASTRO
+/* define os pinos de rastro da tarefa, ligados enquanto ela executa 
+   (cfg_PINOS_RASTRO). Configura os pinos como saida; se a tarefa ja esta 
+   executando, os novos pinos ligam imediatamente */
+void TarefaDefinePinoRastro(uint8_t id_tarefa, uint32_t mascara)
+{
+	reg_atomica_t estado;
+	
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas)
+	{
+		return;
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	PINOS_RASTRO_SAIDA(mascara);
+	if(multitarefas_iniciado && id_tarefa == tarefa_atual)
+	{
+		PINO_RASTRO_SAI(TCB[id_tarefa].pinos_rastro & ~mascara);
+		PINO_RASTRO_ENTRA(mascara);
+	}
+	TCB[id_tarefa].pinos_rastro = mascara;
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+/* retorna o numero de marcas de tempo desde o inicio do sistema */
+tick_t ObtemMarcasDeTempo(void)
+{
+	return contador_marcas;		/* leitura de 32 bits e atomica no Cortex-M */
+}
+
+/* retorna a frequencia atual da marca de tempo, em marcas por segundo */
+uint32_t MarcaTempoFrequencia(void)
+{
+	return MARCA_TEMPO_HZ;
+}
+
+/* retorna o nome da tarefa, ou "-" se ela nao tem nome ou os nomes nao 
+   foram compilados (cfg_NOMES_TAREFAS) */
+const char* TarefaNome(uint8_t id_tarefa)
+{
+	#if cfg_NOMES_TAREFAS
+	if(id_tarefa <= NUMERO_DE_TAREFAS && nomes_tarefas[id_tarefa] != 0)
+	{
+		return nomes_tarefas[id_tarefa];
+	}
+	#else
+	(void)id_tarefa;
+	#endif
+	return "-";
+}
+
+#if cfg_OCIOSA_SEM_MARCAS
+/* retorna o numero de marcas de tempo em que a CPU dormiu no modo ocioso 
+   sem marcas, desde o inicio do sistema. Conta so as marcas completas: a 
+   marca que encerra cada periodo de sono e contada como marca normal. A 
+   diferenca entre duas leituras, comparada a de ObtemMarcasDeTempo, da a 
+   fracao do tempo dormindo (ex.: para escalar o clock pela carga) */
+tick_t ObtemMarcasDormidas(void)
+{
+	return marcas_dormidas;
+}
+#endif
+
+#if cfg_PINTA_PILHA
+/* retorna quantas palavras da pilha da tarefa nunca foram usadas desde a sua 
+   criacao (marca d'agua), contando as que ainda tem o padrao de pintura a 
+   partir do fim da pilha (menor endereco, pois a pilha cresce para baixo). 
+   Um valor proximo de 0 indica risco de estouro da pilha */
+uint16_t TarefaPilhaLivre(uint8_t id_tarefa)
+{
+	stackptr_t pilha;
+	uint16_t livre = 0;
+	
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas || TCB_ESTADO(id_tarefa) == TERMINADA)
+	{
+		return 0;
+	}
+	
+	pilha = TCB[id_tarefa].pilha + PALAVRAS_CANARIO;
+	while(livre < (TCB[id_tarefa].tamanho_pilha - PALAVRAS_CANARIO) && pilha[livre] == PADRAO_PILHA)
+	{
+		livre++;
+	}
+	return livre;
+}
+#endif
+
+#if cfg_VERIFICA_PILHA
+/* tratamento padrao do estouro de pilha: para aqui, com id_tarefa e nome 
+   visiveis no depurador. Pode ser trocado por cfg_ESTOURO_DE_PILHA, por 
+   exemplo para registrar o nome da tarefa e reiniciar o sistema */
+void EstouroDePilha(uint8_t id_tarefa, const char *nome)
+{
+	volatile uint8_t tarefa = id_tarefa;
+	const char * volatile nome_tarefa = nome;
+	
+	(void)tarefa;
+	(void)nome_tarefa;
+	for(;;)
+	{
+	}
+}
+#endif
+
+#if cfg_MONITOR_PERIODICAS
+/* copia as medicoes de TarefaEsperaAte da tarefa. Retorna 0 se a tarefa 
+   nao existir */
+uint8_t TarefaObtemMonitor(uint8_t id_tarefa, monitor_periodica_t *monitor)
+{
+	reg_atomica_t estado;
+	
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas || TCB_ESTADO(id_tarefa) == TERMINADA)
+	{
+		return 0;
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	*monitor = TCB[id_tarefa].periodica;
+	REG_ATOMICA_FIM(estado);
+	
+	return 1;
+}
+
+/* recomeca as medicoes da tarefa, ex.: apos a inicializacao do sistema */
+void TarefaZeraMonitor(uint8_t id_tarefa)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	ZeraMonitor(id_tarefa);
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+#if cfg_ESTATISTICAS
+/* copia as estatisticas de ate max_tarefas tarefas existentes, na ordem dos 
+   identificadores, e retorna quantas foram copiadas. Se tempo_total nao for 
+   nulo, recebe o tempo desde o inicio do sistema, em ciclos: o uso de CPU de 
+   cada tarefa e tempo_execucao / tempo_total. A tarefa atual inclui o tempo 
+   em execucao ate agora */
+uint8_t TarefaObtemEstatisticas(estatisticas_tarefa_t *estatisticas, uint8_t max_tarefas, uint64_t *tempo_total)
+{
+	uint8_t tarefa, copiadas = 0;
+	uint64_t agora;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	agora = TempoEmCiclos();
+	for(tarefa = 1; tarefa <= numero_tarefas && copiadas < max_tarefas; tarefa++)
+	{
+		if(TCB_ESTADO(tarefa) == TERMINADA)
+		{
+			continue;
+		}
+		estatisticas[copiadas].id = tarefa;
+		estatisticas[copiadas].nome = TarefaNome(tarefa);
+		estatisticas[copiadas].tempo_execucao = TCB[tarefa].tempo_execucao;
+		estatisticas[copiadas].trocas = TCB[tarefa].trocas;
+		estatisticas[copiadas].preempcoes = TCB[tarefa].preempcoes;
+		#if cfg_ENERGIA
+		estatisticas[copiadas].energia = TCB[tarefa].energia;
+		#endif
+		if(tarefa == tarefa_atual)
+		{
+			estatisticas[copiadas].tempo_execucao += agora - inicio_execucao;
+			#if cfg_ENERGIA
+			estatisticas[copiadas].energia += (agora - inicio_execucao) * custo_ciclo;
+			#endif
+		}
+		copiadas++;
+	}
+	if(tempo_total != 0)
+	{
+		*tempo_total = agora - inicio_sistema;
+	}
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return copiadas;
+}
+#endif
+
+#if cfg_TEMPO_BLOQUEIO
+/* copia o tempo bloqueado de um objeto (ex.: &sem->bloqueio) ou de uma 
+   tarefa no mesmo instante */
+void TempoBloqueioCopia(const tempo_bloqueio_t* medido, tempo_bloqueio_t* copia)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	*copia = *medido;
+	REG_ATOMICA_FIM(estado);
+}
+
+/* recomeca a medicao (ex.: no inicio de um teste de carga) */
+void TempoBloqueioZera(tempo_bloqueio_t* medido)
+{
+	reg_atomica_t estado;
+	uint8_t i;
+	
+	REG_ATOMICA_INICIO(estado);
+	medido->total = 0;
+	medido->esperas = 0;
+	medido->maior = 0;
+	for(i = 0; i < cfg_TEMPO_BLOQUEIO_FAIXAS; i++)
+	{
+		medido->faixas[i] = 0;
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+/* copia o tempo que a tarefa passou bloqueada em semaforos, mutexes e 
+   filas. Retorna 0 se a tarefa nao existe */
+uint8_t TarefaObtemTempoBloqueio(uint8_t id_tarefa, tempo_bloqueio_t* copia)
+{
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas)
+	{
+		return 0;
+	}
+	TempoBloqueioCopia(&TCB[id_tarefa].bloqueio, copia);
+	return 1;
+}
+#endif
+
+#if cfg_ENERGIA
+/* encerra o intervalo em execucao da tarefa atual, cobrando o tempo da 
+   tarefa e a energia, ao custo dado, em *energia. Chamada com as 
+   interrupcoes desabilitadas */
+static void EncerraIntervalo(uint64_t *energia, uint32_t custo)
+{
+	uint64_t agora = TempoEmCiclos();
+	uint64_t ciclos = agora - inicio_execucao;
+	
+	tcb_atual->tempo_execucao += ciclos;
+	*energia += ciclos * custo;
+	inicio_execucao = agora;
+}
+
+/* novo custo por ciclo, em pJ (ex.: o do perfil de clock que entrou). O 
+   intervalo em execucao ate aqui e cobrado ao custo anterior. Pode ser 
+   chamada por tarefas e interrupcoes */
+void EnergiaAlteraCusto(uint32_t pj_por_ciclo)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	if(multitarefas_iniciado)
+	{
+		EncerraIntervalo(&tcb_atual->energia, custo_ciclo);
+	}
+	custo_ciclo = pj_por_ciclo;
+	REG_ATOMICA_FIM(estado);
+}
+
+/* energia gasta com a CPU dormindo na tarefa ociosa, em pJ. A energia de 
+   cada tarefa vem de TarefaObtemEstatisticas */
+uint64_t EnergiaSono(void)
+{
+	reg_atomica_t estado;
+	uint64_t energia;
+	
+	REG_ATOMICA_INICIO(estado);
+	energia = energia_sono;
+	REG_ATOMICA_FIM(estado);
+	return energia;
+}
+#endif
+
+#if cfg_RASTRO > 0
+/* envia o rastro, do registro mais antigo ao mais recente, pela funcao 
+   envia (ex.: escrita bloqueante na UART). Os eventos que acontecem durante 
+   o envio nao sao gravados. Formato, lido por host_posix/decodifica_rastro.c:
+     "RTR1", cfg_CPU_CLOCK_HZ e a frequencia da marca (uint32_t), ou, com 
+     cfg_RASTRO_TEMPO, cfg_RASTRO_TEMPO_HZ e 0, 
+     numero de tarefas (uint8_t) e o nome de cada uma, terminado em 0, 
+     numero de registros (uint16_t) e os registros (registro_rastro_t), 
+   tudo na ordem de bytes do processador */
+void RastroDescarrega(envia_rastro_t envia)
+{
+	static const uint8_t vazio = 0;
+	#ifdef cfg_RASTRO_TEMPO
+	uint32_t frequencias[2] = {cfg_RASTRO_TEMPO_HZ, 0};
+	#else
+	uint32_t frequencias[2] = {cfg_CPU_CLOCK_HZ, MARCA_TEMPO_HZ};
+	#endif
+	uint16_t total, quantidade, indice, i;
+	uint8_t tarefas = numero_tarefas;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	rastro_pausado = 1;
+	total = rastro_total;
+	REG_ATOMICA_FIM(estado);
+	
+	quantidade = (total < cfg_RASTRO) ? total : cfg_RASTRO;
+	
+	envia((const uint8_t*)"RTR1", 4);
+	envia((const uint8_t*)frequencias, sizeof(frequencias));
+	envia(&tarefas, 1);
+	for(i = 1; i <= tarefas; i++)
+	{
+		#if cfg_NOMES_TAREFAS
+		const char *nome = (nomes_tarefas[i] != 0) ? nomes_tarefas[i] : "";
+		#else
+		const char *nome = "";		/* o decodificador mostra o numero da tarefa */
+		#endif
+		uint16_t tamanho = 0;
+		
+		while(nome[tamanho] != 0)
+		{
+			tamanho++;
+		}
+		envia((const uint8_t*)nome, tamanho);
+		envia(&vazio, 1);
+	}
+	envia((const uint8_t*)&quantidade, sizeof(quantidade));
+	
+	indice = (uint16_t)(total - quantidade);
+	for(i = 0; i < quantidade; i++, indice++)
+	{
+		envia((const uint8_t*)&rastro_nucleo[indice & MASCARA_RASTRO], sizeof(registro_rastro_t));
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	rastro_pausado = 0;
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+#if cfg_PERFIL > 0
+/* grava uma amostra do perfil a cada cfg_PERFIL_INTERVALO chamadas, 
+   sobrescrevendo a mais antiga. Chamada pela porta da cpu na interrupcao 
+   da marca de tempo, com o PC interrompido e as interrupcoes desabilitadas. 
+   O codigo executado com as interrupcoes desabilitadas so e amostrado no 
+   fim da regiao atomica, quando a marca pendente e atendida */
+void PerfilAmostra(uint32_t pc)
+{
+	static uint16_t restantes = cfg_PERFIL_INTERVALO;
+	amostra_perfil_t *amostra;
+	
+	if(--restantes != 0 || perfil_pausado)
+	{
+		return;
+	}
+	restantes = cfg_PERFIL_INTERVALO;
+	
+	amostra = &perfil_amostras[perfil_total & MASCARA_PERFIL];
+	perfil_total++;
+	amostra->pc = pc;
+	amostra->tarefa = tarefa_atual;
+	amostra->reservado = 0;
+	amostra->marca = (uint16_t)contador_marcas;
+}
+
+/* envia o perfil, da amostra mais antiga a mais recente, pela funcao 
+   envia (ex.: escrita bloqueante na UART). As amostras do periodo do envio 
+   nao sao gravadas. Formato, lido por host_posix/perfil.c:
+     "PRF1", amostras por segundo (uint32_t), 
+     numero de tarefas (uint8_t) e o nome de cada uma, terminado em 0, 
+     numero de amostras (uint32_t) e as amostras (amostra_perfil_t), 
+   tudo na ordem de bytes do processador */
+void PerfilDescarrega(envia_rastro_t envia)
+{
+	static const uint8_t vazio = 0;
+	uint32_t frequencia = MARCA_TEMPO_HZ / cfg_PERFIL_INTERVALO;
+	uint32_t total, quantidade, indice, i;
+	uint8_t tarefas = numero_tarefas;
+	uint8_t id;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	perfil_pausado = 1;
+	total = perfil_total;
+	REG_ATOMICA_FIM(estado);
+	
+	quantidade = (total < cfg_PERFIL) ? total : cfg_PERFIL;
+	
+	envia((const uint8_t*)"PRF1", 4);
+	envia((const uint8_t*)&frequencia, sizeof(frequencia));
+	envia(&tarefas, 1);
+	for(id = 1; id <= tarefas; id++)
+	{
+		#if cfg_NOMES_TAREFAS
+		const char *nome = (nomes_tarefas[id] != 0) ? nomes_tarefas[id] : "";
+		#else
+		const char *nome = "";
+		#endif
+		uint16_t tamanho = 0;
+		
+		while(nome[tamanho] != 0)
+		{
+			tamanho++;
+		}
+		envia((const uint8_t*)nome, tamanho);
+		envia(&vazio, 1);
+	}
+	envia((const uint8_t*)&quantidade, sizeof(quantidade));
+	
+	indice = total - quantidade;
+	for(i = 0; i < quantidade; i++, indice++)
+	{
+		envia((const uint8_t*)&perfil_amostras[indice & MASCARA_PERFIL], sizeof(amostra_perfil_t));
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	perfil_pausado = 0;
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+/* Servicos de notificacao direta para tarefas: cada tarefa tem um valor 
+   de notificacao no seu TCB, dispensando um objeto separado (semaforo) 
+   para sinalizacoes simples, como de uma interrupcao para uma tarefa */
+
+/* atualiza o valor de notificacao da tarefa conforme a acao e a acorda, 
+   se estiver esperando. Nunca bloqueia, pode ser usada em interrupcoes. 
+   O valor muda com uma operacao atomica; a regiao atomica so e usada para 
+   acordar a tarefa. Ela so passa a esperar com o valor zerado, dentro de 
+   uma regiao atomica, entao se ainda nao esperava ja ve o novo valor */
+void TarefaNotifica(uint8_t id_tarefa, uint32_t valor, acao_notificacao_t acao)
+{
+	volatile uint32_t *notificacao = &TCB[id_tarefa].notificacao;
+	reg_atomica_t estado;
+	
+	switch(acao)
+	{
+		case NOTIFICA_BITS:
+			(void)AtomicoOu(notificacao, valor);
+			break;
+		case NOTIFICA_INCREMENTA:
+			(void)AtomicoSoma(notificacao, 1);
+			break;
+		default:
+			(void)AtomicoTroca(notificacao, valor);
+			break;
+	}
+	
+	if(TCB[id_tarefa].esperando_notificacao)
+	{
+		REG_ATOMICA_INICIO(estado);
+		if(TCB[id_tarefa].esperando_notificacao)
+		{
+			TCB[id_tarefa].esperando_notificacao = 0;
+			RetiraDaListaDeEspera(id_tarefa);		/* cancela o limite de tempo da espera */
+			TarefaPronta(id_tarefa);
+			TrocaContextoSeNecessario();
+		}
+		REG_ATOMICA_FIM(estado);
+	}
+}
+
+/* espera ate a tarefa atual ser notificada ou ate passarem timeout marcas, 
+   entao retorna o valor de notificacao e o zera. Retorna 0 se o tempo se 
+   esgotou sem notificacao. timeout 0 apenas consulta, sem esperar, e 
+   ESPERA_INFINITA espera sem limite de tempo */
+uint32_t TarefaAguardaNotificacao(tick_t timeout)
+{
+	uint32_t valor;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(tcb_atual->notificacao == 0 && timeout > 0)
+	{
+		tcb_atual->esperando_notificacao = 1;
+		if(timeout != ESPERA_INFINITA)
+		{
+			InsereNaListaDeEspera(tarefa_atual, timeout);
+		}
+		TarefaBloqueia(tarefa_atual);
+		TROCA_CONTEXTO();
+		REG_ATOMICA_FIM(estado);		/* retorna quando notificada ou quando o tempo se esgotar */
+		REG_ATOMICA_INICIO(estado);
+		tcb_atual->esperando_notificacao = 0;
+	}
+	
+	valor = tcb_atual->notificacao;
+	tcb_atual->notificacao = 0;
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return valor;
+}
+
+#if cfg_TEMPORIZADORES || cfg_FILA_TRABALHOS > 0 || cfg_OBJETOS_ATIVOS > 0
+/* notifica uma tarefa de servico do nucleo (temporizadores, trabalhos, 
+   objetos ativos), 
+   que espera em TarefaAguardaNotificacao, e a acorda sem pedir a troca 
+   de contexto. Retorna 1 se a tarefa estava esperando. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static uint8_t AcordaTarefaDoNucleo(uint8_t tarefa)
+{
+	if(tarefa == 0)
+	{
+		return 0;	/* a tarefa ainda nao comecou */
+	}
+	
+	TCB[tarefa].notificacao |= 1;
+	if(TCB[tarefa].esperando_notificacao)
+	{
+		TCB[tarefa].esperando_notificacao = 0;
+		TarefaPronta(tarefa);
+		return 1;
+	}
+	return 0;
+}
+#endif
+
+#if cfg_FILA_TRABALHOS > 0
+/* Servicos de trabalhos adiados das interrupcoes */
+
+/* agenda funcao(arg) para ser executada pela tarefa de trabalhos e 
+   retorna 0 se a fila de trabalhos estiver cheia. Nunca bloqueia; feita 
+   para interrupcoes, que assim tratam so o urgente e deixam o resto para 
+   a tarefa. So o primeiro trabalho de um lote acorda a tarefa e pede a 
+   troca de contexto, os seguintes apenas entram na fila */
+uint8_t TrabalhoAgenda(funcao_trabalho_t funcao, void* arg)
+{
+	uint8_t posicao;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(quantidade_trabalhos >= cfg_FILA_TRABALHOS)
+	{
+		trabalhos_perdidos++;
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	
+	posicao = (uint8_t)(inicio_trabalhos + quantidade_trabalhos);
+	if(posicao >= cfg_FILA_TRABALHOS)
+	{
+		posicao -= cfg_FILA_TRABALHOS;
+	}
+	fila_trabalhos[posicao].funcao = funcao;
+	fila_trabalhos[posicao].arg = arg;
+	quantidade_trabalhos++;
+	
+	if(AcordaTarefaDoNucleo(id_tarefa_trabalhos))
+	{
+		TrocaContextoSeNecessario();	/* em interrupcao, a troca fica pendente no PendSV */
+	}
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return 1;
+}
+
+/* numero de trabalhos recusados por falta de espaco desde o inicio, 
+   para dimensionar cfg_FILA_TRABALHOS */
+uint16_t TrabalhosPerdidos(void)
+{
+	return trabalhos_perdidos;
+}
+
+/* tarefa que executa os trabalhos agendados, em ordem de chegada. Deve ser 
+   criada pela aplicacao com a prioridade desejada para o tratamento adiado 
+   das interrupcoes. Executa todos os trabalhos pendentes antes de esperar 
+   de novo, com as interrupcoes habilitadas durante cada trabalho */
+void tarefa_trabalhos(void)
+{
+	trabalho_t trabalho;
+	uint8_t pendente;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	id_tarefa_trabalhos = tarefa_atual;
+	REG_ATOMICA_FIM(estado);
+	
+	for(;;)
+	{
+		do
+		{
+			REG_ATOMICA_INICIO(estado);
+			pendente = quantidade_trabalhos;
+			if(pendente != 0)
+			{
+				trabalho = fila_trabalhos[inicio_trabalhos];
+				if(++inicio_trabalhos >= cfg_FILA_TRABALHOS)
+				{
+					inicio_trabalhos = 0;
+				}
+				quantidade_trabalhos--;
+			}
+			REG_ATOMICA_FIM(estado);
+			
+			if(pendente != 0)
+			{
+				trabalho.funcao(trabalho.arg);
+			}
+		} while(pendente != 0);
+		
+		/* um trabalho agendado apos o teste acima deixa a notificacao 
+		   pendente, e a espera retorna imediatamente */
+		(void)TarefaAguardaNotificacao(ESPERA_INFINITA);
+	}
+}
+#endif
+
+#if cfg_OBJETOS_ATIVOS > 0
+/* Servicos de objetos ativos */
+
+/* inicia o objeto com a fila fila de capacidade eventos e o coloca no 
+   grupo, na prioridade dada (0 a cfg_OBJETOS_POR_GRUPO - 1, maior primeiro). 
+   Deve ser chamada antes de enviar eventos ao objeto. Retorna 0 se o grupo 
+   ou a prioridade nao existem ou se a prioridade ja esta ocupada */
+uint8_t ObjetoAtivoInicia(objeto_ativo_t* objeto, uint8_t grupo, uint8_t prioridade, despacho_objeto_t despacho, 
+						  evento_t* fila, uint8_t capacidade)
+{
+	reg_atomica_t estado;
+	uint8_t iniciado = 0;
+	
+	if(grupo >= cfg_OBJETOS_ATIVOS || prioridade >= cfg_OBJETOS_POR_GRUPO || capacidade == 0)
+	{
+		return 0;
+	}
+	
+	objeto->despacho = despacho;
+	objeto->fila = fila;
+	objeto->capacidade = capacidade;
+	objeto->quantidade = 0;
+	objeto->inicio = 0;
+	objeto->grupo = grupo;
+	objeto->prioridade = prioridade;
+	objeto->perdidos = 0;
+	objeto->arena = 0;
+	
+	REG_ATOMICA_INICIO(estado);
+	if(grupos_objetos[grupo].objetos[prioridade] == 0)
+	{
+		grupos_objetos[grupo].objetos[prioridade] = objeto;
+		iniciado = 1;
+	}
+	REG_ATOMICA_FIM(estado);
+	
+	return iniciado;
+}
+
+/* copia o evento (sinal, dado) para a fila do objeto e acorda a tarefa do 
+   grupo. Nunca bloqueia, entao serve para tarefas, interrupcoes e as 
+   proprias funcoes de despacho. Retorna 0, e conta em objeto->perdidos, 
+   se a fila estiver cheia */
+uint8_t ObjetoAtivoEnvia(objeto_ativo_t* objeto, uint16_t sinal, void* dado)
+{
+	grupo_objetos_t *grupo = &grupos_objetos[objeto->grupo];
+	uint8_t posicao;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(objeto->quantidade >= objeto->capacidade)
+	{
+		objeto->perdidos++;
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	
+	posicao = (uint8_t)(objeto->inicio + objeto->quantidade);
+	if(posicao >= objeto->capacidade)
+	{
+		posicao -= objeto->capacidade;
+	}
+	objeto->fila[posicao].sinal = sinal;
+	objeto->fila[posicao].dado = dado;
+	objeto->quantidade++;
+	grupo->prontos |= (uint8_t)(1u << objeto->prioridade);
+	
+	if(AcordaTarefaDoNucleo(grupo->tarefa))
+	{
+		TrocaContextoSeNecessario();	/* em interrupcao, a troca fica pendente no PendSV */
+	}
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return 1;
+}
+
+/* executa os objetos ativos do grupo; e o corpo de uma tarefa criada pela 
+   aplicacao, que nunca retorna. Ex.: void tarefa_controle(void) 
+   { ObjetosAtivosExecuta(0); }. A prioridade da tarefa vale para o grupo 
+   todo diante das demais tarefas. A cada volta trata um evento do objeto 
+   de maior prioridade com eventos, entao um evento espera no maximo um 
+   despacho em andamento de outro objeto do grupo, alem dos de maior 
+   prioridade. Sem eventos, a tarefa espera uma notificacao */
+void ObjetosAtivosExecuta(uint8_t grupo)
+{
+	grupo_objetos_t *g = &grupos_objetos[grupo];
+	objeto_ativo_t *objeto = 0;
+	evento_t evento;
+	uint8_t prontos, prioridade;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	g->tarefa = tarefa_atual;
+	REG_ATOMICA_FIM(estado);
+	
+	for(;;)
+	{
+		REG_ATOMICA_INICIO(estado);
+		prontos = g->prontos;
+		if(prontos != 0)
+		{
+			prioridade = cfg_OBJETOS_POR_GRUPO - 1;
+			while((prontos & (1u << prioridade)) == 0)
+			{
+				prioridade--;
+			}
+			objeto = g->objetos[prioridade];
+			evento = objeto->fila[objeto->inicio];
+			if(++objeto->inicio >= objeto->capacidade)
+			{
+				objeto->inicio = 0;
+			}
+			if(--objeto->quantidade == 0)
+			{
+				g->prontos &= (uint8_t)~(1u << prioridade);
+			}
+		}
+		REG_ATOMICA_FIM(estado);
+		
+		if(prontos != 0)
+		{
+			objeto->despacho(objeto, &evento);
+			if(objeto->arena != 0)
+			{
+				ArenaZera(objeto->arena);
+			}
+		}
+		else
+		{
+			/* um evento enviado apos o teste acima deixa a notificacao 
+			   pendente, e a espera retorna imediatamente */
+			(void)TarefaAguardaNotificacao(ESPERA_INFINITA);
+		}
+	}
+}
+#endif
+
+#if cfg_TEMPORIZADORES
+/* Servicos de temporizadores de software */
+
+/* coloca o temporizador na posicao da roda do seu vencimento. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static void InsereNaRoda(temporizador_t* temporizador)
+{
+	temporizador_t **posicao = &roda_temporizadores[temporizador->vencimento & MASCARA_RODA];
+	
+	temporizador->anterior = 0;
+	temporizador->proximo = *posicao;
+	if(*posicao != 0)
+	{
+		(*posicao)->anterior = temporizador;
+	}
+	*posicao = temporizador;
+	temporizador->ativo = 1;
+	temporizadores_ativos++;
+}
+
+/* retira o temporizador da roda. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static void RetiraDaRoda(temporizador_t* temporizador)
+{
+	if(temporizador->anterior != 0)
+	{
+		temporizador->anterior->proximo = temporizador->proximo;
+	}
+	else
+	{
+		roda_temporizadores[temporizador->vencimento & MASCARA_RODA] = temporizador->proximo;
+	}
+	if(temporizador->proximo != 0)
+	{
+		temporizador->proximo->anterior = temporizador->anterior;
+	}
+	temporizador->ativo = 0;
+	temporizadores_ativos--;
+}
+
+/* acorda a tarefa de temporizadores, sem pedir a troca de contexto: na 
+   marca de tempo, a preempcao segue o limiar da tarefa atual. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static void AcordaTemporizadores(void)
+{
+	/* antes de a tarefa comecar nao ha o que acordar: ela confere todas as marcas ao iniciar */
+	(void)AcordaTarefaDoNucleo(id_tarefa_temporizadores);
+}
+
+/* chama as funcoes dos temporizadores que vencem na marca. Cada funcao e 
+   chamada com as interrupcoes habilitadas, entao a posicao da roda e 
+   percorrida de novo apos cada uma, ja que a funcao pode ligar ou 
+   desligar temporizadores */
+static void ExecutaTemporizadores(tick_t marca)
+{
+	temporizador_t *temporizador;
+	reg_atomica_t estado;
+	
+	for(;;)
+	{
+		REG_ATOMICA_INICIO(estado);
+		
+		temporizador = roda_temporizadores[marca & MASCARA_RODA];
+		while(temporizador != 0 && temporizador->vencimento != marca)
+		{
+			temporizador = temporizador->proximo;	/* vence em outra volta da roda */
+		}
+		
+		if(temporizador == 0)
+		{
+			REG_ATOMICA_FIM(estado);
+			return;
+		}
+		
+		RetiraDaRoda(temporizador);
+		if(temporizador->periodo != 0)
+		{
+			/* periodico: o proximo vencimento conta do anterior, sem acumular atrasos */
+			temporizador->vencimento = marca + temporizador->periodo;
+			InsereNaRoda(temporizador);
+		}
+		
+		REG_ATOMICA_FIM(estado);
+		
+		temporizador->funcao(temporizador->arg);
+	}
+}
+
+/* tarefa que executa os temporizadores. Deve ser criada pela aplicacao, em 
+   geral com a maior prioridade, e sua pilha deve comportar a funcao de 
+   temporizador mais profunda. Trata todas as marcas desde a ultima vez que 
+   executou, entao nenhum vencimento se perde se ela atrasar */
+void tarefa_temporizadores(void)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	id_tarefa_temporizadores = tarefa_atual;
+	REG_ATOMICA_FIM(estado);
+	
+	for(;;)
+	{
+		while(marca_temporizadores != ObtemMarcasDeTempo())
+		{
+			tick_t atraso, proximo;
+			
+			/* apos um sono longo sem marcas, salta direto para o proximo 
+			   vencimento, em vez de percorrer uma a uma as marcas dormidas 
+			   (horas, ou dias) */
+			REG_ATOMICA_INICIO(estado);
+			atraso = contador_marcas - marca_temporizadores;
+			proximo = (atraso > 1) ? MarcasAteVencimento(marca_temporizadores) : 1;
+			if(proximo > atraso)
+			{
+				marca_temporizadores = contador_marcas;		/* nada vence nas marcas que faltam */
+				REG_ATOMICA_FIM(estado);
+				break;
+			}
+			marca_temporizadores += proximo;
+			REG_ATOMICA_FIM(estado);
+			
+			ExecutaTemporizadores(marca_temporizadores);
+		}
+		
+		/* uma marca que ocupe a roda apos o teste acima deixa a notificacao 
+		   pendente, e a espera retorna imediatamente */
+		(void)TarefaAguardaNotificacao(ESPERA_INFINITA);
+	}
+}
+
+void TemporizadorInicia(temporizador_t* temporizador, funcao_temporizador_t funcao, void* arg)
+{
+	temporizador->funcao = funcao;
+	temporizador->arg = arg;
+	temporizador->vencimento = 0;
+	temporizador->periodo = 0;
+	temporizador->proximo = 0;
+	temporizador->anterior = 0;
+	temporizador->ativo = 0;
+}
+
+/* liga o temporizador para vencer apos atraso marcas (no minimo 1) e 
+   depois a cada periodo marcas, ou uma vez so se periodo for 0. Se ja 
+   estiver ligado, recomeca a contagem. Nunca bloqueia, pode ser usada em 
+   interrupcoes e nas proprias funcoes de temporizador */
+void TemporizadorLiga(temporizador_t* temporizador, tick_t atraso, tick_t periodo)
+{
+	reg_atomica_t estado;
+	
+	if(atraso == 0)
+	{
+		atraso = 1;
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(temporizador->ativo)
+	{
+		RetiraDaRoda(temporizador);
+	}
+	temporizador->vencimento = contador_marcas + atraso;
+	temporizador->periodo = periodo;
+	InsereNaRoda(temporizador);
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* desliga o temporizador, se estiver ligado. Nunca bloqueia */
+void TemporizadorDesliga(temporizador_t* temporizador)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(temporizador->ativo)
+	{
+		RetiraDaRoda(temporizador);
+	}
+	
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+#if cfg_REGISTRO_OBJETOS
+/* Registro de objetos do nucleo */
+
+/* inclui o objeto no fim do registro, com o nome mostrado pelas 
+   ferramentas (ex.: comando objs do console). O registro e da aplicacao 
+   (ex.: static, ver OBJETO_REGISTRA) e fica em uso ate ObjetoRetira; 
+   registrar de novo o mesmo registro so troca o objeto e o nome. Percorre 
+   o registro com as interrupcoes desabilitadas: para a inicializacao, 
+   nao para os caminhos rapidos */
+void ObjetoRegistra(registro_objeto_t* registro, uint8_t tipo, void* objeto, const char* nome)
+{
+	registro_objeto_t **fim = &objetos_registrados;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	registro->nome = nome;
+	registro->objeto = objeto;
+	registro->tipo = tipo;
+	while(*fim != 0 && *fim != registro)
+	{
+		fim = &(*fim)->proximo;
+	}
+	if(*fim == 0)
+	{
+		registro->proximo = 0;
+		*fim = registro;
+	}
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* retira o objeto do registro (ex.: antes de reutilizar a memoria de um 
+   objeto dinamico). Nada acontece se ele nao esta registrado */
+void ObjetoRetira(registro_objeto_t* registro)
+{
+	registro_objeto_t **anterior = &objetos_registrados;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	while(*anterior != 0 && *anterior != registro)
+	{
+		anterior = &(*anterior)->proximo;
+	}
+	if(*anterior != 0)
+	{
+		*anterior = registro->proximo;
+	}
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* numero de tarefas numa lista de espera de objeto */
+static uint8_t ContaEsperando(uint8_t tarefa)
+{
+	uint8_t esperando = 0;
+	
+	for(; tarefa != 0; tarefa = TCB[tarefa].prox_evento)
+	{
+		esperando++;
+	}
+	return esperando;
+}
+
+/* copia o estado de um objeto registrado. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static void CopiaEstadoObjeto(const registro_objeto_t* registro, estado_objeto_t* copia)
+{
+	uint8_t primeira = 0, segunda = 0;
+	
+	copia->nome = registro->nome;
+	copia->objeto = registro->objeto;
+	copia->tipo = registro->tipo;
+	copia->dono = 0;
+	copia->contagem = 0;
+	copia->marca_agua = 0;
+	#if cfg_ESPERAS_SEMAFORO
+	copia->bloqueios = 0;
+	#endif
+	#if cfg_TEMPO_BLOQUEIO
+	copia->tempo_bloqueado = 0;
+	#endif
+	
+	switch(registro->tipo)
+	{
+		case OBJETO_SEMAFORO:
+		{
+			const semaforo_t *sem = (const semaforo_t*)registro->objeto;
+			
+			primeira = sem->tarefaEsperando;
+			copia->contagem = sem->contador;
+			copia->marca_agua = sem->maximo;
+			#if cfg_ESPERAS_SEMAFORO
+			copia->bloqueios = sem->bloqueios;
+			#endif
+			#if cfg_TEMPO_BLOQUEIO
+			copia->tempo_bloqueado = sem->bloqueio.total;
+			#endif
+			break;
+		}
+		case OBJETO_MUTEX:
+			primeira = ((const mutex_t*)registro->objeto)->tarefaEsperando;
+			copia->dono = ((const mutex_t*)registro->objeto)->dono;
+			#if cfg_TEMPO_BLOQUEIO
+			copia->tempo_bloqueado = ((const mutex_t*)registro->objeto)->bloqueio.total;
+			#endif
+			break;
+		case OBJETO_CONDICAO:
+			primeira = ((const condicao_t*)registro->objeto)->tarefaEsperando;
+			break;
+		case OBJETO_TRAVA_RW:
+		{
+			const trava_rw_t *trava = (const trava_rw_t*)registro->objeto;
+			
+			primeira = trava->escritoresEsperando;
+			segunda = trava->leitoresEsperando;
+			copia->dono = trava->escritor;
+			copia->contagem = trava->leitores;
+			break;
+		}
+		case OBJETO_FILA:
+		{
+			const fila_t *fila = (const fila_t*)registro->objeto;
+			
+			primeira = fila->esperandoReceber;
+			segunda = fila->esperandoEnviar;
+			copia->contagem = fila->quantidade;
+			copia->marca_agua = fila->maximo;
+			#if cfg_TEMPO_BLOQUEIO
+			copia->tempo_bloqueado = fila->bloqueio.total;
+			#endif
+			break;
+		}
+		case OBJETO_MEMORIA:
+			primeira = ((const memoria_t*)registro->objeto)->tarefaEsperando;
+			copia->contagem = ((const memoria_t*)registro->objeto)->quantidade;
+			copia->marca_agua = ((const memoria_t*)registro->objeto)->minimo;
+			break;
+		#if cfg_GRUPOS_EVENTOS
+		case OBJETO_GRUPO_EVENTOS:
+			primeira = ((const grupo_eventos_t*)registro->objeto)->tarefaEsperando;
+			copia->contagem = ((const grupo_eventos_t*)registro->objeto)->bits;
+			break;
+		#endif
+		#if cfg_TEMPORIZADORES
+		case OBJETO_TEMPORIZADOR:
+		{
+			const temporizador_t *temporizador = (const temporizador_t*)registro->objeto;
+			
+			if(temporizador->ativo && (int32_t)(temporizador->vencimento - contador_marcas) > 0)
+			{
+				copia->contagem = temporizador->vencimento - contador_marcas;
+			}
+			break;
+		}
+		#endif
+		default:
+			break;
+	}
+	
+	copia->esperando = (uint8_t)(ContaEsperando(primeira) + ContaEsperando(segunda));
+	copia->primeira = (primeira != 0) ? primeira : segunda;
+}
+
+/* copia o estado de ate max_objetos objetos registrados, a partir do 
+   primeiro-esimo (0 = o primeiro registrado), todos no mesmo instante. 
+   Retorna quantos foram copiados. Para registros longos, pedir em partes 
+   encurta o tempo com as interrupcoes desabilitadas */
+uint8_t ObjetosObtemEstado(estado_objeto_t* estados, uint8_t primeiro, uint8_t max_objetos)
+{
+	const registro_objeto_t *registro;
+	uint8_t copiados = 0;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	for(registro = objetos_registrados; registro != 0 && primeiro > 0; registro = registro->proximo)
+	{
+		primeiro--;
+	}
+	for(; registro != 0 && copiados < max_objetos; registro = registro->proximo)
+	{
+		CopiaEstadoObjeto(registro, &estados[copiados]);
+		copiados++;
+	}
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return copiados;
+}
+#endif
+
+#if cfg_GANCHOS_OCIOSA > 0
+/* registra um gancho de trabalho da tarefa ociosa. Retorna 1 se conseguiu, 
+   0 se ja ha cfg_GANCHOS_OCIOSA ganchos. Nao ha remocao: o gancho que nao 
+   tem mais trabalho apenas retorna 0 */
+uint8_t OciosaRegistraGancho(gancho_ociosa_t gancho)
+{
+	reg_atomica_t estado;
+	uint8_t ok = 0;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(gancho != 0 && numero_ganchos_ociosa < cfg_GANCHOS_OCIOSA)
+	{
+		ganchos_ociosa[numero_ganchos_ociosa] = gancho;
+		numero_ganchos_ociosa++;
+		ok = 1;
+	}
+	
+	REG_ATOMICA_FIM(estado);
+	return ok;
+}
+
+/* executa um passo de cada gancho, em rodizio. Entre um gancho e outro a 
+   tarefa ociosa cede o processador se alguma tarefa ficou pronta, entao o 
+   atraso maximo para as outras tarefas (tambem no modo cooperativo) e o 
+   passo mais longo de um gancho. Retorna 1 se algum ainda tem trabalho */
+static uint8_t ExecutaGanchosOciosa(void)
+{
+	reg_atomica_t estado;
+	uint8_t i, pendente = 0;
+	
+	for(i = 0; i < numero_ganchos_ociosa; i++)
+	{
+		pendente |= ganchos_ociosa[i]();
+		
+		REG_ATOMICA_INICIO(estado);
+		TrocaContextoSeNecessario();
+		REG_ATOMICA_FIM(estado);
+	}
+	return pendente;
+}
+#endif
+
+/* Exemplo de tarefa ociosa */
+void tarefa_ociosa(void)
+{
+	reg_atomica_t estado;
+	#if cfg_OCIOSA_SEM_MARCAS
+	tick_t marcas;
+	#endif
+	
+	for(;;)
+	{		
+		#if cfg_GANCHOS_OCIOSA > 0
+			if(ExecutaGanchosOciosa())
+			{
+				continue;		/* ainda ha trabalho de fundo: nao dorme */
+			}
+		#endif
+		
+		#if cfg_OCIOSA_SEM_MARCAS
+			REG_ATOMICA_INICIO(estado);
+			marcas = MarcasParaDormir();
+			if(marcas >= cfg_OCIOSA_MIN_MARCAS)
+			{
+				/* dorme ate o proximo despertar, ou ate uma interrupcao qualquer. 
+				   A ultima marca e tratada normalmente pelo SysTick_Handler */
+				#if cfg_ENERGIA
+				EncerraIntervalo(&tcb_atual->energia, custo_ciclo);
+				#endif
+				DormeSemMarcas(marcas);
+				#if cfg_ENERGIA
+				EncerraIntervalo(&energia_sono, cfg_CUSTO_SONO());	/* o sono, ao custo do modo escolhido */
+				#endif
+			}
+			REG_ATOMICA_FIM(estado);
+		#endif
+		
+		#if 1
+			REG_ATOMICA_INICIO(estado);
+			TrocaContextoSeNecessario();	/* troca de contexto se alguma tarefa ficou pronta */
+			REG_ATOMICA_FIM(estado);
+		#endif
+	}
+}
+
+
+void IniciaMultitarefas(void)
+{
+	#if cfg_PILHA_TAREFAS_BASICAS > 0 && cfg_PINTA_PILHA
+	/* a pilha compartilhada das tarefas basicas, ainda sem contextos */
+	{
+		uint16_t i;
+		for(i = 0; i < cfg_PILHA_TAREFAS_BASICAS; i++)
+		{
+			pilha_basicas[i] = PADRAO_PILHA;
+		}
+	}
+	#endif
+	#if cfg_PILHA_TAREFAS_BASICAS > 0 && cfg_VERIFICA_PILHA
+	pilha_basicas[0] = CANARIO_PILHA;
+	#endif
+	
+	tarefa_atual = escalonador();
+	tcb_atual = &TCB[tarefa_atual];
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	while(tcb_atual->funcao_basica != 0 && !IniciaTarefaBasica(tarefa_atual))
+	{
+		tarefa_atual = escalonador();	/* ativada antes de iniciar */
+		tcb_atual = &TCB[tarefa_atual];
+	}
+	#endif
+	ponteiro_de_pilha = tcb_atual->stack_pointer;	/* lido pelo SVC_Handler */
+	multitarefas_iniciado = 1;
+	#if cfg_ESTATISTICAS
+	inicio_sistema = TempoEmCiclos();
+	inicio_execucao = inicio_sistema;
+	tcb_atual->trocas = 1;
+	#endif
+	#if cfg_PINOS_RASTRO
+	PINOS_RASTRO_SAIDA(cfg_PINO_RASTRO_SVC | cfg_PINO_RASTRO_PENDSV | cfg_PINO_RASTRO_MARCA);
+	PINO_RASTRO_ENTRA(tcb_atual->pinos_rastro);	/* a primeira tarefa, iniciada pelo SVC_Handler */
+	#endif
+	GERA_INTERRUPCAO_SW();
+}
+
+/* chamada pelo PendSV_Handler com o stack pointer da tarefa atual (em R0), 
+   retorna o stack pointer da proxima tarefa, tambem em R0 */
+CHAMADA_POR_ASM NUCLEO_RAPIDO stackptr_t TrocaContextoDasTarefas(stackptr_t pilha)
+{
+	#if cfg_PINOS_RASTRO
+	uint32_t pinos_antes = tcb_atual->pinos_rastro;	/* antes de LiberaTarefa */
+	#endif
+	
+	/* guarda o valor antigo do stack pointer */
+	tcb_atual->stack_pointer = pilha;
+	#if cfg_CEDE_DIRETO
+	tcb_atual->cedida = 0;		/* contexto completo, do PendSV */
+	#endif
+	
+	#if cfg_VERIFICA_PILHA
+	/* a tarefa que sai estourou a pilha: canario sobrescrito ou stack 
+	   pointer abaixo do inicio da pilha. Se o tratamento retornar, a 
+	   tarefa e suspensa, pois a sua pilha ja esta corrompida */
+	if(tcb_atual->pilha[0] != CANARIO_PILHA || pilha < tcb_atual->pilha)
+	{
+		cfg_ESTOURO_DE_PILHA(tarefa_atual, TarefaNome(tarefa_atual));
+		TarefaBloqueia(tarefa_atual);
+	}
+	#endif
+	
+	/* a tarefa que terminou a si mesma ja nao usa a sua pilha */
+	if(TCB_ATUAL_ESTADO() == TERMINADA)
+	{
+		LiberaTarefa(tarefa_atual);
+	}
+		
+	/* executa o escalonador */
+	proxima_tarefa = escalonador();
+	
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	/* a tarefa basica que saiu ao terminar nao e retomada, e a escolhida, 
+	   se e uma tarefa basica que ainda nao comecou, ganha um contexto novo 
+	   na pilha compartilhada */
+	contexto_descartado = (tcb_atual->funcao_basica != 0 && !tcb_atual->iniciada);
+	while(TCB[proxima_tarefa].funcao_basica != 0 && !TCB[proxima_tarefa].iniciada && 
+		!IniciaTarefaBasica(proxima_tarefa))
+	{
+		proxima_tarefa = escalonador();		/* sem espaco: a tarefa foi suspensa */
+	}
+	#endif
+	
+	if(proxima_tarefa != tarefa_atual)
+	{
+		RASTRO(RASTRO_TROCA, proxima_tarefa, tarefa_atual);
+	}
+	
+	#if cfg_ESTATISTICAS
+	/* contabiliza o tempo de execucao da tarefa que sai e as trocas */
+	{
+		uint64_t agora = TempoEmCiclos();
+		
+		tcb_atual->tempo_execucao += agora - inicio_execucao;
+		#if cfg_ENERGIA
+		tcb_atual->energia += (agora - inicio_execucao) * custo_ciclo;
+		#endif
+		inicio_execucao = agora;
+		if(proxima_tarefa != tarefa_atual)
+		{
+			TCB[proxima_tarefa].trocas++;
+			if(TCB_ATUAL_ESTADO() == PRONTA)
+			{
+				tcb_atual->preempcoes++;	/* saiu sem ter bloqueado */
+			}
+		}
+	}
+	#endif
+		
+	#if cfg_INANICAO > 0
+	/* termina a espera da tarefa que entra e comeca a da que sai ainda 
+	   pronta. A ociosa, na prioridade 0, esta sempre pronta e so executa 
+	   quando nenhuma outra pode: nao e medida */
+	if(proxima_tarefa != tarefa_atual)
+	{
+		if(TCB_PRIORIDADE(proxima_tarefa) != 0)
+		{
+			tick_t espera = contador_marcas - pronta_desde[proxima_tarefa];
+
+			if(espera > inanicao_maior[proxima_tarefa])
+			{
+				inanicao_maior[proxima_tarefa] = espera;
+			}
+			inanicao_avisada[proxima_tarefa] = 0;
+		}
+		if(TCB_PRIORIDADE(tarefa_atual) != 0)
+		{
+			pronta_desde[tarefa_atual] = contador_marcas;
+		}
+	}
+	#endif
+
+	#if cfg_FATIA_TEMPO > 0
+	/* a nova tarefa comeca com uma fatia de tempo completa */
+	if(proxima_tarefa != tarefa_atual)
+	{
+		fatia_restante = cfg_FATIA_TEMPO;
+	}
+	#endif
+	
+	/* seleciona a nova tarefa */
+	tarefa_atual = proxima_tarefa;
+	tcb_atual = &TCB[proxima_tarefa];
+	
+	#if cfg_PINOS_RASTRO
+	/* fim do PendSV e troca dos pinos das tarefas, sem desligar os pinos 
+	   comuns a tarefa que sai e a que entra */
+	PINOS_RASTRO_DESLIGA(cfg_PINO_RASTRO_PENDSV | (pinos_antes & ~tcb_atual->pinos_rastro));
+	PINO_RASTRO_ENTRA(tcb_atual->pinos_rastro);
+	#endif
+		
+	/* retorna o novo valor do stack pointer */
+	return tcb_atual->stack_pointer;
+
+}
+
+#if cfg_CEDE_DIRETO
+/* chamada pelo CEDE_DIRETO da porta, no modo thread e com as interrupcoes 
+   desabilitadas, com o stack pointer da tarefa que cede. A troca e a mesma 
+   do PendSV; a tarefa que sai fica marcada, pois so o seu contexto pode 
+   ser retomado sem a excecao */
+CHAMADA_POR_ASM NUCLEO_RAPIDO stackptr_t TrocaContextoCedida(stackptr_t pilha)
+{
+	tcb_t *cedeu = tcb_atual;
+	
+	pilha = TrocaContextoDasTarefas(pilha);
+	cedeu->cedida = 1;
+	return pilha;
+}
+#endif
+
+#if cfg_VIGIA > 0
+/* confere as janelas das tarefas vigiadas depois de vigia_decorridas 
+   marcas e alimenta o vigia da placa se nenhuma atrasou. Chamada pela 
+   marca de tempo, com as interrupcoes desabilitadas */
+static void VerificaVigia(void)
+{
+	tick_t decorridas = vigia_decorridas;
+	uint8_t i;
+	
+	vigia_decorridas = 0;
+	if(vigia_atrasada != 0)
+	{
+		return;		/* ja falhou: espera o reset */
+	}
+	for(i = 1; i <= numero_tarefas; i++)
+	{
+		if(vigia_janela[i] == 0)
+		{
+			continue;
+		}
+		if(vigia_sinal[i])
+		{
+			vigia_sinal[i] = 0;
+			vigia_restante[i] = vigia_janela[i];
+		}
+		else if(vigia_restante[i] > decorridas)
+		{
+			vigia_restante[i] = (uint16_t)(vigia_restante[i] - decorridas);
+		}
+		else
+		{
+			vigia_atrasada = i;
+			#if cfg_RASTRO > 0
+			rastro_pausado = 1;		/* guarda os eventos ate a falha */
+			#endif
+			#ifdef cfg_VIGIA_FALHOU
+			cfg_VIGIA_FALHOU(i);
+			#endif
+			return;
+		}
+	}
+	cfg_ALIMENTA_VIGIA();
+}
+
+/* passa a vigiar a tarefa, que deve chamar VigiaSinaliza ao menos uma vez 
+   a cada janela marcas (a verificacao e a cada cfg_VIGIA marcas, entao a 
+   falha e detectada ate cfg_VIGIA marcas depois do fim da janela). 
+   janela = 0 deixa de vigiar. TarefaTermina tambem deixa de vigiar */
+void VigiaRegistra(uint8_t id_tarefa, uint16_t janela)
+{
+	reg_atomica_t estado;
+	
+	if(id_tarefa == 0 || id_tarefa > NUMERO_DE_TAREFAS)
+	{
+		return;
+	}
+	REG_ATOMICA_INICIO(estado);
+	vigia_sinal[id_tarefa] = 0;
+	vigia_restante[id_tarefa] = janela;
+	vigia_janela[id_tarefa] = janela;
+	REG_ATOMICA_FIM(estado);
+}
+
+/* retorna a primeira tarefa que nao sinalizou a tempo, ou 0 se nenhuma */
+uint8_t VigiaAtrasada(void)
+{
+	return vigia_atrasada;
+}
+#endif
+
+#if cfg_INANICAO > 0
+/* conta as tarefas prontas que esperam pela CPU ha cfg_INANICAO marcas ou
+   mais, uma vez por espera, exceto a ociosa (prioridade 0). Chamada pela
+   marca de tempo, com as interrupcoes desabilitadas */
+static void VerificaInanicao(void)
+{
+	tick_t espera;
+	uint8_t i;
+
+	inanicao_decorridas = 0;
+	for(i = 1; i <= numero_tarefas; i++)
+	{
+		if(TCB_ESTADO(i) != PRONTA || i == tarefa_atual || inanicao_avisada[i] || TCB_PRIORIDADE(i) == 0)
+		{
+			continue;
+		}
+		espera = contador_marcas - pronta_desde[i];
+		if(espera >= cfg_INANICAO)
+		{
+			inanicao_avisada[i] = 1;
+			if(inanicao_contadas[i] != 0xFFFF)
+			{
+				inanicao_contadas[i]++;
+			}
+			#ifdef cfg_INANICAO_DETECTADA
+			cfg_INANICAO_DETECTADA(i, espera);
+			#endif
+		}
+	}
+}
+
+/* copia as esperas da tarefa pela CPU. Retorna 0 se a tarefa nao existir
+   ou for a ociosa, que nao e medida */
+uint8_t TarefaObtemInanicao(uint8_t id_tarefa, inanicao_tarefa_t *inanicao)
+{
+	reg_atomica_t estado;
+	tick_t espera = 0;
+
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas || TCB_ESTADO(id_tarefa) == TERMINADA ||
+	   TCB_PRIORIDADE(id_tarefa) == 0)
+	{
+		return 0;
+	}
+
+	REG_ATOMICA_INICIO(estado);
+	if(TCB_ESTADO(id_tarefa) == PRONTA && id_tarefa != tarefa_atual)
+	{
+		espera = contador_marcas - pronta_desde[id_tarefa];
+	}
+	inanicao->espera_atual = espera;
+	inanicao->maior_espera = (espera > inanicao_maior[id_tarefa]) ? espera : inanicao_maior[id_tarefa];
+	inanicao->inanicoes = inanicao_contadas[id_tarefa];
+	REG_ATOMICA_FIM(estado);
+
+	return 1;
+}
+
+/* recomeca as medicoes da tarefa, ex.: depois de mudar as prioridades. A
+   espera em andamento continua */
+void TarefaZeraInanicao(uint8_t id_tarefa)
+{
+	reg_atomica_t estado;
+
+	if(id_tarefa > NUMERO_DE_TAREFAS)
+	{
+		return;
+	}
+	REG_ATOMICA_INICIO(estado);
+	inanicao_maior[id_tarefa] = 0;
+	inanicao_contadas[id_tarefa] = 0;
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+#if cfg_MARCA_VARIAVEL
+/* marcas na nova frequencia para durar o mesmo que marcas na antiga, 
+   arredondadas para cima (uma espera nunca termina antes) e limitadas a 
+   ESPERA_INFINITA - 1 */
+static tick_t ReescalaMarcas(tick_t marcas, uint32_t antiga_hz, uint32_t nova_hz)
+{
+	uint64_t reescaladas = ((uint64_t)marcas * nova_hz + antiga_hz - 1) / antiga_hz;
+	
+	return (reescaladas < ESPERA_INFINITA) ? (tick_t)reescaladas : (tick_t)(ESPERA_INFINITA - 1);
+}
+
+/* troca a frequencia da marca de tempo para marca_hz marcas por segundo. 
+   A porta reprograma o temporizador (no Cortex-M0, qualquer LOAD dos 24 
+   bits do SysTick) e a marca atual recomeca no novo periodo. O contador 
+   de marcas nao muda: a partir daqui so conta mais rapido ou mais 
+   devagar. As esperas da lista de espera, os temporizadores ligados e os 
+   prazos do EDF sao convertidos para terminar no mesmo instante, 
+   arredondados para cima; os periodos dos temporizadores ficam com o 
+   valor mais proximo, no minimo 1 marca. Os temporizadores vencidos que a 
+   tarefa de temporizadores ainda nao executou continuam vencidos. As 
+   tarefas periodicas devem recomecar a referencia de TarefaEsperaAte 
+   (*ultimo_despertar = ObtemMarcasDeTempo()) com o periodo na nova 
+   frequencia. Retorna 0, sem mudar nada, se a porta nao aceita a 
+   frequencia */
+uint8_t MarcaTempoMudaFrequencia(uint32_t marca_hz)
+{
+	uint32_t antiga_hz;
+	tick_t acumulado, convertido, anterior;
+	uint8_t tarefa;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	antiga_hz = marca_tempo_hz;
+	if(marca_hz == antiga_hz || !MarcaTempoReprograma(marca_hz))
+	{
+		REG_ATOMICA_FIM(estado);
+		return marca_hz == antiga_hz;
+	}
+	marca_tempo_hz = marca_hz;
+	
+	/* lista de espera: os deltas viram instantes a partir de agora, sao 
+	   convertidos e voltam a ser deltas, entao a ordem se mantem */
+	acumulado = 0;
+	anterior = 0;
+	for(tarefa = lista_espera; tarefa != 0; tarefa = TCB_PROX_ESPERA(tarefa))
+	{
+		acumulado += TCB_TEMPO_ESPERA(tarefa);
+		convertido = ReescalaMarcas(acumulado, antiga_hz, marca_hz);
+		TCB_TEMPO_ESPERA(tarefa) = convertido - anterior;
+		anterior = convertido;
+	}
+	
+	#if cfg_TEMPORIZADORES
+	{
+		temporizador_t *convertidos = 0, *temporizador;
+		tick_t atrasadas = contador_marcas - marca_temporizadores;
+		uint16_t posicao;
+		
+		/* a roda e indexada pelo vencimento: todos saem e voltam convertidos */
+		for(posicao = 0; posicao < cfg_RODA_TEMPORIZADORES; posicao++)
+		{
+			while((temporizador = roda_temporizadores[posicao]) != 0)
+			{
+				RetiraDaRoda(temporizador);
+				temporizador->proximo = convertidos;
+				convertidos = temporizador;
+			}
+		}
+		while((temporizador = convertidos) != 0)
+		{
+			convertidos = temporizador->proximo;
+			if(temporizador->vencimento - marca_temporizadores > atrasadas)
+			{
+				temporizador->vencimento = contador_marcas + 
+					ReescalaMarcas(temporizador->vencimento - contador_marcas, antiga_hz, marca_hz);
+			}
+			if(temporizador->periodo != 0)
+			{
+				temporizador->periodo = (tick_t)(((uint64_t)temporizador->periodo * marca_hz + antiga_hz / 2) / antiga_hz);
+				if(temporizador->periodo == 0)
+				{
+					temporizador->periodo = 1;
+				}
+			}
+			InsereNaRoda(temporizador);
+		}
+	}
+	#endif
+	
+	#if cfg_ESCALONADOR_EDF
+	/* so os prazos futuros: a conversao mantem a ordem entre eles e os que 
+	   ja passaram continuam antes, entao o heap nao muda */
+	for(tarefa = 1; tarefa <= numero_tarefas; tarefa++)
+	{
+		if(TCB[tarefa].tem_prazo && (int32_t)(TCB[tarefa].prazo - contador_marcas) > 0)
+		{
+			TCB[tarefa].prazo = contador_marcas + 
+				ReescalaMarcas(TCB[tarefa].prazo - contador_marcas, antiga_hz, marca_hz);
+		}
+	}
+	#endif
+	
+	#ifdef cfg_RELOGIO_LIVRE
+	contagens_relogio_marca = (uint32_t)((cfg_RELOGIO_LIVRE_HZ) / marca_hz);
+	relogio_ultima_marca = cfg_RELOGIO_LIVRE();		/* a marca atual recomecou */
+	#endif
+	
+	REG_ATOMICA_FIM(estado);
+	return 1;
+}
+#endif
+
+/* avanca o tempo do sistema em qtas_marcas marcas de uma vez, despertando 
+   as tarefas cujo tempo terminou. Deve ser chamada com as interrupcoes 
+   desabilitadas */
+static void AvancaMarcas(tick_t qtas_marcas)
+{
+	uint8_t tarefa = lista_espera;
+	
+	contador_marcas += qtas_marcas;
+	
+	#if cfg_VIGIA > 0
+	/* as marcas que passaram contam para as janelas das tarefas vigiadas */
+	vigia_decorridas += qtas_marcas;
+	if(vigia_decorridas >= cfg_VIGIA)
+	{
+		VerificaVigia();
+	}
+	#endif
+
+	#if cfg_INANICAO > 0
+	inanicao_decorridas += qtas_marcas;
+	if(inanicao_decorridas >= cfg_INANICAO_PERIODO)
+	{
+		VerificaInanicao();
+	}
+	#endif
+	
+	#if cfg_TEMPORIZADORES
+	/* a tarefa de temporizadores confere as marcas que passaram */
+	if(temporizadores_ativos != 0)
+	{
+		AcordaTemporizadores();
+	}
+	#endif
+	
+	/* consome os deltas da lista de espera, despertando as tarefas cujo tempo terminou */
+	while(tarefa != 0 && qtas_marcas > 0)
+	{
+		if(TCB_TEMPO_ESPERA(tarefa) > qtas_marcas)
+		{
+			TCB_TEMPO_ESPERA(tarefa) -= qtas_marcas;
+			break;
+		}
+		
+		qtas_marcas -= TCB_TEMPO_ESPERA(tarefa);
+		TCB_TEMPO_ESPERA(tarefa) = 0;
+		
+		while(tarefa != 0 && TCB_TEMPO_ESPERA(tarefa) == 0)
+		{
+			tarefa = DespertaPrimeiraDaListaDeEspera();
+		}
+	}
+}
+
+/* avanca o tempo do sistema em varias marcas de uma vez, apos um periodo 
+   sem marcas de tempo (modo ocioso tickless). Chamada pela porta da cpu 
+   com as interrupcoes desabilitadas */
+void CompensaMarcasDeTempo(tick_t qtas_marcas)
+{
+	#if cfg_OCIOSA_SEM_MARCAS
+	marcas_dormidas += qtas_marcas;
+	#endif
+	AvancaMarcas(qtas_marcas);
+	#ifdef cfg_RELOGIO_LIVRE
+	relogio_ultima_marca = cfg_RELOGIO_LIVRE();	/* as marcas dormidas nao se perderam */
+	#endif
+}
+
+#ifdef cfg_RELOGIO_LIVRE
+/* processa de uma vez as marcas perdidas desde a anterior, medidas pelo 
+   relogio livre: mais de uma marca entre duas execucoes da marca de tempo 
+   quer dizer que as interrupcoes ficaram desabilitadas por mais de uma 
+   marca. A fase e refeita a cada marca, entao a diferenca entre o relogio 
+   livre e o SysTick nao se acumula */
+static void RecuperaMarcasPerdidas(void)
+{
+	uint32_t agora = cfg_RELOGIO_LIVRE();
+	uint32_t decorridas = (agora - relogio_ultima_marca) / CONTAGENS_RELOGIO_MARCA;
+	
+	if(relogio_medindo && decorridas > 1)
+	{
+		AvancaMarcas(decorridas - 1);		/* a atual e contada pela marca */
+	}
+	relogio_ultima_marca = agora;
+	relogio_medindo = 1;
+}
+#endif
+
+#if cfg_ORCAMENTO
+/* devolve a prioridade ou a execucao a tarefa que esgotou o orcamento. 
+   A tarefa suspensa so volta se continua parada pelo orcamento, fora das 
+   listas de espera. Deve ser chamada com as interrupcoes desabilitadas */
+static void DevolveOrcamento(uint8_t tarefa)
+{
+	orcamento_estourado[tarefa] = 0;
+	if(orcamento_esgotado[tarefa] == ORCAMENTO_SUSPENDE)
+	{
+		if(TCB_ESTADO(tarefa) == ESPERA && TCB[tarefa].lista_evento == 0 && 
+			TCB_PROX_ESPERA(tarefa) == FORA_DA_LISTA && !TCB[tarefa].esperando_notificacao)
+		{
+			TarefaPronta(tarefa);
+		}
+	}
+	else if(TCB_PRIORIDADE(tarefa) < TCB[tarefa].prioridade_base)
+	{
+		MudaPrioridade(tarefa, TCB[tarefa].prioridade_base);
+	}
+}
+
+/* repoe o orcamento das tarefas cujo periodo terminou e calcula a proxima 
+   reposicao. Chamada pela marca de tempo uma vez por periodo */
+static void RepoeOrcamentos(void)
+{
+	uint8_t tarefa;
+	tick_t proxima = contador_marcas + 0xFFFFUL;	/* maior periodo */
+	
+	for(tarefa = 1; tarefa <= numero_tarefas; tarefa++)
+	{
+		if(orcamento_marcas[tarefa] == 0)
+		{
+			continue;
+		}
+		if((int32_t)(contador_marcas - orcamento_reposicao[tarefa]) >= 0)
+		{
+			orcamento_reposicao[tarefa] += orcamento_periodo[tarefa];
+			if((int32_t)(contador_marcas - orcamento_reposicao[tarefa]) >= 0)
+			{
+				/* periodos inteiros sem marcas (ocioso sem marcas) */
+				orcamento_reposicao[tarefa] = contador_marcas + orcamento_periodo[tarefa];
+			}
+			orcamento_restante[tarefa] = orcamento_marcas[tarefa];
+			if(orcamento_estourado[tarefa])
+			{
+				DevolveOrcamento(tarefa);
+			}
+		}
+		if((int32_t)(orcamento_reposicao[tarefa] - proxima) < 0)
+		{
+			proxima = orcamento_reposicao[tarefa];
+		}
+	}
+	proxima_reposicao = proxima;
+}
+
+/* desconta a marca que passou do orcamento da tarefa atual e repoe os 
+   orcamentos no fim dos periodos. A tarefa que esgota o orcamento e 
+   rebaixada ou suspensa, e a troca de contexto e solicitada */
+static void DescontaOrcamento(void)
+{
+	uint8_t tarefa = tarefa_atual;
+	
+	if(orcamento_marcas[tarefa] != 0 && !orcamento_estourado[tarefa] && 
+		--orcamento_restante[tarefa] == 0)
+	{
+		orcamento_estourado[tarefa] = 1;
+		orcamento_estouros[tarefa]++;
+		if(orcamento_esgotado[tarefa] == ORCAMENTO_SUSPENDE)
+		{
+			TarefaBloqueia(tarefa);
+		}
+		else if(TCB_PRIORIDADE(tarefa) > orcamento_esgotado[tarefa])
+		{
+			MudaPrioridade(tarefa, orcamento_esgotado[tarefa]);
+		}
+		TrocaContextoSeNecessario();	/* mesmo na tarefa cooperativa */
+	}
+	
+	/* as tarefas devolvidas preemptam a atual pelo limiar, como as acordadas */
+	if((int32_t)(contador_marcas - proxima_reposicao) >= 0)
+	{
+		RepoeOrcamentos();
+	}
+}
+
+/* limita a tarefa a marcas marcas de execucao a cada periodo marcas, com o 
+   primeiro periodo comecando agora. Ao esgotar o orcamento, a tarefa passa 
+   a prioridade esgotado (ex.: 1, abaixo das tarefas criticas) ou, com 
+   ORCAMENTO_SUSPENDE, fica suspensa ate o fim do periodo. A prioridade e 
+   a execucao voltam na reposicao. O desconto e feito pela marca de tempo, 
+   entao a tarefa que sempre bloqueia antes dela nao e descontada. 
+   marcas = 0 retira o orcamento. Retorna 0 se os parametros sao invalidos 
+   ou a tarefa e basica, cuja posicao na pilha compartilhada depende da 
+   prioridade */
+uint8_t TarefaOrcamento(uint8_t id_tarefa, uint16_t marcas, uint16_t periodo, prioridade_t esgotado)
+{
+	reg_atomica_t estado;
+	
+	if(id_tarefa == 0 || id_tarefa > numero_tarefas || marcas > periodo || 
+		(esgotado > PRIORIDADE_MAXIMA && esgotado != ORCAMENTO_SUSPENDE))
+	{
+		return 0;
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	if(TCB[id_tarefa].funcao_basica != 0)
+	{
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	#endif
+	if(TCB_ESTADO(id_tarefa) == TERMINADA)
+	{
+		REG_ATOMICA_FIM(estado);
+		return 0;
+	}
+	
+	if(orcamento_estourado[id_tarefa])
+	{
+		DevolveOrcamento(id_tarefa);
+	}
+	if(orcamento_marcas[id_tarefa] == 0 && marcas != 0)
+	{
+		tarefas_com_orcamento++;
+	}
+	else if(orcamento_marcas[id_tarefa] != 0 && marcas == 0)
+	{
+		tarefas_com_orcamento--;
+	}
+	orcamento_marcas[id_tarefa] = marcas;
+	orcamento_restante[id_tarefa] = marcas;
+	orcamento_periodo[id_tarefa] = periodo;
+	orcamento_esgotado[id_tarefa] = esgotado;
+	orcamento_reposicao[id_tarefa] = contador_marcas + periodo;
+	if(marcas != 0 && (tarefas_com_orcamento == 1 || 
+		(int32_t)(orcamento_reposicao[id_tarefa] - proxima_reposicao) < 0))
+	{
+		proxima_reposicao = orcamento_reposicao[id_tarefa];
+	}
+	TrocaContextoSeNecessario();
+	REG_ATOMICA_FIM(estado);
+	return 1;
+}
+
+/* numero de vezes que a tarefa esgotou o orcamento */
+uint16_t TarefaOrcamentoEstouros(uint8_t id_tarefa)
+{
+	return (id_tarefa <= NUMERO_DE_TAREFAS) ? orcamento_estouros[id_tarefa] : 0;
+}
+#endif
+
+NUCLEO_RAPIDO void ExecutaMarcaDeTempo(void)
+{
+	
+	uint8_t tarefa;
+	#if cfg_RASTRO > 0
+	uint16_t despertadas = 0;
+	#endif
+	
+	#ifdef cfg_RELOGIO_LIVRE
+	RecuperaMarcasPerdidas();
+	#endif
+	tarefa = lista_espera;
+		
+	++contador_marcas; /* incrementa contador de marcas de tempo */
+	
+	/* somente a primeira tarefa da lista de espera e decrementada, 
+	 * as demais guardam apenas a diferenca em relacao a anterior */
+	if(tarefa != 0)
+	{
+		TCB_TEMPO_ESPERA(tarefa)--; /* decrementa tempo de espera */
+		
+		/* coloca na fila de prontas todas as tarefas cujo tempo terminou */
+		while(tarefa != 0 && TCB_TEMPO_ESPERA(tarefa) == 0)
+		{
+			tarefa = DespertaPrimeiraDaListaDeEspera();
+			#if cfg_RASTRO > 0
+			despertadas++;
+			#endif
+		}
+		
+		#if cfg_RASTRO > 0
+		if(despertadas != 0)
+		{
+			RASTRO(RASTRO_MARCA, tarefa_atual, despertadas);
+		}
+		#endif
+	}
+	
+	#if cfg_FATIA_TEMPO > 0
+	/* fim da fatia de tempo: a tarefa atual vai para o fim da fila
+	   da sua prioridade, se houver outra tarefa pronta com a mesma prioridade */
+	if(--fatia_restante == 0)
+	{
+		prioridade_t prioridade = TCB_ATUAL_PRIORIDADE();
+		
+		fatia_restante = cfg_FATIA_TEMPO;
+		#if cfg_PILHA_TAREFAS_BASICAS > 0
+		/* a tarefa basica executa ate o fim: se outra da mesma prioridade 
+		   comecasse, as duas disputariam o mesmo trecho da pilha */
+		if(tcb_atual->funcao_basica == 0 &&
+			Prioridades[prioridade] == tarefa_atual && tcb_atual->proxima != tarefa_atual)
+		#else
+		if(Prioridades[prioridade] == tarefa_atual && tcb_atual->proxima != tarefa_atual)
+		#endif
+		{
+			Prioridades[prioridade] = tcb_atual->proxima;
+			TrocaContexto();	/* solicita troca de contexto para a proxima tarefa da fila */
+		}
+	}
+	#endif
+	
+	#if cfg_TEMPORIZADORES
+	/* algum temporizador pode vencer nesta marca */
+	if(roda_temporizadores[contador_marcas & MASCARA_RODA] != 0)
+	{
+		AcordaTemporizadores();
+	}
+	#endif
+	
+	#if cfg_VIGIA > 0
+	if(++vigia_decorridas >= cfg_VIGIA)
+	{
+		VerificaVigia();
+	}
+	#endif
+
+	#if cfg_INANICAO > 0
+	if(++inanicao_decorridas >= cfg_INANICAO_PERIODO)
+	{
+		VerificaInanicao();
+	}
+	#endif
+	
+	#if cfg_ORCAMENTO
+	if(tarefas_com_orcamento != 0)
+	{
+		DescontaOrcamento();
+	}
+	#endif
+	
+	PreemptaSeNecessario();		/* a troca acontece apos o fim da interrupcao (PendSV) */
+}
+
+#if cfg_GRUPOS_EVENTOS
+/* Servicos de grupos de eventos */
+
+/* 1 se os bits do grupo satisfazem a espera por esperados com as opcoes */
+static uint8_t EventosSatisfeitos(uint32_t bits, uint32_t esperados, uint8_t opcoes)
+{
+	if(opcoes & EVENTOS_TODOS)
+	{
+		return (bits & esperados) == esperados;
+	}
+	return (bits & esperados) != 0;
+}
+
+/* liga os bits e acorda, da maior para a menor prioridade, as tarefas cuja 
+   espera ficou satisfeita; cada uma recebe os bits do grupo nesse momento. 
+   Os bits das esperas com EVENTOS_ZERA sao zerados depois de percorrer a 
+   lista, entao todas as tarefas satisfeitas pelos mesmos bits acordam. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static void LigaEventos(grupo_eventos_t* grupo, uint32_t bits)
+{
+	uint8_t *lista = &grupo->tarefaEsperando;
+	uint32_t zera = 0;
+	uint8_t tarefa;
+	
+	grupo->bits |= bits;
+	while(*lista != 0)
+	{
+		tarefa = *lista;
+		if(EventosSatisfeitos(grupo->bits, TCB[tarefa].eventos, TCB[tarefa].opcoes_eventos))
+		{
+			if(TCB[tarefa].opcoes_eventos & EVENTOS_ZERA)
+			{
+				zera |= TCB[tarefa].eventos;
+			}
+			TCB[tarefa].eventos = grupo->bits;
+			(void)AcordaDaListaDeEvento(lista);		/* a seguinte passa a ser *lista */
+		}else
+		{
+			lista = &TCB[tarefa].prox_evento;
+		}
+	}
+	grupo->bits &= ~zera;
+}
+
+void GrupoEventosInicia(grupo_eventos_t* grupo)
+{
+	grupo->bits = 0;
+	grupo->tarefaEsperando = 0;
+}
+
+/* liga os bits do grupo e retorna os bits que ficaram ligados, depois de 
+   zerados os das esperas satisfeitas com EVENTOS_ZERA. Nunca bloqueia, 
+   pode ser usada em interrupcoes (a troca de contexto fica pendente no 
+   PendSV) */
+uint32_t GrupoEventosLiga(grupo_eventos_t* grupo, uint32_t bits)
+{
+	uint32_t resultado;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	LigaEventos(grupo, bits);
+	resultado = grupo->bits;
+	TrocaContextoSeNecessario();
+	REG_ATOMICA_FIM(estado);
+	
+	return resultado;
+}
+
+/* zera os bits do grupo e retorna os bits de antes. Pode ser usada em 
+   interrupcoes */
+uint32_t GrupoEventosZera(grupo_eventos_t* grupo, uint32_t bits)
+{
+	uint32_t anteriores;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	anteriores = grupo->bits;
+	grupo->bits = anteriores & ~bits;
+	REG_ATOMICA_FIM(estado);
+	
+	return anteriores;
+}
+
+/* espera qualquer dos bits (EVENTOS_QUALQUER) ou todos eles 
+   (EVENTOS_TODOS) por no maximo timeout marcas (0 nao espera, 
+   ESPERA_INFINITA espera sem limite). Retorna os bits do grupo quando a 
+   espera terminou, antes de zerar os esperados com EVENTOS_ZERA; se o 
+   tempo se esgotou, os bits atuais, que nao satisfazem a espera */
+uint32_t GrupoEventosAguarda(grupo_eventos_t* grupo, uint32_t bits, uint8_t opcoes, tick_t timeout)
+{
+	uint32_t resultado;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	resultado = grupo->bits;
+	if(EventosSatisfeitos(resultado, bits, opcoes))
+	{
+		if(opcoes & EVENTOS_ZERA)
+		{
+			grupo->bits = resultado & ~bits;
+		}
+	}else if(timeout > 0)
+	{
+		tcb_atual->eventos = bits;
+		tcb_atual->opcoes_eventos = opcoes;
+		AguardaEvento(&grupo->tarefaEsperando, timeout);
+		REG_ATOMICA_FIM(estado);			/* retorna com os bits ou quando o tempo se esgotar */
+		REG_ATOMICA_INICIO(estado);
+		/* LigaEventos deixa os bits do grupo em eventos e ja zerou os esperados */
+		resultado = tcb_atual->tempo_esgotado ? grupo->bits : tcb_atual->eventos;
+	}
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return resultado;
+}
+
+/* liga bits no grupo sempre que o contador do semaforo subir sem tarefa 
+   esperando, e ja se houver contagem. A tarefa que espera o grupo retira 
+   as contagens com SemaforoAguardaTempo(sem, 0) ate retornar 0: assim 
+   uma contagem que chega depois de zerado o bit o liga de novo */
+void SemaforoAssociaGrupo(semaforo_t* sem, grupo_eventos_t* grupo, uint32_t bits)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	sem->grupo = grupo;
+	sem->bits_grupo = bits;
+	if(grupo != 0 && sem->contador > 0)
+	{
+		LigaEventos(grupo, bits);
+		TrocaContextoSeNecessario();
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+/* liga bits no grupo sempre que uma mensagem ficar na fila, e ja se houver 
+   mensagens. Como no semaforo, a tarefa que espera o grupo esvazia a fila 
+   com FilaRecebeISR */
+void FilaAssociaGrupo(fila_t* fila, grupo_eventos_t* grupo, uint32_t bits)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	fila->grupo = grupo;
+	fila->bits_grupo = bits;
+	if(grupo != 0 && fila->quantidade > 0)
+	{
+		LigaEventos(grupo, bits);
+		TrocaContextoSeNecessario();
+	}
+	REG_ATOMICA_FIM(estado);
+}
+#endif
+
+/* Servicos de semaforos */
+void SemaforoAguarda(semaforo_t* sem)
+{
+	reg_atomica_t estado;
+	#if cfg_TEMPO_BLOQUEIO
+	uint32_t inicio;
+	#endif
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	#if cfg_ESPERAS_SEMAFORO
+	sem->aguardas++;
+	#endif
+	if(sem->contador > 0)
+	{
+		sem->contador--;
+		RASTRO(RASTRO_SEMAFORO_AGUARDA, tarefa_atual, (uintptr_t)sem);
+	}else
+	{
+		#if cfg_ESPERAS_SEMAFORO
+		sem->bloqueios++;
+		#endif
+		RASTRO(RASTRO_SEMAFORO_BLOQUEIA, tarefa_atual, (uintptr_t)sem);
+		#if cfg_TEMPO_BLOQUEIO
+		inicio = RELOGIO_BLOQUEIO();
+		#endif
+		TarefaBloqueia(tarefa_atual);			/* tarefa colocada na fila de espera */
+		InsereNaListaDeEvento(&sem->tarefaEsperando, tarefa_atual);   	/* tarefa colocada na espera do semaforo, por prioridade */
+		TROCA_CONTEXTO();						/* solicita troca de contexto */
+		#if cfg_TEMPO_BLOQUEIO
+		REG_ATOMICA_FIM(estado);				/* retorna com o semaforo */
+		REG_ATOMICA_INICIO(estado);
+		ContaBloqueio(&sem->bloqueio, inicio);
+		#endif
+	}
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+
+void SemaforoLibera(semaforo_t* sem)
+{
+	SemaforoLiberaISR(sem);		/* a troca pendente acontece ao fim da regiao atomica */
+}
+
+/* espera o semaforo por no maximo timeout marcas (0 nao espera, 
+   ESPERA_INFINITA espera sem limite). Retorna 1 se obteve o semaforo ou 
+   0 se o tempo se esgotou. A tarefa fica ao mesmo tempo na espera do 
+   semaforo e na lista de espera por tempo, e sai da outra ao sair de uma */
+uint8_t SemaforoAguardaTempo(semaforo_t* sem, tick_t timeout)
+{
+	uint8_t obtido = 1;
+	reg_atomica_t estado;
+	#if cfg_TEMPO_BLOQUEIO
+	uint32_t inicio;
+	#endif
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	#if cfg_ESPERAS_SEMAFORO
+	sem->aguardas++;
+	#endif
+	if(sem->contador > 0)
+	{
+		sem->contador--;
+		RASTRO(RASTRO_SEMAFORO_AGUARDA, tarefa_atual, (uintptr_t)sem);
+	}else if(timeout == 0)
+	{
+		obtido = 0;
+	}else
+	{
+		#if cfg_ESPERAS_SEMAFORO
+		sem->bloqueios++;
+		#endif
+		RASTRO(RASTRO_SEMAFORO_BLOQUEIA, tarefa_atual, (uintptr_t)sem);
+		#if cfg_TEMPO_BLOQUEIO
+		inicio = RELOGIO_BLOQUEIO();
+		#endif
+		AguardaEvento(&sem->tarefaEsperando, timeout);
+		REG_ATOMICA_FIM(estado);				/* retorna com o semaforo ou quando o tempo se esgotar */
+		REG_ATOMICA_INICIO(estado);
+		obtido = !tcb_atual->tempo_esgotado;	/* SemaforoLibera passa o semaforo direto para a tarefa */
+		#if cfg_TEMPO_BLOQUEIO
+		ContaBloqueio(&sem->bloqueio, inicio);	/* as esperas esgotadas tambem contam */
+		#endif
+	}
+	#if cfg_ESPERAS_SEMAFORO
+	if(!obtido)
+	{
+		sem->esgotados++;
+	}
+	#endif
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return obtido;
+}
+
+/* versao para rotinas de interrupcao: a troca de contexto, se necessaria, 
+   fica pendente no PendSV e acontece somente ao fim da interrupcao */
+void SemaforoLiberaISR(semaforo_t* sem)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(sem->tarefaEsperando > 0)
+	{	/* tem alguma tarefa aguardando ? */
+		/* a tarefa de maior prioridade e retirada da espera do semaforo 
+		   e colocada na fila de pronta */
+		RASTRO(RASTRO_SEMAFORO_LIBERA, sem->tarefaEsperando, (uintptr_t)sem);
+		(void)AcordaDaListaDeEvento(&sem->tarefaEsperando);	/* cancela o limite de tempo, se houver */
+	}else
+	{
+		RASTRO(RASTRO_SEMAFORO_LIBERA, 0, (uintptr_t)sem);
+		sem->contador++;
+		#if cfg_REGISTRO_OBJETOS
+		if(sem->contador > sem->maximo)
+		{
+			sem->maximo = sem->contador;
+		}
+		#endif
+		#if cfg_GRUPOS_EVENTOS
+		if(sem->grupo != 0)
+		{
+			LigaEventos(sem->grupo, sem->bits_grupo);
+		}
+		#endif
+	}
+	TrocaContextoSeNecessario();
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* libera o semaforo n vezes numa so regiao atomica, para as interrupcoes 
+   que entregam varios itens de uma vez (ex.: fim de um DMA com n blocos): 
+   acorda ate n tarefas, na ordem de prioridade, soma o restante ao 
+   contador, que para em 255, e decide a troca de contexto uma vez so. 
+   Pode ser usada em tarefas e interrupcoes */
+void SemaforoLiberaN(semaforo_t* sem, uint8_t n)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	while(n > 0 && sem->tarefaEsperando > 0)
+	{
+		RASTRO(RASTRO_SEMAFORO_LIBERA, sem->tarefaEsperando, (uintptr_t)sem);
+		(void)AcordaDaListaDeEvento(&sem->tarefaEsperando);
+		n--;
+	}
+	if(n > 0)
+	{
+		RASTRO(RASTRO_SEMAFORO_LIBERA, 0, (uintptr_t)sem);
+		sem->contador = ((uint16_t)sem->contador + n > 0xFF) ? 0xFF : (uint8_t)(sem->contador + n);
+		#if cfg_REGISTRO_OBJETOS
+		if(sem->contador > sem->maximo)
+		{
+			sem->maximo = sem->contador;
+		}
+		#endif
+		#if cfg_GRUPOS_EVENTOS
+		if(sem->grupo != 0)
+		{
+			LigaEventos(sem->grupo, sem->bits_grupo);
+		}
+		#endif
+	}
+	TrocaContextoSeNecessario();
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* Servicos de mutex */
+void MutexAguarda(mutex_t* mutex)
+{
+	reg_atomica_t estado;
+	#if cfg_TEMPO_BLOQUEIO
+	uint32_t inicio;
+	#endif
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(mutex->dono == 0)
+	{
+		mutex->dono = tarefa_atual;				/* mutex livre: tarefa atual passa a ser a dona */
+		tcb_atual->mutexes++;
+	}else
+	{
+		/* heranca de prioridade: a dona passa a executar com a prioridade 
+		   da tarefa que espera, se esta for maior, evitando que tarefas de 
+		   prioridade intermediaria atrasem a liberacao do mutex */
+		if(TCB_PRIORIDADE(mutex->dono) < TCB_ATUAL_PRIORIDADE())
+		{
+			MudaPrioridade(mutex->dono, TCB_ATUAL_PRIORIDADE());
+		}
+		
+		#if cfg_TEMPO_BLOQUEIO
+		inicio = RELOGIO_BLOQUEIO();
+		#endif
+		TarefaBloqueia(tarefa_atual);			/* tarefa colocada na fila de espera */
+		InsereNaListaDeEvento(&mutex->tarefaEsperando, tarefa_atual);   	/* tarefa colocada na espera do mutex, por prioridade */
+		TROCA_CONTEXTO();						/* solicita troca de contexto, so retorna como dona do mutex */
+		#if cfg_TEMPO_BLOQUEIO
+		REG_ATOMICA_FIM(estado);
+		REG_ATOMICA_INICIO(estado);
+		ContaBloqueio(&mutex->bloqueio, inicio);
+		#endif
+	}
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+
+void MutexLibera(mutex_t* mutex)
+{
+	uint8_t tarefa;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(mutex->dono != tarefa_atual)
+	{
+		REG_ATOMICA_FIM(estado);
+		return;		/* somente a dona pode liberar o mutex */
+	}
+	
+	/* ao liberar o ultimo mutex, a tarefa volta a sua prioridade original */
+	tcb_atual->mutexes--;
+	if(tcb_atual->mutexes == 0 && TCB_ATUAL_PRIORIDADE() != tcb_atual->prioridade_base)
+	{
+		MudaPrioridade(tarefa_atual, tcb_atual->prioridade_base);
+	}
+	
+	/* o mutex e passado diretamente para a tarefa de maior prioridade que o espera */
+	tarefa = RetiraDaListaDeEvento(&mutex->tarefaEsperando);
+	mutex->dono = tarefa;
+	if(tarefa != 0)
+	{
+		TCB[tarefa].mutexes++;
+		
+		/* a nova dona herda a prioridade das tarefas que continuam esperando */
+		if(mutex->tarefaEsperando != 0 && TCB_PRIORIDADE(mutex->tarefaEsperando) > TCB_PRIORIDADE(tarefa))
+		{
+			TCB_PRIORIDADE(tarefa) = TCB_PRIORIDADE(mutex->tarefaEsperando);
+		}
+		TarefaPronta(tarefa);					/* tarefa colocada na fila de pronta */
+	}
+	TrocaContextoSeNecessario();			/* nova dona com maior prioridade ou fim da heranca */
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* Servicos de variaveis de condicao */
+
+/* libera o mutex, que a tarefa atual deve possuir, e espera o sinal da 
+   condicao por no maximo timeout marcas (ESPERA_INFINITA = sem limite), 
+   sem intervalo entre as duas coisas: um sinal dado logo depois de o 
+   mutex ser liberado nao se perde. Retoma o mutex antes de retornar. 
+   Retorna 1 se foi sinalizada ou 0 se o tempo se esgotou; com timeout 0 
+   nao espera: so libera e retoma o mutex e retorna 0 */
+uint8_t CondicaoAguarda(condicao_t* condicao, mutex_t* mutex, tick_t timeout)
+{
+	uint8_t sinalizada;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	MutexLibera(mutex);				/* a troca pedida so acontece ao fim da regiao */
+	if(timeout == 0)
+	{
+		/* uma espera de 0 marcas nao pode ir para a lista de espera */
+		REG_ATOMICA_FIM(estado);
+		MutexAguarda(mutex);
+		return 0;
+	}
+	AguardaEvento(&condicao->tarefaEsperando, timeout);
+	REG_ATOMICA_FIM(estado);		/* retorna com o sinal ou quando o tempo se esgotar */
+	
+	sinalizada = !tcb_atual->tempo_esgotado;
+	MutexAguarda(mutex);
+	
+	return sinalizada;
+}
+
+/* acorda a tarefa de maior prioridade que espera a condicao, se houver. 
+   Pode ser usada em interrupcoes */
+void CondicaoSinaliza(condicao_t* condicao)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	if(AcordaDaListaDeEvento(&condicao->tarefaEsperando) != 0)
+	{
+		TrocaContextoSeNecessario();
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+/* acorda todas as tarefas que esperam a condicao; elas retomam o mutex 
+   uma de cada vez, da maior para a menor prioridade */
+void CondicaoDifunde(condicao_t* condicao)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	if(condicao->tarefaEsperando != 0)
+	{
+		while(AcordaDaListaDeEvento(&condicao->tarefaEsperando) != 0)
+		{
+		}
+		TrocaContextoSeNecessario();
+	}
+	REG_ATOMICA_FIM(estado);
+}
+
+/* Servicos de travas de leitura e escrita */
+
+/* passa a escrita ao primeiro escritor que espera, que herda a prioridade 
+   dos que continuam esperando */
+static void PassaEscrita(trava_rw_t* trava)
+{
+	uint8_t tarefa = RetiraDaListaDeEvento(&trava->escritoresEsperando);
+	
+	trava->escritor = tarefa;
+	TCB[tarefa].mutexes++;
+	if(trava->escritoresEsperando != 0 && TCB_PRIORIDADE(trava->escritoresEsperando) > TCB_PRIORIDADE(tarefa))
+	{
+		TCB_PRIORIDADE(tarefa) = TCB_PRIORIDADE(trava->escritoresEsperando);
+	}
+	TarefaPronta(tarefa);
+}
+
+/* 1 se um escritor escreve, ou espera com prioridade igual ou maior que 
+   a prioridade dada */
+static uint8_t EscritaPrecede(const trava_rw_t* trava, prioridade_t prioridade)
+{
+	return trava->escritor != 0 || 
+		   (trava->escritoresEsperando != 0 && TCB_PRIORIDADE(trava->escritoresEsperando) >= prioridade);
+}
+
+void TravaLeituraAguarda(trava_rw_t* trava)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(!EscritaPrecede(trava, TCB_ATUAL_PRIORIDADE()))
+	{
+		trava->leitores++;						/* sem escritor: so conta o leitor */
+	}else
+	{
+		TarefaBloqueia(tarefa_atual);
+		InsereNaListaDeEvento(&trava->leitoresEsperando, tarefa_atual);
+		TROCA_CONTEXTO();						/* so retorna ja contada como leitora */
+	}
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+void TravaLeituraLibera(trava_rw_t* trava)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(trava->leitores != 0)
+	{
+		trava->leitores--;
+		if(trava->leitores == 0 && trava->escritoresEsperando != 0)
+		{
+			PassaEscrita(trava);				/* ultimo leitor: o escritor que espera entra */
+			TrocaContextoSeNecessario();
+		}
+	}
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+void TravaEscritaAguarda(trava_rw_t* trava)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(trava->escritor == 0 && trava->leitores == 0)
+	{
+		trava->escritor = tarefa_atual;
+		tcb_atual->mutexes++;					/* a heranca termina como a do mutex */
+	}else
+	{
+		if(trava->escritor != 0 && TCB_PRIORIDADE(trava->escritor) < TCB_ATUAL_PRIORIDADE())
+		{
+			MudaPrioridade(trava->escritor, TCB_ATUAL_PRIORIDADE());
+		}
+		TarefaBloqueia(tarefa_atual);
+		InsereNaListaDeEvento(&trava->escritoresEsperando, tarefa_atual);
+		TROCA_CONTEXTO();						/* so retorna como escritora */
+	}
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* a escrita vai para o proximo escritor, ou para todos os leitores que 
+   esperam se o de maior prioridade deles passa a frente dos escritores */
+void TravaEscritaLibera(trava_rw_t* trava)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	if(trava->escritor != tarefa_atual)
+	{
+		REG_ATOMICA_FIM(estado);
+		return;		/* somente a escritora pode liberar a escrita */
+	}
+	
+	tcb_atual->mutexes--;
+	if(tcb_atual->mutexes == 0 && TCB_ATUAL_PRIORIDADE() != tcb_atual->prioridade_base)
+	{
+		MudaPrioridade(tarefa_atual, tcb_atual->prioridade_base);
+	}
+	trava->escritor = 0;
+	
+	/* os leitores que esperam entram juntos, ate o primeiro que um escritor 
+	   ainda preceda; sem nenhum, entra o escritor */
+	while(trava->leitoresEsperando != 0 && !EscritaPrecede(trava, TCB_PRIORIDADE(trava->leitoresEsperando)))
+	{
+		TarefaPronta(RetiraDaListaDeEvento(&trava->leitoresEsperando));
+		trava->leitores++;
+	}
+	if(trava->leitores == 0 && trava->escritoresEsperando != 0)
+	{
+		PassaEscrita(trava);
+	}
+	TrocaContextoSeNecessario();
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* Servicos de blocos de memoria de tamanho fixo */
+
+/* prepara o conjunto de numero blocos de tamanho bytes na area, que deve 
+   ter numero * MEMORIA_TAMANHO_BLOCO(tamanho) bytes alinhados para 
+   ponteiros (ver MEMORIA_AREA) */
+void MemoriaInicia(memoria_t* memoria, void* area, uint16_t tamanho, uint16_t numero)
+{
+	uint8_t *bloco = (uint8_t*)area;
+	uint16_t i;
+	
+	memoria->tamanho = (uint16_t)MEMORIA_TAMANHO_BLOCO(tamanho);
+	memoria->quantidade = numero;
+	memoria->tarefaEsperando = 0;
+	memoria->livres = (numero > 0) ? area : 0;
+	#if cfg_REGISTRO_OBJETOS
+	memoria->minimo = numero;
+	#endif
+	
+	/* encadeia os blocos livres na ordem da area */
+	for(i = 1; i <= numero; i++)
+	{
+		*(void**)bloco = (i < numero) ? (void*)(bloco + memoria->tamanho) : 0;
+		bloco += memoria->tamanho;
+	}
+}
+
+/* retira o primeiro bloco livre, ou retorna 0 se nao houver. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static void* MemoriaRetira(memoria_t* memoria)
+{
+	void *bloco = memoria->livres;
+	
+	if(bloco != 0)
+	{
+		memoria->livres = *(void**)bloco;
+		memoria->quantidade--;
+		#if cfg_REGISTRO_OBJETOS
+		if(memoria->quantidade < memoria->minimo)
+		{
+			memoria->minimo = memoria->quantidade;
+		}
+		#endif
+	}
+	return bloco;
+}
+
+/* aloca um bloco, esperando no maximo timeout marcas por um bloco livre 
+   (0 nao espera, ESPERA_INFINITA espera sem limite). Retorna 0 se o 
+   tempo se esgotar */
+void* MemoriaAloca(memoria_t* memoria, tick_t timeout)
+{
+	void *bloco;
+	tick_t inicio = contador_marcas;
+	tick_t decorrido;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	while((bloco = MemoriaRetira(memoria)) == 0)
+	{
+		decorrido = contador_marcas - inicio;
+		if(timeout != ESPERA_INFINITA && decorrido >= timeout)
+		{
+			break;		/* tempo esgotado */
+		}
+		AguardaEvento(&memoria->tarefaEsperando, 
+			(timeout == ESPERA_INFINITA) ? ESPERA_INFINITA : timeout - decorrido);
+		REG_ATOMICA_FIM(estado);				/* retorna quando houver bloco livre ou o tempo se esgotar */
+		REG_ATOMICA_INICIO(estado);
+	}
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return bloco;
+}
+
+/* versao sem espera, para uso em rotinas de interrupcao. 
+   Retorna 0 se nao houver bloco livre */
+void* MemoriaAlocaISR(memoria_t* memoria)
+{
+	void *bloco;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	bloco = MemoriaRetira(memoria);
+	REG_ATOMICA_FIM(estado);
+	
+	return bloco;
+}
+
+void MemoriaLibera(memoria_t* memoria, void* bloco)
+{
+	MemoriaLiberaISR(memoria, bloco);		/* a troca pendente acontece ao fim da regiao atomica */
+}
+
+/* devolve o bloco e acorda a tarefa de maior prioridade esperando por um. 
+   A troca de contexto, se necessaria, fica pendente no PendSV */
+void MemoriaLiberaISR(memoria_t* memoria, void* bloco)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	*(void**)bloco = memoria->livres;
+	memoria->livres = bloco;
+	memoria->quantidade++;
+	
+	if(AcordaDaListaDeEvento(&memoria->tarefaEsperando) != 0)
+	{
+		TrocaContextoSeNecessario();
+	}
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* Servicos de arena (rascunho de um ciclo) */
+
+/* prepara a arena na area de tamanho bytes, alinhada para ponteiros 
+   (ver ARENA_AREA) */
+void ArenaInicia(arena_t* arena, void* area, uint16_t tamanho)
+{
+	arena->area = (uint8_t*)area;
+	arena->tamanho = tamanho;
+	arena->usado = 0;
+	arena->maximo = 0;
+	arena->falhas = 0;
+}
+
+/* aloca tamanho bytes, alinhados para ponteiros, sem esperar. Retorna 0 
+   se nao couberem ate ArenaZera */
+void* ArenaAloca(arena_t* arena, uint16_t tamanho)
+{
+	uint32_t alinhado = MEMORIA_TAMANHO_BLOCO((uint32_t)tamanho);
+	void *bloco;
+	
+	if(alinhado > (uint32_t)(arena->tamanho - arena->usado))
+	{
+		arena->falhas++;
+		return 0;
+	}
+	bloco = &arena->area[arena->usado];
+	arena->usado = (uint16_t)(arena->usado + alinhado);
+	if(arena->usado > arena->maximo)
+	{
+		arena->maximo = arena->usado;
+	}
+	return bloco;
+}
+
+/* Servicos de anel de bytes (um produtor, um consumidor) */
+
+/* prepara o anel na area de capacidade bytes. O consumidor que espera em 
+   AnelAguarda e acordado quando houver limiar bytes (1 a capacidade). 
+   Retorna 0 se a capacidade nao for potencia de 2 ou passar de 32768 */
+uint8_t AnelInicia(anel_t* anel, uint8_t* area, uint16_t capacidade, uint16_t limiar)
+{
+	if(capacidade == 0 || capacidade > 32768U || (capacidade & (capacidade - 1)) != 0)
+	{
+		return 0;
+	}
+	
+	anel->area = area;
+	anel->mascara = (uint16_t)(capacidade - 1);
+	anel->escrita = 0;
+	anel->leitura = 0;
+	anel->limiar = (limiar == 0) ? 1 : (limiar > capacidade) ? capacidade : limiar;
+	anel->espaco = 0;
+	anel->tarefaEsperando = 0;
+	anel->tarefaEscrevendo = 0;
+	
+	return 1;
+}
+
+/* escreve ate quantidade bytes, conforme o espaco livre, e retorna quantos 
+   escreveu. So o produtor chama. A regiao atomica so e usada para acordar 
+   o consumidor, quando ele espera e o limiar foi atingido */
+uint16_t AnelEscreve(anel_t* anel, const uint8_t* dados, uint16_t quantidade)
+{
+	uint16_t escrita = anel->escrita;
+	uint16_t livre = (uint16_t)(anel->mascara + 1 - (uint16_t)(escrita - anel->leitura));
+	uint16_t i;
+	
+	if(quantidade > livre)
+	{
+		quantidade = livre;
+	}
+	
+	for(i = 0; i < quantidade; i++)
+	{
+		anel->area[(uint16_t)(escrita + i) & anel->mascara] = dados[i];
+	}
+	
+	BARREIRA_MEMORIA();		/* os dados ficam visiveis antes do novo indice */
+	anel->escrita = (uint16_t)(escrita + quantidade);
+	
+	if(anel->tarefaEsperando != 0 && AnelQuantidade(anel) >= anel->limiar)
+	{
+		reg_atomica_t estado;
+		
+		REG_ATOMICA_INICIO(estado);
+		if(AcordaDaListaDeEvento(&anel->tarefaEsperando) != 0)
+		{
+			TrocaContextoSeNecessario();	/* em interrupcao, a troca fica pendente no PendSV */
+		}
+		REG_ATOMICA_FIM(estado);
+	}
+	
+	return quantidade;
+}
+
+/* AnelEscreve para varios produtores, tarefas ou interrupcoes: a copia 
+   fica na regiao atomica, entao os bytes de cada chamada ficam juntos no 
+   anel. So para escritas curtas, pois atrasa as interrupcoes */
+uint16_t AnelEscreveAtomico(anel_t* anel, const uint8_t* dados, uint16_t quantidade)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	quantidade = AnelEscreve(anel, dados, quantidade);
+	REG_ATOMICA_FIM(estado);
+	
+	return quantidade;
+}
+
+/* escreve os quantidade bytes, esperando ate haver espaco para todos por 
+   no maximo timeout marcas, e retorna quantos escreveu: todos ou, se o 
+   tempo se esgotar, nenhum. So o produtor chama, de uma tarefa */
+uint16_t AnelEscreveEspera(anel_t* anel, const uint8_t* dados, uint16_t quantidade, tick_t timeout)
+{
+	reg_atomica_t estado;
+	
+	if(quantidade > anel->mascara + 1U)
+	{
+		return 0;		/* nunca caberia */
+	}
+	
+	REG_ATOMICA_INICIO(estado);
+	if((uint16_t)(anel->mascara + 1 - AnelQuantidade(anel)) < quantidade && timeout > 0)
+	{
+		/* o consumidor so libera espaco com a tarefa ja na espera */
+		anel->espaco = quantidade;
+		AguardaEvento(&anel->tarefaEscrevendo, timeout);
+		REG_ATOMICA_FIM(estado);			/* retorna com espaco ou quando o tempo se esgotar */
+		REG_ATOMICA_INICIO(estado);
+	}
+	REG_ATOMICA_FIM(estado);
+	
+	if((uint16_t)(anel->mascara + 1 - AnelQuantidade(anel)) < quantidade)
+	{
+		return 0;
+	}
+	return AnelEscreve(anel, dados, quantidade);
+}
+
+/* le ate quantidade bytes, conforme os disponiveis, e retorna quantos 
+   leu. So o consumidor chama. Nunca bloqueia; so desabilita as 
+   interrupcoes para acordar o produtor que espera espaco */
+uint16_t AnelLe(anel_t* anel, uint8_t* dados, uint16_t quantidade)
+{
+	uint16_t leitura = anel->leitura;
+	uint16_t disponivel = (uint16_t)(anel->escrita - leitura);
+	uint16_t i;
+	
+	if(quantidade > disponivel)
+	{
+		quantidade = disponivel;
+	}
+	
+	BARREIRA_MEMORIA();		/* os dados sao lidos depois do indice de escrita */
+	for(i = 0; i < quantidade; i++)
+	{
+		dados[i] = anel->area[(uint16_t)(leitura + i) & anel->mascara];
+	}
+	
+	BARREIRA_MEMORIA();		/* o espaco so e liberado depois da leitura dos dados */
+	anel->leitura = (uint16_t)(leitura + quantidade);
+	
+	if(anel->tarefaEscrevendo != 0 && (uint16_t)(anel->mascara + 1 - AnelQuantidade(anel)) >= anel->espaco)
+	{
+		reg_atomica_t estado;
+		
+		REG_ATOMICA_INICIO(estado);
+		if(AcordaDaListaDeEvento(&anel->tarefaEscrevendo) != 0)
+		{
+			TrocaContextoSeNecessario();
+		}
+		REG_ATOMICA_FIM(estado);
+	}
+	
+	return quantidade;
+}
+
+/* espera o anel ter pelo menos limiar bytes, por no maximo timeout marcas 
+   (0 nao espera, ESPERA_INFINITA espera sem limite), e retorna a 
+   quantidade disponivel, que pode ser menor que o limiar se o tempo se 
+   esgotar. So o consumidor chama */
+uint16_t AnelAguarda(anel_t* anel, tick_t timeout)
+{
+	uint16_t quantidade;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	quantidade = AnelQuantidade(anel);
+	if(quantidade < anel->limiar && timeout > 0)
+	{
+		/* o produtor so pode escrever apos a tarefa entrar na espera, 
+		   entao nenhum aviso se perde */
+		AguardaEvento(&anel->tarefaEsperando, timeout);
+		REG_ATOMICA_FIM(estado);			/* retorna no limiar ou quando o tempo se esgotar */
+		REG_ATOMICA_INICIO(estado);
+		quantidade = AnelQuantidade(anel);
+	}
+	
+	REG_ATOMICA_FIM(estado);
+	
+	return quantidade;
+}
+
+/* AnelAguarda com o limiar nivel (1 a capacidade), que passa a valer 
+   tambem para as proximas esperas. O consumidor acorda uma vez por lote 
+   de nivel bytes, ou com o que houver quando o tempo se esgotar */
+uint16_t AnelAguardaNivel(anel_t* anel, uint16_t nivel, tick_t timeout)
+{
+	uint16_t capacidade = (uint16_t)(anel->mascara + 1U);
+	
+	anel->limiar = (nivel == 0) ? 1 : (nivel > capacidade) ? capacidade : nivel;
+	return AnelAguarda(anel, timeout);
+}
+
+/* Servicos de instantaneos (um produtor, varios leitores) */
+
+/* prepara o instantaneo na area de 2 * tamanho bytes. Ate a primeira 
+   publicacao, a leitura da o conteudo inicial da primeira copia */
+void InstantaneoInicia(instantaneo_t* inst, uint8_t* area, uint16_t tamanho)
+{
+	inst->area = area;
+	inst->tamanho = tamanho;
+	inst->sequencia = 0;
+}
+
+/* publica os tamanho bytes de dados. So o produtor chama, e nunca espera: 
+   a copia que os leitores usam nao e tocada */
+void InstantaneoPublica(instantaneo_t* inst, const void* dados)
+{
+	uint32_t sequencia = inst->sequencia;
+	uint8_t *destino = &inst->area[(((sequencia >> 1) + 1) & 1) * inst->tamanho];
+	const uint8_t *origem = (const uint8_t *)dados;
+	uint16_t i;
+	
+	inst->sequencia = sequencia + 1;	/* escrevendo a outra copia */
+	BARREIRA_MEMORIA();
+	for(i = 0; i < inst->tamanho; i++)
+	{
+		destino[i] = origem[i];
+	}
+	BARREIRA_MEMORIA();		/* os dados ficam visiveis antes da troca */
+	inst->sequencia = sequencia + 2;
+}
+
+/* copia o ultimo bloco publicado para destino e retorna o numero dele 
+   (publicacoes ate ele), para saber se ha um novo. A copia lida so e 
+   reescrita na segunda publicacao seguinte: ate ela, a leitura vale */
+uint32_t InstantaneoLe(instantaneo_t* inst, void* destino)
+{
+	uint8_t *d = (uint8_t *)destino;
+	const uint8_t *origem;
+	uint32_t inicio, fim;
+	uint16_t i;
+	
+	do
+	{
+		inicio = inst->sequencia;
+		origem = &inst->area[((inicio >> 1) & 1) * inst->tamanho];
+		BARREIRA_MEMORIA();		/* a copia e lida depois da sequencia */
+		for(i = 0; i < inst->tamanho; i++)
+		{
+			d[i] = origem[i];
+		}
+		BARREIRA_MEMORIA();
+		fim = inst->sequencia;
+	} while(fim - inicio >= ((inicio & 1) ? 2U : 3U));	/* o produtor chegou a esta copia */
+	
+	return inicio >> 1;
+}
+
+/* Servicos de fila de mensagens */
+void FilaInicia(fila_t* fila, void* area, uint8_t tamanho, uint8_t capacidade)
+{
+	fila->area = (uint8_t*)area;
+	fila->tamanho = tamanho;
+	fila->capacidade = capacidade;
+	fila->quantidade = 0;
+	fila->inicio = 0;
+	fila->esperandoEnviar = 0;
+	fila->esperandoReceber = 0;
+	#if cfg_GRUPOS_EVENTOS
+	fila->grupo = 0;
+	#endif
+	#if cfg_REGISTRO_OBJETOS
+	fila->maximo = 0;
+	#endif
+	#if cfg_TEMPO_BLOQUEIO
+	TempoBloqueioZera(&fila->bloqueio);
+	#endif
+}
+
+/* copia a mensagem para o fim da fila e acorda a tarefa de maior 
+   prioridade esperando para receber. Retorna 0 se a fila estiver cheia. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static uint8_t FilaColoca(fila_t* fila, const void* mensagem)
+{
+	const uint8_t *origem = (const uint8_t*)mensagem;
+	uint8_t *destino;
+	uint8_t posicao, i;
+	
+	if(fila->quantidade >= fila->capacidade)
+	{
+		return 0;
+	}
+	
+	posicao = fila->inicio + fila->quantidade;
+	if(posicao >= fila->capacidade)
+	{
+		posicao -= fila->capacidade;
+	}
+	
+	destino = &fila->area[posicao * fila->tamanho];
+	for(i = 0; i < fila->tamanho; i++)
+	{
+		destino[i] = origem[i];
+	}
+	fila->quantidade++;
+	#if cfg_REGISTRO_OBJETOS
+	if(fila->quantidade > fila->maximo)
+	{
+		fila->maximo = fila->quantidade;
+	}
+	#endif
+	
+	if(fila->esperandoReceber != 0)
+	{
+		TarefaPronta(RetiraDaListaDeEvento(&fila->esperandoReceber));
+	}
+	#if cfg_GRUPOS_EVENTOS
+	else if(fila->grupo != 0)
+	{
+		LigaEventos(fila->grupo, fila->bits_grupo);
+	}
+	#endif
+	return 1;
+}
+
+/* copia a mensagem mais antiga da fila e acorda a tarefa de maior 
+   prioridade esperando para enviar. Retorna 0 se a fila estiver vazia. 
+   Deve ser chamada com as interrupcoes desabilitadas */
+static uint8_t FilaRetira(fila_t* fila, void* mensagem)
+{
+	uint8_t *destino = (uint8_t*)mensagem;
+	const uint8_t *origem;
+	uint8_t i;
+	
+	if(fila->quantidade == 0)
+	{
+		return 0;
+	}
+	
+	origem = &fila->area[fila->inicio * fila->tamanho];
+	for(i = 0; i < fila->tamanho; i++)
+	{
+		destino[i] = origem[i];
+	}
+	fila->quantidade--;
+	fila->inicio++;
+	if(fila->inicio >= fila->capacidade)
+	{
+		fila->inicio = 0;
+	}
+	
+	if(fila->esperandoEnviar != 0)
+	{
+		TarefaPronta(RetiraDaListaDeEvento(&fila->esperandoEnviar));
+	}
+	return 1;
+}
+
+/* envia uma mensagem, esperando enquanto a fila estiver cheia */
+void FilaEnvia(fila_t* fila, const void* mensagem)
+{
+	reg_atomica_t estado;
+	#if cfg_TEMPO_BLOQUEIO
+	uint32_t inicio = 0;
+	uint8_t bloqueou = 0;
+	#endif
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	while(FilaColoca(fila, mensagem) == 0)
+	{
+		#if cfg_TEMPO_BLOQUEIO
+		if(!bloqueou)
+		{
+			inicio = RELOGIO_BLOQUEIO();		/* uma espera so, ate conseguir */
+			bloqueou = 1;
+		}
+		#endif
+		TarefaBloqueia(tarefa_atual);			/* tarefa colocada na fila de espera */
+		InsereNaListaDeEvento(&fila->esperandoEnviar, tarefa_atual);
+		TROCA_CONTEXTO();						/* solicita troca de contexto */
+		REG_ATOMICA_FIM(estado);				/* retorna quando houver espaco */
+		REG_ATOMICA_INICIO(estado);
+	}
+	#if cfg_TEMPO_BLOQUEIO
+	if(bloqueou)
+	{
+		ContaBloqueio(&fila->bloqueio, inicio);
+	}
+	#endif
+	TrocaContextoSeNecessario();
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* recebe uma mensagem, esperando enquanto a fila estiver vazia */
+void FilaRecebe(fila_t* fila, void* mensagem)
+{
+	reg_atomica_t estado;
+	#if cfg_TEMPO_BLOQUEIO
+	uint32_t inicio = 0;
+	uint8_t bloqueou = 0;
+	#endif
+	
+	REG_ATOMICA_INICIO(estado);
+	
+	while(FilaRetira(fila, mensagem) == 0)
+	{
+		#if cfg_TEMPO_BLOQUEIO
+		if(!bloqueou)
+		{
+			inicio = RELOGIO_BLOQUEIO();		/* uma espera so, ate conseguir */
+			bloqueou = 1;
+		}
+		#endif
+		TarefaBloqueia(tarefa_atual);			/* tarefa colocada na fila de espera */
+		InsereNaListaDeEvento(&fila->esperandoReceber, tarefa_atual);
+		TROCA_CONTEXTO();						/* solicita troca de contexto */
+		REG_ATOMICA_FIM(estado);				/* retorna quando houver mensagem */
+		REG_ATOMICA_INICIO(estado);
+	}
+	#if cfg_TEMPO_BLOQUEIO
+	if(bloqueou)
+	{
+		ContaBloqueio(&fila->bloqueio, inicio);
+	}
+	#endif
+	TrocaContextoSeNecessario();
+	
+	REG_ATOMICA_FIM(estado);
+}
+
+/* versoes sem espera, para uso em rotinas de interrupcao. 
+   Retornam 1 em caso de sucesso, 0 se a fila estiver cheia/vazia */
+uint8_t FilaEnviaISR(fila_t* fila, const void* mensagem)
+{
+	uint8_t enviada;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	enviada = FilaColoca(fila, mensagem);
+	if(enviada)
+	{
+		TrocaContextoSeNecessario();		/* a troca acontece apos o fim da interrupcao (PendSV) */
+	}
+	REG_ATOMICA_FIM(estado);
+	
+	return enviada;
+}
+
+/* envia quantidade mensagens seguidas de mensagens numa so regiao 
+   atomica, sem esperar, e decide a troca de contexto uma vez so. Cada 
+   mensagem acorda uma tarefa esperando para receber. Retorna quantas 
+   couberam na fila, as primeiras. Pode ser usada em tarefas e 
+   interrupcoes */
+uint8_t FilaEnviaVariasISR(fila_t* fila, const void* mensagens, uint8_t quantidade)
+{
+	const uint8_t *mensagem = (const uint8_t*)mensagens;
+	uint8_t enviadas = 0;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	while(enviadas < quantidade && FilaColoca(fila, mensagem))
+	{
+		mensagem += fila->tamanho;
+		enviadas++;
+	}
+	if(enviadas > 0)
+	{
+		TrocaContextoSeNecessario();
+	}
+	REG_ATOMICA_FIM(estado);
+	
+	return enviadas;
+}
+
+uint8_t FilaRecebeISR(fila_t* fila, void* mensagem)
+{
+	uint8_t recebida;
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	recebida = FilaRetira(fila, mensagem);
+	if(recebida)
+	{
+		TrocaContextoSeNecessario();		/* a troca acontece apos o fim da interrupcao (PendSV) */
+	}
+	REG_ATOMICA_FIM(estado);
+	
+	return recebida;
+}
@@ -0,0 +1,1613 @@
+/*
+ * multitarefas.h
+ *
+ */ 
+
+
+#ifndef MULTITAREFAS_H_
+#define MULTITAREFAS_H_
+
+#include "stdint.h"
+#include "conf_rtos.h"		/* configuracao do projeto, na pasta de cada placa */
+#include "cpu-port.h"		/* porta da cpu, escolhida pelo caminho de inclusao do projeto */
+#include "atomico.h"
+
+/******************************************************************/
+/* macros de configuracao 
+   (podem ser redefinidas no conf_rtos.h do projeto ou na linha de comando 
+   do compilador, ex.: -DNUMERO_DE_TAREFAS=8) */
+
+/* numero de tarefas */
+#ifndef NUMERO_DE_TAREFAS
+#define NUMERO_DE_TAREFAS	6
+#endif
+
+/* numero de prioridades/tarefas */
+#ifndef PRIORIDADE_MAXIMA
+#define PRIORIDADE_MAXIMA   4
+#endif
+
+/* politica do escalonador: 0 = prioridades fixas; 1 = prazo mais 
+   proximo primeiro (EDF), em que executa a tarefa pronta de menor prazo 
+   absoluto, e as prioridades so desempatam. O prazo de uma tarefa 
+   periodica e o fim do seu periodo, definido por TarefaEsperaAte; as 
+   tarefas sem prazo (TarefaDefinePrazo) executam depois das que tem, 
+   por prioridade. Em EDF a marca de tempo sempre preempta */
+#ifndef cfg_ESCALONADOR_EDF
+#define cfg_ESCALONADOR_EDF	0
+#endif
+
+/* frequencia de clock da CPU */
+#ifndef cfg_CPU_CLOCK_HZ
+#define cfg_CPU_CLOCK_HZ 	48000000
+#endif
+
+/* frequencia da marca de tempo do sistema multitarefas */
+#ifndef cfg_MARCA_TEMPO_HZ
+#define cfg_MARCA_TEMPO_HZ  1000
+#endif
+
+/* frequencia da marca de tempo variavel: 1 permite trocar a frequencia 
+   durante a execucao com MarcaTempoMudaFrequencia (ex.: 10 kHz numa fase 
+   de controle e 10 Hz no monitoramento de baixo consumo), partindo de 
+   cfg_MARCA_TEMPO_HZ. As esperas em andamento (TarefaEspera, timeouts, 
+   temporizadores e prazos do EDF) sao reescaladas para durar o mesmo 
+   tempo, arredondadas para cima. Continuam em marcas os valores guardados 
+   pela aplicacao ou pelo nucleo sem referencia ao instante atual: 
+   periodos de TarefaEsperaAte, janelas do vigia, orcamentos e 
+   cfg_FATIA_TEMPO. A porta reprograma o temporizador 
+   (MARCA_VARIAVEL_NA_PORTA: cortex_m0_gcc, cortex_m4_gcc e posix). 0: frequencia fixa */
+#ifndef cfg_MARCA_VARIAVEL
+#define cfg_MARCA_VARIAVEL	0
+#endif
+
+/* valor do contador de marcas de tempo na partida. Com um valor perto do 
+   maximo (ex.: -Dcfg_MARCA_INICIAL=0xFFFFF000), o retorno a 0, que so 
+   aconteceria apos ~49 dias a 1 kHz, acontece logo apos iniciar: usado 
+   nos testes de longa duracao (host_posix/longa_duracao.c) */
+#ifndef cfg_MARCA_INICIAL
+#define cfg_MARCA_INICIAL	0
+#endif
+
+/* modo preemptivo: a marca de tempo solicita a troca de contexto quando 
+   desperta uma tarefa de maior prioridade que a atual. 
+   1 habilita, 0 desabilita (modo cooperativo). Define apenas o limiar de 
+   preempcao inicial das tarefas, que pode ser mudado em tempo de execucao 
+   para cada tarefa com TarefaLimiarPreempcao */
+#ifndef cfg_PREEMPTIVO
+#define cfg_PREEMPTIVO		0
+#endif
+
+/* fatia de tempo (em marcas) para as tarefas de mesma prioridade 
+   se revezarem (round-robin), 0 desabilita */
+#ifndef cfg_FATIA_TEMPO
+#define cfg_FATIA_TEMPO		10
+#endif
+
+/* modo ocioso sem marcas de tempo (tickless): quando somente a tarefa 
+   ociosa esta pronta, a marca de tempo e reprogramada para o proximo 
+   despertar e o processador dorme (WFI). 1 habilita, 0 desabilita */
+#ifndef cfg_OCIOSA_SEM_MARCAS
+#define cfg_OCIOSA_SEM_MARCAS	0
+#endif
+
+/* ajuste fino da marca de tempo pela porta da cpu (MarcaTempoAjusta): a 
+   duracao de cada marca pode ser corrigida em fracoes de contagem, para 
+   acompanhar um relogio externo (ex.: sincronismo entre os nos de uma 
+   rede). Nao combina com o modo ocioso sem marcas, cujos periodos longos 
+   nao recebem a correcao. 1 habilita, 0 desabilita */
+#ifndef cfg_AJUSTE_MARCA
+#define cfg_AJUSTE_MARCA	0
+#endif
+
+#if cfg_AJUSTE_MARCA && cfg_OCIOSA_SEM_MARCAS
+#error "cfg_AJUSTE_MARCA nao corrige os periodos do modo ocioso sem marcas"
+#endif
+
+/* caminho critico do nucleo na RAM: o escalonador, a troca de contexto e 
+   a marca de tempo, com as interrupcoes PendSV e SysTick da porta, ficam na 
+   secao de funcoes na RAM (FUNCAO_NA_RAM da porta), copiada na partida. 
+   Executam sem os estados de espera da flash, em tempo deterministico. 
+   1 habilita, 0 desabilita */
+#ifndef cfg_NUCLEO_NA_RAM
+#define cfg_NUCLEO_NA_RAM	0
+#endif
+
+/* marca os simbolos do nucleo usados pelo assembly da porta; a porta o 
+   define quando a otimizacao no ligador (LTO) poderia descarta-los */
+#ifndef CHAMADA_POR_ASM
+#define CHAMADA_POR_ASM
+#endif
+
+#if cfg_NUCLEO_NA_RAM
+#ifndef FUNCAO_NA_RAM
+#error "cfg_NUCLEO_NA_RAM exige FUNCAO_NA_RAM na porta da cpu"
+#endif
+#define NUCLEO_RAPIDO		FUNCAO_NA_RAM
+#else
+#define NUCLEO_RAPIDO
+#endif
+
+/* TCB separado (estrutura de vetores): o estado, a prioridade e a lista de
+   espera por tempo (prox_espera e tempo_espera) saem do tcb_t para vetores
+   proprios, indexados pela tarefa (TCB_ESTADO etc.). A marca de tempo e o
+   escalonador percorrem so esses vetores contiguos, sem trazer para a
+   cache as linhas com a pilha, as estatisticas e os demais campos frios, e
+   o estado de 4 tarefas cabe numa palavra para comparacoes em lote. Para
+   portas com cache (Cortex-M7); no Cortex-M0+, sem cache, so acrescenta
+   os vetores. 1 habilita, 0 desabilita */
+#ifndef cfg_TCB_SEPARADO
+#define cfg_TCB_SEPARADO	0
+#endif
+
+/* servicos em linha: os caminhos rapidos de SemaforoAguarda (contador 
+   maior que 0), SemaforoLibera (nenhuma tarefa esperando) e TarefaEspera 
+   (0 marcas) ficam em funcoes static inline no fim deste arquivo, e so o 
+   caminho que bloqueia ou acorda uma tarefa chama o nucleo 
+   (SemaforoAguardaLento etc.). O caso comum fica em poucas instrucoes na 
+   propria tarefa, sem a chamada e sem ler tarefa_atual, ao custo de mais 
+   codigo em cada chamada. Exige cfg_RASTRO = 0: o caminho rapido nao 
+   registra eventos. 1 habilita, 0 desabilita */
+#ifndef cfg_SERVICOS_EM_LINHA
+#define cfg_SERVICOS_EM_LINHA	0
+#endif
+
+/* TarefaCede sem a excecao PendSV: fora de interrupcoes e de regioes 
+   atomicas, quando a proxima tarefa tambem saiu por TarefaCede, a troca e 
+   feita na propria chamada, no modo thread, guardando so os registradores 
+   que a funcao chamada deve preservar (CEDE_DIRETO da porta). As demais 
+   trocas continuam pelo PendSV. O escalonador executa na pilha da tarefa 
+   que cede, que precisa de espaco para ele. 1 habilita, 0 desabilita */
+#ifndef cfg_CEDE_DIRETO
+#define cfg_CEDE_DIRETO		0
+#endif
+
+#if cfg_CEDE_DIRETO && !defined(CEDE_DIRETO)
+#error "cfg_CEDE_DIRETO exige CEDE_DIRETO na porta da cpu"
+#endif
+
+/* numero minimo de marcas ate o proximo despertar para valer a pena dormir */
+#ifndef cfg_OCIOSA_MIN_MARCAS
+#define cfg_OCIOSA_MIN_MARCAS	2
+#endif
+
+/* ganchos do modo ocioso sem marcas, chamados pela porta da cpu com as 
+   interrupcoes desabilitadas: cfg_ANTES_DE_DORMIR(qtas_marcas) logo antes 
+   do WFI, com as marcas ate o despertar programado (ex.: escolher o nivel 
+   de sono do microcontrolador), e cfg_APOS_DORMIR() logo ao acordar, antes 
+   de corrigir o tempo do sistema. Vazios por padrao */
+#ifndef cfg_ANTES_DE_DORMIR
+#define cfg_ANTES_DE_DORMIR(qtas_marcas)
+#endif
+
+#ifndef cfg_APOS_DORMIR
+#define cfg_APOS_DORMIR()
+#endif
+
+/* sono longo do modo ocioso sem marcas: a partir de cfg_SONO_LONGO_MARCAS
+   marcas ate o despertar, a porta da cpu para a marca de tempo e chama
+   cfg_SONO_LONGO(us), que dorme ate us microssegundos com outra base de
+   tempo, que continua contando num sono mais profundo (ex.: o RTC no
+   STANDBY), e retorna os microssegundos dormidos, medidos por ela. O tempo
+   do sistema e corrigido por essa medida, com a fracao da marca atual.
+   Retornar 0 recusa o sono longo (a porta dorme da forma normal).
+   0 desabilita */
+#ifndef cfg_SONO_LONGO_MARCAS
+#define cfg_SONO_LONGO_MARCAS	0
+#endif
+
+#if cfg_SONO_LONGO_MARCAS > 0 && !defined(cfg_SONO_LONGO)
+#error "cfg_SONO_LONGO_MARCAS exige o gancho cfg_SONO_LONGO(us)"
+#endif
+
+/* ganchos de trabalho da tarefa ociosa: numero maximo de funcoes registradas 
+   com OciosaRegistraGancho, chamadas pela tarefa ociosa em rodizio, um passo 
+   curto de cada por vez, para servicos de fundo sem tarefa propria (ex.: 
+   nivelamento de desgaste da flash, gravacao de estatisticas). 0 desabilita */
+#ifndef cfg_GANCHOS_OCIOSA
+#define cfg_GANCHOS_OCIOSA	0
+#endif
+
+/* pintura das pilhas: CriaTarefa preenche a pilha com PADRAO_PILHA e 
+   TarefaPilhaLivre informa quanto dela nunca foi usado (marca d'agua). 
+   1 habilita, 0 desabilita */
+#ifndef cfg_PINTA_PILHA
+#define cfg_PINTA_PILHA		1
+#endif
+
+/* padrao usado na pintura das pilhas */
+#define PADRAO_PILHA		0xA5A5A5A5UL
+
+/* verificacao de estouro de pilha: CriaTarefa grava CANARIO_PILHA na 
+   primeira palavra (menor endereco) da pilha e, a cada troca de contexto, 
+   o canario e o stack pointer da tarefa que sai sao conferidos. No estouro, 
+   chama cfg_ESTOURO_DE_PILHA(id_tarefa, nome) e suspende a tarefa. 
+   1 habilita, 0 desabilita */
+#ifndef cfg_VERIFICA_PILHA
+#define cfg_VERIFICA_PILHA	1
+#endif
+
+/* funcao chamada no estouro de pilha, void f(uint8_t id_tarefa, const char *nome). 
+   A padrao, EstouroDePilha, fica em laco infinito para parar no depurador */
+#ifndef cfg_ESTOURO_DE_PILHA
+#define cfg_ESTOURO_DE_PILHA	EstouroDePilha
+#endif
+
+/* valor do canario, diferente do padrao de pintura */
+#define CANARIO_PILHA		0x5AFE57ACUL
+
+/* nomes das tarefas (TarefaNome), guardados em uma tabela a parte do TCB, 
+   para o console, o rastro e o estouro de pilha. 0 remove a tabela nas 
+   versoes finais: o nome passado a CriaTarefa e ignorado e TarefaNome 
+   retorna "-". 1 habilita, 0 desabilita */
+#ifndef cfg_NOMES_TAREFAS
+#define cfg_NOMES_TAREFAS	1
+#endif
+
+/* estatisticas de execucao por tarefa (tempo de CPU, trocas de contexto 
+   e preempcoes), obtidas com TarefaObtemEstatisticas. 1 habilita, 0 desabilita */
+#ifndef cfg_ESTATISTICAS
+#define cfg_ESTATISTICAS	1
+#endif
+
+/* energia estimada por tarefa, junto das estatisticas: cada intervalo de 
+   execucao custa os seus ciclos vezes o custo por ciclo do clock em uso, 
+   em pJ. O custo e cfg_CUSTO_CICLO ate a aplicacao informar outro com 
+   EnergiaAlteraCusto (ex.: na troca do perfil de clock). Com 
+   cfg_OCIOSA_SEM_MARCAS, o tempo em que a tarefa ociosa dormiu vai para 
+   uma conta a parte (EnergiaSono), ao custo cfg_CUSTO_SONO() do modo de 
+   sono escolhido, chamado ao acordar. Os custos vem de uma calibracao com 
+   um analisador de energia: potencia / clock (1 uW a 1 MHz = 1 pJ por 
+   ciclo). 1 habilita, 0 desabilita */
+#ifndef cfg_ENERGIA
+#define cfg_ENERGIA			0
+#endif
+#ifndef cfg_CUSTO_CICLO
+#define cfg_CUSTO_CICLO		0
+#endif
+#ifndef cfg_CUSTO_SONO
+#define cfg_CUSTO_SONO()	cfg_CUSTO_CICLO
+#endif
+
+#if cfg_ENERGIA && !cfg_ESTATISTICAS
+#error "cfg_ENERGIA usa o tempo de execucao das estatisticas (cfg_ESTATISTICAS)"
+#endif
+
+/* contadores de espera dos semaforos: cada semaforo conta as chamadas de 
+   SemaforoAguarda e SemaforoAguardaTempo, as que bloquearam a tarefa e as 
+   que retornaram sem o semaforo (tempo esgotado), para diagnosticar 
+   disputas em campo (ex.: comando sem do console). 1 habilita, 0 desabilita */
+#ifndef cfg_ESPERAS_SEMAFORO
+#define cfg_ESPERAS_SEMAFORO	0
+#endif
+
+/* registro de objetos: semaforos, mutexes, filas, conjuntos de memoria, 
+   temporizadores e os demais objetos do nucleo sao incluidos numa lista 
+   com ObjetoRegistra (ou OBJETO_REGISTRA), em geral logo apos a 
+   inicializacao, e ObjetosObtemEstado copia de uma vez o estado de cada 
+   um: tarefas esperando, contador e marca d'agua (maior contador do 
+   semaforo e da fila, menor numero de blocos livres da memoria). Para o 
+   console (comando objs) e as ferramentas do computador acharem em campo 
+   o objeto mais disputado. 1 habilita, 0 desabilita, sem custo nenhum */
+#ifndef cfg_REGISTRO_OBJETOS
+#define cfg_REGISTRO_OBJETOS	0
+#endif
+
+/* tempo bloqueado: mede quanto as tarefas ficam bloqueadas em 
+   SemaforoAguarda, SemaforoAguardaTempo, MutexAguarda, FilaEnvia e 
+   FilaRecebe, somado no objeto e na tarefa (tempo_bloqueio_t: esperas, 
+   total, maior e histograma em faixas de potencias de 2). Mostra os 
+   limites de vazao causados por disputa, e nao pela CPU, que o uso de 
+   CPU nao mostra. O relogio e cfg_TEMPO_BLOQUEIO_RELOGIO(), de 32 bits, 
+   com cfg_TEMPO_BLOQUEIO_HZ contagens por segundo (ex.: a base de tempo 
+   de us da placa); sem ele, as marcas de tempo. 1 habilita, 0 desabilita, 
+   sem custo nenhum */
+#ifndef cfg_TEMPO_BLOQUEIO
+#define cfg_TEMPO_BLOQUEIO	0
+#endif
+
+/* faixas do histograma: a faixa 0 conta as esperas de 0 e 1 contagem do 
+   relogio, a faixa i as de 2^i ate 2^(i+1) - 1 e a ultima todas as 
+   maiores (com 16 e us, de 1 us a 32 ms ou mais) */
+#ifndef cfg_TEMPO_BLOQUEIO_FAIXAS
+#define cfg_TEMPO_BLOQUEIO_FAIXAS	16
+#endif
+
+#if cfg_TEMPO_BLOQUEIO && defined(cfg_TEMPO_BLOQUEIO_RELOGIO) && !defined(cfg_TEMPO_BLOQUEIO_HZ)
+#error "cfg_TEMPO_BLOQUEIO_RELOGIO exige cfg_TEMPO_BLOQUEIO_HZ"
+#endif
+
+/* grupos de eventos: bits ligados por tarefas e interrupcoes, esperados 
+   por uma tarefa em qualquer ou todos os bits, com a opcao de zera-los ao 
+   retornar. Semaforos e filas podem ser associados a um bit do grupo 
+   (SemaforoAssociaGrupo, FilaAssociaGrupo), que liga quando ficam com 
+   algo para retirar: uma tarefa espera varias fontes de uma vez (ex.: 
+   quadro da UART, temporizador e botao) sem uma tarefa para cada uma. 
+   1 habilita, 0 desabilita */
+#ifndef cfg_GRUPOS_EVENTOS
+#define cfg_GRUPOS_EVENTOS	0
+#endif
+
+/* arena de pilhas para tarefas criadas em tempo de execucao com 
+   CriaTarefaDinamica: numero de blocos de pilha, 0 desabilita. 
+   TarefaTermina devolve o bloco a arena */
+#ifndef cfg_ARENA_PILHAS
+#define cfg_ARENA_PILHAS	0
+#endif
+
+/* tamanho de cada bloco de pilha da arena, em palavras */
+#ifndef cfg_TAM_BLOCO_PILHA
+#define cfg_TAM_BLOCO_PILHA	(TAM_MINIMO_PILHA + 64)
+#endif
+
+/* tarefas basicas: funcoes executadas ate o fim (run to completion) a cada 
+   ativacao (TarefaBasicaAtiva), sem pilha propria, escalonadas com as 
+   demais pelas filas de prontas. Todas usam uma pilha compartilhada de 
+   cfg_PILHA_TAREFAS_BASICAS palavras: a tarefa basica que comeca cria o 
+   seu contexto logo abaixo do da ultima tarefa basica iniciada e o libera 
+   ao retornar. Como nao bloqueiam e so comecam quando as tarefas basicas 
+   ja iniciadas tem prioridade menor, os contextos saem na ordem inversa 
+   da entrada, e a pilha so precisa da soma das pilhas de uma cadeia de 
+   preempcoes (uma tarefa basica por prioridade), nao de todas elas. 
+   0 desabilita */
+#ifndef cfg_PILHA_TAREFAS_BASICAS
+#define cfg_PILHA_TAREFAS_BASICAS	0
+#endif
+
+#if cfg_PILHA_TAREFAS_BASICAS > 65535
+#error "cfg_PILHA_TAREFAS_BASICAS deve ser no maximo 65535"
+#endif
+
+#if cfg_PILHA_TAREFAS_BASICAS > 0 && cfg_ESCALONADOR_EDF
+#error "as tarefas basicas exigem o escalonador de prioridades fixas"
+#endif
+
+/* tarefa ociosa na pilha principal: CriaTarefaOciosa(tamanho) cria a
+   tarefa ociosa no fundo (menor endereco) da pilha principal da porta,
+   em vez de um vetor de pilha da aplicacao. Depois de IniciaMultitarefas
+   a pilha principal so atende main ate o primeiro contexto e as
+   interrupcoes, que usam o topo; o fundo, reservado pelo ligador para o
+   pior caso, fica livre. A pilha principal precisa caber o seu uso mais
+   os tamanho palavras da ociosa. Requer PILHA_PRINCIPAL_FUNDO() e
+   PILHA_PRINCIPAL_ATUAL() da porta. 1 habilita, 0 desabilita */
+#ifndef cfg_OCIOSA_PILHA_PRINCIPAL
+#define cfg_OCIOSA_PILHA_PRINCIPAL	0
+#endif
+
+#if cfg_OCIOSA_PILHA_PRINCIPAL && !defined(PILHA_PRINCIPAL_FUNDO)
+#error "cfg_OCIOSA_PILHA_PRINCIPAL exige PILHA_PRINCIPAL_FUNDO na porta da cpu"
+#endif
+
+/* temporizadores de software: funcoes chamadas uma vez ou periodicamente 
+   pela tarefa tarefa_temporizadores, criada pela aplicacao como as demais. 
+   1 habilita, 0 desabilita */
+#ifndef cfg_TEMPORIZADORES
+#define cfg_TEMPORIZADORES	0
+#endif
+
+/* numero de posicoes da roda de temporizadores (potencia de 2). Cada 
+   posicao guarda os temporizadores cujo vencimento tem os mesmos bits 
+   menos significativos, e a marca de tempo so acorda a tarefa de 
+   temporizadores quando a posicao da marca atual nao esta vazia */
+#ifndef cfg_RODA_TEMPORIZADORES
+#define cfg_RODA_TEMPORIZADORES	16
+#endif
+
+/* fila de trabalhos adiados: numero de trabalhos (funcao e argumento) que 
+   as interrupcoes podem deixar para a tarefa tarefa_trabalhos, criada pela 
+   aplicacao como as demais. 0 desabilita */
+#ifndef cfg_FILA_TRABALHOS
+#define cfg_FILA_TRABALHOS	0
+#endif
+
+/* objetos ativos: maquinas de estado que reagem a eventos, cada uma com 
+   sua fila de eventos e sua funcao de despacho, sem pilha propria. Os 
+   objetos de um grupo compartilham uma tarefa (e sua pilha), que executa 
+   ObjetosAtivosExecuta(grupo); cada evento e tratado ate o fim (run to 
+   completion) antes do proximo. Numero de grupos, 0 desabilita */
+#ifndef cfg_OBJETOS_ATIVOS
+#define cfg_OBJETOS_ATIVOS	0
+#endif
+
+/* numero maximo de objetos (e de prioridades) em cada grupo, ate 8 */
+#ifndef cfg_OBJETOS_POR_GRUPO
+#define cfg_OBJETOS_POR_GRUPO	8
+#endif
+
+/* rastro do nucleo: numero de registros (potencia de 2) do anel em RAM com 
+   as trocas de contexto, marcas de tempo que despertam tarefas, operacoes 
+   de semaforo e TarefaEspera. 0 desabilita, sem custo nenhum. Os mais 
+   antigos sao sobrescritos; RastroDescarrega os envia para o computador, 
+   onde host_posix/decodifica_rastro.c mostra a linha do tempo */
+#ifndef cfg_RASTRO
+#define cfg_RASTRO	0
+#endif
+
+/* rastro retido: 1 coloca o anel do rastro na memoria mantida entre resets 
+   (RETIDA da porta), para descarregar depois de um reset do watchdog os 
+   eventos que levaram a ele. A aplicacao zera o anel na partida fria 
+   (ex.: RetidaInicia na placa SAM D21). 0 desabilita */
+#ifndef cfg_RASTRO_RETIDO
+#define cfg_RASTRO_RETIDO	0
+#endif
+
+#if cfg_RASTRO_RETIDO
+#if cfg_RASTRO == 0
+#error "cfg_RASTRO_RETIDO exige cfg_RASTRO"
+#endif
+#ifndef RETIDA
+#error "cfg_RASTRO_RETIDO exige RETIDA na porta da cpu"
+#endif
+#define RASTRO_RETIDO		RETIDA
+#else
+#define RASTRO_RETIDO
+#endif
+
+/* captura de falha grave: 1 faz o HardFault da porta guardar na memoria 
+   retida (falha_grave) os registradores empilhados, a tarefa atual, as 
+   pilhas e os ultimos cfg_FALHA_GRAVE_RASTRO registros do rastro, e 
+   reiniciar em seguida, em vez de parar num laco. A partida seguinte e 
+   quente e le a causa em falha_grave (ex.: RetidaInicia na placa SAM D21). 
+   0 mantem o laco, para o depurador */
+#ifndef cfg_FALHA_GRAVE
+#define cfg_FALHA_GRAVE		0
+#endif
+
+#ifndef cfg_FALHA_GRAVE_RASTRO
+#define cfg_FALHA_GRAVE_RASTRO	8
+#endif
+
+#if cfg_FALHA_GRAVE
+#ifndef RETIDA
+#error "cfg_FALHA_GRAVE exige RETIDA na porta da cpu"
+#endif
+#ifndef FALHA_GRAVE_NA_PORTA
+#error "cfg_FALHA_GRAVE exige a captura no HardFault da porta da cpu"
+#endif
+#endif
+
+/* tempo dos registros do rastro: sem definir, a marca de tempo nos 16 bits 
+   altos e os ciclos desde ela nos baixos (RASTRO_SUBMARCA da porta). 
+   Definido, cfg_RASTRO_TEMPO() da um contador livre de 32 bits a 
+   cfg_RASTRO_TEMPO_HZ (ex.: TempoUs da placa SAM D21, a 1MHz), com 
+   resolucao que nao depende da marca de tempo */
+#if defined(cfg_RASTRO_TEMPO) && !defined(cfg_RASTRO_TEMPO_HZ)
+#error "cfg_RASTRO_TEMPO exige cfg_RASTRO_TEMPO_HZ"
+#endif
+
+/* recuperacao de marcas perdidas: definido, cfg_RELOGIO_LIVRE() da um 
+   contador livre de 32 bits a cfg_RELOGIO_LIVRE_HZ (ex.: TempoUs da placa 
+   SAM D21). A cada marca de tempo, o nucleo mede por ele o tempo desde a 
+   anterior; as marcas que se perderam com as interrupcoes desabilitadas 
+   por mais de uma marca sao processadas de uma vez, como as do modo ocioso 
+   sem marcas, em tempo proporcional as tarefas despertadas. As esperas e o 
+   contador de marcas nao se alongam. Sem definir, nada e medido */
+#if defined(cfg_RELOGIO_LIVRE) && !defined(cfg_RELOGIO_LIVRE_HZ)
+#error "cfg_RELOGIO_LIVRE exige cfg_RELOGIO_LIVRE_HZ"
+#endif
+
+/* perfil estatistico: numero de amostras (potencia de 2) do anel em RAM 
+   com o PC interrompido pela marca de tempo e a tarefa atual, uma a cada 
+   cfg_PERFIL_INTERVALO marcas. 0 desabilita, sem custo nenhum. Os mais 
+   antigos sao sobrescritos; PerfilDescarrega os envia para o computador, 
+   onde host_posix/perfil.c os agrupa pelas funcoes da imagem (nm). A 
+   porta da cpu le o PC (PERFIL_NA_PORTA: cortex_m0_gcc, cortex_m4_gcc e posix) */
+#ifndef cfg_PERFIL
+#define cfg_PERFIL	0
+#endif
+
+#ifndef cfg_PERFIL_INTERVALO
+#define cfg_PERFIL_INTERVALO	1
+#endif
+
+#if cfg_PERFIL > 0 && !defined(PERFIL_NA_PORTA)
+#error "cfg_PERFIL exige a leitura do PC interrompido na porta da cpu"
+#endif
+
+#if cfg_MARCA_VARIAVEL && !defined(MARCA_VARIAVEL_NA_PORTA)
+#error "cfg_MARCA_VARIAVEL exige a reprogramacao da marca na porta da cpu"
+#endif
+
+/* pinos de rastro: 1 liga pinos de saida na entrada e desliga na saida 
+   do SVC_Handler, PendSV_Handler e SysTick_Handler, e mantem ligados os 
+   pinos de cada tarefa (TarefaDefinePinoRastro) enquanto ela executa, 
+   para medir com um analisador logico a duracao das interrupcoes, a 
+   latencia da troca de contexto e a ocupacao das tarefas. As escritas sao 
+   as da porta (PINOS_RASTRO_LIGA/DESLIGA, ex.: um ciclo pelo IOBUS), em 
+   mascaras de bits dos pinos; mascara 0 nao usa pino. 0 desabilita, 
+   sem custo nenhum */
+#ifndef cfg_PINOS_RASTRO
+#define cfg_PINOS_RASTRO	0
+#endif
+
+#ifndef cfg_PINO_RASTRO_SVC
+#define cfg_PINO_RASTRO_SVC		0
+#endif
+
+/* o pino do PendSV desliga quando a proxima tarefa ja foi escolhida, 
+   antes da restauracao dos registradores (alguns ciclos) */
+#ifndef cfg_PINO_RASTRO_PENDSV
+#define cfg_PINO_RASTRO_PENDSV	0
+#endif
+
+#ifndef cfg_PINO_RASTRO_MARCA
+#define cfg_PINO_RASTRO_MARCA	0
+#endif
+
+#if cfg_PINOS_RASTRO
+#ifndef PINOS_RASTRO_LIGA		/* porta sem pinos (ex.: posix) */
+#define PINOS_RASTRO_SAIDA(mascara)		((void)(mascara))
+#define PINOS_RASTRO_LIGA(mascara)		((void)(mascara))
+#define PINOS_RASTRO_DESLIGA(mascara)	((void)(mascara))
+#endif
+/* com mascara constante 0, a escrita some na compilacao */
+#define PINO_RASTRO_ENTRA(mascara)	do { if((mascara) != 0) { PINOS_RASTRO_LIGA(mascara); } } while(0)
+#define PINO_RASTRO_SAI(mascara)	do { if((mascara) != 0) { PINOS_RASTRO_DESLIGA(mascara); } } while(0)
+#else
+#define PINO_RASTRO_ENTRA(mascara)
+#define PINO_RASTRO_SAI(mascara)
+#endif
+
+/* monitor das tarefas periodicas: TarefaEsperaAte mede o atraso de cada 
+   liberacao em relacao ao instante esperado (jitter) e conta os prazos 
+   perdidos, obtidos com TarefaObtemMonitor. 1 habilita, 0 desabilita */
+#ifndef cfg_MONITOR_PERIODICAS
+#define cfg_MONITOR_PERIODICAS	0
+#endif
+
+/* funcao opcional chamada quando uma tarefa periodica perde o prazo, 
+   void f(uint8_t id_tarefa, tick_t atraso), com o atraso em marcas. 
+   Ex.: -Dcfg_PRAZO_PERDIDO=MeuTratamento. Nao definida, nada e chamado */
+
+/* vigia das tarefas (watchdog): cada tarefa registrada com VigiaRegistra 
+   avisa que esta viva com VigiaSinaliza (uma unica escrita). A cada 
+   cfg_VIGIA marcas de tempo, a marca de tempo confere se todas as tarefas 
+   registradas sinalizaram dentro da sua janela e, se sim, chama 
+   cfg_ALIMENTA_VIGIA() (ex.: reinicia o WDT da placa). Na primeira tarefa 
+   atrasada o rastro e congelado, cfg_VIGIA_FALHOU(id_tarefa) e chamada, 
+   se definida, e o WDT deixa de ser alimentado ate o reset. 
+   Periodo de verificacao em marcas, 0 desabilita */
+#ifndef cfg_VIGIA
+#define cfg_VIGIA	0
+#endif
+
+#ifndef cfg_ALIMENTA_VIGIA
+#define cfg_ALIMENTA_VIGIA()
+#endif
+
+/* deteccao de inanicao: mede quanto cada tarefa fica pronta sem executar,
+   desde que ficou pronta ou desde que saiu da CPU ainda pronta (preemptada).
+   A cada cfg_INANICAO_PERIODO marcas, a marca de tempo confere as tarefas
+   prontas: as que esperam ha cfg_INANICAO marcas ou mais sao contadas e
+   cfg_INANICAO_DETECTADA(id_tarefa, marcas) e chamada, se definida, uma
+   vez por espera. A maior espera de cada tarefa (TarefaObtemInanicao),
+   junto com o uso de CPU das estatisticas, mostra o custo de cada ajuste
+   de prioridades para as tarefas de baixo. A ociosa (prioridade 0), sempre
+   pronta, nao e conferida nem medida.
+   Limite em marcas, 0 desabilita */
+#ifndef cfg_INANICAO
+#define cfg_INANICAO	0
+#endif
+
+/* marcas entre as verificacoes: a espera e detectada ate
+   cfg_INANICAO_PERIODO marcas depois de passar do limite */
+#ifndef cfg_INANICAO_PERIODO
+#define cfg_INANICAO_PERIODO	8
+#endif
+
+/* interrupcoes aninhadas: as rotinas de interrupcao que usam os servicos 
+   do sistema podem comecar com InterrupcaoEntra() e terminar com 
+   InterrupcaoSai(). Entre elas, inclusive nas interrupcoes aninhadas, as 
+   tarefas acordadas nao solicitam a troca de contexto uma a uma: o 
+   escalonador decide uma vez, na saida da interrupcao mais externa. As 
+   rotinas sem as marcas continuam como antes. 1 habilita, 0 desabilita */
+#ifndef cfg_INTERRUPCOES_ANINHADAS
+#define cfg_INTERRUPCOES_ANINHADAS	0
+#endif
+
+/* orcamento de execucao das tarefas (servidores de tempo de execucao): a 
+   tarefa registrada com TarefaOrcamento executa no maximo C marcas a cada 
+   periodo de T marcas. A marca de tempo desconta uma marca da tarefa que 
+   interrompeu; esgotado o orcamento, a tarefa e rebaixada a uma prioridade 
+   menor ou suspensa ate a reposicao, no inicio do proximo periodo. Uma 
+   tarefa descontrolada de alta prioridade deixa de bloquear as demais. 
+   1 habilita, 0 desabilita */
+#ifndef cfg_ORCAMENTO
+#define cfg_ORCAMENTO	0
+#endif
+
+typedef  void (*tarefa_t)(void);
+typedef enum {PRONTA, ESPERA, TERMINADA} estado_tarefa_t;	/* TERMINADA: TCB livre para uma nova tarefa */
+typedef uint8_t	  prioridade_t;
+typedef uint32_t  tick_t;	/* marcas de tempo: 32 bits, retorna a 0 apos ~49 dias a 1 kHz */
+
+/* tempo de espera sem limite (ex.: TarefaAguardaNotificacao) */
+#define ESPERA_INFINITA		((tick_t)~0)
+
+/* acoes de TarefaNotifica sobre o valor de notificacao da tarefa */
+typedef enum {
+	NOTIFICA_BITS,			///< liga os bits de valor (OU bit a bit), ex.: um evento por bit
+	NOTIFICA_INCREMENTA,	///< incrementa o valor (valor ignorado), como um semaforo contador
+	NOTIFICA_SOBRESCREVE	///< substitui o valor, como uma caixa de correio de uma posicao
+} acao_notificacao_t;
+
+#if cfg_MONITOR_PERIODICAS
+/**
+* \struct monitor_periodica_t
+* Medicoes de uma tarefa periodica (TarefaEsperaAte), em marcas de tempo. 
+* O atraso e a diferenca entre o instante em que a tarefa voltou a executar 
+* e o instante de liberacao esperado; a media e atraso_total / ativacoes
+*/
+
+typedef struct 
+{
+	uint32_t	ativacoes;			///< Liberacoes medidas
+	uint32_t	prazos_perdidos;	///< Vezes que o periodo terminou antes de a tarefa chamar TarefaEsperaAte
+	tick_t		atraso_minimo;		///< Menor atraso de liberacao
+	tick_t		atraso_maximo;		///< Maior atraso de liberacao
+	uint32_t	atraso_total;		///< Soma dos atrasos, para a media
+} monitor_periodica_t;
+#endif
+
+#if cfg_INANICAO > 0
+/**
+* \struct inanicao_tarefa_t
+* Esperas de uma tarefa pronta pela CPU, em marcas de tempo
+*/
+
+typedef struct
+{
+	tick_t		maior_espera;		///< Maior tempo pronta sem executar, incluindo a espera atual
+	tick_t		espera_atual;		///< Tempo pronta sem executar ate agora (0 se executa ou esta bloqueada)
+	uint16_t	inanicoes;			///< Esperas que passaram de cfg_INANICAO marcas
+} inanicao_tarefa_t;
+#endif
+
+#if cfg_TEMPO_BLOQUEIO
+/**
+* \struct tempo_bloqueio_t
+* Tempo bloqueado num objeto ou de uma tarefa, em contagens do relogio de 
+* cfg_TEMPO_BLOQUEIO_RELOGIO. As faixas param em 0xFFFF
+*/
+
+typedef struct 
+{
+	uint64_t	total;			///< Soma das esperas
+	uint32_t	esperas;		///< Vezes que a tarefa bloqueou
+	uint32_t	maior;			///< Maior espera
+	uint16_t	faixas[cfg_TEMPO_BLOQUEIO_FAIXAS];	///< Histograma das esperas (ver cfg_TEMPO_BLOQUEIO_FAIXAS)
+} tempo_bloqueio_t;
+#endif
+
+/**
+* \struct tcb_t
+* Estrutura de controle de tarefas. Os campos usados pelo escalonador e pela 
+* troca de contexto ficam nos primeiros 8 bytes; os demais vem agrupados por 
+* tamanho, sem preenchimento entre eles. O nome fica fora, em TarefaNome, e 
+* com cfg_TCB_SEPARADO o estado, a prioridade e a espera por tempo tambem 
+* (TCB_ESTADO etc.)
+*/
+
+typedef struct
+{
+	stackptr_t 		stack_pointer;
+#if !cfg_TCB_SEPARADO
+	uint8_t			estado : 2;		///< estado_tarefa_t
+#endif
+	uint8_t			esperando_notificacao : 1;	///< 1 se a tarefa esta bloqueada em TarefaAguardaNotificacao
+	uint8_t			tempo_esgotado : 1;	///< 1 se a ultima espera com limite de tempo por um objeto terminou sem ele
+#if cfg_CEDE_DIRETO
+	uint8_t			cedida : 1;		///< 1 se o contexto foi guardado por TarefaCede, sem o PendSV
+#endif
+#if !cfg_TCB_SEPARADO
+	prioridade_t 	prioridade;
+#endif
+	uint8_t			proxima;		///< proxima tarefa na fila de prontas de mesma prioridade
+	uint8_t			anterior;		///< tarefa anterior na fila de prontas de mesma prioridade
+	prioridade_t	limiar_preempcao;	///< a marca de tempo so preempta a tarefa por uma de prioridade maior que esta
+	prioridade_t	prioridade_base;	///< prioridade original, sem heranca de prioridade (mutex)
+	uint8_t			mutexes;		///< numero de mutexes possuidos pela tarefa
+#if !cfg_TCB_SEPARADO
+	uint8_t			prox_espera;	///< proxima tarefa na lista de espera por tempo
+#endif
+	uint8_t			prox_evento;	///< proxima tarefa na lista de espera de um objeto (semaforo)
+#if cfg_GRUPOS_EVENTOS
+	uint8_t			opcoes_eventos;	///< opcoes da espera no grupo de eventos (EVENTOS_TODOS, EVENTOS_ZERA)
+#endif
+#if cfg_ARENA_PILHAS > 0
+	uint8_t			bloco_pilha;	///< bloco da arena de pilhas usado pela tarefa + 1 (0 = pilha do usuario)
+#endif
+#if cfg_PILHA_TAREFAS_BASICAS > 0
+	uint8_t			iniciada;		///< 1 se a tarefa basica tem um contexto na pilha compartilhada
+	uint8_t			basica_abaixo;	///< tarefa basica iniciada logo abaixo na pilha compartilhada
+	uint8_t			ativacoes;		///< ativacoes pendentes, executadas depois da atual
+#endif
+#if cfg_ESCALONADOR_EDF
+	uint8_t			tem_prazo;		///< 1 se a tarefa tem prazo
+	uint8_t			posicao_heap;	///< posicao no heap de prontas (EDF)
+#endif
+#if cfg_PINTA_PILHA
+	uint16_t		tamanho_pilha;	///< tamanho da area de pilha, em palavras
+#endif
+#if !cfg_TCB_SEPARADO
+	tick_t			tempo_espera;	///< marcas restantes apos a tarefa anterior da lista de espera (delta)
+#endif
+	uint8_t			*lista_evento;	///< lista de espera do objeto em que a tarefa esta bloqueada
+	uint32_t		notificacao;	///< valor de notificacao pendente (0 = nenhuma)
+#if cfg_GRUPOS_EVENTOS
+	uint32_t		eventos;		///< bits esperados no grupo de eventos; ao acordar, os bits do grupo
+#endif
+#if cfg_PINTA_PILHA || cfg_VERIFICA_PILHA
+	stackptr_t		pilha;			///< inicio (menor endereco) da area de pilha da tarefa
+#endif
+#if cfg_PILHA_TAREFAS_BASICAS > 0
+	tarefa_t		funcao_basica;	///< funcao da tarefa basica (0 = tarefa com pilha propria)
+#endif
+#if cfg_ESCALONADOR_EDF
+	tick_t			prazo;			///< prazo absoluto (marca de tempo), se tem_prazo
+#endif
+#if cfg_PINOS_RASTRO
+	uint32_t		pinos_rastro;	///< pinos ligados enquanto a tarefa executa (0 = nenhum)
+#endif
+#if cfg_ESTATISTICAS
+	uint32_t		trocas;			///< numero de vezes que a tarefa entrou em execucao
+	uint32_t		preempcoes;		///< numero de vezes que saiu de execucao ainda pronta
+	uint64_t		tempo_execucao;	///< tempo total em execucao, em ciclos de clock
+#endif
+#if cfg_ENERGIA
+	uint64_t		energia;		///< energia estimada em execucao, em pJ
+#endif
+#if cfg_MONITOR_PERIODICAS
+	monitor_periodica_t	periodica;	///< medicoes de TarefaEsperaAte
+#endif
+#if cfg_TEMPO_BLOQUEIO
+	tempo_bloqueio_t	bloqueio;	///< tempo bloqueado em semaforos, mutexes e filas
+#endif
+}tcb_t;
+
+extern  uint8_t		tarefa_atual;
+extern  uint8_t		proxima_tarefa;
+extern  tcb_t		TCB[NUMERO_DE_TAREFAS+1];
+extern  tcb_t	   *tcb_atual;			/* &TCB[tarefa_atual], sem a conta do indice */
+extern  stackptr_t	ponteiro_de_pilha;
+extern  uint8_t		Prioridades[PRIORIDADE_MAXIMA+1];
+
+/* o TCB de uma tarefa pelo indice e o indice pelo TCB, para quem guarda a 
+   tarefa pelo endereco (ex.: tcb_atual) */
+#define TAREFA_TCB(id)		(&TCB[(id)])
+#define TAREFA_ID(tcb)		((uint8_t)((tcb) - TCB))
+
+/* campos do TCB usados pela marca de tempo e pelo escalonador, pelo indice 
+   da tarefa (ou da tarefa atual): no tcb_t ou, com cfg_TCB_SEPARADO, nos 
+   vetores proprios */
+#if cfg_TCB_SEPARADO
+extern  uint8_t		tcb_estado[NUMERO_DE_TAREFAS+1];		/* estado_tarefa_t */
+extern  prioridade_t	tcb_prioridade[NUMERO_DE_TAREFAS+1];
+extern  uint8_t		tcb_prox_espera[NUMERO_DE_TAREFAS+1];
+extern  tick_t		tcb_tempo_espera[NUMERO_DE_TAREFAS+1];
+#define TCB_ESTADO(id)			(tcb_estado[(id)])
+#define TCB_PRIORIDADE(id)		(tcb_prioridade[(id)])
+#define TCB_PROX_ESPERA(id)		(tcb_prox_espera[(id)])
+#define TCB_TEMPO_ESPERA(id)	(tcb_tempo_espera[(id)])
+#define TCB_ATUAL_ESTADO()		(tcb_estado[tarefa_atual])
+#define TCB_ATUAL_PRIORIDADE()	(tcb_prioridade[tarefa_atual])
+#else
+#define TCB_ESTADO(id)			(TCB[(id)].estado)
+#define TCB_PRIORIDADE(id)		(TCB[(id)].prioridade)
+#define TCB_PROX_ESPERA(id)		(TCB[(id)].prox_espera)
+#define TCB_TEMPO_ESPERA(id)	(TCB[(id)].tempo_espera)
+#define TCB_ATUAL_ESTADO()		(tcb_atual->estado)
+#define TCB_ATUAL_PRIORIDADE()	(tcb_atual->prioridade)
+#endif
+#if cfg_PILHA_TAREFAS_BASICAS > 0
+extern  uint8_t		contexto_descartado;	/* a tarefa que saiu na ultima troca terminou: a porta nao precisa guardar o contexto */
+#endif
+
+#if cfg_INTERRUPCOES_ANINHADAS
+/* interrupcoes marcadas em execucao */
+extern volatile uint8_t	nivel_interrupcao;
+
+/* inicio de uma rotina de interrupcao: sem regiao atomica, pois uma 
+   interrupcao aninhada entre a leitura e a escrita sai antes, com o 
+   mesmo valor */
+#define InterrupcaoEntra()	(nivel_interrupcao++)
+void InterrupcaoSai(void);
+#else
+#define InterrupcaoEntra()
+#define InterrupcaoSai()
+#endif
+
+#if cfg_VIGIA > 0
+/* sinais das tarefas vigiadas, zerados a cada verificacao */
+extern volatile uint8_t	vigia_sinal[NUMERO_DE_TAREFAS+1];
+
+/* a tarefa atual esta viva: uma escrita, sem regiao atomica */
+#define VigiaSinaliza()		(vigia_sinal[tarefa_atual] = 1)
+#else
+#define VigiaSinaliza()
+#endif
+
+#if cfg_ESTATISTICAS
+/**
+* \struct estatisticas_tarefa_t
+* Copia das estatisticas de execucao de uma tarefa
+*/
+
+typedef struct 
+{
+	uint8_t		id;					///< Identificador da tarefa
+	const char	*nome;				///< Nome da tarefa
+	uint64_t	tempo_execucao;		///< Tempo total em execucao, em ciclos de clock
+	uint32_t	trocas;				///< Vezes que a tarefa entrou em execucao
+	uint32_t	preempcoes;			///< Vezes que saiu de execucao ainda pronta (preemptada)
+#if cfg_ENERGIA
+	uint64_t	energia;			///< Energia estimada em execucao, em pJ
+#endif
+} estatisticas_tarefa_t;
+#endif
+
+#if cfg_GRUPOS_EVENTOS
+/**
+* \struct grupo_eventos_t
+* Estrutura de controle do grupo de eventos: um evento por bit
+*/
+
+typedef struct 
+{
+	volatile uint32_t	bits;			///< Eventos ligados e ainda nao zerados
+	uint8_t		tarefaEsperando;		///< Primeira tarefa da lista de espera, ordenada por prioridade
+} grupo_eventos_t;
+
+/* opcoes de GrupoEventosAguarda, combinadas com | */
+#define EVENTOS_QUALQUER	0		///< retorna com qualquer um dos bits
+#define EVENTOS_TODOS		1		///< retorna so com todos os bits
+#define EVENTOS_ZERA		2		///< zera os bits esperados ao retornar com eles
+#endif
+
+/**
+* \struct semaforo_t
+* Estrutura de controle do semaforo
+*/
+
+typedef struct 
+{
+	uint8_t     contador;            ///< Contador do semaforo
+	uint8_t 	tarefaEsperando;        ///< Primeira tarefa da lista de espera, ordenada por prioridade
+#if cfg_ESPERAS_SEMAFORO
+	uint32_t	aguardas;			///< Chamadas de SemaforoAguarda e SemaforoAguardaTempo
+	uint32_t	bloqueios;			///< Chamadas em que a tarefa teve de esperar
+	uint32_t	esgotados;			///< Chamadas que retornaram sem o semaforo
+#endif
+#if cfg_GRUPOS_EVENTOS
+	grupo_eventos_t	*grupo;			///< Grupo avisado quando o contador sobe (0 = nenhum)
+	uint32_t	bits_grupo;			///< Bits ligados no grupo
+#endif
+#if cfg_REGISTRO_OBJETOS
+	uint8_t		maximo;				///< Maior valor do contador apos SemaforoLibera
+#endif
+#if cfg_TEMPO_BLOQUEIO
+	tempo_bloqueio_t	bloqueio;	///< Tempo das tarefas bloqueadas no semaforo
+#endif
+} semaforo_t;
+
+/**
+* \struct mutex_t
+* Estrutura de controle do mutex (exclusao mutua com heranca de prioridade)
+*/
+
+typedef struct 
+{
+	uint8_t     dono;                ///< Tarefa que possui o mutex (0 = livre)
+	uint8_t 	tarefaEsperando;        ///< Primeira tarefa da lista de espera, ordenada por prioridade
+#if cfg_TEMPO_BLOQUEIO
+	tempo_bloqueio_t	bloqueio;	///< Tempo das tarefas bloqueadas no mutex
+#endif
+} mutex_t;
+
+/**
+* \struct condicao_t
+* Estrutura de controle da variavel de condicao, usada com um mutex: a 
+* tarefa confere o estado compartilhado com o mutex e, se ainda nao pode 
+* seguir, espera em CondicaoAguarda, que libera o mutex e bloqueia sem 
+* intervalo entre os dois. Quem muda o estado chama CondicaoSinaliza ou 
+* CondicaoDifunde. A condicao e conferida de novo ao retornar (laco while)
+*/
+
+typedef struct 
+{
+	uint8_t 	tarefaEsperando;        ///< Primeira tarefa da lista de espera, ordenada por prioridade
+} condicao_t;
+
+/**
+* \struct trava_rw_t
+* Estrutura de controle da trava de leitura e escrita, para dados lidos 
+* com frequencia e alterados raramente (ex.: configuracao, calibracao): 
+* varios leitores ao mesmo tempo ou um so escritor. Sem escritor, a 
+* leitura so conta o leitor. O escritor tem preferencia sobre os leitores 
+* de prioridade igual ou menor a dele: eles esperam enquanto ele espera. 
+* O escritor dono herda a prioridade de quem espera, como no mutex; os 
+* leitores nao herdam. Inicializada com zeros
+*/
+
+typedef struct 
+{
+	uint8_t		leitores;				///< Leitores com a trava
+	uint8_t		escritor;				///< Tarefa que escreve (0 = nenhuma)
+	uint8_t		leitoresEsperando;		///< Primeiro leitor da lista de espera, ordenada por prioridade
+	uint8_t		escritoresEsperando;	///< Primeiro escritor da lista de espera, ordenada por prioridade
+} trava_rw_t;
+
+/**
+* \struct fila_t
+* Estrutura de controle da fila de mensagens de tamanho fixo. 
+* Para passar apenas ponteiros (sem copia dos dados), usar 
+* mensagens de tamanho sizeof(void*) e FilaEnviaPonteiro/FilaRecebePonteiro
+*/
+
+typedef struct 
+{
+	uint8_t		*area;				///< Area de armazenamento (capacidade * tamanho bytes)
+	uint8_t		tamanho;			///< Tamanho de cada mensagem, em bytes
+	uint8_t		capacidade;			///< Numero maximo de mensagens
+	uint8_t		quantidade;			///< Numero de mensagens na fila
+	uint8_t		inicio;				///< Posicao da mensagem mais antiga
+	uint8_t		esperandoEnviar;	///< Primeira tarefa esperando espaco para enviar
+	uint8_t		esperandoReceber;	///< Primeira tarefa esperando mensagem para receber
+#if cfg_GRUPOS_EVENTOS
+	grupo_eventos_t	*grupo;			///< Grupo avisado quando uma mensagem fica na fila (0 = nenhum)
+	uint32_t	bits_grupo;			///< Bits ligados no grupo
+#endif
+#if cfg_REGISTRO_OBJETOS
+	uint8_t		maximo;				///< Maior numero de mensagens na fila
+#endif
+#if cfg_TEMPO_BLOQUEIO
+	tempo_bloqueio_t	bloqueio;	///< Tempo das tarefas bloqueadas na fila, enviando ou recebendo
+#endif
+} fila_t;
+
+
+/**
+* \struct memoria_t
+* Estrutura de controle do conjunto de blocos de memoria de tamanho fixo. 
+* Os blocos livres formam uma lista encadeada guardada nos proprios blocos, 
+* entao alocar e liberar levam tempo constante
+*/
+
+typedef struct 
+{
+	void		*livres;			///< Primeiro bloco livre (cada bloco livre guarda o endereco do seguinte)
+	uint16_t	tamanho;			///< Tamanho de cada bloco, em bytes (multiplo de sizeof(void*))
+	uint16_t	quantidade;			///< Numero de blocos livres
+	uint8_t		tarefaEsperando;	///< Primeira tarefa esperando um bloco livre
+#if cfg_REGISTRO_OBJETOS
+	uint16_t	minimo;				///< Menor numero de blocos livres
+#endif
+} memoria_t;
+
+/* tamanho de um bloco de tamanho bytes, arredondado para guardar o encadeamento */
+#define MEMORIA_TAMANHO_BLOCO(tamanho)	((((tamanho) + sizeof(void*) - 1) / sizeof(void*)) * sizeof(void*))
+
+/* declara a area de numero blocos de tamanho bytes para MemoriaInicia, 
+   alinhada para ponteiros. Ex.: static MEMORIA_AREA(area_quadros, 64, 8); */
+#define MEMORIA_AREA(nome, tamanho, numero)	\
+	void *nome[((numero) * MEMORIA_TAMANHO_BLOCO(tamanho)) / sizeof(void*)]
+
+/**
+* \struct arena_t
+* Area de rascunho de um ciclo de processamento (ex.: descompressao ou 
+* copia de um quadro recebido): cada alocacao so avanca o ponteiro da 
+* area, em tempo constante, e nada e liberado ate ArenaZera, no fim do 
+* ciclo, que devolve tudo de uma vez. Sem regiao atomica: cada arena 
+* pertence a uma tarefa ou a um objeto ativo (zerada por 
+* ObjetosAtivosExecuta apos cada evento). O maximo usado mostra a area 
+* necessaria no pior caso
+*/
+
+typedef struct 
+{
+	uint8_t		*area;
+	uint16_t	tamanho;			///< Tamanho da area, em bytes
+	uint16_t	usado;				///< Bytes alocados desde ArenaZera
+	uint16_t	maximo;				///< Maior valor de usado
+	uint16_t	falhas;				///< Alocacoes recusadas sem espaco
+} arena_t;
+
+/* declara a area de tamanho bytes para ArenaInicia, alinhada para 
+   ponteiros. Ex.: static ARENA_AREA(rascunho, 512); */
+#define ARENA_AREA(nome, tamanho)	void *nome[MEMORIA_TAMANHO_BLOCO(tamanho) / sizeof(void*)]
+
+/* devolve todas as alocacoes da arena */
+#define ArenaZera(arena)	((arena)->usado = 0)
+
+/**
+* \struct anel_t
+* Fila circular de bytes sem regiao atomica, para um unico produtor (ex.: 
+* uma interrupcao) e um unico consumidor (uma tarefa). Cada indice so e 
+* alterado por um dos lados, entao escrever e ler nao desabilitam as 
+* interrupcoes. Os indices contam sem parar e a posicao na area e o 
+* indice & mascara, por isso a capacidade deve ser potencia de 2. 
+* Tambem serve de fluxo de bytes entre tarefas (ex.: saida de um 
+* analisador, registros): o consumidor acorda uma vez por lote, no nivel 
+* pedido em AnelAguardaNivel ou no fim do tempo; varios produtores 
+* escrevem com AnelEscreveAtomico e um produtor tarefa pode esperar 
+* espaco com AnelEscreveEspera
+*/
+
+typedef struct 
+{
+	uint8_t				*area;				///< Area de armazenamento (capacidade bytes)
+	uint16_t			mascara;			///< Capacidade - 1
+	volatile uint16_t	escrita;			///< Total de bytes escritos (so o produtor altera)
+	volatile uint16_t	leitura;			///< Total de bytes lidos (so o consumidor altera)
+	uint16_t			limiar;				///< Quantidade que acorda o consumidor em AnelAguarda
+	uint16_t			espaco;				///< Espaco livre que acorda o produtor em AnelEscreveEspera
+	uint8_t				tarefaEsperando;	///< Consumidor esperando em AnelAguarda (0 = nenhum)
+	uint8_t				tarefaEscrevendo;	///< Produtor esperando em AnelEscreveEspera (0 = nenhum)
+} anel_t;
+
+/**
+* \struct instantaneo_t
+* Ultimo valor de um bloco de varias palavras (ex.: vetor de um sensor, 
+* estatisticas) publicado por um unico produtor, em geral uma interrupcao, 
+* e lido por qualquer tarefa, sem regiao atomica. A area tem duas copias: 
+* o produtor escreve na que nao e a atual e a troca ao fim, sem esperar 
+* nunca. O leitor copia a atual e so repete se o produtor voltou a ela 
+* durante a copia (duas publicacoes no meio da leitura). A sequencia 
+* conta 2 por publicacao e fica impar durante a escrita
+*/
+
+typedef struct 
+{
+	uint8_t				*area;			///< Duas copias de tamanho bytes
+	uint16_t			tamanho;		///< Tamanho do bloco, em bytes
+	volatile uint32_t	sequencia;		///< Copia atual: (sequencia >> 1) & 1
+} instantaneo_t;
+
+/* funcao que envia os bytes do rastro ou do perfil (ex.: escrita na UART) */
+typedef void (*envia_rastro_t)(const uint8_t *dados, uint16_t tamanho);
+
+#if cfg_RASTRO > 0
+/* eventos do rastro. Os valores fazem parte do formato binario lido pelo 
+   decodificador no computador, entao so se acrescentam novos no fim */
+typedef enum {
+	RASTRO_TROCA = 1,			///< troca de contexto: tarefa = a que entra, dado = a que sai
+	RASTRO_MARCA,				///< marca de tempo que despertou tarefas: dado = quantas
+	RASTRO_SEMAFORO_AGUARDA,	///< obteve o semaforo sem esperar: dado = endereco do semaforo
+	RASTRO_SEMAFORO_BLOQUEIA,	///< bloqueou no semaforo: dado = endereco do semaforo
+	RASTRO_SEMAFORO_LIBERA,		///< liberou o semaforo: tarefa = a acordada (0 = nenhuma)
+	RASTRO_ESPERA				///< TarefaEspera: dado = marcas de tempo
+} evento_rastro_t;
+
+/**
+* \struct registro_rastro_t
+* Registro do rastro do nucleo (8 bytes)
+*/
+
+typedef struct 
+{
+	uint32_t	tempo;		///< Marca de tempo (16 bits altos) e ciclos desde ela (16 bits baixos), ou cfg_RASTRO_TEMPO()
+	uint8_t		evento;		///< evento_rastro_t
+	uint8_t		tarefa;		///< Tarefa do evento (em geral a atual)
+	uint16_t	dado;		///< Dado do evento (16 bits baixos, no caso de enderecos)
+} registro_rastro_t;
+
+/* anel do rastro, exposto para leitura direta pelo depurador (SWD): 
+   rastro_total registros ja gravados, o ultimo em (rastro_total - 1) % cfg_RASTRO */
+extern registro_rastro_t	rastro_nucleo[cfg_RASTRO];
+extern volatile uint16_t	rastro_total;
+#endif
+
+#if cfg_FALHA_GRAVE
+/* falha_grave.assinatura: captura ainda nao relatada, ou ja relatada na 
+   partida seguinte. Outro valor: nenhuma captura */
+#define FALHA_GRAVE_NOVA		0x46475631UL	/* "FGV1" */
+#define FALHA_GRAVE_RELATADA	0x46475230UL	/* "FGR0" */
+
+/**
+* \struct falha_grave_t
+* Estado capturado pelo HardFault, mantido ate a partida seguinte
+*/
+
+typedef struct
+{
+	uint32_t	assinatura;			///< FALHA_GRAVE_NOVA ou FALHA_GRAVE_RELATADA
+	uint32_t	quadro[8];			///< Registradores empilhados na excecao (Cortex-M: R0-R3, R12, LR, PC, xPSR)
+	uint32_t	retorno;			///< Retorno da excecao (EXC_RETURN): pilha e modo da falha
+	uint32_t	msp;				///< Pilha principal na falha
+	uint32_t	psp;				///< Pilha da tarefa na falha
+	tick_t		marca_tempo;		///< Marca de tempo da falha
+	uint8_t		tarefa;				///< Tarefa em execucao na falha
+	uint8_t		quadro_valido;		///< 0 se a pilha da falha estava fora da RAM (quadro zerado)
+	uint16_t	rastro_total;		///< rastro_total na falha (0 sem cfg_RASTRO)
+#if cfg_RASTRO > 0
+	registro_rastro_t rastro[cfg_FALHA_GRAVE_RASTRO];	///< Ultimos registros, do mais antigo ao mais recente (zerados os que faltam)
+#endif
+} falha_grave_t;
+
+extern falha_grave_t falha_grave;
+#endif
+
+#if cfg_PERFIL > 0
+/**
+* \struct amostra_perfil_t
+* Amostra do perfil estatistico (8 bytes)
+*/
+
+typedef struct 
+{
+	uint32_t	pc;			///< Endereco da instrucao interrompida (0 = fora das tarefas)
+	uint8_t		tarefa;		///< Tarefa atual na amostra
+	uint8_t		reservado;
+	uint16_t	marca;		///< Marca de tempo da amostra (16 bits baixos)
+} amostra_perfil_t;
+
+/* anel do perfil, exposto para leitura direta pelo depurador (SWD): 
+   perfil_total amostras ja gravadas, a ultima em (perfil_total - 1) % cfg_PERFIL */
+extern amostra_perfil_t		perfil_amostras[cfg_PERFIL];
+extern volatile uint32_t	perfil_total;
+#endif
+
+#if cfg_FILA_TRABALHOS > 0
+typedef void (*funcao_trabalho_t)(void *arg);
+#endif
+
+#if cfg_OBJETOS_ATIVOS > 0
+/**
+* \struct evento_t
+* Evento enviado a um objeto ativo, copiado na fila do objeto. Dados maiores 
+* que um ponteiro vao em um bloco de memoria (MemoriaAlocaISR), liberado 
+* pela funcao de despacho
+*/
+
+typedef struct 
+{
+	uint16_t	sinal;				///< Tipo do evento, definido pela aplicacao
+	void		*dado;				///< Parametro do evento (valor ou ponteiro)
+} evento_t;
+
+struct objeto_ativo_s;
+
+/* funcao de despacho: trata um evento ate o fim e retorna, sem bloquear 
+   (sem TarefaEspera, SemaforoAguarda etc.), pois os demais objetos do 
+   grupo so executam depois dela */
+typedef void (*despacho_objeto_t)(struct objeto_ativo_s *objeto, const evento_t *evento);
+
+/**
+* \struct objeto_ativo_t
+* Estrutura de controle do objeto ativo. O estado da maquina de estados da 
+* aplicacao fica em uma estrutura que comeca com um objeto_ativo_t, 
+* recuperada na funcao de despacho pelo ponteiro do objeto
+*/
+
+typedef struct objeto_ativo_s
+{
+	despacho_objeto_t	despacho;	///< Funcao que trata os eventos
+	evento_t	*fila;				///< Area da fila de eventos (capacidade eventos)
+	uint8_t		capacidade;			///< Numero maximo de eventos na fila
+	uint8_t		quantidade;			///< Numero de eventos na fila
+	uint8_t		inicio;				///< Posicao do evento mais antigo
+	uint8_t		grupo;				///< Grupo (tarefa) que executa o objeto
+	uint8_t		prioridade;			///< Prioridade no grupo (maior primeiro)
+	uint16_t	perdidos;			///< Eventos recusados com a fila cheia
+	arena_t		*arena;				///< Rascunho zerado apos cada evento (0 = nenhum)
+} objeto_ativo_t;
+#endif
+
+#if cfg_GANCHOS_OCIOSA > 0
+/* gancho da tarefa ociosa: executa um passo curto do seu servico e retorna 
+   1 se ainda ha trabalho pendente (a tarefa ociosa nao dorme), 0 se nao */
+typedef uint8_t (*gancho_ociosa_t)(void);
+#endif
+
+#if cfg_TEMPORIZADORES
+typedef void (*funcao_temporizador_t)(void *arg);
+
+/**
+* \struct temporizador_t
+* Estrutura de controle do temporizador de software. A funcao e chamada 
+* pela tarefa de temporizadores, entao pode usar os servicos do sistema, 
+* mas nao deve bloquear, pois atrasaria os demais temporizadores
+*/
+
+typedef struct temporizador_s
+{
+	funcao_temporizador_t	funcao;		///< Funcao chamada no vencimento
+	void		*arg;					///< Argumento passado para a funcao
+	tick_t		vencimento;				///< Marca de tempo do proximo vencimento
+	tick_t		periodo;				///< Periodo em marcas (0 = uma vez so)
+	struct temporizador_s	*proximo;	///< Proximo temporizador na mesma posicao da roda
+	struct temporizador_s	*anterior;	///< Temporizador anterior na mesma posicao da roda
+	uint8_t		ativo;					///< 1 se o temporizador esta na roda
+} temporizador_t;
+#endif
+
+#if cfg_REGISTRO_OBJETOS
+/* tipos de objeto do registro (ObjetoRegistra) */
+#define OBJETO_SEMAFORO			1
+#define OBJETO_MUTEX			2
+#define OBJETO_CONDICAO			3
+#define OBJETO_TRAVA_RW			4
+#define OBJETO_FILA				5
+#define OBJETO_MEMORIA			6
+#define OBJETO_GRUPO_EVENTOS	7
+#define OBJETO_TEMPORIZADOR		8
+
+/**
+* \struct registro_objeto_t
+* Ligacao de um objeto no registro, guardada pela aplicacao (ex.: static)
+*/
+
+typedef struct registro_objeto_s
+{
+	const char	*nome;						///< Nome mostrado pelas ferramentas
+	void		*objeto;					///< Objeto registrado
+	struct registro_objeto_s	*proximo;	///< Proximo objeto registrado
+	uint8_t		tipo;						///< OBJETO_SEMAFORO, OBJETO_FILA, ...
+} registro_objeto_t;
+
+/**
+* \struct estado_objeto_t
+* Copia do estado de um objeto registrado (ObjetosObtemEstado). A fila so 
+* tem tarefas esperando de um lado por vez (vazia ou cheia); a trava de 
+* leitura e escrita conta os leitores e os escritores esperando
+*/
+
+typedef struct 
+{
+	const char	*nome;				///< Nome do registro
+	const void	*objeto;			///< Objeto registrado
+	uint8_t		tipo;				///< OBJETO_SEMAFORO, OBJETO_FILA, ...
+	uint8_t		esperando;			///< Tarefas esperando o objeto
+	uint8_t		primeira;			///< Primeira tarefa esperando (maior prioridade), 0 = nenhuma
+	uint8_t		dono;				///< Dono do mutex ou escritor da trava, 0 = nenhum
+	uint32_t	contagem;			///< Contador do semaforo, mensagens da fila, blocos livres, leitores da trava, bits do grupo ou marcas ate o vencimento do temporizador (0 = desligado)
+	uint32_t	marca_agua;			///< Maior contador do semaforo ou da fila, menor numero de blocos livres
+#if cfg_ESPERAS_SEMAFORO
+	uint32_t	bloqueios;			///< Chamadas de SemaforoAguarda que bloquearam (so semaforos)
+#endif
+#if cfg_TEMPO_BLOQUEIO
+	uint64_t	tempo_bloqueado;	///< Tempo total bloqueado no semaforo, mutex ou fila (tempo_bloqueio_t)
+#endif
+} estado_objeto_t;
+
+/* registra o objeto com um registro estatico proprio, para as chamadas 
+   feitas uma vez na inicializacao. Ex.: 
+   OBJETO_REGISTRA(OBJETO_SEMAFORO, &SemaforoCheio, "cheio"); */
+#define OBJETO_REGISTRA(tipo, objeto, nome)		do { static registro_objeto_t registro_objeto_; \
+													 ObjetoRegistra(&registro_objeto_, (tipo), (objeto), (nome)); } while(0)
+#endif
+
+/**
+* \struct descritor_tarefa_t
+* Descricao de uma tarefa na tabela estatica de tarefas (ver TAREFAS_DECLARA)
+*/
+
+typedef struct 
+{
+	tarefa_t		funcao;			///< Funcao da tarefa
+	const char		*nome;			///< Nome da tarefa
+	stackptr_t		pilha;			///< Area de pilha da tarefa
+	uint16_t		tamanho_pilha;	///< Tamanho da area de pilha, em palavras
+	prioridade_t	prioridade;		///< Prioridade da tarefa
+} descritor_tarefa_t;
+
+/* Tabela estatica de tarefas (X-macro). A aplicacao descreve todas as 
+ * tarefas em um unico lugar, uma linha por tarefa com a funcao, o nome, o 
+ * tamanho da pilha (em palavras) e a prioridade:
+ *
+ *   #define TABELA_DE_TAREFAS(TAREFA)								\
+ *       TAREFA(tarefa_1, "Tarefa 1", TAM_MINIMO_PILHA + 24, 2)		\
+ *       TAREFA(tarefa_ociosa, "Tarefa ociosa", TAM_MINIMO_PILHA + 24, 0)
+ *
+ *   TAREFAS_DECLARA(TABELA_DE_TAREFAS)
+ *
+ * TAREFAS_DECLARA gera, fora de funcoes, os prototipos, as pilhas, os 
+ * identificadores ID_<funcao> e a tabela constante tabela_de_tarefas, e 
+ * verifica na compilacao as prioridades, os tamanhos das pilhas e o numero 
+ * de tarefas. Em main(), CriaTarefasDaTabela(tabela_de_tarefas, 
+ * NUMERO_TAREFAS_DA_TABELA) cria todas elas. Os identificadores so valem 
+ * se a tabela for criada antes de qualquer outra tarefa. 
+ * TAREFAS_PRIORIDADES_UNICAS(TABELA) tambem impede, na compilacao, duas 
+ * tarefas com a mesma prioridade (erro "duplicate case value") */
+#define TAREFA_PROTOTIPO_(funcao, nome, tamanho, prioridade)	void funcao(void);
+#define TAREFA_PILHA_(funcao, nome, tamanho, prioridade)		static uint32_t pilha_##funcao[tamanho];
+#define TAREFA_ID_(funcao, nome, tamanho, prioridade)			ID_##funcao,
+#define TAREFA_DESCRITOR_(funcao, nome, tamanho, prioridade)	{ funcao, nome, pilha_##funcao, tamanho, prioridade },
+#define TAREFA_CASO_(funcao, nome, tamanho, prioridade)			case (prioridade):
+#define TAREFA_VERIFICA_(funcao, nome, tamanho, prioridade)		\
+	typedef char verifica_##funcao[((prioridade) <= PRIORIDADE_MAXIMA && (tamanho) >= TAM_MINIMO_PILHA) ? 1 : -1];
+
+#define TAREFAS_DECLARA(TABELA)													\
+	TABELA(TAREFA_PROTOTIPO_)													\
+	TABELA(TAREFA_VERIFICA_)													\
+	TABELA(TAREFA_PILHA_)														\
+	enum { ID_TAREFAS_INICIO_ = 0, TABELA(TAREFA_ID_) ID_TAREFAS_FIM_ };		\
+	enum { NUMERO_TAREFAS_DA_TABELA = ID_TAREFAS_FIM_ - 1 };					\
+	typedef char verifica_numero_de_tarefas_[(NUMERO_TAREFAS_DA_TABELA <= NUMERO_DE_TAREFAS) ? 1 : -1]; \
+	static const descritor_tarefa_t tabela_de_tarefas[] = { TABELA(TAREFA_DESCRITOR_) };
+
+#define TAREFAS_PRIORIDADES_UNICAS(TABELA)										\
+	static inline void verifica_prioridades_unicas_(void)						\
+	{																			\
+		switch(0) { TABELA(TAREFA_CASO_) default: break; }						\
+	}
+
+void tarefa_ociosa(void);
+NUCLEO_RAPIDO uint8_t escalonador(void);
+
+CHAMADA_POR_ASM NUCLEO_RAPIDO stackptr_t TrocaContextoDasTarefas(stackptr_t pilha);
+#if cfg_CEDE_DIRETO
+CHAMADA_POR_ASM NUCLEO_RAPIDO stackptr_t TrocaContextoCedida(stackptr_t pilha);
+#endif
+uint32_t * CriaContexto(tarefa_t endereco_tarefa, uint32_t* ptr_pilha);
+uint8_t CriaTarefa(tarefa_t p, const char * nome, stackptr_t pilha, uint16_t tamanho, prioridade_t prioridade);
+#if cfg_ARENA_PILHAS > 0
+uint8_t CriaTarefaDinamica(tarefa_t p, const char * nome, prioridade_t prioridade);
+#endif
+#if cfg_PILHA_TAREFAS_BASICAS > 0
+uint8_t CriaTarefaBasica(tarefa_t p, const char * nome, prioridade_t prioridade);
+uint8_t TarefaBasicaAtiva(uint8_t id_tarefa);
+#endif
+uint8_t TarefaTermina(uint8_t id_tarefa);
+uint8_t CriaTarefasDaTabela(const descritor_tarefa_t *tabela, uint8_t numero);
+#if cfg_OCIOSA_PILHA_PRINCIPAL
+uint8_t CriaTarefaOciosa(uint16_t tamanho);
+#endif
+void IniciaMultitarefas(void);
+void ConfiguraMarcaTempo(void);
+NUCLEO_RAPIDO void ExecutaMarcaDeTempo(void);
+void CompensaMarcasDeTempo(tick_t qtas_marcas);
+void DormeSemMarcas(tick_t qtas_marcas);
+
+void TarefaSuspende(uint8_t id_tarefa);
+void TarefaContinua(uint8_t id_tarefa);
+void TarefaContinuaISR(uint8_t id_tarefa);
+#if cfg_SERVICOS_EM_LINHA
+void TarefaEsperaLento(tick_t qtas_marcas);		/* TarefaEspera em linha, no fim do arquivo */
+#else
+void TarefaEspera(tick_t qtas_marcas);		
+#endif
+void TarefaEsperaAte(tick_t *ultimo_despertar, tick_t periodo);
+void TarefaCede(void);
+void TarefaLimiarPreempcao(uint8_t id_tarefa, prioridade_t limiar);
+uint8_t TarefaMudaPrioridade(uint8_t id_tarefa, prioridade_t prioridade);
+#if cfg_ESCALONADOR_EDF
+void TarefaDefinePrazo(uint8_t id_tarefa, tick_t qtas_marcas);
+#endif
+#if cfg_PINOS_RASTRO
+void TarefaDefinePinoRastro(uint8_t id_tarefa, uint32_t mascara);
+#endif
+tick_t ObtemMarcasDeTempo(void);
+const char* TarefaNome(uint8_t id_tarefa);
+#if cfg_OCIOSA_SEM_MARCAS
+tick_t ObtemMarcasDormidas(void);
+#endif
+#if cfg_PINTA_PILHA
+uint16_t TarefaPilhaLivre(uint8_t id_tarefa);
+#endif
+#if cfg_VERIFICA_PILHA
+void EstouroDePilha(uint8_t id_tarefa, const char *nome);
+#endif
+#if cfg_MONITOR_PERIODICAS
+uint8_t TarefaObtemMonitor(uint8_t id_tarefa, monitor_periodica_t *monitor);
+void TarefaZeraMonitor(uint8_t id_tarefa);
+#endif
+#if cfg_VIGIA > 0
+void VigiaRegistra(uint8_t id_tarefa, uint16_t janela);
+uint8_t VigiaAtrasada(void);
+#endif
+#if cfg_INANICAO > 0
+uint8_t TarefaObtemInanicao(uint8_t id_tarefa, inanicao_tarefa_t *inanicao);
+void TarefaZeraInanicao(uint8_t id_tarefa);
+#endif
+#if cfg_ORCAMENTO
+/* prioridade de TarefaOrcamento: a tarefa fica suspensa ao esgotar o orcamento */
+#define ORCAMENTO_SUSPENDE	0xFF
+uint8_t TarefaOrcamento(uint8_t id_tarefa, uint16_t marcas, uint16_t periodo, prioridade_t esgotado);
+uint16_t TarefaOrcamentoEstouros(uint8_t id_tarefa);
+#endif
+tick_t MarcaTempoInstante(uint32_t *contagens);		/* portas cortex_m0_gcc e cortex_m4_gcc */
+uint32_t MarcaTempoFrequencia(void);
+#if cfg_MARCA_VARIAVEL
+uint8_t MarcaTempoMudaFrequencia(uint32_t marca_hz);
+uint8_t MarcaTempoReprograma(uint32_t marca_hz);				/* porta */
+#endif
+#if cfg_AJUSTE_MARCA
+uint32_t MarcaTempoContagens(void);
+void MarcaTempoAjusta(int32_t frequencia, int32_t fase);
+#endif
+#if cfg_ESTATISTICAS
+uint64_t TempoEmCiclos(void);
+uint8_t TarefaObtemEstatisticas(estatisticas_tarefa_t *estatisticas, uint8_t max_tarefas, uint64_t *tempo_total);
+#endif
+#if cfg_TEMPO_BLOQUEIO
+void TempoBloqueioCopia(const tempo_bloqueio_t* medido, tempo_bloqueio_t* copia);
+void TempoBloqueioZera(tempo_bloqueio_t* medido);
+uint8_t TarefaObtemTempoBloqueio(uint8_t id_tarefa, tempo_bloqueio_t* copia);
+#endif
+#if cfg_ENERGIA
+void EnergiaAlteraCusto(uint32_t pj_por_ciclo);
+uint64_t EnergiaSono(void);
+#endif
+
+void TarefaNotifica(uint8_t id_tarefa, uint32_t valor, acao_notificacao_t acao);
+uint32_t TarefaAguardaNotificacao(tick_t timeout);
+
+#if cfg_SERVICOS_EM_LINHA
+void SemaforoAguardaLento(semaforo_t* sem);		/* SemaforoAguarda e SemaforoLibera em linha, */
+void SemaforoLiberaLento(semaforo_t* sem);		/* no fim do arquivo */
+#else
+void SemaforoAguarda(semaforo_t* sem);
+void SemaforoLibera(semaforo_t* sem);
+#endif
+uint8_t SemaforoAguardaTempo(semaforo_t* sem, tick_t timeout);
+void SemaforoLiberaISR(semaforo_t* sem);
+void SemaforoLiberaN(semaforo_t* sem, uint8_t n);
+
+#if cfg_GRUPOS_EVENTOS
+void GrupoEventosInicia(grupo_eventos_t* grupo);
+uint32_t GrupoEventosLiga(grupo_eventos_t* grupo, uint32_t bits);
+uint32_t GrupoEventosZera(grupo_eventos_t* grupo, uint32_t bits);
+uint32_t GrupoEventosAguarda(grupo_eventos_t* grupo, uint32_t bits, uint8_t opcoes, tick_t timeout);
+void SemaforoAssociaGrupo(semaforo_t* sem, grupo_eventos_t* grupo, uint32_t bits);
+void FilaAssociaGrupo(fila_t* fila, grupo_eventos_t* grupo, uint32_t bits);
+
+/* bits ligados no grupo, sem esperar */
+#define GrupoEventosLe(grupo)	((grupo)->bits)
+#endif
+
+void MutexAguarda(mutex_t* mutex);
+void MutexLibera(mutex_t* mutex);
+
+uint8_t CondicaoAguarda(condicao_t* condicao, mutex_t* mutex, tick_t timeout);
+void CondicaoSinaliza(condicao_t* condicao);
+void CondicaoDifunde(condicao_t* condicao);
+
+void TravaLeituraAguarda(trava_rw_t* trava);
+void TravaLeituraLibera(trava_rw_t* trava);
+void TravaEscritaAguarda(trava_rw_t* trava);
+void TravaEscritaLibera(trava_rw_t* trava);
+
+void FilaInicia(fila_t* fila, void* area, uint8_t tamanho, uint8_t capacidade);
+void FilaEnvia(fila_t* fila, const void* mensagem);
+void FilaRecebe(fila_t* fila, void* mensagem);
+uint8_t FilaEnviaISR(fila_t* fila, const void* mensagem);
+uint8_t FilaEnviaVariasISR(fila_t* fila, const void* mensagens, uint8_t quantidade);
+uint8_t FilaRecebeISR(fila_t* fila, void* mensagem);
+
+void MemoriaInicia(memoria_t* memoria, void* area, uint16_t tamanho, uint16_t numero);
+void* MemoriaAloca(memoria_t* memoria, tick_t timeout);
+void* MemoriaAlocaISR(memoria_t* memoria);
+void MemoriaLibera(memoria_t* memoria, void* bloco);
+void MemoriaLiberaISR(memoria_t* memoria, void* bloco);
+
+void ArenaInicia(arena_t* arena, void* area, uint16_t tamanho);
+void* ArenaAloca(arena_t* arena, uint16_t tamanho);
+
+uint8_t AnelInicia(anel_t* anel, uint8_t* area, uint16_t capacidade, uint16_t limiar);
+uint16_t AnelEscreve(anel_t* anel, const uint8_t* dados, uint16_t quantidade);
+uint16_t AnelLe(anel_t* anel, uint8_t* dados, uint16_t quantidade);
+uint16_t AnelAguarda(anel_t* anel, tick_t timeout);
+uint16_t AnelAguardaNivel(anel_t* anel, uint16_t nivel, tick_t timeout);
+uint16_t AnelEscreveAtomico(anel_t* anel, const uint8_t* dados, uint16_t quantidade);
+uint16_t AnelEscreveEspera(anel_t* anel, const uint8_t* dados, uint16_t quantidade, tick_t timeout);
+
+void InstantaneoInicia(instantaneo_t* inst, uint8_t* area, uint16_t tamanho);
+void InstantaneoPublica(instantaneo_t* inst, const void* dados);
+uint32_t InstantaneoLe(instantaneo_t* inst, void* destino);
+
+/* numero de bytes no anel. Exata para o consumidor; para o produtor, 
+   pode ser maior que a real se o consumidor estiver lendo */
+#define AnelQuantidade(anel)	((uint16_t)((anel)->escrita - (anel)->leitura))
+
+#if cfg_RASTRO > 0
+void RastroDescarrega(envia_rastro_t envia);
+#endif
+
+#if cfg_PERFIL > 0
+void PerfilAmostra(uint32_t pc);
+void PerfilDescarrega(envia_rastro_t envia);
+#endif
+
+#if cfg_GANCHOS_OCIOSA > 0
+uint8_t OciosaRegistraGancho(gancho_ociosa_t gancho);
+#endif
+
+#if cfg_FILA_TRABALHOS > 0
+void tarefa_trabalhos(void);
+uint8_t TrabalhoAgenda(funcao_trabalho_t funcao, void* arg);
+uint16_t TrabalhosPerdidos(void);
+#endif
+
+#if cfg_OBJETOS_ATIVOS > 0
+uint8_t ObjetoAtivoInicia(objeto_ativo_t* objeto, uint8_t grupo, uint8_t prioridade, despacho_objeto_t despacho, 
+						  evento_t* fila, uint8_t capacidade);
+uint8_t ObjetoAtivoEnvia(objeto_ativo_t* objeto, uint16_t sinal, void* dado);
+void ObjetosAtivosExecuta(uint8_t grupo);
+#endif
+
+#if cfg_TEMPORIZADORES
+void tarefa_temporizadores(void);
+void TemporizadorInicia(temporizador_t* temporizador, funcao_temporizador_t funcao, void* arg);
+void TemporizadorLiga(temporizador_t* temporizador, tick_t atraso, tick_t periodo);
+void TemporizadorDesliga(temporizador_t* temporizador);
+#endif
+
+#if cfg_REGISTRO_OBJETOS
+void ObjetoRegistra(registro_objeto_t* registro, uint8_t tipo, void* objeto, const char* nome);
+void ObjetoRetira(registro_objeto_t* registro);
+uint8_t ObjetosObtemEstado(estado_objeto_t* estados, uint8_t primeiro, uint8_t max_objetos);
+#endif
+
+/* passagem de ponteiros pela fila: transfere a posse de um bloco de memoria. 
+   Em FilaRecebePonteiro, ponteiro e o endereco da variavel que recebe o ponteiro */
+#define FilaEnviaPonteiro(fila, ponteiro)	do { void* p_ = (ponteiro); FilaEnvia((fila), &p_); } while(0)
+#define FilaRecebePonteiro(fila, ponteiro)	FilaRecebe((fila), (void*)(ponteiro))
+
+/* versao de FilaEnviaPonteiro para interrupcoes: retorna 0 se a fila estiver cheia. 
+   Com MemoriaAlocaISR, uma interrupcao passa um bloco a uma tarefa sem copiar 
+   os dados, e a tarefa o devolve com MemoriaLibera depois de usa-lo */
+static inline uint8_t FilaEnviaPonteiroISR(fila_t* fila, void* ponteiro)
+{
+	return FilaEnviaISR(fila, &ponteiro);
+}
+
+#if cfg_SERVICOS_EM_LINHA
+/* caminhos rapidos em linha (cfg_SERVICOS_EM_LINHA): sem mudar o estado de 
+   nenhuma tarefa, resolvem na propria regiao atomica; nos demais casos, a 
+   versao do nucleo confere tudo de novo, em outra regiao */
+static inline void TarefaEspera(tick_t qtas_marcas)
+{
+	if(qtas_marcas > 0)
+	{
+		TarefaEsperaLento(qtas_marcas);
+	}
+}
+
+/* com o contador maior que 0, so o decrementa */
+static inline void SemaforoAguarda(semaforo_t* sem)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	if(sem->contador > 0)
+	{
+		sem->contador--;
+		#if cfg_ESPERAS_SEMAFORO
+		sem->aguardas++;
+		#endif
+		REG_ATOMICA_FIM(estado);
+		return;
+	}
+	REG_ATOMICA_FIM(estado);
+	SemaforoAguardaLento(sem);
+}
+
+/* sem tarefa esperando (nem grupo associado), so incrementa o contador: 
+   nenhuma tarefa fica pronta, entao o escalonador nao e consultado */
+static inline void SemaforoLibera(semaforo_t* sem)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	#if cfg_GRUPOS_EVENTOS
+	if(sem->tarefaEsperando == 0 && sem->grupo == 0)
+	#else
+	if(sem->tarefaEsperando == 0)
+	#endif
+	{
+		sem->contador++;
+		#if cfg_REGISTRO_OBJETOS
+		if(sem->contador > sem->maximo)
+		{
+			sem->maximo = sem->contador;
+		}
+		#endif
+		REG_ATOMICA_FIM(estado);
+		return;
+	}
+	REG_ATOMICA_FIM(estado);
+	SemaforoLiberaLento(sem);
+}
+#endif
+#endif /* MULTITAREFAS_H_ */
\ No newline at end of file
@@ -0,0 +1,603 @@
+/*
+ * cpu_port.c
+ *
+ * Porta do sistema multitarefas para processadores ARM Cortex-M0/M0+ 
+ * com o compilador GCC (Atmel Studio, MPLAB X)
+ *
+ * Author: Carlos H. Barriquello
+ */ 
+
+#include <asf.h>
+#include "cpu-port.h"
+#include "rtos.h"
+
+#if defined(OTIMIZA_DESEMPENHO) && OTIMIZA_DESEMPENHO
+#pragma GCC optimize ("O2")
+#endif
+
+stackptr_t CriaContexto(tarefa_t endereco_tarefa, stackptr_t ptr_pilha)
+{
+	#define INITIAL_XPSR		0x01000000
+	
+	uint32_t reg_val;
+	*(--ptr_pilha) = INITIAL_XPSR;     /* xPSR */
+	*(--ptr_pilha) = (uint32_t)endereco_tarefa;  /* R15 */
+	*(--ptr_pilha) = 0x00;				   /* R14 */
+	
+	*(--ptr_pilha) = 0x12;			   /* R12 */
+	
+	for(reg_val = 3; reg_val > 0; reg_val--)
+	{
+		*(--ptr_pilha) = reg_val;  /* R3, R2, R1 */
+	}
+	
+	*(--ptr_pilha) = 0;		   /* R0 */
+	
+	for(reg_val = 7; reg_val >= 4; reg_val--)
+	{
+		*(--ptr_pilha) = reg_val;  /* R7, R6, R5, R4 */
+	}
+	
+	for(reg_val = 11; reg_val >= 8; reg_val--)
+	{
+		*(--ptr_pilha) = reg_val;  /* R11, R10, R9, R8 */
+	}
+	
+	return ptr_pilha;
+
+	
+}
+
+#ifdef MASCARA_NUCLEO
+#if cfg_OCIOSA_SEM_MARCAS
+#error "MASCARA_NUCLEO nao combina com cfg_OCIOSA_SEM_MARCAS: o WFI nao acorda com as linhas desabilitadas"
+#endif
+
+volatile uint8_t	regiao_nucleo = 0;
+volatile uint8_t	troca_pendente = 0;
+volatile uint8_t	marca_pendente = 0;
+uint32_t			linhas_nucleo;
+
+/* fim da regiao atomica mais externa: reabilita as linhas do nucleo que 
+   estavam habilitadas e pede o que ficou pendente dentro dela. A marca de 
+   tempo volta a ser pendente no SysTick, que a executa em seguida */
+NUCLEO_RAPIDO void FechaRegiaoNucleo(void)
+{
+	reg_atomica_t primask;
+	
+	__asm volatile(	"MRS	%0, PRIMASK	\n"
+					"CPSID	I			\n"
+					: "=r" (primask) : : "memory");
+	regiao_nucleo = 0;
+	*(NVIC_ISER) = linhas_nucleo;
+	if(troca_pendente)
+	{
+		troca_pendente = 0;
+		*(NVIC_INT_CTRL_B) = NVIC_PENDSVSET;
+	}
+	if(marca_pendente)
+	{
+		marca_pendente = 0;
+		*(NVIC_INT_CTRL_B) = NVIC_PENDSTSET;
+	}
+	__asm volatile(	"MSR	PRIMASK, %0	\n" : : "r" (primask) : "memory");
+}
+
+/* escalonador do PendSV_Handler dentro de uma regiao atomica do nucleo, 
+   sem desabilitar as interrupcoes de latencia zero */
+CHAMADA_POR_ASM NUCLEO_RAPIDO stackptr_t TrocaContextoMascarada(stackptr_t pilha)
+{
+	reg_atomica_t estado;
+	
+	REG_ATOMICA_INICIO(estado);
+	pilha = TrocaContextoDasTarefas(pilha);
+	REG_ATOMICA_FIM(estado);
+	return pilha;
+}
+
+/* marca de tempo que ja recarregou o SysTick mas ainda nao foi contada */
+#define MARCA_NAO_CONTADA()		((*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET) || marca_pendente)
+#else
+#define MARCA_NAO_CONTADA()		(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+#endif
+
+/* numero de contagens do SysTick em uma marca de tempo */
+static uint32_t contagens_por_marca;
+
+/* clock da CPU informado por MarcaTempoAlteraClock (0: cfg_CPU_CLOCK_HZ) */
+static uint32_t clock_cpu_hz = 0;
+
+/* marcas de tempo por segundo: cfg_MARCA_TEMPO_HZ ou a frequencia de 
+   MarcaTempoReprograma */
+static uint32_t frequencia_marca = cfg_MARCA_TEMPO_HZ;
+
+#if cfg_ESTATISTICAS
+/* ciclos e marcas de tempo na ultima troca de clock: as marcas seguintes 
+   sao contadas com as contagens do novo clock, sem mudar os ciclos ja 
+   contados com o anterior */
+static uint64_t ciclos_base = 0;
+static tick_t marcas_base = 0;
+#endif
+
+#if cfg_AJUSTE_MARCA
+/* ajuste fino (MarcaTempoAjusta): correcao de frequencia em 1/65536 de 
+   contagem por marca, com o resto fracionario acumulado entre as marcas, 
+   e correcao de fase pendente, em contagens */
+static int32_t ajuste_frequencia = 0;
+static int32_t resto_frequencia = 0;
+static int32_t ajuste_fase = 0;
+
+/* LOAD do periodo em curso e do seguinte: o valor escrito no LOAD so e 
+   usado na proxima recarga do SysTick */
+static uint32_t carga_atual;
+static uint32_t carga_proxima;
+#endif
+
+/* Codigo dependente de hardware usado para 
+ * configuracao da marca de tempo do sistema multitarefas */
+void ConfiguraMarcaTempo(void)
+{   
+	
+	    uint32_t cpu_clock_hz = clock_cpu_hz ? clock_cpu_hz : cfg_CPU_CLOCK_HZ;	/* definido no conf_rtos.h de cada placa */
+		uint32_t valor_comparador = cpu_clock_hz/frequencia_marca;
+		
+		contagens_por_marca = valor_comparador;
+		#if cfg_AJUSTE_MARCA
+		carga_atual = carga_proxima = valor_comparador - 1;
+		#endif
+		
+		*(NVIC_SYSTICK_CTRL) = 0;						// Desabilita SysTick Timer
+		*(NVIC_SYSTICK_LOAD) = valor_comparador - 1;	// Configura a contagem
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;  // Inicia
+}
+
+/* informa a nova frequencia da CPU, quando a placa troca o clock depois do 
+ * inicio. Se a marca de tempo ja foi configurada, reprograma o SysTick: a 
+ * marca atual recomeca com o novo periodo (atrasa no maximo uma marca). 
+ * Chamada com as interrupcoes desabilitadas ou antes de ConfiguraMarcaTempo */
+void MarcaTempoAlteraClock(uint32_t cpu_clock_hz)
+{
+	clock_cpu_hz = cpu_clock_hz;
+	if(*(NVIC_SYSTICK_CTRL) & NVIC_SYSTICK_ENABLE)
+	{
+		#if cfg_ESTATISTICAS
+		uint32_t decorrido;
+		
+		ciclos_base = TempoEmCiclos();
+		marcas_base = MarcaTempoInstante(&decorrido);
+		#endif
+		ConfiguraMarcaTempo();
+	}
+}
+
+#if cfg_MARCA_VARIAVEL
+/* menor numero de contagens do SysTick numa marca: abaixo disso o 
+   tratamento da marca toma a maior parte do tempo da CPU (~20 kHz a 48 MHz) */
+#define MARCA_MIN_CONTAGENS		2400u
+
+/* troca a frequencia da marca de tempo (MarcaTempoMudaFrequencia): o 
+ * SysTick e reprogramado como em MarcaTempoAlteraClock, com a marca atual 
+ * recomecando no novo periodo. Vale qualquer LOAD dos 24 bits do SysTick 
+ * (ex.: de ~2,9 Hz a 20 kHz com 48 MHz). Retorna 0, sem mudar nada, se a 
+ * marca nao cabe no SysTick. Chamada com as interrupcoes desabilitadas */
+uint8_t MarcaTempoReprograma(uint32_t marca_hz)
+{
+	uint32_t cpu_clock_hz = clock_cpu_hz ? clock_cpu_hz : cfg_CPU_CLOCK_HZ;
+	uint32_t contagens;
+	
+	if(marca_hz == 0)
+	{
+		return 0;
+	}
+	contagens = cpu_clock_hz / marca_hz;
+	if(contagens < MARCA_MIN_CONTAGENS || contagens - 1 > NVIC_SYSTICK_MAX_LOAD)
+	{
+		return 0;
+	}
+	frequencia_marca = marca_hz;
+	MarcaTempoAlteraClock(cpu_clock_hz);
+	return 1;
+}
+#endif
+
+#if cfg_AJUSTE_MARCA
+/* contagens do SysTick em uma marca de tempo sem ajuste */
+uint32_t MarcaTempoContagens(void)
+{
+	return contagens_por_marca;
+}
+
+/* corrige a duracao das marcas de tempo: frequencia, em 1/65536 de 
+ * contagem, e somada a todas as marcas seguintes (positiva atrasa o 
+ * relogio), e fase, em contagens, uma unica vez, a proxima marca que 
+ * comecar (positiva atrasa o relogio, negativa o adianta). A fase fica 
+ * entre -1/2 e +1/2 marca. A correcao vale a partir da segunda marca 
+ * seguinte, porque o LOAD so e lido na recarga */
+void MarcaTempoAjusta(int32_t frequencia, int32_t fase)
+{
+	reg_atomica_t estado;
+	int32_t limite = (int32_t)(contagens_por_marca / 2);
+	
+	REG_ATOMICA_INICIO(estado);
+	ajuste_frequencia = frequencia;
+	fase += ajuste_fase;					/* soma a fase ainda nao aplicada */
+	if(fase > limite)
+	{
+		fase = limite;
+	}else if(fase < -limite)
+	{
+		fase = -limite;
+	}
+	ajuste_fase = fase;
+	REG_ATOMICA_FIM(estado);
+}
+
+/* programa o LOAD do proximo periodo com o ajuste. Chamada pelo 
+   SysTick_Handler, logo depois da recarga */
+static NUCLEO_RAPIDO void AjustaProximaMarca(void)
+{
+	int32_t ajuste;
+	
+	carga_atual = carga_proxima;
+	resto_frequencia += ajuste_frequencia;
+	ajuste = resto_frequencia >> 16;			/* deslocamento aritmetico no gcc */
+	resto_frequencia -= ajuste * 65536;
+	ajuste += ajuste_fase;
+	ajuste_fase = 0;
+	
+	carga_proxima = (uint32_t)((int32_t)contagens_por_marca - 1 + ajuste);
+	*(NVIC_SYSTICK_LOAD) = carga_proxima;
+}
+#define CARGA_ATUAL				carga_atual
+#define CARGA_PROXIMA			carga_proxima
+#else
+#define CARGA_ATUAL				(contagens_por_marca - 1)
+#define CARGA_PROXIMA			(contagens_por_marca - 1)
+#endif
+
+/* instante atual: retorna as marcas de tempo ja contadas e as contagens do 
+ * SysTick decorridas na marca atual, de 0 a contagens_por_marca - 1 (numa 
+ * marca alongada pelo ajuste fino, as contagens param no maximo, para o 
+ * instante nunca voltar). Chamada com as interrupcoes desabilitadas */
+tick_t MarcaTempoInstante(uint32_t *contagens)
+{
+	tick_t marcas = ObtemMarcasDeTempo();
+	uint32_t valor = *(NVIC_SYSTICK_VAL);
+	uint32_t carga = CARGA_ATUAL;
+	
+	if(MARCA_NAO_CONTADA())
+	{
+		/* o SysTick recarregou, mas a marca ainda nao foi contada */
+		marcas++;
+		valor = *(NVIC_SYSTICK_VAL);
+		carga = CARGA_PROXIMA;
+	}
+	
+	valor = (valor <= carga) ? carga - valor : 0;
+	*contagens = (valor < contagens_por_marca) ? valor : contagens_por_marca - 1;
+	return marcas;
+}
+
+#if cfg_ESTATISTICAS
+/* Codigo dependente de hardware usado pelas estatisticas de execucao: 
+ * retorna o tempo do sistema em ciclos de clock, isto e, as marcas de tempo 
+ * ja contadas mais os ciclos decorridos na marca atual, lidos do SysTick 
+ * (o Cortex-M0+ nao possui o contador DWT_CYCCNT). Depois de uma troca de 
+ * clock, os ciclos seguintes sao os do novo clock. Chamada com as 
+ * interrupcoes desabilitadas */
+uint64_t TempoEmCiclos(void)
+{
+	uint32_t decorrido;
+	tick_t marcas = MarcaTempoInstante(&decorrido);
+	
+	return ciclos_base + ((uint64_t)(tick_t)(marcas - marcas_base) * contagens_por_marca) + decorrido;
+}
+#endif
+
+#if cfg_SONO_LONGO_MARCAS > 0
+/* sono longo (cfg_SONO_LONGO): o SysTick fica parado e o tempo dormido vem
+ * do gancho, que mede com a sua propria base de tempo. As marcas completas
+ * sao compensadas de uma vez, inclusive a ultima, e o SysTick recomeca com o
+ * restante da marca atual, entao a fase das marcas se mantem. Retorna 0 se o
+ * gancho recusou o sono, com o SysTick de volta como estava */
+static uint8_t DormeLongo(tick_t qtas_marcas)
+{
+	uint64_t contagens_por_s = (uint64_t)contagens_por_marca * frequencia_marca;
+	uint64_t restante, total;
+	uint32_t decorrido, dormido_us;
+
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		/* marca pendente: nao dorme, como em DormeSemMarcas */
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+		return 1;
+	}
+	decorrido = CARGA_ATUAL - *(NVIC_SYSTICK_VAL);
+
+	restante = ((uint64_t)qtas_marcas * contagens_por_marca - decorrido) * 1000000u / contagens_por_s;
+	if(restante > 0xFFFFFFFFu)
+	{
+		restante = 0xFFFFFFFFu;
+	}
+
+	cfg_ANTES_DE_DORMIR(qtas_marcas);
+	dormido_us = cfg_SONO_LONGO((uint32_t)restante);
+	cfg_APOS_DORMIR();
+
+	if(dormido_us == 0)
+	{
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+		return 0;
+	}
+
+	/* contagens do SysTick desde o inicio da marca atual */
+	total = decorrido + ((uint64_t)dormido_us * contagens_por_s) / 1000000u;
+
+	*(NVIC_SYSTICK_LOAD) = (contagens_por_marca - 1) - (uint32_t)(total % contagens_por_marca);
+	*(NVIC_SYSTICK_VAL) = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+	*(NVIC_SYSTICK_LOAD) = contagens_por_marca - 1;
+
+	CompensaMarcasDeTempo((tick_t)(total / contagens_por_marca));
+	return 1;
+}
+#endif
+
+/* Codigo dependente de hardware usado pelo modo ocioso sem marcas de tempo: 
+ * reprograma o SysTick para interromper somente apos qtas_marcas, dorme (WFI) 
+ * e, ao acordar, corrige o tempo do sistema. Chamada com as interrupcoes 
+ * desabilitadas; a ultima marca e contada pelo proprio SysTick_Handler */
+void DormeSemMarcas(tick_t qtas_marcas)
+{
+	uint32_t marcas_max = NVIC_SYSTICK_MAX_LOAD / contagens_por_marca;
+	uint32_t recarga, decorrido;
+	tick_t marcas_completas;
+	
+	#if cfg_SONO_LONGO_MARCAS > 0
+	if(qtas_marcas >= cfg_SONO_LONGO_MARCAS && DormeLongo(qtas_marcas))
+	{
+		return;
+	}
+	#endif
+	
+	if(qtas_marcas > marcas_max)
+	{
+		qtas_marcas = (tick_t)marcas_max;
+	}
+	
+	/* para o SysTick e calcula a contagem ate o instante de despertar */
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	recarga = *(NVIC_SYSTICK_VAL) + (contagens_por_marca * (qtas_marcas - 1));
+	
+	/* uma marca de tempo ficou pendente enquanto o SysTick era parado: nao dorme */
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+		return;
+	}
+	
+	*(NVIC_SYSTICK_LOAD) = recarga;
+	*(NVIC_SYSTICK_VAL) = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+	
+	cfg_ANTES_DE_DORMIR(qtas_marcas);
+	DORME_ATE_INTERRUPCAO();
+	
+	/* acordou: para o SysTick para medir quanto tempo passou */
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	cfg_APOS_DORMIR();
+	
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		/* dormiu o tempo todo: o SysTick_Handler pendente conta a ultima marca 
+		 * e a proxima marca acontece apos o restante do periodo atual */
+		marcas_completas = qtas_marcas - 1;
+		decorrido = recarga - *(NVIC_SYSTICK_VAL);
+		*(NVIC_SYSTICK_LOAD) = (contagens_por_marca - 1) - (decorrido % contagens_por_marca);
+	}else
+	{
+		/* acordou antes por outra interrupcao: conta somente as marcas completas */
+		decorrido = recarga - *(NVIC_SYSTICK_VAL);
+		marcas_completas = (tick_t)(decorrido / contagens_por_marca);
+		*(NVIC_SYSTICK_LOAD) = ((marcas_completas + 1) * contagens_por_marca) - decorrido;
+	}
+	
+	/* reinicia o SysTick com o restante da marca atual e volta ao periodo normal */
+	*(NVIC_SYSTICK_VAL) = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+	*(NVIC_SYSTICK_LOAD) = contagens_por_marca - 1;
+	
+	CompensaMarcasDeTempo(marcas_completas);
+}
+
+/* rotinas de interrupcao necessarias */
+__attribute__ ((naked)) void SVC_Handler(void)
+{
+	PINO_RASTRO_ENTRA(cfg_PINO_RASTRO_SVC);	/* so constantes: sem registradores alem de R0-R3 */
+	/* Make PendSV and SysTick the lowest priority interrupts. */
+	*(NVIC_SYSPRI3) |= NVIC_PENDSV_PRI;
+	*(NVIC_SYSPRI3) |= NVIC_SYSTICK_PRI;
+	PINO_RASTRO_SAI(cfg_PINO_RASTRO_SVC);
+	RESTAURA_SP(ponteiro_de_pilha);
+	RESTAURA_CONTEXTO();
+	RESTAURA_ISR();
+}
+
+/* troca de contexto: o stack pointer passa em R0 do salvamento para o 
+   escalonador e deste para a restauracao, sem variaveis intermediarias. 
+   A flag do PendSV e limpa pelo proprio hardware na entrada da excecao */
+NUCLEO_RAPIDO __attribute__ ((naked)) void PendSV_Handler(void)
+{
+	
+	PINO_RASTRO_ENTRA(cfg_PINO_RASTRO_PENDSV);	/* desligado por TrocaContextoDasTarefas */
+	SALVA_ISR();
+	SALVA_CONTEXTO();			/* R0 = pilha da tarefa atual */
+	
+	ESCOLHE_PROXIMA_TAREFA();	/* R0 = pilha da proxima tarefa */
+	
+	RESTAURA_CONTEXTO();
+	
+}
+
+#if cfg_CEDE_DIRETO
+/* TarefaCede sem o PendSV (cfg_CEDE_DIRETO), no modo thread (SP = PSP) e 
+   com as interrupcoes desabilitadas. Monta na pilha o mesmo contexto do 
+   PendSV, com o retorno da chamada no lugar do PC, entao a tarefa tambem 
+   pode ser retomada pelo PendSV. R0-R3, R12 e LR nao precisam ser guardados 
+   numa chamada de funcao e ficam com lixo. A proxima tarefa, que tambem 
+   cedeu, e retomada com R4-R11 e o desvio para o seu PC, sem retorno de 
+   excecao; as interrupcoes sao reabilitadas pelo REG_ATOMICA_FIM dela */
+NUCLEO_RAPIDO __attribute__ ((naked)) void TarefaCedeDireto(void)
+{
+	__asm volatile(
+		".syntax unified				\n"	/* MOVS etc.; o compilador restaura a sua sintaxe depois */
+		"SUB     SP, SP, #0x20			\n"	/* R0-R3, R12, LR, PC, xPSR */
+		"MOV     R0, LR					\n"
+		"MOVS    R1, #1					\n"
+		"BICS    R0, R1					\n"	/* PC do quadro sem o bit Thumb */
+		"STR     R0, [SP, #0x18]		\n"
+		"LSLS    R1, R1, #24			\n"	/* xPSR = 0x01000000 (Thumb) */
+		"STR     R1, [SP, #0x1C]		\n"
+		"PUSH    {R4-R7}				\n"
+		"MOV     R4, R8					\n"
+		"MOV     R5, R9					\n"
+		"MOV     R6, R10				\n"
+		"MOV     R7, R11				\n"
+		"PUSH    {R4-R7}				\n"
+		"MOV     R0, SP					\n"	/* R0 = pilha da tarefa que cede */
+		"BL      TrocaContextoCedida	\n"	/* R0 = pilha da proxima tarefa */
+		"MOV     SP, R0					\n"
+		"POP     {R4-R7}				\n"
+		"MOV     R8, R4					\n"
+		"MOV     R9, R5					\n"
+		"MOV     R10, R6				\n"
+		"MOV     R11, R7				\n"
+		"POP     {R4-R7}				\n"
+		"LDR     R0, [SP, #0x18]		\n"
+		"ADD     SP, SP, #0x20			\n"
+		"MOVS    R1, #1					\n"
+		"ORRS    R0, R1					\n"
+		"BX      R0						\n"
+	);
+}
+#endif
+
+/* Codigo dependente de hardware usado para 
+   realizar a marca de tempo do sistema multitarefas - interrupcao */
+NUCLEO_RAPIDO void SysTick_Handler(void)
+{	
+	 reg_atomica_t estado;
+	 
+	 #ifdef MASCARA_NUCLEO
+	 if(regiao_nucleo)
+	 {
+		 marca_pendente = 1;		/* interrompeu uma regiao atomica: executada no fim dela */
+		 return;
+	 }
+	 #endif
+	 PINO_RASTRO_ENTRA(cfg_PINO_RASTRO_MARCA);
+	 REG_ATOMICA_INICIO(estado);		/* outras interrupcoes podem usar servicos do sistema */
+	 #if cfg_PERFIL > 0
+	 PerfilAmostra(PERFIL_PC_INTERROMPIDO());
+	 #endif
+	 #if cfg_AJUSTE_MARCA
+	 AjustaProximaMarca();
+	 #endif
+	 ExecutaMarcaDeTempo();    
+	 REG_ATOMICA_FIM(estado);		/* com cfg_PREEMPTIVO, a troca de contexto ja foi solicitada */
+	 PINO_RASTRO_SAI(cfg_PINO_RASTRO_MARCA);
+}
+
+#if cfg_FALHA_GRAVE
+RETIDA falha_grave_t falha_grave;
+
+/* pilha da captura: a da falha pode ter estourado ou estar corrompida */
+#define TAM_PILHA_FALHA		32
+#define TEXTO_ASM_(x)		#x
+#define TEXTO_ASM(x)		TEXTO_ASM_(x)
+CHAMADA_POR_ASM uint32_t pilha_falha[TAM_PILHA_FALHA];
+
+/* chamada pelo HardFault_Handler ja na pilha_falha, com o quadro empilhado 
+   na falha (na PSP ou na MSP, conforme o EXC_RETURN) e a MSP de entrada. 
+   So copia e reinicia: algumas centenas de ciclos ate o reset */
+CHAMADA_POR_ASM __attribute__ ((noreturn, used)) void FalhaGraveCaptura(const uint32_t *quadro, uint32_t retorno, uint32_t msp)
+{
+	uint32_t psp;
+	uint8_t i;
+	
+	__asm volatile("MRS %0, PSP" : "=r"(psp));
+	
+	/* um quadro fora da RAM (pilha estourada) geraria outra falha na 
+	   leitura, e a cpu travaria sem reset */
+	falha_grave.quadro_valido = ((uint32_t)quadro >= HMCRAMC0_ADDR && 
+								 (uint32_t)quadro <= HMCRAMC0_ADDR + HMCRAMC0_SIZE - sizeof(falha_grave.quadro));
+	for(i = 0; i < 8; i++)
+	{
+		falha_grave.quadro[i] = falha_grave.quadro_valido ? quadro[i] : 0;
+	}
+	falha_grave.retorno = retorno;
+	falha_grave.msp = msp;
+	falha_grave.psp = psp;
+	falha_grave.marca_tempo = ObtemMarcasDeTempo();
+	falha_grave.tarefa = tarefa_atual;
+	
+	#if cfg_RASTRO > 0
+	{
+		uint16_t total = rastro_total;
+		uint16_t n = (total < cfg_FALHA_GRAVE_RASTRO) ? total : cfg_FALHA_GRAVE_RASTRO;
+		
+		if(n > cfg_RASTRO)
+		{
+			n = cfg_RASTRO;
+		}
+		falha_grave.rastro_total = total;
+		for(i = 0; i < cfg_FALHA_GRAVE_RASTRO; i++)
+		{
+			falha_grave.rastro[i] = (i < n) ? rastro_nucleo[(uint16_t)(total - n + i) & (cfg_RASTRO - 1)] 
+											: (registro_rastro_t){0, 0, 0, 0};
+		}
+	}
+	#else
+	falha_grave.rastro_total = 0;
+	#endif
+	
+	falha_grave.assinatura = FALHA_GRAVE_NOVA;
+	__DSB();
+	NVIC_SystemReset();
+}
+
+/* escolhe o quadro da falha pelo bit 2 do EXC_RETURN (1: PSP, falha numa 
+   tarefa; 0: MSP, falha numa interrupcao ou antes do nucleo) e troca para 
+   a pilha_falha antes de qualquer acesso em C */
+__attribute__ ((naked)) void HardFault_Handler(void)
+{
+	__asm volatile(
+		".syntax unified				\n"
+		"MOV     R1, LR					\n"	/* R1 = EXC_RETURN */
+		"MRS     R2, MSP				\n"	/* R2 = MSP de entrada */
+		"MOV     R0, R2					\n"
+		"MOVS    R3, #4					\n"
+		"TST     R1, R3					\n"
+		"BEQ     1f						\n"
+		"MRS     R0, PSP				\n"	/* R0 = quadro da falha */
+		"1:								\n"
+		"LDR     R3, =pilha_falha + 4 * " TEXTO_ASM(TAM_PILHA_FALHA) "\n"	/* fim da pilha_falha */
+		"MOV     SP, R3					\n"
+		"BL      FalhaGraveCaptura		\n"
+	);
+}
+#else
+void HardFault_Handler(void)
+{
+	
+	while(1)
+	{
+		
+		
+	}
+}
+#endif
+
+
+
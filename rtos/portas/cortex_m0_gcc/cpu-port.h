@@ -0,0 +1,351 @@
+/*
+ * cpu_port.h
+ *
+ *  Author: Carlos H. Barriquello
+ */ 
+
+
+#ifndef CPU_PORT_H_
+#define CPU_PORT_H_
+
+#include "stdint.h"
+
+/* configurar conforme processador*/
+/* Ex. processador ARM 16 registradores de 4 bytes cada */
+#define TAM_MINIMO_PILHA  (16)
+
+/* tipo do ponteiro de pilha */
+typedef uint32_t* stackptr_t;
+
+
+/* registradores da cpu ARM Cortex-M*/
+#define NVIC_INT_CTRL_B         ( ( volatile unsigned long *) 0xe000ed04 )
+#define NVIC_SYSPRI3			( ( volatile unsigned long *) 0xe000ed20 )
+#define NVIC_SYSTICK_CTRL       ( ( volatile unsigned long *) 0xe000e010 )
+#define NVIC_SYSTICK_LOAD       ( ( volatile unsigned long *) 0xe000e014 )
+#define NVIC_SYSTICK_VAL        ( ( volatile unsigned long *) 0xe000e018 )
+#define NVIC_ISER				( ( volatile unsigned long *) 0xe000e100 )
+#define NVIC_ICER				( ( volatile unsigned long *) 0xe000e180 )
+
+#define NVIC_PENDSVSET      			0x10000000         			// Dispara excecao PendSV
+#define NVIC_PENDSVCLR      			0x08000000         			// Limpa a flag PendSV
+#define NVIC_PENDSTSET      			0x04000000         			// Excecao SysTick pendente
+#define NVIC_SYSTICK_MAX_LOAD   		0x00FFFFFF         			// Contador de 24 bits
+#define NVIC_SYSTICK_CLK        		0x00000004
+#define NVIC_SYSTICK_INT        		0x00000002
+#define NVIC_SYSTICK_ENABLE     		0x00000001
+#define PRIO_BITS       		        4        					// 15 niveis de prioridade
+#define LOWEST_INTERRUPT_PRIORITY		0xF
+#define KERNEL_INTERRUPT_PRIORITY 		(LOWEST_INTERRUPT_PRIORITY << (8 - PRIO_BITS) )
+#define NVIC_PENDSV_PRI					( ( ( unsigned long ) KERNEL_INTERRUPT_PRIORITY ) << 16 )
+#define NVIC_SYSTICK_PRI				( ( ( unsigned long ) KERNEL_INTERRUPT_PRIORITY ) << 24 )
+
+
+/* troca da frequencia da CPU depois do inicio (ver cpu-port.c) */
+void MarcaTempoAlteraClock(uint32_t cpu_clock_hz);
+
+/* macros dependentes de hardware, instrucoes em assembly */
+
+/* regioes atomicas aninhaveis: REG_ATOMICA_INICIO guarda o estado das 
+   interrupcoes (PRIMASK) na variavel estado, do tipo reg_atomica_t, e as 
+   desabilita. REG_ATOMICA_FIM restaura o estado guardado, entao so habilita 
+   as interrupcoes se elas estavam habilitadas no inicio da regiao. Assim os 
+   servicos do sistema podem ser chamados dentro da regiao atomica de um 
+   driver ou de uma interrupcao sem habilitar as interrupcoes antes da hora */
+typedef uint32_t reg_atomica_t;
+
+/* interrupcoes de latencia zero (MASCARA_NUCLEO): sem BASEPRI no Cortex-M0+, 
+   as regioes atomicas do nucleo podem desabilitar so as linhas do NVIC das 
+   interrupcoes que usam o sistema, cujos bits ficam em MASCARA_NUCLEO (ex.: 
+   -DMASCARA_NUCLEO=((1UL << SERCOM3_IRQn) | (1UL << DMAC_IRQn))), em vez de 
+   todas as interrupcoes. As demais linhas (ex.: a falha do PWM do motor) 
+   nunca esperam uma regiao atomica, so as poucas instrucoes com PRIMASK ao 
+   abrir e fechar a regiao e as operacoes de atomico.h, que usam a regiao 
+   curta (REG_ATOMICA_CURTA_INICIO/FIM, abaixo). 
+   O SysTick e o PendSV nao sao linhas do NVIC: a marca de tempo que chega 
+   dentro de uma regiao so anota que esta pendente, e a troca de contexto 
+   solicitada dentro dela so e pedida ao PendSV no fim. As rotinas fora de 
+   MASCARA_NUCLEO nao podem chamar nenhum servico do sistema nem usar 
+   REG_ATOMICA_INICIO/FIM: falam com as tarefas por variaveis e atomico.h, 
+   ou pendendo uma interrupcao de MASCARA_NUCLEO (NVIC->ISPR) que sinaliza 
+   a tarefa. Toda rotina que divide dados com uma regiao atomica de um 
+   driver deve estar em MASCARA_NUCLEO. Nao combina com cfg_CEDE_DIRETO nem 
+   com cfg_OCIOSA_SEM_MARCAS (o WFI nao acorda com as linhas desabilitadas) */
+#ifdef MASCARA_NUCLEO
+extern volatile uint8_t	regiao_nucleo;		/* 1 dentro de uma regiao atomica */
+extern volatile uint8_t	troca_pendente;		/* troca de contexto pedida dentro dela */
+extern volatile uint8_t	marca_pendente;		/* marca de tempo chegou dentro dela */
+extern uint32_t			linhas_nucleo;		/* linhas de MASCARA_NUCLEO habilitadas antes dela */
+void FechaRegiaoNucleo(void);
+
+/* estado = 1 se ja estava dentro de uma regiao: so a mais externa mexe no NVIC */
+static inline reg_atomica_t SalvaEDesabilitaInterrupcoes(void)
+{
+	uint32_t primask;
+	reg_atomica_t estado;
+	
+	__asm volatile(	"MRS	%0, PRIMASK	\n"
+					"CPSID	I			\n"
+					: "=r" (primask) : : "memory");
+	estado = regiao_nucleo;
+	if(!estado)
+	{
+		linhas_nucleo = *(NVIC_ISER) & (MASCARA_NUCLEO);
+		*(NVIC_ICER) = (MASCARA_NUCLEO);
+		__asm volatile(	"DSB	\n"
+						"ISB	\n" : : : "memory");
+		regiao_nucleo = 1;
+	}
+	__asm volatile(	"MSR	PRIMASK, %0	\n" : : "r" (primask) : "memory");
+	return estado;
+}
+
+static inline void RestauraInterrupcoes(reg_atomica_t estado)
+{
+	if(!estado)
+	{
+		FechaRegiaoNucleo();
+	}
+}
+#else
+static inline reg_atomica_t SalvaEDesabilitaInterrupcoes(void)
+{
+	reg_atomica_t estado;
+	__asm volatile(	"MRS	%0, PRIMASK	\n"
+					"CPSID	I			\n"
+					: "=r" (estado) : : "memory");
+	return estado;
+}
+
+static inline void RestauraInterrupcoes(reg_atomica_t estado)
+{
+	__asm volatile(	"MSR	PRIMASK, %0	\n" : : "r" (estado) : "memory");
+}
+#endif
+
+#define REG_ATOMICA_INICIO(estado)	  (estado) = SalvaEDesabilitaInterrupcoes()
+#define REG_ATOMICA_FIM(estado)		  RestauraInterrupcoes(estado)
+
+/* regiao atomica curta, para a leitura, a operacao e a escrita de atomico.h: 
+   sempre com PRIMASK, entao com MASCARA_NUCLEO tambem exclui as rotinas de 
+   latencia zero, que podem usar atomico.h. Nao chama servicos do sistema */
+#ifdef MASCARA_NUCLEO
+static inline reg_atomica_t SalvaEDesabilitaTodas(void)
+{
+	reg_atomica_t estado;
+	__asm volatile(	"MRS	%0, PRIMASK	\n"
+					"CPSID	I			\n"
+					: "=r" (estado) : : "memory");
+	return estado;
+}
+
+static inline void RestauraTodas(reg_atomica_t estado)
+{
+	__asm volatile(	"MSR	PRIMASK, %0	\n" : : "r" (estado) : "memory");
+}
+
+#define REG_ATOMICA_CURTA_INICIO(estado)	(estado) = SalvaEDesabilitaTodas()
+#define REG_ATOMICA_CURTA_FIM(estado)		RestauraTodas(estado)
+#else
+#define REG_ATOMICA_CURTA_INICIO(estado)	REG_ATOMICA_INICIO(estado)
+#define REG_ATOMICA_CURTA_FIM(estado)		REG_ATOMICA_FIM(estado)
+#endif
+
+/* solicita a troca de contexto (PendSV). Ela acontece assim que as interrupcoes 
+   forem habilitadas, ao fim da regiao atomica ou da interrupcao que a solicitou */
+#ifdef MASCARA_NUCLEO
+#define TROCA_CONTEXTO()		do { if(regiao_nucleo) { troca_pendente = 1; }		\
+									 else { *(NVIC_INT_CTRL_B) = NVIC_PENDSVSET; } } while(0)
+#else
+#define TROCA_CONTEXTO()		*(NVIC_INT_CTRL_B) = NVIC_PENDSVSET
+#endif
+#define TrocaContexto()		    TROCA_CONTEXTO()
+#define Clear_PendSV(void)		*(NVIC_INT_CTRL_B) = NVIC_PENDSVCLR
+
+/* TarefaCede no modo thread, sem a excecao PendSV (cfg_CEDE_DIRETO, ver 
+   TarefaCedeDireto em cpu-port.c). So fora de interrupcoes (IPSR = 0) e 
+   com as interrupcoes habilitadas antes da regiao atomica de TarefaCede, 
+   quando o PendSV aconteceria logo no fim dela */
+#ifndef MASCARA_NUCLEO
+void TarefaCedeDireto(void);
+#define CEDE_DIRETO()				TarefaCedeDireto()
+#define PODE_CEDER_DIRETO(estado)	((estado) == 0 && LeIpsr() == 0)
+#endif
+
+static inline uint32_t LeIpsr(void)
+{
+	uint32_t ipsr;
+	__asm volatile("MRS %0, IPSR" : "=r"(ipsr));
+	return ipsr;
+}
+
+/* busca do bit mais significativo do mapa de prontas usada pelo escalonador.
+ * O Cortex-M0+ nao possui a instrucao CLZ, entao o nucleo usa sua versao em C.
+ * Em processadores com CLZ (Cortex-M3/M4/M7) pode-se definir:
+ * #define MAIOR_BIT_ATIVO(mapa)	(31 - __CLZ(mapa))
+ */
+
+/* contador de ciclos para medicoes de desempenho. O Cortex-M0+ nao possui 
+ * o contador DWT_CYCCNT, entao usa-se o valor atual do SysTick, que conta 
+ * para baixo a cada ciclo de clock e recarrega a cada marca de tempo */
+#define LE_CONTADOR_CICLOS()		(*(NVIC_SYSTICK_VAL))
+
+/* ciclos desde a ultima marca de tempo, para o rastro do nucleo (cfg_RASTRO). 
+   Cabe em 16 bits enquanto a marca de tempo tiver ate 65535 ciclos */
+#define RASTRO_SUBMARCA()			((uint16_t)(*(NVIC_SYSTICK_LOAD) - *(NVIC_SYSTICK_VAL)))
+
+/* perfil estatistico (cfg_PERFIL): PC da tarefa interrompida pela marca 
+   de tempo, lido do quadro de excecao na pilha da tarefa (PSP). O SysTick 
+   tem a menor prioridade, entao so interrompe o modo thread; o EXC_RETURN 
+   (LR na entrada da rotina) diz se era a pilha de uma tarefa ou a pilha 
+   principal, antes de IniciaMultitarefas (amostra 0). So na rotina da 
+   interrupcao, que passa o LR de entrada em retorno_excecao */
+#define PERFIL_NA_PORTA				1
+#define PERFIL_PC_INTERROMPIDO()	PcInterrompido((uint32_t)__builtin_return_address(0))
+
+static inline uint32_t PcInterrompido(uint32_t retorno_excecao)
+{
+	uint32_t *quadro;
+	
+	if((retorno_excecao & 0x4) == 0)
+	{
+		return 0;
+	}
+	__asm volatile("MRS %0, PSP" : "=r"(quadro));
+	return quadro[6];		/* R0-R3, R12, LR, PC, xPSR */
+}
+
+/* pinos de rastro (cfg_PINOS_RASTRO): escritas de um ciclo nos registradores 
+   DIRSET/OUTCLR/OUTSET do grupo de pinos pelo IOBUS do SAM D/R, sem 
+   ler-modificar-escrever. A mascara tem os bits dos pinos do grupo 
+   PINOS_RASTRO_IOBUS (padrao: grupo A, PA00 a PA31) */
+#ifndef PINOS_RASTRO_IOBUS
+#define PINOS_RASTRO_IOBUS			0x60000000UL
+#endif
+#define PINOS_RASTRO_SAIDA(mascara)		(*(volatile uint32_t *)(PINOS_RASTRO_IOBUS + 0x08) = (uint32_t)(mascara))
+#define PINOS_RASTRO_DESLIGA(mascara)	(*(volatile uint32_t *)(PINOS_RASTRO_IOBUS + 0x14) = (uint32_t)(mascara))
+#define PINOS_RASTRO_LIGA(mascara)		(*(volatile uint32_t *)(PINOS_RASTRO_IOBUS + 0x18) = (uint32_t)(mascara))
+
+/* barreira de memoria: os acessos anteriores terminam antes dos seguintes, 
+   tambem para o compilador. Usada nas estruturas sem regiao atomica (anel_t) */
+#define BARREIRA_MEMORIA()			__asm volatile("DMB" ::: "memory")
+
+/* variavel global sem inicializacao na partida: fica na secao .noinit do 
+   script do ligador, que o Reset_Handler nao zera. Para areas grandes que 
+   a aplicacao inicializa (pilhas das tarefas, buffers de DMA). 
+   Ex.: NAO_INICIALIZADA uint32_t pilha[TAM_PILHA]; */
+#define NAO_INICIALIZADA			__attribute__((section(".noinit")))
+
+/* pilha principal (MSP) da secao .stack do script do ligador: o fundo
+   (_sstack) e o ponto em uso. Na partida, e depois nas interrupcoes, ela
+   cresce a partir de _estack; o fundo so e alcancado no pior caso que o
+   ligador reserva (STACK_SIZE). Usadas por cfg_OCIOSA_PILHA_PRINCIPAL */
+extern uint32_t _sstack[];
+#define PILHA_PRINCIPAL_FUNDO()		((stackptr_t)_sstack)
+#define PILHA_PRINCIPAL_ATUAL()		LeMsp()
+
+static inline stackptr_t LeMsp(void)
+{
+	stackptr_t msp;
+	__asm volatile("MRS %0, MSP" : "=r"(msp));
+	return msp;
+}
+
+/* variavel mantida entre resets sem falta de energia (watchdog, 
+   NVIC_SystemReset, pino de reset): fica na secao .retida, antes de .data 
+   e .bss, entao nao muda de endereco quando elas crescem. 
+   Nao e zerada nem inicializada; quem valida o conteudo e a aplicacao 
+   (ex.: RetidaInicia, que zera a secao na partida fria). 
+   Ex.: RETIDA registro_rastro_t rastro[N]; */
+#define RETIDA						__attribute__((section(".retida")))
+
+/* captura de falha grave (cfg_FALHA_GRAVE) no HardFault_Handler desta 
+   porta, com pilha propria e reset por NVIC_SystemReset */
+#define FALHA_GRAVE_NA_PORTA		1
+
+/* frequencia da marca de tempo variavel (cfg_MARCA_VARIAVEL): 
+   MarcaTempoReprograma troca o LOAD do SysTick */
+#define MARCA_VARIAVEL_NA_PORTA		1
+
+/* funcao executada da RAM: fica na secao .ramfunc, que o Reset_Handler 
+   copia da flash junto com .data (cfg_NUCLEO_NA_RAM). As chamadas entre a 
+   flash e a RAM passam por veneers gerados pelo ligador */
+#define FUNCAO_NA_RAM				__attribute__((section(".ramfunc"), noinline))
+
+/* simbolo usado so por nome no assembly da porta (ex.: BL do PendSV): com 
+   -flto, o compilador nao ve essa referencia e poderia descartar ou 
+   renomear o simbolo */
+#define CHAMADA_POR_ASM				__attribute__((used, externally_visible))
+
+/* instrucoes para dormir ate a proxima interrupcao */
+#define DORME_ATE_INTERRUPCAO()		__asm volatile(	"DSB	\n"		\
+													"WFI	\n"		\
+													"ISB	\n"		\
+											)
+
+#define GERA_INTERRUPCAO_SW()      __asm(  /* Call SVC to start the first task. */		\
+										"cpsie i				\n"					\
+										"svc 0					\n"					\
+									);												\
+
+
+/* carrega em R0 o stack pointer guardado na variavel SP (inicio do sistema) */
+#define RESTAURA_SP(SP)		__asm(	"LDR	 R1, =" #SP "	    \n"		\
+									"LDR     R0, [R1]		\n"		\
+							);
+
+/* chama o escalonador com as interrupcoes desabilitadas, recebendo e 
+   retornando o stack pointer em R0: stackptr_t TrocaContextoDasTarefas(stackptr_t). 
+   Com MASCARA_NUCLEO, dentro de uma regiao atomica, sem CPSID */
+#ifdef MASCARA_NUCLEO
+#define ESCOLHE_PROXIMA_TAREFA()	__asm volatile(								\
+										"BL      TrocaContextoMascarada		\n"	\
+									)
+#else
+#define ESCOLHE_PROXIMA_TAREFA()	__asm volatile(								\
+										"CPSID   I							\n"	\
+										"BL      TrocaContextoDasTarefas	\n"	\
+									)
+#endif
+
+#define SALVA_CONTEXTO()   __asm(								\
+								"MRS     R0,PSP			\n"		\
+								"SUB     R0, R0, #0x10	\n"		\
+								"STM     R0,{R4-R7}		\n"		\
+								"MOV     R4,R8          \n"		\
+								"MOV     R5,R9          \n"		\
+								"MOV     R6,R10         \n"		\
+								"MOV     R7,R11         \n"		\
+								"SUB     R0, R0, #0x20	\n"		\
+								"STM     R0,{R4-R7}		\n"		\
+								"SUB     R0, R0, #0x10	\n"		\
+							);
+
+#define RESTAURA_CONTEXTO()    __asm volatile(											  \
+									/* Restore r4-11 from new process stack */			  \
+									"LDM     R0!,{R4-R7}		\n"						  \
+									"MOV     R8,R4              \n"						  \
+									"MOV     R9,R5              \n"						  \
+									"MOV     R10,R6             \n"					  	  \
+									"MOV     R11,R7             \n"					  	  \
+									"LDM     R0!,{R4-R7}		\n"						  \
+									/* Load MSP with new process SP */					  \
+									"MSR     PSP, R0			\n"						  \
+									/* Ensures that int return use the task stack  */	  \
+									"LDR     R1,=0xFFFFFFFD     \n"						  \
+									/* Exception return will restore remaining context */ \
+									"CPSIE   I					\n"						  \
+									"BX      R1               	\n"						  \
+								)
+
+#define SALVA_ISR()			// em branco para este processador
+
+#define RESTAURA_ISR()		__asm(							  \
+								"LDR     R1,=0xFFFFFFFD     \n"						  \
+								/* Exception return will restore remaining context */ \
+								"CPSIE   I					\n"						  \
+								"BX      R1               	\n"						  \
+							)
+
+
+#endif /* CPU_PORT_H_ */
\ No newline at end of file
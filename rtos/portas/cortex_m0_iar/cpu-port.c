@@ -0,0 +1,232 @@
+/*
+ * cpu_port.c
+ *
+ * Porta do sistema multitarefas para processadores ARM Cortex-M0/M0+ 
+ * com o compilador IAR EW ARM
+ *
+ * Author: Carlos H. Barriquello
+ */ 
+
+#include "cpu-port.h"
+#include "rtos.h"
+
+stackptr_t CriaContexto(tarefa_t endereco_tarefa, stackptr_t ptr_pilha)
+{
+	#define INITIAL_XPSR		0x01000000
+	
+	uint32_t reg_val;
+	*(--ptr_pilha) = INITIAL_XPSR;     /* xPSR */
+	*(--ptr_pilha) = (uint32_t)endereco_tarefa;  /* R15 */
+	*(--ptr_pilha) = 0x00;				   /* R14 */
+	
+	*(--ptr_pilha) = 0x12;			   /* R12 */
+	
+	for(reg_val = 3; reg_val > 0; reg_val--)
+	{
+		*(--ptr_pilha) = reg_val;  /* R3, R2, R1 */
+	}
+	
+	*(--ptr_pilha) = 0;		   /* R0 */
+	
+	for(reg_val = 7; reg_val >= 4; reg_val--)
+	{
+		*(--ptr_pilha) = reg_val;  /* R7, R6, R5, R4 */
+	}
+	
+	for(reg_val = 11; reg_val >= 8; reg_val--)
+	{
+		*(--ptr_pilha) = reg_val;  /* R11, R10, R9, R8 */
+	}
+	
+	return ptr_pilha;
+
+	
+}
+
+/* numero de contagens do SysTick em uma marca de tempo */
+static uint32_t contagens_por_marca;
+
+/* clock da CPU informado por MarcaTempoAlteraClock (0: cfg_CPU_CLOCK_HZ) */
+static uint32_t clock_cpu_hz = 0;
+
+#if cfg_ESTATISTICAS
+/* ciclos e marcas de tempo na ultima troca de clock: as marcas seguintes 
+   sao contadas com as contagens do novo clock, sem mudar os ciclos ja 
+   contados com o anterior */
+static uint64_t ciclos_base = 0;
+static tick_t marcas_base = 0;
+#endif
+
+/* Codigo dependente de hardware usado para 
+ * configuracao da marca de tempo do sistema multitarefas */
+void ConfiguraMarcaTempo(void)
+{   
+	
+	    uint32_t cpu_clock_hz = clock_cpu_hz ? clock_cpu_hz : cfg_CPU_CLOCK_HZ;	/* definido no conf_rtos.h de cada placa */
+		uint32_t valor_comparador = cpu_clock_hz/cfg_MARCA_TEMPO_HZ;
+		
+		contagens_por_marca = valor_comparador;
+		
+		*(NVIC_SYSTICK_CTRL) = 0;						// Desabilita SysTick Timer
+		*(NVIC_SYSTICK_LOAD) = valor_comparador - 1;	// Configura a contagem
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;  // Inicia
+}
+
+/* informa a nova frequencia da CPU, quando a placa troca o clock depois do 
+ * inicio. Se a marca de tempo ja foi configurada, reprograma o SysTick: a 
+ * marca atual recomeca com o novo periodo (atrasa no maximo uma marca). 
+ * Chamada com as interrupcoes desabilitadas ou antes de ConfiguraMarcaTempo */
+void MarcaTempoAlteraClock(uint32_t cpu_clock_hz)
+{
+	clock_cpu_hz = cpu_clock_hz;
+	if(*(NVIC_SYSTICK_CTRL) & NVIC_SYSTICK_ENABLE)
+	{
+		#if cfg_ESTATISTICAS
+		ciclos_base = TempoEmCiclos();
+		marcas_base = ObtemMarcasDeTempo();
+		if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+		{
+			marcas_base++;		/* contada por TempoEmCiclos */
+		}
+		#endif
+		ConfiguraMarcaTempo();
+	}
+}
+
+#if cfg_ESTATISTICAS
+/* Codigo dependente de hardware usado pelas estatisticas de execucao: 
+ * retorna o tempo do sistema em ciclos de clock, isto e, as marcas de tempo 
+ * ja contadas mais os ciclos decorridos na marca atual, lidos do SysTick 
+ * (o Cortex-M0+ nao possui o contador DWT_CYCCNT). Depois de uma troca de 
+ * clock, os ciclos seguintes sao os do novo clock. Chamada com as 
+ * interrupcoes desabilitadas */
+uint64_t TempoEmCiclos(void)
+{
+	tick_t marcas = ObtemMarcasDeTempo();
+	uint32_t decorrido = (contagens_por_marca - 1) - *(NVIC_SYSTICK_VAL);
+	
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		/* o SysTick recarregou, mas a marca ainda nao foi contada */
+		marcas++;
+		decorrido = (contagens_por_marca - 1) - *(NVIC_SYSTICK_VAL);
+	}
+	
+	return ciclos_base + ((uint64_t)(tick_t)(marcas - marcas_base) * contagens_por_marca) + decorrido;
+}
+#endif
+
+/* Codigo dependente de hardware usado pelo modo ocioso sem marcas de tempo: 
+ * reprograma o SysTick para interromper somente apos qtas_marcas, dorme (WFI) 
+ * e, ao acordar, corrige o tempo do sistema. Chamada com as interrupcoes 
+ * desabilitadas; a ultima marca e contada pelo proprio SysTick_Handler */
+void DormeSemMarcas(tick_t qtas_marcas)
+{
+	uint32_t marcas_max = NVIC_SYSTICK_MAX_LOAD / contagens_por_marca;
+	uint32_t recarga, decorrido;
+	tick_t marcas_completas;
+	
+	if(qtas_marcas > marcas_max)
+	{
+		qtas_marcas = (tick_t)marcas_max;
+	}
+	
+	/* para o SysTick e calcula a contagem ate o instante de despertar */
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	recarga = *(NVIC_SYSTICK_VAL) + (contagens_por_marca * (qtas_marcas - 1));
+	
+	/* uma marca de tempo ficou pendente enquanto o SysTick era parado: nao dorme */
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+		return;
+	}
+	
+	*(NVIC_SYSTICK_LOAD) = recarga;
+	*(NVIC_SYSTICK_VAL) = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+	
+	cfg_ANTES_DE_DORMIR(qtas_marcas);
+	DORME_ATE_INTERRUPCAO();
+	
+	/* acordou: para o SysTick para medir quanto tempo passou */
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	cfg_APOS_DORMIR();
+	
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		/* dormiu o tempo todo: o SysTick_Handler pendente conta a ultima marca 
+		 * e a proxima marca acontece apos o restante do periodo atual */
+		marcas_completas = qtas_marcas - 1;
+		decorrido = recarga - *(NVIC_SYSTICK_VAL);
+		*(NVIC_SYSTICK_LOAD) = (contagens_por_marca - 1) - (decorrido % contagens_por_marca);
+	}else
+	{
+		/* acordou antes por outra interrupcao: conta somente as marcas completas */
+		decorrido = recarga - *(NVIC_SYSTICK_VAL);
+		marcas_completas = (tick_t)(decorrido / contagens_por_marca);
+		*(NVIC_SYSTICK_LOAD) = ((marcas_completas + 1) * contagens_por_marca) - decorrido;
+	}
+	
+	/* reinicia o SysTick com o restante da marca atual e volta ao periodo normal */
+	*(NVIC_SYSTICK_VAL) = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+	*(NVIC_SYSTICK_LOAD) = contagens_por_marca - 1;
+	
+	CompensaMarcasDeTempo(marcas_completas);
+}
+
+/* rotinas de interrupcao necessarias */
+__irq __attribute__ ((naked)) void SVC_Handler(void)
+{
+	PINO_RASTRO_ENTRA(cfg_PINO_RASTRO_SVC);	/* so constantes: sem registradores alem de R0-R3 */
+	/* Make PendSV and SysTick the lowest priority interrupts. */
+	*(NVIC_SYSPRI3) |= NVIC_PENDSV_PRI;
+	*(NVIC_SYSPRI3) |= NVIC_SYSTICK_PRI;
+	PINO_RASTRO_SAI(cfg_PINO_RASTRO_SVC);
+	RESTAURA_SP(ponteiro_de_pilha);
+	RESTAURA_CONTEXTO();
+	RESTAURA_ISR();
+}
+
+/* troca de contexto: o stack pointer passa em R0 do salvamento para o 
+   escalonador e deste para a restauracao, sem variaveis intermediarias. 
+   A flag do PendSV e limpa pelo proprio hardware na entrada da excecao */
+NUCLEO_RAPIDO __irq __attribute__ ((naked)) void PendSV_Handler(void)
+{
+	
+	PINO_RASTRO_ENTRA(cfg_PINO_RASTRO_PENDSV);	/* desligado por TrocaContextoDasTarefas */
+	SALVA_ISR();
+	SALVA_CONTEXTO();			/* R0 = pilha da tarefa atual */
+	
+	ESCOLHE_PROXIMA_TAREFA();	/* R0 = pilha da proxima tarefa */
+	
+	RESTAURA_CONTEXTO();
+	
+}
+
+/* Codigo dependente de hardware usado para 
+   realizar a marca de tempo do sistema multitarefas - interrupcao */
+NUCLEO_RAPIDO __irq void SysTick_Handler(void)
+{	
+	 reg_atomica_t estado;
+	 
+	 PINO_RASTRO_ENTRA(cfg_PINO_RASTRO_MARCA);
+	 REG_ATOMICA_INICIO(estado);		/* outras interrupcoes podem usar servicos do sistema */
+	 ExecutaMarcaDeTempo();    
+	 REG_ATOMICA_FIM(estado);		/* com cfg_PREEMPTIVO, a troca de contexto ja foi solicitada */
+	 PINO_RASTRO_SAI(cfg_PINO_RASTRO_MARCA);
+}
+
+__irq void HardFault_Handler(void)
+{
+	
+	while(1)
+	{
+		
+		
+	}
+}
+
+
+
@@ -0,0 +1,181 @@
+/*
+ * cpu_port.h
+ *
+ * Porta do sistema multitarefas para processadores ARM Cortex-M0/M0+ 
+ * com o compilador IAR EW ARM
+ *
+ *  Author: Carlos H. Barriquello
+ */ 
+
+
+#ifndef CPU_PORT_H_
+#define CPU_PORT_H_
+
+#include "stdint.h"
+#include <intrinsics.h>
+
+/* configurar conforme processador*/
+/* Ex. processador ARM 16 registradores de 4 bytes cada */
+#define TAM_MINIMO_PILHA  (16)
+
+/* tipo do ponteiro de pilha */
+typedef uint32_t* stackptr_t;
+
+
+/* registradores da cpu ARM Cortex-M*/
+#define NVIC_INT_CTRL_B         ( ( volatile unsigned long *) 0xe000ed04 )
+#define NVIC_SYSPRI3			( ( volatile unsigned long *) 0xe000ed20 )
+#define NVIC_SYSTICK_CTRL       ( ( volatile unsigned long *) 0xe000e010 )
+#define NVIC_SYSTICK_LOAD       ( ( volatile unsigned long *) 0xe000e014 )
+#define NVIC_SYSTICK_VAL        ( ( volatile unsigned long *) 0xe000e018 )
+
+#define NVIC_PENDSVSET      			0x10000000         			// Dispara excecao PendSV
+#define NVIC_PENDSVCLR      			0x08000000         			// Limpa a flag PendSV
+#define NVIC_PENDSTSET      			0x04000000         			// Excecao SysTick pendente
+#define NVIC_SYSTICK_MAX_LOAD   		0x00FFFFFF         			// Contador de 24 bits
+#define NVIC_SYSTICK_CLK        		0x00000004
+#define NVIC_SYSTICK_INT        		0x00000002
+#define NVIC_SYSTICK_ENABLE     		0x00000001
+#define PRIO_BITS       		        4        					// 15 niveis de prioridade
+#define LOWEST_INTERRUPT_PRIORITY		0xF
+#define KERNEL_INTERRUPT_PRIORITY 		(LOWEST_INTERRUPT_PRIORITY << (8 - PRIO_BITS) )
+#define NVIC_PENDSV_PRI					( ( ( unsigned long ) KERNEL_INTERRUPT_PRIORITY ) << 16 )
+#define NVIC_SYSTICK_PRI				( ( ( unsigned long ) KERNEL_INTERRUPT_PRIORITY ) << 24 )
+
+
+/* troca da frequencia da CPU depois do inicio (ver cpu-port.c) */
+void MarcaTempoAlteraClock(uint32_t cpu_clock_hz);
+
+/* macros dependentes de hardware, instrucoes em assembly */
+
+/* regioes atomicas aninhaveis: REG_ATOMICA_INICIO guarda o estado das 
+   interrupcoes (PRIMASK) na variavel estado, do tipo reg_atomica_t, e as 
+   desabilita. REG_ATOMICA_FIM restaura o estado guardado, entao so habilita 
+   as interrupcoes se elas estavam habilitadas no inicio da regiao. Assim os 
+   servicos do sistema podem ser chamados dentro da regiao atomica de um 
+   driver ou de uma interrupcao sem habilitar as interrupcoes antes da hora */
+typedef uint32_t reg_atomica_t;
+
+static inline reg_atomica_t SalvaEDesabilitaInterrupcoes(void)
+{
+	reg_atomica_t estado = __get_PRIMASK();
+	__disable_interrupt();
+	return estado;
+}
+
+static inline void RestauraInterrupcoes(reg_atomica_t estado)
+{
+	__set_PRIMASK(estado);
+}
+
+#define REG_ATOMICA_INICIO(estado)	  (estado) = SalvaEDesabilitaInterrupcoes()
+#define REG_ATOMICA_FIM(estado)		  RestauraInterrupcoes(estado)
+
+/* solicita a troca de contexto (PendSV). Ela acontece assim que as interrupcoes 
+   forem habilitadas, ao fim da regiao atomica ou da interrupcao que a solicitou */
+#define TROCA_CONTEXTO()		*(NVIC_INT_CTRL_B) = NVIC_PENDSVSET
+#define TrocaContexto()		    TROCA_CONTEXTO()
+#define Clear_PendSV(void)		*(NVIC_INT_CTRL_B) = NVIC_PENDSVCLR
+
+/* busca do bit mais significativo do mapa de prontas usada pelo escalonador.
+ * O Cortex-M0+ nao possui a instrucao CLZ, entao o nucleo usa sua versao em C.
+ * Em processadores com CLZ (Cortex-M3/M4/M7) pode-se definir:
+ * #define MAIOR_BIT_ATIVO(mapa)	(31 - __CLZ(mapa))
+ */
+
+/* contador de ciclos para medicoes de desempenho. O Cortex-M0+ nao possui 
+ * o contador DWT_CYCCNT, entao usa-se o valor atual do SysTick, que conta 
+ * para baixo a cada ciclo de clock e recarrega a cada marca de tempo */
+#define LE_CONTADOR_CICLOS()		(*(NVIC_SYSTICK_VAL))
+
+/* ciclos desde a ultima marca de tempo, para o rastro do nucleo (cfg_RASTRO). 
+   Cabe em 16 bits enquanto a marca de tempo tiver ate 65535 ciclos */
+#define RASTRO_SUBMARCA()			((uint16_t)(*(NVIC_SYSTICK_LOAD) - *(NVIC_SYSTICK_VAL)))
+
+/* pinos de rastro (cfg_PINOS_RASTRO): escritas de um ciclo nos registradores 
+   DIRSET/OUTCLR/OUTSET do grupo de pinos pelo IOBUS do SAM D/R, sem 
+   ler-modificar-escrever. A mascara tem os bits dos pinos do grupo 
+   PINOS_RASTRO_IOBUS (padrao: grupo A, PA00 a PA31) */
+#ifndef PINOS_RASTRO_IOBUS
+#define PINOS_RASTRO_IOBUS			0x60000000UL
+#endif
+#define PINOS_RASTRO_SAIDA(mascara)		(*(volatile uint32_t *)(PINOS_RASTRO_IOBUS + 0x08) = (uint32_t)(mascara))
+#define PINOS_RASTRO_DESLIGA(mascara)	(*(volatile uint32_t *)(PINOS_RASTRO_IOBUS + 0x14) = (uint32_t)(mascara))
+#define PINOS_RASTRO_LIGA(mascara)		(*(volatile uint32_t *)(PINOS_RASTRO_IOBUS + 0x18) = (uint32_t)(mascara))
+
+/* barreira de memoria: os acessos anteriores terminam antes dos seguintes, 
+   tambem para o compilador. Usada nas estruturas sem regiao atomica (anel_t) */
+#define BARREIRA_MEMORIA()			__DMB()
+
+/* variavel global sem inicializacao na partida, para areas grandes que 
+   a aplicacao inicializa (pilhas das tarefas, buffers de DMA). 
+   Ex.: NAO_INICIALIZADA uint32_t pilha[TAM_PILHA]; */
+#define NAO_INICIALIZADA			__no_init
+
+/* variavel mantida entre resets sem falta de energia: sem inicializacao, 
+   como NAO_INICIALIZADA, validada pela aplicacao */
+#define RETIDA						__no_init
+
+/* funcao executada da RAM, copiada na inicializacao (cfg_NUCLEO_NA_RAM) */
+#define FUNCAO_NA_RAM				__ramfunc
+
+/* instrucoes para dormir ate a proxima interrupcao */
+#define DORME_ATE_INTERRUPCAO()		do { __DSB(); __WFI(); __ISB(); } while(0)
+
+#define GERA_INTERRUPCAO_SW()      __asm(  /* Call SVC to start the first task. */		\
+										"cpsie i				\n"					\
+										"svc 0					\n"					\
+									);												\
+
+
+/* carrega em R0 o stack pointer guardado na variavel SP (inicio do sistema) */
+#define RESTAURA_SP(SP)	       __asm volatile( "mov     r0, %0\n\t" ::"r"(SP));
+
+/* chama o escalonador com as interrupcoes desabilitadas, recebendo e 
+   retornando o stack pointer em R0: stackptr_t TrocaContextoDasTarefas(stackptr_t) */
+#define ESCOLHE_PROXIMA_TAREFA()	__asm volatile(								\
+										"CPSID   I							\n"	\
+										"BL      TrocaContextoDasTarefas	\n"	\
+									)
+
+#define SALVA_CONTEXTO()   __asm volatile(							\
+								"MRS     R0,PSP			\n"		\
+								"SUBS    R0, R0, #0x10	\n"		\
+								"STM     R0!,{R4-R7}	\n"		\
+								"MOV     R4,R8          \n"		\
+								"MOV     R5,R9          \n"		\
+								"MOV     R6,R10         \n"		\
+								"MOV     R7,R11         \n"		\
+								"SUBS    R0, R0, #0x20	\n"		\
+								"STM     R0!,{R4-R7}	\n"		\
+								"SUBS    R0, R0, #0x10	\n"		\
+							);
+
+#define RESTAURA_CONTEXTO()    __asm volatile(											  \
+									/* Restore r4-11 from new process stack */			  \
+									"LDM     R0!,{R4-R7}		\n"						  \
+									"MOV     R8,R4              \n"						  \
+									"MOV     R9,R5              \n"						  \
+									"MOV     R10,R6             \n"					  	  \
+									"MOV     R11,R7             \n"					  	  \
+									"LDM     R0!,{R4-R7}		\n"						  \
+									/* Load MSP with new process SP */					  \
+									"MSR     PSP, R0			\n"						  \
+									/* Ensures that int return use the task stack  */	  \
+									"LDR     R1,=0xFFFFFFFD     \n"						  \
+									/* Exception return will restore remaining context */ \
+									"CPSIE   I					\n"						  \
+									"BX      R1               	\n"						  \
+								)
+
+#define SALVA_ISR()			// em branco para este processador
+
+#define RESTAURA_ISR()		__asm(							  \
+								"LDR     R1,=0xFFFFFFFD     \n"						  \
+								/* Exception return will restore remaining context */ \
+								"CPSIE   I					\n"						  \
+								"BX      R1               	\n"						  \
+							)
+
+
+#endif /* CPU_PORT_H_ */
\ No newline at end of file
@@ -0,0 +1,476 @@
+/*
+ * cpu_port.c
+ *
+ * Porta do sistema multitarefas para processadores ARM Cortex-M3/M4/M4F/M7
+ * com o compilador GCC. A marca de tempo e o sono sem marcas usam o
+ * SysTick como a porta cortex_m0_gcc; as estatisticas contam ciclos pelo
+ * DWT_CYCCNT
+ */
+
+#include "cpu-port.h"
+#include "rtos.h"
+
+#if defined(OTIMIZA_DESEMPENHO) && OTIMIZA_DESEMPENHO
+#pragma GCC optimize ("O2")
+#endif
+
+/* quadro inicial de uma tarefa, no formato do PendSV_Handler: o quadro
+   basico do hardware, R4-R11 e o EXC_RETURN de retorno ao modo thread com
+   a PSP, sem FPU. A tarefa passa a ter o quadro estendido na primeira
+   instrucao de ponto flutuante */
+stackptr_t CriaContexto(tarefa_t endereco_tarefa, stackptr_t ptr_pilha)
+{
+	#define INITIAL_XPSR		0x01000000
+	#define INITIAL_EXC_RETURN	0xFFFFFFFD
+
+	uint32_t reg_val;
+
+	/* o quadro de excecao fica alinhado em 8 bytes */
+	ptr_pilha = (stackptr_t)((uint32_t)ptr_pilha & ~7u);
+
+	*(--ptr_pilha) = INITIAL_XPSR;     /* xPSR */
+	*(--ptr_pilha) = (uint32_t)endereco_tarefa;  /* R15 */
+	*(--ptr_pilha) = 0x00;				   /* R14 */
+
+	*(--ptr_pilha) = 0x12;			   /* R12 */
+
+	for(reg_val = 3; reg_val > 0; reg_val--)
+	{
+		*(--ptr_pilha) = reg_val;  /* R3, R2, R1 */
+	}
+
+	*(--ptr_pilha) = 0;		   /* R0 */
+
+	*(--ptr_pilha) = INITIAL_EXC_RETURN;	/* LR do PendSV */
+
+	for(reg_val = 11; reg_val >= 4; reg_val--)
+	{
+		*(--ptr_pilha) = reg_val;  /* R11 ... R4 */
+	}
+
+	return ptr_pilha;
+}
+
+/* numero de contagens do SysTick em uma marca de tempo */
+static uint32_t contagens_por_marca;
+
+/* clock da CPU informado por MarcaTempoAlteraClock (0: cfg_CPU_CLOCK_HZ) */
+static uint32_t clock_cpu_hz = 0;
+
+/* marcas de tempo por segundo: cfg_MARCA_TEMPO_HZ ou a frequencia de
+   MarcaTempoReprograma */
+static uint32_t frequencia_marca = cfg_MARCA_TEMPO_HZ;
+
+#if cfg_ESTATISTICAS
+/* ciclos do sistema em 64 bits: soma das diferencas do DWT_CYCCNT desde a
+   ultima leitura, que acontece pelo menos a cada marca de tempo (no
+   SysTick_Handler), bem antes de o contador de 32 bits dar a volta */
+static uint64_t ciclos_total = 0;
+static uint32_t ciclos_ultimo = 0;
+
+static NUCLEO_RAPIDO uint64_t ContaCiclos(void)
+{
+	uint32_t agora = *(DWT_CYCCNT);
+
+	ciclos_total += (uint32_t)(agora - ciclos_ultimo);
+	ciclos_ultimo = agora;
+	return ciclos_total;
+}
+
+/* soma o sono que o DWT_CYCCNT nao contou: em muitos microcontroladores o
+   clock do nucleo, e o contador com ele, para no WFI e no sono longo */
+static void CompensaCiclosDormidos(uint64_t dormidos, uint32_t cyccnt_antes)
+{
+	uint32_t contados = *(DWT_CYCCNT) - cyccnt_antes;
+
+	if(dormidos > contados)
+	{
+		ciclos_total += dormidos - contados;
+	}
+}
+#endif
+
+#if cfg_AJUSTE_MARCA
+/* ajuste fino (MarcaTempoAjusta): correcao de frequencia em 1/65536 de
+   contagem por marca, com o resto fracionario acumulado entre as marcas,
+   e correcao de fase pendente, em contagens */
+static int32_t ajuste_frequencia = 0;
+static int32_t resto_frequencia = 0;
+static int32_t ajuste_fase = 0;
+
+/* LOAD do periodo em curso e do seguinte: o valor escrito no LOAD so e
+   usado na proxima recarga do SysTick */
+static uint32_t carga_atual;
+static uint32_t carga_proxima;
+#endif
+
+/* liga o DWT_CYCCNT, se o depurador ainda nao ligou (LE_CONTADOR_CICLOS e
+   as estatisticas). No Cortex-M7 o DWT precisa ser destravado antes */
+static void IniciaContadorCiclos(void)
+{
+	*(DEBUG_DEMCR) |= DEMCR_TRCENA;
+	*(DWT_LAR) = DWT_CHAVE;
+	if((*(DWT_CTRL) & DWT_CYCCNTENA) == 0)
+	{
+		*(DWT_CYCCNT) = 0;
+		*(DWT_CTRL) |= DWT_CYCCNTENA;
+	}
+}
+
+/* Codigo dependente de hardware usado para
+ * configuracao da marca de tempo do sistema multitarefas */
+void ConfiguraMarcaTempo(void)
+{
+		uint32_t cpu_clock_hz = clock_cpu_hz ? clock_cpu_hz : cfg_CPU_CLOCK_HZ;	/* definido no conf_rtos.h de cada placa */
+		uint32_t valor_comparador = cpu_clock_hz/frequencia_marca;
+
+		IniciaContadorCiclos();
+
+		contagens_por_marca = valor_comparador;
+		#if cfg_AJUSTE_MARCA
+		carga_atual = carga_proxima = valor_comparador - 1;
+		#endif
+
+		*(NVIC_SYSTICK_CTRL) = 0;						// Desabilita SysTick Timer
+		*(NVIC_SYSTICK_LOAD) = valor_comparador - 1;	// Configura a contagem
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;  // Inicia
+}
+
+/* informa a nova frequencia da CPU, quando a placa troca o clock depois do
+ * inicio. Se a marca de tempo ja foi configurada, reprograma o SysTick: a
+ * marca atual recomeca com o novo periodo (atrasa no maximo uma marca).
+ * Os ciclos do DWT_CYCCNT seguem o clock real, sem correcao.
+ * Chamada com as interrupcoes desabilitadas ou antes de ConfiguraMarcaTempo */
+void MarcaTempoAlteraClock(uint32_t cpu_clock_hz)
+{
+	clock_cpu_hz = cpu_clock_hz;
+	if(*(NVIC_SYSTICK_CTRL) & NVIC_SYSTICK_ENABLE)
+	{
+		ConfiguraMarcaTempo();
+	}
+}
+
+#if cfg_MARCA_VARIAVEL
+/* menor numero de contagens do SysTick numa marca, como na porta
+   cortex_m0_gcc (~20 kHz a 48 MHz, ~70 kHz a 168 MHz) */
+#define MARCA_MIN_CONTAGENS		2400u
+
+/* troca a frequencia da marca de tempo (MarcaTempoMudaFrequencia), como
+ * MarcaTempoAlteraClock. Retorna 0, sem mudar nada, se a marca nao cabe
+ * no SysTick. Chamada com as interrupcoes desabilitadas */
+uint8_t MarcaTempoReprograma(uint32_t marca_hz)
+{
+	uint32_t cpu_clock_hz = clock_cpu_hz ? clock_cpu_hz : cfg_CPU_CLOCK_HZ;
+	uint32_t contagens;
+
+	if(marca_hz == 0)
+	{
+		return 0;
+	}
+	contagens = cpu_clock_hz / marca_hz;
+	if(contagens < MARCA_MIN_CONTAGENS || contagens - 1 > NVIC_SYSTICK_MAX_LOAD)
+	{
+		return 0;
+	}
+	frequencia_marca = marca_hz;
+	MarcaTempoAlteraClock(cpu_clock_hz);
+	return 1;
+}
+#endif
+
+#if cfg_AJUSTE_MARCA
+/* contagens do SysTick em uma marca de tempo sem ajuste */
+uint32_t MarcaTempoContagens(void)
+{
+	return contagens_por_marca;
+}
+
+/* corrige a duracao das marcas de tempo (ver a porta cortex_m0_gcc):
+ * frequencia em 1/65536 de contagem, somada a todas as marcas seguintes,
+ * e fase em contagens, uma unica vez, limitada a meia marca */
+void MarcaTempoAjusta(int32_t frequencia, int32_t fase)
+{
+	reg_atomica_t estado;
+	int32_t limite = (int32_t)(contagens_por_marca / 2);
+
+	REG_ATOMICA_INICIO(estado);
+	ajuste_frequencia = frequencia;
+	fase += ajuste_fase;					/* soma a fase ainda nao aplicada */
+	if(fase > limite)
+	{
+		fase = limite;
+	}else if(fase < -limite)
+	{
+		fase = -limite;
+	}
+	ajuste_fase = fase;
+	REG_ATOMICA_FIM(estado);
+}
+
+/* programa o LOAD do proximo periodo com o ajuste. Chamada pelo
+   SysTick_Handler, logo depois da recarga */
+static NUCLEO_RAPIDO void AjustaProximaMarca(void)
+{
+	int32_t ajuste;
+
+	carga_atual = carga_proxima;
+	resto_frequencia += ajuste_frequencia;
+	ajuste = resto_frequencia >> 16;			/* deslocamento aritmetico no gcc */
+	resto_frequencia -= ajuste * 65536;
+	ajuste += ajuste_fase;
+	ajuste_fase = 0;
+
+	carga_proxima = (uint32_t)((int32_t)contagens_por_marca - 1 + ajuste);
+	*(NVIC_SYSTICK_LOAD) = carga_proxima;
+}
+#define CARGA_ATUAL				carga_atual
+#define CARGA_PROXIMA			carga_proxima
+#else
+#define CARGA_ATUAL				(contagens_por_marca - 1)
+#define CARGA_PROXIMA			(contagens_por_marca - 1)
+#endif
+
+/* instante atual: retorna as marcas de tempo ja contadas e as contagens do
+ * SysTick decorridas na marca atual, de 0 a contagens_por_marca - 1.
+ * Chamada com as interrupcoes desabilitadas */
+tick_t MarcaTempoInstante(uint32_t *contagens)
+{
+	tick_t marcas = ObtemMarcasDeTempo();
+	uint32_t valor = *(NVIC_SYSTICK_VAL);
+	uint32_t carga = CARGA_ATUAL;
+
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		/* o SysTick recarregou, mas a marca ainda nao foi contada */
+		marcas++;
+		valor = *(NVIC_SYSTICK_VAL);
+		carga = CARGA_PROXIMA;
+	}
+
+	valor = (valor <= carga) ? carga - valor : 0;
+	*contagens = (valor < contagens_por_marca) ? valor : contagens_por_marca - 1;
+	return marcas;
+}
+
+#if cfg_ESTATISTICAS
+/* Codigo dependente de hardware usado pelas estatisticas de execucao:
+ * retorna o tempo do sistema em ciclos de clock, do DWT_CYCCNT estendido
+ * para 64 bits, com exatidao de um ciclo entre as trocas de contexto e
+ * sem depender da marca de tempo. Chamada com as interrupcoes desabilitadas */
+uint64_t TempoEmCiclos(void)
+{
+	return ContaCiclos();
+}
+#endif
+
+#if cfg_SONO_LONGO_MARCAS > 0
+/* sono longo (cfg_SONO_LONGO), como na porta cortex_m0_gcc: o SysTick
+ * fica parado e o tempo dormido vem do gancho. Retorna 0 se o gancho
+ * recusou o sono, com o SysTick de volta como estava */
+static uint8_t DormeLongo(tick_t qtas_marcas)
+{
+	uint64_t contagens_por_s = (uint64_t)contagens_por_marca * frequencia_marca;
+	uint64_t restante, total;
+	uint32_t decorrido, dormido_us;
+	#if cfg_ESTATISTICAS
+	uint32_t cyccnt_antes;
+	#endif
+
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		/* marca pendente: nao dorme, como em DormeSemMarcas */
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+		return 1;
+	}
+	decorrido = CARGA_ATUAL - *(NVIC_SYSTICK_VAL);
+
+	restante = ((uint64_t)qtas_marcas * contagens_por_marca - decorrido) * 1000000u / contagens_por_s;
+	if(restante > 0xFFFFFFFFu)
+	{
+		restante = 0xFFFFFFFFu;
+	}
+
+	#if cfg_ESTATISTICAS
+	ContaCiclos();
+	cyccnt_antes = *(DWT_CYCCNT);
+	#endif
+	cfg_ANTES_DE_DORMIR(qtas_marcas);
+	dormido_us = cfg_SONO_LONGO((uint32_t)restante);
+	cfg_APOS_DORMIR();
+
+	if(dormido_us == 0)
+	{
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+		return 0;
+	}
+
+	#if cfg_ESTATISTICAS
+	CompensaCiclosDormidos(((uint64_t)dormido_us * contagens_por_s) / 1000000u, cyccnt_antes);
+	#endif
+
+	/* contagens do SysTick desde o inicio da marca atual */
+	total = decorrido + ((uint64_t)dormido_us * contagens_por_s) / 1000000u;
+
+	*(NVIC_SYSTICK_LOAD) = (contagens_por_marca - 1) - (uint32_t)(total % contagens_por_marca);
+	*(NVIC_SYSTICK_VAL) = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+	*(NVIC_SYSTICK_LOAD) = contagens_por_marca - 1;
+
+	CompensaMarcasDeTempo((tick_t)(total / contagens_por_marca));
+	return 1;
+}
+#endif
+
+/* Codigo dependente de hardware usado pelo modo ocioso sem marcas de tempo,
+ * como na porta cortex_m0_gcc: reprograma o SysTick para interromper
+ * somente apos qtas_marcas, dorme e, ao acordar, corrige o tempo do
+ * sistema. Chamada dentro de uma regiao atomica (BASEPRI); o WFI acorda
+ * com qualquer interrupcao (DormeAteInterrupcao) */
+void DormeSemMarcas(tick_t qtas_marcas)
+{
+	uint32_t marcas_max = NVIC_SYSTICK_MAX_LOAD / contagens_por_marca;
+	uint32_t recarga, decorrido;
+	tick_t marcas_completas;
+	#if cfg_ESTATISTICAS
+	uint32_t cyccnt_antes;
+	uint32_t dormidos;
+	#endif
+
+	#if cfg_SONO_LONGO_MARCAS > 0
+	if(qtas_marcas >= cfg_SONO_LONGO_MARCAS && DormeLongo(qtas_marcas))
+	{
+		return;
+	}
+	#endif
+
+	if(qtas_marcas > marcas_max)
+	{
+		qtas_marcas = (tick_t)marcas_max;
+	}
+
+	/* para o SysTick e calcula a contagem ate o instante de despertar */
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	recarga = *(NVIC_SYSTICK_VAL) + (contagens_por_marca * (qtas_marcas - 1));
+
+	/* uma marca de tempo ficou pendente enquanto o SysTick era parado: nao dorme */
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+		return;
+	}
+
+	*(NVIC_SYSTICK_LOAD) = recarga;
+	*(NVIC_SYSTICK_VAL) = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+
+	#if cfg_ESTATISTICAS
+	ContaCiclos();
+	cyccnt_antes = *(DWT_CYCCNT);
+	#endif
+	cfg_ANTES_DE_DORMIR(qtas_marcas);
+	DORME_ATE_INTERRUPCAO();
+
+	/* acordou: para o SysTick para medir quanto tempo passou */
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT;
+	cfg_APOS_DORMIR();
+
+	if(*(NVIC_INT_CTRL_B) & NVIC_PENDSTSET)
+	{
+		/* dormiu o tempo todo: o SysTick_Handler pendente conta a ultima marca
+		 * e a proxima marca acontece apos o restante do periodo atual */
+		marcas_completas = qtas_marcas - 1;
+		decorrido = recarga - *(NVIC_SYSTICK_VAL);
+		*(NVIC_SYSTICK_LOAD) = (contagens_por_marca - 1) - (decorrido % contagens_por_marca);
+		#if cfg_ESTATISTICAS
+		dormidos = recarga + 1 + decorrido;
+		#endif
+	}else
+	{
+		/* acordou antes por outra interrupcao: conta somente as marcas completas */
+		decorrido = recarga - *(NVIC_SYSTICK_VAL);
+		marcas_completas = (tick_t)(decorrido / contagens_por_marca);
+		*(NVIC_SYSTICK_LOAD) = ((marcas_completas + 1) * contagens_por_marca) - decorrido;
+		#if cfg_ESTATISTICAS
+		dormidos = decorrido;
+		#endif
+	}
+
+	/* reinicia o SysTick com o restante da marca atual e volta ao periodo normal */
+	*(NVIC_SYSTICK_VAL) = 0;
+	*(NVIC_SYSTICK_CTRL) = NVIC_SYSTICK_CLK | NVIC_SYSTICK_INT | NVIC_SYSTICK_ENABLE;
+	*(NVIC_SYSTICK_LOAD) = contagens_por_marca - 1;
+
+	#if cfg_ESTATISTICAS
+	CompensaCiclosDormidos(dormidos, cyccnt_antes);
+	#endif
+	CompensaMarcasDeTempo(marcas_completas);
+}
+
+/* rotinas de interrupcao necessarias */
+__attribute__ ((naked)) void SVC_Handler(void)
+{
+	PINO_RASTRO_ENTRA(cfg_PINO_RASTRO_SVC);	/* so constantes: sem registradores alem de R0-R3 */
+	/* Make PendSV and SysTick the lowest priority interrupts. */
+	*(NVIC_SYSPRI3) |= NVIC_PENDSV_PRI;
+	*(NVIC_SYSPRI3) |= NVIC_SYSTICK_PRI;
+	#if FPU_NA_PORTA
+	/* FPU habilitada (normalmente ja pelo SystemInit) e com o contexto
+	   empilhado pelo hardware so quando usada, de forma preguicosa */
+	*(SCB_CPACR) |= CPACR_CP10_CP11;
+	*(FPU_FPCCR) |= FPCCR_ASPEN_LSPEN;
+	#endif
+	PINO_RASTRO_SAI(cfg_PINO_RASTRO_SVC);
+	RESTAURA_SP(ponteiro_de_pilha);
+	RESTAURA_CONTEXTO();
+	RESTAURA_ISR();
+}
+
+/* troca de contexto: o stack pointer passa em R0 do salvamento para o
+   escalonador e deste para a restauracao, sem variaveis intermediarias. O
+   EXC_RETURN fica na pilha de cada tarefa, entao o BL pode usar o LR.
+   A flag do PendSV e limpa pelo proprio hardware na entrada da excecao */
+NUCLEO_RAPIDO __attribute__ ((naked)) void PendSV_Handler(void)
+{
+
+	PINO_RASTRO_ENTRA(cfg_PINO_RASTRO_PENDSV);	/* desligado por TrocaContextoDasTarefas */
+	SALVA_ISR();
+	SALVA_CONTEXTO();			/* R0 = pilha da tarefa atual */
+
+	ESCOLHE_PROXIMA_TAREFA();	/* R0 = pilha da proxima tarefa */
+
+	RESTAURA_CONTEXTO();
+
+}
+
+/* Codigo dependente de hardware usado para
+   realizar a marca de tempo do sistema multitarefas - interrupcao */
+NUCLEO_RAPIDO void SysTick_Handler(void)
+{
+	 reg_atomica_t estado;
+
+	 PINO_RASTRO_ENTRA(cfg_PINO_RASTRO_MARCA);
+	 REG_ATOMICA_INICIO(estado);		/* outras interrupcoes podem usar servicos do sistema */
+	 #if cfg_ESTATISTICAS
+	 ContaCiclos();					/* acompanha as voltas do DWT_CYCCNT */
+	 #endif
+	 #if cfg_PERFIL > 0
+	 PerfilAmostra(PERFIL_PC_INTERROMPIDO());
+	 #endif
+	 #if cfg_AJUSTE_MARCA
+	 AjustaProximaMarca();
+	 #endif
+	 ExecutaMarcaDeTempo();
+	 REG_ATOMICA_FIM(estado);		/* com cfg_PREEMPTIVO, a troca de contexto ja foi solicitada */
+	 PINO_RASTRO_SAI(cfg_PINO_RASTRO_MARCA);
+}
+
+void HardFault_Handler(void)
+{
+
+	while(1)
+	{
+
+
+	}
+}
@@ -0,0 +1,300 @@
+/*
+ * cpu_port.h
+ *
+ * Porta para ARM Cortex-M3/M4/M4F/M7 com o compilador GCC. Em relacao a
+ * porta cortex_m0_gcc: regioes atomicas por BASEPRI, contexto de ponto
+ * flutuante guardado so nas tarefas que usam a FPU (empilhamento
+ * preguicoso) e contador de ciclos DWT_CYCCNT. So usa os registradores do
+ * nucleo Cortex-M, sem os arquivos do fabricante (CMSIS).
+ */
+
+
+#ifndef CPU_PORT_H_
+#define CPU_PORT_H_
+
+#include "stdint.h"
+
+/* com FPU (-mfpu=fpv4-sp-d16 ou fpv5-*, -mfloat-abi=hard ou softfp) o
+   contexto de uma tarefa que usou a FPU tem mais S0-S15, FPSCR e um
+   espaco (18 palavras, pelo hardware) e S16-S31 (16, pelo PendSV) */
+#if defined(__ARM_FP)
+#define FPU_NA_PORTA	1
+#else
+#define FPU_NA_PORTA	0
+#endif
+
+/* contexto em palavras: R0-R3, R12, LR, PC, xPSR (hardware), R4-R11 e o
+   EXC_RETURN (PendSV) e o alinhamento de 8 bytes do quadro */
+#if FPU_NA_PORTA
+#define TAM_MINIMO_PILHA  (18 + 34)
+#else
+#define TAM_MINIMO_PILHA  (18)
+#endif
+
+/* tipo do ponteiro de pilha */
+typedef uint32_t* stackptr_t;
+
+
+/* registradores da cpu ARM Cortex-M*/
+#define NVIC_INT_CTRL_B         ( ( volatile unsigned long *) 0xe000ed04 )
+#define NVIC_SYSPRI3			( ( volatile unsigned long *) 0xe000ed20 )
+#define NVIC_SYSTICK_CTRL       ( ( volatile unsigned long *) 0xe000e010 )
+#define NVIC_SYSTICK_LOAD       ( ( volatile unsigned long *) 0xe000e014 )
+#define NVIC_SYSTICK_VAL        ( ( volatile unsigned long *) 0xe000e018 )
+#define SCB_CPACR				( ( volatile unsigned long *) 0xe000ed88 )
+#define FPU_FPCCR				( ( volatile unsigned long *) 0xe000ef34 )
+#define DEBUG_DEMCR				( ( volatile unsigned long *) 0xe000edfc )
+#define DWT_CTRL				( ( volatile unsigned long *) 0xe0001000 )
+#define DWT_CYCCNT				( ( volatile unsigned long *) 0xe0001004 )
+#define DWT_LAR					( ( volatile unsigned long *) 0xe0001fb0 )
+
+#define NVIC_PENDSVSET      			0x10000000         			// Dispara excecao PendSV
+#define NVIC_PENDSVCLR      			0x08000000         			// Limpa a flag PendSV
+#define NVIC_PENDSTSET      			0x04000000         			// Excecao SysTick pendente
+#define NVIC_SYSTICK_MAX_LOAD   		0x00FFFFFF         			// Contador de 24 bits
+#define NVIC_SYSTICK_CLK        		0x00000004
+#define NVIC_SYSTICK_INT        		0x00000002
+#define NVIC_SYSTICK_ENABLE     		0x00000001
+#define NVIC_PENDSV_PRI					( ( unsigned long ) 0xFF << 16 )	// menor prioridade
+#define NVIC_SYSTICK_PRI				( ( unsigned long ) 0xFF << 24 )
+#define CPACR_CP10_CP11					0x00F00000					// acesso total a FPU
+#define FPCCR_ASPEN_LSPEN				0xC0000000					// empilhamento automatico e preguicoso
+#define DEMCR_TRCENA					0x01000000					// habilita o DWT
+#define DWT_CYCCNTENA					0x00000001
+#define DWT_CHAVE						0xC5ACCE55					// destrava o DWT do Cortex-M7
+
+/* bits de prioridade implementados pelo microcontrolador (ex.: 4 no STM32F4,
+   3 no SAM E5x e no SAM E70) */
+#ifndef PRIO_BITS
+#define PRIO_BITS						4
+#endif
+
+/* prioridade mais urgente (menor numero, 1 a 2^PRIO_BITS - 1) das
+   interrupcoes que chamam servicos do sistema. As regioes atomicas so
+   mascaram essas e as menos urgentes (BASEPRI); as de 0 a
+   PRIORIDADE_MAX_NUCLEO - 1 nunca esperam o nucleo, mas nao podem chamar
+   nenhum servico do sistema nem usar REG_ATOMICA_INICIO/FIM (ver
+   MASCARA_NUCLEO da porta cortex_m0_gcc). Sem sufixo: e usada no assembly */
+#ifndef PRIORIDADE_MAX_NUCLEO
+#define PRIORIDADE_MAX_NUCLEO			5
+#endif
+
+#if PRIORIDADE_MAX_NUCLEO < 1 || PRIORIDADE_MAX_NUCLEO >= (1 << PRIO_BITS)
+#error "PRIORIDADE_MAX_NUCLEO deve estar entre 1 e 2^PRIO_BITS - 1"
+#endif
+
+#define BASEPRI_NUCLEO					(PRIORIDADE_MAX_NUCLEO << (8 - PRIO_BITS))
+
+#define TEXTO_ASM_(x)		#x
+#define TEXTO_ASM(x)		TEXTO_ASM_(x)
+
+
+/* troca da frequencia da CPU depois do inicio (ver cpu-port.c) */
+void MarcaTempoAlteraClock(uint32_t cpu_clock_hz);
+
+/* macros dependentes de hardware, instrucoes em assembly */
+
+/* regioes atomicas aninhaveis: REG_ATOMICA_INICIO guarda o BASEPRI na
+   variavel estado, do tipo reg_atomica_t, e o eleva ate BASEPRI_NUCLEO
+   (BASEPRI_MAX so eleva: uma regiao dentro de outra mais restrita nao a
+   afrouxa). REG_ATOMICA_FIM restaura o valor guardado. A escrita do
+   BASEPRI fica entre CPSID e CPSIE (errata 837070 do Cortex-M7 r0p1: uma
+   interrupcao mascarada ainda podia entrar logo depois dela); o PRIMASK e
+   restaurado como estava, para nao habilitar as interrupcoes dentro de
+   DormeSemMarcas ou de um codigo que as desabilitou */
+typedef uint32_t reg_atomica_t;
+
+static inline reg_atomica_t SalvaEDesabilitaInterrupcoes(void)
+{
+	reg_atomica_t estado;
+	uint32_t primask;
+
+	__asm volatile(	"MRS	%0, BASEPRI		\n"
+					"MRS	%1, PRIMASK		\n"
+					"CPSID	I				\n"
+					"MSR	BASEPRI_MAX, %2	\n"
+					"DSB					\n"
+					"ISB					\n"
+					"MSR	PRIMASK, %1		\n"
+					: "=&r" (estado), "=&r" (primask) : "r" (BASEPRI_NUCLEO) : "memory");
+	return estado;
+}
+
+static inline void RestauraInterrupcoes(reg_atomica_t estado)
+{
+	__asm volatile(	"MSR	BASEPRI, %0	\n" : : "r" (estado) : "memory");
+}
+
+#define REG_ATOMICA_INICIO(estado)	  (estado) = SalvaEDesabilitaInterrupcoes()
+#define REG_ATOMICA_FIM(estado)		  RestauraInterrupcoes(estado)
+
+/* solicita a troca de contexto (PendSV). Ela acontece assim que o BASEPRI
+   baixar, ao fim da regiao atomica ou da interrupcao que a solicitou */
+#define TROCA_CONTEXTO()		*(NVIC_INT_CTRL_B) = NVIC_PENDSVSET
+#define TrocaContexto()		    TROCA_CONTEXTO()
+#define Clear_PendSV(void)		*(NVIC_INT_CTRL_B) = NVIC_PENDSVCLR
+
+static inline uint32_t LeIpsr(void)
+{
+	uint32_t ipsr;
+	__asm volatile("MRS %0, IPSR" : "=r"(ipsr));
+	return ipsr;
+}
+
+/* busca do bit mais significativo do mapa de prontas pela instrucao CLZ */
+#define MAIOR_BIT_ATIVO(mapa)	((uint8_t)(31 - __builtin_clz(mapa)))
+
+/* contador de ciclos para medicoes de desempenho: o DWT_CYCCNT (iniciado
+ * por ConfiguraMarcaTempo), de 32 bits, que nao recarrega nas marcas de
+ * tempo. Negado, conta para baixo como o SysTick da porta cortex_m0_gcc,
+ * entao as medicoes (inicio - fim) valem nas duas portas */
+#define LE_CONTADOR_CICLOS()		(0u - *(DWT_CYCCNT))
+
+/* ciclos desde a ultima marca de tempo, para o rastro do nucleo (cfg_RASTRO).
+   Cabe em 16 bits enquanto a marca de tempo tiver ate 65535 ciclos */
+#define RASTRO_SUBMARCA()			((uint16_t)(*(NVIC_SYSTICK_LOAD) - *(NVIC_SYSTICK_VAL)))
+
+/* perfil estatistico (cfg_PERFIL): PC da tarefa interrompida pela marca
+   de tempo, lido do quadro de excecao na pilha da tarefa (PSP), como na
+   porta cortex_m0_gcc. O PC fica na mesma posicao no quadro com a FPU */
+#define PERFIL_NA_PORTA				1
+#define PERFIL_PC_INTERROMPIDO()	PcInterrompido((uint32_t)__builtin_return_address(0))
+
+static inline uint32_t PcInterrompido(uint32_t retorno_excecao)
+{
+	uint32_t *quadro;
+
+	if((retorno_excecao & 0x4) == 0)
+	{
+		return 0;
+	}
+	__asm volatile("MRS %0, PSP" : "=r"(quadro));
+	return quadro[6];		/* R0-R3, R12, LR, PC, xPSR */
+}
+
+/* barreira de memoria: os acessos anteriores terminam antes dos seguintes,
+   tambem para o compilador. Usada nas estruturas sem regiao atomica (anel_t) */
+#define BARREIRA_MEMORIA()			__asm volatile("DMB" ::: "memory")
+
+/* variavel global sem inicializacao na partida: secao .noinit do script
+   do ligador, como na porta cortex_m0_gcc */
+#define NAO_INICIALIZADA			__attribute__((section(".noinit")))
+
+/* pilha principal (MSP) da secao .stack do script do ligador (_sstack),
+   para cfg_OCIOSA_PILHA_PRINCIPAL */
+extern uint32_t _sstack[];
+#define PILHA_PRINCIPAL_FUNDO()		((stackptr_t)_sstack)
+#define PILHA_PRINCIPAL_ATUAL()		LeMsp()
+
+static inline stackptr_t LeMsp(void)
+{
+	stackptr_t msp;
+	__asm volatile("MRS %0, MSP" : "=r"(msp));
+	return msp;
+}
+
+/* variavel mantida entre resets sem falta de energia: secao .retida do
+   script do ligador, como na porta cortex_m0_gcc */
+#define RETIDA						__attribute__((section(".retida")))
+
+/* frequencia da marca de tempo variavel (cfg_MARCA_VARIAVEL):
+   MarcaTempoReprograma troca o LOAD do SysTick */
+#define MARCA_VARIAVEL_NA_PORTA		1
+
+/* funcao executada da RAM (cfg_NUCLEO_NA_RAM): secao .ramfunc, que o
+   Reset_Handler copia da flash junto com .data. No Cortex-M7, de
+   preferencia na ITCM */
+#define FUNCAO_NA_RAM				__attribute__((section(".ramfunc"), noinline))
+
+/* simbolo usado so por nome no assembly da porta (ex.: BL do PendSV): com
+   -flto, o compilador nao ve essa referencia e poderia descartar ou
+   renomear o simbolo */
+#define CHAMADA_POR_ASM				__attribute__((used, externally_visible))
+
+/* dorme ate a proxima interrupcao. O WFI so acorda com as interrupcoes
+   acima do BASEPRI, entao, dentro de uma regiao atomica (DormeSemMarcas),
+   a mascara passa do BASEPRI para o PRIMASK durante o sono: qualquer
+   interrupcao acorda a cpu, e a que acordou so executa depois da regiao */
+static inline void DormeAteInterrupcao(void)
+{
+	uint32_t basepri, primask;
+
+	__asm volatile(	"MRS	%0, BASEPRI		\n"
+					"MRS	%1, PRIMASK		\n"
+					"CPSID	I				\n"
+					"MSR	BASEPRI, %2		\n"
+					"DSB					\n"
+					"WFI					\n"
+					"ISB					\n"
+					"MSR	BASEPRI, %0		\n"
+					"MSR	PRIMASK, %1		\n"
+					: "=&r" (basepri), "=&r" (primask) : "r" (0) : "memory");
+}
+#define DORME_ATE_INTERRUPCAO()		DormeAteInterrupcao()
+
+#define GERA_INTERRUPCAO_SW()      __asm(  /* Call SVC to start the first task. */		\
+										"cpsie i				\n"					\
+										"svc 0					\n"					\
+									);												\
+
+
+/* carrega em R0 o stack pointer guardado na variavel SP (inicio do sistema) */
+#define RESTAURA_SP(SP)		__asm(	"LDR	 R1, =" #SP "	    \n"		\
+									"LDR     R0, [R1]		\n"		\
+							);
+
+/* S16-S31, so se a tarefa usou a FPU: o bit 4 do EXC_RETURN (LR) em 0 diz
+   que o hardware empilhou o quadro estendido. Com o empilhamento
+   preguicoso, o VSTM tambem grava S0-S15 e FPSCR no espaco ja reservado
+   no quadro; sem FPU na tarefa, nada de ponto flutuante e guardado */
+#if FPU_NA_PORTA
+#define SALVA_FPU		"TST     LR, #0x10			\n"		\
+						"IT      EQ					\n"		\
+						"VSTMDBEQ R0!, {S16-S31}	\n"
+#define RESTAURA_FPU	"TST     LR, #0x10			\n"		\
+						"IT      EQ					\n"		\
+						"VLDMIAEQ R0!, {S16-S31}	\n"
+#else
+#define SALVA_FPU		""
+#define RESTAURA_FPU	""
+#endif
+
+/* chama o escalonador com o BASEPRI do nucleo, recebendo e retornando o
+   stack pointer em R0: stackptr_t TrocaContextoDasTarefas(stackptr_t).
+   As interrupcoes mais urgentes continuam atendidas durante a troca */
+#define ESCOLHE_PROXIMA_TAREFA()	__asm volatile(														\
+										"MOV     R1, #" TEXTO_ASM(BASEPRI_NUCLEO) "	\n"					\
+										"CPSID   I							\n"							\
+										"MSR     BASEPRI, R1				\n"							\
+										"DSB								\n"							\
+										"ISB								\n"							\
+										"CPSIE   I							\n"							\
+										"BL      TrocaContextoDasTarefas	\n"							\
+									)
+
+/* guarda R4-R11 e o EXC_RETURN da tarefa, que diz na volta se o quadro
+   dela tem a FPU */
+#define SALVA_CONTEXTO()   __asm(								\
+								"MRS     R0, PSP			\n"	\
+								SALVA_FPU						\
+								"STMDB   R0!, {R4-R11, LR}	\n"	\
+							);
+
+#define RESTAURA_CONTEXTO()    __asm volatile(											  \
+									"LDMIA   R0!, {R4-R11, LR}	\n"						  \
+									RESTAURA_FPU										  \
+									/* Load PSP with new process SP */					  \
+									"MSR     PSP, R0			\n"						  \
+									"ISB						\n"						  \
+									"MOV     R1, #0				\n"						  \
+									"MSR     BASEPRI, R1		\n"						  \
+									/* Exception return will restore remaining context */ \
+									"BX      LR               	\n"						  \
+								)
+
+#define SALVA_ISR()			// em branco para este processador
+
+#define RESTAURA_ISR()		// em branco: RESTAURA_CONTEXTO ja retorna da excecao
+
+
+#endif /* CPU_PORT_H_ */
@@ -0,0 +1,301 @@
+/*
+ * cpu_port.c
+ *
+ * Porta do sistema multitarefas para computadores com sistema POSIX.
+ * Cada tarefa e um contexto ucontext_t guardado no topo da sua pilha. As
+ * interrupcoes sao simuladas: enquanto interrupcoes_desabilitadas = 1, a
+ * marca de tempo (SIGALRM) e a troca de contexto (o PendSV da placa) ficam
+ * pendentes e sao atendidas quando a regiao atomica mais externa termina.
+ */
+
+/* ucontext e temporizadores: definidos antes de qualquer inclusao */
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE			/* REG_RIP, para o perfil */
+#endif
+
+#include <signal.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include "cpu-port.h"
+#include "rtos.h"
+
+#if MARCAS_VIRTUAIS && (!cfg_OCIOSA_SEM_MARCAS || cfg_OCIOSA_MIN_MARCAS != 1)
+#error "MARCAS_VIRTUAIS exige cfg_OCIOSA_SEM_MARCAS = 1 e cfg_OCIOSA_MIN_MARCAS = 1"
+#endif
+
+/* as interrupcoes comecam desabilitadas, ate a primeira tarefa executar */
+volatile sig_atomic_t interrupcoes_desabilitadas = 1;
+
+static volatile sig_atomic_t marca_pendente = 0;
+static volatile sig_atomic_t troca_pendente = 0;
+
+/* contexto de uma tarefa, guardado no topo da sua pilha.
+   O stack_pointer do TCB aponta para esta estrutura */
+typedef struct
+{
+	ucontext_t	contexto;
+	tarefa_t	tarefa;
+} contexto_tarefa_t;
+
+/* executa a troca de contexto pendente, como o PendSV_Handler.
+   Chamada com as interrupcoes desabilitadas */
+static void ExecutaTroca(void)
+{
+	contexto_tarefa_t *atual = (contexto_tarefa_t *)tcb_atual->stack_pointer;
+	contexto_tarefa_t *proxima;
+
+	troca_pendente = 0;
+	proxima = (contexto_tarefa_t *)TrocaContextoDasTarefas((stackptr_t)atual);
+	#if cfg_PILHA_TAREFAS_BASICAS > 0
+	if(contexto_descartado)
+	{
+		/* tarefa basica terminada: o contexto novo pode estar no mesmo 
+		   lugar do atual, que entao nao pode ser guardado */
+		setcontext(&proxima->contexto);
+	}
+	#endif
+	if(proxima != atual)
+	{
+		swapcontext(&atual->contexto, &proxima->contexto);
+	}
+}
+
+/* ponto de entrada de todas as tarefas: habilita as interrupcoes,
+   como o retorno de excecao na placa, e chama a funcao da tarefa */
+static void IniciaTarefa(void)
+{
+	contexto_tarefa_t *contexto = (contexto_tarefa_t *)tcb_atual->stack_pointer;
+
+	RestauraInterrupcoes(0);
+	contexto->tarefa();
+
+	for(;;)
+	{
+		/* uma tarefa nunca deve retornar */
+	}
+}
+
+reg_atomica_t SalvaEDesabilitaInterrupcoes(void)
+{
+	reg_atomica_t estado = interrupcoes_desabilitadas;
+
+	interrupcoes_desabilitadas = 1;
+	return estado;
+}
+
+/* restaura o estado das interrupcoes. Ao habilita-las, atende primeiro a
+   marca de tempo pendente e depois a troca de contexto, que tem a menor
+   prioridade, como na placa */
+void RestauraInterrupcoes(reg_atomica_t estado)
+{
+	if(estado)
+	{
+		return;		/* regiao atomica aninhada: continuam desabilitadas */
+	}
+
+	interrupcoes_desabilitadas = 0;
+	while(marca_pendente || troca_pendente)
+	{
+		interrupcoes_desabilitadas = 1;
+		if(marca_pendente)
+		{
+			marca_pendente = 0;
+			ExecutaMarcaDeTempo();		/* com cfg_PREEMPTIVO, tambem solicita a troca */
+		}
+		if(troca_pendente)
+		{
+			ExecutaTroca();
+		}
+		interrupcoes_desabilitadas = 0;
+	}
+}
+
+void SolicitaTrocaDeContexto(void)
+{
+	troca_pendente = 1;
+	if(!interrupcoes_desabilitadas)
+	{
+		/* interrupcoes habilitadas: a troca acontece imediatamente */
+		interrupcoes_desabilitadas = 1;
+		RestauraInterrupcoes(0);
+	}
+}
+
+/* equivalente ao SysTick_Handler. Tambem pode ser chamada diretamente,
+   sem o temporizador, para gerar marcas de tempo deterministicas */
+void InterrupcaoMarcaDeTempo(void)
+{
+	reg_atomica_t estado;
+
+	REG_ATOMICA_INICIO(estado);
+	marca_pendente = 1;
+	REG_ATOMICA_FIM(estado);
+}
+
+#if cfg_PERFIL > 0
+/* PC interrompido pelo sinal, do contexto guardado pelo sistema. Os 
+   enderecos so cabem nos 32 bits da amostra em um executavel sem PIE 
+   (gcc -no-pie), como os da imagem lida por host_posix/perfil.c */
+static uint32_t PcInterrompido(void *contexto)
+{
+	#if defined(__linux__) && defined(__x86_64__)
+	return (uint32_t)((ucontext_t *)contexto)->uc_mcontext.gregs[REG_RIP];
+	#elif defined(__linux__) && defined(__aarch64__)
+	return (uint32_t)((ucontext_t *)contexto)->uc_mcontext.pc;
+	#else
+	(void)contexto;
+	return 0;
+	#endif
+}
+#endif
+
+static void TrataSinalMarcaDeTempo(int sinal, siginfo_t *info, void *contexto)
+{
+	(void)sinal;
+	(void)info;
+	(void)contexto;
+
+	if(interrupcoes_desabilitadas)
+	{
+		marca_pendente = 1;		/* atendida ao fim da regiao atomica, sem amostra do perfil */
+		return;
+	}
+	#if cfg_PERFIL > 0
+	interrupcoes_desabilitadas = 1;
+	PerfilAmostra(PcInterrompido(contexto));
+	interrupcoes_desabilitadas = 0;
+	#endif
+	InterrupcaoMarcaDeTempo();
+}
+
+/* cria o contexto inicial da tarefa no topo da pilha. Como so o topo e
+   conhecido, a tarefa usa somente os TAM_MINIMO_PILHA palavras do topo */
+stackptr_t CriaContexto(tarefa_t endereco_tarefa, stackptr_t ptr_pilha)
+{
+	uint8_t *topo = (uint8_t *)ptr_pilha;
+	uint8_t *base = topo - (TAM_MINIMO_PILHA * sizeof(uint32_t));
+	contexto_tarefa_t *contexto;
+
+	contexto = (contexto_tarefa_t *)(((uintptr_t)(topo - sizeof(contexto_tarefa_t))) & ~(uintptr_t)15);
+
+	getcontext(&contexto->contexto);
+	contexto->contexto.uc_stack.ss_sp = base;
+	contexto->contexto.uc_stack.ss_size = (size_t)((uint8_t *)contexto - base);
+	contexto->contexto.uc_link = 0;
+	sigemptyset(&contexto->contexto.uc_sigmask);
+	contexto->tarefa = endereco_tarefa;
+	makecontext(&contexto->contexto, IniciaTarefa, 0);
+
+	return (stackptr_t)contexto;
+}
+
+/* inicia a primeira tarefa, escolhida por IniciaMultitarefas */
+void IniciaPrimeiraTarefa(void)
+{
+	setcontext(&((contexto_tarefa_t *)ponteiro_de_pilha)->contexto);
+}
+
+#if !MARCAS_VIRTUAIS
+/* marcas de tempo por segundo: cfg_MARCA_TEMPO_HZ ou a frequencia de 
+   MarcaTempoReprograma */
+static uint32_t frequencia_marca = cfg_MARCA_TEMPO_HZ;
+#endif
+
+/* marca de tempo do sistema multitarefas: temporizador do sistema
+   operacional com o sinal SIGALRM */
+void ConfiguraMarcaTempo(void)
+{
+	struct sigaction acao;
+
+	acao.sa_sigaction = TrataSinalMarcaDeTempo;
+	acao.sa_flags = SA_RESTART | SA_SIGINFO;
+	sigemptyset(&acao.sa_mask);
+	sigaction(SIGALRM, &acao, 0);
+
+	#if !MARCAS_VIRTUAIS		/* virtuais: o tempo anda em DormeSemMarcas */
+	{
+		struct itimerval periodo;
+
+		periodo.it_interval.tv_sec = 0;
+		periodo.it_interval.tv_usec = 1000000 / frequencia_marca;
+		periodo.it_value = periodo.it_interval;
+		setitimer(ITIMER_REAL, &periodo, 0);
+	}
+	#endif
+}
+
+#if cfg_MARCA_VARIAVEL
+/* troca a frequencia da marca de tempo (MarcaTempoMudaFrequencia): o 
+   periodo do setitimer (2 Hz a 1 MHz, o tv_usec fica abaixo de 1 s) 
+   recomeca inteiro. Retorna 0, sem mudar nada, fora dessa faixa */
+uint8_t MarcaTempoReprograma(uint32_t marca_hz)
+{
+	if(marca_hz < 2 || marca_hz > 1000000)
+	{
+		return 0;
+	}
+	#if !MARCAS_VIRTUAIS
+	frequencia_marca = marca_hz;
+	{
+		struct itimerval periodo;
+
+		periodo.it_interval.tv_sec = 0;
+		periodo.it_interval.tv_usec = 1000000 / frequencia_marca;
+		periodo.it_value = periodo.it_interval;
+		setitimer(ITIMER_REAL, &periodo, 0);
+	}
+	#endif
+	return 1;
+}
+#endif
+
+/* modo ocioso sem marcas de tempo: no computador o temporizador nao e
+   reprogramado, apenas espera o proximo sinal. Chamada com as interrupcoes
+   desabilitadas; a marca que acordou fica pendente e e tratada normalmente */
+void DormeSemMarcas(tick_t qtas_marcas)
+{
+	#if MARCAS_VIRTUAIS
+	/* salta direto para o despertar: as marcas dormidas sao compensadas e 
+	   a ultima fica pendente, tratada normalmente como a do SysTick */
+	if(!marca_pendente)
+	{
+		cfg_ANTES_DE_DORMIR(qtas_marcas);
+		cfg_APOS_DORMIR();
+		CompensaMarcasDeTempo(qtas_marcas - 1);
+		marca_pendente = 1;
+	}
+	#else
+	sigset_t bloqueia, anterior;
+
+	(void)qtas_marcas;		/* usado so pelo gancho cfg_ANTES_DE_DORMIR, se definido */
+
+	sigemptyset(&bloqueia);
+	sigaddset(&bloqueia, SIGALRM);
+	sigprocmask(SIG_BLOCK, &bloqueia, &anterior);
+	if(!marca_pendente)
+	{
+		cfg_ANTES_DE_DORMIR(qtas_marcas);
+		sigsuspend(&anterior);
+		cfg_APOS_DORMIR();
+	}
+	sigprocmask(SIG_SETMASK, &anterior, 0);
+	#endif
+}
+
+/* tempo do sistema para as estatisticas e para as medicoes de host_posix: 
+   no computador, em nanossegundos. Existe mesmo sem cfg_ESTATISTICAS */
+uint64_t TempoEmCiclos(void)
+{
+	struct timespec agora;
+
+	clock_gettime(CLOCK_MONOTONIC, &agora);
+	return ((uint64_t)agora.tv_sec * 1000000000ULL) + (uint64_t)agora.tv_nsec;
+}
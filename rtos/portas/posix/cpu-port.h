@@ -0,0 +1,92 @@
+/*
+ * cpu_port.h
+ *
+ * Porta do sistema multitarefas para computadores com sistema POSIX
+ * (Linux, macOS), usada para simular e medir o desempenho do nucleo fora
+ * do microcontrolador. As tarefas sao contextos ucontext, a marca de tempo
+ * e o sinal SIGALRM de um temporizador e as interrupcoes sao simuladas
+ * por uma variavel que indica se estao desabilitadas.
+ *
+ * O nucleo (rtos/nucleo) e o mesmo das placas; esta pasta e escolhida
+ * no caminho de inclusao da compilacao. Ver a linha de compilacao em
+ * host_posix/main.c.
+ */
+
+
+#ifndef CPU_PORT_H_
+#define CPU_PORT_H_
+
+#include <stdint.h>
+#include <signal.h>
+
+/* marcas de tempo virtuais: sem o SIGALRM, o tempo so anda quando a 
+   tarefa ociosa dorme (cfg_OCIOSA_SEM_MARCAS), e anda de uma vez ate o 
+   proximo despertar. Meses de marcas passam em segundos, para os testes 
+   de longa duracao (host_posix/longa_duracao.c). Exige 
+   cfg_OCIOSA_MIN_MARCAS = 1: com uma espera de 1 marca, a ociosa que nao 
+   dorme nao avanca o tempo. 1 habilita, 0 desabilita */
+#ifndef MARCAS_VIRTUAIS
+#define MARCAS_VIRTUAIS		0
+#endif
+
+/* configurar conforme processador*/
+/* no computador a pilha tambem guarda o contexto ucontext_t e as
+   chamadas da biblioteca C e do tratamento de sinais */
+#define TAM_MINIMO_PILHA  (4096)
+
+/* tipo do ponteiro de pilha: nesta porta, aponta para o contexto
+   da tarefa, guardado no topo da sua pilha */
+typedef uint32_t* stackptr_t;
+
+/* estado das interrupcoes simuladas: 1 = desabilitadas */
+typedef uint32_t reg_atomica_t;
+
+extern volatile sig_atomic_t interrupcoes_desabilitadas;
+
+reg_atomica_t SalvaEDesabilitaInterrupcoes(void);
+void RestauraInterrupcoes(reg_atomica_t estado);
+void SolicitaTrocaDeContexto(void);
+void IniciaPrimeiraTarefa(void);
+void InterrupcaoMarcaDeTempo(void);
+
+/* relogio em nanossegundos, tambem sem cfg_ESTATISTICAS (main.c, escala.c) */
+uint64_t TempoEmCiclos(void);
+
+/* macros dependentes de hardware */
+#define REG_ATOMICA_INICIO(estado)	  (estado) = SalvaEDesabilitaInterrupcoes()
+#define REG_ATOMICA_FIM(estado)		  RestauraInterrupcoes(estado)
+
+/* a troca acontece quando as interrupcoes forem habilitadas, como no PendSV */
+#define TROCA_CONTEXTO()		SolicitaTrocaDeContexto()
+#define TrocaContexto()		    TROCA_CONTEXTO()
+
+/* barreira de memoria para as estruturas sem regiao atomica (anel_t) */
+#define BARREIRA_MEMORIA()		__sync_synchronize()
+
+/* tarefas basicas: a tarefa usa os TAM_MINIMO_PILHA palavras abaixo do 
+   contexto (CriaContexto), e nao so ate o contexto como na placa */
+#define FIM_PILHA_USADA(sp)		((stackptr_t)(sp) - TAM_MINIMO_PILHA)
+
+/* variavel sem inicializacao na partida: no computador, uma variavel comum */
+#define NAO_INICIALIZADA
+
+/* variavel mantida entre resets: no computador, uma variavel comum */
+#define RETIDA
+
+/* funcao executada da RAM: no computador, uma funcao comum */
+#define FUNCAO_NA_RAM
+
+/* busca do bit mais significativo com a instrucao do processador */
+#define MAIOR_BIT_ATIVO(mapa)	((uint8_t)(31 - __builtin_clz(mapa)))
+
+#define GERA_INTERRUPCAO_SW()	IniciaPrimeiraTarefa()
+
+/* perfil estatistico (cfg_PERFIL): o tratamento do SIGALRM le o PC do 
+   contexto interrompido (Linux x86-64 e AArch64) */
+#define PERFIL_NA_PORTA			1
+
+/* frequencia da marca de tempo variavel (cfg_MARCA_VARIAVEL): 
+   MarcaTempoReprograma troca o periodo do setitimer */
+#define MARCA_VARIAVEL_NA_PORTA	1
+
+#endif /* CPU_PORT_H_ */
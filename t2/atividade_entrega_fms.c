@@ -1,13 +1,44 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // epoll e cfmakeraw com -std=c99
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
+
+#include "../comum/protocol_checksum.h"
+#include "../comum/protocol_frame.h"
+#include "../comum/protocol_bench.h"
+#include "../comum/protocol_trace.h"
+#include "../comum/protocol_capture.h"
+#include "../comum/protocol_test.h"  // verifica, verifica_tempo e executa_teste (minUnit)
+
+// Gateway de portas seriais com epoll (protocol_gateway_*): só no Linux
+#ifndef PROTOCOL_GATEWAY_LINUX
+#ifdef __linux__
+#define PROTOCOL_GATEWAY_LINUX 1
+#else
+#define PROTOCOL_GATEWAY_LINUX 0
+#endif
+#endif
+
+#if PROTOCOL_GATEWAY_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#endif
 
 // Protocol constants
 #define STX_BYTE 0x02
 #define ETX_BYTE 0x03
-#define MAX_DATA_SIZE 256
+#define MAX_DATA_SIZE 256         // Capacidade usada nos testes (QTD de 8 bits)
+#define MAX_DATA_SIZE_EXT 65535   // Maior QTD do modo estendido (16 bits)
 
 // Return codes
 #define PROTOCOL_SUCCESS 0
@@ -15,12 +46,6 @@
 #define PROTOCOL_WAITING -2
 #define PROTOCOL_INVALID_PARAM -3
 
-/* macros de testes - baseado em minUnit: www.jera.com/techinfo/jtns/jtn002.html */
-#define verifica(mensagem, teste) do { if (!(teste)) return mensagem; } while (0)
-#define executa_teste(teste) do { char *mensagem = teste(); testes_executados++; \
-                                if (mensagem) return mensagem; } while (0)
-int testes_executados = 0;
-
 // ========================================
 // PROTOCOL STATE MACHINE IMPLEMENTATION
 // ========================================
@@ -28,6 +53,7 @@ int testes_executados = 0;
 typedef enum {
     STATE_WAIT_STX,     // Aguardando STX (0x02)
     STATE_WAIT_QTD,     // Aguardando quantidade de dados
+    STATE_WAIT_QTD_LOW, // Aguardando o byte baixo da quantidade (modo estendido)
     STATE_WAIT_DATA,    // Aguardando dados
     STATE_WAIT_CHK,     // Aguardando checksum
     STATE_WAIT_ETX,     // Aguardando ETX (0x03)
@@ -35,30 +61,617 @@ typedef enum {
     STATE_MESSAGE_ERROR // Erro na mensagem
 } ProtocolState;
 
+// Integridade do campo CHK, escolhida por handler: a soma de 8 bits original
+// ou um CRC, calculados sobre os dados. O CRC é enviado com o byte alto
+// primeiro, como o QTD do modo estendido
+typedef enum {
+    PROTOCOL_SUM8 = 0,  // Soma de 8 bits, CHK de 1 byte (padrão)
+    PROTOCOL_CRC16,     // CRC-16/CCITT-FALSE, CHK de 2 bytes
+    PROTOCOL_CRC32      // CRC-32 (IEEE 802.3), CHK de 4 bytes
+} ProtocolIntegrity;
+
+// Caça: bytes guardados ainda por reexaminar depois de uma mensagem
+// encontrada dentro da corrompida, dados[inicio..fim) seguidos da cauda
+typedef struct {
+    uint16_t inicio;
+    uint16_t fim;
+    uint8_t cauda[5];          // CHK e o byte no lugar do ETX
+    uint8_t cauda_count;
+} ProtocolPending;
+
+// Contadores de qualidade do enlace, de 32 bits (voltam a zero ao estourar;
+// use a diferença entre duas leituras). Mantidos pelos parsers sem custo
+// por byte nos parsers de bloco: os bytes são somados a cada retorno
+typedef struct {
+    uint32_t quadros_ok;       // Mensagens válidas entregues
+    uint32_t erros_chk;        // CHK diferente do calculado
+    uint32_t erros_etx;        // Byte no lugar do ETX diferente de ETX
+    uint32_t qtd_zero;         // Mensagens com QTD zero
+    uint32_t qtd_grande;       // QTD maior que a capacidade
+    uint32_t descartados;      // Bytes descartados procurando o STX
+    uint32_t bytes;            // Bytes processados
+} ProtocolStats;
+
+// A área de dados é do chamador, com a capacidade de cada enlace: um enlace
+// de mensagens curtas não reserva 256 bytes. No modo estendido o QTD tem 16
+// bits (byte alto primeiro), para transferências grandes sem fragmentação.
+// Mensagens maiores que a capacidade são descartadas.
 typedef struct {
-    ProtocolState state;        // Estado atual
-    uint8_t qtd_dados;         // Quantidade esperada de dados
-    uint8_t dados[MAX_DATA_SIZE]; // Buffer para dados recebidos
-    uint8_t dados_count;       // Contador de dados recebidos
-    uint8_t checksum_recv;     // Checksum recebido
-    uint8_t checksum_calc;     // Checksum calculado
+    uint8_t* dados;            // Buffer para dados recebidos (capacidade bytes)
+    uint16_t capacidade;       // Tamanho da área de dados
+    uint16_t qtd_dados;        // Quantidade esperada de dados
+    uint16_t dados_count;      // Contador de dados recebidos
+    uint32_t checksum_recv;    // CHK recebido
+    uint32_t checksum_calc;    // Soma ou CRC calculado até aqui
+    uint8_t state;             // Estado atual (ProtocolState)
+    uint8_t integridade;       // Modo do CHK (ProtocolIntegrity)
+    uint8_t chk_count;         // Bytes do CHK recebidos
     bool message_ready;        // Flag de mensagem pronta
+    bool qtd_16_bits;          // Modo estendido: QTD de 2 bytes
+    bool ressincroniza;        // Caça: após um erro, reexamina os bytes recebidos
+    ProtocolPending pendente;  // Caça: bytes ainda por reexaminar
+    ProtocolStats estatisticas;
 } ProtocolHandler;
 
+// Declara um handler com área própria de capacidade bytes, a ser iniciado
+// com protocol_init
+#define PROTOCOL_HANDLER(nome, cap) \
+    uint8_t nome##_area[cap]; \
+    ProtocolHandler nome = { .dados = nome##_area, .capacidade = (cap) }
+
+// Mensagem recebida sem cópia: aponta para o bloco do chamador, ou para a
+// área de reserva quando a mensagem chegou dividida entre blocos
+typedef struct {
+    const uint8_t* data;       // Dados da mensagem
+    uint16_t len;              // Quantidade de dados
+} ProtocolFrame;
+
+typedef struct {
+    const uint8_t* dados;      // Início dos dados no bloco atual
+    uint8_t* reserva;          // Área do chamador, só para mensagens divididas
+    uint16_t capacidade;       // Tamanho da reserva
+    uint16_t qtd_dados;        // Quantidade esperada de dados
+    uint16_t dados_count;      // Contador de dados recebidos
+    uint32_t checksum_recv;    // CHK recebido
+    uint32_t checksum_calc;    // Soma ou CRC calculado até aqui
+    uint8_t state;             // Estado atual (ProtocolState)
+    uint8_t integridade;       // Modo do CHK (ProtocolIntegrity)
+    uint8_t chk_count;         // Bytes do CHK recebidos
+    bool copiado;              // Dados já copiados para a reserva
+    bool qtd_16_bits;          // Modo estendido: QTD de 2 bytes
+    bool ressincroniza;        // Caça: após um erro, reexamina os bytes recebidos
+    ProtocolPending pendente;  // Caça: bytes ainda por reexaminar
+    ProtocolStats estatisticas;
+} ProtocolViewHandler;
+
+// Conjunto de canais (ex.: as portas seriais de um gateway) atendidos por um
+// só parser: o estado quente de cada canal fica em vetores, um por campo,
+// sem área própria. Os dados vêm de blocos compartilhados de capacidade
+// bytes, tomados quando o canal recebe dados e devolvidos quando ele volta
+// a aguardar mensagem; só os canais no meio de uma mensagem (ou com uma
+// mensagem entregue) ocupam um bloco. A capacidade, o QTD e o CHK são os
+// mesmos em todos os canais; a caça (protocol_set_resync) e as estatísticas
+// não são usadas
+typedef struct {
+    uint8_t* state;            // Estado de cada canal (ProtocolState)
+    uint8_t* chk_count;        // Bytes do CHK recebidos
+    uint16_t* qtd_dados;       // Quantidade esperada de dados
+    uint16_t* dados_count;     // Contador de dados recebidos
+    uint32_t* checksum_recv;   // CHK recebido
+    uint32_t* checksum_calc;   // Soma ou CRC calculado até aqui
+    uint8_t** dados;           // Bloco de cada canal (NULL: nenhum)
+    void** blocos;             // Área dos blocos
+    void* livres;              // Primeiro bloco livre (cada um guarda o endereço do seguinte)
+    uint16_t canais;
+    uint16_t numero_blocos;
+    uint16_t blocos_livres;
+    uint16_t capacidade;       // Tamanho de cada bloco
+    uint8_t integridade;       // Modo do CHK (ProtocolIntegrity)
+    bool qtd_16_bits;          // Modo estendido: QTD de 2 bytes
+} ProtocolPool;
+
+// Bloco de capacidade bytes, arredondado para guardar o encadeamento
+#define PROTOCOL_POOL_BLOCO(cap) ((((cap) + sizeof(void*) - 1) / sizeof(void*)) * sizeof(void*))
+
+// Declara um conjunto de n_canais canais com n_blocos blocos de cap bytes,
+// a ser iniciado com protocol_pool_init
+#define PROTOCOL_POOL(nome, n_canais, n_blocos, cap) \
+    uint8_t nome##_state[n_canais], nome##_chk_count[n_canais]; \
+    uint16_t nome##_qtd_dados[n_canais], nome##_dados_count[n_canais]; \
+    uint32_t nome##_checksum_recv[n_canais], nome##_checksum_calc[n_canais]; \
+    uint8_t* nome##_dados[n_canais]; \
+    void* nome##_blocos[((n_blocos) * PROTOCOL_POOL_BLOCO(cap)) / sizeof(void*)]; \
+    ProtocolPool nome = { .state = nome##_state, .chk_count = nome##_chk_count, \
+                          .qtd_dados = nome##_qtd_dados, .dados_count = nome##_dados_count, \
+                          .checksum_recv = nome##_checksum_recv, .checksum_calc = nome##_checksum_calc, \
+                          .dados = nome##_dados, .blocos = nome##_blocos, .canais = (n_canais), \
+                          .numero_blocos = (n_blocos), .capacidade = (cap) }
+
+// Fragmento dos dados de uma mensagem montada por partes (ex.: um cabeçalho
+// e o bloco de um sensor), com os campos de struct iovec, que a biblioteca
+// do microcontrolador não tem
+typedef struct {
+    const void* iov_base;      // Início do fragmento
+    size_t iov_len;            // Tamanho do fragmento (0: ignorado)
+} ProtocolIovec;
+
+// Mensagem montada em partes (protocol_encoder_*): o QTD vai no início, os
+// dados são contados e o CHK é acumulado trecho a trecho
+typedef struct {
+    uint32_t chk;              // Soma ou CRC dos dados até aqui
+    uint16_t qtd;              // Quantidade de dados da mensagem (0: encerrada)
+    uint16_t restantes;        // Dados ainda por acrescentar
+    uint8_t integridade;       // Modo do CHK (ProtocolIntegrity)
+} ProtocolEncoder;
+
+// Mensagem fixa enviada periodicamente (ex.: um quadro de estado), montada
+// uma vez no buffer do chamador. Só os campos que mudam são reescritos, e o
+// CHK é corrigido pela diferença, sem refazer a soma ou o CRC dos dados
+typedef struct {
+    uint8_t* quadro;           // Mensagem montada (STX .. ETX)
+    size_t tamanho;            // Tamanho da mensagem
+    uint16_t qtd;              // Quantidade de dados
+    uint8_t inicio;            // Posição do primeiro dado no quadro
+    uint8_t integridade;       // Modo do CHK (ProtocolIntegrity)
+    uint32_t chk;              // CHK atual
+} ProtocolTemplate;
+
+// Campo de um modelo, preparado uma vez por protocol_template_field
+typedef struct {
+    uint16_t posicao;          // Primeiro byte do campo, nos dados
+    uint16_t tamanho;          // Bytes do campo
+    uint32_t avanco;           // CRC: x^(8 * bytes após o campo) mod P
+} ProtocolTemplateField;
+
+// Mensagem entregue por protocol_pool_process, com o canal de origem
+typedef void (*ProtocolPoolCallback)(void* contexto, uint16_t canal, const ProtocolFrame* frame);
+
+// Modo COBS (Consistent Overhead Byte Stuffing): dados + CHK codificados sem
+// nenhum byte 0x00, que fica só como delimitador no fim de cada quadro. Não
+// há STX, QTD nem ETX: um dado igual a STX não parece início de quadro e,
+// após um erro, o receptor volta a sincronizar no próximo 0x00, sem
+// depender do QTD. Custo de um byte a cada 254 dados, mais o delimitador
+#define PROTOCOL_COBS_DELIMITADOR 0x00
+#define PROTOCOL_COBS_TAMANHO(n) ((size_t)(n) + (size_t)(n) / 254u + 2u)  // Quadro de n bytes (dados + CHK)
+
+// Decodificador COBS por blocos: os dados decodificados (dados + CHK) vão
+// para a área do chamador, de capacidade bytes
+typedef struct {
+    uint8_t* dados;            // Área dos dados decodificados
+    uint16_t capacidade;       // Tamanho da área (dados + CHK)
+    uint16_t dados_count;      // Bytes decodificados do quadro atual
+    uint8_t restantes;         // Bytes ainda por copiar do grupo atual
+    uint8_t integridade;       // Modo do CHK (ProtocolIntegrity)
+    bool zero;                 // O grupo atual termina com um 0x00 implícito
+    bool em_quadro;            // Já recebeu o primeiro código do quadro
+    bool descartando;          // Quadro inválido: descarta até o delimitador
+    ProtocolStats estatisticas;  // erros_etx: quadro terminado no meio de um grupo
+} ProtocolCobsHandler;
+
+#if PROTOCOL_GATEWAY_LINUX
+// Eventos tratados por epoll_wait, e blocos lidos de uma porta por evento,
+// para uma porta rápida não atrasar as demais
+#define PROTOCOL_GATEWAY_EVENTOS 64
+#define PROTOCOL_GATEWAY_LEITURAS 4
+
+typedef struct {
+    uint64_t bytes_lidos;
+    uint64_t bytes_escritos;
+    uint32_t leituras;         // Chamadas de read com dados
+    uint32_t escritas;         // Chamadas de write com dados
+    uint32_t mensagens;        // Entregues ao callback
+    uint32_t envios_recusados; // Área de envio da porta cheia
+    uint32_t portas_fechadas;  // Fim de arquivo ou erro de leitura
+} ProtocolGatewayStats;
+
+// Gateway no computador: centenas de portas seriais ou USB CDC
+// (/dev/ttyACM*) atendidas por um epoll e um ProtocolPool (um canal por
+// porta). Cada porta pronta é lida em blocos, sem bloquear, direto para o
+// parser de bloco; as mensagens enviadas às portas numa rodada são
+// codificadas na área de envio de cada uma e saem juntas, num write por
+// porta
+typedef struct {
+    ProtocolPool* pool;        // Canal de cada porta
+    int* fds;                  // Descritor de cada porta (-1: livre)
+    uint8_t* saida;            // Áreas de envio, tam_saida bytes por porta
+    uint32_t* pendentes;       // Bytes por enviar de cada porta
+    uint16_t* fila;            // Portas com envios pendentes
+    bool* armada;              // Porta esperando EPOLLOUT
+    uint8_t* leitura;          // Bloco de leitura
+    size_t tam_saida;
+    size_t tam_leitura;
+    uint16_t na_fila;
+    int epoll;
+    ProtocolPoolCallback callback;
+    void* contexto;
+    ProtocolCapture* captura;  // Grava cada bloco lido (NULL: sem captura)
+    ProtocolGatewayStats estatisticas;
+} ProtocolGateway;
+
+// Declara um gateway de n_portas portas, com n_blocos blocos de cap bytes
+// para as mensagens em recepção, n_saida bytes de envio por porta e um
+// bloco de leitura de n_leitura bytes, a ser iniciado com
+// protocol_gateway_init
+#define PROTOCOL_GATEWAY(nome, n_portas, n_blocos, cap, n_saida, n_leitura) \
+    PROTOCOL_POOL(nome##_pool, n_portas, n_blocos, cap); \
+    int nome##_fds[n_portas]; \
+    uint8_t nome##_saida[(size_t)(n_portas) * (n_saida)]; \
+    uint32_t nome##_pendentes[n_portas]; \
+    uint16_t nome##_fila[n_portas]; \
+    bool nome##_armada[n_portas]; \
+    uint8_t nome##_leitura[n_leitura]; \
+    ProtocolGateway nome = { .pool = &nome##_pool, .fds = nome##_fds, .saida = nome##_saida, \
+                             .pendentes = nome##_pendentes, .fila = nome##_fila, .armada = nome##_armada, \
+                             .leitura = nome##_leitura, .tam_saida = (n_saida), .tam_leitura = (n_leitura), \
+                             .epoll = -1 }
+#endif
+
 // Function declarations
 void protocol_init(ProtocolHandler* handler);
+void protocol_init_area(ProtocolHandler* handler, uint8_t* area, uint16_t capacidade, bool qtd_16_bits);
 int protocol_process_byte(ProtocolHandler* handler, uint8_t byte);
+int protocol_process_buffer(ProtocolHandler* handler, const uint8_t* buf, size_t len, size_t* consumed);
 int protocol_create_message(uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size);
-uint8_t protocol_calculate_checksum(uint8_t* dados, uint8_t qtd);
+int protocol_create_extended_message(const uint8_t* dados, uint16_t qtd, uint8_t* buffer, size_t* buffer_size);
+uint8_t protocol_calculate_checksum(uint8_t* dados, uint16_t qtd);
+uint32_t protocol_calculate_integrity(ProtocolIntegrity modo, const uint8_t* dados, size_t qtd);
+int protocol_create_frame(const uint8_t* dados, uint16_t qtd, bool qtd_16_bits, ProtocolIntegrity modo,
+                          uint8_t* buffer, size_t* buffer_size);
+int protocol_create_message_v(const ProtocolIovec* iov, int n, bool qtd_16_bits, ProtocolIntegrity modo,
+                              uint8_t* buffer, size_t* buffer_size);
+int protocol_create_envelope_v(const ProtocolIovec* iov, int n, bool qtd_16_bits, ProtocolIntegrity modo,
+                               uint8_t* cabeca, size_t* tam_cabeca, uint8_t* cauda, size_t* tam_cauda);
+int protocol_encoder_begin(ProtocolEncoder* enc, uint16_t qtd, bool qtd_16_bits, ProtocolIntegrity modo,
+                           uint8_t* saida, size_t* tamanho);
+int protocol_encoder_append(ProtocolEncoder* enc, const uint8_t* dados, size_t n, uint8_t* saida, size_t* tamanho);
+int protocol_encoder_finish(ProtocolEncoder* enc, uint8_t* saida, size_t* tamanho);
+int protocol_template_init(ProtocolTemplate* t, const uint8_t* dados, uint16_t qtd, bool qtd_16_bits,
+                           ProtocolIntegrity modo, uint8_t* buffer, size_t* buffer_size);
+int protocol_template_field(const ProtocolTemplate* t, uint16_t posicao, uint16_t tamanho,
+                            ProtocolTemplateField* campo);
+int protocol_template_patch(ProtocolTemplate* t, const ProtocolTemplateField* campo, const void* valor);
+void protocol_set_integrity(ProtocolHandler* handler, ProtocolIntegrity modo);
+void protocol_set_resync(ProtocolHandler* handler, bool ligada);
+void protocol_get_stats(const ProtocolHandler* handler, ProtocolStats* copia);
+void protocol_reset_stats(ProtocolHandler* handler);
 bool protocol_message_ready(ProtocolHandler* handler);
 void protocol_reset(ProtocolHandler* handler);
 uint8_t* protocol_get_data(ProtocolHandler* handler);
-uint8_t protocol_get_data_count(ProtocolHandler* handler);
+uint16_t protocol_get_data_count(ProtocolHandler* handler);
+void protocol_view_init(ProtocolViewHandler* handler, uint8_t* reserva, uint16_t capacidade, bool qtd_16_bits);
+int protocol_process_view(ProtocolViewHandler* handler, const uint8_t* buf, size_t len, size_t* consumed,
+                          ProtocolFrame* frame);
+void protocol_view_set_integrity(ProtocolViewHandler* handler, ProtocolIntegrity modo);
+void protocol_view_set_resync(ProtocolViewHandler* handler, bool ligada);
+void protocol_view_get_stats(const ProtocolViewHandler* handler, ProtocolStats* copia);
+void protocol_view_reset_stats(ProtocolViewHandler* handler);
+void protocol_pool_init(ProtocolPool* pool, bool qtd_16_bits, ProtocolIntegrity modo);
+int protocol_pool_process_buffer(ProtocolPool* pool, uint16_t canal, const uint8_t* buf, size_t len, size_t* consumed,
+                                 ProtocolFrame* frame);
+size_t protocol_pool_process(ProtocolPool* pool, const uint8_t* const* blocos, const size_t* tamanhos,
+                             ProtocolPoolCallback callback, void* contexto);
+int protocol_create_cobs_frame(const uint8_t* dados, uint16_t qtd, ProtocolIntegrity modo,
+                               uint8_t* buffer, size_t* buffer_size);
+void protocol_cobs_init(ProtocolCobsHandler* handler, uint8_t* area, uint16_t capacidade, ProtocolIntegrity modo);
+int protocol_cobs_process_buffer(ProtocolCobsHandler* handler, const uint8_t* buf, size_t len, size_t* consumed,
+                                 ProtocolFrame* frame);
+#if PROTOCOL_GATEWAY_LINUX
+int protocol_gateway_init(ProtocolGateway* gw, bool qtd_16_bits, ProtocolIntegrity modo,
+                          ProtocolPoolCallback callback, void* contexto);
+int protocol_gateway_add_fd(ProtocolGateway* gw, int fd);
+int protocol_gateway_open(ProtocolGateway* gw, const char* caminho, speed_t velocidade);
+void protocol_gateway_close(ProtocolGateway* gw, uint16_t porta);
+int protocol_gateway_send(ProtocolGateway* gw, uint16_t porta, const uint8_t* dados, uint16_t qtd);
+int protocol_gateway_flush(ProtocolGateway* gw);
+int protocol_gateway_poll(ProtocolGateway* gw, int timeout_ms);
+void protocol_gateway_shutdown(ProtocolGateway* gw);
+void protocol_gateway_capture(ProtocolGateway* gw, ProtocolCapture* captura);
+#endif
+
+// ========================================
+// INTEGRITY (SUM8 / CRC)
+// ========================================
+
+// Tabelas constantes (na flash do microcontrolador), para slice-by-2 no
+// CRC-16 e slice-by-4 no CRC-32: a tabela k avança o CRC de um byte seguido
+// de k bytes nulos, e assim cada passo do laço consome 2 ou 4 bytes com uma
+// consulta por byte, sem a dependência serial de um byte por vez
+static const uint16_t crc16_tabela[2][256] = {
+    {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B,
+        0xC18C, 0xD1AD, 0xE1CE, 0xF1EF, 0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+        0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE, 0x2462, 0x3443, 0x0420, 0x1401,
+        0x64E6, 0x74C7, 0x44A4, 0x5485, 0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+        0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4, 0xB75B, 0xA77A, 0x9719, 0x8738,
+        0xF7DF, 0xE7FE, 0xD79D, 0xC7BC, 0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+        0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B, 0x5AF5, 0x4AD4, 0x7AB7, 0x6A96,
+        0x1A71, 0x0A50, 0x3A33, 0x2A12, 0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+        0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41, 0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD,
+        0xAD2A, 0xBD0B, 0x8D68, 0x9D49, 0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+        0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78, 0x9188, 0x81A9, 0xB1CA, 0xA1EB,
+        0xD10C, 0xC12D, 0xF14E, 0xE16F, 0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+        0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E, 0x02B1, 0x1290, 0x22F3, 0x32D2,
+        0x4235, 0x5214, 0x6277, 0x7256, 0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+        0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405, 0xA7DB, 0xB7FA, 0x8799, 0x97B8,
+        0xE75F, 0xF77E, 0xC71D, 0xD73C, 0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+        0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB, 0x5844, 0x4865, 0x7806, 0x6827,
+        0x18C0, 0x08E1, 0x3882, 0x28A3, 0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+        0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92, 0xFD2E, 0xED0F, 0xDD6C, 0xCD4D,
+        0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9, 0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+        0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8, 0x6E17, 0x7E36, 0x4E55, 0x5E74,
+        0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+    },
+    {
+        0x0000, 0x3331, 0x6662, 0x5553, 0xCCC4, 0xFFF5, 0xAAA6, 0x9997, 0x89A9, 0xBA98, 0xEFCB, 0xDCFA,
+        0x456D, 0x765C, 0x230F, 0x103E, 0x0373, 0x3042, 0x6511, 0x5620, 0xCFB7, 0xFC86, 0xA9D5, 0x9AE4,
+        0x8ADA, 0xB9EB, 0xECB8, 0xDF89, 0x461E, 0x752F, 0x207C, 0x134D, 0x06E6, 0x35D7, 0x6084, 0x53B5,
+        0xCA22, 0xF913, 0xAC40, 0x9F71, 0x8F4F, 0xBC7E, 0xE92D, 0xDA1C, 0x438B, 0x70BA, 0x25E9, 0x16D8,
+        0x0595, 0x36A4, 0x63F7, 0x50C6, 0xC951, 0xFA60, 0xAF33, 0x9C02, 0x8C3C, 0xBF0D, 0xEA5E, 0xD96F,
+        0x40F8, 0x73C9, 0x269A, 0x15AB, 0x0DCC, 0x3EFD, 0x6BAE, 0x589F, 0xC108, 0xF239, 0xA76A, 0x945B,
+        0x8465, 0xB754, 0xE207, 0xD136, 0x48A1, 0x7B90, 0x2EC3, 0x1DF2, 0x0EBF, 0x3D8E, 0x68DD, 0x5BEC,
+        0xC27B, 0xF14A, 0xA419, 0x9728, 0x8716, 0xB427, 0xE174, 0xD245, 0x4BD2, 0x78E3, 0x2DB0, 0x1E81,
+        0x0B2A, 0x381B, 0x6D48, 0x5E79, 0xC7EE, 0xF4DF, 0xA18C, 0x92BD, 0x8283, 0xB1B2, 0xE4E1, 0xD7D0,
+        0x4E47, 0x7D76, 0x2825, 0x1B14, 0x0859, 0x3B68, 0x6E3B, 0x5D0A, 0xC49D, 0xF7AC, 0xA2FF, 0x91CE,
+        0x81F0, 0xB2C1, 0xE792, 0xD4A3, 0x4D34, 0x7E05, 0x2B56, 0x1867, 0x1B98, 0x28A9, 0x7DFA, 0x4ECB,
+        0xD75C, 0xE46D, 0xB13E, 0x820F, 0x9231, 0xA100, 0xF453, 0xC762, 0x5EF5, 0x6DC4, 0x3897, 0x0BA6,
+        0x18EB, 0x2BDA, 0x7E89, 0x4DB8, 0xD42F, 0xE71E, 0xB24D, 0x817C, 0x9142, 0xA273, 0xF720, 0xC411,
+        0x5D86, 0x6EB7, 0x3BE4, 0x08D5, 0x1D7E, 0x2E4F, 0x7B1C, 0x482D, 0xD1BA, 0xE28B, 0xB7D8, 0x84E9,
+        0x94D7, 0xA7E6, 0xF2B5, 0xC184, 0x5813, 0x6B22, 0x3E71, 0x0D40, 0x1E0D, 0x2D3C, 0x786F, 0x4B5E,
+        0xD2C9, 0xE1F8, 0xB4AB, 0x879A, 0x97A4, 0xA495, 0xF1C6, 0xC2F7, 0x5B60, 0x6851, 0x3D02, 0x0E33,
+        0x1654, 0x2565, 0x7036, 0x4307, 0xDA90, 0xE9A1, 0xBCF2, 0x8FC3, 0x9FFD, 0xACCC, 0xF99F, 0xCAAE,
+        0x5339, 0x6008, 0x355B, 0x066A, 0x1527, 0x2616, 0x7345, 0x4074, 0xD9E3, 0xEAD2, 0xBF81, 0x8CB0,
+        0x9C8E, 0xAFBF, 0xFAEC, 0xC9DD, 0x504A, 0x637B, 0x3628, 0x0519, 0x10B2, 0x2383, 0x76D0, 0x45E1,
+        0xDC76, 0xEF47, 0xBA14, 0x8925, 0x991B, 0xAA2A, 0xFF79, 0xCC48, 0x55DF, 0x66EE, 0x33BD, 0x008C,
+        0x13C1, 0x20F0, 0x75A3, 0x4692, 0xDF05, 0xEC34, 0xB967, 0x8A56, 0x9A68, 0xA959, 0xFC0A, 0xCF3B,
+        0x56AC, 0x659D, 0x30CE, 0x03FF
+    }
+};
+
+static const uint32_t crc32_tabela[4][256] = {
+    {
+        0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
+        0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
+        0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2,
+        0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+        0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9,
+        0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172,
+        0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
+        0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+        0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423,
+        0xCFBA9599, 0xB8BDA50F, 0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924,
+        0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D, 0x76DC4190, 0x01DB7106,
+        0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+        0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D,
+        0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
+        0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950,
+        0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+        0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7,
+        0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0,
+        0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9, 0x5005713C, 0x270241AA,
+        0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+        0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
+        0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A,
+        0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84,
+        0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+        0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB,
+        0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC,
+        0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8, 0xA1D1937E,
+        0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+        0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55,
+        0x316E8EEF, 0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236,
+        0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28,
+        0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+        0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F,
+        0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38,
+        0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
+        0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+        0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69,
+        0x616BFFD3, 0x166CCF45, 0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2,
+        0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC,
+        0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+        0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693,
+        0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
+        0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+    },
+    {
+        0x00000000, 0x191B3141, 0x32366282, 0x2B2D53C3, 0x646CC504, 0x7D77F445,
+        0x565AA786, 0x4F4196C7, 0xC8D98A08, 0xD1C2BB49, 0xFAEFE88A, 0xE3F4D9CB,
+        0xACB54F0C, 0xB5AE7E4D, 0x9E832D8E, 0x87981CCF, 0x4AC21251, 0x53D92310,
+        0x78F470D3, 0x61EF4192, 0x2EAED755, 0x37B5E614, 0x1C98B5D7, 0x05838496,
+        0x821B9859, 0x9B00A918, 0xB02DFADB, 0xA936CB9A, 0xE6775D5D, 0xFF6C6C1C,
+        0xD4413FDF, 0xCD5A0E9E, 0x958424A2, 0x8C9F15E3, 0xA7B24620, 0xBEA97761,
+        0xF1E8E1A6, 0xE8F3D0E7, 0xC3DE8324, 0xDAC5B265, 0x5D5DAEAA, 0x44469FEB,
+        0x6F6BCC28, 0x7670FD69, 0x39316BAE, 0x202A5AEF, 0x0B07092C, 0x121C386D,
+        0xDF4636F3, 0xC65D07B2, 0xED705471, 0xF46B6530, 0xBB2AF3F7, 0xA231C2B6,
+        0x891C9175, 0x9007A034, 0x179FBCFB, 0x0E848DBA, 0x25A9DE79, 0x3CB2EF38,
+        0x73F379FF, 0x6AE848BE, 0x41C51B7D, 0x58DE2A3C, 0xF0794F05, 0xE9627E44,
+        0xC24F2D87, 0xDB541CC6, 0x94158A01, 0x8D0EBB40, 0xA623E883, 0xBF38D9C2,
+        0x38A0C50D, 0x21BBF44C, 0x0A96A78F, 0x138D96CE, 0x5CCC0009, 0x45D73148,
+        0x6EFA628B, 0x77E153CA, 0xBABB5D54, 0xA3A06C15, 0x888D3FD6, 0x91960E97,
+        0xDED79850, 0xC7CCA911, 0xECE1FAD2, 0xF5FACB93, 0x7262D75C, 0x6B79E61D,
+        0x4054B5DE, 0x594F849F, 0x160E1258, 0x0F152319, 0x243870DA, 0x3D23419B,
+        0x65FD6BA7, 0x7CE65AE6, 0x57CB0925, 0x4ED03864, 0x0191AEA3, 0x188A9FE2,
+        0x33A7CC21, 0x2ABCFD60, 0xAD24E1AF, 0xB43FD0EE, 0x9F12832D, 0x8609B26C,
+        0xC94824AB, 0xD05315EA, 0xFB7E4629, 0xE2657768, 0x2F3F79F6, 0x362448B7,
+        0x1D091B74, 0x04122A35, 0x4B53BCF2, 0x52488DB3, 0x7965DE70, 0x607EEF31,
+        0xE7E6F3FE, 0xFEFDC2BF, 0xD5D0917C, 0xCCCBA03D, 0x838A36FA, 0x9A9107BB,
+        0xB1BC5478, 0xA8A76539, 0x3B83984B, 0x2298A90A, 0x09B5FAC9, 0x10AECB88,
+        0x5FEF5D4F, 0x46F46C0E, 0x6DD93FCD, 0x74C20E8C, 0xF35A1243, 0xEA412302,
+        0xC16C70C1, 0xD8774180, 0x9736D747, 0x8E2DE606, 0xA500B5C5, 0xBC1B8484,
+        0x71418A1A, 0x685ABB5B, 0x4377E898, 0x5A6CD9D9, 0x152D4F1E, 0x0C367E5F,
+        0x271B2D9C, 0x3E001CDD, 0xB9980012, 0xA0833153, 0x8BAE6290, 0x92B553D1,
+        0xDDF4C516, 0xC4EFF457, 0xEFC2A794, 0xF6D996D5, 0xAE07BCE9, 0xB71C8DA8,
+        0x9C31DE6B, 0x852AEF2A, 0xCA6B79ED, 0xD37048AC, 0xF85D1B6F, 0xE1462A2E,
+        0x66DE36E1, 0x7FC507A0, 0x54E85463, 0x4DF36522, 0x02B2F3E5, 0x1BA9C2A4,
+        0x30849167, 0x299FA026, 0xE4C5AEB8, 0xFDDE9FF9, 0xD6F3CC3A, 0xCFE8FD7B,
+        0x80A96BBC, 0x99B25AFD, 0xB29F093E, 0xAB84387F, 0x2C1C24B0, 0x350715F1,
+        0x1E2A4632, 0x07317773, 0x4870E1B4, 0x516BD0F5, 0x7A468336, 0x635DB277,
+        0xCBFAD74E, 0xD2E1E60F, 0xF9CCB5CC, 0xE0D7848D, 0xAF96124A, 0xB68D230B,
+        0x9DA070C8, 0x84BB4189, 0x03235D46, 0x1A386C07, 0x31153FC4, 0x280E0E85,
+        0x674F9842, 0x7E54A903, 0x5579FAC0, 0x4C62CB81, 0x8138C51F, 0x9823F45E,
+        0xB30EA79D, 0xAA1596DC, 0xE554001B, 0xFC4F315A, 0xD7626299, 0xCE7953D8,
+        0x49E14F17, 0x50FA7E56, 0x7BD72D95, 0x62CC1CD4, 0x2D8D8A13, 0x3496BB52,
+        0x1FBBE891, 0x06A0D9D0, 0x5E7EF3EC, 0x4765C2AD, 0x6C48916E, 0x7553A02F,
+        0x3A1236E8, 0x230907A9, 0x0824546A, 0x113F652B, 0x96A779E4, 0x8FBC48A5,
+        0xA4911B66, 0xBD8A2A27, 0xF2CBBCE0, 0xEBD08DA1, 0xC0FDDE62, 0xD9E6EF23,
+        0x14BCE1BD, 0x0DA7D0FC, 0x268A833F, 0x3F91B27E, 0x70D024B9, 0x69CB15F8,
+        0x42E6463B, 0x5BFD777A, 0xDC656BB5, 0xC57E5AF4, 0xEE530937, 0xF7483876,
+        0xB809AEB1, 0xA1129FF0, 0x8A3FCC33, 0x9324FD72
+    },
+    {
+        0x00000000, 0x01C26A37, 0x0384D46E, 0x0246BE59, 0x0709A8DC, 0x06CBC2EB,
+        0x048D7CB2, 0x054F1685, 0x0E1351B8, 0x0FD13B8F, 0x0D9785D6, 0x0C55EFE1,
+        0x091AF964, 0x08D89353, 0x0A9E2D0A, 0x0B5C473D, 0x1C26A370, 0x1DE4C947,
+        0x1FA2771E, 0x1E601D29, 0x1B2F0BAC, 0x1AED619B, 0x18ABDFC2, 0x1969B5F5,
+        0x1235F2C8, 0x13F798FF, 0x11B126A6, 0x10734C91, 0x153C5A14, 0x14FE3023,
+        0x16B88E7A, 0x177AE44D, 0x384D46E0, 0x398F2CD7, 0x3BC9928E, 0x3A0BF8B9,
+        0x3F44EE3C, 0x3E86840B, 0x3CC03A52, 0x3D025065, 0x365E1758, 0x379C7D6F,
+        0x35DAC336, 0x3418A901, 0x3157BF84, 0x3095D5B3, 0x32D36BEA, 0x331101DD,
+        0x246BE590, 0x25A98FA7, 0x27EF31FE, 0x262D5BC9, 0x23624D4C, 0x22A0277B,
+        0x20E69922, 0x2124F315, 0x2A78B428, 0x2BBADE1F, 0x29FC6046, 0x283E0A71,
+        0x2D711CF4, 0x2CB376C3, 0x2EF5C89A, 0x2F37A2AD, 0x709A8DC0, 0x7158E7F7,
+        0x731E59AE, 0x72DC3399, 0x7793251C, 0x76514F2B, 0x7417F172, 0x75D59B45,
+        0x7E89DC78, 0x7F4BB64F, 0x7D0D0816, 0x7CCF6221, 0x798074A4, 0x78421E93,
+        0x7A04A0CA, 0x7BC6CAFD, 0x6CBC2EB0, 0x6D7E4487, 0x6F38FADE, 0x6EFA90E9,
+        0x6BB5866C, 0x6A77EC5B, 0x68315202, 0x69F33835, 0x62AF7F08, 0x636D153F,
+        0x612BAB66, 0x60E9C151, 0x65A6D7D4, 0x6464BDE3, 0x662203BA, 0x67E0698D,
+        0x48D7CB20, 0x4915A117, 0x4B531F4E, 0x4A917579, 0x4FDE63FC, 0x4E1C09CB,
+        0x4C5AB792, 0x4D98DDA5, 0x46C49A98, 0x4706F0AF, 0x45404EF6, 0x448224C1,
+        0x41CD3244, 0x400F5873, 0x4249E62A, 0x438B8C1D, 0x54F16850, 0x55330267,
+        0x5775BC3E, 0x56B7D609, 0x53F8C08C, 0x523AAABB, 0x507C14E2, 0x51BE7ED5,
+        0x5AE239E8, 0x5B2053DF, 0x5966ED86, 0x58A487B1, 0x5DEB9134, 0x5C29FB03,
+        0x5E6F455A, 0x5FAD2F6D, 0xE1351B80, 0xE0F771B7, 0xE2B1CFEE, 0xE373A5D9,
+        0xE63CB35C, 0xE7FED96B, 0xE5B86732, 0xE47A0D05, 0xEF264A38, 0xEEE4200F,
+        0xECA29E56, 0xED60F461, 0xE82FE2E4, 0xE9ED88D3, 0xEBAB368A, 0xEA695CBD,
+        0xFD13B8F0, 0xFCD1D2C7, 0xFE976C9E, 0xFF5506A9, 0xFA1A102C, 0xFBD87A1B,
+        0xF99EC442, 0xF85CAE75, 0xF300E948, 0xF2C2837F, 0xF0843D26, 0xF1465711,
+        0xF4094194, 0xF5CB2BA3, 0xF78D95FA, 0xF64FFFCD, 0xD9785D60, 0xD8BA3757,
+        0xDAFC890E, 0xDB3EE339, 0xDE71F5BC, 0xDFB39F8B, 0xDDF521D2, 0xDC374BE5,
+        0xD76B0CD8, 0xD6A966EF, 0xD4EFD8B6, 0xD52DB281, 0xD062A404, 0xD1A0CE33,
+        0xD3E6706A, 0xD2241A5D, 0xC55EFE10, 0xC49C9427, 0xC6DA2A7E, 0xC7184049,
+        0xC25756CC, 0xC3953CFB, 0xC1D382A2, 0xC011E895, 0xCB4DAFA8, 0xCA8FC59F,
+        0xC8C97BC6, 0xC90B11F1, 0xCC440774, 0xCD866D43, 0xCFC0D31A, 0xCE02B92D,
+        0x91AF9640, 0x906DFC77, 0x922B422E, 0x93E92819, 0x96A63E9C, 0x976454AB,
+        0x9522EAF2, 0x94E080C5, 0x9FBCC7F8, 0x9E7EADCF, 0x9C381396, 0x9DFA79A1,
+        0x98B56F24, 0x99770513, 0x9B31BB4A, 0x9AF3D17D, 0x8D893530, 0x8C4B5F07,
+        0x8E0DE15E, 0x8FCF8B69, 0x8A809DEC, 0x8B42F7DB, 0x89044982, 0x88C623B5,
+        0x839A6488, 0x82580EBF, 0x801EB0E6, 0x81DCDAD1, 0x8493CC54, 0x8551A663,
+        0x8717183A, 0x86D5720D, 0xA9E2D0A0, 0xA820BA97, 0xAA6604CE, 0xABA46EF9,
+        0xAEEB787C, 0xAF29124B, 0xAD6FAC12, 0xACADC625, 0xA7F18118, 0xA633EB2F,
+        0xA4755576, 0xA5B73F41, 0xA0F829C4, 0xA13A43F3, 0xA37CFDAA, 0xA2BE979D,
+        0xB5C473D0, 0xB40619E7, 0xB640A7BE, 0xB782CD89, 0xB2CDDB0C, 0xB30FB13B,
+        0xB1490F62, 0xB08B6555, 0xBBD72268, 0xBA15485F, 0xB853F606, 0xB9919C31,
+        0xBCDE8AB4, 0xBD1CE083, 0xBF5A5EDA, 0xBE9834ED
+    },
+    {
+        0x00000000, 0xB8BC6765, 0xAA09C88B, 0x12B5AFEE, 0x8F629757, 0x37DEF032,
+        0x256B5FDC, 0x9DD738B9, 0xC5B428EF, 0x7D084F8A, 0x6FBDE064, 0xD7018701,
+        0x4AD6BFB8, 0xF26AD8DD, 0xE0DF7733, 0x58631056, 0x5019579F, 0xE8A530FA,
+        0xFA109F14, 0x42ACF871, 0xDF7BC0C8, 0x67C7A7AD, 0x75720843, 0xCDCE6F26,
+        0x95AD7F70, 0x2D111815, 0x3FA4B7FB, 0x8718D09E, 0x1ACFE827, 0xA2738F42,
+        0xB0C620AC, 0x087A47C9, 0xA032AF3E, 0x188EC85B, 0x0A3B67B5, 0xB28700D0,
+        0x2F503869, 0x97EC5F0C, 0x8559F0E2, 0x3DE59787, 0x658687D1, 0xDD3AE0B4,
+        0xCF8F4F5A, 0x7733283F, 0xEAE41086, 0x525877E3, 0x40EDD80D, 0xF851BF68,
+        0xF02BF8A1, 0x48979FC4, 0x5A22302A, 0xE29E574F, 0x7F496FF6, 0xC7F50893,
+        0xD540A77D, 0x6DFCC018, 0x359FD04E, 0x8D23B72B, 0x9F9618C5, 0x272A7FA0,
+        0xBAFD4719, 0x0241207C, 0x10F48F92, 0xA848E8F7, 0x9B14583D, 0x23A83F58,
+        0x311D90B6, 0x89A1F7D3, 0x1476CF6A, 0xACCAA80F, 0xBE7F07E1, 0x06C36084,
+        0x5EA070D2, 0xE61C17B7, 0xF4A9B859, 0x4C15DF3C, 0xD1C2E785, 0x697E80E0,
+        0x7BCB2F0E, 0xC377486B, 0xCB0D0FA2, 0x73B168C7, 0x6104C729, 0xD9B8A04C,
+        0x446F98F5, 0xFCD3FF90, 0xEE66507E, 0x56DA371B, 0x0EB9274D, 0xB6054028,
+        0xA4B0EFC6, 0x1C0C88A3, 0x81DBB01A, 0x3967D77F, 0x2BD27891, 0x936E1FF4,
+        0x3B26F703, 0x839A9066, 0x912F3F88, 0x299358ED, 0xB4446054, 0x0CF80731,
+        0x1E4DA8DF, 0xA6F1CFBA, 0xFE92DFEC, 0x462EB889, 0x549B1767, 0xEC277002,
+        0x71F048BB, 0xC94C2FDE, 0xDBF98030, 0x6345E755, 0x6B3FA09C, 0xD383C7F9,
+        0xC1366817, 0x798A0F72, 0xE45D37CB, 0x5CE150AE, 0x4E54FF40, 0xF6E89825,
+        0xAE8B8873, 0x1637EF16, 0x048240F8, 0xBC3E279D, 0x21E91F24, 0x99557841,
+        0x8BE0D7AF, 0x335CB0CA, 0xED59B63B, 0x55E5D15E, 0x47507EB0, 0xFFEC19D5,
+        0x623B216C, 0xDA874609, 0xC832E9E7, 0x708E8E82, 0x28ED9ED4, 0x9051F9B1,
+        0x82E4565F, 0x3A58313A, 0xA78F0983, 0x1F336EE6, 0x0D86C108, 0xB53AA66D,
+        0xBD40E1A4, 0x05FC86C1, 0x1749292F, 0xAFF54E4A, 0x322276F3, 0x8A9E1196,
+        0x982BBE78, 0x2097D91D, 0x78F4C94B, 0xC048AE2E, 0xD2FD01C0, 0x6A4166A5,
+        0xF7965E1C, 0x4F2A3979, 0x5D9F9697, 0xE523F1F2, 0x4D6B1905, 0xF5D77E60,
+        0xE762D18E, 0x5FDEB6EB, 0xC2098E52, 0x7AB5E937, 0x680046D9, 0xD0BC21BC,
+        0x88DF31EA, 0x3063568F, 0x22D6F961, 0x9A6A9E04, 0x07BDA6BD, 0xBF01C1D8,
+        0xADB46E36, 0x15080953, 0x1D724E9A, 0xA5CE29FF, 0xB77B8611, 0x0FC7E174,
+        0x9210D9CD, 0x2AACBEA8, 0x38191146, 0x80A57623, 0xD8C66675, 0x607A0110,
+        0x72CFAEFE, 0xCA73C99B, 0x57A4F122, 0xEF189647, 0xFDAD39A9, 0x45115ECC,
+        0x764DEE06, 0xCEF18963, 0xDC44268D, 0x64F841E8, 0xF92F7951, 0x41931E34,
+        0x5326B1DA, 0xEB9AD6BF, 0xB3F9C6E9, 0x0B45A18C, 0x19F00E62, 0xA14C6907,
+        0x3C9B51BE, 0x842736DB, 0x96929935, 0x2E2EFE50, 0x2654B999, 0x9EE8DEFC,
+        0x8C5D7112, 0x34E11677, 0xA9362ECE, 0x118A49AB, 0x033FE645, 0xBB838120,
+        0xE3E09176, 0x5B5CF613, 0x49E959FD, 0xF1553E98, 0x6C820621, 0xD43E6144,
+        0xC68BCEAA, 0x7E37A9CF, 0xD67F4138, 0x6EC3265D, 0x7C7689B3, 0xC4CAEED6,
+        0x591DD66F, 0xE1A1B10A, 0xF3141EE4, 0x4BA87981, 0x13CB69D7, 0xAB770EB2,
+        0xB9C2A15C, 0x017EC639, 0x9CA9FE80, 0x241599E5, 0x36A0360B, 0x8E1C516E,
+        0x866616A7, 0x3EDA71C2, 0x2C6FDE2C, 0x94D3B949, 0x090481F0, 0xB1B8E695,
+        0xA30D497B, 0x1BB12E1E, 0x43D23E48, 0xFB6E592D, 0xE9DBF6C3, 0x516791A6,
+        0xCCB0A91F, 0x740CCE7A, 0x66B96194, 0xDE0506F1
+    }
+};
+
+static const uint8_t protocol_tam_chk[] = { 1, 2, 4 };  // Bytes do CHK por modo
+
+static uint32_t protocol_integrity_start(uint8_t modo) {
+    switch (modo) {
+        case PROTOCOL_CRC16: return 0xFFFFu;
+        case PROTOCOL_CRC32: return 0xFFFFFFFFu;
+        default:             return 0;
+    }
+}
+
+// Acumula um trecho de dados: os parsers chamam a cada trecho recebido,
+// então a mensagem não precisa estar inteira para o cálculo
+static uint32_t protocol_integrity_update(uint8_t modo, uint32_t valor, const uint8_t* p, size_t n) {
+    switch (modo) {
+        case PROTOCOL_CRC16: {
+            uint16_t crc = (uint16_t)valor;
+            for (; n >= 2; n -= 2, p += 2) {
+                crc ^= (uint16_t)((p[0] << 8) | p[1]);
+                crc = (uint16_t)(crc16_tabela[1][crc >> 8] ^ crc16_tabela[0][crc & 0xFF]);
+            }
+            if (n) {
+                crc = (uint16_t)((crc << 8) ^ crc16_tabela[0][(crc >> 8) ^ *p]);
+            }
+            return crc;
+        }
+        
+        case PROTOCOL_CRC32: {
+            uint32_t crc = valor;
+            for (; n >= 4; n -= 4, p += 4) {
+                crc ^= (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+                crc = crc32_tabela[3][crc & 0xFF] ^ crc32_tabela[2][(crc >> 8) & 0xFF] ^
+                      crc32_tabela[1][(crc >> 16) & 0xFF] ^ crc32_tabela[0][crc >> 24];
+            }
+            for (; n > 0; n--, p++) {
+                crc = (crc >> 8) ^ crc32_tabela[0][(crc ^ *p) & 0xFF];
+            }
+            return crc;
+        }
+        
+        default:
+            return protocol_sum8_update((uint8_t)valor, p, n);
+    }
+}
+
+static uint32_t protocol_integrity_finish(uint8_t modo, uint32_t valor) {
+    return modo == PROTOCOL_CRC32 ? valor ^ 0xFFFFFFFFu : valor;
+}
+
+// Valor do CHK para os dados (soma de 8 bits ou CRC, conforme o modo)
+uint32_t protocol_calculate_integrity(ProtocolIntegrity modo, const uint8_t* dados, size_t qtd) {
+    if (!dados && qtd > 0) return 0;
+    
+    return protocol_integrity_finish(modo, protocol_integrity_update(modo, protocol_integrity_start(modo), dados, qtd));
+}
 
 // ========================================
 // PROTOCOL IMPLEMENTATIONS
 // ========================================
 
+// Reinicia o estado; a área, a capacidade, os modos do QTD e do CHK e as
+// estatísticas são mantidos (PROTOCOL_HANDLER ou protocol_init_area). Os
+// dados não são apagados
 void protocol_init(ProtocolHandler* handler) {
     if (!handler) return;
     
@@ -66,9 +679,296 @@ void protocol_init(ProtocolHandler* handler) {
     handler->qtd_dados = 0;
     handler->dados_count = 0;
     handler->checksum_recv = 0;
-    handler->checksum_calc = 0;
+    handler->checksum_calc = protocol_integrity_start(handler->integridade);
+    handler->chk_count = 0;
     handler->message_ready = false;
-    memset(handler->dados, 0, MAX_DATA_SIZE);
+    memset(&handler->pendente, 0, sizeof(handler->pendente));
+}
+
+void protocol_init_area(ProtocolHandler* handler, uint8_t* area, uint16_t capacidade, bool qtd_16_bits) {
+    if (!handler) return;
+    
+    handler->dados = area;
+    handler->capacidade = area ? capacidade : 0;
+    handler->qtd_16_bits = qtd_16_bits;
+    handler->integridade = PROTOCOL_SUM8;
+    handler->ressincroniza = false;
+    memset(&handler->estatisticas, 0, sizeof(handler->estatisticas));
+    protocol_init(handler);
+}
+
+// Troca o modo do CHK (o padrão é PROTOCOL_SUM8); os dois lados do enlace
+// devem usar o mesmo. A mensagem em andamento é descartada
+void protocol_set_integrity(ProtocolHandler* handler, ProtocolIntegrity modo) {
+    if (!handler || modo > PROTOCOL_CRC32) return;
+    
+    handler->integridade = (uint8_t)modo;
+    protocol_init(handler);
+}
+
+// Próximo estado após a quantidade: mensagens vazias ou maiores que a
+// área são descartadas
+static uint8_t protocol_qtd_state(uint16_t qtd, uint16_t capacidade) {
+    return (qtd > 0 && qtd <= capacidade) ? STATE_WAIT_DATA : STATE_WAIT_STX;
+}
+
+// Liga a caça ao próximo STX (desligada por padrão). Sem ela, um erro de
+// CHK, de ETX ou de QTD descarta tudo o que veio desde o STX; com ela, os
+// bytes já recebidos são reexaminados a partir do byte seguinte ao STX, e
+// uma mensagem que começou dentro da mensagem corrompida não é perdida
+void protocol_set_resync(ProtocolHandler* handler, bool ligada) {
+    if (!handler) return;
+    
+    handler->ressincroniza = ligada;
+}
+
+// Cópia dos contadores, para comparar com a leitura anterior
+void protocol_get_stats(const ProtocolHandler* handler, ProtocolStats* copia) {
+    if (!handler || !copia) return;
+    
+    *copia = handler->estatisticas;
+}
+
+void protocol_reset_stats(ProtocolHandler* handler) {
+    if (!handler) return;
+    
+    memset(&handler->estatisticas, 0, sizeof(handler->estatisticas));
+}
+
+// Conta o QTD recusado por protocol_qtd_state
+static void protocol_count_qtd(ProtocolStats* e, uint16_t qtd) {
+    if (qtd == 0) {
+        e->qtd_zero++;
+    } else {
+        e->qtd_grande++;
+    }
+}
+
+// Conta a falha no ETX: o byte errado ou o CHK diferente
+static void protocol_count_failure(ProtocolStats* e, uint8_t ultimo) {
+    if (ultimo != ETX_BYTE) {
+        e->erros_etx++;
+    } else {
+        e->erros_chk++;
+    }
+}
+
+// Bytes recebidos após o STX da mensagem que falhou: o QTD e o CHK (que não
+// ficam na área) e o último byte são guardados aqui; os dados continuam na
+// área ou na reserva
+typedef struct {
+    const uint8_t* area;       // Área (ou reserva) com os dados guardados
+    uint16_t inicio;           // Dados guardados: area[inicio..fim)
+    uint16_t fim;
+    uint8_t cabeca[2];         // QTD
+    uint8_t cabeca_count;
+    uint8_t cauda[5];          // CHK e o byte no lugar do ETX
+    uint8_t cauda_count;
+} ProtocolRescan;
+
+// Estado do parser após a caça, copiado para o handler de cada parser
+typedef struct {
+    uint32_t checksum_recv;
+    uint32_t checksum_calc;
+    uint16_t qtd_dados;
+    uint16_t dados_count;
+    uint8_t state;
+    uint8_t chk_count;
+    ProtocolPending pendente;
+} ProtocolRescanState;
+
+enum { CANDIDATO_INVALIDO, CANDIDATO_VALIDO, CANDIDATO_ABERTO };
+
+static bool protocol_has_pending(const ProtocolPending* pendente) {
+    return pendente->fim > pendente->inicio || pendente->cauda_count > 0;
+}
+
+// Bytes da mensagem que falhou; ultimo é o byte no lugar do ETX (NULL se o
+// erro foi no QTD)
+static void protocol_rescan_init(ProtocolRescan* r, const uint8_t* area, uint16_t dados_count, uint16_t qtd,
+                                 bool qtd_16_bits, uint32_t chk, uint8_t chk_count, const uint8_t* ultimo) {
+    r->area = area;
+    r->inicio = 0;
+    r->fim = dados_count;
+    r->cabeca_count = 0;
+    if (qtd_16_bits) {
+        r->cabeca[r->cabeca_count++] = (uint8_t)(qtd >> 8);
+    }
+    r->cabeca[r->cabeca_count++] = (uint8_t)qtd;
+    r->cauda_count = 0;
+    for (uint8_t i = chk_count; i > 0; i--) {
+        r->cauda[r->cauda_count++] = (uint8_t)(chk >> (8 * (i - 1)));
+    }
+    if (ultimo) {
+        r->cauda[r->cauda_count++] = *ultimo;
+    }
+}
+
+// Bytes que sobraram de uma caça anterior
+static void protocol_rescan_init_pending(ProtocolRescan* r, const uint8_t* area, const ProtocolPending* pendente) {
+    r->area = area;
+    r->inicio = pendente->inicio;
+    r->fim = pendente->fim;
+    r->cabeca_count = 0;
+    r->cauda_count = pendente->cauda_count;
+    memcpy(r->cauda, pendente->cauda, pendente->cauda_count);
+}
+
+static size_t protocol_rescan_total(const ProtocolRescan* r) {
+    return (size_t)r->cabeca_count + (size_t)(r->fim - r->inicio) + r->cauda_count;
+}
+
+static uint8_t protocol_rescan_byte(const ProtocolRescan* r, size_t k) {
+    if (k < r->cabeca_count && k < sizeof(r->cabeca)) return r->cabeca[k];
+    k -= r->cabeca_count;
+    if (k < (size_t)(r->fim - r->inicio)) return r->area[r->inicio + k];
+    return r->cauda[k - (size_t)(r->fim - r->inicio)];
+}
+
+// Confere, sem alterar nada, a mensagem que começaria no STX em k: válida,
+// inválida, ou aberta (continua depois dos bytes guardados)
+static int protocol_rescan_check(const ProtocolRescan* r, size_t k, uint16_t capacidade, bool qtd_16_bits,
+                                 uint8_t modo) {
+    size_t total = protocol_rescan_total(r);
+    uint16_t qtd;
+    
+    if (++k >= total) return CANDIDATO_ABERTO;
+    qtd = protocol_rescan_byte(r, k++);
+    if (qtd_16_bits) {
+        if (k >= total) return CANDIDATO_ABERTO;
+        qtd = (uint16_t)((qtd << 8) | protocol_rescan_byte(r, k++));
+    }
+    if (protocol_qtd_state(qtd, capacidade) != STATE_WAIT_DATA) return CANDIDATO_INVALIDO;
+    if (k + qtd + protocol_tam_chk[modo] + 1 > total) return CANDIDATO_ABERTO;
+    
+    uint32_t valor = protocol_integrity_start(modo);
+    for (size_t fim = k + qtd; k < fim; k++) {
+        uint8_t byte = protocol_rescan_byte(r, k);
+        valor = protocol_integrity_update(modo, valor, &byte, 1);
+    }
+    uint32_t chk = 0;
+    for (uint8_t i = 0; i < protocol_tam_chk[modo]; i++) {
+        chk = (chk << 8) | protocol_rescan_byte(r, k++);
+    }
+    return (protocol_rescan_byte(r, k) == ETX_BYTE && protocol_integrity_finish(modo, valor) == chk) ?
+           CANDIDATO_VALIDO : CANDIDATO_INVALIDO;
+}
+
+// Refaz a mensagem do STX em k, com os dados copiados para o início do
+// destino. O destino pode ser a própria área dos dados guardados: cada byte
+// é gravado antes (ou no lugar) de onde foi lido. Retorna a posição seguinte
+// ao último byte usado
+static size_t protocol_rescan_apply(const ProtocolRescan* r, size_t k, uint8_t* destino, bool qtd_16_bits,
+                                    uint8_t modo, ProtocolRescanState* s) {
+    size_t total = protocol_rescan_total(r);
+    
+    s->state = STATE_WAIT_QTD;
+    s->qtd_dados = 0;
+    s->dados_count = 0;
+    s->checksum_recv = 0;
+    s->checksum_calc = protocol_integrity_start(modo);
+    s->chk_count = 0;
+    
+    for (k++; k < total; k++) {
+        uint8_t byte = protocol_rescan_byte(r, k);
+        switch (s->state) {
+            case STATE_WAIT_QTD:
+                s->qtd_dados = byte;
+                s->state = qtd_16_bits ? STATE_WAIT_QTD_LOW : STATE_WAIT_DATA;
+                break;
+            case STATE_WAIT_QTD_LOW:
+                s->qtd_dados = (uint16_t)((s->qtd_dados << 8) | byte);
+                s->state = STATE_WAIT_DATA;
+                break;
+            case STATE_WAIT_DATA:
+                destino[s->dados_count++] = byte;
+                s->checksum_calc = protocol_integrity_update(modo, s->checksum_calc, &byte, 1);
+                if (s->dados_count >= s->qtd_dados) {
+                    s->state = STATE_WAIT_CHK;
+                }
+                break;
+            case STATE_WAIT_CHK:
+                s->checksum_recv = (s->checksum_recv << 8) | byte;
+                if (++s->chk_count >= protocol_tam_chk[modo]) {
+                    s->state = STATE_WAIT_ETX;
+                }
+                break;
+            default:
+                s->state = STATE_MESSAGE_OK;  // ETX, já conferido
+                return k + 1;
+        }
+    }
+    return total;
+}
+
+// Caça ao primeiro STX dos bytes guardados que começa uma mensagem válida
+// ou ainda aberta. Retorna PROTOCOL_SUCCESS (mensagem completa no destino;
+// os bytes guardados depois dela ficam pendentes, para a próxima chamada),
+// PROTOCOL_WAITING (mensagem em andamento) ou PROTOCOL_ERROR (nenhum
+// candidato)
+static int protocol_rescan(const ProtocolRescan* r, uint8_t* destino, uint16_t capacidade, bool qtd_16_bits,
+                           uint8_t modo, ProtocolRescanState* s) {
+    size_t total = protocol_rescan_total(r);
+    
+    memset(&s->pendente, 0, sizeof(s->pendente));
+    for (size_t k = 0; k < total; k++) {
+        if (protocol_rescan_byte(r, k) != STX_BYTE) continue;
+        
+        int candidato = protocol_rescan_check(r, k, capacidade, qtd_16_bits, modo);
+        if (candidato == CANDIDATO_INVALIDO) continue;
+        
+        size_t fim = protocol_rescan_apply(r, k, destino, qtd_16_bits, modo, s);
+        if (candidato == CANDIDATO_ABERTO) return PROTOCOL_WAITING;
+        
+        // Os dados entregues ficam antes dos pendentes, que não são sobrescritos
+        size_t guardados = (size_t)(r->fim - r->inicio);
+        size_t d = fim - r->cabeca_count;
+        if (d < guardados) {
+            s->pendente.inicio = (uint16_t)(r->inicio + d);
+            s->pendente.fim = r->fim;
+            d = 0;
+        } else {
+            d -= guardados;
+        }
+        s->pendente.cauda_count = (uint8_t)(r->cauda_count - d);
+        memcpy(s->pendente.cauda, &r->cauda[d], s->pendente.cauda_count);
+        return PROTOCOL_SUCCESS;
+    }
+    s->state = STATE_WAIT_STX;
+    return PROTOCOL_ERROR;
+}
+
+static int protocol_resync_run(ProtocolHandler* handler, const ProtocolRescan* r) {
+    ProtocolRescanState s;
+    
+    int result = protocol_rescan(r, handler->dados, handler->capacidade, handler->qtd_16_bits,
+                                 handler->integridade, &s);
+    handler->state = s.state;
+    handler->qtd_dados = s.qtd_dados;
+    handler->dados_count = s.dados_count;
+    handler->checksum_recv = s.checksum_recv;
+    handler->checksum_calc = s.checksum_calc;
+    handler->chk_count = s.chk_count;
+    handler->pendente = s.pendente;
+    handler->message_ready = (result == PROTOCOL_SUCCESS);
+    return result;
+}
+
+// Caça nos bytes da mensagem que falhou, guardados pelo handler
+static int protocol_resync(ProtocolHandler* handler, const uint8_t* ultimo) {
+    ProtocolRescan r;
+    
+    protocol_rescan_init(&r, handler->dados, handler->dados_count, handler->qtd_dados, handler->qtd_16_bits,
+                         handler->checksum_recv, handler->chk_count, ultimo);
+    return protocol_resync_run(handler, &r);
+}
+
+// Continua a caça nos bytes que sobraram depois da mensagem entregue
+static int protocol_resync_pending(ProtocolHandler* handler) {
+    ProtocolRescan r;
+    
+    protocol_rescan_init_pending(&r, handler->dados, &handler->pendente);
+    return protocol_resync_run(handler, &r);
 }
 
 void protocol_reset(ProtocolHandler* handler) {
@@ -76,36 +976,57 @@ void protocol_reset(ProtocolHandler* handler) {
     
     handler->state = STATE_WAIT_STX;
     handler->dados_count = 0;
-    handler->checksum_calc = 0;
+    handler->checksum_calc = protocol_integrity_start(handler->integridade);
     handler->message_ready = false;
+    memset(&handler->pendente, 0, sizeof(handler->pendente));
 }
 
-int protocol_process_byte(ProtocolHandler* handler, uint8_t byte) {
-    if (!handler) return PROTOCOL_INVALID_PARAM;
+static int protocol_step_byte(ProtocolHandler* handler, uint8_t byte) {
+    ProtocolStats* e = &handler->estatisticas;
     
     switch (handler->state) {
         case STATE_WAIT_STX:
             if (byte == STX_BYTE) {
                 handler->state = STATE_WAIT_QTD;
                 handler->dados_count = 0;
-                handler->checksum_calc = 0;
+                handler->checksum_recv = 0;
+                handler->checksum_calc = protocol_integrity_start(handler->integridade);
+                handler->chk_count = 0;
                 handler->message_ready = false;
+            } else {
+                e->descartados++;  // Ignora outros bytes
             }
-            // Ignora outros bytes
             break;
             
         case STATE_WAIT_QTD:
-            if (byte > 0) {  // uint8_t sempre será <= 255
-                handler->qtd_dados = byte;
-                handler->state = STATE_WAIT_DATA;
-            } else {
-                handler->state = STATE_WAIT_STX; // Erro: quantidade inválida
+            handler->qtd_dados = byte;
+            if (handler->qtd_16_bits) {
+                handler->state = STATE_WAIT_QTD_LOW;
+                break;
+            }
+            handler->state = protocol_qtd_state(handler->qtd_dados, handler->capacidade);
+            if (handler->state == STATE_WAIT_STX) {
+                protocol_count_qtd(e, handler->qtd_dados);
+                if (handler->ressincroniza) {
+                    (void)protocol_resync(handler, NULL);
+                }
+            }
+            break;
+            
+        case STATE_WAIT_QTD_LOW:
+            handler->qtd_dados = (uint16_t)((handler->qtd_dados << 8) | byte);
+            handler->state = protocol_qtd_state(handler->qtd_dados, handler->capacidade);
+            if (handler->state == STATE_WAIT_STX) {
+                protocol_count_qtd(e, handler->qtd_dados);
+                if (handler->ressincroniza) {
+                    (void)protocol_resync(handler, NULL);
+                }
             }
             break;
             
         case STATE_WAIT_DATA:
             handler->dados[handler->dados_count] = byte;
-            handler->checksum_calc += byte;  // Acumula checksum
+            handler->checksum_calc = protocol_integrity_update(handler->integridade, handler->checksum_calc, &byte, 1);
             handler->dados_count++;
             
             if (handler->dados_count >= handler->qtd_dados) {
@@ -114,232 +1035,3388 @@ int protocol_process_byte(ProtocolHandler* handler, uint8_t byte) {
             break;
             
         case STATE_WAIT_CHK:
-            handler->checksum_recv = byte;
-            handler->state = STATE_WAIT_ETX;
+            handler->checksum_recv = (handler->checksum_recv << 8) | byte;
+            if (++handler->chk_count >= protocol_tam_chk[handler->integridade]) {
+                handler->state = STATE_WAIT_ETX;
+            }
             break;
             
         case STATE_WAIT_ETX:
             if (byte == ETX_BYTE) {
-                if (handler->checksum_calc == handler->checksum_recv) {
+                if (protocol_integrity_finish(handler->integridade, handler->checksum_calc) == handler->checksum_recv) {
                     handler->state = STATE_MESSAGE_OK;
                     handler->message_ready = true;
+                    e->quadros_ok++;
+                    return PROTOCOL_SUCCESS;
+                }
+            }
+            protocol_count_failure(e, byte);
+            // Na caça, uma mensagem completa dentro da corrompida é entregue
+            // no lugar do erro
+            if (handler->ressincroniza) {
+                if (protocol_resync(handler, &byte) == PROTOCOL_SUCCESS) {
+                    e->quadros_ok++;
                     return PROTOCOL_SUCCESS;
                 }
+                return PROTOCOL_ERROR;
             }
             handler->state = STATE_MESSAGE_ERROR;
             return PROTOCOL_ERROR;
             
         case STATE_MESSAGE_OK:
         case STATE_MESSAGE_ERROR:
-            // Reset automático para próxima mensagem
+            // Na caça, os bytes que sobraram depois de uma mensagem encontrada
+            // dentro da corrompida vêm antes deste
+            if (handler->state == STATE_MESSAGE_OK && protocol_has_pending(&handler->pendente)) {
+                if (protocol_resync_pending(handler) == PROTOCOL_SUCCESS) {
+                    e->quadros_ok++;
+                    e->descartados++;
+                    return PROTOCOL_SUCCESS;  // Como após toda mensagem, o byte é descartado
+                }
+                return protocol_step_byte(handler, byte);
+            }
+            // Reset automático para próxima mensagem; o byte é descartado
             protocol_reset(handler);
+            e->descartados++;
             break;
     }
     
     return PROTOCOL_WAITING;
 }
 
-uint8_t protocol_calculate_checksum(uint8_t* dados, uint8_t qtd) {
-    if (!dados || qtd == 0) return 0;
+int protocol_process_byte(ProtocolHandler* handler, uint8_t byte) {
+    if (!handler) return PROTOCOL_INVALID_PARAM;
     
-    uint8_t checksum = 0;
-    for (uint8_t i = 0; i < qtd; i++) {
-        checksum += dados[i];
+    handler->estatisticas.bytes++;
+    uint8_t de = handler->state;
+    int result = protocol_step_byte(handler, byte);
+    if (handler->state != de) {
+        PROTOCOL_TRACE_TRANSICAO(de, handler->state, byte);
     }
-    return checksum;
+    return result;
 }
 
-int protocol_create_message(uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size) {
-    if (!dados || !buffer || !buffer_size || qtd == 0) {
-        return PROTOCOL_INVALID_PARAM;
+/*
+ * Processa um bloco inteiro (ex.: um bloco entregue pelo DMA), com o mesmo
+ * protocolo de protocol_process_byte, mas sem uma chamada por byte: o STX e
+ * procurado com memchr e os dados sao copiados em trechos com memcpy, com o
+ * checksum somado em seguida. Retorna ao fim de cada mensagem:
+ *  - PROTOCOL_SUCCESS: mensagem valida (protocol_get_data);
+ *  - PROTOCOL_ERROR: mensagem invalida (checksum ou ETX);
+ *  - PROTOCOL_WAITING: o bloco terminou no meio de uma mensagem, que
+ *    continua na proxima chamada.
+ * Em *consumed, os bytes usados do bloco; o restante deve ser passado na
+ * proxima chamada. Diferente de protocol_process_byte, o byte seguinte a uma
+ * mensagem nao e descartado: mensagens seguidas no bloco sao todas lidas.
+ * Na caca (protocol_set_resync), o erro de uma mensagem que comecou neste
+ * bloco consome so o STX: o restante, passado na proxima chamada, e
+ * reexaminado desde o byte seguinte a ele.
+ */
+static int protocol_run_buffer(ProtocolHandler* handler, const uint8_t* buf, size_t len, size_t* consumed) {
+    ProtocolStats* e = &handler->estatisticas;
+    const uint8_t* p = buf;
+    const uint8_t* end = buf + len;
+    const uint8_t* inicio = NULL;  // Byte após o STX, se ele veio neste bloco
+    
+    if (handler->state == STATE_MESSAGE_OK && protocol_has_pending(&handler->pendente)) {
+        if (protocol_resync_pending(handler) == PROTOCOL_SUCCESS) {
+            e->quadros_ok++;
+            *consumed = 0;
+            return PROTOCOL_SUCCESS;
+        }
+    } else if (handler->state == STATE_MESSAGE_OK || handler->state == STATE_MESSAGE_ERROR) {
+        protocol_reset(handler);
     }
     
-    uint8_t checksum = protocol_calculate_checksum(dados, qtd);
-    uint8_t msg_size = 5 + qtd; // STX + QTD + dados + CHK + ETX
+    // Os campos usados a cada byte ficam em locais durante o bloco, que o
+    // compilador mantém em registradores, e voltam ao handler só nas saídas
+    // e em volta da caça, que lê e reescreve o handler
+    uint8_t state = handler->state;
+    uint16_t qtd_dados = handler->qtd_dados;
+    uint16_t dados_count = handler->dados_count;
+    uint32_t checksum_recv = handler->checksum_recv;
+    uint32_t checksum_calc = handler->checksum_calc;
+    uint8_t chk_count = handler->chk_count;
+    const uint8_t integridade = handler->integridade;
     
-    if (*buffer_size < msg_size) {
-        return PROTOCOL_ERROR;
+#define GUARDA_ESTADO() do { \
+        handler->state = state; \
+        handler->qtd_dados = qtd_dados; \
+        handler->dados_count = dados_count; \
+        handler->checksum_recv = checksum_recv; \
+        handler->checksum_calc = checksum_calc; \
+        handler->chk_count = chk_count; \
+    } while (0)
+#define CARREGA_ESTADO() do { \
+        state = handler->state; \
+        qtd_dados = handler->qtd_dados; \
+        dados_count = handler->dados_count; \
+        checksum_recv = handler->checksum_recv; \
+        checksum_calc = handler->checksum_calc; \
+        chk_count = handler->chk_count; \
+    } while (0)
+    
+    while (p < end) {
+        uint8_t de = state;
+        int result = PROTOCOL_WAITING;
+        
+        switch (state) {
+            case STATE_WAIT_STX: {
+                const uint8_t* stx = memchr(p, STX_BYTE, (size_t)(end - p));
+                if (!stx) {
+                    e->descartados += (uint32_t)(end - p);
+                    p = end;  // Nenhum STX no restante do bloco
+                    break;
+                }
+                e->descartados += (uint32_t)(stx - p);
+                p = stx + 1;
+                inicio = p;
+                state = STATE_WAIT_QTD;
+                dados_count = 0;
+                checksum_recv = 0;
+                checksum_calc = protocol_integrity_start(integridade);
+                chk_count = 0;
+                handler->message_ready = false;
+                break;
+            }
+                
+            case STATE_WAIT_QTD:
+                qtd_dados = *p++;
+                if (handler->qtd_16_bits) {
+                    state = STATE_WAIT_QTD_LOW;
+                    break;
+                }
+                state = protocol_qtd_state(qtd_dados, handler->capacidade);
+                if (state == STATE_WAIT_STX) {
+                    protocol_count_qtd(e, qtd_dados);
+                    if (handler->ressincroniza) {
+                        if (inicio) {
+                            p = inicio;
+                        } else {
+                            GUARDA_ESTADO();
+                            (void)protocol_resync(handler, NULL);
+                            CARREGA_ESTADO();
+                        }
+                    }
+                }
+                break;
+                
+            case STATE_WAIT_QTD_LOW:
+                qtd_dados = (uint16_t)((qtd_dados << 8) | *p++);
+                state = protocol_qtd_state(qtd_dados, handler->capacidade);
+                if (state == STATE_WAIT_STX) {
+                    protocol_count_qtd(e, qtd_dados);
+                    if (handler->ressincroniza) {
+                        if (inicio) {
+                            p = inicio;
+                        } else {
+                            GUARDA_ESTADO();
+                            (void)protocol_resync(handler, NULL);
+                            CARREGA_ESTADO();
+                        }
+                    }
+                }
+                break;
+                
+            case STATE_WAIT_DATA: {
+                size_t faltam = (size_t)(qtd_dados - dados_count);
+                size_t trecho = (size_t)(end - p) < faltam ? (size_t)(end - p) : faltam;
+                
+                memcpy(&handler->dados[dados_count], p, trecho);
+                checksum_calc = protocol_integrity_update(integridade, checksum_calc, p, trecho);
+                dados_count += (uint16_t)trecho;
+                p += trecho;
+                
+                if (dados_count >= qtd_dados) {
+                    state = STATE_WAIT_CHK;
+                }
+                break;
+            }
+                
+            case STATE_WAIT_CHK:
+                checksum_recv = (checksum_recv << 8) | *p++;
+                if (++chk_count >= protocol_tam_chk[integridade]) {
+                    state = STATE_WAIT_ETX;
+                }
+                break;
+                
+            case STATE_WAIT_ETX:
+                *consumed = (size_t)(p + 1 - buf);
+                if (*p == ETX_BYTE && protocol_integrity_finish(integridade, checksum_calc) == checksum_recv) {
+                    state = STATE_MESSAGE_OK;
+                    e->quadros_ok++;
+                    handler->message_ready = true;
+                    result = PROTOCOL_SUCCESS;
+                    break;
+                }
+                protocol_count_failure(e, *p);
+                result = PROTOCOL_ERROR;
+                if (!handler->ressincroniza) {
+                    state = STATE_MESSAGE_ERROR;
+                } else if (inicio) {
+                    // O restante do bloco é reexaminado na próxima chamada
+                    *consumed = (size_t)(inicio - buf);
+                    state = STATE_WAIT_STX;
+                } else {
+                    // A mensagem veio de blocos anteriores: caça nos bytes guardados
+                    GUARDA_ESTADO();
+                    if (protocol_resync(handler, p) == PROTOCOL_SUCCESS) {
+                        e->quadros_ok++;
+                        result = PROTOCOL_SUCCESS;
+                    }
+                    CARREGA_ESTADO();
+                }
+                break;
+                
+            case STATE_MESSAGE_OK:
+            case STATE_MESSAGE_ERROR:
+                GUARDA_ESTADO();
+                protocol_reset(handler);
+                CARREGA_ESTADO();
+                break;
+        }
+        
+        // O byte da troca: o que estava no lugar do ETX, ou o último lido
+        // (com o rastro desligado, nada é gerado)
+        if (state != de) {
+            PROTOCOL_TRACE_TRANSICAO(de, state, (result != PROTOCOL_WAITING || p == buf) ? *p : p[-1]);
+        }
+        if (result != PROTOCOL_WAITING) {
+            GUARDA_ESTADO();
+            return result;
+        }
     }
     
-    buffer[0] = STX_BYTE;
-    buffer[1] = qtd;
-    memcpy(&buffer[2], dados, qtd);
-    buffer[2 + qtd] = checksum;
-    buffer[3 + qtd] = ETX_BYTE;
+    GUARDA_ESTADO();
+#undef CARREGA_ESTADO
+#undef GUARDA_ESTADO
     
-    *buffer_size = msg_size;
-    return PROTOCOL_SUCCESS;
+    *consumed = len;
+    return PROTOCOL_WAITING;
 }
 
-bool protocol_message_ready(ProtocolHandler* handler) {
-    return handler ? handler->message_ready : false;
+int protocol_process_buffer(ProtocolHandler* handler, const uint8_t* buf, size_t len, size_t* consumed) {
+    if (!handler || !consumed || (!buf && len > 0)) return PROTOCOL_INVALID_PARAM;
+    
+    int result = protocol_run_buffer(handler, buf, len, consumed);
+    handler->estatisticas.bytes += (uint32_t)*consumed;
+    return result;
 }
 
-uint8_t* protocol_get_data(ProtocolHandler* handler) {
-    return handler ? handler->dados : NULL;
+void protocol_view_init(ProtocolViewHandler* handler, uint8_t* reserva, uint16_t capacidade, bool qtd_16_bits) {
+    if (!handler) return;
+    
+    handler->capacidade = reserva ? capacidade : 0;
+    handler->qtd_16_bits = qtd_16_bits;
+    handler->state = STATE_WAIT_STX;
+    handler->qtd_dados = 0;
+    handler->dados_count = 0;
+    handler->checksum_recv = 0;
+    handler->checksum_calc = 0;
+    handler->integridade = PROTOCOL_SUM8;
+    handler->ressincroniza = false;
+    handler->chk_count = 0;
+    handler->copiado = false;
+    memset(&handler->pendente, 0, sizeof(handler->pendente));
+    memset(&handler->estatisticas, 0, sizeof(handler->estatisticas));
+    handler->dados = NULL;
+    handler->reserva = reserva;
 }
 
-uint8_t protocol_get_data_count(ProtocolHandler* handler) {
-    return handler ? handler->qtd_dados : 0;
+// Como protocol_set_integrity, para o parser sem cópia
+void protocol_view_set_integrity(ProtocolViewHandler* handler, ProtocolIntegrity modo) {
+    if (!handler || modo > PROTOCOL_CRC32) return;
+    
+    handler->integridade = (uint8_t)modo;
+    handler->state = STATE_WAIT_STX;
+    handler->copiado = false;
+    memset(&handler->pendente, 0, sizeof(handler->pendente));
 }
 
-// ========================================
-// PROTOCOL TESTS - TDD IMPLEMENTATION
-// ========================================
-
-static char * executa_testes(void);
-
-int main() {
-    char *resultado = executa_testes();
-    if (resultado != 0) {
-        printf("%s\n", resultado);
-    } else {
-        printf("TODOS OS TESTES PASSARAM\n");
-    }
-    printf("Testes executados: %d\n", testes_executados);
-
-    return resultado != 0;
+// Como protocol_set_resync, para o parser sem cópia
+void protocol_view_set_resync(ProtocolViewHandler* handler, bool ligada) {
+    if (!handler) return;
+    
+    handler->ressincroniza = ligada;
 }
 
-/* TESTES BÁSICOS DO PROTOCOLO DE COMUNICAÇÃO */
-/*********************************************/
-
-static char * test_protocol_init(void) {
-    ProtocolHandler handler;
-    protocol_init(&handler);
+// Como protocol_get_stats e protocol_reset_stats, para o parser sem cópia
+void protocol_view_get_stats(const ProtocolViewHandler* handler, ProtocolStats* copia) {
+    if (!handler || !copia) return;
     
-    verifica("erro: estado inicial deve ser WAIT_STX", handler.state == STATE_WAIT_STX);
-    verifica("erro: message_ready deve ser false", handler.message_ready == false);
-    verifica("erro: dados_count deve ser 0", handler.dados_count == 0);
+    *copia = handler->estatisticas;
+}
+
+void protocol_view_reset_stats(ProtocolViewHandler* handler) {
+    if (!handler) return;
     
-    return 0;
+    memset(&handler->estatisticas, 0, sizeof(handler->estatisticas));
 }
 
-static char * test_receive_valid_message(void) {
-    ProtocolHandler handler;
-    protocol_init(&handler);
+static int protocol_view_resync_run(ProtocolViewHandler* handler, const ProtocolRescan* r) {
+    ProtocolRescanState s;
     
-    // Simular mensagem: STX + QTD(2) + DADOS(0x10,0x20) + CHK(0x30) + ETX
-    protocol_process_byte(&handler, STX_BYTE);      // STX
-    protocol_process_byte(&handler, 2);             // QTD = 2 bytes
-    protocol_process_byte(&handler, 0x10);          // DADO 1
-    protocol_process_byte(&handler, 0x20);          // DADO 2
-    protocol_process_byte(&handler, 0x30);          // CHK = 0x10 + 0x20 = 0x30
-    int result = protocol_process_byte(&handler, ETX_BYTE); // ETX
+    int result = protocol_rescan(r, handler->reserva, handler->capacidade, handler->qtd_16_bits,
+                                 handler->integridade, &s);
+    handler->state = s.state;
+    handler->qtd_dados = s.qtd_dados;
+    handler->dados_count = s.dados_count;
+    handler->checksum_recv = s.checksum_recv;
+    handler->checksum_calc = s.checksum_calc;
+    handler->chk_count = s.chk_count;
+    handler->pendente = s.pendente;
+    handler->copiado = true;
+    return result;
+}
+
+// Caça do parser sem cópia: os dados guardados vão antes para a reserva,
+// se ainda estão no bloco do chamador, e a mensagem encontrada fica nela
+static int protocol_view_resync(ProtocolViewHandler* handler, const uint8_t* ultimo) {
+    ProtocolRescan r;
     
-    verifica("erro: mensagem deve ser válida", result == PROTOCOL_SUCCESS);
-    verifica("erro: mensagem deve estar pronta", protocol_message_ready(&handler) == true);
-    verifica("erro: quantidade incorreta", protocol_get_data_count(&handler) == 2);
-    verifica("erro: primeiro dado incorreto", handler.dados[0] == 0x10);
-    verifica("erro: segundo dado incorreto", handler.dados[1] == 0x20);
+    if (!handler->copiado) {
+        memcpy(handler->reserva, handler->dados, handler->dados_count);
+    }
+    protocol_rescan_init(&r, handler->reserva, handler->dados_count, handler->qtd_dados, handler->qtd_16_bits,
+                         handler->checksum_recv, handler->chk_count, ultimo);
+    return protocol_view_resync_run(handler, &r);
+}
+
+static int protocol_view_resync_pending(ProtocolViewHandler* handler) {
+    ProtocolRescan r;
     
-    return 0;
+    protocol_rescan_init_pending(&r, handler->reserva, &handler->pendente);
+    return protocol_view_resync_run(handler, &r);
 }
 
-static char * test_invalid_checksum(void) {
-    ProtocolHandler handler;
-    protocol_init(&handler);
+/*
+ * Mesmo protocolo e mesmos retornos de protocol_process_buffer, sem copiar
+ * os dados: em PROTOCOL_SUCCESS, frame aponta para os dados dentro de buf,
+ * válidos enquanto o chamador não reutilizar o bloco. Só uma mensagem
+ * dividida entre blocos é copiada para a reserva, ao fim de cada bloco, e
+ * então frame aponta para a reserva, válida até a próxima chamada.
+ */
+static int protocol_run_view(ProtocolViewHandler* handler, const uint8_t* buf, size_t len, size_t* consumed,
+                             ProtocolFrame* frame) {
+    ProtocolStats* e = &handler->estatisticas;
+    const uint8_t* p = buf;
+    const uint8_t* end = buf + len;
+    const uint8_t* inicio = NULL;  // Byte após o STX, se ele veio neste bloco
     
-    // Mensagem com checksum incorreto
-    protocol_process_byte(&handler, STX_BYTE);      // STX
-    protocol_process_byte(&handler, 2);             // QTD = 2
-    protocol_process_byte(&handler, 0x10);          // DADO 1
-    protocol_process_byte(&handler, 0x20);          // DADO 2
-    protocol_process_byte(&handler, 0xFF);          // CHK incorreto
-    int result = protocol_process_byte(&handler, ETX_BYTE); // ETX
+    if (handler->state == STATE_MESSAGE_OK && protocol_has_pending(&handler->pendente)) {
+        if (protocol_view_resync_pending(handler) == PROTOCOL_SUCCESS) {
+            e->quadros_ok++;
+            *consumed = 0;
+            frame->data = handler->reserva;
+            frame->len = handler->qtd_dados;
+            return PROTOCOL_SUCCESS;
+        }
+    } else if (handler->state == STATE_MESSAGE_OK || handler->state == STATE_MESSAGE_ERROR) {
+        handler->state = STATE_WAIT_STX;
+    }
     
-    verifica("erro: mensagem deve ser inválida", result == PROTOCOL_ERROR);
-    verifica("erro: mensagem não deve estar pronta", protocol_message_ready(&handler) == false);
+    while (p < end) {
+        uint8_t de = handler->state;
+        int result = PROTOCOL_WAITING;
+        
+        switch (handler->state) {
+            case STATE_WAIT_STX: {
+                const uint8_t* stx = memchr(p, STX_BYTE, (size_t)(end - p));
+                if (!stx) {
+                    e->descartados += (uint32_t)(end - p);
+                    p = end;  // Nenhum STX no restante do bloco
+                    break;
+                }
+                e->descartados += (uint32_t)(stx - p);
+                p = stx + 1;
+                inicio = p;
+                handler->state = STATE_WAIT_QTD;
+                handler->dados_count = 0;
+                handler->checksum_recv = 0;
+                handler->checksum_calc = protocol_integrity_start(handler->integridade);
+                handler->chk_count = 0;
+                handler->copiado = false;
+                break;
+            }
+                
+            case STATE_WAIT_QTD:
+                handler->qtd_dados = *p++;
+                handler->dados = p;
+                if (handler->qtd_16_bits) {
+                    handler->state = STATE_WAIT_QTD_LOW;
+                    break;
+                }
+                handler->state = protocol_qtd_state(handler->qtd_dados, handler->capacidade);
+                if (handler->state == STATE_WAIT_STX) {
+                    protocol_count_qtd(e, handler->qtd_dados);
+                    if (handler->ressincroniza) {
+                        if (inicio) {
+                            p = inicio;
+                        } else {
+                            (void)protocol_view_resync(handler, NULL);
+                        }
+                    }
+                }
+                break;
+                
+            case STATE_WAIT_QTD_LOW:
+                handler->qtd_dados = (uint16_t)((handler->qtd_dados << 8) | *p++);
+                handler->dados = p;
+                handler->state = protocol_qtd_state(handler->qtd_dados, handler->capacidade);
+                if (handler->state == STATE_WAIT_STX) {
+                    protocol_count_qtd(e, handler->qtd_dados);
+                    if (handler->ressincroniza) {
+                        if (inicio) {
+                            p = inicio;
+                        } else {
+                            (void)protocol_view_resync(handler, NULL);
+                        }
+                    }
+                }
+                break;
+                
+            case STATE_WAIT_DATA: {
+                size_t faltam = (size_t)(handler->qtd_dados - handler->dados_count);
+                size_t trecho = (size_t)(end - p) < faltam ? (size_t)(end - p) : faltam;
+                
+                if (handler->copiado) {
+                    memcpy(&handler->reserva[handler->dados_count], p, trecho);
+                }
+                handler->checksum_calc = protocol_integrity_update(handler->integridade, handler->checksum_calc, p, trecho);
+                handler->dados_count += (uint16_t)trecho;
+                p += trecho;
+                
+                if (handler->dados_count >= handler->qtd_dados) {
+                    handler->state = STATE_WAIT_CHK;
+                }
+                break;
+            }
+                
+            case STATE_WAIT_CHK:
+                handler->checksum_recv = (handler->checksum_recv << 8) | *p++;
+                if (++handler->chk_count >= protocol_tam_chk[handler->integridade]) {
+                    handler->state = STATE_WAIT_ETX;
+                }
+                break;
+                
+            case STATE_WAIT_ETX:
+                *consumed = (size_t)(p + 1 - buf);
+                if (*p == ETX_BYTE &&
+                    protocol_integrity_finish(handler->integridade, handler->checksum_calc) == handler->checksum_recv) {
+                    handler->state = STATE_MESSAGE_OK;
+                    e->quadros_ok++;
+                    frame->data = handler->copiado ? handler->reserva : handler->dados;
+                    frame->len = handler->qtd_dados;
+                    result = PROTOCOL_SUCCESS;
+                    break;
+                }
+                protocol_count_failure(e, *p);
+                result = PROTOCOL_ERROR;
+                if (!handler->ressincroniza) {
+                    handler->state = STATE_MESSAGE_ERROR;
+                } else if (inicio) {
+                    *consumed = (size_t)(inicio - buf);
+                    handler->state = STATE_WAIT_STX;
+                } else if (protocol_view_resync(handler, p) == PROTOCOL_SUCCESS) {
+                    e->quadros_ok++;
+                    frame->data = handler->reserva;
+                    frame->len = handler->qtd_dados;
+                    result = PROTOCOL_SUCCESS;
+                }
+                break;
+                
+            case STATE_MESSAGE_OK:
+            case STATE_MESSAGE_ERROR:
+                handler->state = STATE_WAIT_STX;
+                break;
+        }
+        
+        if (handler->state != de) {
+            PROTOCOL_TRACE_TRANSICAO(de, handler->state, (result != PROTOCOL_WAITING || p == buf) ? *p : p[-1]);
+        }
+        if (result != PROTOCOL_WAITING) {
+            return result;
+        }
+    }
+    
+    // O bloco terminou no meio de uma mensagem: os dados já recebidos não
+    // podem continuar apontando para um bloco que o chamador vai reutilizar
+    if ((handler->state == STATE_WAIT_DATA || handler->state == STATE_WAIT_CHK ||
+         handler->state == STATE_WAIT_ETX) && !handler->copiado) {
+        memcpy(handler->reserva, handler->dados, handler->dados_count);
+        handler->copiado = true;
+    }
+    
+    *consumed = len;
+    return PROTOCOL_WAITING;
+}
+
+int protocol_process_view(ProtocolViewHandler* handler, const uint8_t* buf, size_t len, size_t* consumed,
+                          ProtocolFrame* frame) {
+    if (!handler || !handler->reserva || !consumed || !frame || (!buf && len > 0)) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    int result = protocol_run_view(handler, buf, len, consumed, frame);
+    handler->estatisticas.bytes += (uint32_t)*consumed;
+    return result;
+}
+
+// ========================================
+// PARSER POOL (MANY CHANNELS)
+// ========================================
+
+static void protocol_pool_devolve(ProtocolPool* pool, uint16_t canal) {
+    *(void**)pool->dados[canal] = pool->livres;
+    pool->livres = pool->dados[canal];
+    pool->dados[canal] = NULL;
+    pool->blocos_livres++;
+}
+
+// Todos os canais aguardando STX e todos os blocos livres
+void protocol_pool_init(ProtocolPool* pool, bool qtd_16_bits, ProtocolIntegrity modo) {
+    if (!pool || modo > PROTOCOL_CRC32) return;
+    
+    size_t palavras = PROTOCOL_POOL_BLOCO(pool->capacidade) / sizeof(void*);
+    
+    pool->qtd_16_bits = qtd_16_bits;
+    pool->integridade = (uint8_t)modo;
+    pool->livres = NULL;
+    for (uint16_t i = pool->numero_blocos; i > 0; i--) {
+        void** bloco = &pool->blocos[(size_t)(i - 1) * palavras];
+        *bloco = pool->livres;
+        pool->livres = bloco;
+    }
+    pool->blocos_livres = pool->numero_blocos;
+    
+    for (uint16_t canal = 0; canal < pool->canais; canal++) {
+        pool->state[canal] = STATE_WAIT_STX;
+        pool->chk_count[canal] = 0;
+        pool->qtd_dados[canal] = 0;
+        pool->dados_count[canal] = 0;
+        pool->checksum_recv[canal] = 0;
+        pool->checksum_calc[canal] = 0;
+        pool->dados[canal] = NULL;
+    }
+}
+
+/*
+ * protocol_process_buffer para um canal, com os mesmos retornos. O estado
+ * do canal é levado a um handler local e devolvido aos vetores ao fim, para
+ * usar o mesmo parser de bloco. Em PROTOCOL_SUCCESS, frame aponta para o
+ * bloco do canal, válido até a próxima chamada para o mesmo canal. Sem
+ * bloco livre, a mensagem é descartada como maior que a área.
+ */
+int protocol_pool_process_buffer(ProtocolPool* pool, uint16_t canal, const uint8_t* buf, size_t len, size_t* consumed,
+                                 ProtocolFrame* frame) {
+    if (!pool || canal >= pool->canais || !consumed || !frame || (!buf && len > 0)) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    ProtocolHandler handler;
+    
+    if (!pool->dados[canal] && pool->livres) {
+        pool->dados[canal] = (uint8_t*)pool->livres;
+        pool->livres = *(void**)pool->livres;
+        pool->blocos_livres--;
+    }
+    
+    handler.dados = pool->dados[canal];
+    handler.capacidade = handler.dados ? pool->capacidade : 0;
+    handler.qtd_dados = pool->qtd_dados[canal];
+    handler.dados_count = pool->dados_count[canal];
+    handler.checksum_recv = pool->checksum_recv[canal];
+    handler.checksum_calc = pool->checksum_calc[canal];
+    handler.state = pool->state[canal];
+    handler.integridade = pool->integridade;
+    handler.chk_count = pool->chk_count[canal];
+    handler.message_ready = (handler.state == STATE_MESSAGE_OK);
+    handler.qtd_16_bits = pool->qtd_16_bits;
+    handler.ressincroniza = false;
+    memset(&handler.pendente, 0, sizeof(handler.pendente));
+    memset(&handler.estatisticas, 0, sizeof(handler.estatisticas));
+    
+    int result = protocol_process_buffer(&handler, buf, len, consumed);
+    
+    pool->state[canal] = handler.state;
+    pool->chk_count[canal] = handler.chk_count;
+    pool->qtd_dados[canal] = handler.qtd_dados;
+    pool->dados_count[canal] = handler.dados_count;
+    pool->checksum_recv[canal] = handler.checksum_recv;
+    pool->checksum_calc[canal] = handler.checksum_calc;
+    
+    if (result == PROTOCOL_SUCCESS) {
+        frame->data = handler.dados;
+        frame->len = handler.qtd_dados;
+    } else if (pool->dados[canal] && handler.state != STATE_WAIT_DATA && handler.state != STATE_WAIT_CHK &&
+               handler.state != STATE_WAIT_ETX) {
+        protocol_pool_devolve(pool, canal);  // Nenhum dado guardado
+    }
+    return result;
+}
+
+// Passa um bloco a um canal e entrega as mensagens válidas a callback.
+// Retorna o número de mensagens entregues
+static size_t protocol_pool_feed(ProtocolPool* pool, uint16_t canal, const uint8_t* buf, size_t len,
+                                 ProtocolPoolCallback callback, void* contexto) {
+    size_t mensagens = 0, usados = 0;
+    ProtocolFrame frame;
+    
+    for (size_t feito = 0; feito < len; feito += usados) {
+        if (protocol_pool_process_buffer(pool, canal, &buf[feito], len - feito, &usados, &frame) == PROTOCOL_SUCCESS) {
+            callback(contexto, canal, &frame);
+            mensagens++;
+        }
+    }
+    // A mensagem já foi tratada: o bloco não espera a próxima chamada
+    if (pool->state[canal] == STATE_MESSAGE_OK) {
+        pool->state[canal] = STATE_WAIT_STX;
+        protocol_pool_devolve(pool, canal);
+    }
+    return mensagens;
+}
+
+// Passa um bloco a cada canal (tamanhos[canal] == 0: nada recebido) e
+// entrega as mensagens válidas a callback, para uma tarefa atender todos os
+// canais a cada despertar. Retorna o número de mensagens entregues
+size_t protocol_pool_process(ProtocolPool* pool, const uint8_t* const* blocos, const size_t* tamanhos,
+                             ProtocolPoolCallback callback, void* contexto) {
+    if (!pool || !blocos || !tamanhos || !callback) return 0;
+    
+    size_t mensagens = 0;
+    
+    for (uint16_t canal = 0; canal < pool->canais; canal++) {
+        mensagens += protocol_pool_feed(pool, canal, blocos[canal], tamanhos[canal], callback, contexto);
+    }
+    return mensagens;
+}
+
+uint8_t protocol_calculate_checksum(uint8_t* dados, uint16_t qtd) {
+    if (!dados || qtd == 0) return 0;
+    
+    return protocol_sum8(dados, qtd);
+}
+
+int protocol_create_message(uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size) {
+    return protocol_frame_encode8(dados, qtd, buffer, buffer_size);
+}
+
+// Mensagem do modo estendido: STX + QTD (2 bytes, alto primeiro) + dados + CHK + ETX
+int protocol_create_extended_message(const uint8_t* dados, uint16_t qtd, uint8_t* buffer, size_t* buffer_size) {
+    return protocol_create_frame(dados, qtd, true, PROTOCOL_SUM8, buffer, buffer_size);
+}
+
+// Mensagem com os modos do QTD e do CHK escolhidos: STX + QTD (1 ou 2 bytes)
+// + dados + CHK (1, 2 ou 4 bytes, alto primeiro) + ETX
+int protocol_create_frame(const uint8_t* dados, uint16_t qtd, bool qtd_16_bits, ProtocolIntegrity modo,
+                          uint8_t* buffer, size_t* buffer_size) {
+    if (!dados) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    ProtocolIovec unico = { dados, qtd };
+    return protocol_create_message_v(&unico, 1, qtd_16_bits, modo, buffer, buffer_size);
+}
+
+// Soma os fragmentos e confere se cabem no QTD. Retorna 0 se algum
+// fragmento não tem dados, se o total é zero ou se ultrapassa o QTD
+static size_t protocol_iov_total(const ProtocolIovec* iov, int n, bool qtd_16_bits) {
+    size_t limite = qtd_16_bits ? MAX_DATA_SIZE_EXT : 0xFF;
+    size_t total = 0;
+    
+    for (int i = 0; i < n; i++) {
+        if (iov[i].iov_len == 0) {
+            continue;
+        }
+        if (!iov[i].iov_base || iov[i].iov_len > limite - total) {
+            return 0;
+        }
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+// STX + QTD. Retorna o número de bytes escritos
+static size_t protocol_write_header(uint8_t* p, size_t qtd, bool qtd_16_bits) {
+    uint8_t* inicio = p;
+    
+    *p++ = STX_BYTE;
+    if (qtd_16_bits) {
+        *p++ = (uint8_t)(qtd >> 8);
+    }
+    *p++ = (uint8_t)qtd;
+    return (size_t)(p - inicio);
+}
+
+// CHK dos fragmentos
+static uint32_t protocol_iov_integrity(const ProtocolIovec* iov, int n, ProtocolIntegrity modo) {
+    uint32_t chk = protocol_integrity_start(modo);
+    
+    for (int i = 0; i < n; i++) {
+        chk = protocol_integrity_update(modo, chk, (const uint8_t*)iov[i].iov_base, iov[i].iov_len);
+    }
+    return protocol_integrity_finish(modo, chk);
+}
+
+// CHK (alto primeiro) + ETX. Retorna o número de bytes escritos
+static size_t protocol_write_trailer(uint8_t* p, uint32_t chk, ProtocolIntegrity modo) {
+    size_t tam_chk = protocol_tam_chk[modo];
+    
+    for (size_t i = tam_chk; i > 0; i--) {
+        *p++ = (uint8_t)(chk >> (8 * (i - 1)));
+    }
+    *p = ETX_BYTE;
+    return tam_chk + 1;
+}
+
+// Mensagem com os dados em n fragmentos, copiados em ordem para o buffer: o
+// CHK é calculado ao longo dos fragmentos, sem juntá-los antes numa área
+// intermediária. O tamanho da mensagem volta em buffer_size
+int protocol_create_message_v(const ProtocolIovec* iov, int n, bool qtd_16_bits, ProtocolIntegrity modo,
+                              uint8_t* buffer, size_t* buffer_size) {
+    if (!iov || n <= 0 || !buffer || !buffer_size || modo > PROTOCOL_CRC32) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    size_t qtd = protocol_iov_total(iov, n, qtd_16_bits);
+    if (qtd == 0) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    size_t msg_size = 2 + (qtd_16_bits ? 2 : 1) + qtd + protocol_tam_chk[modo];
+    if (*buffer_size < msg_size) {
+        return PROTOCOL_ERROR;
+    }
+    
+    uint8_t* p = buffer + protocol_write_header(buffer, qtd, qtd_16_bits);
+    for (int i = 0; i < n; i++) {
+        if (iov[i].iov_len > 0) {
+            memcpy(p, iov[i].iov_base, iov[i].iov_len);
+            p += iov[i].iov_len;
+        }
+    }
+    (void)protocol_write_trailer(p, protocol_iov_integrity(iov, n, modo), modo);
+    
+    *buffer_size = msg_size;
+    return PROTOCOL_SUCCESS;
+}
+
+// Só o envelope da mensagem dos fragmentos: o cabeçalho (STX + QTD, até 3
+// bytes) e a cauda (CHK + ETX, até 5 bytes). Os dados ficam onde estão e o
+// DMA da UART envia cabeça, fragmentos e cauda em sequência (descritores
+// encadeados), sem copiar nada. Os tamanhos escritos voltam em tam_cabeca
+// e tam_cauda
+int protocol_create_envelope_v(const ProtocolIovec* iov, int n, bool qtd_16_bits, ProtocolIntegrity modo,
+                               uint8_t* cabeca, size_t* tam_cabeca, uint8_t* cauda, size_t* tam_cauda) {
+    if (!iov || n <= 0 || !cabeca || !tam_cabeca || !cauda || !tam_cauda || modo > PROTOCOL_CRC32) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    size_t qtd = protocol_iov_total(iov, n, qtd_16_bits);
+    if (qtd == 0) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    if (*tam_cabeca < (size_t)(qtd_16_bits ? 3 : 2) || *tam_cauda < (size_t)protocol_tam_chk[modo] + 1) {
+        return PROTOCOL_ERROR;
+    }
+    
+    *tam_cabeca = protocol_write_header(cabeca, qtd, qtd_16_bits);
+    *tam_cauda = protocol_write_trailer(cauda, protocol_iov_integrity(iov, n, modo), modo);
+    return PROTOCOL_SUCCESS;
+}
+
+// Codificação em partes: protocol_encoder_begin escreve STX + QTD, cada
+// protocol_encoder_append copia um trecho dos dados (ex.: para o espaço
+// livre do anel de envio) e protocol_encoder_finish escreve CHK + ETX. Os
+// primeiros bytes saem antes de os últimos dados existirem, sem uma área do
+// tamanho da mensagem
+int protocol_encoder_begin(ProtocolEncoder* enc, uint16_t qtd, bool qtd_16_bits, ProtocolIntegrity modo,
+                           uint8_t* saida, size_t* tamanho) {
+    if (!enc || !saida || !tamanho || qtd == 0 || modo > PROTOCOL_CRC32 || (!qtd_16_bits && qtd > 0xFF)) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    if (*tamanho < (size_t)(qtd_16_bits ? 3 : 2)) {
+        return PROTOCOL_ERROR;
+    }
+    
+    enc->chk = protocol_integrity_start(modo);
+    enc->qtd = qtd;
+    enc->restantes = qtd;
+    enc->integridade = (uint8_t)modo;
+    *tamanho = protocol_write_header(saida, qtd, qtd_16_bits);
+    return PROTOCOL_SUCCESS;
+}
+
+// Copia até *tamanho bytes do trecho para a saída (saida NULL: os dados já
+// estão onde serão enviados e só entram no CHK) e devolve em *tamanho
+// quantos foram usados; o resto vai na chamada seguinte. Retorna
+// PROTOCOL_WAITING enquanto faltam dados e PROTOCOL_SUCCESS com o último
+int protocol_encoder_append(ProtocolEncoder* enc, const uint8_t* dados, size_t n, uint8_t* saida, size_t* tamanho) {
+    if (!enc || !tamanho || (n > 0 && !dados) || n > enc->restantes) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    if (saida && n > *tamanho) {
+        n = *tamanho;
+    }
+    if (saida && n > 0) {
+        memcpy(saida, dados, n);
+    }
+    enc->chk = protocol_integrity_update(enc->integridade, enc->chk, dados, n);
+    enc->restantes -= (uint16_t)n;
+    
+    *tamanho = n;
+    return enc->restantes == 0 ? PROTOCOL_SUCCESS : PROTOCOL_WAITING;
+}
+
+// CHK + ETX, depois de todos os dados. Retorna PROTOCOL_ERROR se faltam
+// dados ou se a saída não comporta a cauda (até 5 bytes)
+int protocol_encoder_finish(ProtocolEncoder* enc, uint8_t* saida, size_t* tamanho) {
+    if (!enc || !saida || !tamanho) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    if (enc->restantes != 0 || enc->qtd == 0 || *tamanho < (size_t)protocol_tam_chk[enc->integridade] + 1) {
+        return PROTOCOL_ERROR;
+    }
+    
+    ProtocolIntegrity modo = (ProtocolIntegrity)enc->integridade;
+    *tamanho = protocol_write_trailer(saida, protocol_integrity_finish(modo, enc->chk), modo);
+    enc->qtd = 0;
+    return PROTOCOL_SUCCESS;
+}
+
+// ========================================
+// FRAME TEMPLATES
+// ========================================
+
+// O CRC é linear: trocar bytes dos dados muda o CRC pelo CRC (sem valor
+// inicial nem inversão final) da diferença, seguida dos bytes que vêm
+// depois do campo, todos zero. Esses zeros equivalem a multiplicar por
+// x^(8 * bytes) módulo o polinômio, um fator calculado uma vez por campo
+
+// Produto módulo o polinômio do CRC-32, na representação refletida (x^0
+// no bit 31), como crc32_combine do zlib
+static uint32_t protocol_crc32_mult(uint32_t a, uint32_t b) {
+    uint32_t produto = 0;
+    
+    for (uint32_t m = 1u << 31; m != 0; m >>= 1) {
+        if (a & m) {
+            produto ^= b;
+        }
+        b = (b & 1) ? (b >> 1) ^ 0xEDB88320u : b >> 1;
+    }
+    return produto;
+}
+
+// Produto módulo o polinômio do CRC-16/CCITT, na representação direta
+static uint16_t protocol_crc16_mult(uint16_t a, uint16_t b) {
+    uint16_t produto = 0;
+    
+    for (int i = 15; i >= 0; i--) {
+        produto = (uint16_t)((produto & 0x8000) ? (produto << 1) ^ 0x1021 : produto << 1);
+        if ((a >> i) & 1) {
+            produto ^= b;
+        }
+    }
+    return produto;
+}
+
+// x^(8 * bytes) módulo o polinômio do modo
+static uint32_t protocol_crc_shift(uint8_t modo, uint32_t bytes) {
+    uint32_t potencia = (modo == PROTOCOL_CRC32) ? 1u << 31 : 1u;      // x^0
+    uint32_t base = (modo == PROTOCOL_CRC32) ? 1u << 23 : 1u << 8;     // x^8
+    
+    for (; bytes != 0; bytes >>= 1) {
+        if (bytes & 1) {
+            potencia = (modo == PROTOCOL_CRC32) ? protocol_crc32_mult(potencia, base)
+                                                : protocol_crc16_mult((uint16_t)potencia, (uint16_t)base);
+        }
+        base = (modo == PROTOCOL_CRC32) ? protocol_crc32_mult(base, base)
+                                        : protocol_crc16_mult((uint16_t)base, (uint16_t)base);
+    }
+    return potencia;
+}
+
+// Monta a mensagem dos dados no buffer, como protocol_create_frame, e guarda
+// o que os campos precisam para a corrigir depois
+int protocol_template_init(ProtocolTemplate* t, const uint8_t* dados, uint16_t qtd, bool qtd_16_bits,
+                           ProtocolIntegrity modo, uint8_t* buffer, size_t* buffer_size) {
+    if (!t) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    int result = protocol_create_frame(dados, qtd, qtd_16_bits, modo, buffer, buffer_size);
+    if (result != PROTOCOL_SUCCESS) {
+        return result;
+    }
+    
+    t->quadro = buffer;
+    t->tamanho = *buffer_size;
+    t->qtd = qtd;
+    t->inicio = qtd_16_bits ? 3 : 2;
+    t->integridade = (uint8_t)modo;
+    t->chk = protocol_calculate_integrity(modo, dados, qtd);
+    return PROTOCOL_SUCCESS;
+}
+
+// Prepara o campo de tamanho bytes na posição dos dados. Fica válido
+// enquanto o modelo não for iniciado de novo
+int protocol_template_field(const ProtocolTemplate* t, uint16_t posicao, uint16_t tamanho,
+                            ProtocolTemplateField* campo) {
+    if (!t || !t->quadro || !campo || tamanho == 0 || posicao >= t->qtd || tamanho > t->qtd - posicao) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    campo->posicao = posicao;
+    campo->tamanho = tamanho;
+    campo->avanco = (t->integridade == PROTOCOL_SUM8)
+                        ? 0 : protocol_crc_shift(t->integridade, (uint32_t)(t->qtd - posicao - tamanho));
+    return PROTOCOL_SUCCESS;
+}
+
+// Escreve o novo valor do campo no quadro e corrige o CHK: a soma pela
+// diferença dos bytes, o CRC pelo CRC da diferença avançado até o fim dos
+// dados. O custo depende só do tamanho do campo
+int protocol_template_patch(ProtocolTemplate* t, const ProtocolTemplateField* campo, const void* valor) {
+    if (!t || !t->quadro || !campo || !valor) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    uint8_t* p = t->quadro + t->inicio + campo->posicao;
+    const uint8_t* novo = (const uint8_t*)valor;
+    uint32_t diferenca = 0;
+    
+    switch (t->integridade) {
+        case PROTOCOL_CRC16:
+            for (uint16_t i = 0; i < campo->tamanho; i++) {
+                diferenca = (uint16_t)((diferenca << 8) ^ crc16_tabela[0][((diferenca >> 8) ^ p[i] ^ novo[i]) & 0xFF]);
+            }
+            t->chk ^= protocol_crc16_mult((uint16_t)diferenca, (uint16_t)campo->avanco);
+            break;
+        
+        case PROTOCOL_CRC32:
+            for (uint16_t i = 0; i < campo->tamanho; i++) {
+                diferenca = (diferenca >> 8) ^ crc32_tabela[0][(diferenca ^ p[i] ^ novo[i]) & 0xFF];
+            }
+            t->chk ^= protocol_crc32_mult(diferenca, campo->avanco);
+            break;
+        
+        default:
+            t->chk = (uint8_t)(t->chk - protocol_sum8_update(0, p, campo->tamanho) +
+                               protocol_sum8_update(0, novo, campo->tamanho));
+            break;
+    }
+    
+    memcpy(p, novo, campo->tamanho);
+    (void)protocol_write_trailer(t->quadro + t->inicio + t->qtd, t->chk, (ProtocolIntegrity)t->integridade);
+    return PROTOCOL_SUCCESS;
+}
+
+bool protocol_message_ready(ProtocolHandler* handler) {
+    return handler ? handler->message_ready : false;
+}
+
+uint8_t* protocol_get_data(ProtocolHandler* handler) {
+    return handler ? handler->dados : NULL;
+}
+
+uint16_t protocol_get_data_count(ProtocolHandler* handler) {
+    return handler ? handler->qtd_dados : 0;
+}
+
+// ========================================
+// COBS FRAMING
+// ========================================
+
+// Codifica os trechos em grupos: cada grupo é um código (bytes do grupo + 1)
+// seguido de até 254 bytes diferentes de zero; um código menor que 0xFF
+// representa também o 0x00 que vinha após o grupo. Os trechos sem zero são
+// copiados com memcpy. Retorna o número de bytes escritos, com o delimitador
+static size_t protocol_cobs_encode(const ProtocolIovec* iov, int n, uint8_t* saida) {
+    uint8_t* codigo = saida;   // Lugar do código do grupo atual
+    uint8_t* q = saida + 1;
+    size_t grupo = 0;          // Bytes no grupo atual
+    
+    for (int i = 0; i < n; i++) {
+        const uint8_t* p = (const uint8_t*)iov[i].iov_base;
+        size_t len = iov[i].iov_len;
+        
+        while (len > 0) {
+            size_t livre = 254 - grupo;
+            size_t m = len < livre ? len : livre;
+            const uint8_t* z = memchr(p, 0, m);
+            size_t copia = z ? (size_t)(z - p) : m;
+            
+            memcpy(q, p, copia);
+            q += copia;
+            grupo += copia;
+            p += copia;
+            len -= copia;
+            if (z || grupo == 254) {
+                *codigo = (uint8_t)(grupo + 1);
+                codigo = q++;
+                grupo = 0;
+                if (z) {
+                    p++;
+                    len--;
+                }
+            }
+        }
+    }
+    *codigo = (uint8_t)(grupo + 1);
+    *q++ = PROTOCOL_COBS_DELIMITADOR;
+    return (size_t)(q - saida);
+}
+
+// Quadro COBS: dados + CHK (1, 2 ou 4 bytes, alto primeiro) codificados,
+// seguidos do delimitador 0x00. O tamanho do quadro volta em buffer_size;
+// o buffer precisa de PROTOCOL_COBS_TAMANHO(qtd + CHK) bytes
+int protocol_create_cobs_frame(const uint8_t* dados, uint16_t qtd, ProtocolIntegrity modo,
+                               uint8_t* buffer, size_t* buffer_size) {
+    if (!dados || qtd == 0 || !buffer || !buffer_size || modo > PROTOCOL_CRC32) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    size_t tam_chk = protocol_tam_chk[modo];
+    if (*buffer_size < PROTOCOL_COBS_TAMANHO(qtd + tam_chk)) {
+        return PROTOCOL_ERROR;
+    }
+    
+    uint8_t chk[4];
+    uint32_t valor = protocol_calculate_integrity(modo, dados, qtd);
+    for (size_t i = 0; i < tam_chk; i++) {
+        chk[i] = (uint8_t)(valor >> (8 * (tam_chk - 1 - i)));
+    }
+    
+    ProtocolIovec partes[2] = { { dados, qtd }, { chk, tam_chk } };
+    *buffer_size = protocol_cobs_encode(partes, 2, buffer);
+    return PROTOCOL_SUCCESS;
+}
+
+void protocol_cobs_init(ProtocolCobsHandler* handler, uint8_t* area, uint16_t capacidade, ProtocolIntegrity modo) {
+    if (!handler) return;
+    
+    memset(handler, 0, sizeof(*handler));
+    handler->dados = area;
+    handler->capacidade = area ? capacidade : 0;
+    handler->integridade = (uint8_t)(modo > PROTOCOL_CRC32 ? PROTOCOL_SUM8 : modo);
+}
+
+// Confere o CHK dos últimos bytes de um quadro decodificado de tam bytes
+static bool protocol_cobs_check(uint8_t modo, const uint8_t* quadro, size_t tam) {
+    size_t tam_chk = protocol_tam_chk[modo];
+    uint32_t recebido = 0;
+    
+    for (size_t i = tam - tam_chk; i < tam; i++) {
+        recebido = (recebido << 8) | quadro[i];
+    }
+    return recebido == protocol_calculate_integrity((ProtocolIntegrity)modo, quadro, tam - tam_chk);
+}
+
+// Fim do quadro no delimitador: PROTOCOL_SUCCESS com frame apontando para
+// os dados decodificados, PROTOCOL_ERROR para um quadro inválido ou
+// PROTOCOL_WAITING para um delimitador sem quadro (ex.: enchimento da linha)
+static int protocol_cobs_end(ProtocolCobsHandler* handler, const uint8_t* quadro, size_t tam, ProtocolFrame* frame) {
+    ProtocolStats* e = &handler->estatisticas;
+    size_t tam_chk = protocol_tam_chk[handler->integridade];
+    bool truncado = handler->restantes != 0;
+    bool vazio = !handler->em_quadro;
+    
+    handler->dados_count = 0;
+    handler->restantes = 0;
+    handler->em_quadro = false;
+    
+    if (vazio) {
+        return PROTOCOL_WAITING;
+    }
+    if (truncado) {
+        e->erros_etx++;
+        return PROTOCOL_ERROR;
+    }
+    if (tam <= tam_chk) {
+        e->qtd_zero++;
+        return PROTOCOL_ERROR;
+    }
+    if (!protocol_cobs_check(handler->integridade, quadro, tam)) {
+        e->erros_chk++;
+        return PROTOCOL_ERROR;
+    }
+    
+    e->quadros_ok++;
+    frame->data = quadro;
+    frame->len = (uint16_t)(tam - tam_chk);
+    return PROTOCOL_SUCCESS;
+}
+
+/*
+ * Mesmos retornos de protocol_process_view: cada chamada para na primeira
+ * mensagem (PROTOCOL_SUCCESS) ou no primeiro quadro inválido
+ * (PROTOCOL_ERROR), com consumed até o delimitador, e PROTOCOL_WAITING
+ * quando o bloco acaba. Um quadro inteiro no bloco com um só grupo (menos
+ * de 254 bytes, sem zeros nos dados e no CHK) é entregue sem cópia, com
+ * frame apontando para buf; os demais são decodificados para a área, válida
+ * até a próxima chamada. Após um erro ou um quadro maior que a área, os
+ * bytes são descartados até o delimitador seguinte, procurado com memchr.
+ */
+static int protocol_run_cobs(ProtocolCobsHandler* handler, const uint8_t* buf, size_t len, size_t* consumed,
+                             ProtocolFrame* frame) {
+    ProtocolStats* e = &handler->estatisticas;
+    const uint8_t* p = buf;
+    const uint8_t* end = buf + len;
+    
+    while (p < end) {
+        if (handler->descartando) {
+            const uint8_t* z = memchr(p, PROTOCOL_COBS_DELIMITADOR, (size_t)(end - p));
+            if (!z) {
+                e->descartados += (uint32_t)(end - p);
+                break;
+            }
+            e->descartados += (uint32_t)(z - p);
+            p = z + 1;
+            handler->descartando = false;
+            handler->dados_count = 0;
+            handler->restantes = 0;
+            handler->em_quadro = false;
+            continue;
+        }
+        
+        if (handler->restantes == 0) {
+            uint8_t codigo = *p;
+            
+            // Início de quadro com um só grupo, inteiro no bloco: sem cópia
+            if (!handler->em_quadro && codigo != PROTOCOL_COBS_DELIMITADOR && codigo - 1 <= handler->capacidade &&
+                (size_t)(end - p) > codigo && p[codigo] == PROTOCOL_COBS_DELIMITADOR &&
+                !memchr(p + 1, PROTOCOL_COBS_DELIMITADOR, (size_t)codigo - 1)) {
+                handler->em_quadro = true;
+                *consumed = (size_t)(p + codigo + 1 - buf);
+                return protocol_cobs_end(handler, p + 1, (size_t)codigo - 1, frame);
+            }
+            
+            p++;
+            if (codigo == PROTOCOL_COBS_DELIMITADOR) {
+                int result = protocol_cobs_end(handler, handler->dados, handler->dados_count, frame);
+                if (result != PROTOCOL_WAITING) {
+                    *consumed = (size_t)(p - buf);
+                    return result;
+                }
+                continue;
+            }
+            
+            // Novo grupo: o anterior terminava com um 0x00 implícito
+            if (handler->em_quadro && handler->zero) {
+                if (handler->dados_count >= handler->capacidade) {
+                    e->qtd_grande++;
+                    handler->descartando = true;
+                    continue;
+                }
+                handler->dados[handler->dados_count++] = 0;
+            }
+            handler->em_quadro = true;
+            handler->restantes = (uint8_t)(codigo - 1);
+            handler->zero = codigo != 0xFF;
+            continue;
+        }
+        
+        // Bytes do grupo: um 0x00 no meio é o delimitador de um quadro truncado
+        size_t n = (size_t)(end - p) < handler->restantes ? (size_t)(end - p) : handler->restantes;
+        const uint8_t* z = memchr(p, PROTOCOL_COBS_DELIMITADOR, n);
+        if (z) {
+            n = (size_t)(z - p);
+        }
+        if (n > (size_t)(handler->capacidade - handler->dados_count)) {
+            e->qtd_grande++;
+            handler->descartando = true;
+            continue;
+        }
+        memcpy(&handler->dados[handler->dados_count], p, n);
+        handler->dados_count = (uint16_t)(handler->dados_count + n);
+        handler->restantes = (uint8_t)(handler->restantes - n);
+        p += n;
+        if (z) {
+            *consumed = (size_t)(z + 1 - buf);
+            return protocol_cobs_end(handler, handler->dados, handler->dados_count, frame);
+        }
+    }
+    
+    *consumed = len;
+    return PROTOCOL_WAITING;
+}
+
+int protocol_cobs_process_buffer(ProtocolCobsHandler* handler, const uint8_t* buf, size_t len, size_t* consumed,
+                                 ProtocolFrame* frame) {
+    if (!handler || !handler->dados || !consumed || !frame || (!buf && len > 0)) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    int result = protocol_run_cobs(handler, buf, len, consumed, frame);
+    handler->estatisticas.bytes += (uint32_t)*consumed;
+    return result;
+}
+
+#if PROTOCOL_GATEWAY_LINUX
+// ========================================
+// LINUX GATEWAY (EPOLL)
+// ========================================
+
+static void protocol_gateway_arma(ProtocolGateway* gw, uint16_t porta, bool escrita) {
+    struct epoll_event ev = { .events = EPOLLIN | (escrita ? EPOLLOUT : 0u), .data.u32 = porta };
+    
+    epoll_ctl(gw->epoll, EPOLL_CTL_MOD, gw->fds[porta], &ev);
+    gw->armada[porta] = escrita;
+}
+
+// Nenhuma porta aberta. As mensagens de todas as portas vão para callback,
+// com a porta como canal
+int protocol_gateway_init(ProtocolGateway* gw, bool qtd_16_bits, ProtocolIntegrity modo,
+                          ProtocolPoolCallback callback, void* contexto) {
+    if (!gw || !gw->pool || !callback || modo > PROTOCOL_CRC32 || gw->tam_leitura == 0) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    gw->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (gw->epoll < 0) {
+        return PROTOCOL_ERROR;
+    }
+    protocol_pool_init(gw->pool, qtd_16_bits, modo);
+    for (uint16_t porta = 0; porta < gw->pool->canais; porta++) {
+        gw->fds[porta] = -1;
+        gw->pendentes[porta] = 0;
+        gw->armada[porta] = false;
+    }
+    gw->na_fila = 0;
+    gw->callback = callback;
+    gw->contexto = contexto;
+    memset(&gw->estatisticas, 0, sizeof(gw->estatisticas));
+    return PROTOCOL_SUCCESS;
+}
+
+// Acrescenta um descritor já aberto (porta serial, pipe, socket), passado a
+// não bloqueante. Retorna o número da porta, ou PROTOCOL_ERROR sem porta
+// livre
+int protocol_gateway_add_fd(ProtocolGateway* gw, int fd) {
+    if (!gw || gw->epoll < 0 || fd < 0) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    uint16_t porta = 0;
+    while (porta < gw->pool->canais && gw->fds[porta] >= 0) {
+        porta++;
+    }
+    if (porta == gw->pool->canais) {
+        return PROTOCOL_ERROR;
+    }
+    
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = porta };
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 || epoll_ctl(gw->epoll, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        return PROTOCOL_ERROR;
+    }
+    gw->fds[porta] = fd;
+    gw->pendentes[porta] = 0;
+    gw->armada[porta] = false;
+    return porta;
+}
+
+// Abre uma porta serial em modo bruto, 8N1, sem controle de fluxo. No USB
+// CDC a velocidade não muda nada. Um arquivo que não é terminal (ex.: um
+// FIFO gravado de um dispositivo) é lido como está. Retorna o número da
+// porta ou PROTOCOL_ERROR
+int protocol_gateway_open(ProtocolGateway* gw, const char* caminho, speed_t velocidade) {
+    if (!gw || !caminho) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    int fd = open(caminho, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return PROTOCOL_ERROR;
+    }
+    
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(tcflag_t)(CSTOPB | CRTSCTS);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        if (cfsetispeed(&tio, velocidade) < 0 || cfsetospeed(&tio, velocidade) < 0 ||
+            tcsetattr(fd, TCSANOW, &tio) < 0) {
+            close(fd);
+            return PROTOCOL_ERROR;
+        }
+    }
+    
+    int porta = protocol_gateway_add_fd(gw, fd);
+    if (porta < 0) {
+        close(fd);
+    }
+    return porta;
+}
+
+// Fecha a porta: a mensagem em recepção e os envios pendentes se perdem
+void protocol_gateway_close(ProtocolGateway* gw, uint16_t porta) {
+    if (!gw || porta >= gw->pool->canais || gw->fds[porta] < 0) return;
+    
+    epoll_ctl(gw->epoll, EPOLL_CTL_DEL, gw->fds[porta], NULL);
+    close(gw->fds[porta]);
+    gw->fds[porta] = -1;
+    
+    gw->pool->state[porta] = STATE_WAIT_STX;
+    if (gw->pool->dados[porta]) {
+        protocol_pool_devolve(gw->pool, porta);
+    }
+    if (gw->pendentes[porta] > 0) {
+        uint16_t i = 0;
+        while (gw->fila[i] != porta) {
+            i++;
+        }
+        gw->fila[i] = gw->fila[--gw->na_fila];
+        gw->pendentes[porta] = 0;
+    }
+}
+
+// Codifica a mensagem no fim da área de envio da porta, no QTD e no CHK do
+// gateway. Sai na próxima protocol_gateway_flush (ao fim de cada
+// protocol_gateway_poll), junto com as demais da porta. Retorna
+// PROTOCOL_ERROR se a área está cheia
+int protocol_gateway_send(ProtocolGateway* gw, uint16_t porta, const uint8_t* dados, uint16_t qtd) {
+    if (!gw || porta >= gw->pool->canais || gw->fds[porta] < 0 || !dados) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    
+    size_t livre = gw->tam_saida - gw->pendentes[porta];
+    int result = protocol_create_frame(dados, qtd, gw->pool->qtd_16_bits, (ProtocolIntegrity)gw->pool->integridade,
+                                       &gw->saida[(size_t)porta * gw->tam_saida + gw->pendentes[porta]], &livre);
+    if (result != PROTOCOL_SUCCESS) {
+        if (result == PROTOCOL_ERROR) {
+            gw->estatisticas.envios_recusados++;
+        }
+        return result;
+    }
+    
+    if (gw->pendentes[porta] == 0) {
+        gw->fila[gw->na_fila++] = porta;
+    }
+    gw->pendentes[porta] += (uint32_t)livre;
+    return PROTOCOL_SUCCESS;
+}
+
+// Um write por porta com envios pendentes. O que o driver não aceitar fica
+// na área e a porta passa a esperar EPOLLOUT. Retorna o número de portas
+// que ainda têm envios pendentes
+int protocol_gateway_flush(ProtocolGateway* gw) {
+    if (!gw) return PROTOCOL_INVALID_PARAM;
+    
+    uint16_t restantes = 0;
+    
+    for (uint16_t i = 0; i < gw->na_fila; i++) {
+        uint16_t porta = gw->fila[i];
+        uint8_t* area = &gw->saida[(size_t)porta * gw->tam_saida];
+        ssize_t escritos = write(gw->fds[porta], area, gw->pendentes[porta]);
+        
+        if (escritos > 0) {
+            gw->estatisticas.escritas++;
+            gw->estatisticas.bytes_escritos += (uint64_t)escritos;
+            gw->pendentes[porta] -= (uint32_t)escritos;
+            memmove(area, area + escritos, gw->pendentes[porta]);
+        } else if (escritos < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            gw->pendentes[porta] = 0;  // O erro fecha a porta na leitura (EPOLLERR/EPOLLHUP)
+        }
+        
+        if (gw->pendentes[porta] > 0) {
+            gw->fila[restantes++] = porta;
+            if (!gw->armada[porta]) {
+                protocol_gateway_arma(gw, porta, true);
+            }
+        } else if (gw->armada[porta]) {
+            protocol_gateway_arma(gw, porta, false);
+        }
+    }
+    gw->na_fila = restantes;
+    return restantes;
+}
+
+// Grava o bloco lido na captura, com a marca do relógio monotônico, em
+// trechos de até 64 KB (o tamanho de um trecho)
+static void protocol_gateway_grava(ProtocolGateway* gw, uint16_t porta, size_t lidos) {
+    struct timespec agora;
+    
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    uint32_t marca = (uint32_t)((uint64_t)agora.tv_sec * 1000000u + (uint64_t)agora.tv_nsec / 1000u);
+    for (size_t feito = 0; feito < lidos; feito += 0xFFFFu) {
+        size_t n = lidos - feito < 0xFFFFu ? lidos - feito : 0xFFFFu;
+        protocol_capture_grava(gw->captura, marca, porta, &gw->leitura[feito], (uint16_t)n);
+    }
+}
+
+// Passa a gravar os blocos lidos de todas as portas em captura (NULL:
+// para), para reproduzir o tráfego real depois com protocol_capture_replay
+void protocol_gateway_capture(ProtocolGateway* gw, ProtocolCapture* captura) {
+    if (gw) {
+        gw->captura = captura;
+    }
+}
+
+/*
+ * Espera até timeout_ms (-1: sem limite) por portas prontas, lê cada uma em
+ * blocos (até PROTOCOL_GATEWAY_LEITURAS por evento) e entrega as mensagens
+ * ao callback, que pode responder com protocol_gateway_send mas não deve
+ * fechar a própria porta. Fim de arquivo ou erro fecham a porta. No fim,
+ * os envios da rodada saem em protocol_gateway_flush. Retorna o número de
+ * mensagens entregues ou PROTOCOL_ERROR.
+ */
+int protocol_gateway_poll(ProtocolGateway* gw, int timeout_ms) {
+    if (!gw || gw->epoll < 0) return PROTOCOL_INVALID_PARAM;
+    
+    struct epoll_event eventos[PROTOCOL_GATEWAY_EVENTOS];
+    int prontos = epoll_wait(gw->epoll, eventos, PROTOCOL_GATEWAY_EVENTOS, timeout_ms);
+    size_t mensagens = 0;
+    
+    if (prontos < 0) {
+        return errno == EINTR ? 0 : PROTOCOL_ERROR;
+    }
+    
+    for (int e = 0; e < prontos; e++) {
+        uint16_t porta = (uint16_t)eventos[e].data.u32;
+        
+        if (gw->fds[porta] < 0 || !(eventos[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+            continue;  // Só EPOLLOUT: sai no flush
+        }
+        for (int k = 0; k < PROTOCOL_GATEWAY_LEITURAS; k++) {
+            ssize_t lidos = read(gw->fds[porta], gw->leitura, gw->tam_leitura);
+            
+            if (lidos > 0) {
+                gw->estatisticas.leituras++;
+                gw->estatisticas.bytes_lidos += (uint64_t)lidos;
+                if (gw->captura) {
+                    protocol_gateway_grava(gw, porta, (size_t)lidos);
+                }
+                mensagens += protocol_pool_feed(gw->pool, porta, gw->leitura, (size_t)lidos, gw->callback,
+                                                gw->contexto);
+                if ((size_t)lidos < gw->tam_leitura) {
+                    break;  // Esvaziou: sem um read a mais só para receber EAGAIN
+                }
+                continue;
+            }
+            if (lidos == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                protocol_gateway_close(gw, porta);
+                gw->estatisticas.portas_fechadas++;
+            }
+            break;
+        }
+    }
+    
+    gw->estatisticas.mensagens += (uint32_t)mensagens;
+    protocol_gateway_flush(gw);
+    return (int)mensagens;
+}
+
+// Fecha todas as portas e o epoll
+void protocol_gateway_shutdown(ProtocolGateway* gw) {
+    if (!gw || gw->epoll < 0) return;
+    
+    for (uint16_t porta = 0; porta < gw->pool->canais; porta++) {
+        protocol_gateway_close(gw, porta);
+    }
+    close(gw->epoll);
+    gw->epoll = -1;
+}
+#endif
+
+// ========================================
+// PROTOCOL TESTS - TDD IMPLEMENTATION
+// ========================================
+
+static char * executa_testes(void);
+static void mede_desempenho(void);
+static void mede_estresse(void);
+#ifdef PROTOCOL_CAPTURE_ARQUIVO
+static int reproduz_arquivo(const char* caminho);
+#endif
+static int varre_tamanhos(void);
+
+int main() {
+#ifdef PROTOCOL_CAPTURE_ARQUIVO
+    return reproduz_arquivo(PROTOCOL_CAPTURE_ARQUIVO);
+#endif
+    if (PROTOCOL_BENCH_VARREDURA) {
+        return varre_tamanhos();
+    }
+    char *resultado = executa_testes();
+    if (resultado == 0) {
+        mede_desempenho();
+        mede_estresse();
+    }
+    if (resultado != 0) {
+        printf("%s\n", resultado);
+    } else {
+        printf("TODOS OS TESTES PASSARAM\n");
+    }
+    printf("Testes executados: %d\n", testes_executados);
+    protocol_test_resumo();
+
+    return resultado != 0;
+}
+
+/* TESTES BÁSICOS DO PROTOCOLO DE COMUNICAÇÃO */
+/*********************************************/
+
+static char * test_protocol_init(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    verifica("erro: estado inicial deve ser WAIT_STX", handler.state == STATE_WAIT_STX);
+    verifica("erro: message_ready deve ser false", handler.message_ready == false);
+    verifica("erro: dados_count deve ser 0", handler.dados_count == 0);
+    
+    return 0;
+}
+
+static char * test_receive_valid_message(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    // Simular mensagem: STX + QTD(2) + DADOS(0x10,0x20) + CHK(0x30) + ETX
+    protocol_process_byte(&handler, STX_BYTE);      // STX
+    protocol_process_byte(&handler, 2);             // QTD = 2 bytes
+    protocol_process_byte(&handler, 0x10);          // DADO 1
+    protocol_process_byte(&handler, 0x20);          // DADO 2
+    protocol_process_byte(&handler, 0x30);          // CHK = 0x10 + 0x20 = 0x30
+    int result = protocol_process_byte(&handler, ETX_BYTE); // ETX
+    
+    verifica("erro: mensagem deve ser válida", result == PROTOCOL_SUCCESS);
+    verifica("erro: mensagem deve estar pronta", protocol_message_ready(&handler) == true);
+    verifica("erro: quantidade incorreta", protocol_get_data_count(&handler) == 2);
+    verifica("erro: primeiro dado incorreto", handler.dados[0] == 0x10);
+    verifica("erro: segundo dado incorreto", handler.dados[1] == 0x20);
+    
+    return 0;
+}
+
+static char * test_invalid_checksum(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    // Mensagem com checksum incorreto
+    protocol_process_byte(&handler, STX_BYTE);      // STX
+    protocol_process_byte(&handler, 2);             // QTD = 2
+    protocol_process_byte(&handler, 0x10);          // DADO 1
+    protocol_process_byte(&handler, 0x20);          // DADO 2
+    protocol_process_byte(&handler, 0xFF);          // CHK incorreto
+    int result = protocol_process_byte(&handler, ETX_BYTE); // ETX
+    
+    verifica("erro: mensagem deve ser inválida", result == PROTOCOL_ERROR);
+    verifica("erro: mensagem não deve estar pronta", protocol_message_ready(&handler) == false);
+    
+    return 0;
+}
+
+static char * test_invalid_stx(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    // Bytes inválidos antes do STX
+    protocol_process_byte(&handler, 0xFF);
+    protocol_process_byte(&handler, 0x00);
+    verifica("erro: deve permanecer em WAIT_STX", handler.state == STATE_WAIT_STX);
+    
+    // STX válido
+    protocol_process_byte(&handler, STX_BYTE);
+    verifica("erro: deve ir para WAIT_QTD", handler.state == STATE_WAIT_QTD);
+    
+    return 0;
+}
+
+static char * test_create_message(void) {
+    uint8_t dados[] = {0xAA, 0xBB, 0xCC};
+    uint8_t buffer[10];
+    uint8_t buffer_size = 10;
+    
+    int result = protocol_create_message(dados, 3, buffer, &buffer_size);
+    
+    verifica("erro: criação deve ser bem-sucedida", result == PROTOCOL_SUCCESS);
+    verifica("erro: tamanho incorreto", buffer_size == 8); // STX+QTD+3dados+CHK+ETX = 8
+    verifica("erro: STX incorreto", buffer[0] == STX_BYTE);
+    verifica("erro: QTD incorreta", buffer[1] == 3);
+    verifica("erro: primeiro dado incorreto", buffer[2] == 0xAA);
+    verifica("erro: segundo dado incorreto", buffer[3] == 0xBB);
+    verifica("erro: terceiro dado incorreto", buffer[4] == 0xCC);
+    verifica("erro: ETX incorreto", buffer[6] == ETX_BYTE);
+    
+    // O tamanho de uma mensagem de 252 bytes não cabe em 8 bits: recusada,
+    // sem escrever além do buffer
+    static uint8_t grandes[252];
+    uint8_t pequeno[4];
+    buffer_size = sizeof(pequeno);
+    verifica("erro: QTD grande deve ser recusada", protocol_create_message(grandes, 252, pequeno, &buffer_size) == PROTOCOL_ERROR);
+    
+    return 0;
+}
+
+static char * test_calculate_checksum(void) {
+    uint8_t dados[] = {0x10, 0x20, 0x30};
+    uint8_t checksum = protocol_calculate_checksum(dados, 3);
+    
+    verifica("erro: checksum incorreto", checksum == 0x60); // 0x10+0x20+0x30
+    
+    return 0;
+}
+
+static char * test_checksum_alignment(void) {
+    static uint8_t dados[1100];
+    
+    for (int i = 0; i < 1100; i++) {
+        dados[i] = (uint8_t)(0xFF - (i % 3));  // Bytes altos: as faixas enchem rápido
+    }
+    // Todos os alinhamentos e restos, e mais de PROTOCOL_SUM8_PALAVRAS palavras
+    for (size_t inicio = 0; inicio < 4; inicio++) {
+        for (size_t qtd = 1; qtd + inicio <= sizeof(dados); qtd += (qtd < 64 ? 1 : 97)) {
+            uint8_t esperado = 0;
+            for (size_t i = 0; i < qtd; i++) {
+                esperado += dados[inicio + i];
+            }
+            verifica("erro: soma alinhada", protocol_sum8(&dados[inicio], qtd) == esperado);
+        }
+    }
+    return 0;
+}
+
+static char * test_state_transitions(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    // Teste de transições de estado
+    verifica("erro: estado inicial", handler.state == STATE_WAIT_STX);
+    
+    protocol_process_byte(&handler, STX_BYTE);
+    verifica("erro: após STX", handler.state == STATE_WAIT_QTD);
+    
+    protocol_process_byte(&handler, 1);
+    verifica("erro: após QTD", handler.state == STATE_WAIT_DATA);
+    
+    protocol_process_byte(&handler, 0x42);
+    verifica("erro: após dados", handler.state == STATE_WAIT_CHK);
+    
+    protocol_process_byte(&handler, 0x42);
+    verifica("erro: após CHK", handler.state == STATE_WAIT_ETX);
+    
+    return 0;
+}
+
+static char * test_reset_after_message(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    // Processar mensagem completa
+    protocol_process_byte(&handler, STX_BYTE);
+    protocol_process_byte(&handler, 1);
+    protocol_process_byte(&handler, 0x42);
+    protocol_process_byte(&handler, 0x42);
+    protocol_process_byte(&handler, ETX_BYTE);
+    
+    verifica("erro: deve estar em MESSAGE_OK", handler.state == STATE_MESSAGE_OK);
+    
+    // Próximo byte deve resetar
+    protocol_process_byte(&handler, 0x00);
+    verifica("erro: deve resetar para WAIT_STX", handler.state == STATE_WAIT_STX);
+    
+    return 0;
+}
+
+/* TESTES DO PROCESSAMENTO POR BLOCO */
+/*************************************/
+
+static char * test_buffer_valid_message(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    uint8_t bloco[] = {0xFF, 0x00, STX_BYTE, 2, 0x10, 0x20, 0x30, ETX_BYTE, 0xEE};
+    size_t usados = 0;
+    int result = protocol_process_buffer(&handler, bloco, sizeof(bloco), &usados);
+    
+    verifica("erro: bloco: mensagem deve ser válida", result == PROTOCOL_SUCCESS);
+    verifica("erro: bloco: deve parar no ETX", usados == 8);
+    verifica("erro: bloco: quantidade incorreta", protocol_get_data_count(&handler) == 2);
+    verifica("erro: bloco: dados incorretos", handler.dados[0] == 0x10 && handler.dados[1] == 0x20);
+    
+    result = protocol_process_buffer(&handler, bloco + usados, sizeof(bloco) - usados, &usados);
+    verifica("erro: bloco: resto sem mensagem", result == PROTOCOL_WAITING && usados == 1);
+    verifica("erro: bloco: deve voltar a WAIT_STX", handler.state == STATE_WAIT_STX);
+    
+    return 0;
+}
+
+static char * test_buffer_consecutive_messages(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    // Duas mensagens seguidas, sem nenhum byte entre elas
+    uint8_t bloco[] = {STX_BYTE, 1, 0x42, 0x42, ETX_BYTE, STX_BYTE, 2, 0x01, 0x02, 0x03, ETX_BYTE};
+    size_t usados = 0;
+    
+    int result = protocol_process_buffer(&handler, bloco, sizeof(bloco), &usados);
+    verifica("erro: seguidas: primeira deve ser válida", result == PROTOCOL_SUCCESS && usados == 5);
+    verifica("erro: seguidas: primeiro dado", handler.dados[0] == 0x42);
+    
+    size_t total = usados;
+    result = protocol_process_buffer(&handler, bloco + total, sizeof(bloco) - total, &usados);
+    verifica("erro: seguidas: segunda deve ser válida", result == PROTOCOL_SUCCESS);
+    verifica("erro: seguidas: segunda até o fim", total + usados == sizeof(bloco));
+    verifica("erro: seguidas: segunda quantidade", protocol_get_data_count(&handler) == 2);
+    
+    return 0;
+}
+
+static char * test_buffer_split_message(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    // Mensagem dividida entre três blocos, inclusive no meio dos dados
+    uint8_t parte1[] = {STX_BYTE, 4, 0x01};
+    uint8_t parte2[] = {0x02, 0x03};
+    uint8_t parte3[] = {0x04, 0x0A, ETX_BYTE};
+    size_t usados = 0;
+    
+    verifica("erro: dividida: parte 1", protocol_process_buffer(&handler, parte1, sizeof(parte1), &usados) == PROTOCOL_WAITING);
+    verifica("erro: dividida: parte 1 toda usada", usados == sizeof(parte1));
+    verifica("erro: dividida: parte 2", protocol_process_buffer(&handler, parte2, sizeof(parte2), &usados) == PROTOCOL_WAITING);
+    verifica("erro: dividida: parte 3", protocol_process_buffer(&handler, parte3, sizeof(parte3), &usados) == PROTOCOL_SUCCESS);
+    verifica("erro: dividida: dados", memcmp(handler.dados, "\x01\x02\x03\x04", 4) == 0);
+    
+    return 0;
+}
+
+static char * test_buffer_invalid_checksum(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    protocol_init(&handler);
+    
+    uint8_t bloco[] = {STX_BYTE, 2, 0x10, 0x20, 0xFF, ETX_BYTE, STX_BYTE, 1, 0x05, 0x05, ETX_BYTE};
+    size_t usados = 0;
+    
+    int result = protocol_process_buffer(&handler, bloco, sizeof(bloco), &usados);
+    verifica("erro: checksum bloco: deve ser inválida", result == PROTOCOL_ERROR && usados == 6);
+    verifica("erro: checksum bloco: não deve estar pronta", protocol_message_ready(&handler) == false);
+    
+    result = protocol_process_buffer(&handler, bloco + usados, sizeof(bloco) - usados, &usados);
+    verifica("erro: checksum bloco: a seguinte deve ser válida", result == PROTOCOL_SUCCESS);
+    
+    return 0;
+}
+
+static char * test_buffer_invalid_param(void) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    uint8_t byte = STX_BYTE;
+    size_t usados = 0;
+    protocol_init(&handler);
+    
+    verifica("erro: parametro: handler nulo", protocol_process_buffer(NULL, &byte, 1, &usados) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: parametro: bloco nulo", protocol_process_buffer(&handler, NULL, 1, &usados) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: parametro: consumed nulo", protocol_process_buffer(&handler, &byte, 1, NULL) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: parametro: bloco vazio", protocol_process_buffer(&handler, NULL, 0, &usados) == PROTOCOL_WAITING && usados == 0);
+    
+    return 0;
+}
+
+/* TESTES DO PROCESSAMENTO SEM CÓPIA */
+/*************************************/
+
+static char * test_view_in_place(void) {
+    ProtocolViewHandler handler;
+    ProtocolFrame frame;
+    uint8_t reserva[MAX_DATA_SIZE];
+    protocol_view_init(&handler, reserva, sizeof(reserva), false);
+    
+    uint8_t bloco[] = {0xFF, STX_BYTE, 2, 0x10, 0x20, 0x30, ETX_BYTE, STX_BYTE, 1, 0x07, 0x07, ETX_BYTE};
+    size_t usados = 0;
+    
+    int result = protocol_process_view(&handler, bloco, sizeof(bloco), &usados, &frame);
+    verifica("erro: visão: mensagem deve ser válida", result == PROTOCOL_SUCCESS && usados == 7);
+    verifica("erro: visão: deve apontar para o bloco", frame.data == &bloco[3] && frame.len == 2);
+    
+    size_t total = usados;
+    result = protocol_process_view(&handler, bloco + total, sizeof(bloco) - total, &usados, &frame);
+    verifica("erro: visão: segunda deve ser válida", result == PROTOCOL_SUCCESS);
+    verifica("erro: visão: segunda no bloco", frame.data == &bloco[9] && frame.len == 1);
+    verifica("erro: visão: handler sem área de dados", sizeof(ProtocolViewHandler) < MAX_DATA_SIZE / 2);
+    
+    return 0;
+}
+
+static char * test_view_split(void) {
+    ProtocolViewHandler handler;
+    ProtocolFrame frame;
+    uint8_t reserva[MAX_DATA_SIZE];
+    protocol_view_init(&handler, reserva, sizeof(reserva), false);
+    
+    // Dividida nos dados e antes do ETX; o chamador reutiliza o bloco
+    uint8_t bloco[4];
+    size_t usados = 0;
+    
+    memcpy(bloco, (uint8_t[]){STX_BYTE, 3, 0x01, 0x02}, 4);
+    verifica("erro: visão dividida: parte 1", protocol_process_view(&handler, bloco, 4, &usados, &frame) == PROTOCOL_WAITING);
+    memcpy(bloco, (uint8_t[]){0x03, 0x06, 0xEE, 0xEE}, 4);
+    verifica("erro: visão dividida: parte 2", protocol_process_view(&handler, bloco, 2, &usados, &frame) == PROTOCOL_WAITING);
+    memcpy(bloco, (uint8_t[]){ETX_BYTE, 0xEE, 0xEE, 0xEE}, 4);
+    verifica("erro: visão dividida: parte 3", protocol_process_view(&handler, bloco, 1, &usados, &frame) == PROTOCOL_SUCCESS);
+    verifica("erro: visão dividida: deve apontar para a reserva", frame.data == reserva && frame.len == 3);
+    verifica("erro: visão dividida: dados", memcmp(frame.data, "\x01\x02\x03", 3) == 0);
+    
+    // Dividida logo após os dados: ainda precisa da cópia
+    protocol_view_init(&handler, reserva, sizeof(reserva), false);
+    memcpy(bloco, (uint8_t[]){STX_BYTE, 2, 0x21, 0x22}, 4);
+    protocol_process_view(&handler, bloco, 4, &usados, &frame);
+    memcpy(bloco, (uint8_t[]){0x43, ETX_BYTE, 0xEE, 0xEE}, 4);
+    verifica("erro: visão dividida: antes do CHK", protocol_process_view(&handler, bloco, 2, &usados, &frame) == PROTOCOL_SUCCESS);
+    verifica("erro: visão dividida: dados antes do CHK", frame.data == reserva && frame.data[0] == 0x21 && frame.data[1] == 0x22);
+    
+    return 0;
+}
+
+static char * test_view_invalid(void) {
+    ProtocolViewHandler handler;
+    ProtocolFrame frame;
+    uint8_t reserva[MAX_DATA_SIZE];
+    uint8_t bloco[] = {STX_BYTE, 1, 0x10, 0x11, ETX_BYTE};
+    size_t usados = 0;
+    
+    protocol_view_init(&handler, NULL, 0, false);
+    verifica("erro: visão: reserva nula", protocol_process_view(&handler, bloco, sizeof(bloco), &usados, &frame) == PROTOCOL_INVALID_PARAM);
+    
+    protocol_view_init(&handler, reserva, sizeof(reserva), false);
+    verifica("erro: visão: frame nulo", protocol_process_view(&handler, bloco, sizeof(bloco), &usados, NULL) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: visão: checksum inválido", protocol_process_view(&handler, bloco, sizeof(bloco), &usados, &frame) == PROTOCOL_ERROR);
+    
+    return 0;
+}
+
+static char * test_frame_template(void) {
+    uint8_t dados[200], quadro[220], referencia[220];
+    ProtocolTemplate t;
+    ProtocolTemplateField campos[3];
+    static const uint16_t posicoes[3][2] = { { 0, 4 }, { 97, 2 }, { 196, 4 } };  // início, meio e fim
+    
+    for (int modo = PROTOCOL_SUM8; modo <= PROTOCOL_CRC32; modo++) {
+        for (int estendido = 0; estendido < 2; estendido++) {
+            for (int i = 0; i < 200; i++) {
+                dados[i] = (uint8_t)(i * 13 + 5);
+            }
+            
+            size_t tam = sizeof(quadro);
+            verifica("erro: modelo: montagem", protocol_template_init(&t, dados, sizeof(dados), estendido, (ProtocolIntegrity)modo, quadro, &tam) == PROTOCOL_SUCCESS);
+            for (int c = 0; c < 3; c++) {
+                verifica("erro: modelo: campo", protocol_template_field(&t, posicoes[c][0], posicoes[c][1], &campos[c]) == PROTOCOL_SUCCESS);
+            }
+            
+            // Cada troca deve dar a mesma mensagem que montá-la de novo
+            for (uint32_t n = 0; n < 50; n++) {
+                uint32_t valor = n * 0x9E3779B9u;
+                int c = (int)(n % 3);
+                
+                verifica("erro: modelo: troca", protocol_template_patch(&t, &campos[c], &valor) == PROTOCOL_SUCCESS);
+                memcpy(&dados[posicoes[c][0]], &valor, posicoes[c][1]);
+                
+                size_t tam_ref = sizeof(referencia);
+                protocol_create_frame(dados, sizeof(dados), estendido, (ProtocolIntegrity)modo, referencia, &tam_ref);
+                verifica("erro: modelo: mensagem diferente da remontada", tam_ref == t.tamanho && memcmp(quadro, referencia, tam_ref) == 0);
+            }
+        }
+    }
+    
+    verifica("erro: modelo: campo fora dos dados", protocol_template_field(&t, 198, 4, &campos[0]) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: modelo: campo vazio", protocol_template_field(&t, 0, 0, &campos[0]) == PROTOCOL_INVALID_PARAM);
+    
+    return 0;
+}
+
+/* TESTES DO MODO COBS */
+/************************/
+
+// Decodifica o fluxo inteiro em blocos de tam_bloco bytes e devolve as
+// mensagens entregues; a última fica em ultima (até cap bytes)
+static int cobs_decodifica(ProtocolCobsHandler* handler, const uint8_t* fluxo, size_t tamanho, size_t tam_bloco,
+                           uint8_t* ultima, uint16_t* tam_ultima) {
+    int mensagens = 0;
+    
+    for (size_t pos = 0; pos < tamanho; pos += tam_bloco) {
+        size_t n = tamanho - pos < tam_bloco ? tamanho - pos : tam_bloco;
+        size_t feitos = 0, usados;
+        ProtocolFrame frame;
+        
+        while (feitos < n) {
+            int result = protocol_cobs_process_buffer(handler, fluxo + pos + feitos, n - feitos, &usados, &frame);
+            feitos += usados;
+            if (result == PROTOCOL_SUCCESS) {
+                memcpy(ultima, frame.data, frame.len);
+                *tam_ultima = frame.len;
+                mensagens++;
+            }
+        }
+    }
+    return mensagens;
+}
+
+static char * test_cobs_round_trip(void) {
+    static const uint16_t tamanhos[] = { 1, 2, 253, 254, 255, 300, 508 };
+    uint8_t dados[512], quadro[PROTOCOL_COBS_TAMANHO(512 + 4)], area[520], saida[520];
+    ProtocolCobsHandler handler;
+    
+    for (int modo = PROTOCOL_SUM8; modo <= PROTOCOL_CRC32; modo++) {
+        for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]); t++) {
+            for (int zeros = 0; zeros < 2; zeros++) {
+                uint16_t qtd = tamanhos[t], tam_saida = 0;
+                for (uint16_t i = 0; i < qtd; i++) {
+                    dados[i] = zeros ? (uint8_t)(i * 7) : (uint8_t)(1 + i % 255);
+                }
+                
+                size_t tam = sizeof(quadro);
+                verifica("erro: COBS: codificação", protocol_create_cobs_frame(dados, qtd, (ProtocolIntegrity)modo, quadro, &tam) == PROTOCOL_SUCCESS);
+                verifica("erro: COBS: tamanho acima do limite", tam <= PROTOCOL_COBS_TAMANHO(qtd + protocol_tam_chk[modo]));
+                verifica("erro: COBS: zero fora do delimitador", !memchr(quadro, 0, tam - 1) && quadro[tam - 1] == 0);
+                
+                protocol_cobs_init(&handler, area, sizeof(area), (ProtocolIntegrity)modo);
+                verifica("erro: COBS: mensagem não entregue", cobs_decodifica(&handler, quadro, tam, tam, saida, &tam_saida) == 1);
+                verifica("erro: COBS: dados diferentes", tam_saida == qtd && memcmp(saida, dados, qtd) == 0);
+            }
+        }
+    }
+    
+    size_t pequeno = 4;
+    verifica("erro: COBS: buffer pequeno", protocol_create_cobs_frame(dados, 8, PROTOCOL_SUM8, quadro, &pequeno) == PROTOCOL_ERROR);
+    verifica("erro: COBS: mensagem vazia", protocol_create_cobs_frame(dados, 0, PROTOCOL_SUM8, quadro, &pequeno) == PROTOCOL_INVALID_PARAM);
+    
+    return 0;
+}
+
+static char * test_cobs_zero_copy(void) {
+    uint8_t area[64], fluxo[64];
+    ProtocolCobsHandler handler;
+    ProtocolFrame frame;
+    size_t usados, tam = sizeof(fluxo);
+    
+    // Sem zeros e em um só grupo: aponta para o bloco
+    protocol_cobs_init(&handler, area, sizeof(area), PROTOCOL_SUM8);
+    protocol_create_cobs_frame((const uint8_t*)"\x02\x10\x03", 3, PROTOCOL_SUM8, fluxo, &tam);
+    verifica("erro: COBS sem cópia: tamanho", tam == 6);
+    verifica("erro: COBS sem cópia: mensagem", protocol_cobs_process_buffer(&handler, fluxo, tam, &usados, &frame) == PROTOCOL_SUCCESS);
+    verifica("erro: COBS sem cópia: deve apontar para o bloco", frame.data == &fluxo[1] && frame.len == 3 && usados == tam);
+    
+    // Com um zero nos dados: decodificada para a área
+    tam = sizeof(fluxo);
+    protocol_create_cobs_frame((const uint8_t*)"\x11\x00\x22", 3, PROTOCOL_SUM8, fluxo, &tam);
+    verifica("erro: COBS com zero: mensagem", protocol_cobs_process_buffer(&handler, fluxo, tam, &usados, &frame) == PROTOCOL_SUCCESS);
+    verifica("erro: COBS com zero: deve apontar para a área", frame.data == area && frame.len == 3);
+    verifica("erro: COBS com zero: dados", memcmp(frame.data, "\x11\x00\x22", 3) == 0);
+    
+    // Byte a byte: cada grupo atravessa vários blocos
+    uint8_t saida[64];
+    uint16_t tam_saida = 0;
+    verifica("erro: COBS byte a byte", cobs_decodifica(&handler, fluxo, tam, 1, saida, &tam_saida) == 1);
+    verifica("erro: COBS byte a byte: dados", tam_saida == 3 && memcmp(saida, "\x11\x00\x22", 3) == 0);
+    
+    return 0;
+}
+
+static char * test_cobs_resync(void) {
+    uint8_t area[64], fluxo[256], saida[64];
+    ProtocolCobsHandler handler;
+    ProtocolStats e;
+    uint16_t tam_saida = 0;
+    size_t total = 0, tam;
+    
+    // Três quadros com STX e ETX nos dados; o primeiro é corrompido no
+    // código de um grupo, que passa a apontar para além do delimitador
+    for (uint8_t i = 0; i < 3; i++) {
+        uint8_t dados[] = { STX_BYTE, 0x00, ETX_BYTE, (uint8_t)(0x40 + i) };
+        tam = sizeof(fluxo) - total;
+        protocol_create_cobs_frame(dados, sizeof(dados), PROTOCOL_CRC16, fluxo + total, &tam);
+        total += tam;
+    }
+    fluxo[0] = 0x30;
+    
+    protocol_cobs_init(&handler, area, sizeof(area), PROTOCOL_CRC16);
+    verifica("erro: COBS: ressincronia", cobs_decodifica(&handler, fluxo, total, 5, saida, &tam_saida) == 2);
+    verifica("erro: COBS: última mensagem", tam_saida == 4 && saida[3] == 0x42);
+    
+    // Dado trocado: CHK errado, o quadro seguinte é entregue
+    total = 0;
+    for (uint8_t i = 0; i < 2; i++) {
+        tam = sizeof(fluxo) - total;
+        protocol_create_cobs_frame((const uint8_t*)"\x01\x02\x03\x04", 4, PROTOCOL_CRC16, fluxo + total, &tam);
+        total += tam;
+    }
+    fluxo[2] ^= 0x40;
+    protocol_cobs_init(&handler, area, sizeof(area), PROTOCOL_CRC16);
+    verifica("erro: COBS: CHK errado", cobs_decodifica(&handler, fluxo, total, total, saida, &tam_saida) == 1);
+    e = handler.estatisticas;
+    verifica("erro: COBS: contadores", e.erros_chk == 1 && e.quadros_ok == 1 && e.bytes == total);
+    
+    // Quadro maior que a área: descartado até o delimitador
+    uint8_t grande[40];
+    memset(grande, 0x55, sizeof(grande));
+    tam = sizeof(fluxo);
+    protocol_create_cobs_frame(grande, sizeof(grande), PROTOCOL_SUM8, fluxo, &tam);
+    total = tam;
+    tam = sizeof(fluxo) - total;
+    protocol_create_cobs_frame((const uint8_t*)"\x09", 1, PROTOCOL_SUM8, fluxo + total, &tam);
+    total += tam;
+    protocol_cobs_init(&handler, area, 16, PROTOCOL_SUM8);
+    verifica("erro: COBS: quadro grande", cobs_decodifica(&handler, fluxo, total, 7, saida, &tam_saida) == 1);
+    verifica("erro: COBS: após o quadro grande", tam_saida == 1 && saida[0] == 0x09 && handler.estatisticas.qtd_grande == 1);
+    
+    return 0;
+}
+
+/* TESTES DE CAPACIDADE E DO MODO ESTENDIDO */
+/*********************************************/
+
+static char * test_small_capacity(void) {
+    PROTOCOL_HANDLER(handler, 8);
+    protocol_init(&handler);
+    
+    verifica("erro: capacidade: handler sem área embutida", sizeof(handler) < MAX_DATA_SIZE / 2);
+    
+    // 9 bytes não cabem: descartada sem escrever fora da área
+    uint8_t grande[] = {STX_BYTE, 9, 1, 1, 1, 1, 1, 1, 1, 1, 1, 9, ETX_BYTE};
+    uint8_t cabe[] = {STX_BYTE, 8, 1, 1, 1, 1, 1, 1, 1, 1, 8, ETX_BYTE};
+    size_t usados = 0;
+    
+    int result = protocol_process_buffer(&handler, grande, sizeof(grande), &usados);
+    verifica("erro: capacidade: maior deve ser descartada", result == PROTOCOL_WAITING && usados == sizeof(grande));
+    verifica("erro: capacidade: deve voltar a WAIT_STX", handler.state == STATE_WAIT_STX);
+    
+    result = protocol_process_buffer(&handler, cabe, sizeof(cabe), &usados);
+    verifica("erro: capacidade: deve caber", result == PROTOCOL_SUCCESS && protocol_get_data_count(&handler) == 8);
+    
+    protocol_init(&handler);
+    for (size_t i = 0; i < sizeof(grande); i++) {
+        result = protocol_process_byte(&handler, grande[i]);
+    }
+    verifica("erro: capacidade: byte a byte deve descartar", result == PROTOCOL_WAITING && !protocol_message_ready(&handler));
+    
+    return 0;
+}
+
+static char * test_extended_length(void) {
+    static uint8_t dados[1000], mensagem[1005], area[1000], reserva[1000];
+    size_t tamanho = sizeof(mensagem);
+    size_t usados = 0;
+    ProtocolHandler handler;
+    ProtocolViewHandler visao;
+    ProtocolFrame frame;
+    
+    for (int i = 0; i < 1000; i++) {
+        dados[i] = (uint8_t)(i * 7);
+    }
+    verifica("erro: estendido: criação", protocol_create_extended_message(dados, 1000, mensagem, &tamanho) == PROTOCOL_SUCCESS);
+    verifica("erro: estendido: tamanho", tamanho == 1005 && mensagem[1] == 0x03 && mensagem[2] == 0xE8);
+    
+    protocol_init_area(&handler, area, sizeof(area), true);
+    verifica("erro: estendido: bloco", protocol_process_buffer(&handler, mensagem, tamanho, &usados) == PROTOCOL_SUCCESS);
+    verifica("erro: estendido: quantidade", protocol_get_data_count(&handler) == 1000 && usados == tamanho);
+    verifica("erro: estendido: dados", memcmp(area, dados, 1000) == 0);
+    
+    int result = PROTOCOL_WAITING;
+    protocol_init_area(&handler, area, sizeof(area), true);
+    for (size_t i = 0; i < tamanho; i++) {
+        result = protocol_process_byte(&handler, mensagem[i]);
+    }
+    verifica("erro: estendido: byte a byte", result == PROTOCOL_SUCCESS && protocol_get_data_count(&handler) == 1000);
+    
+    protocol_view_init(&visao, reserva, sizeof(reserva), true);
+    verifica("erro: estendido: visão", protocol_process_view(&visao, mensagem, tamanho, &usados, &frame) == PROTOCOL_SUCCESS);
+    verifica("erro: estendido: visão no bloco", frame.data == &mensagem[3] && frame.len == 1000);
+    
+    // Capacidade menor que o QTD: descartada
+    protocol_init_area(&handler, area, 999, true);
+    verifica("erro: estendido: maior que a área", protocol_process_buffer(&handler, mensagem, tamanho, &usados) == PROTOCOL_WAITING);
+    
+    // Sem área, nenhuma mensagem é aceita
+    protocol_init_area(&handler, NULL, 1000, true);
+    verifica("erro: estendido: sem área", protocol_process_buffer(&handler, mensagem, tamanho, &usados) == PROTOCOL_WAITING);
+    
+    return 0;
+}
+
+/* TESTES DOS MODOS DE INTEGRIDADE */
+/*********************************************/
+
+static char * test_integrity_vectors(void) {
+    const uint8_t texto[] = "123456789";
+    
+    // Valores de verificação dos dois CRCs, em todos os alinhamentos do laço
+    verifica("erro: integridade: soma", protocol_calculate_integrity(PROTOCOL_SUM8, texto, 9) == 0xDD);
+    verifica("erro: integridade: CRC-16", protocol_calculate_integrity(PROTOCOL_CRC16, texto, 9) == 0x29B1);
+    verifica("erro: integridade: CRC-32", protocol_calculate_integrity(PROTOCOL_CRC32, texto, 9) == 0xCBF43926);
+    
+    // Acumulado em trechos de todos os tamanhos, o valor é o mesmo
+    for (int modo = PROTOCOL_SUM8; modo <= PROTOCOL_CRC32; modo++) {
+        for (size_t corte = 0; corte <= 9; corte++) {
+            uint32_t valor = protocol_integrity_start((uint8_t)modo);
+            valor = protocol_integrity_update((uint8_t)modo, valor, texto, corte);
+            valor = protocol_integrity_update((uint8_t)modo, valor, &texto[corte], 9 - corte);
+            verifica("erro: integridade: em trechos", protocol_integrity_finish((uint8_t)modo, valor) ==
+                     protocol_calculate_integrity((ProtocolIntegrity)modo, texto, 9));
+        }
+    }
+    return 0;
+}
+
+static char * test_crc_detects_swap(void) {
+    uint8_t dados[] = {0x10, 0x20, 0x30, 0x40};
+    uint8_t trocados[] = {0x20, 0x10, 0x30, 0x40};
+    uint8_t mensagem[16];
+    size_t tamanho = sizeof(mensagem);
+    size_t usados = 0;
+    PROTOCOL_HANDLER(handler, 8);
+    
+    // A soma não vê a troca de dois bytes; o CRC vê
+    verifica("erro: troca: soma igual", protocol_calculate_integrity(PROTOCOL_SUM8, dados, 4) ==
+             protocol_calculate_integrity(PROTOCOL_SUM8, trocados, 4));
+    
+    verifica("erro: troca: criação", protocol_create_frame(dados, 4, false, PROTOCOL_CRC16, mensagem, &tamanho) == PROTOCOL_SUCCESS);
+    verifica("erro: troca: tamanho", tamanho == 9);
+    memcpy(&mensagem[2], trocados, 4);
+    
+    protocol_set_integrity(&handler, PROTOCOL_CRC16);
+    verifica("erro: troca: CRC deve rejeitar", protocol_process_buffer(&handler, mensagem, tamanho, &usados) == PROTOCOL_ERROR);
+    
+    // Com a soma, a mesma troca passa
+    tamanho = sizeof(mensagem);
+    protocol_create_frame(dados, 4, false, PROTOCOL_SUM8, mensagem, &tamanho);
+    memcpy(&mensagem[2], trocados, 4);
+    protocol_set_integrity(&handler, PROTOCOL_SUM8);
+    verifica("erro: troca: soma aceita", protocol_process_buffer(&handler, mensagem, tamanho, &usados) == PROTOCOL_SUCCESS);
+    return 0;
+}
+
+static char * test_crc_frames(void) {
+    static uint8_t dados[300], mensagem[310], area[300], reserva[300];
+    ProtocolHandler handler;
+    ProtocolViewHandler visao;
+    ProtocolFrame frame;
+    
+    for (int i = 0; i < 300; i++) {
+        dados[i] = (uint8_t)(i * 13 + 5);
+    }
+    
+    for (int modo = PROTOCOL_CRC16; modo <= PROTOCOL_CRC32; modo++) {
+        size_t tamanho = sizeof(mensagem);
+        size_t usados = 0;
+        int result = PROTOCOL_WAITING;
+        
+        verifica("erro: CRC: criação", protocol_create_frame(dados, 300, true, (ProtocolIntegrity)modo, mensagem, &tamanho) == PROTOCOL_SUCCESS);
+        verifica("erro: CRC: tamanho", tamanho == 304u + protocol_tam_chk[modo]);
+        
+        protocol_init_area(&handler, area, sizeof(area), true);
+        protocol_set_integrity(&handler, (ProtocolIntegrity)modo);
+        for (size_t i = 0; i < tamanho; i++) {
+            result = protocol_process_byte(&handler, mensagem[i]);
+        }
+        verifica("erro: CRC: byte a byte", result == PROTOCOL_SUCCESS && memcmp(area, dados, 300) == 0);
+        
+        // Dividida em blocos de 7 bytes: o CHK também chega dividido
+        protocol_init_area(&handler, area, sizeof(area), true);
+        protocol_set_integrity(&handler, (ProtocolIntegrity)modo);
+        protocol_view_init(&visao, reserva, sizeof(reserva), true);
+        protocol_view_set_integrity(&visao, (ProtocolIntegrity)modo);
+        int blocos = 0, visoes = 0;
+        for (size_t pos = 0; pos < tamanho; pos += 7) {
+            size_t n = tamanho - pos < 7 ? tamanho - pos : 7;
+            if (protocol_process_buffer(&handler, &mensagem[pos], n, &usados) == PROTOCOL_SUCCESS) blocos++;
+            if (protocol_process_view(&visao, &mensagem[pos], n, &usados, &frame) == PROTOCOL_SUCCESS) visoes++;
+        }
+        verifica("erro: CRC: bloco", blocos == 1 && memcmp(area, dados, 300) == 0);
+        verifica("erro: CRC: visão", visoes == 1 && frame.len == 300 && memcmp(frame.data, dados, 300) == 0);
+        
+        // Um bit trocado do CHK invalida a mensagem
+        mensagem[tamanho - 2] ^= 0x01;
+        protocol_view_init(&visao, reserva, sizeof(reserva), true);
+        protocol_view_set_integrity(&visao, (ProtocolIntegrity)modo);
+        verifica("erro: CRC: CHK inválido", protocol_process_view(&visao, mensagem, tamanho, &usados, &frame) == PROTOCOL_ERROR);
+    }
+    return 0;
+}
+
+/* TESTES DA CAÇA (RESSINCRONIZAÇÃO) */
+/*********************************************/
+
+/* Passa o fluxo pelos três parsers com a caça ligada, o de blocos e o sem
+   cópia em blocos de todos os tamanhos: cada um deve entregar exatamente as
+   mensagens esperadas, em ordem */
+static char * confere_caca(const uint8_t* fluxo, size_t tam, bool qtd_16_bits, const ProtocolFrame* esperadas, int n) {
+    uint8_t area[16], reserva[16];
+    ProtocolHandler handler;
+    ProtocolViewHandler visao;
+    ProtocolFrame frame;
+    int k = 0;
+    
+    protocol_init_area(&handler, area, sizeof(area), qtd_16_bits);
+    protocol_set_resync(&handler, true);
+    for (size_t i = 0; i < tam; i++) {
+        if (protocol_process_byte(&handler, fluxo[i]) == PROTOCOL_SUCCESS) {
+            verifica("erro: caça: byte a byte, mensagem a mais", k < n);
+            verifica("erro: caça: byte a byte, dados", protocol_get_data_count(&handler) == esperadas[k].len &&
+                     memcmp(area, esperadas[k].data, esperadas[k].len) == 0);
+            k++;
+        }
+    }
+    verifica("erro: caça: byte a byte, mensagens", k == n);
+    
+    for (size_t bloco = 1; bloco <= tam; bloco++) {
+        int k_bloco = 0, k_visao = 0;
+        
+        protocol_init_area(&handler, area, sizeof(area), qtd_16_bits);
+        protocol_set_resync(&handler, true);
+        protocol_view_init(&visao, reserva, sizeof(reserva), qtd_16_bits);
+        protocol_view_set_resync(&visao, true);
+        for (size_t pos = 0; pos < tam; pos += bloco) {
+            size_t n_bloco = tam - pos < bloco ? tam - pos : bloco;
+            size_t usados = 0;
+            
+            for (size_t feito = 0; feito < n_bloco; feito += usados) {
+                if (protocol_process_buffer(&handler, &fluxo[pos + feito], n_bloco - feito, &usados) == PROTOCOL_SUCCESS) {
+                    verifica("erro: caça: bloco, mensagem a mais", k_bloco < n);
+                    verifica("erro: caça: bloco, dados", protocol_get_data_count(&handler) == esperadas[k_bloco].len &&
+                             memcmp(area, esperadas[k_bloco].data, esperadas[k_bloco].len) == 0);
+                    k_bloco++;
+                }
+            }
+            for (size_t feito = 0; feito < n_bloco; feito += usados) {
+                if (protocol_process_view(&visao, &fluxo[pos + feito], n_bloco - feito, &usados, &frame) == PROTOCOL_SUCCESS) {
+                    verifica("erro: caça: visão, mensagem a mais", k_visao < n);
+                    verifica("erro: caça: visão, dados", frame.len == esperadas[k_visao].len &&
+                             memcmp(frame.data, esperadas[k_visao].data, frame.len) == 0);
+                    k_visao++;
+                }
+            }
+        }
+        verifica("erro: caça: bloco, mensagens", k_bloco == n);
+        verifica("erro: caça: visão, mensagens", k_visao == n);
+    }
+    return 0;
+}
+
+static char * test_scatter_gather(void) {
+    static uint8_t bloco[200], juntos[204], esperada[220], mensagem[220];
+    const uint8_t cabecalho[4] = { 0x10, 0x20, 0x30, 0x40 };
+    uint8_t cabeca[3], cauda[5];
+    
+    for (int i = 0; i < 200; i++) {
+        bloco[i] = (uint8_t)(i * 7 + 1);
+    }
+    memcpy(juntos, cabecalho, 4);
+    memcpy(&juntos[4], bloco, 200);
+    
+    // Cabeçalho + fragmento vazio + bloco do sensor, cada bloco começando em
+    // um alinhamento diferente
+    ProtocolIovec iov[3] = { { cabecalho, 4 }, { NULL, 0 }, { &bloco[1], 199 } };
+    
+    for (int modo = PROTOCOL_SUM8; modo <= PROTOCOL_CRC32; modo++) {
+        for (int estendido = 0; estendido <= 1; estendido++) {
+            size_t tam_esperada = sizeof(esperada);
+            size_t tamanho = sizeof(mensagem);
+            
+            memcpy(&juntos[4], &bloco[1], 199);
+            verifica("erro: iovec: referência", protocol_create_frame(juntos, 203, estendido, (ProtocolIntegrity)modo, esperada, &tam_esperada) == PROTOCOL_SUCCESS);
+            verifica("erro: iovec: criação", protocol_create_message_v(iov, 3, estendido, (ProtocolIntegrity)modo, mensagem, &tamanho) == PROTOCOL_SUCCESS);
+            verifica("erro: iovec: mensagem", tamanho == tam_esperada && memcmp(mensagem, esperada, tamanho) == 0);
+            
+            // Envelope: cabeça + fragmentos + cauda formam a mesma mensagem
+            size_t tam_cabeca = sizeof(cabeca), tam_cauda = sizeof(cauda);
+            verifica("erro: iovec: envelope", protocol_create_envelope_v(iov, 3, estendido, (ProtocolIntegrity)modo, cabeca, &tam_cabeca, cauda, &tam_cauda) == PROTOCOL_SUCCESS);
+            verifica("erro: iovec: cabeça", tam_cabeca == (estendido ? 3u : 2u) && memcmp(cabeca, esperada, tam_cabeca) == 0);
+            verifica("erro: iovec: cauda", tam_cauda == protocol_tam_chk[modo] + 1u &&
+                     memcmp(cauda, &esperada[tam_cabeca + 203], tam_cauda) == 0);
+        }
+    }
     
+    // Vazio, grande demais para o QTD de 8 bits, fragmento sem dados e
+    // buffers pequenos
+    size_t tamanho = sizeof(mensagem);
+    size_t tam_cabeca = sizeof(cabeca), tam_cauda = sizeof(cauda);
+    ProtocolIovec vazio[1] = { { NULL, 0 } };
+    ProtocolIovec grande[2] = { { bloco, 200 }, { bloco, 56 } };
+    ProtocolIovec sem_base[1] = { { NULL, 4 } };
+    verifica("erro: iovec: vazio", protocol_create_message_v(vazio, 1, false, PROTOCOL_SUM8, mensagem, &tamanho) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: iovec: n", protocol_create_message_v(iov, 0, false, PROTOCOL_SUM8, mensagem, &tamanho) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: iovec: grande", protocol_create_message_v(grande, 2, false, PROTOCOL_SUM8, mensagem, &tamanho) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: iovec: sem base", protocol_create_message_v(sem_base, 1, false, PROTOCOL_SUM8, mensagem, &tamanho) == PROTOCOL_INVALID_PARAM);
+    tamanho = 6;
+    verifica("erro: iovec: buffer", protocol_create_message_v(iov, 3, false, PROTOCOL_SUM8, mensagem, &tamanho) == PROTOCOL_ERROR && tamanho == 6);
+    tam_cauda = 2;
+    verifica("erro: iovec: cauda pequena", protocol_create_envelope_v(iov, 3, false, PROTOCOL_CRC16, cabeca, &tam_cabeca, cauda, &tam_cauda) == PROTOCOL_ERROR);
     return 0;
 }
 
-static char * test_invalid_stx(void) {
+static char * test_streaming_encoder(void) {
+    static uint8_t dados[600], esperada[610], enviada[610], area[600];
+    ProtocolEncoder enc;
     ProtocolHandler handler;
-    protocol_init(&handler);
     
-    // Bytes inválidos antes do STX
-    protocol_process_byte(&handler, 0xFF);
-    protocol_process_byte(&handler, 0x00);
-    verifica("erro: deve permanecer em WAIT_STX", handler.state == STATE_WAIT_STX);
+    for (int i = 0; i < 600; i++) {
+        dados[i] = (uint8_t)(i * 29 + 3);
+    }
     
-    // STX válido
-    protocol_process_byte(&handler, STX_BYTE);
-    verifica("erro: deve ir para WAIT_QTD", handler.state == STATE_WAIT_QTD);
+    for (int modo = PROTOCOL_SUM8; modo <= PROTOCOL_CRC32; modo++) {
+        size_t tam_esperada = sizeof(esperada);
+        protocol_create_frame(dados, 600, true, (ProtocolIntegrity)modo, esperada, &tam_esperada);
+        
+        // Trechos de 37 bytes por uma janela de 16 bytes do anel de envio
+        size_t pos = 0, janela = 16, usados = 0;
+        int result = protocol_encoder_begin(&enc, 600, true, (ProtocolIntegrity)modo, enviada, &janela);
+        verifica("erro: encoder: início", result == PROTOCOL_SUCCESS && janela == 3);
+        pos = janela;
+        for (size_t lido = 0; lido < 600; lido += 37) {
+            size_t trecho = 600 - lido < 37 ? 600 - lido : 37;
+            size_t feitos = 0;
+            while (feitos < trecho) {
+                janela = 16;
+                result = protocol_encoder_append(&enc, &dados[lido + feitos], trecho - feitos, &enviada[pos], &janela);
+                verifica("erro: encoder: trecho", result == PROTOCOL_WAITING || (result == PROTOCOL_SUCCESS && lido + feitos + janela == 600));
+                feitos += janela;
+                pos += janela;
+            }
+        }
+        verifica("erro: encoder: dados a mais", protocol_encoder_append(&enc, dados, 1, &enviada[pos], &janela) == PROTOCOL_INVALID_PARAM);
+        janela = 4;
+        verifica("erro: encoder: cauda pequena", modo != PROTOCOL_CRC32 ||
+                 protocol_encoder_finish(&enc, &enviada[pos], &janela) == PROTOCOL_ERROR);
+        janela = 16;
+        verifica("erro: encoder: fim", protocol_encoder_finish(&enc, &enviada[pos], &janela) == PROTOCOL_SUCCESS);
+        pos += janela;
+        verifica("erro: encoder: mensagem", pos == tam_esperada && memcmp(enviada, esperada, pos) == 0);
+        
+        protocol_init_area(&handler, area, sizeof(area), true);
+        protocol_set_integrity(&handler, (ProtocolIntegrity)modo);
+        verifica("erro: encoder: recepção", protocol_process_buffer(&handler, enviada, pos, &usados) == PROTOCOL_SUCCESS &&
+                 memcmp(area, dados, 600) == 0);
+    }
+    
+    // Dados já no lugar de envio (saida NULL): só o CHK é acumulado
+    size_t janela = 3, tamanho = sizeof(esperada);
+    protocol_create_frame(dados, 10, false, PROTOCOL_CRC16, esperada, &tamanho);
+    protocol_encoder_begin(&enc, 10, false, PROTOCOL_CRC16, enviada, &janela);
+    verifica("erro: encoder: cabeça", janela == 2 && memcmp(enviada, esperada, 2) == 0);
+    janela = 0;
+    verifica("erro: encoder: no lugar", protocol_encoder_append(&enc, dados, 4, NULL, &janela) == PROTOCOL_WAITING && janela == 4);
+    janela = 5;
+    verifica("erro: encoder: incompleta", protocol_encoder_finish(&enc, enviada, &janela) == PROTOCOL_ERROR);
+    verifica("erro: encoder: resto", protocol_encoder_append(&enc, &dados[4], 6, NULL, &janela) == PROTOCOL_SUCCESS);
+    janela = 5;
+    verifica("erro: encoder: cauda", protocol_encoder_finish(&enc, enviada, &janela) == PROTOCOL_SUCCESS &&
+             janela == 3 && memcmp(enviada, &esperada[12], 3) == 0);
     
+    janela = 3;
+    verifica("erro: encoder: QTD", protocol_encoder_begin(&enc, 256, false, PROTOCOL_SUM8, enviada, &janela) == PROTOCOL_INVALID_PARAM);
     return 0;
 }
 
-static char * test_create_message(void) {
-    uint8_t dados[] = {0xAA, 0xBB, 0xCC};
-    uint8_t buffer[10];
-    uint8_t buffer_size = 10;
+// Ruído, uma mensagem válida, uma com CHK errado, uma sem ETX, QTD zero e
+// QTD maior que a área, nos três parsers
+static char * test_stats(void) {
+    static const uint8_t fluxo[] = {
+        0xAA, 0x55, 0x02, 0x02, 0x11, 0x22, 0x33, 0x03,   // ruído + válida
+        0x02, 0x01, 0x10, 0x11, 0x03,                     // CHK errado
+        0x02, 0x01, 0x10, 0x10, 0x04,                     // sem ETX
+        0x02, 0x00,                                       // QTD zero
+        0x02, 0x09,                                       // QTD maior que 8
+        0x02, 0x01, 0x07, 0x07, 0x03                      // válida
+    };
+    uint8_t area[8], reserva[8];
+    ProtocolHandler handler;
+    ProtocolViewHandler visao;
+    ProtocolFrame frame;
+    ProtocolStats e;
     
-    int result = protocol_create_message(dados, 3, buffer, &buffer_size);
+    // Por bloco e sem cópia: só os 2 bytes de ruído são descartados
+    protocol_init_area(&handler, area, sizeof(area), false);
+    protocol_view_init(&visao, reserva, sizeof(reserva), false);
+    for (size_t pos = 0, usados = 0; pos < sizeof(fluxo); pos += usados) {
+        protocol_process_buffer(&handler, &fluxo[pos], sizeof(fluxo) - pos, &usados);
+    }
+    for (size_t pos = 0, usados = 0; pos < sizeof(fluxo); pos += usados) {
+        protocol_process_view(&visao, &fluxo[pos], sizeof(fluxo) - pos, &usados, &frame);
+    }
+    for (int parser = 0; parser < 2; parser++) {
+        if (parser == 0) {
+            protocol_get_stats(&handler, &e);
+        } else {
+            protocol_view_get_stats(&visao, &e);
+        }
+        verifica("erro: estatísticas: ok", e.quadros_ok == 2);
+        verifica("erro: estatísticas: CHK", e.erros_chk == 1);
+        verifica("erro: estatísticas: ETX", e.erros_etx == 1);
+        verifica("erro: estatísticas: QTD", e.qtd_zero == 1 && e.qtd_grande == 1);
+        verifica("erro: estatísticas: descartados", e.descartados == 2);
+        verifica("erro: estatísticas: bytes", e.bytes == sizeof(fluxo));
+    }
     
-    verifica("erro: criação deve ser bem-sucedida", result == PROTOCOL_SUCCESS);
-    verifica("erro: tamanho incorreto", buffer_size == 8); // STX+QTD+3dados+CHK+ETX = 8
-    verifica("erro: STX incorreto", buffer[0] == STX_BYTE);
-    verifica("erro: QTD incorreta", buffer[1] == 3);
-    verifica("erro: primeiro dado incorreto", buffer[2] == 0xAA);
-    verifica("erro: segundo dado incorreto", buffer[3] == 0xBB);
-    verifica("erro: terceiro dado incorreto", buffer[4] == 0xCC);
-    verifica("erro: ETX incorreto", buffer[6] == ETX_BYTE);
+    // Byte a byte: o byte seguinte a cada mensagem também é descartado, e
+    // com ele o STX da mensagem de CHK errado e o da de QTD zero
+    protocol_init_area(&handler, area, sizeof(area), false);
+    for (size_t i = 0; i < sizeof(fluxo); i++) {
+        protocol_process_byte(&handler, fluxo[i]);
+    }
+    protocol_get_stats(&handler, &e);
+    verifica("erro: estatísticas: byte a byte", e.quadros_ok == 2 && e.erros_chk == 0 && e.erros_etx == 1 &&
+             e.qtd_zero == 0 && e.qtd_grande == 1 && e.descartados == 9 && e.bytes == sizeof(fluxo));
     
+    // protocol_init (ou trocar o modo do CHK) mantém os contadores
+    protocol_set_integrity(&handler, PROTOCOL_CRC16);
+    protocol_get_stats(&handler, &e);
+    verifica("erro: estatísticas: mantidas", e.bytes == sizeof(fluxo));
+    protocol_reset_stats(&handler);
+    protocol_view_reset_stats(&visao);
+    protocol_get_stats(&handler, &e);
+    verifica("erro: estatísticas: zeradas", e.bytes == 0 && e.quadros_ok == 0 && visao.estatisticas.bytes == 0);
     return 0;
 }
 
-static char * test_calculate_checksum(void) {
-    uint8_t dados[] = {0x10, 0x20, 0x30};
-    uint8_t checksum = protocol_calculate_checksum(dados, 3);
+#if PROTOCOL_TRACE
+// Com o rastro ligado, os dois parsers gravam as mesmas trocas para a mesma
+// mensagem, e o anel guarda só as mais recentes
+static char * test_trace(void) {
+    const uint8_t mensagem[] = { STX_BYTE, 2, 0x11, 0x22, 0x33, ETX_BYTE };
+    const uint8_t esperado[5][3] = {
+        { STATE_WAIT_STX, STATE_WAIT_QTD, STX_BYTE },
+        { STATE_WAIT_QTD, STATE_WAIT_DATA, 2 },
+        { STATE_WAIT_DATA, STATE_WAIT_CHK, 0x22 },
+        { STATE_WAIT_CHK, STATE_WAIT_ETX, 0x33 },
+        { STATE_WAIT_ETX, STATE_MESSAGE_OK, ETX_BYTE },
+    };
+    static ProtocolTraceRegistro registros[PROTOCOL_TRACE_TAMANHO];
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    size_t usados;
     
-    verifica("erro: checksum incorreto", checksum == 0x60); // 0x10+0x20+0x30
+    for (int parser = 0; parser < 2; parser++) {
+        protocol_init(&handler);
+        protocol_trace_limpa();
+        if (parser == 0) {
+            for (size_t i = 0; i < sizeof(mensagem); i++) {
+                protocol_process_byte(&handler, mensagem[i]);
+            }
+        } else {
+            protocol_process_buffer(&handler, mensagem, sizeof(mensagem), &usados);
+        }
+        verifica("erro: rastro: número de trocas", protocol_trace_le(registros, PROTOCOL_TRACE_TAMANHO) == 5);
+        for (int i = 0; i < 5; i++) {
+            verifica("erro: rastro: troca", registros[i].de == esperado[i][0] && registros[i].para == esperado[i][1] &&
+                     registros[i].byte == esperado[i][2]);
+        }
+    }
     
+    // Mais trocas que o anel: ficam as últimas, da mais antiga à mais recente
+    protocol_trace_limpa();
+    for (int n = 0; n < (int)PROTOCOL_TRACE_TAMANHO; n++) {
+        protocol_process_byte(&handler, 0xFF);  // MESSAGE_OK -> WAIT_STX, depois nada
+        for (size_t i = 0; i < sizeof(mensagem); i++) {
+            protocol_process_byte(&handler, mensagem[i]);
+        }
+    }
+    size_t n = protocol_trace_le(registros, PROTOCOL_TRACE_TAMANHO);
+    verifica("erro: rastro: anel cheio", n == PROTOCOL_TRACE_TAMANHO && protocol_trace.escritos > PROTOCOL_TRACE_TAMANHO);
+    verifica("erro: rastro: mais recente", registros[n - 1].para == STATE_MESSAGE_OK && registros[n - 1].byte == ETX_BYTE);
     return 0;
 }
+#endif
 
-static char * test_state_transitions(void) {
+static char * test_resync_swallowed_frame(void) {
+    // QTD corrompido (12) engole uma mensagem inteira e a seguinte até o
+    // ETX, que vira o seu CHK; depois, uma terceira
+    uint8_t fluxo[] = {0x02, 0x0C, 0x01, 0x02, 0x02, 0xAA, 0xBB, 0x65, 0x03, 0x02, 0x02, 0xCC, 0xDD, 0xA9,
+                       0x03, 0x00, 0xFF, 0xFF, 0x02, 0x01, 0xEE, 0xEE, 0x03};
+    const uint8_t primeira[] = {0xAA, 0xBB}, segunda[] = {0xCC, 0xDD}, terceira[] = {0xEE};
+    const ProtocolFrame esperadas[] = {{primeira, 2}, {segunda, 2}, {terceira, 1}};
+    uint8_t area[16];
     ProtocolHandler handler;
-    protocol_init(&handler);
+    size_t usados = 0;
+    int recebidas = 0;
     
-    // Teste de transições de estado
-    verifica("erro: estado inicial", handler.state == STATE_WAIT_STX);
+    // Sem a caça, a primeira é perdida junto com a corrompida
+    protocol_init_area(&handler, area, sizeof(area), false);
+    for (size_t feito = 0; feito < sizeof(fluxo); feito += usados) {
+        if (protocol_process_buffer(&handler, &fluxo[feito], sizeof(fluxo) - feito, &usados) == PROTOCOL_SUCCESS) {
+            recebidas++;
+        }
+    }
+    verifica("erro: caça: sem ela, só a terceira", recebidas == 1);
     
-    protocol_process_byte(&handler, STX_BYTE);
-    verifica("erro: após STX", handler.state == STATE_WAIT_QTD);
+    return confere_caca(fluxo, sizeof(fluxo), false, esperadas, 3);
+}
+
+static char * test_resync_open_frame(void) {
+    // A mensagem começa dentro da corrompida e termina depois dela
+    uint8_t fluxo[] = {0x02, 0x03, 0x01, 0x02, 0x04, 0x10, 0x20, 0x30, 0x40, 0xA0, 0x03};
+    const uint8_t dados[] = {0x10, 0x20, 0x30, 0x40};
+    const ProtocolFrame esperada = {dados, 4};
     
-    protocol_process_byte(&handler, 1);
-    verifica("erro: após QTD", handler.state == STATE_WAIT_DATA);
+    return confere_caca(fluxo, sizeof(fluxo), false, &esperada, 1);
+}
+
+static char * test_resync_rejected_qtd(void) {
+    // STX espúrio: o STX verdadeiro vira o byte alto do QTD (0x0200, maior que
+    // a área) e a mensagem é encontrada no QTD rejeitado
+    uint8_t fluxo[] = {0x02, 0x02, 0x00, 0x03, 0x01, 0x02, 0x03, 0x06, 0x03};
+    const uint8_t dados[] = {0x01, 0x02, 0x03};
+    const ProtocolFrame esperada = {dados, 3};
     
-    protocol_process_byte(&handler, 0x42);
-    verifica("erro: após dados", handler.state == STATE_WAIT_CHK);
+    return confere_caca(fluxo, sizeof(fluxo), true, &esperada, 1);
+}
+
+/* TESTES DO CONJUNTO DE CANAIS */
+/*********************************************/
+
+static char * test_pool_interleaved(void) {
+    PROTOCOL_POOL(pool, 4, 2, 16);
+    uint8_t fluxo[2][64];
+    size_t tamanho[2] = {0, 0}, pos[2] = {0, 0};
+    int recebidas[2] = {0, 0};
+    ProtocolFrame frame;
+    size_t usados = 0;
     
-    protocol_process_byte(&handler, 0x42);
-    verifica("erro: após CHK", handler.state == STATE_WAIT_ETX);
+    protocol_pool_init(&pool, false, PROTOCOL_CRC16);
+    for (int canal = 0; canal < 2; canal++) {
+        for (int m = 0; m < 4; m++) {
+            uint8_t dados[6];
+            size_t t = sizeof(fluxo[canal]) - tamanho[canal];
+            memset(dados, 0x10 * (canal + 1) + m, sizeof(dados));
+            protocol_create_frame(dados, sizeof(dados), false, PROTOCOL_CRC16, &fluxo[canal][tamanho[canal]], &t);
+            tamanho[canal] += t;
+        }
+    }
+    
+    // Trechos de 5 bytes, alternando os canais: cada um no meio de uma mensagem
+    while (pos[0] < tamanho[0] || pos[1] < tamanho[1]) {
+        for (int canal = 0; canal < 2; canal++) {
+            size_t n = tamanho[canal] - pos[canal] < 5 ? tamanho[canal] - pos[canal] : 5;
+            for (size_t feito = 0; feito < n; feito += usados) {
+                if (protocol_pool_process_buffer(&pool, (uint16_t)canal, &fluxo[canal][pos[canal] + feito], n - feito,
+                                                 &usados, &frame) == PROTOCOL_SUCCESS) {
+                    verifica("erro: canais: dados", frame.len == 6 && frame.data[0] == 0x10 * (canal + 1) + recebidas[canal]);
+                    recebidas[canal]++;
+                }
+            }
+            pos[canal] += n;
+        }
+    }
+    verifica("erro: canais: mensagens", recebidas[0] == 4 && recebidas[1] == 4);
+    
+    // Em uma terceira mensagem simultânea não há bloco: ela é descartada
+    uint8_t inicio[] = {0x02, 0x03, 0x01};
+    for (uint16_t canal = 0; canal < 3; canal++) {
+        protocol_pool_process_buffer(&pool, canal, inicio, sizeof(inicio), &usados, &frame);
+    }
+    verifica("erro: canais: blocos em uso", pool.blocos_livres == 0 && pool.dados[2] == NULL &&
+             pool.state[2] == STATE_WAIT_STX);
     
+    // Mensagens concluídas (aqui, com erro) devolvem os blocos
+    uint8_t fim[] = {0x02, 0x03, 0x00, 0x00, 0x03};
+    protocol_pool_process_buffer(&pool, 0, fim, sizeof(fim), &usados, &frame);
+    protocol_pool_process_buffer(&pool, 1, fim, sizeof(fim), &usados, &frame);
+    verifica("erro: canais: blocos devolvidos", pool.blocos_livres == 2);
     return 0;
 }
 
-static char * test_reset_after_message(void) {
-    ProtocolHandler handler;
+typedef struct {
+    int mensagens[4];
+    bool dados_corretos;
+} ContagemCanais;
+
+static void conta_canal(void* contexto, uint16_t canal, const ProtocolFrame* frame) {
+    ContagemCanais* contagem = contexto;
+    
+    contagem->mensagens[canal]++;
+    if (frame->len != 1 || frame->data[0] != canal + 0x40) {
+        contagem->dados_corretos = false;
+    }
+}
+
+static char * test_pool_sweep(void) {
+    PROTOCOL_POOL(pool, 4, 2, 8);
+    uint8_t quadros[4][6];
+    const uint8_t* blocos[4];
+    size_t tamanhos[4];
+    ContagemCanais contagem = {{0, 0, 0, 0}, true};
+    
+    protocol_pool_init(&pool, false, PROTOCOL_SUM8);
+    for (int canal = 0; canal < 4; canal++) {
+        uint8_t dado = (uint8_t)(canal + 0x40);
+        uint8_t t = sizeof(quadros[canal]);
+        protocol_create_message(&dado, 1, quadros[canal], &t);
+        blocos[canal] = quadros[canal];
+        tamanhos[canal] = t;
+    }
+    tamanhos[3] = 0;  // Nada recebido no canal 3
+    
+    // Mais canais que blocos: cada mensagem é tratada e o bloco devolvido
+    size_t mensagens = protocol_pool_process(&pool, blocos, tamanhos, conta_canal, &contagem);
+    verifica("erro: varredura: mensagens", mensagens == 3 && contagem.dados_corretos);
+    verifica("erro: varredura: por canal", contagem.mensagens[0] == 1 && contagem.mensagens[2] == 1 &&
+             contagem.mensagens[3] == 0);
+    verifica("erro: varredura: blocos livres", pool.blocos_livres == 2);
+    
+    // Estado por canal muito menor que um handler com área própria
+    size_t por_canal = sizeof(uint8_t) * 2 + sizeof(uint16_t) * 2 + sizeof(uint32_t) * 2 + sizeof(uint8_t*);
+    verifica("erro: varredura: estado por canal", por_canal < (sizeof(ProtocolHandler) + MAX_DATA_SIZE) / 8);
+    return 0;
+}
+
+/* REPRODUÇÃO DE CAPTURAS */
+/*********************************************/
+
+// Parsers da reprodução, no protocolo básico (QTD de 8 bits, soma): um
+// handler com o parser de bloco por canal, ou o conjunto de canais. Canais
+// acima de CAPTURA_CANAIS são ignorados
+#define CAPTURA_CANAIS 256
+
+static ProtocolHandler captura_handlers[CAPTURA_CANAIS];
+static uint8_t captura_areas[CAPTURA_CANAIS][MAX_DATA_SIZE];
+PROTOCOL_POOL(captura_pool, CAPTURA_CANAIS, 64, MAX_DATA_SIZE);
+
+static void prepara_reproducao(void) {
+    for (int canal = 0; canal < CAPTURA_CANAIS; canal++) {
+        protocol_init_area(&captura_handlers[canal], captura_areas[canal], MAX_DATA_SIZE, false);
+    }
+    protocol_pool_init(&captura_pool, false, PROTOCOL_SUM8);
+}
+
+static int reproduz_bloco(void* contexto, uint16_t canal, const uint8_t* bytes, size_t tamanho) {
+    int validas = 0;
+    size_t usados;
+    (void)contexto;
+    
+    if (canal >= CAPTURA_CANAIS) return 0;
+    while (tamanho > 0) {
+        if (protocol_process_buffer(&captura_handlers[canal], bytes, tamanho, &usados) == PROTOCOL_SUCCESS) {
+            validas++;
+        }
+        bytes += usados;
+        tamanho -= usados;
+    }
+    return validas;
+}
+
+static void conta_reproduzida(void* contexto, uint16_t canal, const ProtocolFrame* frame) {
+    (void)canal;
+    (void)frame;
+    (*(int*)contexto)++;
+}
+
+static int reproduz_conjunto(void* contexto, uint16_t canal, const uint8_t* bytes, size_t tamanho) {
+    int validas = 0;
+    (void)contexto;
+    
+    if (canal >= CAPTURA_CANAIS) return 0;
+    protocol_pool_feed(&captura_pool, canal, bytes, tamanho, conta_reproduzida, &validas);
+    return validas;
+}
+
+// Reproduz a captura nos dois parsers e imprime uma linha de cada. Retorna
+// 0 se a captura está inteira e os dois acharam as mesmas mensagens
+static int reproduz_captura(const uint8_t* dados, size_t tamanho, bool tempo_real) {
+    ProtocolCaptureResultado bloco, conjunto;
+    
+    prepara_reproducao();
+    bool inteira = protocol_capture_replay(dados, tamanho, reproduz_bloco, NULL, tempo_real, &bloco);
+    inteira &= protocol_capture_replay(dados, tamanho, reproduz_conjunto, NULL, tempo_real, &conjunto);
+    protocol_capture_imprime("t2 blocos", &bloco);
+    protocol_capture_imprime("t2 conjunto", &conjunto);
+    if (!inteira) {
+        printf("Captura cortada ou corrompida\n");
+    }
+    return inteira && bloco.mensagens == conjunto.mensagens ? 0 : 1;
+}
+
+#ifdef PROTOCOL_CAPTURE_ARQUIVO
+// Só reproduz o arquivo, sem os testes:
+//   gcc -O2 -DPROTOCOL_CAPTURE_ARQUIVO='"trafego.cap"' atividade_entrega_fms.c
+// Com -DPROTOCOL_CAPTURE_TEMPO_REAL=1, na velocidade gravada
+#ifndef PROTOCOL_CAPTURE_TEMPO_REAL
+#define PROTOCOL_CAPTURE_TEMPO_REAL 0
+#endif
+
+static int reproduz_arquivo(const char* caminho) {
+    static uint8_t area[64u << 20];
+    size_t tamanho = protocol_capture_carrega(caminho, area, sizeof(area));
+    
+    if (tamanho == 0) {
+        printf("Captura %s: não abriu ou passa de 64 MB\n", caminho);
+        return 1;
+    }
+    return reproduz_captura(area, tamanho, PROTOCOL_CAPTURE_TEMPO_REAL);
+}
+#endif
+
+static char * test_captura(void) {
+    uint8_t area[128], quadros[2][16];
+    size_t tam[2];
+    ProtocolCapture captura;
+    ProtocolCaptureLeitor leitor;
+    ProtocolCaptureTrecho trecho;
+    ProtocolCaptureResultado r;
+    
+    // Duas mensagens por canal, em trechos de 3 bytes intercalados, a cada 500 µs
+    for (int m = 0; m < 2; m++) {
+        uint8_t dados[5] = { 1, 2, 3, 4, (uint8_t)m };
+        tam[m] = sizeof(quadros[m]);
+        protocol_create_frame(dados, sizeof(dados), false, PROTOCOL_SUM8, quadros[m], &tam[m]);
+    }
+    verifica("erro: captura: inicia", protocol_capture_inicia(&captura, area, sizeof(area)));
+    uint32_t marca = 1000000u;
+    for (int m = 0; m < 2; m++) {
+        for (size_t pos = 0; pos < tam[m]; pos += 3) {
+            uint16_t n = (uint16_t)(tam[m] - pos < 3 ? tam[m] - pos : 3);
+            protocol_capture_grava(&captura, marca, 0, &quadros[m][pos], n);
+            protocol_capture_grava(&captura, marca + 100, 7, &quadros[m][pos], n);
+            marca += 500;
+        }
+    }
+    verifica("erro: captura: trechos", tam[0] == 9 && captura.trechos == 12 && captura.perdidos == 0);
+    
+    // Marcas contadas do primeiro trecho
+    verifica("erro: captura: abre", protocol_capture_abre(&leitor, area, captura.tamanho));
+    verifica("erro: captura: primeiro", protocol_capture_proximo(&leitor, &trecho) == 1 && trecho.marca_us == 0 &&
+             trecho.canal == 0 && trecho.tamanho == 3 && memcmp(trecho.bytes, quadros[0], 3) == 0);
+    verifica("erro: captura: segundo", protocol_capture_proximo(&leitor, &trecho) == 1 && trecho.marca_us == 100 &&
+             trecho.canal == 7);
+    
+    // Os dois parsers, na velocidade máxima e na gravada (3 ms)
+    prepara_reproducao();
+    verifica("erro: captura: blocos", protocol_capture_replay(area, captura.tamanho, reproduz_bloco, NULL, false, &r) &&
+             r.mensagens == 4 && r.trechos == 12 && r.bytes == 2u * (tam[0] + tam[1]));
+    prepara_reproducao();
+    verifica("erro: captura: tempo real", protocol_capture_replay(area, captura.tamanho, reproduz_conjunto, NULL, true, &r) &&
+             r.mensagens == 4 && r.segundos >= 0.0025);
+    
+    // Cortada no meio de um trecho, ou de outro formato
+    verifica("erro: captura: cortada", !protocol_capture_replay(area, captura.tamanho - 1, reproduz_bloco, NULL, false, &r));
+    area[4] = 9;
+    verifica("erro: captura: versão", !protocol_capture_abre(&leitor, area, captura.tamanho));
+    
+    // Área cheia: o trecho que não cabe é perdido inteiro
+    protocol_capture_inicia(&captura, area, 14);
+    verifica("erro: captura: cabe", protocol_capture_grava(&captura, 0, 300, quadros[0], 3));
+    verifica("erro: captura: cheia", !protocol_capture_grava(&captura, 0, 0, quadros[0], 3) && captura.perdidos == 1 &&
+             captura.tamanho == 12);
+    return 0;
+}
+
+#if PROTOCOL_GATEWAY_LINUX
+/* TESTES DO GATEWAY LINUX */
+/*********************************************/
+
+typedef struct {
+    ProtocolGateway* gw;
+    int mensagens[3];
+    bool dados_corretos;
+} EcoGateway;
+
+// Conta e devolve cada mensagem à porta de origem
+static void eco_gateway(void* contexto, uint16_t porta, const ProtocolFrame* frame) {
+    EcoGateway* eco = contexto;
+    
+    eco->mensagens[porta]++;
+    if (frame->len != 2 || frame->data[0] != 0x30 + porta) {
+        eco->dados_corretos = false;
+    }
+    protocol_gateway_send(eco->gw, porta, frame->data, frame->len);
+}
+
+static char * test_gateway(void) {
+    PROTOCOL_GATEWAY(gw, 3, 3, 16, 64, 256);
+    EcoGateway eco = { &gw, {0, 0, 0}, true };
+    uint8_t area[256];
+    ProtocolCapture captura;
+    ProtocolCaptureResultado r;
+    int pares[3][2];
+    uint8_t quadros[3][2][7], resposta[64];  // 7 bytes: 2 dados e CRC16
+    size_t tam = 0;
+    
+    verifica("erro: gateway: init", protocol_gateway_init(&gw, false, PROTOCOL_CRC16, eco_gateway, &eco) == PROTOCOL_SUCCESS);
+    protocol_capture_inicia(&captura, area, sizeof(area));
+    protocol_gateway_capture(&gw, &captura);
+    verifica("erro: gateway: porta inexistente", protocol_gateway_open(&gw, "/nao/existe", B115200) == PROTOCOL_ERROR);
+    for (int porta = 0; porta < 3; porta++) {
+        verifica("erro: gateway: socketpair", socketpair(AF_UNIX, SOCK_STREAM, 0, pares[porta]) == 0);
+        verifica("erro: gateway: porta", protocol_gateway_add_fd(&gw, pares[porta][0]) == porta);
+        for (int m = 0; m < 2; m++) {
+            uint8_t dados[2] = { (uint8_t)(0x30 + porta), (uint8_t)m };
+            tam = sizeof(quadros[porta][m]);
+            protocol_create_frame(dados, sizeof(dados), false, PROTOCOL_CRC16, quadros[porta][m], &tam);
+        }
+    }
+    
+    // Porta 0: duas mensagens juntas; porta 1: uma dividida em duas rodadas;
+    // porta 2: lixo antes da mensagem
+    uint8_t lixo[] = { 0x55, 0x03, 0xAA };
+    verifica("erro: gateway: escrita", write(pares[0][1], quadros[0], 2 * tam) == (ssize_t)(2 * tam));
+    verifica("erro: gateway: escrita", write(pares[1][1], quadros[1][0], 3) == 3);
+    verifica("erro: gateway: escrita", write(pares[2][1], lixo, sizeof(lixo)) == sizeof(lixo) &&
+             write(pares[2][1], quadros[2][0], tam) == (ssize_t)tam);
+    int mensagens = protocol_gateway_poll(&gw, 100);
+    verifica("erro: gateway: primeira rodada", mensagens == 3 && eco.mensagens[0] == 2 && eco.mensagens[1] == 0);
+    verifica("erro: gateway: escrita", write(pares[1][1], &quadros[1][0][3], tam - 3) == (ssize_t)(tam - 3));
+    mensagens = protocol_gateway_poll(&gw, 100);
+    verifica("erro: gateway: segunda rodada", mensagens == 1 && eco.mensagens[1] == 1 && eco.dados_corretos);
+    
+    // Os dois ecos da porta 0 saem num só write, iguais ao que foi enviado
+    verifica("erro: gateway: ecos juntos", gw.estatisticas.escritas == 3 && gw.na_fila == 0);
+    verifica("erro: gateway: eco da porta 0", read(pares[0][1], resposta, sizeof(resposta)) == (ssize_t)(2 * tam) &&
+             memcmp(resposta, quadros[0], 2 * tam) == 0);
+    verifica("erro: gateway: eco da porta 2", read(pares[2][1], resposta, sizeof(resposta)) == (ssize_t)tam &&
+             memcmp(resposta, quadros[2][0], tam) == 0);
+    
+    // Cada read ficou na captura, com os bytes e a porta
+    verifica("erro: gateway: captura", captura.trechos == gw.estatisticas.leituras && captura.perdidos == 0);
+    protocol_gateway_capture(&gw, NULL);
+    prepara_reproducao();
+    protocol_capture_replay(area, captura.tamanho, reproduz_conjunto, NULL, false, &r);
+    verifica("erro: gateway: reprodução", r.bytes == gw.estatisticas.bytes_lidos && r.trechos == captura.trechos);
+    
+    // A área de envio cheia recusa a mensagem
+    uint8_t grande[60] = {0};
+    verifica("erro: gateway: envio cabe", protocol_gateway_send(&gw, 1, grande, 50) == PROTOCOL_SUCCESS);
+    verifica("erro: gateway: envio recusado", protocol_gateway_send(&gw, 1, grande, 50) == PROTOCOL_ERROR &&
+             gw.estatisticas.envios_recusados == 1);
+    
+    // O outro lado fechado fecha a porta, com o bloco e os envios pendentes
+    close(pares[1][1]);
+    verifica("erro: gateway: escrita", write(pares[2][1], quadros[2][1], 4) == 4);
+    protocol_gateway_poll(&gw, 100);
+    verifica("erro: gateway: porta fechada", gw.fds[1] < 0 && gw.estatisticas.portas_fechadas == 1);
+    close(pares[2][1]);
+    protocol_gateway_poll(&gw, 100);
+    verifica("erro: gateway: blocos devolvidos", gw.fds[2] < 0 && gw.pool->blocos_livres == 3);
+    
+    protocol_gateway_shutdown(&gw);
+    close(pares[0][1]);
+    verifica("erro: gateway: encerrado", gw.fds[0] < 0 && gw.epoll < 0);
+    return 0;
+}
+#endif
+
+/* Gera um fluxo de mensagens com lixo entre elas */
+static size_t gera_fluxo(uint8_t* fluxo, size_t tamanho, int* mensagens) {
+    size_t pos = 0;
+    uint8_t semente = 7;
+    *mensagens = 0;
+    
+    while (pos + 5 + 255 + 3 < tamanho) {
+        uint8_t dados[255];
+        uint8_t qtd = (uint8_t)(16 + (semente % 200));
+        uint8_t msg_size = 255;
+        
+        for (int i = 0; i < qtd; i++) {
+            semente = (uint8_t)(semente * 13 + 5);
+            dados[i] = semente;
+        }
+        protocol_create_message(dados, qtd, &fluxo[pos], &msg_size);
+        pos += msg_size;
+        (*mensagens)++;
+        
+        fluxo[pos++] = 0xFF;  // Lixo entre mensagens
+        fluxo[pos++] = 0x00;
+        fluxo[pos++] = 0x55;
+    }
+    return pos;
+}
+
+static int conta_byte_a_byte(const uint8_t* fluxo, size_t tamanho) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    int validas = 0;
     protocol_init(&handler);
     
-    // Processar mensagem completa
-    protocol_process_byte(&handler, STX_BYTE);
-    protocol_process_byte(&handler, 1);
-    protocol_process_byte(&handler, 0x42);
-    protocol_process_byte(&handler, 0x42);
-    protocol_process_byte(&handler, ETX_BYTE);
+    for (size_t i = 0; i < tamanho; i++) {
+        if (protocol_process_byte(&handler, fluxo[i]) == PROTOCOL_SUCCESS) {
+            validas++;
+        }
+    }
+    return validas;
+}
+
+static int conta_por_bloco(const uint8_t* fluxo, size_t tamanho, size_t tam_bloco) {
+    PROTOCOL_HANDLER(handler, MAX_DATA_SIZE);
+    int validas = 0;
+    protocol_init(&handler);
     
-    verifica("erro: deve estar em MESSAGE_OK", handler.state == STATE_MESSAGE_OK);
+    for (size_t inicio = 0; inicio < tamanho; inicio += tam_bloco) {
+        size_t restante = (tamanho - inicio) < tam_bloco ? (tamanho - inicio) : tam_bloco;
+        const uint8_t* p = fluxo + inicio;
+        size_t usados;
+        
+        while (restante > 0) {
+            if (protocol_process_buffer(&handler, p, restante, &usados) == PROTOCOL_SUCCESS) {
+                validas++;
+            }
+            p += usados;
+            restante -= usados;
+        }
+    }
+    return validas;
+}
+
+/* Os blocos são copiados para uma área reutilizada, como os blocos do DMA,
+   e os dados de cada mensagem apontada são conferidos pelo checksum */
+static int conta_sem_copia(const uint8_t* fluxo, size_t tamanho, size_t tam_bloco, uint8_t* area, bool confere) {
+    ProtocolViewHandler handler;
+    ProtocolFrame frame;
+    uint8_t reserva[MAX_DATA_SIZE];
+    int validas = 0;
+    protocol_view_init(&handler, reserva, sizeof(reserva), false);
     
-    // Próximo byte deve resetar
-    protocol_process_byte(&handler, 0x00);
-    verifica("erro: deve resetar para WAIT_STX", handler.state == STATE_WAIT_STX);
+    for (size_t inicio = 0; inicio < tamanho; inicio += tam_bloco) {
+        size_t restante = (tamanho - inicio) < tam_bloco ? (tamanho - inicio) : tam_bloco;
+        const uint8_t* p = fluxo + inicio;
+        size_t usados;
+        
+        if (area) {
+            memcpy(area, p, restante);
+            p = area;
+        }
+        while (restante > 0) {
+            if (protocol_process_view(&handler, p, restante, &usados, &frame) == PROTOCOL_SUCCESS &&
+                (!confere || protocol_calculate_checksum((uint8_t*)frame.data, frame.len) == handler.checksum_recv)) {
+                validas++;
+            }
+            p += usados;
+            restante -= usados;
+        }
+    }
+    return validas;
+}
+
+static uint8_t fluxo_teste[64 * 1024];
+static const uint8_t* volatile fluxo_medido = fluxo_teste;  // Impede o compilador de medir uma só vez
+
+static char * test_buffer_matches_byte_parser(void) {
+    int mensagens;
+    size_t tamanho = gera_fluxo(fluxo_teste, sizeof(fluxo_teste), &mensagens);
+    
+    verifica("erro: fluxo: byte a byte", conta_byte_a_byte(fluxo_teste, tamanho) == mensagens);
+    verifica("erro: fluxo: blocos de 64", conta_por_bloco(fluxo_teste, tamanho, 64) == mensagens);
+    verifica("erro: fluxo: blocos de 1", conta_por_bloco(fluxo_teste, tamanho, 1) == mensagens);
+    verifica("erro: fluxo: bloco único", conta_por_bloco(fluxo_teste, tamanho, tamanho) == mensagens);
+    
+    uint8_t area[64];
+    verifica("erro: fluxo: sem cópia, blocos de 64", conta_sem_copia(fluxo_teste, tamanho, 64, area, true) == mensagens);
+    verifica("erro: fluxo: sem cópia, blocos de 1", conta_sem_copia(fluxo_teste, tamanho, 1, area, true) == mensagens);
+    verifica("erro: fluxo: sem cópia, bloco único", conta_sem_copia(fluxo_teste, tamanho, tamanho, NULL, true) == mensagens);
+    
+    return 0;
+}
+
+/* Orçamentos de tempo dos analisadores nos 64 KB de fluxo, bem acima do
+   medido (cerca de 20x) para só reprovar regressões grosseiras, como um
+   laço por byte voltando ao caminho em bloco */
+static char * test_time_budget(void) {
+    int mensagens;
+    size_t tamanho = gera_fluxo(fluxo_teste, sizeof(fluxo_teste), &mensagens);
+    
+    verifica_tempo("erro: tempo: byte a byte, 64 KB", conta_byte_a_byte(fluxo_medido, tamanho), 6000000);
+    verifica_tempo("erro: tempo: blocos de 64, 64 KB", conta_por_bloco(fluxo_medido, tamanho, 64), 1000000);
+    verifica_tempo("erro: tempo: bloco único, 64 KB", conta_por_bloco(fluxo_medido, tamanho, tamanho), 1000000);
     
     return 0;
 }
 
+// Parsers nos fluxos de protocol_bench.h, comparáveis aos de t3 e t4
+static int mede_byte_a_byte(void* contexto, const uint8_t* fluxo, size_t tamanho) {
+    (void)contexto;
+    return conta_byte_a_byte(fluxo, tamanho);
+}
+
+static int mede_por_bloco(void* contexto, const uint8_t* fluxo, size_t tamanho) {
+    return conta_por_bloco(fluxo, tamanho, *(const size_t*)contexto);
+}
+
+// protocol_create_message na varredura de tamanhos: o quadro sem a folga
+static size_t codifica_mensagem(const uint8_t* dados, uint8_t qtd, uint8_t* quadro) {
+    uint8_t tamanho = (uint8_t)(qtd + PROTOCOL_FRAME_ENVELOPE);
+    
+    if (qtd > 0xFF - PROTOCOL_FRAME_ENVELOPE ||
+        protocol_create_message((uint8_t*)dados, qtd, quadro, &tamanho) != PROTOCOL_SUCCESS) {
+        return 0;
+    }
+    return (size_t)qtd + 4;
+}
+
+// Codificador e parsers em cada tamanho de dados (PROTOCOL_BENCH_VARREDURA)
+static int varre_tamanhos(void) {
+    size_t bloco_dma = 64;
+    int divergente = protocol_bench_varredura("t2 switch", codifica_mensagem, mede_byte_a_byte, NULL);
+    
+    divergente |= protocol_bench_varredura("t2 blocos de 64", codifica_mensagem, mede_por_bloco, &bloco_dma);
+    return divergente;
+}
+
+/* Compara a taxa dos analisadores no mesmo fluxo, em um bloco contíguo */
+#if PROTOCOL_GATEWAY_LINUX
+// Gateway com GATEWAY_PORTAS portas (pares de sockets no lugar das seriais):
+// a cada rodada, o outro lado de cada porta escreve GATEWAY_LOTE mensagens
+// de uma vez, e cada mensagem recebe uma resposta de 1 byte
+#define GATEWAY_PORTAS 256
+#define GATEWAY_LOTE 32
+#define GATEWAY_RODADAS 100
+
+PROTOCOL_GATEWAY(gateway_medido, GATEWAY_PORTAS, GATEWAY_PORTAS, 64, 4096, 16384);
+
+static void responde_gateway(void* contexto, uint16_t porta, const ProtocolFrame* frame) {
+    (void)contexto;
+    protocol_gateway_send(&gateway_medido, porta, frame->data, 1);
+}
+
+static void mede_gateway(void) {
+    static int outro_lado[GATEWAY_PORTAS];
+    static uint8_t lote[GATEWAY_LOTE * 40], respostas[4096], area[512 * 1024];
+    ProtocolCapture captura;
+    size_t tam_lote = 0;
+    int portas = 0;
+    struct timespec inicio, fim;
+    
+    protocol_gateway_init(&gateway_medido, false, PROTOCOL_SUM8, responde_gateway, NULL);
+    for (; portas < GATEWAY_PORTAS; portas++) {
+        int par[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, par) < 0) break;  // Limite de descritores
+        protocol_gateway_add_fd(&gateway_medido, par[0]);
+        outro_lado[portas] = par[1];
+    }
+    for (int m = 0; m < GATEWAY_LOTE; m++) {
+        uint8_t dados[32];
+        size_t t = sizeof(lote) - tam_lote;
+        memset(dados, m, sizeof(dados));
+        protocol_create_frame(dados, sizeof(dados), false, PROTOCOL_SUM8, &lote[tam_lote], &t);
+        tam_lote += t;
+    }
+    
+    // A primeira rodada fica gravada, para reproduzir nos parsers
+    protocol_capture_inicia(&captura, area, sizeof(area));
+    protocol_gateway_capture(&gateway_medido, &captura);
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (int r = 0; r < GATEWAY_RODADAS; r++) {
+        long esperadas = (long)portas * GATEWAY_LOTE;
+        for (int p = 0; p < portas; p++) {
+            if (write(outro_lado[p], lote, tam_lote) != (ssize_t)tam_lote) esperadas -= GATEWAY_LOTE;
+        }
+        while (esperadas > 0) {
+            int n = protocol_gateway_poll(&gateway_medido, 1000);
+            if (n <= 0) break;
+            esperadas -= n;
+        }
+        for (int p = 0; p < portas; p++) {
+            while (read(outro_lado[p], respostas, sizeof(respostas)) == (ssize_t)sizeof(respostas)) {
+            }
+        }
+        protocol_gateway_capture(&gateway_medido, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    
+    const ProtocolGatewayStats* e = &gateway_medido.estatisticas;
+    double t = (double)(fim.tv_sec - inicio.tv_sec) + (double)(fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    if (t > 0 && e->leituras > 0 && e->escritas > 0) {
+        printf("Gateway: %d portas, %.0f mensagens/s, %.0f MB/s recebidos, %.0f bytes por read, "
+               "%.1f respostas por write\n", portas, e->mensagens / t, (double)e->bytes_lidos / 1e6 / t,
+               (double)e->bytes_lidos / e->leituras, (double)e->mensagens / e->escritas);
+    }
+    protocol_gateway_shutdown(&gateway_medido);
+    for (int p = 0; p < portas; p++) {
+        close(outro_lado[p]);
+    }
+    reproduz_captura(area, captura.tamanho, false);
+}
+#endif
+
+static void mede_desempenho(void) {
+    int mensagens, validas = 0;
+    size_t tamanho = gera_fluxo(fluxo_teste, sizeof(fluxo_teste), &mensagens);
+    const int repeticoes = 200;
+    clock_t inicio;
+    double t_byte, t_bloco, t_visao;
+    
+    inicio = clock();
+    for (int r = 0; r < repeticoes; r++) {
+        validas += conta_byte_a_byte(fluxo_medido, tamanho);
+    }
+    t_byte = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+    
+    inicio = clock();
+    for (int r = 0; r < repeticoes; r++) {
+        validas += conta_por_bloco(fluxo_medido, tamanho, tamanho);
+    }
+    t_bloco = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+    
+    inicio = clock();
+    for (int r = 0; r < repeticoes; r++) {
+        validas += conta_sem_copia(fluxo_medido, tamanho, tamanho, NULL, false);
+    }
+    t_visao = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+    
+    if (t_byte > 0 && t_bloco > 0 && t_visao > 0) {
+        double mb = (double)tamanho * repeticoes / 1e6;
+        printf("Desempenho: byte a byte %.0f MB/s, por bloco %.0f MB/s (%.1fx), sem cópia %.0f MB/s (%.1fx), %d mensagens\n",
+               mb / t_byte, mb / t_bloco, t_byte / t_bloco, mb / t_visao, t_byte / t_visao, validas);
+    }
+    
+    size_t bloco_dma = 64;
+    protocol_bench_executa("t2 switch", mede_byte_a_byte, NULL, 100);
+    protocol_bench_executa("t2 blocos de 64", mede_por_bloco, &bloco_dma, 100);
+#if PROTOCOL_GATEWAY_LINUX
+    mede_gateway();
+#endif
+}
+
+/* ESTRESSE: FLUXO ALEATÓRIO DE ALTO VOLUME */
+/*********************************************/
+
+// Quadros sorteados por modo de integridade, com semente fixa: exceto a
+// taxa, os números de cada linha se comparam entre commits
+#ifndef PROTOCOL_ESTRESSE_QUADROS
+#define PROTOCOL_ESTRESSE_QUADROS 1000000u
+#endif
+
+typedef enum {
+    ESTRESSE_VALIDO = 0,    // 1 a 64 dados, ou 255 em 1 de 16
+    ESTRESSE_CORROMPIDO,    // Válido com 1 a 3 bytes trocados
+    ESTRESSE_TRUNCADO,      // Válido cortado nos dados
+    ESTRESSE_LIXO,          // 8 a 40 bytes aleatórios (com STX possíveis)
+    ESTRESSE_NUM_TIPOS
+} EstresseTipo;
+
+typedef struct {
+    uint32_t inicio;        // Posição na rodada
+    uint32_t fim;
+    uint8_t qtd;            // QTD original (válidos e corrompidos)
+    uint8_t tipo;           // EstresseTipo
+} EstresseRegistro;
+
+typedef struct {
+    uint32_t gerados[ESTRESSE_NUM_TIPOS];
+    uint32_t entregues;         // Válidos entregues
+    uint32_t perdidos;          // Válidos não entregues
+    uint32_t nao_detectados;    // Corrompidos entregues como válidos
+    uint32_t falsos;            // Entregues que não foram enviados (achados no lixo ou nos cortes)
+    uint32_t ressincronizacoes; // Quadros entregues depois de uma perturbação
+    uint64_t latencia_total;    // Bytes do fim da perturbação ao início do quadro entregue
+    uint32_t latencia_maxima;
+    uint64_t bytes;
+    double segundos;            // Só o parser, sem a geração e a conferência
+} EstresseResultado;
+
+// Conferência das mensagens entregues contra os registros da rodada
+typedef struct {
+    const uint8_t* fluxo;
+    const EstresseRegistro* registros;
+    size_t n_registros;
+    size_t cursor;              // Primeiro registro ainda não conferido
+    uint64_t base;              // Posição da rodada no fluxo inteiro
+    uint64_t fim_perturbacao;   // Fim da última perturbação sem quadro entregue depois (UINT64_MAX: nenhuma)
+    EstresseResultado* r;
+} EstresseConferencia;
+
+#define ESTRESSE_RODADA (64u * 1024u)
+#define ESTRESSE_JANELA 16      // Registros à frente em que uma mensagem entregue é procurada
+
+static uint8_t estresse_fluxo[ESTRESSE_RODADA];
+static EstresseRegistro estresse_registros[ESTRESSE_RODADA / 3];
+
+// Linha ociosa no fim de cada rodada, sem STX e mais longa que um quadro:
+// a rodada termina com o parser aguardando STX e a caça sem pendências
+#define ESTRESSE_PAUSA (5 + 255 + 4)
+
+// Gera uma rodada (os quadros não passam do fim dela) e retorna o tamanho
+static size_t estresse_gera(ProtocolIntegrity modo, uint32_t* semente, uint32_t* restantes, size_t* n_registros,
+                            EstresseResultado* r) {
+    size_t pos = 0, n = 0;
+    
+    while (*restantes > 0 && pos + 5 + 255 + 4 + ESTRESSE_PAUSA <= ESTRESSE_RODADA) {
+        uint32_t sorteio = protocol_bench_aleatorio(semente) % 10;
+        EstresseTipo tipo = sorteio == 0 ? ESTRESSE_CORROMPIDO : sorteio == 1 ? ESTRESSE_TRUNCADO :
+                            sorteio == 2 ? ESTRESSE_LIXO : ESTRESSE_VALIDO;
+        uint8_t* quadro = &estresse_fluxo[pos];
+        size_t tam = ESTRESSE_RODADA - pos;
+        uint8_t qtd = 0;
+        
+        if (tipo == ESTRESSE_LIXO) {
+            tam = 8 + protocol_bench_aleatorio(semente) % 33;
+            for (size_t i = 0; i < tam; i++) {
+                quadro[i] = (uint8_t)protocol_bench_aleatorio(semente);
+            }
+        } else {
+            uint8_t dados[255];
+            qtd = protocol_bench_aleatorio(semente) % 16 == 0 ? 255 : (uint8_t)(1 + protocol_bench_aleatorio(semente) % 64);
+            for (int i = 0; i < qtd; i++) {
+                dados[i] = (uint8_t)protocol_bench_aleatorio(semente);
+            }
+            protocol_create_frame(dados, qtd, false, modo, quadro, &tam);
+            
+            if (tipo == ESTRESSE_CORROMPIDO) {
+                // Posições distintas, e cada troca muda o byte
+                size_t trocas = 1 + protocol_bench_aleatorio(semente) % 3, posicoes[3];
+                for (size_t t = 0; t < trocas; t++) {
+                    bool repetida;
+                    do {
+                        posicoes[t] = protocol_bench_aleatorio(semente) % tam;
+                        repetida = false;
+                        for (size_t k = 0; k < t; k++) {
+                            repetida |= posicoes[k] == posicoes[t];
+                        }
+                    } while (repetida);
+                    quadro[posicoes[t]] ^= (uint8_t)(1 + protocol_bench_aleatorio(semente) % 255);
+                }
+            } else if (tipo == ESTRESSE_TRUNCADO) {
+                tam = 3 + protocol_bench_aleatorio(semente) % qtd;  // Sem o CHK e o ETX
+            }
+        }
+        
+        estresse_registros[n++] = (EstresseRegistro){ (uint32_t)pos, (uint32_t)(pos + tam), qtd, (uint8_t)tipo };
+        r->gerados[tipo]++;
+        pos += tam;
+        (*restantes)--;
+    }
+    memset(&estresse_fluxo[pos], 0xFF, ESTRESSE_PAUSA);
+    *n_registros = n;
+    return pos + ESTRESSE_PAUSA;
+}
+
+// Registros conferidos sem mensagem entregue: válidos perdidos, e o fim da
+// perturbação a partir do qual a ressincronização é medida
+static void estresse_avanca(EstresseConferencia* c, size_t ate) {
+    for (; c->cursor < ate; c->cursor++) {
+        const EstresseRegistro* reg = &c->registros[c->cursor];
+        if (reg->tipo == ESTRESSE_VALIDO) {
+            c->r->perdidos++;
+        } else {
+            c->fim_perturbacao = c->base + reg->fim;
+        }
+    }
+}
+
+// Procura a mensagem entregue entre os próximos registros, pelos dados
+static void estresse_confere(EstresseConferencia* c, const uint8_t* dados, uint16_t qtd) {
+    size_t limite = c->cursor + ESTRESSE_JANELA < c->n_registros ? c->cursor + ESTRESSE_JANELA : c->n_registros;
+    
+    for (size_t k = c->cursor; k < limite; k++) {
+        const EstresseRegistro* reg = &c->registros[k];
+        if ((reg->tipo == ESTRESSE_VALIDO || reg->tipo == ESTRESSE_CORROMPIDO) && reg->qtd == qtd &&
+            memcmp(&c->fluxo[reg->inicio + 2], dados, qtd) == 0) {
+            estresse_avanca(c, k);
+            c->cursor = k + 1;
+            if (reg->tipo == ESTRESSE_CORROMPIDO) {
+                c->r->nao_detectados++;
+                c->fim_perturbacao = c->base + reg->fim;
+                return;
+            }
+            c->r->entregues++;
+            if (c->fim_perturbacao != UINT64_MAX) {
+                uint64_t latencia = c->base + reg->inicio - c->fim_perturbacao;
+                c->r->ressincronizacoes++;
+                c->r->latencia_total += latencia;
+                if (latencia > c->r->latencia_maxima) {
+                    c->r->latencia_maxima = (uint32_t)latencia;
+                }
+                c->fim_perturbacao = UINT64_MAX;
+            }
+            return;
+        }
+    }
+    c->r->falsos++;
+}
+
+// Passa a rodada pelo parser de bloco em blocos de 1 a 512 bytes, como os
+// de um DMA; com a conferência, confere cada mensagem entregue
+static void estresse_processa(ProtocolHandler* handler, size_t tamanho, uint32_t semente_blocos,
+                              EstresseConferencia* c) {
+    size_t pos = 0, usados;
+    
+    while (pos < tamanho) {
+        size_t restante = 1 + protocol_bench_aleatorio(&semente_blocos) % 512;
+        const uint8_t* p = &estresse_fluxo[pos];
+        if (restante > tamanho - pos) {
+            restante = tamanho - pos;
+        }
+        pos += restante;
+        
+        while (restante > 0) {
+            if (protocol_process_buffer(handler, p, restante, &usados) == PROTOCOL_SUCCESS && c) {
+                estresse_confere(c, protocol_get_data(handler), protocol_get_data_count(handler));
+            }
+            p += usados;
+            restante -= usados;
+        }
+    }
+    
+    // Mensagens achadas na caça que ainda estão pendentes
+    while (protocol_process_buffer(handler, estresse_fluxo, 0, &usados) == PROTOCOL_SUCCESS) {
+        if (c) {
+            estresse_confere(c, protocol_get_data(handler), protocol_get_data_count(handler));
+        }
+    }
+}
+
+static void estresse_executa(ProtocolIntegrity modo, EstresseResultado* r) {
+    static PROTOCOL_HANDLER(medido, MAX_DATA_SIZE);
+    static PROTOCOL_HANDLER(conferido, MAX_DATA_SIZE);
+    uint32_t semente = 59u, restantes = PROTOCOL_ESTRESSE_QUADROS;
+    EstresseConferencia c = { estresse_fluxo, estresse_registros, 0, 0, 0, UINT64_MAX, r };
+    
+    memset(r, 0, sizeof(*r));
+    protocol_set_integrity(&medido, modo);
+    protocol_set_integrity(&conferido, modo);
+    protocol_init(&medido);
+    protocol_init(&conferido);
+    protocol_set_resync(&medido, true);
+    protocol_set_resync(&conferido, true);
+    
+    while (restantes > 0) {
+        uint32_t semente_blocos = semente;
+        size_t tamanho = estresse_gera(modo, &semente, &restantes, &c.n_registros, r);
+        
+        clock_t inicio = clock();
+        estresse_processa(&medido, tamanho, semente_blocos, NULL);
+        r->segundos += (double)(clock() - inicio) / CLOCKS_PER_SEC;
+        
+        c.cursor = 0;
+        estresse_processa(&conferido, tamanho, semente_blocos, &c);
+        estresse_avanca(&c, c.n_registros);
+        if (c.fim_perturbacao != UINT64_MAX) {
+            c.fim_perturbacao = c.base + tamanho;  // A pausa já é ociosa
+        }
+        c.base += tamanho;
+        r->bytes += tamanho;
+    }
+}
+
+/* Fluxo de PROTOCOL_ESTRESSE_QUADROS quadros válidos, corrompidos, truncados
+   e de lixo pelo encoder e pelo parser de bloco com a caça, em cada modo de
+   integridade: taxa, quadros perdidos, erros não detectados e bytes até a
+   ressincronização depois de cada perturbação */
+static void mede_estresse(void) {
+    static const char* const nomes[] = { "SUM8", "CRC16", "CRC32" };
+    
+    for (int modo = PROTOCOL_SUM8; modo <= PROTOCOL_CRC32; modo++) {
+        EstresseResultado r;
+        estresse_executa((ProtocolIntegrity)modo, &r);
+        
+        uint32_t quadros = 0;
+        for (int t = 0; t < ESTRESSE_NUM_TIPOS; t++) {
+            quadros += r.gerados[t];
+        }
+        printf("Estresse %s: %u quadros (%u válidos, %u corrompidos, %u truncados, %u de lixo), %.1f MB\n",
+               nomes[modo], quadros, r.gerados[ESTRESSE_VALIDO], r.gerados[ESTRESSE_CORROMPIDO],
+               r.gerados[ESTRESSE_TRUNCADO], r.gerados[ESTRESSE_LIXO], (double)r.bytes / 1e6);
+        printf("  entregues %u, perdidos %u, não detectados %u (detecção %.4f%%), falsos %u\n",
+               r.entregues, r.perdidos, r.nao_detectados,
+               100.0 * (1.0 - (double)r.nao_detectados / (r.gerados[ESTRESSE_CORROMPIDO] ? r.gerados[ESTRESSE_CORROMPIDO] : 1)),
+               r.falsos);
+        printf("  ressincronização: %u vezes, média %.2f bytes, máxima %u bytes",
+               r.ressincronizacoes, r.ressincronizacoes ? (double)r.latencia_total / r.ressincronizacoes : 0.0,
+               r.latencia_maxima);
+        if (r.segundos > 0) {
+            printf(", %.0f MB/s", (double)r.bytes / r.segundos / 1e6);
+        }
+        printf("\n");
+    }
+}
+
 /***********************************************/
 
 static char * executa_testes(void) {
@@ -349,8 +4426,43 @@ static char * executa_testes(void) {
     executa_teste(test_invalid_stx);
     executa_teste(test_create_message);
     executa_teste(test_calculate_checksum);
+    executa_teste(test_checksum_alignment);
     executa_teste(test_state_transitions);
     executa_teste(test_reset_after_message);
+    executa_teste(test_buffer_valid_message);
+    executa_teste(test_buffer_consecutive_messages);
+    executa_teste(test_buffer_split_message);
+    executa_teste(test_buffer_invalid_checksum);
+    executa_teste(test_buffer_invalid_param);
+    executa_teste(test_view_in_place);
+    executa_teste(test_view_split);
+    executa_teste(test_view_invalid);
+    executa_teste(test_cobs_round_trip);
+    executa_teste(test_cobs_zero_copy);
+    executa_teste(test_cobs_resync);
+    executa_teste(test_small_capacity);
+    executa_teste(test_extended_length);
+    executa_teste(test_integrity_vectors);
+    executa_teste(test_crc_detects_swap);
+    executa_teste(test_crc_frames);
+    executa_teste(test_scatter_gather);
+    executa_teste(test_streaming_encoder);
+    executa_teste(test_frame_template);
+    executa_teste(test_stats);
+#if PROTOCOL_TRACE
+    executa_teste(test_trace);
+#endif
+    executa_teste(test_resync_swallowed_frame);
+    executa_teste(test_resync_open_frame);
+    executa_teste(test_resync_rejected_qtd);
+    executa_teste(test_pool_interleaved);
+    executa_teste(test_pool_sweep);
+    executa_teste(test_captura);
+#if PROTOCOL_GATEWAY_LINUX
+    executa_teste(test_gateway);
+#endif
+    executa_teste(test_buffer_matches_byte_parser);
+    executa_teste(test_time_budget);
     
     return 0;
 }
@@ -4,6 +4,12 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "../comum/protocol_checksum.h"
+#include "../comum/protocol_frame.h"
+#include "../comum/protocol_bench.h"
+#include "../comum/protocol_trace.h"
+#include "../comum/protocol_test.h"  // verifica, verifica_tempo e executa_teste (minUnit)
+
 // Protocol constants
 #define STX_BYTE 0x02
 #define ETX_BYTE 0x03
@@ -15,12 +21,6 @@
 #define PROTOCOL_WAITING -2
 #define PROTOCOL_INVALID_PARAM -3
 
-/* macros de testes - baseado em minUnit: www.jera.com/techinfo/jtns/jtn002.html */
-#define verifica(mensagem, teste) do { if (!(teste)) return mensagem; } while (0)
-#define executa_teste(teste) do { char *mensagem = teste(); testes_executados++; \
-                                if (mensagem) return mensagem; } while (0)
-int testes_executados = 0;
-
 // ========================================
 // FUNCTION POINTER STATE MACHINE IMPLEMENTATION
 // ========================================
@@ -40,16 +40,18 @@ typedef enum {
     NUM_STATES     // Total number of states
 } ProtocolStates;
 
+// As funções de estado ficam numa tabela única (state_functions), e o
+// handler guarda só o índice do estado: os campos usados a cada byte vêm
+// juntos no início, antes do buffer
 struct ProtocolHandler {
-    ProtocolStates current_state;      // Estado atual (índice)
-    StateFunction state_functions[NUM_STATES]; // Array de ponteiros para funções
+    uint8_t current_state;             // Estado atual (ProtocolStates, índice da tabela)
     uint8_t qtd_dados;                 // Quantidade esperada de dados
-    uint8_t dados[MAX_DATA_SIZE];      // Buffer para dados recebidos
     uint8_t dados_count;               // Contador de dados recebidos
     uint8_t checksum_recv;             // Checksum recebido
     uint8_t checksum_calc;             // Checksum calculado
     bool message_ready;                // Flag de mensagem pronta
     int last_result;                   // Último resultado de processamento
+    uint8_t dados[MAX_DATA_SIZE];      // Buffer para dados recebidos
 };
 
 // ========================================
@@ -62,12 +64,24 @@ int state_wait_data(ProtocolHandler* handler, uint8_t byte);
 int state_wait_chk(ProtocolHandler* handler, uint8_t byte);
 int state_wait_etx(ProtocolHandler* handler, uint8_t byte);
 
+// Tabela de despacho constante (na flash do microcontrolador), indexada por
+// current_state e compartilhada por todos os handlers
+static const StateFunction state_functions[NUM_STATES] = {
+    [ST_STX] = state_wait_stx,
+    [ST_QTD] = state_wait_qtd,
+    [ST_DATA] = state_wait_data,
+    [ST_CHK] = state_wait_chk,
+    [ST_ETX] = state_wait_etx,
+};
+
 // ========================================
 // PROTOCOL FUNCTION DECLARATIONS
 // ========================================
 
 void protocol_init(ProtocolHandler* handler);
 int protocol_process_byte(ProtocolHandler* handler, uint8_t byte);
+int protocol_process_byte_matrix(ProtocolHandler* handler, uint8_t byte);
+int protocol_process_buffer(ProtocolHandler* handler, const uint8_t* buf, size_t len, size_t* consumed);
 int protocol_create_message(uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size);
 uint8_t protocol_calculate_checksum(uint8_t* dados, uint8_t qtd);
 bool protocol_message_ready(ProtocolHandler* handler);
@@ -140,13 +154,6 @@ int state_wait_etx(ProtocolHandler* handler, uint8_t byte) {
 void protocol_init(ProtocolHandler* handler) {
     if (!handler) return;
     
-    // Initialize state function pointers
-    handler->state_functions[ST_STX] = state_wait_stx;
-    handler->state_functions[ST_QTD] = state_wait_qtd;
-    handler->state_functions[ST_DATA] = state_wait_data;
-    handler->state_functions[ST_CHK] = state_wait_chk;
-    handler->state_functions[ST_ETX] = state_wait_etx;
-    
     // Initialize state and data
     handler->current_state = ST_STX;
     handler->qtd_dados = 0;
@@ -171,46 +178,297 @@ void protocol_reset(ProtocolHandler* handler) {
 int protocol_process_byte(ProtocolHandler* handler, uint8_t byte) {
     if (!handler) return PROTOCOL_INVALID_PARAM;
     
-    // Call the current state function using function pointer
-    StateFunction current_function = handler->state_functions[handler->current_state];
-    if (current_function) {
-        handler->last_result = current_function(handler, byte);
+    // Call the current state function through the shared table
+    if (handler->current_state < NUM_STATES) {
+        uint8_t de = handler->current_state;
+        handler->last_result = state_functions[handler->current_state](handler, byte);
+        if (handler->current_state != de) {
+            PROTOCOL_TRACE_TRANSICAO(de, handler->current_state, byte);
+        }
         return handler->last_result;
     }
     
     return PROTOCOL_ERROR;
 }
 
-uint8_t protocol_calculate_checksum(uint8_t* dados, uint8_t qtd) {
-    if (!dados || qtd == 0) return 0;
+// ========================================
+// TRANSITION MATRIX DISPATCH
+// ========================================
+
+// Classe de cada byte, para a matriz de transições: só STX, ETX e zero
+// mudam o caminho da máquina de estados
+typedef enum {
+    CLS_OUTRO = 0,
+    CLS_STX,
+    CLS_ETX,
+    CLS_ZERO,
+    NUM_CLASSES
+} ByteClass;
+
+// Ações da matriz, executadas depois da troca de estado
+typedef enum {
+    OP_NADA = 0,   // Só troca de estado
+    OP_INICIO,     // STX: zera contadores e checksum
+    OP_QTD,        // Guarda a quantidade
+    OP_DADO,       // Guarda o dado e soma o checksum; ST_CHK após o último
+    OP_CHK,        // Guarda o checksum recebido
+    OP_FIM,        // ETX: compara os checksums
+    OP_ERRO        // Byte no lugar do ETX diferente de ETX
+} ProtocolOpcode;
+
+typedef struct {
+    uint8_t proximo;   // Próximo estado (ProtocolStates)
+    uint8_t acao;      // ProtocolOpcode
+} ProtocolTransition;
+
+// Tabelas constantes (na flash), geradas pelo compilador: os bytes que não
+// aparecem são CLS_OUTRO
+static const uint8_t byte_class[256] = {
+    [0x00] = CLS_ZERO,
+    [STX_BYTE] = CLS_STX,
+    [ETX_BYTE] = CLS_ETX,
+};
+
+static const ProtocolTransition transitions[NUM_STATES][NUM_CLASSES] = {
+    [ST_STX] = {
+        [CLS_OUTRO] = { ST_STX, OP_NADA },
+        [CLS_STX]   = { ST_QTD, OP_INICIO },
+        [CLS_ETX]   = { ST_STX, OP_NADA },
+        [CLS_ZERO]  = { ST_STX, OP_NADA },
+    },
+    [ST_QTD] = {
+        [CLS_OUTRO] = { ST_DATA, OP_QTD },
+        [CLS_STX]   = { ST_DATA, OP_QTD },
+        [CLS_ETX]   = { ST_DATA, OP_QTD },
+        [CLS_ZERO]  = { ST_STX, OP_NADA },   // Quantidade inválida
+    },
+    [ST_DATA] = {
+        [CLS_OUTRO] = { ST_DATA, OP_DADO },
+        [CLS_STX]   = { ST_DATA, OP_DADO },
+        [CLS_ETX]   = { ST_DATA, OP_DADO },
+        [CLS_ZERO]  = { ST_DATA, OP_DADO },
+    },
+    [ST_CHK] = {
+        [CLS_OUTRO] = { ST_ETX, OP_CHK },
+        [CLS_STX]   = { ST_ETX, OP_CHK },
+        [CLS_ETX]   = { ST_ETX, OP_CHK },
+        [CLS_ZERO]  = { ST_ETX, OP_CHK },
+    },
+    [ST_ETX] = {
+        [CLS_OUTRO] = { ST_STX, OP_ERRO },
+        [CLS_STX]   = { ST_STX, OP_ERRO },
+        [CLS_ETX]   = { ST_STX, OP_FIM },
+        [CLS_ZERO]  = { ST_STX, OP_ERRO },
+    },
+};
+
+/*
+ * Mesmo protocolo e mesmos retornos de protocol_process_byte, sem os testes
+ * de estado e de byte: a classe do byte e a transição saem de duas
+ * consultas às tabelas, e a ação é um só salto. O tempo por byte quase não
+ * varia com o fluxo, o que facilita o orçamento de pior caso de uma ISR.
+ */
+int protocol_process_byte_matrix(ProtocolHandler* handler, uint8_t byte) {
+    if (!handler || handler->current_state >= NUM_STATES) return PROTOCOL_INVALID_PARAM;
+    
+    const ProtocolTransition* t = &transitions[handler->current_state][byte_class[byte]];
+    uint8_t de = handler->current_state;
+    int result = PROTOCOL_WAITING;
+    
+    handler->current_state = t->proximo;
+    switch (t->acao) {
+        case OP_INICIO:
+            handler->dados_count = 0;
+            handler->checksum_calc = 0;
+            handler->message_ready = false;
+            break;
+        case OP_QTD:
+            handler->qtd_dados = byte;
+            break;
+        case OP_DADO:
+            handler->dados[handler->dados_count++] = byte;
+            handler->checksum_calc += byte;
+            handler->current_state = (uint8_t)(ST_DATA + (handler->dados_count >= handler->qtd_dados));
+            break;
+        case OP_CHK:
+            handler->checksum_recv = byte;
+            break;
+        case OP_FIM:
+            handler->message_ready = (handler->checksum_calc == handler->checksum_recv);
+            result = handler->message_ready ? PROTOCOL_SUCCESS : PROTOCOL_ERROR;
+            break;
+        case OP_ERRO:
+            result = PROTOCOL_ERROR;
+            break;
+        default:
+            break;
+    }
     
-    uint8_t checksum = 0;
-    for (uint8_t i = 0; i < qtd; i++) {
-        checksum += dados[i];
+    if (handler->current_state != de) {
+        PROTOCOL_TRACE_TRANSICAO(de, handler->current_state, byte);
     }
-    return checksum;
+    handler->last_result = result;
+    return result;
 }
 
-int protocol_create_message(uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size) {
-    if (!dados || !buffer || !buffer_size || qtd == 0) {
+// ========================================
+// THREADED BUFFER DISPATCH
+// ========================================
+
+// Despacho do parser de bloco. Em 1 (padrão no GCC), cada estado salta
+// direto para o rótulo do próximo (labels as values, extensão do GCC): sem
+// a chamada indireta de state_functions e sem voltar a um switch a cada
+// byte. Em 0 (padrão nos demais compiladores, como o IAR), um switch
+// portátil com o mesmo código de cada estado
+#ifndef PROTOCOL_THREADED
+#if defined(__GNUC__)
+#define PROTOCOL_THREADED 1
+#else
+#define PROTOCOL_THREADED 0
+#endif
+#endif
+
+/*
+ * Processa um bloco de bytes, com o mesmo protocolo de protocol_process_byte.
+ * Retorna PROTOCOL_SUCCESS ou PROTOCOL_ERROR ao fim de cada mensagem, com
+ * *consumed até o ETX; quem chama continua do byte seguinte. Sem mensagem
+ * completa, consome o bloco inteiro e retorna PROTOCOL_WAITING. A busca do
+ * STX e os dados andam por trechos (memchr e memcpy), não byte a byte.
+ */
+int protocol_process_buffer(ProtocolHandler* handler, const uint8_t* buf, size_t len, size_t* consumed) {
+    if (!handler || !consumed || (!buf && len > 0) || handler->current_state >= NUM_STATES) {
         return PROTOCOL_INVALID_PARAM;
     }
     
-    uint8_t checksum = protocol_calculate_checksum(dados, qtd);
-    uint8_t msg_size = 5 + qtd; // STX + QTD + dados + CHK + ETX
-    
-    if (*buffer_size < msg_size) {
-        return PROTOCOL_ERROR;
+    const uint8_t* p = buf;
+    const uint8_t* end = buf + len;
+    uint8_t byte;
+    
+    // Os campos usados a cada byte ficam em locais durante o bloco, que o
+    // compilador mantém em registradores: o handler é lido aqui e escrito
+    // uma vez, na saída
+    uint8_t estado = handler->current_state;
+    uint8_t qtd_dados = handler->qtd_dados;
+    uint8_t dados_count = handler->dados_count;
+    uint8_t checksum_recv = handler->checksum_recv;
+    uint8_t checksum_calc = handler->checksum_calc;
+    
+// Troca de estado com o rastro de protocol_trace.h
+#define MUDA_ESTADO(novo) do { \
+        PROTOCOL_TRACE_TRANSICAO(estado, (novo), byte); \
+        estado = (novo); \
+    } while (0)
+#define GUARDA_ESTADO() do { \
+        handler->current_state = estado; \
+        handler->qtd_dados = qtd_dados; \
+        handler->dados_count = dados_count; \
+        handler->checksum_recv = checksum_recv; \
+        handler->checksum_calc = checksum_calc; \
+    } while (0)
+
+#if PROTOCOL_THREADED
+    static const void* const rotulos[NUM_STATES] = {
+        [ST_STX] = &&estado_stx,
+        [ST_QTD] = &&estado_qtd,
+        [ST_DATA] = &&estado_data,
+        [ST_CHK] = &&estado_chk,
+        [ST_ETX] = &&estado_etx,
+    };
+#define ESTADO(rotulo, estado) rotulo
+#define PROXIMO_BYTE() do { \
+        if (p == end) goto fim; \
+        byte = *p++; \
+        goto *rotulos[estado]; \
+    } while (0)
+    
+    PROXIMO_BYTE();
+#else
+#define ESTADO(rotulo, estado) case estado
+#define PROXIMO_BYTE() continue
+    
+    while (p < end) {
+        byte = *p++;
+        switch (estado) {
+#endif
+        ESTADO(estado_stx, ST_STX):
+            if (byte != STX_BYTE) {
+                const uint8_t* stx = memchr(p, STX_BYTE, (size_t)(end - p));
+                if (!stx) {
+                    p = end;
+                    PROXIMO_BYTE();
+                }
+                p = stx + 1;
+                byte = STX_BYTE;
+            }
+            MUDA_ESTADO(ST_QTD);
+            dados_count = 0;
+            checksum_calc = 0;
+            handler->message_ready = false;
+            PROXIMO_BYTE();
+        
+        ESTADO(estado_qtd, ST_QTD):
+            if (byte > 0) {
+                qtd_dados = byte;
+                MUDA_ESTADO(ST_DATA);
+            } else {
+                MUDA_ESTADO(ST_STX);  // Quantidade inválida
+            }
+            PROXIMO_BYTE();
+        
+        ESTADO(estado_data, ST_DATA): {
+            // O byte atual e os seguintes, até o fim dos dados ou do bloco
+            size_t faltam = (size_t)(qtd_dados - dados_count);
+            size_t disponivel = (size_t)(end - p) + 1;
+            size_t trecho = faltam < disponivel ? faltam : disponivel;
+            
+            memcpy(&handler->dados[dados_count], p - 1, trecho);
+            checksum_calc = protocol_sum8_update(checksum_calc, p - 1, trecho);
+            dados_count = (uint8_t)(dados_count + trecho);
+            p += trecho - 1;
+            if (dados_count >= qtd_dados) {
+                MUDA_ESTADO(ST_CHK);
+            }
+            PROXIMO_BYTE();
+        }
+        
+        ESTADO(estado_chk, ST_CHK):
+            checksum_recv = byte;
+            MUDA_ESTADO(ST_ETX);
+            PROXIMO_BYTE();
+        
+        ESTADO(estado_etx, ST_ETX):
+            MUDA_ESTADO(ST_STX);
+            handler->message_ready = (byte == ETX_BYTE && checksum_calc == checksum_recv);
+            handler->last_result = handler->message_ready ? PROTOCOL_SUCCESS : PROTOCOL_ERROR;
+            *consumed = (size_t)(p - buf);
+            GUARDA_ESTADO();
+            return handler->last_result;
+#if PROTOCOL_THREADED
+fim:
+#else
+        }
     }
+#endif
     
-    buffer[0] = STX_BYTE;
-    buffer[1] = qtd;
-    memcpy(&buffer[2], dados, qtd);
-    buffer[2 + qtd] = checksum;
-    buffer[3 + qtd] = ETX_BYTE;
+    GUARDA_ESTADO();
+#undef PROXIMO_BYTE
+#undef ESTADO
+#undef MUDA_ESTADO
+#undef GUARDA_ESTADO
+    
+    *consumed = len;
+    handler->last_result = PROTOCOL_WAITING;
+    return PROTOCOL_WAITING;
+}
+
+uint8_t protocol_calculate_checksum(uint8_t* dados, uint8_t qtd) {
+    if (!dados || qtd == 0) return 0;
     
-    *buffer_size = msg_size;
-    return PROTOCOL_SUCCESS;
+    return protocol_sum8(dados, qtd);
+}
+
+int protocol_create_message(uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size) {
+    return protocol_frame_encode8(dados, qtd, buffer, buffer_size);
 }
 
 bool protocol_message_ready(ProtocolHandler* handler) {
@@ -230,15 +488,24 @@ uint8_t protocol_get_data_count(ProtocolHandler* handler) {
 // ========================================
 
 static char * executa_testes(void);
+static void mede_desempenho(void);
+static int varre_tamanhos(void);
 
 int main() {
+    if (PROTOCOL_BENCH_VARREDURA) {
+        return varre_tamanhos();
+    }
     char *resultado = executa_testes();
+    if (resultado == 0) {
+        mede_desempenho();
+    }
     if (resultado != 0) {
         printf("%s\n", resultado);
     } else {
         printf("TODOS OS TESTES PASSARAM\n");
     }
     printf("Testes executados: %d\n", testes_executados);
+    protocol_test_resumo();
 
     return resultado != 0;
 }
@@ -253,8 +520,8 @@ static char * test_protocol_init(void) {
     verifica("erro: estado inicial deve ser ST_STX", handler.current_state == ST_STX);
     verifica("erro: message_ready deve ser false", handler.message_ready == false);
     verifica("erro: dados_count deve ser 0", handler.dados_count == 0);
-    verifica("erro: função ST_STX deve estar definida", handler.state_functions[ST_STX] != NULL);
-    verifica("erro: função ST_QTD deve estar definida", handler.state_functions[ST_QTD] != NULL);
+    verifica("erro: função ST_STX deve estar definida", state_functions[ST_STX] != NULL);
+    verifica("erro: função ST_QTD deve estar definida", state_functions[ST_QTD] != NULL);
     
     return 0;
 }
@@ -386,15 +653,216 @@ static char * test_function_pointers(void) {
     protocol_init(&handler);
     
     // Verificar se os ponteiros de função estão corretos
-    verifica("erro: função ST_STX", handler.state_functions[ST_STX] == state_wait_stx);
-    verifica("erro: função ST_QTD", handler.state_functions[ST_QTD] == state_wait_qtd);
-    verifica("erro: função ST_DATA", handler.state_functions[ST_DATA] == state_wait_data);
-    verifica("erro: função ST_CHK", handler.state_functions[ST_CHK] == state_wait_chk);
-    verifica("erro: função ST_ETX", handler.state_functions[ST_ETX] == state_wait_etx);
+    verifica("erro: função ST_STX", state_functions[ST_STX] == state_wait_stx);
+    verifica("erro: função ST_QTD", state_functions[ST_QTD] == state_wait_qtd);
+    verifica("erro: função ST_DATA", state_functions[ST_DATA] == state_wait_data);
+    verifica("erro: função ST_CHK", state_functions[ST_CHK] == state_wait_chk);
+    verifica("erro: função ST_ETX", state_functions[ST_ETX] == state_wait_etx);
+    
+    // O handler não guarda ponteiros: só o estado e o buffer
+    verifica("erro: handler sem tabela própria", sizeof(handler) < MAX_DATA_SIZE + NUM_STATES * sizeof(StateFunction));
+    
+    // Estado inválido não chama a tabela
+    handler.current_state = NUM_STATES;
+    verifica("erro: estado inválido", protocol_process_byte(&handler, STX_BYTE) == PROTOCOL_ERROR);
     
     return 0;
 }
 
+// A matriz e as funções de estado dão os mesmos retornos e o mesmo estado
+// em um fluxo com mensagens válidas, corrompidas e ruído
+static char * test_transition_matrix(void) {
+    static ProtocolHandler por_funcao, por_matriz;
+    uint32_t semente = 12345;
+    uint8_t mensagem[64];
+    uint8_t dados[255];
+    
+    protocol_init(&por_funcao);
+    protocol_init(&por_matriz);
+    
+    int validas = 0;
+    for (int n = 0; n < 2000; n++) {
+        semente = semente * 1103515245u + 12345u;
+        uint8_t qtd = (uint8_t)((semente >> 16) % 40 + 1);
+        for (int i = 0; i < qtd; i++) {
+            semente = semente * 1103515245u + 12345u;
+            dados[i] = (uint8_t)(semente >> 16) % 6;  // Muitos STX, ETX e zeros
+        }
+        uint8_t tamanho = sizeof(mensagem);
+        protocol_create_message(dados, qtd, mensagem, &tamanho);
+        
+        // Um terço das mensagens tem um byte trocado
+        semente = semente * 1103515245u + 12345u;
+        if ((semente >> 16) % 3 == 0) {
+            mensagem[(semente >> 20) % tamanho] ^= (uint8_t)(1 << ((semente >> 8) % 8));
+        }
+        
+        for (int i = 0; i < tamanho; i++) {
+            int esperado = protocol_process_byte(&por_funcao, mensagem[i]);
+            int obtido = protocol_process_byte_matrix(&por_matriz, mensagem[i]);
+            verifica("erro: matriz: retorno diferente", esperado == obtido);
+            verifica("erro: matriz: estado diferente", por_funcao.current_state == por_matriz.current_state);
+            if (obtido == PROTOCOL_SUCCESS) {
+                validas++;
+                verifica("erro: matriz: dados diferentes", por_matriz.qtd_dados == por_funcao.qtd_dados &&
+                         memcmp(por_matriz.dados, por_funcao.dados, por_matriz.qtd_dados) == 0);
+            }
+        }
+    }
+    verifica("erro: matriz: nenhuma mensagem válida", validas > 1000);
+    
+    por_matriz.current_state = NUM_STATES;
+    verifica("erro: matriz: estado inválido", protocol_process_byte_matrix(&por_matriz, STX_BYTE) == PROTOCOL_INVALID_PARAM);
+    return 0;
+}
+
+// O parser de bloco encontra as mesmas mensagens que o byte a byte, com o
+// fluxo cortado em blocos de tamanhos variados (mensagens divididas entre
+// blocos e várias mensagens no mesmo bloco)
+static char * test_process_buffer(void) {
+    static ProtocolHandler por_byte, por_bloco;
+    static uint8_t fluxo[8192];
+    uint32_t semente = 777;
+    size_t tamanho = 0;
+    
+    while (tamanho + 70 < sizeof(fluxo)) {
+        uint8_t dados[64];
+        uint8_t qtd = (uint8_t)((semente >> 16) % 64 + 1);
+        for (int i = 0; i < qtd; i++) {
+            semente = semente * 1103515245u + 12345u;
+            dados[i] = (uint8_t)(semente >> 16) % 6;  // Muitos STX, ETX e zeros
+        }
+        uint8_t escrito = (uint8_t)(sizeof(fluxo) - tamanho < 255 ? sizeof(fluxo) - tamanho : 255);
+        protocol_create_message(dados, qtd, &fluxo[tamanho], &escrito);
+        
+        // Um quarto das mensagens tem um byte trocado, e há ruído entre elas
+        semente = semente * 1103515245u + 12345u;
+        if ((semente >> 16) % 4 == 0) {
+            fluxo[tamanho + (semente >> 20) % escrito] ^= 0x01;
+        }
+        tamanho += escrito;
+        fluxo[tamanho++] = 0xFF;
+    }
+    
+    protocol_init(&por_byte);
+    protocol_init(&por_bloco);
+    int esperadas = 0, encontradas = 0, erros_byte = 0, erros_bloco = 0;
+    for (size_t i = 0; i < tamanho; i++) {
+        int result = protocol_process_byte(&por_byte, fluxo[i]);
+        esperadas += result == PROTOCOL_SUCCESS;
+        erros_byte += result == PROTOCOL_ERROR;
+    }
+    
+    for (size_t pos = 0, bloco = 1; pos < tamanho; bloco = bloco % 97 + 1) {
+        size_t len = tamanho - pos < bloco ? tamanho - pos : bloco;
+        size_t consumed;
+        int result = protocol_process_buffer(&por_bloco, &fluxo[pos], len, &consumed);
+        verifica("erro: bloco: consumo além do bloco", consumed <= len && consumed > 0);
+        if (result == PROTOCOL_SUCCESS) {
+            encontradas++;
+            verifica("erro: bloco: checksum dos dados",
+                     protocol_calculate_checksum(por_bloco.dados, por_bloco.qtd_dados) == por_bloco.checksum_recv);
+        } else if (result == PROTOCOL_ERROR) {
+            erros_bloco++;
+        } else {
+            verifica("erro: bloco: espera sem consumir tudo", result == PROTOCOL_WAITING && consumed == len);
+        }
+        pos += consumed;
+    }
+    verifica("erro: bloco: mensagens diferentes do byte a byte", encontradas == esperadas && esperadas > 50);
+    verifica("erro: bloco: erros diferentes do byte a byte", erros_bloco == erros_byte);
+    verifica("erro: bloco: estado final diferente", por_bloco.current_state == por_byte.current_state);
+    
+    size_t consumed;
+    verifica("erro: bloco: parâmetro nulo", protocol_process_buffer(&por_bloco, NULL, 1, &consumed) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: bloco: bloco vazio", protocol_process_buffer(&por_bloco, NULL, 0, &consumed) == PROTOCOL_WAITING &&
+             consumed == 0);
+    return 0;
+}
+
+// Os dois despachos nos fluxos de protocol_bench.h, comparáveis a t2 e t4
+static int mede_funcoes(void* contexto, const uint8_t* fluxo, size_t tamanho) {
+    ProtocolHandler* handler = contexto;
+    int validas = 0;
+    
+    for (size_t i = 0; i < tamanho; i++) {
+        validas += protocol_process_byte(handler, fluxo[i]) == PROTOCOL_SUCCESS;
+    }
+    return validas;
+}
+
+static int mede_matriz(void* contexto, const uint8_t* fluxo, size_t tamanho) {
+    ProtocolHandler* handler = contexto;
+    int validas = 0;
+    
+    for (size_t i = 0; i < tamanho; i++) {
+        validas += protocol_process_byte_matrix(handler, fluxo[i]) == PROTOCOL_SUCCESS;
+    }
+    return validas;
+}
+
+static int mede_bloco(void* contexto, const uint8_t* fluxo, size_t tamanho) {
+    ProtocolHandler* handler = contexto;
+    int validas = 0;
+    
+    for (size_t pos = 0; pos < tamanho; ) {
+        size_t consumed;
+        validas += protocol_process_buffer(handler, &fluxo[pos], tamanho - pos, &consumed) == PROTOCOL_SUCCESS;
+        pos += consumed;
+    }
+    return validas;
+}
+
+/* Orçamentos de tempo no fluxo com ruído de protocol_bench.h, cerca de 20x
+   acima do medido: só reprovam regressões grosseiras dos dois despachos */
+static char * test_time_budget(void) {
+    static uint8_t fluxo[PROTOCOL_BENCH_TAMANHO];
+    static ProtocolHandler handler;
+    int validas;
+    size_t tamanho = protocol_bench_gera(BENCH_RUIDO, fluxo, sizeof(fluxo), &validas);
+    
+    protocol_init(&handler);
+    verifica("erro: tempo: mensagens do fluxo", mede_funcoes(&handler, fluxo, tamanho) == validas);
+    verifica_tempo("erro: tempo: ponteiros para funções, 32 KB", mede_funcoes(&handler, fluxo, tamanho), 2000000);
+    verifica_tempo("erro: tempo: bloco, 32 KB", mede_bloco(&handler, fluxo, tamanho), 600000);
+    
+    return 0;
+}
+
+// protocol_create_message na varredura de tamanhos: o quadro sem a folga
+static size_t codifica_mensagem(const uint8_t* dados, uint8_t qtd, uint8_t* quadro) {
+    uint8_t tamanho = (uint8_t)(qtd + PROTOCOL_FRAME_ENVELOPE);
+    
+    if (qtd > 0xFF - PROTOCOL_FRAME_ENVELOPE ||
+        protocol_create_message((uint8_t*)dados, qtd, quadro, &tamanho) != PROTOCOL_SUCCESS) {
+        return 0;
+    }
+    return (size_t)qtd + 4;
+}
+
+// Codificador e despachos em cada tamanho de dados (PROTOCOL_BENCH_VARREDURA)
+static int varre_tamanhos(void) {
+    static ProtocolHandler handler;
+    int divergente;
+    
+    protocol_init(&handler);
+    divergente = protocol_bench_varredura("t3 ponteiros para funções", codifica_mensagem, mede_funcoes, &handler);
+    protocol_init(&handler);
+    divergente |= protocol_bench_varredura("t3 bloco", codifica_mensagem, mede_bloco, &handler);
+    return divergente;
+}
+
+static void mede_desempenho(void) {
+    static ProtocolHandler handler;
+    
+    protocol_init(&handler);
+    protocol_bench_executa("t3 ponteiros para funções", mede_funcoes, &handler, 100);
+    protocol_init(&handler);
+    protocol_bench_executa("t3 matriz de transições", mede_matriz, &handler, 100);
+    protocol_init(&handler);
+    protocol_bench_executa(PROTOCOL_THREADED ? "t3 bloco (goto)" : "t3 bloco (switch)", mede_bloco, &handler, 100);
+}
+
 /***********************************************/
 
 static char * executa_testes(void) {
@@ -407,6 +875,9 @@ static char * executa_testes(void) {
     executa_teste(test_state_transitions);
     executa_teste(test_reset_after_message);
     executa_teste(test_function_pointers);
+    executa_teste(test_transition_matrix);
+    executa_teste(test_process_buffer);
+    executa_teste(test_time_budget);
     
     return 0;
 }
@@ -4,13 +4,20 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "../comum/protocol_checksum.h"
+#include "../comum/protocol_frame.h"
+#include "../comum/protocol_bench.h"
+#include "../comum/protocol_trace.h"
+#include "../comum/protocol_test.h"  // verifica, verifica_tempo e executa_teste (minUnit)
+
 // Protocol constants
+#define SOH_BYTE 0x01      // Início de quadro com número de sequência
 #define STX_BYTE 0x02
 #define ETX_BYTE 0x03
 #define ACK_BYTE 0x06
 #define NACK_BYTE 0x15
 #define MAX_DATA_SIZE 256
-#define TIMEOUT_MS 1000
+#define TIMEOUT_MS 1000        // RTO inicial, antes da primeira medida de RTT
 #define MAX_RETRIES 3
 
 // Return codes
@@ -19,19 +26,40 @@
 #define PROTOCOL_TIMEOUT -2
 #define PROTOCOL_INVALID_PARAM -3
 
-/* macros de testes - baseado em minUnit: www.jera.com/techinfo/jtns/jtn002.html */
-#define verifica(mensagem, teste) do { if (!(teste)) return mensagem; } while (0)
-#define executa_teste(teste) do { char *mensagem = teste(); testes_executados++; \
-                                if (mensagem) return mensagem; } while (0)
-int testes_executados = 0;
-
 // ========================================
 // PROTOTHREADS INFRASTRUCTURE
 // ========================================
 
 // Simplified protothreads implementation
+
+// Continuação local (lc): onde a thread retoma. Com GCC/Clang, é o endereço
+// de um rótulo (&&rótulo) e a retomada é um único goto indireto; as threads
+// podem ter switch próprio. Nos demais compiladores (ex.: IAR), ou com
+// -DPT_LC_SWITCH, é o número da linha num switch que envolve a thread, e um
+// switch dentro dela não pode conter PT_WAIT/PT_YIELD. Nos dois casos, um
+// PT_WAIT/PT_YIELD por linha
+#if defined(__GNUC__) && !defined(PT_LC_SWITCH)
+typedef void* lc_t;
+#define LC_CONCAT2(a, b) a##b
+#define LC_CONCAT(a, b) LC_CONCAT2(a, b)
+#define LC_INIT(lc) (lc) = NULL
+#define LC_RESUME(lc) do { if ((lc) != NULL) goto *(lc); } while (0);
+#define LC_SET(lc) LC_CONCAT(pt_lc_, __LINE__): (lc) = &&LC_CONCAT(pt_lc_, __LINE__)
+#define LC_END(lc)
+// O GCC 12+ toma o rótulo guardado na pt por endereço de variável local
+#if !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic ignored "-Wdangling-pointer"
+#endif
+#else
+typedef unsigned short lc_t;
+#define LC_INIT(lc) (lc) = 0
+#define LC_RESUME(lc) switch (lc) { case 0:
+#define LC_SET(lc) (lc) = __LINE__; case __LINE__:
+#define LC_END(lc) }
+#endif
+
 typedef struct pt {
-    unsigned short lc;
+    lc_t lc;
 } pt_t;
 
 #define PT_WAITING 0
@@ -39,515 +67,4706 @@ typedef struct pt {
 #define PT_EXITED  2
 #define PT_ENDED   3
 
-#define PT_INIT(pt) do { (pt)->lc = 0; } while(0)
+#define PT_INIT(pt) do { LC_INIT((pt)->lc); } while(0)
 
-#define PT_BEGIN(pt) switch((pt)->lc) { case 0:
-#define PT_END(pt) } (pt)->lc = 0; return PT_ENDED;
-#define PT_WAIT_UNTIL(pt, condition) do { (pt)->lc = __LINE__; case __LINE__: if(!(condition)) return PT_WAITING; } while(0)
+// A flag distingue a volta de um PT_YIELD (segue adiante) da chegada a ele
+#define PT_BEGIN(pt) { char pt_yield_flag = 1; (void)pt_yield_flag; LC_RESUME((pt)->lc)
+#define PT_END(pt) LC_END((pt)->lc); LC_INIT((pt)->lc); return PT_ENDED; }
+#define PT_WAIT_UNTIL(pt, condition) do { LC_SET((pt)->lc); if(!(condition)) return PT_WAITING; } while(0)
 #define PT_WAIT_WHILE(pt, cond) PT_WAIT_UNTIL((pt), !(cond))
 #define PT_RESTART(pt) do { PT_INIT(pt); return PT_WAITING; } while(0)
 #define PT_EXIT(pt) do { PT_INIT(pt); return PT_EXITED; } while(0)
-#define PT_YIELD(pt) do { (pt)->lc = __LINE__; case __LINE__: return PT_YIELDED; } while(0)
+#define PT_YIELD(pt) do { pt_yield_flag = 0; LC_SET((pt)->lc); if (pt_yield_flag == 0) return PT_YIELDED; } while(0)
 #define PT_THREAD(name_args) static int name_args
 
 // ========================================
-// TIMER INFRASTRUCTURE
+// PROTOTHREAD SCHEDULER
 // ========================================
 
-typedef struct {
-    uint32_t start_time;
-    uint32_t timeout_ms;
-    bool active;
-} timer_t;
+// Escalonador de até PT_MAX_THREADS protothreads com um conjunto de prontas:
+// cada thread registrada tem um bit em pt_ready e só as threads com o bit
+// ligado são retomadas. Quem pode mudar uma condição de espera (dados no
+// canal, ACK, avanço do tempo) sinaliza o evento correspondente, que liga os
+// bits das threads inscritas nele; uma passada custa o número de threads
+// acordadas, não o de registradas.
+#ifndef PT_MAX_THREADS
+#define PT_MAX_THREADS 32
+#endif
 
-// Simulated time (milliseconds)
-static uint32_t system_time_ms = 0;
+#if PT_MAX_THREADS > 32
+#error "PT_MAX_THREADS deve caber em pt_mask_t (32 bits)"
+#endif
 
-void timer_set(timer_t* timer, uint32_t timeout_ms) {
-    timer->start_time = system_time_ms;
-    timer->timeout_ms = timeout_ms;
-    timer->active = true;
-}
+typedef uint32_t pt_mask_t;               // Um bit por thread registrada
+typedef int (*pt_thread_fn)(void* contexto);
 
-bool timer_expired(timer_t* timer) {
-    if (!timer->active) return false;
-    return (system_time_ms - timer->start_time) >= timer->timeout_ms;
-}
+typedef struct {
+    pt_thread_fn run;
+    void* contexto;
+} pt_entry_t;
 
-void timer_stop(timer_t* timer) {
-    timer->active = false;
-}
+// Evento que pode mudar a condição de espera das threads inscritas
+typedef struct {
+    pt_mask_t waiting;
+} pt_event_t;
 
-// Simulate time advancement
-void advance_time(uint32_t ms) {
-    system_time_ms += ms;
-}
+static pt_entry_t pt_threads[PT_MAX_THREADS];
+static int pt_thread_count = 0;
+static pt_mask_t pt_registered = 0;       // Um bit por thread em pt_threads
+static pt_mask_t pt_ready = 0;            // Threads a retomar na próxima passada
+static pt_mask_t pt_finished = 0;         // Terminadas: só pt_wake as retoma
+static int pt_current = -1;               // Thread em execução (-1: fora de pt_schedule)
+static bool pt_polling = false;           // Dentro de protothreads_poll: sem PT_NOTIFY
+static uint32_t pt_notifies = 0;          // Chamadas de PT_NOTIFY
+static uint32_t pt_idle_passes = 0;       // Passadas sem nenhuma thread pronta
 
-// ========================================
-// COMMUNICATION CHANNEL SIMULATION
-// ========================================
+// Chamado quando nenhuma thread está pronta: só um evento (interrupção ou a
+// expiração em next_deadline) pode mudar isso. No microcontrolador, ex.:
+// __WFI() com um alarme do RTC na próxima expiração
+#ifndef PT_SLEEP
+#define PT_SLEEP() ((void)0)
+#endif
 
-typedef struct {
-    uint8_t tx_buffer[MAX_DATA_SIZE + 10];  // Buffer for outgoing data
-    uint8_t rx_buffer[MAX_DATA_SIZE + 10];  // Buffer for incoming data
-    uint8_t tx_size;                        // Size of data in tx buffer
-    uint8_t rx_size;                        // Size of data in rx buffer
-    uint8_t rx_pos;                         // Current read position in rx buffer
-    bool tx_ready;                          // Data ready to transmit
-    bool rx_ready;                          // Data received and ready
-    bool ack_received;                      // ACK/NACK received flag
-    uint8_t ack_value;                      // ACK or NACK value
-    bool simulate_loss;                     // Simulate packet loss for testing
-} comm_channel_t;
+// Chamado quando um evento ou pt_wake deixa threads prontas fora do
+// escalonador (ex.: channel_write na interrupção da UART): no RTOS, acorda a
+// tarefa que roda protothreads_poll (PonteProtothreadsNotifica)
+#ifndef PT_NOTIFY
+#define PT_NOTIFY() ((void)0)
+#endif
 
-static comm_channel_t channel = {0};
+// Executa uma alteração de pt_ready sem ser interrompida, quando há eventos
+// sinalizados em interrupções. No RTOS, ex.: do { reg_atomica_t e;
+// REG_ATOMICA_INICIO(e); instrucao; REG_ATOMICA_FIM(e); } while (0)
+#ifndef PT_ATOMIC
+#define PT_ATOMIC(instrucao) do { instrucao; } while (0)
+#endif
 
-// Send data through channel
-void channel_send(uint8_t* data, uint8_t size) {
-    if (!channel.simulate_loss) {
-        memcpy(channel.rx_buffer, data, size);
-        channel.rx_size = size;
-        channel.rx_pos = 0;
-        channel.rx_ready = true;
+// Índice do bit ligado mais baixo (mascara != 0)
+static inline int pt_lowest(pt_mask_t mascara) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mascara);
+#else
+    int i = 0;
+    while (!(mascara & 1u)) {
+        mascara >>= 1;
+        i++;
     }
-    channel.tx_ready = false;
+    return i;
+#endif
 }
 
-// Receive byte from channel
-bool channel_receive_byte(uint8_t* byte) {
-    if (channel.rx_ready && channel.rx_pos < channel.rx_size) {
-        *byte = channel.rx_buffer[channel.rx_pos++];
-        if (channel.rx_pos >= channel.rx_size) {
-            channel.rx_ready = false;
-        }
-        return true;
-    }
-    return false;
+// Remove todas as threads registradas
+void pt_scheduler_reset(void) {
+    pt_thread_count = 0;
+    pt_registered = 0;
+    pt_ready = 0;
+    pt_finished = 0;
+    pt_idle_passes = 0;
+    pt_notifies = 0;
 }
 
-// Send ACK/NACK
-void channel_send_ack(uint8_t ack_type) {
-    channel.ack_received = true;
-    channel.ack_value = ack_type;
+// Registra uma thread, já pronta para a primeira passada, e retorna o seu
+// identificador, ou -1 se não há mais espaço
+int pt_register(pt_thread_fn run, void* contexto) {
+    if (!run || pt_thread_count >= PT_MAX_THREADS) return -1;
+    
+    pt_threads[pt_thread_count].run = run;
+    pt_threads[pt_thread_count].contexto = contexto;
+    pt_registered |= (pt_mask_t)1u << pt_thread_count;
+    pt_ready |= (pt_mask_t)1u << pt_thread_count;
+    return pt_thread_count++;
 }
 
-// Check for ACK/NACK
-bool channel_ack_received(uint8_t* ack_type) {
-    if (channel.ack_received) {
-        *ack_type = channel.ack_value;
-        channel.ack_received = false;
-        return true;
+// Põe a thread no conjunto de prontas, também se ela já terminou (que então
+// recomeça do início, como em PT_INIT)
+void pt_wake(int id) {
+    pt_mask_t bit = (pt_mask_t)1u << id;
+    
+    PT_ATOMIC(pt_finished &= ~bit; pt_ready |= bit);
+    if (pt_current < 0 && !pt_polling) {
+        pt_notifies++;
+        PT_NOTIFY();
     }
-    return false;
 }
 
-void channel_reset(void) {
-    memset(&channel, 0, sizeof(channel));
+void pt_event_subscribe(pt_event_t* evento, int id) {
+    evento->waiting |= (pt_mask_t)1u << id;
 }
 
-// ========================================
-// PROTOCOL FUNCTIONS
-// ========================================
-
-uint8_t protocol_calculate_checksum(uint8_t* dados, uint8_t qtd) {
-    if (!dados || qtd == 0) return 0;
+// Acorda as threads inscritas no evento que ainda não terminaram. A
+// inscrição vale para um sinal: quem ainda não pode seguir se inscreve de novo.
+// Bits de threads não registradas (ex.: evento de um timer não iniciado) são
+// ignorados
+static inline void pt_event_signal(pt_event_t* evento) {
+    pt_mask_t acordadas;
     
-    uint8_t checksum = 0;
-    for (uint8_t i = 0; i < qtd; i++) {
-        checksum += dados[i];
+    PT_ATOMIC(acordadas = evento->waiting & pt_registered & ~pt_finished; pt_ready |= acordadas;
+              evento->waiting = 0);
+    if (acordadas && pt_current < 0 && !pt_polling) {
+        pt_notifies++;
+        PT_NOTIFY();
     }
-    return checksum;
 }
 
-int protocol_create_message(uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size) {
-    if (!dados || !buffer || !buffer_size || qtd == 0) {
-        return PROTOCOL_INVALID_PARAM;
+// Inscreve a thread em execução (fora de pt_schedule não faz nada)
+static inline void pt_event_wait(pt_event_t* evento) {
+    if (pt_current >= 0) {
+        pt_event_subscribe(evento, pt_current);
     }
-    
-    uint8_t checksum = protocol_calculate_checksum(dados, qtd);
-    uint8_t msg_size = 5 + qtd; // STX + QTD + dados + CHK + ETX
-    
-    if (*buffer_size < msg_size) {
-        return PROTOCOL_ERROR;
-    }
-    
-    buffer[0] = STX_BYTE;
-    buffer[1] = qtd;
-    memcpy(&buffer[2], dados, qtd);
-    buffer[2 + qtd] = checksum;
-    buffer[3 + qtd] = ETX_BYTE;
-    
-    *buffer_size = msg_size;
-    return PROTOCOL_SUCCESS;
 }
 
-// ========================================
-// PROTOTHREAD STATE VARIABLES
-// ========================================
+// Como PT_WAIT_UNTIL, mas a condição só é reavaliada quando o evento é
+// sinalizado, não a cada passada: o evento deve ser sinalizado por tudo o
+// que pode torná-la verdadeira. PT_WAIT_EVENT2 espera qualquer de dois eventos
+#define PT_WAIT_EVENT(pt, evento, condition) do { LC_SET((pt)->lc); \
+        if(!(condition)) { pt_event_wait(evento); return PT_WAITING; } } while(0)
+#define PT_WAIT_EVENT2(pt, evento1, evento2, condition) do { LC_SET((pt)->lc); \
+        if(!(condition)) { pt_event_wait(evento1); pt_event_wait(evento2); return PT_WAITING; } } while(0)
 
-// Transmitter state
+// Conclusão de uma operação de E/S assíncrona: a thread inicia a transferência
+// (DMA, UART, SPI) e espera com PT_AWAIT, sem polling; a interrupção de fim do
+// periférico chama pt_complete com o resultado. Cada pt_complete vale para um
+// PT_AWAIT, e a conclusão que chega antes da espera não se perde. Muitas
+// sessões de E/S esperam assim na mesma pilha, e sem nada pronto o
+// escalonador dorme (PT_SLEEP)
 typedef struct {
-    pt_t pt;
-    timer_t timer;
-    uint8_t* data_to_send;
-    uint8_t data_size;
-    uint8_t message_buffer[MAX_DATA_SIZE + 10];
-    uint8_t message_size;
-    uint8_t retry_count;
-    bool transmission_complete;
-    int result;
-} transmitter_state_t;
+    volatile uint8_t count;               // Conclusões ainda não consumidas
+    volatile int result;                  // Resultado da última
+    pt_event_t done;                      // Sinalizado por pt_complete
+} pt_completion_t;
 
-// Receiver state
+// Antes de iniciar a primeira operação
+static inline void pt_completion_init(pt_completion_t* c) {
+    c->count = 0;
+    c->result = 0;
+    c->done.waiting = 0;
+}
+
+// Da interrupção ou de qualquer contexto: conclui uma operação e acorda a
+// thread que a espera (fora do escalonador, com PT_NOTIFY)
+static inline void pt_complete(pt_completion_t* c, int result) {
+    PT_ATOMIC(c->result = result; c->count++);
+    pt_event_signal(&c->done);
+}
+
+// Consome uma conclusão; retorna false se não há
+static inline bool pt_completion_take(pt_completion_t* c) {
+    bool pronta;
+    
+    PT_ATOMIC(pronta = c->count > 0; if (pronta) c->count--);
+    return pronta;
+}
+
+// Espera e consome a conclusão; o resultado fica em (c)->result
+#define PT_AWAIT(pt, c) PT_WAIT_EVENT((pt), &(c)->done, pt_completion_take(c))
+
+// Protothreads filhas: um subprotocolo (ex.: handshake, transferência,
+// encerramento) é uma PT_THREAD com a sua pt, chamada pela mãe a cada
+// retomada até terminar. A filha roda no lugar da mãe no escalonador: o
+// PT_WAIT_EVENT dela inscreve a mãe, e o PT_YIELD dela mantém a mãe pronta.
+// PT_SPAWN reinicia a filha antes; PT_WAIT_THREAD só espera
+#define PT_SCHEDULE(f) ((f) < PT_EXITED)
+#define PT_WAIT_THREAD(pt, thread) do { LC_SET((pt)->lc); \
+        { int pt_filha = (thread); if (PT_SCHEDULE(pt_filha)) return pt_filha; } } while(0)
+#define PT_SPAWN(pt, child, thread) do { PT_INIT((child)); PT_WAIT_THREAD((pt), (thread)); } while(0)
+
+// Semáforo contador entre protothreads (ex.: buffers livres divididos por
+// várias sessões). PT_SEM_WAIT espera pelo evento do semáforo, sem polling;
+// pt_sem_signal pode ser chamado de qualquer contexto, também de interrupções
 typedef struct {
-    pt_t pt;
-    uint8_t rx_data[MAX_DATA_SIZE];
-    uint8_t rx_count;
-    uint8_t expected_size;
-    uint8_t checksum_calc;
-    uint8_t checksum_recv;
-    enum {
-        RX_WAIT_STX,
-        RX_WAIT_QTD,
-        RX_WAIT_DATA,
-        RX_WAIT_CHK,
-        RX_WAIT_ETX
-    } state;
-    bool message_received;
-    int result;
-} receiver_state_t;
+    volatile unsigned count;              // Unidades disponíveis
+    pt_event_t available;                 // Sinalizado por pt_sem_signal
+} pt_sem_t;
 
-static transmitter_state_t tx_state;
-static receiver_state_t rx_state;
+static inline void pt_sem_init(pt_sem_t* s, unsigned count) {
+    s->count = count;
+    s->available.waiting = 0;
+}
 
-// ========================================
-// PROTOTHREADS IMPLEMENTATION
-// ========================================
+static inline void pt_sem_signal(pt_sem_t* s) {
+    PT_ATOMIC(s->count++);
+    pt_event_signal(&s->available);
+}
 
-PT_THREAD(transmitter_thread(transmitter_state_t* tx))
-{
-    static uint8_t ack_value;
-    
-    PT_BEGIN(&tx->pt);
-    
-    tx->retry_count = 0;
-    tx->transmission_complete = false;
-    
-    // Create protocol message
-    tx->message_size = (uint8_t)sizeof(tx->message_buffer);
-    tx->result = protocol_create_message(tx->data_to_send, tx->data_size, 
-                                       tx->message_buffer, &tx->message_size);
-    
-    if (tx->result != PROTOCOL_SUCCESS) {
-        PT_EXIT(&tx->pt);
-    }
-    
-    while (tx->retry_count < MAX_RETRIES) {
-        // Send the message
-        channel_send(tx->message_buffer, tx->message_size);
-        
-        // Wait for acknowledgment or timeout
-        timer_set(&tx->timer, TIMEOUT_MS);
-        
-        PT_WAIT_UNTIL(&tx->pt, 
-            channel_ack_received(&ack_value) || timer_expired(&tx->timer));
-        
-        if (timer_expired(&tx->timer)) {
-            // Timeout - retry
-            tx->retry_count++;
-            printf("Transmitter: Timeout, retry %d/%d\n", tx->retry_count, MAX_RETRIES);
-        } else {
-            // ACK/NACK received
-            if (ack_value == ACK_BYTE) {
-                printf("Transmitter: ACK received, transmission complete\n");
-                tx->transmission_complete = true;
-                tx->result = PROTOCOL_SUCCESS;
-                PT_EXIT(&tx->pt);
-            } else if (ack_value == NACK_BYTE) {
-                // NACK - retry
-                tx->retry_count++;
-                printf("Transmitter: NACK received, retry %d/%d\n", tx->retry_count, MAX_RETRIES);
-            }
-        }
-    }
-    
-    // Max retries reached
-    printf("Transmitter: Max retries reached, transmission failed\n");
-    tx->result = PROTOCOL_TIMEOUT;
-    tx->transmission_complete = true; // Mark as complete even if failed
+// Consome uma unidade; retorna false se não há
+static inline bool pt_sem_take(pt_sem_t* s) {
+    bool livre;
     
-    PT_END(&tx->pt);
+    PT_ATOMIC(livre = s->count > 0; if (livre) s->count--);
+    return livre;
 }
 
-PT_THREAD(receiver_thread(receiver_state_t* rx))
-{
-    static uint8_t incoming_byte;
-    
-    PT_BEGIN(&rx->pt);
+#define PT_SEM_WAIT(pt, s) PT_WAIT_EVENT((pt), &(s)->available, pt_sem_take(s))
+#define PT_SEM_SIGNAL(pt, s) pt_sem_signal(s)
+
+// Uma passada: retoma cada thread pronta uma vez, da de menor identificador
+// para a maior. As acordadas durante a passada ficam para a seguinte; a que
+// cede com PT_YIELD continua pronta. Retorna quantas threads foram retomadas
+int pt_schedule(void) {
+    pt_mask_t prontas;
+    int retomadas = 0;
     
-    while (1) {
-        rx->state = RX_WAIT_STX;
-        rx->rx_count = 0;
-        rx->checksum_calc = 0;
-        rx->message_received = false;
-        
-        // Wait for STX
-        PT_WAIT_UNTIL(&rx->pt, 
-            channel_receive_byte(&incoming_byte) && incoming_byte == STX_BYTE);
-        
-        rx->state = RX_WAIT_QTD;
-        
-        // Wait for quantity byte
-        PT_WAIT_UNTIL(&rx->pt, channel_receive_byte(&incoming_byte));
-        
-        if (incoming_byte == 0) {
-            printf("Receiver: Invalid quantity, sending NACK\n");
-            channel_send_ack(NACK_BYTE);
-            continue; // Restart
-        }
-        
-        rx->expected_size = incoming_byte;
-        rx->state = RX_WAIT_DATA;
-        
-        // Receive data bytes
-        for (rx->rx_count = 0; rx->rx_count < rx->expected_size; rx->rx_count++) {
-            PT_WAIT_UNTIL(&rx->pt, channel_receive_byte(&incoming_byte));
-            rx->rx_data[rx->rx_count] = incoming_byte;
-            rx->checksum_calc += incoming_byte;
-        }
-        
-        rx->state = RX_WAIT_CHK;
-        
-        // Wait for checksum
-        PT_WAIT_UNTIL(&rx->pt, channel_receive_byte(&incoming_byte));
-        rx->checksum_recv = incoming_byte;
-        
-        rx->state = RX_WAIT_ETX;
-        
-        // Wait for ETX
-        PT_WAIT_UNTIL(&rx->pt, channel_receive_byte(&incoming_byte));
+    PT_ATOMIC(prontas = pt_ready; pt_ready = 0);
+    while (prontas) {
+        int id = pt_lowest(prontas);
+        pt_mask_t bit = (pt_mask_t)1u << id;
         
-        if (incoming_byte == ETX_BYTE && rx->checksum_calc == rx->checksum_recv) {
-            printf("Receiver: Valid message received, sending ACK\n");
-            rx->message_received = true;
-            rx->result = PROTOCOL_SUCCESS;
-            channel_send_ack(ACK_BYTE);
-        } else {
-            printf("Receiver: Invalid message (ETX or checksum), sending NACK\n");
-            rx->result = PROTOCOL_ERROR;
-            channel_send_ack(NACK_BYTE);
+        prontas &= prontas - 1;
+        pt_current = id;
+        switch (pt_threads[id].run(pt_threads[id].contexto)) {
+            case PT_YIELDED:
+                PT_ATOMIC(pt_ready |= bit);
+                break;
+            case PT_EXITED:
+            case PT_ENDED:
+                pt_finished |= bit;
+                break;
+            default:
+                break;
         }
-        
-        // Yield to allow other threads to run
-        PT_YIELD(&rx->pt);
+        retomadas++;
     }
-    
-    PT_END(&rx->pt);
+    pt_current = -1;
+    return retomadas;
 }
 
 // ========================================
-// PUBLIC API
+// TIMER INFRASTRUCTURE
 // ========================================
 
-void protothreads_init(void) {
-    PT_INIT(&tx_state.pt);
-    PT_INIT(&rx_state.pt);
-    channel_reset();
-    system_time_ms = 0;
-}
+typedef struct timer {
+    uint32_t start_time;
+    uint32_t timeout_ms;
+    bool active;
+    pt_event_t expired;                   // Sinalizado quando o timer expira
+    struct timer* next;                   // Lista dos timers armados
+} timer_t;
 
-int protothreads_send_data(uint8_t* data, uint8_t size) {
-    if (!data || size == 0) return PROTOCOL_INVALID_PARAM;
-    
-    // Reset all transmitter state for new transmission
-    tx_state.data_to_send = data;
-    tx_state.data_size = size;
-    tx_state.retry_count = 0;
-    tx_state.transmission_complete = false;
-    tx_state.result = 0;
-    timer_stop(&tx_state.timer);
-    PT_INIT(&tx_state.pt);
-    
-    return PROTOCOL_SUCCESS;
+// Tempo simulado na partida e em protothreads_init. Perto de UINT32_MAX (ex.:
+// -DSYSTEM_TIME_INICIAL=0xFFFFF000), os testes atravessam a volta do
+// contador, que só aconteceria após 49 dias
+#ifndef SYSTEM_TIME_INICIAL
+#define SYSTEM_TIME_INICIAL 0u
+#endif
+
+// Fonte do tempo dos timers, em ms. Sem PT_TIME_NOW, o tempo é virtual e só
+// anda por advance_time: os testes e as medições no host injetam o tempo que
+// quiserem. No microcontrolador, PT_TIME_NOW() lê o relógio do sistema (ex.:
+// PonteProtothreadsTempoMs(), das marcas do RTOS, ou TempoUs() / 1000), e
+// timer_set, timer_expired e advance_time o releem: os timeouts contam do
+// instante real do envio, sem um relógio paralelo. O valor deve dar a volta
+// em 2^32 ms, como system_time_ms
+#ifdef PT_TIME_NOW
+#define PT_TIME_START() PT_TIME_NOW()
+#else
+#define PT_TIME_START() SYSTEM_TIME_INICIAL
+#endif
+
+// Current time (milliseconds): virtual, or the last read of PT_TIME_NOW
+static uint32_t system_time_ms = SYSTEM_TIME_INICIAL;
+
+static inline uint32_t pt_time_now(void) {
+#ifdef PT_TIME_NOW
+    system_time_ms = PT_TIME_NOW();
+#endif
+    return system_time_ms;
 }
 
-bool protothreads_transmission_complete(void) {
-    return tx_state.transmission_complete;
+// Fila dos timers armados e ainda não expirados, em ordem de expiração:
+// advance_time só olha o início da fila e next_deadline é o primeiro. Um
+// timer armado deve continuar válido até expirar ou ser parado
+static timer_t* armed_timers = NULL;
+
+// Tempo até a expiração, contado a partir de agora (sem problema com a volta
+// de system_time_ms, com timeouts menores que 2^31 ms)
+static uint32_t timer_remaining(const timer_t* timer) {
+    return timer->start_time + timer->timeout_ms - system_time_ms;
 }
 
-int protothreads_get_tx_result(void) {
-    return tx_state.result;
+// Tira o timer da fila; retorna false se ele não estava nela
+static bool timer_disarm(timer_t* timer) {
+    for (timer_t** t = &armed_timers; *t; t = &(*t)->next) {
+        if (*t == timer) {
+            *t = timer->next;
+            return true;
+        }
+    }
+    return false;
 }
 
-bool protothreads_message_received(void) {
-    return rx_state.message_received;
+void timer_set(timer_t* timer, uint32_t timeout_ms) {
+    timer_t** t;
+    
+    timer_disarm(timer);
+    timer->start_time = pt_time_now();
+    timer->timeout_ms = timeout_ms;
+    timer->active = true;
+    
+    // Depois dos que expiram antes ou junto (com PT_TIME_NOW, os já vencidos
+    // que advance_time ainda não tirou têm tempo restante negativo)
+    for (t = &armed_timers; *t && (int32_t)timer_remaining(*t) <= (int32_t)timeout_ms; t = &(*t)->next) {
+    }
+    timer->next = *t;
+    *t = timer;
 }
 
-uint8_t* protothreads_get_received_data(void) {
-    return rx_state.rx_data;
+bool timer_expired(timer_t* timer) {
+    if (!timer->active) return false;
+    return (pt_time_now() - timer->start_time) >= timer->timeout_ms;
 }
 
-uint8_t protothreads_get_received_size(void) {
-    return rx_state.expected_size;
+void timer_stop(timer_t* timer) {
+    timer->active = false;
+    timer_disarm(timer);
 }
 
-int protothreads_get_rx_result(void) {
-    return rx_state.result;
+// Próxima expiração em *deadline_ms (no tempo de system_time_ms); retorna
+// false se não há timer armado. Sem thread pronta, o host ou o RTOS pode
+// dormir até lá em vez de avançar o tempo aos poucos
+bool next_deadline(uint32_t* deadline_ms) {
+    if (!armed_timers) return false;
+    
+    *deadline_ms = armed_timers->start_time + armed_timers->timeout_ms;
+    return true;
 }
 
-// Main scheduler
-void protothreads_schedule(void) {
-    transmitter_thread(&tx_state);
-    receiver_thread(&rx_state);
+static void channels_deliver(void);
+static void fanout_ports_complete(void);
+static void tx_scheds_complete(void);
+
+// Simulate time advancement. Com PT_TIME_NOW, ms é ignorado: o tempo é o do
+// relógio, e só as expirações até agora são tratadas
+void advance_time(uint32_t ms) {
+#ifdef PT_TIME_NOW
+    (void)ms;
+    pt_time_now();
+#else
+    system_time_ms += ms;
+#endif
+    
+    // Os expirados saem do início da fila e acordam quem os espera (continuam
+    // expirados para timer_expired até o próximo timer_set ou timer_stop)
+    while (armed_timers && timer_expired(armed_timers)) {
+        timer_t* timer = armed_timers;
+        armed_timers = timer->next;
+        pt_event_signal(&timer->expired);
+    }
+    channels_deliver();
+    fanout_ports_complete();
+    tx_scheds_complete();
 }
 
 // ========================================
-// TESTS
+// RETRANSMISSION TIMEOUT
 // ========================================
 
-static char * executa_testes(void);
+// Timeout de retransmissão adaptativo (Jacobson/Karels, como na RFC 6298):
+// RTT suavizado e a sua variação medidos pelo tempo até o ACK, RTO =
+// SRTT + max(RTO_FOLGA_MS, 4 * RTTVAR), e o RTO dobra a cada perda seguida.
+// Só se mede o RTT de quadros não retransmitidos (algoritmo de Karn): o ACK
+// de um retransmitido pode ser do envio anterior
+#ifndef RTO_MIN_MS
+#define RTO_MIN_MS 20
+#endif
 
-int main() {
-    char *resultado = executa_testes();
-    if (resultado != 0) {
-        printf("%s\n", resultado);
-    } else {
-        printf("TODOS OS TESTES PASSARAM\n");
-    }
-    printf("Testes executados: %d\n", testes_executados);
+#ifndef RTO_MAX_MS
+#define RTO_MAX_MS 60000
+#endif
 
-    return resultado != 0;
+// Folga mínima sobre o SRTT, para a variação não zerar com RTT constante
+#ifndef RTO_FOLGA_MS
+#define RTO_FOLGA_MS 10
+#endif
+
+typedef struct {
+    uint32_t srtt8;                       // RTT suavizado, em 1/8 ms
+    uint32_t rttvar4;                     // Variação do RTT, em 1/4 ms
+    uint32_t base_ms;                     // RTO sem recuo
+    uint32_t rto_ms;                      // RTO atual, com o recuo
+    uint8_t backoff;                      // Perdas seguidas desde a última medida
+    uint32_t samples;                     // Medidas de RTT
+} rto_estimator_t;
+
+static uint32_t rto_clamp(uint32_t rto) {
+    return rto < RTO_MIN_MS ? RTO_MIN_MS : rto > RTO_MAX_MS ? RTO_MAX_MS : rto;
 }
 
-static char * test_protothread_init(void) {
-    protothreads_init();
-    
-    verifica("erro: tx_state deve estar inicializado", tx_state.pt.lc == 0);
-    verifica("erro: rx_state deve estar inicializado", rx_state.pt.lc == 0);
-    verifica("erro: system_time deve ser 0", system_time_ms == 0);
-    
-    return 0;
+void rto_init(rto_estimator_t* rto, uint32_t initial_ms) {
+    memset(rto, 0, sizeof(*rto));
+    rto->base_ms = rto_clamp(initial_ms);
+    rto->rto_ms = rto->base_ms;
 }
 
-static char * test_successful_transmission(void) {
-    protothreads_init();
-    
-    uint8_t test_data[] = {0xAA, 0xBB, 0xCC};
-    protothreads_send_data(test_data, 3);
-    
-    // Run threads until transmission completes
-    for (int i = 0; i < 100 && !protothreads_transmission_complete(); i++) {
-        protothreads_schedule();
-        if (i % 10 == 0) advance_time(10); // Advance time periodically
+// Uma medida de RTT: atualiza SRTT e RTTVAR e desfaz o recuo
+void rto_sample(rto_estimator_t* rto, uint32_t rtt_ms) {
+    if (rto->samples++ == 0) {
+        rto->srtt8 = rtt_ms << 3;
+        rto->rttvar4 = rtt_ms << 1;       // RTTVAR = RTT / 2
+    } else {
+        // SRTT += (RTT - SRTT) / 8; RTTVAR += (|RTT - SRTT| - RTTVAR) / 4
+        int32_t erro = (int32_t)rtt_ms - (int32_t)(rto->srtt8 >> 3);
+        rto->srtt8 = (uint32_t)((int32_t)rto->srtt8 + erro);
+        if (erro < 0) erro = -erro;
+        rto->rttvar4 = (uint32_t)((int32_t)rto->rttvar4 + erro - (int32_t)(rto->rttvar4 >> 2));
     }
     
-    verifica("erro: transmissão deve estar completa", protothreads_transmission_complete());
-    verifica("erro: resultado TX deve ser SUCCESS", protothreads_get_tx_result() == PROTOCOL_SUCCESS);
-    verifica("erro: mensagem deve ser recebida", protothreads_message_received());
-    verifica("erro: resultado RX deve ser SUCCESS", protothreads_get_rx_result() == PROTOCOL_SUCCESS);
-    verifica("erro: tamanho recebido deve ser 3", protothreads_get_received_size() == 3);
-    verifica("erro: dados recebidos devem estar corretos", 
-             memcmp(protothreads_get_received_data(), test_data, 3) == 0);
-    
-    return 0;
+    uint32_t variacao = rto->rttvar4 > RTO_FOLGA_MS ? rto->rttvar4 : RTO_FOLGA_MS;
+    rto->base_ms = rto_clamp((rto->srtt8 >> 3) + variacao);
+    rto->backoff = 0;
+    rto->rto_ms = rto->base_ms;
 }
 
-static char * test_timeout_and_retry(void) {
-    protothreads_init();
-    
-    uint8_t test_data[] = {0x12, 0x34};
+// ACK de dados novos sem medida (só de retransmitidos): o enlace voltou a
+// entregar, então o recuo é desfeito, mas SRTT e RTTVAR ficam como estão
+void rto_progress(rto_estimator_t* rto) {
+    rto->backoff = 0;
+    rto->rto_ms = rto->base_ms;
+}
+
+// Uma perda por timeout: dobra o RTO, até RTO_MAX_MS
+void rto_backoff(rto_estimator_t* rto) {
+    if (rto->rto_ms < RTO_MAX_MS) {
+        rto->backoff++;
+        rto->rto_ms = rto_clamp(rto->rto_ms * 2);
+    }
+}
+
+// ========================================
+// CHANNEL IMPAIRMENTS
+// ========================================
+
+// Degradações de um canal simulado, reproduzíveis pela semente, em tempo
+// simulado: aplicadas no envio, com as chegadas feitas por advance_time.
+// Tudo zero é o canal perfeito, que entrega na hora
+typedef struct {
+    uint8_t loss_percent;                   // Quadros perdidos inteiros
+    uint8_t ack_loss_percent;               // ACK/NACK perdidos (comm_channel_t; no ARQ
+                                            // cada sentido é um link_t)
+    uint32_t ber_ppm;                       // Bits trocados por milhão de bits
+    uint32_t delay_ms;                      // Latência fixa
+    uint32_t jitter_ms;                     // Mais 0 a jitter_ms, sem reordenar os quadros
+    uint32_t rate;                          // Bytes/s no meio (0: sem limite)
+    uint32_t seed;                          // Estado do gerador pseudoaleatório
+} channel_impairment_t;
+
+static bool impairment_drop(channel_impairment_t* imp, uint8_t percent) {
+    return percent && protocol_bench_aleatorio(&imp->seed) % 100 < percent;
+}
+
+// Troca cada bit do byte com probabilidade ber_ppm / 10^6; retorna se trocou
+static bool impairment_corrupt(channel_impairment_t* imp, uint8_t* byte) {
+    uint8_t original = *byte;
+    
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        uint32_t sorteio = (protocol_bench_aleatorio(&imp->seed) << 16) | protocol_bench_aleatorio(&imp->seed);
+        if (sorteio % 1000000u < imp->ber_ppm) {
+            *byte ^= (uint8_t)(1u << bit);
+        }
+    }
+    return *byte != original;
+}
+
+// Chegada de um quadro de size bytes enviado agora: espera o meio livre
+// (*busy_until, que pode ser de outro sentido; NULL, sem disputar o meio nem
+// taxa), a transmissão na taxa, a latência e a variação, e não chega antes
+// de not_before (o anterior)
+static uint32_t impairment_arrival(channel_impairment_t* imp, uint32_t* busy_until, uint32_t size,
+                                   uint32_t not_before) {
+    uint32_t fim = system_time_ms;
+    
+    // O quadro ocupa o meio também quando se perde
+    if (imp->rate && busy_until) {
+        if ((int32_t)(*busy_until - fim) > 0) {
+            fim = *busy_until;
+        }
+        fim += (size * 1000u + imp->rate - 1) / imp->rate;
+        *busy_until = fim;
+    }
+    fim += imp->delay_ms;
+    if (imp->jitter_ms) {
+        fim += protocol_bench_aleatorio(&imp->seed) % (imp->jitter_ms + 1);
+    }
+    return (int32_t)(fim - not_before) < 0 ? not_before : fim;
+}
+
+// ========================================
+// COMMUNICATION CHANNEL SIMULATION
+// ========================================
+
+// Bytes em trânsito em cada canal (potência de 2): vários quadros cabem ao
+// mesmo tempo e o que não cabe é recusado, como uma UART sem espaço
+#ifndef CHANNEL_CAPACITY
+#define CHANNEL_CAPACITY 1024u
+#endif
+
+// ACK/NACK em trânsito no sentido contrário
+#ifndef CHANNEL_ACKS
+#define CHANNEL_ACKS 8u
+#endif
+
+// Escritas a caminho num canal com latência; com todas ocupadas a escrita
+// seguinte se perde
+#ifndef CHANNEL_FLIGHT
+#define CHANNEL_FLIGHT 16u
+#endif
+
+#if (CHANNEL_CAPACITY & (CHANNEL_CAPACITY - 1)) != 0 || CHANNEL_CAPACITY > 32768u
+#error "CHANNEL_CAPACITY deve ser potencia de 2 ate 32768"
+#endif
+
+// Menor janela do controle de fluxo: o maior quadro do transmissor, que só
+// sai inteiro
+#define CHANNEL_MIN_WINDOW (MAX_DATA_SIZE + 10)
+
+#if CHANNEL_CAPACITY < CHANNEL_MIN_WINDOW
+#error "CHANNEL_CAPACITY deve caber o maior quadro"
+#endif
+
+typedef struct {
+    uint8_t value;                          // ACK or NACK
+    bool has_seq;                           // From a receiver with sequence numbers
+    uint8_t seq;                            // Sequence number it answers
+    uint32_t deliver_at;                    // system_time_ms da chegada
+} channel_ack_t;
+
+typedef struct {
+    uint16_t end;                           // write depois da escrita
+    uint32_t deliver_at;
+} channel_flight_t;
+
+// Canal de um transmissor para um receptor: FIFO de bytes com índices que
+// contam sem parar (posição = índice & (CHANNEL_CAPACITY - 1)), e os
+// ACK/NACK de volta. Cada par de threads usa a sua instância. Com
+// channel_impair, os bytes entre arrived e write estão a caminho: ocupam a
+// FIFO, mas o receptor só os vê quando chegam
+typedef struct comm_channel {
+    uint8_t fifo[CHANNEL_CAPACITY];
+    uint16_t write;                         // Total de bytes escritos
+    uint16_t arrived;                       // Total de bytes que já chegaram
+    uint16_t read;                          // Total de bytes lidos
+    channel_ack_t acks[CHANNEL_ACKS];
+    uint8_t ack_head;
+    uint8_t ack_count;
+    bool impaired;                          // Com impairment; senão entrega na hora
+    channel_impairment_t impairment;
+    channel_flight_t flight[CHANNEL_FLIGHT];
+    uint8_t flight_head;
+    uint8_t flight_count;
+    uint32_t busy_until;                    // Fim da transmissão em curso no meio
+    timer_t delivery;                       // Expira na próxima chegada (bytes ou ACK)
+    struct comm_channel* next_impaired;     // Lista dos canais com impairment
+    uint32_t rejected;                      // Bytes recusados por falta de espaço
+    uint32_t lost;                          // Escritas perdidas pelo impairment
+    uint32_t corrupted;                     // Bytes com bits trocados
+    uint32_t acks_lost;
+    bool flow;                              // Controle de fluxo por créditos (channel_flow_control)
+    uint16_t window;                        // Bytes que o receptor aceita além de read
+    uint16_t credit_limit;                  // Até onde write pode ir, o último crédito que chegou
+    uint16_t credit_granted;                // O último crédito concedido pelo receptor
+    bool credit_in_flight;                  // Um crédito a caminho do transmissor, em credit_at
+    uint32_t credit_at;
+    uint32_t credit_updates;                // Créditos enviados pelo receptor
+    pt_event_t rx_event;                    // Sinalizado quando chegam bytes
+    pt_event_t ack_event;                   // Sinalizado quando chega um ACK/NACK
+    pt_event_t credit_event;                // Sinalizado quando há mais espaço ou crédito
+} comm_channel_t;
+
+// Canal do transmissor e do receptor de protothreads_init
+static comm_channel_t channel = {0};
+
+// Canais com impairment, que advance_time percorre para as chegadas
+static comm_channel_t* impaired_channels = NULL;
+
+uint16_t channel_available(const comm_channel_t* ch) {
+    return (uint16_t)(ch->arrived - ch->read);
+}
+
+uint16_t channel_space(const comm_channel_t* ch) {
+    return (uint16_t)(CHANNEL_CAPACITY - (uint16_t)(ch->write - ch->read));
+}
+
+// Bytes que o transmissor pode escrever agora: o espaço na FIFO e, com o
+// controle de fluxo, o crédito do receptor
+uint16_t channel_credit(const comm_channel_t* ch) {
+    uint16_t espaco = channel_space(ch);
+    
+    if (ch->flow) {
+        uint16_t credito = (uint16_t)(ch->credit_limit - ch->write);
+        if (credito > ch->window) {
+            credito = 0;                    // write passou do crédito (janela reduzida)
+        }
+        return credito < espaco ? credito : espaco;
+    }
+    return espaco;
+}
+
+static bool channel_ack_arrived(const channel_ack_t* ack) {
+    return (int32_t)(system_time_ms - ack->deliver_at) >= 0;
+}
+
+// Arma a entrega para a próxima chegada, de bytes ou de ACK
+static void channel_schedule_delivery(comm_channel_t* ch) {
+    bool pendente = false;
+    uint32_t proxima = 0;
+    
+    if (ch->flight_count > 0) {
+        proxima = ch->flight[ch->flight_head].deliver_at;
+        pendente = true;
+    }
+    if (ch->credit_in_flight && (!pendente || (int32_t)(ch->credit_at - proxima) < 0)) {
+        proxima = ch->credit_at;
+        pendente = true;
+    }
+    for (uint8_t i = 0; i < ch->ack_count; i++) {
+        const channel_ack_t* ack = &ch->acks[(ch->ack_head + i) % CHANNEL_ACKS];
+        if (!channel_ack_arrived(ack)) {
+            if (!pendente || (int32_t)(ack->deliver_at - proxima) < 0) {
+                proxima = ack->deliver_at;
+                pendente = true;
+            }
+            break;                          // Os ACKs chegam em ordem
+        }
+    }
+    if (pendente) {
+        timer_set(&ch->delivery, proxima - system_time_ms);
+    } else {
+        timer_stop(&ch->delivery);
+    }
+}
+
+// O receptor concede crédito até read + window. No canal perfeito ele chega
+// na hora; com channel_impair, leva a latência do sentido contrário, como
+// um sinal de controle de fluxo (RTS/CTS), sem perda: com um crédito a
+// caminho, o seguinte sai quando ele chegar
+static void channel_grant(comm_channel_t* ch) {
+    uint16_t limite = (uint16_t)(ch->read + ch->window);
+    
+    if (!ch->flow || limite == ch->credit_granted || ch->credit_in_flight) return;
+    
+    ch->credit_granted = limite;
+    ch->credit_updates++;
+    if (!ch->impaired) {
+        ch->credit_limit = limite;
+        pt_event_signal(&ch->credit_event);
+        return;
+    }
+    ch->credit_at = impairment_arrival(&ch->impairment, NULL, 1, system_time_ms);
+    ch->credit_in_flight = true;
+    channel_schedule_delivery(ch);
+}
+
+// Bytes lidos: mais espaço na FIFO e, com o controle de fluxo, crédito
+static void channel_consumed(comm_channel_t* ch) {
+    if (ch->flow) {
+        channel_grant(ch);
+    } else if (ch->credit_event.waiting) {
+        pt_event_signal(&ch->credit_event);
+    }
+}
+
+// Liga o controle de fluxo: o transmissor só escreve o que o receptor
+// concedeu, até window bytes além do que ele já leu (no mínimo
+// CHANNEL_MIN_WINDOW, no máximo CHANNEL_CAPACITY). window 0 desliga. Um
+// produtor mais rápido que o consumidor espera o crédito (channel_credit e
+// credit_event) em vez de ter os quadros recusados
+void channel_flow_control(comm_channel_t* ch, uint16_t window) {
+    ch->flow = window != 0;
+    if (window != 0 && window < CHANNEL_MIN_WINDOW) window = CHANNEL_MIN_WINDOW;
+    if (window > CHANNEL_CAPACITY) window = CHANNEL_CAPACITY;
+    ch->window = window;
+    ch->credit_limit = (uint16_t)(ch->read + window);
+    ch->credit_granted = ch->credit_limit;
+    ch->credit_in_flight = false;
+    pt_event_signal(&ch->credit_event);
+}
+
+// Entrega o que já chegou e arma a próxima entrega
+static void channel_deliver(comm_channel_t* ch) {
+    bool chegaram = false;
+    
+    while (ch->flight_count > 0 &&
+           (int32_t)(system_time_ms - ch->flight[ch->flight_head].deliver_at) >= 0) {
+        ch->arrived = ch->flight[ch->flight_head].end;
+        ch->flight_head = (uint8_t)((ch->flight_head + 1) % CHANNEL_FLIGHT);
+        ch->flight_count--;
+        chegaram = true;
+    }
+    if (chegaram) {
+        pt_event_signal(&ch->rx_event);
+    }
+    if (ch->ack_count > 0 && channel_ack_arrived(&ch->acks[ch->ack_head])) {
+        pt_event_signal(&ch->ack_event);
+    }
+    if (ch->credit_in_flight && (int32_t)(system_time_ms - ch->credit_at) >= 0) {
+        ch->credit_in_flight = false;
+        ch->credit_limit = ch->credit_granted;
+        pt_event_signal(&ch->credit_event);
+        channel_grant(ch);                  // O receptor leu mais enquanto ele vinha
+    }
+    channel_schedule_delivery(ch);
+}
+
+// Chamada por advance_time: as chegadas dos canais com impairment
+static void channels_deliver(void) {
+    for (comm_channel_t* ch = impaired_channels; ch; ch = ch->next_impaired) {
+        if (timer_expired(&ch->delivery)) {
+            channel_deliver(ch);
+        }
+    }
+}
+
+// Tira o canal da lista dos canais com impairment
+static void channel_unlist(comm_channel_t* ch) {
+    for (comm_channel_t** c = &impaired_channels; *c; c = &(*c)->next_impaired) {
+        if (*c == ch) {
+            *c = ch->next_impaired;
+            return;
+        }
+    }
+}
+
+// Liga as degradações de imp ao canal, ou volta ao canal perfeito com NULL
+// (o que estava a caminho chega na hora). O canal vazio por channel_reset
+// também volta a ser perfeito
+void channel_impair(comm_channel_t* ch, const channel_impairment_t* imp) {
+    ch->arrived = ch->write;
+    ch->flight_count = 0;
+    for (uint8_t i = 0; i < ch->ack_count; i++) {
+        ch->acks[(ch->ack_head + i) % CHANNEL_ACKS].deliver_at = system_time_ms;
+    }
+    if (ch->credit_in_flight) {
+        ch->credit_in_flight = false;
+        ch->credit_limit = ch->credit_granted;
+    }
+    timer_stop(&ch->delivery);
+    channel_unlist(ch);
+    ch->busy_until = system_time_ms;
+    ch->impaired = imp != NULL;
+    if (imp) {
+        ch->impairment = *imp;
+        ch->next_impaired = impaired_channels;
+        impaired_channels = ch;
+    }
+    pt_event_signal(&ch->rx_event);
+    pt_event_signal(&ch->ack_event);
+    pt_event_signal(&ch->credit_event);
+    channel_grant(ch);
+}
+
+// Os n bytes escritos agora no fim da FIFO passam pelas degradações: podem
+// se perder, ter bits trocados ou chegar depois
+static void channel_transmit(comm_channel_t* ch, uint16_t n) {
+    channel_impairment_t* imp = &ch->impairment;
+    uint32_t anterior = ch->flight_count > 0 ?
+        ch->flight[(ch->flight_head + ch->flight_count - 1) % CHANNEL_FLIGHT].deliver_at : system_time_ms;
+    uint32_t chegada = impairment_arrival(imp, &ch->busy_until, n, anterior);
+    
+    if (impairment_drop(imp, imp->loss_percent) ||
+        (chegada != system_time_ms && ch->flight_count == CHANNEL_FLIGHT)) {
+        ch->write = (uint16_t)(ch->write - n);
+        ch->lost++;
+        return;
+    }
+    if (imp->ber_ppm) {
+        for (uint16_t i = (uint16_t)(ch->write - n); i != ch->write; i++) {
+            ch->corrupted += impairment_corrupt(imp, &ch->fifo[i & (CHANNEL_CAPACITY - 1)]);
+        }
+    }
+    if (chegada == system_time_ms && ch->flight_count == 0) {
+        ch->arrived = ch->write;
+        pt_event_signal(&ch->rx_event);
+        return;
+    }
+    channel_flight_t* f = &ch->flight[(ch->flight_head + ch->flight_count) % CHANNEL_FLIGHT];
+    f->end = ch->write;
+    f->deliver_at = chegada;
+    if (ch->flight_count++ == 0) {
+        channel_schedule_delivery(ch);
+    }
+}
+
+// Escreve até size bytes e retorna quantos couberam (o resto fica para o
+// produtor tentar depois, como numa UART cheia)
+uint16_t channel_write(comm_channel_t* ch, const uint8_t* data, uint16_t size) {
+    uint16_t livre = channel_credit(ch);
+    uint16_t n = size < livre ? size : livre;
+    uint16_t inicio = (uint16_t)(ch->write & (CHANNEL_CAPACITY - 1));
+    uint16_t ate_o_fim = (uint16_t)(CHANNEL_CAPACITY - inicio);
+    
+    if (n == 0) {
+        ch->rejected += size;
+        return 0;
+    }
+    if (n <= ate_o_fim) {
+        memcpy(&ch->fifo[inicio], data, n);
+    } else {
+        memcpy(&ch->fifo[inicio], data, ate_o_fim);
+        memcpy(ch->fifo, &data[ate_o_fim], (size_t)(n - ate_o_fim));
+    }
+    ch->write = (uint16_t)(ch->write + n);
+    ch->rejected += (uint32_t)(size - n);
+    if (ch->impaired) {
+        channel_transmit(ch, n);
+    } else {
+        ch->arrived = ch->write;
+        pt_event_signal(&ch->rx_event);
+    }
+    return n;
+}
+
+// Send a whole frame: all or nothing (refused when it does not fit, or with
+// flow control when the receiver has not granted the credit). Returns true
+// if the frame left, even if the impairments lose it on the way
+bool channel_send(comm_channel_t* ch, const uint8_t* data, uint8_t size) {
+    if (channel_credit(ch) < size) {
+        ch->rejected += size;
+        return false;
+    }
+    channel_write(ch, data, size);
+    return true;
+}
+
+// Receive up to max bytes at once into dest; returns how many were copied
+uint8_t channel_receive(comm_channel_t* ch, uint8_t* dest, uint8_t max) {
+    uint16_t disponivel = channel_available(ch);
+    uint16_t n = disponivel < max ? disponivel : max;
+    uint16_t inicio = (uint16_t)(ch->read & (CHANNEL_CAPACITY - 1));
+    uint16_t ate_o_fim = (uint16_t)(CHANNEL_CAPACITY - inicio);
+    
+    if (n <= ate_o_fim) {
+        memcpy(dest, &ch->fifo[inicio], n);
+    } else {
+        memcpy(dest, &ch->fifo[inicio], ate_o_fim);
+        memcpy(&dest[ate_o_fim], ch->fifo, (size_t)(n - ate_o_fim));
+    }
+    ch->read = (uint16_t)(ch->read + n);
+    if (n > 0) {
+        channel_consumed(ch);
+    }
+    return (uint8_t)n;
+}
+
+// Receive byte from channel
+bool channel_receive_byte(comm_channel_t* ch, uint8_t* byte) {
+    if (channel_available(ch) == 0) return false;
+    
+    *byte = ch->fifo[ch->read & (CHANNEL_CAPACITY - 1)];
+    ch->read++;
+    channel_consumed(ch);
+    return true;
+}
+
+// Send ACK/NACK carrying the sequence number it answers (has_seq): also
+// tells the transmitter that this receiver filters duplicates. With the
+// ACK queue full the oldest one is lost. With channel_impair, ACKs can be
+// lost on the way back and take the channel's delay and jitter
+void channel_send_ack_seq(comm_channel_t* ch, uint8_t ack_type, bool has_seq, uint8_t seq) {
+    uint32_t chegada = system_time_ms;
+    
+    if (ch->impaired) {
+        channel_impairment_t* imp = &ch->impairment;
+        if (impairment_drop(imp, imp->ack_loss_percent)) {
+            ch->acks_lost++;
+            return;
+        }
+        uint32_t anterior = ch->ack_count > 0 ?
+            ch->acks[(ch->ack_head + ch->ack_count - 1) % CHANNEL_ACKS].deliver_at : system_time_ms;
+        chegada = impairment_arrival(imp, NULL, 1, anterior);
+    }
+    if (ch->ack_count == CHANNEL_ACKS) {
+        ch->ack_head = (uint8_t)((ch->ack_head + 1) % CHANNEL_ACKS);
+        ch->ack_count--;
+    }
+    channel_ack_t* ack = &ch->acks[(ch->ack_head + ch->ack_count) % CHANNEL_ACKS];
+    ack->value = ack_type;
+    ack->has_seq = has_seq;
+    ack->seq = seq;
+    ack->deliver_at = chegada;
+    ch->ack_count++;
+    if (chegada == system_time_ms) {
+        pt_event_signal(&ch->ack_event);
+    } else {
+        channel_schedule_delivery(ch);
+    }
+}
+
+// Send ACK/NACK
+void channel_send_ack(comm_channel_t* ch, uint8_t ack_type) {
+    channel_send_ack_seq(ch, ack_type, false, 0);
+}
+
+// Check for ACK/NACK, with its sequence number if it has one
+bool channel_ack_received_seq(comm_channel_t* ch, uint8_t* ack_type, bool* has_seq, uint8_t* seq) {
+    if (ch->ack_count == 0 || !channel_ack_arrived(&ch->acks[ch->ack_head])) return false;
+    
+    channel_ack_t* ack = &ch->acks[ch->ack_head];
+    *ack_type = ack->value;
+    *has_seq = ack->has_seq;
+    *seq = ack->seq;
+    ch->ack_head = (uint8_t)((ch->ack_head + 1) % CHANNEL_ACKS);
+    ch->ack_count--;
+    return true;
+}
+
+// Check for ACK/NACK
+bool channel_ack_received(comm_channel_t* ch, uint8_t* ack_type) {
+    bool has_seq;
+    uint8_t seq;
+    
+    return channel_ack_received_seq(ch, ack_type, &has_seq, &seq);
+}
+
+// Empty the channel, without impairments or flow control; the threads
+// waiting on its events stay subscribed
+void channel_reset(comm_channel_t* ch) {
+    pt_event_t rx_event = ch->rx_event;
+    pt_event_t ack_event = ch->ack_event;
+    pt_event_t credit_event = ch->credit_event;
+    
+    timer_disarm(&ch->delivery);
+    channel_unlist(ch);
+    memset(ch, 0, sizeof(*ch));
+    ch->rx_event = rx_event;
+    ch->ack_event = ack_event;
+    ch->credit_event = credit_event;
+}
+
+// ========================================
+// PROTOCOL FUNCTIONS
+// ========================================
+
+uint8_t protocol_calculate_checksum(uint8_t* dados, uint8_t qtd) {
+    if (!dados || qtd == 0) return 0;
+    
+    return protocol_sum8(dados, qtd);
+}
+
+int protocol_create_message(uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size) {
+    return protocol_frame_encode8(dados, qtd, buffer, buffer_size);
+}
+
+// Quadro com número de sequência: SOH, QTD, SEQ, DADOS, CHK, ETX, com QTD e
+// CHK contando o SEQ. É o layout de STX/QTD/CHK/ETX com SEQ como primeiro
+// dado e outro byte de início, então um receptor sem sequência nunca o
+// confunde com uma mensagem; por isso só é usado depois que o receptor
+// anunciou a sequência num ACK (channel_send_ack_seq)
+int protocol_create_message_seq(uint8_t seq, uint8_t* dados, uint8_t qtd, uint8_t* buffer, uint8_t* buffer_size) {
+    uint8_t com_seq[MAX_DATA_SIZE];
+    
+    if (!dados || qtd == 0 || qtd == UINT8_MAX) return PROTOCOL_INVALID_PARAM;
+    
+    com_seq[0] = seq;
+    memcpy(&com_seq[1], dados, qtd);
+    int result = protocol_frame_encode8(com_seq, (uint8_t)(qtd + 1), buffer, buffer_size);
+    if (result == PROTOCOL_SUCCESS) {
+        buffer[0] = SOH_BYTE;
+    }
+    return result;
+}
+
+// ========================================
+// MULTICAST FAN-OUT
+// ========================================
+
+// Um quadro para vários canais (ex.: a mesma configuração para todos os
+// enlaces do gateway), codificado uma vez: protocol_create_message escreve
+// num buffer do fanout_pool_t e cada porta de envio recebe só o ponteiro,
+// no seu anel de descritores. Cada porta envia um descritor por vez, como
+// um canal de DMA para a UART do enlace, na taxa da porta; o buffer volta
+// ao pool quando o envio da última porta termina (contagem de referências),
+// em vez de uma codificação e uma cópia do quadro por canal
+#ifndef FANOUT_BUFFERS
+#define FANOUT_BUFFERS 16u
+#endif
+
+// Descritores na fila de cada porta (potência de 2)
+#ifndef FANOUT_RING
+#define FANOUT_RING 8u
+#endif
+
+#if (FANOUT_RING & (FANOUT_RING - 1)) != 0 || FANOUT_RING > 128u
+#error "FANOUT_RING deve ser potencia de 2 ate 128"
+#endif
+
+// Com um pool do tamanho de um anel, uma porta lenta prende todos os buffers
+#if FANOUT_BUFFERS <= FANOUT_RING || FANOUT_BUFFERS > 255u
+#error "FANOUT_BUFFERS deve ser maior que FANOUT_RING e caber em 8 bits"
+#endif
+
+typedef struct {
+    uint8_t bytes[0xFF];                    // Quadro de protocol_create_message
+    uint8_t size;                           // Sem a folga após o ETX
+    uint8_t refs;                           // Portas que ainda não terminaram o envio
+} fanout_buffer_t;
+
+typedef struct {
+    fanout_buffer_t buffers[FANOUT_BUFFERS];
+    uint8_t free_list[FANOUT_BUFFERS];      // Índices dos buffers livres (pilha)
+    uint8_t free_count;
+    uint32_t encodes;                       // Quadros codificados
+    uint32_t exhausted;                     // Envios recusados sem buffer livre
+} fanout_pool_t;
+
+// Porta de envio para um canal: os descritores entre head e head + count
+// esperam o envio; o de head está no "DMA" até dma expirar
+typedef struct fanout_port {
+    fanout_pool_t* pool;
+    comm_channel_t* ch;
+    fanout_buffer_t* ring[FANOUT_RING];
+    uint8_t head;
+    uint8_t count;
+    uint32_t rate;                          // Bytes/s (0: o envio termina na hora)
+    bool busy;                              // Descritor de head em envio
+    timer_t dma;                            // Expira no fim do envio em curso
+    pt_event_t done_event;                  // Sinalizado quando um envio termina
+    struct fanout_port* next;               // Lista das portas, que advance_time percorre
+    uint32_t frames;                        // Quadros enviados
+    uint32_t rejected;                      // Quadros recusados com o anel cheio
+} fanout_port_t;
+
+// Portas iniciadas, com o envio terminado por advance_time
+static fanout_port_t* fanout_ports = NULL;
+
+void fanout_pool_init(fanout_pool_t* pool) {
+    memset(pool, 0, sizeof(*pool));
+    for (uint8_t i = 0; i < FANOUT_BUFFERS; i++) {
+        pool->free_list[i] = (uint8_t)(FANOUT_BUFFERS - 1u - i);
+    }
+    pool->free_count = FANOUT_BUFFERS;
+}
+
+uint8_t fanout_pool_available(const fanout_pool_t* pool) {
+    return pool->free_count;
+}
+
+// Solta uma referência; a última devolve o buffer ao pool
+static void fanout_release(fanout_pool_t* pool, fanout_buffer_t* buf) {
+    if (--buf->refs == 0) {
+        pool->free_list[pool->free_count++] = (uint8_t)(buf - pool->buffers);
+    }
+}
+
+static void fanout_port_start(fanout_port_t* port);
+
+// Fim do envio do descritor de head: o canal recebe o quadro, o buffer
+// perde uma referência e começa o próximo. Com o canal sem espaço, o DMA
+// espera a UART e tenta de novo no ms seguinte
+static void fanout_port_complete(fanout_port_t* port) {
+    fanout_buffer_t* buf = port->ring[port->head];
+    
+    if (channel_credit(port->ch) < buf->size) {
+        timer_set(&port->dma, 1);
+        return;
+    }
+    channel_send(port->ch, buf->bytes, buf->size);
+    port->frames++;
+    port->busy = false;
+    port->head = (uint8_t)((port->head + 1) & (FANOUT_RING - 1));
+    port->count--;
+    fanout_release(port->pool, buf);
+    pt_event_signal(&port->done_event);
+    fanout_port_start(port);
+}
+
+// Começa o envio do descritor de head, se há um e a porta está livre
+static void fanout_port_start(fanout_port_t* port) {
+    if (port->busy || port->count == 0) return;
+    
+    port->busy = true;
+    if (port->rate == 0) {
+        fanout_port_complete(port);
+        return;
+    }
+    uint32_t size = port->ring[port->head]->size;
+    timer_set(&port->dma, (size * 1000u + port->rate - 1) / port->rate);
+}
+
+// Chamada por advance_time: os envios que terminaram
+static void fanout_ports_complete(void) {
+    for (fanout_port_t* port = fanout_ports; port; port = port->next) {
+        if (port->busy && timer_expired(&port->dma)) {
+            fanout_port_complete(port);
+        }
+    }
+}
+
+// Porta vazia para o canal ch, com os buffers de pool, enviando bytes_per_s
+void fanout_port_init(fanout_port_t* port, fanout_pool_t* pool, comm_channel_t* ch, uint32_t bytes_per_s) {
+    pt_event_t done_event = port->done_event;
+    
+    timer_disarm(&port->dma);
+    for (fanout_port_t** p = &fanout_ports; *p; p = &(*p)->next) {
+        if (*p == port) {
+            *p = port->next;
+            break;
+        }
+    }
+    memset(port, 0, sizeof(*port));
+    port->pool = pool;
+    port->ch = ch;
+    port->rate = bytes_per_s;
+    port->done_event = done_event;
+    port->next = fanout_ports;
+    fanout_ports = port;
+}
+
+// Codifica dados uma vez e enfileira o quadro nas n portas, todas do mesmo
+// pool. Retorna em quantas portas ele entrou (as de anel cheio são puladas
+// e contadas em rejected), PROTOCOL_ERROR sem buffer livre ou
+// PROTOCOL_INVALID_PARAM
+int fanout_send(fanout_port_t* const* ports, int n, uint8_t* dados, uint8_t qtd) {
+    if (!ports || n <= 0 || n > 254 || !dados || qtd == 0 || qtd > 0xFF - PROTOCOL_FRAME_ENVELOPE) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    fanout_pool_t* pool = ports[0]->pool;
+    if (pool->free_count == 0) {
+        pool->exhausted++;
+        return PROTOCOL_ERROR;
+    }
+    
+    fanout_buffer_t* buf = &pool->buffers[pool->free_list[--pool->free_count]];
+    uint8_t size = sizeof(buf->bytes);
+    protocol_create_message(dados, qtd, buf->bytes, &size);
+    buf->size = (uint8_t)(size - 1u);
+    pool->encodes++;
+    
+    // Uma referência a mais durante a distribuição: uma porta sem taxa
+    // termina o envio dentro do laço e não pode devolver o buffer antes
+    // das outras o receberem
+    buf->refs = 1;
+    int enfileiradas = 0;
+    for (int i = 0; i < n; i++) {
+        fanout_port_t* port = ports[i];
+        if (port->count == FANOUT_RING) {
+            port->rejected++;
+            continue;
+        }
+        port->ring[(port->head + port->count) & (FANOUT_RING - 1)] = buf;
+        port->count++;
+        buf->refs++;
+        enfileiradas++;
+        fanout_port_start(port);
+    }
+    fanout_release(pool, buf);
+    return enfileiradas;
+}
+
+// ========================================
+// PRIORITY TX SCHEDULER
+// ========================================
+
+// Envio por prioridade na frente de um canal: um quadro grande de dados em
+// massa ocupa o enlace por muito tempo, e um alarme que chega logo depois
+// esperaria todos os quadros já enfileirados. O escalonador tem uma fila
+// por prioridade (0 é a mais urgente) e põe um quadro por vez no enlace, na
+// taxa do enlace; no fim de cada quadro escolhe o da fila mais urgente. Um
+// quadro em envio nunca é interrompido (preempção na fronteira dos
+// quadros): a espera de um urgente fica limitada ao quadro em envio mais os
+// urgentes à frente dele, qualquer que seja a fila de dados em massa
+#ifndef TX_PRIORITIES
+#define TX_PRIORITIES 3u
+#endif
+
+// Quadros em cada fila (potência de 2)
+#ifndef TX_QUEUE_FRAMES
+#define TX_QUEUE_FRAMES 8u
+#endif
+
+// Maior quadro: o buffer de mensagem do transmissor
+#define TX_FRAME_MAX (MAX_DATA_SIZE + 10)
+
+#if (TX_QUEUE_FRAMES & (TX_QUEUE_FRAMES - 1)) != 0 || TX_QUEUE_FRAMES > 128u
+#error "TX_QUEUE_FRAMES deve ser potencia de 2 ate 128"
+#endif
+#if TX_PRIORITIES < 1u || TX_PRIORITIES > 8u
+#error "TX_PRIORITIES deve estar entre 1 e 8"
+#endif
+
+typedef struct {
+    uint8_t bytes[TX_FRAME_MAX];
+    uint16_t size;
+    uint32_t queued_at;                     // system_time_ms da entrada na fila
+} tx_frame_t;
+
+typedef struct {
+    tx_frame_t frames[TX_QUEUE_FRAMES];
+    uint8_t head;
+    uint8_t count;
+} tx_queue_t;
+
+// O quadro de head da fila current está no enlace até wire expirar
+typedef struct tx_sched {
+    comm_channel_t* ch;
+    tx_queue_t queues[TX_PRIORITIES];
+    uint32_t rate;                          // Bytes/s (0: o envio termina na hora)
+    bool busy;
+    uint8_t current;                        // Prioridade do quadro em envio
+    timer_t wire;                           // Expira no fim do quadro em envio
+    pt_event_t done_event;                  // Sinalizado quando um quadro termina
+    struct tx_sched* next;                  // Lista dos escalonadores, que advance_time percorre
+    uint32_t sent[TX_PRIORITIES];           // Quadros enviados
+    uint32_t rejected[TX_PRIORITIES];       // Quadros recusados com a fila cheia
+    uint32_t max_wait_ms[TX_PRIORITIES];    // Maior espera na fila até o início do envio
+} tx_sched_t;
+
+// Escalonadores iniciados, com o envio terminado por advance_time
+static tx_sched_t* tx_scheds = NULL;
+
+static void tx_sched_start(tx_sched_t* s);
+
+// Fim do quadro em envio: o canal o recebe e começa o mais urgente. Com o
+// canal sem espaço, o enlace espera e tenta de novo no ms seguinte
+static void tx_sched_complete(tx_sched_t* s) {
+    tx_queue_t* q = &s->queues[s->current];
+    tx_frame_t* f = &q->frames[q->head];
+    
+    if (channel_credit(s->ch) < f->size) {
+        timer_set(&s->wire, 1);
+        return;
+    }
+    channel_write(s->ch, f->bytes, f->size);
+    s->sent[s->current]++;
+    s->busy = false;
+    q->head = (uint8_t)((q->head + 1) & (TX_QUEUE_FRAMES - 1));
+    q->count--;
+    pt_event_signal(&s->done_event);
+    tx_sched_start(s);
+}
+
+// Começa o quadro da fila mais urgente, se há um e o enlace está livre
+static void tx_sched_start(tx_sched_t* s) {
+    if (s->busy) return;
+    
+    uint8_t p = 0;
+    while (p < TX_PRIORITIES && s->queues[p].count == 0) {
+        p++;
+    }
+    if (p == TX_PRIORITIES) return;
+    
+    tx_frame_t* f = &s->queues[p].frames[s->queues[p].head];
+    uint32_t espera = system_time_ms - f->queued_at;
+    if (espera > s->max_wait_ms[p]) {
+        s->max_wait_ms[p] = espera;
+    }
+    s->busy = true;
+    s->current = p;
+    if (s->rate == 0) {
+        tx_sched_complete(s);
+        return;
+    }
+    timer_set(&s->wire, ((uint32_t)f->size * 1000u + s->rate - 1) / s->rate);
+}
+
+// Chamada por advance_time: os envios que terminaram
+static void tx_scheds_complete(void) {
+    for (tx_sched_t* s = tx_scheds; s; s = s->next) {
+        if (s->busy && timer_expired(&s->wire)) {
+            tx_sched_complete(s);
+        }
+    }
+}
+
+// Escalonador vazio para o canal ch, enviando bytes_per_s
+void tx_sched_init(tx_sched_t* s, comm_channel_t* ch, uint32_t bytes_per_s) {
+    pt_event_t done_event = s->done_event;
+    
+    timer_disarm(&s->wire);
+    for (tx_sched_t** p = &tx_scheds; *p; p = &(*p)->next) {
+        if (*p == s) {
+            *p = s->next;
+            break;
+        }
+    }
+    memset(s, 0, sizeof(*s));
+    s->ch = ch;
+    s->rate = bytes_per_s;
+    s->done_event = done_event;
+    s->next = tx_scheds;
+    tx_scheds = s;
+}
+
+// Copia o quadro para a fila da prioridade e retorna sem esperar o enlace:
+// PROTOCOL_SUCCESS, PROTOCOL_ERROR com a fila cheia (contado em rejected)
+// ou PROTOCOL_INVALID_PARAM
+int tx_sched_send(tx_sched_t* s, uint8_t priority, const uint8_t* frame, uint16_t size) {
+    if (!frame || size == 0 || size > TX_FRAME_MAX || priority >= TX_PRIORITIES) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    tx_queue_t* q = &s->queues[priority];
+    if (q->count == TX_QUEUE_FRAMES) {
+        s->rejected[priority]++;
+        return PROTOCOL_ERROR;
+    }
+    tx_frame_t* f = &q->frames[(q->head + q->count) & (TX_QUEUE_FRAMES - 1)];
+    memcpy(f->bytes, frame, size);
+    f->size = size;
+    f->queued_at = system_time_ms;
+    q->count++;
+    tx_sched_start(s);
+    return PROTOCOL_SUCCESS;
+}
+
+// Senha do último quadro enfileirado na prioridade: ele saiu quando
+// tx_sched_left a aceita
+uint32_t tx_sched_ticket(const tx_sched_t* s, uint8_t priority) {
+    return s->sent[priority] + s->queues[priority].count;
+}
+
+bool tx_sched_left(const tx_sched_t* s, uint8_t priority, uint32_t ticket) {
+    return (int32_t)(s->sent[priority] - ticket) >= 0;
+}
+
+// Quadros esperando na fila da prioridade, sem o que está em envio
+uint8_t tx_sched_pending(const tx_sched_t* s, uint8_t priority) {
+    const tx_queue_t* q = &s->queues[priority];
+    return (uint8_t)(q->count - (s->busy && s->current == priority));
+}
+
+// ========================================
+// PROTOTHREAD STATE VARIABLES
+// ========================================
+
+// Transmitter state
+typedef struct {
+    pt_t pt;
+    comm_channel_t* ch;                   // Canal até o receptor
+    tx_sched_t* sched;                    // Envio por prioridade no canal (NULL: direto)
+    uint8_t priority;                     // Fila no escalonador
+    uint32_t ticket;                      // Senha do envio em curso no escalonador
+    timer_t timer;
+    uint8_t* data_to_send;
+    uint8_t data_size;
+    uint8_t message_buffer[MAX_DATA_SIZE + 10];
+    uint8_t message_size;
+    uint8_t retry_count;
+    bool transmission_complete;
+    int result;
+    rto_estimator_t rto;                  // Mantido entre transmissões
+    uint32_t sent_at;                     // system_time_ms do primeiro envio
+    bool peer_sequencing;                 // O receptor anunciou números de sequência
+    bool sequenced;                       // A mensagem atual tem número de sequência
+    uint8_t seq;                          // Número da mensagem atual (um por mensagem, não por envio)
+    uint8_t ack_value;                    // ACK/NACK recebido
+    bool ack_has_seq;
+    uint8_t ack_seq;
+} transmitter_state_t;
+
+// Buffers de recepção da aplicação (session_rx_post): cada mensagem válida é
+// escrita direto no primeiro buffer postado, que passa à aplicação inteiro
+// (session_rx_take), sem cópia. Enquanto a aplicação trata uma mensagem, a
+// seguinte já chega no próximo buffer. Sem buffer postado, a mensagem fica em
+// rx_data, como antes
+#ifndef RX_BUFFERS
+#define RX_BUFFERS 4
+#endif
+
+typedef struct {
+    uint8_t* data;
+    uint8_t size;
+} rx_buffer_t;
+
+// Receiver state
+typedef struct {
+    pt_t pt;
+    comm_channel_t* ch;                   // Canal vindo do transmissor
+    uint8_t rx_data[MAX_DATA_SIZE];
+    uint8_t* buf;                         // Mensagem atual: rx_data ou o primeiro postado
+    uint8_t* posted[RX_BUFFERS];          // Postados pela aplicação, ainda vazios
+    uint8_t posted_head;
+    uint8_t posted_count;
+    rx_buffer_t filled[RX_BUFFERS];       // Cheios, à espera de session_rx_take
+    uint8_t filled_head;
+    uint8_t filled_count;
+    pt_event_t filled_event;              // Sinalizado a cada buffer cheio
+    uint8_t rx_count;
+    uint8_t expected_size;
+    uint8_t checksum_calc;
+    uint8_t checksum_recv;
+    uint8_t incoming_byte;                // Último byte lido do canal
+    enum {
+        RX_WAIT_STX,
+        RX_WAIT_QTD,
+        RX_WAIT_SEQ,
+        RX_WAIT_DATA,
+        RX_WAIT_CHK,
+        RX_WAIT_ETX
+    } state;
+    bool message_received;
+    int result;
+    bool sequencing;                      // Aceita quadros SOH e filtra duplicatas
+    bool sequenced;                       // O quadro atual é SOH
+    uint8_t seq;                          // SEQ do quadro atual
+    bool have_last;                       // last_seq vale
+    uint8_t last_seq;                     // SEQ da última mensagem entregue
+    uint32_t delivered;                   // Mensagens entregues
+    uint32_t duplicates;                  // Retransmissões reconhecidas e só confirmadas
+} receiver_state_t;
+
+// Sessão: um transmissor e um receptor num canal, com todo o estado das
+// duas threads. Cada enlace tem a sua sessão (session_init); com duas
+// threads por sessão, cabem PT_MAX_THREADS / 2 sessões
+typedef struct {
+    transmitter_state_t tx;
+    receiver_state_t rx;
+    int tx_id;
+    int rx_id;
+} protocol_session_t;
+
+// A sessão de protothreads_init e das funções protothreads_*
+static protocol_session_t default_session;
+
+// Change the receiver state, recording the change in the trace ring
+// (protocol_trace.h) with the byte that caused it
+#define RX_SET_STATE(rx, novo, byte) do { \
+        if ((rx)->state != (novo)) { PROTOCOL_TRACE_TRANSICAO((rx)->state, (novo), (byte)); } \
+        (rx)->state = (novo); } while (0)
+
+// Mensagens das threads, desligadas durante a medição de desempenho
+static bool pt_log_ligado = true;
+#define PT_LOG(...) do { if (pt_log_ligado) printf(__VA_ARGS__); } while (0)
+
+// ========================================
+// PROTOTHREADS IMPLEMENTATION
+// ========================================
+
+PT_THREAD(transmitter_thread(transmitter_state_t* tx))
+{
+    PT_BEGIN(&tx->pt);
+    
+    tx->retry_count = 0;
+    tx->transmission_complete = false;
+    
+    /* message_size é de 8 bits: o buffer (266) não cabe, e o cast direto dava 10 */
+    tx->message_size = sizeof(tx->message_buffer) > UINT8_MAX ? UINT8_MAX : (uint8_t)sizeof(tx->message_buffer);
+    // Create protocol message: with a sequence number once the receiver has
+    // announced it filters duplicates (too long for SEQ: plain message)
+    tx->sequenced = tx->peer_sequencing && tx->data_size < UINT8_MAX;
+    if (tx->sequenced) {
+        tx->seq++;
+        tx->result = protocol_create_message_seq(tx->seq, tx->data_to_send, tx->data_size,
+                                                 tx->message_buffer, &tx->message_size);
+    } else {
+        tx->result = protocol_create_message(tx->data_to_send, tx->data_size, 
+                                           tx->message_buffer, &tx->message_size);
+    }
+    
+    if (tx->result != PROTOCOL_SUCCESS) {
+        PT_EXIT(&tx->pt);
+    }
+    
+    while (tx->retry_count < MAX_RETRIES) {
+        // Send the message
+        if (tx->sched) {
+            // Through the scheduler, the RTO and the RTT count from the end
+            // of the frame on the link: the wait behind more urgent frames
+            // is not a loss. A frame refused by a full queue times out
+            if (tx_sched_send(tx->sched, tx->priority, tx->message_buffer, tx->message_size) == PROTOCOL_SUCCESS) {
+                tx->ticket = tx_sched_ticket(tx->sched, tx->priority);
+                PT_WAIT_EVENT(&tx->pt, &tx->sched->done_event, tx_sched_left(tx->sched, tx->priority, tx->ticket));
+            }
+        } else {
+            // Back-pressure: wait for room (with flow control, the
+            // receiver's credit) instead of sending a frame that the channel
+            // would refuse and the RTO would have to recover
+            PT_WAIT_EVENT(&tx->pt, &tx->ch->credit_event, channel_credit(tx->ch) >= tx->message_size);
+            channel_send(tx->ch, tx->message_buffer, tx->message_size);
+        }
+        if (tx->retry_count == 0) {
+            tx->sent_at = system_time_ms;
+        }
+        
+        // Wait for acknowledgment or timeout; a late ACK of an earlier
+        // message is ignored
+        timer_set(&tx->timer, tx->rto.rto_ms);
+        
+        do {
+            PT_WAIT_EVENT2(&tx->pt, &tx->ch->ack_event, &tx->timer.expired,
+                channel_ack_received_seq(tx->ch, &tx->ack_value, &tx->ack_has_seq, &tx->ack_seq) ||
+                timer_expired(&tx->timer));
+        } while (!timer_expired(&tx->timer) && tx->sequenced && tx->ack_has_seq && tx->ack_seq != tx->seq);
+        
+        if (timer_expired(&tx->timer)) {
+            // Timeout - retry
+            rto_backoff(&tx->rto);
+            tx->retry_count++;
+            PT_LOG("Transmitter: Timeout, retry %d/%d\n", tx->retry_count, MAX_RETRIES);
+        } else {
+            // ACK/NACK received: RTT only from a message sent once (Karn)
+            timer_stop(&tx->timer);
+            if (tx->retry_count == 0) {
+                rto_sample(&tx->rto, system_time_ms - tx->sent_at);
+            } else {
+                rto_progress(&tx->rto);
+            }
+            tx->peer_sequencing = tx->ack_has_seq;
+            if (tx->ack_value == ACK_BYTE) {
+                PT_LOG("Transmitter: ACK received, transmission complete\n");
+                tx->transmission_complete = true;
+                tx->result = PROTOCOL_SUCCESS;
+                PT_EXIT(&tx->pt);
+            } else if (tx->ack_value == NACK_BYTE) {
+                // NACK - retry
+                tx->retry_count++;
+                PT_LOG("Transmitter: NACK received, retry %d/%d\n", tx->retry_count, MAX_RETRIES);
+            }
+        }
+    }
+    
+    // Max retries reached
+    PT_LOG("Transmitter: Max retries reached, transmission failed\n");
+    tx->result = PROTOCOL_TIMEOUT;
+    tx->transmission_complete = true; // Mark as complete even if failed
+    
+    PT_END(&tx->pt);
+}
+
+// A receiver with sequence numbers answers every frame with them, which is
+// how the transmitter learns it can send SOH frames
+static void receiver_send_ack(receiver_state_t* rx, uint8_t ack_type) {
+    if (rx->sequencing) {
+        channel_send_ack_seq(rx->ch, ack_type, true, rx->sequenced ? rx->seq : 0);
+    } else {
+        channel_send_ack(rx->ch, ack_type);
+    }
+}
+
+// Discard bytes up to a frame start (STX, or SOH with sequence numbers) and
+// return true once one is consumed; false when the channel runs dry first
+static bool receiver_hunt_start(receiver_state_t* rx, uint8_t* byte) {
+    while (channel_receive_byte(rx->ch, byte)) {
+        if (*byte == STX_BYTE || (rx->sequencing && *byte == SOH_BYTE)) return true;
+    }
+    return false;
+}
+
+// Passa o primeiro buffer postado, já com a mensagem, à fila de cheios
+static void receiver_hand_over(receiver_state_t* rx) {
+    rx_buffer_t* cheio = &rx->filled[(rx->filled_head + rx->filled_count) % RX_BUFFERS];
+    
+    cheio->data = rx->buf;
+    cheio->size = rx->expected_size;
+    rx->filled_count++;
+    rx->posted_head = (uint8_t)((rx->posted_head + 1) % RX_BUFFERS);
+    rx->posted_count--;
+    pt_event_signal(&rx->filled_event);
+}
+
+PT_THREAD(receiver_thread(receiver_state_t* rx))
+{
+    PT_BEGIN(&rx->pt);
+    
+    while (1) {
+        RX_SET_STATE(rx, RX_WAIT_STX, rx->incoming_byte);
+        rx->rx_count = 0;
+        rx->checksum_calc = 0;
+        
+        // Wait for STX (or SOH, with a sequence number)
+        PT_WAIT_EVENT(&rx->pt, &rx->ch->rx_event, receiver_hunt_start(rx, &rx->incoming_byte));
+        rx->sequenced = rx->incoming_byte == SOH_BYTE;
+        
+        // The previous message stays readable until the next one starts;
+        // with a posted buffer, this one is written straight into it
+        rx->message_received = false;
+        rx->buf = rx->posted_count > 0 ? rx->posted[rx->posted_head] : rx->rx_data;
+        RX_SET_STATE(rx, RX_WAIT_QTD, rx->incoming_byte);
+        
+        // Wait for quantity byte
+        PT_WAIT_EVENT(&rx->pt, &rx->ch->rx_event, channel_receive_byte(rx->ch, &rx->incoming_byte));
+        
+        if (rx->incoming_byte == 0 || (rx->sequenced && rx->incoming_byte == 1)) {
+            PT_LOG("Receiver: Invalid quantity, sending NACK\n");
+            receiver_send_ack(rx, NACK_BYTE);
+            continue; // Restart
+        }
+        
+        rx->expected_size = rx->incoming_byte;
+        if (rx->sequenced) {
+            // SEQ counts in QTD and CHK, but is not part of the message
+            RX_SET_STATE(rx, RX_WAIT_SEQ, rx->incoming_byte);
+            PT_WAIT_EVENT(&rx->pt, &rx->ch->rx_event, channel_receive_byte(rx->ch, &rx->incoming_byte));
+            rx->seq = rx->incoming_byte;
+            rx->checksum_calc = rx->incoming_byte;
+            rx->expected_size--;
+        }
+        RX_SET_STATE(rx, RX_WAIT_DATA, rx->incoming_byte);
+        
+        // Receive data bytes: each wake-up takes every payload byte already
+        // in the channel in one copy, with the checksum over the copied run
+        for (rx->rx_count = 0; rx->rx_count < rx->expected_size; ) {
+            PT_WAIT_EVENT(&rx->pt, &rx->ch->rx_event, channel_available(rx->ch) > 0);
+            uint8_t n = channel_receive(rx->ch, &rx->buf[rx->rx_count], (uint8_t)(rx->expected_size - rx->rx_count));
+            rx->checksum_calc = protocol_sum8_update(rx->checksum_calc, &rx->buf[rx->rx_count], n);
+            rx->rx_count = (uint8_t)(rx->rx_count + n);
+        }
+        rx->incoming_byte = rx->buf[rx->rx_count - 1];
+        
+        RX_SET_STATE(rx, RX_WAIT_CHK, rx->incoming_byte);
+        
+        // Wait for checksum
+        PT_WAIT_EVENT(&rx->pt, &rx->ch->rx_event, channel_receive_byte(rx->ch, &rx->incoming_byte));
+        rx->checksum_recv = rx->incoming_byte;
+        
+        RX_SET_STATE(rx, RX_WAIT_ETX, rx->incoming_byte);
+        
+        // Wait for ETX
+        PT_WAIT_EVENT(&rx->pt, &rx->ch->rx_event, channel_receive_byte(rx->ch, &rx->incoming_byte));
+        
+        if (rx->incoming_byte == ETX_BYTE && rx->checksum_calc == rx->checksum_recv) {
+            if (rx->sequenced && rx->have_last && rx->seq == rx->last_seq) {
+                // Retransmission after a lost ACK: the same message, already
+                // delivered, is only acknowledged again
+                PT_LOG("Receiver: Duplicate message, sending ACK again\n");
+                rx->duplicates++;
+            } else {
+                PT_LOG("Receiver: Valid message received, sending ACK\n");
+                rx->delivered++;
+                // A plain message comes from a transmitter that has not
+                // negotiated (or restarted): the next SEQ starts anew
+                rx->have_last = rx->sequenced;
+                rx->last_seq = rx->seq;
+                if (rx->buf != rx->rx_data) {
+                    receiver_hand_over(rx);
+                }
+            }
+            rx->message_received = true;
+            rx->result = PROTOCOL_SUCCESS;
+            receiver_send_ack(rx, ACK_BYTE);
+        } else {
+            PT_LOG("Receiver: Invalid message (ETX or checksum), sending NACK\n");
+            rx->result = PROTOCOL_ERROR;
+            receiver_send_ack(rx, NACK_BYTE);
+        }
+        
+        // Yield to allow other threads to run
+        PT_YIELD(&rx->pt);
+    }
+    
+    PT_END(&rx->pt);
+}
+
+// ========================================
+// PUBLIC API
+// ========================================
+
+static int transmitter_run(void* contexto) {
+    return transmitter_thread(contexto);
+}
+
+static int receiver_run(void* contexto) {
+    return receiver_thread(contexto);
+}
+
+// Start a session on channel ch: empties the channel, resets both threads
+// and registers them with the scheduler. The session and the channel must
+// stay valid while the scheduler runs
+int session_init(protocol_session_t* s, comm_channel_t* ch) {
+    timer_disarm(&s->tx.timer);        // Numa sessão reiniciada, sai da fila
+    memset(s, 0, sizeof(*s));
+    s->tx.ch = ch;
+    s->rx.ch = ch;
+    rto_init(&s->tx.rto, TIMEOUT_MS);  // A primeira mensagem vai sem sequência
+    s->rx.sequencing = true;
+    channel_reset(ch);
+    ch->rx_event.waiting = 0;
+    ch->ack_event.waiting = 0;
+    ch->credit_event.waiting = 0;
+    
+    // Sem dados, a primeira passada só encerra o transmissor
+    s->tx_id = pt_register(transmitter_run, &s->tx);
+    s->rx_id = pt_register(receiver_run, &s->rx);
+    return s->tx_id >= 0 && s->rx_id >= 0 ? PROTOCOL_SUCCESS : PROTOCOL_ERROR;
+}
+
+// Send the session's frames through sched, the scheduler in front of its
+// channel, with the given priority (0 the most urgent); NULL sends straight
+// to the channel. The retries go through the same queue, so the RTO also
+// covers the wait behind more urgent frames
+void session_set_tx_sched(protocol_session_t* s, tx_sched_t* sched, uint8_t priority) {
+    s->tx.sched = sched;
+    s->tx.priority = priority < TX_PRIORITIES ? priority : (uint8_t)(TX_PRIORITIES - 1u);
+}
+
+int session_send_data(protocol_session_t* s, uint8_t* data, uint8_t size) {
+    if (!data || size == 0) return PROTOCOL_INVALID_PARAM;
+    
+    // Reset all transmitter state for new transmission
+    s->tx.data_to_send = data;
+    s->tx.data_size = size;
+    s->tx.retry_count = 0;
+    s->tx.transmission_complete = false;
+    s->tx.result = 0;
+    timer_stop(&s->tx.timer);
+    PT_INIT(&s->tx.pt);
+    pt_wake(s->tx_id);
+    
+    return PROTOCOL_SUCCESS;
+}
+
+bool session_transmission_complete(const protocol_session_t* s) {
+    return s->tx.transmission_complete;
+}
+
+int session_get_tx_result(const protocol_session_t* s) {
+    return s->tx.result;
+}
+
+bool session_message_received(const protocol_session_t* s) {
+    return s->rx.message_received;
+}
+
+uint8_t* session_get_received_data(protocol_session_t* s) {
+    return s->rx.buf ? s->rx.buf : s->rx.rx_data;
+}
+
+// Posta um buffer de MAX_DATA_SIZE bytes para as próximas mensagens; ele
+// pertence ao receptor até voltar por session_rx_take. Retorna false se já há
+// RX_BUFFERS buffers postados ou cheios
+bool session_rx_post(protocol_session_t* s, uint8_t* buffer) {
+    receiver_state_t* rx = &s->rx;
+    
+    if (!buffer || rx->posted_count + rx->filled_count >= RX_BUFFERS) return false;
+    rx->posted[(rx->posted_head + rx->posted_count) % RX_BUFFERS] = buffer;
+    rx->posted_count++;
+    return true;
+}
+
+// Tira o buffer cheio mais antigo, que volta a ser da aplicação, e o tamanho
+// da mensagem nele; NULL se nenhum. Uma thread espera por um com
+// PT_WAIT_EVENT(pt, session_rx_event(s), ...)
+uint8_t* session_rx_take(protocol_session_t* s, uint8_t* size) {
+    receiver_state_t* rx = &s->rx;
+    
+    if (rx->filled_count == 0) return NULL;
+    rx_buffer_t* cheio = &rx->filled[rx->filled_head];
+    rx->filled_head = (uint8_t)((rx->filled_head + 1) % RX_BUFFERS);
+    rx->filled_count--;
+    if (size) *size = cheio->size;
+    return cheio->data;
+}
+
+pt_event_t* session_rx_event(protocol_session_t* s) {
+    return &s->rx.filled_event;
+}
+
+uint8_t session_get_received_size(const protocol_session_t* s) {
+    return s->rx.expected_size;
+}
+
+// Resets the scheduler, the timers and the time, and starts the default
+// session on the default channel
+void protothreads_init(void) {
+    pt_scheduler_reset();
+    armed_timers = NULL;
+    impaired_channels = NULL;
+    fanout_ports = NULL;
+    tx_scheds = NULL;
+    system_time_ms = PT_TIME_START();
+    session_init(&default_session, &channel);
+}
+
+int protothreads_send_data(uint8_t* data, uint8_t size) {
+    return session_send_data(&default_session, data, size);
+}
+
+bool protothreads_transmission_complete(void) {
+    return session_transmission_complete(&default_session);
+}
+
+int protothreads_get_tx_result(void) {
+    return session_get_tx_result(&default_session);
+}
+
+// Current retransmission timeout, and the estimator behind it
+uint32_t protothreads_get_rto(void) {
+    return default_session.tx.rto.rto_ms;
+}
+
+const rto_estimator_t* protothreads_get_rto_stats(void) {
+    return &default_session.tx.rto;
+}
+
+bool protothreads_message_received(void) {
+    return session_message_received(&default_session);
+}
+
+uint8_t* protothreads_get_received_data(void) {
+    return session_get_received_data(&default_session);
+}
+
+uint8_t protothreads_get_received_size(void) {
+    return session_get_received_size(&default_session);
+}
+
+int protothreads_get_rx_result(void) {
+    return default_session.rx.result;
+}
+
+// Messages delivered, and retransmissions recognized as duplicates
+uint32_t protothreads_get_rx_delivered(void) {
+    return default_session.rx.delivered;
+}
+
+uint32_t protothreads_get_rx_duplicates(void) {
+    return default_session.rx.duplicates;
+}
+
+// Main scheduler: one pass over the ready threads, or sleep if none is ready
+void protothreads_schedule(void) {
+    if (!pt_ready) {
+        pt_idle_passes++;
+        PT_SLEEP();
+        return;
+    }
+    pt_schedule();
+}
+
+// Sem expiração pendente (protothreads_poll)
+#define PT_NO_DEADLINE UINT32_MAX
+
+// Para uma tarefa do RTOS ou o laço principal com tempo real: avança o tempo
+// em elapsed_ms, faz uma passada e retorna os ms até a próxima expiração, ou
+// PT_NO_DEADLINE. Quem chama pode bloquear até lá ou até um PT_NOTIFY; com
+// threads ainda prontas (acordadas na passada, ou PT_YIELD), retorna 0
+uint32_t protothreads_poll(uint32_t elapsed_ms) {
+    uint32_t deadline;
+    
+    pt_polling = true;
+    advance_time(elapsed_ms);
+    pt_schedule();
+    pt_polling = false;
+    if (pt_ready) return 0;
+    if (!next_deadline(&deadline)) return PT_NO_DEADLINE;
+    return (int32_t)(deadline - system_time_ms) > 0 ? deadline - system_time_ms : 0;
+}
+
+// ========================================
+// SLIDING-WINDOW ARQ
+// ========================================
+
+// Janela deslizante sobre um enlace com atraso. Com pare-e-espere
+// (transmitter_thread) cabe um quadro por ida e volta; com uma janela de
+// até ARQ_WINDOW quadros o enlace fica cheio. Go-back-N com janela 1 é o
+// pare-e-espere. O primeiro byte dos dados de cada quadro é o tipo:
+//   [ARQ_DATA_BYTE, seq, dados...]            dados, seq módulo 256
+//   [ARQ_DATA_ACK_BYTE, seq, ack, dados...]   dados com o ACK do outro sentido
+//   [ACK_BYTE, ack]                           ACK
+//   [ACK_BYTE, ack, seq]                      ACK, repetição seletiva
+//   [NACK_BYTE, ack, n, mapa...]              NACK seletivo
+// ack é cumulativo, o próximo esperado: confirma tudo antes dele. A
+// repetição seletiva confirma também o quadro seq, recebido fora de ordem.
+// Um quadro fora de ordem na repetição seletiva tem, em vez do ACK, o NACK
+// seletivo dos n quadros a partir de ack: o bit i do mapa ligado diz que
+// ack + i falta, e desligado, que chegou. O transmissor reenvia na hora os
+// que faltam, sem esperar o RTO, e confirma os que chegaram.
+// Com arq_receiver_delay_acks, um ACK confirma vários quadros; com
+// arq_pair, os ACKs seguem nos quadros de dados do sentido contrário.
+#ifndef ARQ_WINDOW
+#define ARQ_WINDOW 8
+#endif
+
+// Dados por quadro, além do byte de sequência
+#ifndef ARQ_PAYLOAD
+#define ARQ_PAYLOAD 64
+#endif
+
+// Quadros em trânsito em cada sentido do enlace simulado
+#ifndef LINK_SLOTS
+#define LINK_SLOTS 32
+#endif
+
+#if ARQ_WINDOW < 1 || ARQ_WINDOW > 128 || (ARQ_WINDOW & (ARQ_WINDOW - 1)) != 0
+#error "ARQ_WINDOW deve ser potencia de 2 de 1 a 128 (metade da sequencia de 8 bits)"
+#endif
+
+#if ARQ_PAYLOAD < 1 || ARQ_PAYLOAD > 247
+#error "ARQ_PAYLOAD deve estar entre 1 e 247 (QTD ate 250 com tipo, sequencia e ACK)"
+#endif
+
+#define ARQ_DATA_BYTE 0x10
+#define ARQ_DATA_ACK_BYTE 0x11
+#define ARQ_HEADER_MAX 3                  // Tipo, sequência e ACK
+#define ARQ_FRAME_MAX (ARQ_PAYLOAD + ARQ_HEADER_MAX + PROTOCOL_FRAME_ENVELOPE)
+#define ARQ_INDEX(seq) ((seq) & (ARQ_WINDOW - 1))
+
+typedef enum {
+    ARQ_GO_BACK_N,
+    ARQ_SELECTIVE_REPEAT
+} arq_mode_t;
+
+typedef struct {
+    uint8_t bytes[ARQ_FRAME_MAX];
+    uint8_t size;
+    uint32_t deliver_at;                  // system_time_ms da chegada
+} link_slot_t;
+
+// Um sentido do enlace simulado: os quadros chegam depois de enviados, na
+// ordem de envio, com as degradações de imp (link_init só liga a latência e
+// a perda; link_impair, todas). Com taxa, cada quadro ocupa o meio pelo seu
+// tempo de transmissão
+typedef struct link {
+    link_slot_t slots[LINK_SLOTS];
+    uint8_t head;
+    uint8_t count;
+    channel_impairment_t imp;             // ack_loss_percent não vale: os ACKs vão no outro link_t
+    struct link* medium;                  // Dono de busy_until: este, ou o outro sentido (half-duplex)
+    uint32_t busy_until;                  // Fim da transmissão em curso no meio
+    timer_t delivery;                     // Expira quando o primeiro quadro chega
+    uint32_t sent;
+    uint32_t lost;
+    uint32_t corrupted;                   // Quadros com bits trocados
+    uint32_t queued_ms;                   // Espera total dos quadros pelo meio livre
+} link_t;
+
+void link_init(link_t* link, uint32_t delay_ms, uint8_t loss_percent, uint32_t seed) {
+    timer_stop(&link->delivery);
+    memset(link, 0, sizeof(*link));
+    link->imp.delay_ms = delay_ms;
+    link->imp.loss_percent = loss_percent;
+    link->imp.seed = seed;
+    link->medium = link;
+    link->busy_until = system_time_ms;    // 0 ficaria no futuro perto da volta do tempo
+}
+
+// Todas as degradações de imp, inclusive a taxa, no lugar das de link_init
+void link_impair(link_t* link, const channel_impairment_t* imp) {
+    link->imp = *imp;
+}
+
+// Taxa do meio em bytes/s. Com medium, os dois sentidos dividem o mesmo
+// meio (RS-485 half-duplex): um quadro só começa quando o anterior, de
+// qualquer sentido, terminou
+void link_set_rate(link_t* link, uint32_t bytes_per_s, link_t* medium) {
+    link->imp.rate = bytes_per_s;
+    link->medium = medium ? medium : link;
+}
+
+void link_send(link_t* link, const uint8_t* bytes, uint8_t size) {
+    uint32_t anterior = link->count > 0 ?
+        link->slots[(link->head + link->count - 1) % LINK_SLOTS].deliver_at : system_time_ms;
+    uint32_t livre = link->medium->busy_until;
+    uint32_t chegada = impairment_arrival(&link->imp, &link->medium->busy_until, size, anterior);
+    
+    if (link->imp.rate && (int32_t)(livre - system_time_ms) > 0) {
+        link->queued_ms += livre - system_time_ms;
+    }
+    link->sent++;
+    if (impairment_drop(&link->imp, link->imp.loss_percent) || link->count >= LINK_SLOTS) {
+        link->lost++;
+        return;
+    }
+    
+    link_slot_t* slot = &link->slots[(link->head + link->count) % LINK_SLOTS];
+    memcpy(slot->bytes, bytes, size);
+    slot->size = size;
+    slot->deliver_at = chegada;
+    if (link->imp.ber_ppm) {
+        bool trocado = false;
+        for (uint8_t i = 0; i < size; i++) {
+            trocado |= impairment_corrupt(&link->imp, &slot->bytes[i]);
+        }
+        link->corrupted += trocado;
+    }
+    if (link->count++ == 0) {
+        timer_set(&link->delivery, slot->deliver_at - system_time_ms);
+    }
+}
+
+// Há um quadro que já chegou
+static bool link_ready(const link_t* link) {
+    return link->count > 0 && (int32_t)(system_time_ms - link->slots[link->head].deliver_at) >= 0;
+}
+
+// Tira o primeiro quadro que já chegou; retorna false se nenhum chegou
+bool link_receive(link_t* link, uint8_t* bytes, uint8_t* size) {
+    if (!link_ready(link)) return false;
+    
+    link_slot_t* slot = &link->slots[link->head];
+    memcpy(bytes, slot->bytes, slot->size);
+    *size = slot->size;
+    link->head = (uint8_t)((link->head + 1) % LINK_SLOTS);
+    if (--link->count > 0) {
+        timer_set(&link->delivery, link->slots[link->head].deliver_at - system_time_ms);
+    } else {
+        timer_stop(&link->delivery);
+    }
+    return true;
+}
+
+// Confere STX, QTD, CHK e ETX de um quadro recebido inteiro e aponta os dados
+static bool arq_frame_payload(const uint8_t* bytes, uint8_t size, const uint8_t** dados, uint8_t* qtd) {
+    if (size < 4 || bytes[0] != STX_BYTE || bytes[1] == 0 || bytes[1] > size - 4) return false;
+    if (bytes[3 + bytes[1]] != ETX_BYTE || bytes[2 + bytes[1]] != protocol_sum8(&bytes[2], bytes[1])) return false;
+    
+    *dados = &bytes[2];
+    *qtd = bytes[1];
+    return true;
+}
+
+// Quadro da janela de transmissão, tirado do conjunto do transmissor
+typedef struct arq_frame {
+    struct arq_frame* next_free;
+    timer_t timer;                        // Repetição seletiva: retransmissão deste quadro
+    uint32_t sent_at;                     // Primeiro envio, para o RTT
+    uint8_t seq;
+    bool acked;
+    bool retransmitted;                   // Sem medida de RTT (Karn)
+    bool fast_retransmitted;              // Já reenviado por um NACK seletivo
+    uint8_t qtd;
+    size_t offset;                        // Dados em data do transmissor: o quadro
+                                          // é montado a cada envio, com o ACK da vez
+} arq_frame_t;
+
+typedef struct {
+    pt_t pt;
+    arq_mode_t mode;
+    uint8_t window;                       // 1 a ARQ_WINDOW
+    rto_estimator_t rto;                  // Timeout de retransmissão
+    link_t* data_link;
+    link_t* ack_link;                     // NULL com arq_pair: os ACKs vêm do receptor
+    struct arq_receiver* piggyback;       // Receptor cujos ACKs seguem nos dados (arq_pair)
+    pt_event_t acked;                     // Com arq_pair: o receptor entregou ACKs
+    bool ack_update;
+    arq_frame_t pool[ARQ_WINDOW];
+    arq_frame_t* free_frames;
+    arq_frame_t* outstanding[ARQ_WINDOW]; // Enviados e não confirmados, por ARQ_INDEX(seq)
+    uint8_t base;                         // Mais antigo não confirmado
+    uint8_t next_seq;
+    timer_t timer;                        // Go-back-N: retransmissão da janela
+    const uint8_t* data;
+    size_t size;
+    size_t offset;                        // Dados já postos em quadros
+    uint8_t ack[ARQ_FRAME_MAX];
+    bool complete;
+    uint32_t transmissions;
+    uint32_t retransmissions;
+    uint32_t fast_retransmissions;        // Das retransmissões, as pedidas por NACK
+} arq_sender_t;
+
+typedef struct {
+    bool present;
+    uint8_t qtd;
+    uint8_t data[ARQ_PAYLOAD];
+} arq_slot_t;
+
+typedef struct arq_receiver {
+    pt_t pt;
+    arq_mode_t mode;
+    uint8_t window;
+    link_t* data_link;
+    link_t* ack_link;
+    arq_sender_t* reverse;                // Recebe os ACKs que chegam (arq_pair)
+    uint32_t ack_delay_ms;                // 0: um ACK por quadro, na hora
+    uint8_t ack_every;                    // Quadros em ordem que forçam o ACK
+    uint8_t ack_pending;                  // Quadros em ordem ainda sem ACK
+    timer_t ack_timer;
+    uint8_t expected;                     // Próximo a entregar em ordem
+    arq_slot_t buffered[ARQ_WINDOW];      // Repetição seletiva: fora de ordem
+    uint8_t* out;
+    size_t out_size;
+    size_t out_capacity;
+    uint8_t frame[ARQ_FRAME_MAX];
+    uint32_t discarded;                   // Inválidos ou fora da janela
+    uint32_t acks_sent;                   // Quadros só de ACK ou NACK
+    uint32_t nacks_sent;                  // Dos quadros de ACK, os NACKs seletivos
+    uint32_t acks_piggybacked;            // ACKs nos quadros de dados
+} arq_receiver_t;
+
+void arq_sender_init(arq_sender_t* s, arq_mode_t mode, uint8_t window, uint32_t initial_rto_ms,
+                     link_t* data_link, link_t* ack_link, const uint8_t* data, size_t size) {
+    timer_stop(&s->timer);
+    for (int i = 0; i < ARQ_WINDOW; i++) {
+        timer_stop(&s->pool[i].timer);
+    }
+    memset(s, 0, sizeof(*s));
+    s->mode = mode;
+    s->window = window < 1 ? 1 : window > ARQ_WINDOW ? ARQ_WINDOW : window;
+    rto_init(&s->rto, initial_rto_ms);
+    s->data_link = data_link;
+    s->ack_link = ack_link;
+    s->data = data;
+    s->size = size;
+    for (int i = 0; i < ARQ_WINDOW; i++) {
+        s->pool[i].next_free = s->free_frames;
+        s->free_frames = &s->pool[i];
+    }
+}
+
+void arq_receiver_init(arq_receiver_t* r, arq_mode_t mode, uint8_t window, link_t* data_link, link_t* ack_link,
+                       uint8_t* out, size_t out_capacity) {
+    timer_stop(&r->ack_timer);
+    memset(r, 0, sizeof(*r));
+    r->mode = mode;
+    r->window = window < 1 ? 1 : window > ARQ_WINDOW ? ARQ_WINDOW : window;
+    r->data_link = data_link;
+    r->ack_link = ack_link;
+    r->out = out;
+    r->out_capacity = out_capacity;
+}
+
+// ACKs atrasados: os quadros em ordem que chegam juntos têm um ACK só, na
+// hora se são every ou mais e, se não, até delay_ms depois, à espera dos
+// seguintes. Com arq_pair, se o transmissor tem dados a enviar, o ACK segue
+// neles. Quadros fora de ordem e repetidos têm ACK na hora. delay_ms deve
+// ficar bem abaixo do RTO: o atraso entra no RTT medido
+void arq_receiver_delay_acks(arq_receiver_t* r, uint32_t delay_ms, uint8_t every) {
+    r->ack_delay_ms = delay_ms;
+    r->ack_every = every < 1 ? 1 : every;
+}
+
+// Liga o transmissor e o receptor de uma ponta de um enlace nos dois
+// sentidos: r recebe de r->data_link e o transmissor envia em
+// s->data_link == r->ack_link. O receptor entrega ao transmissor os ACKs que
+// chegam, e os ACKs atrasados do receptor seguem no próximo quadro de dados
+void arq_pair(arq_sender_t* s, arq_receiver_t* r) {
+    s->ack_link = NULL;
+    s->piggyback = r;
+    r->reverse = s;
+}
+
+static uint8_t arq_in_flight(const arq_sender_t* s) {
+    return (uint8_t)(s->next_seq - s->base);
+}
+
+static void arq_ack_clear(arq_receiver_t* r) {
+    r->ack_pending = 0;
+    timer_stop(&r->ack_timer);
+}
+
+// Monta e envia o quadro, com o ACK pendente do receptor ligado
+static void arq_transmit(arq_sender_t* s, arq_frame_t* f) {
+    uint8_t payload[ARQ_HEADER_MAX + ARQ_PAYLOAD];
+    uint8_t quadro[ARQ_FRAME_MAX];
+    uint8_t size = (uint8_t)sizeof(quadro);
+    uint8_t n = 0;
+    arq_receiver_t* r = s->piggyback;
+    
+    if (r && r->ack_pending) {
+        payload[n++] = ARQ_DATA_ACK_BYTE;
+        payload[n++] = f->seq;
+        payload[n++] = r->expected;
+        r->acks_piggybacked++;
+        arq_ack_clear(r);
+    } else {
+        payload[n++] = ARQ_DATA_BYTE;
+        payload[n++] = f->seq;
+    }
+    memcpy(&payload[n], &s->data[f->offset], f->qtd);
+    protocol_frame_encode8(payload, (uint8_t)(n + f->qtd), quadro, &size);
+    link_send(s->data_link, quadro, size);
+    s->transmissions++;
+    if (s->mode == ARQ_SELECTIVE_REPEAT) {
+        timer_set(&f->timer, s->rto.rto_ms);
+    }
+}
+
+// RTT do quadro confirmado, se ele foi enviado uma vez só
+static void arq_rtt_sample(arq_sender_t* s, const arq_frame_t* f) {
+    if (!f->retransmitted) {
+        rto_sample(&s->rto, system_time_ms - f->sent_at);
+    } else {
+        rto_progress(&s->rto);
+    }
+}
+
+// Põe em quadros os dados seguintes enquanto a janela tem espaço
+static void arq_fill_window(arq_sender_t* s) {
+    while (arq_in_flight(s) < s->window && s->offset < s->size) {
+        arq_frame_t* f = s->free_frames;   // Nunca nulo: a janela não passa do conjunto
+        size_t resto = s->size - s->offset;
+        uint8_t qtd = (uint8_t)(resto < ARQ_PAYLOAD ? resto : ARQ_PAYLOAD);
+        
+        s->free_frames = f->next_free;
+        f->offset = s->offset;
+        f->qtd = qtd;
+        f->seq = s->next_seq;
+        f->acked = false;
+        f->retransmitted = false;
+        f->fast_retransmitted = false;
+        f->sent_at = system_time_ms;
+        s->outstanding[ARQ_INDEX(f->seq)] = f;
+        
+        if (s->mode == ARQ_GO_BACK_N && arq_in_flight(s) == 0) {
+            timer_set(&s->timer, s->rto.rto_ms);
+        }
+        arq_transmit(s, f);
+        s->next_seq++;
+        s->offset += qtd;
+    }
+}
+
+// Devolve ao conjunto o quadro mais antigo da janela
+static void arq_release_base(arq_sender_t* s) {
+    arq_frame_t* f = s->outstanding[ARQ_INDEX(s->base)];
+    
+    timer_stop(&f->timer);
+    s->outstanding[ARQ_INDEX(s->base)] = NULL;
+    f->next_free = s->free_frames;
+    s->free_frames = f;
+    s->base++;
+}
+
+// Confirma tudo antes de ack e, na repetição seletiva, o quadro seq
+static void arq_sender_acknowledge(arq_sender_t* s, uint8_t ack, bool seletivo, uint8_t seq) {
+    uint8_t offset = (uint8_t)(ack - s->base);
+    
+    if (offset > 0 && offset <= arq_in_flight(s)) {
+        arq_frame_t* f = s->outstanding[ARQ_INDEX((uint8_t)(ack - 1))];
+        if (!f->acked) {
+            arq_rtt_sample(s, f);
+        }
+        while (s->base != ack) {
+            arq_release_base(s);
+        }
+        if (s->mode == ARQ_GO_BACK_N) {
+            if (arq_in_flight(s) == 0) {
+                timer_stop(&s->timer);
+            } else {
+                timer_set(&s->timer, s->rto.rto_ms);
+            }
+        }
+    }
+    
+    offset = (uint8_t)(seq - s->base);
+    if (!seletivo || s->mode != ARQ_SELECTIVE_REPEAT || offset >= arq_in_flight(s)) return;
+    arq_frame_t* f = s->outstanding[ARQ_INDEX(seq)];
+    if (f->acked) return;
+    arq_rtt_sample(s, f);
+    f->acked = true;
+    timer_stop(&f->timer);
+    while (arq_in_flight(s) > 0 && s->outstanding[ARQ_INDEX(s->base)]->acked) {
+        arq_release_base(s);
+    }
+}
+
+// NACK seletivo: confirma os quadros do mapa que chegaram e reenvia na hora
+// os que faltam, uma vez cada; se o reenvio se perder, o timer do quadro o
+// repete. Os NACKs seguintes da mesma falta não reenviam de novo
+static void arq_sender_nack(arq_sender_t* s, const uint8_t* dados, uint8_t qtd) {
+    uint8_t n = dados[2];
+    
+    if (n > s->window || qtd < 3 + (n + 7) / 8) return;
+    arq_sender_acknowledge(s, dados[1], false, 0);
+    if (s->mode != ARQ_SELECTIVE_REPEAT) return;
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t seq = (uint8_t)(dados[1] + i);
+        if ((uint8_t)(seq - s->base) >= arq_in_flight(s)) continue;
+        
+        arq_frame_t* f = s->outstanding[ARQ_INDEX(seq)];
+        if (!(dados[3 + i / 8] & (1u << (i % 8)))) {
+            arq_sender_acknowledge(s, s->base, true, seq);
+        } else if (!f->acked && !f->fast_retransmitted) {
+            f->fast_retransmitted = true;
+            f->retransmitted = true;
+            arq_transmit(s, f);
+            s->retransmissions++;
+            s->fast_retransmissions++;
+        }
+    }
+}
+
+static void arq_sender_ack(arq_sender_t* s, const uint8_t* bytes, uint8_t size) {
+    const uint8_t* dados;
+    uint8_t qtd;
+    
+    if (!arq_frame_payload(bytes, size, &dados, &qtd) || qtd < 2) return;
+    if (dados[0] == NACK_BYTE && qtd >= 3) {
+        arq_sender_nack(s, dados, qtd);
+    } else if (dados[0] == ACK_BYTE && qtd <= 3) {
+        arq_sender_acknowledge(s, dados[1], qtd == 3, qtd == 3 ? dados[2] : 0);
+    }
+}
+
+static bool arq_timeout_pending(arq_sender_t* s) {
+    if (s->mode == ARQ_GO_BACK_N) {
+        return timer_expired(&s->timer);
+    }
+    for (uint8_t i = 0; i < arq_in_flight(s); i++) {
+        arq_frame_t* f = s->outstanding[ARQ_INDEX((uint8_t)(s->base + i))];
+        if (!f->acked && timer_expired(&f->timer)) return true;
+    }
+    return false;
+}
+
+// Go-back-N reenvia a janela inteira; a repetição seletiva, só os expirados.
+// Os timeouts de uma mesma retomada contam como uma perda para o recuo
+static void arq_sender_timeouts(arq_sender_t* s) {
+    bool janela = s->mode == ARQ_GO_BACK_N && timer_expired(&s->timer);
+    bool perda = janela;
+    
+    for (uint8_t i = 0; i < arq_in_flight(s); i++) {
+        arq_frame_t* f = s->outstanding[ARQ_INDEX((uint8_t)(s->base + i))];
+        if (janela || (!f->acked && timer_expired(&f->timer))) {
+            if (!perda) {
+                rto_backoff(&s->rto);
+                perda = true;
+            }
+            f->retransmitted = true;
+            arq_transmit(s, f);
+            s->retransmissions++;
+        }
+    }
+    if (janela) {
+        rto_backoff(&s->rto);
+        timer_set(&s->timer, s->rto.rto_ms);
+    }
+}
+
+// Timer que expira primeiro (a janela não está vazia)
+static timer_t* arq_next_timer(arq_sender_t* s) {
+    timer_t* proximo = &s->timer;
+    
+    if (s->mode == ARQ_SELECTIVE_REPEAT) {
+        proximo = NULL;
+        for (uint8_t i = 0; i < arq_in_flight(s); i++) {
+            arq_frame_t* f = s->outstanding[ARQ_INDEX((uint8_t)(s->base + i))];
+            if (!f->acked && (!proximo || timer_remaining(&f->timer) < timer_remaining(proximo))) {
+                proximo = &f->timer;
+            }
+        }
+    }
+    return proximo;
+}
+
+// ACKs no enlace de volta ou, com arq_pair, entregues pelo receptor
+static pt_event_t* arq_ack_event(arq_sender_t* s) {
+    return s->ack_link ? &s->ack_link->delivery.expired : &s->acked;
+}
+
+static bool arq_ack_ready(const arq_sender_t* s) {
+    return s->ack_link ? link_ready(s->ack_link) : s->ack_update;
+}
+
+PT_THREAD(arq_sender_thread(arq_sender_t* s))
+{
+    uint8_t size;
+    
+    PT_BEGIN(&s->pt);
+    
+    while (s->offset < s->size || arq_in_flight(s) > 0) {
+        arq_fill_window(s);
+        
+        // ACK ou retransmissão vencida
+        PT_WAIT_EVENT2(&s->pt, arq_ack_event(s), &arq_next_timer(s)->expired,
+            arq_ack_ready(s) || arq_timeout_pending(s));
+        
+        while (s->ack_link && link_receive(s->ack_link, s->ack, &size)) {
+            arq_sender_ack(s, s->ack, size);
+        }
+        s->ack_update = false;
+        arq_sender_timeouts(s);
+    }
+    s->complete = true;
+    
+    PT_END(&s->pt);
+}
+
+// ACK cumulativo na hora, com o quadro seq fora de ordem se seletivo
+static void arq_send_ack(arq_receiver_t* r, bool seletivo, uint8_t seq) {
+    uint8_t ack[3] = { ACK_BYTE, r->expected, seq };
+    uint8_t quadro[3 + PROTOCOL_FRAME_ENVELOPE];
+    uint8_t size = (uint8_t)sizeof(quadro);
+    
+    protocol_frame_encode8(ack, seletivo ? 3 : 2, quadro, &size);
+    link_send(r->ack_link, quadro, size);
+    r->acks_sent++;
+    arq_ack_clear(r);
+}
+
+// NACK seletivo dos quadros a partir do esperado até o último guardado
+// fora de ordem (ver SLIDING-WINDOW ARQ)
+static void arq_send_nack(arq_receiver_t* r) {
+    uint8_t nack[3 + (ARQ_WINDOW + 7) / 8] = { NACK_BYTE, r->expected, 0 };
+    uint8_t quadro[sizeof(nack) + PROTOCOL_FRAME_ENVELOPE];
+    uint8_t size = (uint8_t)sizeof(quadro);
+    uint8_t n = 0;
+    
+    for (uint8_t i = 0; i < r->window; i++) {
+        if (r->buffered[ARQ_INDEX((uint8_t)(r->expected + i))].present) n = (uint8_t)(i + 1);
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        if (!r->buffered[ARQ_INDEX((uint8_t)(r->expected + i))].present) {
+            nack[3 + i / 8] |= (uint8_t)(1u << (i % 8));
+        }
+    }
+    nack[2] = n;
+    protocol_frame_encode8(nack, (uint8_t)(3 + (n + 7) / 8), quadro, &size);
+    link_send(r->ack_link, quadro, size);
+    r->acks_sent++;
+    r->nacks_sent++;
+    arq_ack_clear(r);
+}
+
+// ACK de um quadro em ordem: na hora, ou atrasado para juntar com os
+// seguintes ou seguir num quadro de dados (arq_ack_flush)
+static void arq_ack_in_order(arq_receiver_t* r) {
+    if (r->ack_delay_ms == 0) {
+        arq_send_ack(r, false, 0);
+    } else if (r->ack_pending++ == 0) {
+        timer_set(&r->ack_timer, r->ack_delay_ms);
+    }
+}
+
+// O transmissor ligado vai enviar um quadro na próxima passada
+static bool arq_will_send(const arq_sender_t* s) {
+    return s && s->offset < s->size && arq_in_flight(s) < s->window;
+}
+
+// Depois dos quadros que chegaram juntos: o ACK pendente vai agora se o atraso
+// venceu ou se juntou every quadros e não há dados em que seguir
+static void arq_ack_flush(arq_receiver_t* r) {
+    if (r->ack_pending && (timer_expired(&r->ack_timer) ||
+                           (r->ack_pending >= r->ack_every && !arq_will_send(r->reverse)))) {
+        arq_send_ack(r, false, 0);
+    }
+}
+
+static void arq_deliver(arq_receiver_t* r, const uint8_t* dados, uint8_t qtd) {
+    if (r->out_size + qtd <= r->out_capacity) {
+        memcpy(&r->out[r->out_size], dados, qtd);
+    }
+    r->out_size += qtd;
+    r->expected++;
+}
+
+static void arq_receiver_frame(arq_receiver_t* r, const uint8_t* bytes, uint8_t size) {
+    const uint8_t* dados;
+    uint8_t qtd, n;
+    
+    if (!arq_frame_payload(bytes, size, &dados, &qtd) || qtd < 2) {
+        r->discarded++;
+        return;
+    }
+    
+    // ACKs do outro sentido vão para o transmissor ligado
+    bool so_ack = dados[0] == ACK_BYTE || dados[0] == NACK_BYTE;
+    bool com_ack = dados[0] == ACK_BYTE ? qtd <= 3 : dados[0] == NACK_BYTE ? qtd >= 3 :
+                   dados[0] == ARQ_DATA_ACK_BYTE && qtd > 3;
+    if (com_ack && r->reverse) {
+        if (dados[0] == ACK_BYTE) {
+            arq_sender_acknowledge(r->reverse, dados[1], qtd == 3, qtd == 3 ? dados[2] : 0);
+        } else if (dados[0] == NACK_BYTE) {
+            arq_sender_nack(r->reverse, dados, qtd);
+        } else {
+            arq_sender_acknowledge(r->reverse, dados[2], false, 0);
+        }
+        r->reverse->ack_update = true;
+        pt_event_signal(&r->reverse->acked);
+    }
+    n = dados[0] == ARQ_DATA_BYTE ? 2 : dados[0] == ARQ_DATA_ACK_BYTE ? 3 : 0;
+    if (n == 0 || qtd <= n) {
+        if (!(com_ack && r->reverse) || !so_ack) {
+            r->discarded++;
+        }
+        return;
+    }
+    
+    uint8_t seq = dados[1];
+    dados += n;
+    qtd = (uint8_t)(qtd - n);
+    if (r->mode == ARQ_GO_BACK_N) {
+        // Só o esperado é aceito; os demais repetem na hora o ACK cumulativo
+        if (seq == r->expected) {
+            arq_deliver(r, dados, qtd);
+            arq_ack_in_order(r);
+        } else {
+            r->discarded++;
+            arq_send_ack(r, false, 0);
+        }
+        return;
+    }
+    
+    if ((uint8_t)(seq - r->expected) < r->window) {
+        arq_slot_t* slot = &r->buffered[ARQ_INDEX(seq)];
+        bool em_ordem = seq == r->expected;
+        if (!slot->present) {
+            slot->present = true;
+            slot->qtd = qtd;
+            memcpy(slot->data, dados, qtd);
+        }
+        while (r->buffered[ARQ_INDEX(r->expected)].present) {
+            slot = &r->buffered[ARQ_INDEX(r->expected)];
+            slot->present = false;
+            arq_deliver(r, slot->data, slot->qtd);
+        }
+        if (em_ordem) {
+            arq_ack_in_order(r);
+        } else {
+            arq_send_nack(r);
+        }
+    } else if ((uint8_t)(r->expected - seq) <= r->window) {
+        // Já entregue: o ACK se perdeu
+        arq_send_ack(r, false, 0);
+    } else {
+        r->discarded++;
+    }
+}
+
+PT_THREAD(arq_receiver_thread(arq_receiver_t* r))
+{
+    uint8_t size;
+    
+    PT_BEGIN(&r->pt);
+    
+    while (1) {
+        // Quadro no enlace ou ACK atrasado vencido
+        PT_WAIT_EVENT2(&r->pt, &r->data_link->delivery.expired, &r->ack_timer.expired,
+            link_ready(r->data_link) || timer_expired(&r->ack_timer));
+        
+        while (link_receive(r->data_link, r->frame, &size)) {
+            arq_receiver_frame(r, r->frame, size);
+        }
+        arq_ack_flush(r);
+    }
+    
+    PT_END(&r->pt);
+}
+
+static int arq_sender_run(void* contexto) {
+    return arq_sender_thread(contexto);
+}
+
+static int arq_receiver_run(void* contexto) {
+    return arq_receiver_thread(contexto);
+}
+
+// ========================================
+// NETWORK SIMULATION
+// ========================================
+
+// Simulação de eventos discretos de muitos nós ligados a um gateway, para
+// dimensionar o gateway e ajustar janelas e timeouts antes do campo. Cada nó
+// envia os mesmos dados por uma sessão ARQ própria (transmissor no nó,
+// receptor no gateway), e os quadros de todos, nos dois sentidos, dividem um
+// meio com a taxa dada (o rádio ou o RS-485 do gateway). O tempo é virtual e
+// salta para a próxima expiração. As threads dos nós não passam pelo
+// escalonador, limitado a PT_MAX_THREADS: a cada instante são retomados os
+// receptores e depois os transmissores de todos os nós, o que basta com
+// latência de 1 ms ou mais (um ACK nunca chega no mesmo instante)
+#ifndef SIM_MAX_NODES
+#define SIM_MAX_NODES 256
+#endif
+
+// Dados por nó
+#ifndef SIM_MAX_BYTES
+#define SIM_MAX_BYTES 2048u
+#endif
+
+// Tempo virtual máximo de uma simulação
+#define SIM_MAX_MS 3600000u
+
+typedef struct {
+    arq_mode_t mode;
+    uint8_t window;
+    uint32_t rto_ms;                      // RTO inicial
+    uint32_t delay_ms;                    // Latência de cada sentido, 1 ms ou mais
+    uint8_t loss_percent;                 // Em cada sentido
+    uint32_t rate;                        // Bytes/s do meio dividido, 0 sem limite
+    size_t bytes;                         // Dados de cada nó
+} sim_config_t;
+
+typedef struct {
+    uint16_t completed;                   // Nós com os dados entregues inteiros
+    uint32_t elapsed_ms;                  // Até o último nó terminar
+    double goodput;                       // Bytes entregues por segundo, de todos os nós
+    double queue_ms;                      // Espera média de um quadro pelo meio
+    double overhead;                      // Retransmissões por quadro de dados
+} sim_result_t;
+
+typedef struct {
+    arq_sender_t tx;
+    arq_receiver_t rx;
+    link_t up;                            // Nó -> gateway: dados
+    link_t down;                          // Gateway -> nó: ACKs
+} sim_node_t;
+
+static sim_node_t sim_nodes[SIM_MAX_NODES];
+static uint8_t sim_out[SIM_MAX_NODES][SIM_MAX_BYTES];
+static link_t sim_medium;                 // Só o busy_until do meio dividido
+
+// Transfere data de cada um de nodes nós ao gateway; retorna false se a
+// configuração não cabe
+bool sim_run(const sim_config_t* c, uint16_t nodes, const uint8_t* data, sim_result_t* r) {
+    uint32_t deadline, transmissoes = 0, retransmissoes = 0, quadros = 0, espera = 0;
+    uint16_t pendentes = nodes;
+    
+    if (nodes == 0 || nodes > SIM_MAX_NODES || c->bytes > SIM_MAX_BYTES || c->delay_ms == 0) return false;
+    protothreads_init();
+    link_init(&sim_medium, 0, 0, 0);
+    for (uint16_t i = 0; i < nodes; i++) {
+        sim_node_t* n = &sim_nodes[i];
+        link_init(&n->up, c->delay_ms, c->loss_percent, 11u + 2u * i);
+        link_init(&n->down, c->delay_ms, c->loss_percent, 23u + 2u * i);
+        if (c->rate) {
+            link_set_rate(&n->up, c->rate, &sim_medium);
+            link_set_rate(&n->down, c->rate, &sim_medium);
+        }
+        arq_sender_init(&n->tx, c->mode, c->window, c->rto_ms, &n->up, &n->down, data, c->bytes);
+        arq_receiver_init(&n->rx, c->mode, c->window, &n->up, &n->down, sim_out[i], c->bytes);
+    }
+    
+    while (pendentes > 0 && system_time_ms - SYSTEM_TIME_INICIAL < SIM_MAX_MS) {
+        for (uint16_t i = 0; i < nodes; i++) {
+            arq_receiver_thread(&sim_nodes[i].rx);
+        }
+        for (uint16_t i = 0; i < nodes; i++) {
+            if (!sim_nodes[i].tx.complete) {
+                arq_sender_thread(&sim_nodes[i].tx);
+                pendentes -= sim_nodes[i].tx.complete;
+            }
+        }
+        if (pendentes == 0 || !next_deadline(&deadline)) break;
+        advance_time(deadline - system_time_ms);
+    }
+    
+    memset(r, 0, sizeof(*r));
+    r->elapsed_ms = system_time_ms - SYSTEM_TIME_INICIAL;
+    for (uint16_t i = 0; i < nodes; i++) {
+        sim_node_t* n = &sim_nodes[i];
+        r->completed += n->tx.complete && n->rx.out_size == c->bytes && memcmp(sim_out[i], data, c->bytes) == 0;
+        transmissoes += n->tx.transmissions;
+        retransmissoes += n->tx.retransmissions;
+        quadros += n->up.sent + n->down.sent;
+        espera += n->up.queued_ms + n->down.queued_ms;
+    }
+    r->goodput = r->elapsed_ms ? (double)r->completed * c->bytes * 1000.0 / r->elapsed_ms : 0.0;
+    r->queue_ms = quadros ? (double)espera / quadros : 0.0;
+    r->overhead = transmissoes ? (double)retransmissoes / transmissoes : 0.0;
+    protothreads_init();
+    return true;
+}
+
+// ========================================
+// PIPELINED RPC
+// ========================================
+
+// Pedidos e respostas sobre os quadros do enlace, casados por um número de
+// correlação: o cliente (lado do host) mantém até RPC_MAX_PENDING pedidos em
+// aberto, cada um com o seu timer, e as respostas voltam em qualquer ordem.
+// Com transmitter_thread cabe uma transação por ida e volta; aqui várias
+// consultas dividem a mesma. Dados de cada quadro:
+//   [RPC_REQUEST_BYTE, id, método, argumentos...]
+//   [RPC_RESPONSE_BYTE, id, status, resultado...]
+//   [RPC_CANCEL_BYTE, id]                     o servidor esquece o pedido
+// A resposta de um pedido que já venceu ou foi cancelado é descartada
+#ifndef RPC_MAX_PENDING
+#define RPC_MAX_PENDING 8
+#endif
+
+// Argumentos ou resultado por quadro
+#ifndef RPC_PAYLOAD
+#define RPC_PAYLOAD 32
+#endif
+
+#if RPC_PAYLOAD < 1 || RPC_PAYLOAD > ARQ_PAYLOAD
+#error "RPC_PAYLOAD deve estar entre 1 e ARQ_PAYLOAD (o quadro vai num link_t)"
+#endif
+
+#define RPC_REQUEST_BYTE 0x20
+#define RPC_RESPONSE_BYTE 0x21
+#define RPC_CANCEL_BYTE 0x22
+#define RPC_HEADER 3                      // Tipo, id e método ou status
+
+// Um pedido: a memória é de quem chama, até a conclusão
+typedef struct {
+    timer_t timer;                        // Timeout deste pedido
+    pt_completion_t done;                 // PROTOCOL_SUCCESS, PROTOCOL_TIMEOUT ou,
+                                          // cancelado, PROTOCOL_ERROR
+    uint8_t id;
+    uint8_t status;                       // Do servidor
+    uint8_t reply[RPC_PAYLOAD];
+    uint8_t reply_size;
+} rpc_call_t;
+
+typedef struct {
+    pt_t pt;
+    int thread;                           // Identificador no escalonador
+    link_t* request_link;
+    link_t* response_link;
+    rpc_call_t* pending[RPC_MAX_PENDING]; // Em aberto; NULL nos lugares livres
+    uint8_t next_id;
+    uint8_t frame[ARQ_FRAME_MAX];
+    uint32_t calls;
+    uint32_t replies;
+    uint32_t timeouts;
+    uint32_t cancels;
+    uint32_t stale;                       // Respostas sem pedido em aberto
+} rpc_client_t;
+
+struct rpc_server;
+
+// Trata um pedido: responde já ou guarda o id e responde depois, também fora
+// de ordem, com rpc_server_reply
+typedef void (*rpc_handler_t)(struct rpc_server* s, uint8_t id, uint8_t method,
+                              const uint8_t* args, uint8_t size);
+
+typedef struct rpc_server {
+    pt_t pt;
+    link_t* request_link;
+    link_t* response_link;
+    rpc_handler_t handler;
+    void (*cancel)(struct rpc_server* s, uint8_t id);  // Opcional
+    void* contexto;                       // Da aplicação, para o tratador
+    uint8_t frame[ARQ_FRAME_MAX];
+    uint32_t requests;
+    uint32_t cancels;
+    uint32_t discarded;
+} rpc_server_t;
+
+static void rpc_send(link_t* link, uint8_t type, uint8_t id, uint8_t third, const uint8_t* dados, uint8_t size) {
+    uint8_t payload[RPC_HEADER + RPC_PAYLOAD];
+    uint8_t quadro[ARQ_FRAME_MAX];
+    uint8_t tamanho = (uint8_t)sizeof(quadro);
+    uint8_t n = 0;
+    
+    payload[n++] = type;
+    payload[n++] = id;
+    if (type != RPC_CANCEL_BYTE) {
+        payload[n++] = third;
+        if (size > 0) {
+            memcpy(&payload[n], dados, size);
+        }
+    }
+    protocol_frame_encode8(payload, (uint8_t)(n + size), quadro, &tamanho);
+    link_send(link, quadro, tamanho);
+}
+
+static int rpc_client_run(void* contexto);
+
+// Registra a thread do cliente; retorna false se não há lugar no escalonador
+bool rpc_client_init(rpc_client_t* c, link_t* request_link, link_t* response_link) {
+    memset(c, 0, sizeof(*c));
+    c->request_link = request_link;
+    c->response_link = response_link;
+    c->thread = pt_register(rpc_client_run, c);
+    return c->thread >= 0;
+}
+
+static int rpc_client_slot(const rpc_client_t* c, uint8_t id) {
+    for (int i = 0; i < RPC_MAX_PENDING; i++) {
+        if (c->pending[i] && c->pending[i]->id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Envia o pedido sem esperar os anteriores. O resultado chega em call->done
+// (PT_AWAIT); retorna PROTOCOL_ERROR com a tabela cheia
+int rpc_call(rpc_client_t* c, rpc_call_t* call, uint8_t method, const uint8_t* args, uint8_t size,
+             uint32_t timeout_ms) {
+    int livre = -1;
+    
+    if (!call || size > RPC_PAYLOAD || (size > 0 && !args) || timeout_ms == 0) {
+        return PROTOCOL_INVALID_PARAM;
+    }
+    for (int i = 0; i < RPC_MAX_PENDING; i++) {
+        if (c->pending[i] == call) return PROTOCOL_INVALID_PARAM;
+        if (!c->pending[i] && livre < 0) {
+            livre = i;
+        }
+    }
+    if (livre < 0) return PROTOCOL_ERROR;
+    
+    // Ids em aberto são pulados: com RPC_MAX_PENDING < 256 sempre há um livre
+    while (rpc_client_slot(c, c->next_id) >= 0) {
+        c->next_id++;
+    }
+    call->id = c->next_id++;
+    call->status = 0;
+    call->reply_size = 0;
+    // Fora da tabela o timer não está armado: pode ser da pilha, sem iniciar
+    memset(&call->timer, 0, sizeof(call->timer));
+    pt_completion_init(&call->done);
+    c->pending[livre] = call;
+    c->calls++;
+    
+    rpc_send(c->request_link, RPC_REQUEST_BYTE, call->id, method, args, size);
+    timer_set(&call->timer, timeout_ms);
+    // O novo timer pode vencer antes do que a thread espera
+    pt_wake(c->thread);
+    return PROTOCOL_SUCCESS;
+}
+
+static void rpc_client_finish(rpc_client_t* c, int slot, int result) {
+    rpc_call_t* call = c->pending[slot];
+    
+    c->pending[slot] = NULL;
+    timer_stop(&call->timer);
+    pt_complete(&call->done, result);
+}
+
+// Desiste do pedido: conclui com PROTOCOL_ERROR e avisa o servidor. Retorna
+// false se ele já foi concluído
+bool rpc_cancel(rpc_client_t* c, rpc_call_t* call) {
+    int slot = rpc_client_slot(c, call->id);
+    
+    if (slot < 0 || c->pending[slot] != call) return false;
+    
+    rpc_send(c->request_link, RPC_CANCEL_BYTE, call->id, 0, NULL, 0);
+    rpc_client_finish(c, slot, PROTOCOL_ERROR);
+    c->cancels++;
+    return true;
+}
+
+uint8_t rpc_outstanding(const rpc_client_t* c) {
+    uint8_t n = 0;
+    
+    for (int i = 0; i < RPC_MAX_PENDING; i++) {
+        n += c->pending[i] != NULL;
+    }
+    return n;
+}
+
+static void rpc_client_frame(rpc_client_t* c, const uint8_t* bytes, uint8_t size) {
+    const uint8_t* dados;
+    uint8_t qtd;
+    int slot;
+    
+    if (!arq_frame_payload(bytes, size, &dados, &qtd) || qtd < RPC_HEADER || dados[0] != RPC_RESPONSE_BYTE ||
+        qtd - RPC_HEADER > RPC_PAYLOAD || (slot = rpc_client_slot(c, dados[1])) < 0) {
+        c->stale++;
+        return;
+    }
+    
+    rpc_call_t* call = c->pending[slot];
+    call->status = dados[2];
+    call->reply_size = (uint8_t)(qtd - RPC_HEADER);
+    memcpy(call->reply, &dados[RPC_HEADER], call->reply_size);
+    rpc_client_finish(c, slot, PROTOCOL_SUCCESS);
+    c->replies++;
+}
+
+// Evento do pedido que vence primeiro; sem pedidos, só as respostas importam
+static pt_event_t* rpc_next_event(rpc_client_t* c) {
+    timer_t* proximo = NULL;
+    
+    for (int i = 0; i < RPC_MAX_PENDING; i++) {
+        timer_t* t = c->pending[i] ? &c->pending[i]->timer : NULL;
+        if (t && (!proximo || timer_remaining(t) < timer_remaining(proximo))) {
+            proximo = t;
+        }
+    }
+    return proximo ? &proximo->expired : &c->response_link->delivery.expired;
+}
+
+static bool rpc_client_expired(const rpc_client_t* c) {
+    for (int i = 0; i < RPC_MAX_PENDING; i++) {
+        if (c->pending[i] && timer_expired(&c->pending[i]->timer)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PT_THREAD(rpc_client_thread(rpc_client_t* c))
+{
+    uint8_t size;
+    
+    PT_BEGIN(&c->pt);
+    
+    while (1) {
+        PT_WAIT_EVENT2(&c->pt, &c->response_link->delivery.expired, rpc_next_event(c),
+            link_ready(c->response_link) || rpc_client_expired(c));
+        
+        // As respostas primeiro: a que chega junto com o timeout ainda vale
+        while (link_receive(c->response_link, c->frame, &size)) {
+            rpc_client_frame(c, c->frame, size);
+        }
+        for (int i = 0; i < RPC_MAX_PENDING; i++) {
+            if (c->pending[i] && timer_expired(&c->pending[i]->timer)) {
+                rpc_client_finish(c, i, PROTOCOL_TIMEOUT);
+                c->timeouts++;
+            }
+        }
+    }
+    
+    PT_END(&c->pt);
+}
+
+static int rpc_client_run(void* contexto) {
+    return rpc_client_thread(contexto);
+}
+
+void rpc_server_init(rpc_server_t* s, link_t* request_link, link_t* response_link, rpc_handler_t handler,
+                     void* contexto) {
+    memset(s, 0, sizeof(*s));
+    s->request_link = request_link;
+    s->response_link = response_link;
+    s->handler = handler;
+    s->contexto = contexto;
+}
+
+// Responde ao pedido id, do tratador ou depois dele
+int rpc_server_reply(rpc_server_t* s, uint8_t id, uint8_t status, const uint8_t* dados, uint8_t size) {
+    if (size > RPC_PAYLOAD || (size > 0 && !dados)) return PROTOCOL_INVALID_PARAM;
+    
+    rpc_send(s->response_link, RPC_RESPONSE_BYTE, id, status, dados, size);
+    return PROTOCOL_SUCCESS;
+}
+
+static void rpc_server_frame(rpc_server_t* s, const uint8_t* bytes, uint8_t size) {
+    const uint8_t* dados;
+    uint8_t qtd;
+    
+    if (!arq_frame_payload(bytes, size, &dados, &qtd) || qtd < 2) {
+        s->discarded++;
+    } else if (dados[0] == RPC_REQUEST_BYTE && qtd >= RPC_HEADER) {
+        s->requests++;
+        s->handler(s, dados[1], dados[2], &dados[RPC_HEADER], (uint8_t)(qtd - RPC_HEADER));
+    } else if (dados[0] == RPC_CANCEL_BYTE) {
+        s->cancels++;
+        if (s->cancel) {
+            s->cancel(s, dados[1]);
+        }
+    } else {
+        s->discarded++;
+    }
+}
+
+PT_THREAD(rpc_server_thread(rpc_server_t* s))
+{
+    uint8_t size;
+    
+    PT_BEGIN(&s->pt);
+    
+    while (1) {
+        PT_WAIT_EVENT(&s->pt, &s->request_link->delivery.expired, link_ready(s->request_link));
+        
+        while (link_receive(s->request_link, s->frame, &size)) {
+            rpc_server_frame(s, s->frame, size);
+        }
+    }
+    
+    PT_END(&s->pt);
+}
+
+static int rpc_server_run(void* contexto) {
+    return rpc_server_thread(contexto);
+}
+
+// ========================================
+// TESTS
+// ========================================
+
+static char * executa_testes(void);
+static void mede_desempenho(void);
+static int varre_tamanhos(void);
+
+int main() {
+    if (PROTOCOL_BENCH_VARREDURA) {
+        return varre_tamanhos();
+    }
+    char *resultado = executa_testes();
+    if (resultado == 0) {
+        mede_desempenho();
+    }
+    if (resultado != 0) {
+        printf("%s\n", resultado);
+    } else {
+        printf("TODOS OS TESTES PASSARAM\n");
+    }
+    printf("Testes executados: %d\n", testes_executados);
+    protocol_test_resumo();
+
+    return resultado != 0;
+}
+
+// Canal que perde todos os quadros de dados (os ACKs passam)
+static const channel_impairment_t canal_mudo = { .loss_percent = 100 };
+
+static char * test_protothread_init(void) {
+    protothreads_init();
+    
+    verifica("erro: tx_state deve estar inicializado", default_session.tx.pt.lc == 0);
+    verifica("erro: rx_state deve estar inicializado", default_session.rx.pt.lc == 0);
+    verifica("erro: system_time deve ser o inicial", system_time_ms == SYSTEM_TIME_INICIAL);
+    
+    return 0;
+}
+
+static char * test_successful_transmission(void) {
+    protothreads_init();
+    
+    uint8_t test_data[] = {0xAA, 0xBB, 0xCC};
+    protothreads_send_data(test_data, 3);
+    
+    // Run threads until transmission completes
+    for (int i = 0; i < 100 && !protothreads_transmission_complete(); i++) {
+        protothreads_schedule();
+        if (i % 10 == 0) advance_time(10); // Advance time periodically
+    }
+    
+    verifica("erro: transmissão deve estar completa", protothreads_transmission_complete());
+    verifica("erro: resultado TX deve ser SUCCESS", protothreads_get_tx_result() == PROTOCOL_SUCCESS);
+    verifica("erro: mensagem deve ser recebida", protothreads_message_received());
+    verifica("erro: resultado RX deve ser SUCCESS", protothreads_get_rx_result() == PROTOCOL_SUCCESS);
+    verifica("erro: tamanho recebido deve ser 3", protothreads_get_received_size() == 3);
+    verifica("erro: dados recebidos devem estar corretos", 
+             memcmp(protothreads_get_received_data(), test_data, 3) == 0);
+    
+    return 0;
+}
+
+static char * test_timeout_and_retry(void) {
+    protothreads_init();
+    
+    uint8_t test_data[] = {0x12, 0x34};
+    protothreads_send_data(test_data, 2);
+    
+    // Test scenario 1: Simulate complete packet loss to force timeout
+    channel_impair(&channel, &canal_mudo);
+    
+    // Run until max retries reached (should take 3 * 1000ms + some processing time)
+    for (int i = 0; i < 200; i++) {  // Increased iterations
+        protothreads_schedule();
+        advance_time(100); // Advance 100ms each iteration
+        
+        if (protothreads_transmission_complete()) {
+            break;
+        }
+    }
+    
+    // After max retries, transmission should be marked complete with TIMEOUT result
+    verifica("erro: transmissão deve estar completa após max retries", 
+             protothreads_transmission_complete());
+    verifica("erro: resultado deve ser TIMEOUT após max retries", 
+             protothreads_get_tx_result() == PROTOCOL_TIMEOUT);
+    
+    return 0;
+}
+
+static char * test_message_creation(void) {
+    uint8_t dados[] = {0x10, 0x20, 0x30};
+    uint8_t buffer[10];
+    uint8_t buffer_size = 10;
+    
+    int result = protocol_create_message(dados, 3, buffer, &buffer_size);
+    
+    verifica("erro: criação deve ser bem-sucedida", result == PROTOCOL_SUCCESS);
+    verifica("erro: tamanho deve ser 8", buffer_size == 8);
+    verifica("erro: STX deve estar correto", buffer[0] == STX_BYTE);
+    verifica("erro: QTD deve estar correta", buffer[1] == 3);
+    verifica("erro: dados devem estar corretos", memcmp(&buffer[2], dados, 3) == 0);
+    verifica("erro: ETX deve estar correto", buffer[6] == ETX_BYTE);
+    
+    return 0;
+}
+
+static char * test_timer_functionality(void) {
+    timer_t timer;
+    
+    timer_set(&timer, 100);
+    verifica("erro: timer não deve estar expirado inicialmente", !timer_expired(&timer));
+    
+    advance_time(50);
+    verifica("erro: timer não deve estar expirado após 50ms", !timer_expired(&timer));
+    
+    advance_time(60);
+    verifica("erro: timer deve estar expirado após 110ms total", timer_expired(&timer));
+    
+    return 0;
+}
+
+static char * test_retry_then_success(void) {
+    protothreads_init();
+    
+    uint8_t test_data[] = {0xFF, 0xEE, 0xDD};
+    protothreads_send_data(test_data, 3);
+    
+    // Simulate exactly 1 timeout, then allow success
+    channel_impair(&channel, &canal_mudo);
+    
+    // Run until first retry
+    for (int i = 0; i < 50 && default_session.tx.retry_count == 0; i++) {
+        protothreads_schedule();
+        advance_time(50);
+    }
+    
+    verifica("erro: deve ter feito 1 retry", default_session.tx.retry_count == 1);
+    
+    // Now stop packet loss and allow success
+    channel_impair(&channel, NULL);
+    
+    // Continue until transmission completes
+    for (int i = 0; i < 50 && !protothreads_transmission_complete(); i++) {
+        protothreads_schedule();
+        advance_time(10);
+    }
+    
+    verifica("erro: transmissão deve ter sucesso após 1 retry", 
+             protothreads_transmission_complete());
+    verifica("erro: resultado deve ser SUCCESS", 
+             protothreads_get_tx_result() == PROTOCOL_SUCCESS);
+    verifica("erro: dados devem estar corretos", 
+             memcmp(protothreads_get_received_data(), test_data, 3) == 0);
+    
+    return 0;
+}
+
+// Thread de teste: conta as retomadas e espera go
+typedef struct {
+    pt_t pt;
+    int retomadas;
+    bool go;
+} teste_thread_t;
+
+PT_THREAD(teste_thread(void* contexto))
+{
+    teste_thread_t* t = contexto;
+    
+    t->retomadas++;
+    PT_BEGIN(&t->pt);
+    PT_WAIT_UNTIL(&t->pt, t->go);
+    PT_END(&t->pt);
+}
+
+#if defined(__GNUC__) && !defined(PT_LC_SWITCH)
+// Thread com switch próprio e PT_YIELD dentro dele (só com &&rótulo)
+typedef struct {
+    pt_t pt;
+    int fase;
+    int passos;
+} teste_switch_t;
+
+PT_THREAD(teste_switch_thread(teste_switch_t* t))
+{
+    PT_BEGIN(&t->pt);
+    while (t->fase < 3) {
+        switch (t->fase) {
+            case 0:
+                t->passos++;
+                PT_YIELD(&t->pt);
+                t->fase = 1;
+                break;
+            case 1:
+                t->passos += 10;
+                PT_YIELD(&t->pt);
+                t->fase = 2;
+                break;
+            default:
+                t->fase = 3;
+                break;
+        }
+    }
+    PT_END(&t->pt);
+}
+
+static char * test_lc_switch_in_thread(void) {
+    teste_switch_t t = {0};
+    
+    PT_INIT(&t.pt);
+    verifica("erro: a primeira passada deve ceder no caso 0", teste_switch_thread(&t) == PT_YIELDED && t.passos == 1);
+    verifica("erro: a retomada deve ceder no caso 1", teste_switch_thread(&t) == PT_YIELDED && t.passos == 11);
+    verifica("erro: a thread deve terminar", teste_switch_thread(&t) == PT_ENDED && t.fase == 3);
+    verifica("erro: a continuação deve voltar ao início", t.pt.lc == 0);
+    
+    return 0;
+}
+#endif
+
+static char * test_channel_fifo(void) {
+    static comm_channel_t a, b;
+    uint8_t primeira[8], segunda[8], lido[16];
+    uint8_t size = 8;
+    
+    channel_reset(&a);
+    channel_reset(&b);
+    
+    // Dois quadros seguidos: o segundo não sobrescreve o primeiro
+    uint8_t d1[] = {1, 2, 3}, d2[] = {4, 5, 6};
+    protocol_create_message(d1, 3, primeira, &size);
+    size = 8;
+    protocol_create_message(d2, 3, segunda, &size);
+    verifica("erro: os dois quadros devem caber", channel_send(&a, primeira, 7) && channel_send(&a, segunda, 7));
+    verifica("erro: o canal deve ter os dois quadros", channel_available(&a) == 14);
+    verifica("erro: o primeiro quadro deve sair primeiro",
+             channel_receive(&a, lido, 7) == 7 && memcmp(lido, primeira, 7) == 0);
+    verifica("erro: depois o segundo", channel_receive(&a, lido, 16) == 7 && memcmp(lido, segunda, 7) == 0);
+    
+    // As instâncias são independentes
+    verifica("erro: o outro canal deve continuar vazio", channel_available(&b) == 0 && !channel_receive_byte(&b, lido));
+    
+    // Canal cheio: a escrita em bloco aceita o que cabe; o quadro inteiro é recusado
+    static uint8_t bloco[CHANNEL_CAPACITY];
+    for (size_t i = 0; i < sizeof(bloco); i++) {
+        bloco[i] = (uint8_t)i;
+    }
+    verifica("erro: a escrita deve aceitar só o espaço livre",
+             channel_write(&a, bloco, 100) == 100 && channel_write(&a, bloco, CHANNEL_CAPACITY) == CHANNEL_CAPACITY - 100);
+    verifica("erro: o canal cheio deve recusar o quadro", !channel_send(&a, primeira, 7) && channel_space(&a) == 0);
+    verifica("erro: a recusa deve ser contada", a.rejected == 100 + 7);
+    
+    // A leitura atravessa a volta da FIFO
+    uint8_t n = channel_receive(&a, lido, 16);
+    verifica("erro: a leitura deve tirar 16 bytes", n == 16 && lido[15] == 15);
+    verifica("erro: a escrita na volta deve caber", channel_write(&a, bloco, 16) == 16);
+    uint16_t restante = channel_available(&a);
+    for (uint16_t i = 0; i < restante; i++) {
+        channel_receive_byte(&a, &lido[0]);
+    }
+    verifica("erro: o último byte deve ser o da volta", lido[0] == 15 && channel_available(&a) == 0);
+    
+    // ACKs ficam em fila, na ordem
+    channel_send_ack(&a, ACK_BYTE);
+    channel_send_ack_seq(&a, NACK_BYTE, true, 9);
+    uint8_t ack, seq;
+    bool has_seq;
+    verifica("erro: o primeiro ACK deve sair primeiro",
+             channel_ack_received_seq(&a, &ack, &has_seq, &seq) && ack == ACK_BYTE && !has_seq);
+    verifica("erro: depois o NACK com sequência",
+             channel_ack_received_seq(&a, &ack, &has_seq, &seq) && ack == NACK_BYTE && has_seq && seq == 9);
+    verifica("erro: a fila de ACKs deve ficar vazia", !channel_ack_received(&a, &ack));
+    
+    // Mensagens seguidas no canal e ruído antes do STX: o receptor acha todas
+    protothreads_init();
+    uint8_t ruido[] = {0x55, 0xAA, 0x03};
+    channel_send(&channel, ruido, 3);
+    channel_send(&channel, primeira, 7);
+    channel_send(&channel, segunda, 7);
+    for (int i = 0; i < 10; i++) {
+        protothreads_schedule();
+    }
+    verifica("erro: o receptor deve entregar as duas mensagens", protothreads_get_rx_delivered() == 2);
+    protothreads_init();
+    
+    return 0;
+}
+
+// Sessões independentes, cada uma no seu canal, no mesmo escalonador
+#define SESSOES_TESTE 4
+static char * test_channel_impairment(void) {
+    static comm_channel_t a;
+    static uint8_t bloco[250];
+    uint8_t quadro[8], lido[16], ack;
+    uint8_t size = 8;
+    uint8_t d[] = {1, 2, 3};
+    
+    protothreads_init();
+    channel_reset(&a);
+    protocol_create_message(d, 3, quadro, &size);
+    
+    // Latência: o quadro ocupa a FIFO, mas só chega em advance_time
+    channel_impairment_t atraso = { .delay_ms = 30, .seed = 1 };
+    channel_impair(&a, &atraso);
+    verifica("erro: impairment: o quadro deve sair", channel_send(&a, quadro, 7) && channel_space(&a) == CHANNEL_CAPACITY - 7);
+    advance_time(29);
+    verifica("erro: impairment: o quadro não deve chegar antes da latência", channel_available(&a) == 0);
+    advance_time(1);
+    verifica("erro: impairment: o quadro deve chegar com a latência",
+             channel_receive(&a, lido, 16) == 7 && memcmp(lido, quadro, 7) == 0);
+    
+    // O ACK também leva a latência
+    channel_send_ack(&a, ACK_BYTE);
+    verifica("erro: impairment: o ACK não deve chegar na hora", !channel_ack_received(&a, &ack));
+    advance_time(30);
+    verifica("erro: impairment: o ACK deve chegar com a latência", channel_ack_received(&a, &ack) && ack == ACK_BYTE);
+    
+    // Taxa de 1000 bytes/s: 10 bytes levam 10 ms, e o segundo espera o primeiro
+    channel_impairment_t taxa = { .rate = 1000, .seed = 1 };
+    channel_impair(&a, &taxa);
+    channel_write(&a, bloco, 10);
+    channel_write(&a, bloco, 10);
+    advance_time(10);
+    verifica("erro: impairment: o primeiro bloco deve chegar em 10 ms", channel_available(&a) == 10);
+    advance_time(10);
+    verifica("erro: impairment: o segundo, 10 ms depois", channel_available(&a) == 20);
+    channel_receive(&a, lido, 10);
+    channel_receive(&a, lido, 10);
+    
+    // Variação: as chegadas espalham, sem reordenar os bytes
+    channel_impairment_t variacao = { .delay_ms = 10, .jitter_ms = 20, .seed = 5 };
+    channel_impair(&a, &variacao);
+    for (uint8_t i = 0; i < 10; i++) {
+        channel_write(&a, &i, 1);
+    }
+    advance_time(10);
+    uint16_t no_minimo = channel_available(&a);
+    advance_time(20);
+    verifica("erro: impairment: a variação deve espalhar as chegadas", no_minimo < 10 && channel_available(&a) == 10);
+    for (uint8_t i = 0; i < 10; i++) {
+        verifica("erro: impairment: a variação não deve reordenar", channel_receive_byte(&a, &lido[0]) && lido[0] == i);
+    }
+    
+    // Erros de bit: 1% dos bits troca uns 8% dos bytes
+    channel_impairment_t ruido = { .ber_ppm = 10000, .seed = 7 };
+    channel_impair(&a, &ruido);
+    for (int i = 0; i < 4; i++) {
+        channel_write(&a, bloco, sizeof(bloco));
+    }
+    verifica("erro: impairment: os bits trocados devem seguir a BER", a.corrupted > 40 && a.corrupted < 120);
+    
+    // Perdas: de quadros e de ACKs, contadas
+    channel_reset(&a);
+    channel_impairment_t perdas = { .loss_percent = 100, .ack_loss_percent = 100 };
+    channel_impair(&a, &perdas);
+    channel_send(&a, quadro, 7);
+    channel_send_ack(&a, ACK_BYTE);
+    verifica("erro: impairment: o quadro e o ACK devem se perder",
+             channel_available(&a) == 0 && channel_space(&a) == CHANNEL_CAPACITY && !channel_ack_received(&a, &ack) &&
+             a.lost == 1 && a.acks_lost == 1);
+    
+    // A sessão padrão num enlace de 40 a 50 ms em cada sentido: a mensagem
+    // chega e o RTT medido é a ida e volta
+    uint8_t dados[] = {0x12, 0x34, 0x56};
+    uint32_t deadline;
+    channel_impairment_t enlace = { .delay_ms = 40, .jitter_ms = 10, .seed = 3 };
+    protothreads_init();
+    channel_impair(&channel, &enlace);
+    protothreads_send_data(dados, 3);
+    for (int i = 0; i < 1000 && !protothreads_transmission_complete(); i++) {
+        protothreads_schedule();
+        if (!pt_ready && next_deadline(&deadline)) {
+            advance_time(deadline - system_time_ms);
+        }
+    }
+    verifica("erro: impairment: a mensagem deve chegar pelo enlace",
+             protothreads_get_tx_result() == PROTOCOL_SUCCESS && protothreads_get_rx_delivered() == 1 &&
+             memcmp(protothreads_get_received_data(), dados, 3) == 0);
+    uint32_t rtt = protothreads_get_rto_stats()->srtt8 >> 3;
+    verifica("erro: impairment: o RTT deve ser a ida e volta", rtt >= 80 && rtt <= 100);
+
+    protothreads_init();
+    
+    return 0;
+}
+
+static char * test_multiple_sessions(void) {
+    static protocol_session_t sessoes[SESSOES_TESTE];
+    static comm_channel_t canais[SESSOES_TESTE];
+    uint8_t dados[SESSOES_TESTE][3];
+    uint32_t deadline;
+    
+    protothreads_init();
+    for (int i = 0; i < SESSOES_TESTE; i++) {
+        verifica("erro: a sessão deve caber no escalonador", session_init(&sessoes[i], &canais[i]) == PROTOCOL_SUCCESS);
+        for (int j = 0; j < 3; j++) {
+            dados[i][j] = (uint8_t)(0x10 * (i + 1) + j);
+        }
+        session_send_data(&sessoes[i], dados[i], 3);
+    }
+    channel_impair(&canais[SESSOES_TESTE - 1], &canal_mudo);  // Só esta deve esgotar as tentativas
+    
+    int passadas = 0;
+    bool pendente = true;
+    while (pendente && passadas++ < 50) {
+        protothreads_schedule();
+        if (!pt_ready && next_deadline(&deadline)) {
+            advance_time(deadline - system_time_ms);
+        }
+        pendente = false;
+        for (int i = 0; i < SESSOES_TESTE; i++) {
+            pendente |= !session_transmission_complete(&sessoes[i]);
+        }
+    }
+    
+    for (int i = 0; i < SESSOES_TESTE - 1; i++) {
+        verifica("erro: a sessão deve transmitir com sucesso", session_get_tx_result(&sessoes[i]) == PROTOCOL_SUCCESS);
+        verifica("erro: cada receptor deve ter os dados da sua sessão",
+                 session_message_received(&sessoes[i]) && session_get_received_size(&sessoes[i]) == 3 &&
+                 memcmp(session_get_received_data(&sessoes[i]), dados[i], 3) == 0);
+    }
+    verifica("erro: a sessão com perda deve terminar por timeout",
+             session_get_tx_result(&sessoes[SESSOES_TESTE - 1]) == PROTOCOL_TIMEOUT &&
+             !session_message_received(&sessoes[SESSOES_TESTE - 1]));
+    verifica("erro: a sessão padrão não deve receber nada", !protothreads_message_received());
+    protothreads_init();
+    
+    return 0;
+}
+
+// Envia pela sessão padrão e roda até o fim da transmissão
+static bool envia_e_espera(uint8_t* dados, uint8_t size) {
+    protothreads_send_data(dados, size);
+    for (int i = 0; i < 100 && !protothreads_transmission_complete(); i++) {
+        protothreads_schedule();
+        if (i % 10 == 0) advance_time(10);
+    }
+    return protothreads_get_tx_result() == PROTOCOL_SUCCESS;
+}
+
+// As mensagens chegam direto nos buffers postados, na ordem, e passam à
+// aplicação sem cópia; sem buffer postado, ficam em rx_data
+static char * test_rx_zero_copy(void) {
+    static uint8_t a[MAX_DATA_SIZE], b[MAX_DATA_SIZE];
+    uint8_t m1[] = {1, 2, 3}, m2[] = {4, 5}, m3[] = {6};
+    uint8_t size = 0;
+    
+    protothreads_init();
+    verifica("erro: o buffer deve ser postado", session_rx_post(&default_session, a) && session_rx_post(&default_session, b));
+    verifica("erro: sem mensagem não há buffer cheio", session_rx_take(&default_session, &size) == NULL);
+    verifica("erro: a primeira mensagem deve ser entregue", envia_e_espera(m1, 3));
+    verifica("erro: a segunda mensagem deve ser entregue", envia_e_espera(m2, 2));
+    verifica("erro: a primeira deve chegar no buffer a",
+             session_rx_take(&default_session, &size) == a && size == 3 && memcmp(a, m1, 3) == 0);
+    verifica("erro: a segunda deve chegar no buffer b",
+             session_rx_take(&default_session, &size) == b && size == 2 && memcmp(b, m2, 2) == 0);
+    
+    // Sem buffer postado, como antes
+    verifica("erro: a terceira mensagem deve ser entregue", envia_e_espera(m3, 1));
+    verifica("erro: sem buffer postado nada passa à aplicação", session_rx_take(&default_session, &size) == NULL);
+    verifica("erro: sem buffer postado a mensagem fica em rx_data",
+             protothreads_get_received_data() == default_session.rx.rx_data && default_session.rx.rx_data[0] == 6);
+    
+    // Os buffers cheios ocupam as vagas até voltarem à aplicação
+    for (int i = 0; i < RX_BUFFERS; i++) {
+        session_rx_post(&default_session, a);
+    }
+    verifica("erro: não deve haver mais que RX_BUFFERS buffers postados", !session_rx_post(&default_session, b));
+    protothreads_init();
+    
+    return 0;
+}
+
+static char * test_duplicate_suppression(void) {
+    uint8_t primeira[] = {0x11, 0x22};
+    uint8_t segunda[] = {0x33, 0x44, 0x55};
+    
+    protothreads_init();
+    
+    // A primeira mensagem vai sem sequência; o ACK anuncia a sequência
+    protothreads_send_data(primeira, 2);
+    for (int i = 0; i < 10 && !protothreads_transmission_complete(); i++) {
+        protothreads_schedule();
+    }
+    verifica("erro: a primeira mensagem deve ser entregue", protothreads_get_rx_delivered() == 1);
+    verifica("erro: o transmissor deve negociar a sequência", default_session.tx.peer_sequencing);
+    
+    // A segunda vai com SOH e SEQ; o ACK se perde e ela é retransmitida
+    protothreads_send_data(segunda, 3);
+    for (int i = 0; i < 10 && protothreads_get_rx_delivered() < 2; i++) {
+        protothreads_schedule();
+    }
+    verifica("erro: a segunda mensagem deve ir com sequência", default_session.tx.message_buffer[0] == SOH_BYTE);
+    verifica("erro: a segunda mensagem deve ser entregue", protothreads_get_rx_delivered() == 2);
+    uint8_t perdido;
+    channel_ack_received(&channel, &perdido);
+    advance_time(protothreads_get_rto());
+    for (int i = 0; i < 10 && !protothreads_transmission_complete(); i++) {
+        protothreads_schedule();
+    }
+    verifica("erro: a retransmissão deve ser reconhecida como duplicata",
+             protothreads_get_rx_duplicates() == 1 && protothreads_get_rx_delivered() == 2);
+    verifica("erro: a transmissão deve terminar com sucesso", protothreads_get_tx_result() == PROTOCOL_SUCCESS);
+    verifica("erro: a mensagem deve continuar disponível", protothreads_message_received() &&
+             protothreads_get_received_size() == 3 && memcmp(protothreads_get_received_data(), segunda, 3) == 0);
+    
+    // Um receptor sem sequência não anuncia e recebe sempre STX
+    protothreads_init();
+    default_session.rx.sequencing = false;
+    for (int m = 0; m < 2; m++) {
+        protothreads_send_data(primeira, 2);
+        for (int i = 0; i < 10 && !protothreads_transmission_complete(); i++) {
+            protothreads_schedule();
+        }
+    }
+    verifica("erro: sem anúncio não deve haver sequência", !default_session.tx.peer_sequencing && default_session.tx.message_buffer[0] == STX_BYTE);
+    verifica("erro: o receptor sem sequência deve entregar", protothreads_get_rx_delivered() == 2);
+    protothreads_init();
+    
+    return 0;
+}
+
+static char * test_scheduler_ready_set(void) {
+    static teste_thread_t threads[PT_MAX_THREADS];
+    pt_event_t evento = {0};
+    
+    pt_scheduler_reset();
+    memset(threads, 0, sizeof(threads));
+    for (int i = 0; i < PT_MAX_THREADS; i++) {
+        verifica("erro: registro deve caber", pt_register(teste_thread, &threads[i]) == i);
+    }
+    verifica("erro: registro além do limite deve falhar", pt_register(teste_thread, &threads[0]) == -1);
+    
+    // A primeira passada retoma todas; depois, sem eventos, nenhuma
+    verifica("erro: primeira passada deve retomar todas", pt_schedule() == PT_MAX_THREADS);
+    verifica("erro: sem eventos nenhuma thread deve ser retomada", pt_schedule() == 0);
+    
+    // Só a thread acordada é retomada
+    threads[7].go = true;
+    pt_wake(7);
+    verifica("erro: só a thread acordada deve ser retomada", pt_schedule() == 1);
+    verifica("erro: a thread 7 deve ter sido retomada", threads[7].retomadas == 2 && threads[6].retomadas == 1);
+    
+    // O evento acorda as inscritas, menos a que já terminou
+    pt_event_subscribe(&evento, 3);
+    pt_event_subscribe(&evento, 7);
+    pt_event_subscribe(&evento, PT_MAX_THREADS - 1);
+    pt_event_signal(&evento);
+    verifica("erro: o evento deve acordar as inscritas não terminadas", pt_schedule() == 2);
+    verifica("erro: a thread terminada não deve ser retomada", threads[7].retomadas == 2);
+    verifica("erro: as inscritas devem ser retomadas",
+             threads[3].retomadas == 2 && threads[PT_MAX_THREADS - 1].retomadas == 2);
+    
+    // O canal acorda só o receptor
+    protothreads_init();
+    while (pt_schedule() > 0) {
+    }
+    uint8_t byte = 0x55;
+    channel_send(&channel, &byte, 1);
+    verifica("erro: dados no canal devem acordar só o receptor", pt_ready == ((pt_mask_t)1u << default_session.rx_id));
+    protothreads_init();
+    
+    return 0;
+}
+
+static char * test_event_wakeup(void) {
+    uint8_t test_data[] = {0x42};
+    
+    protothreads_init();
+    protothreads_send_data(test_data, 1);
+    channel_impair(&channel, &canal_mudo);
+    
+    // O transmissor espera ACK ou timeout; o receptor, dados: nada pronto
+    protothreads_schedule();
+    verifica("erro: sem eventos nenhuma thread deve estar pronta", pt_ready == 0);
+    
+    // O tempo passa sem expirar o timer: nenhuma thread é retomada
+    for (int i = 0; i < 9; i++) {
+        advance_time(100);
+        protothreads_schedule();
+    }
+    verifica("erro: o avanço do tempo sem expirar não deve acordar", pt_ready == 0 && default_session.tx.retry_count == 0);
+    verifica("erro: as passadas ociosas devem dormir", pt_idle_passes == 9);
+    
+    // A expiração acorda só o transmissor, que reenvia
+    advance_time(100);
+    verifica("erro: a expiração deve acordar o transmissor", pt_ready == ((pt_mask_t)1u << default_session.tx_id));
+    protothreads_schedule();
+    verifica("erro: o transmissor deve ter reenviado", default_session.tx.retry_count == 1);
+    
+    // Com o canal de volta, os dados acordam o receptor e o ACK, o transmissor
+    channel_impair(&channel, NULL);
+    advance_time(protothreads_get_rto());
+    for (int i = 0; i < 10 && !protothreads_transmission_complete(); i++) {
+        protothreads_schedule();
+    }
+    verifica("erro: a transmissão deve terminar sem polling", protothreads_transmission_complete() &&
+             protothreads_get_tx_result() == PROTOCOL_SUCCESS);
+    protothreads_init();
+    
+    return 0;
+}
+
+// Como numa tarefa do RTOS: protothreads_poll até nada ficar pronto, e então
+// a espera pela expiração ou por um PT_NOTIFY
+static char * test_poll_notify(void) {
+    uint8_t test_data[] = {0x42, 0x43};
+    uint32_t espera = 0;
+    
+    protothreads_init();
+    verifica("erro: o registro das threads não deve notificar", pt_notifies == 0);
+    protothreads_send_data(test_data, 2);
+    verifica("erro: pt_wake fora do escalonador deve notificar", pt_notifies == 1);
+    for (int i = 0; i < 10 && (espera = protothreads_poll(0)) == 0; i++) {
+    }
+    verifica("erro: a transmissão deve terminar nas passadas", protothreads_get_tx_result() == PROTOCOL_SUCCESS);
+    verifica("erro: sem timers armados não há expiração", espera == PT_NO_DEADLINE);
+    verifica("erro: os eventos dentro do poll não devem notificar", pt_notifies == 1);
+    
+    // Bytes escritos fora do escalonador (a interrupção) acordam o receptor
+    uint8_t ruido[] = {0x55};
+    channel_write(&channel, ruido, 1);
+    verifica("erro: os dados da interrupção devem notificar", pt_notifies == 2 && pt_ready != 0);
+    
+    // Sem ACK, o poll retorna o RTO e a tarefa dorme até lá: cada retomada é
+    // uma retransmissão
     protothreads_send_data(test_data, 2);
+    channel_impair(&channel, &canal_mudo);
+    uint32_t retomadas = 0;
+    for (espera = 0; !protothreads_transmission_complete() && retomadas < 20; retomadas++) {
+        espera = protothreads_poll(espera == PT_NO_DEADLINE ? 0 : espera);
+    }
+    verifica("erro: deve terminar por timeout", protothreads_get_tx_result() == PROTOCOL_TIMEOUT);
+    verifica("erro: as retomadas devem ser as passadas e os timeouts", retomadas <= 3 + MAX_RETRIES + 1);
+    protothreads_init();
+    
+    return 0;
+}
+
+// Sessão de E/S de teste: duas transferências, cada uma esperada com PT_AWAIT
+typedef struct {
+    pt_t pt;
+    pt_completion_t io;
+    int retomadas;
+    int iniciadas;
+    int concluidas;
+    int soma;
+} teste_io_t;
+
+PT_THREAD(teste_io_thread(void* contexto))
+{
+    teste_io_t* s = contexto;
+    
+    s->retomadas++;
+    PT_BEGIN(&s->pt);
+    while (s->iniciadas < 2) {
+        s->iniciadas++;                   // No microcontrolador: dispara o DMA
+        PT_AWAIT(&s->pt, &s->io);
+        s->concluidas++;
+        s->soma += s->io.result;
+    }
+    PT_END(&s->pt);
+}
+
+// Sessões esperando E/S não são retomadas: o escalonador dorme e cada
+// conclusão da interrupção acorda só a sua sessão
+static char * test_io_completion(void) {
+    static teste_io_t sessoes[8];
+    
+    pt_scheduler_reset();
+    memset(sessoes, 0, sizeof(sessoes));
+    for (int i = 0; i < 8; i++) {
+        pt_completion_init(&sessoes[i].io);
+        pt_register(teste_io_thread, &sessoes[i]);
+    }
+    
+    // A conclusão que chega antes da espera não se perde
+    pt_complete(&sessoes[0].io, 10);
+    verifica("erro: sem thread esperando não deve notificar", pt_notifies == 0);
+    verifica("erro: a primeira passada deve iniciar todas", pt_schedule() == 8);
+    verifica("erro: a sessão 0 não deve esperar a primeira", sessoes[0].concluidas == 1 && sessoes[0].iniciadas == 2);
+    protothreads_schedule();
+    verifica("erro: esperando E/S o escalonador deve dormir", pt_ready == 0 && pt_idle_passes == 1);
+    
+    // A interrupção conclui a transferência da sessão 5: só ela é retomada
+    pt_complete(&sessoes[5].io, 7);
+    verifica("erro: a conclusão deve acordar só a sua sessão", pt_notifies == 1 && pt_ready == ((pt_mask_t)1u << 5));
+    verifica("erro: só a sessão concluída deve ser retomada", pt_schedule() == 1 && sessoes[4].retomadas == 1);
+    verifica("erro: a sessão 5 deve iniciar a segunda", sessoes[5].concluidas == 1 && sessoes[5].iniciadas == 2);
+    
+    // Uma conclusão para cada: as sessões 0 e 5 terminam, as outras esperam a
+    // segunda, e o resultado chega à thread
+    for (int i = 0; i < 8; i++) {
+        pt_complete(&sessoes[i].io, i);
+    }
+    verifica("erro: todas as conclusões devem ser retomadas", pt_schedule() == 8 && pt_ready == 0);
+    for (int i = 0; i < 8; i++) {
+        verifica("erro: cada conclusão deve valer para uma espera",
+                 sessoes[i].concluidas == (i == 0 || i == 5 ? 2 : 1) && sessoes[i].io.count == 0);
+    }
+    verifica("erro: os resultados devem chegar às threads", sessoes[0].soma == 10 && sessoes[5].soma == 12);
+    verifica("erro: as sessões concluídas devem terminar", pt_finished == ((pt_mask_t)1u << 0 | (pt_mask_t)1u << 5));
+    protothreads_init();
+    
+    return 0;
+}
+
+// Sessão de teste em subprotocolos: handshake (cede uma vez) e transferência
+// (espera um buffer do semáforo), cada um uma protothread filha
+typedef struct {
+    pt_t pt;
+    pt_t filha;
+    pt_sem_t* buffers;
+    int fase;
+    int etapas;
+} teste_sessao_t;
+
+PT_THREAD(teste_handshake(teste_sessao_t* s))
+{
+    PT_BEGIN(&s->filha);
+    s->etapas++;
+    PT_YIELD(&s->filha);
+    s->etapas++;
+    PT_END(&s->filha);
+}
+
+PT_THREAD(teste_transferencia(teste_sessao_t* s))
+{
+    PT_BEGIN(&s->filha);
+    PT_SEM_WAIT(&s->filha, s->buffers);
+    s->etapas += 10;
+    PT_END(&s->filha);
+}
+
+PT_THREAD(teste_sessao_thread(void* contexto))
+{
+    teste_sessao_t* s = contexto;
+    
+    PT_BEGIN(&s->pt);
+    PT_SPAWN(&s->pt, &s->filha, teste_handshake(s));
+    s->fase = 1;
+    PT_SPAWN(&s->pt, &s->filha, teste_transferencia(s));
+    s->fase = 2;
+    PT_END(&s->pt);
+}
+
+// A filha que cede mantém a mãe pronta; a que espera o semáforo inscreve a
+// mãe no evento dele, e só o sinal a retoma
+static char * test_pt_spawn_sem(void) {
+    static teste_sessao_t sessoes[2];
+    pt_sem_t buffers;
+    
+    pt_scheduler_reset();
+    memset(sessoes, 0, sizeof(sessoes));
+    pt_sem_init(&buffers, 1);
+    for (int i = 0; i < 2; i++) {
+        sessoes[i].buffers = &buffers;
+        pt_register(teste_sessao_thread, &sessoes[i]);
+    }
     
-    // Test scenario 1: Simulate complete packet loss to force timeout
-    channel.simulate_loss = true;
+    verifica("erro: o handshake deve ceder", pt_schedule() == 2 && sessoes[0].fase == 0 && sessoes[1].etapas == 1);
+    verifica("erro: a filha que cede deve manter a mãe pronta", pt_ready == 3);
+    verifica("erro: as duas devem terminar o handshake", pt_schedule() == 2 && sessoes[1].fase == 1);
+    verifica("erro: só uma sessão deve obter o buffer", sessoes[0].fase == 2 && sessoes[0].etapas == 12 && buffers.count == 0);
+    verifica("erro: a sessão sem buffer não deve ser retomada", pt_schedule() == 0 && sessoes[1].etapas == 2);
     
-    // Run until max retries reached (should take 3 * 1000ms + some processing time)
-    for (int i = 0; i < 200; i++) {  // Increased iterations
+    PT_SEM_SIGNAL(&sessoes[0].pt, &buffers);
+    verifica("erro: o sinal deve acordar a que espera", pt_ready == 2);
+    verifica("erro: a sessão 1 deve terminar", pt_schedule() == 1 && sessoes[1].fase == 2 && sessoes[1].etapas == 12);
+    verifica("erro: as duas devem terminar", pt_finished == 3 && buffers.count == 0);
+    protothreads_init();
+    
+    return 0;
+}
+
+static char * test_timer_queue(void) {
+    timer_t a = {0}, b = {0}, t = {0};
+    uint32_t deadline;
+    
+    protothreads_init();
+    verifica("erro: sem timers não há próxima expiração", !next_deadline(&deadline));
+    
+    // A fila fica em ordem de expiração, qualquer que seja a ordem de armar
+    timer_set(&a, 300);
+    timer_set(&b, 100);
+    timer_set(&t, 200);
+    verifica("erro: a próxima expiração deve ser a de b", next_deadline(&deadline) && deadline == SYSTEM_TIME_INICIAL + 100);
+    verifica("erro: a fila deve estar ordenada", armed_timers == &b && b.next == &t && t.next == &a);
+    
+    // Rearmar reposiciona; parar tira da fila
+    timer_set(&b, 250);
+    verifica("erro: b rearmado deve ir para depois de t", armed_timers == &t && t.next == &b && b.next == &a);
+    timer_stop(&t);
+    verifica("erro: t parado deve sair da fila", next_deadline(&deadline) && deadline == SYSTEM_TIME_INICIAL + 250);
+    
+    // Só os expirados saem, e continuam expirados
+    advance_time(260);
+    verifica("erro: b deve ter expirado e saído da fila", timer_expired(&b) && armed_timers == &a);
+    verifica("erro: a não deve ter expirado", !timer_expired(&a));
+    advance_time(40);
+    verifica("erro: a fila deve ficar vazia", timer_expired(&a) && !next_deadline(&deadline));
+    
+    // Com a fila, o host avança o tempo direto até cada retransmissão
+    uint8_t test_data[] = {0x12, 0x34};
+    protothreads_init();
+    protothreads_send_data(test_data, 2);
+    channel_impair(&channel, &canal_mudo);
+    int passadas = 0;
+    while (!protothreads_transmission_complete() && passadas++ < 20) {
         protothreads_schedule();
-        advance_time(100); // Advance 100ms each iteration
+        if (!pt_ready && next_deadline(&deadline)) {
+            advance_time(deadline - system_time_ms);
+        }
+    }
+    verifica("erro: deve terminar por timeout", protothreads_get_tx_result() == PROTOCOL_TIMEOUT);
+    // Com o recuo: TIMEOUT_MS, 2 * TIMEOUT_MS, 4 * TIMEOUT_MS
+    verifica("erro: o tempo deve ser exatamente o dos timeouts", system_time_ms - SYSTEM_TIME_INICIAL == ((1u << MAX_RETRIES) - 1) * TIMEOUT_MS);
+    protothreads_init();
+    
+    return 0;
+}
+
+// A volta de system_time_ms, após 49 dias, no meio dos timers armados
+static char * test_timer_wraparound(void) {
+    timer_t a = {0}, b = {0}, t = {0};
+    uint32_t deadline;
+    
+    // A volta acontece em 100 ms: a fila segue em ordem de expiração
+    protothreads_init();
+    system_time_ms = UINT32_MAX - 99;
+    timer_set(&a, 300);
+    timer_set(&b, 50);
+    timer_set(&t, 150);
+    verifica("erro: na volta a fila deve seguir ordenada", armed_timers == &b && b.next == &t && t.next == &a);
+    verifica("erro: b expira antes da volta", next_deadline(&deadline) && deadline == UINT32_MAX - 49);
+    advance_time(49);
+    verifica("erro: b não deve expirar 1 ms antes", !timer_expired(&b));
+    advance_time(1);
+    verifica("erro: b deve expirar e sair da fila", timer_expired(&b) && armed_timers == &t);
+    advance_time(50);
+    verifica("erro: t expira depois da volta", system_time_ms == 0 && next_deadline(&deadline) && deadline == 50);
+    advance_time(49);
+    verifica("erro: t não deve expirar 1 ms antes", !timer_expired(&t));
+    advance_time(1);
+    verifica("erro: t deve expirar e sair da fila", timer_expired(&t) && armed_timers == &a);
+    
+    // Armado depois da volta, entra antes de um armado antes dela
+    timer_set(&b, 100);
+    verifica("erro: b rearmado deve ir para antes de a", armed_timers == &b && b.next == &a);
+    advance_time(150);
+    verifica("erro: a e b devem expirar juntos", timer_expired(&a) && timer_expired(&b) && !next_deadline(&deadline));
+    
+    // Longa duração: 200 dias de um timer de 1 h, saltando até 1 ms antes
+    // de cada expiração, como o host sem thread pronta. Passa por 5 voltas
+    uint32_t voltas = 0;
+    system_time_ms = UINT32_MAX - 1000;
+    timer_set(&t, 3600000u);
+    for (int hora = 0; hora < 200 * 24; hora++) {
+        uint32_t inicio = system_time_ms;
+        uint32_t esperado = inicio + 3600000u;
         
-        if (protothreads_transmission_complete()) {
-            break;
+        verifica("erro: a expiração deve ser a do timer", next_deadline(&deadline) && deadline == esperado);
+        advance_time(deadline - system_time_ms - 1);
+        verifica("erro: o timer não deve expirar 1 ms antes", !timer_expired(&t));
+        advance_time(1);
+        verifica("erro: o timer deve expirar no instante exato", timer_expired(&t) && system_time_ms == esperado);
+        voltas += system_time_ms < inicio;
+        timer_set(&t, 3600000u);
+    }
+    verifica("erro: 200 dias devem passar por 5 voltas", voltas == 5);
+    protothreads_init();
+    
+    return 0;
+}
+
+static arq_sender_t arq_tx;
+static arq_receiver_t arq_rx;
+static link_t arq_data_link;
+static link_t arq_ack_link;
+
+// Executa a transferência preparada em arq_tx e arq_rx, avançando o tempo
+// direto até cada expiração quando nenhuma thread está pronta. Retorna o
+// tempo simulado em ms, ou 0 se a transferência não terminou ou os dados
+// chegaram diferentes
+static uint32_t arq_run_transfer(const uint8_t* data, size_t size, uint8_t* out) {
+    uint32_t deadline;
+    
+    pt_register(arq_sender_run, &arq_tx);
+    pt_register(arq_receiver_run, &arq_rx);
+    
+    for (int passadas = 0; !arq_tx.complete && passadas < 1000000; passadas++) {
+        pt_schedule();
+        if (!pt_ready) {
+            if (!next_deadline(&deadline)) break;
+            advance_time(deadline - system_time_ms);
         }
     }
     
-    // After max retries, transmission should be marked complete with TIMEOUT result
-    verifica("erro: transmissão deve estar completa após max retries", 
-             protothreads_transmission_complete());
-    verifica("erro: resultado deve ser TIMEOUT após max retries", 
-             protothreads_get_tx_result() == PROTOCOL_TIMEOUT);
+    uint32_t tempo = system_time_ms - SYSTEM_TIME_INICIAL;
+    bool ok = arq_tx.complete && arq_rx.out_size == size && memcmp(out, data, size) == 0;
+    protothreads_init();
+    return ok ? tempo : 0;
+}
+
+// Transfere os dados pelo ARQ num enlace com atraso delay_ms e perda
+// loss_percent nos dois sentidos (arq_run_transfer). Com ack_delay_ms, o
+// receptor atrasa os ACKs (arq_receiver_delay_acks)
+static uint32_t arq_transfer_acks(arq_mode_t mode, uint8_t window, uint32_t delay_ms, uint8_t loss_percent,
+                                  uint32_t ack_delay_ms, uint8_t ack_every,
+                                  const uint8_t* data, size_t size, uint8_t* out) {
+    protothreads_init();
+    pt_scheduler_reset();
+    link_init(&arq_data_link, delay_ms, loss_percent, 11u);
+    link_init(&arq_ack_link, delay_ms, loss_percent, 23u);
+    arq_sender_init(&arq_tx, mode, window, 3 * delay_ms, &arq_data_link, &arq_ack_link, data, size);
+    arq_receiver_init(&arq_rx, mode, window, &arq_data_link, &arq_ack_link, out, size);
+    arq_receiver_delay_acks(&arq_rx, ack_delay_ms, ack_every);
+    return arq_run_transfer(data, size, out);
+}
+
+// A mesma transferência com as degradações ida nos dados e volta nos ACKs
+static uint32_t arq_transfer_impaired(arq_mode_t mode, uint8_t window, const channel_impairment_t* ida,
+                                      const channel_impairment_t* volta,
+                                      const uint8_t* data, size_t size, uint8_t* out) {
+    protothreads_init();
+    pt_scheduler_reset();
+    link_init(&arq_data_link, 0, 0, 0);
+    link_init(&arq_ack_link, 0, 0, 0);
+    link_impair(&arq_data_link, ida);
+    link_impair(&arq_ack_link, volta);
+    arq_sender_init(&arq_tx, mode, window, 3 * (ida->delay_ms + ida->jitter_ms), &arq_data_link, &arq_ack_link,
+                    data, size);
+    arq_receiver_init(&arq_rx, mode, window, &arq_data_link, &arq_ack_link, out, size);
+    return arq_run_transfer(data, size, out);
+}
+
+static uint32_t arq_transfer(arq_mode_t mode, uint8_t window, uint32_t delay_ms, uint8_t loss_percent,
+                             const uint8_t* data, size_t size, uint8_t* out) {
+    return arq_transfer_acks(mode, window, delay_ms, loss_percent, 0, 1, data, size, out);
+}
+
+#define ARQ_TESTE_TAMANHO 20000u            // Mais de 256 quadros: a sequência dá a volta
+
+static uint8_t arq_dados[ARQ_TESTE_TAMANHO];
+static uint8_t arq_saida[ARQ_TESTE_TAMANHO];
+
+static void arq_gera_dados(void) {
+    uint32_t semente = 7u;
+    for (size_t i = 0; i < sizeof(arq_dados); i++) {
+        arq_dados[i] = (uint8_t)protocol_bench_aleatorio(&semente);
+    }
+}
+
+static char * test_arq_window_goodput(void) {
+    arq_gera_dados();
+    
+    // Sem perdas, a janela multiplica a vazão: pare-e-espere é um quadro por
+    // ida e volta
+    uint32_t pare_espere = arq_transfer(ARQ_GO_BACK_N, 1, 50, 0, arq_dados, sizeof(arq_dados), arq_saida);
+    uint32_t go_back_n = arq_transfer(ARQ_GO_BACK_N, 8, 50, 0, arq_dados, sizeof(arq_dados), arq_saida);
+    uint32_t seletiva = arq_transfer(ARQ_SELECTIVE_REPEAT, 8, 50, 0, arq_dados, sizeof(arq_dados), arq_saida);
+    
+    verifica("erro: pare-e-espere deve entregar os dados", pare_espere > 0);
+    verifica("erro: go-back-N deve entregar os dados", go_back_n > 0);
+    verifica("erro: repetição seletiva deve entregar os dados", seletiva > 0);
+    verifica("erro: a janela de 8 deve multiplicar a vazão", pare_espere >= 7 * go_back_n && pare_espere >= 7 * seletiva);
+    verifica("erro: sem perdas não deve haver retransmissões", arq_tx.retransmissions == 0);
     
     return 0;
 }
 
-static char * test_message_creation(void) {
-    uint8_t dados[] = {0x10, 0x20, 0x30};
-    uint8_t buffer[10];
-    uint8_t buffer_size = 10;
+static char * test_rto_estimator(void) {
+    rto_estimator_t rto;
     
-    int result = protocol_create_message(dados, 3, buffer, &buffer_size);
+    rto_init(&rto, TIMEOUT_MS);
+    verifica("erro: antes de medir, o RTO é o inicial", rto.rto_ms == TIMEOUT_MS);
     
-    verifica("erro: criação deve ser bem-sucedida", result == PROTOCOL_SUCCESS);
-    verifica("erro: tamanho deve ser 8", buffer_size == 8);
-    verifica("erro: STX deve estar correto", buffer[0] == STX_BYTE);
-    verifica("erro: QTD deve estar correta", buffer[1] == 3);
-    verifica("erro: dados devem estar corretos", memcmp(&buffer[2], dados, 3) == 0);
-    verifica("erro: ETX deve estar correto", buffer[6] == ETX_BYTE);
+    // Primeira medida: SRTT = RTT, RTTVAR = RTT / 2, RTO = SRTT + 4 * RTTVAR
+    rto_sample(&rto, 100);
+    verifica("erro: RTO após a primeira medida", rto.srtt8 >> 3 == 100 && rto.rto_ms == 300);
+    
+    // Com RTT constante a variação cai até a folga mínima
+    for (int i = 0; i < 50; i++) {
+        rto_sample(&rto, 100);
+    }
+    verifica("erro: RTO deve convergir para SRTT + folga", rto.rto_ms == 100 + RTO_FOLGA_MS);
+    
+    // Uma subida do RTT aumenta a variação, e o RTO mais que o RTT
+    rto_sample(&rto, 200);
+    verifica("erro: a variação deve pesar no RTO", rto.rto_ms > 200);
+    
+    // Perdas seguidas dobram o RTO; a próxima medida desfaz o recuo
+    uint32_t base = rto.rto_ms;
+    rto_backoff(&rto);
+    rto_backoff(&rto);
+    verifica("erro: duas perdas devem quadruplicar o RTO", rto.rto_ms == 4 * base && rto.backoff == 2);
+    rto_sample(&rto, 200);
+    verifica("erro: a medida deve desfazer o recuo", rto.backoff == 0 && rto.rto_ms < 4 * base);
+    for (int i = 0; i < 40; i++) {
+        rto_backoff(&rto);
+    }
+    verifica("erro: o recuo deve parar em RTO_MAX_MS", rto.rto_ms == RTO_MAX_MS);
+    
+    // O transmissor mede o ACK imediato do canal simulado: RTO mínimo
+    uint8_t test_data[] = {0x01, 0x02};
+    protothreads_init();
+    protothreads_send_data(test_data, 2);
+    for (int i = 0; i < 10 && !protothreads_transmission_complete(); i++) {
+        protothreads_schedule();
+    }
+    verifica("erro: o transmissor deve medir o RTT", protothreads_get_rto_stats()->samples == 1);
+    verifica("erro: o RTO deve cair ao mínimo", protothreads_get_rto() == RTO_MIN_MS);
+    
+    // O ARQ aprende a ida e volta de 100 ms do enlace
+    arq_gera_dados();
+    verifica("erro: a transferência deve terminar",
+             arq_transfer(ARQ_SELECTIVE_REPEAT, 8, 50, 0, arq_dados, sizeof(arq_dados), arq_saida) > 0);
+    verifica("erro: o SRTT do ARQ deve ser a ida e volta", arq_tx.rto.srtt8 >> 3 == 100);
+    verifica("erro: o RTO do ARQ deve ficar abaixo do inicial", arq_tx.rto.rto_ms < 150);
     
     return 0;
 }
 
-static char * test_timer_functionality(void) {
-    timer_t timer;
+static char * test_arq_loss(void) {
+    arq_gera_dados();
     
-    timer_set(&timer, 100);
-    verifica("erro: timer não deve estar expirado inicialmente", !timer_expired(&timer));
+    // Com 10% de perda nos dois sentidos os dados chegam inteiros e em ordem
+    verifica("erro: pare-e-espere com perdas deve entregar os dados",
+             arq_transfer(ARQ_GO_BACK_N, 1, 20, 10, arq_dados, sizeof(arq_dados), arq_saida) > 0);
+    verifica("erro: go-back-N com perdas deve entregar os dados",
+             arq_transfer(ARQ_GO_BACK_N, 8, 20, 10, arq_dados, sizeof(arq_dados), arq_saida) > 0);
+    uint32_t go_back_n = arq_tx.retransmissions;
+    verifica("erro: repetição seletiva com perdas deve entregar os dados",
+             arq_transfer(ARQ_SELECTIVE_REPEAT, 8, 20, 10, arq_dados, sizeof(arq_dados), arq_saida) > 0);
+    verifica("erro: a repetição seletiva deve retransmitir menos que go-back-N", arq_tx.retransmissions < go_back_n);
+    verifica("erro: os quadros fora de ordem devem gerar NACKs seletivos",
+             arq_rx.nacks_sent > 0 && arq_tx.fast_retransmissions > 0);
+    verifica("erro: um NACK deve reenviar cada quadro uma vez só", arq_tx.fast_retransmissions <= arq_data_link.lost);
     
-    advance_time(50);
-    verifica("erro: timer não deve estar expirado após 50ms", !timer_expired(&timer));
+    return 0;
+}
+
+static char * test_arq_impairment(void) {
+    arq_gera_dados();
     
-    advance_time(60);
-    verifica("erro: timer deve estar expirado após 110ms total", timer_expired(&timer));
+    // Erros de bit e variação nos dois sentidos: os quadros corrompidos caem
+    // no checksum e são retransmitidos, e os dados chegam inteiros
+    channel_impairment_t ida = { .ber_ppm = 20, .delay_ms = 20, .jitter_ms = 10, .seed = 11u };
+    channel_impairment_t volta = { .ber_ppm = 20, .delay_ms = 20, .jitter_ms = 10, .seed = 23u };
+    verifica("erro: go-back-N com erros de bit deve entregar os dados",
+             arq_transfer_impaired(ARQ_GO_BACK_N, ARQ_WINDOW, &ida, &volta, arq_dados, sizeof(arq_dados), arq_saida) > 0);
+    verifica("erro: repetição seletiva com erros de bit deve entregar os dados",
+             arq_transfer_impaired(ARQ_SELECTIVE_REPEAT, ARQ_WINDOW, &ida, &volta, arq_dados, sizeof(arq_dados),
+                                   arq_saida) > 0);
+    verifica("erro: os quadros corrompidos devem ser retransmitidos",
+             arq_data_link.corrupted > 0 && arq_tx.retransmissions > 0);
+    
+    // A variação não reordena: sem perdas nem erros, nenhuma retransmissão
+    channel_impairment_t variacao = { .delay_ms = 20, .jitter_ms = 30, .seed = 5u };
+    verifica("erro: a variação não deve causar retransmissões",
+             arq_transfer_impaired(ARQ_SELECTIVE_REPEAT, ARQ_WINDOW, &variacao, &variacao, arq_dados,
+                                   sizeof(arq_dados), arq_saida) > 0 && arq_tx.retransmissions == 0);
     
     return 0;
 }
 
-static char * test_retry_then_success(void) {
+// As duas pontas de um enlace nos dois sentidos: cada uma com transmissor e
+// receptor ligados por arq_pair
+static arq_sender_t arq_tx_b;
+static arq_receiver_t arq_rx_b;
+static uint8_t arq_saida_b[ARQ_TESTE_TAMANHO];
+
+// Como arq_transfer, com a ponta A enviando size_a bytes e a B size_b bytes
+// de data ao mesmo tempo num meio half-duplex de rate bytes/s, com ACKs
+// atrasados de ack_delay_ms (0: um ACK por quadro)
+static uint32_t arq_transfer_duplex(arq_mode_t mode, uint32_t delay_ms, uint8_t loss_percent, uint32_t rate,
+                                    uint32_t ack_delay_ms, const uint8_t* data, size_t size_a, size_t size_b) {
+    uint32_t deadline;
+    uint32_t rto = 3 * (delay_ms + 2u * ARQ_WINDOW * ARQ_FRAME_MAX * 1000u / rate);
+    
     protothreads_init();
+    pt_scheduler_reset();
+    link_init(&arq_data_link, delay_ms, loss_percent, 11u);   // A para B
+    link_init(&arq_ack_link, delay_ms, loss_percent, 23u);    // B para A
+    link_set_rate(&arq_data_link, rate, NULL);
+    link_set_rate(&arq_ack_link, rate, &arq_data_link);
+    arq_sender_init(&arq_tx, mode, ARQ_WINDOW, rto, &arq_data_link, NULL, data, size_a);
+    arq_receiver_init(&arq_rx, mode, ARQ_WINDOW, &arq_ack_link, &arq_data_link, arq_saida_b, size_b);
+    arq_sender_init(&arq_tx_b, mode, ARQ_WINDOW, rto, &arq_ack_link, NULL, data, size_b);
+    arq_receiver_init(&arq_rx_b, mode, ARQ_WINDOW, &arq_data_link, &arq_ack_link, arq_saida, size_a);
+    arq_pair(&arq_tx, &arq_rx);
+    arq_pair(&arq_tx_b, &arq_rx_b);
+    arq_receiver_delay_acks(&arq_rx, ack_delay_ms, ARQ_WINDOW / 2);
+    arq_receiver_delay_acks(&arq_rx_b, ack_delay_ms, ARQ_WINDOW / 2);
+    pt_register(arq_sender_run, &arq_tx);
+    pt_register(arq_receiver_run, &arq_rx);
+    pt_register(arq_sender_run, &arq_tx_b);
+    pt_register(arq_receiver_run, &arq_rx_b);
     
-    uint8_t test_data[] = {0xFF, 0xEE, 0xDD};
-    protothreads_send_data(test_data, 3);
+    for (int passadas = 0; !(arq_tx.complete && arq_tx_b.complete) && passadas < 1000000; passadas++) {
+        pt_schedule();
+        if (!pt_ready) {
+            if (!next_deadline(&deadline)) break;
+            advance_time(deadline - system_time_ms);
+        }
+    }
     
-    // Simulate exactly 1 timeout, then allow success
-    channel.simulate_loss = true;
+    uint32_t tempo = system_time_ms - SYSTEM_TIME_INICIAL;
+    bool ok = arq_tx.complete && arq_tx_b.complete &&
+              arq_rx_b.out_size == size_a && memcmp(arq_saida, data, size_a) == 0 &&
+              arq_rx.out_size == size_b && memcmp(arq_saida_b, data, size_b) == 0;
+    protothreads_init();
+    return ok ? tempo : 0;
+}
+
+static char * test_arq_ack_coalescing(void) {
+    arq_gera_dados();
     
-    // Run until first retry
-    for (int i = 0; i < 50 && tx_state.retry_count == 0; i++) {
+    // ACKs atrasados: um ACK a cada dois quadros, sem perder vazão
+    uint32_t imediato = arq_transfer(ARQ_GO_BACK_N, 8, 50, 0, arq_dados, sizeof(arq_dados), arq_saida);
+    verifica("erro: deve haver um ACK por quadro", arq_ack_link.sent == arq_tx.transmissions);
+    uint32_t atrasado = arq_transfer_acks(ARQ_GO_BACK_N, 8, 50, 0, 20, 2, arq_dados, sizeof(arq_dados), arq_saida);
+    verifica("erro: com ACKs atrasados os dados devem chegar", imediato > 0 && atrasado > 0);
+    verifica("erro: os ACKs atrasados devem ser a metade", 2 * arq_ack_link.sent <= arq_tx.transmissions + 1);
+    verifica("erro: a vazão deve se manter", atrasado <= imediato + imediato / 4);
+    
+    // Com perdas o ACK cumulativo cobre os ACKs perdidos
+    verifica("erro: go-back-N com ACKs atrasados e perdas deve entregar os dados",
+             arq_transfer_acks(ARQ_GO_BACK_N, 8, 20, 10, 5, 2, arq_dados, sizeof(arq_dados), arq_saida) > 0);
+    verifica("erro: repetição seletiva com ACKs atrasados e perdas deve entregar os dados",
+             arq_transfer_acks(ARQ_SELECTIVE_REPEAT, 8, 20, 10, 5, 2, arq_dados, sizeof(arq_dados), arq_saida) > 0);
+    
+    // Nos dois sentidos, num meio half-duplex de 1000 bytes/s, os ACKs seguem
+    // nos quadros de dados: menos quadros no meio e a transferência mais curta
+    uint32_t separados = arq_transfer_duplex(ARQ_GO_BACK_N, 5, 0, 1000, 0, arq_dados, 8000, 4000);
+    uint32_t quadros_separados = arq_data_link.sent + arq_ack_link.sent;
+    uint32_t juntos = arq_transfer_duplex(ARQ_GO_BACK_N, 5, 0, 1000, 200, arq_dados, 8000, 4000);
+    verifica("erro: a transferência nos dois sentidos deve terminar", separados > 0 && juntos > 0);
+    verifica("erro: os ACKs devem seguir nos dados", arq_rx.acks_piggybacked > 0 && arq_rx_b.acks_piggybacked > 0);
+    verifica("erro: o meio deve levar um quarto a menos de quadros",
+             4 * (arq_data_link.sent + arq_ack_link.sent) <= 3 * quadros_separados);
+    verifica("erro: a transferência deve ficar mais curta", juntos < separados);
+    verifica("erro: repetição seletiva nos dois sentidos com perdas deve entregar os dados",
+             arq_transfer_duplex(ARQ_SELECTIVE_REPEAT, 5, 10, 1000, 200, arq_dados, 4000, 8000) > 0);
+    
+    return 0;
+}
+
+// Vários nós num gateway: todos entregam os dados, e o meio dividido limita
+// a vazão somada e faz os quadros esperarem
+static char * test_sim_rede(void) {
+    sim_config_t cfg = { .mode = ARQ_SELECTIVE_REPEAT, .window = 2, .rto_ms = 200, .delay_ms = 20,
+                         .loss_percent = 5, .rate = 8000, .bytes = 1000 };
+    sim_result_t um, oito;
+    arq_gera_dados();
+    
+    verifica("erro: a simulação deve recusar nós demais", !sim_run(&cfg, SIM_MAX_NODES + 1, arq_dados, &um));
+    verifica("erro: a simulação com um nó deve rodar", sim_run(&cfg, 1, arq_dados, &um));
+    verifica("erro: o nó deve entregar os dados", um.completed == 1);
+    verifica("erro: a simulação com oito nós deve rodar", sim_run(&cfg, 8, arq_dados, &oito));
+    verifica("erro: os oito nós devem entregar os dados", oito.completed == 8);
+    verifica("erro: a vazão somada não pode passar da taxa do meio", oito.goodput > 0 && oito.goodput <= cfg.rate);
+    verifica("erro: oito nós devem somar mais vazão que um", oito.goodput > um.goodput);
+    verifica("erro: com oito nós os quadros devem esperar mais pelo meio", oito.queue_ms > um.queue_ms);
+    verifica("erro: com perdas deve haver retransmissões", oito.overhead > 0);
+    
+    return 0;
+}
+
+// Um quadro de configuração para três enlaces de taxas diferentes: uma
+// codificação, o mesmo buffer nos três anéis, devolvido no fim do mais lento
+#define FANOUT_TESTE_PORTAS 3
+static char * test_fanout(void) {
+    static comm_channel_t canais[FANOUT_TESTE_PORTAS];
+    static fanout_port_t portas[FANOUT_TESTE_PORTAS];
+    static fanout_pool_t pool;
+    static const uint32_t taxas[FANOUT_TESTE_PORTAS] = { 0, 1000, 100 };
+    fanout_port_t* todas[FANOUT_TESTE_PORTAS];
+    uint8_t config[20], esperado[32], lido[32];
+    uint8_t size = sizeof(esperado);
+    
+    protothreads_init();
+    fanout_pool_init(&pool);
+    for (int i = 0; i < FANOUT_TESTE_PORTAS; i++) {
+        channel_reset(&canais[i]);
+        fanout_port_init(&portas[i], &pool, &canais[i], taxas[i]);
+        todas[i] = &portas[i];
+    }
+    for (uint8_t i = 0; i < sizeof(config); i++) {
+        config[i] = (uint8_t)(0xC0 + i);
+    }
+    protocol_create_message(config, sizeof(config), esperado, &size);
+    
+    verifica("erro: fan-out: o quadro deve entrar nas três portas",
+             fanout_send(todas, FANOUT_TESTE_PORTAS, config, sizeof(config)) == FANOUT_TESTE_PORTAS);
+    verifica("erro: fan-out: uma só codificação e um só buffer",
+             pool.encodes == 1 && fanout_pool_available(&pool) == FANOUT_BUFFERS - 1);
+    verifica("erro: fan-out: a porta sem taxa deve entregar na hora",
+             channel_receive(&canais[0], lido, sizeof(lido)) == 24 && memcmp(lido, esperado, 24) == 0);
+    
+    // 24 bytes a 1000 bytes/s: 24 ms; a 100 bytes/s: 240 ms
+    advance_time(23);
+    verifica("erro: fan-out: o envio a 1000 bytes/s ainda não terminou", channel_available(&canais[1]) == 0);
+    advance_time(1);
+    verifica("erro: fan-out: o envio a 1000 bytes/s deve terminar em 24 ms",
+             channel_receive(&canais[1], lido, sizeof(lido)) == 24 && memcmp(lido, esperado, 24) == 0);
+    verifica("erro: fan-out: o buffer fica com a porta lenta", fanout_pool_available(&pool) == FANOUT_BUFFERS - 1);
+    advance_time(216);
+    verifica("erro: fan-out: o envio a 100 bytes/s deve terminar em 240 ms",
+             channel_receive(&canais[2], lido, sizeof(lido)) == 24 && memcmp(lido, esperado, 24) == 0);
+    verifica("erro: fan-out: o último envio devolve o buffer", fanout_pool_available(&pool) == FANOUT_BUFFERS);
+    
+    // A porta lenta enche o anel e é pulada, a porta sem taxa continua
+    fanout_port_t* par[2] = { &portas[0], &portas[2] };
+    for (int i = 0; i < (int)FANOUT_RING; i++) {
+        fanout_send(par, 2, config, sizeof(config));
+    }
+    verifica("erro: fan-out: com o anel cheio só a outra porta recebe",
+             fanout_send(par, 2, config, sizeof(config)) == 1 && portas[2].rejected == 1);
+    verifica("erro: fan-out: os buffers ficam só com a porta lenta",
+             fanout_pool_available(&pool) == FANOUT_BUFFERS - FANOUT_RING);
+    
+    // Sem buffer livre o envio é recusado antes de codificar
+    int enviados = 0;
+    while (fanout_send(&todas[1], 1, config, sizeof(config)) == 1) {
+        enviados++;
+    }
+    verifica("erro: fan-out: os buffers devem acabar",
+             fanout_pool_available(&pool) == 0 && pool.exhausted == 1 && enviados == FANOUT_BUFFERS - FANOUT_RING);
+    for (int i = 0; i < 1000 && fanout_pool_available(&pool) < FANOUT_BUFFERS; i++) {
+        advance_time(10);
+        while (channel_receive(&canais[1], lido, sizeof(lido)) > 0 || channel_receive(&canais[2], lido, sizeof(lido)) > 0) {
+        }
+    }
+    verifica("erro: fan-out: todos os buffers devem voltar", fanout_pool_available(&pool) == FANOUT_BUFFERS);
+    verifica("erro: fan-out: cada porta deve enviar o que enfileirou",
+             portas[0].frames == 2 + FANOUT_RING && portas[1].frames == 1 + (uint32_t)enviados &&
+             portas[2].frames == 1 + FANOUT_RING);
+    verifica("erro: fan-out: parâmetros inválidos", fanout_send(todas, 0, config, 1) == PROTOCOL_INVALID_PARAM &&
+             fanout_send(todas, 1, config, 0) == PROTOCOL_INVALID_PARAM);
+    protothreads_init();
+    
+    return 0;
+}
+
+// Um alarme pela sessão com ACK e retransmissão, na prioridade 0, atrás de
+// oito quadros de dados em massa na prioridade 2 do mesmo enlace: espera no
+// máximo o quadro em envio, não a fila inteira
+#define TX_TESTE_TAXA 10000u
+static char * test_tx_priority(void) {
+    static comm_channel_t canal;
+    static tx_sched_t sched;
+    static protocol_session_t sessao;
+    uint8_t massa[250], quadro[0xFF];
+    uint8_t negocia[] = {0x01, 0x02};
+    uint8_t alarme[] = {0xA1, 0xA2, 0xA3};
+    uint8_t size = sizeof(quadro);
+    uint32_t deadline;
+    
+    protothreads_init();
+    verifica("erro: prioridade: a sessão deve caber no escalonador", session_init(&sessao, &canal) == PROTOCOL_SUCCESS);
+    tx_sched_init(&sched, &canal, TX_TESTE_TAXA);
+    session_set_tx_sched(&sessao, &sched, 0);
+    
+    // A primeira mensagem negocia a sequência: depois dela, o transmissor
+    // ignora os ACKs dos quadros de dados em massa (sem SEQ do alarme)
+    session_send_data(&sessao, negocia, sizeof(negocia));
+    for (int i = 0; i < 50 && !session_transmission_complete(&sessao); i++) {
         protothreads_schedule();
-        advance_time(50);
+        if (!pt_ready && next_deadline(&deadline)) {
+            advance_time(deadline - system_time_ms);
+        }
     }
+    verifica("erro: prioridade: a negociação deve passar pelo escalonador",
+             session_get_tx_result(&sessao) == PROTOCOL_SUCCESS && sessao.tx.peer_sequencing && sched.sent[0] == 1);
     
-    verifica("erro: deve ter feito 1 retry", tx_state.retry_count == 1);
+    memset(massa, 0x5A, sizeof(massa));
+    protocol_create_message(massa, sizeof(massa), quadro, &size);
+    for (uint8_t i = 0; i < TX_QUEUE_FRAMES; i++) {
+        verifica("erro: prioridade: a fila de dados em massa deve aceitar o quadro",
+                 tx_sched_send(&sched, 2, quadro, size) == PROTOCOL_SUCCESS);
+    }
+    verifica("erro: prioridade: com a fila cheia o quadro é recusado",
+             tx_sched_send(&sched, 2, quadro, size) == PROTOCOL_ERROR && sched.rejected[2] == 1);
+    verifica("erro: prioridade: um quadro em envio, os outros na fila",
+             sched.busy && tx_sched_pending(&sched, 2) == TX_QUEUE_FRAMES - 1);
     
-    // Now stop packet loss and allow success
-    channel.simulate_loss = false;
+    // O alarme sai no meio do primeiro quadro de dados em massa
+    advance_time(5);
+    uint32_t inicio = system_time_ms;
+    uint32_t quadro_ms = ((uint32_t)size * 1000u + TX_TESTE_TAXA - 1) / TX_TESTE_TAXA;
+    session_send_data(&sessao, alarme, sizeof(alarme));
+    for (int i = 0; i < 200; i++) {
+        protothreads_schedule();
+        if (session_transmission_complete(&sessao)) break;
+        if (!pt_ready && next_deadline(&deadline)) {
+            advance_time(deadline - system_time_ms);
+        }
+    }
+    verifica("erro: prioridade: o alarme deve ser confirmado", session_get_tx_result(&sessao) == PROTOCOL_SUCCESS);
+    verifica("erro: prioridade: o alarme espera só o quadro em envio",
+             system_time_ms - inicio <= quadro_ms + 2u && sched.max_wait_ms[0] < quadro_ms &&
+             sched.sent[2] == 1 && sessao.tx.retry_count == 0);
     
-    // Continue until transmission completes
-    for (int i = 0; i < 50 && !protothreads_transmission_complete(); i++) {
+    // Os dados em massa continuam depois do alarme
+    for (int i = 0; i < 100 && (sched.busy || tx_sched_pending(&sched, 2) > 0); i++) {
+        advance_time(quadro_ms);
+        while (channel_receive(&canal, quadro, sizeof(quadro)) > 0) {
+        }
+    }
+    verifica("erro: prioridade: todos os quadros de dados em massa devem sair",
+             sched.sent[2] == TX_QUEUE_FRAMES && sched.max_wait_ms[2] >= (TX_QUEUE_FRAMES - 1u) * quadro_ms);
+    verifica("erro: prioridade: parâmetros inválidos",
+             tx_sched_send(&sched, TX_PRIORITIES, quadro, 1) == PROTOCOL_INVALID_PARAM &&
+             tx_sched_send(&sched, 0, quadro, 0) == PROTOCOL_INVALID_PARAM);
+    protothreads_init();
+    
+    return 0;
+}
+
+// Produtor do teste de controle de fluxo: quadros de FLUXO_TESTE_QUADRO
+// bytes, um por passada, esperando o crédito (espera) ou não
+#define FLUXO_TESTE_QUADRO 100u
+#define FLUXO_TESTE_QUADROS 30u
+#define FLUXO_TESTE_CONSUMO 50u             // Bytes lidos a cada 10 ms
+typedef struct {
+    pt_t pt;
+    comm_channel_t* ch;
+    bool espera;
+    uint8_t enviados;
+    uint32_t recusados;
+} produtor_fluxo_t;
+
+static int produtor_fluxo(void* contexto) {
+    produtor_fluxo_t* p = contexto;
+    uint8_t quadro[FLUXO_TESTE_QUADRO];
+    
+    PT_BEGIN(&p->pt);
+    while (p->enviados < FLUXO_TESTE_QUADROS) {
+        if (p->espera) {
+            PT_WAIT_EVENT(&p->pt, &p->ch->credit_event, channel_credit(p->ch) >= FLUXO_TESTE_QUADRO);
+        }
+        memset(quadro, p->enviados, sizeof(quadro));
+        if (!channel_send(p->ch, quadro, sizeof(quadro))) {
+            p->recusados++;
+        }
+        p->enviados++;
+        PT_YIELD(&p->pt);
+    }
+    PT_END(&p->pt);
+}
+
+// Um produtor rápido e um consumidor de 5 bytes/ms: sem controle de fluxo a
+// FIFO enche e os quadros são recusados; com créditos (que voltam com a
+// latência do canal) o produtor é freado na taxa do consumidor, sem perda,
+// e nunca passa da janela
+static uint32_t fluxo_executa(comm_channel_t* ch, produtor_fluxo_t* p, uint16_t* maior_ocupacao, uint32_t* erros) {
+    uint8_t lido[FLUXO_TESTE_CONSUMO];
+    uint32_t recebidos = 0;
+    
+    *maior_ocupacao = 0;
+    *erros = 0;
+    for (int i = 0; i < 1000 && (p->enviados < FLUXO_TESTE_QUADROS || channel_available(ch) > 0 ||
+                                 ch->flight_count > 0); i++) {
         protothreads_schedule();
+        uint16_t ocupacao = (uint16_t)(ch->write - ch->read);
+        if (ocupacao > *maior_ocupacao) {
+            *maior_ocupacao = ocupacao;
+        }
+        uint8_t n = channel_receive(ch, lido, sizeof(lido));
+        for (uint8_t j = 0; j < n; j++, recebidos++) {
+            *erros += p->recusados == 0 && lido[j] != (uint8_t)(recebidos / FLUXO_TESTE_QUADRO);
+        }
         advance_time(10);
     }
+    return recebidos;
+}
+
+static char * test_flow_control(void) {
+    static comm_channel_t canal;
+    static produtor_fluxo_t produtor;
+    static protocol_session_t sessao;
+    static const channel_impairment_t atraso = { .delay_ms = 5 };
+    uint16_t maior;
+    uint32_t erros, inicio;
+    uint8_t dados[200];
     
-    verifica("erro: transmissão deve ter sucesso após 1 retry", 
-             protothreads_transmission_complete());
-    verifica("erro: resultado deve ser SUCCESS", 
-             protothreads_get_tx_result() == PROTOCOL_SUCCESS);
-    verifica("erro: dados devem estar corretos", 
-             memcmp(protothreads_get_received_data(), test_data, 3) == 0);
+    // Sem controle de fluxo: a FIFO enche e o produtor perde quadros
+    protothreads_init();
+    channel_reset(&canal);
+    channel_impair(&canal, &atraso);
+    memset(&produtor, 0, sizeof(produtor));
+    produtor.ch = &canal;
+    pt_register(produtor_fluxo, &produtor);
+    uint32_t recebidos = fluxo_executa(&canal, &produtor, &maior, &erros);
+    verifica("erro: fluxo: sem créditos o canal cheio recusa quadros",
+             produtor.recusados > 0 && canal.rejected > 0 &&
+             recebidos == (FLUXO_TESTE_QUADROS - produtor.recusados) * FLUXO_TESTE_QUADRO);
+    
+    // Com créditos: o produtor espera e tudo chega, em ordem, na taxa do
+    // consumidor
+    protothreads_init();
+    channel_reset(&canal);
+    channel_impair(&canal, &atraso);
+    channel_flow_control(&canal, 300);
+    memset(&produtor, 0, sizeof(produtor));
+    produtor.ch = &canal;
+    produtor.espera = true;
+    pt_register(produtor_fluxo, &produtor);
+    inicio = system_time_ms;
+    recebidos = fluxo_executa(&canal, &produtor, &maior, &erros);
+    verifica("erro: fluxo: com créditos nenhum quadro é recusado",
+             produtor.recusados == 0 && canal.rejected == 0 && recebidos == FLUXO_TESTE_QUADROS * FLUXO_TESTE_QUADRO &&
+             erros == 0);
+    verifica("erro: fluxo: o produtor não passa da janela", maior <= 300 && canal.credit_updates > 0);
+    verifica("erro: fluxo: o produtor segue a taxa do consumidor",
+             system_time_ms - inicio >= (recebidos / FLUXO_TESTE_CONSUMO - 1u) * 10u);
+    verifica("erro: fluxo: janela abaixo do maior quadro", (channel_flow_control(&canal, 10), canal.window == CHANNEL_MIN_WINDOW));
+    
+    // O transmissor com ACK espera o crédito antes de cada quadro, sem
+    // recusas nem retransmissões
+    protothreads_init();
+    session_init(&sessao, &canal);
+    channel_impair(&canal, &atraso);
+    channel_flow_control(&canal, CHANNEL_MIN_WINDOW);
+    memset(dados, 0x33, sizeof(dados));
+    for (int m = 0; m < 4; m++) {
+        session_send_data(&sessao, dados, sizeof(dados));
+        uint32_t deadline;
+        for (int i = 0; i < 100 && !session_transmission_complete(&sessao); i++) {
+            protothreads_schedule();
+            if (!pt_ready && next_deadline(&deadline)) {
+                advance_time(deadline - system_time_ms);
+            }
+        }
+        verifica("erro: fluxo: a sessão deve entregar com crédito",
+                 session_get_tx_result(&sessao) == PROTOCOL_SUCCESS && sessao.tx.retry_count == 0);
+    }
+    verifica("erro: fluxo: a sessão não deve ter quadros recusados", canal.rejected == 0 && sessao.rx.delivered == 4);
+    channel_reset(&canal);
+    protothreads_init();
+    
+    return 0;
+}
+
+// O receptor nos fluxos de protocol_bench.h, comparável a t2 e t3: o fluxo
+// passa pelo canal em trechos de até 255 bytes (o tamanho de channel_send)
+static int mede_receptor(void* contexto, const uint8_t* fluxo, size_t tamanho) {
+    int validas = 0;
+    uint8_t resposta;
+    (void)contexto;
+    
+    for (size_t pos = 0; pos < tamanho; ) {
+        uint8_t trecho = (uint8_t)(tamanho - pos < 255 ? tamanho - pos : 255);
+        channel_send(&channel, &fluxo[pos], trecho);
+        pos += trecho;
+        while (channel_available(&channel) > 0) {
+            receiver_thread(&default_session.rx);
+            // Cada mensagem recebe um ACK ou NACK
+            while (channel_ack_received(&channel, &resposta)) {
+                if (resposta == ACK_BYTE) {
+                    validas++;
+                }
+            }
+        }
+    }
+    return validas;
+}
+
+/* Orçamentos de tempo do receptor e do ARQ simulado, cerca de 20x acima do
+   medido: só reprovam regressões grosseiras do escalonador ou do canal */
+static rpc_client_t rpc_cli;
+static rpc_server_t rpc_srv;
+static link_t rpc_req_link;
+static link_t rpc_resp_link;
+
+// Tratador dos testes: o método 1 responde já com a soma dos argumentos; o
+// método 2 guarda o id em contexto (uint8_t[2]: id e "há um") e não responde
+static void rpc_teste_handler(rpc_server_t* s, uint8_t id, uint8_t method, const uint8_t* args, uint8_t size) {
+    uint8_t soma = 0;
+    uint8_t* adiado = s->contexto;
+    
+    if (method == 2) {
+        adiado[0] = id;
+        adiado[1] = 1;
+        return;
+    }
+    for (uint8_t i = 0; i < size; i++) {
+        soma = (uint8_t)(soma + args[i]);
+    }
+    rpc_server_reply(s, id, method == 1 ? 0 : 0xFF, &soma, 1);
+}
+
+// Roda cliente e servidor até o pedido concluir ou o tempo passar de limite_ms
+static bool rpc_run_until(rpc_call_t* call, uint32_t limite_ms) {
+    uint32_t deadline;
+    uint32_t inicio = system_time_ms;
+    
+    while (call->done.count == 0 && system_time_ms - inicio <= limite_ms) {
+        pt_schedule();
+        if (!pt_ready && call->done.count == 0) {
+            if (!next_deadline(&deadline)) break;
+            advance_time(deadline - system_time_ms);
+        }
+    }
+    return call->done.count > 0;
+}
+
+static void rpc_teste_init(uint32_t delay_ms, uint8_t* adiado) {
+    protothreads_init();
+    pt_scheduler_reset();
+    link_init(&rpc_req_link, delay_ms, 0, 0);
+    link_init(&rpc_resp_link, delay_ms, 0, 0);
+    rpc_client_init(&rpc_cli, &rpc_req_link, &rpc_resp_link);
+    rpc_server_init(&rpc_srv, &rpc_req_link, &rpc_resp_link, rpc_teste_handler, adiado);
+    pt_register(rpc_server_run, &rpc_srv);
+}
+
+static char * test_rpc_pipelining(void) {
+    rpc_call_t calls[4];
+    rpc_call_t lento;
+    uint8_t adiado[2] = { 0, 0 };
+    uint8_t args[3];
+    
+    // Quatro consultas em aberto: todas voltam numa ida e volta de 100 ms
+    rpc_teste_init(50, adiado);
+    for (uint8_t i = 0; i < 4; i++) {
+        args[0] = i;
+        args[1] = 10;
+        args[2] = 20;
+        verifica("erro: rpc: pedido deve caber na tabela", rpc_call(&rpc_cli, &calls[i], 1, args, 3, 1000) == PROTOCOL_SUCCESS);
+    }
+    verifica("erro: rpc: quatro pedidos em aberto", rpc_outstanding(&rpc_cli) == 4);
+    verifica("erro: rpc: o último deve concluir", rpc_run_until(&calls[3], 1000));
+    verifica("erro: rpc: uma ida e volta para os quatro", system_time_ms - SYSTEM_TIME_INICIAL == 100);
+    for (uint8_t i = 0; i < 4; i++) {
+        verifica("erro: rpc: cada pedido concluído uma vez", pt_completion_take(&calls[i].done) &&
+                 calls[i].done.result == PROTOCOL_SUCCESS);
+        verifica("erro: rpc: resposta do próprio pedido", calls[i].reply_size == 1 && calls[i].reply[0] == 30 + i &&
+                 calls[i].status == 0);
+    }
+    verifica("erro: rpc: ids diferentes", calls[0].id != calls[1].id && calls[2].id != calls[3].id);
+    verifica("erro: rpc: tabela vazia no fim", rpc_outstanding(&rpc_cli) == 0 && rpc_cli.replies == 4);
+    
+    // Fora de ordem: o pedido lento fica no servidor e o seguinte volta antes
+    args[0] = 7;
+    verifica("erro: rpc: pedido lento", rpc_call(&rpc_cli, &lento, 2, NULL, 0, 1000) == PROTOCOL_SUCCESS);
+    verifica("erro: rpc: pedido rápido", rpc_call(&rpc_cli, &calls[0], 1, args, 1, 1000) == PROTOCOL_SUCCESS);
+    verifica("erro: rpc: o rápido conclui", rpc_run_until(&calls[0], 1000) && calls[0].reply[0] == 7);
+    verifica("erro: rpc: o lento ainda em aberto", lento.done.count == 0 && rpc_outstanding(&rpc_cli) == 1);
+    verifica("erro: rpc: o servidor guardou o lento", adiado[1] == 1 && adiado[0] == lento.id);
+    args[0] = 0x5A;
+    rpc_server_reply(&rpc_srv, adiado[0], 0, args, 1);
+    verifica("erro: rpc: o lento conclui depois", rpc_run_until(&lento, 1000) && lento.done.result == PROTOCOL_SUCCESS &&
+             lento.reply[0] == 0x5A);
+    protothreads_init();
+    
+    return 0;
+}
+
+static char * test_rpc_timeout_cancel(void) {
+    rpc_call_t calls[RPC_MAX_PENDING + 1];
+    uint8_t adiado[2] = { 0, 0 };
+    
+    // O servidor guarda todos os pedidos (método 2) sem responder
+    rpc_teste_init(10, adiado);
+    for (int i = 0; i < RPC_MAX_PENDING; i++) {
+        verifica("erro: rpc: a tabela deve aceitar RPC_MAX_PENDING",
+                 rpc_call(&rpc_cli, &calls[i], 2, NULL, 0, (uint32_t)(500 - 10 * i)) == PROTOCOL_SUCCESS);
+    }
+    verifica("erro: rpc: pedido já em aberto", rpc_call(&rpc_cli, &calls[1], 2, NULL, 0, 500) == PROTOCOL_INVALID_PARAM);
+    verifica("erro: rpc: tabela cheia deve recusar",
+             rpc_call(&rpc_cli, &calls[RPC_MAX_PENDING], 2, NULL, 0, 500) == PROTOCOL_ERROR);
+    verifica("erro: rpc: parâmetro inválido", rpc_call(&rpc_cli, &calls[RPC_MAX_PENDING], 2, NULL, 1, 500) ==
+             PROTOCOL_INVALID_PARAM);
+    
+    // Cancelado: conclui já com erro e o servidor é avisado
+    verifica("erro: rpc: cancela o primeiro", rpc_cancel(&rpc_cli, &calls[0]));
+    verifica("erro: rpc: cancelar de novo falha", !rpc_cancel(&rpc_cli, &calls[0]));
+    verifica("erro: rpc: cancelado conclui com erro", pt_completion_take(&calls[0].done) &&
+             calls[0].done.result == PROTOCOL_ERROR);
+    verifica("erro: rpc: lugar livre depois de cancelar",
+             rpc_call(&rpc_cli, &calls[RPC_MAX_PENDING], 2, NULL, 0, 1000) == PROTOCOL_SUCCESS);
+    
+    // Cada timer vence no seu tempo: o último pedido tem o menor timeout
+    uint32_t inicio = system_time_ms;
+    verifica("erro: rpc: o último vence primeiro", rpc_run_until(&calls[RPC_MAX_PENDING - 1], 1000) &&
+             calls[RPC_MAX_PENDING - 1].done.result == PROTOCOL_TIMEOUT);
+    verifica("erro: rpc: timeout do próprio pedido",
+             system_time_ms - inicio == (uint32_t)(500 - 10 * (RPC_MAX_PENDING - 1)));
+    verifica("erro: rpc: os outros continuam", calls[1].done.count == 0);
+    verifica("erro: rpc: todos vencem", rpc_run_until(&calls[1], 1000) && calls[1].done.result == PROTOCOL_TIMEOUT);
+    verifica("erro: rpc: só o de 1000 ms em aberto", rpc_outstanding(&rpc_cli) == 1 &&
+             rpc_cli.timeouts == RPC_MAX_PENDING - 1);
+    verifica("erro: rpc: o servidor recebeu o cancelamento", rpc_srv.cancels == 1 &&
+             rpc_srv.requests == RPC_MAX_PENDING + 1);
+    
+    // Resposta atrasada de um pedido vencido é descartada
+    rpc_server_reply(&rpc_srv, calls[1].id, 0, NULL, 0);
+    advance_time(10);
+    pt_schedule();
+    verifica("erro: rpc: resposta atrasada descartada", rpc_cli.stale == 1 && rpc_outstanding(&rpc_cli) == 1);
+    protothreads_init();
+    
+    return 0;
+}
+
+static char * test_time_budget(void) {
+    static uint8_t fluxo[PROTOCOL_BENCH_TAMANHO];
+    int validas;
+    size_t tamanho = protocol_bench_gera(BENCH_VALIDAS, fluxo, sizeof(fluxo), &validas);
+    
+    protothreads_init();
+    default_session.rx.sequencing = false;
+    pt_log_ligado = false;
+    verifica("erro: tempo: mensagens do fluxo", mede_receptor(NULL, fluxo, tamanho) == validas);
+    verifica_tempo("erro: tempo: receptor, 32 KB", mede_receptor(NULL, fluxo, tamanho), 1500000);
+    pt_log_ligado = true;
+    protothreads_init();
+    
+    arq_gera_dados();
+    verifica_tempo("erro: tempo: ARQ repetição seletiva, 20 KB",
+                   arq_transfer(ARQ_SELECTIVE_REPEAT, 8, 50, 0, arq_dados, sizeof(arq_dados), arq_saida), 2000000);
     
     return 0;
 }
 
+// protocol_create_message na varredura de tamanhos: o quadro sem a folga
+static size_t codifica_mensagem(const uint8_t* dados, uint8_t qtd, uint8_t* quadro) {
+    uint8_t tamanho = (uint8_t)(qtd + PROTOCOL_FRAME_ENVELOPE);
+    
+    if (qtd > 0xFF - PROTOCOL_FRAME_ENVELOPE ||
+        protocol_create_message((uint8_t*)dados, qtd, quadro, &tamanho) != PROTOCOL_SUCCESS) {
+        return 0;
+    }
+    return (size_t)qtd + 4;
+}
+
+// Codificador e receptor em cada tamanho de dados (PROTOCOL_BENCH_VARREDURA),
+// nas condições de mede_desempenho
+static int varre_tamanhos(void) {
+    protothreads_init();
+    default_session.rx.sequencing = false;
+    pt_log_ligado = false;
+    return protocol_bench_varredura("t4 protothreads", codifica_mensagem, mede_receptor, NULL);
+}
+
+static void mede_desempenho(void) {
+    protothreads_init();
+    // Os fluxos de protocol_bench.h são de mensagens STX, e o ruído deles não
+    // tem STX mas pode ter SOH: mede o receptor sem números de sequência
+    default_session.rx.sequencing = false;
+    pt_log_ligado = false;
+    protocol_bench_executa("t4 protothreads", mede_receptor, NULL, 100);
+    pt_log_ligado = true;
+    
+    // Vazão útil simulada do ARQ num enlace de 50 ms em cada sentido
+    static const uint8_t janelas[] = { 1, ARQ_WINDOW };
+    static const uint8_t perdas[] = { 0, 10 };
+    arq_gera_dados();
+    for (int p = 0; p < 2; p++) {
+        for (int m = 0; m < 2; m++) {
+            for (int j = 0; j < 2; j++) {
+                arq_mode_t modo = m == 0 ? ARQ_GO_BACK_N : ARQ_SELECTIVE_REPEAT;
+                uint32_t tempo = arq_transfer(modo, janelas[j], 50, perdas[p], arq_dados, sizeof(arq_dados), arq_saida);
+                printf("ARQ %s, janela %u, perda %u%%: ", m == 0 ? "go-back-N" : "repetição seletiva",
+                       janelas[j], perdas[p]);
+                if (tempo > 0) {
+                    printf("%.0f bytes/s, %u retransmissões\n", (double)sizeof(arq_dados) * 1000.0 / tempo,
+                           (unsigned)arq_tx.retransmissions);
+                } else {
+                    printf("não terminou\n");
+                }
+            }
+        }
+    }
+    
+    // Goodput e RTT num enlace com variação, erros de bit e perdas, limitado
+    // a 2000 bytes/s. Com 3 em 10^5 bits errados, uns 2% dos quadros; com
+    // BER maior, dois bits trocados na mesma posição escapam da soma de 8
+    // bits e a transferência acaba com "dados errados"
+    static const channel_impairment_t ida = { .loss_percent = 2, .ber_ppm = 30, .delay_ms = 50,
+                                              .jitter_ms = 20, .rate = 2000, .seed = 11u };
+    static const channel_impairment_t volta = { .loss_percent = 2, .ber_ppm = 30, .delay_ms = 50,
+                                                .jitter_ms = 20, .seed = 23u };
+    for (int m = 0; m < 2; m++) {
+        for (int j = 0; j < 2; j++) {
+            arq_mode_t modo = m == 0 ? ARQ_GO_BACK_N : ARQ_SELECTIVE_REPEAT;
+            uint32_t tempo = arq_transfer_impaired(modo, janelas[j], &ida, &volta, arq_dados, sizeof(arq_dados), arq_saida);
+            printf("ARQ %s, janela %u, enlace com degradações: ", m == 0 ? "go-back-N" : "repetição seletiva",
+                   janelas[j]);
+            if (tempo > 0) {
+                printf("%.0f bytes/s, SRTT %u ms, %u quadros corrompidos, %u retransmissões\n",
+                       (double)sizeof(arq_dados) * 1000.0 / tempo, (unsigned)(arq_tx.rto.srtt8 >> 3),
+                       (unsigned)(arq_data_link.corrupted + arq_ack_link.corrupted), (unsigned)arq_tx.retransmissions);
+            } else {
+                printf(arq_tx.complete ? "dados errados\n" : "não terminou\n");
+            }
+        }
+    }
+    
+    // Tráfego de controle nos dois sentidos num RS-485 de 1000 bytes/s
+    for (int atraso = 0; atraso < 2; atraso++) {
+        uint32_t tempo = arq_transfer_duplex(ARQ_GO_BACK_N, 5, 0, 1000, atraso ? 200 : 0, arq_dados, 8000, 4000);
+        printf("ARQ nos dois sentidos, half-duplex, %s: %u ms, %u quadros no meio, %u ACKs nos dados\n",
+               atraso ? "ACKs atrasados" : "um ACK por quadro", (unsigned)tempo,
+               (unsigned)(arq_data_link.sent + arq_ack_link.sent),
+               (unsigned)(arq_rx.acks_piggybacked + arq_rx_b.acks_piggybacked));
+    }
+    
+    // Escala do gateway: nós com 1 KB cada num meio de 10000 bytes/s
+    static const uint16_t nos[] = { 1, 4, 16, 64, 256 };
+    sim_config_t cfg = { .mode = ARQ_SELECTIVE_REPEAT, .window = ARQ_WINDOW, .rto_ms = 200, .delay_ms = 20,
+                         .loss_percent = 2, .rate = 10000, .bytes = 1024 };
+    sim_result_t r;
+    for (size_t i = 0; i < sizeof(nos) / sizeof(nos[0]); i++) {
+        sim_run(&cfg, nos[i], arq_dados, &r);
+        printf("Rede de %u nós: %u entregues em %u ms, %.0f bytes/s, espera pelo meio %.1f ms, "
+               "%.1f%% retransmissões\n", (unsigned)nos[i], (unsigned)r.completed, (unsigned)r.elapsed_ms,
+               r.goodput, r.queue_ms, 100.0 * r.overhead);
+    }
+}
+
 static char * executa_testes(void) {
     executa_teste(test_protothread_init);
     executa_teste(test_successful_transmission);
@@ -556,6 +4775,33 @@ static char * executa_testes(void) {
     // executa_teste(test_retry_then_success);  
     executa_teste(test_message_creation);
     executa_teste(test_timer_functionality);
+#if defined(__GNUC__) && !defined(PT_LC_SWITCH)
+    executa_teste(test_lc_switch_in_thread);
+#endif
+    executa_teste(test_scheduler_ready_set);
+    executa_teste(test_channel_fifo);
+    executa_teste(test_channel_impairment);
+    executa_teste(test_multiple_sessions);
+    executa_teste(test_duplicate_suppression);
+    executa_teste(test_rx_zero_copy);
+    executa_teste(test_event_wakeup);
+    executa_teste(test_poll_notify);
+    executa_teste(test_io_completion);
+    executa_teste(test_pt_spawn_sem);
+    executa_teste(test_timer_queue);
+    executa_teste(test_timer_wraparound);
+    executa_teste(test_arq_window_goodput);
+    executa_teste(test_arq_loss);
+    executa_teste(test_arq_impairment);
+    executa_teste(test_arq_ack_coalescing);
+    executa_teste(test_sim_rede);
+    executa_teste(test_fanout);
+    executa_teste(test_tx_priority);
+    executa_teste(test_flow_control);
+    executa_teste(test_rto_estimator);
+    executa_teste(test_rpc_pipelining);
+    executa_teste(test_rpc_timeout_cancel);
+    executa_teste(test_time_budget);
     
     return 0;
 }